@@ -103,6 +103,7 @@ def _get_dslx_test_cmdline(ctx, src, all_srcs, append_cmd_line_args = True):
         "disable_warnings",
         "enable_warnings",
         "max_ticks",
+        "test_parallelism",
         "format_preference",
     )
 
@@ -277,6 +277,7 @@ def xls_ir_cc_library_macro(
             "@com_google_absl//absl/types:span",
             "//xls/ir:events",
             "//xls/ir:value",
+            "//xls/jit:aot_block_runtime",
             "//xls/jit:aot_runtime",
             "//xls/jit:type_layout",
         ],
@@ -408,6 +408,8 @@ def cc_xls_ir_jit_wrapper(
             "//xls/public:ir_parser",
             "//xls/public:ir",
             "@com_google_absl//absl/container:flat_hash_map",
+            "@com_google_absl//absl/types:span",
+            "//xls/common/status:ret_check",
             "//xls/public:function_builder",
             "//xls/public:value",
             "//xls/jit:function_jit",
@@ -376,7 +376,8 @@ def xls_dslx_opt_ir_macro(
 def xls_dslx_cpp_type_library(
         name,
         src,
-        namespace = None):
+        namespace = None,
+        jit_buffer_conversions = False):
     """Creates a cc_library target for transpiled DSLX types.
 
     This macros invokes the DSLX-to-C++ transpiler and compiles the result as
@@ -386,6 +387,8 @@ def xls_dslx_cpp_type_library(
       name: The name of the eventual cc_library.
       src: The DSLX file whose types to compile as C++.
       namespace: The C++ namespace to generate the code in (e.g., `foo::bar`).
+      jit_buffer_conversions: Whether to also generate functions converting the
+        types to and from the native data layout of the JIT.
     """
     native.genrule(
         name = name + "_generate_sources",
@@ -401,6 +404,7 @@ def xls_dslx_cpp_type_library(
               "--output_header_path=$(@D)/{}.h ".format(name) +
               "--output_source_path=$(@D)/{}.cc ".format(name) +
               ("" if namespace == None else "--namespaces={} ".format(namespace)) +
+              ("--jit_buffer_conversions " if jit_buffer_conversions else "") +
               "$(location {})".format(src),
     )
 
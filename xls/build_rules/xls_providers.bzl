@@ -139,6 +139,16 @@ SCHEDULING_FIELDS = {
                                       "when `--clock_period_ps` is given but is infeasible for " +
                                       "scheduling, will print a warning and continue scheduling " +
                                       "as if the shortest feasible clock period had been given.",
+    "clock_period_search_threads": "The number of candidate clock periods to " +
+                                   "evaluate concurrently when searching for " +
+                                   "the shortest feasible clock period.",
+    "sdc_partition_node_count": "If positive, functions with more nodes than " +
+                                "this are scheduled in independent groups of " +
+                                "pipeline stages of at most roughly this many " +
+                                "nodes, trading some pipeline registers for speed.",
+    "retime_pipeline": "If true, rebalance the pipeline stages after " +
+                       "scheduling by retiming the pipeline registers to " +
+                       "minimize the largest stage delay.",
     "minimize_worst_case_throughput": "If true, when `--worst_case_throughput` " +
                                       "is not given, search for & report the best " +
                                       "possible worst-case throughput of the circuit " +
@@ -184,6 +194,8 @@ SCHEDULING_FIELDS = {
     "fdo_synthesis_libraries": "Synthesis and STA libraries.",
     "fdo_default_driver_cell": "Cell to assume is driving primary inputs.",
     "fdo_default_load": "Cell to assume is being driven by primary outputs.",
+    "fdo_persistent_synthesis_tools": "If true, keep Yosys and OpenSTA " +
+                                      "running between synthesis jobs.",
     "multi_proc": "If true, schedule all procs and codegen them all.",
 }
 
@@ -15,10 +15,13 @@
 #include "xls/codegen/block_generator.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <deque>
+#include <filesystem>  // NOLINT
 #include <initializer_list>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -26,6 +29,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
@@ -36,6 +40,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/codegen/block_conversion.h"
+#include "xls/codegen/codegen_cache.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/flattening.h"
 #include "xls/codegen/module_builder.h"
@@ -49,6 +54,7 @@
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/block.h"
 #include "xls/ir/format_preference.h"
@@ -56,6 +62,7 @@
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
+#include "xls/ir/package.h"
 #include "xls/ir/register.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/topo_sort.h"
@@ -938,6 +945,50 @@ absl::StatusOr<std::vector<Block*>> GatherInstantiatedBlocks(Block* top) {
   return blocks;
 }
 
+// Generates the Verilog text for the single given block (not including any
+// blocks it instantiates). If `with_line_map` is true the line map of the
+// result is populated, with Verilog spans relative to the start of the text.
+absl::StatusOr<CodegenCache::Entry> GenerateBlockVerilog(
+    Block* block, const CodegenOptions& options, bool with_line_map,
+    const absl::flat_hash_map<InputPort*, std::string>& input_port_sv_types,
+    const absl::flat_hash_map<OutputPort*, std::string>&
+        output_port_sv_types) {
+  VerilogFile file(options.use_system_verilog() ? FileType::kSystemVerilog
+                                                : FileType::kVerilog);
+  XLS_RETURN_IF_ERROR(BlockGenerator::Generate(
+      block, &file, options, input_port_sv_types, output_port_sv_types));
+
+  CodegenCache::Entry entry;
+  if (!with_line_map) {
+    entry.verilog = file.Emit();
+    return entry;
+  }
+  LineInfo line_info;
+  entry.verilog = file.Emit(&line_info);
+  for (const auto& [vast_node, partial_spans] : line_info.Spans()) {
+    std::optional<std::vector<LineSpan>> spans =
+        line_info.LookupNode(vast_node);
+    if (!spans.has_value()) {
+      return absl::InternalError("Unbalanced calls to LineInfo::{Start, End}");
+    }
+    for (const LineSpan& span : spans.value()) {
+      SourceInfo info = vast_node->loc();
+      for (const SourceLocation& loc : info.locations) {
+        int64_t line = static_cast<int32_t>(loc.lineno());
+        VerilogLineMapping* mapping = entry.line_map.add_mapping();
+        mapping->set_source_file(
+            block->package()->GetFilename(loc.fileno()).value_or(""));
+        mapping->mutable_source_span()->set_line_start(line);
+        mapping->mutable_source_span()->set_line_end(line);
+        mapping->set_verilog_file("");  // to be updated later on
+        mapping->mutable_verilog_span()->set_line_start(span.StartLine());
+        mapping->mutable_verilog_span()->set_line_end(span.EndLine());
+      }
+    }
+  }
+  return entry;
+}
+
 }  // namespace
 
 absl::StatusOr<std::string> GenerateVerilog(
@@ -951,41 +1002,88 @@ absl::StatusOr<std::string> GenerateVerilog(
 
   XLS_ASSIGN_OR_RETURN(std::vector<Block*> blocks,
                        GatherInstantiatedBlocks(top));
-  VerilogFile file(options.use_system_verilog() ? FileType::kSystemVerilog
-                                                : FileType::kVerilog);
-  for (Block* block : blocks) {
-    XLS_RETURN_IF_ERROR(BlockGenerator::Generate(
-        block, &file, options, input_port_sv_types, output_port_sv_types));
-    if (block != blocks.back()) {
-      file.Add(file.Make<BlankLine>(SourceInfo()));
-      file.Add(file.Make<BlankLine>(SourceInfo()));
-    }
-  }
 
-  LineInfo line_info;
-  std::string text = file.Emit(&line_info);
-  if (verilog_line_map != nullptr) {
-    for (const auto& [vast_node, partial_spans] : line_info.Spans()) {
-      std::optional<std::vector<LineSpan>> spans =
-          line_info.LookupNode(vast_node);
-      if (!spans.has_value()) {
-        return absl::InternalError(
-            "Unbalanced calls to LineInfo::{Start, End}");
+  // Each block is generated into its own VerilogFile and emitted into its own
+  // buffer. Generation only reads the IR, so the blocks are handled in
+  // parallel and the results concatenated in the (deterministic) order of
+  // `blocks`. Blocks found in the codegen cache, if any, are not regenerated.
+  std::optional<CodegenCache> cache;
+  if (options.codegen_cache_dir().has_value()) {
+    XLS_ASSIGN_OR_RETURN(CodegenCache created,
+                         CodegenCache::Create(std::filesystem::path(
+                             *options.codegen_cache_dir())));
+    cache.emplace(std::move(created));
+  }
+  auto emit_block = [&](Block* block) -> absl::StatusOr<CodegenCache::Entry> {
+    std::string key;
+    if (cache.has_value()) {
+      key = CodegenCache::Key(block, options.codegen_cache_salt(),
+                              input_port_sv_types, output_port_sv_types);
+      XLS_ASSIGN_OR_RETURN(std::optional<CodegenCache::Entry> cached,
+                           cache->Lookup(key));
+      if (cached.has_value()) {
+        VLOG(2) << "Reusing cached Verilog for block " << block->name();
+        return *std::move(cached);
       }
-      for (const LineSpan& span : spans.value()) {
-        SourceInfo info = vast_node->loc();
-        for (const SourceLocation& loc : info.locations) {
-          int64_t line = static_cast<int32_t>(loc.lineno());
-          VerilogLineMapping* mapping = verilog_line_map->add_mapping();
-          mapping->set_source_file(
-              top->package()->GetFilename(loc.fileno()).value_or(""));
-          mapping->mutable_source_span()->set_line_start(line);
-          mapping->mutable_source_span()->set_line_end(line);
-          mapping->set_verilog_file("");  // to be updated later on
-          mapping->mutable_verilog_span()->set_line_start(span.StartLine());
-          mapping->mutable_verilog_span()->set_line_end(span.EndLine());
+    }
+    XLS_ASSIGN_OR_RETURN(
+        CodegenCache::Entry entry,
+        GenerateBlockVerilog(
+            block, options,
+            /*with_line_map=*/cache.has_value() || verilog_line_map != nullptr,
+            input_port_sv_types, output_port_sv_types));
+    if (cache.has_value()) {
+      XLS_RETURN_IF_ERROR(cache->Insert(key, entry));
+    }
+    return entry;
+  };
+  std::vector<absl::StatusOr<CodegenCache::Entry>> emitted(blocks.size());
+  int64_t thread_count =
+      std::min<int64_t>(blocks.size(), std::max(AvailableCPUs(), 1));
+  if (thread_count <= 1) {
+    for (int64_t i = 0; i < blocks.size(); ++i) {
+      emitted[i] = emit_block(blocks[i]);
+    }
+  } else {
+    // Generation may look up types of the package from every thread.
+    top->package()->type_manager().BeginConcurrentAccess();
+    std::atomic<int64_t> next_block = 0;
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t t = 0; t < thread_count; ++t) {
+      threads.push_back(std::make_unique<Thread>([&] {
+        for (int64_t i = next_block++; i < blocks.size(); i = next_block++) {
+          emitted[i] = emit_block(blocks[i]);
         }
-      }
+      }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+    top->package()->type_manager().EndConcurrentAccess();
+  }
+
+  std::string text;
+  for (int64_t i = 0; i < blocks.size(); ++i) {
+    XLS_RETURN_IF_ERROR(emitted[i].status());
+    // Lines in each block's line map are relative to the start of the block.
+    int64_t line_offset = absl::c_count(text, '\n');
+    absl::StrAppend(&text, emitted[i]->verilog);
+    if (i + 1 < blocks.size()) {
+      // Separate the modules by two blank lines.
+      absl::StrAppend(&text, "\n\n");
+    }
+    if (verilog_line_map == nullptr) {
+      continue;
+    }
+    for (const VerilogLineMapping& block_mapping :
+         emitted[i]->line_map.mapping()) {
+      VerilogLineMapping* mapping = verilog_line_map->add_mapping();
+      *mapping = block_mapping;
+      mapping->mutable_verilog_span()->set_line_start(
+          block_mapping.verilog_span().line_start() + line_offset);
+      mapping->mutable_verilog_span()->set_line_end(
+          block_mapping.verilog_span().line_end() + line_offset);
     }
   }
 
@@ -36,12 +36,16 @@
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "xls/codegen/block_conversion.h"
+#include "xls/codegen/codegen_cache.pb.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/codegen_pass.h"
 #include "xls/codegen/codegen_pass_pipeline.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/op_override_impls.h"
 #include "xls/codegen/signature_generator.h"
+#include "xls/codegen/verilog_line_map.pb.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
@@ -75,6 +79,7 @@ namespace xls {
 namespace verilog {
 namespace {
 
+using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
 using ::testing::HasSubstr;
 
@@ -231,6 +236,53 @@ TEST_P(BlockGeneratorTest, AandB) {
   XLS_ASSERT_OK(tb->Run());
 }
 
+TEST_P(BlockGeneratorTest, CodegenCacheReusesBlockVerilog) {
+  Package package(TestBaseName());
+
+  Type* u32 = package.GetBitsType(32);
+  BlockBuilder bb(TestBaseName(), &package);
+  BValue a = bb.InputPort("a", u32);
+  BValue b = bb.InputPort("b", u32);
+  bb.OutputPort("sum", bb.And(a, b));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory cache_dir, TempDirectory::Create());
+  CodegenOptions options = codegen_options();
+  options.codegen_cache(cache_dir.path().string(), "salt");
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string uncached,
+                           GenerateVerilog(block, codegen_options()));
+  VerilogLineMap line_map;
+  XLS_ASSERT_OK_AND_ASSIGN(std::string verilog,
+                           GenerateVerilog(block, options, &line_map));
+  EXPECT_EQ(verilog, uncached);
+
+  // Mark the cached Verilog so that its reuse is observable.
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::filesystem::path> entries,
+                           GetDirectoryEntries(cache_dir.path()));
+  int64_t cache_entries = 0;
+  for (const std::filesystem::path& entry : entries) {
+    if (entry.extension() == ".codegen") {
+      XLS_ASSERT_OK_AND_ASSIGN(std::string contents, GetFileContents(entry));
+      CodegenCacheEntryProto proto;
+      ASSERT_TRUE(proto.ParseFromString(contents));
+      proto.set_verilog("// cached\n");
+      XLS_ASSERT_OK(SetFileContents(entry, proto.SerializeAsString()));
+      ++cache_entries;
+    }
+  }
+  EXPECT_EQ(cache_entries, 1);
+
+  VerilogLineMap cached_line_map;
+  EXPECT_THAT(GenerateVerilog(block, options, &cached_line_map),
+              IsOkAndHolds("// cached\n"));
+  EXPECT_EQ(cached_line_map.mapping_size(), line_map.mapping_size());
+
+  // A different salt (i.e., different options) misses the cache.
+  options.codegen_cache(cache_dir.path().string(), "other salt");
+  EXPECT_THAT(GenerateVerilog(block, options), IsOkAndHolds(uncached));
+}
+
 TEST_P(BlockGeneratorTest, PipelinedAandB) {
   Package package(TestBaseName());
 
@@ -0,0 +1,100 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/codegen_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/codegen/codegen_cache.pb.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/block.h"
+#include "xls/ir/nodes.h"
+
+namespace xls::verilog {
+namespace {
+
+// Version of the format of cache entries; bump when CodegenCacheEntryProto or
+// how the key material is assembled changes incompatibly.
+constexpr std::string_view kFormatVersion = "1";
+
+}  // namespace
+
+/* static */ absl::StatusOr<CodegenCache> CodegenCache::Create(
+    const std::filesystem::path& directory) {
+  XLS_ASSIGN_OR_RETURN(
+      ContentAddressedCache cache,
+      ContentAddressedCache::Create(directory, ".codegen", "codegen cache"));
+  return CodegenCache(std::move(cache));
+}
+
+/* static */ std::string CodegenCache::Key(
+    Block* block, std::string_view salt,
+    const absl::flat_hash_map<InputPort*, std::string>& input_port_sv_types,
+    const absl::flat_hash_map<OutputPort*, std::string>& output_port_sv_types) {
+  std::string sv_types;
+  for (const Block::Port& port : block->GetPorts()) {
+    if (std::holds_alternative<InputPort*>(port)) {
+      auto it = input_port_sv_types.find(std::get<InputPort*>(port));
+      if (it != input_port_sv_types.end()) {
+        absl::StrAppend(&sv_types, "sv_type ", it->first->name(), " ",
+                        it->second, "\n");
+      }
+    } else if (std::holds_alternative<OutputPort*>(port)) {
+      auto it = output_port_sv_types.find(std::get<OutputPort*>(port));
+      if (it != output_port_sv_types.end()) {
+        absl::StrAppend(&sv_types, "sv_type ", it->first->name(), " ",
+                        it->second, "\n");
+      }
+    }
+  }
+  return ContentAddressedCache::ComputeKey(
+      {kFormatVersion, salt, block->DumpIr(), sv_types});
+}
+
+absl::StatusOr<std::optional<CodegenCache::Entry>> CodegenCache::Lookup(
+    std::string_view key) const {
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> contents,
+                       cache_.Lookup(key));
+  if (!contents.has_value()) {
+    return std::nullopt;
+  }
+  CodegenCacheEntryProto proto;
+  if (!proto.ParseFromString(*contents)) {
+    return absl::DataLossError(
+        absl::StrFormat("Unable to parse codegen cache entry %s",
+                        cache_.GetPath(key).string()));
+  }
+  return Entry{.verilog = std::move(*proto.mutable_verilog()),
+               .line_map = std::move(*proto.mutable_line_map())};
+}
+
+absl::Status CodegenCache::Insert(std::string_view key, const Entry& entry) {
+  CodegenCacheEntryProto proto;
+  proto.set_verilog(entry.verilog);
+  *proto.mutable_line_map() = entry.line_map;
+  return cache_.Insert(key, proto.SerializeAsString());
+}
+
+}  // namespace xls::verilog
@@ -0,0 +1,82 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_CODEGEN_CODEGEN_CACHE_H_
+#define XLS_CODEGEN_CODEGEN_CACHE_H_
+
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/codegen/verilog_line_map.pb.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/ir/block.h"
+#include "xls/ir/nodes.h"
+
+namespace xls::verilog {
+
+// An on-disk cache of the Verilog generated for individual blocks stored in a
+// directory on disk (see ContentAddressedCache), so that blocks which are
+// unchanged between runs of codegen need not be regenerated. Entries are keyed
+// by the IR of the block (which includes its schedule, as pipeline registers)
+// along with a caller-provided salt which must capture every option affecting
+// the generated text.
+//
+// Each entry is a single serialized CodegenCacheEntryProto, so the cache may
+// be shared between concurrent processes.
+class CodegenCache {
+ public:
+  // The cached results of generating a single block. Verilog spans in the line
+  // map are relative to the start of `verilog`.
+  struct Entry {
+    std::string verilog;
+    VerilogLineMap line_map;
+  };
+
+  // Creates a cache backed by `directory`, creating the directory if it does
+  // not exist.
+  static absl::StatusOr<CodegenCache> Create(
+      const std::filesystem::path& directory);
+
+  // Returns the key under which the results of generating `block` are cached.
+  static std::string Key(
+      Block* block, std::string_view salt,
+      const absl::flat_hash_map<InputPort*, std::string>& input_port_sv_types,
+      const absl::flat_hash_map<OutputPort*, std::string>&
+          output_port_sv_types);
+
+  // Returns the entry with the given key, or std::nullopt if there is none.
+  absl::StatusOr<std::optional<Entry>> Lookup(std::string_view key) const;
+
+  // Adds an entry to the cache, replacing any existing entry with the same
+  // key.
+  absl::Status Insert(std::string_view key, const Entry& entry);
+
+  const std::filesystem::path& directory() const { return cache_.directory(); }
+
+ private:
+  explicit CodegenCache(ContentAddressedCache cache)
+      : cache_(std::move(cache)) {}
+
+  ContentAddressedCache cache_;
+};
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_CODEGEN_CACHE_H_
@@ -274,6 +274,20 @@ class CodegenOptions {
   }
   bool emit_sv_types() const { return emit_sv_types_; }
 
+  // Directory in which to cache the Verilog generated for each block so that
+  // unchanged blocks are not regenerated by later runs. The salt is included in
+  // the cache key and must distinguish all options which affect the generated
+  // Verilog (e.g., a serialization of the codegen flags).
+  CodegenOptions& codegen_cache(std::string_view dir, std::string_view salt) {
+    codegen_cache_dir_ = dir;
+    codegen_cache_salt_ = salt;
+    return *this;
+  }
+  std::optional<std::string_view> codegen_cache_dir() const {
+    return codegen_cache_dir_;
+  }
+  std::string_view codegen_cache_salt() const { return codegen_cache_salt_; }
+
  private:
   std::optional<std::string> entry_;
   std::optional<std::string> module_name_;
@@ -304,6 +318,8 @@ class CodegenOptions {
   std::optional<PackageInterfaceProto> package_interface_;
   std::vector<std::string> includes_;
   bool emit_sv_types_ = true;
+  std::optional<std::string> codegen_cache_dir_;
+  std::string codegen_cache_salt_;
 };
 
 template <typename Sink>
@@ -35,7 +35,7 @@ namespace verilog {
 
 absl::StatusOr<ModuleGeneratorResult> GenerateCombinationalModule(
     FunctionBase* module, const CodegenOptions& options,
-    const DelayEstimator* delay_estimator) {
+    const DelayEstimator* delay_estimator, PassResults* pass_results) {
   XLS_ASSIGN_OR_RETURN(CodegenPassUnit unit,
                        FunctionBaseToCombinationalBlock(module, options));
 
@@ -45,7 +45,9 @@ absl::StatusOr<ModuleGeneratorResult> GenerateCombinationalModule(
 
   PassResults results;
   XLS_RETURN_IF_ERROR(CreateCodegenPassPipeline()
-                          ->Run(&unit, codegen_pass_options, &results)
+                          ->Run(&unit, codegen_pass_options,
+                                pass_results == nullptr ? &results
+                                                        : pass_results)
                           .status());
   XLS_RET_CHECK_NE(unit.top_block, nullptr);
   XLS_RET_CHECK(unit.metadata.contains(unit.top_block));
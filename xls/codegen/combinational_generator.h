@@ -20,6 +20,7 @@
 #include "xls/codegen/module_signature.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/node.h"
+#include "xls/passes/pass_base.h"
 
 namespace xls {
 namespace verilog {
@@ -28,9 +29,12 @@ namespace verilog {
 // use_system_verilog is true the generated module will be SystemVerilog
 // otherwise it will be Verilog. This adds a proc to the package which
 // represents the combinational module. This proc is used for code generation.
+// If `pass_results` is non-null, the results (including the per-invocation
+// timing and memory profile) of the codegen pass pipeline are stored in it.
 absl::StatusOr<ModuleGeneratorResult> GenerateCombinationalModule(
     FunctionBase* module, const CodegenOptions& options,
-    const DelayEstimator* delay_estimator = nullptr);
+    const DelayEstimator* delay_estimator = nullptr,
+    PassResults* pass_results = nullptr);
 
 }  // namespace verilog
 }  // namespace xls
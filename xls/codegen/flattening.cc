@@ -48,6 +48,12 @@ static void GatherValueLeaves(const Value& value, std::vector<Bits>* leaves) {
       }
       break;
     case ValueKind::kArray:
+      if (value.IsPackedBitsArray()) {
+        // The packed elements are already laid out with element 0 in the least
+        // significant bits, as in the flattened form.
+        leaves->push_back(value.packed_bits());
+        break;
+      }
       for (int64_t i = value.size() - 1; i >= 0; --i) {
         GatherValueLeaves(value.element(i), leaves);
       }
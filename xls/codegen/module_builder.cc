@@ -95,7 +95,11 @@ absl::StatusOr<Expression*> FlattenValueToExpression(const Value& value,
   }
   // Compound types are represented as a concatenation of their elements.
   std::vector<Value> value_elements;
-  if (value.IsArray()) {
+  if (value.IsPackedBitsArray()) {
+    for (int64_t i = value.size() - 1; i >= 0; --i) {
+      value_elements.push_back(Value(value.GetBitsElement(i)));
+    }
+  } else if (value.IsArray()) {
     for (int64_t i = value.size() - 1; i >= 0; --i) {
       value_elements.push_back(value.element(i));
     }
@@ -135,6 +139,16 @@ absl::StatusOr<ArrayAssignmentPattern*> ValueToArrayAssignmentPattern(
     const Value& value, VerilogFile* file) {
   XLS_RET_CHECK(value.IsArray());
   std::vector<Expression*> pieces;
+  if (value.IsPackedBitsArray()) {
+    pieces.reserve(value.size());
+    for (int64_t i = 0; i < value.size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          Expression * element_expr,
+          FlattenValueToExpression(Value(value.GetBitsElement(i)), file));
+      pieces.push_back(element_expr);
+    }
+    return file->Make<ArrayAssignmentPattern>(SourceInfo(), pieces);
+  }
   for (const Value& element : value.elements()) {
     Expression* element_expr;
     if (element.IsArray()) {
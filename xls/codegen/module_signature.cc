@@ -874,6 +874,12 @@ absl::Status ModuleSignature::ReplaceBlockMetrics(
   return absl::OkStatus();
 }
 
+void ModuleSignature::ReplaceCodegenPassProfile(
+    PassPipelineProfileProto profile) {
+  *proto_.mutable_metrics()->mutable_codegen_pass_profile() =
+      std::move(profile);
+}
+
 std::ostream& operator<<(std::ostream& os, const ModuleSignature& signature) {
   os << signature.ToString();
   return os;
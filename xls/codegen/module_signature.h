@@ -38,6 +38,7 @@
 #include "xls/ir/package.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/passes/pass_profile.pb.h"
 
 namespace xls {
 namespace verilog {
@@ -269,6 +270,9 @@ class ModuleSignature {
   // TODO(tedhong): 2022-01-28 Support incremental update of metrics.
   absl::Status ReplaceBlockMetrics(BlockMetricsProto block_metrics);
 
+  // Replace the profile of the codegen pass pipeline in the signature metrics.
+  void ReplaceCodegenPassProfile(PassPipelineProfileProto profile);
+
  private:
   ModuleSignatureProto proto_;
 
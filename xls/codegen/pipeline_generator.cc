@@ -43,14 +43,16 @@ namespace verilog {
 
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, Function* func,
-    const CodegenOptions& options, const DelayEstimator* delay_estimator) {
+    const CodegenOptions& options, const DelayEstimator* delay_estimator,
+    PassResults* pass_results) {
   return ToPipelineModuleText(schedule, static_cast<FunctionBase*>(func),
-                              options, delay_estimator);
+                              options, delay_estimator, pass_results);
 }
 
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, FunctionBase* module,
-    const CodegenOptions& options, const DelayEstimator* delay_estimator) {
+    const CodegenOptions& options, const DelayEstimator* delay_estimator,
+    PassResults* pass_results) {
   VLOG(2) << "Generating pipelined module for module:";
   XLS_VLOG_LINES(2, module->DumpIr());
   XLS_VLOG_LINES(2, schedule.ToString());
@@ -71,8 +73,11 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
   }
 
   PassResults results;
-  XLS_RETURN_IF_ERROR(
-      CreateCodegenPassPipeline()->Run(&unit, pass_options, &results).status());
+  XLS_RETURN_IF_ERROR(CreateCodegenPassPipeline()
+                          ->Run(&unit, pass_options,
+                                pass_results == nullptr ? &results
+                                                        : pass_results)
+                          .status());
   XLS_RET_CHECK(unit.top_block != nullptr &&
                 unit.metadata.contains(unit.top_block) &&
                 unit.metadata.at(unit.top_block).signature.has_value());
@@ -94,7 +99,8 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
 
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PackagePipelineSchedules& schedules, Package* package,
-    const CodegenOptions& options, const DelayEstimator* delay_estimator) {
+    const CodegenOptions& options, const DelayEstimator* delay_estimator,
+    PassResults* pass_results) {
   VLOG(2) << "Generating pipelined module for module:";
   XLS_VLOG_LINES(2, package->DumpIr());
   if (VLOG_IS_ON(2)) {
@@ -123,8 +129,11 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
   }
 
   PassResults results;
-  XLS_RETURN_IF_ERROR(
-      CreateCodegenPassPipeline()->Run(&unit, pass_options, &results).status());
+  XLS_RETURN_IF_ERROR(CreateCodegenPassPipeline()
+                          ->Run(&unit, pass_options,
+                                pass_results == nullptr ? &results
+                                                        : pass_results)
+                          .status());
   XLS_RET_CHECK(unit.top_block != nullptr &&
                 unit.metadata.contains(unit.top_block) &&
                 unit.metadata.at(unit.top_block).signature.has_value());
@@ -27,6 +27,7 @@
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/package.h"
+#include "xls/passes/pass_base.h"
 #include "xls/scheduling/pipeline_schedule.h"
 
 namespace xls {
@@ -46,29 +47,37 @@ inline CodegenOptions BuildPipelineOptions() {
 // given in the signature.
 // If a delay estimator is provided, the signature also includes delay
 // information about the pipeline stages.
+// If `pass_results` is non-null, the results (including the per-invocation
+// timing and memory profile) of the codegen pass pipeline are stored in it.
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, Function* func,
     const CodegenOptions& options = BuildPipelineOptions(),
-    const DelayEstimator* delay_estimator = nullptr);
+    const DelayEstimator* delay_estimator = nullptr,
+    PassResults* pass_results = nullptr);
 
 // Emits the given function or proc as a verilog module which follows the given
 // schedule. The module is pipelined with a latency and initiation interval
 // given in the signature.
 // If a delay estimator is provided, the signature also includes delay
 // information about the pipeline stages.
+// If `pass_results` is non-null, the results of the codegen pass pipeline are
+// stored in it.
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, FunctionBase* module,
     const CodegenOptions& options = BuildPipelineOptions(),
-    const DelayEstimator* delay_estimator = nullptr);
+    const DelayEstimator* delay_estimator = nullptr,
+    PassResults* pass_results = nullptr);
 
 // Emits the given package as a verilog module which follows the given
 // schedules. Modules are pipelined with a latency and initiation interval
 // given in the signature. If a delay estimator is provided, the signature also
-// includes delay information about the pipeline stages.
+// includes delay information about the pipeline stages. If `pass_results` is
+// non-null, the results of the codegen pass pipeline are stored in it.
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PackagePipelineSchedules& schedules, Package* package,
     const CodegenOptions& options = BuildPipelineOptions(),
-    const DelayEstimator* delay_estimator = nullptr);
+    const DelayEstimator* delay_estimator = nullptr,
+    PassResults* pass_results = nullptr);
 
 }  // namespace verilog
 }  // namespace xls
@@ -25,6 +25,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/substitute.h"
+#include "absl/time/time.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/common/status/matchers.h"
@@ -35,6 +36,7 @@
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
+#include "xls/passes/pass_base.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/run_pipeline_schedule.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -109,6 +111,36 @@ TEST_P(PipelineGeneratorTest, TrivialFunction) {
   EXPECT_EQ(result.signature.proto().pipeline().latency(), 2);
 }
 
+TEST_P(PipelineGeneratorTest, RecordsPassResults) {
+  Package package(TestBaseName());
+  FunctionBuilder fb(TestBaseName(), &package);
+  BValue x = fb.Param("x", package.GetBitsType(8));
+  BValue y = fb.Param("y", package.GetBitsType(8));
+  fb.Add(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(func, TestDelayEstimator(),
+                          SchedulingOptions().pipeline_stages(2)));
+
+  PassResults results;
+  XLS_ASSERT_OK(ToPipelineModuleText(
+                    schedule, func,
+                    BuildPipelineOptions().use_system_verilog(
+                        UseSystemVerilog()),
+                    /*delay_estimator=*/nullptr, &results)
+                    .status());
+
+  ASSERT_FALSE(results.invocations.empty());
+  for (const PassInvocation& invocation : results.invocations) {
+    EXPECT_FALSE(invocation.pass_name.empty());
+    EXPECT_GE(invocation.run_duration, absl::ZeroDuration());
+    EXPECT_GE(invocation.peak_rss_delta_bytes, 0);
+    EXPECT_GT(invocation.node_count_after, 0);
+  }
+}
+
 TEST_P(PipelineGeneratorTest, ReturnLiteral) {
   Package package(TestBaseName());
   FunctionBuilder fb(TestBaseName(), &package);
@@ -17,13 +17,19 @@
 #include <deque>
 #include <iterator>
 #include <list>
+#include <optional>
+#include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
 #include "xls/codegen/codegen_pass.h"
 #include "xls/codegen/concurrent_stage_groups.h"
+#include "xls/ir/node.h"
+#include "xls/ir/register.h"
 
 namespace xls::verilog {
 
@@ -56,62 +62,6 @@ bool IsClobbered(const RegisterData& chain_start,
   return false;
 }
 
-// Insert the register into a chain, return the chain that was inserted into
-std::list<std::deque<RegisterData>>::iterator InsertIntoChain(
-    std::list<std::deque<RegisterData>>& chains, const RegisterData& reg) {
-  for (auto it = chains.begin(); it != chains.end(); ++it) {
-    if (IsChainable(reg, it->front()) && !IsClobbered(reg, it->back())) {
-      // Can put it at the front of this.
-      it->push_front(reg);
-      return it;
-    }
-    if (IsChainable(it->back(), reg) && !IsClobbered(it->front(), reg)) {
-      // Can put it at the back of this chain.
-      it->push_back(reg);
-      return it;
-    }
-  }
-  // No compatible chain found.
-  chains.emplace_front().push_back(reg);
-  return chains.begin();
-}
-
-void ReduceChains(std::list<std::deque<RegisterData>>& chains,
-                  std::list<std::deque<RegisterData>>::iterator modified_entry,
-                  bool is_front_modified) {
-  // TODO(allight): b/c of the way we add stuff to chains we can skip to
-  // modified entry in the iteration probably. Needs some more thought. Rather
-  // small optimization in any case.
-  for (auto it = chains.begin(); it != chains.end(); ++it) {
-    if (it == modified_entry) {
-      // can't merge with ourself.
-      continue;
-    }
-    if (is_front_modified) {
-      // Want to perform `(merge it modified_entry)`
-      if (IsChainable(it->back(), modified_entry->front()) &&
-          !IsClobbered(it->front(), modified_entry->back())) {
-        absl::c_copy(*modified_entry, std::back_inserter(*it));
-        chains.erase(modified_entry);
-        VLOG(2) << "Merged chain now (len: " << it->size()
-                << "): " << it->front() << " -> " << it->back();
-        return;
-      }
-    } else {
-      // Want to perform `(merge modified_entry it)`
-      if (IsChainable(modified_entry->back(), it->front()) &&
-          !IsClobbered(modified_entry->front(), it->back())) {
-        absl::c_copy(*it, std::back_inserter(*modified_entry));
-        chains.erase(it);
-        VLOG(2) << "Merged chain now(len: " << modified_entry->size()
-                << "): " << modified_entry->front() << " -> "
-                << modified_entry->back();
-        return;
-      }
-    }
-  }
-}
-
 // Splits a chain of registers at the locations required by the register r/w and
 // concurrent stage information. This returns a list of all the (non-singleton)
 // chains that make up the original chain and are internally mutually exclusive,
@@ -139,20 +89,30 @@ std::vector<std::vector<RegisterData>> SplitOneChain(
     }
   };
 
+  // The distinct (read, write) stage pairs of the registers in
+  // results.back(). Mutual exclusion only depends on the stages so these are
+  // all that need to be checked, rather than every register of the group.
+  std::vector<std::pair<Stage, Stage>> group_stages;
   for (const auto& cur : chain) {
-    auto is_mutex_with_current = [&](const RegisterData& v) {
-      return groups.IsMutuallyExclusive(v.read_stage, cur.read_stage) &&
-             groups.IsMutuallyExclusive(v.write_stage, cur.write_stage);
+    auto is_mutex_with_current = [&](const std::pair<Stage, Stage>& stages) {
+      return groups.IsMutuallyExclusive(stages.first, cur.read_stage) &&
+             groups.IsMutuallyExclusive(stages.second, cur.write_stage);
     };
     // Can't merge up if (1) there's nothing to merge with, (2) the register
     // might be written concurrently, (3) there's some stage in the current
     // group we're not mutex with.
     if (results.empty() || is_read_write_concurrent(cur) ||
-        !absl::c_all_of(results.back(), is_mutex_with_current)) {
+        !absl::c_all_of(group_stages, is_mutex_with_current)) {
       maybe_remove_singleton();
       results.push_back({cur});
+      group_stages = {{cur.read_stage, cur.write_stage}};
     } else {
       results.back().push_back(cur);
+      if (!absl::c_linear_search(
+              group_stages,
+              std::make_pair(cur.read_stage, cur.write_stage))) {
+        group_stages.push_back({cur.read_stage, cur.write_stage});
+      }
     }
   }
   maybe_remove_singleton();
@@ -161,9 +121,131 @@ std::vector<std::vector<RegisterData>> SplitOneChain(
 
 }  // namespace
 
+void RegisterChains::AddToIndex(ChainIterator chain) {
+  chains_by_front_write_[chain->front().write->data()].push_back(chain);
+  chains_by_back_read_[chain->back().read].push_back(chain);
+}
+
+void RegisterChains::RemoveFromIndex(ChainIterator chain) {
+  auto remove = [&](absl::flat_hash_map<Node*, std::vector<ChainIterator>>&
+                        index,
+                    Node* key) {
+    auto it = index.find(key);
+    CHECK(it != index.end());
+    std::erase(it->second, chain);
+    if (it->second.empty()) {
+      index.erase(it);
+    }
+  };
+  remove(chains_by_front_write_, chain->front().write->data());
+  remove(chains_by_back_read_, chain->back().read);
+}
+
+template <typename Accept>
+std::optional<RegisterChains::ChainIterator> RegisterChains::FirstChain(
+    const absl::flat_hash_map<Node*, std::vector<ChainIterator>>& index,
+    Node* key, Accept accept) const {
+  std::optional<ChainIterator> first;
+  auto it = index.find(key);
+  if (it == index.end()) {
+    return std::nullopt;
+  }
+  for (ChainIterator chain : it->second) {
+    if ((!first.has_value() ||
+         chain_order_.at(&*chain) > chain_order_.at(&**first)) &&
+        accept(*chain)) {
+      first = chain;
+    }
+  }
+  return first;
+}
+
+RegisterChains::ChainIterator RegisterChains::InsertIntoChain(
+    const RegisterData& reg) {
+  // Use the first chain (in chains_ order) which the register can be put at
+  // either end of, preferring the front if both are possible.
+  std::optional<ChainIterator> front = FirstChain(
+      chains_by_front_write_, reg.read, [&](const Chain& chain) {
+        return IsChainable(reg, chain.front()) && !IsClobbered(reg, chain.back());
+      });
+  std::optional<ChainIterator> back = FirstChain(
+      chains_by_back_read_, reg.write->data(), [&](const Chain& chain) {
+        return IsChainable(chain.back(), reg) &&
+               !IsClobbered(chain.front(), reg);
+      });
+  if (front.has_value() &&
+      (!back.has_value() ||
+       chain_order_.at(&**front) >= chain_order_.at(&**back))) {
+    // Can put it at the front of this.
+    RemoveFromIndex(*front);
+    (*front)->push_front(reg);
+    AddToIndex(*front);
+    return *front;
+  }
+  if (back.has_value()) {
+    // Can put it at the back of this chain.
+    RemoveFromIndex(*back);
+    (*back)->push_back(reg);
+    AddToIndex(*back);
+    return *back;
+  }
+  // No compatible chain found.
+  chains_.emplace_front().push_back(reg);
+  chain_order_[&chains_.front()] = next_chain_order_++;
+  AddToIndex(chains_.begin());
+  return chains_.begin();
+}
+
+void RegisterChains::ReduceChains(ChainIterator modified_entry,
+                                  bool is_front_modified) {
+  auto is_other = [&](const Chain& chain) { return &chain != &*modified_entry; };
+  if (is_front_modified) {
+    // Want to perform `(merge it modified_entry)`
+    std::optional<ChainIterator> it = FirstChain(
+        chains_by_back_read_, modified_entry->front().write->data(),
+        [&](const Chain& chain) {
+          return is_other(chain) &&
+                 IsChainable(chain.back(), modified_entry->front()) &&
+                 !IsClobbered(chain.front(), modified_entry->back());
+        });
+    if (!it.has_value()) {
+      return;
+    }
+    RemoveFromIndex(*it);
+    RemoveFromIndex(modified_entry);
+    absl::c_copy(*modified_entry, std::back_inserter(**it));
+    chain_order_.erase(&*modified_entry);
+    chains_.erase(modified_entry);
+    AddToIndex(*it);
+    VLOG(2) << "Merged chain now (len: " << (*it)->size()
+            << "): " << (*it)->front() << " -> " << (*it)->back();
+    return;
+  }
+  // Want to perform `(merge modified_entry it)`
+  std::optional<ChainIterator> it = FirstChain(
+      chains_by_front_write_, modified_entry->back().read,
+      [&](const Chain& chain) {
+        return is_other(chain) &&
+               IsChainable(modified_entry->back(), chain.front()) &&
+               !IsClobbered(modified_entry->front(), chain.back());
+      });
+  if (!it.has_value()) {
+    return;
+  }
+  RemoveFromIndex(*it);
+  RemoveFromIndex(modified_entry);
+  absl::c_copy(**it, std::back_inserter(*modified_entry));
+  chain_order_.erase(&**it);
+  chains_.erase(*it);
+  AddToIndex(modified_entry);
+  VLOG(2) << "Merged chain now(len: " << modified_entry->size()
+          << "): " << modified_entry->front() << " -> "
+          << modified_entry->back();
+}
+
 void RegisterChains::InsertAndReduce(const RegisterData& data) {
   VLOG(2) << "Adding to chain " << data;
-  auto modified_entry = InsertIntoChain(chains_, data);
+  auto modified_entry = InsertIntoChain(data);
   if (modified_entry->size() == 1) {
     VLOG(2) << "Chain is singleton.";
     // Left as a singleton so nothing to merge (If a merge was possible the
@@ -174,7 +256,7 @@ void RegisterChains::InsertAndReduce(const RegisterData& data) {
           << "): " << modified_entry->front() << " -> "
           << modified_entry->back();
 
-  ReduceChains(chains_, modified_entry,
+  ReduceChains(modified_entry,
                /*is_front_modified=*/modified_entry->front() == data);
 }
 
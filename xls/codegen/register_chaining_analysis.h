@@ -15,12 +15,16 @@
 #ifndef XLS_CODEGEN_REGISTER_CHAINING_ANALYSIS_H_
 #define XLS_CODEGEN_REGISTER_CHAINING_ANALYSIS_H_
 
+#include <cstdint>
 #include <deque>
 #include <list>
+#include <optional>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "xls/codegen/codegen_pass.h"
+#include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/register.h"
 
@@ -104,8 +108,19 @@ inline bool operator==(const RegisterData& l, const RegisterData& r) {
 //     of le_1
 //   - the side-effecting operations S must be activated at or before the next
 //     assertion of le_0
+//
+// Chains are indexed by the registers at their ends so each insertion only
+// looks at the chains it can actually be chained with, making building the
+// chains near-linear in the number of registers.
 class RegisterChains {
  public:
+  RegisterChains() = default;
+  // The indices refer into chains_ so this can't be copied.
+  RegisterChains(const RegisterChains&) = delete;
+  RegisterChains& operator=(const RegisterChains&) = delete;
+  RegisterChains(RegisterChains&&) = default;
+  RegisterChains& operator=(RegisterChains&&) = default;
+
   // Add the given register into a chain if possible or create a new one.
   //
   // Once it is in a chain the chain set is reduced to produce as few chains as
@@ -123,7 +138,38 @@ class RegisterChains {
   const std::list<std::deque<RegisterData>>& chains() const { return chains_; }
 
  private:
-  std::list<std::deque<RegisterData>> chains_;
+  using Chain = std::deque<RegisterData>;
+  using ChainIterator = std::list<Chain>::iterator;
+
+  // Insert the register into a chain, return the chain that was inserted into.
+  ChainIterator InsertIntoChain(const RegisterData& reg);
+
+  // Merge the modified chain with another chain if possible.
+  void ReduceChains(ChainIterator modified_entry, bool is_front_modified);
+
+  void AddToIndex(ChainIterator chain);
+  void RemoveFromIndex(ChainIterator chain);
+
+  // Of the chains which 'accept' returns true for, the one which comes first in
+  // chains_ (i.e., the most recently created one), if any.
+  template <typename Accept>
+  std::optional<ChainIterator> FirstChain(
+      const absl::flat_hash_map<Node*, std::vector<ChainIterator>>& index,
+      Node* key, Accept accept) const;
+
+  std::list<Chain> chains_;
+
+  // Chains keyed by the value written into their first register and by the
+  // read of their last register, respectively. A register can only go in front
+  // of a chain whose first register writes its read, and behind a chain whose
+  // last read it writes.
+  absl::flat_hash_map<Node*, std::vector<ChainIterator>> chains_by_front_write_;
+  absl::flat_hash_map<Node*, std::vector<ChainIterator>> chains_by_back_read_;
+
+  // Creation order of each chain. New chains are added at the front of
+  // chains_, so later chains are earlier in the list.
+  absl::flat_hash_map<const Chain*, int64_t> chain_order_;
+  int64_t next_chain_order_ = 0;
 };
 }  // namespace xls::verilog
 
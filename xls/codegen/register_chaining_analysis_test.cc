@@ -17,8 +17,11 @@
 #include <array>
 #include <cstdint>
 #include <optional>
+#include <string>
 #include <string_view>
+#include <vector>
 
+#include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/algorithm/container.h"
@@ -1264,5 +1267,46 @@ TEST_F(RegisterChainingAnalysisTest, MutexLoopbackContinues) {
       check_mutex);
 }
 
+// A block with `state.range(0)` independent pipelines, each with a register in
+// every one of `state.range(1)` stages. The registers are inserted stage by
+// stage as RegisterCombiningPass does.
+void BM_InsertAndReduce(benchmark::State& state) {
+  const int64_t pipeline_count = state.range(0);
+  const int64_t stage_count = state.range(1);
+  Package p("register_chains_benchmark");
+  BlockBuilder bb("pipelines", &p);
+  XLS_ASSERT_OK(bb.AddClockPort("clk"));
+  std::vector<RegisterData> registers(pipeline_count * stage_count);
+  for (int64_t i = 0; i < pipeline_count; ++i) {
+    BValue value =
+        bb.InputPort(absl::StrFormat("in_%d", i), p.GetBitsType(32));
+    for (int64_t stage = 0; stage < stage_count; ++stage) {
+      std::string name = absl::StrFormat("reg_%d_%d", i, stage);
+      value = bb.InsertRegister(name, value);
+      XLS_ASSERT_OK_AND_ASSIGN(Register * reg, bb.block()->GetRegister(name));
+      XLS_ASSERT_OK_AND_ASSIGN(RegisterWrite * write,
+                               bb.block()->GetRegisterWrite(reg));
+      registers[stage * pipeline_count + i] =
+          RegisterData{.reg = reg,
+                       .read = value.node()->As<RegisterRead>(),
+                       .read_stage = stage + 1,
+                       .write = write,
+                       .write_stage = stage};
+    }
+    bb.OutputPort(absl::StrFormat("out_%d", i), value);
+  }
+  XLS_ASSERT_OK(bb.Build().status());
+
+  for (auto _ : state) {
+    RegisterChains chains;
+    for (const RegisterData& reg : registers) {
+      chains.InsertAndReduce(reg);
+    }
+    benchmark::DoNotOptimize(chains.chains());
+  }
+}
+
+BENCHMARK(BM_InsertAndReduce)->RangePair(1, 4096, 2, 64);
+
 }  // namespace
 }  // namespace xls::verilog
@@ -36,8 +36,12 @@
 namespace xls::verilog {
 
 namespace {
+// Merges the registers of the group into its first register. The removed
+// registers are added to 'removed_regs' so that the metadata can be updated for
+// all groups at once.
 absl::Status CombineRegisters(absl::Span<const RegisterData> mutex_group,
-                              Block* block, CodegenMetadata& metadata) {
+                              Block* block,
+                              absl::flat_hash_set<Register*>& removed_regs) {
   XLS_RET_CHECK_GE(mutex_group.size(), 2)
       << "Attempting to combine a single register is not meaningful. Single "
          "element mutex groups should have been filtered out.";
@@ -61,24 +65,30 @@ absl::Status CombineRegisters(absl::Span<const RegisterData> mutex_group,
   }
 
   // Do cleanup.
-  for (auto& stage : metadata.streaming_io_and_pipeline.pipeline_registers) {
-    std::erase_if(stage, [&](const PipelineRegister& pr) {
-      return cleanup_regs.contains(pr.reg);
-    });
-  }
-  for (auto& state_reg : metadata.streaming_io_and_pipeline.state_registers) {
-    CHECK(!state_reg || !cleanup_regs.contains(state_reg->reg))
-        << "Removed a state register: " << state_reg->reg->ToString();
-  }
   for (Node* n : cleanup_nodes) {
     XLS_RETURN_IF_ERROR(block->RemoveNode(n)) << "can't remove " << n;
   }
   for (Register* r : cleanup_regs) {
     XLS_RETURN_IF_ERROR(block->RemoveRegister(r));
   }
+  removed_regs.insert(cleanup_regs.begin(), cleanup_regs.end());
   return absl::OkStatus();
 }
 
+// Removes the metadata of the registers removed by CombineRegisters.
+void RemoveRegisterMetadata(const absl::flat_hash_set<Register*>& removed_regs,
+                            CodegenMetadata& metadata) {
+  for (auto& stage : metadata.streaming_io_and_pipeline.pipeline_registers) {
+    std::erase_if(stage, [&](const PipelineRegister& pr) {
+      return removed_regs.contains(pr.reg);
+    });
+  }
+  for (auto& state_reg : metadata.streaming_io_and_pipeline.state_registers) {
+    CHECK(!state_reg || !removed_regs.contains(state_reg->reg))
+        << "Removed a state register: " << state_reg->reg->ToString();
+  }
+}
+
 absl::StatusOr<bool> RunOnBlock(Block* block, CodegenMetadata& metadata,
                                 const CodegenPassOptions& options) {
   if (options.codegen_options.register_merge_strategy() ==
@@ -153,9 +163,11 @@ absl::StatusOr<bool> RunOnBlock(Block* block, CodegenMetadata& metadata,
                            *metadata.concurrent_stages, options));
   bool changed = !mutex_chains.empty();
 
+  absl::flat_hash_set<Register*> removed_regs;
   for (const std::vector<RegisterData>& group : mutex_chains) {
-    XLS_RETURN_IF_ERROR(CombineRegisters(group, block, metadata));
+    XLS_RETURN_IF_ERROR(CombineRegisters(group, block, removed_regs));
   }
+  RemoveRegisterMetadata(removed_regs, metadata);
 
   return changed;
 }
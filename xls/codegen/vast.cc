@@ -17,6 +17,8 @@
 #include <algorithm>
 #include <cstdint>
 #include <optional>
+#include <ostream>
+#include <sstream>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -273,6 +275,42 @@ std::optional<std::vector<LineSpan>> LineInfo::LookupNode(
   return spans_.at(node).completed_spans;
 }
 
+void VastSink::Write(std::string_view text) {
+  while (!text.empty()) {
+    if (at_line_start_) {
+      if (text.front() == '\n') {
+        if (!drop_blank_lines_) {
+          os_ << '\n';
+        }
+        text.remove_prefix(1);
+        continue;
+      }
+      os_ << std::string(indent_level_ * kDefaultIndentSpaces, ' ');
+      at_line_start_ = false;
+      drop_blank_lines_ = false;
+    }
+    size_t newline = text.find('\n');
+    if (newline == std::string_view::npos) {
+      os_ << text;
+      return;
+    }
+    os_ << text.substr(0, newline + 1);
+    text.remove_prefix(newline + 1);
+    at_line_start_ = true;
+  }
+}
+
+void VastSink::Indent() {
+  ++indent_level_;
+  drop_blank_lines_ = true;
+}
+
+void VastSink::Dedent() {
+  CHECK_GT(indent_level_, 0);
+  --indent_level_;
+  drop_blank_lines_ = false;
+}
+
 std::string SanitizeIdentifier(std::string_view name) {
   if (name.empty()) {
     return "_";
@@ -383,16 +421,23 @@ UnpackedArrayType* VerilogFile::UnpackedArrayType(
 }
 
 std::string VerilogFile::Emit(LineInfo* line_info) const {
-  auto file_member_str = [=](const FileMember& member) -> std::string {
-    return absl::visit([=](auto* m) { return m->Emit(line_info); }, member);
-  };
+  std::ostringstream os;
+  Emit(os, line_info);
+  return os.str();
+}
 
-  std::string out;
+void VerilogFile::Emit(std::ostream& os, LineInfo* line_info) const {
+  VastSink sink(os);
   for (const FileMember& member : members_) {
-    absl::StrAppend(&out, file_member_str(member), "\n");
+    if (std::holds_alternative<Module*>(member)) {
+      std::get<Module*>(member)->Emit(sink, line_info);
+    } else {
+      sink.Write(
+          absl::visit([=](auto* m) { return m->Emit(line_info); }, member));
+    }
+    sink.Write("\n");
     LineInfoIncrease(line_info, 1);
   }
-  return out;
 }
 
 LocalParamItemRef* LocalParam::AddItem(std::string_view name, Expression* value,
@@ -911,22 +956,36 @@ std::string EmitVerilogPackageMember(LineInfo* line_info,
 }  // namespace
 
 std::string ModuleSection::Emit(LineInfo* line_info) const {
+  std::ostringstream os;
+  VastSink sink(os);
+  Emit(sink, line_info);
+  return os.str();
+}
+
+void ModuleSection::Emit(VastSink& sink, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::vector<std::string> elements;
+  bool first = true;
   for (const ModuleMember& member : members_) {
     if (std::holds_alternative<ModuleSection*>(member)) {
       if (std::get<ModuleSection*>(member)->members_.empty()) {
         continue;
       }
     }
-    elements.push_back(EmitModuleMember(line_info, member));
+    if (!first) {
+      sink.Write("\n");
+    }
+    first = false;
+    if (std::holds_alternative<ModuleSection*>(member)) {
+      std::get<ModuleSection*>(member)->Emit(sink, line_info);
+    } else {
+      sink.Write(EmitModuleMember(line_info, member));
+    }
     LineInfoIncrease(line_info, 1);
   }
-  if (!elements.empty()) {
+  if (!first) {
     LineInfoIncrease(line_info, -1);
   }
   LineInfoEnd(line_info, this);
-  return absl::StrJoin(elements, "\n");
 }
 
 std::string VerilogPackageSection::Emit(LineInfo* line_info) const {
@@ -1084,29 +1143,39 @@ std::string SystemFunctionCall::Emit(LineInfo* line_info) const {
 }
 
 std::string Module::Emit(LineInfo* line_info) const {
+  std::ostringstream os;
+  VastSink sink(os);
+  Emit(sink, line_info);
+  return os.str();
+}
+
+void Module::Emit(VastSink& sink, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::string result = absl::StrCat("module ", name_);
+  sink.Write(absl::StrCat("module ", name_));
   if (ports_.empty()) {
-    absl::StrAppend(&result, ";\n");
+    sink.Write(";\n");
     LineInfoIncrease(line_info, 1);
   } else {
-    absl::StrAppend(&result, "(\n  ");
+    sink.Write("(\n  ");
     LineInfoIncrease(line_info, 1);
-    absl::StrAppend(
-        &result,
-        absl::StrJoin(ports_, ",\n  ", [=](std::string* out, const Port& port) {
-          absl::StrAppendFormat(out, "%s %s", ToString(port.direction),
-                                port.wire->EmitNoSemi(line_info));
-          LineInfoIncrease(line_info, 1);
-        }));
-    absl::StrAppend(&result, "\n);\n");
+    for (int64_t i = 0; i < ports_.size(); ++i) {
+      if (i != 0) {
+        sink.Write(",\n  ");
+      }
+      sink.Write(absl::StrFormat("%s %s", ToString(ports_[i].direction),
+                                 ports_[i].wire->EmitNoSemi(line_info)));
+      LineInfoIncrease(line_info, 1);
+    }
+    sink.Write("\n);\n");
     LineInfoIncrease(line_info, 1);
   }
-  absl::StrAppend(&result, Indent(top_.Emit(line_info)), "\n");
+  sink.Indent();
+  top_.Emit(sink, line_info);
+  sink.Dedent();
+  sink.Write("\n");
   LineInfoIncrease(line_info, 1);
-  absl::StrAppend(&result, "endmodule");
+  sink.Write("endmodule");
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 std::string VerilogPackage::Emit(LineInfo* line_info) const {
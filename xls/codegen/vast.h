@@ -152,6 +152,29 @@ class LineInfo {
   absl::flat_hash_map<const VastNode*, PartialLineSpans> spans_;
 };
 
+// An output sink for streaming emission of VAST. Text written to the sink is
+// indented by the current indentation level, with the same conventions as
+// xls::Indent: empty lines are not indented and blank lines at the start of an
+// indented region are dropped. Streaming avoids materializing (and repeatedly
+// copying and re-indenting) the text of large constructs such as modules.
+class VastSink {
+ public:
+  explicit VastSink(std::ostream& os) : os_(os) {}
+
+  // Writes the given text to the sink, indenting each line.
+  void Write(std::string_view text);
+
+  // Begins and ends a region indented by one more level.
+  void Indent();
+  void Dedent();
+
+ private:
+  std::ostream& os_;
+  int64_t indent_level_ = 0;
+  bool at_line_start_ = true;
+  bool drop_blank_lines_ = false;
+};
+
 // Returns a sanitized identifier string based on the given name. Invalid
 // characters are replaced with '_'.
 std::string SanitizeIdentifier(std::string_view name);
@@ -2123,6 +2146,7 @@ class ModuleSection : public VastNode {
   const std::vector<ModuleMember>& members() const { return members_; }
 
   std::string Emit(LineInfo* line_info) const override;
+  void Emit(VastSink& sink, LineInfo* line_info) const;
 
  private:
   std::vector<ModuleMember> members_;
@@ -2193,6 +2217,7 @@ class Module : public VastNode {
   const std::string& name() const { return name_; }
 
   std::string Emit(LineInfo* line_info) const override;
+  void Emit(VastSink& sink, LineInfo* line_info) const;
 
  private:
   // Add the given Def as a port on the module.
@@ -2345,6 +2370,9 @@ class VerilogFile {
   }
 
   std::string Emit(LineInfo* line_info = nullptr) const;
+  // Streams the emitted file to `os`. Modules are written member by member
+  // rather than being built up as a single string.
+  void Emit(std::ostream& os, LineInfo* line_info = nullptr) const;
 
   verilog::Slice* Slice(IndexableExpression* subject, Expression* hi,
                         Expression* lo, const SourceInfo& loc) {
@@ -15,6 +15,7 @@
 #include "xls/codegen/vast.h"
 
 #include <optional>
+#include <sstream>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -2042,6 +2043,47 @@ endpackage)");
             std::vector<LineSpan>{LineSpan(3, 3)});
 }
 
+TEST_P(VastTest, StreamedModuleMatchesEmit) {
+  VerilogFile f(GetFileType());
+  Module* module = f.AddModule("my_module", SourceInfo());
+  LogicRef* a =
+      module->AddInput("a", f.BitVectorType(8, SourceInfo()), SourceInfo());
+  LogicRef* b =
+      module->AddOutput("b", f.BitVectorType(8, SourceInfo()), SourceInfo());
+  // A leading blank line in the module body is dropped when indenting.
+  module->Add<BlankLine>(SourceInfo());
+  ModuleSection* section = module->Add<ModuleSection>(SourceInfo());
+  section->Add<Comment>(SourceInfo(), "in a section");
+  section->Add<BlankLine>(SourceInfo());
+  module->Add<ContinuousAssignment>(SourceInfo(), b, a);
+  f.Add(f.Make<BlankLine>(SourceInfo()));
+  f.AddModule("empty_module", SourceInfo());
+
+  std::ostringstream os;
+  LineInfo line_info;
+  f.Emit(os, &line_info);
+  EXPECT_EQ(os.str(),
+            R"(module my_module(
+  input wire [7:0] a,
+  output wire [7:0] b
+);
+  // in a section
+
+  assign b = a;
+endmodule
+
+module empty_module;
+
+endmodule
+)");
+  LineInfo string_line_info;
+  EXPECT_EQ(os.str(), f.Emit(&string_line_info));
+  EXPECT_EQ(line_info.LookupNode(module),
+            string_line_info.LookupNode(module));
+  EXPECT_EQ(line_info.LookupNode(section),
+            string_line_info.LookupNode(section));
+}
+
 INSTANTIATE_TEST_SUITE_P(VastTestInstantiation, VastTest,
                          testing::Values(false, true),
                          [](const testing::TestParamInfo<bool>& info) {
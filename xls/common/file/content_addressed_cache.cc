@@ -0,0 +1,107 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/common/file/content_addressed_cache.h"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+
+/* static */ absl::StatusOr<ContentAddressedCache>
+ContentAddressedCache::Create(const std::filesystem::path& directory,
+                              std::string_view extension,
+                              std::string_view description) {
+  if (directory.empty()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Directory of the %s is empty", description));
+  }
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory));
+  return ContentAddressedCache(directory, std::string(extension),
+                               std::string(description));
+}
+
+/* static */ std::string ContentAddressedCache::ComputeKey(
+    absl::Span<const std::string_view> components) {
+  std::string preimage;
+  for (std::string_view component : components) {
+    absl::StrAppend(&preimage, component.size(), ":", component, ";");
+  }
+  return Sha256Hex(preimage);
+}
+
+/* static */ std::string ContentAddressedCache::Sha256Hex(
+    std::string_view data) {
+  std::array<uint8_t, SHA256_DIGEST_LENGTH> digest;
+  SHA256(reinterpret_cast<const uint8_t*>(data.data()), data.size(),
+         digest.data());
+  return absl::BytesToHexString(std::string_view(
+      reinterpret_cast<const char*>(digest.data()), digest.size()));
+}
+
+std::filesystem::path ContentAddressedCache::GetPath(
+    std::string_view key) const {
+  return directory_ / absl::StrCat(key, extension_);
+}
+
+absl::StatusOr<std::optional<std::string>> ContentAddressedCache::Lookup(
+    std::string_view key) const {
+  std::filesystem::path path = GetPath(key);
+  absl::Status exists = FileExists(path);
+  if (absl::IsNotFound(exists)) {
+    return std::nullopt;
+  }
+  XLS_RETURN_IF_ERROR(exists);
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+  return contents;
+}
+
+absl::Status ContentAddressedCache::Insert(std::string_view key,
+                                           std::string_view contents) {
+  // Write to a uniquely named temporary file and rename it into place so
+  // concurrent readers never observe a partially written entry.
+  absl::BitGen bitgen;
+  std::filesystem::path temp_path =
+      directory_ / absl::StrFormat("%s.%016x.tmp", key,
+                                   absl::Uniform<uint64_t>(bitgen));
+  XLS_RETURN_IF_ERROR(SetFileContents(temp_path, contents));
+  std::error_code ec;
+  std::filesystem::rename(temp_path, GetPath(key), ec);
+  if (ec) {
+    std::filesystem::remove(temp_path, ec);
+    return absl::InternalError(
+        absl::StrFormat("Unable to add `%s` to %s in %s: %s", key, description_,
+                        directory_.string(), ec.message()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls
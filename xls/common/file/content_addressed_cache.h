@@ -0,0 +1,85 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_COMMON_FILE_CONTENT_ADDRESSED_CACHE_H_
+#define XLS_COMMON_FILE_CONTENT_ADDRESSED_CACHE_H_
+
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+
+namespace xls {
+
+// A persistent, content-addressed store of byte strings in a directory on
+// disk. Each entry is named by a key which is a hash of everything that affects
+// its contents (see ComputeKey) and is stored in the file
+// `<directory>/<key><extension>`.
+// This is the storage shared by the typed on-disk caches of compilation results
+// (e.g. JitObjectCache), which supply the key material and the serialization of
+// their entries.
+//
+// The directory may be shared by multiple processes. Entries are written
+// atomically (write to a temporary file then rename) and are never modified
+// once written, so readers never observe a partially written entry.
+class ContentAddressedCache {
+ public:
+  // Creates a cache backed by `directory`, creating the directory if it does
+  // not exist. Entries are stored in files ending in `extension` (e.g. ".o").
+  // `description` names the cache in error messages (e.g. "JIT object cache").
+  static absl::StatusOr<ContentAddressedCache> Create(
+      const std::filesystem::path& directory, std::string_view extension,
+      std::string_view description);
+
+  // Returns the key for an entry determined by `components`: the hex-encoded
+  // SHA-256 digest of the components, each length-prefixed so that distinct
+  // lists of components never produce the same byte stream.
+  static std::string ComputeKey(absl::Span<const std::string_view> components);
+
+  // Returns the hex-encoded SHA-256 digest of `data`.
+  static std::string Sha256Hex(std::string_view data);
+
+  // Returns the contents of the entry for `key` or std::nullopt if there is
+  // none.
+  absl::StatusOr<std::optional<std::string>> Lookup(std::string_view key) const;
+
+  // Stores `contents` under `key`, replacing any existing entry.
+  absl::Status Insert(std::string_view key, std::string_view contents);
+
+  // Returns the path of the file holding the entry for `key`.
+  std::filesystem::path GetPath(std::string_view key) const;
+
+  const std::filesystem::path& directory() const { return directory_; }
+
+ private:
+  ContentAddressedCache(std::filesystem::path directory, std::string extension,
+                        std::string description)
+      : directory_(std::move(directory)),
+        extension_(std::move(extension)),
+        description_(std::move(description)) {}
+
+  std::filesystem::path directory_;
+  std::string extension_;
+  std::string description_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_FILE_CONTENT_ADDRESSED_CACHE_H_
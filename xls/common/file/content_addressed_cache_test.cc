@@ -0,0 +1,98 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/common/file/content_addressed_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using testing::Optional;
+
+TEST(ContentAddressedCacheTest, KeyDependsOnAllComponents) {
+  std::string key = ContentAddressedCache::ComputeKey({"a", "b"});
+  EXPECT_EQ(key, ContentAddressedCache::ComputeKey({"a", "b"}));
+  EXPECT_EQ(key.size(), 64);
+  EXPECT_NE(key, ContentAddressedCache::ComputeKey({"a", "c"}));
+  EXPECT_NE(key, ContentAddressedCache::ComputeKey({"b", "a"}));
+  EXPECT_NE(key, ContentAddressedCache::ComputeKey({"a", "b", ""}));
+  // Components are length-prefixed so moving characters between them changes
+  // the key.
+  EXPECT_NE(key, ContentAddressedCache::ComputeKey({"ab", ""}));
+  EXPECT_NE(key, ContentAddressedCache::ComputeKey({"ab"}));
+}
+
+TEST(ContentAddressedCacheTest, Sha256Hex) {
+  EXPECT_EQ(
+      ContentAddressedCache::Sha256Hex(""),
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+}
+
+TEST(ContentAddressedCacheTest, EmptyDirectoryIsRejected) {
+  EXPECT_THAT(ContentAddressedCache::Create("", ".o", "test cache"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(ContentAddressedCacheTest, InsertAndLookup) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ContentAddressedCache cache,
+      ContentAddressedCache::Create(temp_dir.path() / "cache", ".entry",
+                                    "test cache"));
+  std::string key = ContentAddressedCache::ComputeKey({"contents"});
+  EXPECT_THAT(cache.Lookup(key), IsOkAndHolds(std::nullopt));
+  XLS_ASSERT_OK(cache.Insert(key, "contents"));
+  EXPECT_THAT(cache.Lookup(key),
+              IsOkAndHolds(Optional(std::string("contents"))));
+  EXPECT_EQ(cache.GetPath(key), temp_dir.path() / "cache" / (key + ".entry"));
+
+  // Inserting again replaces the entry.
+  XLS_ASSERT_OK(cache.Insert(key, "new contents"));
+  EXPECT_THAT(cache.Lookup(key),
+              IsOkAndHolds(Optional(std::string("new contents"))));
+}
+
+TEST(ContentAddressedCacheTest, InsertLeavesNoTemporaryFiles) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ContentAddressedCache cache,
+      ContentAddressedCache::Create(temp_dir.path(), ".entry", "test cache"));
+  for (int64_t i = 0; i < 3; ++i) {
+    std::string key = ContentAddressedCache::ComputeKey({std::to_string(i)});
+    XLS_ASSERT_OK(cache.Insert(key, "contents"));
+  }
+  int64_t entries = 0;
+  for (const auto& entry :
+       std::filesystem::directory_iterator(cache.directory())) {
+    EXPECT_EQ(entry.path().extension(), ".entry") << entry.path();
+    ++entries;
+  }
+  EXPECT_EQ(entries, 3);
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,58 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_FILE_MAPPED_FILE_H_
+#define XLS_COMMON_FILE_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <filesystem>  // NOLINT
+#include <string_view>
+
+#include "absl/status/statusor.h"
+
+namespace xls {
+
+// RAII wrapper around a read-only memory mapping of an entire file. This lets
+// large inputs (e.g. IR text) be consumed in place as a string_view without
+// copying them into memory first; pages are faulted in as they are read.
+class MappedFile {
+ public:
+  ~MappedFile();
+
+  // Maps the file at `path`. Empty files are supported and produce an empty
+  // view.
+  static absl::StatusOr<MappedFile> Open(const std::filesystem::path& path);
+
+  // The contents of the file. Only valid for the lifetime of this object.
+  std::string_view contents() const {
+    return std::string_view(static_cast<const char*>(data_), size_);
+  }
+
+  // MappedFile is movable but not copyable.
+  MappedFile(MappedFile&& other);
+  MappedFile& operator=(MappedFile&& other);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+ private:
+  MappedFile(void* data, size_t size) : data_(data), size_(size) {}
+  void Unmap();
+
+  void* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_FILE_MAPPED_FILE_H_
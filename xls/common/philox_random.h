@@ -0,0 +1,129 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_COMMON_PHILOX_RANDOM_H_
+#define XLS_COMMON_PHILOX_RANDOM_H_
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "absl/types/span.h"
+
+namespace xls {
+
+// A counter-based pseudo-random number generator: Philox-4x32-10 from Salmon
+// et al., "Parallel Random Numbers: As Easy as 1, 2, 3" (SC'11).
+//
+// Each output block is a keyed bijection of a counter, so there is no state
+// beyond the counter and any element of a sequence can be generated directly.
+// The generator is keyed by `seed` and the counter is split into a 64-bit
+// `stream`, a 32-bit `lane` and a 32-bit position within the stream. This
+// makes it cheap to give every item of a large batch (e.g. the i-th sample of
+// a quickcheck or fuzz run) its own reproducible sequence, independent of the
+// order or thread in which the items are generated:
+//
+//   PhiloxRandom rng(seed, /*stream=*/sample_index);
+//
+// Satisfies the UniformRandomBitGenerator requirements so it can be used with
+// absl::BitGenRef and the absl/std distributions.
+class PhiloxRandom {
+ public:
+  using result_type = uint64_t;
+
+  explicit PhiloxRandom(uint64_t seed, uint64_t stream = 0, uint32_t lane = 0)
+      : key_{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)},
+        counter_{0, lane, static_cast<uint32_t>(stream),
+                 static_cast<uint32_t>(stream >> 32)} {}
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()() {
+    if (buffer_index_ == kBlockBytes) {
+      Refill();
+    }
+    result_type result;
+    std::memcpy(&result, block_bytes() + buffer_index_, sizeof(result));
+    buffer_index_ += sizeof(result);
+    return result;
+  }
+
+  // Fills `bytes` with random bytes, continuing the sequence. Consumes whole
+  // 64-bit words so interleaving with operator() is well defined.
+  void Fill(absl::Span<uint8_t> bytes) {
+    uint8_t* data = bytes.data();
+    int64_t remaining = bytes.size();
+    while (remaining > 0) {
+      if (buffer_index_ == kBlockBytes) {
+        Refill();
+      }
+      int64_t available = kBlockBytes - buffer_index_;
+      int64_t n = remaining < available ? remaining : available;
+      std::memcpy(data, block_bytes() + buffer_index_, n);
+      data += n;
+      remaining -= n;
+      // Round up to the next word.
+      buffer_index_ += (n + sizeof(result_type) - 1) /
+                       sizeof(result_type) * sizeof(result_type);
+    }
+  }
+
+  // Returns the Philox-4x32-10 block for the given counter and key.
+  static std::array<uint32_t, 4> Block(std::array<uint32_t, 4> counter,
+                                       std::array<uint32_t, 2> key) {
+    constexpr uint64_t kMultiplier0 = 0xD2511F53;
+    constexpr uint64_t kMultiplier1 = 0xCD9E8D57;
+    constexpr uint32_t kWeyl0 = 0x9E3779B9;
+    constexpr uint32_t kWeyl1 = 0xBB67AE85;
+    for (int64_t round = 0; round < 10; ++round) {
+      uint64_t product0 = kMultiplier0 * counter[0];
+      uint64_t product1 = kMultiplier1 * counter[2];
+      counter = {static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                 static_cast<uint32_t>(product1),
+                 static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                 static_cast<uint32_t>(product0)};
+      key[0] += kWeyl0;
+      key[1] += kWeyl1;
+    }
+    return counter;
+  }
+
+ private:
+  static constexpr int64_t kBlockBytes = sizeof(std::array<uint32_t, 4>);
+
+  const uint8_t* block_bytes() const {
+    return reinterpret_cast<const uint8_t*>(block_.data());
+  }
+
+  void Refill() {
+    block_ = Block(counter_, key_);
+    ++counter_[0];
+    buffer_index_ = 0;
+  }
+
+  std::array<uint32_t, 2> key_;
+  // {position, lane, stream low, stream high}.
+  std::array<uint32_t, 4> counter_;
+  std::array<uint32_t, 4> block_ = {};
+  int64_t buffer_index_ = kBlockBytes;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_PHILOX_RANDOM_H_
@@ -0,0 +1,108 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/common/philox_random.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/random/bit_gen_ref.h"
+#include "absl/random/distributions.h"
+#include "absl/types/span.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Known answers from the Random123 distribution (kat_vectors).
+TEST(PhiloxRandomTest, KnownAnswers) {
+  EXPECT_THAT(PhiloxRandom::Block({0, 0, 0, 0}, {0, 0}),
+              ElementsAre(0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8));
+  EXPECT_THAT(PhiloxRandom::Block({0xffffffff, 0xffffffff, 0xffffffff,
+                                   0xffffffff},
+                                  {0xffffffff, 0xffffffff}),
+              ElementsAre(0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd));
+  EXPECT_THAT(PhiloxRandom::Block({0x243f6a88, 0x85a308d3, 0x13198a2e,
+                                   0x03707344},
+                                  {0xa4093822, 0x299f31d0}),
+              ElementsAre(0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1));
+}
+
+TEST(PhiloxRandomTest, SequenceIsTheBlocksOfTheCounter) {
+  PhiloxRandom rng(/*seed=*/0);
+  std::array<uint32_t, 4> block = PhiloxRandom::Block({0, 0, 0, 0}, {0, 0});
+  uint64_t expected[2];
+  std::memcpy(expected, block.data(), sizeof(expected));
+  EXPECT_EQ(rng(), expected[0]);
+  EXPECT_EQ(rng(), expected[1]);
+  block = PhiloxRandom::Block({1, 0, 0, 0}, {0, 0});
+  std::memcpy(expected, block.data(), sizeof(expected));
+  EXPECT_EQ(rng(), expected[0]);
+}
+
+TEST(PhiloxRandomTest, StreamsAreReproducibleAndDistinct) {
+  absl::flat_hash_set<uint64_t> firsts;
+  for (uint64_t stream = 0; stream < 1000; ++stream) {
+    PhiloxRandom a(/*seed=*/42, stream);
+    PhiloxRandom b(/*seed=*/42, stream);
+    for (int64_t i = 0; i < 5; ++i) {
+      uint64_t value = a();
+      EXPECT_EQ(value, b());
+      if (i == 0) {
+        EXPECT_TRUE(firsts.insert(value).second) << stream;
+      }
+    }
+  }
+  EXPECT_NE(PhiloxRandom(42, 0, /*lane=*/0)(), PhiloxRandom(42, 0, 1)());
+  EXPECT_NE(PhiloxRandom(42, 0)(), PhiloxRandom(43, 0)());
+}
+
+TEST(PhiloxRandomTest, FillConsumesWholeWords) {
+  PhiloxRandom words(/*seed=*/7, /*stream=*/3);
+  std::vector<uint64_t> expected;
+  for (int64_t i = 0; i < 6; ++i) {
+    expected.push_back(words());
+  }
+
+  PhiloxRandom bytes(/*seed=*/7, /*stream=*/3);
+  std::vector<uint8_t> buffer(20);
+  bytes.Fill(absl::MakeSpan(buffer));
+  EXPECT_EQ(std::memcmp(buffer.data(), expected.data(), buffer.size()), 0);
+  // 20 bytes consume three words.
+  EXPECT_EQ(bytes(), expected[3]);
+  buffer.resize(3);
+  bytes.Fill(absl::MakeSpan(buffer));
+  EXPECT_EQ(std::memcmp(buffer.data(), &expected[4], buffer.size()), 0);
+  EXPECT_EQ(bytes(), expected[5]);
+}
+
+TEST(PhiloxRandomTest, WorksWithDistributions) {
+  PhiloxRandom rng(/*seed=*/1);
+  absl::BitGenRef ref(rng);
+  for (int64_t i = 0; i < 100; ++i) {
+    int64_t value = absl::Uniform<int64_t>(ref, 10, 20);
+    EXPECT_GE(value, 10);
+    EXPECT_LT(value, 20);
+  }
+}
+
+}  // namespace
+}  // namespace xls
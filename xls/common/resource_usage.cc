@@ -0,0 +1,51 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/resource_usage.h"
+
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include <cstdint>
+
+#include "absl/time/time.h"
+
+namespace xls {
+namespace {
+
+absl::Duration TimevalToDuration(const struct timeval& tv) {
+  return absl::Seconds(tv.tv_sec) + absl::Microseconds(tv.tv_usec);
+}
+
+}  // namespace
+
+ResourceUsage GetResourceUsage() {
+  ResourceUsage usage;
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) != 0) {
+    return usage;
+  }
+  usage.cpu_time =
+      TimevalToDuration(ru.ru_utime) + TimevalToDuration(ru.ru_stime);
+#ifdef __APPLE__
+  // ru_maxrss is in bytes on macOS...
+  usage.peak_rss_bytes = static_cast<int64_t>(ru.ru_maxrss);
+#else
+  // ... and in kilobytes elsewhere.
+  usage.peak_rss_bytes = static_cast<int64_t>(ru.ru_maxrss) * 1024;
+#endif
+  return usage;
+}
+
+}  // namespace xls
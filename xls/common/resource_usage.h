@@ -0,0 +1,40 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_RESOURCE_USAGE_H_
+#define XLS_COMMON_RESOURCE_USAGE_H_
+
+#include <cstdint>
+
+#include "absl/time/time.h"
+
+namespace xls {
+
+// A snapshot of the resources consumed by the current process.
+struct ResourceUsage {
+  // Total CPU time (user + system) consumed by all threads of the process.
+  absl::Duration cpu_time;
+
+  // Peak resident set size of the process in bytes. This is a high-water mark
+  // so it never decreases over the lifetime of the process.
+  int64_t peak_rss_bytes = 0;
+};
+
+// Returns the resources consumed by the process so far. Fields which cannot be
+// determined on the host are left at zero.
+ResourceUsage GetResourceUsage();
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_RESOURCE_USAGE_H_
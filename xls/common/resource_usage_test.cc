@@ -0,0 +1,45 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/resource_usage.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+
+namespace xls {
+namespace {
+
+TEST(ResourceUsageTest, IsMonotonic) {
+  ResourceUsage before = GetResourceUsage();
+  EXPECT_GT(before.peak_rss_bytes, 0);
+
+  // Burn some CPU and touch some memory.
+  std::vector<int64_t> data(1 << 20);
+  int64_t sum = 0;
+  for (int64_t i = 0; i < data.size(); ++i) {
+    data[i] = i * i;
+    sum += data[i];
+  }
+  EXPECT_NE(sum, 0);
+
+  ResourceUsage after = GetResourceUsage();
+  EXPECT_GE(after.cpu_time, before.cpu_time);
+  EXPECT_GE(after.peak_rss_bytes, before.peak_rss_bytes);
+}
+
+}  // namespace
+}  // namespace xls
@@ -27,6 +27,7 @@
 #include <cstring>
 #include <ctime>
 #include <filesystem>  // NOLINT
+#include <memory>
 #include <optional>
 #include <ostream>
 #include <string>
@@ -37,6 +38,7 @@
 #include "absl/container/fixed_array.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -83,56 +85,77 @@ struct Pipe {
   FileDescriptor entrance;
 };
 
-absl::Status ReplaceFdWithPipe(posix_spawn_file_actions_t& actions, int fd,
-                               Pipe& pipe, std::string_view pipe_name) {
-  if (int err = posix_spawn_file_actions_addclose(&actions, pipe.exit.get());
+// Replaces `fd` in the child with `child_end` of a pipe, closing the other end
+// of the pipe in the child.
+absl::Status ReplaceFdWithPipeEnd(posix_spawn_file_actions_t& actions, int fd,
+                                  FileDescriptor& child_end,
+                                  FileDescriptor& parent_end,
+                                  std::string_view pipe_name) {
+  if (int err = posix_spawn_file_actions_addclose(&actions, parent_end.get());
       err != 0) {
-    return absl::InternalError(absl::StrFormat(
-        "Cannot add close() action for %s exit: %s", pipe_name, Strerror(err)));
+    return absl::InternalError(
+        absl::StrFormat("Cannot add close() action for %s parent end: %s",
+                        pipe_name, Strerror(err)));
   }
 
-  if (int err =
-          posix_spawn_file_actions_adddup2(&actions, pipe.entrance.get(), fd);
+  if (int err = posix_spawn_file_actions_adddup2(&actions, child_end.get(), fd);
       err != 0) {
     return absl::InternalError(
-        absl::StrFormat("Cannot add dup2() action for %s entrance: %s",
+        absl::StrFormat("Cannot add dup2() action for %s child end: %s",
                         pipe_name, Strerror(err)));
   }
-  if (int err =
-          posix_spawn_file_actions_addclose(&actions, pipe.entrance.get());
+  if (int err = posix_spawn_file_actions_addclose(&actions, child_end.get());
       err != 0) {
     return absl::InternalError(absl::StrFormat(
-        "Cannot clean up for %s entrance: %s", pipe_name, Strerror(err)));
+        "Cannot clean up for %s child end: %s", pipe_name, Strerror(err)));
   }
   return absl::OkStatus();
 }
 
+// Replaces an output `fd` of the child with the entrance of `pipe`.
+absl::Status ReplaceFdWithPipe(posix_spawn_file_actions_t& actions, int fd,
+                               Pipe& pipe, std::string_view pipe_name) {
+  return ReplaceFdWithPipeEnd(actions, fd, /*child_end=*/pipe.entrance,
+                              /*parent_end=*/pipe.exit, pipe_name);
+}
+
+// Creates the file actions for a child process. If `stdin_pipe` is null the
+// child's stdin is closed; otherwise the child reads from its exit. If
+// `stderr_pipe` is null the child inherits our stderr.
 absl::StatusOr<posix_spawn_file_actions_t> CreateChildFileActions(
-    Pipe& stdout_pipe, Pipe& stderr_pipe) {
+    Pipe* stdin_pipe, Pipe& stdout_pipe, Pipe* stderr_pipe) {
   posix_spawn_file_actions_t actions;
 
   if (int err = posix_spawn_file_actions_init(&actions); err != 0) {
     return absl::InternalError(
         absl::StrCat("Cannot initialize file actions: ", Strerror(err)));
   }
-  if (int err = posix_spawn_file_actions_addclose(&actions, STDIN_FILENO);
-      err != 0) {
-    return absl::InternalError(
-        absl::StrCat("Cannot add close() action (stdin): ", Strerror(err)));
+  if (stdin_pipe == nullptr) {
+    if (int err = posix_spawn_file_actions_addclose(&actions, STDIN_FILENO);
+        err != 0) {
+      return absl::InternalError(
+          absl::StrCat("Cannot add close() action (stdin): ", Strerror(err)));
+    }
+  } else {
+    XLS_RETURN_IF_ERROR(ReplaceFdWithPipeEnd(
+        actions, STDIN_FILENO, /*child_end=*/stdin_pipe->exit,
+        /*parent_end=*/stdin_pipe->entrance, "stdin"));
   }
 
   XLS_RETURN_IF_ERROR(
       ReplaceFdWithPipe(actions, STDOUT_FILENO, stdout_pipe, "stdout"));
-  XLS_RETURN_IF_ERROR(
-      ReplaceFdWithPipe(actions, STDERR_FILENO, stderr_pipe, "stderr"));
+  if (stderr_pipe != nullptr) {
+    XLS_RETURN_IF_ERROR(
+        ReplaceFdWithPipe(actions, STDERR_FILENO, *stderr_pipe, "stderr"));
+  }
 
   return actions;
 }
 
 absl::StatusOr<pid_t> ExecInChildProcess(
     const std::vector<const char*>& argv_pointers,
-    const std::optional<std::filesystem::path>& cwd, Pipe& stdout_pipe,
-    Pipe& stderr_pipe) {
+    const std::optional<std::filesystem::path>& cwd, Pipe* stdin_pipe,
+    Pipe& stdout_pipe, Pipe* stderr_pipe) {
   // We previously used fork() & exec() here, but that's prone to many subtle
   // problems (e.g., allocating between fork() and exec() can cause arbitrary
   // problems)... and it's also slow. vfork() might have made the performance
@@ -154,7 +177,8 @@ absl::StatusOr<pid_t> ExecInChildProcess(
                               argv_pointers.end());
 
   XLS_ASSIGN_OR_RETURN(posix_spawn_file_actions_t file_actions,
-                       CreateChildFileActions(stdout_pipe, stderr_pipe));
+                       CreateChildFileActions(stdin_pipe, stdout_pipe,
+                                              stderr_pipe));
 
   pid_t pid;
   if (int err = posix_spawnp(
@@ -169,8 +193,13 @@ absl::StatusOr<pid_t> ExecInChildProcess(
     return absl::InternalError(
         absl::StrCat("Cannot destroy file actions: ", Strerror(err)));
   }
+  if (stdin_pipe != nullptr) {
+    stdin_pipe->exit.Close();
+  }
   stdout_pipe.entrance.Close();
-  stderr_pipe.entrance.Close();
+  if (stderr_pipe != nullptr) {
+    stderr_pipe->entrance.Close();
+  }
   return pid;
 }
 
@@ -275,8 +304,9 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
   XLS_ASSIGN_OR_RETURN(auto stdout_pipe, Pipe::Open());
   XLS_ASSIGN_OR_RETURN(auto stderr_pipe, Pipe::Open());
 
-  XLS_ASSIGN_OR_RETURN(pid_t pid, ExecInChildProcess(argv_pointers, cwd,
-                                                     stdout_pipe, stderr_pipe));
+  XLS_ASSIGN_OR_RETURN(
+      pid_t pid, ExecInChildProcess(argv_pointers, cwd, /*stdin_pipe=*/nullptr,
+                                    stdout_pipe, &stderr_pipe));
 
   // Order is important here. The optional<Thread> must appear after the mutex
   // because the thread's destructor calls Join() and because the thread has
@@ -358,6 +388,117 @@ absl::StatusOr<SubprocessResult> SubprocessErrorAsStatus(
       result_or_status->stdout_content, result_or_status->stderr_content));
 }
 
+absl::StatusOr<std::unique_ptr<InteractiveSubprocess>>
+InteractiveSubprocess::Create(absl::Span<const std::string> argv,
+                              std::optional<std::filesystem::path> cwd) {
+  if (argv.empty()) {
+    return absl::InvalidArgumentError("Cannot invoke empty argv list.");
+  }
+  VLOG(1) << absl::StreamFormat(
+      "Starting interactive %s; argv: [ %s ]",
+      std::filesystem::path(argv[0]).filename().string(),
+      absl::StrJoin(argv, " "));
+
+  std::vector<const char*> argv_pointers;
+  argv_pointers.reserve(argv.size() + 1);
+  for (const auto& arg : argv) {
+    argv_pointers.push_back(arg.c_str());
+  }
+  argv_pointers.push_back(nullptr);
+
+  XLS_ASSIGN_OR_RETURN(auto stdin_pipe, Pipe::Open());
+  XLS_ASSIGN_OR_RETURN(auto stdout_pipe, Pipe::Open());
+  XLS_ASSIGN_OR_RETURN(pid_t pid,
+                       ExecInChildProcess(argv_pointers, cwd, &stdin_pipe,
+                                          stdout_pipe, /*stderr_pipe=*/nullptr));
+  return absl::WrapUnique(new InteractiveSubprocess(
+      pid, std::move(stdin_pipe.entrance), std::move(stdout_pipe.exit)));
+}
+
+InteractiveSubprocess::~InteractiveSubprocess() {
+  if (!exit_status_.has_value()) {
+    absl::StatusOr<int> exit_status = Finish();
+    if (!exit_status.ok()) {
+      LOG(WARNING) << "Failed to finish interactive subprocess: "
+                   << exit_status.status();
+    }
+  }
+}
+
+absl::StatusOr<std::string> InteractiveSubprocess::Communicate(
+    std::string_view request) {
+  XLS_RETURN_IF_ERROR(WriteRequest(request));
+  return ReadLine();
+}
+
+absl::StatusOr<std::string> InteractiveSubprocess::CommunicateUntil(
+    std::string_view request, std::string_view marker) {
+  XLS_RETURN_IF_ERROR(WriteRequest(request));
+  std::string output;
+  while (true) {
+    XLS_ASSIGN_OR_RETURN(std::string line, ReadLine());
+    absl::StrAppend(&output, line);
+    if (line.starts_with(marker)) {
+      return output;
+    }
+    output.push_back('\n');
+  }
+}
+
+absl::Status InteractiveSubprocess::WriteRequest(std::string_view request) {
+  if (exit_status_.has_value()) {
+    return absl::FailedPreconditionError(
+        "Interactive subprocess has already finished.");
+  }
+  std::string line = absl::StrCat(request, "\n");
+  std::string_view remaining = line;
+  while (!remaining.empty()) {
+    ssize_t bytes = write(stdin_.get(), remaining.data(), remaining.size());
+    if (bytes < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return absl::InternalError(absl::StrCat(
+          "Failed to write to interactive subprocess: ", Strerror(errno)));
+    }
+    remaining.remove_prefix(bytes);
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string> InteractiveSubprocess::ReadLine() {
+  absl::FixedArray<char> buffer(4096);
+  size_t newline;
+  while ((newline = stdout_buffer_.find('\n')) == std::string::npos) {
+    ssize_t bytes = read(stdout_.get(), buffer.data(), buffer.size());
+    if (bytes < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return absl::InternalError(absl::StrCat(
+          "Failed to read from interactive subprocess: ", Strerror(errno)));
+    }
+    if (bytes == 0) {
+      return absl::InternalError(
+          "Interactive subprocess closed its stdout before replying.");
+    }
+    stdout_buffer_.append(buffer.data(), bytes);
+  }
+  std::string response = stdout_buffer_.substr(0, newline);
+  stdout_buffer_.erase(0, newline + 1);
+  return response;
+}
+
+absl::StatusOr<int> InteractiveSubprocess::Finish() {
+  if (!exit_status_.has_value()) {
+    stdin_.Close();
+    stdout_.Close();
+    XLS_ASSIGN_OR_RETURN(int wait_status, WaitForPid(pid_));
+    exit_status_ = WEXITSTATUS(wait_status);
+  }
+  return *exit_status_;
+}
+
 std::ostream& operator<<(std::ostream& os, const SubprocessResult& other) {
   os << "exit_status:" << other.exit_status
      << " normal_termination:" << other.normal_termination
@@ -15,16 +15,22 @@
 #ifndef XLS_COMMON_SUBPROCESS_H_
 #define XLS_COMMON_SUBPROCESS_H_
 
+#include <sys/types.h>
+
 #include <filesystem>  // NOLINT
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "xls/common/file/file_descriptor.h"
 
 namespace xls {
 
@@ -97,5 +103,60 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
     std::optional<std::filesystem::path> cwd = std::nullopt,
     std::optional<absl::Duration> optional_timeout = std::nullopt);
 
+// A subprocess which is kept running and queried with lines of text: each
+// request is written as a line to its stdin, and it replies with a line on its
+// stdout. The subprocess inherits our stderr. This avoids paying the startup
+// cost of a tool (e.g. initializing LLVM) for each of many queries.
+//
+// Writing a request to a subprocess which has exited raises SIGPIPE; callers
+// which want an error status instead should ignore that signal.
+class InteractiveSubprocess {
+ public:
+  // Starts the subprocess with the given argv. If 'cwd' is supplied, the
+  // subprocess is started in the given directory.
+  static absl::StatusOr<std::unique_ptr<InteractiveSubprocess>> Create(
+      absl::Span<const std::string> argv,
+      std::optional<std::filesystem::path> cwd = std::nullopt);
+
+  // Finishes the subprocess if Finish() has not been called.
+  ~InteractiveSubprocess();
+
+  // Writes `request` and a newline to the stdin of the subprocess and returns
+  // the next line (without its newline) that the subprocess writes to stdout.
+  // Returns an error if the subprocess closes its stdout before replying.
+  absl::StatusOr<std::string> Communicate(std::string_view request);
+
+  // Writes `request` and a newline to the stdin of the subprocess and returns
+  // everything the subprocess writes to stdout up to and including the first
+  // line which starts with `marker` (without that line's newline). This is for
+  // subprocesses such as Tcl shells which reply to a (possibly multi-line)
+  // script with many lines of output, and which the script itself tells to
+  // write `marker` once it is done.
+  absl::StatusOr<std::string> CommunicateUntil(std::string_view request,
+                                               std::string_view marker);
+
+  // Closes the stdin of the subprocess, which should make it exit, and waits
+  // for it to do so. Returns its exit status.
+  absl::StatusOr<int> Finish();
+
+ private:
+  InteractiveSubprocess(pid_t pid, FileDescriptor stdin_fd,
+                        FileDescriptor stdout_fd)
+      : pid_(pid), stdin_(std::move(stdin_fd)), stdout_(std::move(stdout_fd)) {}
+
+  // Writes `request` and a newline to the stdin of the subprocess.
+  absl::Status WriteRequest(std::string_view request);
+
+  // Returns the next line (without its newline) written to stdout.
+  absl::StatusOr<std::string> ReadLine();
+
+  pid_t pid_;
+  FileDescriptor stdin_;
+  FileDescriptor stdout_;
+  // Output read from the subprocess beyond the last returned line.
+  std::string stdout_buffer_;
+  std::optional<int> exit_status_;
+};
+
 }  // namespace xls
 #endif  // XLS_COMMON_SUBPROCESS_H_
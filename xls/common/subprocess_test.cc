@@ -14,6 +14,7 @@
 
 #include "xls/common/subprocess.h"
 
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -186,5 +187,46 @@ TEST(SubprocessTest, ResultsUnpackToStringPair) {
               StatusIs(absl::StatusCode::kInternal, HasSubstr("bad arg")));
 }
 
+TEST(SubprocessTest, InteractiveSubprocessCommunicates) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<InteractiveSubprocess> subprocess,
+      InteractiveSubprocess::Create(
+          {"/usr/bin/env", "bash", "-c",
+           "while read line; do echo \"got $line\"; done; exit 3"}));
+
+  EXPECT_THAT(subprocess->Communicate("a"), IsOkAndHolds("got a"));
+  EXPECT_THAT(subprocess->Communicate("b c"), IsOkAndHolds("got b c"));
+  EXPECT_THAT(subprocess->Finish(), IsOkAndHolds(3));
+  EXPECT_THAT(subprocess->Communicate("d"),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST(SubprocessTest, InteractiveSubprocessCommunicatesUntilMarker) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<InteractiveSubprocess> subprocess,
+      InteractiveSubprocess::Create(
+          {"/usr/bin/env", "bash", "-c",
+           "while read line; do echo \"got $line\"; "
+           "if [[ $line == done* ]]; then echo \"DONE $line\"; fi; done"}));
+
+  EXPECT_THAT(subprocess->CommunicateUntil("a\nb\ndone 1", "DONE"),
+              IsOkAndHolds("got a\ngot b\ngot done 1\nDONE done 1"));
+  EXPECT_THAT(subprocess->CommunicateUntil("done 2", "DONE"),
+              IsOkAndHolds("got done 2\nDONE done 2"));
+  EXPECT_THAT(subprocess->Finish(), IsOkAndHolds(0));
+}
+
+TEST(SubprocessTest, InteractiveSubprocessExitWithoutReplyFails) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<InteractiveSubprocess> subprocess,
+      InteractiveSubprocess::Create(
+          {"/usr/bin/env", "bash", "-c", "read line; exit 5"}));
+
+  EXPECT_THAT(subprocess->Communicate("a"),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("closed its stdout")));
+  EXPECT_THAT(subprocess->Finish(), IsOkAndHolds(5));
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,36 +14,79 @@
 
 #include "xls/contrib/integrator/integration_algorithms/basic_integration_algorithm.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/node.h"
 #include "xls/ir/op.h"
+#include "xls/ir/type.h"
 
 namespace xls {
 
-void BasicIntegrationAlgorithm::EnqueueNodeIfReady(Node* node) {
+/* static */ std::string BasicIntegrationAlgorithm::MergeSignature(
+    const Node* node) {
+  std::string signature =
+      absl::StrCat(OpToString(node->op()), " ", node->GetType()->ToString());
+  for (const Node* operand : node->operands()) {
+    absl::StrAppend(&signature, " ", operand->GetType()->ToString());
+  }
+  return signature;
+}
+
+void BasicIntegrationAlgorithm::AddMergeCandidate(Node* node) {
+  merge_candidates_[MergeSignature(node)].push_back(node);
+}
+
+void BasicIntegrationAlgorithm::RemoveMergeCandidate(Node* node) {
+  auto bucket_itr = merge_candidates_.find(MergeSignature(node));
+  if (bucket_itr == merge_candidates_.end()) {
+    return;
+  }
+  std::vector<Node*>& bucket = bucket_itr->second;
+  bucket.erase(std::remove(bucket.begin(), bucket.end(), node), bucket.end());
+  if (bucket.empty()) {
+    merge_candidates_.erase(bucket_itr);
+  }
+}
+
+absl::Status BasicIntegrationAlgorithm::EnqueueNodeIfReady(Node* node) {
   if (!queued_nodes_.contains(node) &&
       integration_function_->AllOperandsHaveMapping(node)) {
+    XLS_ASSIGN_OR_RETURN(int64_t insert_cost,
+                         integration_function_->GetInsertNodeCost(node));
+    insert_costs_[node] = insert_cost;
     ready_nodes_.push_back(node);
     queued_nodes_.insert(node);
   }
+  return absl::OkStatus();
 }
 
 absl::Status BasicIntegrationAlgorithm::Initialize() {
   // Make integration function.
   XLS_ASSIGN_OR_RETURN(integration_function_, NewIntegrationFunction());
 
+  // Index the initial mapping targets (e.g. parameter tuple indices).
+  for (Node* node : integration_function_->function()->nodes()) {
+    if (integration_function_->IsMappingTarget(node)) {
+      AddMergeCandidate(node);
+    }
+  }
+
   // ID initial nodes with all operands ready.
   for (const Function* func : source_functions_) {
     for (Node* node : func->nodes()) {
       if (node->op() != Op::kParam) {
-        EnqueueNodeIfReady(node);
+        XLS_RETURN_IF_ERROR(EnqueueNodeIfReady(node));
       }
     }
   }
@@ -57,20 +100,17 @@ BasicIntegrationAlgorithm::Run() {
     for (auto node_itr = ready_nodes_.begin(); node_itr != ready_nodes_.end();
          ++node_itr) {
       // Check insertion cost.
-      XLS_ASSIGN_OR_RETURN(int64_t insert_cost,
-                           integration_function_->GetInsertNodeCost(*node_itr));
+      int64_t insert_cost = insert_costs_.at(*node_itr);
       if (!move.has_value() || insert_cost < move.value().cost) {
         move = MakeInsertMove(node_itr, insert_cost);
       }
 
-      // Check merge cost.
-      for (Node* internal_node : integration_function_->function()->nodes()) {
-        // TODO(jbaileyhandle): Relax this requirement so that
-        // it only applies to integration-generated muxes.
-        if (!integration_function_->IsMappingTarget(internal_node)) {
-          continue;
-        }
-
+      // Check merge cost against the compatible integration function nodes.
+      auto bucket_itr = merge_candidates_.find(MergeSignature(*node_itr));
+      if (bucket_itr == merge_candidates_.end()) {
+        continue;
+      }
+      for (Node* internal_node : bucket_itr->second) {
         // Check if mergeable
         XLS_ASSIGN_OR_RETURN(
             std::optional<int64_t> merge_cost,
@@ -87,15 +127,24 @@ BasicIntegrationAlgorithm::Run() {
       }
     }
 
-    // Execute lowest-cost move.
+    // Execute lowest-cost move. A merge removes the integration function node
+    // it merged with and replaces it with the returned mapping targets.
     XLS_RET_CHECK(move.has_value());
-    XLS_RETURN_IF_ERROR(
-        ExecuteMove(integration_function_.get(), move.value()).status());
+    if (move.value().move_type == IntegrationMoveType::kMerge) {
+      RemoveMergeCandidate(move.value().merge_node);
+    }
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<Node*> targets,
+        ExecuteMove(integration_function_.get(), move.value()));
+    for (Node* target : targets) {
+      AddMergeCandidate(target);
+    }
 
     // Update ready_nodes_.
+    insert_costs_.erase(move.value().node);
     ready_nodes_.erase(move.value().node_itr);
     for (Node* user : move.value().node->users()) {
-      EnqueueNodeIfReady(user);
+      XLS_RETURN_IF_ERROR(EnqueueNodeIfReady(user));
     }
   }
 
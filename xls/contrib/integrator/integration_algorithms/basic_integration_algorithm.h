@@ -19,7 +19,10 @@
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -33,7 +36,10 @@ namespace xls {
 // integration function when all of its operands have already been added.
 // At each step, adds the eligible node for which the cost of adding it to
 // the function (either by inserting or merging with any integeration function
-// node) is the lowest.
+// node) is the lowest. Only integration function nodes with the same merge
+// signature as an eligible node are considered as merge candidates, so each
+// step is proportional to the number of compatible pairs rather than to the
+// product of the eligible and integrated node counts.
 class BasicIntegrationAlgorithm
     : public IntegrationAlgorithm<BasicIntegrationAlgorithm> {
  public:
@@ -89,12 +95,32 @@ class BasicIntegrationAlgorithm
 
   // Queue node for processing if all its operands are mapped
   // and node has not already been queued for processing.
-  void EnqueueNodeIfReady(Node* node);
+  absl::Status EnqueueNodeIfReady(Node* node);
+
+  // Returns a key such that nodes which may be merged with each other have
+  // the same key. IntegrationFunction currently only merges nodes which are
+  // IsDefinitelyEqualTo each other, so this is the op along with the result
+  // and operand types.
+  static std::string MergeSignature(const Node* node);
+
+  // Add / remove an integration function node from merge_candidates_.
+  void AddMergeCandidate(Node* node);
+  void RemoveMergeCandidate(Node* node);
 
   // Track nodes for which all operands are already mapped and
   // are ready to be added to the integration_function_
   std::list<Node*> ready_nodes_;
 
+  // The cost of inserting each node in 'ready_nodes_'. This does not depend on
+  // the rest of the integration function, so it is computed once when the node
+  // is queued.
+  absl::flat_hash_map<Node*, int64_t> insert_costs_;
+
+  // Integration function nodes which are mapping targets, bucketed by
+  // MergeSignature. Each bucket is kept in the order in which the nodes were
+  // added to the integration function.
+  absl::flat_hash_map<std::string, std::vector<Node*>> merge_candidates_;
+
   // Track all nodes that have ever been inserted into 'ready_nodes_'.
   absl::flat_hash_set<Node*> queued_nodes_;
 
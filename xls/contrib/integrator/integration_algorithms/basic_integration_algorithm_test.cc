@@ -67,6 +67,39 @@ TEST_F(BasicIntegrationAlgorithmTest, BasicIntegrationNodesNotCompatible) {
                       m::TupleIndex(m::Param("func_b_ParamTuple"), 1))));
 }
 
+TEST_F(BasicIntegrationAlgorithmTest, BasicIntegrationWidthsNotCompatible) {
+  auto p = CreatePackage();
+  FunctionBuilder fb_a("func_a", p.get());
+  auto a_in1 = fb_a.Param("a_in1", p->GetBitsType(2));
+  auto a_in2 = fb_a.Param("a_in2", p->GetBitsType(2));
+
+  fb_a.UMul(a_in1, a_in2, SourceInfo(), "a_mul");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_a, fb_a.Build());
+
+  FunctionBuilder fb_b("func_b", p.get());
+  auto b_in1 = fb_b.Param("b_in1", p->GetBitsType(4));
+  auto b_in2 = fb_b.Param("b_in2", p->GetBitsType(4));
+
+  fb_b.UMul(b_in1, b_in2, SourceInfo(), "b_mul");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_b, fb_b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IntegrationBuilder> builder,
+      IntegrationBuilder::Build(
+          {func_a, func_b},
+          IntegrationOptions().algorithm(
+              IntegrationOptions::Algorithm::kBasicIntegrationAlgorithm)));
+
+  Function* function = builder->integrated_function()->function();
+  EXPECT_EQ(function->node_count(), 10);
+  EXPECT_THAT(
+      builder->integrated_function()->function()->return_value(),
+      m::Tuple(m::UMul(m::TupleIndex(m::Param("func_a_ParamTuple"), 0),
+                       m::TupleIndex(m::Param("func_a_ParamTuple"), 1)),
+               m::UMul(m::TupleIndex(m::Param("func_b_ParamTuple"), 0),
+                       m::TupleIndex(m::Param("func_b_ParamTuple"), 1))));
+}
+
 TEST_F(BasicIntegrationAlgorithmTest, BasicIntegrationMergeNotProfitable) {
   auto p = CreatePackage();
   FunctionBuilder fb_a("func_a", p.get());
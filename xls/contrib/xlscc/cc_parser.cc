@@ -49,6 +49,7 @@
 #include "clang/include/clang/Basic/TokenKinds.h"
 #include "clang/include/clang/Frontend/CompilerInstance.h"
 #include "clang/include/clang/Frontend/FrontendAction.h"
+#include "clang/include/clang/Frontend/FrontendActions.h"
 #include "clang/include/clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/include/clang/Lex/PPCallbacks.h"
 #include "clang/include/clang/Lex/Pragma.h"
@@ -658,49 +659,11 @@ absl::StatusOr<const clang::VarDecl*> CCParser::GetXlsccOnReset() const {
   return xlscc_on_reset_;
 }
 
-LibToolThread::LibToolThread(std::string_view source_filename,
-                             std::string_view top_class_name,
-                             absl::Span<std::string_view> command_line_args,
-                             CCParser& parser)
-    : source_filename_(source_filename),
-      top_class_name_(top_class_name),
-      command_line_args_(command_line_args),
-      parser_(parser) {}
-
-void LibToolThread::Start() {
-  thread_.emplace([this] { Run(); });
-}
-
-void LibToolThread::Join() { thread_->Join(); }
-
-void LibToolThread::Run() {
-  std::vector<std::string> argv;
-  argv.emplace_back("binary");
-  argv.emplace_back("/xls_top.cc");
-  for (const auto& view : command_line_args_) {
-    argv.emplace_back(view);
-  }
-  // For xls_top.cc to include the source file
-  argv.emplace_back("-I.");
-  argv.emplace_back("-fsyntax-only");
-  argv.emplace_back("-std=c++17");
-  argv.emplace_back("-nostdinc");
-  argv.emplace_back("-Wno-unused-label");
-  argv.emplace_back("-Wno-constant-logical-operand");
-  argv.emplace_back("-Wno-unused-but-set-variable");
-  argv.emplace_back("-Wno-c++11-narrowing");
-  argv.emplace_back("-Wno-conversion");
-
-  llvm::IntrusiveRefCntPtr<clang::FileManager> libtool_files;
-
-  std::unique_ptr<LibToolFrontendAction> libtool_action(
-      new LibToolFrontendAction(parser_));
-
-  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs(
-      new llvm::vfs::InMemoryFileSystem);
-  mem_fs->addFile("/xls_builtin.h", 0,
-                  llvm::MemoryBuffer::getMemBuffer(
-                      R"(
+// Declarations visible to every translation unit parsed by xlscc. This is
+// included first from /xls_top.cc and force-included into precompiled headers,
+// so a header precompiled by GeneratePrecompiledHeader() records the same file.
+static constexpr std::string_view kXlsBuiltinPath = "/xls_builtin.h";
+static constexpr std::string_view kXlsBuiltinHeader = R"(
 #ifndef __XLS_BUILTIN_H
 #define __XLS_BUILTIN_H
 template<int N>
@@ -775,7 +738,57 @@ void __xlscc_unroll(long long factor) { }
 void __xlscc_asap() { }
 
 #endif//__XLS_BUILTIN_H
-          )"));
+          )";
+
+// Arguments passed to Clang for every parse. Precompiled headers are only
+// accepted if they were built with compatible language options, so these are
+// shared between ScanFile() and GeneratePrecompiledHeader().
+static void AppendCommonClangArgs(std::vector<std::string>& argv) {
+  argv.emplace_back("-std=c++17");
+  argv.emplace_back("-nostdinc");
+  argv.emplace_back("-Wno-unused-label");
+  argv.emplace_back("-Wno-constant-logical-operand");
+  argv.emplace_back("-Wno-unused-but-set-variable");
+  argv.emplace_back("-Wno-c++11-narrowing");
+  argv.emplace_back("-Wno-conversion");
+}
+
+LibToolThread::LibToolThread(std::string_view source_filename,
+                             std::string_view top_class_name,
+                             absl::Span<std::string_view> command_line_args,
+                             CCParser& parser)
+    : source_filename_(source_filename),
+      top_class_name_(top_class_name),
+      command_line_args_(command_line_args),
+      parser_(parser) {}
+
+void LibToolThread::Start() {
+  thread_.emplace([this] { Run(); });
+}
+
+void LibToolThread::Join() { thread_->Join(); }
+
+void LibToolThread::Run() {
+  std::vector<std::string> argv;
+  argv.emplace_back("binary");
+  argv.emplace_back("/xls_top.cc");
+  for (const auto& view : command_line_args_) {
+    argv.emplace_back(view);
+  }
+  // For xls_top.cc to include the source file
+  argv.emplace_back("-I.");
+  argv.emplace_back("-fsyntax-only");
+  AppendCommonClangArgs(argv);
+
+  llvm::IntrusiveRefCntPtr<clang::FileManager> libtool_files;
+
+  std::unique_ptr<LibToolFrontendAction> libtool_action(
+      new LibToolFrontendAction(parser_));
+
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs(
+      new llvm::vfs::InMemoryFileSystem);
+  mem_fs->addFile(kXlsBuiltinPath, 0,
+                  llvm::MemoryBuffer::getMemBuffer(kXlsBuiltinHeader));
 
   // Inject an instantiation to make Clang parse the constructor bodies
   std::string top_class_inst_injection = top_class_name_.empty()
@@ -834,6 +847,43 @@ void LibToolFrontendAction::EndSourceFileAction() {
   parser_.libtool_wait_for_destruct_->Wait();
 }
 
+absl::Status GeneratePrecompiledHeader(
+    std::string_view header_filename, std::string_view output_filename,
+    absl::Span<std::string_view> command_line_args) {
+  std::vector<std::string> argv;
+  argv.emplace_back("binary");
+  argv.emplace_back("-x");
+  argv.emplace_back("c++-header");
+  argv.emplace_back(header_filename);
+  argv.emplace_back("-include");
+  argv.emplace_back(kXlsBuiltinPath);
+  argv.emplace_back("-o");
+  argv.emplace_back(output_filename);
+  for (const auto& view : command_line_args) {
+    argv.emplace_back(view);
+  }
+  argv.emplace_back("-I.");
+  AppendCommonClangArgs(argv);
+
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs(
+      new llvm::vfs::InMemoryFileSystem);
+  mem_fs->addFile(kXlsBuiltinPath, 0,
+                  llvm::MemoryBuffer::getMemBuffer(kXlsBuiltinHeader));
+  llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> overlay_fs(
+      new llvm::vfs::OverlayFileSystem(llvm::vfs::getRealFileSystem()));
+  overlay_fs->pushOverlay(mem_fs);
+  llvm::IntrusiveRefCntPtr<clang::FileManager> files(
+      new clang::FileManager(clang::FileSystemOptions(), overlay_fs));
+
+  clang::tooling::ToolInvocation invocation(
+      argv, std::make_unique<clang::GeneratePCHAction>(), files.get());
+  if (!invocation.run()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Unable to generate precompiled header for %s", header_filename));
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::string> CCParser::GetEntryFunctionName() const {
   if (top_function_ == nullptr) {
     return absl::NotFoundError("No top function found");
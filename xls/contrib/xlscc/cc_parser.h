@@ -189,6 +189,18 @@ class CCParser {
   int next_file_number_ = 1;
 };
 
+// Precompiles header_filename, along with the headers it includes, into a
+// Clang PCH file at output_filename. Passing "-include-pch output_filename" in
+// the command_line_args of a later ScanFile() then loads the serialized AST
+// instead of re-parsing the headers, which dominates the parse time of small
+// sources including large libraries such as ac_types.
+//
+// The same command_line_args (in particular -D and -I) must be used for both
+// calls, otherwise Clang rejects the precompiled header.
+absl::Status GeneratePrecompiledHeader(
+    std::string_view header_filename, std::string_view output_filename,
+    absl::Span<std::string_view> command_line_args);
+
 }  // namespace xlscc
 
 #endif  // XLS_CONTRIB_XLSCC_PARSE_CPP_H_
@@ -39,6 +39,8 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/log_flags.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/stopwatch.h"
+#include "xls/contrib/xlscc/cc_parser.h"
 #include "xls/contrib/xlscc/flags.h"
 #include "xls/contrib/xlscc/hls_block.pb.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
@@ -57,6 +59,10 @@ xlscc foo.cc
 Emit combinational Verilog module:
 xlscc foo.cc --block_pb block_info.pb
 
+Precompile headers included by foo.cc, then reuse them:
+xlscc headers.h --emit_pch headers.pch
+xlscc foo.cc --include_pch headers.pch
+
 )";
 
 ABSL_FLAG(std::string, out, "",
@@ -84,6 +90,15 @@ ABSL_FLAG(std::vector<std::string>, defines, std::vector<std::string>(),
 ABSL_FLAG(std::vector<std::string>, include_dirs, std::vector<std::string>(),
           "Comma separated list of include directories to pass to clang");
 
+ABSL_FLAG(std::string, include_pch, "",
+          "Clang precompiled header, as generated by --emit_pch, to load "
+          "before parsing the input file");
+
+ABSL_FLAG(std::string, emit_pch, "",
+          "If specified, treat the input file as a header, precompile it along "
+          "with its includes to this path, and exit without generating IR. "
+          "Must be given the same clang arguments as the --include_pch runs.");
+
 ABSL_FLAG(std::string, meta_out, "",
           "Path at which to output metadata protobuf");
 
@@ -244,12 +259,32 @@ static absl::Status Run(std::string_view cpp_path) {
     clang_argvs.push_back(absl::StrCat("-I", dir));
   }
 
+  const std::string include_pch = absl::GetFlag(FLAGS_include_pch);
+  if (!include_pch.empty()) {
+    clang_argvs.push_back("-include-pch");
+    clang_argvs.push_back(include_pch);
+  }
+
   std::vector<std::string_view> clang_argv;
   clang_argv.reserve(clang_argvs.size());
   for (const auto& i : clang_argvs) {
     clang_argv.push_back(i);
   }
 
+  const std::string emit_pch = absl::GetFlag(FLAGS_emit_pch);
+  if (!emit_pch.empty()) {
+    if (!include_pch.empty()) {
+      return absl::InvalidArgumentError(
+          "--emit_pch and --include_pch may not be combined");
+    }
+    LOG(INFO) << "Precompiling header '" << cpp_path << "' with clang...";
+    xls::Stopwatch pch_stopwatch;
+    XLS_RETURN_IF_ERROR(GeneratePrecompiledHeader(
+        cpp_path, emit_pch, absl::MakeSpan(clang_argv)));
+    LOG(INFO) << "Precompiled in " << pch_stopwatch.GetElapsedTime();
+    return absl::OkStatus();
+  }
+
   std::cerr << "Parsing file '" << cpp_path << "' with clang..." << '\n';
   XLS_RETURN_IF_ERROR(translator.ScanFile(
       cpp_path, clang_argv.empty()
@@ -46,9 +46,6 @@
 #include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
-#include "xls/solvers/z3_ir_translator.h"
-#include "xls/solvers/z3_utils.h"
-#include "external/z3/src/api/z3_api.h"
 
 using std::shared_ptr;
 using std::string;
@@ -159,25 +156,7 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
                                                  const clang::Stmt* body,
                                                  clang::ASTContext& ctx,
                                                  const xls::SourceInfo& loc) {
-  XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<xls::solvers::z3::IrTranslator> z3_translator_parent,
-      xls::solvers::z3::IrTranslator::CreateAndTranslate(
-          /*source=*/nullptr,
-          /*allow_unsupported=*/false));
-
-  Z3_solver solver =
-      xls::solvers::z3::CreateSolver(z3_translator_parent->ctx(), 1);
-
-  class SolverDeref {
-   public:
-    SolverDeref(Z3_context ctx, Z3_solver solver)
-        : ctx_(ctx), solver_(solver) {}
-    ~SolverDeref() { Z3_solver_dec_ref(ctx_, solver_); }
-
-   private:
-    Z3_context ctx_;
-    Z3_solver solver_;
-  };
+  BitMustBeState condition_state;
 
   // Generate the declaration within a private context
   PushContextGuard for_init_guard(*this, loc);
@@ -234,7 +213,7 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
       // We use the relative condition so that returns also stop unrolling
       XLS_ASSIGN_OR_RETURN(bool condition_must_be_false,
                            BitMustBe(false, context().relative_condition,
-                                     solver, z3_translator_parent->ctx(), loc));
+                                     condition_state, loc));
       if (condition_must_be_false) {
         break;
       }
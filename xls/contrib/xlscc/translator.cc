@@ -86,6 +86,8 @@
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
 #include "xls/solvers/z3_ir_translator.h"
 #include "xls/solvers/z3_utils.h"
 #include "external/z3/src/api/z3_api.h"
@@ -5382,7 +5384,7 @@ absl::StatusOr<Z3_lbool> Translator::CheckAssumptions(
 }
 
 absl::StatusOr<bool> Translator::BitMustBe(bool assert_value, xls::BValue& bval,
-                                           Z3_solver& solver, Z3_context ctx,
+                                           BitMustBeState& state,
                                            const xls::SourceInfo& loc) {
   // Invalid is interpreted as literal 1
   if (!bval.valid()) {
@@ -5394,12 +5396,29 @@ absl::StatusOr<bool> Translator::BitMustBe(bool assert_value, xls::BValue& bval,
 
   XLS_RETURN_IF_ERROR(ShortCircuitBVal(bval, loc));
 
-  XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<xls::solvers::z3::IrTranslator> z3_translator,
-      xls::solvers::z3::IrTranslator::CreateAndTranslate(
-          /*ctx=*/ctx,
-          /*source=*/bval.node(),
-          /*allow_unsupported=*/false));
+  // Loop conditions which only depend on the induction variable fold to a
+  // literal.
+  if (bval.node()->Is<xls::Literal>()) {
+    return bval.node()->As<xls::Literal>()->value().IsAllOnes() ==
+           assert_value;
+  }
+
+  XLS_RETURN_IF_ERROR(state.ternary_query_engine.PopulateCone(bval.node()));
+  const xls::TreeBitLocation bit(bval.node(), 0);
+  if (state.ternary_query_engine.IsKnown(bit)) {
+    return state.ternary_query_engine.IsOne(bit) == assert_value;
+  }
+
+  if (state.z3_translator == nullptr) {
+    XLS_ASSIGN_OR_RETURN(state.z3_translator,
+                         xls::solvers::z3::IrTranslator::CreateAndTranslate(
+                             /*source=*/nullptr,
+                             /*allow_unsupported=*/false));
+    state.z3_solver =
+        xls::solvers::z3::CreateSolver(state.z3_translator->ctx(), 1);
+  }
+  // Only the nodes not translated by an earlier check are visited.
+  XLS_RETURN_IF_ERROR(bval.node()->Accept(state.z3_translator.get()));
 
   absl::Span<xls::Node*> positive_assumptions, negative_assumptions;
   xls::Node* assumptions[] = {bval.node()};
@@ -5414,8 +5433,8 @@ absl::StatusOr<bool> Translator::BitMustBe(bool assert_value, xls::BValue& bval,
 
   XLS_ASSIGN_OR_RETURN(
       Z3_lbool result,
-      CheckAssumptions(positive_assumptions, negative_assumptions, solver,
-                       *z3_translator));
+      CheckAssumptions(positive_assumptions, negative_assumptions,
+                       state.z3_solver, *state.z3_translator));
 
   // No combination of variables can satisfy !break condition.
   return result == Z3_L_FALSE;
@@ -61,6 +61,7 @@
 #include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/passes/ternary_query_engine.h"
 #include "xls/solvers/z3_ir_translator.h"
 #include "external/z3/src/api/z3_api.h"
 
@@ -2044,10 +2045,30 @@ class Translator {
       absl::Span<xls::Node*> negative_nodes, Z3_solver& solver,
       xls::solvers::z3::IrTranslator& z3_translator);
 
+  // State kept across the BitMustBe() checks of one unrolled loop. The
+  // ternary information and Z3 translations of nodes are retained, so each
+  // check only evaluates the IR generated since the previous one. The Z3
+  // context and solver are only created once a check needs them.
+  struct BitMustBeState {
+    BitMustBeState() = default;
+    BitMustBeState(const BitMustBeState&) = delete;
+    BitMustBeState& operator=(const BitMustBeState&) = delete;
+    ~BitMustBeState() {
+      if (z3_solver != nullptr) {
+        Z3_solver_dec_ref(z3_translator->ctx(), z3_solver);
+      }
+    }
+
+    xls::TernaryQueryEngine ternary_query_engine;
+    std::unique_ptr<xls::solvers::z3::IrTranslator> z3_translator;
+    Z3_solver z3_solver = nullptr;
+  };
+
   // bval can be invalid, in which case it is interpreted as 1
   // Short circuits the BValue
+  // Tries constant folding and then ternary evaluation before asking Z3.
   absl::StatusOr<bool> BitMustBe(bool assert_value, xls::BValue& bval,
-                                 Z3_solver& solver, Z3_context ctx,
+                                 BitMustBeState& state,
                                  const xls::SourceInfo& loc);
 
   absl::StatusOr<ConstValue> TranslateBValToConstVal(const CValue& bvalue,
@@ -17,13 +17,18 @@
 #include <cstdint>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "clang/include/clang/AST/Decl.h"
 #include "clang/include/clang/Basic/SourceLocation.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
 #include "xls/contrib/xlscc/unit_tests/unit_test.h"
@@ -940,4 +945,41 @@ TEST_F(CCParserTest, PragmaUnrollParametersMustBeNumberIfNotYesOrNo) {
                   testing::HasSubstr("Must be 'yes', 'no', or an integer.")));
 }
 
+TEST_F(CCParserTest, PrecompiledHeader) {
+  const std::string header_src = R"(
+    #ifndef PRECOMPILED_HEADER_TEST_H
+    #define PRECOMPILED_HEADER_TEST_H
+    template <int N>
+    struct Adder {
+      int operator()(int a) const { return a + N; }
+    };
+    #endif
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(
+      xls::TempFile header,
+      xls::TempFile::CreateWithContent(header_src, ".h"));
+  XLS_ASSERT_OK_AND_ASSIGN(xls::TempDirectory pch_dir,
+                           xls::TempDirectory::Create());
+  const std::string pch_path = (pch_dir.path() / "header.pch").string();
+
+  std::vector<std::string_view> pch_argv = {"-Werror", "-Wall",
+                                            "-Wno-unknown-pragmas"};
+  XLS_ASSERT_OK(xlscc::GeneratePrecompiledHeader(
+      header.path().c_str(), pch_path, absl::MakeSpan(pch_argv)));
+
+  const std::string cpp_src = absl::StrFormat(R"(
+    #include "%s"
+    int add3(int a) {
+      return Adder<3>()(a);
+    }
+  )", header.path().string());
+
+  xlscc::CCParser parser;
+  XLS_ASSERT_OK(ScanTempFileWithContent(cpp_src, {"-include-pch", pch_path},
+                                        &parser, /*top_name=*/"add3"));
+  XLS_ASSERT_OK_AND_ASSIGN(const auto* top_ptr, parser.GetTopFunction());
+  EXPECT_NE(top_ptr, nullptr);
+  XLS_EXPECT_OK(parser.GetXlsccOnReset());
+}
+
 }  // namespace
@@ -19,6 +19,7 @@
 #include <limits>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -29,54 +30,105 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 
 namespace xls {
 
-BinaryDecisionDiagram::BinaryDecisionDiagram() {
-  // Leaf node 0.
-  nodes_.push_back(BddNode(BddVariable(-1), BddNodeIndex(-1), BddNodeIndex(-1),
-                           /*p=*/1));
-  // Leaf node 1.
+namespace {
+
+constexpr int64_t kInitialComputedTableSize = 1 << 12;
+
+}  // namespace
+
+BinaryDecisionDiagram::BinaryDecisionDiagram(int64_t max_computed_table_size)
+    : max_computed_table_size_(max_computed_table_size) {
+  CHECK_GT(max_computed_table_size, 0);
+  CHECK_EQ(max_computed_table_size & (max_computed_table_size - 1), 0)
+      << "Computed table size must be a power of two";
+  // The terminal node one. Zero is its complement.
   nodes_.push_back(BddNode(BddVariable(-1), BddNodeIndex(-1), BddNodeIndex(-1),
                            /*p=*/1));
+  computed_table_.resize(
+      std::min(kInitialComputedTableSize, max_computed_table_size_));
+  statistics_.peak_node_count = size();
 }
 
 BddNodeIndex BinaryDecisionDiagram::GetOrCreateNode(BddVariable var,
                                                     BddNodeIndex high,
                                                     BddNodeIndex low) {
+  if (low == high) {
+    return low;
+  }
+  // Keep the high edge uncomplemented so each function has a unique
+  // representation: (var, !h, !l) is stored as the complement of (var, h, l).
+  if (IsComplemented(high)) {
+    return Not(GetOrCreateNode(var, Not(high), Not(low)));
+  }
   NodeKey key = std::make_tuple(var, high, low);
   auto it = node_map_.find(key);
   if (it != node_map_.end()) {
     return it->second;
   }
-  if (low == high) {
-    return low;
-  }
   // Compute the number of paths that the new node will have to the terminal
   // nodes 0 and 1. Use int64s to avoid overflowing and saturate at INT32_MAX.
   int32_t paths = std::min(
-      static_cast<int64_t>(GetNode(low).path_count) + GetNode(high).path_count,
+      static_cast<int64_t>(path_count(low)) + path_count(high),
       static_cast<int64_t>(std::numeric_limits<int32_t>::max()));
-  nodes_.emplace_back(var, high, low, paths);
-  BddNodeIndex node_index = BddNodeIndex(nodes_.size() - 1);
+  int32_t slot;
+  if (free_slots_.empty()) {
+    CHECK_LT(nodes_.size(), std::numeric_limits<int32_t>::max() >> 1)
+        << "BDD node limit exceeded";
+    slot = nodes_.size();
+    nodes_.emplace_back(var, high, low, paths);
+  } else {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+    nodes_[slot] = BddNode(var, high, low, paths);
+  }
+  BddNodeIndex node_index = BddNodeIndex(slot << 1);
   node_map_[key] = node_index;
+  statistics_.peak_node_count = std::max(statistics_.peak_node_count, size());
+  MaybeGrowComputedTable();
   return node_index;
 }
 
 BddNodeIndex BinaryDecisionDiagram::Restrict(BddNodeIndex expr, BddVariable var,
-                                             bool value) {
-  if (expr == zero() || expr == one()) {
+                                             bool value) const {
+  if (IsTerminal(expr)) {
     return expr;
   }
 
-  const BddNode& node = GetNode(expr);
-  CHECK_LE(var, node.variable);
-  if (node.variable == var) {
-    return value ? node.high : node.low;
+  CHECK_LE(var, variable(expr));
+  if (variable(expr) == var) {
+    return value ? high(expr) : low(expr);
   }
   return expr;
 }
 
+void BinaryDecisionDiagram::MaybeGrowComputedTable() {
+  int64_t table_size = computed_table_.size();
+  if (table_size >= max_computed_table_size_ || size() <= table_size) {
+    return;
+  }
+  // The table is a cache so entries are simply dropped rather than rehashed.
+  computed_table_.assign(std::min(2 * table_size, max_computed_table_size_),
+                         ComputedTableEntry{});
+}
+
+BinaryDecisionDiagram::ComputedTableEntry&
+BinaryDecisionDiagram::GetComputedTableEntry(BddNodeIndex cond,
+                                             BddNodeIndex if_true,
+                                             BddNodeIndex if_false) {
+  uint64_t hash =
+      static_cast<uint64_t>(static_cast<uint32_t>(cond.value())) *
+          0x9e3779b97f4a7c15ULL ^
+      static_cast<uint64_t>(static_cast<uint32_t>(if_true.value())) *
+          0xc2b2ae3d27d4eb4fULL ^
+      static_cast<uint64_t>(static_cast<uint32_t>(if_false.value())) *
+          0x165667b19e3779f9ULL;
+  return computed_table_[(hash >> 32) & (computed_table_.size() - 1)];
+}
+
 BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
                                                BddNodeIndex if_true,
                                                BddNodeIndex if_false) {
@@ -86,16 +138,55 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
   if (cond == zero()) {
     return if_false;
   }
-  if (if_true == one() && if_false == zero()) {
-    return cond;
+  // Replace operands equal to the condition (or its inverse) with constants:
+  // ite(f, f, h) == ite(f, 1, h), ite(f, g, !f) == ite(f, g, 1), etc.
+  if (if_true == cond) {
+    if_true = one();
+  } else if (if_true == Not(cond)) {
+    if_true = zero();
+  }
+  if (if_false == cond) {
+    if_false = zero();
+  } else if (if_false == Not(cond)) {
+    if_false = one();
   }
   if (if_true == if_false) {
     return if_true;
   }
-  auto key = std::make_tuple(cond, if_true, if_false);
-  auto it = ite_map_.find(key);
-  if (it != ite_map_.end()) {
-    return it->second;
+  if (if_true == one() && if_false == zero()) {
+    return cond;
+  }
+  if (if_true == zero() && if_false == one()) {
+    return Not(cond);
+  }
+
+  // Normalize the expression so the condition and the if-true operand are not
+  // complemented using the identities:
+  //
+  //   ite(!f, g, h) == ite(f, h, g)
+  //   ite(f, !g, !h) == !ite(f, g, h)
+  //
+  // This maps equivalent expressions to the same computed table entry.
+  if (IsComplemented(cond)) {
+    cond = Not(cond);
+    std::swap(if_true, if_false);
+  }
+  bool complement_result = false;
+  if (IsComplemented(if_true)) {
+    if_true = Not(if_true);
+    if_false = Not(if_false);
+    complement_result = true;
+  }
+
+  ++statistics_.computed_table_lookups;
+  {
+    const ComputedTableEntry& entry =
+        GetComputedTableEntry(cond, if_true, if_false);
+    if (entry.cond == cond && entry.if_true == if_true &&
+        entry.if_false == if_false) {
+      ++statistics_.computed_table_hits;
+      return complement_result ? Not(entry.result) : entry.result;
+    }
   }
 
   // The expression is non-trivial and has not been computed before. Recursively
@@ -104,13 +195,13 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
 
   // First, find the lowest-index variable amongst all expressions. In all paths
   // through the BDD the variable indices are strictly increasing.
-  BddVariable min_var = GetNode(cond).variable;
+  BddVariable min_var = variable(cond);
   // Only non-leaf nodes (not zero or one) have associated variables.
-  if (if_true != zero() && if_true != one()) {
-    min_var = std::min(min_var, GetNode(if_true).variable);
+  if (!IsTerminal(if_true)) {
+    min_var = std::min(min_var, variable(if_true));
   }
-  if (if_false != zero() && if_false != one()) {
-    min_var = std::min(min_var, GetNode(if_false).variable);
+  if (!IsTerminal(if_false)) {
+    min_var = std::min(min_var, variable(if_false));
   }
 
   // Perform a Shannon expansion about the variable where Shannon expansion is
@@ -124,34 +215,128 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
   BddNodeIndex false_cofactor = IfThenElse(Restrict(cond, min_var, false),
                                            Restrict(if_true, min_var, false),
                                            Restrict(if_false, min_var, false));
-
-  if (true_cofactor == false_cofactor) {
-    ite_map_[key] = true_cofactor;
-    return true_cofactor;
-  }
   BddNodeIndex expr = GetOrCreateNode(min_var, true_cofactor, false_cofactor);
-  ite_map_[key] = expr;
-  return expr;
+
+  // The recursive calls may have grown (and cleared) the table so look up the
+  // entry again.
+  GetComputedTableEntry(cond, if_true, if_false) = ComputedTableEntry{
+      .cond = cond, .if_true = if_true, .if_false = if_false, .result = expr};
+  return complement_result ? Not(expr) : expr;
 }
 
 BddNodeIndex BinaryDecisionDiagram::NewVariable() {
   BddVariable var = next_var_;
   ++next_var_;
-  return GetOrCreateNode(var, one(), zero());
-}
-
-BddNodeIndex BinaryDecisionDiagram::Not(BddNodeIndex expr) {
-  return IfThenElse(expr, zero(), one());
+  BddNodeIndex node = GetOrCreateNode(var, one(), zero());
+  variable_base_nodes_.push_back(node);
+  return node;
 }
 
 BddNodeIndex BinaryDecisionDiagram::Or(BddNodeIndex a, BddNodeIndex b) {
+  // Order the operands so that commuted expressions share computed table
+  // entries.
+  if (b < a) {
+    std::swap(a, b);
+  }
   return IfThenElse(a, one(), b);
 }
 
 BddNodeIndex BinaryDecisionDiagram::And(BddNodeIndex a, BddNodeIndex b) {
+  if (b < a) {
+    std::swap(a, b);
+  }
   return IfThenElse(a, b, zero());
 }
 
+int64_t BinaryDecisionDiagram::GetNodeCount(
+    absl::Span<const BddNodeIndex> roots) const {
+  std::vector<bool> visited(nodes_.size());
+  std::vector<BddNodeIndex> stack(roots.begin(), roots.end());
+  int64_t count = 0;
+  while (!stack.empty()) {
+    BddNodeIndex expr = stack.back();
+    stack.pop_back();
+    int64_t slot = expr.value() >> 1;
+    if (visited[slot]) {
+      continue;
+    }
+    visited[slot] = true;
+    ++count;
+    if (!IsTerminal(expr)) {
+      stack.push_back(GetNode(expr).high);
+      stack.push_back(GetNode(expr).low);
+    }
+  }
+  return count;
+}
+
+int64_t BinaryDecisionDiagram::GetNodeCountWithoutComplementEdges(
+    absl::Span<const BddNodeIndex> roots) const {
+  // Without complement edges an expression and its inverse are distinct nodes
+  // so track visited edges rather than visited nodes.
+  std::vector<bool> visited(2 * nodes_.size());
+  std::vector<BddNodeIndex> stack(roots.begin(), roots.end());
+  int64_t count = 0;
+  while (!stack.empty()) {
+    BddNodeIndex expr = stack.back();
+    stack.pop_back();
+    if (visited[expr.value()]) {
+      continue;
+    }
+    visited[expr.value()] = true;
+    ++count;
+    if (!IsTerminal(expr)) {
+      stack.push_back(high(expr));
+      stack.push_back(low(expr));
+    }
+  }
+  return count;
+}
+
+int64_t BinaryDecisionDiagram::GarbageCollect(
+    absl::Span<const BddNodeIndex> roots) {
+  // Mark.
+  std::vector<bool> live(nodes_.size());
+  live[0] = true;
+  std::vector<BddNodeIndex> stack(roots.begin(), roots.end());
+  stack.insert(stack.end(), variable_base_nodes_.begin(),
+               variable_base_nodes_.end());
+  while (!stack.empty()) {
+    BddNodeIndex expr = stack.back();
+    stack.pop_back();
+    int64_t slot = expr.value() >> 1;
+    if (live[slot]) {
+      continue;
+    }
+    live[slot] = true;
+    stack.push_back(GetNode(expr).high);
+    stack.push_back(GetNode(expr).low);
+  }
+
+  // Sweep.
+  int64_t freed = 0;
+  for (int32_t slot = 1; slot < nodes_.size(); ++slot) {
+    BddNode& node = nodes_[slot];
+    if (live[slot] || node.path_count == 0) {
+      continue;
+    }
+    node_map_.erase(std::make_tuple(node.variable, node.high, node.low));
+    node = BddNode();
+    free_slots_.push_back(slot);
+    ++freed;
+  }
+  // Entries may refer to freed nodes.
+  std::fill(computed_table_.begin(), computed_table_.end(),
+            ComputedTableEntry{});
+
+  gc_threshold_ = std::max(kMinGarbageCollectionThreshold, 2 * size());
+  ++statistics_.gc_count;
+  statistics_.gc_freed_node_count += freed;
+  VLOG(2) << absl::StreamFormat(
+      "BDD garbage collection freed %d nodes, %d nodes remain", freed, size());
+  return freed;
+}
+
 absl::StatusOr<bool> BinaryDecisionDiagram::Evaluate(
     BddNodeIndex expr,
     const absl::flat_hash_map<BddNodeIndex, bool>& variable_values) const {
@@ -166,19 +351,18 @@ absl::StatusOr<bool> BinaryDecisionDiagram::Evaluate(
     }
     std::sort(variables.begin(), variables.end());
     for (BddNodeIndex node : variables) {
-      VLOG(3) << "    variable " << GetNode(node).variable << ": "
+      VLOG(3) << "    variable " << variable(node) << ": "
               << variable_values.at(node);
     }
   }
-  while (result != zero() && result != one()) {
-    BddNodeIndex var_node = GetVariableBaseNode(GetNode(result).variable);
+  while (!IsTerminal(result)) {
+    BddNodeIndex var_node = GetVariableBaseNode(variable(result));
     if (!variable_values.contains(var_node)) {
       return absl::InvalidArgumentError(
           absl::StrFormat("Missing value for BDD variable %d (node index %d)",
-                          GetNode(result).variable.value(), var_node.value()));
+                          variable(result).value(), var_node.value()));
     }
-    result = variable_values.at(var_node) ? GetNode(result).high
-                                          : GetNode(result).low;
+    result = variable_values.at(var_node) ? high(result) : low(result);
   }
   VLOG(2) << "  result = " << (result == one() ? true : false);
   return result == one();
@@ -209,11 +393,10 @@ void BinaryDecisionDiagram::ToStringDnfHelper(BddNodeIndex expr,
     return;
   }
 
-  const BddNode& node = GetNode(expr);
-  terms->push_back(absl::StrCat("x", node.variable.value()));
-  ToStringDnfHelper(node.high, minterms_to_emit, terms, str);
-  terms->back() = absl::StrCat("!x", node.variable.value());
-  ToStringDnfHelper(node.low, minterms_to_emit, terms, str);
+  terms->push_back(absl::StrCat("x", variable(expr).value()));
+  ToStringDnfHelper(high(expr), minterms_to_emit, terms, str);
+  terms->back() = absl::StrCat("!x", variable(expr).value());
+  ToStringDnfHelper(low(expr), minterms_to_emit, terms, str);
   terms->pop_back();
 }
 
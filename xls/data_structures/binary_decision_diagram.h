@@ -22,6 +22,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/strong_int.h"
 
 namespace xls {
@@ -34,15 +35,25 @@ namespace xls {
 //   K.S. Brace, R.L. Rudell, and R.E. Bryant,
 //   "Efficient Implementation of a BDD package"
 //   https://ieeexplore.ieee.org/document/114826
+//
+// As described in the paper the BDD uses complement edges: an expression and
+// its inverse share a single node and differ only in a complement bit on the
+// edge referring to the node. This roughly halves the number of nodes and
+// makes Not a constant-time operation. If-then-else results are memoized in a
+// bounded, direct-mapped computed table, and nodes which are no longer
+// referenced may be reclaimed with GarbageCollect.
 
 // For efficiency variables and nodes are referred to by indices into vector
-// data members in the BDD.
+// data members in the BDD. A BddNodeIndex is an edge in the graph: the low bit
+// is the complement flag and the remaining bits are the index of the node in
+// the node vector.
 XLS_DEFINE_STRONG_INT_TYPE(BddVariable, int32_t);
 XLS_DEFINE_STRONG_INT_TYPE(BddNodeIndex, int32_t);
 
 // A node in the BDD. The node is associated with a single variable and has
 // children corresponding to when the variable is true (high) and when it is
-// false (low).
+// false (low). The high child of a stored node is never a complemented edge,
+// which makes the representation canonical.
 struct BddNode {
   BddNode() : variable(0), high(0), low(0), path_count(0) {}
   BddNode(BddVariable v, BddNodeIndex h, BddNodeIndex l, int32_t p)
@@ -54,30 +65,64 @@ struct BddNode {
 
   // Number of paths from this node to the terminal nodes 0 and 1. Used to limit
   // the growth of the BDD by halting evaluation if the number of paths gets too
-  // large. Saturates at INT32_MAX.
+  // large. Saturates at INT32_MAX. Zero for slots which have been freed by
+  // garbage collection.
   int32_t path_count;
 };
 
 class BinaryDecisionDiagram {
  public:
-  // Creates an empty BDD. Initialize the BDD contains only the nodes
-  // corresponding to zero and one.
-  BinaryDecisionDiagram();
+  // Default upper bound on the number of entries in the if-then-else computed
+  // table. Each entry is 16 bytes.
+  static constexpr int64_t kDefaultMaxComputedTableSize = int64_t{1} << 20;
+
+  // The minimum number of live nodes before ShouldGarbageCollect returns true.
+  static constexpr int64_t kMinGarbageCollectionThreshold = int64_t{1} << 16;
+
+  // Counters describing the work done by the BDD.
+  struct Statistics {
+    // Largest number of live nodes at any point.
+    int64_t peak_node_count = 0;
+    // Number of calls to GarbageCollect and the total number of nodes those
+    // calls freed.
+    int64_t gc_count = 0;
+    int64_t gc_freed_node_count = 0;
+    // Number of lookups in the if-then-else computed table and how many of
+    // them found a result.
+    int64_t computed_table_lookups = 0;
+    int64_t computed_table_hits = 0;
+  };
+
+  // Creates an empty BDD. Initialize the BDD contains only the terminal node
+  // corresponding to one (zero is its complement). `max_computed_table_size`
+  // bounds the number of memoized if-then-else results and must be a power of
+  // two.
+  explicit BinaryDecisionDiagram(
+      int64_t max_computed_table_size = kDefaultMaxComputedTableSize);
 
   // Adds a new variable to the BDD and returns the node corresponding the
   // variable's value.
   BddNodeIndex NewVariable();
 
-  // Returns the inverse of the given expression.
-  BddNodeIndex Not(BddNodeIndex expr);
+  // Returns the inverse of the given expression. This is a constant-time
+  // operation which never creates new nodes.
+  BddNodeIndex Not(BddNodeIndex expr) const {
+    return BddNodeIndex(expr.value() ^ 1);
+  }
 
   // Returns the OR/AND of the given expressions.
   BddNodeIndex And(BddNodeIndex a, BddNodeIndex b);
   BddNodeIndex Or(BddNodeIndex a, BddNodeIndex b);
 
   // Returns the leaf node corresponding to zero or one.
-  BddNodeIndex zero() const { return BddNodeIndex(0); }
-  BddNodeIndex one() const { return BddNodeIndex(1); }
+  BddNodeIndex zero() const { return BddNodeIndex(1); }
+  BddNodeIndex one() const { return BddNodeIndex(0); }
+
+  // Returns whether the given edge is complemented, i.e., whether the
+  // expression is the inverse of the node it refers to.
+  static bool IsComplemented(BddNodeIndex expr) {
+    return (expr.value() & 1) != 0;
+  }
 
   // Evaluates the given expression with the given variable values. The keys in
   // the map are the *node* indices of the respective variable (value returned
@@ -87,13 +132,28 @@ class BinaryDecisionDiagram {
       BddNodeIndex expr,
       const absl::flat_hash_map<BddNodeIndex, bool>& variable_values) const;
 
-  // Returns the BDD node with the given index.
+  // Returns the BDD node referred to by the given edge. The complement flag of
+  // the edge is ignored so the children of the returned node are those of the
+  // uncomplemented expression; use high() and low() to get the children of
+  // `node_index` itself.
   const BddNode& GetNode(BddNodeIndex node_index) const {
-    return nodes_.at(node_index.value());
+    return nodes_.at(node_index.value() >> 1);
+  }
+
+  // Returns the variable of the given non-terminal expression and the
+  // expression with that variable set to true (high) or false (low).
+  BddVariable variable(BddNodeIndex expr) const {
+    return GetNode(expr).variable;
+  }
+  BddNodeIndex high(BddNodeIndex expr) const {
+    return BddNodeIndex(GetNode(expr).high.value() ^ (expr.value() & 1));
+  }
+  BddNodeIndex low(BddNodeIndex expr) const {
+    return BddNodeIndex(GetNode(expr).low.value() ^ (expr.value() & 1));
   }
 
-  // Returns the number of nodes in the graph.
-  int64_t size() const { return nodes_.size(); }
+  // Returns the number of live nodes in the graph.
+  int64_t size() const { return nodes_.size() - free_slots_.size(); }
 
   // Returns the number of variables in the graph.
   int64_t variable_count() const { return next_var_.value(); }
@@ -103,6 +163,28 @@ class BinaryDecisionDiagram {
     return GetNode(expr).path_count;
   }
 
+  // Returns the number of distinct nodes (including the terminal) reachable
+  // from the given expressions.
+  int64_t GetNodeCount(absl::Span<const BddNodeIndex> roots) const;
+
+  // Returns the number of nodes the expressions would need in a BDD without
+  // complement edges, i.e., the number of distinct expressions reachable from
+  // `roots` where an expression and its inverse are counted separately.
+  int64_t GetNodeCountWithoutComplementEdges(
+      absl::Span<const BddNodeIndex> roots) const;
+
+  // Frees every node which is not reachable from `roots` and clears the
+  // computed table. Variable nodes are always kept. Any BddNodeIndex not
+  // reachable from `roots` is invalid after this call. Returns the number of
+  // nodes freed.
+  int64_t GarbageCollect(absl::Span<const BddNodeIndex> roots);
+
+  // Returns true if the BDD has grown enough since the last garbage collection
+  // that another collection is likely to be worthwhile.
+  bool ShouldGarbageCollect() const { return size() >= gc_threshold_; }
+
+  const Statistics& statistics() const { return statistics_; }
+
   // Returns the given expression in disjunctive normal form (sum of products).
   // The expression is not minimal. 'minterm_limit' is the maximum number of
   // minterms to emit before truncating the output.
@@ -112,10 +194,21 @@ class BinaryDecisionDiagram {
   // variable. The expression of a base node is exactly equal to the value of
   // the variable.
   bool IsVariableBaseNode(BddNodeIndex expr) const {
-    return GetNode(expr).high == one() && GetNode(expr).low == zero();
+    return !IsTerminal(expr) && high(expr) == one() && low(expr) == zero();
   }
 
  private:
+  // An entry in the if-then-else computed table. An entry with a terminal
+  // condition is empty as such expressions are never memoized.
+  struct ComputedTableEntry {
+    BddNodeIndex cond;
+    BddNodeIndex if_true;
+    BddNodeIndex if_false;
+    BddNodeIndex result;
+  };
+
+  bool IsTerminal(BddNodeIndex expr) const { return (expr.value() >> 1) == 0; }
+
   // Helper for constructing a DNF string respresentation.
   void ToStringDnfHelper(BddNodeIndex expr, int64_t* minterms_to_emit,
                          std::vector<std::string>* terms,
@@ -128,23 +221,37 @@ class BinaryDecisionDiagram {
 
   // Returns the node equal to given expression with the given variable
   // set to the given value.
-  BddNodeIndex Restrict(BddNodeIndex expr, BddVariable var, bool value);
+  BddNodeIndex Restrict(BddNodeIndex expr, BddVariable var, bool value) const;
 
   // Returns the node corresponding to the given if-then-else expression.
   BddNodeIndex IfThenElse(BddNodeIndex cond, BddNodeIndex if_true,
                           BddNodeIndex if_false);
 
+  // Returns the computed table entry the given if-then-else expression maps to.
+  ComputedTableEntry& GetComputedTableEntry(BddNodeIndex cond,
+                                            BddNodeIndex if_true,
+                                            BddNodeIndex if_false);
+
+  // Grows the computed table (up to its maximum size) so it is at least as
+  // large as the number of live nodes.
+  void MaybeGrowComputedTable();
+
   // Returns the node corresponding to the value of the given variable.
   BddNodeIndex GetVariableBaseNode(BddVariable variable) const {
-    return node_map_.at({variable, one(), zero()});
+    return variable_base_nodes_.at(variable.value());
   }
 
   // The numeric id to use for the next created variable. Increments with each
   // call to NewVariable which
   BddVariable next_var_ = BddVariable(0);
 
-  // The vector of all the nodes in the BDD.
+  // The vector of all the nodes in the BDD. Slots freed by garbage collection
+  // are recorded in `free_slots_` and reused for new nodes.
   std::vector<BddNode> nodes_;
+  std::vector<int32_t> free_slots_;
+
+  // The base node of each variable indexed by variable id.
+  std::vector<BddNodeIndex> variable_base_nodes_;
 
   // A map from BDD node content (variable id, high child, low child) to the
   // index of the respective node. This map is used to ensure that no duplicate
@@ -152,11 +259,16 @@ class BinaryDecisionDiagram {
   using NodeKey = std::tuple<BddVariable, BddNodeIndex, BddNodeIndex>;
   absl::flat_hash_map<NodeKey, BddNodeIndex> node_map_;
 
-  // A map from if-then-else expression to the node corresponding to that
-  // expression. The key elements are (condition, if-true, if-false). This map
-  // enables fast lookup for expressions.
-  using IteKey = std::tuple<BddNodeIndex, BddNodeIndex, BddNodeIndex>;
-  absl::flat_hash_map<IteKey, BddNodeIndex> ite_map_;
+  // A direct-mapped cache from normalized if-then-else expression to the node
+  // corresponding to that expression. Colliding entries overwrite each other so
+  // memory use is bounded. The size is always a power of two.
+  std::vector<ComputedTableEntry> computed_table_;
+  int64_t max_computed_table_size_;
+
+  // The live node count at which ShouldGarbageCollect returns true.
+  int64_t gc_threshold_ = kMinGarbageCollectionThreshold;
+
+  Statistics statistics_;
 };
 
 }  // namespace xls
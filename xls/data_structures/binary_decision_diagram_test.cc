@@ -312,5 +312,106 @@ TEST(BinaryDecisionDiagramTest, ThreeVariableExhaustive) {
   }
 }
 
+TEST(BinaryDecisionDiagramTest, NotSharesNodes) {
+  BinaryDecisionDiagram bdd;
+  BddNodeIndex x0 = bdd.NewVariable();
+  BddNodeIndex x1 = bdd.NewVariable();
+  BddNodeIndex expr = bdd.Or(bdd.And(x0, x1), bdd.Not(x1));
+
+  int64_t before_size = bdd.size();
+  BddNodeIndex not_expr = bdd.Not(expr);
+  EXPECT_EQ(bdd.size(), before_size);
+  EXPECT_NE(not_expr, expr);
+  EXPECT_EQ(bdd.Not(not_expr), expr);
+  EXPECT_EQ(bdd.Not(bdd.zero()), bdd.one());
+  EXPECT_EQ(bdd.Not(bdd.Or(bdd.And(x0, x1), bdd.Not(x1))), not_expr);
+  EXPECT_FALSE(bdd.IsVariableBaseNode(bdd.Not(x0)));
+  EXPECT_TRUE(bdd.IsVariableBaseNode(x0));
+}
+
+TEST(BinaryDecisionDiagramTest, ComplementEdgesHalveParity) {
+  BinaryDecisionDiagram bdd;
+  constexpr int64_t kVariableCount = 16;
+  BddNodeIndex parity = bdd.zero();
+  for (int64_t i = 0; i < kVariableCount; ++i) {
+    BddNodeIndex x = bdd.NewVariable();
+    parity = bdd.Or(bdd.And(parity, bdd.Not(x)), bdd.And(bdd.Not(parity), x));
+  }
+  // With complement edges each variable needs a single node plus the terminal.
+  // Without them both polarities of each sub-parity are needed (except at the
+  // root) as well as both terminals.
+  EXPECT_EQ(bdd.GetNodeCount({parity}), kVariableCount + 1);
+  EXPECT_EQ(bdd.GetNodeCountWithoutComplementEdges({parity}),
+            2 * kVariableCount + 1);
+}
+
+TEST(BinaryDecisionDiagramTest, GarbageCollect) {
+  BinaryDecisionDiagram bdd;
+  std::vector<BddNodeIndex> vars;
+  for (int64_t i = 0; i < 8; ++i) {
+    vars.push_back(bdd.NewVariable());
+  }
+  BddNodeIndex keep = bdd.And(bdd.Or(vars[0], vars[1]), vars[7]);
+  // Create a bunch of garbage.
+  for (int64_t i = 0; i < 8; ++i) {
+    for (int64_t j = i + 1; j < 8; ++j) {
+      bdd.Or(bdd.And(vars[i], bdd.Not(vars[j])), bdd.And(vars[j], vars[0]));
+    }
+  }
+  int64_t before_size = bdd.size();
+  int64_t freed = bdd.GarbageCollect({keep});
+  EXPECT_GT(freed, 0);
+  EXPECT_EQ(bdd.size(), before_size - freed);
+  // Everything left is reachable from `keep` or the variables.
+  std::vector<BddNodeIndex> roots = vars;
+  roots.push_back(keep);
+  EXPECT_EQ(bdd.size(), bdd.GetNodeCount(roots));
+  EXPECT_EQ(bdd.statistics().gc_count, 1);
+  EXPECT_EQ(bdd.statistics().gc_freed_node_count, freed);
+  EXPECT_GE(bdd.statistics().peak_node_count, before_size);
+
+  // Surviving expressions are unchanged and are found again when rebuilt.
+  EXPECT_EQ(bdd.And(bdd.Or(vars[0], vars[1]), vars[7]), keep);
+  EXPECT_THAT(bdd.Evaluate(keep, {{vars[0], true}, {vars[1], false},
+                                  {vars[7], true}}),
+              IsOkAndHolds(true));
+
+  // Freed slots are reused.
+  int64_t after_gc_size = bdd.size();
+  BddNodeIndex rebuilt = bdd.Or(bdd.And(vars[2], bdd.Not(vars[3])),
+                                bdd.And(vars[3], vars[0]));
+  EXPECT_GT(bdd.size(), after_gc_size);
+  EXPECT_LE(bdd.size(), before_size);
+  for (bool x0 : {false, true}) {
+    for (bool x2 : {false, true}) {
+      for (bool x3 : {false, true}) {
+        EXPECT_THAT(bdd.Evaluate(rebuilt,
+                                 {{vars[0], x0}, {vars[2], x2}, {vars[3], x3}}),
+                    IsOkAndHolds((x2 && !x3) || (x3 && x0)));
+      }
+    }
+  }
+}
+
+TEST(BinaryDecisionDiagramTest, TinyComputedTable) {
+  // A computed table with a single entry thrashes constantly but still produces
+  // the same canonical results.
+  BinaryDecisionDiagram small_bdd(/*max_computed_table_size=*/1);
+  BinaryDecisionDiagram bdd;
+  BddNodeIndex small_parity = small_bdd.zero();
+  BddNodeIndex parity = bdd.zero();
+  for (int64_t i = 0; i < 12; ++i) {
+    BddNodeIndex small_x = small_bdd.NewVariable();
+    BddNodeIndex x = bdd.NewVariable();
+    small_parity =
+        small_bdd.Or(small_bdd.And(small_parity, small_bdd.Not(small_x)),
+                     small_bdd.And(small_bdd.Not(small_parity), small_x));
+    parity = bdd.Or(bdd.And(parity, bdd.Not(x)), bdd.And(bdd.Not(parity), x));
+  }
+  EXPECT_EQ(small_bdd.ToStringDnf(small_parity), bdd.ToStringDnf(parity));
+  EXPECT_EQ(small_bdd.GetNodeCount({small_parity}), bdd.GetNodeCount({parity}));
+  EXPECT_GT(bdd.statistics().computed_table_hits, 0);
+}
+
 }  // namespace
 }  // namespace xls
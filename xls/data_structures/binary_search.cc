@@ -14,13 +14,18 @@
 
 #include "xls/data_structures/binary_search.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
 
 #include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 
 namespace xls {
 
@@ -104,4 +109,63 @@ absl::StatusOr<int64_t> BinarySearchMinTrueWithStatus(
   return lowest_true;
 }
 
+absl::StatusOr<int64_t> ParallelBinarySearchMinTrueWithStatus(
+    int64_t start, int64_t end, int64_t worker_count,
+    absl::FunctionRef<absl::StatusOr<bool>(int64_t worker, int64_t i)> f,
+    BinarySearchAssumptions assumptions) {
+  XLS_RET_CHECK_LE(start, end);
+  XLS_RET_CHECK_GE(worker_count, 1);
+  if (assumptions != BinarySearchAssumptions::kEndKnownTrue) {
+    XLS_ASSIGN_OR_RETURN(bool f_end, f(/*worker=*/0, end));
+    if (!f_end) {
+      return absl::InvalidArgumentError(
+          "Highest value in range fails condition of binary search.");
+    }
+  }
+
+  // Invariant: every value <= `highest_false` fails and every value >=
+  // `lowest_true` passes; `start - 1` is never evaluated.
+  int64_t highest_false = start - 1;
+  int64_t lowest_true = end;
+  while (highest_false < lowest_true - 1) {
+    // Place `k` probes strictly inside (highest_false, lowest_true), splitting
+    // the window into k+1 nearly equal pieces.
+    const int64_t width = lowest_true - highest_false;
+    const int64_t k = std::min(worker_count, width - 1);
+    const int64_t step = width / (k + 1);
+    const int64_t remainder = width % (k + 1);
+    std::vector<int64_t> probes(k);
+    for (int64_t j = 0; j < k; ++j) {
+      probes[j] = highest_false + step * (j + 1) + std::min(j + 1, remainder);
+    }
+
+    std::vector<std::optional<absl::StatusOr<bool>>> results(k);
+    if (k == 1) {
+      results[0] = f(/*worker=*/0, probes[0]);
+    } else {
+      std::vector<std::unique_ptr<Thread>> threads;
+      threads.reserve(k);
+      for (int64_t j = 0; j < k; ++j) {
+        threads.push_back(std::make_unique<Thread>(
+            [&, j]() { results[j] = f(/*worker=*/j, probes[j]); }));
+      }
+      for (std::unique_ptr<Thread>& thread : threads) {
+        thread->Join();
+      }
+    }
+
+    // Probes are in increasing order so, by monotonicity, the first passing
+    // probe bounds the window from above and the one before it from below.
+    for (int64_t j = 0; j < k; ++j) {
+      XLS_ASSIGN_OR_RETURN(bool f_probe, *std::move(results[j]));
+      if (f_probe) {
+        lowest_true = probes[j];
+        break;
+      }
+      highest_false = probes[j];
+    }
+  }
+  return lowest_true;
+}
+
 }  // namespace xls
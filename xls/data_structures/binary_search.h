@@ -55,6 +55,19 @@ absl::StatusOr<int64_t> BinarySearchMinTrueWithStatus(
     absl::FunctionRef<absl::StatusOr<bool>(int64_t i)> f,
     BinarySearchAssumptions assumptions = BinarySearchAssumptions::kNone);
 
+// Variant of BinarySearchMinTrueWithStatus which evaluates up to
+// `worker_count` points of the range concurrently, each on its own thread.
+// Every round probes k evenly spaced points of the remaining window, which
+// shrinks the window by a factor of k+1 rather than 2. `f` is called as
+// `f(worker, i)` where `worker` in [0, worker_count) is unique among the calls
+// running at the same time, so callers can keep per-worker state (e.g. a
+// non-thread-safe solver). An error from a probe is returned unless a lower
+// probe of the same round already returned true.
+absl::StatusOr<int64_t> ParallelBinarySearchMinTrueWithStatus(
+    int64_t start, int64_t end, int64_t worker_count,
+    absl::FunctionRef<absl::StatusOr<bool>(int64_t worker, int64_t i)> f,
+    BinarySearchAssumptions assumptions = BinarySearchAssumptions::kNone);
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_BINARY_SEARCH_H_
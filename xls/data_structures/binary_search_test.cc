@@ -14,6 +14,7 @@
 
 #include "xls/data_structures/binary_search.h"
 
+#include <atomic>
 #include <cstdint>
 
 #include "gmock/gmock.h"
@@ -103,6 +104,61 @@ TEST(BinarySearchTest, NumTimesFunctionCalled) {
   EXPECT_LT(f_called, 25);
 }
 
+TEST(BinarySearchTest, ParallelMinTrue) {
+  const int64_t kMaxSize = 10;
+  for (int64_t workers : {1, 2, 3, 8}) {
+    for (int start = 0; start < kMaxSize; ++start) {
+      for (int end = start; end < kMaxSize; ++end) {
+        for (int target = start; target <= end; ++target) {
+          auto got = ParallelBinarySearchMinTrueWithStatus(
+              start, end, workers,
+              [&](int64_t worker, int64_t i) -> absl::StatusOr<bool> {
+                EXPECT_LT(worker, workers);
+                return i >= target;
+              });
+          EXPECT_THAT(got, IsOkAndHolds(target));
+        }
+      }
+    }
+  }
+}
+
+TEST(BinarySearchTest, ParallelMinTrueUsesFewerRounds) {
+  std::atomic<int64_t> f_called = 0;
+  std::atomic<int64_t> max_worker = 0;
+  auto f = [&](int64_t worker, int64_t i) -> absl::StatusOr<bool> {
+    f_called++;
+    int64_t seen = max_worker.load();
+    while (worker > seen && !max_worker.compare_exchange_weak(seen, worker)) {
+    }
+    return i >= 123456;
+  };
+  EXPECT_THAT(ParallelBinarySearchMinTrueWithStatus(
+                  0, 1024 * 1024, /*worker_count=*/7, f,
+                  BinarySearchAssumptions::kEndKnownTrue),
+              IsOkAndHolds(123456));
+  // Each round shrinks the window by a factor of 8, so 7 rounds of 7 probes
+  // suffice for a window of 2^20.
+  EXPECT_LE(f_called, 7 * 7);
+  EXPECT_EQ(max_worker, 6);
+
+  EXPECT_THAT(
+      ParallelBinarySearchMinTrueWithStatus(
+          1, 42, /*worker_count=*/4,
+          [&](int64_t, int64_t i) -> absl::StatusOr<bool> { return false; }),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("Highest value in range fails condition")));
+  EXPECT_THAT(ParallelBinarySearchMinTrueWithStatus(
+                  1, 42, /*worker_count=*/4,
+                  [&](int64_t, int64_t i) -> absl::StatusOr<bool> {
+                    if (i == 42) {
+                      return true;
+                    }
+                    return absl::UnimplementedError("qux");
+                  }),
+              StatusIs(absl::StatusCode::kUnimplemented, HasSubstr("qux")));
+}
+
 TEST(BinarySearchTest, ErrorConditions) {
   // Note: some compilers dislike the lambda living inside the macro, so we
   // hoist the compared-to values.
@@ -0,0 +1,195 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/data_structures/graph_coloring.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
+#include "absl/numeric/bits.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
+
+namespace xls {
+namespace {
+
+// Calls `f` with the index of each bit set in both `a` and `b`.
+template <typename F>
+void ForEachBitInIntersection(const InlineBitmap& a, const InlineBitmap& b,
+                              F f) {
+  for (int64_t wordno = 0; wordno < a.word_count(); ++wordno) {
+    uint64_t word = a.GetWord(wordno) & b.GetWord(wordno);
+    while (word != 0) {
+      f(wordno * 64 + absl::countr_zero(word));
+      word &= word - 1;
+    }
+  }
+}
+
+// Colors the vertices set in `vertices` with DSatur, writing the color of each
+// into `colors`. No vertex in `vertices` may be adjacent to a vertex outside
+// of it. Returns the number of colors used.
+int64_t DSaturColorVertices(absl::Span<const InlineBitmap> adjacency,
+                            InlineBitmap vertices,
+                            std::vector<int64_t>& colors) {
+  const int64_t n = adjacency.size();
+  // `uncolored` is the set of vertices still to be colored.
+  InlineBitmap& uncolored = vertices;
+  std::vector<int64_t> saturation(n, 0);
+  std::vector<int64_t> uncolored_degree(n, 0);
+  std::vector<int64_t> candidates;
+  for (int64_t v = 0; v < n; ++v) {
+    if (uncolored.Get(v)) {
+      CHECK_EQ(adjacency[v].bit_count(), n);
+      CHECK(!adjacency[v].Get(v)) << "Vertex " << v << " has a self loop";
+      for (int64_t wordno = 0; wordno < adjacency[v].word_count(); ++wordno) {
+        uncolored_degree[v] += absl::popcount(adjacency[v].GetWord(wordno));
+      }
+      candidates.push_back(v);
+    }
+  }
+
+  // The union of the neighborhoods of the vertices of each color.
+  std::vector<InlineBitmap> color_neighborhoods;
+  for (int64_t step = 0; step < candidates.size(); ++step) {
+    std::optional<int64_t> best;
+    for (int64_t v : candidates) {
+      if (uncolored.Get(v) &&
+          (!best.has_value() ||
+           std::tie(saturation[v], uncolored_degree[v]) >
+               std::tie(saturation[*best], uncolored_degree[*best]))) {
+        best = v;
+      }
+    }
+    const int64_t v = best.value();
+    const InlineBitmap& neighbors = adjacency[v];
+
+    int64_t color = 0;
+    while (color < color_neighborhoods.size() &&
+           color_neighborhoods[color].Get(v)) {
+      ++color;
+    }
+    if (color == color_neighborhoods.size()) {
+      color_neighborhoods.push_back(InlineBitmap(n));
+    }
+    colors[v] = color;
+    uncolored.Set(v, false);
+
+    // Uncolored neighbors which had no neighbor of this color yet gain
+    // saturation; every uncolored neighbor loses one uncolored neighbor.
+    InlineBitmap& color_neighborhood = color_neighborhoods[color];
+    ForEachBitInIntersection(neighbors, uncolored, [&](int64_t u) {
+      --uncolored_degree[u];
+      if (!color_neighborhood.Get(u)) {
+        ++saturation[u];
+      }
+    });
+    color_neighborhood.Union(neighbors);
+  }
+  return color_neighborhoods.size();
+}
+
+std::vector<std::vector<int64_t>> ColorClasses(
+    absl::Span<const int64_t> colors, int64_t color_count) {
+  std::vector<std::vector<int64_t>> result(color_count);
+  for (int64_t v = 0; v < colors.size(); ++v) {
+    CHECK_GE(colors[v], 0);
+    result[colors[v]].push_back(v);
+  }
+  return result;
+}
+
+}  // namespace
+
+std::vector<std::vector<int64_t>> DSaturColoring(
+    absl::Span<const InlineBitmap> adjacency) {
+  const int64_t n = adjacency.size();
+  std::vector<int64_t> colors(n, -1);
+  int64_t color_count =
+      DSaturColorVertices(adjacency, InlineBitmap(n, /*fill=*/true), colors);
+  return ColorClasses(colors, color_count);
+}
+
+std::vector<std::vector<int64_t>> DenseColoring(
+    absl::Span<const InlineBitmap> adjacency,
+    const DenseColoringOptions& options) {
+  if (options.exact_component_size_limit <= 0) {
+    return DSaturColoring(adjacency);
+  }
+  const int64_t n = adjacency.size();
+  std::vector<int64_t> colors(n, -1);
+  int64_t color_count = 0;
+
+  // Find the connected components by a breadth-first search which adds the
+  // unvisited neighbors of each vertex a word at a time.
+  InlineBitmap unvisited(n, /*fill=*/true);
+  for (int64_t root = 0; root < n; ++root) {
+    if (!unvisited.Get(root)) {
+      continue;
+    }
+    InlineBitmap component(n);
+    std::vector<int64_t> members = {root};
+    component.Set(root);
+    unvisited.Set(root, false);
+    for (int64_t i = 0; i < members.size(); ++i) {
+      ForEachBitInIntersection(adjacency[members[i]], unvisited,
+                               [&](int64_t u) {
+                                 component.Set(u);
+                                 unvisited.Set(u, false);
+                                 members.push_back(u);
+                               });
+    }
+
+    int64_t component_colors;
+    if (members.size() > 2 &&
+        members.size() <= options.exact_component_size_limit) {
+      std::vector<absl::flat_hash_set<int64_t>> classes = Z3Coloring<int64_t>(
+          absl::flat_hash_set<int64_t>(members.begin(), members.end()),
+          [&](const int64_t& v) -> absl::flat_hash_set<int64_t> {
+            absl::flat_hash_set<int64_t> neighbors;
+            for (int64_t u : members) {
+              if (adjacency[v].Get(u)) {
+                neighbors.insert(u);
+              }
+            }
+            return neighbors;
+          });
+      component_colors = 0;
+      for (const absl::flat_hash_set<int64_t>& color_class : classes) {
+        if (color_class.empty()) {
+          continue;
+        }
+        for (int64_t v : color_class) {
+          colors[v] = component_colors;
+        }
+        ++component_colors;
+      }
+    } else {
+      component_colors =
+          DSaturColorVertices(adjacency, std::move(component), colors);
+    }
+    color_count = std::max(color_count, component_colors);
+  }
+
+  return ColorClasses(colors, color_count);
+}
+
+}  // namespace xls
@@ -28,7 +28,9 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "external/z3/src/api/c++/z3++.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 
@@ -226,6 +228,36 @@ std::vector<absl::flat_hash_set<V>> Z3Coloring(
   return result;
 }
 
+// Colors the graph over the vertices 0..n-1 given as an adjacency matrix: bit j
+// of `adjacency[i]` is set iff i and j are adjacent. The matrix must be
+// symmetric and have no self loops.
+//
+// This is the DSatur algorithm: the next vertex colored is always the one with
+// the most distinctly colored neighbors (ties broken by the number of uncolored
+// neighbors), and it is given the smallest color none of its neighbors has.
+// The neighborhood of each color class is kept as a bitmap so that choosing a
+// color is a bit test and updating the saturation of the neighbors is a
+// word-wise scan of one row. This takes O(n^2) time, which is far less than
+// RecursiveLargestFirstColoring for graphs with thousands of vertices.
+//
+// Returns the color classes, each of which is sorted.
+std::vector<std::vector<int64_t>> DSaturColoring(
+    absl::Span<const InlineBitmap> adjacency);
+
+struct DenseColoringOptions {
+  // Connected components with at most this many vertices are colored with the
+  // minimum number of colors using Z3Coloring rather than with DSatur. Zero
+  // disables exact coloring.
+  int64_t exact_component_size_limit = 0;
+};
+
+// Colors the graph given as an adjacency matrix (see DSaturColoring) one
+// connected component at a time, coloring small components exactly according
+// to `options`. The components share colors.
+std::vector<std::vector<int64_t>> DenseColoring(
+    absl::Span<const InlineBitmap> adjacency,
+    const DenseColoringOptions& options = DenseColoringOptions());
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_GRAPH_COLORING_H_
@@ -14,12 +14,18 @@
 
 #include "xls/data_structures/graph_coloring.h"
 
+#include <cstdint>
+#include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "benchmark/benchmark.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 namespace {
@@ -143,5 +149,168 @@ TEST(GraphColoringTest, Wheel) {
   EXPECT_TRUE(IsValidColoring(graph, Z3FromMap(graph)));
 }
 
+// Returns the adjacency matrix of a random graph over `n` vertices in which
+// each pair of vertices is adjacent with probability `percent`/100.
+std::vector<InlineBitmap> RandomGraph(int64_t n, int64_t percent,
+                                      uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<int64_t> dist(0, 99);
+  std::vector<InlineBitmap> adjacency(n, InlineBitmap(n));
+  for (int64_t i = 0; i < n; ++i) {
+    for (int64_t j = i + 1; j < n; ++j) {
+      if (dist(rng) < percent) {
+        adjacency[i].Set(j);
+        adjacency[j].Set(i);
+      }
+    }
+  }
+  return adjacency;
+}
+
+// Returns the adjacency matrix of the (symmetric closure of the) given graph.
+std::vector<InlineBitmap> ToMatrix(
+    const absl::flat_hash_map<V, absl::flat_hash_set<V>>& neighborhood) {
+  absl::flat_hash_map<V, int64_t> index;
+  for (const auto& [node, neighbors] : neighborhood) {
+    index.try_emplace(node, index.size());
+    for (const V& neighbor : neighbors) {
+      index.try_emplace(neighbor, index.size());
+    }
+  }
+  std::vector<InlineBitmap> adjacency(index.size(), InlineBitmap(index.size()));
+  for (const auto& [node, neighbors] : neighborhood) {
+    for (const V& neighbor : neighbors) {
+      adjacency[index.at(node)].Set(index.at(neighbor));
+      adjacency[index.at(neighbor)].Set(index.at(node));
+    }
+  }
+  return adjacency;
+}
+
+// Returns true if every vertex is in exactly one color class and no two
+// adjacent vertices share a color.
+bool IsValidDenseColoring(absl::Span<const InlineBitmap> adjacency,
+                          const std::vector<std::vector<int64_t>>& coloring) {
+  std::vector<int64_t> colors(adjacency.size(), -1);
+  for (int64_t color = 0; color < coloring.size(); ++color) {
+    if (coloring[color].empty()) {
+      return false;
+    }
+    for (int64_t v : coloring[color]) {
+      if (colors[v] != -1) {
+        return false;
+      }
+      colors[v] = color;
+    }
+  }
+  for (int64_t i = 0; i < adjacency.size(); ++i) {
+    if (colors[i] == -1) {
+      return false;
+    }
+    for (int64_t j = 0; j < adjacency.size(); ++j) {
+      if (adjacency[i].Get(j) && colors[i] == colors[j]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+TEST(GraphColoringTest, DenseColoringOfSmallGraphs) {
+  absl::flat_hash_map<V, absl::flat_hash_set<V>> cycle;
+  cycle["a"].insert("b");
+  cycle["b"].insert("c");
+  cycle["c"].insert("d");
+  cycle["d"].insert("e");
+  cycle["e"].insert("a");
+  absl::flat_hash_map<V, absl::flat_hash_set<V>> wheel = cycle;
+  wheel["center"] = {"a", "b", "c", "d", "e"};
+
+  for (const auto& [graph, chromatic_number] :
+       {std::pair(cycle, 3), std::pair(wheel, 4)}) {
+    std::vector<InlineBitmap> adjacency = ToMatrix(graph);
+    std::vector<std::vector<int64_t>> dsatur = DSaturColoring(adjacency);
+    EXPECT_TRUE(IsValidDenseColoring(adjacency, dsatur));
+    EXPECT_EQ(dsatur.size(), chromatic_number);
+    std::vector<std::vector<int64_t>> exact =
+        DenseColoring(adjacency, {.exact_component_size_limit = 8});
+    EXPECT_TRUE(IsValidDenseColoring(adjacency, exact));
+    EXPECT_EQ(exact.size(), chromatic_number);
+  }
+}
+
+TEST(GraphColoringTest, DSaturColorsBipartiteGraphsOptimally) {
+  // The crown graph (a complete bipartite graph without a perfect matching)
+  // defeats greedy coloring in vertex order but not DSatur.
+  constexpr int64_t kHalf = 20;
+  std::vector<InlineBitmap> adjacency(2 * kHalf, InlineBitmap(2 * kHalf));
+  for (int64_t i = 0; i < kHalf; ++i) {
+    for (int64_t j = 0; j < kHalf; ++j) {
+      if (i != j) {
+        adjacency[2 * i].Set(2 * j + 1);
+        adjacency[2 * j + 1].Set(2 * i);
+      }
+    }
+  }
+  std::vector<std::vector<int64_t>> coloring = DSaturColoring(adjacency);
+  EXPECT_TRUE(IsValidDenseColoring(adjacency, coloring));
+  EXPECT_EQ(coloring.size(), 2);
+}
+
+TEST(GraphColoringTest, DenseColoringOfRandomGraphs) {
+  for (uint64_t seed = 0; seed < 5; ++seed) {
+    // Mostly isolated vertices and small components, which share colors.
+    std::vector<InlineBitmap> sparse = RandomGraph(150, 1, seed);
+    std::vector<std::vector<int64_t>> exact =
+        DenseColoring(sparse, {.exact_component_size_limit = 6});
+    EXPECT_TRUE(IsValidDenseColoring(sparse, exact));
+    EXPECT_LE(exact.size(), DSaturColoring(sparse).size());
+
+    std::vector<InlineBitmap> dense = RandomGraph(130, 50, seed);
+    EXPECT_TRUE(IsValidDenseColoring(dense, DSaturColoring(dense)));
+    EXPECT_TRUE(IsValidDenseColoring(
+        dense, DenseColoring(dense, {.exact_component_size_limit = 6})));
+  }
+}
+
+void BM_RecursiveLargestFirstColoring(benchmark::State& state) {
+  std::vector<InlineBitmap> adjacency =
+      RandomGraph(state.range(0), state.range(1), 0);
+  absl::flat_hash_set<int64_t> vertices;
+  for (int64_t v = 0; v < adjacency.size(); ++v) {
+    vertices.insert(v);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(RecursiveLargestFirstColoring<int64_t>(
+        vertices, [&](const int64_t& v) -> absl::flat_hash_set<int64_t> {
+          absl::flat_hash_set<int64_t> neighbors;
+          for (int64_t u = 0; u < adjacency.size(); ++u) {
+            if (adjacency[v].Get(u)) {
+              neighbors.insert(u);
+            }
+          }
+          return neighbors;
+        }));
+  }
+}
+
+void BM_DSaturColoring(benchmark::State& state) {
+  std::vector<InlineBitmap> adjacency =
+      RandomGraph(state.range(0), state.range(1), 0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(DSaturColoring(adjacency));
+  }
+}
+
+// Arguments are the number of vertices and the edge density in percent. The
+// graphs colored by the mutual exclusion pass are dense: they are complements
+// of the sparse relation of mergeable operations.
+BENCHMARK(BM_RecursiveLargestFirstColoring)->Args({100, 90})->Args({300, 90});
+BENCHMARK(BM_DSaturColoring)
+    ->Args({100, 90})
+    ->Args({300, 90})
+    ->Args({3000, 90})
+    ->Args({3000, 10});
+
 }  // namespace
 }  // namespace xls
@@ -22,6 +22,7 @@
 #include <string>
 #include <tuple>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/algorithm/container.h"
@@ -515,6 +516,68 @@ class LeafTypeTree {
   TypeContainerT leaf_types_;
 };
 
+// A LeafTypeTree which either refers to data held elsewhere (like a
+// LeafTypeTreeView) or holds its own data (like a LeafTypeTree). This is
+// returned by interfaces which can hand out their stored trees without copying
+// them but which must sometimes compute a fresh tree. When it refers to data
+// held elsewhere the data must outlive the SharedLeafTypeTree.
+template <typename T>
+class SharedLeafTypeTree {
+ public:
+  explicit SharedLeafTypeTree(LeafTypeTreeView<T> view)
+      : value_(std::move(view)) {}
+  explicit SharedLeafTypeTree(LeafTypeTree<T>&& tree)
+      : value_(std::move(tree)) {}
+  SharedLeafTypeTree(const SharedLeafTypeTree<T>& other) = delete;
+  SharedLeafTypeTree& operator=(const SharedLeafTypeTree<T>& other) = delete;
+  SharedLeafTypeTree(SharedLeafTypeTree<T>&& other) = default;
+  SharedLeafTypeTree& operator=(SharedLeafTypeTree<T>&& other) = default;
+
+  // Returns whether this object holds its own data.
+  bool IsOwned() const {
+    return std::holds_alternative<LeafTypeTree<T>>(value_);
+  }
+
+  // These methods are mirrors of those on LeafTypeTree. See LeafTypeTree for
+  // descriptions.
+  Type* type() const { return AsView().type(); }
+  int64_t size() const { return AsView().size(); }
+  const T& Get(absl::Span<int64_t const> index) const
+      ABSL_ATTRIBUTE_LIFETIME_BOUND {
+    return AsView().Get(index);
+  }
+  absl::Span<T const> elements() const ABSL_ATTRIBUTE_LIFETIME_BOUND {
+    return AsView().elements();
+  }
+  absl::Span<Type* const> leaf_types() const ABSL_ATTRIBUTE_LIFETIME_BOUND {
+    return AsView().leaf_types();
+  }
+  LeafTypeTreeView<T> AsView(absl::Span<const int64_t> index = {}) const
+      ABSL_ATTRIBUTE_LIFETIME_BOUND {
+    if (const auto* tree = std::get_if<LeafTypeTree<T>>(&value_)) {
+      return tree->AsView(index);
+    }
+    return std::get<LeafTypeTreeView<T>>(value_).AsView(index);
+  }
+  std::string ToString(const std::function<std::string(const T&)>& f) const {
+    return AsView().ToString(f);
+  }
+  std::string ToString() const { return AsView().ToString(); }
+
+  // Returns a LeafTypeTree holding the data, copying it only if it is held
+  // elsewhere.
+  LeafTypeTree<T> ToOwned() && {
+    if (auto* tree = std::get_if<LeafTypeTree<T>>(&value_)) {
+      return std::move(*tree);
+    }
+    LeafTypeTreeView<T> view = std::get<LeafTypeTreeView<T>>(value_);
+    return LeafTypeTree<T>(view.type(), view.elements());
+  }
+
+ private:
+  std::variant<LeafTypeTreeView<T>, LeafTypeTree<T>> value_;
+};
+
 namespace leaf_type_tree_internal {
 
 // Increment a multi-dimensional array index assuming the given array bounds.
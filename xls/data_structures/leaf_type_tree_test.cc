@@ -924,5 +924,26 @@ TEST_F(LeafTypeTreeTest, CreateFromFunction) {
             "([bits[32]@{0,0}, bits[32]@{0,1}], bits[2]@{1})");
 }
 
+TEST_F(LeafTypeTreeTest, SharedLeafTypeTree) {
+  Type* type = AsType("(bits[32], (bits[2], bits[3]))");
+  LeafTypeTree<int64_t> tree(type, {1, 2, 3});
+
+  SharedLeafTypeTree<int64_t> shared_view(tree.AsView());
+  EXPECT_FALSE(shared_view.IsOwned());
+  EXPECT_EQ(shared_view.type(), type);
+  EXPECT_EQ(shared_view.elements().data(), tree.elements().data());
+  EXPECT_EQ(shared_view.Get({1, 1}), 3);
+  EXPECT_EQ(shared_view.AsView({1}).ToString(), "(2, 3)");
+
+  SharedLeafTypeTree<int64_t> shared_tree(LeafTypeTree<int64_t>(type, 42));
+  EXPECT_TRUE(shared_tree.IsOwned());
+  EXPECT_THAT(shared_tree.elements(), ElementsAre(42, 42, 42));
+
+  LeafTypeTree<int64_t> copy = std::move(shared_view).ToOwned();
+  EXPECT_EQ(copy, tree);
+  EXPECT_NE(copy.elements().data(), tree.elements().data());
+  EXPECT_EQ(std::move(shared_tree).ToOwned(), LeafTypeTree<int64_t>(type, 42));
+}
+
 }  // namespace
 }  // namespace xls
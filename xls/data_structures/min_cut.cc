@@ -22,10 +22,10 @@
 #include <utility>
 #include <vector>
 
-#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/numeric/int128.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -183,108 +183,162 @@ std::string GraphWithFlowToString(const Graph& graph,
   return out;
 }
 
-// Finds an augmenting path from source to sink in the graph (path of edges with
-// non-zero residual capacity) and increases the flow along each edge in the
-// path. The amount of flow increase is equal to the minimum residual capacity
-// of any edge in the path. The augmenting path is found via Dinic's algorithm
-// which finds a shortest augmenting path via BFS search. Returns the amount of
-// augmented flow. If no augmenting path is found then zero is returned.
-int64_t AugmentFlow(const Graph& graph, NodeId source, NodeId sink,
-                    ResidualGraph* residual_graph) {
-  XLS_VLOG_LINES(4, GraphWithFlowToString(graph, *residual_graph));
-
-  // Perform a BFS search from flow to find the shortest augmenting path (by
-  // edge count) from source to sink. For each edge traversed in the BFS search,
-  // 'path_back' holds the previous edge in the path from the source along with
-  // the residual capacity of that path..
-  absl::flat_hash_map<NodeId, std::pair<ResidualEdge*, int64_t>> path_back;
-  std::vector<NodeId> frontier = {source};
-  while (!frontier.empty()) {
-    std::vector<NodeId> next_frontier;
-    // Try to add extend the BFS-constructed paths from the source with the
-    // given edge.
-    auto maybe_extend_frontier = [&](ResidualEdge* e) {
-      if (path_back.contains(e->to)) {
-        return;
+// Computes a maximum flow from source to sink using the push-relabel method
+// and leaves the flow in the residual graph. Flow is first pushed along every
+// edge out of the source; each node then repeatedly pushes its excess inflow to
+// neighbors which are one step closer to the sink (by 'height') and is
+// relabeled when no such neighbor remains. Excess which cannot reach the sink
+// is eventually returned to the source, so on return the flow is a valid flow
+// (not just a preflow). Active nodes are processed in FIFO order, which
+// results in a worst case run time of O(V^3). The gap and global relabeling
+// heuristics keep the number of relabel operations small in practice.
+void MaximizeFlow(const Graph& graph, NodeId source, NodeId sink,
+                  ResidualGraph* residual_graph) {
+  const int64_t node_count = graph.node_count();
+  // Heights of active nodes never exceed 2 * node_count - 1. Unreachable nodes
+  // (which never become active) are placed at 2 * node_count.
+  const int64_t max_height = 2 * node_count;
+  std::vector<int64_t> height(node_count, 0);
+  std::vector<int64_t> height_count(max_height + 1, 0);
+  // The excess of a node may exceed the capacity of any single edge (e.g.,
+  // several edges of maximum weight flowing into a node) so it is kept as a
+  // 128-bit value.
+  std::vector<absl::int128> excess(node_count, 0);
+  // Index into the successor list of each node of the next edge to consider
+  // pushing flow along.
+  std::vector<int64_t> current_edge(node_count, 0);
+  std::deque<NodeId> active;
+
+  auto set_height = [&](NodeId node, int64_t value) {
+    CHECK_LE(value, max_height);
+    --height_count[height[int64_t{node}]];
+    height[int64_t{node}] = value;
+    ++height_count[value];
+  };
+
+  // Sets the height of every node to its exact residual distance to the sink,
+  // or to node_count plus its residual distance to the source if it cannot
+  // reach the sink.
+  auto global_relabel = [&]() {
+    constexpr int64_t kUnvisited = -1;
+    std::vector<int64_t> distance(node_count, kUnvisited);
+    auto bfs = [&](NodeId root, int64_t root_distance) {
+      std::deque<NodeId> frontier = {root};
+      distance[int64_t{root}] = root_distance;
+      while (!frontier.empty()) {
+        NodeId node = frontier.front();
+        frontier.pop_front();
+        for (EdgeId edge_id : residual_graph->successors(node)) {
+          // Walk the residual graph backwards: 'to' can reach 'node' if the
+          // dual of this edge has residual capacity.
+          const ResidualEdge& edge = residual_graph->edge(edge_id);
+          if (distance[int64_t{edge.to}] == kUnvisited &&
+              residual_graph->edge(edge.dual_edge).capacity > 0) {
+            distance[int64_t{edge.to}] = distance[int64_t{node}] + 1;
+            frontier.push_back(edge.to);
+          }
+        }
       }
-      int64_t path_capacity = path_back.contains(e->from)
-                                  ? path_back.at(e->from).second
-                                  : std::numeric_limits<int64_t>::max();
-      // The residual capacity of a path is the minimum residual capacity of any
-      // edge in the path.
-      path_capacity = std::min(path_capacity, e->capacity);
-      path_back[e->to] = {e, path_capacity};
-      next_frontier.push_back(e->to);
-      VLOG(5) << "  Added " << graph.name(e->to) << " to the frontier";
     };
+    // The source is marked first so the search from the sink does not pass
+    // through it.
+    distance[int64_t{source}] = node_count;
+    bfs(sink, 0);
+    distance[int64_t{source}] = kUnvisited;
+    bfs(source, node_count);
+    std::fill(height_count.begin(), height_count.end(), 0);
+    for (int64_t i = 0; i < node_count; ++i) {
+      height[i] = distance[i] == kUnvisited ? max_height : distance[i];
+      ++height_count[height[i]];
+    }
+    std::fill(current_edge.begin(), current_edge.end(), 0);
+  };
+
+  auto add_excess = [&](NodeId node, int64_t amount) {
+    if (excess[int64_t{node}] == 0 && node != source && node != sink) {
+      active.push_back(node);
+    }
+    excess[int64_t{node}] += amount;
+  };
+
+  // Saturate every edge out of the source.
+  for (EdgeId edge_id : residual_graph->successors(source)) {
+    ResidualEdge& edge = residual_graph->edge(edge_id);
+    int64_t amount = edge.capacity;
+    if (amount > 0) {
+      residual_graph->PushFlow(amount, &edge);
+      add_excess(edge.to, amount);
+      excess[int64_t{source}] -= amount;
+    }
+  }
+  global_relabel();
+
+  int64_t relabels_since_global_relabel = 0;
+  while (!active.empty()) {
+    NodeId node = active.front();
+    active.pop_front();
+    absl::Span<const EdgeId> successors = residual_graph->successors(node);
+    int64_t& edge_index = current_edge[int64_t{node}];
+    // Discharge the node: push all of its excess to its neighbors, relabeling
+    // it as necessary.
+    while (excess[int64_t{node}] > 0) {
+      if (edge_index < static_cast<int64_t>(successors.size())) {
+        ResidualEdge& edge = residual_graph->edge(successors[edge_index]);
+        if (edge.capacity > 0 &&
+            height[int64_t{node}] == height[int64_t{edge.to}] + 1) {
+          int64_t amount = static_cast<int64_t>(
+              std::min(excess[int64_t{node}], absl::int128{edge.capacity}));
+          residual_graph->PushFlow(amount, &edge);
+          excess[int64_t{node}] -= amount;
+          add_excess(edge.to, amount);
+        } else {
+          ++edge_index;
+        }
+        continue;
+      }
 
-    for (NodeId node : frontier) {
-      VLOG(5) << "Visiting " << graph.name(node);
-      for (EdgeId edge_id : residual_graph->successors(node)) {
-        ResidualEdge& edge = residual_graph->edge(edge_id);
-        VLOG(5) << absl::StreamFormat(
-            "  Traversing %s->%s", graph.name(edge.from), graph.name(edge.to));
-        CHECK_GE(edge.capacity, 0);
+      // No admissible edge remains. Raise the node to one above its lowest
+      // residual neighbor.
+      int64_t old_height = height[int64_t{node}];
+      int64_t new_height = std::numeric_limits<int64_t>::max();
+      for (EdgeId edge_id : successors) {
+        const ResidualEdge& edge = residual_graph->edge(edge_id);
         if (edge.capacity > 0) {
-          maybe_extend_frontier(&edge);
-          if (edge.to == sink) {
-            // Found augmenting path. As this is the first path we've found in a
-            // BFS search it is necessarily a shortest path. Walk back along
-            // path and augment the flow.
-            int64_t augmented_flow_amount = path_back.at(sink).second;
-            CHECK_GT(augmented_flow_amount, 0);
-            NodeId n = sink;
-            while (n != source) {
-              ResidualEdge* e = path_back.at(n).first;
-              residual_graph->PushFlow(augmented_flow_amount, e);
-              CHECK_GE(e->capacity, 0);
-              n = e->from;
-            }
-            if (VLOG_IS_ON(4)) {
-              VLOG(4) << "Augmented flow: " << augmented_flow_amount;
-              std::vector<const ResidualEdge*> augmented_path;
-              NodeId n = sink;
-              while (n != source) {
-                const ResidualEdge* e = path_back.at(n).first;
-                augmented_path.push_back(e);
-                n = e->from;
-              }
-              std::reverse(augmented_path.begin(), augmented_path.end());
-              VLOG(4) << "Augmented path: "
-                      << absl::StrJoin(
-                             augmented_path, ", ",
-                             [&](std::string* out, const ResidualEdge* e) {
-                               absl::StrAppendFormat(
-                                   out, "%s->%s [new capacity %d]",
-                                   graph.name(e->from), graph.name(e->to),
-                                   e->capacity);
-                             });
-            }
-            return augmented_flow_amount;
+          new_height = std::min(new_height, height[int64_t{edge.to}] + 1);
+        }
+      }
+      // A node with excess always has a residual edge back toward the node
+      // which sent it flow.
+      CHECK_NE(new_height, std::numeric_limits<int64_t>::max());
+      set_height(node, new_height);
+      edge_index = 0;
+      ++relabels_since_global_relabel;
+
+      if (height_count[old_height] == 0 && old_height < node_count) {
+        // Gap heuristic: no node remains at 'old_height' so no node above it
+        // can reach the sink. Lift those nodes straight to above the source.
+        for (int64_t i = 0; i < node_count; ++i) {
+          if (height[i] > old_height && height[i] < node_count) {
+            set_height(NodeId(i), node_count + 1);
+            current_edge[i] = 0;
           }
         }
       }
+      if (relabels_since_global_relabel >= node_count) {
+        global_relabel();
+        relabels_since_global_relabel = 0;
+      }
     }
-
-    frontier = std::move(next_frontier);
-    next_frontier.clear();
   }
 
-  VLOG(4) << "No augmenting path found";
-  return 0;
+  XLS_VLOG_LINES(4, GraphWithFlowToString(graph, *residual_graph));
 }
 
 }  // namespace
 
 GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink) {
-  // This loop is the core of the Ford-Fulkerson method. Starting with zero flow
-  // on all edges, flow is increased along a path from source to sink with
-  // residual capacity (called an augmenting path). When no further augmenting
-  // paths exist, flow has been maximized. 'flow' is the flow of each edge in
-  // the graph indexed by EdgeId.
   ResidualGraph residual_graph(graph);
-  while (AugmentFlow(graph, source, sink, &residual_graph) > 0) {
-  }
+  MaximizeFlow(graph, source, sink, &residual_graph);
 
   // Once a maximum flow is found, walk the residual graph from the source. All
   // reachable nodes form one partition.
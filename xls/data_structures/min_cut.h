@@ -98,9 +98,11 @@ struct GraphCut {
 
 // Computes a minimum cut of the given graph where source and sink are in
 // different partitions. The cut is returned as a partitioning of the nodes of
-// the graph into two sets of nodes on either side of the cut. The min cut is
-// found via the Ford-Fulkerson method using Dinic's algorithm. This results in
-// a worst case run time of O(V^2 * E).
+// the graph into two sets of nodes on either side of the cut. The maximum flow
+// is found with the FIFO push-relabel method (with gap and global relabeling
+// heuristics) which has a worst case run time of O(V^3). The source partition
+// is the set of nodes reachable from the source in the residual graph, i.e.,
+// the smallest source partition of any minimum cut.
 GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink);
 
 }  // namespace min_cut
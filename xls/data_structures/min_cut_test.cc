@@ -362,6 +362,49 @@ TEST(MinCutTest, ResidualGraphTraversalTest) {
   EXPECT_EQ(min_cut.weight, 2);
 }
 
+TEST(MinCutTest, ExcessAboveMaximumEdgeWeight) {
+  // Several maximum weight edges flow into 'c' so the flow entering it exceeds
+  // the range of an int64_t before the excess is returned to the source. The
+  // opposing maximum weight edges mirror the dicut construction used by the
+  // scheduler.
+  //
+  //      source
+  //      /  |  \
+  //     a   b   d     (maximum weight edges from source)
+  //      \  |  /
+  //         c         (maximum weight edges into c)
+  //         |  5
+  //         e
+  //         |
+  //        sink       (maximum weight edge)
+  //
+  constexpr int64_t kMaxWeight = std::numeric_limits<int64_t>::max();
+  Graph graph;
+  auto source = graph.AddNode("source");
+  auto a = graph.AddNode("a");
+  auto b = graph.AddNode("b");
+  auto c = graph.AddNode("c");
+  auto d = graph.AddNode("d");
+  auto e = graph.AddNode("e");
+  auto sink = graph.AddNode("sink");
+  auto add_edge = [&](NodeId from, NodeId to, int64_t weight) {
+    graph.AddEdge(from, to, weight);
+    graph.AddEdge(to, from, kMaxWeight);
+  };
+  for (NodeId node : {a, b, d}) {
+    add_edge(source, node, kMaxWeight);
+    add_edge(node, c, kMaxWeight);
+  }
+  add_edge(c, e, 5);
+  add_edge(e, sink, kMaxWeight);
+
+  GraphCut min_cut = MinCutBetweenNodes(graph, source, sink);
+  EXPECT_EQ(min_cut.weight, 5);
+  EXPECT_THAT(min_cut.source_partition,
+              UnorderedElementsAre(source, a, b, c, d));
+  EXPECT_THAT(min_cut.sink_partition, UnorderedElementsAre(e, sink));
+}
+
 }  // namespace
 }  // namespace min_cut
 }  // namespace xls
@@ -0,0 +1,140 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/transitive_closure.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
+
+namespace xls {
+
+std::vector<InlineBitmap> DenseTransitiveClosure(
+    std::vector<InlineBitmap> relation) {
+  const int64_t n = relation.size();
+  for (int64_t k = 0; k < n; ++k) {
+    CHECK_EQ(relation[k].bit_count(), n);
+    for (int64_t i = 0; i < n; ++i) {
+      if (i != k && relation[i].Get(k)) {
+        relation[i].Union(relation[k]);
+      }
+    }
+  }
+  return relation;
+}
+
+std::vector<InlineBitmap> SparseTransitiveClosure(
+    absl::Span<const std::vector<int64_t>> successors) {
+  const int64_t n = successors.size();
+  constexpr int64_t kUnvisited = -1;
+
+  // Tarjan's algorithm, run iteratively so deep relations don't overflow the
+  // stack. A component is completed only after every component reachable from
+  // it, so its reachable set can be built from theirs as soon as it completes.
+  std::vector<int64_t> index(n, kUnvisited);
+  std::vector<int64_t> lowlink(n);
+  std::vector<int64_t> component(n, kUnvisited);
+  std::vector<bool> on_stack(n, false);
+  std::vector<int64_t> component_stack;
+  std::vector<InlineBitmap> component_reach;
+  // The nodes being visited and the index of the next successor to visit.
+  std::vector<std::pair<int64_t, int64_t>> dfs_stack;
+  int64_t next_index = 0;
+
+  auto visit = [&](int64_t node) {
+    index[node] = next_index;
+    lowlink[node] = next_index;
+    ++next_index;
+    component_stack.push_back(node);
+    on_stack[node] = true;
+    dfs_stack.push_back({node, 0});
+  };
+
+  for (int64_t root = 0; root < n; ++root) {
+    if (index[root] != kUnvisited) {
+      continue;
+    }
+    visit(root);
+    while (!dfs_stack.empty()) {
+      auto [node, next_successor] = dfs_stack.back();
+      if (next_successor < successors[node].size()) {
+        ++dfs_stack.back().second;
+        int64_t successor = successors[node][next_successor];
+        CHECK_GE(successor, 0);
+        CHECK_LT(successor, n);
+        if (index[successor] == kUnvisited) {
+          visit(successor);
+        } else if (on_stack[successor]) {
+          lowlink[node] = std::min(lowlink[node], index[successor]);
+        }
+        continue;
+      }
+
+      dfs_stack.pop_back();
+      if (!dfs_stack.empty()) {
+        int64_t parent = dfs_stack.back().first;
+        lowlink[parent] = std::min(lowlink[parent], lowlink[node]);
+      }
+      if (lowlink[node] != index[node]) {
+        continue;
+      }
+
+      // `node` is the root of a component; its members are on top of the
+      // component stack.
+      const int64_t c = component_reach.size();
+      std::vector<int64_t> members;
+      int64_t member;
+      do {
+        member = component_stack.back();
+        component_stack.pop_back();
+        on_stack[member] = false;
+        component[member] = c;
+        members.push_back(member);
+      } while (member != node);
+
+      InlineBitmap reach(n);
+      bool cyclic = members.size() > 1;
+      for (int64_t m : members) {
+        for (int64_t successor : successors[m]) {
+          if (component[successor] == c) {
+            cyclic = true;
+            continue;
+          }
+          reach.Set(successor);
+          reach.Union(component_reach[component[successor]]);
+        }
+      }
+      if (cyclic) {
+        for (int64_t m : members) {
+          reach.Set(m);
+        }
+      }
+      component_reach.push_back(std::move(reach));
+    }
+  }
+
+  std::vector<InlineBitmap> closure;
+  closure.reserve(n);
+  for (int64_t node = 0; node < n; ++node) {
+    closure.push_back(component_reach[component[node]]);
+  }
+  return closure;
+}
+
+}  // namespace xls
@@ -20,13 +20,34 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
-#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 
 template <typename V>
 using HashRelation = absl::flat_hash_map<V, absl::flat_hash_set<V>>;
 
+// Computes the transitive closure of a relation over the nodes 0..n-1 given as
+// an adjacency matrix: bit j of `relation[i]` is set iff i is related to j.
+//
+// This is Warshall's algorithm with each row update done as a word-wise OR of
+// whole rows, so it takes O(n^3 / 64) time. Prefer SparseTransitiveClosure
+// unless the relation is dense.
+std::vector<InlineBitmap> DenseTransitiveClosure(
+    std::vector<InlineBitmap> relation);
+
+// Computes the transitive closure of a relation over the nodes 0..n-1 given as
+// successor lists, returning it as an adjacency matrix (see
+// DenseTransitiveClosure).
+//
+// The relation is condensed into its strongly connected components, whose
+// reachable sets are then propagated in reverse topological order. This takes
+// O(n * e / 64) time for e edges, which for sparse relations such as the
+// dependency DAGs of a function is far less than Warshall's algorithm.
+std::vector<InlineBitmap> SparseTransitiveClosure(
+    absl::Span<const std::vector<int64_t>> successors);
+
 // Compute the transitive closure of a relation.
 template <typename V>
 HashRelation<V> TransitiveClosure(const HashRelation<V>& relation) {
@@ -36,60 +57,40 @@ HashRelation<V> TransitiveClosure(const HashRelation<V>& relation) {
     return Rel();
   }
 
-  absl::flat_hash_set<V> unordered_nodes;
-  for (const auto& [node, children] : relation) {
-    unordered_nodes.insert(node);
-    for (const auto& child : children) {
-      unordered_nodes.insert(child);
-    }
-  }
-
-  std::vector<V> ordered_nodes(unordered_nodes.begin(), unordered_nodes.end());
-  std::sort(ordered_nodes.begin(), ordered_nodes.end());
-
-  const int64_t n = ordered_nodes.size();
-
+  std::vector<V> nodes;
   absl::flat_hash_map<V, int64_t> node_to_index;
-  for (int64_t i = 0; i < n; ++i) {
-    node_to_index[ordered_nodes[i]] = i;
-  }
-
-  // Warshall's algorithm; https://cs.winona.edu/lin/cs440/ch08-2.pdf
-
-  auto get = [&](const HashRelation<int64_t>& rel, int64_t i,
-                 int64_t j) -> bool {
-    return rel.contains(i) && rel.at(i).contains(j);
-  };
-
-  auto set = [&](HashRelation<int64_t>* rel, int64_t i, int64_t j, bool value) {
-    if (value) {
-      (*rel)[i].insert(j);
-    } else {
-      (*rel)[i].erase(j);
+  auto add_node = [&](const V& node) {
+    if (node_to_index.try_emplace(node, nodes.size()).second) {
+      nodes.push_back(node);
     }
   };
-
-  HashRelation<int64_t> lag;
   for (const auto& [node, children] : relation) {
+    add_node(node);
     for (const auto& child : children) {
-      set(&lag, node_to_index.at(node), node_to_index.at(child), true);
+      add_node(child);
     }
   }
-  HashRelation<int64_t> closure = lag;
-  for (int64_t k = 0; k < n; ++k) {
-    for (int64_t i = 0; i < n; ++i) {
-      for (int64_t j = 0; j < n; ++j) {
-        set(&closure, i, j,
-            get(lag, i, j) || (get(lag, i, k) && get(lag, k, j)));
-      }
+
+  std::vector<std::vector<int64_t>> successors(nodes.size());
+  for (const auto& [node, children] : relation) {
+    std::vector<int64_t>& node_successors = successors[node_to_index.at(node)];
+    for (const auto& child : children) {
+      node_successors.push_back(node_to_index.at(child));
     }
-    lag = closure;
   }
 
+  std::vector<InlineBitmap> closure = SparseTransitiveClosure(successors);
+
   Rel result;
-  for (const auto& [node_index, children_indices] : closure) {
-    for (const auto& child_index : children_indices) {
-      result[ordered_nodes[node_index]].insert(ordered_nodes[child_index]);
+  for (int64_t i = 0; i < closure.size(); ++i) {
+    if (closure[i].IsAllZeroes()) {
+      continue;
+    }
+    absl::flat_hash_set<V>& children = result[nodes[i]];
+    for (int64_t j = 0; j < closure[i].bit_count(); ++j) {
+      if (closure[i].Get(j)) {
+        children.insert(nodes[j]);
+      }
     }
   }
 
@@ -14,12 +14,17 @@
 
 #include "xls/data_structures/transitive_closure.h"
 
+#include <cstdint>
+#include <random>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "benchmark/benchmark.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 namespace {
@@ -28,6 +33,72 @@ using ::testing::UnorderedElementsAre;
 
 using V = std::string;
 
+// Warshall's algorithm directly over a HashRelation, used as a reference and as
+// a baseline for the benchmarks.
+HashRelation<int64_t> HashTransitiveClosure(
+    const HashRelation<int64_t>& relation, int64_t n) {
+  auto get = [](const HashRelation<int64_t>& rel, int64_t i, int64_t j) {
+    return rel.contains(i) && rel.at(i).contains(j);
+  };
+  HashRelation<int64_t> closure = relation;
+  for (int64_t k = 0; k < n; ++k) {
+    for (int64_t i = 0; i < n; ++i) {
+      if (!get(closure, i, k)) {
+        continue;
+      }
+      for (int64_t j = 0; j < n; ++j) {
+        if (get(closure, k, j)) {
+          closure[i].insert(j);
+        }
+      }
+    }
+  }
+  return closure;
+}
+
+// A random relation on `n` nodes where each node is related to
+// `edges_per_node` others. If `dag` is true all edges go from lower to higher
+// numbered nodes.
+std::vector<std::vector<int64_t>> RandomRelation(int64_t n,
+                                                 int64_t edges_per_node,
+                                                 bool dag, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<std::vector<int64_t>> successors(n);
+  for (int64_t i = 0; i < n; ++i) {
+    if (dag && i == n - 1) {
+      break;
+    }
+    std::uniform_int_distribution<int64_t> dist(dag ? i + 1 : 0, n - 1);
+    for (int64_t e = 0; e < edges_per_node; ++e) {
+      successors[i].push_back(dist(rng));
+    }
+  }
+  return successors;
+}
+
+std::vector<InlineBitmap> ToMatrix(
+    const std::vector<std::vector<int64_t>>& successors) {
+  std::vector<InlineBitmap> matrix(successors.size(),
+                                   InlineBitmap(successors.size()));
+  for (int64_t i = 0; i < successors.size(); ++i) {
+    for (int64_t j : successors[i]) {
+      matrix[i].Set(j);
+    }
+  }
+  return matrix;
+}
+
+HashRelation<int64_t> ToHashRelation(
+    const std::vector<std::vector<int64_t>>& successors) {
+  HashRelation<int64_t> relation;
+  for (int64_t i = 0; i < successors.size(); ++i) {
+    for (int64_t j : successors[i]) {
+      relation[i].insert(j);
+    }
+  }
+  return relation;
+}
+
 TEST(TransitiveClosureTest, Simple) {
   HashRelation<V> rel;
   rel["foo"].insert("bar");
@@ -43,5 +114,87 @@ TEST(TransitiveClosureTest, Simple) {
   EXPECT_FALSE(tc.contains("qux"));
 }
 
+TEST(TransitiveClosureTest, Cycles) {
+  HashRelation<V> rel;
+  rel["a"].insert("b");
+  rel["b"].insert("c");
+  rel["c"].insert("a");
+  rel["c"].insert("d");
+  rel["e"].insert("e");
+  HashRelation<V> tc = TransitiveClosure<V>(rel);
+  EXPECT_THAT(tc.at("a"), UnorderedElementsAre("a", "b", "c", "d"));
+  EXPECT_THAT(tc.at("b"), UnorderedElementsAre("a", "b", "c", "d"));
+  EXPECT_THAT(tc.at("c"), UnorderedElementsAre("a", "b", "c", "d"));
+  EXPECT_THAT(tc.at("e"), UnorderedElementsAre("e"));
+  EXPECT_FALSE(tc.contains("d"));
+}
+
+TEST(TransitiveClosureTest, DenseAndSparseMatchReference) {
+  for (bool dag : {false, true}) {
+    for (uint64_t seed = 0; seed < 10; ++seed) {
+      constexpr int64_t kNodes = 100;
+      std::vector<std::vector<int64_t>> successors =
+          RandomRelation(kNodes, /*edges_per_node=*/2, dag, seed);
+      HashRelation<int64_t> expected =
+          HashTransitiveClosure(ToHashRelation(successors), kNodes);
+      std::vector<InlineBitmap> dense =
+          DenseTransitiveClosure(ToMatrix(successors));
+      std::vector<InlineBitmap> sparse = SparseTransitiveClosure(successors);
+      ASSERT_EQ(dense.size(), kNodes);
+      ASSERT_EQ(sparse.size(), kNodes);
+      for (int64_t i = 0; i < kNodes; ++i) {
+        for (int64_t j = 0; j < kNodes; ++j) {
+          bool related = expected.contains(i) && expected.at(i).contains(j);
+          EXPECT_EQ(dense[i].Get(j), related) << i << " -> " << j;
+          EXPECT_EQ(sparse[i].Get(j), related) << i << " -> " << j;
+        }
+      }
+    }
+  }
+}
+
+TEST(TransitiveClosureTest, SparseHandlesLongChains) {
+  // Deep enough that a recursive depth-first search would be at risk.
+  constexpr int64_t kNodes = 20000;
+  std::vector<std::vector<int64_t>> successors(kNodes);
+  for (int64_t i = 0; i + 1 < kNodes; ++i) {
+    successors[i].push_back(i + 1);
+  }
+  std::vector<InlineBitmap> closure = SparseTransitiveClosure(successors);
+  EXPECT_FALSE(closure[0].Get(0));
+  EXPECT_TRUE(closure[0].Get(kNodes - 1));
+  EXPECT_TRUE(closure[kNodes - 1].IsAllZeroes());
+}
+
+void BM_HashTransitiveClosure(benchmark::State& state) {
+  HashRelation<int64_t> relation = ToHashRelation(
+      RandomRelation(state.range(0), /*edges_per_node=*/4, /*dag=*/true, 0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(HashTransitiveClosure(relation, state.range(0)));
+  }
+}
+
+void BM_DenseTransitiveClosure(benchmark::State& state) {
+  std::vector<InlineBitmap> matrix = ToMatrix(
+      RandomRelation(state.range(0), /*edges_per_node=*/4, /*dag=*/true, 0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(DenseTransitiveClosure(matrix));
+  }
+}
+
+void BM_SparseTransitiveClosure(benchmark::State& state) {
+  std::vector<std::vector<int64_t>> successors =
+      RandomRelation(state.range(0), /*edges_per_node=*/4, /*dag=*/true, 0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(SparseTransitiveClosure(successors));
+  }
+}
+
+// The hash-based version is cubic in hash lookups, so is only run at the low
+// end of the range.
+BENCHMARK(BM_HashTransitiveClosure)->Arg(250)->Arg(1000);
+BENCHMARK(BM_DenseTransitiveClosure)->Arg(1000)->Arg(10000)->Arg(50000);
+BENCHMARK(BM_SparseTransitiveClosure)->Arg(1000)->Arg(10000)->Arg(50000);
+
 }  // namespace
 }  // namespace xls
@@ -15,6 +15,7 @@
 #ifndef XLS_DATA_STRUCTURES_UNION_FIND_H_
 #define XLS_DATA_STRUCTURES_UNION_FIND_H_
 
+#include <atomic>
 #include <cstdint>
 #include <optional>
 #include <utility>
@@ -73,6 +74,65 @@ class UnionFind {
   UnionFindMap<T, absl::monostate> union_find_map_;
 };
 
+// A union-find over the dense integer ids [0, size), stored as one parent id
+// per element. This is much cheaper in time and memory than UnionFind when the
+// elements can be numbered, e.g. by their position in a container.
+//
+// Union and Find may be called concurrently from several threads. The
+// representative of an equivalence class is always its smallest id, so the
+// result does not depend on the order in which the unions were performed.
+class DenseUnionFind {
+ public:
+  explicit DenseUnionFind(int64_t size) : parents_(size) {
+    for (int64_t i = 0; i < size; ++i) {
+      parents_[i].store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Union together the equivalence classes of two elements.
+  void Union(int64_t x, int64_t y) {
+    while (true) {
+      x = Find(x);
+      y = Find(y);
+      if (x == y) {
+        return;
+      }
+      if (x < y) {
+        std::swap(x, y);
+      }
+      // Link the larger root under the smaller one, unless another thread has
+      // linked it elsewhere in the meantime.
+      int64_t expected = x;
+      if (parents_[x].compare_exchange_strong(expected, y)) {
+        return;
+      }
+    }
+  }
+
+  // Returns the representative (smallest) element in the given element's
+  // equivalence class.
+  int64_t Find(int64_t x) {
+    while (true) {
+      int64_t parent = parents_[x].load();
+      if (parent == x) {
+        return x;
+      }
+      // Path halving: point `x` at its grandparent. Losing a race here only
+      // means the path is not shortened.
+      int64_t grandparent = parents_[parent].load();
+      if (grandparent != parent) {
+        parents_[x].compare_exchange_weak(parent, grandparent);
+      }
+      x = grandparent;
+    }
+  }
+
+  int64_t size() const { return parents_.size(); }
+
+ private:
+  std::vector<std::atomic<int64_t>> parents_;
+};
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_UNION_FIND_H_
@@ -14,8 +14,13 @@
 
 #include "xls/data_structures/union_find.h"
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "xls/common/thread.h"
 
 namespace xls {
 namespace {
@@ -67,5 +72,52 @@ TEST(UnionFindTest, UnionFind) {
   EXPECT_THAT(uf.Find('a'), AnyOf('a', 'b', 'c', 'd'));
 }
 
+TEST(UnionFindTest, DenseUnionFind) {
+  DenseUnionFind uf(5);
+  for (int64_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(uf.Find(i), i);
+  }
+
+  uf.Union(3, 3);
+  EXPECT_EQ(uf.Find(3), 3);
+
+  // The representative is always the smallest element of the class.
+  uf.Union(4, 3);
+  EXPECT_EQ(uf.Find(4), 3);
+  uf.Union(1, 4);
+  EXPECT_EQ(uf.Find(3), 1);
+  EXPECT_EQ(uf.Find(4), 1);
+  EXPECT_EQ(uf.Find(0), 0);
+  EXPECT_EQ(uf.Find(2), 2);
+
+  uf.Union(2, 0);
+  uf.Union(4, 2);
+  for (int64_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(uf.Find(i), 0);
+  }
+}
+
+TEST(UnionFindTest, DenseUnionFindConcurrentUnions) {
+  // Each thread links every element to its neighbor in a different order;
+  // all elements must end up in one class.
+  constexpr int64_t kSize = 10000;
+  constexpr int64_t kThreadCount = 4;
+  DenseUnionFind uf(kSize);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t t = 0; t < kThreadCount; ++t) {
+    threads.push_back(std::make_unique<Thread>([&uf, t]() {
+      for (int64_t i = t; i < kSize - 1; i += kThreadCount) {
+        uf.Union(kSize - 1 - i, kSize - 2 - i);
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread->Join();
+  }
+  for (int64_t i = 0; i < kSize; ++i) {
+    EXPECT_EQ(uf.Find(i), 0);
+  }
+}
+
 }  // namespace
 }  // namespace xls
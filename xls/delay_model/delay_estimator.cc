@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -250,15 +251,72 @@ absl::StatusOr<int64_t> FirstMatchDelayEstimator::GetOperationDelayInPs(
 }
 
 CachingDelayEstimator::CachingDelayEstimator(std::string_view name,
-                                             const DelayEstimator& cached)
-    : DelayEstimator(name), cached_(cached) {}
+                                             const DelayEstimator& cached,
+                                             CacheKey cache_key)
+    : DelayEstimator(name), cached_(cached), cache_key_(cache_key) {}
+
+CachingDelayEstimator::Key CachingDelayEstimator::GetKey(Node* node) const {
+  if (cache_key_ == CacheKey::kNode || !node->GetType()->IsBits() ||
+      node->operand_count() > 64) {
+    return node;
+  }
+  switch (node->op()) {
+    case Op::kInvoke:
+    case Op::kMap:
+    case Op::kCountedFor:
+    case Op::kDynamicCountedFor:
+      return node;
+    case Op::kOneHotSel:
+    case Op::kPrioritySel:
+      // The delay of a select with a known selector may depend on its value.
+      if (node->operand(0)->Is<Literal>()) {
+        return node;
+      }
+      break;
+    default:
+      break;
+  }
+  OpSignature signature{.op = node->op(),
+                        .result_width = node->BitCountOrDie(),
+                        .literal_operands = 0};
+  for (int64_t i = 0; i < node->operand_count(); ++i) {
+    Node* operand = node->operand(i);
+    if (!operand->GetType()->IsBits()) {
+      return node;
+    }
+    signature.operand_widths.push_back(operand->BitCountOrDie());
+    if (operand->Is<Literal>()) {
+      signature.literal_operands |= uint64_t{1} << i;
+    }
+  }
+  return signature;
+}
+
+std::optional<int64_t> CachingDelayEstimator::Lookup(const Key& key) const {
+  Shard& shard = GetShard(key);
+  absl::ReaderMutexLock lock(&shard.mutex);
+  auto it = shard.delays.find(key);
+  if (it == shard.delays.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void CachingDelayEstimator::AddNodeDelay(Node* node, int64_t delay) const {
+  Key key = GetKey(node);
+  Shard& shard = GetShard(key);
+  absl::WriterMutexLock lock(&shard.mutex);
+  shard.delays.emplace(std::move(key), delay);
+}
 
 absl::StatusOr<int64_t> CachingDelayEstimator::GetOperationDelayInPs(
     Node* node) const {
-  if (ContainsNodeDelay(node)) {
-    return GetNodeDelay(node);
+  if (std::optional<int64_t> delay = Lookup(GetKey(node)); delay.has_value()) {
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return *delay;
   }
 
+  misses_.fetch_add(1, std::memory_order_relaxed);
   XLS_ASSIGN_OR_RETURN(int64_t delay, cached_.GetOperationDelayInPs(node));
   AddNodeDelay(node, delay);
   return delay;
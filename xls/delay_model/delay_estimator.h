@@ -15,22 +15,29 @@
 #ifndef XLS_DELAY_MODEL_DELAY_ESTIMATOR_H_
 #define XLS_DELAY_MODEL_DELAY_ESTIMATOR_H_
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/test_macros.h"
 #include "xls/ir/node.h"
+#include "xls/ir/op.h"
 
 namespace xls {
 
@@ -90,36 +97,101 @@ class FirstMatchDelayEstimator : public DelayEstimator {
 
 // Cache the delay of an underlying delay estimator. This class is safe for
 // concurrent access.
+//
+// The cache is split into shards, each with its own lock, so that concurrent
+// lookups of different nodes rarely contend. Lookups which hit only take a
+// shared lock.
 class CachingDelayEstimator : public DelayEstimator {
  public:
-  CachingDelayEstimator(std::string_view name, const DelayEstimator& cached);
+  // What cached delays are keyed on.
+  enum class CacheKey {
+    // The node itself.
+    kNode,
+    // The op, result and operand bit widths, and which operands are literals.
+    // Structurally identical nodes, e.g. in different functions, then share a
+    // cache entry. Only valid if the cached estimator's delays depend on
+    // nothing else, as for the estimators generated from delay models. Nodes
+    // with non-bits types, nodes which call other functions, and one-hot or
+    // priority selects with a literal selector are always keyed on the node.
+    kOpSignature,
+  };
+
+  // Cache hit and miss counts since construction.
+  struct CacheStats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+
+    double hit_rate() const {
+      int64_t lookups = hits + misses;
+      return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+    }
+  };
+
+  CachingDelayEstimator(std::string_view name, const DelayEstimator& cached,
+                        CacheKey cache_key = CacheKey::kNode);
 
   ~CachingDelayEstimator() override = default;
 
   absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override;
 
+  CacheStats cache_stats() const {
+    return CacheStats{.hits = hits_.load(std::memory_order_relaxed),
+                      .misses = misses_.load(std::memory_order_relaxed)};
+  }
+
  private:
+  struct OpSignature {
+    Op op;
+    int64_t result_width;
+    absl::InlinedVector<int64_t, 4> operand_widths;
+    // Bit i is set if operand i is a literal.
+    uint64_t literal_operands;
+
+    bool operator==(const OpSignature& other) const {
+      return op == other.op && result_width == other.result_width &&
+             operand_widths == other.operand_widths &&
+             literal_operands == other.literal_operands;
+    }
+
+    template <typename H>
+    friend H AbslHashValue(H h, const OpSignature& s) {
+      return H::combine(std::move(h), s.op, s.result_width, s.operand_widths,
+                        s.literal_operands);
+    }
+  };
+  using Key = std::variant<Node*, OpSignature>;
+
+  static constexpr int64_t kShardCount = 16;
+  struct Shard {
+    mutable absl::Mutex mutex;
+    absl::flat_hash_map<Key, int64_t> delays ABSL_GUARDED_BY(mutex);
+  };
+
+  Key GetKey(Node* node) const;
+  Shard& GetShard(const Key& key) const {
+    // Use high bits of the hash; the low bits are used within each map.
+    return shards_[(absl::Hash<Key>{}(key) >> 32) % kShardCount];
+  }
+  std::optional<int64_t> Lookup(const Key& key) const;
+
   bool ContainsNodeDelay(Node* node) const {
-    absl::ReaderMutexLock lock(&cache_mutex_);
-    return cache_.contains(node);
+    return Lookup(GetKey(node)).has_value();
   }
 
   int64_t GetNodeDelay(Node* node) const {
-    absl::ReaderMutexLock lock(&cache_mutex_);
-    return cache_.at(node);
+    return Lookup(GetKey(node)).value();
   }
 
-  void AddNodeDelay(Node* node, int64_t delay) const {
-    absl::WriterMutexLock lock(&cache_mutex_);
-    cache_.emplace(node, delay);
-  }
+  void AddNodeDelay(Node* node, int64_t delay) const;
 
   XLS_FRIEND_TEST(DelayEstimatorTest, CachingDelayEstimator);
+  XLS_FRIEND_TEST(DelayEstimatorTest, CachingDelayEstimatorOpSignature);
 
   const DelayEstimator& cached_;
-  mutable absl::Mutex cache_mutex_;
-  mutable absl::flat_hash_map<Node*, int64_t> cache_
-      ABSL_GUARDED_BY(cache_mutex_);
+  const CacheKey cache_key_;
+  mutable std::array<Shard, kShardCount> shards_;
+  mutable std::atomic<int64_t> hits_ = 0;
+  mutable std::atomic<int64_t> misses_ = 0;
 };
 
 enum class DelayEstimatorPrecedence {
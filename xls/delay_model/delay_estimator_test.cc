@@ -301,6 +301,42 @@ TEST_F(DelayEstimatorTest, CachingDelayEstimator) {
               IsOkAndHolds(1));
   EXPECT_THAT(caching.ContainsNodeDelay(f->return_value()), true);
   EXPECT_THAT(caching.GetNodeDelay(f->return_value()), 1);
+  EXPECT_THAT(caching.GetOperationDelayInPs(f->return_value()),
+              IsOkAndHolds(1));
+  EXPECT_EQ(caching.cache_stats().hits, 1);
+  EXPECT_EQ(caching.cache_stats().misses, 1);
+  EXPECT_DOUBLE_EQ(caching.cache_stats().hit_rate(), 0.5);
+}
+
+TEST_F(DelayEstimatorTest, CachingDelayEstimatorOpSignature) {
+  auto p = CreatePackage();
+  FunctionBuilder fb1("f1", p.get());
+  BValue x1 = fb1.Param("x", p->GetBitsType(8));
+  BValue y1 = fb1.Param("y", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f1,
+                           fb1.BuildWithReturnValue(fb1.Add(x1, y1)));
+  FunctionBuilder fb2("f2", p.get());
+  BValue x2 = fb2.Param("x", p->GetBitsType(8));
+  BValue y2 = fb2.Param("y", p->GetBitsType(8));
+  BValue add2 = fb2.Add(x2, y2);
+  BValue add_literal = fb2.Add(x2, fb2.Literal(UBits(1, 8)));
+  BValue wide = fb2.Add(fb2.ZeroExtend(add2, 16), fb2.ZeroExtend(y2, 16));
+  XLS_ASSERT_OK(
+      fb2.BuildWithReturnValue(fb2.Tuple({add_literal, wide})).status());
+
+  FakeDelayEstimator one(1, "one");
+  CachingDelayEstimator caching("caching", one,
+                                CachingDelayEstimator::CacheKey::kOpSignature);
+  XLS_ASSERT_OK(caching.GetOperationDelayInPs(f1->return_value()).status());
+  EXPECT_TRUE(caching.ContainsNodeDelay(add2.node()));
+  EXPECT_FALSE(caching.ContainsNodeDelay(add_literal.node()));
+  EXPECT_FALSE(caching.ContainsNodeDelay(wide.node()));
+
+  XLS_ASSERT_OK(caching.GetOperationDelayInPs(add2.node()).status());
+  XLS_ASSERT_OK(caching.GetOperationDelayInPs(add_literal.node()).status());
+  XLS_ASSERT_OK(caching.GetOperationDelayInPs(wide.node()).status());
+  EXPECT_EQ(caching.cache_stats().hits, 1);
+  EXPECT_EQ(caching.cache_stats().misses, 3);
 }
 
 // A Delay Estimator that can only handle one kind of operation.
@@ -0,0 +1,244 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/delay_model/incremental_critical_path.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/delay_model/analyze_critical_path.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/topo_sort.h"
+
+namespace xls {
+namespace {
+
+// Returns the nodes of `dirty` ordered such that each node comes after every
+// node of `dirty` among its `neighbors` (operands or users).
+std::vector<Node*> OrderDirtyNodes(
+    const absl::flat_hash_set<Node*>& dirty,
+    const std::function<absl::Span<Node* const>(Node*)>& neighbors) {
+  std::vector<Node*> order;
+  order.reserve(dirty.size());
+  absl::flat_hash_set<Node*> visited;
+  std::vector<std::pair<Node*, int64_t>> stack;
+  for (Node* root : dirty) {
+    if (!visited.insert(root).second) {
+      continue;
+    }
+    stack.push_back({root, 0});
+    while (!stack.empty()) {
+      Node* node = stack.back().first;
+      absl::Span<Node* const> next_nodes = neighbors(node);
+      int64_t& next_index = stack.back().second;
+      if (next_index < next_nodes.size()) {
+        Node* next = next_nodes[next_index++];
+        if (dirty.contains(next) && visited.insert(next).second) {
+          stack.push_back({next, 0});
+        }
+        continue;
+      }
+      order.push_back(node);
+      stack.pop_back();
+    }
+  }
+  return order;
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<IncrementalCriticalPathAnalysis>>
+IncrementalCriticalPathAnalysis::Create(FunctionBase* f,
+                                        std::optional<int64_t> clock_period_ps,
+                                        const DelayEstimator& delay_estimator) {
+  auto analysis = absl::WrapUnique(
+      new IncrementalCriticalPathAnalysis(f, clock_period_ps, delay_estimator));
+  for (Node* node : TopoSort(f)) {
+    XLS_ASSIGN_OR_RETURN(analysis->timing_[node].node_delay,
+                         delay_estimator.GetOperationDelayInPs(node));
+    XLS_RETURN_IF_ERROR(analysis->ComputeArrival(node));
+  }
+  for (Node* node : ReverseTopoSort(f)) {
+    XLS_RETURN_IF_ERROR(analysis->ComputeDownstream(node));
+  }
+  return analysis;
+}
+
+const IncrementalCriticalPathAnalysis::NodeTiming&
+IncrementalCriticalPathAnalysis::GetTiming(Node* node) const {
+  CHECK(!NeedsUpdate()) << "Update() must be called before querying timing";
+  auto it = timing_.find(node);
+  CHECK(it != timing_.end()) << "Node not known to the analysis: "
+                             << node->GetName();
+  return it->second;
+}
+
+void IncrementalCriticalPathAnalysis::InvalidateArrivals(Node* node) {
+  std::vector<Node*> worklist = {node};
+  while (!worklist.empty()) {
+    Node* n = worklist.back();
+    worklist.pop_back();
+    if (!arrival_dirty_.insert(n).second) {
+      continue;
+    }
+    worklist.insert(worklist.end(), n->users().begin(), n->users().end());
+  }
+}
+
+void IncrementalCriticalPathAnalysis::InvalidateDownstream(Node* node) {
+  std::vector<Node*> worklist = {node};
+  while (!worklist.empty()) {
+    Node* n = worklist.back();
+    worklist.pop_back();
+    if (!downstream_dirty_.insert(n).second) {
+      continue;
+    }
+    worklist.insert(worklist.end(), n->operands().begin(),
+                    n->operands().end());
+  }
+}
+
+absl::Status IncrementalCriticalPathAnalysis::MarkModified(Node* node) {
+  XLS_RET_CHECK_EQ(node->function_base(), f_);
+  XLS_ASSIGN_OR_RETURN(int64_t delay,
+                       delay_estimator_.GetOperationDelayInPs(node));
+  return SetNodeDelay(node, delay);
+}
+
+absl::Status IncrementalCriticalPathAnalysis::SetNodeDelay(Node* node,
+                                                           int64_t delay_ps) {
+  XLS_RET_CHECK_EQ(node->function_base(), f_);
+  timing_[node].node_delay = delay_ps;
+  InvalidateArrivals(node);
+  InvalidateDownstream(node);
+  return absl::OkStatus();
+}
+
+absl::Status IncrementalCriticalPathAnalysis::NodeRemoved(Node* node) {
+  XLS_RET_CHECK(node->users().empty()) << node->GetName();
+  auto it = timing_.find(node);
+  XLS_RET_CHECK(it != timing_.end()) << node->GetName();
+  arrivals_.erase({it->second.arrival, node->id(), node});
+  timing_.erase(it);
+  arrival_dirty_.erase(node);
+  downstream_dirty_.erase(node);
+  for (Node* operand : node->operands()) {
+    InvalidateDownstream(operand);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status IncrementalCriticalPathAnalysis::ComputeArrival(Node* node) {
+  NodeTiming& timing = timing_[node];
+  arrivals_.erase({timing.arrival, node->id(), node});
+
+  // The maximum delay from any path up to but not including `node`. As in
+  // AnalyzeCriticalPath, ties are broken in favor of the last operand.
+  int64_t max_path_delay = 0;
+  timing.critical_operand = nullptr;
+  for (Node* operand : node->operands()) {
+    auto it = timing_.find(operand);
+    XLS_RET_CHECK(it != timing_.end())
+        << "Operand " << operand->GetName() << " of " << node->GetName()
+        << " is not known to the analysis";
+    if (it->second.arrival >= max_path_delay) {
+      max_path_delay = it->second.arrival;
+      timing.critical_operand = operand;
+    }
+  }
+
+  // If the dependency straddles a clock boundary the delay starts from the
+  // clock time.
+  timing.delayed_by_cycle_boundary = false;
+  if (clock_period_ps_.has_value() &&
+      (max_path_delay + timing.node_delay) / *clock_period_ps_ >
+          max_path_delay / *clock_period_ps_) {
+    max_path_delay = RoundDownToNearest(max_path_delay + timing.node_delay,
+                                        *clock_period_ps_);
+    timing.delayed_by_cycle_boundary = true;
+  }
+  timing.arrival = max_path_delay + timing.node_delay;
+  arrivals_.insert({timing.arrival, node->id(), node});
+  return absl::OkStatus();
+}
+
+absl::Status IncrementalCriticalPathAnalysis::ComputeDownstream(Node* node) {
+  int64_t downstream = 0;
+  for (Node* user : node->users()) {
+    auto it = timing_.find(user);
+    XLS_RET_CHECK(it != timing_.end())
+        << "User " << user->GetName() << " of " << node->GetName()
+        << " is not known to the analysis";
+    downstream =
+        std::max(downstream, it->second.node_delay + it->second.downstream);
+  }
+  timing_[node].downstream = downstream;
+  return absl::OkStatus();
+}
+
+absl::Status IncrementalCriticalPathAnalysis::Update() {
+  for (Node* node : OrderDirtyNodes(
+           arrival_dirty_, [](Node* n) { return n->operands(); })) {
+    XLS_RETURN_IF_ERROR(ComputeArrival(node));
+  }
+  arrival_dirty_.clear();
+  for (Node* node : OrderDirtyNodes(
+           downstream_dirty_, [](Node* n) { return n->users(); })) {
+    XLS_RETURN_IF_ERROR(ComputeDownstream(node));
+  }
+  downstream_dirty_.clear();
+  return absl::OkStatus();
+}
+
+int64_t IncrementalCriticalPathAnalysis::CriticalPathDelay() const {
+  CHECK(!NeedsUpdate()) << "Update() must be called before querying timing";
+  return arrivals_.empty() ? 0 : std::get<0>(*arrivals_.rbegin());
+}
+
+absl::StatusOr<std::vector<CriticalPathEntry>>
+IncrementalCriticalPathAnalysis::CriticalPath() const {
+  XLS_RET_CHECK(!NeedsUpdate())
+      << "Update() must be called before querying timing";
+  XLS_RET_CHECK(!arrivals_.empty());
+  std::vector<CriticalPathEntry> critical_path;
+  for (Node* node = std::get<2>(*arrivals_.rbegin()); node != nullptr;
+       node = timing_.at(node).critical_operand) {
+    const NodeTiming& timing = timing_.at(node);
+    critical_path.push_back(CriticalPathEntry{
+        .node = node,
+        .node_delay_ps = timing.node_delay,
+        .path_delay_ps = timing.arrival,
+        .delayed_by_cycle_boundary = timing.delayed_by_cycle_boundary});
+  }
+  return critical_path;
+}
+
+}  // namespace xls
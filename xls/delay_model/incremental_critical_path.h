@@ -0,0 +1,160 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_DELAY_MODEL_INCREMENTAL_CRITICAL_PATH_H_
+#define XLS_DELAY_MODEL_INCREMENTAL_CRITICAL_PATH_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/delay_model/analyze_critical_path.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// Maintains per-node timing of a function or proc across small modifications
+// so that repeated critical-path queries do not re-analyze the whole graph.
+//
+// For each node the analysis tracks:
+//
+//   arrival time: the delay of the critical path up to and including the node,
+//     computed exactly as AnalyzeCriticalPath does (including the elongation
+//     caused by cycle boundaries when a clock period is given).
+//   downstream delay: the longest combinational delay from the output of the
+//     node to any sink, excluding the node's own delay and ignoring cycle
+//     boundaries.
+//
+// The required time of a node is the critical-path delay minus its downstream
+// delay; slack is the required time minus the arrival time.
+//
+// The analysis is not notified of IR changes automatically. After changing the
+// graph the caller must report each change, then call Update() before the next
+// query:
+//
+//   * MarkModified(node) for every added node, every node whose operands
+//     changed, and every node which gained or lost users (e.g. the old and new
+//     operand of a ReplaceOperand).
+//   * NodeRemoved(node) before removing a node from the function.
+//   * SetNodeDelay(node, delay) to override the estimated delay of a node, for
+//     example with a delay obtained from synthesis.
+//
+// Update() only recomputes the arrival times of the fan-out cones and the
+// downstream delays of the fan-in cones of the reported nodes. Delays are only
+// estimated for the reported nodes.
+class IncrementalCriticalPathAnalysis {
+ public:
+  // Analyzes all nodes of `f`. `delay_estimator` must outlive the analysis.
+  static absl::StatusOr<std::unique_ptr<IncrementalCriticalPathAnalysis>>
+  Create(FunctionBase* f, std::optional<int64_t> clock_period_ps,
+         const DelayEstimator& delay_estimator);
+
+  // Re-estimates the delay of `node` (discarding any delay set with
+  // SetNodeDelay) and invalidates the timing of its fan-in and fan-out cones.
+  // `node` need not have been seen by the analysis before.
+  absl::Status MarkModified(Node* node);
+
+  // Sets the delay of `node` and invalidates the timing of its fan-in and
+  // fan-out cones.
+  absl::Status SetNodeDelay(Node* node, int64_t delay_ps);
+
+  // Forgets `node`. Must be called while `node` is still in the function and
+  // has no users.
+  absl::Status NodeRemoved(Node* node);
+
+  // Propagates all changes reported since the last update.
+  absl::Status Update();
+
+  // Returns whether changes have been reported since the last Update().
+  bool NeedsUpdate() const {
+    return !arrival_dirty_.empty() || !downstream_dirty_.empty();
+  }
+
+  // The following queries require that there are no pending changes.
+
+  // Returns the delay of the critical path through the function.
+  int64_t CriticalPathDelay() const;
+
+  // Returns the critical path in the same form as AnalyzeCriticalPath; the
+  // last node of the path is at the front. If several paths are equally
+  // critical, the one ending at the node with the largest id is returned.
+  absl::StatusOr<std::vector<CriticalPathEntry>> CriticalPath() const;
+
+  int64_t NodeDelay(Node* node) const { return GetTiming(node).node_delay; }
+  int64_t ArrivalTime(Node* node) const { return GetTiming(node).arrival; }
+  int64_t DownstreamDelay(Node* node) const {
+    return GetTiming(node).downstream;
+  }
+  int64_t RequiredTime(Node* node) const {
+    return CriticalPathDelay() - DownstreamDelay(node);
+  }
+  int64_t Slack(Node* node) const {
+    return RequiredTime(node) - ArrivalTime(node);
+  }
+
+ private:
+  struct NodeTiming {
+    int64_t node_delay = 0;
+    int64_t arrival = 0;
+    // The operand through which the critical path to this node passes, or
+    // nullptr if the node has no operands.
+    Node* critical_operand = nullptr;
+    bool delayed_by_cycle_boundary = false;
+    int64_t downstream = 0;
+  };
+
+  IncrementalCriticalPathAnalysis(FunctionBase* f,
+                                  std::optional<int64_t> clock_period_ps,
+                                  const DelayEstimator& delay_estimator)
+      : f_(f),
+        clock_period_ps_(clock_period_ps),
+        delay_estimator_(delay_estimator) {}
+
+  const NodeTiming& GetTiming(Node* node) const;
+
+  // Marks `node` and its transitive users as needing new arrival times.
+  void InvalidateArrivals(Node* node);
+  // Marks `node` and its transitive operands as needing new downstream
+  // delays.
+  void InvalidateDownstream(Node* node);
+
+  absl::Status ComputeArrival(Node* node);
+  absl::Status ComputeDownstream(Node* node);
+
+  FunctionBase* f_;
+  std::optional<int64_t> clock_period_ps_;
+  const DelayEstimator& delay_estimator_;
+
+  absl::flat_hash_map<Node*, NodeTiming> timing_;
+  absl::flat_hash_set<Node*> arrival_dirty_;
+  absl::flat_hash_set<Node*> downstream_dirty_;
+
+  // All nodes ordered by (arrival time, id); the last entry ends the critical
+  // path.
+  std::set<std::tuple<int64_t, int64_t, Node*>> arrivals_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_DELAY_MODEL_INCREMENTAL_CRITICAL_PATH_H_
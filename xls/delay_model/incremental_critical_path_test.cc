@@ -0,0 +1,166 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/delay_model/incremental_critical_path.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/delay_model/analyze_critical_path.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/delay_model/delay_estimators.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+
+namespace xls {
+namespace {
+
+class IncrementalCriticalPathTest : public IrTestBase {
+ protected:
+  // Expects that `analysis` reports the same critical-path delay as a
+  // from-scratch analysis of `f`.
+  void ExpectMatchesFullAnalysis(IncrementalCriticalPathAnalysis& analysis,
+                                 FunctionBase* f,
+                                 std::optional<int64_t> clock_period_ps) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::vector<CriticalPathEntry> expected,
+        AnalyzeCriticalPath(f, clock_period_ps, *delay_estimator_));
+    XLS_ASSERT_OK_AND_ASSIGN(std::vector<CriticalPathEntry> actual,
+                             analysis.CriticalPath());
+    ASSERT_FALSE(actual.empty());
+    EXPECT_EQ(analysis.CriticalPathDelay(), expected.front().path_delay_ps);
+    EXPECT_EQ(actual.front().path_delay_ps, expected.front().path_delay_ps);
+    EXPECT_EQ(actual.size(), expected.size());
+  }
+
+  const DelayEstimator* delay_estimator_ = GetDelayEstimator("unit").value();
+};
+
+TEST_F(IncrementalCriticalPathTest, MatchesFullAnalysis) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue add = fb.Add(x, y);
+  BValue neg = fb.Negate(add);
+  BValue sub = fb.Subtract(neg, x);
+  BValue rev = fb.Reverse(y);
+  fb.Tuple({sub, rev});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  for (std::optional<int64_t> clock_period_ps :
+       {std::optional<int64_t>(), std::optional<int64_t>(2)}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<IncrementalCriticalPathAnalysis> analysis,
+        IncrementalCriticalPathAnalysis::Create(f, clock_period_ps,
+                                                *delay_estimator_));
+    ExpectMatchesFullAnalysis(*analysis, f, clock_period_ps);
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalCriticalPathAnalysis> analysis,
+      IncrementalCriticalPathAnalysis::Create(f, std::nullopt,
+                                              *delay_estimator_));
+  EXPECT_EQ(analysis->CriticalPathDelay(), 4);
+  EXPECT_EQ(analysis->ArrivalTime(neg.node()), 2);
+  EXPECT_EQ(analysis->DownstreamDelay(neg.node()), 2);
+  EXPECT_EQ(analysis->Slack(neg.node()), 0);
+  EXPECT_EQ(analysis->ArrivalTime(rev.node()), 1);
+  EXPECT_EQ(analysis->DownstreamDelay(rev.node()), 1);
+  EXPECT_EQ(analysis->Slack(rev.node()), 2);
+}
+
+TEST_F(IncrementalCriticalPathTest, AddAndRemoveNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue neg = fb.Negate(x);
+  BValue rev = fb.Reverse(neg);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalCriticalPathAnalysis> analysis,
+      IncrementalCriticalPathAnalysis::Create(f, std::nullopt,
+                                              *delay_estimator_));
+  EXPECT_EQ(analysis->CriticalPathDelay(), 2);
+
+  // Insert a second negate between `neg` and `rev`.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * neg2, f->MakeNode<UnOp>(SourceInfo(), neg.node(), Op::kNeg));
+  XLS_ASSERT_OK(rev.node()->ReplaceOperandNumber(0, neg2));
+  XLS_ASSERT_OK(analysis->MarkModified(neg2));
+  XLS_ASSERT_OK(analysis->MarkModified(rev.node()));
+  XLS_ASSERT_OK(analysis->MarkModified(neg.node()));
+  EXPECT_TRUE(analysis->NeedsUpdate());
+  XLS_ASSERT_OK(analysis->Update());
+  EXPECT_EQ(analysis->CriticalPathDelay(), 3);
+  EXPECT_EQ(analysis->DownstreamDelay(x.node()), 3);
+  ExpectMatchesFullAnalysis(*analysis, f, std::nullopt);
+
+  // And remove it again.
+  XLS_ASSERT_OK(rev.node()->ReplaceOperandNumber(0, neg.node()));
+  XLS_ASSERT_OK(analysis->NodeRemoved(neg2));
+  XLS_ASSERT_OK(f->RemoveNode(neg2));
+  XLS_ASSERT_OK(analysis->MarkModified(rev.node()));
+  XLS_ASSERT_OK(analysis->Update());
+  EXPECT_EQ(analysis->CriticalPathDelay(), 2);
+  EXPECT_EQ(analysis->DownstreamDelay(x.node()), 2);
+  ExpectMatchesFullAnalysis(*analysis, f, std::nullopt);
+}
+
+TEST_F(IncrementalCriticalPathTest, SetNodeDelay) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue neg = fb.Negate(x);
+  BValue rev = fb.Reverse(x);
+  fb.Tuple({neg, rev});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalCriticalPathAnalysis> analysis,
+      IncrementalCriticalPathAnalysis::Create(f, std::nullopt,
+                                              *delay_estimator_));
+  EXPECT_EQ(analysis->CriticalPathDelay(), 2);
+
+  XLS_ASSERT_OK(analysis->SetNodeDelay(rev.node(), 10));
+  XLS_ASSERT_OK(analysis->Update());
+  EXPECT_EQ(analysis->CriticalPathDelay(), 11);
+  EXPECT_EQ(analysis->NodeDelay(rev.node()), 10);
+  EXPECT_EQ(analysis->Slack(rev.node()), 0);
+  EXPECT_EQ(analysis->Slack(neg.node()), 9);
+  EXPECT_EQ(analysis->DownstreamDelay(x.node()), 11);
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<CriticalPathEntry> cp,
+                           analysis->CriticalPath());
+  ASSERT_EQ(cp.size(), 3);
+  EXPECT_EQ(cp[1].node, rev.node());
+  EXPECT_EQ(cp[2].node, x.node());
+
+  // Re-estimating restores the model delay.
+  XLS_ASSERT_OK(analysis->MarkModified(rev.node()));
+  XLS_ASSERT_OK(analysis->Update());
+  EXPECT_EQ(analysis->CriticalPathDelay(), 2);
+}
+
+}  // namespace
+}  // namespace xls
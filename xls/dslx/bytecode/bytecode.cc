@@ -206,6 +206,12 @@ absl::StatusOr<Bytecode::Op> OpFromString(std::string_view s) {
   if (s == "xor") {
     return Bytecode::Op::kXor;
   }
+  if (s == "fused_binop") {
+    return Bytecode::Op::kFusedBinop;
+  }
+  if (s == "literal_compare_jump_rel_if") {
+    return Bytecode::Op::kLiteralCompareJumpRelIf;
+  }
   return absl::InvalidArgumentError(
       absl::StrCat("String was not a bytecode op: `", s, "`"));
 }
@@ -318,10 +324,50 @@ std::string OpToString(Bytecode::Op op) {
       return "width_slice";
     case Bytecode::Op::kXor:
       return "xor";
+    case Bytecode::Op::kFusedBinop:
+      return "fused_binop";
+    case Bytecode::Op::kLiteralCompareJumpRelIf:
+      return "literal_compare_jump_rel_if";
   }
   return absl::StrCat("<invalid: ", static_cast<int>(op), ">");
 }
 
+bool OpIsBinop(Bytecode::Op op) {
+  switch (op) {
+    case Bytecode::Op::kUAdd:
+    case Bytecode::Op::kSAdd:
+    case Bytecode::Op::kAnd:
+    case Bytecode::Op::kConcat:
+    case Bytecode::Op::kDiv:
+    case Bytecode::Op::kMod:
+    case Bytecode::Op::kUMul:
+    case Bytecode::Op::kSMul:
+    case Bytecode::Op::kOr:
+    case Bytecode::Op::kShl:
+    case Bytecode::Op::kShr:
+    case Bytecode::Op::kUSub:
+    case Bytecode::Op::kSSub:
+    case Bytecode::Op::kXor:
+      return true;
+    default:
+      return OpIsComparison(op);
+  }
+}
+
+bool OpIsComparison(Bytecode::Op op) {
+  switch (op) {
+    case Bytecode::Op::kEq:
+    case Bytecode::Op::kNe:
+    case Bytecode::Op::kLt:
+    case Bytecode::Op::kLe:
+    case Bytecode::Op::kGt:
+    case Bytecode::Op::kGe:
+      return true;
+    default:
+      return false;
+  }
+}
+
 std::string BytecodesToString(absl::Span<const Bytecode> bytecodes,
                               bool source_locs) {
   std::string program;
@@ -540,6 +586,20 @@ absl::StatusOr<const Bytecode::ChannelData*> Bytecode::channel_data() const {
   return &std::get<ChannelData>(data_.value());
 }
 
+absl::StatusOr<const Bytecode::CompareJumpData*> Bytecode::compare_jump_data()
+    const {
+  XLS_RET_CHECK(data_.has_value());
+  XLS_RET_CHECK(std::holds_alternative<CompareJumpData>(data_.value()));
+  return &std::get<CompareJumpData>(data_.value());
+}
+
+absl::StatusOr<const Bytecode::FusedBinopData*> Bytecode::fused_binop_data()
+    const {
+  XLS_RET_CHECK(data_.has_value());
+  XLS_RET_CHECK(std::holds_alternative<FusedBinopData>(data_.value()));
+  return &std::get<FusedBinopData>(data_.value());
+}
+
 absl::StatusOr<Bytecode::SlotIndex> Bytecode::slot_index() const {
   XLS_RET_CHECK(data_.has_value());
   XLS_RET_CHECK(std::holds_alternative<SlotIndex>(data_.value()));
@@ -653,6 +713,29 @@ std::string Bytecode::ToString(bool source_locs) const {
       std::string operator()(const SpawnData& spawn_data) {
         return spawn_data.spawn()->ToString();
       }
+
+      std::string operator()(const FusedBinopData& fused) {
+        auto operand_to_string = [](const FusedOperand& operand) {
+          if (std::holds_alternative<SlotIndex>(operand)) {
+            return absl::StrCat("slot:", std::get<SlotIndex>(operand).value());
+          }
+          return std::get<InterpValue>(operand).ToString();
+        };
+        std::string result =
+            absl::StrFormat("%s %s %s", OpToString(fused.binop),
+                            operand_to_string(fused.lhs),
+                            operand_to_string(fused.rhs));
+        if (fused.result.has_value()) {
+          absl::StrAppend(&result, " -> slot:", fused.result->value());
+        }
+        return result;
+      }
+
+      std::string operator()(const CompareJumpData& compare_jump) {
+        return absl::StrFormat("%s %s %d", OpToString(compare_jump.comparison),
+                               compare_jump.rhs.ToString(),
+                               compare_jump.target.value());
+      }
     };
 
     std::string data_string = absl::visit(DataVisitor(), data_.value());
@@ -758,6 +841,16 @@ std::vector<Bytecode> BytecodeFunction::CloneBytecodes() const {
         bytecodes.emplace_back(
             Bytecode(bc.source_span(), bc.op(),
                      std::get<InterpValue>(bc.data().value())));
+      } else if (std::holds_alternative<Bytecode::FusedBinopData>(
+                     bc.data().value())) {
+        bytecodes.emplace_back(
+            Bytecode(bc.source_span(), bc.op(),
+                     std::get<Bytecode::FusedBinopData>(bc.data().value())));
+      } else if (std::holds_alternative<Bytecode::CompareJumpData>(
+                     bc.data().value())) {
+        bytecodes.emplace_back(
+            Bytecode(bc.source_span(), bc.op(),
+                     std::get<Bytecode::CompareJumpData>(bc.data().value())));
       } else {
         const std::unique_ptr<Type>& type =
             std::get<std::unique_ptr<Type>>(bc.data().value());
@@ -181,6 +181,20 @@ class Bytecode {
     kWidthSlice,
     // Performs a bitwise XOR of the top two values on the stack.
     kXor,
+
+    // Superinstructions: these are never produced by BytecodeEmitter but are
+    // formed from common instruction sequences by OptimizeBytecode (see
+    // bytecode_optimizer.h).
+    //
+    // Applies the binary operation given in the FusedBinopData data member to
+    // operands held in slots or given as literals, and either stores the
+    // result in a slot or pushes it onto the stack. Replaces
+    // `load|literal, load|literal, <binop>[, store]`.
+    kFusedBinop,
+    // Pops TOS0, compares it against the literal in the CompareJumpData data
+    // member, and jumps (relative) if the comparison is true, i.e. TOS0 is the
+    // left-hand side. Replaces `literal, <comparison>, jump_rel_if`.
+    kLiteralCompareJumpRelIf,
   };
 
   // Indicates the amount by which the PC should be adjusted.
@@ -195,6 +209,29 @@ class Bytecode {
   // by kLoad and kStore opcodes.
   XLS_DEFINE_STRONG_INT_TYPE(SlotIndex, int64_t);
 
+  // An operand of a kFusedBinop: either the slot it is loaded from or a
+  // literal.
+  using FusedOperand = std::variant<SlotIndex, InterpValue>;
+
+  // Data for kFusedBinop.
+  struct FusedBinopData {
+    // The fused binary operation; OpIsBinop(binop) holds.
+    Op binop;
+    FusedOperand lhs;
+    FusedOperand rhs;
+    // The slot the result is stored to, or std::nullopt if it is pushed onto
+    // the stack.
+    std::optional<SlotIndex> result;
+  };
+
+  // Data for kLiteralCompareJumpRelIf.
+  struct CompareJumpData {
+    // The fused comparison; OpIsComparison(comparison) holds.
+    Op comparison;
+    InterpValue rhs;
+    JumpTarget target;
+  };
+
   // Data needed to resolve a potentially parametric Function invocation to
   // its concrete implementation.
   class InvocationData {
@@ -371,7 +408,8 @@ class Bytecode {
 
   using Data = std::variant<InterpValue, JumpTarget, NumElements, SlotIndex,
                             std::unique_ptr<Type>, InvocationData, MatchArmItem,
-                            SpawnData, TraceData, ChannelData>;
+                            SpawnData, TraceData, ChannelData, FusedBinopData,
+                            CompareJumpData>;
 
   static Bytecode MakeDup(Span span);
   static Bytecode MakeIndex(Span span);
@@ -415,6 +453,8 @@ class Bytecode {
 
   bool has_data() const { return data_.has_value(); }
 
+  absl::StatusOr<const CompareJumpData*> compare_jump_data() const;
+  absl::StatusOr<const FusedBinopData*> fused_binop_data() const;
   absl::StatusOr<InvocationData> invocation_data() const;
   absl::StatusOr<JumpTarget> jump_target() const;
   absl::StatusOr<const MatchArmItem*> match_arm_item() const;
@@ -452,6 +492,14 @@ class Bytecode {
 
 std::string OpToString(Bytecode::Op op);
 
+// Returns true if `op` pops two values and pushes the result of applying a
+// binary operation to them; i.e. it may be the `binop` of a FusedBinopData.
+bool OpIsBinop(Bytecode::Op op);
+
+// Returns true if `op` is one of the comparison binops (kEq, kNe, kLt, kLe,
+// kGt, kGe).
+bool OpIsComparison(Bytecode::Op op);
+
 // Holds all the bytecode implementing a function along with useful metadata.
 class BytecodeFunction {
  public:
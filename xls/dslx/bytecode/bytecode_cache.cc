@@ -13,18 +13,30 @@
 // limitations under the License.
 #include "xls/dslx/bytecode/bytecode_cache.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/bytecode/bytecode.pb.h"
 #include "xls/dslx/bytecode/bytecode_emitter.h"
+#include "xls/dslx/bytecode/bytecode_to_proto.h"
+#include "xls/dslx/bytecode/persistent_bytecode_cache.h"
 #include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/ast_node.h"
+#include "xls/dslx/frontend/module.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/type_system/parametric_env.h"
 #include "xls/dslx/type_system/type_info.h"
@@ -40,13 +52,93 @@ absl::StatusOr<BytecodeFunction*> BytecodeCache::GetOrCreateBytecodeFunction(
   XLS_RET_CHECK(type_info != nullptr);
   Key key = std::make_tuple(&f, type_info, caller_bindings);
   if (!cache_.contains(key)) {
-    XLS_ASSIGN_OR_RETURN(
-        std::unique_ptr<BytecodeFunction> bf,
-        BytecodeEmitter::Emit(import_data_, type_info, f, caller_bindings));
+    std::unique_ptr<BytecodeFunction> bf;
+    if (PersistentBytecodeCache* persistent =
+            GetDefaultPersistentBytecodeCache();
+        persistent != nullptr) {
+      XLS_ASSIGN_OR_RETURN(bf, EmitWithPersistentCache(f, type_info,
+                                                       caller_bindings,
+                                                       *persistent));
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          bf, BytecodeEmitter::Emit(import_data_, type_info, f,
+                                    caller_bindings,
+                                    BytecodeEmitterOptions{.optimize = true}));
+    }
     cache_.emplace(key, std::move(bf));
   }
 
   return cache_.at(key).get();
 }
 
+absl::StatusOr<std::unique_ptr<BytecodeFunction>>
+BytecodeCache::EmitWithPersistentCache(
+    const Function& f, const TypeInfo* type_info,
+    const std::optional<ParametricEnv>& caller_bindings,
+    PersistentBytecodeCache& persistent) {
+  auto emit = [&]() {
+    return BytecodeEmitter::Emit(import_data_, type_info, f, caller_bindings,
+                                 BytecodeEmitterOptions{.optimize = true});
+  };
+  // Only functions of modules with a type info cache key can be identified
+  // across processes.
+  const ImportData::TypeInfoCacheRecord* record =
+      import_data_->GetTypeInfoCacheRecord(f.owner());
+  if (record == nullptr || !record->complete) {
+    return emit();
+  }
+  absl::Span<AstNode* const> nodes = f.owner()->nodes().first(
+      std::min<int64_t>(record->parsed_node_count, f.owner()->nodes().size()));
+  auto it = std::find(nodes.begin(), nodes.end(), &f);
+  if (it == nodes.end()) {
+    return emit();
+  }
+  std::optional<std::string> bindings;
+  if (caller_bindings.has_value()) {
+    bindings = caller_bindings->ToString();
+  }
+  std::string key = PersistentBytecodeCache::ComputeKey(
+      PersistentBytecodeCache::KeyOptions{
+          .module_key = record->key,
+          .function_index = it - nodes.begin(),
+          .bindings = bindings});
+
+  absl::StatusOr<std::optional<BytecodesProto>> entry = persistent.Lookup(key);
+  if (!entry.ok()) {
+    LOG(WARNING) << "Unable to read bytecode cache entry: " << entry.status();
+  } else if (entry->has_value()) {
+    absl::StatusOr<std::vector<Bytecode>> bytecodes =
+        BytecodesFromProto(**entry, *import_data_);
+    if (bytecodes.ok()) {
+      VLOG(1) << "Loaded bytecode for " << f.identifier()
+              << " from cache entry " << key;
+      return BytecodeFunction::Create(f.owner(), &f, type_info,
+                                      *std::move(bytecodes));
+    }
+    LOG(WARNING) << "Unable to restore bytecode cache entry " << key
+                 << "; emitting " << f.identifier()
+                 << " instead: " << bytecodes.status();
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<BytecodeFunction> bf, emit());
+  absl::StatusOr<BytecodesProto> proto = BytecodesToProto(
+      bf->bytecodes(), [&](const Module* m) -> std::optional<int64_t> {
+        const ImportData::TypeInfoCacheRecord* module_record =
+            import_data_->GetTypeInfoCacheRecord(m);
+        if (module_record == nullptr) {
+          return std::nullopt;
+        }
+        return module_record->parsed_node_count;
+      });
+  if (!proto.ok()) {
+    VLOG(1) << "Not caching bytecode for " << f.identifier() << ": "
+            << proto.status();
+    return bf;
+  }
+  if (absl::Status status = persistent.Insert(key, *proto); !status.ok()) {
+    LOG(WARNING) << "Unable to write bytecode cache entry: " << status;
+  }
+  return bf;
+}
+
 }  // namespace xls::dslx
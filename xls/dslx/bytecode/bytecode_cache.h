@@ -22,6 +22,7 @@
 #include "absl/status/statusor.h"
 #include "xls/dslx/bytecode/bytecode.h"
 #include "xls/dslx/bytecode/bytecode_cache_interface.h"
+#include "xls/dslx/bytecode/persistent_bytecode_cache.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/type_system/parametric_env.h"
@@ -41,6 +42,13 @@ class BytecodeCache : public BytecodeCacheInterface {
   using Key = std::tuple<const Function*, const TypeInfo*,
                          std::optional<ParametricEnv>>;
 
+  // Loads the bytecode of `f` from `persistent` if present, otherwise emits it
+  // and adds it to `persistent` when it can be serialized.
+  absl::StatusOr<std::unique_ptr<BytecodeFunction>> EmitWithPersistentCache(
+      const Function& f, const TypeInfo* type_info,
+      const std::optional<ParametricEnv>& caller_bindings,
+      PersistentBytecodeCache& persistent);
+
   ImportData* import_data_;
   absl::flat_hash_map<Key, std::unique_ptr<BytecodeFunction>> cache_;
 };
@@ -40,6 +40,7 @@
 #include "xls/common/symbolized_stacktrace.h"
 #include "xls/common/visitor.h"
 #include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/bytecode/bytecode_optimizer.h"
 #include "xls/dslx/dslx_builtins.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/ast_utils.h"
@@ -162,8 +163,12 @@ BytecodeEmitter::EmitProcNext(
   XLS_RETURN_IF_ERROR(emitter.Init(f));
   XLS_RETURN_IF_ERROR(f.body()->AcceptExpr(&emitter));
 
+  std::vector<Bytecode> bytecode = std::move(emitter.bytecode_);
+  if (options.optimize) {
+    XLS_ASSIGN_OR_RETURN(bytecode, OptimizeBytecode(std::move(bytecode)));
+  }
   return BytecodeFunction::Create(f.owner(), &f, type_info,
-                                  std::move(emitter.bytecode_));
+                                  std::move(bytecode));
 }
 
 /* static */ absl::StatusOr<std::unique_ptr<BytecodeFunction>>
@@ -201,8 +206,12 @@ BytecodeEmitter::EmitExpression(
 
   XLS_RETURN_IF_ERROR(expr->AcceptExpr(&emitter));
 
+  std::vector<Bytecode> bytecode = std::move(emitter.bytecode_);
+  if (options.optimize) {
+    XLS_ASSIGN_OR_RETURN(bytecode, OptimizeBytecode(std::move(bytecode)));
+  }
   return BytecodeFunction::Create(expr->owner(), /*source_fn=*/nullptr,
-                                  type_info, std::move(emitter.bytecode_));
+                                  type_info, std::move(bytecode));
 }
 
 absl::Status BytecodeEmitter::HandleArray(const Array* node) {
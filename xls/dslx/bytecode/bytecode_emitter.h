@@ -38,6 +38,9 @@ namespace xls::dslx {
 struct BytecodeEmitterOptions {
   // The format preference to use when one is not otherwise specified.
   FormatPreference format_preference;
+  // Whether to rewrite the emitted bytecode with OptimizeBytecode, which makes
+  // it faster to interpret but no longer a direct transcription of the AST.
+  bool optimize = false;
 };
 
 // Translates a DSLX expression tree into a linear sequence of bytecodes.
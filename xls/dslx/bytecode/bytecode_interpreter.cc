@@ -17,7 +17,6 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
-#include <functional>
 #include <ios>
 #include <memory>
 #include <optional>
@@ -26,6 +25,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
@@ -195,15 +195,15 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
            << " depth before: " << stack_.size();
   switch (bytecode.op()) {
     case Bytecode::Op::kUAdd: {
-      XLS_RETURN_IF_ERROR(EvalAdd(bytecode, /*is_signed=*/false));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kSAdd: {
-      XLS_RETURN_IF_ERROR(EvalAdd(bytecode, /*is_signed=*/true));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kAnd: {
-      XLS_RETURN_IF_ERROR(EvalAnd(bytecode));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kCall: {
@@ -219,7 +219,7 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       break;
     }
     case Bytecode::Op::kConcat: {
-      XLS_RETURN_IF_ERROR(EvalConcat(bytecode));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kCreateArray: {
@@ -235,7 +235,7 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       break;
     }
     case Bytecode::Op::kDiv: {
-      XLS_RETURN_IF_ERROR(EvalDiv(bytecode));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kDup: {
@@ -243,7 +243,7 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       break;
     }
     case Bytecode::Op::kEq: {
-      XLS_RETURN_IF_ERROR(EvalEq(bytecode));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kExpandTuple: {
@@ -255,11 +255,11 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       break;
     }
     case Bytecode::Op::kGe: {
-      XLS_RETURN_IF_ERROR(EvalGe(bytecode));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kGt: {
-      XLS_RETURN_IF_ERROR(EvalGt(bytecode));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kIndex: {
@@ -291,7 +291,7 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       break;
     }
     case Bytecode::Op::kLe: {
-      XLS_RETURN_IF_ERROR(EvalLe(bytecode));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kLoad: {
@@ -311,7 +311,7 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       break;
     }
     case Bytecode::Op::kLt: {
-      XLS_RETURN_IF_ERROR(EvalLt(bytecode));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kMatchArm: {
@@ -319,19 +319,19 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       break;
     }
     case Bytecode::Op::kSMul: {
-      XLS_RETURN_IF_ERROR(EvalMul(bytecode, /*is_signed=*/true));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kUMul: {
-      XLS_RETURN_IF_ERROR(EvalMul(bytecode, /*is_signed=*/false));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kMod: {
-      XLS_RETURN_IF_ERROR(EvalMod(bytecode));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kNe: {
-      XLS_RETURN_IF_ERROR(EvalNe(bytecode));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kNegate: {
@@ -339,7 +339,7 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       break;
     }
     case Bytecode::Op::kOr: {
-      XLS_RETURN_IF_ERROR(EvalOr(bytecode));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kPop: {
@@ -363,11 +363,11 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       break;
     }
     case Bytecode::Op::kShl: {
-      XLS_RETURN_IF_ERROR(EvalShl(bytecode));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kShr: {
-      XLS_RETURN_IF_ERROR(EvalShr(bytecode));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kSlice: {
@@ -384,11 +384,11 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       break;
     }
     case Bytecode::Op::kUSub: {
-      XLS_RETURN_IF_ERROR(EvalSub(bytecode, /*is_signed=*/false));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kSSub: {
-      XLS_RETURN_IF_ERROR(EvalSub(bytecode, /*is_signed=*/true));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
       break;
     }
     case Bytecode::Op::kSwap: {
@@ -404,7 +404,20 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       break;
     }
     case Bytecode::Op::kXor: {
-      XLS_RETURN_IF_ERROR(EvalXor(bytecode));
+      XLS_RETURN_IF_ERROR(EvalBinop(bytecode));
+      break;
+    }
+    case Bytecode::Op::kFusedBinop: {
+      XLS_RETURN_IF_ERROR(EvalFusedBinop(bytecode));
+      break;
+    }
+    case Bytecode::Op::kLiteralCompareJumpRelIf: {
+      XLS_ASSIGN_OR_RETURN(std::optional<int64_t> new_pc,
+                           EvalLiteralCompareJumpRelIf(frame->pc(), bytecode));
+      if (new_pc.has_value()) {
+        frame->set_pc(new_pc.value());
+        return absl::OkStatus();
+      }
       break;
     }
   }
@@ -412,45 +425,136 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
   return absl::OkStatus();
 }
 
-absl::Status BytecodeInterpreter::EvalBinop(
-    const std::function<absl::StatusOr<InterpValue>(
-        const InterpValue& lhs, const InterpValue& rhs)>& op) {
-  XLS_RET_CHECK_GE(stack_.size(), 2);
-  XLS_ASSIGN_OR_RETURN(InterpValue rhs, Pop());
-  XLS_ASSIGN_OR_RETURN(InterpValue lhs, Pop());
-  XLS_ASSIGN_OR_RETURN(InterpValue result, op(lhs, rhs));
-  stack_.Push(std::move(result));
-  return absl::OkStatus();
-}
-
-absl::Status BytecodeInterpreter::EvalAdd(const Bytecode& bytecode,
-                                          bool is_signed) {
-  return EvalBinop([&](const InterpValue& lhs,
-                       const InterpValue& rhs) -> absl::StatusOr<InterpValue> {
-    XLS_ASSIGN_OR_RETURN(InterpValue output, lhs.Add(rhs));
-
+absl::StatusOr<InterpValue> BytecodeInterpreter::ApplyBinop(
+    const Bytecode& bytecode, Bytecode::Op op, const InterpValue& lhs,
+    const InterpValue& rhs) {
+  // Arithmetic ops which may report rollover when the hook is enabled.
+  auto check_rollover = [&](absl::StatusOr<InterpValue> output, bool is_signed,
+                            absl::FunctionRef<BigInt(const BigInt&,
+                                                     const BigInt&)>
+                                big_op) -> absl::StatusOr<InterpValue> {
+    XLS_RETURN_IF_ERROR(output.status());
     // Slow path: when rollover warning hook is enabled.
     if (options_.rollover_hook() != nullptr) {
       auto make_big_int = [is_signed](const Bits& bits) {
         return is_signed ? BigInt::MakeSigned(bits)
                          : BigInt::MakeUnsigned(bits);
       };
-      bool rollover =
-          make_big_int(lhs.GetBitsOrDie()) + make_big_int(rhs.GetBitsOrDie()) !=
-          make_big_int(output.GetBitsOrDie());
+      bool rollover = big_op(make_big_int(lhs.GetBitsOrDie()),
+                             make_big_int(rhs.GetBitsOrDie())) !=
+                      make_big_int(output->GetBitsOrDie());
       if (rollover) {
         options_.rollover_hook()(bytecode.source_span());
       }
     }
-
     return output;
-  });
+  };
+  auto add = [](const BigInt& a, const BigInt& b) { return a + b; };
+  auto sub = [](const BigInt& a, const BigInt& b) { return a - b; };
+  auto mul = [](const BigInt& a, const BigInt& b) { return a * b; };
+
+  switch (op) {
+    case Bytecode::Op::kUAdd:
+      return check_rollover(lhs.Add(rhs), /*is_signed=*/false, add);
+    case Bytecode::Op::kSAdd:
+      return check_rollover(lhs.Add(rhs), /*is_signed=*/true, add);
+    case Bytecode::Op::kUSub:
+      return check_rollover(lhs.Sub(rhs), /*is_signed=*/false, sub);
+    case Bytecode::Op::kSSub:
+      return check_rollover(lhs.Sub(rhs), /*is_signed=*/true, sub);
+    case Bytecode::Op::kUMul:
+      return check_rollover(lhs.Mul(rhs), /*is_signed=*/false, mul);
+    case Bytecode::Op::kSMul:
+      return check_rollover(lhs.Mul(rhs), /*is_signed=*/true, mul);
+    case Bytecode::Op::kAnd:
+      return lhs.BitwiseAnd(rhs);
+    case Bytecode::Op::kConcat:
+      return lhs.Concat(rhs);
+    case Bytecode::Op::kDiv:
+      return lhs.FloorDiv(rhs);
+    case Bytecode::Op::kMod:
+      return lhs.FloorMod(rhs);
+    case Bytecode::Op::kEq:
+      return InterpValue::MakeBool(lhs.Eq(rhs));
+    case Bytecode::Op::kNe:
+      return InterpValue::MakeBool(lhs.Ne(rhs));
+    case Bytecode::Op::kGe:
+      return lhs.Ge(rhs);
+    case Bytecode::Op::kGt:
+      return lhs.Gt(rhs);
+    case Bytecode::Op::kLe:
+      return lhs.Le(rhs);
+    case Bytecode::Op::kLt:
+      return lhs.Lt(rhs);
+    case Bytecode::Op::kOr:
+      return lhs.BitwiseOr(rhs);
+    case Bytecode::Op::kShl:
+      return lhs.Shl(rhs);
+    case Bytecode::Op::kShr:
+      if (lhs.IsSigned()) {
+        return lhs.Shra(rhs);
+      }
+      return lhs.Shrl(rhs);
+    case Bytecode::Op::kXor:
+      return lhs.BitwiseXor(rhs);
+    default:
+      return absl::InternalError(
+          absl::StrCat("Not a binary operation: ", OpToString(op)));
+  }
+}
+
+absl::Status BytecodeInterpreter::EvalBinop(const Bytecode& bytecode) {
+  XLS_RET_CHECK_GE(stack_.size(), 2);
+  XLS_ASSIGN_OR_RETURN(InterpValue rhs, Pop());
+  XLS_ASSIGN_OR_RETURN(InterpValue lhs, Pop());
+  XLS_ASSIGN_OR_RETURN(InterpValue result,
+                       ApplyBinop(bytecode, bytecode.op(), lhs, rhs));
+  stack_.Push(std::move(result));
+  return absl::OkStatus();
+}
+
+absl::StatusOr<const InterpValue*> BytecodeInterpreter::ResolveFusedOperand(
+    const Bytecode::FusedOperand& operand) {
+  if (std::holds_alternative<InterpValue>(operand)) {
+    return &std::get<InterpValue>(operand);
+  }
+  int64_t slot = std::get<Bytecode::SlotIndex>(operand).value();
+  if (frames_.back().slots().size() <= slot) {
+    return absl::InternalError(absl::StrFormat(
+        "Attempted to access local data in slot %d, which is out of range.",
+        slot));
+  }
+  return &frames_.back().slots().at(slot);
+}
+
+absl::Status BytecodeInterpreter::EvalFusedBinop(const Bytecode& bytecode) {
+  XLS_ASSIGN_OR_RETURN(const Bytecode::FusedBinopData* data,
+                       bytecode.fused_binop_data());
+  // The operands are read in place rather than copied onto the stack.
+  XLS_ASSIGN_OR_RETURN(const InterpValue* lhs, ResolveFusedOperand(data->lhs));
+  XLS_ASSIGN_OR_RETURN(const InterpValue* rhs, ResolveFusedOperand(data->rhs));
+  XLS_ASSIGN_OR_RETURN(InterpValue result,
+                       ApplyBinop(bytecode, data->binop, *lhs, *rhs));
+  if (data->result.has_value()) {
+    frames_.back().StoreSlot(*data->result, std::move(result));
+  } else {
+    stack_.Push(std::move(result));
+  }
+  return absl::OkStatus();
 }
 
-absl::Status BytecodeInterpreter::EvalAnd(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.BitwiseAnd(rhs);
-  });
+absl::StatusOr<std::optional<int64_t>>
+BytecodeInterpreter::EvalLiteralCompareJumpRelIf(int64_t pc,
+                                                 const Bytecode& bytecode) {
+  XLS_ASSIGN_OR_RETURN(const Bytecode::CompareJumpData* data,
+                       bytecode.compare_jump_data());
+  XLS_ASSIGN_OR_RETURN(InterpValue lhs, Pop());
+  XLS_ASSIGN_OR_RETURN(InterpValue condition,
+                       ApplyBinop(bytecode, data->comparison, lhs, data->rhs));
+  if (condition.IsTrue()) {
+    return pc + data->target.value();
+  }
+  return std::nullopt;
 }
 
 absl::StatusOr<BytecodeFunction*> BytecodeInterpreter::GetBytecodeFn(
@@ -459,7 +563,9 @@ absl::StatusOr<BytecodeFunction*> BytecodeInterpreter::GetBytecodeFn(
   const Frame& frame = frames_.back();
   const TypeInfo* caller_type_info = frame.type_info();
 
-  BytecodeCacheInterface* cache = import_data_->bytecode_cache();
+  BytecodeCacheInterface* cache = options_.bytecode_cache() != nullptr
+                                      ? options_.bytecode_cache()
+                                      : import_data_->bytecode_cache();
   XLS_RET_CHECK(cache != nullptr);
 
   std::optional<ParametricEnv> callee_bindings;
@@ -560,7 +666,7 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
           "Array types can only be cast to bits.");
     }
     XLS_ASSIGN_OR_RETURN(InterpValue converted, from.Flatten());
-    stack_.Push(converted);
+    stack_.Push(std::move(converted));
     return absl::OkStatus();
   }
 
@@ -593,14 +699,14 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
           from_bit_count, to_bit_count));
     }
     XLS_ASSIGN_OR_RETURN(InterpValue casted, CastBitsToArray(from, *to_array));
-    stack_.Push(casted);
+    stack_.Push(std::move(casted));
     return absl::OkStatus();
   }
 
   // From bits to enum.
   if (EnumType* to_enum = dynamic_cast<EnumType*>(to); to_enum != nullptr) {
     XLS_ASSIGN_OR_RETURN(InterpValue converted, CastBitsToEnum(from, *to_enum));
-    stack_.Push(converted);
+    stack_.Push(std::move(converted));
     return absl::OkStatus();
   }
 
@@ -650,17 +756,11 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
   }
   InterpValue result = InterpValue::MakeBits(to_bits->is_signed(), result_bits);
 
-  stack_.Push(result);
+  stack_.Push(std::move(result));
 
   return absl::OkStatus();
 }
 
-absl::Status BytecodeInterpreter::EvalConcat(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Concat(rhs);
-  });
-}
-
 absl::Status BytecodeInterpreter::EvalCreateArray(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(Bytecode::NumElements array_size,
                        bytecode.num_elements());
@@ -670,12 +770,13 @@ absl::Status BytecodeInterpreter::EvalCreateArray(const Bytecode& bytecode) {
   elements.reserve(array_size.value());
   for (int64_t i = 0; i < array_size.value(); i++) {
     XLS_ASSIGN_OR_RETURN(InterpValue value, Pop());
-    elements.push_back(value);
+    elements.push_back(std::move(value));
   }
 
   std::reverse(elements.begin(), elements.end());
-  XLS_ASSIGN_OR_RETURN(InterpValue array, InterpValue::MakeArray(elements));
-  stack_.Push(array);
+  XLS_ASSIGN_OR_RETURN(InterpValue array,
+                       InterpValue::MakeArray(std::move(elements)));
+  stack_.Push(std::move(array));
   return absl::OkStatus();
 }
 
@@ -688,12 +789,12 @@ absl::Status BytecodeInterpreter::EvalCreateTuple(const Bytecode& bytecode) {
   elements.reserve(tuple_size.value());
   for (int64_t i = 0; i < tuple_size.value(); i++) {
     XLS_ASSIGN_OR_RETURN(InterpValue value, Pop());
-    elements.push_back(value);
+    elements.push_back(std::move(value));
   }
 
   std::reverse(elements.begin(), elements.end());
 
-  stack_.Push(InterpValue::MakeTuple(elements));
+  stack_.Push(InterpValue::MakeTuple(std::move(elements)));
   return absl::OkStatus();
 }
 
@@ -722,30 +823,12 @@ absl::Status BytecodeInterpreter::EvalDecode(const Bytecode& bytecode) {
   return absl::OkStatus();
 }
 
-absl::Status BytecodeInterpreter::EvalDiv(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.FloorDiv(rhs);
-  });
-}
-
-absl::Status BytecodeInterpreter::EvalMod(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.FloorMod(rhs);
-  });
-}
-
 absl::Status BytecodeInterpreter::EvalDup(const Bytecode& bytecode) {
   XLS_RET_CHECK(!stack_.empty());
   stack_.Push(stack_.PeekOrDie());
   return absl::OkStatus();
 }
 
-absl::Status BytecodeInterpreter::EvalEq(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return InterpValue::MakeBool(lhs.Eq(rhs));
-  });
-}
-
 absl::Status BytecodeInterpreter::EvalExpandTuple(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(InterpValue tuple, stack_.Pop());
   if (!tuple.IsTuple()) {
@@ -757,11 +840,9 @@ absl::Status BytecodeInterpreter::EvalExpandTuple(const Bytecode& bytecode) {
 
   // Note that we destructure the tuple in "reverse" order, with the first
   // element on top of the stack.
-  XLS_ASSIGN_OR_RETURN(int64_t tuple_size, tuple.GetLength());
-  for (int64_t i = tuple_size - 1; i >= 0; i--) {
-    XLS_ASSIGN_OR_RETURN(InterpValue element,
-                         tuple.Index(InterpValue::MakeUBits(64, i)));
-    stack_.Push(element);
+  const std::vector<InterpValue>& elements = tuple.GetValuesOrDie();
+  for (auto it = elements.rbegin(); it != elements.rend(); ++it) {
+    stack_.Push(*it);
   }
 
   return absl::OkStatus();
@@ -775,18 +856,6 @@ absl::Status BytecodeInterpreter::EvalFail(const Bytecode& bytecode) {
   return FailureErrorStatus(bytecode.source_span(), message);
 }
 
-absl::Status BytecodeInterpreter::EvalGe(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Ge(rhs);
-  });
-}
-
-absl::Status BytecodeInterpreter::EvalGt(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Gt(rhs);
-  });
-}
-
 absl::Status BytecodeInterpreter::EvalTupleIndex(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(InterpValue index, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue basis, Pop());
@@ -800,7 +869,7 @@ absl::Status BytecodeInterpreter::EvalTupleIndex(const Bytecode& bytecode) {
 
   XLS_ASSIGN_OR_RETURN(InterpValue result, basis.Index(index),
                        _ << " while processing " << bytecode.ToString());
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -817,26 +886,20 @@ absl::Status BytecodeInterpreter::EvalIndex(const Bytecode& bytecode) {
 
   XLS_ASSIGN_OR_RETURN(InterpValue result, basis.Index(index),
                        _ << " while processing " << bytecode.ToString());
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
 absl::Status BytecodeInterpreter::EvalInvert(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(InterpValue operand, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue result, operand.BitwiseNegate());
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
-absl::Status BytecodeInterpreter::EvalLe(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Le(rhs);
-  });
-}
-
 absl::Status BytecodeInterpreter::EvalLiteral(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(InterpValue value, bytecode.value_data());
-  stack_.Push(value);
+  stack_.Push(std::move(value));
   return absl::OkStatus();
 }
 
@@ -868,7 +931,7 @@ absl::Status BytecodeInterpreter::EvalLogicalAnd(const Bytecode& bytecode) {
   }
 
   XLS_ASSIGN_OR_RETURN(InterpValue result, lhs.BitwiseAnd(rhs));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -889,16 +952,10 @@ absl::Status BytecodeInterpreter::EvalLogicalOr(const Bytecode& bytecode) {
   }
 
   XLS_ASSIGN_OR_RETURN(InterpValue result, lhs.BitwiseOr(rhs));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
-absl::Status BytecodeInterpreter::EvalLt(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Lt(rhs);
-  });
-}
-
 absl::StatusOr<bool> BytecodeInterpreter::MatchArmEqualsInterpValue(
     Frame* frame, const Bytecode::MatchArmItem& item,
     const InterpValue& value) {
@@ -979,49 +1036,13 @@ absl::Status BytecodeInterpreter::EvalMatchArm(const Bytecode& bytecode) {
   return absl::OkStatus();
 }
 
-absl::Status BytecodeInterpreter::EvalMul(const Bytecode& bytecode,
-                                          bool is_signed) {
-  return EvalBinop([&](const InterpValue& lhs,
-                       const InterpValue& rhs) -> absl::StatusOr<InterpValue> {
-    XLS_ASSIGN_OR_RETURN(InterpValue output, lhs.Mul(rhs));
-
-    // Slow path: when rollover warning hook is enabled.
-    if (options_.rollover_hook() != nullptr) {
-      auto make_big_int = [is_signed](const Bits& bits) {
-        return is_signed ? BigInt::MakeSigned(bits)
-                         : BigInt::MakeUnsigned(bits);
-      };
-      bool rollover =
-          make_big_int(lhs.GetBitsOrDie()) * make_big_int(rhs.GetBitsOrDie()) !=
-          make_big_int(output.GetBitsOrDie());
-      if (rollover) {
-        options_.rollover_hook()(bytecode.source_span());
-      }
-    }
-
-    return output;
-  });
-}
-
-absl::Status BytecodeInterpreter::EvalNe(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return InterpValue::MakeBool(lhs.Ne(rhs));
-  });
-}
-
 absl::Status BytecodeInterpreter::EvalNegate(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(InterpValue operand, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue result, operand.ArithmeticNegate());
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
-absl::Status BytecodeInterpreter::EvalOr(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.BitwiseOr(rhs);
-  });
-}
-
 absl::Status BytecodeInterpreter::EvalPop(const Bytecode& bytecode) {
   return Pop().status();
 }
@@ -1123,25 +1144,10 @@ absl::Status BytecodeInterpreter::EvalSend(const Bytecode& bytecode) {
     }
     channel->push_back(payload);
   }
-  stack_.Push(token);
+  stack_.Push(std::move(token));
   return absl::OkStatus();
 }
 
-absl::Status BytecodeInterpreter::EvalShl(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Shl(rhs);
-  });
-}
-
-absl::Status BytecodeInterpreter::EvalShr(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    if (lhs.IsSigned()) {
-      return lhs.Shra(rhs);
-    }
-    return lhs.Shrl(rhs);
-  });
-}
-
 absl::Status BytecodeInterpreter::EvalSlice(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(InterpValue limit, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue start, Pop());
@@ -1192,7 +1198,7 @@ absl::Status BytecodeInterpreter::EvalSlice(const Bytecode& bytecode) {
   start = InterpValue::MakeBits(/*is_signed=*/false, start.GetBitsOrDie());
   length = InterpValue::MakeBits(/*is_signed=*/false, length.GetBitsOrDie());
   XLS_ASSIGN_OR_RETURN(InterpValue result, basis.Slice(start, length));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -1219,36 +1225,12 @@ absl::StatusOr<std::optional<int64_t>> BytecodeInterpreter::EvalJumpRelIf(
   return std::nullopt;
 }
 
-absl::Status BytecodeInterpreter::EvalSub(const Bytecode& bytecode,
-                                          bool is_signed) {
-  return EvalBinop([&](const InterpValue& lhs,
-                       const InterpValue& rhs) -> absl::StatusOr<InterpValue> {
-    XLS_ASSIGN_OR_RETURN(InterpValue output, lhs.Sub(rhs));
-
-    // Slow path: when rollover warning hook is enabled.
-    if (options_.rollover_hook() != nullptr) {
-      auto make_big_int = [is_signed](const Bits& bits) {
-        return is_signed ? BigInt::MakeSigned(bits)
-                         : BigInt::MakeUnsigned(bits);
-      };
-      bool rollover =
-          make_big_int(lhs.GetBitsOrDie()) - make_big_int(rhs.GetBitsOrDie()) !=
-          make_big_int(output.GetBitsOrDie());
-      if (rollover) {
-        options_.rollover_hook()(bytecode.source_span());
-      }
-    }
-
-    return output;
-  });
-}
-
 absl::Status BytecodeInterpreter::EvalSwap(const Bytecode& bytecode) {
   XLS_RET_CHECK_GE(stack_.size(), 2);
   XLS_ASSIGN_OR_RETURN(InterpValue tos0, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue tos1, Pop());
-  stack_.Push(tos0);
-  stack_.Push(tos1);
+  stack_.Push(std::move(tos0));
+  stack_.Push(std::move(tos1));
   return absl::OkStatus();
 }
 
@@ -1267,7 +1249,7 @@ absl::Status BytecodeInterpreter::EvalSwap(const Bytecode& bytecode) {
   for (size_t i = 0; i < argc; ++i) {
     XLS_RET_CHECK(!stack.empty());
     XLS_ASSIGN_OR_RETURN(InterpValue value, stack.Pop());
-    args.push_back(value);
+    args.push_back(std::move(value));
   }
 
   std::reverse(args.begin(), args.end());
@@ -1323,7 +1305,7 @@ absl::Status BytecodeInterpreter::EvalWidthSlice(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(InterpValue start, Pop());
   if (!start.FitsInUint64()) {
     XLS_RETURN_IF_ERROR(Pop().status());
-    stack_.Push(oob_value);
+    stack_.Push(std::move(oob_value));
     return absl::OkStatus();
   }
   XLS_ASSIGN_OR_RETURN(uint64_t start_index, start.GetBitValueUnsigned());
@@ -1334,7 +1316,7 @@ absl::Status BytecodeInterpreter::EvalWidthSlice(const Bytecode& bytecode) {
   InterpValue width = InterpValue::MakeUBits(64, width_value);
 
   if (start_index >= basis_width) {
-    stack_.Push(oob_value);
+    stack_.Push(std::move(oob_value));
     return absl::OkStatus();
   }
 
@@ -1347,16 +1329,10 @@ absl::Status BytecodeInterpreter::EvalWidthSlice(const Bytecode& bytecode) {
       bits_type->is_signed() ? InterpValueTag::kSBits : InterpValueTag::kUBits;
   XLS_ASSIGN_OR_RETURN(InterpValue result,
                        InterpValue::MakeBits(tag, result_bits));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
-absl::Status BytecodeInterpreter::EvalXor(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.BitwiseXor(rhs);
-  });
-}
-
 absl::Status BytecodeInterpreter::RunBuiltinFn(const Bytecode& bytecode,
                                                Builtin builtin) {
   switch (builtin) {
@@ -1599,8 +1575,9 @@ absl::Status ProcConfigBytecodeInterpreter::EvalSpawn(
       std::unique_ptr<BytecodeFunction> config_bf,
       BytecodeEmitter::Emit(
           import_data, type_info, proc->config(), callee_bindings,
-          BytecodeEmitterOptions{.format_preference =
-                                     options.format_preference()}));
+          BytecodeEmitterOptions{
+              .format_preference = options.format_preference(),
+              .optimize = true}));
 
   ProcConfigBytecodeInterpreter cbi(import_data, proc_instances, options);
   XLS_RETURN_IF_ERROR(cbi.InitFrame(config_bf.get(), config_args, type_info));
@@ -1646,8 +1623,9 @@ absl::Status ProcConfigBytecodeInterpreter::EvalSpawn(
       std::unique_ptr<BytecodeFunction> next_bf,
       BytecodeEmitter::EmitProcNext(
           import_data, type_info, proc->next(), callee_bindings, member_defs,
-          BytecodeEmitterOptions{.format_preference =
-                                     options.format_preference()}));
+          BytecodeEmitterOptions{
+              .format_preference = options.format_preference(),
+              .optimize = true}));
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeInterpreter> next_interpreter,
       CreateUnique(import_data, next_bf.get(), full_next_args, options));
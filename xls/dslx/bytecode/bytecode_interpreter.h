@@ -108,45 +108,28 @@ class BytecodeInterpreter {
   // when the PC is already pointing to the end of the bytecode.
   absl::Status EvalNextInstruction();
 
-  absl::Status EvalAdd(const Bytecode& bytecode, bool is_signed);
-  absl::Status EvalSub(const Bytecode& bytecode, bool is_signed);
-  absl::Status EvalMul(const Bytecode& bytecode, bool is_signed);
-
-  absl::Status EvalAnd(const Bytecode& bytecode);
   absl::Status EvalCall(const Bytecode& bytecode);
   absl::Status EvalCast(const Bytecode& bytecode, bool is_checked = false);
-  absl::Status EvalConcat(const Bytecode& bytecode);
   absl::Status EvalCreateArray(const Bytecode& bytecode);
   absl::Status EvalCreateTuple(const Bytecode& bytecode);
   absl::Status EvalDecode(const Bytecode& bytecode);
-  absl::Status EvalDiv(const Bytecode& bytecode);
   absl::Status EvalDup(const Bytecode& bytecode);
-  absl::Status EvalEq(const Bytecode& bytecode);
   absl::Status EvalExpandTuple(const Bytecode& bytecode);
   absl::Status EvalFail(const Bytecode& bytecode);
-  absl::Status EvalGe(const Bytecode& bytecode);
-  absl::Status EvalGt(const Bytecode& bytecode);
   absl::Status EvalIndex(const Bytecode& bytecode);
   absl::Status EvalTupleIndex(const Bytecode& bytecode);
   absl::Status EvalInvert(const Bytecode& bytecode);
-  absl::Status EvalLe(const Bytecode& bytecode);
   absl::Status EvalLiteral(const Bytecode& bytecode);
   absl::Status EvalLoad(const Bytecode& bytecode);
   absl::Status EvalLogicalAnd(const Bytecode& bytecode);
   absl::Status EvalLogicalOr(const Bytecode& bytecode);
-  absl::Status EvalLt(const Bytecode& bytecode);
   absl::Status EvalMatchArm(const Bytecode& bytecode);
-  absl::Status EvalMod(const Bytecode& bytecode);
-  absl::Status EvalNe(const Bytecode& bytecode);
   absl::Status EvalNegate(const Bytecode& bytecode);
-  absl::Status EvalOr(const Bytecode& bytecode);
   absl::Status EvalPop(const Bytecode& bytecode);
   absl::Status EvalRange(const Bytecode& bytecode);
   absl::Status EvalRecv(const Bytecode& bytecode);
   absl::Status EvalRecvNonBlocking(const Bytecode& bytecode);
   absl::Status EvalSend(const Bytecode& bytecode);
-  absl::Status EvalShl(const Bytecode& bytecode);
-  absl::Status EvalShr(const Bytecode& bytecode);
   absl::Status EvalSlice(const Bytecode& bytecode);
   // TODO(rspringer): 2022-04-12: Rather than use inheritance here, consider
   // injecting a Proc/Spawn strategy function/lambda into the interpreter.
@@ -160,11 +143,25 @@ class BytecodeInterpreter {
   absl::Status EvalSwap(const Bytecode& bytecode);
   absl::Status EvalTrace(const Bytecode& bytecode);
   absl::Status EvalWidthSlice(const Bytecode& bytecode);
-  absl::Status EvalXor(const Bytecode& bytecode);
 
-  absl::Status EvalBinop(
-      const std::function<absl::StatusOr<InterpValue>(
-          const InterpValue& lhs, const InterpValue& rhs)>& op);
+  // Pops the two operands of the binary operation `bytecode` off the stack and
+  // pushes the result.
+  absl::Status EvalBinop(const Bytecode& bytecode);
+  // Superinstructions formed by OptimizeBytecode.
+  absl::Status EvalFusedBinop(const Bytecode& bytecode);
+  absl::StatusOr<std::optional<int64_t>> EvalLiteralCompareJumpRelIf(
+      int64_t pc, const Bytecode& bytecode);
+
+  // Returns the result of the binary operation `op` (one of the ops for which
+  // OpIsBinop holds) applied to `lhs` and `rhs`. `bytecode` is the
+  // instruction being evaluated and is used for rollover reporting.
+  absl::StatusOr<InterpValue> ApplyBinop(const Bytecode& bytecode,
+                                         Bytecode::Op op,
+                                         const InterpValue& lhs,
+                                         const InterpValue& rhs);
+  // Returns the value of a kFusedBinop operand without copying it.
+  absl::StatusOr<const InterpValue*> ResolveFusedOperand(
+      const Bytecode::FusedOperand& operand);
 
   absl::StatusOr<BytecodeFunction*> GetBytecodeFn(
       Function& function, const Invocation* invocation,
@@ -0,0 +1,119 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string_view>
+
+#include "include/benchmark/benchmark.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/bytecode/bytecode_emitter.h"
+#include "xls/dslx/bytecode/bytecode_interpreter.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/type_system/parametric_env.h"
+
+namespace {
+
+// Number of calls to the global operator new, which is replaced below so the
+// benchmarks can report allocations per interpretation.
+std::atomic<int64_t> allocation_count = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  void* p = std::malloc(size);
+  if (p == nullptr) {
+    std::abort();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace xls::dslx {
+namespace {
+
+// A loop dominated by scalar arithmetic on locals, as in typical DSLX test
+// bodies and stdlib helpers.
+constexpr std::string_view kScalarProgram = R"(
+fn main(x: u32) -> u32 {
+  for (i, acc): (u32, u32) in range(u32:0, u32:1024) {
+    let t = acc + i;
+    let u = t ^ x;
+    if (u & u32:1) == u32:0 { u >> u32:1 } else { u + i * u32:3 }
+  }(u32:0)
+}
+)";
+
+// A loop carrying a tuple holding an array, which is loaded, indexed, updated
+// and rebuilt every iteration.
+constexpr std::string_view kAggregateProgram = R"(
+fn main(x: u32) -> u32 {
+  let (sum, arr) = for (i, (sum, arr)): (u32, (u32, u32[8])) in
+      range(u32:0, u32:256) {
+    let idx = i & u32:7;
+    let v = arr[idx] + x;
+    (sum + v, update(arr, idx, v))
+  }((u32:0, u32[8]:[u32:0, ...]));
+  sum + arr[0]
+}
+)";
+
+// Interprets `main` of `program` with optimized bytecode if `optimize`, and
+// reports the number of allocations made per interpretation.
+void InterpretMain(benchmark::State& state, std::string_view program,
+                   bool optimize) {
+  ImportData import_data(CreateImportDataForTest());
+  TypecheckedModule tm =
+      ParseAndTypecheck(program, "test.x", "test", &import_data).value();
+  Function* f = tm.module->GetMemberOrError<Function>("main").value();
+  std::unique_ptr<BytecodeFunction> bf =
+      BytecodeEmitter::Emit(&import_data, tm.type_info, *f, ParametricEnv(),
+                            BytecodeEmitterOptions{.optimize = optimize})
+          .value();
+  const int64_t allocations_before = allocation_count.load();
+  for (auto _ : state) {
+    InterpValue result = BytecodeInterpreter::Interpret(
+                             &import_data, bf.get(), {InterpValue::MakeU32(7)})
+                             .value();
+    benchmark::DoNotOptimize(result);
+  }
+  state.counters["allocations"] = benchmark::Counter(
+      static_cast<double>(allocation_count.load() - allocations_before),
+      benchmark::Counter::kAvgIterations);
+}
+
+// Argument is whether the bytecode is optimized.
+static void BM_InterpretLoop(benchmark::State& state) {
+  InterpretMain(state, kScalarProgram, state.range(0) != 0);
+}
+
+static void BM_InterpretAggregateLoop(benchmark::State& state) {
+  InterpretMain(state, kAggregateProgram, state.range(0) != 0);
+}
+
+BENCHMARK(BM_InterpretLoop)->Arg(0)->Arg(1);
+BENCHMARK(BM_InterpretAggregateLoop)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace xls::dslx
@@ -0,0 +1,189 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/bytecode/bytecode_optimizer.h"
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/interp_value.h"
+
+namespace xls::dslx {
+namespace {
+
+bool IsJump(Bytecode::Op op) {
+  return op == Bytecode::Op::kJumpRel || op == Bytecode::Op::kJumpRelIf;
+}
+
+// Returns the value pushed by `bytecode` as an operand of a kFusedBinop if it
+// is a load or a literal.
+std::optional<Bytecode::FusedOperand> GetFusedOperand(
+    const Bytecode& bytecode) {
+  if (!bytecode.has_data()) {
+    return std::nullopt;
+  }
+  const Bytecode::Data& data = bytecode.data().value();
+  if (bytecode.op() == Bytecode::Op::kLoad &&
+      std::holds_alternative<Bytecode::SlotIndex>(data)) {
+    return std::get<Bytecode::SlotIndex>(data);
+  }
+  if (bytecode.op() == Bytecode::Op::kLiteral &&
+      std::holds_alternative<InterpValue>(data)) {
+    return std::get<InterpValue>(data);
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<Bytecode>> OptimizeBytecode(
+    std::vector<Bytecode> bytecodes) {
+  const int64_t size = bytecodes.size();
+
+  // PCs that jumps land on: these may only start (and never be in the middle
+  // of) a superinstruction, and may not be removed.
+  absl::flat_hash_set<int64_t> jump_dests;
+  for (int64_t pc = 0; pc < size; ++pc) {
+    if (IsJump(bytecodes[pc].op())) {
+      XLS_ASSIGN_OR_RETURN(Bytecode::JumpTarget target,
+                           bytecodes[pc].jump_target());
+      jump_dests.insert(pc + target.value());
+    }
+  }
+  // Returns whether the `count` instructions starting at `pc` may be replaced
+  // by one.
+  auto can_fuse = [&](int64_t pc, int64_t count) {
+    if (pc + count > size) {
+      return false;
+    }
+    for (int64_t i = pc + 1; i < pc + count; ++i) {
+      if (jump_dests.contains(i)) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  std::vector<Bytecode> result;
+  result.reserve(size);
+  // Maps each original PC to the PC of the instruction it became (part of), or
+  // of the next instruction if it was removed. Has an extra entry for the end
+  // of the function.
+  std::vector<int64_t> new_pc(size + 1);
+  // Maps the PC of each jump in `result` to the original PC it jumps to.
+  absl::flat_hash_map<int64_t, int64_t> jump_to_original_dest;
+  int64_t pc = 0;
+  while (pc < size) {
+    const Bytecode& bytecode = bytecodes[pc];
+
+    // load|literal, load|literal, <binop>[, store]
+    if (can_fuse(pc, 3) && OpIsBinop(bytecodes[pc + 2].op())) {
+      std::optional<Bytecode::FusedOperand> lhs = GetFusedOperand(bytecode);
+      std::optional<Bytecode::FusedOperand> rhs =
+          GetFusedOperand(bytecodes[pc + 1]);
+      if (lhs.has_value() && rhs.has_value()) {
+        const Bytecode& binop = bytecodes[pc + 2];
+        int64_t count = 3;
+        std::optional<Bytecode::SlotIndex> result_slot;
+        if (can_fuse(pc, 4) &&
+            bytecodes[pc + 3].op() == Bytecode::Op::kStore) {
+          XLS_ASSIGN_OR_RETURN(result_slot, bytecodes[pc + 3].slot_index());
+          count = 4;
+        }
+        for (int64_t i = pc; i < pc + count; ++i) {
+          new_pc[i] = result.size();
+        }
+        result.push_back(Bytecode(
+            binop.source_span(), Bytecode::Op::kFusedBinop,
+            Bytecode::FusedBinopData{.binop = binop.op(),
+                                     .lhs = *std::move(lhs),
+                                     .rhs = *std::move(rhs),
+                                     .result = result_slot}));
+        pc += count;
+        continue;
+      }
+    }
+
+    // literal, <comparison>, jump_rel_if
+    if (can_fuse(pc, 3) && bytecode.op() == Bytecode::Op::kLiteral &&
+        OpIsComparison(bytecodes[pc + 1].op()) &&
+        bytecodes[pc + 2].op() == Bytecode::Op::kJumpRelIf) {
+      XLS_ASSIGN_OR_RETURN(InterpValue rhs, bytecode.value_data());
+      XLS_ASSIGN_OR_RETURN(Bytecode::JumpTarget target,
+                           bytecodes[pc + 2].jump_target());
+      for (int64_t i = pc; i < pc + 3; ++i) {
+        new_pc[i] = result.size();
+      }
+      jump_to_original_dest[result.size()] = pc + 2 + target.value();
+      result.push_back(Bytecode(
+          bytecodes[pc + 1].source_span(),
+          Bytecode::Op::kLiteralCompareJumpRelIf,
+          Bytecode::CompareJumpData{.comparison = bytecodes[pc + 1].op(),
+                                    .rhs = std::move(rhs),
+                                    .target = target}));
+      pc += 3;
+      continue;
+    }
+
+    // dup|load|literal, pop
+    if (can_fuse(pc, 2) && !jump_dests.contains(pc) &&
+        bytecodes[pc + 1].op() == Bytecode::Op::kPop &&
+        (bytecode.op() == Bytecode::Op::kDup ||
+         GetFusedOperand(bytecode).has_value())) {
+      new_pc[pc] = result.size();
+      new_pc[pc + 1] = result.size();
+      pc += 2;
+      continue;
+    }
+
+    new_pc[pc] = result.size();
+    if (IsJump(bytecode.op())) {
+      XLS_ASSIGN_OR_RETURN(Bytecode::JumpTarget target, bytecode.jump_target());
+      jump_to_original_dest[result.size()] = pc + target.value();
+    }
+    result.push_back(std::move(bytecodes[pc]));
+    ++pc;
+  }
+  new_pc[size] = result.size();
+
+  // Retarget the jumps now that the new position of every instruction is
+  // known.
+  for (const auto& [jump_pc, original_dest] : jump_to_original_dest) {
+    XLS_RET_CHECK(original_dest >= 0 && original_dest <= size)
+        << "Jump at PC " << jump_pc << " lands outside the function.";
+    Bytecode::JumpTarget target(new_pc[original_dest] - jump_pc);
+    Bytecode& jump = result[jump_pc];
+    if (jump.op() == Bytecode::Op::kLiteralCompareJumpRelIf) {
+      XLS_ASSIGN_OR_RETURN(const Bytecode::CompareJumpData* data,
+                           jump.compare_jump_data());
+      Bytecode::CompareJumpData retargeted = *data;
+      retargeted.target = target;
+      jump = Bytecode(jump.source_span(), jump.op(), std::move(retargeted));
+    } else {
+      jump = Bytecode(jump.source_span(), jump.op(), target);
+    }
+  }
+  return result;
+}
+
+}  // namespace xls::dslx
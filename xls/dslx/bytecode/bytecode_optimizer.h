@@ -0,0 +1,45 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_BYTECODE_BYTECODE_OPTIMIZER_H_
+#define XLS_DSLX_BYTECODE_BYTECODE_OPTIMIZER_H_
+
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "xls/dslx/bytecode/bytecode.h"
+
+namespace xls::dslx {
+
+// Rewrites the bytecode of a function as emitted by BytecodeEmitter to make it
+// cheaper to interpret:
+//
+//  * `load|literal, load|literal, <binop>[, store]` sequences are fused into a
+//    single kFusedBinop which reads its operands directly from the frame's
+//    slots (or its data member) and can store its result directly into a slot,
+//    avoiding copying the operands onto the stack and back.
+//  * `literal, <comparison>, jump_rel_if` sequences are fused into a single
+//    kLiteralCompareJumpRelIf.
+//  * Values that are pushed only to be popped right away (`dup, pop`,
+//    `load, pop` and `literal, pop`) are not pushed at all.
+//
+// Instructions which are jump targets are never fused into the middle of a
+// superinstruction, and relative jump amounts are updated for the new
+// positions of their destinations.
+absl::StatusOr<std::vector<Bytecode>> OptimizeBytecode(
+    std::vector<Bytecode> bytecodes);
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_BYTECODE_BYTECODE_OPTIMIZER_H_
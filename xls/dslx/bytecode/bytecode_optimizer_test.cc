@@ -0,0 +1,197 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/bytecode/bytecode_optimizer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/bytecode/bytecode_emitter.h"
+#include "xls/dslx/bytecode/bytecode_interpreter.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/pos.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/type_system/parametric_env.h"
+
+namespace xls::dslx {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+const Span kSpan = Span::Fake();
+
+Bytecode::SlotIndex Slot(int64_t index) { return Bytecode::SlotIndex(index); }
+
+Bytecode::JumpTarget Target(int64_t amount) {
+  return Bytecode::JumpTarget(amount);
+}
+
+TEST(BytecodeOptimizerTest, FusesLoadLoadBinopStore) {
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(Bytecode::MakeLoad(kSpan, Slot(0)));
+  bytecodes.push_back(
+      Bytecode::MakeLiteral(kSpan, InterpValue::MakeU32(1)));
+  bytecodes.push_back(Bytecode(kSpan, Bytecode::Op::kUAdd));
+  bytecodes.push_back(Bytecode::MakeStore(kSpan, Slot(1)));
+  bytecodes.push_back(Bytecode::MakeLoad(kSpan, Slot(0)));
+  bytecodes.push_back(Bytecode::MakeLoad(kSpan, Slot(1)));
+  bytecodes.push_back(Bytecode(kSpan, Bytecode::Op::kLt));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bytecode> optimized,
+                           OptimizeBytecode(std::move(bytecodes)));
+  EXPECT_EQ(BytecodesToString(optimized, /*source_locs=*/false),
+            R"(000 fused_binop uadd slot:0 u32:1 -> slot:1
+001 fused_binop lt slot:0 slot:1)");
+}
+
+TEST(BytecodeOptimizerTest, RetargetsLoopJumps) {
+  // The shape of the bytecode emitted for a counted loop: jump_rel_if exits
+  // to the jump_dest at 012 and jump_rel goes back to the one at 002.
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(
+      Bytecode::MakeLiteral(kSpan, InterpValue::MakeU32(0)));
+  bytecodes.push_back(Bytecode::MakeStore(kSpan, Slot(0)));
+  bytecodes.push_back(Bytecode::MakeJumpDest(kSpan));
+  bytecodes.push_back(Bytecode::MakeLoad(kSpan, Slot(0)));
+  bytecodes.push_back(
+      Bytecode::MakeLiteral(kSpan, InterpValue::MakeU32(4)));
+  bytecodes.push_back(Bytecode(kSpan, Bytecode::Op::kEq));
+  bytecodes.push_back(Bytecode::MakeJumpRelIf(kSpan, Target(6)));
+  bytecodes.push_back(Bytecode::MakeLoad(kSpan, Slot(0)));
+  bytecodes.push_back(
+      Bytecode::MakeLiteral(kSpan, InterpValue::MakeU32(1)));
+  bytecodes.push_back(Bytecode(kSpan, Bytecode::Op::kUAdd));
+  bytecodes.push_back(Bytecode::MakeStore(kSpan, Slot(0)));
+  bytecodes.push_back(Bytecode::MakeJumpRel(kSpan, Target(-9)));
+  bytecodes.push_back(Bytecode::MakeJumpDest(kSpan));
+  bytecodes.push_back(Bytecode::MakeLoad(kSpan, Slot(0)));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bytecode> optimized,
+                           OptimizeBytecode(std::move(bytecodes)));
+  EXPECT_EQ(BytecodesToString(optimized, /*source_locs=*/false),
+            R"(000 literal u32:0
+001 store 0
+002 jump_dest
+003 fused_binop eq slot:0 u32:4
+004 jump_rel_if 3
+005 fused_binop uadd slot:0 u32:1 -> slot:0
+006 jump_rel -4
+007 jump_dest
+008 load 0)");
+}
+
+TEST(BytecodeOptimizerTest, FusesLiteralCompareJump) {
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(Bytecode::MakeLoad(kSpan, Slot(0)));
+  bytecodes.push_back(Bytecode::MakeLoad(kSpan, Slot(1)));
+  bytecodes.push_back(Bytecode(kSpan, Bytecode::Op::kUAdd));
+  bytecodes.push_back(
+      Bytecode::MakeLiteral(kSpan, InterpValue::MakeU32(3)));
+  bytecodes.push_back(Bytecode(kSpan, Bytecode::Op::kEq));
+  bytecodes.push_back(Bytecode::MakeJumpRelIf(kSpan, Target(3)));
+  bytecodes.push_back(
+      Bytecode::MakeLiteral(kSpan, InterpValue::MakeU32(0)));
+  bytecodes.push_back(Bytecode::MakeJumpRel(kSpan, Target(3)));
+  bytecodes.push_back(Bytecode::MakeJumpDest(kSpan));
+  bytecodes.push_back(
+      Bytecode::MakeLiteral(kSpan, InterpValue::MakeU32(1)));
+  bytecodes.push_back(Bytecode::MakeJumpDest(kSpan));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bytecode> optimized,
+                           OptimizeBytecode(std::move(bytecodes)));
+  EXPECT_EQ(BytecodesToString(optimized, /*source_locs=*/false),
+            R"(000 fused_binop uadd slot:0 slot:1
+001 literal_compare_jump_rel_if eq u32:3 3
+002 literal u32:0
+003 jump_rel 3
+004 jump_dest
+005 literal u32:1
+006 jump_dest)");
+}
+
+TEST(BytecodeOptimizerTest, RemovesPushPopPairs) {
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(Bytecode::MakeLoad(kSpan, Slot(0)));
+  bytecodes.push_back(Bytecode::MakeDup(kSpan));
+  bytecodes.push_back(Bytecode::MakePop(kSpan));
+  bytecodes.push_back(
+      Bytecode::MakeLiteral(kSpan, InterpValue::MakeU32(1)));
+  bytecodes.push_back(Bytecode::MakePop(kSpan));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bytecode> optimized,
+                           OptimizeBytecode(std::move(bytecodes)));
+  EXPECT_EQ(BytecodesToString(optimized, /*source_locs=*/false), "000 load 0");
+}
+
+TEST(BytecodeOptimizerTest, DoesNotFuseAcrossJumpDestinations) {
+  // The jump lands on the second load, so it can't become part of a fused
+  // instruction beginning at the first, nor be removed along with the pop.
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(Bytecode::MakeJumpRel(kSpan, Target(2)));
+  bytecodes.push_back(Bytecode::MakeLoad(kSpan, Slot(0)));
+  bytecodes.push_back(Bytecode::MakeLoad(kSpan, Slot(1)));
+  bytecodes.push_back(Bytecode::MakePop(kSpan));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bytecode> optimized,
+                           OptimizeBytecode(std::move(bytecodes)));
+  EXPECT_EQ(BytecodesToString(optimized, /*source_locs=*/false),
+            R"(000 jump_rel 2
+001 load 0
+002 load 1
+003 pop)");
+}
+
+TEST(BytecodeOptimizerTest, OptimizedFunctionComputesSameResult) {
+  constexpr std::string_view kProgram = R"(
+fn main(x: u32) -> u32 {
+  let y = for (i, acc): (u32, u32) in range(u32:0, u32:16) {
+    if acc + i == u32:10 { acc } else { acc + x * i }
+  }(u32:0);
+  let z = y >> u32:1;
+  if z < u32:100 { z } else { y - z }
+}
+)";
+  ImportData import_data(CreateImportDataForTest());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kProgram, "test.x", "test", &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           tm.module->GetMemberOrError<Function>("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BytecodeFunction> plain,
+      BytecodeEmitter::Emit(&import_data, tm.type_info, *f, ParametricEnv()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BytecodeFunction> optimized,
+      BytecodeEmitter::Emit(&import_data, tm.type_info, *f, ParametricEnv(),
+                            BytecodeEmitterOptions{.optimize = true}));
+  EXPECT_LT(optimized->bytecodes().size(), plain->bytecodes().size());
+
+  for (uint32_t x : {0, 1, 2, 3, 7, 100, 1000000}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        InterpValue expected,
+        BytecodeInterpreter::Interpret(&import_data, plain.get(),
+                                       {InterpValue::MakeU32(x)}));
+    EXPECT_THAT(BytecodeInterpreter::Interpret(&import_data, optimized.get(),
+                                               {InterpValue::MakeU32(x)}),
+                IsOkAndHolds(expected))
+        << "x = " << x;
+  }
+}
+
+}  // namespace
+}  // namespace xls::dslx
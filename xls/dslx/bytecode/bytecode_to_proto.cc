@@ -0,0 +1,497 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/bytecode/bytecode_to_proto.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/bytecode/bytecode.pb.h"
+#include "xls/dslx/dslx_builtins.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/ast_node.h"
+#include "xls/dslx/frontend/module.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/dslx/type_system/parametric_env.h"
+#include "xls/dslx/type_system/type.h"
+#include "xls/dslx/type_system/type_info.pb.h"
+#include "xls/dslx/type_system/type_info_to_proto.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/format_strings.h"
+
+namespace xls::dslx {
+namespace {
+
+class BytecodeWriter {
+ public:
+  explicit BytecodeWriter(const ParsedNodeCountFn& parsed_node_count)
+      : parsed_node_count_(parsed_node_count) {}
+
+  absl::StatusOr<BytecodesProto> Run(absl::Span<const Bytecode> bytecodes) {
+    BytecodesProto proto;
+    for (const Bytecode& bytecode : bytecodes) {
+      XLS_ASSIGN_OR_RETURN(*proto.add_bytecodes(), ToProto(bytecode));
+    }
+    return proto;
+  }
+
+ private:
+  struct NodeIndices {
+    int64_t limit;
+    absl::flat_hash_map<const AstNode*, int64_t> indices;
+  };
+
+  absl::StatusOr<BytecodeAstNodeRefProto> ToRef(const AstNode* node) {
+    const Module* module = node->owner();
+    auto it = node_indices_.find(module);
+    if (it == node_indices_.end()) {
+      std::optional<int64_t> limit = parsed_node_count_(module);
+      if (!limit.has_value()) {
+        return absl::UnimplementedError(absl::StrFormat(
+            "BytecodesToProto: AST nodes of module `%s` cannot be referred to",
+            module->name()));
+      }
+      NodeIndices indices{.limit = *limit};
+      absl::Span<AstNode* const> nodes = module->nodes();
+      for (int64_t i = 0; i < nodes.size(); ++i) {
+        indices.indices[nodes[i]] = i;
+      }
+      it = node_indices_.emplace(module, std::move(indices)).first;
+    }
+    auto index_it = it->second.indices.find(node);
+    if (index_it == it->second.indices.end() ||
+        index_it->second >= it->second.limit) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "BytecodesToProto: AST node `%s` was not created by parsing module "
+          "`%s`",
+          node->ToString(), module->name()));
+    }
+    BytecodeAstNodeRefProto ref;
+    ref.set_module(module->name());
+    ref.set_index(index_it->second);
+    return ref;
+  }
+
+  absl::StatusOr<ParametricEnvProto> EnvToProto(const ParametricEnv& env) {
+    ParametricEnvProto proto;
+    for (const ParametricEnvItem& item : env.bindings()) {
+      ParametricEnvItemProto* item_proto = proto.add_items();
+      item_proto->set_identifier(item.identifier);
+      XLS_ASSIGN_OR_RETURN(*item_proto->mutable_value(),
+                           InterpValueToProto(item.value));
+    }
+    return proto;
+  }
+
+  absl::StatusOr<BytecodeValueProto> ValueToProto(const InterpValue& value) {
+    BytecodeValueProto proto;
+    if (!value.IsFunction()) {
+      XLS_ASSIGN_OR_RETURN(*proto.mutable_value(), InterpValueToProto(value));
+      return proto;
+    }
+    XLS_ASSIGN_OR_RETURN(const InterpValue::FnData* fn_data,
+                         value.GetFunction());
+    if (std::holds_alternative<Builtin>(*fn_data)) {
+      proto.set_builtin(BuiltinToString(std::get<Builtin>(*fn_data)));
+      return proto;
+    }
+    const auto& user_fn_data = std::get<InterpValue::UserFnData>(*fn_data);
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_user_function(),
+                         ToRef(user_fn_data.function));
+    return proto;
+  }
+
+  absl::StatusOr<MatchArmItemProto> ToProto(
+      const Bytecode::MatchArmItem& item) {
+    MatchArmItemProto proto;
+    switch (item.kind()) {
+      case Bytecode::MatchArmItem::Kind::kInterpValue: {
+        XLS_ASSIGN_OR_RETURN(InterpValue value, item.interp_value());
+        XLS_ASSIGN_OR_RETURN(*proto.mutable_value(), ValueToProto(value));
+        break;
+      }
+      case Bytecode::MatchArmItem::Kind::kLoad: {
+        XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex slot, item.slot_index());
+        proto.set_load(slot.value());
+        break;
+      }
+      case Bytecode::MatchArmItem::Kind::kStore: {
+        XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex slot, item.slot_index());
+        proto.set_store(slot.value());
+        break;
+      }
+      case Bytecode::MatchArmItem::Kind::kRange: {
+        XLS_ASSIGN_OR_RETURN(Bytecode::MatchArmItem::RangeData range,
+                             item.range());
+        XLS_ASSIGN_OR_RETURN(*proto.mutable_range()->mutable_start(),
+                             InterpValueToProto(range.start));
+        XLS_ASSIGN_OR_RETURN(*proto.mutable_range()->mutable_limit(),
+                             InterpValueToProto(range.limit));
+        break;
+      }
+      case Bytecode::MatchArmItem::Kind::kTuple: {
+        XLS_ASSIGN_OR_RETURN(std::vector<Bytecode::MatchArmItem> elements,
+                             item.tuple_elements());
+        MatchArmItemProto::Tuple* tuple = proto.mutable_tuple();
+        for (const Bytecode::MatchArmItem& element : elements) {
+          XLS_ASSIGN_OR_RETURN(*tuple->add_elements(), ToProto(element));
+        }
+        break;
+      }
+      case Bytecode::MatchArmItem::Kind::kWildcard:
+        proto.set_wildcard(true);
+        break;
+    }
+    return proto;
+  }
+
+  absl::StatusOr<FusedOperandProto> ToProto(
+      const Bytecode::FusedOperand& operand) {
+    FusedOperandProto proto;
+    if (std::holds_alternative<Bytecode::SlotIndex>(operand)) {
+      proto.set_slot(std::get<Bytecode::SlotIndex>(operand).value());
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          *proto.mutable_value(),
+          InterpValueToProto(std::get<InterpValue>(operand)));
+    }
+    return proto;
+  }
+
+  absl::StatusOr<BytecodeProto> ToProto(const Bytecode& bytecode) {
+    BytecodeProto proto;
+    *proto.mutable_span() = SpanToProto(bytecode.source_span());
+    proto.set_op(static_cast<int32_t>(bytecode.op()));
+    if (!bytecode.has_data()) {
+      return proto;
+    }
+    const Bytecode::Data& data = *bytecode.data();
+    if (const auto* value = std::get_if<InterpValue>(&data)) {
+      XLS_ASSIGN_OR_RETURN(*proto.mutable_value(), ValueToProto(*value));
+    } else if (const auto* target = std::get_if<Bytecode::JumpTarget>(&data)) {
+      proto.set_jump_target(target->value());
+    } else if (const auto* num_elements =
+                   std::get_if<Bytecode::NumElements>(&data)) {
+      proto.set_num_elements(num_elements->value());
+    } else if (const auto* slot = std::get_if<Bytecode::SlotIndex>(&data)) {
+      proto.set_slot_index(slot->value());
+    } else if (const auto* type = std::get_if<std::unique_ptr<Type>>(&data)) {
+      XLS_ASSIGN_OR_RETURN(*proto.mutable_type(), TypeToProto(**type));
+    } else if (const auto* invocation =
+                   std::get_if<Bytecode::InvocationData>(&data)) {
+      BytecodeInvocationProto* invocation_proto = proto.mutable_invocation();
+      XLS_ASSIGN_OR_RETURN(*invocation_proto->mutable_invocation(),
+                           ToRef(invocation->invocation()));
+      if (invocation->caller_bindings().has_value()) {
+        XLS_ASSIGN_OR_RETURN(*invocation_proto->mutable_caller_bindings(),
+                             EnvToProto(*invocation->caller_bindings()));
+      }
+      if (invocation->callee_bindings().has_value()) {
+        XLS_ASSIGN_OR_RETURN(*invocation_proto->mutable_callee_bindings(),
+                             EnvToProto(*invocation->callee_bindings()));
+      }
+    } else if (const auto* item =
+                   std::get_if<Bytecode::MatchArmItem>(&data)) {
+      XLS_ASSIGN_OR_RETURN(*proto.mutable_match_arm_item(), ToProto(*item));
+    } else if (const auto* trace = std::get_if<Bytecode::TraceData>(&data)) {
+      if (!trace->value_fmt_descs().empty()) {
+        return absl::UnimplementedError(
+            "BytecodesToProto: cannot convert trace of formatted values");
+      }
+      TraceDataProto* trace_proto = proto.mutable_trace();
+      for (const FormatStep& step : trace->steps()) {
+        FormatStepProto* step_proto = trace_proto->add_steps();
+        if (std::holds_alternative<std::string>(step)) {
+          step_proto->set_text(std::get<std::string>(step));
+        } else {
+          step_proto->set_preference(std::string(
+              FormatPreferenceToString(std::get<FormatPreference>(step))));
+        }
+      }
+    } else if (const auto* fused =
+                   std::get_if<Bytecode::FusedBinopData>(&data)) {
+      FusedBinopProto* fused_proto = proto.mutable_fused_binop();
+      fused_proto->set_binop(static_cast<int32_t>(fused->binop));
+      XLS_ASSIGN_OR_RETURN(*fused_proto->mutable_lhs(), ToProto(fused->lhs));
+      XLS_ASSIGN_OR_RETURN(*fused_proto->mutable_rhs(), ToProto(fused->rhs));
+      if (fused->result.has_value()) {
+        fused_proto->set_result(fused->result->value());
+      }
+    } else if (const auto* compare_jump =
+                   std::get_if<Bytecode::CompareJumpData>(&data)) {
+      CompareJumpProto* compare_jump_proto = proto.mutable_compare_jump();
+      compare_jump_proto->set_comparison(
+          static_cast<int32_t>(compare_jump->comparison));
+      XLS_ASSIGN_OR_RETURN(*compare_jump_proto->mutable_rhs(),
+                           InterpValueToProto(compare_jump->rhs));
+      compare_jump_proto->set_target(compare_jump->target.value());
+    } else {
+      // Spawn and channel data refer to procs and channel types.
+      return absl::UnimplementedError(
+          absl::StrFormat("BytecodesToProto: cannot convert data of `%s`",
+                          bytecode.ToString(/*source_locs=*/false)));
+    }
+    return proto;
+  }
+
+  const ParsedNodeCountFn& parsed_node_count_;
+  absl::flat_hash_map<const Module*, NodeIndices> node_indices_;
+};
+
+class BytecodeReader {
+ public:
+  explicit BytecodeReader(const ImportData& import_data)
+      : import_data_(import_data) {}
+
+  absl::StatusOr<std::vector<Bytecode>> Run(const BytecodesProto& proto) {
+    std::vector<Bytecode> bytecodes;
+    bytecodes.reserve(proto.bytecodes_size());
+    for (const BytecodeProto& bytecode : proto.bytecodes()) {
+      XLS_ASSIGN_OR_RETURN(Bytecode restored, FromProto(bytecode));
+      bytecodes.push_back(std::move(restored));
+    }
+    return bytecodes;
+  }
+
+ private:
+  template <typename NodeT>
+  absl::StatusOr<NodeT*> FromRef(const BytecodeAstNodeRefProto& ref) {
+    XLS_ASSIGN_OR_RETURN(ImportTokens subject,
+                         ImportTokens::FromString(ref.module()));
+    XLS_ASSIGN_OR_RETURN(ModuleInfo * info, import_data_.Get(subject));
+    absl::Span<AstNode* const> nodes = info->module().nodes();
+    XLS_RET_CHECK(ref.index() >= 0 && ref.index() < nodes.size())
+        << "node index " << ref.index() << " out of range for module "
+        << ref.module();
+    auto* node = dynamic_cast<NodeT*>(nodes[ref.index()]);
+    XLS_RET_CHECK(node != nullptr)
+        << "unexpected kind of node " << ref.index() << " of module "
+        << ref.module() << ": " << nodes[ref.index()]->ToString();
+    return node;
+  }
+
+  absl::StatusOr<ParametricEnv> EnvFromProto(const ParametricEnvProto& proto) {
+    std::vector<std::pair<std::string, InterpValue>> items;
+    for (const ParametricEnvItemProto& item : proto.items()) {
+      XLS_ASSIGN_OR_RETURN(InterpValue value,
+                           InterpValueFromProto(item.value(), import_data_));
+      items.push_back({item.identifier(), std::move(value)});
+    }
+    return ParametricEnv(items);
+  }
+
+  absl::StatusOr<InterpValue> ValueFromProto(const BytecodeValueProto& proto) {
+    switch (proto.value_oneof_case()) {
+      case BytecodeValueProto::kValue:
+        return InterpValueFromProto(proto.value(), import_data_);
+      case BytecodeValueProto::kBuiltin: {
+        XLS_ASSIGN_OR_RETURN(Builtin builtin,
+                             BuiltinFromString(proto.builtin()));
+        return InterpValue::MakeFunction(builtin);
+      }
+      case BytecodeValueProto::kUserFunction: {
+        XLS_ASSIGN_OR_RETURN(Function * f,
+                             FromRef<Function>(proto.user_function()));
+        return InterpValue::MakeFunction(
+            InterpValue::UserFnData{f->owner(), f});
+      }
+      case BytecodeValueProto::VALUE_ONEOF_NOT_SET:
+        break;
+    }
+    return absl::InvalidArgumentError("BytecodeValueProto has no value");
+  }
+
+  absl::StatusOr<Bytecode::MatchArmItem> FromProto(
+      const MatchArmItemProto& proto) {
+    switch (proto.item_oneof_case()) {
+      case MatchArmItemProto::kValue: {
+        XLS_ASSIGN_OR_RETURN(InterpValue value, ValueFromProto(proto.value()));
+        return Bytecode::MatchArmItem::MakeInterpValue(value);
+      }
+      case MatchArmItemProto::kLoad:
+        return Bytecode::MatchArmItem::MakeLoad(
+            Bytecode::SlotIndex(proto.load()));
+      case MatchArmItemProto::kStore:
+        return Bytecode::MatchArmItem::MakeStore(
+            Bytecode::SlotIndex(proto.store()));
+      case MatchArmItemProto::kRange: {
+        XLS_ASSIGN_OR_RETURN(
+            InterpValue start,
+            InterpValueFromProto(proto.range().start(), import_data_));
+        XLS_ASSIGN_OR_RETURN(
+            InterpValue limit,
+            InterpValueFromProto(proto.range().limit(), import_data_));
+        return Bytecode::MatchArmItem::MakeRange(std::move(start),
+                                                 std::move(limit));
+      }
+      case MatchArmItemProto::kTuple: {
+        std::vector<Bytecode::MatchArmItem> elements;
+        for (const MatchArmItemProto& element : proto.tuple().elements()) {
+          XLS_ASSIGN_OR_RETURN(Bytecode::MatchArmItem restored,
+                               FromProto(element));
+          elements.push_back(std::move(restored));
+        }
+        return Bytecode::MatchArmItem::MakeTuple(std::move(elements));
+      }
+      case MatchArmItemProto::kWildcard:
+        return Bytecode::MatchArmItem::MakeWildcard();
+      case MatchArmItemProto::ITEM_ONEOF_NOT_SET:
+        break;
+    }
+    return absl::InvalidArgumentError("MatchArmItemProto has no item");
+  }
+
+  absl::StatusOr<Bytecode::FusedOperand> FromProto(
+      const FusedOperandProto& proto) {
+    if (proto.has_value()) {
+      XLS_ASSIGN_OR_RETURN(InterpValue value,
+                           InterpValueFromProto(proto.value(), import_data_));
+      return value;
+    }
+    return Bytecode::SlotIndex(proto.slot());
+  }
+
+  absl::StatusOr<Bytecode::Op> OpFromProto(int32_t op) {
+    XLS_RET_CHECK(op >= 0 &&
+                  op <= static_cast<int32_t>(
+                            Bytecode::Op::kLiteralCompareJumpRelIf))
+        << "invalid bytecode op " << op;
+    return static_cast<Bytecode::Op>(op);
+  }
+
+  absl::StatusOr<Bytecode> FromProto(const BytecodeProto& proto) {
+    Span span = SpanFromProto(proto.span());
+    XLS_ASSIGN_OR_RETURN(Bytecode::Op op, OpFromProto(proto.op()));
+    switch (proto.data_oneof_case()) {
+      case BytecodeProto::kValue: {
+        XLS_ASSIGN_OR_RETURN(InterpValue value, ValueFromProto(proto.value()));
+        return Bytecode(span, op, std::move(value));
+      }
+      case BytecodeProto::kJumpTarget:
+        return Bytecode(span, op, Bytecode::JumpTarget(proto.jump_target()));
+      case BytecodeProto::kNumElements:
+        return Bytecode(span, op, Bytecode::NumElements(proto.num_elements()));
+      case BytecodeProto::kSlotIndex:
+        return Bytecode(span, op, Bytecode::SlotIndex(proto.slot_index()));
+      case BytecodeProto::kType: {
+        XLS_ASSIGN_OR_RETURN(std::unique_ptr<Type> type,
+                             TypeFromProto(proto.type(), import_data_));
+        return Bytecode(span, op, std::move(type));
+      }
+      case BytecodeProto::kInvocation: {
+        const BytecodeInvocationProto& invocation = proto.invocation();
+        XLS_ASSIGN_OR_RETURN(Invocation * node,
+                             FromRef<Invocation>(invocation.invocation()));
+        std::optional<ParametricEnv> caller_bindings;
+        if (invocation.has_caller_bindings()) {
+          XLS_ASSIGN_OR_RETURN(caller_bindings,
+                               EnvFromProto(invocation.caller_bindings()));
+        }
+        std::optional<ParametricEnv> callee_bindings;
+        if (invocation.has_callee_bindings()) {
+          XLS_ASSIGN_OR_RETURN(callee_bindings,
+                               EnvFromProto(invocation.callee_bindings()));
+        }
+        return Bytecode(span, op,
+                        Bytecode::InvocationData(node,
+                                                 std::move(caller_bindings),
+                                                 std::move(callee_bindings)));
+      }
+      case BytecodeProto::kMatchArmItem: {
+        XLS_ASSIGN_OR_RETURN(Bytecode::MatchArmItem item,
+                             FromProto(proto.match_arm_item()));
+        return Bytecode(span, op, std::move(item));
+      }
+      case BytecodeProto::kTrace: {
+        std::vector<FormatStep> steps;
+        for (const FormatStepProto& step : proto.trace().steps()) {
+          if (step.has_preference()) {
+            XLS_ASSIGN_OR_RETURN(FormatPreference preference,
+                                 FormatPreferenceFromString(step.preference()));
+            steps.push_back(preference);
+          } else {
+            steps.push_back(step.text());
+          }
+        }
+        return Bytecode(span, op,
+                        Bytecode::TraceData(std::move(steps), {}));
+      }
+      case BytecodeProto::kFusedBinop: {
+        const FusedBinopProto& fused = proto.fused_binop();
+        XLS_ASSIGN_OR_RETURN(Bytecode::Op binop, OpFromProto(fused.binop()));
+        XLS_ASSIGN_OR_RETURN(Bytecode::FusedOperand lhs,
+                             FromProto(fused.lhs()));
+        XLS_ASSIGN_OR_RETURN(Bytecode::FusedOperand rhs,
+                             FromProto(fused.rhs()));
+        std::optional<Bytecode::SlotIndex> result;
+        if (fused.has_result()) {
+          result = Bytecode::SlotIndex(fused.result());
+        }
+        return Bytecode(span, op,
+                        Bytecode::FusedBinopData{.binop = binop,
+                                                 .lhs = std::move(lhs),
+                                                 .rhs = std::move(rhs),
+                                                 .result = result});
+      }
+      case BytecodeProto::kCompareJump: {
+        const CompareJumpProto& compare_jump = proto.compare_jump();
+        XLS_ASSIGN_OR_RETURN(Bytecode::Op comparison,
+                             OpFromProto(compare_jump.comparison()));
+        XLS_ASSIGN_OR_RETURN(
+            InterpValue rhs,
+            InterpValueFromProto(compare_jump.rhs(), import_data_));
+        return Bytecode(
+            span, op,
+            Bytecode::CompareJumpData{
+                .comparison = comparison,
+                .rhs = std::move(rhs),
+                .target = Bytecode::JumpTarget(compare_jump.target())});
+      }
+      case BytecodeProto::DATA_ONEOF_NOT_SET:
+        break;
+    }
+    return Bytecode(span, op);
+  }
+
+  const ImportData& import_data_;
+};
+
+}  // namespace
+
+absl::StatusOr<BytecodesProto> BytecodesToProto(
+    absl::Span<const Bytecode> bytecodes,
+    const ParsedNodeCountFn& parsed_node_count) {
+  return BytecodeWriter(parsed_node_count).Run(bytecodes);
+}
+
+absl::StatusOr<std::vector<Bytecode>> BytecodesFromProto(
+    const BytecodesProto& proto, const ImportData& import_data) {
+  return BytecodeReader(import_data).Run(proto);
+}
+
+}  // namespace xls::dslx
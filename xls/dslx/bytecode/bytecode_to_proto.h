@@ -0,0 +1,51 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_BYTECODE_BYTECODE_TO_PROTO_H_
+#define XLS_DSLX_BYTECODE_BYTECODE_TO_PROTO_H_
+
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/bytecode/bytecode.pb.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/type_system/type_info_to_proto.h"
+
+namespace xls::dslx {
+
+// Converts `bytecodes` to protobuf form so they can be restored with
+// BytecodesFromProto once the modules they refer to have been imported again,
+// e.g. by another process.
+//
+// AST nodes (invoked functions and invocations) are referred to by their index
+// in Module::nodes(); `parsed_node_count` gives the number of nodes of a module
+// which can be referred to this way (see TypeInfoClosureToProto).
+//
+// Returns an error if some bytecode cannot be converted: spawns, channel
+// operations, traces of formatted values, and references to nodes created
+// after parsing.
+absl::StatusOr<BytecodesProto> BytecodesToProto(
+    absl::Span<const Bytecode> bytecodes,
+    const ParsedNodeCountFn& parsed_node_count);
+
+// Restores bytecodes converted with BytecodesToProto. All the modules referred
+// to must be present in `import_data`.
+absl::StatusOr<std::vector<Bytecode>> BytecodesFromProto(
+    const BytecodesProto& proto, const ImportData& import_data);
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_BYTECODE_BYTECODE_TO_PROTO_H_
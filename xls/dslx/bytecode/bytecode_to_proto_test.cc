@@ -0,0 +1,112 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/bytecode/bytecode_to_proto.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/bytecode/bytecode.pb.h"
+#include "xls/dslx/bytecode/bytecode_emitter.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/module.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/type_system/type_info.h"
+
+namespace xls::dslx {
+namespace {
+
+using status_testing::StatusIs;
+
+std::optional<int64_t> AllNodes(const Module* module) {
+  return module->nodes().size();
+}
+
+TEST(BytecodeToProtoTest, RoundTripsFunctionBytecode) {
+  constexpr std::string_view kProgram = R"(
+enum E : u2 { A = 0, B = 1 }
+
+fn helper(x: u8) -> u16 { x as u16 }
+
+fn main(x: u8, t: (u8, E)) -> u16 {
+  assert!(x != u8:42, "not_42");
+  let y = match t {
+    (u8:0, E::A) => helper(x),
+    (z, _) => helper(z) + u16:1,
+  };
+  let w = match x {
+    u8:0..u8:4 => u16:0,
+    _ => y,
+  };
+  let a = [y, w];
+  for (i, acc): (u32, u16) in u32:0..u32:2 {
+    acc + a[i]
+  }(u16:0)
+}
+)";
+  ImportData import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kProgram, "test.x", "test", &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           tm.module->GetMemberOrError<Function>("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BytecodeFunction> bf,
+      BytecodeEmitter::Emit(&import_data, tm.type_info, *f, std::nullopt,
+                            BytecodeEmitterOptions{.optimize = true}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(BytecodesProto proto,
+                           BytecodesToProto(bf->bytecodes(), AllNodes));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bytecode> restored,
+                           BytecodesFromProto(proto, import_data));
+  EXPECT_EQ(BytecodesToString(restored, /*source_locs=*/true),
+            BytecodesToString(bf->bytecodes(), /*source_locs=*/true));
+}
+
+TEST(BytecodeToProtoTest, RejectsNodesCreatedAfterParsing) {
+  constexpr std::string_view kProgram = R"(
+fn helper(x: u8) -> u8 { x + u8:1 }
+
+fn main(x: u8) -> u8 { helper(x) }
+)";
+  ImportData import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kProgram, "test.x", "test", &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           tm.module->GetMemberOrError<Function>("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BytecodeFunction> bf,
+      BytecodeEmitter::Emit(&import_data, tm.type_info, *f, std::nullopt));
+
+  // Pretend none of the nodes were created by the parser.
+  EXPECT_THAT(
+      BytecodesToProto(bf->bytecodes(),
+                       [](const Module*) -> std::optional<int64_t> {
+                         return 0;
+                       }),
+      StatusIs(absl::StatusCode::kUnimplemented));
+}
+
+}  // namespace
+}  // namespace xls::dslx
@@ -49,9 +49,10 @@ Frame::Frame(BytecodeFunction* bf, std::vector<InterpValue> args,
 void Frame::StoreSlot(Bytecode::SlotIndex slot, InterpValue value) {
   // Slots are usually encountered in order of use (and assignment), except for
   // those declared inside conditional branches, which may never be seen,
-  // so we may have to add more than one slot at a time in such cases.
+  // so we may have to add more than one slot at a time in such cases. The
+  // placeholder is never read; units are used as they need no allocation.
   while (slots_.size() <= slot.value()) {
-    slots_.push_back(InterpValue::MakeToken());
+    slots_.push_back(InterpValue::MakeUnit());
   }
 
   slots_.at(slot.value()) = std::move(value);
@@ -0,0 +1,104 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/bytecode/persistent_bytecode_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/base/const_init.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/bytecode/bytecode.pb.h"
+
+namespace xls::dslx {
+namespace {
+
+// Version of the format of cache entries; bump when BytecodesProto, the
+// bytecode instruction set or how bytecode is converted to protos changes
+// incompatibly.
+constexpr std::string_view kFormatVersion = "1";
+
+ABSL_CONST_INIT absl::Mutex default_cache_mutex(absl::kConstInit);
+PersistentBytecodeCache* default_cache ABSL_GUARDED_BY(default_cache_mutex) =
+    nullptr;
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<PersistentBytecodeCache>>
+PersistentBytecodeCache::Create(const std::filesystem::path& directory) {
+  XLS_ASSIGN_OR_RETURN(
+      ContentAddressedCache cache,
+      ContentAddressedCache::Create(directory, ".bytecode", "bytecode cache"));
+  return absl::WrapUnique(new PersistentBytecodeCache(std::move(cache)));
+}
+
+/* static */ std::string PersistentBytecodeCache::ComputeKey(
+    const KeyOptions& options) {
+  // The bindings component is prefixed so that empty bindings differ from no
+  // bindings.
+  std::string function = absl::StrCat("F", options.function_index);
+  std::string bindings =
+      options.bindings.has_value() ? absl::StrCat("B", *options.bindings) : "";
+  return ContentAddressedCache::ComputeKey(
+      {kFormatVersion, options.module_key, function, bindings});
+}
+
+absl::StatusOr<std::optional<BytecodesProto>> PersistentBytecodeCache::Lookup(
+    std::string_view key) const {
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> contents,
+                       cache_.Lookup(key));
+  if (!contents.has_value()) {
+    return std::nullopt;
+  }
+  BytecodesProto entry;
+  if (!entry.ParseFromString(*contents)) {
+    return absl::DataLossError(
+        absl::StrFormat("Unable to parse bytecode cache entry %s",
+                        cache_.GetPath(key).string()));
+  }
+  return entry;
+}
+
+absl::Status PersistentBytecodeCache::Insert(std::string_view key,
+                                             const BytecodesProto& entry) {
+  return cache_.Insert(key, entry.SerializeAsString());
+}
+
+void SetDefaultPersistentBytecodeCache(
+    std::unique_ptr<PersistentBytecodeCache> cache) {
+  absl::MutexLock lock(&default_cache_mutex);
+  // Previously set caches may still be in use by running interpreters so they
+  // are intentionally leaked.
+  default_cache = cache.release();
+}
+
+PersistentBytecodeCache* GetDefaultPersistentBytecodeCache() {
+  absl::MutexLock lock(&default_cache_mutex);
+  return default_cache;
+}
+
+}  // namespace xls::dslx
@@ -0,0 +1,92 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_BYTECODE_PERSISTENT_BYTECODE_CACHE_H_
+#define XLS_DSLX_BYTECODE_PERSISTENT_BYTECODE_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/dslx/bytecode/bytecode.pb.h"
+
+namespace xls::dslx {
+
+// A persistent cache of the bytecode emitted for the functions of imported
+// DSLX modules stored in a directory on disk (see ContentAddressedCache), so
+// that e.g. the standard library does not have to be compiled to bytecode
+// again by every test run. Each entry holds the serialized bytecode of one
+// function instantiation (see BytecodesToProto).
+//
+// Entries are keyed on the type info cache key of the function's module (see
+// TypeInfoCache::ComputeKey, which covers the text of the module and of
+// everything it imports), the function and its parametric bindings, so only
+// functions of modules imported while a TypeInfoCache is in use are cached.
+// As with TypeInfoCache the version of the tools is not part of the key.
+class PersistentBytecodeCache {
+ public:
+  // Creates a cache backed by `directory`, creating the directory if it does
+  // not exist.
+  static absl::StatusOr<std::unique_ptr<PersistentBytecodeCache>> Create(
+      const std::filesystem::path& directory);
+
+  // Components of a cache key.
+  struct KeyOptions {
+    // Type info cache key of the module containing the function.
+    std::string_view module_key;
+    // Index of the function in its module's Module::nodes().
+    int64_t function_index;
+    // Textual form of the parametric bindings the function is emitted for, or
+    // std::nullopt if there are none.
+    std::optional<std::string_view> bindings;
+  };
+
+  static std::string ComputeKey(const KeyOptions& options);
+
+  // Returns the entry for `key` or std::nullopt if there is none.
+  absl::StatusOr<std::optional<BytecodesProto>> Lookup(
+      std::string_view key) const;
+
+  // Stores `entry` under `key`, replacing any existing entry.
+  absl::Status Insert(std::string_view key, const BytecodesProto& entry);
+
+  const std::filesystem::path& directory() const { return cache_.directory(); }
+
+ private:
+  explicit PersistentBytecodeCache(ContentAddressedCache cache)
+      : cache_(std::move(cache)) {}
+
+  ContentAddressedCache cache_;
+};
+
+// Sets the cache consulted by BytecodeCache when emitting functions. Passing
+// nullptr disables caching. Typically called once at binary startup (e.g., by
+// InitPersistentBytecodeCacheFromFlags).
+void SetDefaultPersistentBytecodeCache(
+    std::unique_ptr<PersistentBytecodeCache> cache);
+
+// Returns the cache consulted by BytecodeCache, or nullptr if caching is
+// disabled.
+PersistentBytecodeCache* GetDefaultPersistentBytecodeCache();
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_BYTECODE_PERSISTENT_BYTECODE_CACHE_H_
@@ -0,0 +1,46 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/bytecode/persistent_bytecode_cache_flags.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/bytecode/persistent_bytecode_cache.h"
+
+ABSL_FLAG(std::string, dslx_bytecode_cache_dir, "",
+          "If non-empty, directory in which to cache the bytecode emitted for "
+          "the functions of imported DSLX modules. Only takes effect together "
+          "with --dslx_type_info_cache_dir, whose keys identify unchanged "
+          "modules. The directory may be shared between concurrent processes "
+          "using the same version of the tools.");
+
+namespace xls::dslx {
+
+absl::Status InitPersistentBytecodeCacheFromFlags() {
+  std::string directory = absl::GetFlag(FLAGS_dslx_bytecode_cache_dir);
+  if (directory.empty()) {
+    return absl::OkStatus();
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<PersistentBytecodeCache> cache,
+                       PersistentBytecodeCache::Create(directory));
+  SetDefaultPersistentBytecodeCache(std::move(cache));
+  return absl::OkStatus();
+}
+
+}  // namespace xls::dslx
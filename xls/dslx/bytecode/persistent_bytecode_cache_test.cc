@@ -0,0 +1,173 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/bytecode/persistent_bytecode_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/bytecode/bytecode.pb.h"
+#include "xls/dslx/bytecode/bytecode_interpreter.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/type_info_cache.h"
+#include "xls/dslx/warning_kind.h"
+
+namespace xls::dslx {
+namespace {
+
+using status_testing::StatusIs;
+
+int64_t CountCacheEntries(const std::filesystem::path& directory) {
+  int64_t count = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+    if (entry.path().extension() == ".bytecode") {
+      ++count;
+    }
+  }
+  return count;
+}
+
+class PersistentBytecodeCacheTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    SetDefaultPersistentBytecodeCache(nullptr);
+    SetDefaultTypeInfoCache(nullptr);
+  }
+};
+
+TEST_F(PersistentBytecodeCacheTest, KeyDependsOnAllInputs) {
+  const PersistentBytecodeCache::KeyOptions options{
+      .module_key = "abc", .function_index = 3, .bindings = std::nullopt};
+  std::string key = PersistentBytecodeCache::ComputeKey(options);
+  EXPECT_EQ(key, PersistentBytecodeCache::ComputeKey(options));
+
+  PersistentBytecodeCache::KeyOptions other = options;
+  other.module_key = "abd";
+  EXPECT_NE(key, PersistentBytecodeCache::ComputeKey(other));
+  other = options;
+  other.function_index = 4;
+  EXPECT_NE(key, PersistentBytecodeCache::ComputeKey(other));
+  other = options;
+  other.bindings = "{}";
+  EXPECT_NE(key, PersistentBytecodeCache::ComputeKey(other));
+  // Empty bindings are distinct from no bindings.
+  other.bindings = "";
+  EXPECT_NE(key, PersistentBytecodeCache::ComputeKey(other));
+}
+
+TEST_F(PersistentBytecodeCacheTest, EntryRoundTrips) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PersistentBytecodeCache> cache,
+      PersistentBytecodeCache::Create(temp_dir.path() / "cache"));
+  std::string key = PersistentBytecodeCache::ComputeKey(
+      {.module_key = "abc", .function_index = 3, .bindings = std::nullopt});
+  XLS_ASSERT_OK_AND_ASSIGN(std::optional<BytecodesProto> found,
+                           cache->Lookup(key));
+  EXPECT_FALSE(found.has_value());
+
+  BytecodesProto entry;
+  entry.add_bytecodes()->set_op(1);
+  XLS_ASSERT_OK(cache->Insert(key, entry));
+  XLS_ASSERT_OK_AND_ASSIGN(found, cache->Lookup(key));
+  ASSERT_TRUE(found.has_value());
+  ASSERT_EQ(found->bytecodes_size(), 1);
+  EXPECT_EQ(found->bytecodes(0).op(), 1);
+}
+
+TEST_F(PersistentBytecodeCacheTest, MalformedEntryIsDataLoss) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PersistentBytecodeCache> cache,
+                           PersistentBytecodeCache::Create(temp_dir.path()));
+  std::string key = PersistentBytecodeCache::ComputeKey(
+      {.module_key = "abc", .function_index = 3, .bindings = std::nullopt});
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / (key + ".bytecode"),
+                                "\xff not a proto"));
+  EXPECT_THAT(cache->Lookup(key), StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST_F(PersistentBytecodeCacheTest, InterpreterReusesCachedBytecode) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / "mylib.x", R"(
+pub fn double<N: u32>(x: uN[N]) -> uN[N] { x + x }
+
+pub fn clamp(x: u8) -> u8 {
+  match x {
+    u8:0..u8:10 => x,
+    _ => u8:10,
+  }
+}
+)"));
+  constexpr std::string_view kMain = R"(
+import mylib;
+
+fn main(x: u8) -> u8 { mylib::clamp(mylib::double(x)) }
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TypeInfoCache> type_info_cache,
+                           TypeInfoCache::Create(temp_dir.path() / "ti"));
+  SetDefaultTypeInfoCache(std::move(type_info_cache));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PersistentBytecodeCache> cache,
+      PersistentBytecodeCache::Create(temp_dir.path() / "bytecode"));
+  const std::filesystem::path cache_dir = cache->directory();
+  SetDefaultPersistentBytecodeCache(std::move(cache));
+
+  // Runs `main` with a fresh ImportData, as a new process would.
+  auto run = [&](uint8_t x) -> absl::StatusOr<InterpValue> {
+    const std::filesystem::path search_paths[] = {temp_dir.path()};
+    ImportData import_data = CreateImportData(
+        kDefaultDslxStdlibPath, search_paths, kDefaultWarningsSet);
+    XLS_ASSIGN_OR_RETURN(
+        TypecheckedModule tm,
+        ParseAndTypecheck(kMain, "main.x", "main", &import_data));
+    XLS_ASSIGN_OR_RETURN(Function * main,
+                         tm.module->GetMemberOrError<Function>("main"));
+    XLS_ASSIGN_OR_RETURN(
+        BytecodeFunction * bf,
+        import_data.bytecode_cache()->GetOrCreateBytecodeFunction(
+            *main, tm.type_info, std::nullopt));
+    return BytecodeInterpreter::Interpret(&import_data, bf,
+                                          {InterpValue::MakeU8(x)});
+  };
+
+  EXPECT_THAT(run(3), status_testing::IsOkAndHolds(InterpValue::MakeU8(6)));
+  // Only the functions of the imported module are cached.
+  EXPECT_EQ(CountCacheEntries(cache_dir), 2);
+
+  // The second run should be served from the cache without adding any new
+  // entries.
+  EXPECT_THAT(run(7), status_testing::IsOkAndHolds(InterpValue::MakeU8(10)));
+  EXPECT_EQ(CountCacheEntries(cache_dir), 2);
+}
+
+}  // namespace
+}  // namespace xls::dslx
@@ -85,6 +85,49 @@ absl::StatusOr<std::unique_ptr<BitsType>> InstantiateParametricNumberType(
       std::get<InterpValue>(e).GetBitValueViaSign().value());
 }
 
+// Computes a binary operation on bits-typed constexpr operands the way the
+// bytecode interpreter would (see BytecodeInterpreter::ApplyBinop), without
+// emitting bytecode. Returns std::nullopt for operations and operand kinds
+// which are left to the interpreter.
+absl::StatusOr<std::optional<InterpValue>> FoldBitsBinop(
+    BinopKind kind, const InterpValue& lhs, const InterpValue& rhs) {
+  if (!lhs.IsBits() || !rhs.IsBits()) {
+    return std::nullopt;
+  }
+  switch (kind) {
+    case BinopKind::kAdd:
+      return lhs.Add(rhs);
+    case BinopKind::kSub:
+      return lhs.Sub(rhs);
+    case BinopKind::kMul:
+      return lhs.Mul(rhs);
+    case BinopKind::kShl:
+      return lhs.Shl(rhs);
+    case BinopKind::kShr:
+      return lhs.IsSigned() ? lhs.Shra(rhs) : lhs.Shrl(rhs);
+    case BinopKind::kAnd:
+      return lhs.BitwiseAnd(rhs);
+    case BinopKind::kOr:
+      return lhs.BitwiseOr(rhs);
+    case BinopKind::kXor:
+      return lhs.BitwiseXor(rhs);
+    case BinopKind::kEq:
+      return InterpValue::MakeBool(lhs.Eq(rhs));
+    case BinopKind::kNe:
+      return InterpValue::MakeBool(lhs.Ne(rhs));
+    case BinopKind::kLt:
+      return lhs.Lt(rhs);
+    case BinopKind::kLe:
+      return lhs.Le(rhs);
+    case BinopKind::kGt:
+      return lhs.Gt(rhs);
+    case BinopKind::kGe:
+      return lhs.Ge(rhs);
+    default:
+      return std::nullopt;
+  }
+}
+
 }  // namespace
 
 /* static */ absl::Status ConstexprEvaluator::Evaluate(
@@ -240,6 +283,16 @@ absl::Status ConstexprEvaluator::HandleBinop(const Binop* expr) {
   VLOG(3) << "ConstexprEvaluator::HandleBinop : " << expr->ToString();
   EVAL_AS_CONSTEXPR_OR_RETURN(expr->lhs());
   EVAL_AS_CONSTEXPR_OR_RETURN(expr->rhs());
+
+  // Simple arithmetic on known values (e.g. `u32:1 << N`) is folded directly.
+  XLS_ASSIGN_OR_RETURN(InterpValue lhs, type_info_->GetConstExpr(expr->lhs()));
+  XLS_ASSIGN_OR_RETURN(InterpValue rhs, type_info_->GetConstExpr(expr->rhs()));
+  XLS_ASSIGN_OR_RETURN(std::optional<InterpValue> folded,
+                       FoldBitsBinop(expr->binop_kind(), lhs, rhs));
+  if (folded.has_value()) {
+    type_info_->NoteConstExpr(expr, *std::move(folded));
+    return absl::OkStatus();
+  }
   return InterpretExpr(expr);
 }
 
@@ -687,6 +740,16 @@ absl::Status ConstexprEvaluator::InterpretExpr(const Expr* expr) {
       env, MakeConstexprEnv(import_data_, type_info_, warning_collector_, expr,
                             bindings_));
 
+  // The value of the expression only depends on the environment, so an
+  // evaluation with the same environment (typically of another instantiation
+  // of the enclosing parametric function) can be reused.
+  std::string memo_env = EnvMapToString(env);
+  if (std::optional<InterpValue> memoized =
+          import_data_->GetMemoizedConstexpr(expr, memo_env)) {
+    type_info_->NoteConstExpr(expr, *memoized);
+    return absl::OkStatus();
+  }
+
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<BytecodeFunction> bf,
                        BytecodeEmitter::EmitExpression(import_data_, type_info_,
                                                        expr, env, bindings_));
@@ -704,6 +767,8 @@ absl::Status ConstexprEvaluator::InterpretExpr(const Expr* expr) {
           "constexpr evaluation detected rollover in operation");
     }
   }
+  import_data_->NoteMemoizedConstexpr(expr, std::move(memo_env),
+                                      constexpr_value);
   type_info_->NoteConstExpr(expr, constexpr_value);
 
   return absl::OkStatus();
@@ -13,6 +13,7 @@
 // limitations under the License.
 #include "xls/dslx/constexpr_evaluator.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -587,5 +588,70 @@ fn main() -> u32 {
   EXPECT_EQ(value.GetBitValueViaSign().value(), 5);
 }
 
+TEST(ConstexprEvaluatorTest, FoldsBitsBinops) {
+  constexpr std::string_view kModule = R"(
+const kShl = u32:1 << u32:5;
+const kShra = s8:-128 >> u32:1;
+const kWrappingAdd = u8:250 + u8:10;
+const kSignedLt = s4:-1 < s4:0;
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(TestData test_data, CreateTestData(kModule));
+  auto get_value = [&](std::string_view name) -> absl::StatusOr<InterpValue> {
+    XLS_ASSIGN_OR_RETURN(ConstantDef * constant_def,
+                         test_data.module->GetConstantDef(name));
+    return test_data.type_info->GetConstExpr(constant_def->value());
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue shl, get_value("kShl"));
+  EXPECT_EQ(shl, InterpValue::MakeU32(32));
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue shra, get_value("kShra"));
+  EXPECT_EQ(shra, InterpValue::MakeSBits(8, -64));
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue add, get_value("kWrappingAdd"));
+  EXPECT_EQ(add, InterpValue::MakeUBits(8, 4));
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue lt, get_value("kSignedLt"));
+  EXPECT_EQ(lt, InterpValue::MakeBool(true));
+}
+
+TEST(ConstexprEvaluatorTest, MemoizedValuesAreKeyedByEnvironment) {
+  // The cast is interpreted once per distinct value of N; the memo must not
+  // let the second instantiation's assertion pass on the first one's value.
+  constexpr std::string_view kProgram = R"(
+fn p<N: u32>() -> u32 {
+  const_assert!((N as u64) < u64:10);
+  N
+}
+
+fn main() -> u32 {
+  p<u32:3>() + p<u32:3>() + p<u32:12>()
+}
+)";
+
+  ImportData import_data(CreateImportDataForTest());
+  EXPECT_THAT(ParseAndTypecheck(kProgram, "test.x", "test", &import_data),
+              status_testing::StatusIs(
+                  testing::_, testing::HasSubstr("const_assert! failure")));
+}
+
+TEST(ConstexprEvaluatorTest, ImportDataMemoizesConstexprs) {
+  constexpr std::string_view kModule = R"(
+const kFoo = u32:7;
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(TestData test_data, CreateTestData(kModule));
+  XLS_ASSERT_OK_AND_ASSIGN(ConstantDef * constant_def,
+                           test_data.module->GetConstantDef("kFoo"));
+  ImportData& import_data = test_data.import_data;
+  int64_t hits = import_data.constexpr_memo_hit_count();
+  EXPECT_EQ(import_data.GetMemoizedConstexpr(constant_def->value(), "{N: 1}"),
+            std::nullopt);
+  import_data.NoteMemoizedConstexpr(constant_def->value(), "{N: 1}",
+                                    InterpValue::MakeU32(2));
+  EXPECT_EQ(import_data.GetMemoizedConstexpr(constant_def->value(), "{N: 1}"),
+            InterpValue::MakeU32(2));
+  EXPECT_EQ(import_data.GetMemoizedConstexpr(constant_def->value(), "{N: 2}"),
+            std::nullopt);
+  EXPECT_EQ(import_data.constexpr_memo_hit_count(), hits + 1);
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -27,6 +27,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -112,6 +113,64 @@ absl::StatusOr<std::string> GetBitVectorCppType(int64_t bit_count,
   return prefix + "int64_t";
 }
 
+// Returns the number of bytes holding the data of a bit vector with the given
+// bit count in the native layout used by the JIT.
+int64_t JitLeafDataSize(int64_t bit_count) { return (bit_count + 7) / 8; }
+
+// Returns the number of bytes to which a bit vector with the given bit count is
+// padded with zeros in the native layout used by the JIT. This is the LLVM
+// allocation size of the integer type, a power of two for up to 64 bits.
+int64_t JitLeafPaddedSize(int64_t bit_count) {
+  int64_t data_size = JitLeafDataSize(bit_count);
+  if (data_size > 8) {
+    // Types wider than 64 bits are not functional, see GetBitVectorCppType.
+    return data_size;
+  }
+  int64_t padded_size = 1;
+  while (padded_size < data_size) {
+    padded_size *= 2;
+  }
+  return padded_size;
+}
+
+// Returns a C++ expression for the product of the C++ expression `variable`
+// and the integer expression `factor`.
+std::string MultiplyCppIntExpression(std::string_view variable,
+                                     std::string_view factor) {
+  int64_t value;
+  if (absl::SimpleAtoi(factor, &value)) {
+    return value == 1 ? std::string{variable}
+                      : absl::StrFormat("%s * %d", variable, value);
+  }
+  return absl::StrFormat("%s * (%s)", variable, factor);
+}
+
+std::string BitVectorToJitBuffer(std::string_view buffer,
+                                 std::string_view leaf_offsets,
+                                 std::string_view first_leaf,
+                                 std::string_view rhs, int64_t bit_count) {
+  return absl::StrFormat(
+      "__WriteJitLeaf(static_cast<uint64_t>(%s), %d, %d, %s + %s[%s]);", rhs,
+      bit_count, JitLeafPaddedSize(bit_count), buffer, leaf_offsets,
+      first_leaf);
+}
+
+std::string BitVectorFromJitBuffer(std::string_view lhs,
+                                   std::string_view cpp_type,
+                                   std::string_view buffer,
+                                   std::string_view leaf_offsets,
+                                   std::string_view first_leaf,
+                                   int64_t bit_count, bool is_signed) {
+  std::string read =
+      absl::StrFormat("__ReadJitLeaf(%d, %s + %s[%s])",
+                      JitLeafDataSize(bit_count), buffer, leaf_offsets,
+                      first_leaf);
+  if (is_signed) {
+    read = absl::StrFormat("__SignExtend(%s, %d)", read, bit_count);
+  }
+  return absl::StrFormat("%s = static_cast<%s>(%s);", lhs, cpp_type, read);
+}
+
 // Returns the number of elements in the array defined by `type_annotation`.
 absl::StatusOr<int64_t> ArraySize(const ArrayTypeAnnotation* type_annotation,
                                   TypeInfo* type_info,
@@ -223,6 +282,26 @@ class BitVectorCppEmitter : public CppEmitter {
                         ValueAsDslxString(identifier), ";");
   }
 
+  std::string AssignToJitBuffer(std::string_view buffer,
+                                std::string_view leaf_offsets,
+                                std::string_view first_leaf,
+                                std::string_view rhs,
+                                int64_t nesting) const override {
+    return BitVectorToJitBuffer(buffer, leaf_offsets, first_leaf, rhs,
+                                dslx_bit_count());
+  }
+
+  std::string AssignFromJitBuffer(std::string_view lhs,
+                                  std::string_view buffer,
+                                  std::string_view leaf_offsets,
+                                  std::string_view first_leaf,
+                                  int64_t nesting) const override {
+    return BitVectorFromJitBuffer(lhs, cpp_type(), buffer, leaf_offsets,
+                                  first_leaf, dslx_bit_count(), is_signed());
+  }
+
+  std::string LeafCount() const override { return "1"; }
+
   std::optional<int64_t> GetBitCountIfBitVector() const override {
     return dslx_bit_count_;
   }
@@ -259,10 +338,12 @@ class TypeRefCppEmitter : public CppEmitter {
   explicit TypeRefCppEmitter(const TypeRefTypeAnnotation* type_annotation,
                              std::string_view cpp_type,
                              std::string_view dslx_type,
-                             std::optional<int64_t> dslx_bit_count)
+                             std::optional<int64_t> dslx_bit_count,
+                             bool is_signed = false)
       : CppEmitter(cpp_type, dslx_type),
         typeref_type_annotation_(type_annotation),
-        dslx_bit_count_(dslx_bit_count) {}
+        dslx_bit_count_(dslx_bit_count),
+        is_signed_(is_signed) {}
   ~TypeRefCppEmitter() override = default;
 
   static absl::StatusOr<std::unique_ptr<TypeRefCppEmitter>> Create(
@@ -273,13 +354,15 @@ class TypeRefCppEmitter : public CppEmitter {
     std::optional<BitVectorMetadata> bit_vector_metadata =
         ExtractBitVectorMetadata(type_annotation);
     std::optional<int64_t> dslx_bit_count;
+    bool is_signed = false;
     if (bit_vector_metadata.has_value()) {
       XLS_ASSIGN_OR_RETURN(dslx_bit_count,
                            GetBitCountFromBitVectorMetadata(
                                *bit_vector_metadata, type_info, import_data));
+      is_signed = bit_vector_metadata->is_signed;
     }
-    return std::make_unique<TypeRefCppEmitter>(type_annotation, cpp_type,
-                                               dslx_type, dslx_bit_count);
+    return std::make_unique<TypeRefCppEmitter>(
+        type_annotation, cpp_type, dslx_type, dslx_bit_count, is_signed);
   }
 
   std::string AssignToValue(std::string_view lhs, std::string_view rhs,
@@ -331,6 +414,55 @@ class TypeRefCppEmitter : public CppEmitter {
                               indent_amount));
   }
 
+  // Bit-vector types (enums and aliases of bits types) are written in place.
+  // Other types delegate to the code generated for the type.
+  std::string AssignToJitBuffer(std::string_view buffer,
+                                std::string_view leaf_offsets,
+                                std::string_view first_leaf,
+                                std::string_view rhs,
+                                int64_t nesting) const override {
+    if (dslx_bit_count_.has_value()) {
+      return BitVectorToJitBuffer(buffer, leaf_offsets, first_leaf, rhs,
+                                  *dslx_bit_count_);
+    }
+    std::string leaves = absl::StrFormat("%s.subspan(%s, %s)", leaf_offsets,
+                                         first_leaf, LeafCount());
+    return absl::StrFormat(
+        "XLS_RETURN_IF_ERROR(%s);",
+        TypeHasMethods()
+            ? absl::StrFormat("%s.ToJitBuffer(%s, %s)", rhs, leaves, buffer)
+            : absl::StrFormat("%sToJitBuffer(%s, %s, %s)", cpp_type(), rhs,
+                              leaves, buffer));
+  }
+
+  std::string AssignFromJitBuffer(std::string_view lhs,
+                                  std::string_view buffer,
+                                  std::string_view leaf_offsets,
+                                  std::string_view first_leaf,
+                                  int64_t nesting) const override {
+    if (dslx_bit_count_.has_value()) {
+      return BitVectorFromJitBuffer(lhs, cpp_type(), buffer, leaf_offsets,
+                                    first_leaf, *dslx_bit_count_, is_signed_);
+    }
+    std::string leaves = absl::StrFormat("%s.subspan(%s, %s)", leaf_offsets,
+                                         first_leaf, LeafCount());
+    return absl::StrFormat(
+        "XLS_ASSIGN_OR_RETURN(%s, %s);", lhs,
+        TypeHasMethods()
+            ? absl::StrFormat("%s::FromJitBuffer(%s, %s)", cpp_type(), leaves,
+                              buffer)
+            : absl::StrFormat("%sFromJitBuffer(%s, %s)", cpp_type(), leaves,
+                              buffer));
+  }
+
+  std::string LeafCount() const override {
+    if (dslx_bit_count_.has_value()) {
+      return "1";
+    }
+    return TypeHasMethods() ? absl::StrFormat("%s::kLeafCount", cpp_type())
+                            : absl::StrFormat("k%sLeafCount", cpp_type());
+  }
+
   bool TypeHasMethods() const {
     return std::holds_alternative<StructDef*>(
         typeref_type_annotation_->type_ref()->type_definition());
@@ -344,6 +476,8 @@ class TypeRefCppEmitter : public CppEmitter {
   const TypeRefTypeAnnotation* typeref_type_annotation_;
   // Bit-count of the underlying DSLX type if it is a bitvector.
   std::optional<int64_t> dslx_bit_count_;
+  // Signedness of the underlying DSLX type if it is a bitvector.
+  bool is_signed_;
 };
 
 // An emitter for DSLX array types which are represented in C++ using
@@ -465,9 +599,61 @@ class ArrayCppEmitter : public CppEmitter {
                         });
   }
 
+  std::string AssignToJitBuffer(std::string_view buffer,
+                                std::string_view leaf_offsets,
+                                std::string_view first_leaf,
+                                std::string_view rhs,
+                                int64_t nesting) const override {
+    std::string ind_var = absl::StrCat("i", nesting);
+    std::vector<std::string> pieces;
+    pieces.push_back(absl::StrFormat("for (int64_t %s = 0; %s < %d; ++%s) {",
+                                     ind_var, ind_var, array_size(), ind_var));
+    std::string assignment = element_emitter_->AssignToJitBuffer(
+        buffer, leaf_offsets, ElementFirstLeaf(first_leaf, ind_var),
+        absl::StrFormat("%s[%s]", rhs, ind_var), nesting + 1);
+    pieces.push_back(Indent(assignment, 2));
+    pieces.push_back("}");
+    return absl::StrJoin(pieces, "\n");
+  }
+
+  std::string AssignFromJitBuffer(std::string_view lhs,
+                                  std::string_view buffer,
+                                  std::string_view leaf_offsets,
+                                  std::string_view first_leaf,
+                                  int64_t nesting) const override {
+    std::string ind_var = absl::StrCat("i", nesting);
+    std::vector<std::string> pieces;
+    pieces.push_back(absl::StrFormat("for (int64_t %s = 0; %s < %d; ++%s) {",
+                                     ind_var, ind_var, array_size(), ind_var));
+    std::string assignment = element_emitter_->AssignFromJitBuffer(
+        absl::StrFormat("%s[%s]", lhs, ind_var), buffer, leaf_offsets,
+        ElementFirstLeaf(first_leaf, ind_var), nesting + 1);
+    pieces.push_back(Indent(assignment, 2));
+    pieces.push_back("}");
+    return absl::StrJoin(pieces, "\n");
+  }
+
+  std::string LeafCount() const override {
+    std::string element_leaf_count = element_emitter_->LeafCount();
+    int64_t value;
+    if (absl::SimpleAtoi(element_leaf_count, &value)) {
+      return absl::StrCat(array_size() * value);
+    }
+    return absl::StrFormat("%d * (%s)", array_size(), element_leaf_count);
+  }
+
   int64_t array_size() const { return array_size_; }
 
  protected:
+  // Returns a C++ expression for the index of the first leaf of the element
+  // with index `ind_var`.
+  std::string ElementFirstLeaf(std::string_view first_leaf,
+                               std::string_view ind_var) const {
+    return AddCppIntExpressions(
+        first_leaf,
+        MultiplyCppIntExpression(ind_var, element_emitter_->LeafCount()));
+  }
+
   // Emits the C++ code for printing the array using the specified emitter
   // function.
   std::string EmitToString(
@@ -618,6 +804,50 @@ class TupleCppEmitter : public CppEmitter {
     return absl::StrJoin(pieces, "\n");
   }
 
+  std::string AssignToJitBuffer(std::string_view buffer,
+                                std::string_view leaf_offsets,
+                                std::string_view first_leaf,
+                                std::string_view rhs,
+                                int64_t nesting) const override {
+    std::vector<std::string> pieces;
+    std::string element_first_leaf{first_leaf};
+    for (int64_t i = 0; i < size(); ++i) {
+      pieces.push_back(element_emitters_[i]->AssignToJitBuffer(
+          buffer, leaf_offsets, element_first_leaf,
+          absl::StrFormat("std::get<%d>(%s)", i, rhs), nesting + 1));
+      element_first_leaf = AddCppIntExpressions(
+          element_first_leaf, element_emitters_[i]->LeafCount());
+    }
+    return absl::StrJoin(pieces, "\n");
+  }
+
+  std::string AssignFromJitBuffer(std::string_view lhs,
+                                  std::string_view buffer,
+                                  std::string_view leaf_offsets,
+                                  std::string_view first_leaf,
+                                  int64_t nesting) const override {
+    std::vector<std::string> pieces;
+    std::string element_first_leaf{first_leaf};
+    for (int64_t i = 0; i < size(); ++i) {
+      pieces.push_back(element_emitters_[i]->AssignFromJitBuffer(
+          absl::StrFormat("std::get<%d>(%s)", i, lhs), buffer, leaf_offsets,
+          element_first_leaf, nesting + 1));
+      element_first_leaf = AddCppIntExpressions(
+          element_first_leaf, element_emitters_[i]->LeafCount());
+    }
+    return absl::StrJoin(pieces, "\n");
+  }
+
+  std::string LeafCount() const override {
+    std::string leaf_count = "0";
+    for (const std::unique_ptr<CppEmitter>& element_emitter :
+         element_emitters_) {
+      leaf_count =
+          AddCppIntExpressions(leaf_count, element_emitter->LeafCount());
+    }
+    return leaf_count;
+  }
+
   int64_t size() const { return element_emitters_.size(); }
 
  protected:
@@ -630,6 +860,23 @@ std::string DslxTypeNameToCpp(std::string_view dslx_type) {
   return Camelize(dslx_type);
 }
 
+std::string AddCppIntExpressions(std::string_view lhs, std::string_view rhs) {
+  int64_t lhs_value;
+  int64_t rhs_value;
+  bool lhs_is_literal = absl::SimpleAtoi(lhs, &lhs_value);
+  bool rhs_is_literal = absl::SimpleAtoi(rhs, &rhs_value);
+  if (lhs_is_literal && rhs_is_literal) {
+    return absl::StrCat(lhs_value + rhs_value);
+  }
+  if (lhs_is_literal && lhs_value == 0) {
+    return std::string{rhs};
+  }
+  if (rhs_is_literal && rhs_value == 0) {
+    return std::string{lhs};
+  }
+  return absl::StrCat(lhs, " + ", rhs);
+}
+
 /* static */ absl::StatusOr<std::unique_ptr<CppEmitter>> CppEmitter::Create(
     const TypeAnnotation* type_annotation, std::string_view dslx_type,
     TypeInfo* type_info, ImportData* import_data) {
@@ -31,6 +31,10 @@ namespace xls::dslx {
 // Returns the C++ type name used to represent the given DSLX type name.
 std::string DslxTypeNameToCpp(std::string_view dslx_type);
 
+// Returns a C++ expression for the sum of the integer expressions `lhs` and
+// `rhs`. The sum is folded if both are integer literals.
+std::string AddCppIntExpressions(std::string_view lhs, std::string_view rhs);
+
 // A class which handles generation of snippets of C++ code for a particular
 // type which may be represented with a TypeAnnotation (e.g., array, tuple,
 // bit-vector).
@@ -104,6 +108,33 @@ class CppEmitter {
                                    std::string_view identifier,
                                    int64_t nesting) const = 0;
 
+  // Emits and returns c++ code which writes `rhs` of `cpp_type()` to the
+  // `uint8_t*` named `buffer` in the native data layout used by the JIT.
+  // `leaf_offsets` is the name of an `absl::Span<const int64_t>` holding the
+  // byte offset in `buffer` of each leaf (bit vector) of the enclosing type in
+  // the order of xls::TypeLayout::elements(), and `first_leaf` is a C++
+  // expression for the index in `leaf_offsets` of the first leaf of `rhs`.
+  // The value is not verified and bits outside of the DSLX type are dropped.
+  virtual std::string AssignToJitBuffer(std::string_view buffer,
+                                        std::string_view leaf_offsets,
+                                        std::string_view first_leaf,
+                                        std::string_view rhs,
+                                        int64_t nesting) const = 0;
+
+  // Emits and returns c++ code which reads a value of `cpp_type()` from the
+  // `const uint8_t*` named `buffer` in the native data layout used by the JIT
+  // and assigns it to `lhs`. `leaf_offsets` and `first_leaf` are as in
+  // AssignToJitBuffer.
+  virtual std::string AssignFromJitBuffer(std::string_view lhs,
+                                          std::string_view buffer,
+                                          std::string_view leaf_offsets,
+                                          std::string_view first_leaf,
+                                          int64_t nesting) const = 0;
+
+  // Returns a C++ constant expression for the number of leaves (bit vectors)
+  // of the type, i.e., the number of its elements in an xls::TypeLayout.
+  virtual std::string LeafCount() const = 0;
+
   // If the underlying DSLX type is a bit vector then return its bit
   // count. Otherwise return std::nullopt.
   virtual std::optional<int64_t> GetBitCountIfBitVector() const {
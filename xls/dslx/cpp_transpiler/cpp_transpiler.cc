@@ -37,7 +37,8 @@ namespace xls::dslx {
 absl::StatusOr<CppSource> TranspileToCpp(Module* module,
                                          ImportData* import_data,
                                          std::string_view output_header_path,
-                                         std::string_view namespaces) {
+                                         std::string_view namespaces,
+                                         bool jit_buffer_conversions) {
   constexpr std::string_view kHeaderTemplate =
       R"(// AUTOMATICALLY GENERATED FILE FROM `xls/dslx/cpp_transpiler`. DO NOT EDIT!
 #ifndef $0
@@ -49,7 +50,7 @@ absl::StatusOr<CppSource> TranspileToCpp(Module* module,
 #include <vector>
 
 #include "absl/status/statusor.h"
-#include "xls/public/value.h"
+$4#include "xls/public/value.h"
 
 $2$1$3
 
@@ -59,7 +60,7 @@ $2$1$3
   constexpr std::string_view kSourceTemplate =
       R"(// AUTOMATICALLY GENERATED FILE FROM `xls/dslx/cpp_transpiler`. DO NOT EDIT!
 #include <array>
-#include <string>
+%s#include <string>
 #include <vector>
 
 #include "%s"
@@ -93,8 +94,38 @@ static bool FitsInNBitsUnsigned(uint64_t value, int64_t n) {
 static std::string __indent(int64_t amount) {
   return std::string(amount * 2, ' ');
 }
-
+%s
 %s%s%s
+)";
+  // Helpers for reading and writing a bits-typed leaf element in the native
+  // data layout of the JIT: the value in the low bytes in host byte order
+  // (little-endian), zero-extended to the padded size of the element.
+  constexpr std::string_view kJitBufferHelpers = R"(
+static void __WriteJitLeaf(uint64_t value, int64_t bit_count,
+                           int64_t byte_count, uint8_t* buffer) {
+  if (bit_count < 64) {
+    value &= (uint64_t{1} << bit_count) - 1;
+  }
+  int64_t value_bytes = byte_count < 8 ? byte_count : 8;
+  memcpy(buffer, &value, value_bytes);
+  if (byte_count > value_bytes) {
+    memset(buffer + value_bytes, 0, byte_count - value_bytes);
+  }
+}
+
+static uint64_t __ReadJitLeaf(int64_t byte_count, const uint8_t* buffer) {
+  uint64_t value = 0;
+  memcpy(&value, buffer, byte_count < 8 ? byte_count : 8);
+  return value;
+}
+
+static int64_t __SignExtend(uint64_t value, int64_t bit_count) {
+  if (bit_count >= 64) {
+    return static_cast<int64_t>(value);
+  }
+  uint64_t sign_bit = uint64_t{1} << (bit_count - 1);
+  return static_cast<int64_t>((value ^ sign_bit) - sign_bit);
+}
 )";
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
                        import_data->GetRootTypeInfo(module));
@@ -102,7 +133,8 @@ static std::string __indent(int64_t amount) {
   std::vector<std::string> source;
   for (const TypeDefinition& def : module->GetTypeDefinitions()) {
     XLS_ASSIGN_OR_RETURN(std::unique_ptr<CppTypeGenerator> generator,
-                         CppTypeGenerator::Create(def, type_info, import_data));
+                         CppTypeGenerator::Create(def, type_info, import_data,
+                                                  jit_buffer_conversions));
     XLS_ASSIGN_OR_RETURN(CppSource result, generator->GetCppSource());
     header.push_back(result.header);
     source.push_back(result.source);
@@ -126,11 +158,16 @@ static std::string __indent(int64_t amount) {
   }
 
   return CppSource{
-      absl::Substitute(kHeaderTemplate, header_guard,
-                       absl::StrJoin(header, "\n\n"), namespace_begin,
-                       namespace_end),
-      absl::StrFormat(kSourceTemplate, output_header_path, namespace_begin,
-                      absl::StrJoin(source, "\n\n"), namespace_end)};
+      absl::Substitute(
+          kHeaderTemplate, header_guard, absl::StrJoin(header, "\n\n"),
+          namespace_begin, namespace_end,
+          jit_buffer_conversions ? "#include \"absl/types/span.h\"\n" : ""),
+      absl::StrFormat(kSourceTemplate,
+                      jit_buffer_conversions ? "#include <cstring>\n" : "",
+                      output_header_path,
+                      jit_buffer_conversions ? kJitBufferHelpers : "",
+                      namespace_begin, absl::StrJoin(source, "\n\n"),
+                      namespace_end)};
 }
 
 }  // namespace xls::dslx
@@ -38,10 +38,17 @@ namespace xls::dslx {
 // should be infrequent, so users should feel comfortable using these
 // interfaces, but should also be aware of the potential for change in the
 // future.
+//
+// If `jit_buffer_conversions` is true, structs and type aliases additionally
+// get `ToJitBuffer`/`FromJitBuffer` functions which write and read the native
+// data layout used by the JIT directly, given the byte offset of each leaf
+// element (see xls::TypeLayout). This avoids building an xls::Value when
+// passing arguments to and results from a JIT-compiled function.
 absl::StatusOr<CppSource> TranspileToCpp(Module* module,
                                          ImportData* import_data,
                                          std::string_view output_header_path,
-                                         std::string_view namespaces = "");
+                                         std::string_view namespaces = "",
+                                         bool jit_buffer_conversions = false);
 
 }  // namespace xls::dslx
 
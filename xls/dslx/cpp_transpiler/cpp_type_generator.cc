@@ -54,6 +54,17 @@ absl::StatusOr<InterpValue> InterpretExpr(
   return BytecodeInterpreter::Interpret(import_data, bf.get(), /*args=*/{});
 }
 
+// Returns C++ code which returns an error if the span `leaf_offsets` does not
+// have `leaf_count` elements.
+std::string LeafOffsetsCheck(std::string_view leaf_count) {
+  return absl::StrFormat(
+      "if (static_cast<int64_t>(leaf_offsets.size()) != %s) {\n"
+      "  return absl::InvalidArgumentError(absl::StrFormat(\"Expected %%d leaf "
+      "offsets, got %%d.\", %s, leaf_offsets.size()));\n"
+      "}",
+      leaf_count, leaf_count);
+}
+
 // A type generator for emitting a C++ enum representing a dslx::EnumDef.
 class EnumCppTypeGenerator : public CppTypeGenerator {
  public:
@@ -301,12 +312,22 @@ class TypeAliasCppTypeGenerator : public CppTypeGenerator {
     hdr_pieces.push_back(to_dslx_string_src.header);
     hdr_pieces.push_back(to_value_src.header);
     hdr_pieces.push_back(from_value_src.header);
-    return CppSource{
-        .header = absl::StrJoin(hdr_pieces, "\n"),
-        .source = absl::StrJoin(
-            {verify_src.source, to_string_src.source, to_dslx_string_src.source,
-             to_value_src.source, from_value_src.source},
-            "\n\n")};
+    std::vector<std::string> src_pieces = {
+        verify_src.source, to_string_src.source, to_dslx_string_src.source,
+        to_value_src.source, from_value_src.source};
+    if (emit_jit_buffer_conversions_) {
+      CppSource to_jit_buffer_src = ToJitBufferFunction();
+      CppSource from_jit_buffer_src = FromJitBufferFunction();
+      hdr_pieces.push_back(
+          absl::StrFormat("constexpr int64_t k%sLeafCount = %s;", cpp_type(),
+                          emitter_->LeafCount()));
+      hdr_pieces.push_back(to_jit_buffer_src.header);
+      hdr_pieces.push_back(from_jit_buffer_src.header);
+      src_pieces.push_back(to_jit_buffer_src.source);
+      src_pieces.push_back(from_jit_buffer_src.source);
+    }
+    return CppSource{.header = absl::StrJoin(hdr_pieces, "\n"),
+                     .source = absl::StrJoin(src_pieces, "\n\n")};
   }
 
  protected:
@@ -406,6 +427,45 @@ class TypeAliasCppTypeGenerator : public CppTypeGenerator {
         .source = absl::StrFormat("%s {\n%s\n}", signature, Indent(body, 2))};
   }
 
+  CppSource ToJitBufferFunction() const {
+    std::string signature = absl::StrFormat(
+        "absl::Status %sToJitBuffer(%s, absl::Span<const int64_t> "
+        "leaf_offsets, uint8_t* buffer)",
+        cpp_type(), GetValueParameter("value"));
+    std::vector<std::string> pieces;
+    pieces.push_back(
+        LeafOffsetsCheck(absl::StrFormat("k%sLeafCount", cpp_type())));
+    pieces.push_back(
+        absl::StrFormat("XLS_RETURN_IF_ERROR(Verify%s(value));", cpp_type()));
+    pieces.push_back(emitter_->AssignToJitBuffer("buffer", "leaf_offsets", "0",
+                                                 "value", /*nesting=*/0));
+    pieces.push_back("return absl::OkStatus();");
+    std::string body = absl::StrJoin(pieces, "\n");
+    return CppSource{
+        .header = absl::StrCat(signature, ";"),
+        .source = absl::StrFormat("%s {\n%s\n}", signature, Indent(body, 2))};
+  }
+
+  CppSource FromJitBufferFunction() const {
+    std::string signature = absl::StrFormat(
+        "absl::StatusOr<%s> %sFromJitBuffer(absl::Span<const int64_t> "
+        "leaf_offsets, const uint8_t* buffer)",
+        cpp_type(), cpp_type());
+    std::vector<std::string> pieces;
+    pieces.push_back(
+        LeafOffsetsCheck(absl::StrFormat("k%sLeafCount", cpp_type())));
+    pieces.push_back(absl::StrFormat("%s result;", cpp_type()));
+    pieces.push_back(emitter_->AssignFromJitBuffer(
+        "result", "buffer", "leaf_offsets", "0", /*nesting=*/0));
+    pieces.push_back(
+        absl::StrFormat("XLS_RETURN_IF_ERROR(Verify%s(result));", cpp_type()));
+    pieces.push_back("return result;");
+    std::string body = absl::StrJoin(pieces, "\n");
+    return CppSource{
+        .header = absl::StrCat(signature, ";"),
+        .source = absl::StrFormat("%s {\n%s\n}", signature, Indent(body, 2))};
+  }
+
   std::unique_ptr<CppEmitter> emitter_;
 };
 
@@ -464,6 +524,10 @@ class StructCppTypeGenerator : public CppTypeGenerator {
     hdr_pieces.insert(hdr_pieces.end(), member_decls.begin(),
                       member_decls.end());
     hdr_pieces.push_back("");
+    if (emit_jit_buffer_conversions_) {
+      scalar_widths.push_back(absl::StrFormat(
+          "static constexpr int64_t kLeafCount = %s;", LeafCount()));
+    }
     if (!scalar_widths.empty()) {
       hdr_pieces.insert(hdr_pieces.end(), scalar_widths.begin(),
                         scalar_widths.end());
@@ -471,6 +535,16 @@ class StructCppTypeGenerator : public CppTypeGenerator {
     }
     hdr_pieces.push_back(from_value_method.header);
     hdr_pieces.push_back(to_value_method.header);
+    std::vector<std::string> src_pieces = {from_value_method.source,
+                                           to_value_method.source};
+    if (emit_jit_buffer_conversions_) {
+      CppSource from_jit_buffer_method = FromJitBufferMethod();
+      CppSource to_jit_buffer_method = ToJitBufferMethod();
+      hdr_pieces.push_back(from_jit_buffer_method.header);
+      hdr_pieces.push_back(to_jit_buffer_method.header);
+      src_pieces.push_back(from_jit_buffer_method.source);
+      src_pieces.push_back(to_jit_buffer_method.source);
+    }
     hdr_pieces.push_back(to_string_method.header);
     hdr_pieces.push_back(to_dslx_string_method.header);
     hdr_pieces.push_back(verify_method.header);
@@ -484,12 +558,12 @@ class StructCppTypeGenerator : public CppTypeGenerator {
 
     std::string header =
         absl::StrFormat("struct %s {\n%s\n};", cpp_type(), Indent(members, 2));
-    std::string source =
-        absl::StrJoin({from_value_method.source, to_value_method.source,
-                       to_string_method.source, to_dslx_string_method.source,
-                       verify_method.source, operator_eq_method.source,
-                       operator_stream_method.source},
-                      "\n\n");
+    src_pieces.insert(
+        src_pieces.end(),
+        {to_string_method.source, to_dslx_string_method.source,
+         verify_method.source, operator_eq_method.source,
+         operator_stream_method.source});
+    std::string source = absl::StrJoin(src_pieces, "\n\n");
     return CppSource{.header = header, .source = source};
   }
 
@@ -544,6 +618,67 @@ class StructCppTypeGenerator : public CppTypeGenerator {
             cpp_type(), Indent(body, 2))};
   }
 
+  // Returns a C++ expression for the number of leaves of the struct.
+  std::string LeafCount() const {
+    std::string leaf_count = "0";
+    for (const std::unique_ptr<CppEmitter>& emitter : member_emitters_) {
+      leaf_count = AddCppIntExpressions(leaf_count, emitter->LeafCount());
+    }
+    return leaf_count;
+  }
+
+  CppSource FromJitBufferMethod() const {
+    std::vector<std::string> pieces;
+    pieces.push_back(LeafOffsetsCheck("kLeafCount"));
+    pieces.push_back(absl::StrFormat("%s result;", cpp_type()));
+    std::string first_leaf = "0";
+    for (int i = 0; i < struct_def_->members().size(); i++) {
+      pieces.push_back(member_emitters_[i]->AssignFromJitBuffer(
+          /*lhs=*/absl::StrFormat("result.%s", struct_def_->GetMemberName(i)),
+          "buffer", "leaf_offsets", first_leaf, /*nesting=*/0));
+      first_leaf =
+          AddCppIntExpressions(first_leaf, member_emitters_[i]->LeafCount());
+    }
+    pieces.push_back("XLS_RETURN_IF_ERROR(result.Verify());");
+    pieces.push_back("return result;");
+    std::string body = absl::StrJoin(pieces, "\n");
+
+    return CppSource{
+        .header = absl::StrFormat(
+            "static absl::StatusOr<%s> FromJitBuffer("
+            "absl::Span<const int64_t> leaf_offsets, const uint8_t* buffer);",
+            cpp_type()),
+        .source = absl::StrFormat(
+            "absl::StatusOr<%s> %s::FromJitBuffer("
+            "absl::Span<const int64_t> leaf_offsets, const uint8_t* buffer) "
+            "{\n%s\n}",
+            cpp_type(), cpp_type(), Indent(body, 2))};
+  }
+
+  CppSource ToJitBufferMethod() const {
+    std::vector<std::string> pieces;
+    pieces.push_back(LeafOffsetsCheck("kLeafCount"));
+    pieces.push_back("XLS_RETURN_IF_ERROR(Verify());");
+    std::string first_leaf = "0";
+    for (int i = 0; i < struct_def_->members().size(); i++) {
+      pieces.push_back(member_emitters_[i]->AssignToJitBuffer(
+          "buffer", "leaf_offsets", first_leaf,
+          /*rhs=*/struct_def_->GetMemberName(i), /*nesting=*/0));
+      first_leaf =
+          AddCppIntExpressions(first_leaf, member_emitters_[i]->LeafCount());
+    }
+    pieces.push_back("return absl::OkStatus();");
+    std::string body = absl::StrJoin(pieces, "\n");
+
+    return CppSource{
+        .header = "absl::Status ToJitBuffer(absl::Span<const int64_t> "
+                  "leaf_offsets, uint8_t* buffer) const;",
+        .source = absl::StrFormat(
+            "absl::Status %s::ToJitBuffer(absl::Span<const int64_t> "
+            "leaf_offsets, uint8_t* buffer) const {\n%s\n}",
+            cpp_type(), Indent(body, 2))};
+  }
+
   CppSource VerifyMethod() const {
     std::vector<std::string> pieces;
     for (int i = 0; i < struct_def_->members().size(); i++) {
@@ -656,29 +791,34 @@ class StructCppTypeGenerator : public CppTypeGenerator {
 
 /* static */ absl::StatusOr<std::unique_ptr<CppTypeGenerator>>
 CppTypeGenerator::Create(const TypeDefinition& type_definition,
-                         TypeInfo* type_info, ImportData* import_data) {
-  return absl::visit(
-      Visitor{[&](const TypeAlias* type_alias)
-                  -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
-                return TypeAliasCppTypeGenerator::Create(type_alias, type_info,
-                                                         import_data);
-              },
-              [&](const StructDef* struct_def)
-                  -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
-                return StructCppTypeGenerator::Create(struct_def, type_info,
-                                                      import_data);
-              },
-              [&](const EnumDef* enum_def)
-                  -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
-                return EnumCppTypeGenerator::Create(enum_def, type_info,
-                                                    import_data);
-              },
-              [&](const ColonRef* colon_ref)
-                  -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
-                return absl::UnimplementedError(absl::StrFormat(
-                    "Unsupported type: %s", colon_ref->ToString()));
-              }},
-      type_definition);
+                         TypeInfo* type_info, ImportData* import_data,
+                         bool emit_jit_buffer_conversions) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<CppTypeGenerator> generator,
+      absl::visit(
+          Visitor{[&](const TypeAlias* type_alias)
+                      -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
+                    return TypeAliasCppTypeGenerator::Create(
+                        type_alias, type_info, import_data);
+                  },
+                  [&](const StructDef* struct_def)
+                      -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
+                    return StructCppTypeGenerator::Create(struct_def, type_info,
+                                                          import_data);
+                  },
+                  [&](const EnumDef* enum_def)
+                      -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
+                    return EnumCppTypeGenerator::Create(enum_def, type_info,
+                                                        import_data);
+                  },
+                  [&](const ColonRef* colon_ref)
+                      -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
+                    return absl::UnimplementedError(absl::StrFormat(
+                        "Unsupported type: %s", colon_ref->ToString()));
+                  }},
+          type_definition));
+  generator->emit_jit_buffer_conversions_ = emit_jit_buffer_conversions;
+  return generator;
 }
 
 }  // namespace xls::dslx
@@ -52,14 +52,18 @@ class CppTypeGenerator {
   // not a tuple or array).
   std::string dslx_type() const { return dslx_type_; }
 
-  // Returns a type generator for the given TypeDefinition.
+  // Returns a type generator for the given TypeDefinition. If
+  // `emit_jit_buffer_conversions` is true, structs and type aliases also get
+  // functions converting directly to and from the native data layout used by
+  // the JIT (see CppEmitter::AssignToJitBuffer).
   static absl::StatusOr<std::unique_ptr<CppTypeGenerator>> Create(
       const TypeDefinition& type_definition, TypeInfo* type_info,
-      ImportData* import_data);
+      ImportData* import_data, bool emit_jit_buffer_conversions = false);
 
  protected:
   std::string cpp_type_;
   std::string dslx_type_;
+  bool emit_jit_buffer_conversions_ = false;
 };
 
 }  // namespace xls::dslx
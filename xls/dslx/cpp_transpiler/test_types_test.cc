@@ -12,13 +12,23 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/cpp_transpiler/test_types_lib.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 namespace {
@@ -27,6 +37,22 @@ using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
 using testing::HasSubstr;
 
+// Returns the native layout used by the JIT for the type of `value`.
+TypeLayout CreateTypeLayout(Package* package, const Value& value) {
+  std::unique_ptr<OrcJit> orc_jit = OrcJit::Create().value();
+  LlvmTypeConverter type_converter(orc_jit->GetContext(),
+                                   orc_jit->CreateDataLayout().value());
+  return type_converter.CreateTypeLayout(package->GetTypeForValue(value));
+}
+
+std::vector<int64_t> LeafOffsets(const TypeLayout& layout) {
+  std::vector<int64_t> offsets;
+  for (const ElementLayout& element : layout.elements()) {
+    offsets.push_back(element.offset);
+  }
+  return offsets;
+}
+
 TEST(TestTypesTest, EnumToString) {
   EXPECT_EQ(MyEnumToString(test::MyEnum::kA), "MyEnum::kA (0)");
   EXPECT_EQ(MyEnumToString(test::MyEnum::kB), "MyEnum::kB (1)");
@@ -618,5 +644,83 @@ TEST(TestTypesTest, SnakeCaseToString) {
 })");
 }
 
+TEST(TestTypesTest, StructToAndFromJitBuffer) {
+  test::InnerStruct a{.x = 42, .y = test::MyEnum::kB};
+  test::InnerStruct b{.x = 123, .y = test::MyEnum::kC};
+  test::OuterStruct o{.a = a, .b = b, .c = 0xdead, .v = test::MyEnum::kA};
+  test::OuterOuterStruct s{
+      .q = test::EmptyStruct(), .some_array = {1, 2, 3}, .s = o};
+  XLS_ASSERT_OK_AND_ASSIGN(Value value, s.ToValue());
+
+  Package package("test");
+  TypeLayout layout = CreateTypeLayout(&package, value);
+  std::vector<int64_t> leaf_offsets = LeafOffsets(layout);
+  ASSERT_EQ(leaf_offsets.size(), test::OuterOuterStruct::kLeafCount);
+
+  // Fill the buffer with garbage to check that padding bytes are written.
+  std::vector<uint8_t> buffer(layout.size(), 0xff);
+  XLS_ASSERT_OK(s.ToJitBuffer(leaf_offsets, buffer.data()));
+  EXPECT_EQ(layout.NativeLayoutToValue(buffer.data()), value);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      test::OuterOuterStruct s_copy,
+      test::OuterOuterStruct::FromJitBuffer(leaf_offsets, buffer.data()));
+  EXPECT_EQ(s, s_copy);
+}
+
+TEST(TestTypesTest, SignedTupleToAndFromJitBuffer) {
+  test::MyTupleOfTuples t{2, {42, -3, 123, -1}};
+  XLS_ASSERT_OK_AND_ASSIGN(Value value, test::MyTupleOfTuplesToValue(t));
+
+  Package package("test");
+  TypeLayout layout = CreateTypeLayout(&package, value);
+  std::vector<int64_t> leaf_offsets = LeafOffsets(layout);
+  ASSERT_EQ(leaf_offsets.size(), test::kMyTupleOfTuplesLeafCount);
+
+  std::vector<uint8_t> buffer(layout.size(), 0xff);
+  XLS_ASSERT_OK(
+      test::MyTupleOfTuplesToJitBuffer(t, leaf_offsets, buffer.data()));
+  EXPECT_EQ(layout.NativeLayoutToValue(buffer.data()), value);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      test::MyTupleOfTuples t_copy,
+      test::MyTupleOfTuplesFromJitBuffer(leaf_offsets, buffer.data()));
+  EXPECT_EQ(t, t_copy);
+}
+
+TEST(TestTypesTest, ArrayOfTuplesToAndFromJitBuffer) {
+  test::MyTupleArray t{{{1, 2, 3, -4}, {5, -6, 7, 8}}};
+  XLS_ASSERT_OK_AND_ASSIGN(Value value, test::MyTupleArrayToValue(t));
+
+  Package package("test");
+  TypeLayout layout = CreateTypeLayout(&package, value);
+  std::vector<int64_t> leaf_offsets = LeafOffsets(layout);
+  ASSERT_EQ(leaf_offsets.size(), test::kMyTupleArrayLeafCount);
+
+  std::vector<uint8_t> buffer(layout.size(), 0xff);
+  XLS_ASSERT_OK(test::MyTupleArrayToJitBuffer(t, leaf_offsets, buffer.data()));
+  EXPECT_EQ(layout.NativeLayoutToValue(buffer.data()), value);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      test::MyTupleArray t_copy,
+      test::MyTupleArrayFromJitBuffer(leaf_offsets, buffer.data()));
+  EXPECT_EQ(t, t_copy);
+}
+
+TEST(TestTypesTest, ToJitBufferVerifiesValue) {
+  test::InnerStruct s{.x = 1234567, .y = test::MyEnum::kC};
+  std::vector<int64_t> leaf_offsets = {0, 4};
+  std::vector<uint8_t> buffer(8);
+  EXPECT_THAT(
+      s.ToJitBuffer(leaf_offsets, buffer.data()),
+      StatusIs(
+          absl::StatusCode::kInvalidArgument,
+          HasSubstr("InnerStruct.x value does not fit in 17 bits: 0x12d687")));
+  EXPECT_THAT(s.ToJitBuffer(absl::MakeConstSpan(leaf_offsets).subspan(1),
+                            buffer.data()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Expected 2 leaf offsets, got 1.")));
+}
+
 }  // namespace
 }  // namespace xls
@@ -35,6 +35,17 @@ ImportData CreateImportData(
   return import_data;
 }
 
+std::unique_ptr<ImportData> CreateImportDataPtr(
+    const std::filesystem::path& stdlib_path,
+    absl::Span<const std::filesystem::path> additional_search_paths,
+    WarningKindSet warnings) {
+  auto import_data = absl::WrapUnique(
+      new ImportData(stdlib_path, additional_search_paths, warnings));
+  import_data->SetBytecodeCache(
+      std::make_unique<BytecodeCache>(import_data.get()));
+  return import_data;
+}
+
 ImportData CreateImportDataForTest() {
   ImportData import_data(xls::kDefaultDslxStdlibPath,
                          /*additional_search_paths=*/{}, kDefaultWarningsSet);
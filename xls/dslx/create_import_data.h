@@ -34,6 +34,13 @@ ImportData CreateImportData(
     absl::Span<const std::filesystem::path> additional_search_paths,
     WarningKindSet warnings);
 
+// As above, but heap-allocated so that the bytecode cache (which refers back
+// to the ImportData) remains valid when the pointer is moved around.
+std::unique_ptr<ImportData> CreateImportDataPtr(
+    const std::filesystem::path& stdlib_path,
+    absl::Span<const std::filesystem::path> additional_search_paths,
+    WarningKindSet warnings);
+
 // Creates an ImportData with reasonable defaults (standard path to the stdlib
 // and no additional search paths).
 ImportData CreateImportDataForTest();
@@ -2168,115 +2168,133 @@ static bool AreGroupedMembers(const ModuleMember& above,
   return above_effective_lineno + 1 == below_member->span().start().lineno();
 }
 
-DocRef Fmt(const Module& n, const Comments& comments, DocArena& arena) {
-  std::vector<DocRef> pieces;
-
-  if (!n.annotations().empty()) {
-    for (ModuleAnnotation annotation : n.annotations()) {
-      switch (annotation) {
-        case ModuleAnnotation::kAllowNonstandardConstantNaming:
-          pieces.push_back(
-              arena.MakeText("#![allow(nonstandard_constant_naming)]"));
-          pieces.push_back(arena.hard_line());
-          break;
-        case ModuleAnnotation::kAllowNonstandardMemberNaming:
-          pieces.push_back(
-              arena.MakeText("#![allow(nonstandard_member_naming)]"));
-          pieces.push_back(arena.hard_line());
-          break;
-      }
+// Emits the module-level annotations of "n" (if any) into "pieces".
+static void FmtModuleAnnotations(const Module& n, DocArena& arena,
+                                 std::vector<DocRef>& pieces) {
+  if (n.annotations().empty()) {
+    return;
+  }
+  for (ModuleAnnotation annotation : n.annotations()) {
+    switch (annotation) {
+      case ModuleAnnotation::kAllowNonstandardConstantNaming:
+        pieces.push_back(
+            arena.MakeText("#![allow(nonstandard_constant_naming)]"));
+        pieces.push_back(arena.hard_line());
+        break;
+      case ModuleAnnotation::kAllowNonstandardMemberNaming:
+        pieces.push_back(
+            arena.MakeText("#![allow(nonstandard_member_naming)]"));
+        pieces.push_back(arena.hard_line());
+        break;
     }
-    pieces.push_back(arena.hard_line());
   }
+  pieces.push_back(arena.hard_line());
+}
 
-  std::optional<Pos> last_entity_pos;
-  for (size_t i = 0; i < n.top().size(); ++i) {
-    const auto& member = n.top()[i];
+// Emits the "i"th top-level member of "n" into "pieces" along with the comments
+// between it and the previous member, any inline comment that trails it, and
+// the line breaks that separate it from the next member.
+//
+// "last_entity_pos" is the limit of the last emitted entity and is updated to
+// reflect the emission of this member.
+//
+// Note that the emitted pieces always end in a hard line break at indent zero,
+// so each member can be pretty printed independently of the others.
+static void FmtModuleMember(const Module& n, size_t i,
+                            const Comments& comments, DocArena& arena,
+                            std::optional<Pos>& last_entity_pos,
+                            std::vector<DocRef>& pieces) {
+  const auto& member = n.top()[i];
 
-    const AstNode* node = ToAstNode(member);
+  const AstNode* node = ToAstNode(member);
 
-    // If this is a desugared proc function, we skip it, and handle formatting
-    // it when we get to the proc node.
-    if (const Function* f = dynamic_cast<const Function*>(node);
-        f != nullptr && f->tag() != FunctionTag::kNormal) {
-      continue;
-    }
+  // If this is a desugared proc function, we skip it, and handle formatting
+  // it when we get to the proc node.
+  if (const Function* f = dynamic_cast<const Function*>(node);
+      f != nullptr && f->tag() != FunctionTag::kNormal) {
+    return;
+  }
 
-    VLOG(3) << "Fmt; " << node->GetNodeTypeName()
-            << " module member: " << node->ToString();
+  VLOG(3) << "Fmt; " << node->GetNodeTypeName()
+          << " module member: " << node->ToString();
 
-    // If there are comment blocks between the last member position and the
-    // member we're about the process, we need to emit them.
-    std::optional<Span> member_span = node->GetSpan();
-    CHECK(member_span.has_value()) << node->GetNodeTypeName();
-    const Pos& member_start = member_span->start();
-    const Pos& member_limit = member_span->limit();
+  // If there are comment blocks between the last member position and the
+  // member we're about the process, we need to emit them.
+  std::optional<Span> member_span = node->GetSpan();
+  CHECK(member_span.has_value()) << node->GetNodeTypeName();
+  const Pos& member_start = member_span->start();
+  const Pos& member_limit = member_span->limit();
 
-    // Check the start of this member is >= the last member limit.
-    if (last_entity_pos.has_value()) {
-      CHECK_GE(member_start, last_entity_pos.value()) << node->ToString();
-    }
+  // Check the start of this member is >= the last member limit.
+  if (last_entity_pos.has_value()) {
+    CHECK_GE(member_start, last_entity_pos.value()) << node->ToString();
+  }
 
-    std::optional<Span> last_comment_span;
-    if (std::optional<DocRef> comments_doc =
-            EmitCommentsBetween(last_entity_pos, member_start, comments, arena,
-                                &last_comment_span)) {
-      pieces.push_back(comments_doc.value());
-      pieces.push_back(arena.hard_line());
+  std::optional<Span> last_comment_span;
+  if (std::optional<DocRef> comments_doc =
+          EmitCommentsBetween(last_entity_pos, member_start, comments, arena,
+                              &last_comment_span)) {
+    pieces.push_back(comments_doc.value());
+    pieces.push_back(arena.hard_line());
 
-      VLOG(3) << "last_comment_span: " << last_comment_span.value()
-              << " this member start: " << member_start;
+    VLOG(3) << "last_comment_span: " << last_comment_span.value()
+            << " this member start: " << member_start;
 
-      // If the comment abuts the module member we don't put a newline in
-      // between, we assume the comment is associated with the member.
-      if (last_comment_span->limit().lineno() != member_start.lineno()) {
-        pieces.push_back(arena.hard_line());
-      }
+    // If the comment abuts the module member we don't put a newline in
+    // between, we assume the comment is associated with the member.
+    if (last_comment_span->limit().lineno() != member_start.lineno()) {
+      pieces.push_back(arena.hard_line());
     }
+  }
 
-    // Check the last member position is monotonically increasing.
-    if (last_entity_pos.has_value()) {
-      CHECK_GT(member_span->limit(), last_entity_pos.value());
-    }
+  // Check the last member position is monotonically increasing.
+  if (last_entity_pos.has_value()) {
+    CHECK_GT(member_span->limit(), last_entity_pos.value());
+  }
 
-    // Here we actually emit the formatted member.
-    pieces.push_back(Fmt(member, comments, arena));
+  // Here we actually emit the formatted member.
+  pieces.push_back(Fmt(member, comments, arena));
 
-    // Now we reflect the emission of the member.
-    last_entity_pos = member_span->limit();
+  // Now we reflect the emission of the member.
+  last_entity_pos = member_span->limit();
 
-    // See if there are inline comments after the statement.
-    const Pos next_line(member_limit.filename(), member_limit.lineno() + 1, 0);
-    if (std::optional<DocRef> comments_doc = EmitCommentsBetween(
-            last_entity_pos, next_line, comments, arena, &last_comment_span)) {
-      VLOG(3) << "Saw after-statement comment: "
-              << arena.ToDebugString(comments_doc.value())
-              << " last_comment_span: " << last_comment_span.value();
-      pieces.push_back(arena.space());
-      pieces.push_back(arena.space());
-      pieces.push_back(arena.MakeAlign(comments_doc.value()));
+  // See if there are inline comments after the statement.
+  const Pos next_line(member_limit.filename(), member_limit.lineno() + 1, 0);
+  if (std::optional<DocRef> comments_doc = EmitCommentsBetween(
+          last_entity_pos, next_line, comments, arena, &last_comment_span)) {
+    VLOG(3) << "Saw after-statement comment: "
+            << arena.ToDebugString(comments_doc.value())
+            << " last_comment_span: " << last_comment_span.value();
+    pieces.push_back(arena.space());
+    pieces.push_back(arena.space());
+    pieces.push_back(arena.MakeAlign(comments_doc.value()));
 
-      last_entity_pos = AdjustCommentLimit(last_comment_span.value(), arena,
-                                           comments_doc.value());
-    }
+    last_entity_pos = AdjustCommentLimit(last_comment_span.value(), arena,
+                                         comments_doc.value());
+  }
 
-    if (i + 1 == n.top().size()) {
-      // For the last module member we just put a trailing newline at EOF.
-      pieces.push_back(arena.hard_line());
-    } else if (AreGroupedMembers<Import>(member, n.top()[i + 1]) ||
-               AreGroupedMembers<TypeAlias>(member, n.top()[i + 1]) ||
-               AreGroupedMembers<StructDef>(member, n.top()[i + 1]) ||
-               AreGroupedMembers<ConstantDef>(member, n.top()[i + 1])) {
-      // If two (e.g. imports) are adjacent to each other (i.e. no intervening
-      // newline) we keep them adjacent to each other in the formatted output.
-      pieces.push_back(arena.hard_line());
-    } else {
-      // For other module members we separate them by an intervening newline.
-      pieces.push_back(arena.hard_line());
-      pieces.push_back(arena.hard_line());
-    }
+  if (i + 1 == n.top().size()) {
+    // For the last module member we just put a trailing newline at EOF.
+    pieces.push_back(arena.hard_line());
+  } else if (AreGroupedMembers<Import>(member, n.top()[i + 1]) ||
+             AreGroupedMembers<TypeAlias>(member, n.top()[i + 1]) ||
+             AreGroupedMembers<StructDef>(member, n.top()[i + 1]) ||
+             AreGroupedMembers<ConstantDef>(member, n.top()[i + 1])) {
+    // If two (e.g. imports) are adjacent to each other (i.e. no intervening
+    // newline) we keep them adjacent to each other in the formatted output.
+    pieces.push_back(arena.hard_line());
+  } else {
+    // For other module members we separate them by an intervening newline.
+    pieces.push_back(arena.hard_line());
+    pieces.push_back(arena.hard_line());
   }
+}
 
+// Emits the comments that follow the last module member into "pieces".
+static void FmtModuleTrailingComments(const Comments& comments,
+                                      const std::optional<Pos>& last_entity_pos,
+                                      DocArena& arena,
+                                      std::vector<DocRef>& pieces) {
   if (std::optional<Pos> last_data_limit = comments.last_data_limit();
       last_data_limit.has_value() && last_entity_pos < last_data_limit) {
     std::optional<Span> last_comment_span;
@@ -2287,15 +2305,77 @@ DocRef Fmt(const Module& n, const Comments& comments, DocArena& arena) {
       pieces.push_back(arena.hard_line());
     }
   }
+}
 
+DocRef Fmt(const Module& n, const Comments& comments, DocArena& arena) {
+  std::vector<DocRef> pieces;
+  FmtModuleAnnotations(n, arena, pieces);
+
+  std::optional<Pos> last_entity_pos;
+  for (size_t i = 0; i < n.top().size(); ++i) {
+    FmtModuleMember(n, i, comments, arena, last_entity_pos, pieces);
+  }
+
+  FmtModuleTrailingComments(comments, last_entity_pos, arena, pieces);
   return ConcatN(arena, pieces);
 }
 
 std::string AutoFmt(const Module& m, const Comments& comments,
                     int64_t text_width) {
-  DocArena arena;
-  DocRef ref = Fmt(m, comments, arena);
-  return PrettyPrint(arena, ref, text_width);
+  // Rather than building a single doc for the whole module we print the module
+  // a top-level member at a time, each with its own arena -- every member ends
+  // with a hard line break at indent zero, so the result is the same as
+  // printing Fmt(m), but memory use is bounded by the largest member instead of
+  // the size of the module.
+  std::string result;
+  std::vector<DocRef> pieces;
+  auto print = [&](const std::function<void(DocArena&)>& fmt) {
+    DocArena arena;
+    pieces.clear();
+    fmt(arena);
+    PrettyPrintTo(arena, ConcatN(arena, pieces), text_width, result);
+  };
+
+  print([&](DocArena& arena) { FmtModuleAnnotations(m, arena, pieces); });
+  std::optional<Pos> last_entity_pos;
+  for (size_t i = 0; i < m.top().size(); ++i) {
+    print([&](DocArena& arena) {
+      FmtModuleMember(m, i, comments, arena, last_entity_pos, pieces);
+    });
+  }
+  print([&](DocArena& arena) {
+    FmtModuleTrailingComments(comments, last_entity_pos, arena, pieces);
+  });
+  return result;
+}
+
+std::vector<AutoFmtEdit> AutoFmtRange(const Module& m,
+                                      const Comments& comments,
+                                      const Span& range, int64_t text_width) {
+  std::vector<AutoFmtEdit> edits;
+  for (const ModuleMember& member : m.top()) {
+    const AstNode* node = ToAstNode(member);
+    // Desugared proc functions are formatted as part of their proc.
+    if (const Function* f = dynamic_cast<const Function*>(node);
+        f != nullptr && f->tag() != FunctionTag::kNormal) {
+      continue;
+    }
+    std::optional<Span> member_span = node->GetSpan();
+    CHECK(member_span.has_value()) << node->GetNodeTypeName();
+    // Members are sorted by position, so we can stop at the first one that
+    // starts after the range.
+    if (range.limit() < member_span->start()) {
+      break;
+    }
+    if (member_span->limit() < range.start()) {
+      continue;
+    }
+    DocArena arena;
+    edits.push_back(AutoFmtEdit{
+        .span = member_span.value(),
+        .text = PrettyPrint(arena, Fmt(member, comments, arena), text_width)});
+  }
+  return edits;
 }
 
 // AutoFmt output should be the same as input after whitespace is eliminated
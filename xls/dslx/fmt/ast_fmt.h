@@ -83,6 +83,22 @@ inline constexpr int64_t kDslxDefaultTextWidth = 100;
 std::string AutoFmt(const Module& m, const Comments& comments,
                     int64_t text_width = kDslxDefaultTextWidth);
 
+// A replacement of the original text in "span" by "text".
+struct AutoFmtEdit {
+  Span span;
+  std::string text;
+};
+
+// Range-formatting entry point.
+//
+// Formats only the top-level members of "m" that intersect "range" (e.g. the
+// lines changed in an editor), returning one edit per member that replaces the
+// member's span. The text around the members -- comments between members,
+// blank lines, etc. -- is left as is.
+std::vector<AutoFmtEdit> AutoFmtRange(
+    const Module& m, const Comments& comments, const Span& range,
+    int64_t text_width = kDslxDefaultTextWidth);
+
 // If we fail the postcondition we return back the data we used to detect that
 // the postcondition was violated.
 struct AutoFmtPostconditionViolation {
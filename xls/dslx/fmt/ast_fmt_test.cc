@@ -36,6 +36,7 @@
 #include "xls/dslx/frontend/bindings.h"
 #include "xls/dslx/frontend/comment_data.h"
 #include "xls/dslx/frontend/parser.h"
+#include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/frontend/scanner.h"
 #include "xls/dslx/parse_and_typecheck.h"
 
@@ -934,7 +935,14 @@ class ModuleFmtTest : public testing::Test {
     std::vector<CommentData> comments;
     XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Module> m,
                              ParseModule(input, "fake.x", "fake", &comments));
-    std::string got = AutoFmt(*m, Comments::Create(comments), text_width);
+    const Comments comments_data = Comments::Create(comments);
+    std::string got = AutoFmt(*m, comments_data, text_width);
+
+    // AutoFmt prints the module a member at a time; that should be the same as
+    // printing the doc for the whole module.
+    DocArena arena;
+    EXPECT_EQ(got,
+              PrettyPrint(arena, Fmt(*m, comments_data, arena), text_width));
 
     if (opportunistic_postcondition) {
       std::optional<AutoFmtPostconditionViolation> maybe_violation =
@@ -1950,5 +1958,37 @@ pub fn f(a: A) -> A { if a.B[0].value == u32:0 { zero!<A>() } else { a } }
 )");
 }
 
+TEST(AutoFmtRangeTest, FormatsOnlyIntersectingMembers) {
+  constexpr std::string_view kInput = R"(fn f(x:u32)->u32{x}
+// Comment about g.
+fn g(x:u32)->u32{x+u32:1}
+fn h(x:u32)->u32{x+u32:2}
+)";
+  std::vector<CommentData> comments;
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Module> m,
+                           ParseModule(kInput, "fake.x", "fake", &comments));
+  const Pos start("fake.x", 2, 0);
+  const Pos limit(start.filename(), 2, 5);
+  std::vector<AutoFmtEdit> edits =
+      AutoFmtRange(*m, Comments::Create(comments), Span(start, limit));
+  ASSERT_EQ(edits.size(), 1);
+  EXPECT_EQ(edits[0].span.start().lineno(), 2);
+  EXPECT_EQ(edits[0].text, "fn g(x: u32) -> u32 { x + u32:1 }");
+}
+
+TEST(AutoFmtRangeTest, EmptyWhenNoMemberIntersects) {
+  constexpr std::string_view kInput = R"(fn f(x:u32)->u32{x}
+
+
+fn g(x:u32)->u32{x}
+)";
+  std::vector<CommentData> comments;
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Module> m,
+                           ParseModule(kInput, "fake.x", "fake", &comments));
+  const Pos start("fake.x", 1, 0);
+  EXPECT_TRUE(
+      AutoFmtRange(*m, Comments::Create(comments), Span(start, start)).empty());
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -28,7 +28,6 @@
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
-#include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
@@ -120,8 +119,7 @@ bool operator<=(Requirement lhs, Requirement rhs) {
 }
 
 void PrettyPrintInternal(const DocArena& arena, const Doc& doc,
-                         const int64_t default_text_width,
-                         std::vector<std::string>& pieces) {
+                         const int64_t default_text_width, std::string& out) {
   VLOG(1) << "PrettyPrintInternal; default text width: " << default_text_width;
 
   // We maintain a stack to keep track of doc emission we still need to perform.
@@ -139,17 +137,19 @@ void PrettyPrintInternal(const DocArena& arena, const Doc& doc,
   // avoid whitespace before newlines on newline-only lines.
   int64_t virtual_outcol = 0;
 
+  // Text is appended directly to the output buffer as it is emitted, so we
+  // never hold more than the (flat) requirements of the docs on the stack.
   auto emit = [&](std::string_view s) {
     if (real_outcol < virtual_outcol) {
-      pieces.push_back(std::string(virtual_outcol - real_outcol, ' '));
+      out.append(virtual_outcol - real_outcol, ' ');
       real_outcol = virtual_outcol;
     }
-    pieces.push_back(std::string{s});
+    out.append(s);
     real_outcol += s.size();
     virtual_outcol += s.size();
   };
   auto emit_cr = [&](int64_t indent) {
-    pieces.push_back("\n");
+    out.push_back('\n');
     real_outcol = 0;
     virtual_outcol = indent;
   };
@@ -211,7 +211,8 @@ void PrettyPrintInternal(const DocArena& arena, const Doc& doc,
                 if (prefix.size() + line.size() < remaining_cols) {
                   // If it all fits in available cols, place it there in its
                   // entirety.
-                  emit(absl::StrCat(prefix, line));
+                  emit(prefix);
+                  emit(line);
                   if (i + 1 != lines.size()) {
                     emit_cr(entry.indent());
                   }
@@ -237,7 +238,7 @@ void PrettyPrintInternal(const DocArena& arena, const Doc& doc,
 
                   while (!remaining_toks.empty()) {
                     emit(prefix);
-                    emit(std::string(leading_whitespace_size, ' '));
+                    emit(line.substr(0, leading_whitespace_size));
 
                     // After we emit the prefix we make sure we emit at least
                     // one token.
@@ -525,9 +526,14 @@ DocRef DocArena::Make(Keyword kw) {
 }
 
 std::string PrettyPrint(const DocArena& arena, DocRef ref, int64_t text_width) {
-  std::vector<std::string> pieces;
-  PrettyPrintInternal(arena, arena.Deref(ref), text_width, pieces);
-  return absl::StrJoin(pieces, "");
+  std::string out;
+  PrettyPrintTo(arena, ref, text_width, out);
+  return out;
+}
+
+void PrettyPrintTo(const DocArena& arena, DocRef ref, int64_t text_width,
+                   std::string& out) {
+  PrettyPrintInternal(arena, arena.Deref(ref), text_width, out);
 }
 
 DocRef ConcatN(DocArena& arena, absl::Span<DocRef const> docs) {
@@ -327,6 +327,14 @@ DocRef ConcatNGroup(DocArena& arena, absl::Span<DocRef const> docs);
 // width limit.
 std::string PrettyPrint(const DocArena& arena, DocRef ref, int64_t text_width);
 
+// As PrettyPrint() but appends the result to "out".
+//
+// The printer starts at column zero, so docs that end in a hard line break
+// (e.g. the members of a module) can be printed one after another into the
+// same buffer, each from its own (short lived) arena.
+void PrettyPrintTo(const DocArena& arena, DocRef ref, int64_t text_width,
+                   std::string& out);
+
 }  // namespace xls::dslx
 
 #endif  // XLS_DSLX_FMT_PRETTY_PRINT_H_
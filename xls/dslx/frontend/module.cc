@@ -14,7 +14,9 @@
 
 #include "xls/dslx/frontend/module.h"
 
+#include <cstddef>
 #include <filesystem>  // NOLINT
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -50,6 +52,48 @@ Module::~Module() {
   VLOG(3) << "Destroying module \"" << name_ << "\" @ " << this;
 }
 
+Module::NodeArena& Module::NodeArena::operator=(NodeArena&& other) noexcept {
+  if (this != &other) {
+    Clear();
+    nodes_ = std::move(other.nodes_);
+    blocks_ = std::move(other.blocks_);
+    cursor_ = std::exchange(other.cursor_, nullptr);
+    remaining_ = std::exchange(other.remaining_, 0);
+    other.nodes_.clear();
+    other.blocks_.clear();
+  }
+  return *this;
+}
+
+void* Module::NodeArena::Allocate(size_t size) {
+  size = (size + kAlignment - 1) / kAlignment * kAlignment;
+  if (size > remaining_) {
+    // Nodes that would waste much of a block get a block of their own, and the
+    // current block stays in use for subsequent small nodes.
+    if (size > kBlockSize / 4) {
+      blocks_.push_back(std::unique_ptr<std::byte[]>(new std::byte[size]));
+      return blocks_.back().get();
+    }
+    blocks_.push_back(std::unique_ptr<std::byte[]>(new std::byte[kBlockSize]));
+    cursor_ = blocks_.back().get();
+    remaining_ = kBlockSize;
+  }
+  void* result = cursor_;
+  cursor_ += size;
+  remaining_ -= size;
+  return result;
+}
+
+void Module::NodeArena::Clear() {
+  for (AstNode* node : nodes_) {
+    node->~AstNode();
+  }
+  nodes_.clear();
+  blocks_.clear();
+  cursor_ = nullptr;
+  remaining_ = 0;
+}
+
 std::string Module::ToString() const {
   // Don't print Proc functions, as they'll be printed as part of the procs
   // themselves.
@@ -88,10 +132,10 @@ std::string Module::ToString() const {
 }
 
 const AstNode* Module::FindNode(AstNodeKind kind, const Span& target) const {
-  for (const auto& node : nodes_) {
+  for (const AstNode* node : nodes()) {
     if (node->kind() == kind && node->GetSpan().has_value() &&
         node->GetSpan().value() == target) {
-      return node.get();
+      return node;
     }
   }
   return nullptr;
@@ -99,9 +143,9 @@ const AstNode* Module::FindNode(AstNodeKind kind, const Span& target) const {
 
 std::vector<const AstNode*> Module::FindIntercepting(const Pos& target) const {
   std::vector<const AstNode*> found;
-  for (const auto& node : nodes_) {
+  for (const AstNode* node : nodes()) {
     if (node->GetSpan().has_value() && node->GetSpan()->Contains(target)) {
-      found.push_back(node.get());
+      found.push_back(node);
     }
   }
   return found;
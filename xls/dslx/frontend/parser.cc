@@ -524,7 +524,7 @@ Parser::ParseAttribute(absl::flat_hash_map<std::string, Function*>* name_to_fn,
         Token ffi_annotation_token,
         PopTokenOrError(TokenKind::kString, /*start=*/nullptr,
                         "extern_verilog template", &template_limit));
-    std::string ffi_annotation = *ffi_annotation_token.GetValue();
+    std::string ffi_annotation = ffi_annotation_token.GetStringValue();
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kCParen));
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kCBrack));
     XLS_ASSIGN_OR_RETURN(bool dropped_pub, TryDropKeyword(Keyword::kPub));
@@ -738,7 +738,7 @@ absl::StatusOr<Number*> Parser::TokenToNumber(const Token& tok) {
       kind = NumberKind::kOther;
       break;
   }
-  return module_->Make<Number>(tok.span(), *tok.GetValue(), kind,
+  return module_->Make<Number>(tok.span(), tok.GetStringValue(), kind,
                                /*type=*/nullptr);
 }
 
@@ -754,8 +754,9 @@ absl::StatusOr<TypeRef*> Parser::ParseTypeRef(Bindings& bindings,
   if (peek_is_double_colon) {
     return ParseModTypeRef(bindings, tok);
   }
-  XLS_ASSIGN_OR_RETURN(BoundNode type_def, bindings.ResolveNodeOrError(
-                                               *tok.GetValue(), tok.span()));
+  XLS_ASSIGN_OR_RETURN(
+      BoundNode type_def,
+      bindings.ResolveNodeOrError(tok.GetStringValue(), tok.span()));
   if (!IsOneOf<TypeAlias, EnumDef, StructDef>(ToAstNode(type_def))) {
     return ParseErrorStatus(
         tok.span(),
@@ -933,7 +934,8 @@ absl::StatusOr<ColonRef*> Parser::ParseColonRef(Bindings& bindings,
         PopTokenOrError(TokenKind::kIdentifier, /*start=*/nullptr,
                         "Expected colon-reference identifier"));
     Span span(start, GetPos());
-    subject = module_->Make<ColonRef>(span, subject, *value_tok.GetValue());
+    subject =
+        module_->Make<ColonRef>(span, subject, value_tok.GetStringValue());
     start = GetPos();
     XLS_ASSIGN_OR_RETURN(bool dropped_colon,
                          TryDropToken(TokenKind::kDoubleColon));
@@ -999,11 +1001,11 @@ absl::StatusOr<Expr*> Parser::ParseStructInstance(Bindings& bindings,
     XLS_ASSIGN_OR_RETURN(bool dropped_colon, TryDropToken(TokenKind::kColon));
     if (dropped_colon) {
       XLS_ASSIGN_OR_RETURN(Expr * e, ParseExpression(bindings));
-      return std::make_pair(*tok.GetValue(), e);
+      return std::make_pair(tok.GetStringValue(), e);
     }
 
     XLS_ASSIGN_OR_RETURN(NameRef * name_ref, ParseNameRef(bindings, &tok));
-    return std::make_pair(*tok.GetValue(), name_ref);
+    return std::make_pair(tok.GetStringValue(), name_ref);
   };
 
   std::vector<StructInstanceMember> members;
@@ -1354,7 +1356,7 @@ absl::StatusOr<NameDefTree*> Parser::ParsePattern(Bindings& bindings) {
   XLS_ASSIGN_OR_RETURN(const Token* peek, PeekToken());
   if (peek->kind() == TokenKind::kIdentifier) {
     XLS_ASSIGN_OR_RETURN(Token tok, PopTokenOrError(TokenKind::kIdentifier));
-    if (*tok.GetValue() == "_") {
+    if (tok.GetStringValue() == "_") {
       return module_->Make<NameDefTree>(
           tok.span(), module_->Make<WildcardPattern>(tok.span()));
     }
@@ -1367,15 +1369,18 @@ absl::StatusOr<NameDefTree*> Parser::ParsePattern(Bindings& bindings) {
       return module_->Make<NameDefTree>(tok.span(), colon_ref);
     }
 
-    std::optional<BoundNode> resolved = bindings.ResolveNode(*tok.GetValue());
+    std::optional<BoundNode> resolved =
+        bindings.ResolveNode(tok.GetStringValue());
     NameRef* ref;
     if (resolved) {
       AnyNameDef name_def =
-          bindings.ResolveNameOrNullopt(*tok.GetValue()).value();
+          bindings.ResolveNameOrNullopt(tok.GetStringValue()).value();
       if (std::holds_alternative<ConstantDef*>(*resolved)) {
-        ref = module_->Make<ConstRef>(tok.span(), *tok.GetValue(), name_def);
+        ref = module_->Make<ConstRef>(tok.span(), tok.GetStringValue(),
+                                      name_def);
       } else {
-        ref = module_->Make<NameRef>(tok.span(), *tok.GetValue(), name_def);
+        ref = module_->Make<NameRef>(tok.span(), tok.GetStringValue(),
+                                     name_def);
       }
       return module_->Make<NameDefTree>(tok.span(), ref);
     }
@@ -1471,7 +1476,7 @@ absl::StatusOr<Import*> Parser::ParseImport(Bindings& bindings) {
   XLS_ASSIGN_OR_RETURN(Token first_tok,
                        PopTokenOrError(TokenKind::kIdentifier));
   std::vector<Token> toks = {first_tok};
-  std::vector<std::string> subject = {*first_tok.GetValue()};
+  std::vector<std::string> subject = {first_tok.GetStringValue()};
   while (true) {
     XLS_ASSIGN_OR_RETURN(bool dropped_dot, TryDropToken(TokenKind::kDot));
     if (!dropped_dot) {
@@ -1479,7 +1484,7 @@ absl::StatusOr<Import*> Parser::ParseImport(Bindings& bindings) {
     }
     XLS_ASSIGN_OR_RETURN(Token tok, PopTokenOrError(TokenKind::kIdentifier));
     toks.push_back(tok);
-    subject.push_back(*tok.GetValue());
+    subject.push_back(tok.GetStringValue());
   }
 
   XLS_ASSIGN_OR_RETURN(bool dropped_as, TryDropKeyword(Keyword::kAs));
@@ -1666,11 +1671,11 @@ absl::StatusOr<Expr*> Parser::ParseTermLhs(Bindings& outer_bindings,
     Token tok = PopTokenOrDie();
     // TODO(https://github.com/google/xls/issues/1105): 2021-05-20 Add
     // zero-length string support akin to zero-length array support.
-    if (tok.GetValue()->empty()) {
+    if (tok.GetStringValue().empty()) {
       return ParseErrorStatus(tok.span(),
                               "Zero-length strings are not supported.");
     }
-    return module_->Make<String>(tok.span(), *tok.GetValue());
+    return module_->Make<String>(tok.span(), tok.GetStringValue());
   } else if (peek->IsKindIn({TokenKind::kBang, TokenKind::kMinus})) {
     Token tok = PopTokenOrDie();
     XLS_ASSIGN_OR_RETURN(Expr * arg, ParseTerm(outer_bindings, restrictions));
@@ -1687,7 +1692,8 @@ absl::StatusOr<Expr*> Parser::ParseTermLhs(Bindings& outer_bindings,
     lhs = module_->Make<Unop>(span, unop_kind, arg);
   } else if (peek->IsTypeKeyword() ||
              (peek->kind() == TokenKind::kIdentifier &&
-              outer_bindings.ResolveNodeIsTypeDefinition(*peek->GetValue()))) {
+              outer_bindings.ResolveNodeIsTypeDefinition(
+                  peek->GetStringValue()))) {
     XLS_ASSIGN_OR_RETURN(
         lhs, ParseCastOrEnumRefOrStructInstanceOrToken(outer_bindings));
   } else if (peek->kind() == TokenKind::kIdentifier || peek_is_kw_in ||
@@ -1767,7 +1773,7 @@ absl::StatusOr<Expr*> Parser::ParseTermRhs(Expr* lhs, Bindings& outer_bindings,
       XLS_ASSIGN_OR_RETURN(Token tok, PopToken());
       const Span span(new_pos, GetPos());
       if (tok.kind() == TokenKind::kIdentifier) {
-        lhs = module_->Make<Attr>(span, lhs, *tok.GetValue());
+        lhs = module_->Make<Attr>(span, lhs, tok.GetStringValue());
       } else if (tok.kind() == TokenKind::kNumber) {
         XLS_ASSIGN_OR_RETURN(Number * number, TokenToNumber(tok));
         lhs = module_->Make<TupleIndex>(span, lhs, number);
@@ -2681,7 +2687,8 @@ absl::StatusOr<TypeRef*> Parser::ParseModTypeRef(Bindings& bindings,
   XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kDoubleColon));
   XLS_ASSIGN_OR_RETURN(
       BoundNode bn,
-      bindings.ResolveNodeOrError(*start_tok.GetValue(), start_tok.span()));
+      bindings.ResolveNodeOrError(start_tok.GetStringValue(),
+                                  start_tok.span()));
   if (!std::holds_alternative<Import*>(bn)) {
     return ParseErrorStatus(
         start_tok.span(),
@@ -2694,7 +2701,7 @@ absl::StatusOr<TypeRef*> Parser::ParseModTypeRef(Bindings& bindings,
                                        "module type-reference"));
   const Span span(start_tok.span().start(), type_name.span().limit());
   ColonRef* mod_ref =
-      module_->Make<ColonRef>(span, subject, *type_name.GetValue());
+      module_->Make<ColonRef>(span, subject, type_name.GetStringValue());
   return module_->Make<TypeRef>(span, mod_ref);
 }
 
@@ -0,0 +1,110 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/dslx/frontend/module.h"
+#include "xls/dslx/frontend/parser.h"
+#include "xls/dslx/frontend/scanner.h"
+
+namespace {
+
+// Number and total size of calls to the global operator new, which is replaced
+// below so the benchmarks can report allocations per parse.
+std::atomic<int64_t> allocation_count = 0;
+std::atomic<int64_t> allocated_bytes = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  void* p = std::malloc(size);
+  if (p == nullptr) {
+    std::abort();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace xls::dslx {
+namespace {
+
+// Emulates machine-generated DSLX (e.g. from proto_to_dslx or table
+// generators): a large lookup table followed by many small functions using
+// long identifiers.
+std::string MakeGeneratedProgram(int64_t size) {
+  std::string program = "pub const GENERATED_LOOKUP_TABLE = u32[";
+  absl::StrAppend(&program, size, "]:[\n");
+  for (int64_t i = 0; i < size; ++i) {
+    absl::StrAppendFormat(&program, "  u32:0x%08x,\n", i * 2654435761 % 4096);
+  }
+  absl::StrAppend(&program, "];\n\n");
+  for (int64_t i = 0; i < size / 8; ++i) {
+    absl::StrAppendFormat(&program, R"(pub struct GeneratedRecord%d {
+  generated_field_a: u32,
+  generated_field_b: u16[4],
+}
+
+pub fn generated_lookup_%d(record: GeneratedRecord%d, index: u32) -> u32 {
+  let entry = GENERATED_LOOKUP_TABLE[index + u32:%d];
+  let sum = record.generated_field_a + (record.generated_field_b[0] as u32);
+  if entry > sum { entry - sum } else { sum - entry }
+}
+
+)",
+                          i, i, i, i);
+  }
+  return program;
+}
+
+void BM_ParseGeneratedModule(benchmark::State& state) {
+  const std::string program = MakeGeneratedProgram(state.range(0));
+  int64_t allocations = 0;
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    const int64_t allocations_before = allocation_count.load();
+    const int64_t bytes_before = allocated_bytes.load();
+    Scanner scanner("generated.x", program);
+    Parser parser("generated", &scanner);
+    absl::StatusOr<std::unique_ptr<Module>> module = parser.ParseModule();
+    allocations += allocation_count.load() - allocations_before;
+    bytes += allocated_bytes.load() - bytes_before;
+    CHECK_OK(module.status());
+    benchmark::DoNotOptimize(module);
+  }
+  state.SetBytesProcessed(state.iterations() * program.size());
+  state.counters["allocations"] =
+      benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+  state.counters["allocated_bytes"] =
+      benchmark::Counter(bytes, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_ParseGeneratedModule)->Range(1 << 10, 1 << 16);
+
+}  // namespace
+}  // namespace xls::dslx
@@ -15,9 +15,12 @@
 #include "xls/dslx/frontend/pos.h"
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
+#include <utility>
 
+#include "absl/base/no_destructor.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
@@ -25,6 +28,11 @@
 
 namespace xls::dslx {
 
+/* static */ const std::string& Pos::EmptyFilename() {
+  static const absl::NoDestructor<std::string> kEmpty;
+  return *kEmpty;
+}
+
 /* static */ absl::StatusOr<Span> Span::FromString(std::string_view s) {
   std::string filename;
   int64_t start_lineno, start_colno, limit_lineno, limit_colno;
@@ -33,8 +41,10 @@ namespace xls::dslx {
                      &limit_colno)) {
     // The values used for display are 1-based, whereas the backing storage is
     // zero-based.
-    return Span(Pos(filename, start_lineno - 1, start_colno - 1),
-                Pos(filename, limit_lineno - 1, limit_colno - 1));
+    auto shared_filename =
+        std::make_shared<const std::string>(std::move(filename));
+    return Span(Pos(shared_filename, start_lineno - 1, start_colno - 1),
+                Pos(shared_filename, limit_lineno - 1, limit_colno - 1));
   }
 
   return absl::InvalidArgumentError(
@@ -45,7 +55,7 @@ namespace xls::dslx {
   std::string filename;
   int64_t lineno, colno;
   if (RE2::FullMatch(s, "(.*):(\\d+):(\\d+)", &filename, &lineno, &colno)) {
-    return Pos(filename, lineno - 1, colno - 1);
+    return Pos(std::move(filename), lineno - 1, colno - 1);
   }
 
   return absl::InvalidArgumentError(
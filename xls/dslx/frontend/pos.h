@@ -16,6 +16,7 @@
 #define XLS_DSLX_FRONTEND_POS_H_
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <ostream>
 #include <string>
@@ -29,27 +30,38 @@
 namespace xls::dslx {
 
 // Represents a position in the text (file, line, column).
+//
+// The filename is shared between copies so that positions (of which there are
+// several per token and AST node) can be copied without allocating. Producers
+// of many positions in the same file (e.g. the scanner) should use the
+// constructor taking a shared filename.
 class Pos {
  public:
   static absl::StatusOr<Pos> FromString(std::string_view s);
 
   Pos() : lineno_(0), colno_(0) {}
   Pos(std::string filename, int64_t lineno, int64_t colno)
+      : filename_(std::make_shared<const std::string>(std::move(filename))),
+        lineno_(lineno),
+        colno_(colno) {}
+  Pos(std::shared_ptr<const std::string> filename, int64_t lineno,
+      int64_t colno)
       : filename_(std::move(filename)), lineno_(lineno), colno_(colno) {}
 
   std::string ToString() const {
-    return absl::StrFormat("%s:%d:%d", filename_, lineno_ + 1, colno_ + 1);
+    return absl::StrFormat("%s:%d:%d", filename(), lineno_ + 1, colno_ + 1);
   }
   std::string ToStringNoFile() const {
     return absl::StrFormat("%d:%d", lineno_ + 1, colno_ + 1);
   }
 
   std::string ToRepr() const {
-    return absl::StrFormat("Pos(\"%s\", %d, %d)", filename_, lineno_, colno_);
+    return absl::StrFormat("Pos(\"%s\", %d, %d)", filename(), lineno_,
+                           colno_);
   }
 
   bool operator<(const Pos& other) const {
-    CHECK_EQ(filename_, other.filename_);
+    CHECK(filename_ == other.filename_ || filename() == other.filename());
     if (lineno_ < other.lineno_) {
       return true;
     }
@@ -62,7 +74,7 @@ class Pos {
     return false;
   }
   bool operator==(const Pos& other) const {
-    CHECK_EQ(filename_, other.filename_);
+    CHECK(filename_ == other.filename_ || filename() == other.filename());
     return lineno_ == other.lineno_ && colno_ == other.colno_;
   }
   bool operator!=(const Pos& other) const { return !(*this == other); }
@@ -72,7 +84,9 @@ class Pos {
   bool operator>(const Pos& other) const { return !(*this <= other); }
   bool operator>=(const Pos& other) const { return !((*this) < other); }
 
-  const std::string& filename() const { return filename_; }
+  const std::string& filename() const {
+    return filename_ == nullptr ? EmptyFilename() : *filename_;
+  }
 
   // Note: these lineno/colno values are zero-based.
   int64_t lineno() const { return lineno_; }
@@ -86,7 +100,10 @@ class Pos {
   Pos BumpCol() const { return Pos(filename_, lineno_, colno_ + 1); }
 
  private:
-  std::string filename_;
+  static const std::string& EmptyFilename();
+
+  // Null for default-constructed positions, which have an empty filename.
+  std::shared_ptr<const std::string> filename_;
   int64_t lineno_;
   int64_t colno_;
 };
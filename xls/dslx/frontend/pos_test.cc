@@ -14,6 +14,7 @@
 
 #include "xls/dslx/frontend/pos.h"
 
+#include <memory>
 #include <string>
 
 #include "gtest/gtest.h"
@@ -38,6 +39,17 @@ TEST(PosTest, PosLt) {
   EXPECT_GE(Pos(kFakeFile, 0, 0), Pos(kFakeFile, 0, 0));
 }
 
+TEST(PosTest, SharedFilename) {
+  auto filename = std::make_shared<const std::string>("/my/foo.x");
+  Pos a(filename, 0, 0);
+  Pos b = a.BumpCol();
+  EXPECT_EQ(&a.filename(), &b.filename());
+  EXPECT_EQ(b.ToString(), "/my/foo.x:1:2");
+  EXPECT_LT(a, b);
+  EXPECT_EQ(Pos("/my/foo.x", 0, 1), b);
+  EXPECT_EQ(Pos().filename(), "");
+}
+
 TEST(SpanTest, SpanContainsOther) {
   const char* kFakeFile = "<fake>";
   const Pos origin = Pos(kFakeFile, 0, 0);
@@ -293,12 +293,12 @@ absl::StatusOr<Token> Scanner::ScanIdentifierOrKeyword(char startc,
     return std::isalpha(c) != 0 || std::isdigit(c) != 0 || c == '_' ||
            c == '!' || c == '\'';
   };
-  std::string s = ScanWhile(startc, is_trailing_identifier_char);
+  std::string_view s = ScanWhile(index_ - 1, is_trailing_identifier_char);
   Span span(start_pos, GetPos());
   if (std::optional<Keyword> keyword = GetKeyword(s)) {
     return Token(span, *keyword);
   }
-  return Token(TokenKind::kIdentifier, span, std::move(s));
+  return Token(TokenKind::kIdentifier, span, std::string(s));
 }
 
 std::optional<CommentData> Scanner::TryPopComment() {
@@ -346,9 +346,12 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, const Pos& start_pos) {
     startc = PopChar();
   }
 
-  std::string s;
+  // Index of the first digit (or radix prefix) of the number, which has already
+  // been popped.
+  const int64_t start_index = index_ - 1;
+  std::string_view s;
   if (startc == '0' && TryDropChar('x')) {  // Hex radix.
-    s = ScanWhile("0x", [](char c) {
+    s = ScanWhile(start_index, [](char c) {
       return ('0' <= c && c <= '9') || ('a' <= c && c <= 'f') ||
              ('A' <= c && c <= 'F') || c == '_';
     });
@@ -357,7 +360,7 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, const Pos& start_pos) {
                              "Expected hex characters following 0x prefix.");
     }
   } else if (startc == '0' && TryDropChar('b')) {  // Bin prefix.
-    s = ScanWhile("0b",
+    s = ScanWhile(start_index,
                   [](char c) { return ('0' <= c && c <= '1') || c == '_'; });
     if (s == "0b") {
       return ScanErrorStatus(Span(GetPos(), GetPos()),
@@ -369,7 +372,7 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, const Pos& start_pos) {
           absl::StrFormat("Invalid digit for binary number: '%c'", PeekChar()));
     }
   } else {
-    s = ScanWhile(startc, [](char c) { return std::isdigit(c) != 0; });
+    s = ScanWhile(start_index, [](char c) { return std::isdigit(c) != 0; });
     if (absl::StartsWith(s, "0") && s.size() != 1) {
       return ScanErrorStatus(
           Span(GetPos(), GetPos()),
@@ -378,10 +381,8 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, const Pos& start_pos) {
     CHECK(!s.empty())
         << "Must have seen numerical digits to attempt to scan a number.";
   }
-  if (negative) {
-    s = "-" + s;
-  }
-  return Token(TokenKind::kNumber, Span(start_pos, GetPos()), s);
+  return Token(TokenKind::kNumber, Span(start_pos, GetPos()),
+               negative ? absl::StrCat("-", s) : std::string(s));
 }
 
 bool Scanner::AtWhitespace() const {
@@ -16,7 +16,7 @@
 #define XLS_DSLX_FRONTEND_SCANNER_H_
 
 #include <cstdint>
-#include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -53,7 +53,7 @@ class Scanner {
  public:
   Scanner(std::string filename, std::string text,
           bool include_whitespace_and_comments = false)
-      : filename_(std::move(filename)),
+      : filename_(std::make_shared<const std::string>(std::move(filename))),
         text_(std::move(text)),
         include_whitespace_and_comments_(include_whitespace_and_comments) {}
 
@@ -97,7 +97,7 @@ class Scanner {
   void EnableDoubleCAngle() { double_c_angle_enabled_ = true; }
   void DisableDoubleCAngle() { double_c_angle_enabled_ = false; }
 
-  std::string_view filename() const { return filename_; }
+  std::string_view filename() const { return *filename_; }
 
   absl::Span<const CommentData> comments() const { return comments_; }
 
@@ -146,19 +146,18 @@ class Scanner {
   absl::StatusOr<Token> ScanChar(const Pos& start_pos);
 
   // Scans from the current position until ftake returns false or EOF is
-  // reached.
-  std::string ScanWhile(std::string s, const std::function<bool(char)>& ftake) {
-    while (!AtCharEof()) {
-      char peek = PeekChar();
-      if (!ftake(peek)) {
-        break;
-      }
-      s.append(1, PopChar());
+  // reached, and returns the text from `start_index` (which may precede the
+  // current position to include characters that were already popped) up to
+  // the new position.
+  //
+  // The result is a view into the text being scanned, so scanning large
+  // generated files does not build up a string a character at a time.
+  template <typename TakeFn>
+  std::string_view ScanWhile(int64_t start_index, TakeFn ftake) {
+    while (!AtCharEof() && ftake(PeekChar())) {
+      DropChar();
     }
-    return s;
-  }
-  std::string ScanWhile(char c, const std::function<bool(char)>& ftake) {
-    return ScanWhile(std::string(1, c), ftake);
+    return std::string_view(text_).substr(start_index, index_ - start_index);
   }
 
   // Scans the identifier-looping entity beginning with startc.
@@ -261,7 +260,8 @@ class Scanner {
   // are valid constituents of a string.
   absl::StatusOr<std::string> ProcessNextStringChar();
 
-  std::string filename_;
+  // Shared by all the positions produced by this scanner.
+  std::shared_ptr<const std::string> filename_;
   std::string text_;
   bool include_whitespace_and_comments_;
   int64_t index_ = 0;
@@ -156,7 +156,7 @@ class TokenParser {
     if (span_out != nullptr) {
       *span_out = tok.span();
     }
-    return *tok.GetValue();
+    return tok.GetStringValue();
   }
 
   // For use only when the caller knows there is lookahead present (in which
@@ -15,8 +15,10 @@
 #include "xls/dslx/import_data.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -32,6 +34,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/bytecode/bytecode_cache_interface.h"
@@ -42,6 +45,7 @@
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/import_record.h"
 #include "xls/dslx/interp_bindings.h"
+#include "xls/dslx/interp_value.h"
 #include "xls/dslx/type_system/type_info.h"
 
 namespace xls::dslx {
@@ -72,6 +76,38 @@ absl::StatusOr<ModuleInfo*> ImportData::Put(
   return pmodule_info;
 }
 
+absl::Status ImportData::Remove(const ImportTokens& subject) {
+  auto it = modules_.find(subject);
+  if (it == modules_.end()) {
+    return absl::NotFoundError(
+        "No module is loaded for import of " + subject.ToString());
+  }
+  Module* module = &it->second->module();
+  path_to_module_info_.erase(std::string{it->second->path()});
+  top_level_bindings_.erase(module);
+  top_level_bindings_done_.erase(module);
+  typecheck_wip_.erase(module);
+  type_info_cache_records_.erase(module);
+  type_info_owner_.Remove(module);
+  {
+    absl::MutexLock lock(&constexpr_memo_->mutex);
+    absl::erase_if(constexpr_memo_->values, [&](const auto& entry) {
+      return entry.first.first->owner() == module;
+    });
+  }
+  modules_.erase(it);
+  return absl::OkStatus();
+}
+
+std::vector<std::filesystem::path> ImportData::GetModulePaths() const {
+  std::vector<std::filesystem::path> paths;
+  paths.reserve(modules_.size());
+  for (const auto& [subject, module_info] : modules_) {
+    paths.push_back(module_info->path());
+  }
+  return paths;
+}
+
 absl::StatusOr<TypeInfo*> ImportData::GetRootTypeInfoForNode(
     const AstNode* node) {
   XLS_RET_CHECK(node != nullptr);
@@ -117,6 +153,30 @@ BytecodeCacheInterface* ImportData::bytecode_cache() {
   return bytecode_cache_.get();
 }
 
+std::optional<InterpValue> ImportData::GetMemoizedConstexpr(
+    const Expr* expr, std::string_view env) const {
+  absl::MutexLock lock(&constexpr_memo_->mutex);
+  auto it =
+      constexpr_memo_->values.find(std::make_pair(expr, std::string(env)));
+  if (it == constexpr_memo_->values.end()) {
+    return std::nullopt;
+  }
+  ++constexpr_memo_->hit_count;
+  return it->second;
+}
+
+void ImportData::NoteMemoizedConstexpr(const Expr* expr, std::string env,
+                                       InterpValue value) {
+  absl::MutexLock lock(&constexpr_memo_->mutex);
+  constexpr_memo_->values.insert_or_assign(std::make_pair(expr, std::move(env)),
+                                           std::move(value));
+}
+
+int64_t ImportData::constexpr_memo_hit_count() const {
+  absl::MutexLock lock(&constexpr_memo_->mutex);
+  return constexpr_memo_->hit_count;
+}
+
 absl::StatusOr<const EnumDef*> ImportData::FindEnumDef(const Span& span) const {
   XLS_ASSIGN_OR_RETURN(const Module* module, FindModule(span));
   const EnumDef* enum_def = module->FindEnumDef(span);
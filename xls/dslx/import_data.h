@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -27,7 +28,9 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/dslx/bytecode/bytecode_cache_interface.h"
 #include "xls/dslx/frontend/ast.h"
@@ -35,6 +38,7 @@
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/import_record.h"
 #include "xls/dslx/interp_bindings.h"
+#include "xls/dslx/interp_value.h"
 #include "xls/dslx/type_system/type_info.h"
 #include "xls/dslx/warning_kind.h"
 
@@ -133,6 +137,19 @@ class ImportData {
   absl::StatusOr<ModuleInfo*> Put(const ImportTokens& subject,
                                   std::unique_ptr<ModuleInfo> module_info);
 
+  // Drops the module for `subject` along with all its type information,
+  // interpreter bindings and memoized constexprs so that a new version of the
+  // module can be `Put` in its place (e.g. when an editor buffer changes).
+  // Modules imported by the removed module are retained.
+  //
+  // Note: the caller is responsible for ensuring no other retained module
+  // imports `subject`, and for resetting the bytecode cache, which may refer
+  // to functions of the removed module.
+  absl::Status Remove(const ImportTokens& subject);
+
+  // Returns the paths of all the modules currently owned by this object.
+  std::vector<std::filesystem::path> GetModulePaths() const;
+
   TypeInfoOwner& type_info_owner() { return type_info_owner_; }
 
   // Helper that gets the "root" type information for the module of the given
@@ -202,6 +219,61 @@ class ImportData {
   // into this ImportData set.
   WarningKindSet enabled_warnings() const { return enabled_warnings_; }
 
+  // Information noted about modules imported while a TypeInfoCache is in use.
+  struct TypeInfoCacheRecord {
+    // Key of the module's cache entry; keys of importers incorporate it.
+    std::string key;
+    // Number of AST nodes the module had after parsing. Nodes created later
+    // (e.g. synthesized during type checking) cannot be referred to from
+    // cache entries.
+    int64_t parsed_node_count;
+    // Whether the key incorporates the keys of all the modules imported by the
+    // module, i.e. whether it identifies the module's type information.
+    bool complete = true;
+  };
+  void SetTypeInfoCacheRecord(const Module* module,
+                              TypeInfoCacheRecord record) {
+    type_info_cache_records_.insert_or_assign(module, std::move(record));
+  }
+  const TypeInfoCacheRecord* GetTypeInfoCacheRecord(
+      const Module* module) const {
+    auto it = type_info_cache_records_.find(module);
+    return it == type_info_cache_records_.end() ? nullptr : &it->second;
+  }
+
+  // Memo of constexpr values computed by interpreting expressions (see
+  // ConstexprEvaluator), keyed by the expression and the rendering of the
+  // environment it was evaluated in (see EnvMapToString). Type checking a
+  // parametric function evaluates the same expressions once per
+  // instantiation, often with the same environment. Thread-safe, as IR
+  // conversion evaluates constexprs from several threads.
+  std::optional<InterpValue> GetMemoizedConstexpr(const Expr* expr,
+                                                  std::string_view env) const;
+  void NoteMemoizedConstexpr(const Expr* expr, std::string env,
+                             InterpValue value);
+  int64_t constexpr_memo_hit_count() const;
+
+  // A module which was located and parsed ahead of being imported (see
+  // PrefetchImports), so importing it only has to type check it.
+  struct PrefetchedModule {
+    std::unique_ptr<Module> module;
+    std::filesystem::path path;
+    std::string contents;
+  };
+  void AddPrefetchedModule(const ImportTokens& subject,
+                           PrefetchedModule prefetched) {
+    prefetched_modules_.insert_or_assign(subject, std::move(prefetched));
+  }
+  // Removes and returns the prefetched module for `subject`, if there is one.
+  std::optional<PrefetchedModule> TakePrefetchedModule(
+      const ImportTokens& subject) {
+    auto node = prefetched_modules_.extract(subject);
+    if (node.empty()) {
+      return std::nullopt;
+    }
+    return std::move(node.mapped());
+  }
+
  private:
   friend ImportData CreateImportData(const std::filesystem::path&,
                                      absl::Span<const std::filesystem::path>,
@@ -235,6 +307,18 @@ class ImportData {
   absl::Span<const std::filesystem::path> additional_search_paths_;
   WarningKindSet enabled_warnings_;
   std::unique_ptr<BytecodeCacheInterface> bytecode_cache_;
+  absl::flat_hash_map<const Module*, TypeInfoCacheRecord>
+      type_info_cache_records_;
+  absl::flat_hash_map<ImportTokens, PrefetchedModule> prefetched_modules_;
+  // Held by pointer so that ImportData stays movable.
+  struct ConstexprMemo {
+    absl::Mutex mutex;
+    absl::flat_hash_map<std::pair<const Expr*, std::string>, InterpValue>
+        values ABSL_GUARDED_BY(mutex);
+    int64_t hit_count ABSL_GUARDED_BY(mutex) = 0;
+  };
+  std::unique_ptr<ConstexprMemo> constexpr_memo_ =
+      std::make_unique<ConstexprMemo>();
 
   // See comment on AddToImporterStack() above.
   std::vector<ImportRecord> importer_stack_;
@@ -14,11 +14,16 @@
 
 #include "xls/dslx/import_routines.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/cleanup/cleanup.h"
@@ -36,15 +41,27 @@
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/frontend/module.h"
 #include "xls/dslx/frontend/parser.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/frontend/scanner.h"
 #include "xls/dslx/import_data.h"
+#include "xls/dslx/type_info_cache.h"
 #include "xls/dslx/type_system/type_info.h"
+#include "xls/dslx/type_system/type_info.pb.h"
+#include "xls/dslx/type_system/type_info_to_proto.h"
+#include "xls/dslx/warning_collector.h"
+#include "xls/dslx/warning_kind.h"
 
 namespace xls::dslx {
 
+namespace {
+
+std::atomic<int64_t> default_import_prefetch_thread_count = 1;
+
+}  // namespace
+
 static absl::StatusOr<std::filesystem::path> FindExistingPath(
     const ImportTokens& subject, const std::filesystem::path& stdlib_path,
     absl::Span<const std::filesystem::path> additional_search_paths,
@@ -141,10 +158,239 @@ static absl::StatusOr<std::filesystem::path> FindExistingPath(
                       GetCurrentDirectory().value(), stdlib_path));
 }
 
+// Adds `module` and the modules it transitively imports to `modules`.
+static void CollectImportClosure(const Module* module, ImportData* import_data,
+                                 absl::flat_hash_set<const Module*>& modules) {
+  if (!modules.insert(module).second) {
+    return;
+  }
+  absl::StatusOr<TypeInfo*> type_info =
+      import_data->GetRootTypeInfo(module);
+  if (!type_info.ok()) {
+    return;
+  }
+  for (const auto& [import, imported] : (*type_info)->imports()) {
+    CollectImportClosure(imported.module, import_data, modules);
+  }
+}
+
+static int64_t CountNodes(const absl::flat_hash_set<const Module*>& modules) {
+  int64_t count = 0;
+  for (const Module* module : modules) {
+    count += module->nodes().size();
+  }
+  return count;
+}
+
+// Type checks the freshly parsed `module` using `cache`: returns the cached
+// type information if there is an entry for the module, and otherwise type
+// checks it and adds an entry.
+static absl::StatusOr<TypeInfo*> TypecheckWithCache(
+    const TypecheckModuleFn& ftypecheck, Module* module,
+    std::string_view contents, const std::filesystem::path& found_path,
+    ImportData* import_data, WarningCollector* warnings,
+    TypeInfoCache& cache) {
+  const int64_t parsed_node_count = module->nodes().size();
+
+  // The key of a module incorporates the keys of the modules it imports, so
+  // those are imported first (type checking then finds them already present).
+  std::vector<std::string> import_keys;
+  absl::flat_hash_set<const Module*> closure = {module};
+  bool cacheable = true;
+  for (const ModuleMember& member : module->top()) {
+    if (!std::holds_alternative<Import*>(member)) {
+      continue;
+    }
+    Import* import = std::get<Import*>(member);
+    XLS_ASSIGN_OR_RETURN(
+        ModuleInfo * imported,
+        DoImport(ftypecheck, ImportTokens(import->subject()), import_data,
+                 import->span(), warnings));
+    const ImportData::TypeInfoCacheRecord* record =
+        import_data->GetTypeInfoCacheRecord(&imported->module());
+    if (record == nullptr || !record->complete) {
+      cacheable = false;
+    } else {
+      import_keys.push_back(record->key);
+    }
+    CollectImportClosure(&imported->module(), import_data, closure);
+  }
+  std::string key = TypeInfoCache::ComputeKey(TypeInfoCache::KeyOptions{
+      .module_name = module->name(),
+      .path = found_path.string(),
+      .text = contents,
+      .enabled_warnings = import_data->enabled_warnings(),
+      .import_keys = import_keys});
+  import_data->SetTypeInfoCacheRecord(
+      module, ImportData::TypeInfoCacheRecord{
+                  .key = key,
+                  .parsed_node_count = parsed_node_count,
+                  .complete = cacheable});
+
+  if (cacheable) {
+    absl::StatusOr<std::optional<TypeInfoCacheEntryProto>> entry =
+        cache.Lookup(key);
+    if (!entry.ok()) {
+      LOG(WARNING) << "Unable to read type info cache entry: "
+                   << entry.status();
+    } else if (entry->has_value()) {
+      absl::StatusOr<TypeInfo*> type_info = TypeInfoClosureFromProto(
+          (*entry)->type_info(), module, *import_data);
+      if (type_info.ok()) {
+        VLOG(1) << "Loaded type information for " << module->name()
+                << " from cache entry " << key;
+        for (const WarningProto& warning : (*entry)->warnings()) {
+          XLS_ASSIGN_OR_RETURN(WarningKind kind,
+                               WarningKindFromString(warning.kind()));
+          warnings->Add(SpanFromProto(warning.span()), kind,
+                        warning.message());
+        }
+        return *type_info;
+      }
+      LOG(WARNING) << "Unable to restore type info cache entry " << key
+                   << "; type checking " << module->name()
+                   << " instead: " << type_info.status();
+    }
+  }
+
+  const int64_t warning_count = warnings->warnings().size();
+  const int64_t closure_node_count = CountNodes(closure);
+  XLS_ASSIGN_OR_RETURN(TypeInfo * type_info, ftypecheck(module));
+  // Type checking may synthesize AST nodes (e.g. for `map`) in this module or
+  // in imported ones which a restored module would lack, so such modules are
+  // not cached.
+  if (!cacheable || CountNodes(closure) != closure_node_count) {
+    return type_info;
+  }
+  absl::StatusOr<TypeInfoClosureProto> closure_proto = TypeInfoClosureToProto(
+      *type_info, [&](const Module* m) -> std::optional<int64_t> {
+        const ImportData::TypeInfoCacheRecord* record =
+            import_data->GetTypeInfoCacheRecord(m);
+        if (record == nullptr) {
+          return std::nullopt;
+        }
+        return record->parsed_node_count;
+      });
+  if (!closure_proto.ok()) {
+    VLOG(1) << "Not caching type information for " << module->name() << ": "
+            << closure_proto.status();
+    return type_info;
+  }
+  TypeInfoCacheEntryProto entry;
+  *entry.mutable_type_info() = *std::move(closure_proto);
+  for (int64_t i = warning_count; i < warnings->warnings().size(); ++i) {
+    const WarningCollector::Entry& warning = warnings->warnings()[i];
+    WarningProto* warning_proto = entry.add_warnings();
+    *warning_proto->mutable_span() = SpanToProto(warning.span);
+    XLS_ASSIGN_OR_RETURN(std::string_view kind,
+                         WarningKindToString(warning.kind));
+    warning_proto->set_kind(std::string(kind));
+    warning_proto->set_message(warning.message);
+  }
+  if (absl::Status status = cache.Insert(key, entry); !status.ok()) {
+    LOG(WARNING) << "Unable to write type info cache entry: " << status;
+  }
+  return type_info;
+}
+
+// Locates and parses the module `subject` for PrefetchImports, returning
+// std::nullopt if that fails.
+static std::optional<ImportData::PrefetchedModule> PrefetchModule(
+    const ImportTokens& subject, const std::filesystem::path& stdlib_path,
+    absl::Span<const std::filesystem::path> additional_search_paths,
+    const Span& import_span) {
+  absl::StatusOr<std::filesystem::path> found_path = FindExistingPath(
+      subject, stdlib_path, additional_search_paths, import_span);
+  if (!found_path.ok()) {
+    return std::nullopt;
+  }
+  absl::StatusOr<std::string> contents = GetFileContents(*found_path);
+  if (!contents.ok()) {
+    return std::nullopt;
+  }
+  Scanner scanner(*found_path, *contents);
+  Parser parser(/*module_name=*/subject.ToString(), &scanner);
+  absl::StatusOr<std::unique_ptr<Module>> module = parser.ParseModule();
+  if (!module.ok()) {
+    return std::nullopt;
+  }
+  return ImportData::PrefetchedModule{.module = *std::move(module),
+                                      .path = *std::move(found_path),
+                                      .contents = *std::move(contents)};
+}
+
+void PrefetchImports(const Module& module, ImportData* import_data,
+                     int64_t thread_count) {
+  struct PendingImport {
+    ImportTokens subject;
+    Span span;
+  };
+  absl::flat_hash_set<ImportTokens> seen;
+  std::vector<PendingImport> wave;
+  auto add_imports = [&](const Module& importer) {
+    for (const ModuleMember& member : importer.top()) {
+      if (!std::holds_alternative<Import*>(member)) {
+        continue;
+      }
+      const Import* import = std::get<Import*>(member);
+      ImportTokens subject(import->subject());
+      if (import_data->Contains(subject) || !seen.insert(subject).second) {
+        continue;
+      }
+      wave.push_back(PendingImport{std::move(subject), import->span()});
+    }
+  };
+  add_imports(module);
+
+  const std::filesystem::path& stdlib_path = import_data->stdlib_path();
+  absl::Span<const std::filesystem::path> additional_search_paths =
+      import_data->additional_search_paths();
+  while (!wave.empty()) {
+    std::vector<PendingImport> current = std::move(wave);
+    wave.clear();
+    std::vector<std::optional<ImportData::PrefetchedModule>> prefetched(
+        current.size());
+    std::atomic<int64_t> next = 0;
+    auto worker = [&]() {
+      for (int64_t i = next++; i < current.size(); i = next++) {
+        prefetched[i] = PrefetchModule(current[i].subject, stdlib_path,
+                                       additional_search_paths,
+                                       current[i].span);
+      }
+    };
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 0; i < std::min<int64_t>(thread_count, current.size());
+         ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+
+    for (int64_t i = 0; i < current.size(); ++i) {
+      if (!prefetched[i].has_value()) {
+        continue;
+      }
+      add_imports(*prefetched[i]->module);
+      import_data->AddPrefetchedModule(current[i].subject,
+                                       *std::move(prefetched[i]));
+    }
+  }
+}
+
+void SetDefaultImportPrefetchThreadCount(int64_t thread_count) {
+  default_import_prefetch_thread_count.store(thread_count);
+}
+
+int64_t GetDefaultImportPrefetchThreadCount() {
+  return default_import_prefetch_thread_count.load();
+}
+
 absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                      const ImportTokens& subject,
                                      ImportData* import_data,
-                                     const Span& import_span) {
+                                     const Span& import_span,
+                                     WarningCollector* warnings) {
   XLS_RET_CHECK(import_data != nullptr);
   if (import_data->Contains(subject)) {
     VLOG(3) << "DoImport (cached) subject: " << subject.ToString();
@@ -153,25 +399,50 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
 
   VLOG(3) << "DoImport (uncached) subject: " << subject.ToString();
 
-  XLS_ASSIGN_OR_RETURN(
-      std::filesystem::path found_path,
-      FindExistingPath(subject, import_data->stdlib_path(),
-                       import_data->additional_search_paths(), import_span));
+  std::optional<ImportData::PrefetchedModule> prefetched =
+      import_data->TakePrefetchedModule(subject);
+  std::filesystem::path found_path;
+  if (prefetched.has_value()) {
+    found_path = prefetched->path;
+  } else {
+    XLS_ASSIGN_OR_RETURN(
+        found_path,
+        FindExistingPath(subject, import_data->stdlib_path(),
+                         import_data->additional_search_paths(), import_span));
+  }
 
   XLS_RETURN_IF_ERROR(import_data->AddToImporterStack(import_span, found_path));
   absl::Cleanup cleanup = absl::MakeCleanup(
       [&] { CHECK_OK(import_data->PopFromImporterStack(import_span)); });
 
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(found_path));
+  std::string contents;
+  std::unique_ptr<Module> module;
+  if (prefetched.has_value()) {
+    VLOG(3) << "Typechecking prefetched " << subject.ToString() << ": start";
+    contents = std::move(prefetched->contents);
+    module = std::move(prefetched->module);
+  } else {
+    XLS_ASSIGN_OR_RETURN(contents, GetFileContents(found_path));
 
-  absl::Span<std::string const> pieces = subject.pieces();
-  std::string fully_qualified_name = absl::StrJoin(pieces, ".");
-  VLOG(3) << "Parsing and typechecking " << fully_qualified_name << ": start";
+    absl::Span<std::string const> pieces = subject.pieces();
+    std::string fully_qualified_name = absl::StrJoin(pieces, ".");
+    VLOG(3) << "Parsing and typechecking " << fully_qualified_name
+            << ": start";
 
-  Scanner scanner(found_path, contents);
-  Parser parser(/*module_name=*/fully_qualified_name, &scanner);
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module, parser.ParseModule());
-  XLS_ASSIGN_OR_RETURN(TypeInfo * type_info, ftypecheck(module.get()));
+    Scanner scanner(found_path, contents);
+    Parser parser(/*module_name=*/fully_qualified_name, &scanner);
+    XLS_ASSIGN_OR_RETURN(module, parser.ParseModule());
+  }
+  TypeInfo* type_info;
+  if (TypeInfoCache* cache = GetDefaultTypeInfoCache();
+      cache != nullptr && warnings != nullptr) {
+    XLS_ASSIGN_OR_RETURN(
+        type_info, TypecheckWithCache(ftypecheck, module.get(), contents,
+                                      found_path, import_data, warnings,
+                                      *cache));
+  } else {
+    XLS_ASSIGN_OR_RETURN(type_info, ftypecheck(module.get()));
+  }
   return import_data->Put(
       subject, std::make_unique<ModuleInfo>(std::move(module), type_info,
                                             std::move(found_path)));
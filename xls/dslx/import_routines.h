@@ -15,12 +15,14 @@
 #ifndef XLS_DSLX_IMPORT_ROUTINES_H_
 #define XLS_DSLX_IMPORT_ROUTINES_H_
 
+#include <cstdint>
 #include <functional>
 
 #include "absl/status/statusor.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/type_system/type_info.h"
+#include "xls/dslx/warning_collector.h"
 
 namespace xls::dslx {
 
@@ -41,13 +43,39 @@ using TypecheckModuleFn = std::function<absl::StatusOr<TypeInfo*>(Module*)>;
 //      fully qualified like ('xls', 'lib', 'math').
 //  cache: Cache that we resolve against so we don't waste resources
 //      re-importing things in the import DAG.
+//  warnings: Collector that type checking `ftypecheck` adds warnings to. If
+//      given and a default TypeInfoCache is set (see
+//      SetDefaultTypeInfoCache) the type information for the module is loaded
+//      from or added to that cache, and warnings noted in a cache entry are
+//      added to this collector.
 //
 // Returns:
 //  The imported module information.
 absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                      const ImportTokens& subject,
                                      ImportData* import_data,
-                                     const Span& import_span);
+                                     const Span& import_span,
+                                     WarningCollector* warnings);
+
+// Locates and parses the modules transitively imported by `module` which are
+// not yet in `import_data` so that importing them later (see DoImport) only has
+// to type check them. Each level of the import graph is parsed concurrently on
+// up to `thread_count` threads. Modules which cannot be found or parsed are
+// skipped; importing them reports the error as usual.
+//
+// Type checking itself stays on the calling thread: type checking a module
+// instantiates parametrics of the modules it imports, which adds to their type
+// information, so modules sharing an import cannot be type checked
+// concurrently.
+void PrefetchImports(const Module& module, ImportData* import_data,
+                     int64_t thread_count);
+
+// Sets the number of threads used by ParseAndTypecheck and TypecheckModule (in
+// parse_and_typecheck.h) to prefetch the imports of a module before type
+// checking it. Values less than or equal to one disable prefetching, which is
+// the default.
+void SetDefaultImportPrefetchThreadCount(int64_t thread_count);
+int64_t GetDefaultImportPrefetchThreadCount();
 
 }  // namespace xls::dslx
 
@@ -0,0 +1,117 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/import_routines.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/frontend/module.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/warning_kind.h"
+
+namespace xls::dslx {
+namespace {
+
+// An import graph with sharing: main imports a and b which both import c.
+class PrefetchImportsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(temp_dir_, TempDirectory::Create());
+    XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "c.x",
+                                  "pub const C = u32:1;"));
+    XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "a.x", R"(
+import c;
+pub const A = c::C + u32:1;
+)"));
+    XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "b.x", R"(
+import c;
+pub const B = c::C + u32:2;
+)"));
+  }
+
+  void TearDown() override { SetDefaultImportPrefetchThreadCount(1); }
+
+  ImportData CreateImportDataWithSearchPath() {
+    search_paths_[0] = temp_dir_->path();
+    return CreateImportData(kDefaultDslxStdlibPath, search_paths_,
+                            kDefaultWarningsSet);
+  }
+
+  static constexpr std::string_view kMain = R"(
+import a;
+import b;
+import missing;
+
+fn main() -> u32 { a::A + b::B }
+)";
+
+  std::optional<TempDirectory> temp_dir_;
+  std::filesystem::path search_paths_[1];
+};
+
+TEST_F(PrefetchImportsTest, ParsesImportGraph) {
+  ImportData import_data = CreateImportDataWithSearchPath();
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Module> module,
+                           ParseModule(kMain, "main.x", "main"));
+  PrefetchImports(*module, &import_data, /*thread_count=*/4);
+
+  for (std::string_view name : {"a", "b", "c"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(ImportTokens subject,
+                             ImportTokens::FromString(name));
+    std::optional<ImportData::PrefetchedModule> prefetched =
+        import_data.TakePrefetchedModule(subject);
+    ASSERT_TRUE(prefetched.has_value()) << name;
+    EXPECT_EQ(prefetched->module->name(), name);
+    EXPECT_EQ(prefetched->path, temp_dir_->path() / absl::StrCat(name, ".x"));
+  }
+  // Modules which cannot be found are left for DoImport to report.
+  XLS_ASSERT_OK_AND_ASSIGN(ImportTokens missing,
+                           ImportTokens::FromString("missing"));
+  EXPECT_FALSE(import_data.TakePrefetchedModule(missing).has_value());
+}
+
+TEST_F(PrefetchImportsTest, TypecheckUsesPrefetchedModules) {
+  SetDefaultImportPrefetchThreadCount(4);
+  ImportData import_data = CreateImportDataWithSearchPath();
+  constexpr std::string_view kProgram = R"(
+import a;
+import b;
+
+fn main() -> u32 { a::A + b::B }
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kProgram, "main.x", "main", &import_data));
+  for (std::string_view name : {"a", "b", "c"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(ImportTokens subject,
+                             ImportTokens::FromString(name));
+    EXPECT_TRUE(import_data.Contains(subject)) << name;
+    EXPECT_FALSE(import_data.TakePrefetchedModule(subject).has_value())
+        << name;
+  }
+}
+
+}  // namespace
+}  // namespace xls::dslx
@@ -26,6 +26,8 @@
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/base/no_destructor.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -70,6 +72,19 @@ std::string TagToString(InterpValueTag tag) {
                          static_cast<int64_t>(tag));
 }
 
+InterpValue::InterpValue(InterpValueTag tag, std::vector<InterpValue> values)
+    : tag_(tag) {
+  if (values.empty()) {
+    // Units and empty arrays are common (e.g. every function returning `()`);
+    // share a single empty vector rather than allocating one for each.
+    static const absl::NoDestructor<Values> kEmpty(
+        std::make_shared<std::vector<InterpValue>>());
+    payload_ = *kEmpty;
+  } else {
+    payload_ = std::make_shared<std::vector<InterpValue>>(std::move(values));
+  }
+}
+
 /* static */ InterpValue InterpValue::MakeTuple(
     std::vector<InterpValue> members) {
   return InterpValue{InterpValueTag::kTuple, std::move(members)};
@@ -584,7 +599,7 @@ absl::StatusOr<InterpValue> InterpValue::Slice(
       result.push_back(subject[offset_int]);
     }
   }
-  return InterpValue(InterpValueTag::kArray, result);
+  return InterpValue(InterpValueTag::kArray, std::move(result));
 }
 
 absl::StatusOr<InterpValue> InterpValue::Index(int64_t index) const {
@@ -609,34 +624,50 @@ absl::StatusOr<InterpValue> InterpValue::Index(const InterpValue& other) const {
 }
 
 absl::StatusOr<InterpValue> InterpValue::Update(
-    const InterpValue& index, const InterpValue& value) const {
+    const InterpValue& index, const InterpValue& value) const& {
+  return InterpValue(*this).Update(index, value);
+}
+
+absl::StatusOr<InterpValue> InterpValue::Update(const InterpValue& index,
+                                                const InterpValue& value) && {
   absl::Span<const xls::dslx::InterpValue> indices;
   if (index.IsTuple()) {
-    indices =
-        absl::MakeConstSpan(std::get<std::vector<InterpValue>>(index.payload_));
+    indices = absl::MakeConstSpan(index.GetValuesOrDie());
   } else {
     indices = absl::MakeConstSpan(&index, 1);
   }
-  InterpValue copy = *this;
-  InterpValue* element = &copy;
-  for (const auto& i : indices) {
-    if (!element->IsArray()) {
-      return absl::InvalidArgumentError(absl::StrFormat(
-          "Update of non-array element: %s", element->ToString()));
-    }
-    std::vector<InterpValue>& values =
-        std::get<std::vector<InterpValue>>(element->payload_);
-    XLS_ASSIGN_OR_RETURN(Bits index_bits, i.GetBits());
-    XLS_ASSIGN_OR_RETURN(uint64_t index_value, index_bits.ToUint64());
-    if (index_value >= values.size()) {
-      return absl::InvalidArgumentError(
-          absl::StrFormat("Update index %d is out of bounds; subject size: %d",
-                          index_value, values.size()));
-    }
-    element = &values[index_value];
+  return UpdateElement(std::move(*this), indices, value);
+}
+
+/* static */ absl::StatusOr<InterpValue> InterpValue::UpdateElement(
+    InterpValue subject, absl::Span<const InterpValue> indices,
+    const InterpValue& value) {
+  if (indices.empty()) {
+    return value;
   }
-  *element = value;
-  return copy;
+  if (!subject.IsArray()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Update of non-array element: %s", subject.ToString()));
+  }
+  Values& values = std::get<Values>(subject.payload_);
+  XLS_ASSIGN_OR_RETURN(Bits index_bits, indices.front().GetBits());
+  XLS_ASSIGN_OR_RETURN(uint64_t index_value, index_bits.ToUint64());
+  if (index_value >= values->size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Update index %d is out of bounds; subject size: %d",
+                        index_value, values->size()));
+  }
+  if (values.use_count() != 1) {
+    values = std::make_shared<std::vector<InterpValue>>(*values);
+  }
+  // `subject` is now the sole owner of the (non-empty, so never the shared
+  // empty) elements, which were created mutable.
+  auto& elements = const_cast<std::vector<InterpValue>&>(*values);
+  XLS_ASSIGN_OR_RETURN(
+      elements[index_value],
+      UpdateElement(std::move(elements[index_value]), indices.subspan(1),
+                    value));
+  return subject;
 }
 
 absl::StatusOr<InterpValue> InterpValue::ArithmeticNegate() const {
@@ -919,8 +950,20 @@ absl::StatusOr<xls::Value> InterpValue::ConvertToIr() const {
       return xls::Value(GetBitsOrDie());
     }
     case InterpValueTag::kArray: {
+      const std::vector<InterpValue>& elements = GetValuesOrDie();
+      // Arrays of bits (e.g. constant lookup tables) become packed IR arrays.
+      if (!elements.empty() &&
+          absl::c_all_of(elements,
+                         [](const InterpValue& e) { return e.HasBits(); })) {
+        std::vector<Bits> bits;
+        bits.reserve(elements.size());
+        for (const InterpValue& e : elements) {
+          bits.push_back(e.GetBitsOrDie());
+        }
+        return xls::Value::PackedBitsArray(bits);
+      }
       XLS_ASSIGN_OR_RETURN(std::vector<xls::Value> converted,
-                           ConvertValuesToIr(GetValuesOrDie()));
+                           ConvertValuesToIr(elements));
       return xls::Value::Array(converted);
     }
     case InterpValueTag::kTuple: {
@@ -252,7 +252,11 @@ class InterpValue {
   absl::StatusOr<InterpValue> Index(const InterpValue& other) const;
   absl::StatusOr<InterpValue> Index(int64_t index) const;
   absl::StatusOr<InterpValue> Update(const InterpValue& index,
-                                     const InterpValue& value) const;
+                                     const InterpValue& value) const&;
+  // As above, but updates the elements in place rather than copying them when
+  // this value is their only owner.
+  absl::StatusOr<InterpValue> Update(const InterpValue& index,
+                                     const InterpValue& value) &&;
   absl::StatusOr<InterpValue> Slice(const InterpValue& start,
                                     const InterpValue& length) const;
   absl::StatusOr<InterpValue> Flatten() const;
@@ -297,13 +301,13 @@ class InterpValue {
   InterpValueTag tag() const { return tag_; }
 
   absl::StatusOr<const std::vector<InterpValue>*> GetValues() const {
-    if (!std::holds_alternative<std::vector<InterpValue>>(payload_)) {
+    if (!std::holds_alternative<Values>(payload_)) {
       return absl::InvalidArgumentError("Value does not hold element values");
     }
-    return &std::get<std::vector<InterpValue>>(payload_);
+    return std::get<Values>(payload_).get();
   }
   const std::vector<InterpValue>& GetValuesOrDie() const {
-    return std::get<std::vector<InterpValue>>(payload_);
+    return *std::get<Values>(payload_);
   }
   absl::StatusOr<const FnData*> GetFunction() const {
     if (!std::holds_alternative<FnData>(payload_)) {
@@ -345,7 +349,7 @@ class InterpValue {
   }
 
   bool HasValues() const {
-    return std::holds_alternative<std::vector<InterpValue>>(payload_);
+    return std::holds_alternative<Values>(payload_);
   }
 
   bool IsToken() const { return tag_ == InterpValueTag::kToken; }
@@ -403,12 +407,25 @@ class InterpValue {
   //
   // TODO(leary): 2020-02-10 When all Python bindings are eliminated we can more
   // easily make an interpreter scoped lifetime that InterpValues can live in.
-  using Payload =
-      std::variant<Bits, EnumData, std::vector<InterpValue>, FnData,
-                   std::shared_ptr<TokenData>, std::shared_ptr<Channel>>;
+  //
+  // The elements of tuples and arrays are immutable once created and shared
+  // between copies, so copying an aggregate (e.g. loading it from a slot of the
+  // bytecode interpreter) does not copy its elements.
+  using Values = std::shared_ptr<const std::vector<InterpValue>>;
+  using Payload = std::variant<Bits, EnumData, Values, FnData,
+                               std::shared_ptr<TokenData>,
+                               std::shared_ptr<Channel>>;
 
   InterpValue(InterpValueTag tag, Payload payload)
       : tag_(tag), payload_(std::move(payload)) {}
+  InterpValue(InterpValueTag tag, std::vector<InterpValue> values);
+
+  // Implements Update: replaces the element of `subject` at `indices` with
+  // `value`, copying only the aggregates on the path to it that `subject` does
+  // not solely own.
+  static absl::StatusOr<InterpValue> UpdateElement(
+      InterpValue subject, absl::Span<const InterpValue> indices,
+      const InterpValue& value);
 
   using CompareF = bool (*)(const Bits& lhs, const Bits& rhs);
 
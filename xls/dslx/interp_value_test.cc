@@ -14,6 +14,7 @@
 
 #include "xls/dslx/interp_value.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -181,6 +182,51 @@ TEST(InterpValueTest, Array2DUpdate) {
             "[[1, 2], [4, 4]]");
 }
 
+TEST(InterpValueTest, UpdateDoesNotAffectCopies) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue array,
+      InterpValue::MakeArray(
+          {InterpValue::MakeArray(
+               {InterpValue::MakeU32(1), InterpValue::MakeU32(2)})
+               .value(),
+           InterpValue::MakeArray(
+               {InterpValue::MakeU32(3), InterpValue::MakeU32(4)})
+               .value()}));
+  InterpValue copy = array;
+  auto indices =
+      InterpValue::MakeTuple({InterpValue::MakeU8(0), InterpValue::MakeU32(1)});
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue updated,
+                           copy.Update(indices, InterpValue::MakeU32(5)));
+  EXPECT_EQ(updated.ToHumanString(), "[[1, 5], [3, 4]]");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue moved_update,
+      std::move(copy).Update(indices, InterpValue::MakeU32(6)));
+  EXPECT_EQ(moved_update.ToHumanString(), "[[1, 6], [3, 4]]");
+  EXPECT_EQ(array.ToHumanString(), "[[1, 2], [3, 4]]");
+  EXPECT_EQ(updated.ToHumanString(), "[[1, 5], [3, 4]]");
+}
+
+TEST(InterpValueTest, RvalueUpdateOfSoleOwner) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue array,
+      InterpValue::MakeArray(
+          {InterpValue::MakeU32(1), InterpValue::MakeU32(2)}));
+  for (int64_t i = 0; i < 2; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        array, std::move(array).Update(InterpValue::MakeU32(i),
+                                       InterpValue::MakeU32(7 + i)));
+  }
+  EXPECT_EQ(array.ToHumanString(), "[7, 8]");
+}
+
+TEST(InterpValueTest, EmptyAggregates) {
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue empty_array, InterpValue::MakeArray({}));
+  EXPECT_TRUE(empty_array.GetValuesOrDie().empty());
+  EXPECT_TRUE(InterpValue::MakeUnit().GetValuesOrDie().empty());
+  EXPECT_EQ(InterpValue::MakeUnit(), InterpValue::MakeTuple({}));
+  EXPECT_EQ(InterpValue::MakeUnit().ToHumanString(), "()");
+}
+
 TEST(InterpValueTest, Array2DUpdateEmptyIndices) {
   auto array =
       InterpValue::MakeArray({InterpValue::MakeArray({InterpValue::MakeU32(1),
@@ -37,12 +37,16 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/dslx/bytecode/persistent_bytecode_cache_flags.h"
 #include "xls/dslx/command_line_utils.h"
+#include "xls/dslx/import_routines.h"
 #include "xls/dslx/run_routines/run_comparator.h"
 #include "xls/dslx/run_routines/run_routines.h"
 #include "xls/dslx/run_routines/test_xml.h"
+#include "xls/dslx/type_info_cache_flags.h"
 #include "xls/dslx/warning_kind.h"
 #include "xls/ir/format_preference.h"
+#include "xls/tools/jit_object_cache_flags.h"
 #include "re2/re2.h"
 
 // LINT.IfChange
@@ -79,7 +83,17 @@ ABSL_FLAG(bool, trace_channels, false,
 ABSL_FLAG(int64_t, max_ticks, 100000,
           "If non-zero, the maximum number of ticks to execute on any proc. If "
           "exceeded an error is returned.");
+ABSL_FLAG(int64_t, test_parallelism, 1,
+          "Number of unit tests to execute concurrently; also the number of "
+          "threads used to evaluate the samples of each quickcheck.");
 // LINT.ThenChange(//xls/build_rules/xls_dslx_rules.bzl)
+ABSL_FLAG(int64_t, import_prefetch_threads, 1,
+          "Number of threads used to locate and parse the modules imported "
+          "by the input before type checking it.");
+ABSL_FLAG(std::string, test_proc_backend, "interpreter",
+          "How to execute test procs; options: interpreter|jit. `jit` converts "
+          "the test proc network to IR and runs it in the JIT proc runtime, "
+          "which is much faster for long-running tests.");
 
 namespace xls::dslx {
 namespace {
@@ -100,7 +114,8 @@ absl::StatusOr<TestResult> RealMain(
     const std::optional<std::string>& test_filter,
     FormatPreference format_preference, CompareFlag compare_flag, bool execute,
     bool warnings_as_errors, std::optional<int64_t> seed, bool trace_channels,
-    std::optional<int64_t> max_ticks,
+    std::optional<int64_t> max_ticks, int64_t test_parallelism,
+    TestProcBackend test_proc_backend,
     std::optional<std::string_view> xml_output_file) {
   XLS_ASSIGN_OR_RETURN(
       WarningKindSet warnings,
@@ -150,7 +165,9 @@ absl::StatusOr<TestResult> RealMain(
                                  .warnings_as_errors = warnings_as_errors,
                                  .warnings = warnings,
                                  .trace_channels = trace_channels,
-                                 .max_ticks = max_ticks};
+                                 .max_ticks = max_ticks,
+                                 .test_parallelism = test_parallelism,
+                                 .test_proc_backend = test_proc_backend};
 
   XLS_ASSIGN_OR_RETURN(
       TestResultData test_result,
@@ -178,6 +195,23 @@ int main(int argc, char* argv[]) {
                 << ": `" << absl::StrJoin(args, " ") << "`; want " << argv[0]
                 << " <input-file>";
   }
+  if (absl::Status status = xls::InitJitObjectCacheFromFlags(); !status.ok()) {
+    LOG(QFATAL) << "Unable to initialize JIT object cache: " << status;
+  }
+  if (absl::Status status = xls::InitJitProfilerFromFlags(); !status.ok()) {
+    LOG(QFATAL) << "Unable to initialize JIT profiler: " << status;
+  }
+  xls::InitJitCompileBudgetFromFlags();
+  if (absl::Status status = xls::dslx::InitTypeInfoCacheFromFlags();
+      !status.ok()) {
+    LOG(QFATAL) << "Unable to initialize type info cache: " << status;
+  }
+  if (absl::Status status = xls::dslx::InitPersistentBytecodeCacheFromFlags();
+      !status.ok()) {
+    LOG(QFATAL) << "Unable to initialize bytecode cache: " << status;
+  }
+  xls::dslx::SetDefaultImportPrefetchThreadCount(
+      absl::GetFlag(FLAGS_import_prefetch_threads));
   std::string dslx_path = absl::GetFlag(FLAGS_dslx_path);
   std::vector<std::string> dslx_path_strs = absl::StrSplit(dslx_path, ':');
   std::vector<std::filesystem::path> dslx_paths;
@@ -194,6 +228,8 @@ int main(int argc, char* argv[]) {
       absl::GetFlag(FLAGS_max_ticks) == 0
           ? std::nullopt
           : std::optional<int64_t>(absl::GetFlag(FLAGS_max_ticks));
+  int64_t test_parallelism = absl::GetFlag(FLAGS_test_parallelism);
+  QCHECK_GE(test_parallelism, 1) << "-test_parallelism must be positive";
 
   xls::dslx::CompareFlag compare_flag;
   if (compare_flag_str == "none") {
@@ -207,6 +243,17 @@ int main(int argc, char* argv[]) {
                 << "; must be one of none|jit|interpreter";
   }
 
+  std::string test_proc_backend_str = absl::GetFlag(FLAGS_test_proc_backend);
+  xls::dslx::TestProcBackend test_proc_backend;
+  if (test_proc_backend_str == "interpreter") {
+    test_proc_backend = xls::dslx::TestProcBackend::kInterpreter;
+  } else if (test_proc_backend_str == "jit") {
+    test_proc_backend = xls::dslx::TestProcBackend::kJit;
+  } else {
+    LOG(QFATAL) << "Invalid -test_proc_backend flag: " << test_proc_backend_str
+                << "; must be one of interpreter|jit";
+  }
+
   // Optional seed value.
   std::optional<int64_t> seed;
   if (int64_t seed_flag_value = absl::GetFlag(FLAGS_seed);
@@ -257,7 +304,8 @@ int main(int argc, char* argv[]) {
 
   absl::StatusOr<xls::dslx::TestResult> test_result = xls::dslx::RealMain(
       args[0], dslx_paths, test_filter, preference, compare_flag, execute,
-      warnings_as_errors, seed, trace_channels, max_ticks, xml_output_file);
+      warnings_as_errors, seed, trace_channels, max_ticks, test_parallelism,
+      test_proc_backend, xml_output_file);
   if (!test_result.ok()) {
     return xls::ExitStatus(test_result.status());
   }
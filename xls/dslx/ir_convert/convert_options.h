@@ -15,6 +15,8 @@
 #ifndef XLS_DSLX_IR_CONVERT_CONVERT_OPTIONS_H_
 #define XLS_DSLX_IR_CONVERT_CONVERT_OPTIONS_H_
 
+#include <cstdint>
+
 #include "xls/dslx/warning_kind.h"
 
 namespace xls::dslx {
@@ -41,6 +43,19 @@ struct ConvertOptions {
   //
   // Note that this is only used in IR conversion routines that do typechecking.
   WarningKindSet enabled_warnings = kDefaultWarningsSet;
+
+  // Number of threads used to convert the (non-proc) functions of the
+  // conversion order. Values greater than one convert function instances
+  // whose callees have all been converted concurrently, each into a private
+  // package, and merge the results back into the output package in conversion
+  // order -- the resulting set of functions is the same as for serial
+  // conversion.
+  int64_t conversion_threads = 1;
+
+  // Whether to emit structurally identical parametric instantiations (and
+  // for-loop bodies) once: a converted function that is equal to one emitted
+  // earlier is dropped and its call sites invoke the earlier function instead.
+  bool deduplicate_functions = false;
 };
 
 }  // namespace xls::dslx
@@ -26,8 +26,10 @@
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -35,6 +37,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "xls/common/casts.h"
@@ -116,6 +119,19 @@ absl::StatusOr<TypeDefinition> ToTypeDefinition(
   return type_ref_type_annotation->type_ref()->type_definition();
 }
 
+// Hash used to bucket candidates for function deduplication: the signature and
+// the multiset of node ops. Candidates in a bucket are compared with
+// Function::IsDefinitelyEqualTo().
+uint64_t StructuralHash(xls::Function* f) {
+  std::vector<Op> ops;
+  ops.reserve(f->node_count());
+  for (Node* node : f->nodes()) {
+    ops.push_back(node->op());
+  }
+  std::sort(ops.begin(), ops.end());
+  return absl::HashOf(f->GetType()->ToString(), ops);
+}
+
 }  // namespace
 
 absl::StatusOr<xls::Function*> EmitImplicitTokenEntryWrapper(
@@ -167,6 +183,52 @@ absl::StatusOr<xls::Function*> EmitImplicitTokenEntryWrapper(
   return fb.BuildWithReturnValue(result);
 }
 
+std::optional<xls::Function*> FindConvertedFunction(
+    const PackageData& package_data, std::string_view name) {
+  if (auto it = package_data.deduplicated_functions.find(name);
+      it != package_data.deduplicated_functions.end()) {
+    return it->second;
+  }
+  return package_data.conversion_info->package->TryGetFunction(name);
+}
+
+absl::StatusOr<xls::Function*> DeduplicateFunction(PackageData& package_data,
+                                                   xls::Function* f) {
+  // Foreign function templates may differ between otherwise equal functions.
+  if (f->ForeignFunctionData().has_value() || f->package()->GetTop() == f) {
+    return f;
+  }
+  std::vector<xls::Function*>& candidates =
+      package_data.functions_by_hash[StructuralHash(f)];
+  for (xls::Function* candidate : candidates) {
+    if (!candidate->IsDefinitelyEqualTo(f)) {
+      continue;
+    }
+    VLOG(3) << "Deduplicating function " << f->name() << " as "
+            << candidate->name();
+    auto* functions =
+        package_data.conversion_info->interface.mutable_functions();
+    for (int64_t i = functions->size() - 1; i >= 0; --i) {
+      if (functions->Get(i).base().name() == f->name()) {
+        functions->DeleteSubrange(i, 1);
+        break;
+      }
+    }
+    package_data.deduplicated_functions[f->name()] = candidate;
+    XLS_RETURN_IF_ERROR(f->package()->RemoveFunction(f));
+    return candidate;
+  }
+  candidates.push_back(f);
+  return f;
+}
+
+bool IsRegisteredForDeduplication(const PackageData& package_data,
+                                  xls::Function* f) {
+  auto it = package_data.functions_by_hash.find(StructuralHash(f));
+  return it != package_data.functions_by_hash.end() &&
+         absl::c_linear_search(it->second, f);
+}
+
 bool GetRequiresImplicitToken(dslx::Function& f, ImportData* import_data,
                               const ConvertOptions& options) {
   std::optional<bool> requires_opt =
@@ -1083,14 +1145,10 @@ absl::StatusOr<FunctionConverter::RangeData> FunctionConverter::GetRangeData(
 
   const auto* range_op = dynamic_cast<const Range*>(iterable);
   if (range_op != nullptr) {
-    XLS_ASSIGN_OR_RETURN(
-        start_value, ConstexprEvaluator::EvaluateToValue(
-                         import_data_, current_type_info_, kNoWarningCollector,
-                         bindings, range_op->start(), nullptr));
-    XLS_ASSIGN_OR_RETURN(
-        limit_value, ConstexprEvaluator::EvaluateToValue(
-                         import_data_, current_type_info_, kNoWarningCollector,
-                         bindings, range_op->end(), nullptr));
+    XLS_ASSIGN_OR_RETURN(start_value,
+                         EvaluateConstexprValue(bindings, range_op->start()));
+    XLS_ASSIGN_OR_RETURN(limit_value,
+                         EvaluateConstexprValue(bindings, range_op->end()));
   } else {
     const auto* iterable_call = dynamic_cast<const Invocation*>(iterable);
     if (iterable_call == nullptr) {
@@ -1113,14 +1171,8 @@ absl::StatusOr<FunctionConverter::RangeData> FunctionConverter::GetRangeData(
     Expr* start = iterable_call->args()[0];
     Expr* limit = iterable_call->args()[1];
 
-    XLS_ASSIGN_OR_RETURN(
-        start_value, ConstexprEvaluator::EvaluateToValue(
-                         import_data_, current_type_info_, kNoWarningCollector,
-                         bindings, start, nullptr));
-    XLS_ASSIGN_OR_RETURN(
-        limit_value, ConstexprEvaluator::EvaluateToValue(
-                         import_data_, current_type_info_, kNoWarningCollector,
-                         bindings, limit, nullptr));
+    XLS_ASSIGN_OR_RETURN(start_value, EvaluateConstexprValue(bindings, start));
+    XLS_ASSIGN_OR_RETURN(limit_value, EvaluateConstexprValue(bindings, limit));
   }
 
   if (!start_value.IsBits() || !limit_value.IsBits()) {
@@ -1371,6 +1423,10 @@ absl::Status FunctionConverter::HandleFor(const For* node) {
   XLS_ASSIGN_OR_RETURN(xls::Function * body_function,
                        body_builder_ptr->Build());
   VLOG(5) << "Converted body function: " << body_function->name();
+  if (options_.deduplicate_functions) {
+    XLS_ASSIGN_OR_RETURN(body_function,
+                         DeduplicateFunction(package_data_, body_function));
+  }
 
   std::vector<BValue> invariant_args;
   for (const NameDef* nd : relevant_name_defs) {
@@ -1574,9 +1630,15 @@ absl::StatusOr<BValue> FunctionConverter::HandleMap(const Invocation* node) {
                      free_set, node_parametric_env.value()));
   VLOG(5) << "Getting function with mangled name: " << mangled_name
           << " from package: " << package()->name();
-  XLS_ASSIGN_OR_RETURN(xls::Function * f, package()->GetFunction(mangled_name));
+  std::optional<xls::Function*> f =
+      FindConvertedFunction(package_data_, mangled_name);
+  if (!f.has_value()) {
+    return absl::NotFoundError(
+        absl::StrFormat("Function %s not found in package %s", mangled_name,
+                        package()->name()));
+  }
   return Def(node, [&](const SourceInfo& loc) -> BValue {
-    return function_builder_->Map(arg, f, loc);
+    return function_builder_->Map(arg, *f, loc);
   });
 }
 
@@ -1702,19 +1764,25 @@ absl::Status FunctionConverter::HandleUdfInvocation(const Invocation* node,
   return absl::OkStatus();
 }
 
+absl::StatusOr<InterpValue> FunctionConverter::EvaluateConstexprValue(
+    const ParametricEnv& bindings, const Expr* expr) {
+  std::optional<absl::MutexLock> lock;
+  if (package_data_.constexpr_mu != nullptr) {
+    lock.emplace(package_data_.constexpr_mu);
+  }
+  return ConstexprEvaluator::EvaluateToValue(import_data_, current_type_info_,
+                                             kNoWarningCollector, bindings,
+                                             expr, nullptr);
+}
+
 absl::StatusOr<FunctionConverter::AssertionLabelData>
 FunctionConverter::GetAssertionLabel(std::string_view caller_name,
                                      const Expr* label_expr, const Span& span) {
   ParametricEnv bindings(parametric_env_map_);
-  XLS_RETURN_IF_ERROR(
-      ConstexprEvaluator::Evaluate(import_data_, current_type_info_,
-                                   kNoWarningCollector, bindings, label_expr));
-
-  std::optional<InterpValue> start_value =
-      current_type_info_->GetConstExprOption(label_expr);
-  XLS_RET_CHECK(start_value.has_value());
+  XLS_ASSIGN_OR_RETURN(InterpValue start_value,
+                       EvaluateConstexprValue(bindings, label_expr));
   XLS_ASSIGN_OR_RETURN(std::optional<std::string> label,
-                       InterpValueAsString(start_value.value()));
+                       InterpValueAsString(start_value));
   XLS_RET_CHECK(label.has_value());
 
   // TODO(cdleary): 2024-03-12 We should put the label into the assertion
@@ -1880,7 +1948,8 @@ absl::Status FunctionConverter::HandleInvocation(const Invocation* node) {
     return values;
   };
 
-  if (std::optional<xls::Function*> f = package()->TryGetFunction(called_name);
+  if (std::optional<xls::Function*> f =
+          FindConvertedFunction(package_data_, called_name);
       f.has_value()) {
     XLS_ASSIGN_OR_RETURN(std::vector<BValue> args, accept_args());
     return HandleUdfInvocation(node, *f, std::move(args));
@@ -2471,6 +2540,14 @@ absl::Status FunctionConverter::HandleFunction(
   }
   function_proto_.reset();
 
+  if (options_.deduplicate_functions && node->IsParametric() && !is_top_) {
+    XLS_ASSIGN_OR_RETURN(xls::Function * deduplicated,
+                         DeduplicateFunction(package_data_, ir_fn));
+    if (deduplicated != ir_fn) {
+      return absl::OkStatus();
+    }
+  }
+
   package_data_.ir_to_dslx[ir_fn] = node;
   return absl::OkStatus();
 }
@@ -30,6 +30,7 @@
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/frontend/ast.h"
@@ -87,8 +88,33 @@ struct PackageData {
   PackageConversionData* conversion_info;
   absl::flat_hash_map<xls::FunctionBase*, dslx::Function*> ir_to_dslx;
   absl::flat_hash_set<xls::Function*> wrappers;
+  // When several function converters run concurrently (each with its own
+  // PackageData), constexpr evaluation -- which populates the bytecode cache
+  // of the shared ImportData -- is serialized on this mutex.
+  absl::Mutex* constexpr_mu = nullptr;
+  // Functions eligible for deduplication (see
+  // ConvertOptions::deduplicate_functions), bucketed by structural hash.
+  absl::flat_hash_map<uint64_t, std::vector<xls::Function*>> functions_by_hash;
+  // Names of functions dropped as duplicates, mapped to their replacement.
+  absl::flat_hash_map<std::string, xls::Function*> deduplicated_functions;
 };
 
+// Returns the function with the given name, following deduplicated names to
+// their replacement.
+std::optional<xls::Function*> FindConvertedFunction(
+    const PackageData& package_data, std::string_view name);
+
+// If `f` is structurally equal to a function registered earlier, removes `f`
+// (and its interface entry) from the package, notes the replacement in
+// `package_data.deduplicated_functions` and returns the earlier function.
+// Otherwise registers `f` for deduplication and returns it.
+absl::StatusOr<xls::Function*> DeduplicateFunction(PackageData& package_data,
+                                                   xls::Function* f);
+
+// Returns whether `f` was registered by DeduplicateFunction().
+bool IsRegisteredForDeduplication(const PackageData& package_data,
+                                  xls::Function* f);
+
 // A function that creates/returns a predicate value -- since this is used
 // frequently when making "chained" predicates through control constructs, we
 // give it an alias.
@@ -467,6 +493,12 @@ class FunctionConverter {
     std::string message;
   };
 
+  // Evaluates `expr` to its constexpr value in the current type information
+  // (see `ConstexprEvaluator::EvaluateToValue()`), holding
+  // `package_data_.constexpr_mu` if one is set.
+  absl::StatusOr<InterpValue> EvaluateConstexprValue(
+      const ParametricEnv& bindings, const Expr* expr);
+
   // Helper that provides the label we'll use for an emitted assertion as well
   // as the message we'll use in building the IR node.
   absl::StatusOr<AssertionLabelData> GetAssertionLabel(
@@ -24,6 +24,9 @@
 
 #include "xls/dslx/ir_convert/ir_converter.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
@@ -42,11 +45,13 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/common/visitor.h"
 #include "xls/dslx/channel_direction.h"
 #include "xls/dslx/command_line_utils.h"
@@ -70,11 +75,13 @@
 #include "xls/dslx/type_system/typecheck_module.h"
 #include "xls/dslx/warning_collector.h"
 #include "xls/dslx/warning_kind.h"
+#include "xls/ir/call_graph.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_scanner.h"
+#include "xls/ir/package.h"
 #include "xls/ir/value.h"
 #include "xls/ir/verifier.h"
 #include "xls/ir/xls_ir_interface.pb.h"
@@ -261,6 +268,218 @@ absl::Status CreateBoundaryChannels(absl::Span<Param* const> params,
   return absl::OkStatus();
 }
 
+// Returns the number of leading records in `order` which are plain (non-proc)
+// function instances -- GetOrder() emits functions before procs.
+int64_t CountLeadingFunctions(absl::Span<const ConversionRecord> order) {
+  int64_t count = 0;
+  while (count < order.size() && !order[count].proc_id().has_value()) {
+    ++count;
+  }
+  return count;
+}
+
+// State of a function instance being converted into a private package,
+// concurrently with others; see ConvertFunctionsConcurrently().
+struct PrivateConversion {
+  PackageConversionData conversion_info;
+  PackageData package_data{&conversion_info};
+  // Callee IR cloned from the output package, mapped to the original.
+  absl::flat_hash_map<const xls::Function*, xls::Function*> clone_to_original;
+};
+
+// Converts `records` -- plain function instances in conversion order -- on up
+// to `options.conversion_threads` threads.
+//
+// Each record is placed in the wave after the last wave holding one of its
+// callees. The records of a wave are converted concurrently, each by its own
+// FunctionConverter into a private package seeded with clones of its
+// (transitive) callees' IR. The new functions are then cloned into the output
+// package record by record, in conversion order, so the result does not
+// depend on thread scheduling.
+//
+// Returns false, having converted nothing, if a callee cannot be matched to an
+// earlier record; the caller should then convert the records serially.
+absl::StatusOr<bool> ConvertFunctionsConcurrently(
+    absl::Span<const ConversionRecord> records, ImportData* import_data,
+    const ConvertOptions& options, PackageData& package_data) {
+  xls::Package* package = package_data.conversion_info->package.get();
+
+  using InstanceKey = std::pair<const Function*, ParametricEnv>;
+  absl::flat_hash_map<InstanceKey, int64_t> record_index;
+  std::vector<std::vector<int64_t>> callee_records(records.size());
+  std::vector<int64_t> record_wave(records.size());
+  std::vector<std::vector<int64_t>> waves;
+  for (int64_t i = 0; i < records.size(); ++i) {
+    int64_t wave = 0;
+    for (const Callee& callee : records[i].callees()) {
+      auto it = record_index.find(
+          InstanceKey{callee.f(), callee.parametric_env()});
+      if (it == record_index.end()) {
+        VLOG(3) << "No record precedes callee " << callee.ToString()
+                << "; converting serially";
+        return false;
+      }
+      callee_records[i].push_back(it->second);
+      wave = std::max(wave, record_wave[it->second] + 1);
+    }
+    record_wave[i] = wave;
+    if (wave == waves.size()) {
+      waves.emplace_back();
+    }
+    waves[wave].push_back(i);
+    record_index.emplace(
+        InstanceKey{records[i].f(), records[i].parametric_env()}, i);
+  }
+  VLOG(3) << "Converting " << records.size() << " functions in "
+          << waves.size() << " waves";
+
+  // IR functions in the output package created for each record.
+  std::vector<std::vector<xls::Function*>> record_functions(records.size());
+  absl::Mutex constexpr_mu;
+  for (const std::vector<int64_t>& wave : waves) {
+    // File numbers are allocated in the output package up front so that
+    // positions in the private packages need no translation.
+    for (int64_t i : wave) {
+      if (records[i].module()->fs_path().has_value()) {
+        package->GetOrCreateFileno(
+            std::string{records[i].module()->fs_path().value()});
+      }
+    }
+    std::vector<std::unique_ptr<PrivateConversion>> conversions;
+    conversions.reserve(wave.size());
+    for (int64_t i = 0; i < wave.size(); ++i) {
+      auto conversion = std::make_unique<PrivateConversion>();
+      conversion->conversion_info.package =
+          std::make_unique<xls::Package>(package->name());
+      for (const auto& [fileno, filename] : package->fileno_to_name()) {
+        conversion->conversion_info.package->SetFileno(fileno, filename);
+      }
+      conversion->package_data.constexpr_mu = &constexpr_mu;
+      conversions.push_back(std::move(conversion));
+    }
+
+    // Only reads the output package, which is not modified until the wave is
+    // complete.
+    auto convert = [&](int64_t j) -> absl::Status {
+      const ConversionRecord& record = records[wave[j]];
+      PrivateConversion& conversion = *conversions[j];
+      absl::flat_hash_map<const xls::Function*, xls::Function*>
+          original_to_clone;
+      for (int64_t callee : callee_records[wave[j]]) {
+        for (xls::Function* root : record_functions[callee]) {
+          for (xls::FunctionBase* dependency : GetDependentFunctions(root)) {
+            xls::Function* original = dependency->AsFunctionOrDie();
+            if (original_to_clone.contains(original)) {
+              continue;
+            }
+            XLS_ASSIGN_OR_RETURN(
+                xls::Function * clone,
+                original->Clone(original->name(),
+                                conversion.conversion_info.package.get(),
+                                original_to_clone));
+            original_to_clone[original] = clone;
+            conversion.clone_to_original[clone] = original;
+            if (auto it = package_data.ir_to_dslx.find(original);
+                it != package_data.ir_to_dslx.end()) {
+              conversion.package_data.ir_to_dslx[clone] = it->second;
+            }
+            if (package_data.wrappers.contains(original)) {
+              conversion.package_data.wrappers.insert(clone);
+            }
+            if (IsRegisteredForDeduplication(package_data, original)) {
+              XLS_RETURN_IF_ERROR(
+                  DeduplicateFunction(conversion.package_data, clone).status());
+            }
+          }
+        }
+      }
+      for (const auto& [name, replacement] :
+           package_data.deduplicated_functions) {
+        if (auto it = original_to_clone.find(replacement);
+            it != original_to_clone.end()) {
+          conversion.package_data.deduplicated_functions[name] = it->second;
+        }
+      }
+      ProcConversionData proc_data;
+      return ConvertOneFunctionInternal(conversion.package_data, record,
+                                        import_data, &proc_data, options);
+    };
+    std::vector<absl::Status> statuses(wave.size());
+    std::atomic<int64_t> next = 0;
+    auto worker = [&]() {
+      for (int64_t j = next++; j < wave.size(); j = next++) {
+        statuses[j] = convert(j);
+      }
+    };
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 0;
+         i < std::min<int64_t>(options.conversion_threads, wave.size()); ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+    for (const absl::Status& status : statuses) {
+      XLS_RETURN_IF_ERROR(status);
+    }
+
+    for (int64_t j = 0; j < wave.size(); ++j) {
+      PrivateConversion& conversion = *conversions[j];
+      absl::flat_hash_map<const xls::Function*, xls::Function*> remapping =
+          conversion.clone_to_original;
+      absl::flat_hash_set<std::string> merged_names;
+      for (const std::unique_ptr<xls::Function>& f :
+           conversion.conversion_info.package->functions()) {
+        if (remapping.contains(f.get())) {
+          continue;
+        }
+        // Helpers (e.g. for mapped builtins) are created on first use, so an
+        // earlier record may already have created the same one.
+        if (std::optional<xls::Function*> existing =
+                package->TryGetFunction(f->name());
+            existing.has_value()) {
+          remapping[f.get()] = *existing;
+          continue;
+        }
+        XLS_ASSIGN_OR_RETURN(xls::Function * merged,
+                             f->Clone(f->name(), package, remapping));
+        // Deduplicate against functions from other private packages.
+        if (IsRegisteredForDeduplication(conversion.package_data, f.get())) {
+          XLS_ASSIGN_OR_RETURN(merged,
+                               DeduplicateFunction(package_data, merged));
+        }
+        remapping[f.get()] = merged;
+        record_functions[wave[j]].push_back(merged);
+        if (merged->name() != f->name()) {
+          continue;
+        }
+        merged_names.insert(f->name());
+        if (auto it = conversion.package_data.ir_to_dslx.find(f.get());
+            it != conversion.package_data.ir_to_dslx.end()) {
+          package_data.ir_to_dslx[merged] = it->second;
+        }
+        if (conversion.package_data.wrappers.contains(f.get())) {
+          package_data.wrappers.insert(merged);
+        }
+      }
+      for (const auto& [name, replacement] :
+           conversion.package_data.deduplicated_functions) {
+        xls::Function* merged = remapping.at(replacement);
+        if (package_data.deduplicated_functions.emplace(name, merged).second) {
+          record_functions[wave[j]].push_back(merged);
+        }
+      }
+      for (const PackageInterfaceProto::Function& function :
+           conversion.conversion_info.interface.functions()) {
+        if (merged_names.contains(function.base().name())) {
+          *package_data.conversion_info->interface.add_functions() = function;
+        }
+      }
+    }
+  }
+  return true;
+}
+
 // Converts the functions in the call graph in a specified order.
 //
 // Args:
@@ -336,7 +555,19 @@ absl::Status ConvertCallGraph(absl::Span<const ConversionRecord> order,
         first_proc_config->type_info(), package_data, &proc_data));
   }
 
-  for (const ConversionRecord& record : order) {
+  absl::Span<const ConversionRecord> remaining = order;
+  if (options.conversion_threads > 1) {
+    int64_t function_count = CountLeadingFunctions(order);
+    XLS_ASSIGN_OR_RETURN(
+        bool converted,
+        ConvertFunctionsConcurrently(order.subspan(0, function_count),
+                                     import_data, options, package_data));
+    if (converted) {
+      remaining = order.subspan(function_count);
+    }
+  }
+
+  for (const ConversionRecord& record : remaining) {
     VLOG(3) << "Converting to IR: " << record.ToString();
     XLS_RETURN_IF_ERROR(ConvertOneFunctionInternal(
         package_data, record, import_data, &proc_data, options));
@@ -409,6 +640,15 @@ absl::Status ConvertOneFunctionIntoPackage(Module* module, Function* fn,
                                                parametric_env, options, conv);
 }
 
+absl::Status ConvertOneFunctionIntoPackage(Module* module, Proc* proc,
+                                           ImportData* import_data,
+                                           const ParametricEnv* parametric_env,
+                                           const ConvertOptions& options,
+                                           PackageConversionData* conv) {
+  return ConvertOneFunctionIntoPackageInternal(module, proc, import_data,
+                                               parametric_env, options, conv);
+}
+
 absl::Status ConvertOneFunctionIntoPackage(Module* module,
                                            std::string_view entry_function_name,
                                            ImportData* import_data,
@@ -96,6 +96,15 @@ absl::Status ConvertOneFunctionIntoPackage(Module* module, Function* fn,
                                            const ConvertOptions& options,
                                            PackageConversionData* conv);
 
+// As above but takes a proc in the module (e.g. the proc of a test proc) as the
+// top of the proc network to convert. Channels passed to its config function
+// become the boundary channels of the package.
+absl::Status ConvertOneFunctionIntoPackage(Module* module, Proc* proc,
+                                           ImportData* import_data,
+                                           const ParametricEnv* parametric_env,
+                                           const ConvertOptions& options,
+                                           PackageConversionData* conv);
+
 
 // Converts DSLX files at paths into a package.
 //
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>  // NOLINT
 #include <iostream>
@@ -35,9 +36,11 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/import_routines.h"
 #include "xls/dslx/ir_convert/conversion_info.h"
 #include "xls/dslx/ir_convert/convert_options.h"
 #include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/dslx/type_info_cache_flags.h"
 #include "xls/dslx/warning_kind.h"
 #include "xls/ir/package.h"
 
@@ -75,6 +78,13 @@ ABSL_FLAG(std::optional<std::string>, interface_proto_file, std::nullopt,
 ABSL_FLAG(std::optional<std::string>, interface_textproto_file, std::nullopt,
           "File to store a xls.PackageInterfaceProto containing extern type "
           "information and interface specs in textproto format");
+ABSL_FLAG(int64_t, import_prefetch_threads, 1,
+          "Number of threads used to locate and parse the modules imported "
+          "by the input before type checking it.");
+ABSL_FLAG(int64_t, conversion_threads, 1,
+          "Number of threads used to convert independent functions to IR.");
+ABSL_FLAG(bool, deduplicate_functions, false,
+          "Emit structurally identical parametric instantiations once.");
 
 namespace xls::dslx {
 namespace {
@@ -114,6 +124,8 @@ absl::Status RealMain(
       .verify_ir = verify_ir,
       .warnings_as_errors = warnings_as_errors,
       .enabled_warnings = enabled_warnings,
+      .conversion_threads = absl::GetFlag(FLAGS_conversion_threads),
+      .deduplicate_functions = absl::GetFlag(FLAGS_deduplicate_functions),
   };
 
   // The following checks are performed inside ConvertFilesToPackage(), but we
@@ -163,6 +175,12 @@ int main(int argc, char* argv[]) {
                 << ": `" << absl::StrJoin(args, " ") << "`; want " << argv[0]
                 << " <input-file>";
   }
+  if (absl::Status status = xls::dslx::InitTypeInfoCacheFromFlags();
+      !status.ok()) {
+    LOG(QFATAL) << "Unable to initialize type info cache: " << status;
+  }
+  xls::dslx::SetDefaultImportPrefetchThreadCount(
+      absl::GetFlag(FLAGS_import_prefetch_threads));
   // "-" is a special path that is shorthand for /dev/stdin. Update here as
   // there isn't a better place later.
   for (auto& arg : args) {
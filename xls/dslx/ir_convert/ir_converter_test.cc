@@ -20,28 +20,38 @@
 
 #include "xls/dslx/ir_convert/ir_converter.h"
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
 #include "xls/common/golden_files.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/import_data.h"
+#include "xls/dslx/ir_convert/conversion_info.h"
 #include "xls/dslx/ir_convert/convert_options.h"
 #include "xls/dslx/parse_and_typecheck.h"
+#include "xls/ir/function.h"
+#include "xls/ir/xls_ir_interface.pb.h"
 
 namespace xls::dslx {
 namespace {
 
 using status_testing::StatusIs;
 using ::testing::HasSubstr;
+using ::testing::Not;
+using ::testing::UnorderedElementsAreArray;
 
 constexpr ConvertOptions kFailNoPos = {
     .emit_positions = false,
@@ -54,6 +64,11 @@ void ExpectIr(std::string_view got, std::string_view test_name) {
       got);
 }
 
+int64_t CountOccurrences(std::string_view text, std::string_view needle) {
+  std::vector<std::string_view> pieces = absl::StrSplit(text, needle);
+  return pieces.size() - 1;
+}
+
 std::string TestName() {
   return ::testing::UnitTest::GetInstance()->current_test_info()->name();
 }
@@ -2197,5 +2212,104 @@ proc Counter {
   ExpectIr(converted, TestName());
 }
 
+TEST(IrConverterTest, ConcurrentConversionMatchesSerialConversion) {
+  constexpr std::string_view program =
+      R"(
+fn square<N: u32>(x: uN[N]) -> uN[N] { x * x }
+
+fn leading_zeros(x: u8[4]) -> u8[4] { map(x, clz) }
+
+fn checked(x: u32) -> u32 {
+  if x == u32:0 { fail!("zero", u32:0) } else { x }
+}
+
+fn sum_squares(x: u32[4]) -> u32 {
+  for (i, accum): (u32, u32) in u32:0..u32:4 {
+    accum + square(x[i])
+  }(u32:0)
+}
+
+fn narrow(x: u8[4]) -> u8 {
+  let zeros = map(x, clz);
+  square(zeros[0]) + square(x[1])
+}
+
+fn main(x: u32[4], y: u8[4]) -> u32 {
+  let zeros = leading_zeros(y);
+  checked(sum_squares(x)) + (narrow(zeros) as u32)
+}
+)";
+
+  // Node ids differ between the two modes, so compare function signatures and
+  // sizes rather than the IR text.
+  auto convert = [&](int64_t conversion_threads)
+      -> absl::StatusOr<std::vector<std::string>> {
+    auto import_data = CreateImportDataForTest();
+    XLS_ASSIGN_OR_RETURN(
+        TypecheckedModule tm,
+        ParseAndTypecheck(program, "test_module.x", "test_module",
+                          &import_data));
+    XLS_ASSIGN_OR_RETURN(
+        PackageConversionData converted,
+        ConvertModuleToPackage(
+            tm.module, &import_data,
+            ConvertOptions{.emit_positions = false,
+                           .conversion_threads = conversion_threads}));
+    std::vector<std::string> functions;
+    for (const std::unique_ptr<xls::Function>& f :
+         converted.package->functions()) {
+      functions.push_back(absl::StrFormat("%s: %s, %d nodes", f->name(),
+                                          f->GetType()->ToString(),
+                                          f->node_count()));
+    }
+    for (const PackageInterfaceProto::Function& f :
+         converted.interface.functions()) {
+      functions.push_back(absl::StrCat("interface: ", f.base().name()));
+    }
+    return functions;
+  };
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::string> serial, convert(1));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::string> concurrent, convert(4));
+  EXPECT_THAT(concurrent, UnorderedElementsAreArray(serial));
+}
+
+TEST(IrConverterTest, DeduplicateIdenticalParametricInstantiations) {
+  constexpr std::string_view program =
+      R"(
+fn add_one<N: u32>(x: u32) -> u32 { x + u32:1 }
+
+fn sum<N: u32>(x: u32[4]) -> u32 {
+  for (i, accum): (u32, u32) in u32:0..u32:4 {
+    accum + x[i]
+  }(u32:0)
+}
+
+fn main(x: u32[4]) -> u32 {
+  add_one<u32:1>(sum<u32:1>(x)) + add_one<u32:2>(sum<u32:2>(x))
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string duplicated,
+      ConvertModuleForTest(program, ConvertOptions{.emit_positions = false}));
+  EXPECT_EQ(CountOccurrences(duplicated, "\nfn "), 7);
+
+  for (int64_t conversion_threads : {1, 4}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::string converted,
+        ConvertModuleForTest(
+            program, ConvertOptions{.emit_positions = false,
+                                    .conversion_threads = conversion_threads,
+                                    .deduplicate_functions = true}));
+    // main, one instance of each parametric function and one loop body.
+    EXPECT_EQ(CountOccurrences(converted, "\nfn "), 4) << converted;
+    EXPECT_THAT(converted, Not(HasSubstr("__test_module__add_one__2")));
+    EXPECT_THAT(converted, Not(HasSubstr("__test_module__sum__2")));
+    EXPECT_EQ(
+        CountOccurrences(converted, "to_apply=__test_module__add_one__1"), 2);
+  }
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -15,7 +15,7 @@
 // Very simple language server for dslx that
 //  - keeps track of open files and updates them whenever they are
 //    changed in the editor (hidden under the hood).
-//  - On every change, attempts to parse and send back diagnostics
+//  - After changes, attempts to parse and send back diagnostics
 //    on errors/warnings.
 //
 // Heavily commented below as this serves as a sample.
@@ -31,9 +31,13 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/flags/flag.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "nlohmann/json.hpp"
 #include "external/verible/common/lsp/json-rpc-dispatcher.h"
 #include "external/verible/common/lsp/lsp-protocol.h"
@@ -41,8 +45,10 @@
 #include "external/verible/common/lsp/message-stream-splitter.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/lsp/language_server_adapter.h"
+#include "xls/dslx/type_info_cache_flags.h"
 
 ABSL_FLAG(std::string, stdlib_path, xls::kDefaultDslxStdlibPath,
           "Path to DSLX standard library files.");
@@ -90,6 +96,25 @@ InitializeResult InitializeServer(const nlohmann::json& params) {
   };
 }
 
+// Requests taking longer than this are reported in the LSP log, as the delay
+// is likely noticeable in the editor.
+constexpr absl::Duration kSlowRequestThreshold = absl::Milliseconds(200);
+
+// Wraps the handler for LSP request `method` so its latency is recorded.
+template <typename Params, typename Handler>
+auto WithLatencyLogging(std::string_view method, Handler handler) {
+  return [method, handler = std::move(handler)](const Params& params) {
+    const absl::Time start = absl::Now();
+    auto result = handler(params);
+    const absl::Duration duration = absl::Now() - start;
+    VLOG(1) << method << " took " << duration;
+    if (duration > kSlowRequestThreshold) {
+      LspLog() << method << " took " << duration << "\n";
+    }
+    return result;
+  };
+}
+
 // On text change: attempt to parse the buffer and emit diagnostics if needed.
 void TextChangeHandler(const std::string& file_uri,
                        const EditTextBuffer& text_buffer,
@@ -107,6 +132,7 @@ void TextChangeHandler(const std::string& file_uri,
 }
 
 absl::Status RealMain() {
+  XLS_RETURN_IF_ERROR(InitTypeInfoCacheFromFlags());
   const std::string stdlib_path = absl::GetFlag(FLAGS_stdlib_path);
   const std::string dslx_path = absl::GetFlag(FLAGS_dslx_path);
   const std::vector<fs::path> dslx_paths = absl::StrSplit(dslx_path, ':');
@@ -162,54 +188,94 @@ absl::Status RealMain() {
   // The text buffer collection can call a callback whenever there is a change.
   // We're using this to hook up our parser that then can send diagnostic
   // messages back.
+  //
+  // Changes are not analyzed right away: the listener only marks the buffer
+  // as dirty, and dirty buffers are analyzed once all the messages read so far
+  // have been dispatched. A burst of edits arriving together (e.g. from fast
+  // typing) thus costs a single reparse, and versions of a buffer that were
+  // superseded before we got to them are never analyzed.
+  absl::flat_hash_set<std::string> dirty_uris;
   buffers.SetChangeListener(
       [&](const std::string& uri, const EditTextBuffer* buffer) {
         if (buffer == nullptr) {
+          dirty_uris.erase(uri);
           return;  // buffer got deleted. No interest.
         }
-        TextChangeHandler(uri, *buffer, dispatcher, language_server_adapter);
+        dirty_uris.insert(uri);
       });
 
+  // Analyzes the buffer for `uri` if it has pending changes. Requests call
+  // this first so that they are answered with respect to the latest contents.
+  auto flush_changes = [&](const std::string& uri) {
+    if (!dirty_uris.contains(uri)) {
+      return;
+    }
+    dirty_uris.erase(uri);
+    if (const EditTextBuffer* buffer = buffers.findBufferByUri(uri)) {
+      TextChangeHandler(uri, *buffer, dispatcher, language_server_adapter);
+    }
+  };
+
   dispatcher.AddRequestHandler(
       "textDocument/documentSymbol",
-      [&](const verible::lsp::DocumentSymbolParams& params) {
-        return language_server_adapter.GenerateDocumentSymbols(
-            params.textDocument.uri);
-      });
+      WithLatencyLogging<verible::lsp::DocumentSymbolParams>(
+          "textDocument/documentSymbol",
+          [&](const verible::lsp::DocumentSymbolParams& params) {
+            flush_changes(params.textDocument.uri);
+            return language_server_adapter.GenerateDocumentSymbols(
+                params.textDocument.uri);
+          }));
 
   dispatcher.AddRequestHandler(
       "textDocument/definition",
-      [&](const verible::lsp::DefinitionParams& params) {
-        return language_server_adapter.FindDefinitions(params.textDocument.uri,
-                                                       params.position);
-      });
+      WithLatencyLogging<verible::lsp::DefinitionParams>(
+          "textDocument/definition",
+          [&](const verible::lsp::DefinitionParams& params) {
+            flush_changes(params.textDocument.uri);
+            return language_server_adapter.FindDefinitions(
+                params.textDocument.uri, params.position);
+          }));
 
   dispatcher.AddRequestHandler(
       "textDocument/formatting",
-      [&](const verible::lsp::DocumentFormattingParams& params) {
-        auto text_edits_or =
-            language_server_adapter.FormatDocument(params.textDocument.uri);
-        if (text_edits_or.ok()) {
-          return text_edits_or.value();
-        }
-        LspLog() << "could not format document; status: "
-                 << text_edits_or.status() << "\n";
-        return std::vector<verible::lsp::TextEdit>{};
-      });
+      WithLatencyLogging<verible::lsp::DocumentFormattingParams>(
+          "textDocument/formatting",
+          [&](const verible::lsp::DocumentFormattingParams& params) {
+            flush_changes(params.textDocument.uri);
+            auto text_edits_or =
+                language_server_adapter.FormatDocument(params.textDocument.uri);
+            if (text_edits_or.ok()) {
+              return text_edits_or.value();
+            }
+            LspLog() << "could not format document; status: "
+                     << text_edits_or.status() << "\n";
+            return std::vector<verible::lsp::TextEdit>{};
+          }));
 
   dispatcher.AddRequestHandler(
       "textDocument/documentLink",
-      [&](const verible::lsp::DocumentLinkParams& params) {
-        return language_server_adapter.ProvideImportLinks(
-            params.textDocument.uri);
-      });
+      WithLatencyLogging<verible::lsp::DocumentLinkParams>(
+          "textDocument/documentLink",
+          [&](const verible::lsp::DocumentLinkParams& params) {
+            flush_changes(params.textDocument.uri);
+            return language_server_adapter.ProvideImportLinks(
+                params.textDocument.uri);
+          }));
 
   // Main loop. Feeding the stream-splitter that then calls the dispatcher.
+  // Once everything read has been dispatched, the buffers changed in the
+  // meantime are analyzed.
   absl::Status status = absl::OkStatus();
   while (status.ok() && !shutdown_requested) {
     status = stream_splitter.PullFrom([](char* buf, int size) -> int {  //
       return static_cast<int>(read(STDIN_FILENO, buf, size));
     });
+    std::vector<std::string> uris(dirty_uris.begin(), dirty_uris.end());
+    for (const std::string& uri : uris) {
+      const absl::Time start = absl::Now();
+      flush_changes(uri);
+      VLOG(1) << "Analyzing " << uri << " took " << absl::Now() - start;
+    }
   }
 
   LspLog() << status << "\n";
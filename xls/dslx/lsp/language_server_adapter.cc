@@ -19,9 +19,11 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <system_error>  // NOLINT
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -30,6 +32,7 @@
 #include "external/verible/common/lsp/lsp-file-utils.h"
 #include "external/verible/common/lsp/lsp-protocol-enums.h"
 #include "external/verible/common/lsp/lsp-protocol.h"
+#include "xls/dslx/bytecode/bytecode_cache.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/extract_module_name.h"
 #include "xls/dslx/fmt/ast_fmt.h"
@@ -82,6 +85,23 @@ void AppendDiagnosticFromTypecheck(
   }
 }
 
+// Returns true if all the files in `import_mtimes` still have the recorded
+// modification time.
+bool ImportedFilesUnchanged(
+    const absl::flat_hash_map<std::string, std::filesystem::file_time_type>&
+        import_mtimes) {
+  for (const auto& [path, mtime] : import_mtimes) {
+    std::error_code ec;
+    std::filesystem::file_time_type current =
+        std::filesystem::last_write_time(path, ec);
+    if (ec || current != mtime) {
+      VLOG(1) << "Imported file changed: " << path;
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 LanguageServerAdapter::LanguageServerAdapter(
@@ -97,6 +117,31 @@ const LanguageServerAdapter::ParseData* LanguageServerAdapter::FindParsedForUri(
   return nullptr;
 }
 
+std::unique_ptr<ImportData> LanguageServerAdapter::TakeImportData(
+    ParseData* previous, std::string_view module_name) {
+  // A failed analysis may leave partial state (e.g. type information for a
+  // module that was never added) behind, so only successful ones are reused.
+  if (previous == nullptr || !previous->ok() ||
+      !ImportedFilesUnchanged(previous->import_mtimes)) {
+    return CreateImportDataPtr(stdlib_, dslx_paths_, kAllWarningsSet);
+  }
+
+  absl::StatusOr<ImportTokens> subject = ImportTokens::FromString(module_name);
+  absl::Status removed =
+      subject.ok() ? previous->import_data->Remove(*subject) : subject.status();
+  if (!removed.ok()) {
+    LspLog() << "Could not invalidate module " << module_name
+             << "; status: " << removed << "\n";
+    return CreateImportDataPtr(stdlib_, dslx_paths_, kAllWarningsSet);
+  }
+  std::unique_ptr<ImportData> import_data = std::move(previous->import_data);
+  // Bytecode may refer to functions and type information of the removed
+  // module.
+  import_data->SetBytecodeCache(
+      std::make_unique<BytecodeCache>(import_data.get()));
+  return import_data;
+}
+
 absl::Status LanguageServerAdapter::Update(std::string_view file_uri,
                                            std::string_view dslx_code) {
   const absl::Time start = absl::Now();
@@ -109,25 +154,52 @@ absl::Status LanguageServerAdapter::Update(std::string_view file_uri,
 
   auto inserted = uri_parse_data_.emplace(file_uri, nullptr);
   std::unique_ptr<ParseData>& insert_value = inserted.first->second;
-
-  ImportData import_data =
-      CreateImportData(stdlib_, dslx_paths_, kAllWarningsSet);
   const std::string& module_name = module_name_or.value();
 
+  if (insert_value != nullptr && insert_value->ok() &&
+      insert_value->dslx_code == dslx_code &&
+      ImportedFilesUnchanged(insert_value->import_mtimes)) {
+    VLOG(1) << "Contents of " << file_uri << " unchanged; skipping analysis";
+    return absl::OkStatus();
+  }
+
+  std::unique_ptr<ImportData> import_data =
+      TakeImportData(insert_value.get(), module_name);
+
   std::vector<CommentData> comments;
   absl::StatusOr<TypecheckedModule> typechecked_module =
       ParseAndTypecheck(dslx_code, /*path=*/file_uri,
-                        /*module_name=*/module_name, &import_data, &comments);
+                        /*module_name=*/module_name, import_data.get(),
+                        &comments);
+
+  absl::flat_hash_map<std::string, std::filesystem::file_time_type>
+      import_mtimes;
+  if (typechecked_module.ok()) {
+    for (const std::filesystem::path& path : import_data->GetModulePaths()) {
+      std::error_code ec;
+      std::filesystem::file_time_type mtime =
+          std::filesystem::last_write_time(path, ec);
+      // Note: the buffer itself is named by a URI and so is not found here.
+      if (!ec) {
+        import_mtimes[path.string()] = mtime;
+      }
+    }
+  }
 
   if (typechecked_module.ok()) {
     insert_value.reset(new ParseData{
-        std::move(import_data), TypecheckedModuleWithComments{
-                                    .tm = std::move(typechecked_module).value(),
-                                    .comments = Comments::Create(comments),
-                                }});
+        .import_data = std::move(import_data),
+        .tmc =
+            TypecheckedModuleWithComments{
+                .tm = std::move(typechecked_module).value(),
+                .comments = Comments::Create(comments),
+            },
+        .dslx_code = std::string{dslx_code},
+        .import_mtimes = std::move(import_mtimes)});
   } else {
-    insert_value.reset(
-        new ParseData{std::move(import_data), typechecked_module.status()});
+    insert_value.reset(new ParseData{.import_data = std::move(import_data),
+                                     .tmc = typechecked_module.status(),
+                                     .dslx_code = std::string{dslx_code}});
   }
 
   const absl::Duration duration = absl::Now() - start;
@@ -191,6 +263,23 @@ LanguageServerAdapter::FormatDocument(std::string_view uri) const {
   return ResultT{};
 }
 
+absl::StatusOr<std::vector<verible::lsp::TextEdit>>
+LanguageServerAdapter::FormatRange(std::string_view uri,
+                                   const verible::lsp::Range& range) const {
+  using ResultT = std::vector<verible::lsp::TextEdit>;
+  ResultT result;
+  if (const ParseData* parsed = FindParsedForUri(uri); parsed && parsed->ok()) {
+    for (AutoFmtEdit& edit :
+         AutoFmtRange(parsed->module(), parsed->comments(),
+                      ConvertLspRangeToSpan(uri, range))) {
+      result.push_back(
+          verible::lsp::TextEdit{.range = ConvertSpanToLspRange(edit.span),
+                                 .newText = std::move(edit.text)});
+    }
+  }
+  return result;
+}
+
 std::vector<verible::lsp::DocumentLink>
 LanguageServerAdapter::ProvideImportLinks(std::string_view uri) const {
   std::vector<verible::lsp::DocumentLink> result;
@@ -198,7 +287,7 @@ LanguageServerAdapter::ProvideImportLinks(std::string_view uri) const {
     const Module& module = parsed->module();
     for (const auto& [_, import_node] : module.GetImportByName()) {
       const ImportTokens tok(import_node->subject());
-      absl::StatusOr<ModuleInfo*> info = parsed->import_data.Get(tok);
+      absl::StatusOr<ModuleInfo*> info = parsed->import_data->Get(tok);
       if (!info.ok()) {
         continue;
       }
@@ -48,9 +48,15 @@ class LanguageServerAdapter {
   LanguageServerAdapter(std::string_view stdlib,
                         const std::vector<std::filesystem::path>& dslx_paths);
 
-  // Note: this is parsing is triggered for every keystroke. Fine for now.
-  // Successful and unsuccessful parses are memoized so that their status
-  // and can be queried.
+  // Note: this is parsing is triggered for every change the language server
+  // decides to analyze. Successful and unsuccessful parses are memoized so
+  // that their status and can be queried.
+  //
+  // Analysis is incremental: after a successful update the modules imported by
+  // the buffer stay typechecked, and the next update of the same buffer only
+  // reparses and retypechecks the buffer itself, unless one of the imported
+  // files changed on disk in the meantime. Updating a buffer with the contents
+  // it was last analyzed with is a no-op.
   // Implementation note: since we currently do not react to buffer closed
   // events in the buffer change listener, we keep track of every file ever
   // opened and never delete.
@@ -76,6 +82,14 @@ class LanguageServerAdapter {
   absl::StatusOr<std::vector<verible::lsp::TextEdit>> FormatDocument(
       std::string_view uri) const;
 
+  // Implements the functionality for range formatting:
+  // https://microsoft.github.io/language-server-protocol/specifications/lsp/3.17/specification/#textDocument_rangeFormatting
+  //
+  // Only the top-level members that intersect `range` are formatted (one edit
+  // per member), which keeps format-on-save cheap for large files.
+  absl::StatusOr<std::vector<verible::lsp::TextEdit>> FormatRange(
+      std::string_view uri, const verible::lsp::Range& range) const;
+
   // Present links to imports to directly open the relevant file.
   std::vector<verible::lsp::DocumentLink> ProvideImportLinks(
       std::string_view uri) const;
@@ -86,6 +100,12 @@ class LanguageServerAdapter {
   // Find parse result of opened file with given URI or nullptr, if not opened.
   const ParseData* FindParsedForUri(std::string_view uri) const;
 
+  // Returns an import data for analyzing a new version of the module named
+  // `module_name` -- the one used for `previous` with the module removed if
+  // it can be reused, or a fresh one otherwise.
+  std::unique_ptr<ImportData> TakeImportData(ParseData* previous,
+                                             std::string_view module_name);
+
   struct TypecheckedModuleWithComments {
     TypecheckedModule tm;
     Comments comments;
@@ -95,9 +115,18 @@ class LanguageServerAdapter {
   // Note, each buffer independently currently keeps track of its import data.
   // This could maybe be considered to be put in a single place.
   struct ParseData {
-    ImportData import_data;
+    std::unique_ptr<ImportData> import_data;
     absl::StatusOr<TypecheckedModuleWithComments> tmc;
 
+    // The buffer contents this data was computed from.
+    std::string dslx_code;
+
+    // Modification time of every file loaded into `import_data` when the
+    // buffer was analyzed; used to decide whether `import_data` can be reused
+    // for the next version of the buffer.
+    absl::flat_hash_map<std::string, std::filesystem::file_time_type>
+        import_mtimes;
+
     bool ok() const { return tmc.ok(); }
     absl::Status status() const { return tmc.status(); }
 
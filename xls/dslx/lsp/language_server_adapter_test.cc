@@ -14,6 +14,8 @@
 
 #include "xls/dslx/lsp/language_server_adapter.h"
 
+#include <chrono>  // NOLINT
+#include <filesystem>  // NOLINT
 #include <string>
 #include <string_view>
 #include <vector>
@@ -24,6 +26,8 @@
 #include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
 #include "external/verible/common/lsp/lsp-protocol.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 
@@ -193,5 +197,84 @@ fn messy() {
 )");
 }
 
+TEST(LanguageServerAdapterTest, RangeFormattingOnlyTouchesChangedMembers) {
+  LanguageServerAdapter adapter(kDefaultDslxStdlibPath, /*dslx_paths=*/{"."});
+  constexpr std::string_view kUri = "memfile://test.x";
+  XLS_ASSERT_OK(adapter.Update(kUri, R"(fn f() -> u32 {u32:0}
+
+fn g() -> u32 {u32:1}
+)"));
+  const auto kChangedRange =
+      verible::lsp::Range{.start = verible::lsp::Position{2, 0},
+                          .end = verible::lsp::Position{2, 4}};
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<verible::lsp::TextEdit> edits,
+                           adapter.FormatRange(kUri, kChangedRange));
+
+  ASSERT_EQ(edits.size(), 1);
+  const verible::lsp::TextEdit& edit = edits.at(0);
+  EXPECT_EQ(edit.range.start.line, 2);
+  EXPECT_EQ(edit.newText, "fn g() -> u32 { u32:1 }");
+}
+
+// Repeated updates of a buffer reuse its typechecked imports; edits of the
+// buffer itself must still be reflected in the results.
+TEST(LanguageServerAdapterTest, IncrementalUpdatesOfBufferWithImports) {
+  LanguageServerAdapter adapter(kDefaultDslxStdlibPath, /*dslx_paths=*/{"."});
+  constexpr std::string_view kUri = "memfile://test.x";
+  XLS_ASSERT_OK(adapter.Update(kUri, R"(import std;
+fn f(x: u32) -> u32 { std::clog2(x) }
+)"));
+  EXPECT_EQ(adapter.GenerateDocumentSymbols(kUri).size(), 1);
+
+  // An unchanged buffer is not reanalyzed (and still reports success).
+  XLS_ASSERT_OK(adapter.Update(kUri, R"(import std;
+fn f(x: u32) -> u32 { std::clog2(x) }
+)"));
+
+  XLS_ASSERT_OK(adapter.Update(kUri, R"(import std;
+fn f(x: u32) -> u32 { std::clog2(x) }
+fn g(x: u32) -> u32 { std::clog2(x) + u32:1 }
+)"));
+  EXPECT_EQ(adapter.GenerateDocumentSymbols(kUri).size(), 2);
+  EXPECT_EQ(adapter.ProvideImportLinks(kUri).size(), 1);
+
+  EXPECT_THAT(adapter.Update(kUri, R"(import std;
+fn f(x: u32) -> u32 { std::not_a_function(x) }
+)"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_EQ(adapter.GenerateParseDiagnostics(kUri).size(), 1);
+
+  XLS_ASSERT_OK(adapter.Update(kUri, R"(import std;
+fn f(x: u32) -> u32 { std::clog2(x) }
+)"));
+  EXPECT_EQ(adapter.GenerateParseDiagnostics(kUri).size(), 0);
+}
+
+// Imported files that change on disk are reloaded on the next update.
+TEST(LanguageServerAdapterTest, ImportChangedOnDiskIsReloaded) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  const std::filesystem::path imported_path = temp_dir.path() / "imported.x";
+  XLS_ASSERT_OK(SetFileContents(imported_path, "pub fn f() -> u32 { u32:1 }"));
+
+  LanguageServerAdapter adapter(kDefaultDslxStdlibPath,
+                                /*dslx_paths=*/{temp_dir.path()});
+  constexpr std::string_view kUri = "memfile://test.x";
+  XLS_ASSERT_OK(adapter.Update(
+      kUri, "import imported;\nfn g() -> u32 { imported::f() }"));
+
+  XLS_ASSERT_OK(SetFileContents(imported_path, R"(pub fn f() -> u32 { u32:1 }
+pub fn h() -> u32 { u32:2 }
+)"));
+  // Make sure the modification is observable regardless of the resolution of
+  // the file system timestamps.
+  std::filesystem::last_write_time(
+      imported_path,
+      std::filesystem::last_write_time(imported_path) + std::chrono::hours(1));
+
+  XLS_ASSERT_OK(adapter.Update(
+      kUri, "import imported;\nfn g() -> u32 { imported::h() }"));
+  EXPECT_EQ(adapter.GenerateParseDiagnostics(kUri).size(), 0);
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -14,6 +14,7 @@
 
 #include "xls/dslx/parse_and_typecheck.h"
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <string>
@@ -34,6 +35,7 @@
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/frontend/scanner.h"
 #include "xls/dslx/import_data.h"
+#include "xls/dslx/import_routines.h"
 #include "xls/dslx/type_system/type_info.h"
 #include "xls/dslx/type_system/typecheck_module.h"
 #include "xls/dslx/warning_collector.h"
@@ -88,6 +90,11 @@ absl::StatusOr<TypecheckedModule> TypecheckModule(
 
   std::string_view module_name = module->name();
 
+  if (int64_t thread_count = GetDefaultImportPrefetchThreadCount();
+      thread_count > 1) {
+    PrefetchImports(*module, import_data, thread_count);
+  }
+
   WarningCollector warnings(import_data->enabled_warnings());
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
                        TypecheckModule(module.get(), import_data, &warnings));
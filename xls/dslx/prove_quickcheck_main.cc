@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>  // NOLINT
 #include <memory>
@@ -21,6 +22,7 @@
 #include <vector>
 
 #include "absl/flags/flag.h"
+#include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -48,10 +50,16 @@ ABSL_FLAG(std::string, disable_warnings, "",
           "recommended, but can be used in exceptional circumstances");
 ABSL_FLAG(bool, warnings_as_errors, true,
           "Whether to fail early, as an error, if warnings are detected");
+ABSL_FLAG(int64_t, proof_parallelism, 1,
+          "Number of threads on which to prove the quickchecks. Results are "
+          "reported in declaration order regardless.");
+ABSL_FLAG(absl::Duration, timeout_per_quickcheck, absl::InfiniteDuration(),
+          "How long each proof may run before the quickcheck is reported as "
+          "timed out.");
 
 static constexpr std::string_view kUsage = R"(
-Attempts to proves a single quickcheck property in a given module to be
-infallible, or provide a counterexample.
+Attempts to prove each quickcheck property in a given module to be infallible,
+or provide a counterexample.
 )";
 
 namespace xls::dslx {
@@ -60,6 +68,7 @@ namespace {
 absl::StatusOr<TestResultData> RealMain(
     std::string_view entry_module_path, std::string_view test_filter,
     absl::Span<const std::filesystem::path> dslx_paths, bool warnings_as_errors,
+    int64_t proof_parallelism, absl::Duration timeout_per_quickcheck,
     std::optional<std::string_view> xml_output_file) {
   XLS_ASSIGN_OR_RETURN(
       WarningKindSet warnings,
@@ -85,6 +94,11 @@ absl::StatusOr<TestResultData> RealMain(
       .test_filter = test_filter_re_ptr,
       .warnings_as_errors = warnings_as_errors,
       .warnings = warnings,
+      .proof_parallelism = proof_parallelism,
+      .timeout_per_quickcheck =
+          timeout_per_quickcheck == absl::InfiniteDuration()
+              ? std::nullopt
+              : std::make_optional(timeout_per_quickcheck),
   };
 
   XLS_ASSIGN_OR_RETURN(
@@ -135,10 +149,13 @@ int main(int argc, char** argv) {
   }
 
   bool warnings_as_errors = absl::GetFlag(FLAGS_warnings_as_errors);
+  int64_t proof_parallelism = absl::GetFlag(FLAGS_proof_parallelism);
+  QCHECK_GE(proof_parallelism, 1) << "-proof_parallelism must be positive";
 
-  absl::StatusOr<xls::dslx::TestResultData> test_result =
-      xls::dslx::RealMain(positional_arguments[0], test_filter, dslx_paths,
-                          warnings_as_errors, xml_output_file);
+  absl::StatusOr<xls::dslx::TestResultData> test_result = xls::dslx::RealMain(
+      positional_arguments[0], test_filter, dslx_paths, warnings_as_errors,
+      proof_parallelism, absl::GetFlag(FLAGS_timeout_per_quickcheck),
+      xml_output_file);
   if (!test_result.ok()) {
     return xls::ExitStatus(test_result.status());
   }
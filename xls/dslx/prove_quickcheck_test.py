@@ -116,6 +116,47 @@ class ProveQuickcheckMainTest(test_base.TestCase):
     """
     self._prove_quickcheck(program, test_filter='qc_a*')
 
+  def test_multiple_in_parallel(self):
+    program = """
+    #[quickcheck]
+    fn qc_always_true() -> bool { true }
+    #[quickcheck]
+    fn qc_never_42(x: u8) -> bool { x != u8:42 }
+    #[quickcheck]
+    fn qc_add_one(x: u4) -> bool { (x as u5 + u5:1) > (x as u5) }
+    """
+    _, stderr = self._prove_quickcheck(
+        program, want_error=True, extra_flags=('--proof_parallelism=3',)
+    )
+    self.assertIn('counterexample: bits[8]:42', stderr)
+    # Output is reported in declaration order.
+    self.assertLess(
+        stderr.index('qc_always_true'), stderr.index('qc_never_42')
+    )
+    self.assertLess(stderr.index('qc_never_42'), stderr.index('qc_add_one'))
+
+  def test_parallel_writes_xml(self):
+    program = """
+    #[quickcheck]
+    fn qc_always_true() -> bool { true }
+    #[quickcheck]
+    fn qc_never_42(x: u8) -> bool { x != u8:42 }
+    """
+    xml_file = self.create_tempfile()
+    temp_file = self.create_tempfile(content=program)
+    p = subp.run(
+        [_BINARY, temp_file.full_path, '--proof_parallelism=2'],
+        check=False,
+        stdout=subp.PIPE,
+        stderr=subp.PIPE,
+        encoding='utf-8',
+        env={'XML_OUTPUT_FILE': xml_file.full_path},
+    )
+    self.assertNotEqual(p.returncode, 0)
+    xml = xml_file.read_text()
+    self.assertIn('qc_always_true', xml)
+    self.assertIn('failures="1"', xml)
+
 
 if __name__ == '__main__':
   test_base.main()
@@ -14,6 +14,7 @@
 
 #include "xls/dslx/run_routines/run_comparator.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -24,6 +25,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -38,11 +40,19 @@
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
 #include "xls/jit/function_jit.h"
+#include "xls/jit/jit_arg_marshaller.h"
+#include "xls/jit/jit_buffer.h"
 
 namespace xls::dslx {
 
 absl::StatusOr<FunctionJit*> RunComparator::GetOrCompileJitFunction(
     std::string_view ir_name, xls::Function* ir_function) {
+  absl::MutexLock lock(&mu_);
+  return GetOrCompileJitFunctionLocked(ir_name, ir_function);
+}
+
+absl::StatusOr<FunctionJit*> RunComparator::GetOrCompileJitFunctionLocked(
+    std::string_view ir_name, xls::Function* ir_function) {
   auto it = jit_cache_.find(ir_name);
   if (it != jit_cache_.end()) {
     return it->second.get();
@@ -83,6 +93,9 @@ absl::Status RunComparator::RunComparison(Package* ir_package,
 
   xls::Function* ir_function = *get_result;
 
+  // The interpreter may add types to the package and the JIT'd functions own
+  // their argument buffers, so execute one IR function at a time.
+  absl::MutexLock lock(&mu_);
   XLS_ASSIGN_OR_RETURN(std::vector<Value> ir_args,
                        InterpValue::ConvertValuesToIr(args));
 
@@ -100,7 +113,7 @@ absl::Status RunComparator::RunComparison(Package* ir_package,
       // TODO(https://github.com/google/xls/issues/506): Also compare events
       // once the DSLX interpreter supports them (and the JIT supports traces).
       XLS_ASSIGN_OR_RETURN(FunctionJit * jit,
-                           GetOrCompileJitFunction(ir_name, ir_function));
+                           GetOrCompileJitFunctionLocked(ir_name, ir_function));
       XLS_ASSIGN_OR_RETURN(ir_result, DropInterpreterEvents(jit->Run(ir_args)));
       mode_str = "JIT";
       break;
@@ -141,9 +154,59 @@ absl::Status RunComparator::RunComparison(Package* ir_package,
 absl::StatusOr<InterpreterResult<xls::Value>> RunComparator::RunIrFunction(
     std::string_view ir_name, xls::Function* ir_function,
     absl::Span<const xls::Value> ir_args) {
+  absl::MutexLock lock(&mu_);
   XLS_ASSIGN_OR_RETURN(FunctionJit * jit,
-                       GetOrCompileJitFunction(ir_name, ir_function));
+                       GetOrCompileJitFunctionLocked(ir_name, ir_function));
   return jit->Run(ir_args);
 }
 
+absl::StatusOr<std::vector<xls::Value>> RunComparator::RunIrFunctionBatched(
+    std::string_view ir_name, xls::Function* ir_function,
+    absl::Span<const std::vector<xls::Value>> arg_sets, int64_t thread_count) {
+  if (arg_sets.empty()) {
+    return std::vector<xls::Value>();
+  }
+  absl::MutexLock lock(&mu_);
+  XLS_ASSIGN_OR_RETURN(FunctionJit * jit,
+                       GetOrCompileJitFunctionLocked(ir_name, ir_function));
+  const JitArgMarshaller& marshaller = jit->arg_marshaller();
+  const int64_t batch_size = arg_sets.size();
+
+  // Structure-of-arrays layout: one array of `batch_size` elements per
+  // parameter.
+  std::vector<std::unique_ptr<uint8_t[], DeleteAligned>> arg_arrays;
+  std::vector<const uint8_t*> args;
+  arg_arrays.reserve(marshaller.arg_count());
+  args.reserve(marshaller.arg_count());
+  for (int64_t i = 0; i < marshaller.arg_count(); ++i) {
+    arg_arrays.emplace_back(static_cast<uint8_t*>(AllocateAligned(
+        jit->GetArgTypeAlignment(i), batch_size * jit->GetArgTypeSize(i))));
+    args.push_back(arg_arrays.back().get());
+  }
+  std::vector<uint8_t*> element_buffers(marshaller.arg_count());
+  for (int64_t n = 0; n < batch_size; ++n) {
+    for (int64_t i = 0; i < marshaller.arg_count(); ++i) {
+      element_buffers[i] = arg_arrays[i].get() + n * jit->GetArgTypeSize(i);
+    }
+    XLS_RETURN_IF_ERROR(marshaller.MarshalArgs(arg_sets[n], element_buffers));
+  }
+
+  const int64_t result_size = jit->GetReturnTypeSize();
+  std::unique_ptr<uint8_t[], DeleteAligned> result_buffer(
+      static_cast<uint8_t*>(AllocateAligned(jit->GetReturnTypeAlignment(),
+                                            batch_size * result_size)));
+  XLS_RETURN_IF_ERROR(jit->RunBatched(
+      args, batch_size,
+      absl::MakeSpan(result_buffer.get(), batch_size * result_size),
+      /*events=*/nullptr, thread_count));
+
+  std::vector<xls::Value> results;
+  results.reserve(batch_size);
+  for (int64_t n = 0; n < batch_size; ++n) {
+    results.push_back(
+        marshaller.UnmarshalResult(result_buffer.get() + n * result_size));
+  }
+  return results;
+}
+
 }  // namespace xls::dslx
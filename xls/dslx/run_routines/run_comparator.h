@@ -23,6 +23,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/test_macros.h"
 #include "xls/dslx/frontend/ast.h"
@@ -49,6 +50,10 @@ enum class CompareMode : uint8_t {
 //
 // Implementation note: slightly simpler to keep in object form so we can
 // inspect cache state more easily than closing over it, e.g. for testing.
+//
+// Thread-safe: the IR package and the JIT'd functions are not, so IR
+// compilation and execution are serialized; the DSLX interpretation that
+// triggers the comparisons can still proceed concurrently.
 class RunComparator : public AbstractRunComparator {
  public:
   explicit RunComparator(CompareMode mode) : mode_(mode) {}
@@ -63,20 +68,33 @@ class RunComparator : public AbstractRunComparator {
       std::string_view ir_name, xls::Function* ir_function,
       absl::Span<const xls::Value> ir_args) override;
 
+  // Marshals all the argument sets into the JIT's native layout up front and
+  // evaluates them with a single FunctionJit::RunBatched call.
+  absl::StatusOr<std::vector<xls::Value>> RunIrFunctionBatched(
+      std::string_view ir_name, xls::Function* ir_function,
+      absl::Span<const std::vector<xls::Value>> arg_sets,
+      int64_t thread_count) override;
+
   // Returns the cached or newly-compiled jit function for ir_name.  ir_name has
   // already been mangled (see MangleDslxName) so it should be unique in the
   // program and is used as the cache key.
   //
-  // Note: There is no locking in jit compilation or on the jit function cache
-  // so this function is *not* thread-safe.
+  // Note: the returned FunctionJit is not thread-safe; it must not be run
+  // concurrently with comparisons made by this object.
   absl::StatusOr<FunctionJit*> GetOrCompileJitFunction(
       std::string_view ir_name, xls::Function* ir_function);
 
  private:
+  absl::StatusOr<FunctionJit*> GetOrCompileJitFunctionLocked(
+      std::string_view ir_name, xls::Function* ir_function)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   XLS_FRIEND_TEST(RunRoutinesTest, TestInvokedFunctionDoesJit);
   XLS_FRIEND_TEST(RunRoutinesTest, QuickcheckInvokedFunctionDoesJit);
   XLS_FRIEND_TEST(RunRoutinesTest, NoSeedStillQuickChecks);
 
+  // Guards `jit_cache_` as well as all IR compilation and execution.
+  absl::Mutex mu_;
   absl::flat_hash_map<std::string, std::unique_ptr<FunctionJit>> jit_cache_;
   CompareMode mode_;
 };
@@ -17,13 +17,16 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <ctime>
 #include <functional>
 #include <iostream>
 #include <memory>
 #include <optional>
+#include <ostream>
 #include <random>
+#include <sstream>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -35,14 +38,18 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/bytecode/bytecode.h"
 #include "xls/dslx/bytecode/bytecode_cache.h"
 #include "xls/dslx/bytecode/bytecode_emitter.h"
@@ -68,12 +75,16 @@
 #include "xls/dslx/type_system/parametric_env.h"
 #include "xls/dslx/type_system/type.h"
 #include "xls/dslx/type_system/type_info.h"
+#include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/random_value.h"
+#include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/events.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
 #include "xls/ir/value.h"
+#include "xls/jit/jit_proc_runtime.h"
 #include "xls/passes/optimization_pass_pipeline.h"
 #include "xls/solvers/z3_ir_translator.h"
 #include "re2/re2.h"
@@ -85,10 +96,16 @@ namespace {
 constexpr int kUnitSpaces = 7;
 constexpr int kQuickcheckSpaces = 15;
 
-void HandleError(TestResultData& result, const absl::Status& status,
-                 std::string_view test_name, const Pos& start_pos,
-                 const absl::Time& start, const absl::Duration& duration,
-                 bool is_quickcheck) {
+// Serializes IR conversion of test procs run on the JIT backend.
+ABSL_CONST_INIT absl::Mutex ir_conversion_mutex(absl::kConstInit);
+
+// Prints the failure of a test to `out` and returns the corresponding entry
+// for the test XML.
+test_xml::TestCase ReportError(const absl::Status& status,
+                               std::string_view test_name,
+                               const Pos& start_pos, const absl::Time& start,
+                               const absl::Duration& duration,
+                               bool is_quickcheck, std::ostream& out) {
   VLOG(1) << "Handling error; status: " << status
           << " test_name: " << test_name;
   absl::StatusOr<PositionalErrorData> data_or = GetPositionalErrorData(status);
@@ -98,7 +115,7 @@ void HandleError(TestResultData& result, const absl::Status& status,
   if (data_or.ok()) {
     const auto& data = data_or.value();
     CHECK_OK(PrintPositionalError(
-        data.span, data.GetMessageWithType(), std::cerr,
+        data.span, data.GetMessageWithType(), out,
         /*get_file_contents=*/nullptr, PositionalErrorColor::kErrorColor));
     one_liner = data.GetMessageWithType();
   } else {
@@ -109,45 +126,50 @@ void HandleError(TestResultData& result, const absl::Status& status,
     one_liner = suffix;
   }
 
-  // Add to test tracking data.
-  result.AddTestCase(
-      test_xml::TestCase{.name = std::string(test_name),
-                         .file = start_pos.filename(),
-                         .line = start_pos.GetHumanLineno(),
-                         .status = test_xml::RunStatus::kRun,
-                         .result = test_xml::RunResult::kCompleted,
-                         .time = duration,
-                         .timestamp = start,
-                         .failure = test_xml::Failure{.message = one_liner}});
-
   std::string spaces((is_quickcheck ? kQuickcheckSpaces : kUnitSpaces), ' ');
-  std::cerr << absl::StreamFormat("[ %sFAILED ] %s%s", spaces, test_name,
-                                  suffix)
-            << "\n";
-};
+  out << absl::StreamFormat("[ %sFAILED ] %s%s", spaces, test_name, suffix)
+      << "\n";
+
+  return test_xml::TestCase{.name = std::string(test_name),
+                            .file = start_pos.filename(),
+                            .line = start_pos.GetHumanLineno(),
+                            .status = test_xml::RunStatus::kRun,
+                            .result = test_xml::RunResult::kCompleted,
+                            .time = duration,
+                            .timestamp = start,
+                            .failure = test_xml::Failure{.message = one_liner}};
+}
 
+void HandleError(TestResultData& result, const absl::Status& status,
+                 std::string_view test_name, const Pos& start_pos,
+                 const absl::Time& start, const absl::Duration& duration,
+                 bool is_quickcheck) {
+  // Add to test tracking data.
+  result.AddTestCase(ReportError(status, test_name, start_pos, start, duration,
+                                 is_quickcheck, std::cerr));
+}
+
+// Runs the given test function. Bytecode is emitted into `options`' bytecode
+// cache, so `import_data` is only read from.
 absl::Status RunTestFunction(ImportData* import_data, TypeInfo* type_info,
                              Module* module, TestFunction* tf,
                              const BytecodeInterpreterOptions& options) {
-  auto cache = std::make_unique<BytecodeCache>(import_data);
-  import_data->SetBytecodeCache(std::move(cache));
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeFunction> bf,
       BytecodeEmitter::Emit(
           import_data, type_info, tf->fn(), std::nullopt,
-          BytecodeEmitterOptions{.format_preference =
-                                     options.format_preference()}));
+          BytecodeEmitterOptions{
+              .format_preference = options.format_preference(),
+              .optimize = true}));
   return BytecodeInterpreter::Interpret(import_data, bf.get(), /*args=*/{},
                                         options)
       .status();
 }
 
+// As above, for a test proc.
 absl::Status RunTestProc(ImportData* import_data, TypeInfo* type_info,
                          Module* module, TestProc* tp,
                          const BytecodeInterpreterOptions& options) {
-  auto cache = std::make_unique<BytecodeCache>(import_data);
-  import_data->SetBytecodeCache(std::move(cache));
-
   XLS_ASSIGN_OR_RETURN(TypeInfo * ti,
                        type_info->GetTopLevelProcTypeInfo(tp->proc()));
 
@@ -196,6 +218,170 @@ absl::Status RunTestProc(ImportData* import_data, TypeInfo* type_info,
   return absl::OkStatus();
 }
 
+// As above, but converts the test proc network to IR and ticks it in the JIT
+// proc runtime. Errors are reported as the interpreter would report them:
+// failed assertions and `fail!`s as failures, a deadlocked network or too many
+// ticks as deadline exceeded and a false value on the terminator channel as a
+// failure of the proc.
+absl::Status RunTestProcWithJit(ImportData* import_data, Module* module,
+                                TestProc* tp,
+                                const ParseAndTestOptions& options) {
+  ConvertOptions convert_options = options.convert_options;
+  convert_options.emit_fail_as_assert = true;
+  PackageConversionData conv{.package =
+                                 std::make_unique<Package>(module->name())};
+  {
+    // IR conversion is not safe to run concurrently on the same ImportData.
+    absl::MutexLock lock(&ir_conversion_mutex);
+    XLS_RETURN_IF_ERROR(ConvertOneFunctionIntoPackage(
+        module, tp->proc(), import_data, /*parametric_env=*/nullptr,
+        convert_options, &conv));
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> runtime,
+                       CreateJitSerialProcRuntime(conv.package.get()));
+
+  // IR conversion names the channels passed to the top proc's config function
+  // `<package>__<parameter>`.
+  std::string terminator_name =
+      absl::StrCat(conv.package->name(), "__",
+                   tp->proc()->config().params()[0]->identifier());
+  XLS_ASSIGN_OR_RETURN(
+      ChannelQueue * terminator,
+      runtime->queue_manager().GetQueueByName(terminator_name));
+
+  int64_t tick_count = 0;
+  while (terminator->IsEmpty()) {
+    if (options.max_ticks.has_value() &&
+        tick_count > options.max_ticks.value()) {
+      return absl::DeadlineExceededError(
+          absl::StrFormat("Exceeded limit of %d proc ticks before terminating",
+                          options.max_ticks.value()));
+    }
+    if (absl::Status status = runtime->Tick(); !status.ok()) {
+      if (absl::StartsWith(status.message(), "Proc network is deadlocked")) {
+        return absl::DeadlineExceededError(
+            absl::StrCat("Procs are deadlocked. ", status.message()));
+      }
+      return status;
+    }
+    for (const std::unique_ptr<xls::Proc>& proc : conv.package->procs()) {
+      const InterpreterEvents& events =
+          runtime->GetInterpreterEvents(proc.get());
+      for (const TraceMessage& trace : events.trace_msgs) {
+        XLS_LOG_LINES(INFO, trace.message);
+      }
+      if (!events.assert_msgs.empty()) {
+        return FailureErrorStatus(tp->proc()->span(),
+                                  events.assert_msgs.front());
+      }
+    }
+    runtime->ClearInterpreterEvents();
+    ++tick_count;
+  }
+
+  std::optional<Value> ret_val = terminator->Read();
+  XLS_RET_CHECK(ret_val.has_value() && ret_val->IsBits() &&
+                ret_val->bits().bit_count() == 1);
+  if (ret_val->bits().IsZero()) {
+    return FailureErrorStatus(tp->proc()->span(),
+                              "Proc reported failure upon exit.");
+  }
+  return absl::OkStatus();
+}
+
+// Runs the unit test (test function or test proc) `test_name` of
+// `entry_module`, printing its progress to `out`, and returns its entry for
+// the test XML. Each test gets a fresh bytecode cache and interpreter state of
+// its own, so several tests may run concurrently against the same
+// `import_data`.
+absl::StatusOr<test_xml::TestCase> RunUnitTest(
+    ImportData* import_data, TypeInfo* type_info, Module* entry_module,
+    const std::string& test_name, const ParseAndTestOptions& options,
+    const PostFnEvalHook& post_fn_eval_hook, std::ostream& out) {
+  auto test_case_start = absl::Now();
+  ModuleMember* member = entry_module->FindMemberWithName(test_name).value();
+  const Pos start_pos = GetPos(*member);
+
+  out << "[ RUN UNITTEST  ] " << test_name << '\n';
+  BytecodeCache bytecode_cache(import_data);
+  absl::Status status;
+  BytecodeInterpreterOptions interpreter_options;
+  interpreter_options.post_fn_eval_hook(post_fn_eval_hook)
+      .trace_hook(InfoLoggingTraceHook)
+      .trace_channels(options.trace_channels)
+      .max_ticks(options.max_ticks)
+      .format_preference(options.format_preference)
+      .bytecode_cache(&bytecode_cache);
+  if (std::holds_alternative<TestFunction*>(*member)) {
+    XLS_ASSIGN_OR_RETURN(TestFunction * tf, entry_module->GetTest(test_name));
+    status = RunTestFunction(import_data, type_info, entry_module, tf,
+                             interpreter_options);
+  } else {
+    XLS_ASSIGN_OR_RETURN(TestProc * tp, entry_module->GetTestProc(test_name));
+    if (options.test_proc_backend == TestProcBackend::kJit) {
+      status = RunTestProcWithJit(import_data, entry_module, tp, options);
+    } else {
+      status = RunTestProc(import_data, type_info, entry_module, tp,
+                           interpreter_options);
+    }
+  }
+  auto test_case_end = absl::Now();
+
+  if (!status.ok()) {
+    return ReportError(status, test_name, start_pos, test_case_start,
+                       test_case_end - test_case_start,
+                       /*is_quickcheck=*/false, out);
+  }
+  out << "[            OK ]" << '\n';
+  return test_xml::TestCase{.name = test_name,
+                            .file = start_pos.filename(),
+                            .line = start_pos.GetHumanLineno(),
+                            .status = test_xml::RunStatus::kRun,
+                            .result = test_xml::RunResult::kCompleted,
+                            .time = test_case_end - test_case_start,
+                            .timestamp = test_case_start};
+}
+
+// Runs the unit tests `test_names` on `worker_count` threads and returns their
+// test XML entries in the order of `test_names`. The output of each test is
+// buffered and printed once all tests have finished so that it appears in the
+// same order as for a serial run.
+absl::StatusOr<std::vector<test_xml::TestCase>> RunUnitTestsInParallel(
+    ImportData* import_data, TypeInfo* type_info, Module* entry_module,
+    absl::Span<const std::string> test_names,
+    const ParseAndTestOptions& options,
+    const PostFnEvalHook& post_fn_eval_hook, int64_t worker_count) {
+  std::vector<std::optional<absl::StatusOr<test_xml::TestCase>>> results(
+      test_names.size());
+  std::vector<std::string> outputs(test_names.size());
+  std::atomic<int64_t> next_test = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_test++; i < test_names.size(); i = next_test++) {
+      std::ostringstream out;
+      results[i] = RunUnitTest(import_data, type_info, entry_module,
+                               test_names[i], options, post_fn_eval_hook, out);
+      outputs[i] = out.str();
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 0; i < std::min<int64_t>(worker_count, test_names.size());
+       ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  std::vector<test_xml::TestCase> test_cases;
+  test_cases.reserve(test_names.size());
+  for (int64_t i = 0; i < test_names.size(); ++i) {
+    std::cerr << outputs[i];
+    XLS_ASSIGN_OR_RETURN(test_xml::TestCase test_case, *std::move(results[i]));
+    test_cases.push_back(std::move(test_case));
+  }
+  return test_cases;
+}
+
 }  // namespace
 
 TestResultData::TestResultData(absl::Time start_time,
@@ -263,36 +449,90 @@ static bool TestMatchesFilter(std::string_view test_name,
   return RE2::FullMatch(test_name, *test_filter);
 }
 
+absl::StatusOr<std::vector<xls::Value>>
+AbstractRunComparator::RunIrFunctionBatched(
+    std::string_view ir_name, xls::Function* ir_function,
+    absl::Span<const std::vector<xls::Value>> arg_sets, int64_t thread_count) {
+  std::vector<xls::Value> results;
+  results.reserve(arg_sets.size());
+  for (const std::vector<xls::Value>& args : arg_sets) {
+    XLS_ASSIGN_OR_RETURN(
+        xls::Value result,
+        DropInterpreterEvents(RunIrFunction(ir_name, ir_function, args)));
+    results.push_back(std::move(result));
+  }
+  return results;
+}
+
+// Number of quickcheck samples evaluated per thread in each batch. Batches
+// only stop at a falsifying example once fully evaluated, so this bounds the
+// amount of wasted work.
+constexpr int64_t kQuickCheckSamplesPerThread = 1024;
+
+// In the case of an implicit token signature we get (token, bool) as the
+// result of the quickcheck'd function, so we unbox the boolean here.
+static absl::StatusOr<xls::Value> UnboxQuickCheckResult(xls::Value result) {
+  if (result.IsTuple()) {
+    result = result.elements()[1];
+    XLS_RET_CHECK(result.IsBits());
+  }
+  return result;
+}
+
 absl::StatusOr<QuickCheckResults> DoQuickCheck(
     xls::Function* xls_function, std::string_view ir_name,
-    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests) {
+    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests,
+    int64_t thread_count) {
+  XLS_RET_CHECK_GE(thread_count, 1);
   QuickCheckResults results;
   std::minstd_rand rng_engine(seed);
 
-  for (int i = 0; i < num_tests; i++) {
-    results.arg_sets.push_back(
-        RandomFunctionArguments(xls_function, rng_engine));
+  const int64_t max_batch_size = kQuickCheckSamplesPerThread * thread_count;
+  for (int64_t start = 0; start < num_tests; start += max_batch_size) {
+    const int64_t batch_size = std::min(max_batch_size, num_tests - start);
+    for (int64_t i = 0; i < batch_size; ++i) {
+      results.arg_sets.push_back(
+          RandomFunctionArguments(xls_function, rng_engine));
+    }
+    absl::Span<const std::vector<Value>> batch =
+        absl::MakeConstSpan(results.arg_sets).subspan(start);
+
     // TODO(https://github.com/google/xls/issues/506): 2021-10-15
     // Assertion failures should work out, but we should consciously decide
     // if/how we want to dump traces when running QuickChecks (always, for
     // failures, flag-controlled, ...).
-    XLS_ASSIGN_OR_RETURN(xls::Value result,
-                         DropInterpreterEvents(run_comparator->RunIrFunction(
-                             ir_name, xls_function, results.arg_sets.back())));
-
-    // In the case of an implicit token signature we get (token, bool) as the
-    // result of the quickcheck'd function, so we unbox the boolean here.
-    if (result.IsTuple()) {
-      result = result.elements()[1];
-      XLS_RET_CHECK(result.IsBits());
+    absl::StatusOr<std::vector<xls::Value>> batch_results =
+        run_comparator->RunIrFunctionBatched(ir_name, xls_function, batch,
+                                             thread_count);
+    if (!batch_results.ok()) {
+      // Some sample failed to evaluate; replay the batch one sample at a time
+      // so we report the same error (or falsifying example, if one comes
+      // first) as a serial run would.
+      batch_results.emplace();
+      for (const std::vector<Value>& args : batch) {
+        XLS_ASSIGN_OR_RETURN(
+            xls::Value result,
+            DropInterpreterEvents(
+                run_comparator->RunIrFunction(ir_name, xls_function, args)));
+        XLS_ASSIGN_OR_RETURN(result, UnboxQuickCheckResult(std::move(result)));
+        batch_results->push_back(result);
+        if (result.IsAllZeros()) {
+          break;
+        }
+      }
     }
 
-    results.results.push_back(result);
-
-    if (result.IsAllZeros()) {
-      // We were able to falsify the xls_function (predicate), bail out early
-      // and present this evidence.
-      break;
+    for (int64_t i = 0; i < batch_results->size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          xls::Value result,
+          UnboxQuickCheckResult(std::move(batch_results->at(i))));
+      results.results.push_back(result);
+      if (result.IsAllZeros()) {
+        // We were able to falsify the xls_function (predicate), bail out early
+        // and present this evidence.
+        results.arg_sets.resize(start + i + 1);
+        return results;
+      }
     }
   }
 
@@ -334,7 +574,8 @@ static absl::StatusOr<QuickcheckIrFn> FindQuickcheckIrFn(Function* fn,
 
 static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
                                   Package* ir_package, QuickCheck* quickcheck,
-                                  TypeInfo* type_info, int64_t seed) {
+                                  TypeInfo* type_info, int64_t seed,
+                                  int64_t thread_count) {
   // Note: DSLX function.
   Function* fn = quickcheck->f();
 
@@ -344,7 +585,7 @@ static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
   XLS_ASSIGN_OR_RETURN(
       QuickCheckResults qc_results,
       DoQuickCheck(qc_fn.ir_function, qc_fn.ir_name, run_comparator, seed,
-                   quickcheck->GetTestCountOrDefault()));
+                   quickcheck->GetTestCountOrDefault(), thread_count));
   const auto& [arg_sets, results] = qc_results;
   XLS_ASSIGN_OR_RETURN(Bits last_result, results.back().GetBitsWithStatus());
   if (!last_result.IsZero()) {
@@ -378,7 +619,8 @@ static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
 static absl::Status RunQuickChecksIfJitEnabled(
     const RE2* test_filter, Module* entry_module, TypeInfo* type_info,
     AbstractRunComparator* run_comparator, Package* ir_package,
-    std::optional<int64_t> seed, TestResultData& result) {
+    std::optional<int64_t> seed, int64_t thread_count,
+    TestResultData& result) {
   if (run_comparator == nullptr) {
     // TODO(leary): 2024-02-08 Note that this skips /all/ the quickchecks so we
     // don't make an entry for it right now in the test XML.
@@ -418,7 +660,8 @@ static absl::Status RunQuickChecksIfJitEnabled(
     std::cerr << "[ RUN QUICKCHECK        ] " << quickcheck_name
               << " count: " << quickcheck->GetTestCountOrDefault() << "\n";
     const absl::Status status =
-        RunQuickCheck(run_comparator, ir_package, quickcheck, type_info, *seed);
+        RunQuickCheck(run_comparator, ir_package, quickcheck, type_info, *seed,
+                      thread_count);
     const absl::Duration duration = absl::Now() - test_case_start;
     if (!status.ok()) {
       HandleError(result, status, quickcheck_name, start_pos, test_case_start,
@@ -443,6 +686,160 @@ static absl::Status RunQuickChecksIfJitEnabled(
   return absl::OkStatus();
 }
 
+namespace {
+
+// A quickcheck converted to IR and ready to be proven.
+struct QuickCheckProof {
+  std::string name;
+  QuickCheck* quickcheck;
+  Pos start_pos;
+  absl::Time start;
+  std::unique_ptr<Package> package;
+  xls::Function* ir_function;
+};
+
+// Converts the quickcheck `quickcheck_name` to IR, optimized so that it has no
+// invokes or loops left for the translator. If the quickcheck is filtered out
+// or fails to convert, its test XML entry is stored in `test_case` instead.
+absl::StatusOr<std::optional<QuickCheckProof>> PrepareQuickCheckProof(
+    ImportData* import_data, Module* entry_module,
+    const std::string& quickcheck_name, const ParseAndProveOptions& options,
+    std::optional<test_xml::TestCase>& test_case, std::ostream& out) {
+  QuickCheck* quickcheck = entry_module->GetQuickCheckByName().at(
+      quickcheck_name);
+  const Pos& start_pos = quickcheck->span().start();
+  Function* f = quickcheck->f();
+  VLOG(1) << "Found quickcheck function: " << f->identifier();
+  out << "[ RUN QUICKCHECK        ] " << quickcheck_name << '\n';
+
+  auto test_case_start = absl::Now();
+
+  if (!TestMatchesFilter(quickcheck_name, options.test_filter)) {
+    auto test_case_end = absl::Now();
+    test_case = test_xml::TestCase{.name = quickcheck_name,
+                                   .file = start_pos.filename(),
+                                   .line = start_pos.GetHumanLineno(),
+                                   .status = test_xml::RunStatus::kRun,
+                                   .result = test_xml::RunResult::kFiltered,
+                                   .time = test_case_end - test_case_start,
+                                   .timestamp = test_case_start};
+    return std::nullopt;
+  }
+  auto fail = [&](const absl::Status& status) {
+    test_case = ReportError(status, quickcheck_name, start_pos,
+                            test_case_start, absl::Now() - test_case_start,
+                            /*is_quickcheck=*/true, out);
+    return std::nullopt;
+  };
+
+  dslx::PackageConversionData conv{
+      .package = std::make_unique<Package>(entry_module->name())};
+  absl::Status status = ConvertOneFunctionIntoPackage(
+      entry_module, f, import_data,
+      /*parametric_env=*/nullptr, ConvertOptions{}, &conv);
+  if (!status.ok()) {
+    return fail(status);
+  }
+
+  // Note: we need this to eliminate unoptimized IR constructs that are not
+  // currently handled for translation; e.g. bounded-for-loops and non-inlined
+  // function calls.
+  status = RunOptimizationPassPipeline(conv.package.get()).status();
+  if (!status.ok()) {
+    return fail(status);
+  }
+
+  absl::StatusOr<std::string> ir_function_name_or = MangleDslxName(
+      entry_module->name(), f->identifier(), CallingConvention::kTypical);
+  if (!ir_function_name_or.ok()) {
+    return fail(ir_function_name_or.status());
+  }
+
+  absl::StatusOr<xls::Function*> ir_function_or =
+      conv.package->GetFunction(ir_function_name_or.value());
+  if (!ir_function_or.ok()) {
+    return fail(ir_function_or.status());
+  }
+
+  VLOG(1) << "Found IR function: " << ir_function_or.value()->name();
+  return QuickCheckProof{.name = quickcheck_name,
+                         .quickcheck = quickcheck,
+                         .start_pos = start_pos,
+                         .start = test_case_start,
+                         .package = std::move(conv.package),
+                         .ir_function = ir_function_or.value()};
+}
+
+// Tries to prove that the quickcheck holds for all inputs within `timeout`
+// and returns its test XML entry. If it is disproven, `counterexample` is set
+// to the failing arguments.
+absl::StatusOr<test_xml::TestCase> ProveQuickCheck(
+    const QuickCheckProof& proof, absl::Duration timeout,
+    std::optional<std::vector<Value>>& counterexample, std::ostream& out) {
+  absl::StatusOr<solvers::z3::ProverResult> proven_or = solvers::z3::TryProve(
+      proof.ir_function, proof.ir_function->return_value(),
+      solvers::z3::Predicate::NotEqualToZero(), timeout);
+
+  if (absl::IsDeadlineExceeded(proven_or.status())) {
+    absl::Duration duration = absl::Now() - proof.start;
+    out << "[               TIMEOUT ] " << proof.name << '\n';
+    return test_xml::TestCase{
+        .name = proof.name,
+        .file = proof.start_pos.filename(),
+        .line = proof.start_pos.GetHumanLineno(),
+        .status = test_xml::RunStatus::kRun,
+        .result = test_xml::RunResult::kInterrupted,
+        .time = duration,
+        .timestamp = proof.start,
+        .failure = test_xml::Failure{.message = absl::StrFormat(
+                                         "proof timed out after %s",
+                                         absl::FormatDuration(duration))}};
+  }
+  if (!proven_or.ok()) {
+    return ReportError(proven_or.status(), proof.name, proof.start_pos,
+                       proof.start, absl::Now() - proof.start,
+                       /*is_quickcheck=*/true, out);
+  }
+
+  VLOG(1) << "Proven? "
+          << (std::holds_alternative<solvers::z3::ProvenTrue>(
+                  proven_or.value())
+                  ? "true"
+                  : "false");
+
+  if (std::holds_alternative<solvers::z3::ProvenTrue>(proven_or.value())) {
+    out << "[                    OK ] " << proof.name << "\n";
+    return test_xml::TestCase{
+        .name = proof.name,
+        .file = proof.start_pos.filename(),
+        .line = proof.start_pos.GetHumanLineno(),
+        .status = test_xml::RunStatus::kRun,
+        .result = test_xml::RunResult::kCompleted,
+        .time = absl::Now() - proof.start,
+        .timestamp = proof.start,
+    };
+  }
+
+  const auto& proven_false =
+      std::get<solvers::z3::ProvenFalse>(proven_or.value());
+
+  // Extract the counterexample, and collapse it back into sequential order.
+  using ParamValues = absl::flat_hash_map<const xls::Param*, Value>;
+  XLS_ASSIGN_OR_RETURN(ParamValues counterexample_map,
+                       proven_false.counterexample);
+  counterexample.emplace();
+  for (const xls::Param* param : proof.ir_function->params()) {
+    counterexample->push_back(counterexample_map[param]);
+  }
+  std::string one_liner =
+      absl::StrCat("counterexample: ", absl::StrJoin(*counterexample, ", "));
+  return ReportError(ProofErrorStatus(proof.quickcheck->span(), one_liner),
+                     proof.name, proof.start_pos, proof.start,
+                     absl::Now() - proof.start, /*is_quickcheck=*/true, out);
+}
+
+}  // namespace
+
 absl::StatusOr<ParseAndProveResult> ParseAndProve(
     std::string_view program, std::string_view module_name,
     std::string_view filename, const ParseAndProveOptions& options) {
@@ -476,129 +873,82 @@ absl::StatusOr<ParseAndProveResult> ParseAndProve(
 
   Module* entry_module = tm_or.value().module;
 
-  // We need to IR-convert the quickcheck property and then try to prove that
-  // the return value is always true.
-  absl::flat_hash_map<std::string, QuickCheck*> qcs =
-      entry_module->GetQuickCheckByName();
-
-  // Counter-examples map from failing test name -> counterexample values.
-  absl::flat_hash_map<std::string, std::vector<Value>> counterexamples;
-
-  for (const std::string& quickcheck_name :
-       entry_module->GetQuickCheckNames()) {
-    QuickCheck* quickcheck = qcs.at(quickcheck_name);
-    const Pos& start_pos = quickcheck->span().start();
-    Function* f = quickcheck->f();
-    VLOG(1) << "Found quickcheck function: " << f->identifier();
-    std::cerr << "[ RUN QUICKCHECK        ] " << quickcheck_name << '\n';
-    absl::Status status;
-
-    auto test_case_start = absl::Now();
-
-    if (!TestMatchesFilter(quickcheck_name, options.test_filter)) {
-      auto test_case_end = absl::Now();
-      result.AddTestCase(
-          test_xml::TestCase{.name = quickcheck_name,
-                             .file = start_pos.filename(),
-                             .line = start_pos.GetHumanLineno(),
-                             .status = test_xml::RunStatus::kRun,
-                             .result = test_xml::RunResult::kFiltered,
-                             .time = test_case_end - test_case_start,
-                             .timestamp = test_case_start});
-      continue;
-    }
-    dslx::PackageConversionData conv{
-        .package = std::make_unique<Package>(entry_module->name())};
-    Package& package = *conv.package;
-
-    status = ConvertOneFunctionIntoPackage(entry_module, f, &import_data,
-                                           /*parametric_env=*/nullptr,
-                                           ConvertOptions{}, &conv);
-    if (!status.ok()) {
-      HandleError(result, status, quickcheck_name, start_pos, test_case_start,
-                  absl::Now() - start, /*is_quickcheck=*/true);
-      continue;
-    }
-
-    // Note: we need this to eliminate unoptimized IR constructs that are not
-    // currently handled for translation; e.g. bounded-for-loops and non-inlined
-    // function calls.
-    status = RunOptimizationPassPipeline(&package).status();
-    if (!status.ok()) {
-      HandleError(result, status, quickcheck_name, start_pos, test_case_start,
-                  absl::Now() - start, /*is_quickcheck=*/true);
-      continue;
+  // We need to IR-convert each quickcheck property and then try to prove that
+  // the return value is always true. Conversion uses the import data so it is
+  // done on this thread; with `proof_parallelism` > 1 the proofs are then
+  // sharded across worker threads. Either way the results and output are
+  // reported in declaration order.
+  const std::vector<std::string> quickcheck_names =
+      entry_module->GetQuickCheckNames();
+  const absl::Duration timeout =
+      options.timeout_per_quickcheck.value_or(absl::InfiniteDuration());
+  std::vector<std::optional<test_xml::TestCase>> test_cases(
+      quickcheck_names.size());
+  std::vector<std::optional<std::vector<Value>>> counterexample_values(
+      quickcheck_names.size());
+
+  if (options.proof_parallelism > 1) {
+    std::vector<std::ostringstream> outputs(quickcheck_names.size());
+    std::vector<std::optional<QuickCheckProof>> proofs(quickcheck_names.size());
+    for (int64_t i = 0; i < quickcheck_names.size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          proofs[i],
+          PrepareQuickCheckProof(&import_data, entry_module,
+                                 quickcheck_names[i], options, test_cases[i],
+                                 outputs[i]));
     }
-
-    absl::StatusOr<std::string> ir_function_name_or = MangleDslxName(
-        entry_module->name(), f->identifier(), CallingConvention::kTypical);
-    if (!ir_function_name_or.ok()) {
-      HandleError(result, status, quickcheck_name, start_pos, test_case_start,
-                  absl::Now() - start, /*is_quickcheck=*/true);
-      continue;
+    std::vector<absl::Status> statuses(quickcheck_names.size());
+    std::atomic<int64_t> next_proof = 0;
+    auto worker = [&]() {
+      for (int64_t i = next_proof++; i < proofs.size(); i = next_proof++) {
+        if (!proofs[i].has_value()) {
+          continue;
+        }
+        absl::StatusOr<test_xml::TestCase> test_case = ProveQuickCheck(
+            *proofs[i], timeout, counterexample_values[i], outputs[i]);
+        if (test_case.ok()) {
+          test_cases[i] = *std::move(test_case);
+        } else {
+          statuses[i] = test_case.status();
+        }
+      }
+    };
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 0;
+         i < std::min<int64_t>(options.proof_parallelism, proofs.size()); ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
     }
-
-    absl::StatusOr<xls::Function*> ir_function_or =
-        package.GetFunction(ir_function_name_or.value());
-    if (!ir_function_or.ok()) {
-      HandleError(result, status, quickcheck_name, start_pos, test_case_start,
-                  absl::Now() - start, /*is_quickcheck=*/true);
-      continue;
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
     }
-
-    VLOG(1) << "Found IR function: " << ir_function_or.value()->name();
-
-    absl::StatusOr<solvers::z3::ProverResult> proven_or = solvers::z3::TryProve(
-        ir_function_or.value(), ir_function_or.value()->return_value(),
-        solvers::z3::Predicate::NotEqualToZero(), absl::InfiniteDuration());
-
-    if (!proven_or.ok()) {
-      HandleError(result, status, quickcheck_name, start_pos, test_case_start,
-                  absl::Now() - start, /*is_quickcheck=*/true);
-      continue;
+    for (int64_t i = 0; i < quickcheck_names.size(); ++i) {
+      std::cerr << outputs[i].str();
+      XLS_RETURN_IF_ERROR(statuses[i]);
     }
-
-    VLOG(1) << "Proven? "
-            << (std::holds_alternative<solvers::z3::ProvenTrue>(
-                    proven_or.value())
-                    ? "true"
-                    : "false");
-
-    if (std::holds_alternative<solvers::z3::ProvenTrue>(proven_or.value())) {
-      absl::Time test_case_end = absl::Now();
-      absl::Duration duration = test_case_end - test_case_start;
-      result.AddTestCase(test_xml::TestCase{
-          .name = std::string(quickcheck_name),
-          .file = start_pos.filename(),
-          .line = start_pos.GetHumanLineno(),
-          .status = test_xml::RunStatus::kRun,
-          .result = test_xml::RunResult::kCompleted,
-          .time = duration,
-          .timestamp = test_case_start,
-      });
-      std::cerr << "[                    OK ] " << quickcheck_name << "\n";
-      continue;
+  } else {
+    for (int64_t i = 0; i < quickcheck_names.size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          std::optional<QuickCheckProof> proof,
+          PrepareQuickCheckProof(&import_data, entry_module,
+                                 quickcheck_names[i], options, test_cases[i],
+                                 std::cerr));
+      if (proof.has_value()) {
+        XLS_ASSIGN_OR_RETURN(test_cases[i],
+                             ProveQuickCheck(*proof, timeout,
+                                             counterexample_values[i],
+                                             std::cerr));
+      }
     }
+  }
 
-    const auto& proven_false =
-        std::get<solvers::z3::ProvenFalse>(proven_or.value());
-
-    // Extract the counterexample, and collapse it back into sequential order.
-    std::vector<Value> counterexample;
-    using ParamValues = absl::flat_hash_map<const xls::Param*, Value>;
-    XLS_ASSIGN_OR_RETURN(ParamValues counterexample_map,
-                         proven_false.counterexample);
-    for (const xls::Param* param : ir_function_or.value()->params()) {
-      counterexample.push_back(counterexample_map[param]);
+  // Counter-examples map from failing test name -> counterexample values.
+  absl::flat_hash_map<std::string, std::vector<Value>> counterexamples;
+  for (int64_t i = 0; i < quickcheck_names.size(); ++i) {
+    result.AddTestCase(*std::move(test_cases[i]));
+    if (counterexample_values[i].has_value()) {
+      counterexamples[quickcheck_names[i]] =
+          *std::move(counterexample_values[i]);
     }
-    std::string one_liner =
-        absl::StrCat("counterexample: ", absl::StrJoin(counterexample, ", "));
-    status = ProofErrorStatus(quickcheck->span(), one_liner);
-    counterexamples[quickcheck_name] = std::move(counterexample);
-    absl::Time test_case_end = absl::Now();
-    absl::Duration duration = test_case_end - test_case_start;
-    HandleError(result, status, quickcheck_name, start_pos, test_case_start,
-                duration, /*is_quickcheck=*/true);
   }
 
   result.Finish(TestResult::kSomeFailed, absl::Now() - start);
@@ -689,61 +1039,57 @@ absl::StatusOr<TestResultData> ParseAndTest(
     };
   }
 
-  // Run unit tests.
-  for (const std::string& test_name : entry_module->GetTestNames()) {
+  // Run unit tests. Tests which don't match the filter are recorded right
+  // away; the others run either in order on this thread or sharded across
+  // worker threads, but are reported in declaration order either way.
+  const std::vector<std::string> test_names = entry_module->GetTestNames();
+  std::vector<std::optional<test_xml::TestCase>> test_cases(test_names.size());
+  std::vector<int64_t> to_run;
+  for (int64_t i = 0; i < test_names.size(); ++i) {
+    const std::string& test_name = test_names[i];
+    if (TestMatchesFilter(test_name, options.test_filter)) {
+      to_run.push_back(i);
+      continue;
+    }
     auto test_case_start = absl::Now();
     ModuleMember* member = entry_module->FindMemberWithName(test_name).value();
     const Pos start_pos = GetPos(*member);
+    auto test_case_end = absl::Now();
+    test_cases[i] =
+        test_xml::TestCase{.name = test_name,
+                           .file = start_pos.filename(),
+                           .line = start_pos.GetHumanLineno(),
+                           .status = test_xml::RunStatus::kRun,
+                           .result = test_xml::RunResult::kFiltered,
+                           .time = test_case_end - test_case_start,
+                           .timestamp = test_case_start};
+  }
 
-    if (!TestMatchesFilter(test_name, options.test_filter)) {
-      auto test_case_end = absl::Now();
-      result.AddTestCase(
-          test_xml::TestCase{.name = test_name,
-                             .file = start_pos.filename(),
-                             .line = start_pos.GetHumanLineno(),
-                             .status = test_xml::RunStatus::kRun,
-                             .result = test_xml::RunResult::kFiltered,
-                             .time = test_case_end - test_case_start,
-                             .timestamp = test_case_start});
-      continue;
+  if (options.test_parallelism > 1 && to_run.size() > 1) {
+    std::vector<std::string> names_to_run;
+    names_to_run.reserve(to_run.size());
+    for (int64_t i : to_run) {
+      names_to_run.push_back(test_names[i]);
     }
-
-    std::cerr << "[ RUN UNITTEST  ] " << test_name << '\n';
-    absl::Status status;
-    BytecodeInterpreterOptions interpreter_options;
-    interpreter_options.post_fn_eval_hook(post_fn_eval_hook)
-        .trace_hook(InfoLoggingTraceHook)
-        .trace_channels(options.trace_channels)
-        .max_ticks(options.max_ticks)
-        .format_preference(options.format_preference);
-    if (std::holds_alternative<TestFunction*>(*member)) {
-      XLS_ASSIGN_OR_RETURN(TestFunction * tf, entry_module->GetTest(test_name));
-      status = RunTestFunction(&import_data, tm_or.value().type_info,
-                               entry_module, tf, interpreter_options);
-    } else {
-      XLS_ASSIGN_OR_RETURN(TestProc * tp, entry_module->GetTestProc(test_name));
-      status = RunTestProc(&import_data, tm_or.value().type_info, entry_module,
-                           tp, interpreter_options);
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<test_xml::TestCase> ran,
+        RunUnitTestsInParallel(&import_data, tm_or.value().type_info,
+                               entry_module, names_to_run, options,
+                               post_fn_eval_hook, options.test_parallelism));
+    for (int64_t j = 0; j < to_run.size(); ++j) {
+      test_cases[to_run[j]] = std::move(ran[j]);
     }
-    auto test_case_end = absl::Now();
-
-    if (status.ok()) {
-      // Add to the tracking data.
-      result.AddTestCase(
-          test_xml::TestCase{.name = test_name,
-                             .file = start_pos.filename(),
-                             .line = start_pos.GetHumanLineno(),
-                             .status = test_xml::RunStatus::kRun,
-                             .result = test_xml::RunResult::kCompleted,
-                             .time = test_case_end - test_case_start,
-                             .timestamp = test_case_start});
-      std::cerr << "[            OK ]" << '\n';
-    } else {
-      HandleError(result, status, test_name, start_pos, test_case_start,
-                  test_case_end - test_case_start,
-                  /*is_quickcheck=*/false);
+  } else {
+    for (int64_t i : to_run) {
+      XLS_ASSIGN_OR_RETURN(
+          test_cases[i],
+          RunUnitTest(&import_data, tm_or.value().type_info, entry_module,
+                      test_names[i], options, post_fn_eval_hook, std::cerr));
     }
   }
+  for (std::optional<test_xml::TestCase>& test_case : test_cases) {
+    result.AddTestCase(*std::move(test_case));
+  }
 
   std::cerr << absl::StreamFormat(
                    "[===============] %d test(s) ran; %d failed; %d skipped.",
@@ -755,7 +1101,8 @@ absl::StatusOr<TestResultData> ParseAndTest(
   if (!entry_module->GetQuickChecks().empty()) {
     XLS_RETURN_IF_ERROR(RunQuickChecksIfJitEnabled(
         options.test_filter, entry_module, tm_or.value().type_info,
-        options.run_comparator, ir_package.get(), options.seed, result));
+        options.run_comparator, ir_package.get(), options.seed,
+        options.test_parallelism, result));
   }
 
   result.Finish(
@@ -76,6 +76,26 @@ class AbstractRunComparator {
   virtual absl::StatusOr<InterpreterResult<xls::Value>> RunIrFunction(
       std::string_view ir_name, xls::Function* ir_function,
       absl::Span<const xls::Value> ir_args) = 0;
+
+  // Evaluates the IR function on each of `arg_sets` using up to
+  // `thread_count` threads and returns the results in the same order. Returns
+  // an error if any evaluation fails (e.g. raises an assertion), in which case
+  // callers can use RunIrFunction to find out which one.
+  //
+  // The default implementation calls RunIrFunction on each argument set in
+  // turn.
+  virtual absl::StatusOr<std::vector<xls::Value>> RunIrFunctionBatched(
+      std::string_view ir_name, xls::Function* ir_function,
+      absl::Span<const std::vector<xls::Value>> arg_sets,
+      int64_t thread_count);
+};
+
+// How test procs are executed.
+enum class TestProcBackend : uint8_t {
+  // Tick the DSLX procs in the bytecode interpreter.
+  kInterpreter,
+  // Convert the test proc network to IR and tick it in the JIT proc runtime.
+  kJit,
 };
 
 // Optional arguments to ParseAndTest (that have sensible defaults).
@@ -91,6 +111,14 @@ class AbstractRunComparator {
 //   warnings_as_errors: Whether warnings should be reported as errors (i.e.
 //    cause the run routine to report failure when a warning is encountered).
 //   warnings: Set of warnings to enable for reporting.
+//   test_parallelism: Number of threads on which to run the unit tests (test
+//    functions and test procs); all of them share the typechecked ImportData
+//    read-only. Results and output are reported in declaration order
+//    regardless. Requires `run_comparator` to be thread-safe when > 1. Also
+//    the number of threads used to evaluate the samples of each quickcheck.
+//   test_proc_backend: How to execute test procs. With kJit, trace messages
+//    and assertion failures are reported from the events of the JIT procs and
+//    `trace_channels` has no effect.
 struct ParseAndTestOptions {
   std::string stdlib_path = xls::kDefaultDslxStdlibPath;
   absl::Span<const std::filesystem::path> dslx_paths;
@@ -104,16 +132,27 @@ struct ParseAndTestOptions {
   WarningKindSet warnings = kDefaultWarningsSet;
   bool trace_channels = false;
   std::optional<int64_t> max_ticks;
+  int64_t test_parallelism = 1;
+  TestProcBackend test_proc_backend = TestProcBackend::kInterpreter;
 };
 
 // As above, but a subset of the options required for the ParseAndProve()
-// routine.
+// routine, plus:
+//
+//   proof_parallelism: Number of threads on which to prove the quickchecks,
+//    each with its own Z3 context. The quickchecks are still converted to IR
+//    one at a time, and results and output are reported in declaration order
+//    regardless.
+//   timeout_per_quickcheck: How long each proof may run before the quickcheck
+//    is reported as timed out (a failure). Unbounded if not set.
 struct ParseAndProveOptions {
   std::string stdlib_path = xls::kDefaultDslxStdlibPath;
   absl::Span<const std::filesystem::path> dslx_paths;
   const RE2* test_filter = nullptr;
   bool warnings_as_errors = true;
   WarningKindSet warnings = kDefaultWarningsSet;
+  int64_t proof_parallelism = 1;
+  std::optional<absl::Duration> timeout_per_quickcheck;
 };
 
 enum class TestResult : uint8_t {
@@ -199,9 +238,8 @@ struct ParseAndProveResult {
   absl::flat_hash_map<std::string, std::vector<Value>> counterexamples;
 };
 
-// Parses program and attempts to prove the given quickcheck property.
-//
-// Note that this call can only prove a single quickcheck function.
+// Parses program and attempts to prove each of its quickcheck properties (that
+// match the test filter) for all inputs.
 absl::StatusOr<ParseAndProveResult> ParseAndProve(
     std::string_view program, std::string_view module_name,
     std::string_view filename, const ParseAndProveOptions& options);
@@ -218,9 +256,15 @@ struct QuickCheckResults {
 // xls_function is a predicate we're trying to find evidence to falsify, so if
 // this finds an example that falsifies the predicate, we early-return (i.e. the
 // length of the returned vectors may be < 1000).
+//
+// Arguments are generated and evaluated in batches (see
+// AbstractRunComparator::RunIrFunctionBatched) across `thread_count` threads.
+// The returned vectors are the same as if the samples were evaluated one at a
+// time, i.e. they end at the first falsifying example.
 absl::StatusOr<QuickCheckResults> DoQuickCheck(
     xls::Function* xls_function, std::string_view ir_name,
-    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests);
+    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests,
+    int64_t thread_count = 1);
 
 }  // namespace xls::dslx
 
@@ -16,15 +16,21 @@
 
 #include <cstdint>
 #include <optional>
+#include <random>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/run_routines/run_comparator.h"
+#include "xls/dslx/run_routines/test_xml.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/events.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
@@ -315,6 +321,45 @@ TEST(QuickcheckTest, Seeding) {
   EXPECT_EQ(results1, results2);
 }
 
+// Evaluating samples in multi-threaded batches should stop at the same
+// falsifying example as evaluating them one at a time.
+TEST(QuickcheckTest, BatchedMatchesSerial) {
+  Package package("rarely_false");
+  std::string ir_text = R"(
+  fn ne_abc(x: bits[12]) -> bits[1] {
+    literal.2: bits[12] = literal(value=0xabc)
+    ret ne.3: bits[1] = ne(x, literal.2)
+  }
+  )";
+  int64_t seed = 42;
+  int64_t num_tests = 100000;
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator jit_comparator(CompareMode::kJit);
+
+  std::minstd_rand rng_engine(seed);
+  std::vector<std::vector<Value>> expected_argsets;
+  for (int64_t i = 0; i < num_tests; ++i) {
+    expected_argsets.push_back(RandomFunctionArguments(function, rng_engine));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        InterpreterResult<Value> result,
+        jit_comparator.RunIrFunction(kFakeIrName, function,
+                                     expected_argsets.back()));
+    if (result.value.IsAllZeros()) {
+      break;
+    }
+  }
+  ASSERT_LT(expected_argsets.size(), num_tests);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto quickcheck_info,
+      DoQuickCheck(function, kFakeIrName, &jit_comparator, seed, num_tests,
+                   /*thread_count=*/4));
+  EXPECT_EQ(quickcheck_info.arg_sets, expected_argsets);
+  ASSERT_EQ(quickcheck_info.results.size(), expected_argsets.size());
+  EXPECT_EQ(quickcheck_info.results.back(), Value(UBits(0, 1)));
+}
+
 TEST(ParseAndTestTest, DeadlockedProc) {
   // Test proc never sends to the subproc, so network is deadlocked.
   constexpr std::string_view kProgram = R"(
@@ -411,6 +456,124 @@ proc tester_proc {
   EXPECT_THAT(result, IsTestResult(TestResult::kSomeFailed, 1, 0, 1));
 }
 
+// Returns a test proc which checks that a spawned proc adds `delta` to each of
+// the ten values sent to it.
+std::string MakeIncrementerTestProc(int64_t delta) {
+  return absl::StrFormat(R"(
+proc incrementer {
+  in_ch: chan<u32> in;
+  out_ch: chan<u32> out;
+
+  init { () }
+
+  config(in_ch: chan<u32> in,
+         out_ch: chan<u32> out) {
+    (in_ch, out_ch)
+  }
+  next(_: ()) {
+    let (tok, i) = recv(join(), in_ch);
+    let tok = send(tok, out_ch, i + u32:1);
+  }
+}
+
+#[test_proc]
+proc tester_proc {
+  data_out: chan<u32> out;
+  data_in: chan<u32> in;
+  terminator: chan<bool> out;
+
+  init { u32:0 }
+
+  config(terminator: chan<bool> out) {
+    let (input_out, input_in) = chan<u32>("input");
+    let (output_out, output_in) = chan<u32>("output");
+    spawn incrementer(input_in, output_out);
+    (input_out, output_in, terminator)
+  }
+
+  next(count: u32) {
+    let tok = send(join(), data_out, count);
+    let (tok, result) = recv(tok, data_in);
+    assert_eq(result, count + u32:%d);
+    let tok = send_if(tok, terminator, count == u32:10, true);
+    count + u32:1
+  }
+})",
+                         delta);
+}
+
+TEST(ParseAndTestTest, JitTestProcPasses) {
+  for (TestProcBackend backend :
+       {TestProcBackend::kInterpreter, TestProcBackend::kJit}) {
+    ParseAndTestOptions options;
+    options.test_proc_backend = backend;
+    XLS_ASSERT_OK_AND_ASSIGN(
+        TestResultData result,
+        ParseAndTest(MakeIncrementerTestProc(1), "test_module", "test.x",
+                     options));
+    EXPECT_THAT(result, IsTestResult(TestResult::kAllPassed, 1, 0, 0));
+  }
+}
+
+TEST(ParseAndTestTest, JitTestProcFailedAssertion) {
+  ParseAndTestOptions options;
+  options.test_proc_backend = TestProcBackend::kJit;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TestResultData result,
+      ParseAndTest(MakeIncrementerTestProc(2), "test_module", "test.x",
+                   options));
+  EXPECT_THAT(result, IsTestResult(TestResult::kSomeFailed, 1, 0, 1));
+}
+
+TEST(ParseAndTestTest, JitTestProcReportsFailure) {
+  constexpr std::string_view kProgram = R"(
+#[test_proc]
+proc doomed {
+  terminator: chan<bool> out;
+
+  init { () }
+
+  config(terminator: chan<bool> out) {
+    (terminator,)
+  }
+
+  next(state: ()) {
+    let tok = send(join(), terminator, false);
+  }
+})";
+  ParseAndTestOptions options;
+  options.test_proc_backend = TestProcBackend::kJit;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TestResultData result,
+      ParseAndTest(kProgram, "test_module", "test.x", options));
+  EXPECT_THAT(result, IsTestResult(TestResult::kSomeFailed, 1, 0, 1));
+}
+
+TEST(ParseAndTestTest, JitTestProcTooManyTicks) {
+  constexpr std::string_view kProgram = R"(
+#[test_proc]
+proc spinner {
+  terminator: chan<bool> out;
+
+  init { () }
+
+  config(terminator: chan<bool> out) {
+    (terminator,)
+  }
+
+  next(state: ()) {
+    let tok = send_if(join(), terminator, false, true);
+  }
+})";
+  ParseAndTestOptions options;
+  options.test_proc_backend = TestProcBackend::kJit;
+  options.max_ticks = 100;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TestResultData result,
+      ParseAndTest(kProgram, "test_module", "test.x", options));
+  EXPECT_THAT(result, IsTestResult(TestResult::kSomeFailed, 1, 0, 1));
+}
+
 inline constexpr std::string_view kTwoTests = R"(
 #[test] fn test_one() {}
 #[test] fn test_two() {}
@@ -450,4 +613,49 @@ TEST(ParseAndTestTest, TestFilterSelectBoth) {
   EXPECT_THAT(result, IsTestResult(TestResult::kAllPassed, 2, 0, 0));
 }
 
+// Running tests concurrently should give the same results, in the same
+// (declaration) order, as running them serially.
+TEST(ParseAndTestTest, ParallelTestsMatchSerial) {
+  constexpr std::string_view kProgram = R"(
+fn add_one(x: u32) -> u32 { x + u32:1 }
+
+#[test] fn test_a() { assert_eq(add_one(u32:1), u32:2) }
+#[test] fn test_b() { assert_eq(add_one(u32:2), u32:4) }
+#[test] fn test_c() { assert_eq(add_one(u32:3), u32:4) }
+#[test] fn test_d() { assert_eq(add_one(u32:4), u32:5) }
+#[test] fn test_e() { assert_eq(add_one(u32:5), u32:6) }
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto temp_file,
+                           TempFile::CreateWithContent(kProgram, "_test.x"));
+  const RE2 test_filter("test_[a-d]");
+
+  auto run = [&](int64_t test_parallelism) -> absl::StatusOr<TestResultData> {
+    RunComparator jit_comparator(CompareMode::kJit);
+    ParseAndTestOptions options;
+    options.run_comparator = &jit_comparator;
+    options.test_filter = &test_filter;
+    options.test_parallelism = test_parallelism;
+    return ParseAndTest(kProgram, "test", std::string(temp_file.path()),
+                        options);
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(TestResultData serial, run(1));
+  XLS_ASSERT_OK_AND_ASSIGN(TestResultData parallel, run(4));
+  EXPECT_THAT(serial, IsTestResult(TestResult::kSomeFailed, 5, 1, 1));
+  EXPECT_THAT(parallel, IsTestResult(TestResult::kSomeFailed, 5, 1, 1));
+
+  std::vector<test_xml::TestCase> serial_cases =
+      serial.ToXmlSuites("test").test_suites.at(0).test_cases;
+  std::vector<test_xml::TestCase> parallel_cases =
+      parallel.ToXmlSuites("test").test_suites.at(0).test_cases;
+  ASSERT_EQ(serial_cases.size(), parallel_cases.size());
+  for (int64_t i = 0; i < serial_cases.size(); ++i) {
+    EXPECT_EQ(serial_cases[i].name, parallel_cases[i].name);
+    EXPECT_EQ(serial_cases[i].result, parallel_cases[i].result);
+    EXPECT_EQ(serial_cases[i].failure.has_value(),
+              parallel_cases[i].failure.has_value());
+  }
+  EXPECT_EQ(parallel_cases.at(1).name, "test_b");
+  EXPECT_TRUE(parallel_cases.at(1).failure.has_value());
+}
+
 }  // namespace xls::dslx
@@ -16,9 +16,12 @@
 #include <cstdint>
 #include <memory>
 #include <tuple>
+#include <vector>
 
 #include "absl/flags/flag.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/init_xls.h"
 #include "xls/dslx/stdlib/float32_add_jit_wrapper.h"
@@ -51,6 +54,18 @@ static float ComputeActual(fp::Float32Add* jit_wrapper, Float2x32 input) {
   return jit_wrapper->Run(std::get<0>(input), std::get<1>(input)).value();
 }
 
+// Computes FP addition via DSLX & the JIT, a block of inputs at a time.
+static void ComputeActualBatch(fp::Float32Add* jit_wrapper,
+                               absl::Span<const Float2x32> inputs,
+                               absl::Span<float> results) {
+  std::vector<float> xs(inputs.size());
+  std::vector<float> ys(inputs.size());
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    std::tie(xs[i], ys[i]) = inputs[i];
+  }
+  CHECK_OK(jit_wrapper->RunBatched(xs, ys, results));
+}
+
 static std::unique_ptr<fp::Float32Add> CreateJit() {
   return fp::Float32Add::Create().value();
 }
@@ -59,6 +74,7 @@ static absl::Status RealMain(uint64_t num_samples, int num_threads) {
   TestbenchBuilder<Float2x32, float, fp::Float32Add> builder(
       ComputeExpected, ComputeActual, CreateJit);
   builder.SetCompareResultsFn(CompareResults).SetNumSamples(num_samples);
+  builder.SetComputeActualBatchFn(ComputeActualBatch);
   if (num_threads != 0) {
     builder.SetNumThreads(num_threads);
   }
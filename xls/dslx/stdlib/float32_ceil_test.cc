@@ -15,9 +15,13 @@
 // Random-sampling test for the DSLX 32 to 64 bit floating-point upcast.
 #include <cmath>
 #include <cstdint>
+#include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/flags/flag.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/init_xls.h"
 #include "xls/dslx/stdlib/float32_ceil_jit_wrapper.h"
@@ -40,11 +44,21 @@ static double ComputeActual(fp::F32Ceil* jit_wrapper, float input) {
   return jit_wrapper->Run(input).value();
 }
 
+// Computes ceil via DSLX & the JIT, a block of inputs at a time.
+static void ComputeActualBatch(fp::F32Ceil* jit_wrapper,
+                               absl::Span<const float> inputs,
+                               absl::Span<double> results) {
+  std::vector<float> jit_results(inputs.size());
+  CHECK_OK(jit_wrapper->RunBatched(inputs, absl::MakeSpan(jit_results)));
+  absl::c_copy(jit_results, results.begin());
+}
+
 static absl::Status RealMain(uint64_t num_samples, int num_threads) {
   TestbenchBuilder<float, double, fp::F32Ceil> builder(
-      ComputeActual, ComputeExpected,
+      ComputeExpected, ComputeActual,
       []() { return fp::F32Ceil::Create().value(); });
   builder.SetCompareResultsFn(CompareResults).SetNumSamples(num_samples);
+  builder.SetComputeActualBatchFn(ComputeActualBatch);
   if (num_threads != 0) {
     builder.SetNumThreads(num_threads);
   }
@@ -16,9 +16,12 @@
 // inverse sqrt.
 #include <cmath>
 #include <cstdint>
+#include <vector>
 
 #include "absl/flags/flag.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/init_xls.h"
 #include "xls/dslx/stdlib/float32_fast_rsqrt_jit_wrapper.h"
@@ -47,12 +50,20 @@ static float ComputeActual(fp::Float32FastRsqrt* jit_wrapper, float input) {
   return jit_wrapper->Run(input).value();
 }
 
+// Computes the fast rsqrt via DSLX & the JIT, a block of inputs at a time.
+static void ComputeActualBatch(fp::Float32FastRsqrt* jit_wrapper,
+                               absl::Span<const float> inputs,
+                               absl::Span<float> results) {
+  CHECK_OK(jit_wrapper->RunBatched(inputs, results));
+}
+
 static absl::Status RealMain(uint64_t num_samples, int num_threads) {
   TestbenchBuilder<float, float, fp::Float32FastRsqrt> builder(
       ComputeExpected, ComputeActual,
       []() { return fp::Float32FastRsqrt::Create().value(); });
   builder.SetCompareResultsFn(CompareResultsWith1PercentMargin)
       .SetNumSamples(num_samples);
+  builder.SetComputeActualBatchFn(ComputeActualBatch);
   if (num_threads != 0) {
     builder.SetNumThreads(num_threads);
   }
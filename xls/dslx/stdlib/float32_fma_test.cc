@@ -18,12 +18,15 @@
 #include <limits>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include "absl/base/casts.h"
 #include "absl/flags/flag.h"
+#include "absl/log/check.h"
 #include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/init_xls.h"
 #include "xls/dslx/stdlib/float32_fma_jit_wrapper.h"
@@ -76,6 +79,19 @@ static float ComputeActual(fp::Float32Fma* jit_wrapper, Float3x32 input) {
   return result;
 }
 
+// Computes FP FMA via DSLX & the JIT, a block of inputs at a time.
+static void ComputeActualBatch(fp::Float32Fma* jit_wrapper,
+                               absl::Span<const Float3x32> inputs,
+                               absl::Span<float> results) {
+  std::vector<float> xs(inputs.size());
+  std::vector<float> ys(inputs.size());
+  std::vector<float> zs(inputs.size());
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    std::tie(xs[i], ys[i], zs[i]) = inputs[i];
+  }
+  CHECK_OK(jit_wrapper->RunBatched(xs, ys, zs, results));
+}
+
 static std::string PrintFloat(float a) {
   uint32_t a_int = absl::bit_cast<uint32_t>(a);
   return absl::StrFormat("0x%016x (0x%01x, 0x%03x, 0x%013x)", a_int,
@@ -100,6 +116,7 @@ static absl::Status RealMain(int64_t num_samples, int num_threads) {
       .SetPrintInputFn(PrintInput)
       .SetPrintResultFn(PrintFloat)
       .SetNumSamples(num_samples);
+  builder.SetComputeActualBatchFn(ComputeActualBatch);
   if (num_threads != 0) {
     builder.SetNumThreads(num_threads);
   }
@@ -16,13 +16,16 @@
 #include <cmath>
 #include <cstdint>
 #include <tuple>
+#include <vector>
 
 #include "absl/base/casts.h"
 #include "absl/flags/flag.h"
+#include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/init_xls.h"
 #include "xls/dslx/stdlib/float32_ldexp_jit_wrapper.h"
@@ -63,6 +66,19 @@ static float ComputeActual(fp::Float32Ldexp* jit_wrapper, Float32xint input) {
   return jit_wrapper->Run(std::get<0>(input), std::get<1>(input)).value();
 }
 
+// Computes FP ldexp via DSLX & the JIT, a block of inputs at a time.
+static void ComputeActualBatch(fp::Float32Ldexp* jit_wrapper,
+                               absl::Span<const Float32xint> inputs,
+                               absl::Span<float> results) {
+  std::vector<float> fractions(inputs.size());
+  std::vector<uint32_t> exps(inputs.size());
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    fractions[i] = std::get<0>(inputs[i]);
+    exps[i] = absl::bit_cast<uint32_t>(std::get<1>(inputs[i]));
+  }
+  CHECK_OK(jit_wrapper->RunBatched(fractions, exps, results));
+}
+
 static void LogMismatch(uint64_t index, Float32xint input, float expected,
                         float actual) {
   LOG(ERROR) << absl::StrFormat(
@@ -85,6 +101,7 @@ static absl::Status RealMain(uint64_t num_samples, int num_threads) {
       .SetCompareResultsFn(CompareResults)
       .SetLogErrorsFn(LogMismatch)
       .SetNumSamples(num_samples);
+  builder.SetComputeActualBatchFn(ComputeActualBatch);
   if (num_threads != 0) {
     builder.SetNumThreads(num_threads);
   }
@@ -15,9 +15,12 @@
 // Random-sampling test for the DSLX 2x32 floating-point multiplier.
 #include <cstdint>
 #include <tuple>
+#include <vector>
 
 #include "absl/flags/flag.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/init_xls.h"
 #include "xls/dslx/stdlib/float32_mul_jit_wrapper.h"
@@ -50,11 +53,24 @@ static float ComputeActual(fp::Float32Mul* jit_wrapper, Float2x32 input) {
   return jit_wrapper->Run(std::get<0>(input), std::get<1>(input)).value();
 }
 
+// Computes FP multiplication via DSLX & the JIT, a block of inputs at a time.
+static void ComputeActualBatch(fp::Float32Mul* jit_wrapper,
+                               absl::Span<const Float2x32> inputs,
+                               absl::Span<float> results) {
+  std::vector<float> xs(inputs.size());
+  std::vector<float> ys(inputs.size());
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    std::tie(xs[i], ys[i]) = inputs[i];
+  }
+  CHECK_OK(jit_wrapper->RunBatched(xs, ys, results));
+}
+
 static absl::Status RealMain(uint64_t num_samples, int num_threads) {
   TestbenchBuilder<Float2x32, float, fp::Float32Mul> builder(
-      ComputeActual, ComputeExpected,
+      ComputeExpected, ComputeActual,
       []() { return fp::Float32Mul::Create().value(); });
   builder.SetCompareResultsFn(CompareResults).SetNumSamples(num_samples);
+  builder.SetComputeActualBatchFn(ComputeActualBatch);
   if (num_threads != 0) {
     builder.SetNumThreads(num_threads);
   }
@@ -14,9 +14,12 @@
 
 // Random-sampling test for the DSLX 32 to 64 bit floating-point upcast.
 #include <cstdint>
+#include <vector>
 
 #include "absl/flags/flag.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/init_xls.h"
 #include "xls/dslx/stdlib/float32_test_utils.h"
@@ -42,11 +45,19 @@ static double ComputeActual(fp::F32ToF64* jit_wrapper, float input) {
   return jit_wrapper->Run(input).value();
 }
 
+// Computes the upcast via DSLX & the JIT, a block of inputs at a time.
+static void ComputeActualBatch(fp::F32ToF64* jit_wrapper,
+                               absl::Span<const float> inputs,
+                               absl::Span<double> results) {
+  CHECK_OK(jit_wrapper->RunBatched(inputs, results));
+}
+
 static absl::Status RealMain(uint64_t num_samples, int num_threads) {
   TestbenchBuilder<float, double, fp::F32ToF64> builder(
-      ComputeActual, ComputeExpected,
+      ComputeExpected, ComputeActual,
       []() { return fp::F32ToF64::Create().value(); });
   builder.SetCompareResultsFn(CompareResults).SetNumSamples(num_samples);
+  builder.SetComputeActualBatchFn(ComputeActualBatch);
   if (num_threads != 0) {
     builder.SetNumThreads(num_threads);
   }
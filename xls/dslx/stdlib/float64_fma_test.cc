@@ -18,12 +18,15 @@
 #include <limits>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include "absl/base/casts.h"
 #include "absl/flags/flag.h"
+#include "absl/log/check.h"
 #include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/math_util.h"
@@ -76,6 +79,19 @@ static double ComputeActual(fp::Float64Fma* jit_wrapper, Float3x64 input) {
   return result;
 }
 
+// Computes FP FMA via DSLX & the JIT, a block of inputs at a time.
+static void ComputeActualBatch(fp::Float64Fma* jit_wrapper,
+                               absl::Span<const Float3x64> inputs,
+                               absl::Span<double> results) {
+  std::vector<double> xs(inputs.size());
+  std::vector<double> ys(inputs.size());
+  std::vector<double> zs(inputs.size());
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    std::tie(xs[i], ys[i], zs[i]) = inputs[i];
+  }
+  CHECK_OK(jit_wrapper->RunBatched(xs, ys, zs, results));
+}
+
 static bool CompareResults(double a, double b) {
   return a == b || (std::isnan(a) && std::isnan(b)) ||
          (ZeroOrSubnormal(a) && ZeroOrSubnormal(b));
@@ -105,6 +121,7 @@ static absl::Status RealMain(int64_t num_samples, int num_threads) {
       .SetPrintInputFn(PrintInput)
       .SetPrintResultFn(PrintDouble)
       .SetNumSamples(num_samples);
+  builder.SetComputeActualBatchFn(ComputeActualBatch);
   if (num_threads != 0) {
     builder.SetNumThreads(num_threads);
   }
@@ -16,9 +16,12 @@
 #include <cmath>
 #include <cstdint>
 #include <tuple>
+#include <vector>
 
 #include "absl/flags/flag.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/init_xls.h"
 #include "xls/dslx/stdlib/float64_mul_jit_wrapper.h"
@@ -62,6 +65,18 @@ static double ComputeActual(fp::Float64Mul* jit_wrapper, Float2x64 input) {
   return jit_wrapper->Run(std::get<0>(input), std::get<1>(input)).value();
 }
 
+// Computes FP multiplication via DSLX & the JIT, a block of inputs at a time.
+static void ComputeActualBatch(fp::Float64Mul* jit_wrapper,
+                               absl::Span<const Float2x64> inputs,
+                               absl::Span<double> results) {
+  std::vector<double> xs(inputs.size());
+  std::vector<double> ys(inputs.size());
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    std::tie(xs[i], ys[i]) = inputs[i];
+  }
+  CHECK_OK(jit_wrapper->RunBatched(xs, ys, results));
+}
+
 // Compares expected vs. actual results, taking into account two special cases.
 static bool CompareResults(double a, double b) {
   // DSLX flushes subnormal outputs, while regular FP addition does not, so
@@ -72,9 +87,10 @@ static bool CompareResults(double a, double b) {
 
 static absl::Status RealMain(uint64_t num_samples, int num_threads) {
   TestbenchBuilder<Float2x64, double, fp::Float64Mul> builder(
-      ComputeActual, ComputeExpected,
+      ComputeExpected, ComputeActual,
       []() { return fp::Float64Mul::Create().value(); });
   builder.SetCompareResultsFn(CompareResults).SetNumSamples(num_samples);
+  builder.SetComputeActualBatchFn(ComputeActualBatch);
   if (num_threads != 0) {
     builder.SetNumThreads(num_threads);
   }
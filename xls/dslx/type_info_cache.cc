@@ -0,0 +1,100 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/type_info_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/const_init.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/type_system/type_info.pb.h"
+
+namespace xls::dslx {
+namespace {
+
+// Version of the format of cache entries; bump when TypeInfoCacheEntryProto
+// (or how type information is converted to it) changes incompatibly.
+constexpr std::string_view kFormatVersion = "1";
+
+ABSL_CONST_INIT absl::Mutex default_cache_mutex(absl::kConstInit);
+TypeInfoCache* default_cache ABSL_GUARDED_BY(default_cache_mutex) = nullptr;
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<TypeInfoCache>>
+TypeInfoCache::Create(const std::filesystem::path& directory) {
+  XLS_ASSIGN_OR_RETURN(ContentAddressedCache cache,
+                       ContentAddressedCache::Create(directory, ".typeinfo",
+                                                     "type info cache"));
+  return absl::WrapUnique(new TypeInfoCache(std::move(cache)));
+}
+
+/* static */ std::string TypeInfoCache::ComputeKey(const KeyOptions& options) {
+  std::string warnings = absl::StrCat("W", options.enabled_warnings.value());
+  std::vector<std::string_view> components = {
+      kFormatVersion, options.module_name, options.path, options.text,
+      warnings};
+  components.insert(components.end(), options.import_keys.begin(),
+                    options.import_keys.end());
+  return ContentAddressedCache::ComputeKey(components);
+}
+
+absl::StatusOr<std::optional<TypeInfoCacheEntryProto>> TypeInfoCache::Lookup(
+    std::string_view key) const {
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> contents,
+                       cache_.Lookup(key));
+  if (!contents.has_value()) {
+    return std::nullopt;
+  }
+  TypeInfoCacheEntryProto entry;
+  if (!entry.ParseFromString(*contents)) {
+    return absl::DataLossError(
+        absl::StrFormat("Unable to parse type info cache entry %s",
+                        cache_.GetPath(key).string()));
+  }
+  return entry;
+}
+
+absl::Status TypeInfoCache::Insert(std::string_view key,
+                                   const TypeInfoCacheEntryProto& entry) {
+  return cache_.Insert(key, entry.SerializeAsString());
+}
+
+void SetDefaultTypeInfoCache(std::unique_ptr<TypeInfoCache> cache) {
+  absl::MutexLock lock(&default_cache_mutex);
+  // Previously set caches may still be in use by in-flight imports so they are
+  // intentionally leaked.
+  default_cache = cache.release();
+}
+
+TypeInfoCache* GetDefaultTypeInfoCache() {
+  absl::MutexLock lock(&default_cache_mutex);
+  return default_cache;
+}
+
+}  // namespace xls::dslx
@@ -0,0 +1,92 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_TYPE_INFO_CACHE_H_
+#define XLS_DSLX_TYPE_INFO_CACHE_H_
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/dslx/type_system/type_info.pb.h"
+#include "xls/dslx/warning_kind.h"
+
+namespace xls::dslx {
+
+// A persistent cache of the type information of imported DSLX modules stored
+// in a directory on disk (see ContentAddressedCache), so that e.g. the standard
+// library does not have to be type checked again by every tool invocation. Each
+// entry holds the serialized type information (see TypeInfoClosureToProto) and
+// warnings of a module and is keyed on everything which affects type checking
+// it: its text, name and path, the enabled warnings, and the keys of the
+// modules it imports (so a change to an imported module invalidates the
+// entries of all its importers).
+//
+// Entries are not keyed on the version of the type checker itself so the cache
+// directory should not be shared between different versions of the tools.
+class TypeInfoCache {
+ public:
+  // Creates a cache backed by `directory`, creating the directory if it does
+  // not exist.
+  static absl::StatusOr<std::unique_ptr<TypeInfoCache>> Create(
+      const std::filesystem::path& directory);
+
+  // Components of a cache key.
+  struct KeyOptions {
+    std::string_view module_name;
+    std::string_view path;
+    std::string_view text;
+    WarningKindSet enabled_warnings;
+    // Keys of the modules imported by the module, in order of import.
+    absl::Span<const std::string> import_keys;
+  };
+
+  static std::string ComputeKey(const KeyOptions& options);
+
+  // Returns the entry for `key` or std::nullopt if there is none.
+  absl::StatusOr<std::optional<TypeInfoCacheEntryProto>> Lookup(
+      std::string_view key) const;
+
+  // Stores `entry` under `key`, replacing any existing entry.
+  absl::Status Insert(std::string_view key,
+                      const TypeInfoCacheEntryProto& entry);
+
+  const std::filesystem::path& directory() const { return cache_.directory(); }
+
+ private:
+  explicit TypeInfoCache(ContentAddressedCache cache)
+      : cache_(std::move(cache)) {}
+
+  ContentAddressedCache cache_;
+};
+
+// Sets the cache consulted when importing modules (see DoImport). Passing
+// nullptr disables caching. Typically called once at binary startup (e.g., by
+// InitTypeInfoCacheFromFlags).
+void SetDefaultTypeInfoCache(std::unique_ptr<TypeInfoCache> cache);
+
+// Returns the cache consulted when importing modules, or nullptr if caching is
+// disabled.
+TypeInfoCache* GetDefaultTypeInfoCache();
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_TYPE_INFO_CACHE_H_
@@ -0,0 +1,47 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/type_info_cache_flags.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/type_info_cache.h"
+
+ABSL_FLAG(std::string, dslx_type_info_cache_dir, "",
+          "If non-empty, directory in which to cache the type information of "
+          "imported DSLX modules. Importing an unchanged module (whose "
+          "imports are also unchanged) loads its type information from the "
+          "cache rather than type checking it again. The directory may be "
+          "shared between concurrent processes using the same version of the "
+          "tools.");
+
+namespace xls::dslx {
+
+absl::Status InitTypeInfoCacheFromFlags() {
+  std::string directory = absl::GetFlag(FLAGS_dslx_type_info_cache_dir);
+  if (directory.empty()) {
+    return absl::OkStatus();
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<TypeInfoCache> cache,
+                       TypeInfoCache::Create(directory));
+  SetDefaultTypeInfoCache(std::move(cache));
+  return absl::OkStatus();
+}
+
+}  // namespace xls::dslx
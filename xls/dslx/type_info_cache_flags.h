@@ -0,0 +1,27 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_TYPE_INFO_CACHE_FLAGS_H_
+#define XLS_DSLX_TYPE_INFO_CACHE_FLAGS_H_
+
+#include "absl/status/status.h"
+
+namespace xls::dslx {
+
+// Sets the default TypeInfoCache according to --dslx_type_info_cache_dir.
+absl::Status InitTypeInfoCacheFromFlags();
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_TYPE_INFO_CACHE_FLAGS_H_
@@ -0,0 +1,168 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/type_info_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/type_system/type_info.h"
+#include "xls/dslx/type_system/type_info.pb.h"
+#include "xls/dslx/warning_kind.h"
+
+namespace xls::dslx {
+namespace {
+
+TypeInfoCache::KeyOptions DefaultKeyOptions() {
+  return TypeInfoCache::KeyOptions{.module_name = "mylib",
+                                   .path = "/path/to/mylib.x",
+                                   .text = "pub const K = u32:3;",
+                                   .enabled_warnings = kDefaultWarningsSet,
+                                   .import_keys = {}};
+}
+
+int64_t CountCacheEntries(const std::filesystem::path& directory) {
+  int64_t count = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+    if (entry.path().extension() == ".typeinfo") {
+      ++count;
+    }
+  }
+  return count;
+}
+
+class TypeInfoCacheTest : public ::testing::Test {
+ protected:
+  void TearDown() override { SetDefaultTypeInfoCache(nullptr); }
+};
+
+TEST_F(TypeInfoCacheTest, KeyDependsOnAllInputs) {
+  const TypeInfoCache::KeyOptions options = DefaultKeyOptions();
+  std::string key = TypeInfoCache::ComputeKey(options);
+  EXPECT_EQ(key, TypeInfoCache::ComputeKey(options));
+
+  TypeInfoCache::KeyOptions other = options;
+  other.module_name = "otherlib";
+  EXPECT_NE(key, TypeInfoCache::ComputeKey(other));
+  other = options;
+  other.path = "/path/to/otherlib.x";
+  EXPECT_NE(key, TypeInfoCache::ComputeKey(other));
+  other = options;
+  other.text = "pub const K = u32:4;";
+  EXPECT_NE(key, TypeInfoCache::ComputeKey(other));
+  other = options;
+  other.enabled_warnings = kAllWarningsSet;
+  EXPECT_NE(key, TypeInfoCache::ComputeKey(other));
+  other = options;
+  std::string import_keys[] = {"abc"};
+  other.import_keys = import_keys;
+  EXPECT_NE(key, TypeInfoCache::ComputeKey(other));
+}
+
+TEST_F(TypeInfoCacheTest, EntryRoundTrips) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TypeInfoCache> cache,
+                           TypeInfoCache::Create(temp_dir.path() / "cache"));
+  std::string key = TypeInfoCache::ComputeKey(DefaultKeyOptions());
+  XLS_ASSERT_OK_AND_ASSIGN(std::optional<TypeInfoCacheEntryProto> found,
+                           cache->Lookup(key));
+  EXPECT_FALSE(found.has_value());
+
+  TypeInfoCacheEntryProto entry;
+  entry.add_warnings()->set_message("a warning");
+  XLS_ASSERT_OK(cache->Insert(key, entry));
+  XLS_ASSERT_OK_AND_ASSIGN(found, cache->Lookup(key));
+  ASSERT_TRUE(found.has_value());
+  ASSERT_EQ(found->warnings_size(), 1);
+  EXPECT_EQ(found->warnings(0).message(), "a warning");
+}
+
+TEST_F(TypeInfoCacheTest, MalformedEntryIsDataLoss) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TypeInfoCache> cache,
+                           TypeInfoCache::Create(temp_dir.path()));
+  std::string key = TypeInfoCache::ComputeKey(DefaultKeyOptions());
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / (key + ".typeinfo"),
+                                "\xff not a proto"));
+  EXPECT_THAT(cache->Lookup(key),
+              status_testing::StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST_F(TypeInfoCacheTest, ImportReusesCachedTypeInfo) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / "mylib.x", R"(
+pub const K = u32:3;
+
+pub fn double<N: u32>(x: uN[N]) -> uN[N] { x + x }
+)"));
+  constexpr std::string_view kMain = R"(
+import mylib;
+
+fn main(x: u8) -> u8 { mylib::double(x) + (mylib::K as u8) }
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TypeInfoCache> cache,
+                           TypeInfoCache::Create(temp_dir.path() / "cache"));
+  const std::filesystem::path cache_dir = cache->directory();
+  SetDefaultTypeInfoCache(std::move(cache));
+
+  // Type checks `kMain` with a fresh ImportData and returns the value of
+  // `mylib::K` noted in the type information of the imported module.
+  auto typecheck = [&]() -> absl::StatusOr<InterpValue> {
+    const std::filesystem::path search_paths[] = {temp_dir.path()};
+    ImportData import_data = CreateImportData(
+        kDefaultDslxStdlibPath, search_paths, kDefaultWarningsSet);
+    XLS_ASSIGN_OR_RETURN(
+        TypecheckedModule tm,
+        ParseAndTypecheck(kMain, "main.x", "main", &import_data));
+    XLS_ASSIGN_OR_RETURN(ImportTokens subject,
+                         ImportTokens::FromString("mylib"));
+    XLS_ASSIGN_OR_RETURN(ModuleInfo * info, import_data.Get(subject));
+    XLS_ASSIGN_OR_RETURN(ConstantDef * k,
+                         info->module().GetConstantDef("K"));
+    return info->type_info()->GetConstExpr(k);
+  };
+
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue first, typecheck());
+  EXPECT_EQ(first, InterpValue::MakeU32(3));
+  // Only the imported module is cached.
+  EXPECT_EQ(CountCacheEntries(cache_dir), 1);
+
+  // The second run should be served from the cache without adding any new
+  // entries.
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue second, typecheck());
+  EXPECT_EQ(second, InterpValue::MakeU32(3));
+  EXPECT_EQ(CountCacheEntries(cache_dir), 1);
+}
+
+}  // namespace
+}  // namespace xls::dslx
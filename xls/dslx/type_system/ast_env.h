@@ -46,6 +46,8 @@ class AstEnv {
 
   void Clear() { map_.clear(); }
 
+  bool empty() const { return map_.empty(); }
+
   MapT::const_iterator begin() const { return map_.begin(); }
   MapT::const_iterator end() const { return map_.end(); }
 
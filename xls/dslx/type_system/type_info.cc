@@ -30,6 +30,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/variant.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -152,9 +153,36 @@ absl::StatusOr<TypeInfo*> TypeInfoOwner::GetRootTypeInfo(const Module* module) {
   return it->second;
 }
 
+std::optional<TypeInfo*> TypeInfoOwner::GetInstantiation(
+    const Function* f, const ParametricEnv& env) const {
+  auto it = instantiations_.find(std::make_pair(f, env));
+  if (it == instantiations_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void TypeInfoOwner::NoteInstantiation(const Function* f,
+                                      const ParametricEnv& env,
+                                      TypeInfo* derived_type_info) {
+  CHECK_EQ(derived_type_info->module(), f->owner());
+  instantiations_.emplace(std::make_pair(f, env), derived_type_info);
+}
+
+void TypeInfoOwner::Remove(const Module* module) {
+  module_to_root_.erase(module);
+  absl::erase_if(instantiations_, [module](const auto& item) {
+    return item.first.first->owner() == module;
+  });
+  std::erase_if(type_infos_, [module](const std::unique_ptr<TypeInfo>& ti) {
+    return ti->module() == module;
+  });
+}
+
 // -- class TypeInfo
 
 void TypeInfo::NoteConstExpr(const AstNode* const_expr, InterpValue value) {
+  absl::MutexLock lock(&const_exprs_mu_);
   const_exprs_.insert({const_expr, value});
 }
 
@@ -164,8 +192,11 @@ absl::StatusOr<InterpValue> TypeInfo::GetConstExpr(
       << const_expr->owner()->name() << " vs " << module_->name()
       << " node: " << const_expr->ToString();
 
-  if (auto it = const_exprs_.find(const_expr); it != const_exprs_.end()) {
-    return it->second.value();
+  {
+    absl::MutexLock lock(&const_exprs_mu_);
+    if (auto it = const_exprs_.find(const_expr); it != const_exprs_.end()) {
+      return it->second.value();
+    }
   }
 
   if (parent_ != nullptr) {
@@ -187,8 +218,11 @@ std::optional<InterpValue> TypeInfo::GetConstExprOption(
       << const_expr->owner()->name() << " vs " << module_->name()
       << " node: " << const_expr->ToString();
 
-  if (auto it = const_exprs_.find(const_expr); it != const_exprs_.end()) {
-    return it->second;
+  {
+    absl::MutexLock lock(&const_exprs_mu_);
+    if (auto it = const_exprs_.find(const_expr); it != const_exprs_.end()) {
+      return it->second;
+    }
   }
 
   if (parent_ != nullptr) {
@@ -202,8 +236,11 @@ std::optional<InterpValue> TypeInfo::GetConstExprOption(
 }
 
 bool TypeInfo::IsKnownConstExpr(const AstNode* node) const {
-  if (const_exprs_.contains(node)) {
-    return const_exprs_.at(node).has_value();
+  {
+    absl::MutexLock lock(&const_exprs_mu_);
+    if (auto it = const_exprs_.find(node); it != const_exprs_.end()) {
+      return it->second.has_value();
+    }
   }
 
   if (parent_ != nullptr) {
@@ -214,8 +251,11 @@ bool TypeInfo::IsKnownConstExpr(const AstNode* node) const {
 }
 
 bool TypeInfo::IsKnownNonConstExpr(const AstNode* node) const {
-  if (const_exprs_.contains(node)) {
-    return !const_exprs_.at(node).has_value();
+  {
+    absl::MutexLock lock(&const_exprs_mu_);
+    if (auto it = const_exprs_.find(node); it != const_exprs_.end()) {
+      return !it->second.has_value();
+    }
   }
 
   if (parent_ != nullptr) {
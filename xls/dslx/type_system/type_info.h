@@ -21,14 +21,17 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/variant.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/pos.h"
@@ -136,6 +139,18 @@ class TypeInfoOwner {
   // status error if it is not present.
   absl::StatusOr<TypeInfo*> GetRootTypeInfo(const Module* module);
 
+  // Destroys the root and all derived type information for "module".
+  void Remove(const Module* module);
+
+  // Memo of parametric function instantiations: the derived type information
+  // for the body of "f" is fully determined by its parametric environment, so
+  // once it has been checked for "env" it is shared by all the invocations
+  // that instantiate "f" with the same environment, regardless of the caller.
+  std::optional<TypeInfo*> GetInstantiation(const Function* f,
+                                            const ParametricEnv& env) const;
+  void NoteInstantiation(const Function* f, const ParametricEnv& env,
+                         TypeInfo* derived_type_info);
+
  private:
   // Mapping from module to the "root" (or "parentmost") type info -- these have
   // nullptr as their parent. There should only be one of these for any given
@@ -145,6 +160,10 @@ class TypeInfoOwner {
   // Owned type information objects -- TypeInfoOwner is the lifetime owner for
   // these.
   std::vector<std::unique_ptr<TypeInfo>> type_infos_;
+
+  // See GetInstantiation().
+  absl::flat_hash_map<std::pair<const Function*, ParametricEnv>, TypeInfo*>
+      instantiations_;
 };
 
 class TypeInfo {
@@ -322,6 +341,26 @@ class TypeInfo {
     return dict_;
   }
 
+  // Accessors for the remaining underlying mappings, e.g. for serialization.
+  // All but `const_exprs()` are only populated on the root type information.
+  //
+  // Note: `const_exprs()` is not synchronized with `NoteConstExpr()`.
+  const absl::flat_hash_map<const AstNode*, std::optional<InterpValue>>&
+  const_exprs() const ABSL_NO_THREAD_SAFETY_ANALYSIS {
+    return const_exprs_;
+  }
+  const absl::flat_hash_map<Slice*, SliceData>& slices() const {
+    return slices_;
+  }
+  const absl::flat_hash_map<const Function*, bool>& requires_implicit_token()
+      const {
+    return requires_implicit_token_;
+  }
+  const absl::flat_hash_map<const Proc*, TypeInfo*>& top_level_proc_type_info()
+      const {
+    return top_level_proc_type_info_;
+  }
+
  private:
   friend class TypeInfoOwner;
 
@@ -368,7 +407,12 @@ class TypeInfo {
   // Node to constexpr-value mapping -- this is also present on "derived" type
   // info as constexprs take on different values in different parametric
   // instantiation contexts.
-  absl::flat_hash_map<const AstNode*, std::optional<InterpValue>> const_exprs_;
+  //
+  // Constexpr values are memoized lazily after type checking (e.g. by IR
+  // conversion), possibly from several threads, so the mapping is guarded.
+  mutable absl::Mutex const_exprs_mu_;
+  absl::flat_hash_map<const AstNode*, std::optional<InterpValue>> const_exprs_
+      ABSL_GUARDED_BY(const_exprs_mu_);
 
   // The following are only present on the root type info.
   absl::flat_hash_map<Import*, ImportedInfo> imports_;
@@ -16,6 +16,7 @@
 
 #include <optional>
 #include <string>
+#include <string_view>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -86,5 +87,52 @@ fn main() -> u32 {
                                  "present in parametric keys: {}")));
 }
 
+// Invocations of a parametric function with the same parametric environment
+// share the derived type information, even across callers.
+TEST(TypeInfoTest, InstantiationsWithSameEnvAreShared) {
+  ImportData import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(TypecheckedModule tm,
+                           ParseAndTypecheck(R"(
+fn p<N: u32>(x: bits[N]) -> bits[N] {
+  x + bits[N]:1
+}
+
+fn f() -> u32 {
+  p(u32:2)
+}
+
+fn g() -> u32 {
+  p(u32:3)
+}
+
+fn h() -> u8 {
+  p(u8:4)
+})",
+                                             "test.x", "test", &import_data));
+
+  auto get_invocation = [&](std::string_view caller) {
+    Function* fn = tm.module->GetFunctionByName().at(caller);
+    return down_cast<const Invocation*>(
+        ToAstNode(fn->body()->statements().at(0)->wrapped()));
+  };
+  std::optional<TypeInfo*> f_ti =
+      tm.type_info->GetInvocationTypeInfo(get_invocation("f"), {});
+  std::optional<TypeInfo*> g_ti =
+      tm.type_info->GetInvocationTypeInfo(get_invocation("g"), {});
+  std::optional<TypeInfo*> h_ti =
+      tm.type_info->GetInvocationTypeInfo(get_invocation("h"), {});
+  ASSERT_TRUE(f_ti.has_value());
+  ASSERT_TRUE(g_ti.has_value());
+  ASSERT_TRUE(h_ti.has_value());
+  EXPECT_EQ(*f_ti, *g_ti);
+  EXPECT_NE(*f_ti, *h_ti);
+
+  Function* p = tm.module->GetFunctionByName().at("p");
+  EXPECT_EQ(import_data.type_info_owner().GetInstantiation(
+                p, ParametricEnv(absl::flat_hash_map<std::string, InterpValue>{
+                       {"N", InterpValue::MakeU32(32)}})),
+            f_ti);
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -26,6 +26,8 @@
 #include <vector>
 
 #include "absl/base/optimization.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -34,13 +36,16 @@
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/common/proto_adaptor_utils.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/channel_direction.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/ast_node.h"
+#include "xls/dslx/frontend/module.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/interp_value.h"
+#include "xls/dslx/type_system/parametric_env.h"
 #include "xls/dslx/type_system/parametric_expression.h"
 #include "xls/dslx/type_system/type.h"
 #include "xls/dslx/type_system/type_info.h"
@@ -201,17 +206,38 @@ std::string U8sToString(absl::Span<const uint8_t> bs) {
   return std::string(reinterpret_cast<const char*>(bs.data()), bs.size());
 }
 
+BitsValueProto ToProto(const Bits& bits, bool is_signed) {
+  BitsValueProto proto;
+  proto.set_is_signed(is_signed);
+  proto.set_bit_count(static_cast<int32_t>(bits.bit_count()));
+  // Bits::ToBytes is in little-endian format. The proto stores data in
+  // big-endian.
+  std::vector<uint8_t> bytes = bits.ToBytes();
+  std::reverse(bytes.begin(), bytes.end());
+  *proto.mutable_data() = U8sToString(bytes);
+  return proto;
+}
+
+// Forward decl since enum values refer to their definition.
+absl::StatusOr<EnumDefProto> ToProto(const EnumDef& enum_def);
+
 absl::StatusOr<InterpValueProto> ToProto(const InterpValue& v) {
   InterpValueProto proto;
   if (v.IsBits()) {
-    BitsValueProto* bvp = proto.mutable_bits();
-    bvp->set_is_signed(v.IsSBits());
-    bvp->set_bit_count(static_cast<int32_t>(v.GetBitCount().value()));
-    // Bits::ToBytes is in little-endian format. The proto stores data in
-    // big-endian.
-    std::vector<uint8_t> bytes = v.GetBitsOrDie().ToBytes();
-    std::reverse(bytes.begin(), bytes.end());
-    *bvp->mutable_data() = U8sToString(bytes);
+    *proto.mutable_bits() = ToProto(v.GetBitsOrDie(), v.IsSBits());
+  } else if (std::optional<InterpValue::EnumData> enum_data =
+                 v.GetEnumData()) {
+    EnumValueProto* evp = proto.mutable_enum_value();
+    XLS_ASSIGN_OR_RETURN(*evp->mutable_enum_def(), ToProto(*enum_data->def));
+    *evp->mutable_bits() = ToProto(enum_data->value, enum_data->is_signed);
+  } else if (v.IsTuple() || v.IsArray()) {
+    InterpValuesProto* ivp =
+        v.IsTuple() ? proto.mutable_tuple() : proto.mutable_array();
+    for (const InterpValue& element : v.GetValuesOrDie()) {
+      XLS_ASSIGN_OR_RETURN(*ivp->add_elements(), ToProto(element));
+    }
+  } else if (v.IsToken()) {
+    proto.mutable_token();
   } else {
     return absl::UnimplementedError(
         "TypeInfoProto: convert InterpValue to proto: " + v.ToString());
@@ -346,6 +372,9 @@ absl::StatusOr<EnumTypeProto> ToProto(const EnumType& enum_type) {
                        ToProto(enum_type.nominal_type()));
   XLS_ASSIGN_OR_RETURN(*proto.mutable_size(), ToProto(enum_type.size()));
   proto.set_is_signed(enum_type.is_signed());
+  for (const InterpValue& member : enum_type.members()) {
+    XLS_ASSIGN_OR_RETURN(*proto.add_members(), ToProto(member));
+  }
   VLOG(5) << "- proto: " << proto.ShortDebugString();
   return proto;
 }
@@ -445,19 +474,76 @@ absl::Span<const uint8_t> ToU8Span(const std::string& s) {
                                    s.size());
 }
 
-absl::StatusOr<InterpValue> FromProto(const InterpValueProto& ivp) {
+// Resolves the nominal definitions referred to (by span) from the protobuf
+// form of types and values.
+class DefinitionResolver {
+ public:
+  virtual ~DefinitionResolver() = default;
+  virtual absl::StatusOr<const EnumDef*> FindEnumDef(
+      const Span& span) const = 0;
+  virtual absl::StatusOr<const StructDef*> FindStructDef(
+      const Span& span) const = 0;
+};
+
+// Resolves definitions in the modules present in an ImportData.
+class ImportDataResolver : public DefinitionResolver {
+ public:
+  explicit ImportDataResolver(const ImportData& import_data)
+      : import_data_(import_data) {}
+
+  absl::StatusOr<const EnumDef*> FindEnumDef(const Span& span) const final {
+    return import_data_.FindEnumDef(span);
+  }
+  absl::StatusOr<const StructDef*> FindStructDef(
+      const Span& span) const final {
+    return import_data_.FindStructDef(span);
+  }
+
+ private:
+  const ImportData& import_data_;
+};
+
+Bits FromProto(const BitsValueProto& proto) {
+  std::vector<uint8_t> bytes;
+  for (uint8_t i8 : ToU8Span(proto.data())) {
+    bytes.push_back(i8);
+  }
+  // Bits::FromBytes expects data in little-endian format.
+  std::reverse(bytes.begin(), bytes.end());
+  return Bits::FromBytes(bytes, proto.bit_count());
+}
+
+absl::StatusOr<InterpValue> FromProto(const InterpValueProto& ivp,
+                                      const DefinitionResolver& resolver) {
   switch (ivp.value_oneof_case()) {
-    case InterpValueProto::ValueOneofCase::kBits: {
-      std::vector<uint8_t> bytes;
-      for (uint8_t i8 : ToU8Span(ivp.bits().data())) {
-        bytes.push_back(i8);
+    case InterpValueProto::ValueOneofCase::kBits:
+      return InterpValue::MakeBits(ivp.bits().is_signed(),
+                                   FromProto(ivp.bits()));
+    case InterpValueProto::ValueOneofCase::kEnumValue: {
+      const EnumValueProto& evp = ivp.enum_value();
+      XLS_ASSIGN_OR_RETURN(
+          const EnumDef* enum_def,
+          resolver.FindEnumDef(FromProto(evp.enum_def().span())));
+      return InterpValue::MakeEnum(FromProto(evp.bits()),
+                                   evp.bits().is_signed(), enum_def);
+    }
+    case InterpValueProto::ValueOneofCase::kTuple:
+    case InterpValueProto::ValueOneofCase::kArray: {
+      const InterpValuesProto& values = ivp.has_tuple() ? ivp.tuple()
+                                                        : ivp.array();
+      std::vector<InterpValue> elements;
+      elements.reserve(values.elements_size());
+      for (const InterpValueProto& element : values.elements()) {
+        XLS_ASSIGN_OR_RETURN(InterpValue value, FromProto(element, resolver));
+        elements.push_back(std::move(value));
       }
-      // Bits::FromBytes expects data in little-endian format.
-      std::reverse(bytes.begin(), bytes.end());
-      return InterpValue::MakeBits(
-          ivp.bits().is_signed(),
-          Bits::FromBytes(bytes, ivp.bits().bit_count()));
+      if (ivp.has_tuple()) {
+        return InterpValue::MakeTuple(std::move(elements));
+      }
+      return InterpValue::MakeArray(std::move(elements));
     }
+    case InterpValueProto::ValueOneofCase::kToken:
+      return InterpValue::MakeToken();
     default:
       break;
   }
@@ -475,11 +561,31 @@ std::unique_ptr<ParametricSymbol> FromProto(
 }
 
 absl::StatusOr<std::unique_ptr<ParametricExpression>> FromProto(
-    const ParametricExpressionProto& proto) {
+    const ParametricExpressionProto& proto,
+    const DefinitionResolver& resolver) {
   switch (proto.expr_oneof_case()) {
     case ParametricExpressionProto::ExprOneofCase::kSymbol: {
       return FromProto(proto.symbol());
     }
+    case ParametricExpressionProto::ExprOneofCase::kConstant: {
+      XLS_ASSIGN_OR_RETURN(InterpValue value,
+                           FromProto(proto.constant().constant(), resolver));
+      return std::make_unique<ParametricConstant>(std::move(value));
+    }
+    case ParametricExpressionProto::ExprOneofCase::kMul: {
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<ParametricExpression> lhs,
+                           FromProto(proto.mul().lhs(), resolver));
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<ParametricExpression> rhs,
+                           FromProto(proto.mul().rhs(), resolver));
+      return std::make_unique<ParametricMul>(std::move(lhs), std::move(rhs));
+    }
+    case ParametricExpressionProto::ExprOneofCase::kAdd: {
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<ParametricExpression> lhs,
+                           FromProto(proto.add().lhs(), resolver));
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<ParametricExpression> rhs,
+                           FromProto(proto.add().rhs(), resolver));
+      return std::make_unique<ParametricAdd>(std::move(lhs), std::move(rhs));
+    }
     default:
       break;
   }
@@ -490,15 +596,17 @@ absl::StatusOr<std::unique_ptr<ParametricExpression>> FromProto(
       proto.ShortDebugString());
 }
 
-absl::StatusOr<TypeDim> FromProto(const TypeDimProto& ctdp) {
+absl::StatusOr<TypeDim> FromProto(const TypeDimProto& ctdp,
+                                  const DefinitionResolver& resolver) {
   switch (ctdp.dim_oneof_case()) {
     case TypeDimProto::DimOneofCase::kInterpValue: {
-      XLS_ASSIGN_OR_RETURN(InterpValue iv, FromProto(ctdp.interp_value()));
+      XLS_ASSIGN_OR_RETURN(InterpValue iv,
+                           FromProto(ctdp.interp_value(), resolver));
       return TypeDim(std::move(iv));
     }
     case TypeDimProto::DimOneofCase::kParametric: {
       XLS_ASSIGN_OR_RETURN(std::unique_ptr<ParametricExpression> p,
-                           FromProto(ctdp.parametric()));
+                           FromProto(ctdp.parametric(), resolver));
       return TypeDim(std::move(p));
     }
     default:
@@ -510,12 +618,25 @@ absl::StatusOr<TypeDim> FromProto(const TypeDimProto& ctdp) {
   }
 }
 
-absl::StatusOr<std::unique_ptr<Type>> FromProto(const TypeProto& ctp,
-                                                const ImportData& import_data) {
+absl::StatusOr<ChannelDirection> FromProto(ChannelDirectionProto p) {
+  switch (p) {
+    case CHANNEL_DIRECTION_IN:
+      return ChannelDirection::kIn;
+    case CHANNEL_DIRECTION_OUT:
+      return ChannelDirection::kOut;
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid ChannelDirectionProto: ", p));
+  }
+}
+
+absl::StatusOr<std::unique_ptr<Type>> FromProto(
+    const TypeProto& ctp, const DefinitionResolver& resolver) {
   VLOG(5) << "Converting TypeProto to C++: " << ctp.ShortDebugString();
   switch (ctp.type_oneof_case()) {
     case TypeProto::TypeOneofCase::kBitsType: {
-      XLS_ASSIGN_OR_RETURN(TypeDim dim, FromProto(ctp.bits_type().dim()));
+      XLS_ASSIGN_OR_RETURN(TypeDim dim,
+                           FromProto(ctp.bits_type().dim(), resolver));
       return std::make_unique<BitsType>(ctp.bits_type().is_signed(),
                                         std::move(dim));
     }
@@ -523,7 +644,7 @@ absl::StatusOr<std::unique_ptr<Type>> FromProto(const TypeProto& ctp,
       std::vector<std::unique_ptr<Type>> members;
       for (const TypeProto& member : ctp.tuple_type().members()) {
         XLS_ASSIGN_OR_RETURN(std::unique_ptr<Type> ct,
-                             FromProto(member, import_data));
+                             FromProto(member, resolver));
         members.push_back(std::move(ct));
       }
       return std::make_unique<TupleType>(std::move(members));
@@ -531,21 +652,23 @@ absl::StatusOr<std::unique_ptr<Type>> FromProto(const TypeProto& ctp,
     case TypeProto::TypeOneofCase::kArrayType: {
       XLS_ASSIGN_OR_RETURN(
           std::unique_ptr<Type> element_type,
-          FromProto(ctp.array_type().element_type(), import_data));
-      XLS_ASSIGN_OR_RETURN(TypeDim size, FromProto(ctp.array_type().size()));
+          FromProto(ctp.array_type().element_type(), resolver));
+      XLS_ASSIGN_OR_RETURN(TypeDim size,
+                           FromProto(ctp.array_type().size(), resolver));
       return std::make_unique<ArrayType>(std::move(element_type),
                                          std::move(size));
     }
     case TypeProto::TypeOneofCase::kEnumType: {
       const EnumTypeProto& etp = ctp.enum_type();
       const EnumDefProto& enum_def_proto = etp.enum_def();
-      XLS_ASSIGN_OR_RETURN(TypeDim size, FromProto(ctp.enum_type().size()));
+      XLS_ASSIGN_OR_RETURN(TypeDim size,
+                           FromProto(ctp.enum_type().size(), resolver));
       XLS_ASSIGN_OR_RETURN(
           const EnumDef* enum_def,
-          import_data.FindEnumDef(FromProto(enum_def_proto.span())));
+          resolver.FindEnumDef(FromProto(enum_def_proto.span())));
       std::vector<InterpValue> members;
       for (const InterpValueProto& value : etp.members()) {
-        XLS_ASSIGN_OR_RETURN(InterpValue member, FromProto(value));
+        XLS_ASSIGN_OR_RETURN(InterpValue member, FromProto(value, resolver));
         members.push_back(member);
       }
 
@@ -557,11 +680,11 @@ absl::StatusOr<std::unique_ptr<Type>> FromProto(const TypeProto& ctp,
       std::vector<std::unique_ptr<Type>> params;
       for (const TypeProto& param : ftp.params()) {
         XLS_ASSIGN_OR_RETURN(std::unique_ptr<Type> ct,
-                             FromProto(param, import_data));
+                             FromProto(param, resolver));
         params.push_back(std::move(ct));
       }
       XLS_ASSIGN_OR_RETURN(std::unique_ptr<Type> rt,
-                           FromProto(ftp.return_type(), import_data));
+                           FromProto(ftp.return_type(), resolver));
       return std::make_unique<FunctionType>(std::move(params), std::move(rt));
     }
     case TypeProto::TypeOneofCase::kTokenType: {
@@ -572,18 +695,32 @@ absl::StatusOr<std::unique_ptr<Type>> FromProto(const TypeProto& ctp,
       const StructDefProto& struct_def_proto = stp.struct_def();
       XLS_ASSIGN_OR_RETURN(
           const StructDef* struct_def,
-          import_data.FindStructDef(FromProto(struct_def_proto.span())));
+          resolver.FindStructDef(FromProto(struct_def_proto.span())));
       std::vector<std::unique_ptr<Type>> members;
       for (const TypeProto& member_proto : stp.members()) {
         XLS_ASSIGN_OR_RETURN(std::unique_ptr<Type> member,
-                             FromProto(member_proto, import_data));
+                             FromProto(member_proto, resolver));
         members.push_back(std::move(member));
       }
       return std::make_unique<StructType>(std::move(members), *struct_def);
     }
+    case TypeProto::TypeOneofCase::kBitsConstructorType: {
+      XLS_ASSIGN_OR_RETURN(
+          TypeDim is_signed,
+          FromProto(ctp.bits_constructor_type().is_signed(), resolver));
+      return std::make_unique<BitsConstructorType>(std::move(is_signed));
+    }
+    case TypeProto::TypeOneofCase::kChannelType: {
+      const ChannelTypeProto& ctp_channel = ctp.channel_type();
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<Type> payload,
+                           FromProto(ctp_channel.payload(), resolver));
+      XLS_ASSIGN_OR_RETURN(ChannelDirection direction,
+                           FromProto(ctp_channel.direction()));
+      return std::make_unique<ChannelType>(std::move(payload), direction);
+    }
     case TypeProto::TypeOneofCase::kMetaType: {
       XLS_ASSIGN_OR_RETURN(std::unique_ptr<Type> wrapped,
-                           FromProto(ctp.meta_type().wrapped(), import_data));
+                           FromProto(ctp.meta_type().wrapped(), resolver));
       return std::make_unique<MetaType>(std::move(wrapped));
     }
     default:
@@ -597,7 +734,8 @@ absl::StatusOr<std::unique_ptr<Type>> FromProto(const TypeProto& ctp,
 
 absl::StatusOr<std::string> ToHumanString(const TypeProto& ctp,
                                           const ImportData& import_data) {
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Type> ct, FromProto(ctp, import_data));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Type> ct,
+                       FromProto(ctp, ImportDataResolver(import_data)));
   return ct->ToString();
 }
 
@@ -790,4 +928,592 @@ absl::StatusOr<std::string> ToHumanString(const TypeInfoProto& tip,
   return absl::StrJoin(lines, "\n");
 }
 
+namespace {
+
+// Converts the type information objects reachable from a module's root type
+// information to protobuf form. Modules and type information objects are
+// numbered in the order they are first referred to; a type information
+// object's parent is always numbered before it.
+class ClosureWriter {
+ public:
+  explicit ClosureWriter(const ParsedNodeCountFn& parsed_node_count)
+      : parsed_node_count_(parsed_node_count) {}
+
+  absl::StatusOr<TypeInfoClosureProto> Run(const TypeInfo& root) {
+    XLS_RET_CHECK(root.parent() == nullptr);
+    GetTypeInfoIndex(&root);
+    // Note: converting type information may discover more of it.
+    for (int64_t i = 0; i < type_infos_.size(); ++i) {
+      XLS_RETURN_IF_ERROR(
+          AddContents(*type_infos_[i], *proto_.mutable_type_infos(i)));
+    }
+    return std::move(proto_);
+  }
+
+ private:
+  int32_t GetModuleIndex(const Module* module) {
+    auto [it, inserted] = module_indices_.try_emplace(
+        module, static_cast<int32_t>(proto_.modules_size()));
+    if (inserted) {
+      proto_.add_modules(module->name());
+    }
+    return it->second;
+  }
+
+  int32_t GetTypeInfoIndex(const TypeInfo* type_info) {
+    if (auto it = type_info_indices_.find(type_info);
+        it != type_info_indices_.end()) {
+      return it->second;
+    }
+    std::optional<int32_t> parent;
+    if (type_info->parent() != nullptr) {
+      parent = GetTypeInfoIndex(type_info->parent());
+    }
+    int32_t index = static_cast<int32_t>(type_infos_.size());
+    type_info_indices_[type_info] = index;
+    type_infos_.push_back(type_info);
+    TypeInfoDataProto* data = proto_.add_type_infos();
+    data->set_module(GetModuleIndex(type_info->module()));
+    if (parent.has_value()) {
+      data->set_parent(*parent);
+    }
+    return index;
+  }
+
+  // Returns std::nullopt for nodes created after the owning module was parsed
+  // as those cannot be referred to when the module is parsed again.
+  absl::StatusOr<std::optional<AstNodeRefProto>> ToRef(const AstNode* node) {
+    const Module* module = node->owner();
+    auto it = node_indices_.find(module);
+    if (it == node_indices_.end()) {
+      std::optional<int64_t> limit = parsed_node_count_(module);
+      if (!limit.has_value()) {
+        return absl::UnimplementedError(absl::StrFormat(
+            "TypeInfoClosureToProto: AST nodes of module `%s` cannot be "
+            "referred to",
+            module->name()));
+      }
+      NodeIndices indices{.limit = *limit};
+      absl::Span<AstNode* const> nodes = module->nodes();
+      indices.indices.reserve(nodes.size());
+      for (int64_t i = 0; i < nodes.size(); ++i) {
+        indices.indices[nodes[i]] = i;
+      }
+      it = node_indices_.emplace(module, std::move(indices)).first;
+    }
+    auto index_it = it->second.indices.find(node);
+    if (index_it == it->second.indices.end()) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "TypeInfoClosureToProto: AST node `%s` is not owned by module `%s`",
+          node->ToString(), module->name()));
+    }
+    if (index_it->second >= it->second.limit) {
+      return std::nullopt;
+    }
+    AstNodeRefProto ref;
+    ref.set_module(GetModuleIndex(module));
+    ref.set_index(index_it->second);
+    ref.set_kind(ToProto(node->kind()));
+    return ref;
+  }
+
+  absl::StatusOr<ParametricEnvProto> EnvToProto(const ParametricEnv& env) {
+    ParametricEnvProto proto;
+    for (const ParametricEnvItem& item : env.bindings()) {
+      ParametricEnvItemProto* item_proto = proto.add_items();
+      item_proto->set_identifier(item.identifier);
+      XLS_ASSIGN_OR_RETURN(*item_proto->mutable_value(), ToProto(item.value));
+    }
+    return proto;
+  }
+
+  absl::Status AddContents(const TypeInfo& type_info,
+                           TypeInfoDataProto& data) {
+    for (const auto& [node, type] : type_info.dict()) {
+      XLS_ASSIGN_OR_RETURN(std::optional<AstNodeRefProto> ref, ToRef(node));
+      if (!ref.has_value()) {
+        continue;
+      }
+      NodeTypeProto* entry = data.add_types();
+      *entry->mutable_node() = *std::move(ref);
+      XLS_ASSIGN_OR_RETURN(*entry->mutable_type(), ToProto(*type));
+    }
+    for (const auto& [node, value] : type_info.const_exprs()) {
+      XLS_ASSIGN_OR_RETURN(std::optional<AstNodeRefProto> ref, ToRef(node));
+      if (!ref.has_value() || !value.has_value()) {
+        continue;
+      }
+      ConstExprProto* entry = data.add_const_exprs();
+      *entry->mutable_node() = *std::move(ref);
+      XLS_ASSIGN_OR_RETURN(*entry->mutable_value(), ToProto(*value));
+    }
+    if (type_info.parent() != nullptr) {
+      return absl::OkStatus();
+    }
+
+    for (const auto& [import, imported] : type_info.imports()) {
+      XLS_ASSIGN_OR_RETURN(std::optional<AstNodeRefProto> ref, ToRef(import));
+      if (!ref.has_value()) {
+        continue;
+      }
+      ImportedInfoProto* entry = data.add_imports();
+      *entry->mutable_import() = *std::move(ref);
+      entry->set_module(GetModuleIndex(imported.module));
+      entry->set_type_info(GetTypeInfoIndex(imported.type_info));
+    }
+    for (const auto& [invocation, invocation_data] :
+         type_info.GetRootInvocations()) {
+      XLS_ASSIGN_OR_RETURN(std::optional<AstNodeRefProto> ref,
+                           ToRef(invocation));
+      std::optional<AstNodeRefProto> caller;
+      if (invocation_data.caller() != nullptr) {
+        XLS_ASSIGN_OR_RETURN(caller, ToRef(invocation_data.caller()));
+        if (!caller.has_value()) {
+          continue;
+        }
+      }
+      if (!ref.has_value()) {
+        continue;
+      }
+      InvocationDataProto* entry = data.add_invocations();
+      *entry->mutable_invocation() = *std::move(ref);
+      if (caller.has_value()) {
+        *entry->mutable_caller() = *std::move(caller);
+      }
+      for (const auto& [caller_env, callee_data] :
+           invocation_data.env_to_callee_data()) {
+        InvocationCalleeDataProto* callee = entry->add_callees();
+        XLS_ASSIGN_OR_RETURN(*callee->mutable_caller_env(),
+                             EnvToProto(caller_env));
+        XLS_ASSIGN_OR_RETURN(*callee->mutable_callee_bindings(),
+                             EnvToProto(callee_data.callee_bindings));
+        if (callee_data.derived_type_info != nullptr) {
+          callee->set_derived_type_info(
+              GetTypeInfoIndex(callee_data.derived_type_info));
+        }
+      }
+    }
+    for (const auto& [slice, slice_data] : type_info.slices()) {
+      XLS_ASSIGN_OR_RETURN(std::optional<AstNodeRefProto> ref, ToRef(slice));
+      if (!ref.has_value()) {
+        continue;
+      }
+      SliceDataProto* entry = data.add_slices();
+      *entry->mutable_slice() = *std::move(ref);
+      for (const auto& [env, start_width] :
+           slice_data.bindings_to_start_width) {
+        SliceStartAndWidthProto* binding = entry->add_bindings();
+        XLS_ASSIGN_OR_RETURN(*binding->mutable_env(), EnvToProto(env));
+        binding->set_start(start_width.start);
+        binding->set_width(start_width.width);
+      }
+    }
+    for (const auto& [function, is_required] :
+         type_info.requires_implicit_token()) {
+      XLS_ASSIGN_OR_RETURN(std::optional<AstNodeRefProto> ref,
+                           ToRef(function));
+      if (!ref.has_value()) {
+        continue;
+      }
+      RequiresImplicitTokenProto* entry = data.add_requires_implicit_token();
+      *entry->mutable_function() = *std::move(ref);
+      entry->set_is_required(is_required);
+    }
+    for (const auto& [proc, proc_type_info] :
+         type_info.top_level_proc_type_info()) {
+      XLS_ASSIGN_OR_RETURN(std::optional<AstNodeRefProto> ref, ToRef(proc));
+      if (!ref.has_value()) {
+        continue;
+      }
+      TopLevelProcTypeInfoProto* entry = data.add_top_level_procs();
+      *entry->mutable_proc() = *std::move(ref);
+      entry->set_type_info(GetTypeInfoIndex(proc_type_info));
+    }
+    return absl::OkStatus();
+  }
+
+  struct NodeIndices {
+    int64_t limit;
+    absl::flat_hash_map<const AstNode*, int64_t> indices;
+  };
+
+  const ParsedNodeCountFn& parsed_node_count_;
+  TypeInfoClosureProto proto_;
+  absl::flat_hash_map<const Module*, int32_t> module_indices_;
+  absl::flat_hash_map<const TypeInfo*, int32_t> type_info_indices_;
+  std::vector<const TypeInfo*> type_infos_;
+  absl::flat_hash_map<const Module*, NodeIndices> node_indices_;
+};
+
+// Resolves definitions by the file name of their span within a fixed set of
+// modules (which, unlike ImportDataResolver, may include a module which has
+// not been added to the ImportData yet).
+class ModulesResolver : public DefinitionResolver {
+ public:
+  explicit ModulesResolver(absl::Span<Module* const> modules) {
+    for (Module* module : modules) {
+      if (module->fs_path().has_value()) {
+        by_filename_.emplace(module->fs_path()->string(), module);
+      }
+    }
+  }
+
+  absl::StatusOr<const EnumDef*> FindEnumDef(const Span& span) const final {
+    XLS_ASSIGN_OR_RETURN(const Module* module, FindModule(span));
+    if (const EnumDef* enum_def = module->FindEnumDef(span)) {
+      return enum_def;
+    }
+    return absl::NotFoundError(
+        absl::StrFormat("Could not find enum def @ %s within module %s",
+                        span.ToString(), module->name()));
+  }
+  absl::StatusOr<const StructDef*> FindStructDef(
+      const Span& span) const final {
+    XLS_ASSIGN_OR_RETURN(const Module* module, FindModule(span));
+    if (const StructDef* struct_def = module->FindStructDef(span)) {
+      return struct_def;
+    }
+    return absl::NotFoundError(
+        absl::StrFormat("Could not find struct def @ %s within module %s",
+                        span.ToString(), module->name()));
+  }
+
+ private:
+  absl::StatusOr<const Module*> FindModule(const Span& span) const {
+    auto it = by_filename_.find(span.filename());
+    if (it == by_filename_.end()) {
+      return absl::NotFoundError(
+          absl::StrCat("Could not find module: ", span.filename()));
+    }
+    return it->second;
+  }
+
+  absl::flat_hash_map<std::string, const Module*> by_filename_;
+};
+
+// Restores a TypeInfoClosureProto. Everything is resolved and validated before
+// any type information is created or modified so a failure leaves the
+// ImportData untouched.
+class ClosureReader {
+ public:
+  ClosureReader(const TypeInfoClosureProto& proto, Module* module,
+                ImportData& import_data)
+      : proto_(proto), module_(module), import_data_(import_data) {}
+
+  absl::StatusOr<TypeInfo*> Run() {
+    XLS_RETURN_IF_ERROR(ResolveModules());
+    ModulesResolver resolver(modules_);
+    for (int64_t i = 0; i < proto_.type_infos_size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          StagedTypeInfo staged,
+          Stage(proto_.type_infos(static_cast<int32_t>(i)), i, resolver));
+      staged_.push_back(std::move(staged));
+    }
+    XLS_RET_CHECK(!staged_.empty() && staged_[0].module == module_ &&
+                  !staged_[0].parent.has_value())
+        << "first type information must be the root of the module";
+    return Apply();
+  }
+
+ private:
+  struct StagedImport {
+    Import* import;
+    Module* module;
+    int64_t type_info;
+  };
+  struct StagedInvocation {
+    const Invocation* invocation;
+    const Function* caller;
+    ParametricEnv caller_env;
+    ParametricEnv callee_bindings;
+    std::optional<int64_t> derived_type_info;
+  };
+  struct StagedSlice {
+    Slice* slice;
+    ParametricEnv env;
+    StartAndWidth start_width;
+  };
+  struct StagedTypeInfo {
+    Module* module;
+    std::optional<int64_t> parent;
+    std::vector<std::pair<const AstNode*, std::unique_ptr<Type>>> types;
+    std::vector<std::pair<const AstNode*, InterpValue>> const_exprs;
+    std::vector<StagedImport> imports;
+    std::vector<StagedInvocation> invocations;
+    std::vector<StagedSlice> slices;
+    std::vector<std::pair<const Function*, bool>> requires_implicit_token;
+    std::vector<std::pair<const Proc*, int64_t>> top_level_procs;
+  };
+
+  // Resolves the modules of the closure: the first is the module being
+  // restored (which must not have type information yet) and the rest must
+  // already have been imported.
+  absl::Status ResolveModules() {
+    XLS_RET_CHECK_GT(proto_.modules_size(), 0);
+    XLS_RET_CHECK_EQ(proto_.modules(0), module_->name());
+    XLS_RET_CHECK(!import_data_.type_info_owner().GetRootTypeInfo(module_).ok())
+        << "module `" << module_->name() << "` already has type information";
+    modules_.push_back(module_);
+    roots_.push_back(nullptr);
+    for (int64_t i = 1; i < proto_.modules_size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          ImportTokens subject,
+          ImportTokens::FromString(proto_.modules(static_cast<int32_t>(i))));
+      XLS_ASSIGN_OR_RETURN(ModuleInfo * info, import_data_.Get(subject));
+      modules_.push_back(&info->module());
+      roots_.push_back(info->type_info());
+    }
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<Module*> GetModule(int64_t index) const {
+    XLS_RET_CHECK(index >= 0 && index < modules_.size());
+    return modules_[index];
+  }
+
+  absl::Status CheckTypeInfoIndex(int64_t index) const {
+    XLS_RET_CHECK(index >= 0 && index < proto_.type_infos_size());
+    return absl::OkStatus();
+  }
+
+  // Resolves `ref` which must refer to a node of type T owned by `owner`.
+  template <typename T>
+  absl::StatusOr<T*> Resolve(const AstNodeRefProto& ref, const Module* owner) {
+    XLS_ASSIGN_OR_RETURN(Module * module, GetModule(ref.module()));
+    XLS_RET_CHECK_EQ(module, owner);
+    absl::Span<AstNode* const> nodes = module->nodes();
+    XLS_RET_CHECK(ref.index() >= 0 && ref.index() < nodes.size());
+    AstNode* node = nodes[ref.index()];
+    XLS_ASSIGN_OR_RETURN(AstNodeKind kind, FromProto(ref.kind()));
+    XLS_RET_CHECK(node->kind() == kind)
+        << "node " << ref.index() << " of module `" << module->name()
+        << "` is a " << node->GetNodeTypeName();
+    T* result = dynamic_cast<T*>(node);
+    XLS_RET_CHECK(result != nullptr);
+    return result;
+  }
+
+  absl::StatusOr<ParametricEnv> FromEnvProto(
+      const ParametricEnvProto& proto, const DefinitionResolver& resolver) {
+    std::vector<std::pair<std::string, InterpValue>> items;
+    for (const ParametricEnvItemProto& item : proto.items()) {
+      XLS_ASSIGN_OR_RETURN(InterpValue value,
+                           FromProto(item.value(), resolver));
+      items.push_back({item.identifier(), std::move(value)});
+    }
+    return ParametricEnv(absl::MakeSpan(items));
+  }
+
+  absl::StatusOr<StagedTypeInfo> Stage(const TypeInfoDataProto& data,
+                                       int64_t index,
+                                       const DefinitionResolver& resolver) {
+    StagedTypeInfo staged;
+    XLS_ASSIGN_OR_RETURN(staged.module, GetModule(data.module()));
+    const Module* m = staged.module;
+    if (data.has_parent()) {
+      XLS_RET_CHECK(data.parent() >= 0 && data.parent() < index);
+      XLS_RET_CHECK_EQ(staged_[data.parent()].module, m);
+      staged.parent = data.parent();
+    } else {
+      XLS_RET_CHECK(roots_seen_.insert(m).second)
+          << "duplicate root type information for `" << m->name() << "`";
+    }
+    for (const NodeTypeProto& entry : data.types()) {
+      XLS_ASSIGN_OR_RETURN(AstNode * node, Resolve<AstNode>(entry.node(), m));
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<Type> type,
+                           FromProto(entry.type(), resolver));
+      staged.types.push_back({node, std::move(type)});
+    }
+    for (const ConstExprProto& entry : data.const_exprs()) {
+      XLS_ASSIGN_OR_RETURN(AstNode * node, Resolve<AstNode>(entry.node(), m));
+      XLS_ASSIGN_OR_RETURN(InterpValue value,
+                           FromProto(entry.value(), resolver));
+      staged.const_exprs.push_back({node, std::move(value)});
+    }
+    XLS_RET_CHECK(!staged.parent.has_value() ||
+                  (data.imports().empty() && data.invocations().empty() &&
+                   data.slices().empty() &&
+                   data.requires_implicit_token().empty() &&
+                   data.top_level_procs().empty()))
+        << "only root type information may note imports, invocations, "
+           "slices, implicit tokens and procs";
+    for (const ImportedInfoProto& entry : data.imports()) {
+      XLS_ASSIGN_OR_RETURN(Import * import,
+                           Resolve<Import>(entry.import(), m));
+      XLS_ASSIGN_OR_RETURN(Module * imported, GetModule(entry.module()));
+      XLS_RETURN_IF_ERROR(CheckTypeInfoIndex(entry.type_info()));
+      staged.imports.push_back(
+          StagedImport{import, imported, entry.type_info()});
+    }
+    for (const InvocationDataProto& entry : data.invocations()) {
+      XLS_ASSIGN_OR_RETURN(Invocation * invocation,
+                           Resolve<Invocation>(entry.invocation(), m));
+      const Function* caller = nullptr;
+      if (entry.has_caller()) {
+        XLS_ASSIGN_OR_RETURN(caller, Resolve<Function>(entry.caller(), m));
+      }
+      for (const InvocationCalleeDataProto& callee : entry.callees()) {
+        StagedInvocation staged_invocation{.invocation = invocation,
+                                           .caller = caller};
+        XLS_ASSIGN_OR_RETURN(staged_invocation.caller_env,
+                             FromEnvProto(callee.caller_env(), resolver));
+        // Checked here as InvocationData::Add would only fail after
+        // modifications have been made.
+        for (const std::string& key :
+             staged_invocation.caller_env.GetKeySet()) {
+          XLS_RET_CHECK(caller != nullptr &&
+                        caller->parametric_keys().contains(key))
+              << "invalid caller env key `" << key << "`";
+        }
+        XLS_ASSIGN_OR_RETURN(staged_invocation.callee_bindings,
+                             FromEnvProto(callee.callee_bindings(), resolver));
+        if (callee.has_derived_type_info()) {
+          XLS_RETURN_IF_ERROR(CheckTypeInfoIndex(callee.derived_type_info()));
+          staged_invocation.derived_type_info = callee.derived_type_info();
+        }
+        staged.invocations.push_back(std::move(staged_invocation));
+      }
+    }
+    for (const SliceDataProto& entry : data.slices()) {
+      XLS_ASSIGN_OR_RETURN(Slice * slice, Resolve<Slice>(entry.slice(), m));
+      for (const SliceStartAndWidthProto& binding : entry.bindings()) {
+        XLS_ASSIGN_OR_RETURN(ParametricEnv env,
+                             FromEnvProto(binding.env(), resolver));
+        staged.slices.push_back(StagedSlice{
+            slice, std::move(env),
+            StartAndWidth{.start = binding.start(), .width = binding.width()}});
+      }
+    }
+    for (const RequiresImplicitTokenProto& entry :
+         data.requires_implicit_token()) {
+      XLS_ASSIGN_OR_RETURN(Function * function,
+                           Resolve<Function>(entry.function(), m));
+      staged.requires_implicit_token.push_back({function, entry.is_required()});
+    }
+    for (const TopLevelProcTypeInfoProto& entry : data.top_level_procs()) {
+      XLS_ASSIGN_OR_RETURN(Proc * proc, Resolve<Proc>(entry.proc(), m));
+      XLS_RETURN_IF_ERROR(CheckTypeInfoIndex(entry.type_info()));
+      staged.top_level_procs.push_back({proc, entry.type_info()});
+    }
+    return staged;
+  }
+
+  // Creates the type information for the restored module and for everything
+  // derived, and merges the staged contents into those along with the root
+  // type information of the other modules. Information already present
+  // (e.g. recorded when a module that was type checked earlier in this
+  // process instantiated the same parametric function) is left as is.
+  absl::StatusOr<TypeInfo*> Apply() {
+    TypeInfoOwner& owner = import_data_.type_info_owner();
+    std::vector<TypeInfo*> type_infos;
+    type_infos.reserve(staged_.size());
+    for (const StagedTypeInfo& staged : staged_) {
+      if (staged.parent.has_value()) {
+        XLS_ASSIGN_OR_RETURN(
+            TypeInfo * type_info,
+            owner.New(staged.module, type_infos[*staged.parent]));
+        type_infos.push_back(type_info);
+      } else if (staged.module == module_) {
+        XLS_ASSIGN_OR_RETURN(TypeInfo * type_info, owner.New(staged.module));
+        type_infos.push_back(type_info);
+      } else {
+        auto it = std::find(modules_.begin(), modules_.end(), staged.module);
+        type_infos.push_back(roots_[it - modules_.begin()]);
+      }
+    }
+    for (int64_t i = 0; i < staged_.size(); ++i) {
+      StagedTypeInfo& staged = staged_[i];
+      TypeInfo* type_info = type_infos[i];
+      for (const auto& [node, type] : staged.types) {
+        if (!type_info->dict().contains(node)) {
+          type_info->SetItem(node, *type);
+        }
+      }
+      for (auto& [node, value] : staged.const_exprs) {
+        type_info->NoteConstExpr(node, std::move(value));
+      }
+      for (const StagedImport& import : staged.imports) {
+        if (!type_info->imports().contains(import.import)) {
+          type_info->AddImport(import.import, import.module,
+                               type_infos[import.type_info]);
+        }
+      }
+      for (const StagedInvocation& invocation : staged.invocations) {
+        if (type_info->GetInvocationCalleeBindings(invocation.invocation,
+                                                   invocation.caller_env)
+                .has_value()) {
+          continue;
+        }
+        XLS_RETURN_IF_ERROR(type_info->AddInvocationTypeInfo(
+            *invocation.invocation, invocation.caller, invocation.caller_env,
+            invocation.callee_bindings,
+            invocation.derived_type_info.has_value()
+                ? type_infos[*invocation.derived_type_info]
+                : nullptr));
+      }
+      for (const StagedSlice& slice : staged.slices) {
+        if (!type_info->GetSliceStartAndWidth(slice.slice, slice.env)
+                 .has_value()) {
+          type_info->AddSliceStartAndWidth(slice.slice, slice.env,
+                                           slice.start_width);
+        }
+      }
+      for (const auto& [function, is_required] :
+           staged.requires_implicit_token) {
+        type_info->NoteRequiresImplicitToken(*function, is_required);
+      }
+      for (const auto& [proc, proc_type_info] : staged.top_level_procs) {
+        if (!type_info->top_level_proc_type_info().contains(proc)) {
+          XLS_RETURN_IF_ERROR(type_info->SetTopLevelProcTypeInfo(
+              proc, type_infos[proc_type_info]));
+        }
+      }
+    }
+    return type_infos[0];
+  }
+
+  const TypeInfoClosureProto& proto_;
+  Module* module_;
+  ImportData& import_data_;
+  std::vector<Module*> modules_;
+  std::vector<TypeInfo*> roots_;
+  absl::flat_hash_set<const Module*> roots_seen_;
+  std::vector<StagedTypeInfo> staged_;
+};
+
+}  // namespace
+
+SpanProto SpanToProto(const Span& span) { return ToProto(span); }
+
+Span SpanFromProto(const SpanProto& proto) { return FromProto(proto); }
+
+absl::StatusOr<InterpValueProto> InterpValueToProto(const InterpValue& value) {
+  return ToProto(value);
+}
+
+absl::StatusOr<InterpValue> InterpValueFromProto(
+    const InterpValueProto& proto, const ImportData& import_data) {
+  return FromProto(proto, ImportDataResolver(import_data));
+}
+
+absl::StatusOr<TypeProto> TypeToProto(const Type& type) {
+  return ToProto(type);
+}
+
+absl::StatusOr<std::unique_ptr<Type>> TypeFromProto(
+    const TypeProto& proto, const ImportData& import_data) {
+  return FromProto(proto, ImportDataResolver(import_data));
+}
+
+absl::StatusOr<TypeInfoClosureProto> TypeInfoClosureToProto(
+    const TypeInfo& type_info, const ParsedNodeCountFn& parsed_node_count) {
+  return ClosureWriter(parsed_node_count).Run(type_info);
+}
+
+absl::StatusOr<TypeInfo*> TypeInfoClosureFromProto(
+    const TypeInfoClosureProto& proto, Module* module,
+    ImportData& import_data) {
+  return ClosureReader(proto, module, import_data).Run();
+}
+
 }  // namespace xls::dslx
@@ -15,10 +15,18 @@
 #ifndef XLS_DSLX_TYPE_SYSTEM_TYPE_INFO_TO_PROTO_H_
 #define XLS_DSLX_TYPE_SYSTEM_TYPE_INFO_TO_PROTO_H_
 
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
 
 #include "absl/status/statusor.h"
+#include "xls/dslx/frontend/module.h"
+#include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/import_data.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/dslx/type_system/type.h"
 #include "xls/dslx/type_system/type_info.h"
 #include "xls/dslx/type_system/type_info.pb.h"
 
@@ -28,6 +36,52 @@ namespace xls::dslx {
 // serialization.
 absl::StatusOr<TypeInfoProto> TypeInfoToProto(const TypeInfo& type_info);
 
+// Returns the number of AST nodes `module` had when it was parsed, or
+// std::nullopt if that is not known.
+using ParsedNodeCountFn =
+    std::function<std::optional<int64_t>(const Module* module)>;
+
+// Converts the root type information of a module -- along with the root type
+// information of every module it transitively imports and all the type
+// information derived from those (e.g. for parametric instantiations) -- to
+// protobuf form so it can be restored with TypeInfoClosureFromProto when the
+// module is parsed again from the same text.
+//
+// AST nodes are referred to by their index in Module::nodes(), which is only
+// stable for the nodes the parser created: information about nodes created
+// afterwards (e.g. synthesized during type checking) is dropped.
+//
+// Returns an error if some of the information cannot be converted (e.g. a
+// constexpr value which is a function).
+absl::StatusOr<TypeInfoClosureProto> TypeInfoClosureToProto(
+    const TypeInfo& type_info, const ParsedNodeCountFn& parsed_node_count);
+
+// Restores type information converted with TypeInfoClosureToProto for
+// `module`, which must not have any type information yet. All the other modules
+// in the closure must already be present in `import_data`; information missing
+// from their root type information is added to it. Returns the new root type
+// information for `module`.
+//
+// On error `import_data` is left unmodified.
+absl::StatusOr<TypeInfo*> TypeInfoClosureFromProto(
+    const TypeInfoClosureProto& proto, Module* module, ImportData& import_data);
+
+// Converts between spans and their protobuf form.
+SpanProto SpanToProto(const Span& span);
+Span SpanFromProto(const SpanProto& proto);
+
+// Converts between values and their protobuf form. Function and channel values
+// cannot be converted. Enum values refer to their definitions by span, which
+// must be present in `import_data` when converting back.
+absl::StatusOr<InterpValueProto> InterpValueToProto(const InterpValue& value);
+absl::StatusOr<InterpValue> InterpValueFromProto(const InterpValueProto& proto,
+                                                 const ImportData& import_data);
+
+// As above, for types.
+absl::StatusOr<TypeProto> TypeToProto(const Type& type);
+absl::StatusOr<std::unique_ptr<Type>> TypeFromProto(
+    const TypeProto& proto, const ImportData& import_data);
+
 // Converts the given protobuf representation of an AST node in module "m" into
 // a human readable string suitable for debugging and convenient testing.
 absl::StatusOr<std::string> ToHumanString(const AstNodeTypeInfoProto& antip,
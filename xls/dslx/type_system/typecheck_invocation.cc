@@ -417,6 +417,26 @@ absl::StatusOr<TypeAndParametricEnv> TypecheckInvocation(
   parent_ctx->type_info()->SetItem(invocation->callee(), instantiated_ft);
   ctx->type_info()->SetItem(callee_fn.name_def(), instantiated_ft);
 
+  // If the body has already been checked for this parametric environment (by
+  // any caller), share the resulting type information instead of deducing the
+  // body again. Procs are excluded since every instantiation needs its own
+  // constexpr values for the proc members.
+  const bool memoizable =
+      !callee_fn.proc().has_value() && constexpr_env.empty();
+  if (memoizable) {
+    if (std::optional<TypeInfo*> memoized =
+            ctx->type_info_owner().GetInstantiation(
+                &callee_fn, callee_tab.parametric_env);
+        memoized.has_value()) {
+      VLOG(5) << "Reusing instantiation of " << callee_fn.identifier()
+              << " with env: " << callee_tab.parametric_env;
+      XLS_RETURN_IF_ERROR(parent_ctx->type_info()->AddInvocationTypeInfo(
+          *invocation, caller, caller_parametric_env,
+          callee_tab.parametric_env, memoized.value()));
+      return callee_tab;
+    }
+  }
+
   // We need to deduce fn body, so we're going to call Deduce, which means we'll
   // need a new stack entry w/the new symbolic bindings.
   TypeInfo* const original_ti = parent_ctx->type_info();
@@ -513,6 +533,11 @@ absl::StatusOr<TypeAndParametricEnv> TypecheckInvocation(
   XLS_RETURN_IF_ERROR(ctx->PopDerivedTypeInfo(derived_type_info));
   ctx->PopFnStackEntry();
 
+  if (memoizable) {
+    ctx->type_info_owner().NoteInstantiation(
+        &callee_fn, callee_tab.parametric_env, derived_type_info);
+  }
+
   // Implementation note: though we could have all functions have
   // NoteRequiresImplicitToken() be false unless otherwise noted, this helps
   // guarantee we did consider and make a note for every function -- the code
@@ -17,7 +17,9 @@
 #include <algorithm>
 #include <cstdint>
 #include <iterator>
+#include <optional>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -39,14 +41,14 @@
 namespace xls {
 
 DelayManager::DelayManager(FunctionBase *function,
-                           const DelayEstimator &delay_estimator)
+                           const DelayEstimator &delay_estimator,
+                           std::optional<int64_t> delay_horizon_ps)
     : function_(function),
       index_to_node_(function_->node_count()),
-      indices_to_delay_(function_->node_count(),
-                        std::vector<int64_t>(function_->node_count(), -1)),
-      indices_to_critical_operand_(
-          function_->node_count(),
-          std::vector<Node *>(function_->node_count(), nullptr)),
+      index_to_topo_position_(function_->node_count()),
+      delay_horizon_ps_(delay_horizon_ps),
+      paths_to_(function_->node_count()),
+      targets_from_(function_->node_count()),
       name_(delay_estimator.name()) {
   // Get the mapping between function node and their index. Also, estimate the
   // delay of each node.
@@ -58,18 +60,107 @@ DelayManager::DelayManager(FunctionBase *function,
     absl::StatusOr<int64_t> maybe_delay =
         delay_estimator.GetOperationDelayInPs(node);
     CHECK_OK(maybe_delay.status());
-    indices_to_delay_[index][index] = maybe_delay.value();
+    SetPath(index, index, maybe_delay.value(), /*critical_operand=*/nullptr);
     index++;
   }
+  int64_t topo_position = 0;
+  for (Node *node : TopoSort(function_)) {
+    index_to_topo_position_[node_to_index_.at(node)] = topo_position++;
+  }
   PropagateDelays();
 }
 
+const DelayManager::PathDelay *DelayManager::FindPath(int64_t from_index,
+                                                      int64_t to_index) const {
+  auto it = paths_to_[to_index].find(from_index);
+  return it == paths_to_[to_index].end() ? nullptr : &it->second;
+}
+
+void DelayManager::SetPath(int64_t from_index, int64_t to_index, int64_t delay,
+                           Node *critical_operand) {
+  auto [it, inserted] = paths_to_[to_index].insert(
+      {from_index, PathDelay{.delay = delay,
+                             .critical_operand = critical_operand}});
+  if (inserted) {
+    targets_from_[from_index].push_back(to_index);
+  } else {
+    it->second = PathDelay{.delay = delay, .critical_operand = critical_operand};
+  }
+}
+
+std::vector<int64_t> DelayManager::SortedTargetsFrom(int64_t from_index) const {
+  std::vector<int64_t> targets = targets_from_[from_index];
+  std::sort(targets.begin(), targets.end());
+  return targets;
+}
+
+int64_t DelayManager::ComputeCriticalPath(int64_t from_index, int64_t to_index,
+                                          std::vector<Node *> *path) const {
+  int64_t from_position = index_to_topo_position_[from_index];
+  int64_t to_position = index_to_topo_position_[to_index];
+  if (from_position > to_position) {
+    return -1;
+  }
+
+  // Collect the nodes reachable from `from` which can precede `to` in the
+  // topological order.
+  std::vector<int64_t> reachable = {from_index};
+  absl::flat_hash_set<int64_t> visited = {from_index};
+  for (int64_t i = 0; i < reachable.size(); ++i) {
+    for (Node *user : index_to_node_[reachable[i]]->users()) {
+      int64_t user_index = node_to_index_.at(user);
+      if (index_to_topo_position_[user_index] <= to_position &&
+          visited.insert(user_index).second) {
+        reachable.push_back(user_index);
+      }
+    }
+  }
+  if (!visited.contains(to_index)) {
+    return -1;
+  }
+  std::sort(reachable.begin(), reachable.end(), [&](int64_t a, int64_t b) {
+    return index_to_topo_position_[a] < index_to_topo_position_[b];
+  });
+
+  // Longest path in topological order. Stored delays from `from` take
+  // precedence so that refined delays are honored.
+  absl::flat_hash_map<int64_t, PathDelay> delays;
+  for (int64_t index : reachable) {
+    if (const PathDelay *stored = FindPath(from_index, index);
+        stored != nullptr) {
+      delays[index] = *stored;
+      continue;
+    }
+    PathDelay critical{.delay = -1, .critical_operand = nullptr};
+    for (Node *operand : index_to_node_[index]->operands()) {
+      auto it = delays.find(node_to_index_.at(operand));
+      if (it != delays.end() && it->second.delay > critical.delay) {
+        critical = PathDelay{.delay = it->second.delay,
+                             .critical_operand = operand};
+      }
+    }
+    critical.delay += NodeDelay(index);
+    delays[index] = critical;
+  }
+
+  if (path != nullptr) {
+    path->clear();
+    Node *node = index_to_node_[to_index];
+    while (node != nullptr && node != index_to_node_[from_index]) {
+      path->push_back(node);
+      node = delays.at(node_to_index_.at(node)).critical_operand;
+    }
+    path->push_back(index_to_node_[from_index]);
+    std::reverse(path->begin(), path->end());
+  }
+  return delays.at(to_index).delay;
+}
+
 absl::StatusOr<int64_t> DelayManager::GetNodeDelay(Node *node) const {
   if (node->function_base() != function_) {
     return absl::InvalidArgumentError("invalid node");
   }
-  int64_t node_index = node_to_index_.at(node);
-  return indices_to_delay_[node_index][node_index];
+  return NodeDelay(node_to_index_.at(node));
 }
 
 absl::StatusOr<int64_t> DelayManager::GetCriticalPathDelay(Node *from,
@@ -79,7 +170,18 @@ absl::StatusOr<int64_t> DelayManager::GetCriticalPathDelay(Node *from,
   }
   int64_t from_index = node_to_index_.at(from);
   int64_t to_index = node_to_index_.at(to);
-  return indices_to_delay_[from_index][to_index];
+  if (const PathDelay *path = FindPath(from_index, to_index); path != nullptr) {
+    return path->delay;
+  }
+  if (!delay_horizon_ps_.has_value()) {
+    return -1;
+  }
+  auto [it, inserted] =
+      on_demand_delays_.insert({{from_index, to_index}, int64_t{-1}});
+  if (inserted) {
+    it->second = ComputeCriticalPath(from_index, to_index, /*path=*/nullptr);
+  }
+  return it->second;
 }
 
 absl::Status DelayManager::SetCriticalPathDelay(Node *from, Node *to,
@@ -90,10 +192,13 @@ absl::Status DelayManager::SetCriticalPathDelay(Node *from, Node *to,
   }
   int64_t from_index = node_to_index_.at(from);
   int64_t to_index = node_to_index_.at(to);
-  int64_t &current_delay = indices_to_delay_[from_index][to_index];
+  const PathDelay *path = FindPath(from_index, to_index);
+  int64_t current_delay = path == nullptr ? -1 : path->delay;
   if (!if_shorter || current_delay > delay) {
     if (!if_exist || current_delay != -1) {
-      current_delay = delay;
+      SetPath(from_index, to_index, delay,
+              path == nullptr ? nullptr : path->critical_operand);
+      on_demand_delays_.clear();
     }
   }
   return absl::OkStatus();
@@ -105,13 +210,21 @@ absl::StatusOr<std::vector<Node *>> DelayManager::GetFullCriticalPath(
   int64_t to_index = node_to_index_.at(to);
   std::vector<Node *> critical_path;
 
-  Node *critical_operand = indices_to_critical_operand_[from_index][to_index];
+  const PathDelay *path = FindPath(from_index, to_index);
+  if (path == nullptr) {
+    XLS_RET_CHECK(delay_horizon_ps_.has_value());
+    XLS_RET_CHECK_NE(ComputeCriticalPath(from_index, to_index, &critical_path),
+                     -1);
+    return critical_path;
+  }
+  Node *critical_operand = path->critical_operand;
   critical_path.push_back(to);
   while (critical_operand != nullptr && critical_operand != from) {
     critical_path.push_back(critical_operand);
-    int64_t critical_operand_index = node_to_index_.at(critical_operand);
-    critical_operand =
-        indices_to_critical_operand_[from_index][critical_operand_index];
+    const PathDelay *operand_path =
+        FindPath(from_index, node_to_index_.at(critical_operand));
+    XLS_RET_CHECK(operand_path != nullptr);
+    critical_operand = operand_path->critical_operand;
   }
   XLS_RET_CHECK(critical_operand == from);
   critical_path.push_back(from);
@@ -120,34 +233,38 @@ absl::StatusOr<std::vector<Node *>> DelayManager::GetFullCriticalPath(
 }
 
 void DelayManager::PropagateDelays() {
+  on_demand_delays_.clear();
+
   // Traverse the function in a reversed topological order.
   for (Node *node : ReverseTopoSort(function_)) {
     int64_t node_index = node_to_index_[node];
-    int64_t node_delay = indices_to_delay_[node_index][node_index];
-    std::vector<int64_t> new_delays(function_->node_count(), -1);
+    int64_t node_delay = NodeDelay(node_index);
+    absl::flat_hash_map<int64_t, int64_t> new_delays;
 
-    // Compute the critical-path distance from `a` to `node` for all nodes `a`
-    // from the delays of `a` to each operand of `node`.
+    // Compute the critical-path distance from `node` to `a` for all nodes `a`
+    // from the delays of each user of `node` to `a`.
     for (Node *user : node->users()) {
       int64_t user_index = node_to_index_[user];
-      for (int64_t i = 0; i < function_->node_count(); ++i) {
-        int64_t from_user_delay = indices_to_delay_[user_index][i];
-        if (from_user_delay != -1) {
-          // Always pick the critical path.
-          if (new_delays[i] < from_user_delay + node_delay) {
-            new_delays[i] = from_user_delay + node_delay;
-          }
+      for (int64_t i : targets_from_[user_index]) {
+        int64_t delay = paths_to_[i].at(user_index).delay + node_delay;
+        if (!WithinHorizon(delay, i)) {
+          continue;
+        }
+        // Always pick the critical path.
+        auto [it, inserted] = new_delays.insert({i, delay});
+        if (!inserted && it->second < delay) {
+          it->second = delay;
         }
       }
     }
 
     // Update the original delay if the newly calculated delay is smaller.
-    for (int64_t i = 0; i < function_->node_count(); ++i) {
-      if (new_delays[i] != -1) {
-        int64_t &current_delay = indices_to_delay_[node_index][i];
-        if (current_delay >= new_delays[i] || current_delay == -1) {
-          current_delay = new_delays[i];
-        }
+    for (const auto &[i, new_delay] : new_delays) {
+      const PathDelay *current = FindPath(node_index, i);
+      if (current == nullptr) {
+        SetPath(node_index, i, new_delay, /*critical_operand=*/nullptr);
+      } else if (current->delay >= new_delay) {
+        SetPath(node_index, i, new_delay, current->critical_operand);
       }
     }
   }
@@ -155,35 +272,39 @@ void DelayManager::PropagateDelays() {
   // Traverse the function in a topological order.
   for (Node *node : TopoSort(function_)) {
     int64_t node_index = node_to_index_[node];
-    int64_t node_delay = indices_to_delay_[node_index][node_index];
-    std::vector<int64_t> new_delays(function_->node_count(), -1);
-    std::vector<Node *> new_critical_operands(function_->node_count(), nullptr);
+    int64_t node_delay = NodeDelay(node_index);
+    absl::flat_hash_map<int64_t, PathDelay> new_delays;
+    // Sources with a path to `node` leaving the horizon. Paths from them are
+    // not stored even if other paths stay within the horizon.
+    absl::flat_hash_set<int64_t> beyond_horizon;
 
     // Compute the critical-path distance from `a` to `node` for all nodes `a`
     // from the delays of `a` to each operand of `node`.
     for (Node *operand : node->operands()) {
       int64_t operand_index = node_to_index_[operand];
-      for (int64_t i = 0; i < function_->node_count(); ++i) {
-        int64_t to_operand_delay = indices_to_delay_[i][operand_index];
-        if (to_operand_delay != -1) {
-          // Always pick the critical path.
-          if (new_delays[i] < to_operand_delay + node_delay) {
-            new_delays[i] = to_operand_delay + node_delay;
-            new_critical_operands[i] = operand;
-          }
+      for (const auto &[i, to_operand] : paths_to_[operand_index]) {
+        int64_t delay = to_operand.delay + node_delay;
+        if (!WithinHorizon(delay, node_index)) {
+          beyond_horizon.insert(i);
+          continue;
+        }
+        // Always pick the critical path.
+        auto [it, inserted] = new_delays.insert(
+            {i, PathDelay{.delay = delay, .critical_operand = operand}});
+        if (!inserted && it->second.delay < delay) {
+          it->second = PathDelay{.delay = delay, .critical_operand = operand};
         }
       }
     }
 
     // Update the original delay if the newly calculated delay is smaller.
-    for (int64_t i = 0; i < function_->node_count(); ++i) {
-      if (new_delays[i] != -1) {
-        int64_t &current_delay = indices_to_delay_[i][node_index];
-        if (current_delay >= new_delays[i] || current_delay == -1) {
-          current_delay = new_delays[i];
-          indices_to_critical_operand_[i][node_index] =
-              new_critical_operands[i];
-        }
+    for (const auto &[i, new_delay] : new_delays) {
+      if (beyond_horizon.contains(i)) {
+        continue;
+      }
+      const PathDelay *current = FindPath(i, node_index);
+      if (current == nullptr || current->delay >= new_delay.delay) {
+        SetPath(i, node_index, new_delay.delay, new_delay.critical_operand);
       }
     }
   }
@@ -197,10 +318,9 @@ DelayManager::GetPathsOverDelayThreshold(int64_t delay_threshold) const {
   }
   for (int64_t i = 0; i < function_->node_count(); ++i) {
     Node *from = index_to_node_[i];
-    for (int64_t j = 0; j < function_->node_count(); ++j) {
-      Node *to = index_to_node_[j];
-      if (indices_to_delay_[i][j] > delay_threshold) {
-        paths[from].push_back(to);
+    for (int64_t j : SortedTargetsFrom(i)) {
+      if (paths_to_[j].at(i).delay > delay_threshold) {
+        paths[from].push_back(index_to_node_[j]);
       }
     }
   }
@@ -221,9 +341,9 @@ absl::StatusOr<std::vector<PathInfo>> DelayManager::GetTopNPaths(
   std::vector<std::tuple<float, int64_t, Node *, Node *>> worklist;
   for (int64_t i = 0; i < function_->node_count(); ++i) {
     Node *from = index_to_node_[i];
-    for (int64_t j = 0; j < function_->node_count(); ++j) {
+    for (int64_t j : SortedTargetsFrom(i)) {
       Node *to = index_to_node_[j];
-      int64_t delay = indices_to_delay_[i][j];
+      int64_t delay = paths_to_[j].at(i).delay;
 
       if (delay < 0) {
         continue;
@@ -16,7 +16,9 @@
 #define XLS_FDO_DELAY_MANAGER_H_
 
 #include <cstdint>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -72,10 +74,26 @@ struct PathExtractOptions {
 // or proc. It allows users to update the delay between a certain pair of nodes,
 // re-calculate the critical delay of all pairs of nodes, extract paths longer
 // than a threshold, extract top-N longest paths, etc.
+//
+// Delays are stored sparsely, only for pairs of nodes connected by a path. If
+// `delay_horizon_ps` is given, a pair is only stored if the delay of its
+// critical path excluding the target node is at most the horizon. This bounds
+// the memory to the number of pairs within the horizon rather than all
+// connected pairs. With a horizon of at least the clock period, every path
+// longer than the clock period still has a stored prefix which is longer than
+// the clock period, so timing constraints derived from the stored pairs are
+// unchanged. The delays of pairs beyond the horizon are computed on demand by
+// GetCriticalPathDelay and GetFullCriticalPath and cached until the delays are
+// next updated. The path enumeration methods only consider stored pairs.
+//
+// Horizon pruning is detected one operand at a time, so a pair reached both
+// within the horizon and, through a deeper pruned path, beyond it may be stored
+// with the delay of its longest path within the horizon.
 class DelayManager {
  public:
   explicit DelayManager(FunctionBase *function,
-                        const DelayEstimator &delay_estimator);
+                        const DelayEstimator &delay_estimator,
+                        std::optional<int64_t> delay_horizon_ps = std::nullopt);
 
   absl::StatusOr<int64_t> GetNodeDelay(Node *node) const;
 
@@ -104,6 +122,7 @@ class DelayManager {
   void PropagateDelays();
 
   // Get all the paths whose delay is longer than the given delay threshold.
+  // Targets are ordered as the nodes of the function.
   absl::flat_hash_map<Node *, std::vector<Node *>> GetPathsOverDelayThreshold(
       int64_t delay_threshold) const;
 
@@ -130,9 +149,45 @@ class DelayManager {
       absl::FunctionRef<bool(Node *, Node *)> except = GetFalse) const;
 
  private:
+  struct PathDelay {
+    int64_t delay;
+    // The operand of the target node on the critical path. nullptr for the
+    // self-to-self path or if not yet known.
+    Node *critical_operand;
+  };
+
   static float GetZeroScore(Node *from, Node *to) { return 0.0; }
   static bool GetFalse(Node *from, Node *to) { return false; }
 
+  // Returns the stored path from `from_index` to `to_index`, or nullptr.
+  const PathDelay *FindPath(int64_t from_index, int64_t to_index) const;
+
+  // Stores the given path, replacing any existing one.
+  void SetPath(int64_t from_index, int64_t to_index, int64_t delay,
+               Node *critical_operand);
+
+  int64_t NodeDelay(int64_t index) const {
+    return paths_to_[index].at(index).delay;
+  }
+
+  // Returns true if a path of the given delay ending at `to_index` should be
+  // stored.
+  bool WithinHorizon(int64_t delay, int64_t to_index) const {
+    return !delay_horizon_ps_.has_value() ||
+           delay - NodeDelay(to_index) <= *delay_horizon_ps_;
+  }
+
+  // Returns the target indices of the stored paths from `from_index` sorted by
+  // index.
+  std::vector<int64_t> SortedTargetsFrom(int64_t from_index) const;
+
+  // Computes the critical path delay between a pair of nodes which is not
+  // stored by a longest-path traversal of the nodes between them, using stored
+  // delays from `from_index` where available. Returns -1 if there is no path.
+  // If `path` is non-null, it is set to the nodes of the critical path.
+  int64_t ComputeCriticalPath(int64_t from_index, int64_t to_index,
+                              std::vector<Node *> *path) const;
+
   FunctionBase *function_;
 
   // A mapping from a node to its index in the function.
@@ -141,14 +196,24 @@ class DelayManager {
   // A mapping from a node index to the corresponding node.
   std::vector<Node *> index_to_node_;
 
-  // An all-to-all delay mapping. The self-to-self delay of a node is defined as
-  // the delay of itself. If there is no valid path exists, the delay is defined
-  // as -1. Both the source and target node delays are counted.
-  std::vector<std::vector<int64_t>> indices_to_delay_;
+  // A mapping from a node index to its position in a topological order.
+  std::vector<int64_t> index_to_topo_position_;
+
+  std::optional<int64_t> delay_horizon_ps_;
+
+  // For each target node index, the critical paths to it keyed by source node
+  // index. The self-to-self delay of a node is defined as the delay of itself.
+  // Pairs without a path (or beyond the horizon) are absent. Both the source
+  // and target node delays are counted.
+  std::vector<absl::flat_hash_map<int64_t, PathDelay>> paths_to_;
+
+  // For each source node index, the target node indices of its stored paths.
+  std::vector<std::vector<int64_t>> targets_from_;
 
-  // A all-to-all mapping from the source and target node indices to the
-  // critical operand of the target node.
-  std::vector<std::vector<Node *>> indices_to_critical_operand_;
+  // Delays of pairs beyond the horizon computed by GetCriticalPathDelay.
+  // Cleared whenever the stored delays change.
+  mutable absl::flat_hash_map<std::pair<int64_t, int64_t>, int64_t>
+      on_demand_delays_;
 
   // Name of the delay estimator.
   const std::string name_;
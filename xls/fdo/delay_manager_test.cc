@@ -176,5 +176,54 @@ fn main(i0: bits[3], i1: bits[3]) -> bits[3] {
   EXPECT_EQ(new_udiv3_i0_delay, -1);
 }
 
+TEST_F(DelayManagerTest, DelayHorizon) {
+  std::string ir_text = R"(
+package p
+
+fn main(i0: bits[3], i1: bits[3]) -> bits[3] {
+  add.1: bits[3] = add(i0, i1)
+  sub.2: bits[3] = sub(add.1, i1)
+  ret udiv.3: bits[3] = udiv(sub.2, add.1)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, package->GetFunction("main"));
+  Node *i0 = FindNode("i0", function);
+  Node *add1 = FindNode("add.1", function);
+  Node *sub2 = FindNode("sub.2", function);
+  Node *udiv3 = FindNode("udiv.3", function);
+
+  // Only paths whose delay excluding the target is at most 1ps are stored.
+  DelayManager dm(function, TestDelayEstimator(), /*delay_horizon_ps=*/1);
+
+  absl::flat_hash_map<Node *, std::vector<Node *>> threshold_result =
+      dm.GetPathsOverDelayThreshold(1);
+  EXPECT_TRUE(threshold_result.at(i0) == std::vector<Node *>({sub2}));
+  EXPECT_TRUE(threshold_result.at(add1) == std::vector<Node *>({sub2}));
+  EXPECT_TRUE(threshold_result.at(sub2) == std::vector<Node *>({udiv3}));
+
+  // Pairs beyond the horizon are computed on demand.
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t sub2_udiv3_delay,
+                           dm.GetCriticalPathDelay(sub2, udiv3));
+  EXPECT_EQ(sub2_udiv3_delay, 3);
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t i0_udiv3_delay,
+                           dm.GetCriticalPathDelay(i0, udiv3));
+  EXPECT_EQ(i0_udiv3_delay, 4);
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t udiv3_i0_delay,
+                           dm.GetCriticalPathDelay(udiv3, i0));
+  EXPECT_EQ(udiv3_i0_delay, -1);
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Node *> path,
+                           dm.GetFullCriticalPath(i0, udiv3));
+  EXPECT_TRUE(path == std::vector<Node *>({i0, add1, sub2, udiv3}));
+
+  // Refined delays within the horizon are used by on-demand queries.
+  XLS_EXPECT_OK(dm.SetCriticalPathDelay(add1, sub2, 1));
+  dm.PropagateDelays();
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t new_i0_udiv3_delay,
+                           dm.GetCriticalPathDelay(i0, udiv3));
+  EXPECT_EQ(new_i0_udiv3_delay, 3);
+}
+
 }  // namespace
 }  // namespace xls
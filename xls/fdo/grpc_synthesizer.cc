@@ -14,12 +14,20 @@
 
 #include "xls/fdo/grpc_synthesizer.h"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <string_view>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/log/check.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/casts.h"
 #include "xls/common/module_initializer.h"
 #include "xls/common/status/status_macros.h"
@@ -32,11 +40,20 @@ namespace synthesis {
 namespace {
 
 // A Synthesizer implementation that invokes a `SynthesizerService` via a gRPC
-// client.
+// client. Requests are spread round-robin over the configured endpoints so
+// that concurrent synthesis jobs can be served by several servers. Concurrent
+// requests to an endpoint are multiplexed over one CompileBatch stream, falling
+// back to unary Compile calls for servers which do not implement it.
 class GrpcSynthesizer : public Synthesizer {
  public:
   explicit GrpcSynthesizer(const GrpcSynthesizerParameters& params)
-      : Synthesizer("grpc"), params_(params) {}
+      : Synthesizer("grpc"),
+        params_(params),
+        endpoints_(absl::StrSplit(params.server_and_port(), ',',
+                                  absl::SkipWhitespace())),
+        clients_(endpoints_.size()) {
+    CHECK(!endpoints_.empty()) << "No gRPC synthesis server specified";
+  }
 
   absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
       std::string_view verilog_text,
@@ -46,16 +63,47 @@ class GrpcSynthesizer : public Synthesizer {
     request.set_target_frequency_hz(params_.frequency_hz());
     request.set_module_text(verilog_text);
 
-    XLS_ASSIGN_OR_RETURN(CompileResponse response,
-                         xls::synthesis::SynthesizeViaClient(
-                             params_.server_and_port(), request));
+    const int64_t endpoint =
+        next_endpoint_.fetch_add(1, std::memory_order_relaxed) %
+        endpoints_.size();
+    XLS_ASSIGN_OR_RETURN(CompileResponse response, Compile(endpoint, request));
     const int64_t clock_period_ps =
         static_cast<int64_t>(1e12) / params_.frequency_hz();
     return response.slack_ps() == 0 ? 0 : clock_period_ps - response.slack_ps();
   }
 
+  // The endpoints are assumed to run equivalent synthesis flows, so only the
+  // target frequency distinguishes cached delays.
+  std::string ParameterFingerprint() const override {
+    return absl::StrCat(name(), "\n", params_.frequency_hz());
+  }
+
  private:
+  // Sends `request` to the given endpoint.
+  absl::StatusOr<CompileResponse> Compile(
+      int64_t endpoint, const CompileRequest& request) const {
+    CompileBatchClient* client;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (clients_[endpoint] == nullptr) {
+        XLS_ASSIGN_OR_RETURN(clients_[endpoint],
+                             CompileBatchClient::Create(endpoints_[endpoint]));
+      }
+      client = clients_[endpoint].get();
+    }
+    absl::StatusOr<CompileResponse> response = client->Compile(request);
+    if (absl::IsUnimplemented(response.status())) {
+      return SynthesizeViaClient(endpoints_[endpoint], request);
+    }
+    return response;
+  }
+
   const GrpcSynthesizerParameters params_;
+  const std::vector<std::string> endpoints_;
+  mutable std::atomic<int64_t> next_endpoint_ = 0;
+  mutable absl::Mutex mutex_;
+  mutable std::vector<std::unique_ptr<CompileBatchClient>> clients_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace
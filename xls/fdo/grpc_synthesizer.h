@@ -30,7 +30,9 @@ inline constexpr int64_t kDefaultFrequencyHz = 1e9;
 
 // Factory parameters for the gRPC-client Synthesizer. The parameters are:
 // `server_and_port`: The gRPC endpoint that the `Synthesizer` object should
-//      send requests to. e.g.: "ipv4:///0.0.0.0:10000"
+//      send requests to. e.g.: "ipv4:///0.0.0.0:10000". Several endpoints may
+//      be given separated by commas, in which case requests are distributed
+//      across them round-robin.
 // `frequency_hz`: The target frequency any designs that will be synthesized.
 class GrpcSynthesizerParameters : public SynthesizerParameters {
  public:
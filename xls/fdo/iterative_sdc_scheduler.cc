@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <optional>
 #include <random>
 #include <string>
@@ -242,7 +243,8 @@ absl::Status RefineDelayEstimations(
 
   XLS_ASSIGN_OR_RETURN(
       std::vector<int64_t> delay_list,
-      options.synthesizer->SynthesizeNodesConcurrentlyAndGetDelays(nodes_list));
+      options.synthesizer->SynthesizeNodesConcurrentlyAndGetDelays(
+          nodes_list, options.max_concurrent_synthesis_jobs));
 
   VLOG(1) << "Number of modules generated is " << nodes_list.size();
   for (int64_t j = 0; j < delay_list.size(); ++j) {
@@ -268,6 +270,7 @@ absl::Status RefineDelayEstimations(
 }
 
 absl::Status BuildError(IterativeSDCSchedulingModel &model,
+                        math_opt::IncrementalSolver &solver,
                         const math_opt::SolveResult &result,
                         SchedulingFailureBehavior failure_behavior) {
   CHECK_NE(result.termination.reason, math_opt::TerminationReason::kOptimal);
@@ -278,9 +281,8 @@ absl::Status BuildError(IterativeSDCSchedulingModel &model,
            math_opt::TerminationReason::kInfeasibleOrUnbounded)) {
     XLS_RETURN_IF_ERROR(model.AddSlackVariables(
         failure_behavior.infeasible_per_state_backedge_slack_pool));
-    XLS_ASSIGN_OR_RETURN(
-        math_opt::SolveResult result_with_slack,
-        math_opt::Solve(model.UnderlyingModel(), math_opt::SolverType::kGlop));
+    XLS_ASSIGN_OR_RETURN(math_opt::SolveResult result_with_slack,
+                         solver.Solve());
     if (result_with_slack.termination.reason ==
             math_opt::TerminationReason::kOptimal ||
         result_with_slack.termination.reason ==
@@ -304,21 +306,8 @@ absl::Status BuildError(IterativeSDCSchedulingModel &model,
 
 absl::Status IterativeSDCSchedulingModel::AddTimingConstraints(
     int64_t clock_period_ps) {
-  absl::flat_hash_map<Node *, std::vector<Node *>> delay_constraints =
-      delay_manager_.GetPathsOverDelayThreshold(clock_period_ps);
-
-  int64_t number_constraints = 0;
-  for (const auto &p : delay_constraints) {
-    Node *source = p.first;
-    for (Node *target : p.second) {
-      number_constraints++;
-      DiffAtLeastConstraint(target, source, 1, "timing");
-      VLOG(2) << "Setting timing constraint: "
-              << absl::StrFormat("1 ≤ %s - %s", target->GetName(),
-                                 source->GetName());
-    }
-  }
-  VLOG(2) << "Number of timing constraints added: " << number_constraints;
+  UpdateTimingConstraints(
+      delay_manager_.GetPathsOverDelayThreshold(clock_period_ps));
   return absl::OkStatus();
 }
 
@@ -402,36 +391,45 @@ absl::StatusOr<ScheduleCycleMap> ScheduleByIterativeSDC(
   ScheduleCycleMap cycle_map;
   absl::flat_hash_set<NodeCut> evaluated_cuts;
   std::mt19937_64 bit_gen;
-  for (int64_t i = 0; i < options.iteration_number; ++i) {
-    IterativeSDCSchedulingModel model(f, delay_manager);
+  // The model and solver are built once and updated in place on every
+  // iteration: only the timing constraints depend on the refined delay
+  // estimations, so the solver warm-starts each solve from the previous basis
+  // instead of solving a fresh LP.
+  IterativeSDCSchedulingModel model(f, delay_manager);
+
+  for (const SchedulingConstraint &constraint : constraints) {
+    XLS_RETURN_IF_ERROR(model.AddSchedulingConstraint(constraint));
+  }
 
-    for (const SchedulingConstraint &constraint : constraints) {
-      XLS_RETURN_IF_ERROR(model.AddSchedulingConstraint(constraint));
+  for (Node *node : f->nodes()) {
+    for (Node *user : node->users()) {
+      XLS_RETURN_IF_ERROR(model.AddDefUseConstraints(node, user));
     }
-
-    for (Node *node : f->nodes()) {
-      for (Node *user : node->users()) {
-        XLS_RETURN_IF_ERROR(model.AddDefUseConstraints(node, user));
-      }
-      if (f->IsFunction() && f->HasImplicitUse(node)) {
-        XLS_RETURN_IF_ERROR(model.AddDefUseConstraints(node, std::nullopt));
-      }
+    if (f->IsFunction() && f->HasImplicitUse(node)) {
+      XLS_RETURN_IF_ERROR(model.AddDefUseConstraints(node, std::nullopt));
     }
+  }
 
-    if (f->IsProc()) {
-      Proc *proc = f->AsProcOrDie();
-      for (int64_t index = 0; index < proc->GetStateElementCount(); ++index) {
-        Param *const state_access = proc->GetStateParam(index);
-        Node *const next_state_element = proc->GetNextStateElement(index);
-
-        // The next-state element always has lifetime extended to the state
-        // param node, since we can't store the new value in the state register
-        // until the old value's been used.
-        XLS_RETURN_IF_ERROR(
-            model.AddLifetimeConstraint(next_state_element, state_access));
-      }
+  if (f->IsProc()) {
+    Proc *proc = f->AsProcOrDie();
+    for (int64_t index = 0; index < proc->GetStateElementCount(); ++index) {
+      Param *const state_access = proc->GetStateParam(index);
+      Node *const next_state_element = proc->GetNextStateElement(index);
+
+      // The next-state element always has lifetime extended to the state
+      // param node, since we can't store the new value in the state register
+      // until the old value's been used.
+      XLS_RETURN_IF_ERROR(
+          model.AddLifetimeConstraint(next_state_element, state_access));
     }
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<math_opt::IncrementalSolver> solver,
+                       math_opt::IncrementalSolver::New(
+                           &model.UnderlyingModel(),
+                           math_opt::SolverType::kGlop));
 
+  for (int64_t i = 0; i < options.iteration_number; ++i) {
     XLS_RETURN_IF_ERROR(model.AddTimingConstraints(clock_period_ps));
 
     int64_t min_pipeline_length = 1;
@@ -443,11 +441,11 @@ absl::StatusOr<ScheduleCycleMap> ScheduleByIterativeSDC(
       model.MinimizePipelineLength();
       XLS_ASSIGN_OR_RETURN(
           const math_opt::SolveResult result_with_minimized_pipeline_length,
-          math_opt::Solve(model.UnderlyingModel(),
-                          math_opt::SolverType::kGlop));
+          solver->Solve());
       if (result_with_minimized_pipeline_length.termination.reason !=
           math_opt::TerminationReason::kOptimal) {
-        return BuildError(model, result_with_minimized_pipeline_length,
+        return BuildError(model, *solver,
+                          result_with_minimized_pipeline_length,
                           failure_behavior);
       }
       XLS_ASSIGN_OR_RETURN(
@@ -459,12 +457,10 @@ absl::StatusOr<ScheduleCycleMap> ScheduleByIterativeSDC(
 
     model.SetObjective();
 
-    XLS_ASSIGN_OR_RETURN(
-        math_opt::SolveResult result,
-        math_opt::Solve(model.UnderlyingModel(), math_opt::SolverType::kGlop));
+    XLS_ASSIGN_OR_RETURN(math_opt::SolveResult result, solver->Solve());
 
     if (result.termination.reason != math_opt::TerminationReason::kOptimal) {
-      return BuildError(model, result, failure_behavior);
+      return BuildError(model, *solver, result, failure_behavior);
     }
 
     // Extract scheduling results to the cycle map.
@@ -42,7 +42,9 @@ class IterativeSDCSchedulingModel : public SDCSchedulingModel {
 
   // Overrides the original timing constraints builder. This method directly
   // call delay manager to extract the paths longer than the given clock period
-  // instead of recalculating them.
+  // instead of recalculating them. May be called again after the delay manager
+  // has been refined; only the constraints which changed are added to or
+  // removed from the model.
   absl::Status AddTimingConstraints(int64_t clock_period_ps);
 
  private:
@@ -56,6 +58,8 @@ struct IterativeSDCSchedulingOptions {
   int64_t fanout_driven_path_number = 0;
   float stochastic_ratio = 1.0;
   PathEvaluateStrategy path_evaluate_strategy = PathEvaluateStrategy::WINDOW;
+  // Bounds the number of concurrent synthesis jobs; unbounded if unset.
+  std::optional<int64_t> max_concurrent_synthesis_jobs;
 };
 
 // Runs iterative SDC scheduling. Compared to the original SDC, the iterative
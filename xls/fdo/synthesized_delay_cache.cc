@@ -0,0 +1,90 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/fdo/synthesized_delay_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+namespace synthesis {
+
+/* static */ absl::StatusOr<std::unique_ptr<SynthesizedDelayCache>>
+SynthesizedDelayCache::Create(const std::filesystem::path& directory) {
+  XLS_ASSIGN_OR_RETURN(ContentAddressedCache cache,
+                       ContentAddressedCache::Create(
+                           directory, ".delay", "synthesized delay cache"));
+  return absl::WrapUnique(new SynthesizedDelayCache(std::move(cache)));
+}
+
+/* static */ std::string SynthesizedDelayCache::ComputeKey(
+    std::string_view verilog_text, std::string_view top_module_name,
+    std::string_view synthesizer_fingerprint) {
+  return ContentAddressedCache::ComputeKey(
+      {synthesizer_fingerprint, top_module_name, verilog_text});
+}
+
+absl::StatusOr<std::optional<int64_t>> SynthesizedDelayCache::Lookup(
+    std::string_view key) {
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      return it->second;
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> contents,
+                       cache_.Lookup(key));
+  if (!contents.has_value()) {
+    return std::nullopt;
+  }
+  int64_t delay_ps;
+  if (!absl::SimpleAtoi(absl::StripAsciiWhitespace(*contents), &delay_ps)) {
+    return absl::DataLossError(
+        absl::StrFormat("Malformed synthesized delay cache entry %s",
+                        cache_.GetPath(key).string()));
+  }
+  absl::MutexLock lock(&mutex_);
+  entries_.emplace(std::string(key), delay_ps);
+  return delay_ps;
+}
+
+absl::Status SynthesizedDelayCache::Insert(std::string_view key,
+                                           int64_t delay_ps) {
+  {
+    absl::MutexLock lock(&mutex_);
+    entries_.insert_or_assign(std::string(key), delay_ps);
+  }
+  return cache_.Insert(key, absl::StrCat(delay_ps, "\n"));
+}
+
+}  // namespace synthesis
+}  // namespace xls
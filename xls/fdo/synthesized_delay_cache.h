@@ -0,0 +1,79 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_FDO_SYNTHESIZED_DELAY_CACHE_H_
+#define XLS_FDO_SYNTHESIZED_DELAY_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/content_addressed_cache.h"
+
+namespace xls {
+namespace synthesis {
+
+// A persistent cache of delays reported by a `Synthesizer`, stored in a
+// directory on disk (see ContentAddressedCache). Each entry is keyed on a hash
+// of the Verilog which was synthesized, its top module name, and a fingerprint
+// of the synthesizer settings (see `Synthesizer::ParameterFingerprint`). The
+// Verilog for a subgraph is generated from canonically renamed nodes, so
+// structurally identical subgraphs map to the same key both within a run and
+// across runs.
+//
+// Entries are also kept in memory so repeated lookups within a process do not
+// touch the file system. This class is thread-safe.
+class SynthesizedDelayCache {
+ public:
+  // Creates a cache backed by `directory`, creating the directory if it does
+  // not exist.
+  static absl::StatusOr<std::unique_ptr<SynthesizedDelayCache>> Create(
+      const std::filesystem::path& directory);
+
+  // Returns the cache key for the given synthesis job.
+  static std::string ComputeKey(std::string_view verilog_text,
+                                std::string_view top_module_name,
+                                std::string_view synthesizer_fingerprint);
+
+  // Returns the cached delay for `key` or std::nullopt if there is none.
+  absl::StatusOr<std::optional<int64_t>> Lookup(std::string_view key);
+
+  // Stores `delay_ps` under `key`, replacing any existing entry.
+  absl::Status Insert(std::string_view key, int64_t delay_ps);
+
+  const std::filesystem::path& directory() const { return cache_.directory(); }
+
+ private:
+  explicit SynthesizedDelayCache(ContentAddressedCache cache)
+      : cache_(std::move(cache)) {}
+
+  ContentAddressedCache cache_;
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, int64_t> entries_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace synthesis
+}  // namespace xls
+
+#endif  // XLS_FDO_SYNTHESIZED_DELAY_CACHE_H_
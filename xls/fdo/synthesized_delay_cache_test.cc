@@ -0,0 +1,72 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/fdo/synthesized_delay_cache.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using testing::Optional;
+
+TEST(SynthesizedDelayCacheTest, KeyDependsOnAllInputs) {
+  std::string key = SynthesizedDelayCache::ComputeKey("v", "top", "yosys");
+  EXPECT_EQ(key, SynthesizedDelayCache::ComputeKey("v", "top", "yosys"));
+  EXPECT_NE(key, SynthesizedDelayCache::ComputeKey("v2", "top", "yosys"));
+  EXPECT_NE(key, SynthesizedDelayCache::ComputeKey("v", "top2", "yosys"));
+  EXPECT_NE(key, SynthesizedDelayCache::ComputeKey("v", "top", "grpc"));
+}
+
+TEST(SynthesizedDelayCacheTest, InsertAndLookup) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SynthesizedDelayCache> cache,
+                           SynthesizedDelayCache::Create(temp_dir.path()));
+  std::string key = SynthesizedDelayCache::ComputeKey("v", "top", "yosys");
+  EXPECT_THAT(cache->Lookup(key), IsOkAndHolds(std::nullopt));
+  XLS_ASSERT_OK(cache->Insert(key, 1234));
+  EXPECT_THAT(cache->Lookup(key), IsOkAndHolds(Optional(1234)));
+
+  // A second cache over the same directory, e.g. in another process, sees the
+  // entry.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SynthesizedDelayCache> other,
+                           SynthesizedDelayCache::Create(temp_dir.path()));
+  EXPECT_THAT(other->Lookup(key), IsOkAndHolds(Optional(1234)));
+}
+
+TEST(SynthesizedDelayCacheTest, MalformedEntry) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SynthesizedDelayCache> cache,
+                           SynthesizedDelayCache::Create(temp_dir.path()));
+  std::string key = SynthesizedDelayCache::ComputeKey("v", "top", "yosys");
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / (key + ".delay"), "junk"));
+  EXPECT_THAT(cache->Lookup(key), StatusIs(absl::StatusCode::kDataLoss));
+}
+
+}  // namespace
+}  // namespace synthesis
+}  // namespace xls
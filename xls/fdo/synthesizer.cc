@@ -14,6 +14,8 @@
 
 #include "xls/fdo/synthesizer.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -23,9 +25,12 @@
 #include <vector>
 
 #include "absl/base/no_destructor.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
@@ -38,9 +43,11 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/common/thread.h"
 #include "xls/fdo/extract_nodes.h"
+#include "xls/fdo/synthesized_delay_cache.h"
 #include "xls/ir/block.h"
 #include "xls/ir/function.h"
 #include "xls/ir/node.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/scheduling_options.h"
 
@@ -49,19 +56,45 @@ namespace synthesis {
 
 absl::StatusOr<std::vector<int64_t>>
 Synthesizer::SynthesizeNodesConcurrentlyAndGetDelays(
-    absl::Span<const absl::flat_hash_set<Node *>> nodes_list) const {
-  // Launches multi-threading delay estimation.
-  std::vector<absl::StatusOr<int64_t>> results;
-  std::vector<std::unique_ptr<Thread>> threads;
-  results.reserve(nodes_list.size());
-  absl::StatusOr<int64_t> init_val = 0;
+    absl::Span<const absl::flat_hash_set<Node *>> nodes_list,
+    std::optional<int64_t> max_in_flight) const {
+  XLS_RET_CHECK(!max_in_flight.has_value() || *max_in_flight > 0)
+      << "max_in_flight must be positive";
+
+  // Deduplicates the node sets so that each distinct subgraph is synthesized
+  // only once. `job_of_entry[i]` is the job whose result is reported for
+  // `nodes_list[i]`.
+  absl::flat_hash_map<std::vector<Node *>, int64_t> job_of_key;
+  std::vector<const absl::flat_hash_set<Node *> *> jobs;
+  std::vector<int64_t> job_of_entry;
+  job_of_entry.reserve(nodes_list.size());
   for (const absl::flat_hash_set<Node *> &nodes : nodes_list) {
-    results.push_back(init_val);
-    absl::StatusOr<int64_t> &dest = results.back();
-    // TODO(hanchenye): 2023-08-14 Use a thread pool structure that we can
-    // schedule on.
-    threads.push_back(std::make_unique<Thread>(
-        [&]() { dest = SynthesizeNodesAndGetDelay(nodes); }));
+    std::vector<Node *> key(nodes.begin(), nodes.end());
+    std::sort(key.begin(), key.end());
+    auto [it, inserted] = job_of_key.try_emplace(std::move(key), jobs.size());
+    if (inserted) {
+      jobs.push_back(&nodes);
+    }
+    job_of_entry.push_back(it->second);
+  }
+  VLOG(2) << absl::StreamFormat("Synthesizing %d distinct of %d node sets",
+                                jobs.size(), nodes_list.size());
+
+  // Launches multi-threading delay estimation. Each worker repeatedly claims
+  // the next unstarted job, so no more than `worker_count` jobs are in flight.
+  std::vector<absl::StatusOr<int64_t>> results(jobs.size(), 0);
+  std::atomic<int64_t> next_job = 0;
+  auto worker = [&]() {
+    for (int64_t job = next_job++; job < jobs.size(); job = next_job++) {
+      results[job] = SynthesizeNodesAndGetDelay(*jobs[job]);
+    }
+  };
+  const int64_t worker_count =
+      std::min<int64_t>(max_in_flight.value_or(jobs.size()), jobs.size());
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(worker_count);
+  for (int64_t i = 0; i < worker_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
   }
 
   // Records the estimated delays.
@@ -69,26 +102,53 @@ Synthesizer::SynthesizeNodesConcurrentlyAndGetDelays(
     t->Join();
   }
   std::vector<int64_t> delay_list;
-  delay_list.reserve(results.size());
-  for (absl::StatusOr<int64_t> result : results) {
-    XLS_RETURN_IF_ERROR(result.status());
-    delay_list.push_back(result.value());
+  delay_list.reserve(nodes_list.size());
+  for (int64_t job : job_of_entry) {
+    XLS_RETURN_IF_ERROR(results[job].status());
+    delay_list.push_back(results[job].value());
   }
   return delay_list;
 }
 
+absl::StatusOr<int64_t> Synthesizer::SynthesizeVerilogAndGetDelayCached(
+    std::string_view verilog_text, std::string_view top_module_name) const {
+  if (delay_cache_ == nullptr) {
+    return SynthesizeVerilogAndGetDelay(verilog_text, top_module_name);
+  }
+  std::string key = SynthesizedDelayCache::ComputeKey(
+      verilog_text, top_module_name, ParameterFingerprint());
+  XLS_ASSIGN_OR_RETURN(std::optional<int64_t> cached_delay,
+                       delay_cache_->Lookup(key));
+  if (cached_delay.has_value()) {
+    VLOG(3) << "Synthesized delay cache hit for " << key;
+    return *cached_delay;
+  }
+  XLS_ASSIGN_OR_RETURN(
+      int64_t delay, SynthesizeVerilogAndGetDelay(verilog_text, top_module_name));
+  XLS_RETURN_IF_ERROR(delay_cache_->Insert(key, delay));
+  return delay;
+}
+
 absl::StatusOr<int64_t> Synthesizer::SynthesizeNodesAndGetDelay(
     const absl::flat_hash_set<Node *> &nodes) const {
   std::string top_name = "tmp_module";
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> tmp_package,
                        ExtractNodes(nodes, top_name));
   XLS_ASSIGN_OR_RETURN(Function * f, tmp_package->GetFunction(top_name));
+  if (delay_cache_ != nullptr) {
+    // Names the nodes after their topological position so that structurally
+    // identical subgraphs generate identical Verilog and share a cache entry.
+    int64_t index = 0;
+    for (Node *node : TopoSort(f)) {
+      node->SetNameDirectly(absl::StrCat("n", index++));
+    }
+  }
   XLS_ASSIGN_OR_RETURN(std::string verilog_text,
                        FunctionBaseToVerilog(f, /*flop_inputs_outputs=*/true));
   if (verilog_text.empty()) {
     return 0;
   }
-  return SynthesizeVerilogAndGetDelay(verilog_text, top_name);
+  return SynthesizeVerilogAndGetDelayCached(verilog_text, top_name);
 }
 
 absl::StatusOr<int64_t> Synthesizer::SynthesizeFunctionBaseAndGetDelay(
@@ -98,7 +158,7 @@ absl::StatusOr<int64_t> Synthesizer::SynthesizeFunctionBaseAndGetDelay(
   if (verilog_text.empty()) {
     return 0;
   }
-  return SynthesizeVerilogAndGetDelay(verilog_text, f->name());
+  return SynthesizeVerilogAndGetDelayCached(verilog_text, f->name());
 }
 
 absl::StatusOr<std::string> Synthesizer::FunctionBaseToVerilog(
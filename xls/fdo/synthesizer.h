@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -28,6 +29,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "xls/fdo/synthesized_delay_cache.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -70,15 +72,39 @@ class Synthesizer {
   virtual absl::StatusOr<std::string> FunctionBaseToVerilog(
       FunctionBase *f, bool flop_inputs_outputs) const;
 
+  // Returns a string identifying the synthesizer settings which affect the
+  // reported delays, e.g., the tool and cell library paths. Delays are only
+  // shared through a `SynthesizedDelayCache` between synthesizers with equal
+  // fingerprints.
+  virtual std::string ParameterFingerprint() const { return name_; }
+
+  // Sets the cache consulted by `SynthesizeNodesAndGetDelay` and
+  // `SynthesizeFunctionBaseAndGetDelay` before invoking the synthesis tool.
+  // Passing nullptr disables caching.
+  void set_delay_cache(std::unique_ptr<SynthesizedDelayCache> delay_cache) {
+    delay_cache_ = std::move(delay_cache);
+  }
+  SynthesizedDelayCache *delay_cache() const { return delay_cache_.get(); }
+
   // Launches `SynthesizeNodesAndGetDelay` concurrently for each set of nodes
-  // listed in `nodes_list` and get their delays.
+  // listed in `nodes_list` and get their delays, in the order of `nodes_list`.
+  // Identical node sets are synthesized only once. At most `max_in_flight`
+  // synthesis jobs run at any time; if unset, every distinct node set is
+  // synthesized on its own thread.
   absl::StatusOr<std::vector<int64_t>> SynthesizeNodesConcurrentlyAndGetDelays(
-      absl::Span<const absl::flat_hash_set<Node *>> nodes_list) const;
+      absl::Span<const absl::flat_hash_set<Node *>> nodes_list,
+      std::optional<int64_t> max_in_flight = std::nullopt) const;
 
  private:
+  // Calls `SynthesizeVerilogAndGetDelay` unless the delay of the given Verilog
+  // is already in the delay cache.
+  absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelayCached(
+      std::string_view verilog_text, std::string_view top_module_name) const;
+
   // Records the name of the concreate synthesizer, e.g., yosys, for management
   // and debugging purpose.
   std::string name_;
+  std::unique_ptr<SynthesizedDelayCache> delay_cache_;
 };
 
 // An abstract class of a synthesis service.
@@ -14,13 +14,21 @@
 
 #include "xls/fdo/synthesizer.h"
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/status/matchers.h"
+#include "xls/fdo/synthesized_delay_cache.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/ir_test_base.h"
@@ -29,6 +37,9 @@
 namespace xls {
 namespace {
 
+using ::testing::ElementsAre;
+using status_testing::IsOkAndHolds;
+
 class FakeSynthesizer : public synthesis::Synthesizer {
  public:
   FakeSynthesizer() : synthesis::Synthesizer("FakeSynthesizer") {}
@@ -40,6 +51,47 @@ class FakeSynthesizer : public synthesis::Synthesizer {
   }
 };
 
+// Reports the number of nodes as the delay and counts the synthesis jobs.
+class CountingSynthesizer : public synthesis::Synthesizer {
+ public:
+  CountingSynthesizer() : synthesis::Synthesizer("CountingSynthesizer") {}
+
+  absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
+      std::string_view verilog_text,
+      std::string_view top_module_name) const override {
+    return 0;
+  }
+
+  absl::StatusOr<int64_t> SynthesizeNodesAndGetDelay(
+      const absl::flat_hash_set<Node *> &nodes) const override {
+    ++job_count_;
+    return nodes.size();
+  }
+
+  int64_t job_count() const { return job_count_; }
+
+ private:
+  mutable std::atomic<int64_t> job_count_ = 0;
+};
+
+// Counts the Verilog modules handed to the synthesis tool.
+class VerilogCountingSynthesizer : public synthesis::Synthesizer {
+ public:
+  VerilogCountingSynthesizer()
+      : synthesis::Synthesizer("VerilogCountingSynthesizer") {}
+
+  absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
+      std::string_view verilog_text,
+      std::string_view top_module_name) const override {
+    return ++synthesis_count_ * 100;
+  }
+
+  int64_t synthesis_count() const { return synthesis_count_; }
+
+ private:
+  mutable std::atomic<int64_t> synthesis_count_ = 0;
+};
+
 class SynthesizerTest : public IrTestBase {
  public:
   FakeSynthesizer synthesizer_;
@@ -161,5 +213,72 @@ endmodule
   EXPECT_EQ(actual_verilog_text, expected_verilog_text);
 }
 
+TEST_F(SynthesizerTest, SynthesizeNodesConcurrentlyDeduplicates) {
+  const std::string ir_text = R"(
+package p
+
+fn test(i0: bits[3], i1: bits[3]) -> bits[3] {
+  add.3: bits[3] = add(i0, i1, id=3)
+  ret sub.4: bits[3] = sub(add.3, i1, id=4)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, package->GetFunction("test"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * add, function->GetNode("add.3"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * sub, function->GetNode("sub.4"));
+
+  std::vector<absl::flat_hash_set<Node *>> nodes_list = {
+      {add, sub}, {add}, {sub, add}, {add}, {sub}};
+  for (int64_t max_in_flight : {1, 2, 8}) {
+    CountingSynthesizer synthesizer;
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::vector<int64_t> delays,
+        synthesizer.SynthesizeNodesConcurrentlyAndGetDelays(nodes_list,
+                                                            max_in_flight));
+    EXPECT_THAT(delays, ElementsAre(2, 1, 2, 1, 1));
+    EXPECT_EQ(synthesizer.job_count(), 3);
+  }
+}
+
+TEST_F(SynthesizerTest, DelayCacheSharesStructurallyIdenticalSubgraphs) {
+  const std::string ir_text = R"(
+package p
+
+fn test(i0: bits[3], i1: bits[3], i2: bits[3]) -> (bits[3], bits[3]) {
+  add.4: bits[3] = add(i0, i1, id=4)
+  add.5: bits[3] = add(i1, i2, id=5)
+  ret tuple.6: (bits[3], bits[3]) = tuple(add.4, add.5, id=6)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, package->GetFunction("test"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * add4, function->GetNode("add.4"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * add5, function->GetNode("add.5"));
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+
+  VerilogCountingSynthesizer synthesizer;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<synthesis::SynthesizedDelayCache> cache,
+      synthesis::SynthesizedDelayCache::Create(temp_dir.path()));
+  synthesizer.set_delay_cache(std::move(cache));
+  EXPECT_THAT(synthesizer.SynthesizeNodesAndGetDelay({add4}),
+              IsOkAndHolds(100));
+  EXPECT_THAT(synthesizer.SynthesizeNodesAndGetDelay({add5}),
+              IsOkAndHolds(100));
+  EXPECT_EQ(synthesizer.synthesis_count(), 1);
+
+  // A later run with a fresh synthesizer reuses the delay from disk.
+  VerilogCountingSynthesizer second_run;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<synthesis::SynthesizedDelayCache> second_cache,
+      synthesis::SynthesizedDelayCache::Create(temp_dir.path()));
+  second_run.set_delay_cache(std::move(second_cache));
+  EXPECT_THAT(second_run.SynthesizeNodesAndGetDelay({add5}),
+              IsOkAndHolds(100));
+  EXPECT_EQ(second_run.synthesis_count(), 0);
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,6 +14,7 @@
 
 #include "xls/fdo/yosys_synthesizer.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -25,6 +26,7 @@
 #include "xls/common/casts.h"
 #include "xls/common/module_initializer.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/fdo/synthesizer.h"
 #include "xls/scheduling/scheduling_options.h"
 
@@ -53,7 +55,8 @@ YosysSynthesizerFactory::CreateSynthesizer(
       yosys_synthesizer_parameters.sta_path(),
       yosys_synthesizer_parameters.synthesis_libraries(),
       yosys_synthesizer_parameters.default_driver_cell(),
-      yosys_synthesizer_parameters.default_load());
+      yosys_synthesizer_parameters.default_load(),
+      yosys_synthesizer_parameters.persistent_workers());
 }
 
 absl::StatusOr<std::unique_ptr<Synthesizer>>
@@ -65,11 +68,18 @@ YosysSynthesizerFactory::CreateSynthesizer(
     return absl::InternalError(
         "yosys_path, sta_path, and synthesis_libraries must not be empty");
   }
+  // Keep as many tool processes as there are synthesis jobs in flight.
+  int64_t persistent_workers = 0;
+  if (scheduling_options.fdo_persistent_synthesis_tools()) {
+    persistent_workers =
+        scheduling_options.fdo_max_concurrent_synthesis_jobs().value_or(
+            std::max(AvailableCPUs(), 1));
+  }
   YosysSynthesizerParameters yosys_synthesizer_parameters(
       scheduling_options.fdo_yosys_path(), scheduling_options.fdo_sta_path(),
       scheduling_options.fdo_synthesis_libraries(),
       scheduling_options.fdo_default_driver_cell(),
-      scheduling_options.fdo_default_load());
+      scheduling_options.fdo_default_load(), persistent_workers);
   return CreateSynthesizer(yosys_synthesizer_parameters);
 }
 
@@ -22,6 +22,8 @@
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "xls/fdo/synthesizer.h"
 #include "xls/ir/node.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -31,7 +33,9 @@ namespace xls {
 namespace synthesis {
 
 // A derived Synthesizer class for Yosys-OpenSTA-based synthesis and static
-// timing analysis.
+// timing analysis. If `persistent_workers` is positive, up to that many Yosys
+// and OpenSTA processes are kept running (with the libraries loaded) and
+// shared by the synthesis jobs rather than starting the tools for each job.
 class YosysSynthesizer : public Synthesizer {
   static constexpr int64_t kFrequencyHz = 1e9;
   static constexpr int64_t kClockPeriodPs = 1e12 / kFrequencyHz;
@@ -41,19 +45,30 @@ class YosysSynthesizer : public Synthesizer {
                             std::string_view sta_path,
                             std::string_view synthesis_libraries,
                             std::string_view default_driver_cell,
-                            std::string_view default_load)
+                            std::string_view default_load,
+                            int64_t persistent_workers = 0)
       : Synthesizer("yosys"),
+        fingerprint_(absl::StrJoin({yosys_path, sta_path, synthesis_libraries,
+                                    default_driver_cell, default_load},
+                                   "\n")),
         service_(yosys_path, /*nextpnr_path=*/"", /*synthesis_target=*/"",
                  sta_path, synthesis_libraries, synthesis_libraries,
                  default_driver_cell, default_load,
                  /*save_temps=*/false, /*return_netlist=*/false,
-                 /*synthesis_only=*/false) {}
+                 /*synthesis_only=*/false,
+                 /*max_concurrent_compiles=*/1,
+                 /*persistent_tool_workers=*/persistent_workers) {}
 
   absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
       std::string_view verilog_text,
       std::string_view top_module_name) const override;
 
+  std::string ParameterFingerprint() const override {
+    return absl::StrCat(name(), "\n", kFrequencyHz, "\n", fingerprint_);
+  }
+
  private:
+  std::string fingerprint_;
   YosysSynthesisServiceImpl service_;
 };
 
@@ -64,13 +79,15 @@ class YosysSynthesizerParameters : public SynthesizerParameters {
                                       std::string_view sta_path,
                                       std::string_view synthesis_libraries,
                                       std::string_view default_driver_cell,
-                                      std::string_view default_load)
+                                      std::string_view default_load,
+                                      int64_t persistent_workers = 0)
       : SynthesizerParameters("yosys"),
         yosys_path_(yosys_path),
         sta_path_(sta_path),
         synthesis_libraries_(synthesis_libraries),
         default_driver_cell_(default_driver_cell),
-        default_load_(default_load) {}
+        default_load_(default_load),
+        persistent_workers_(persistent_workers) {}
   ~YosysSynthesizerParameters() override = default;
 
   std::string yosys_path() const { return yosys_path_; }
@@ -78,6 +95,7 @@ class YosysSynthesizerParameters : public SynthesizerParameters {
   std::string synthesis_libraries() const { return synthesis_libraries_; }
   std::string default_driver_cell() const { return default_driver_cell_; }
   std::string default_load() const { return default_load_; }
+  int64_t persistent_workers() const { return persistent_workers_; }
 
  private:
   std::string yosys_path_;
@@ -85,6 +103,7 @@ class YosysSynthesizerParameters : public SynthesizerParameters {
   std::string synthesis_libraries_;
   std::string default_driver_cell_;
   std::string default_load_;
+  int64_t persistent_workers_;
 };
 
 // An abstract class that can construct synthesizers. Meant to be passed to the
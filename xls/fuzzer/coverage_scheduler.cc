@@ -0,0 +1,213 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/coverage_scheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/random/bit_gen_ref.h"
+#include "absl/random/discrete_distribution.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/fuzzer/ast_generator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+// Weight of the most recent sample in the moving average score of an arm.
+constexpr double kScoreDecay = 0.1;
+
+// Minimum weight of an arm relative to the best arm, so that arms which have
+// stopped finding new features are still occasionally sampled.
+constexpr double kMinRelativeWeight = 0.1;
+
+// The smallest maximum bits type width of the arms.
+constexpr int64_t kMinArmBitsWidth = 4;
+
+absl::flat_hash_map<Op, int64_t> CountOps(Package* package) {
+  absl::flat_hash_map<Op, int64_t> counts;
+  for (FunctionBase* fb : package->GetFunctionBases()) {
+    for (Node* node : fb->nodes()) {
+      ++counts[node->op()];
+    }
+  }
+  return counts;
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ParseIrFile(
+    const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+  return Parser::ParsePackage(contents, path.string());
+}
+
+}  // namespace
+
+absl::btree_set<std::string> GetIrCoverageFeatures(Package* unoptimized,
+                                                   Package* optimized) {
+  absl::btree_set<std::string> features;
+  for (FunctionBase* fb : unoptimized->GetFunctionBases()) {
+    for (Node* node : fb->nodes()) {
+      std::string op = OpToString(node->op());
+      int64_t width = node->GetType()->GetFlatBitCount();
+      int64_t width_bucket = 1;
+      while (width_bucket < width) {
+        width_bucket *= 2;
+      }
+      features.insert(absl::StrCat("op:", op));
+      features.insert(absl::StrFormat("op_width:%s:<=%d", op,
+                                      width == 0 ? 0 : width_bucket));
+    }
+  }
+  if (optimized != nullptr) {
+    absl::flat_hash_map<Op, int64_t> optimized_counts = CountOps(optimized);
+    for (const auto& [op, count] : CountOps(unoptimized)) {
+      auto it = optimized_counts.find(op);
+      if (it == optimized_counts.end() || it->second < count) {
+        features.insert(absl::StrCat("opt_removed:", OpToString(op)));
+      }
+    }
+  }
+  return features;
+}
+
+absl::StatusOr<absl::btree_set<std::string>> GetSampleCoverageFeatures(
+    const std::filesystem::path& run_dir) {
+  std::filesystem::path unoptimized_path = run_dir / "sample.ir";
+  if (!FileExists(unoptimized_path).ok()) {
+    return absl::btree_set<std::string>();
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> unoptimized,
+                       ParseIrFile(unoptimized_path));
+  std::unique_ptr<Package> optimized;
+  std::filesystem::path optimized_path = run_dir / "sample.opt.ir";
+  if (FileExists(optimized_path).ok()) {
+    XLS_ASSIGN_OR_RETURN(optimized, ParseIrFile(optimized_path));
+  }
+  return GetIrCoverageFeatures(unoptimized.get(), optimized.get());
+}
+
+CoverageGuidedScheduler::CoverageGuidedScheduler(
+    const dslx::AstGeneratorOptions& base_options) {
+  std::vector<int64_t> bits_widths = {base_options.max_width_bits_types};
+  while (bits_widths.back() / 4 >= kMinArmBitsWidth) {
+    bits_widths.push_back(bits_widths.back() / 4);
+  }
+  std::vector<bool> emit_loops = {base_options.emit_loops};
+  if (base_options.emit_loops) {
+    emit_loops.push_back(false);
+  }
+  for (int64_t bits_width : bits_widths) {
+    for (bool loops : emit_loops) {
+      dslx::AstGeneratorOptions options = base_options;
+      options.max_width_bits_types = bits_width;
+      options.emit_loops = loops;
+      arms_.push_back(
+          Arm{.name = absl::StrFormat("bits<=%d%s", bits_width,
+                                      loops ? ",loops" : ""),
+              .options = options});
+    }
+  }
+  arm_samples_.resize(arms_.size(), 0);
+  arm_scores_.resize(arms_.size(), 0.0);
+}
+
+std::vector<double> CoverageGuidedScheduler::GetArmWeights() const {
+  // Arms which have not been sampled yet are as attractive as the best arm.
+  double max_score = 0.0;
+  for (int64_t i = 0; i < arms_.size(); ++i) {
+    if (arm_samples_[i] > 0) {
+      max_score = std::max(max_score, arm_scores_[i]);
+    }
+  }
+  if (max_score == 0.0) {
+    return std::vector<double>(arms_.size(), 1.0);
+  }
+  std::vector<double> weights(arms_.size());
+  for (int64_t i = 0; i < arms_.size(); ++i) {
+    weights[i] =
+        arm_samples_[i] == 0
+            ? max_score
+            : std::max(arm_scores_[i], kMinRelativeWeight * max_score);
+  }
+  return weights;
+}
+
+int64_t CoverageGuidedScheduler::ChooseArm(absl::BitGenRef bit_gen) const {
+  std::vector<double> weights;
+  {
+    absl::MutexLock lock(&mutex_);
+    weights = GetArmWeights();
+  }
+  absl::discrete_distribution<int64_t> distribution(weights.begin(),
+                                                    weights.end());
+  return distribution(bit_gen);
+}
+
+int64_t CoverageGuidedScheduler::RecordSample(
+    int64_t arm, const absl::btree_set<std::string>& features) {
+  absl::MutexLock lock(&mutex_);
+  int64_t new_features = 0;
+  double score = 0.0;
+  for (const std::string& feature : features) {
+    int64_t& count = feature_counts_[feature];
+    if (count == 0) {
+      ++new_features;
+    }
+    score += 1.0 / static_cast<double>(count + 1);
+    ++count;
+  }
+  arm_scores_.at(arm) = arm_samples_.at(arm) == 0
+                            ? score
+                            : (1.0 - kScoreDecay) * arm_scores_.at(arm) +
+                                  kScoreDecay * score;
+  ++arm_samples_.at(arm);
+  return new_features;
+}
+
+int64_t CoverageGuidedScheduler::GetFeatureCount() const {
+  absl::MutexLock lock(&mutex_);
+  return feature_counts_.size();
+}
+
+std::string CoverageGuidedScheduler::ToString() const {
+  absl::MutexLock lock(&mutex_);
+  std::vector<std::string> lines;
+  lines.push_back(
+      absl::StrFormat("%d coverage features seen", feature_counts_.size()));
+  for (int64_t i = 0; i < arms_.size(); ++i) {
+    lines.push_back(absl::StrFormat("  %s: %d samples, score %.3f",
+                                    arms_[i].name, arm_samples_[i],
+                                    arm_scores_[i]));
+  }
+  return absl::StrJoin(lines, "\n");
+}
+
+}  // namespace xls
@@ -0,0 +1,106 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_COVERAGE_SCHEDULER_H_
+#define XLS_FUZZER_COVERAGE_SCHEDULER_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/random/bit_gen_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/fuzzer/ast_generator.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// Returns the coverage features exercised by a sample, e.g. "op:smul" for each
+// op kind in the unoptimized IR, "op_width:smul:<=32" for the bit width
+// (rounded up to a power of two) of each op kind, and "opt_removed:smul" for
+// each op kind whose node count was reduced by optimization. `optimized` may
+// be null if the sample was not optimized.
+absl::btree_set<std::string> GetIrCoverageFeatures(Package* unoptimized,
+                                                   Package* optimized);
+
+// Returns the coverage features of the sample run in `run_dir` from the IR
+// files written by the sample runner. Returns an empty set if the sample did
+// not get as far as producing IR.
+absl::StatusOr<absl::btree_set<std::string>> GetSampleCoverageFeatures(
+    const std::filesystem::path& run_dir);
+
+// Chooses the generator options of each fuzzer sample, biased toward the
+// options whose samples recently exercised rarely seen coverage features.
+//
+// The scheduler derives a fixed set of "arms" from the base options, each a
+// variation of the base options which stays within its limits (e.g. narrower
+// bits types, or no loops). Each recorded sample is scored by the rarity of
+// its features across all samples recorded so far, and arms are chosen with
+// probability proportional to a moving average of the scores of their recent
+// samples. Thread-safe; a single scheduler is shared by all fuzzer workers.
+class CoverageGuidedScheduler {
+ public:
+  explicit CoverageGuidedScheduler(
+      const dslx::AstGeneratorOptions& base_options);
+
+  int64_t arm_count() const { return arms_.size(); }
+
+  const dslx::AstGeneratorOptions& GetArmOptions(int64_t arm) const {
+    return arms_.at(arm).options;
+  }
+  const std::string& GetArmName(int64_t arm) const {
+    return arms_.at(arm).name;
+  }
+
+  // Randomly chooses the arm to generate the next sample with.
+  int64_t ChooseArm(absl::BitGenRef bit_gen) const;
+
+  // Records the coverage features of a sample generated with `arm`. Returns
+  // the number of features which had never been seen before.
+  int64_t RecordSample(int64_t arm,
+                       const absl::btree_set<std::string>& features);
+
+  // Returns the number of distinct features seen so far.
+  int64_t GetFeatureCount() const;
+
+  // Returns a human-readable summary of the samples and score of each arm.
+  std::string ToString() const;
+
+ private:
+  struct Arm {
+    std::string name;
+    dslx::AstGeneratorOptions options;
+  };
+
+  // Returns the current weight of each arm.
+  std::vector<double> GetArmWeights() const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  std::vector<Arm> arms_;
+
+  mutable absl::Mutex mutex_;
+  std::vector<int64_t> arm_samples_ ABSL_GUARDED_BY(mutex_);
+  std::vector<double> arm_scores_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, int64_t> feature_counts_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_COVERAGE_SCHEDULER_H_
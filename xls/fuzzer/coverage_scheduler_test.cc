@@ -0,0 +1,127 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/coverage_scheduler.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/btree_set.h"
+#include "xls/common/status/matchers.h"
+#include "xls/fuzzer/ast_generator.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using ::testing::Contains;
+using ::testing::Not;
+
+TEST(CoverageSchedulerTest, IrCoverageFeatures) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> unoptimized,
+                           Parser::ParsePackage(R"(
+package test
+
+top fn main(x: bits[20], y: bits[20]) -> bits[20] {
+  zero: bits[20] = literal(value=0)
+  sum: bits[20] = add(x, zero)
+  ret product: bits[20] = umul(sum, y)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> optimized,
+                           Parser::ParsePackage(R"(
+package test
+
+top fn main(x: bits[20], y: bits[20]) -> bits[20] {
+  ret product: bits[20] = umul(x, y)
+}
+)"));
+
+  absl::btree_set<std::string> features =
+      GetIrCoverageFeatures(unoptimized.get(), optimized.get());
+  EXPECT_THAT(features, Contains("op:add"));
+  EXPECT_THAT(features, Contains("op:umul"));
+  EXPECT_THAT(features, Contains("op_width:umul:<=32"));
+  EXPECT_THAT(features, Contains("opt_removed:add"));
+  EXPECT_THAT(features, Contains("opt_removed:literal"));
+  EXPECT_THAT(features, Not(Contains("opt_removed:umul")));
+
+  EXPECT_THAT(GetIrCoverageFeatures(unoptimized.get(), nullptr),
+              Not(Contains("opt_removed:add")));
+}
+
+TEST(CoverageSchedulerTest, ArmsStayWithinBaseOptions) {
+  dslx::AstGeneratorOptions options;
+  options.max_width_bits_types = 64;
+  options.emit_loops = false;
+  CoverageGuidedScheduler scheduler(options);
+
+  // Widths 64, 16 and 4 without loops.
+  ASSERT_EQ(scheduler.arm_count(), 3);
+  for (int64_t arm = 0; arm < scheduler.arm_count(); ++arm) {
+    EXPECT_LE(scheduler.GetArmOptions(arm).max_width_bits_types, 64);
+    EXPECT_FALSE(scheduler.GetArmOptions(arm).emit_loops);
+  }
+
+  options.emit_loops = true;
+  EXPECT_EQ(CoverageGuidedScheduler(options).arm_count(), 6);
+}
+
+TEST(CoverageSchedulerTest, RecordSampleCountsNewFeatures) {
+  CoverageGuidedScheduler scheduler(dslx::AstGeneratorOptions{});
+  EXPECT_EQ(scheduler.RecordSample(0, {"op:add", "op:umul"}), 2);
+  EXPECT_EQ(scheduler.RecordSample(1, {"op:add", "op:sub"}), 1);
+  EXPECT_EQ(scheduler.RecordSample(0, {"op:add"}), 0);
+  EXPECT_EQ(scheduler.GetFeatureCount(), 3);
+}
+
+TEST(CoverageSchedulerTest, PrefersArmsFindingRareFeatures) {
+  CoverageGuidedScheduler scheduler(dslx::AstGeneratorOptions{});
+  ASSERT_GT(scheduler.arm_count(), 1);
+
+  // Every arm but the first only ever exercises the same feature, while the
+  // first keeps exercising new ones.
+  int64_t next_feature = 0;
+  for (int64_t i = 0; i < 10; ++i) {
+    for (int64_t arm = 0; arm < scheduler.arm_count(); ++arm) {
+      absl::btree_set<std::string> features = {"op:add"};
+      if (arm == 0) {
+        for (int64_t j = 0; j < 10; ++j) {
+          features.insert(std::to_string(next_feature++));
+        }
+      }
+      scheduler.RecordSample(arm, features);
+    }
+  }
+
+  std::mt19937_64 rng;
+  std::vector<int64_t> chosen(scheduler.arm_count(), 0);
+  for (int64_t i = 0; i < 1000; ++i) {
+    ++chosen[scheduler.ChooseArm(rng)];
+  }
+  for (int64_t arm = 1; arm < scheduler.arm_count(); ++arm) {
+    EXPECT_GT(chosen[0], chosen[arm]);
+    // Stale arms are still explored.
+    EXPECT_GT(chosen[arm], 0);
+  }
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,316 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/in_process_commands.h"
+
+#include <filesystem>  // NOLINT
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/stopwatch.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/ir_convert/conversion_info.h"
+#include "xls/dslx/ir_convert/convert_options.h"
+#include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_runner.h"
+#include "xls/interpreter/compiled_function_interpreter.h"
+#include "xls/ir/events.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/tools/opt.h"
+#include "xls/tools/typed_value_file.h"
+#include "re2/re2.h"
+
+namespace xls {
+namespace {
+
+// Flags and positional arguments of a tool invocation built by the
+// SampleRunner.
+struct ToolArgs {
+  absl::flat_hash_map<std::string, std::string> flags;
+  std::vector<std::filesystem::path> positional;
+
+  std::optional<std::string_view> GetFlag(std::string_view name) const {
+    auto it = flags.find(name);
+    if (it == flags.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  absl::StatusOr<bool> GetBoolFlag(std::string_view name,
+                                   bool default_value) const {
+    std::optional<std::string_view> value = GetFlag(name);
+    if (!value.has_value()) {
+      return default_value;
+    }
+    bool result;
+    if (!absl::SimpleAtob(*value, &result)) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid value for --%s: %s", name, *value));
+    }
+    return result;
+  }
+};
+
+// Parses `args` of the given tool, accepting only the flags in
+// `supported_bool_flags` (which may also be given as `--flag` or `--noflag`)
+// and `supported_flags`. Relative paths are resolved against `run_dir`, which
+// is the working directory the tool would have been run in.
+absl::StatusOr<ToolArgs> ParseToolArgs(
+    std::string_view tool, absl::Span<const std::string> args,
+    const std::filesystem::path& run_dir,
+    absl::Span<const std::string_view> supported_bool_flags,
+    absl::Span<const std::string_view> supported_flags) {
+  ToolArgs result;
+  for (const std::string& arg : args) {
+    if (!absl::StartsWith(arg, "-")) {
+      std::filesystem::path path(arg);
+      result.positional.push_back(path.is_relative() ? run_dir / path : path);
+      continue;
+    }
+    std::string_view flag = arg;
+    flag.remove_prefix(absl::StartsWith(flag, "--") ? 2 : 1);
+    std::vector<std::string_view> name_and_value =
+        absl::StrSplit(flag, absl::MaxSplits('=', 1));
+    std::string_view name = name_and_value[0];
+    std::optional<std::string_view> value;
+    if (name_and_value.size() == 2) {
+      value = name_and_value[1];
+    }
+    if (absl::c_linear_search(supported_bool_flags, name)) {
+      result.flags[std::string(name)] = value.value_or("true");
+    } else if (!value.has_value() && absl::StartsWith(name, "no") &&
+               absl::c_linear_search(supported_bool_flags, name.substr(2))) {
+      result.flags[std::string(name.substr(2))] = "false";
+    } else if (value.has_value() &&
+               absl::c_linear_search(supported_flags, name)) {
+      result.flags[std::string(name)] = *value;
+    } else {
+      return absl::UnimplementedError(
+          absl::StrFormat("In-process %s does not support argument: %s", tool,
+                          arg));
+    }
+  }
+  return result;
+}
+
+absl::StatusOr<std::filesystem::path> GetSinglePositional(
+    std::string_view tool, const ToolArgs& args) {
+  if (args.positional.size() != 1) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("In-process %s expects a single input file; got %d",
+                        tool, args.positional.size()));
+  }
+  return args.positional.front();
+}
+
+absl::StatusOr<std::string> ConvertDslxToIr(
+    const std::vector<std::string>& args,
+    const std::filesystem::path& run_dir) {
+  XLS_ASSIGN_OR_RETURN(
+      ToolArgs tool_args,
+      ParseToolArgs("ir_converter_main", args, run_dir,
+                    {"emit_fail_as_assert", "verify", "warnings_as_errors"},
+                    {"top"}));
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path input_path,
+                       GetSinglePositional("ir_converter_main", tool_args));
+  XLS_ASSIGN_OR_RETURN(bool emit_fail_as_assert,
+                       tool_args.GetBoolFlag("emit_fail_as_assert", true));
+  XLS_ASSIGN_OR_RETURN(bool verify_ir, tool_args.GetBoolFlag("verify", true));
+  XLS_ASSIGN_OR_RETURN(bool warnings_as_errors,
+                       tool_args.GetBoolFlag("warnings_as_errors", true));
+  const dslx::ConvertOptions convert_options = {
+      .emit_positions = true,
+      .emit_fail_as_assert = emit_fail_as_assert,
+      .verify_ir = verify_ir,
+      .warnings_as_errors = warnings_as_errors,
+  };
+  std::string input_path_str = input_path.string();
+  std::string_view paths[] = {input_path_str};
+  XLS_ASSIGN_OR_RETURN(
+      dslx::PackageConversionData result,
+      dslx::ConvertFilesToPackage(paths, kDefaultDslxStdlibPath,
+                                  /*dslx_paths=*/{}, convert_options,
+                                  /*top=*/tool_args.GetFlag("top")));
+  return result.DumpIr();
+}
+
+absl::StatusOr<std::string> OptimizeIr(const std::vector<std::string>& args,
+                                       const std::filesystem::path& run_dir) {
+  XLS_ASSIGN_OR_RETURN(
+      ToolArgs tool_args,
+      ParseToolArgs("opt_main", args, run_dir, /*supported_bool_flags=*/{},
+                    {"top"}));
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path ir_path,
+                       GetSinglePositional("opt_main", tool_args));
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
+  // The defaults of opt_main.
+  tools::OptOptions opt_options = {
+      .top = tool_args.GetFlag("top").value_or(""),
+      .split_next_value_selects = 4,
+      .inline_procs = false,
+      .use_context_narrowing_analysis = false,
+  };
+  return tools::OptimizeIrForTop(ir_text, opt_options);
+}
+
+absl::StatusOr<std::string> EvaluateIr(const std::vector<std::string>& args,
+                                       const std::filesystem::path& run_dir) {
+  XLS_ASSIGN_OR_RETURN(
+      ToolArgs tool_args,
+      ParseToolArgs("eval_ir_main", args, run_dir, {"use_llvm_jit"},
+                    {"input_file", "jit_compile_time_output", "top"}));
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path ir_path,
+                       GetSinglePositional("eval_ir_main", tool_args));
+  XLS_ASSIGN_OR_RETURN(bool use_jit,
+                       tool_args.GetBoolFlag("use_llvm_jit", true));
+  std::optional<std::string_view> input_file = tool_args.GetFlag("input_file");
+  if (!input_file.has_value()) {
+    return absl::UnimplementedError(
+        "In-process eval_ir_main requires --input_file");
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text, ir_path.string()));
+  if (std::optional<std::string_view> top = tool_args.GetFlag("top");
+      top.has_value()) {
+    XLS_RETURN_IF_ERROR(package->SetTopByName(*top));
+  }
+  XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
+
+  std::filesystem::path input_path(*input_file);
+  if (input_path.is_relative()) {
+    input_path = run_dir / input_path;
+  }
+  XLS_ASSIGN_OR_RETURN(std::string input_text, GetFileContents(input_path));
+  std::vector<std::vector<Value>> arg_sets;
+  if (IsTypedValueFile(input_text)) {
+    XLS_ASSIGN_OR_RETURN(std::vector<Value> tuples,
+                         DecodeTypedValues(input_text));
+    for (const Value& tuple : tuples) {
+      arg_sets.emplace_back(tuple.elements().begin(), tuple.elements().end());
+    }
+  } else {
+    for (std::string_view line :
+         absl::StrSplit(input_text, '\n', absl::SkipWhitespace())) {
+      std::vector<Value>& arg_set = arg_sets.emplace_back();
+      for (std::string_view arg : absl::StrSplit(line, ';')) {
+        XLS_ASSIGN_OR_RETURN(
+            Value value,
+            Parser::ParseTypedValue(absl::StripAsciiWhitespace(arg)));
+        arg_set.push_back(std::move(value));
+      }
+    }
+  }
+
+  std::unique_ptr<FunctionJit> jit;
+  std::unique_ptr<CompiledFunctionInterpreter> interpreter;
+  if (use_jit) {
+    Stopwatch compile_timer;
+    XLS_ASSIGN_OR_RETURN(jit, FunctionJit::Create(f));
+    if (std::optional<std::string_view> compile_time_path =
+            tool_args.GetFlag("jit_compile_time_output");
+        compile_time_path.has_value()) {
+      std::filesystem::path path(*compile_time_path);
+      XLS_RETURN_IF_ERROR(SetFileContents(
+          path.is_relative() ? run_dir / path : path,
+          absl::StrCat(
+              absl::ToInt64Nanoseconds(compile_timer.GetElapsedTime()))));
+    }
+  } else {
+    XLS_ASSIGN_OR_RETURN(interpreter, CompiledFunctionInterpreter::Create(f));
+  }
+  std::string results;
+  for (const std::vector<Value>& arg_set : arg_sets) {
+    Value result;
+    if (use_jit) {
+      XLS_ASSIGN_OR_RETURN(result, DropInterpreterEvents(jit->Run(arg_set)));
+    } else {
+      XLS_ASSIGN_OR_RETURN(result,
+                           DropInterpreterEvents(interpreter->Run(arg_set)));
+    }
+    absl::StrAppend(&results, result.ToString(FormatPreference::kHex), "\n");
+  }
+  return results;
+}
+
+// Wraps an in-process command so that its errors are filtered by the known
+// failures of the sample options, as RunCommand does with the stderr of
+// subprocesses.
+SampleRunner::Commands::Callable WithKnownFailures(
+    std::string tool,
+    std::function<absl::StatusOr<std::string>(const std::vector<std::string>&,
+                                              const std::filesystem::path&)>
+        command) {
+  return [tool = std::move(tool), command = std::move(command)](
+             const std::vector<std::string>& args,
+             const std::filesystem::path& run_dir,
+             const SampleOptions& options) -> absl::StatusOr<std::string> {
+    VLOG(1) << "Running in-process " << tool;
+    absl::StatusOr<std::string> result = command(args, run_dir);
+    if (result.ok() || absl::IsUnimplemented(result.status())) {
+      return result;
+    }
+    for (const KnownFailure& filter : options.known_failures()) {
+      if ((filter.tool == nullptr || RE2::FullMatch(tool, *filter.tool)) &&
+          RE2::PartialMatch(result.status().message(),
+                            *filter.stderr_regex)) {
+        return absl::FailedPreconditionError(absl::StrFormat(
+            "%s failed but failure was suppressed due to stderr regexp: %s",
+            tool, result.status().ToString()));
+      }
+    }
+    return result;
+  };
+}
+
+}  // namespace
+
+SampleRunner::Commands InProcessCommands() {
+  return SampleRunner::Commands{
+      .eval_ir_main = WithKnownFailures("eval_ir_main", EvaluateIr),
+      .ir_converter_main =
+          WithKnownFailures("ir_converter_main", ConvertDslxToIr),
+      .ir_opt_main = WithKnownFailures("opt_main", OptimizeIr),
+  };
+}
+
+}  // namespace xls
@@ -0,0 +1,40 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_IN_PROCESS_COMMANDS_H_
+#define XLS_FUZZER_IN_PROCESS_COMMANDS_H_
+
+#include "xls/fuzzer/sample_runner.h"
+
+namespace xls {
+
+// Returns SampleRunner commands which convert DSLX to IR, optimize IR and
+// evaluate IR functions (with the interpreter or the JIT) by calling the
+// library entry points in the current process rather than spawning
+// ir_converter_main, opt_main and eval_ir_main.
+//
+// The commands accept the subset of flags of the corresponding tools which
+// the SampleRunner passes, and return an UnimplementedError for any other
+// flag (e.g. from SampleOptions::ir_converter_args). Known failures in the
+// sample options are matched against the error message in place of stderr.
+//
+// Codegen, proc evaluation and Verilog simulation are left unset and so still
+// run as subprocesses. Note that, unlike subprocesses, the commands are not
+// subject to SampleOptions::timeout_seconds and a crash in the compiler takes
+// down the calling process.
+SampleRunner::Commands InProcessCommands();
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_IN_PROCESS_COMMANDS_H_
@@ -0,0 +1,105 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/in_process_commands.h"
+
+#include <filesystem>  // NOLINT
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_runner.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+constexpr std::string_view kAdderDslx = "fn main(x: u8, y: u8) -> u8 { x + y }";
+
+std::vector<std::vector<dslx::InterpValue>> AdderArgs() {
+  return {{dslx::InterpValue::MakeUBits(8, 42),
+           dslx::InterpValue::MakeUBits(8, 100)}};
+}
+
+TEST(InProcessCommandsTest, ConvertOptimizeAndEvaluate) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  SampleRunner runner(temp_dir.path(), InProcessCommands());
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  options.set_ir_converter_args({"--top=main"});
+  options.set_optimize_ir(true);
+  options.set_use_jit(true);
+  XLS_ASSERT_OK(
+      runner.Run(Sample(std::string(kAdderDslx), options, AdderArgs())));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string opt_ir,
+                           GetFileContents(temp_dir.path() / "sample.opt.ir"));
+  EXPECT_THAT(opt_ir, HasSubstr("package sample"));
+  for (std::string_view results_file :
+       {"sample.ir.results", "sample.opt.ir.results"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::string results,
+                             GetFileContents(temp_dir.path() / results_file));
+    EXPECT_EQ(absl::StripAsciiWhitespace(results), "bits[8]:0x8e");
+  }
+  EXPECT_GT(runner.timing().unoptimized_jit_compile_ns(), 0);
+  EXPECT_GT(runner.timing().optimized_jit_compile_ns(), 0);
+
+  // No tool was run as a subprocess.
+  for (const std::filesystem::directory_entry& entry :
+       std::filesystem::directory_iterator(temp_dir.path())) {
+    EXPECT_NE(entry.path().extension(), ".stderr") << entry.path();
+  }
+}
+
+TEST(InProcessCommandsTest, Interpreter) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  SampleRunner runner(temp_dir.path(), InProcessCommands());
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  options.set_ir_converter_args({"--top=main"});
+  options.set_optimize_ir(true);
+  options.set_use_jit(false);
+  XLS_ASSERT_OK(
+      runner.Run(Sample(std::string(kAdderDslx), options, AdderArgs())));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string results,
+      GetFileContents(temp_dir.path() / "sample.opt.ir.results"));
+  EXPECT_EQ(absl::StripAsciiWhitespace(results), "bits[8]:0x8e");
+}
+
+TEST(InProcessCommandsTest, UnsupportedConverterFlag) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  SampleRunner runner(temp_dir.path(), InProcessCommands());
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  options.set_ir_converter_args({"--top=main", "--package_name=foo"});
+  EXPECT_THAT(
+      runner.Run(Sample(std::string(kAdderDslx), options, AdderArgs())),
+      StatusIs(absl::StatusCode::kUnimplemented,
+               HasSubstr("does not support argument: --package_name=foo")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
@@ -88,6 +89,8 @@ struct SummaryInfo {
   fuzzer::SampleTimingProto total_timing;
   // The maximum time spent on a single same for the various fuzzer operations.
   fuzzer::SampleTimingProto max_timing;
+  // The timing of each sample, for computing percentiles.
+  std::vector<fuzzer::SampleTimingProto> sample_timings;
 };
 
 // Aggregates the summary data in 'summary' into 'info'.
@@ -148,7 +151,35 @@ void AggregateSummary(const fuzzer::SampleSummaryProto& summary,
   AGGREGATE_FIELD(optimized_jit_ns);
   AGGREGATE_FIELD(codegen_ns);
   AGGREGATE_FIELD(simulate_ns);
+  AGGREGATE_FIELD(unoptimized_jit_compile_ns);
+  AGGREGATE_FIELD(optimized_jit_compile_ns);
 #undef AGGREGATE_FIELD
+  info->sample_timings.push_back(summary.timing());
+}
+
+// Returns the values of a timing field over all samples in ascending order.
+std::vector<int64_t> SortedTimes(
+    absl::Span<const fuzzer::SampleTimingProto> timings,
+    absl::FunctionRef<int64_t(const fuzzer::SampleTimingProto&)> field) {
+  std::vector<int64_t> times;
+  times.reserve(timings.size());
+  for (const fuzzer::SampleTimingProto& timing : timings) {
+    times.push_back(field(timing));
+  }
+  std::sort(times.begin(), times.end());
+  return times;
+}
+
+// Returns the given percentile of the sorted times using the nearest-rank
+// method.
+int64_t Percentile(absl::Span<const int64_t> sorted_times, int64_t percentile) {
+  if (sorted_times.empty()) {
+    return 0;
+  }
+  int64_t rank = (percentile * static_cast<int64_t>(sorted_times.size()) + 99) /
+                 100;
+  return sorted_times[std::clamp<int64_t>(rank - 1, 0,
+                                          sorted_times.size() - 1)];
 }
 
 // Print the timing info contained in 'info' to stdout.
@@ -189,12 +220,20 @@ void DumpTimingInfo(const SummaryInfo& info) {
                                   us_to_sec(info.max_timing.total_ns()));
   std::cout << "\nBreakdown:\n";
 #define PRINT_ROW(F)                                                         \
-  std::cout << absl::StreamFormat(                                           \
-      "%-30s %10.3fs (%4.1f%%), mean %5.3fs, max %6.3fs\n", #F,              \
-      us_to_sec(info.total_timing.F()),                                      \
-      percent(info.total_timing.F(), info.total_timing.total_ns()),          \
-      us_to_sec(mean(info.total_timing.F(), info.unoptimized_info.samples)), \
-      us_to_sec(info.max_timing.F()));
+  {                                                                          \
+    std::vector<int64_t> times = SortedTimes(                                \
+        info.sample_timings,                                                 \
+        [](const fuzzer::SampleTimingProto& t) { return t.F(); });           \
+    std::cout << absl::StreamFormat(                                         \
+        "%-30s %10.3fs (%4.1f%%), mean %5.3fs, p50 %5.3fs, p90 %5.3fs, "     \
+        "p99 %6.3fs, max %6.3fs\n",                                          \
+        #F, us_to_sec(info.total_timing.F()),                                \
+        percent(info.total_timing.F(), info.total_timing.total_ns()),        \
+        us_to_sec(mean(info.total_timing.F(),                                \
+                       info.unoptimized_info.samples)),                      \
+        us_to_sec(Percentile(times, 50)), us_to_sec(Percentile(times, 90)),  \
+        us_to_sec(Percentile(times, 99)), us_to_sec(info.max_timing.F()));   \
+  }
   PRINT_ROW(generate_sample_ns);
   PRINT_ROW(interpret_dslx_ns);
   PRINT_ROW(convert_ir_ns);
@@ -205,6 +244,9 @@ void DumpTimingInfo(const SummaryInfo& info) {
   PRINT_ROW(optimized_jit_ns);
   PRINT_ROW(codegen_ns);
   PRINT_ROW(simulate_ns);
+  std::cout << "\nJIT compilation (included in the JIT times above):\n";
+  PRINT_ROW(unoptimized_jit_compile_ns);
+  PRINT_ROW(optimized_jit_compile_ns);
 #undef PRINT_ROW
 }
 
@@ -172,7 +172,8 @@ absl::StatusOr<std::filesystem::path> SaveCrasher(
 
 absl::Status RunSample(const Sample& smp, const std::filesystem::path& run_dir,
                        const std::optional<std::filesystem::path>& summary_file,
-                       std::optional<absl::Duration> generate_sample_elapsed) {
+                       std::optional<absl::Duration> generate_sample_elapsed,
+                       const SampleRunner::Commands& commands) {
   XLS_ASSIGN_OR_RETURN(std::filesystem::path sample_runner_main_path,
                        GetXlsRunfilePath(kSampleRunnerMainPath));
 
@@ -222,7 +223,7 @@ absl::Status RunSample(const Sample& smp, const std::filesystem::path& run_dir,
 
   VLOG(1) << "Starting to run sample";
   VLOG(2) << smp.input_text();
-  SampleRunner runner(run_dir);
+  SampleRunner runner(run_dir, commands);
   XLS_RETURN_IF_ERROR(runner.RunFromFiles(sample_file_name, options_file_name,
                                           args_file_name,
                                           ir_channel_names_file_name));
@@ -254,14 +255,14 @@ absl::StatusOr<Sample> GenerateSampleAndRun(
     const SampleOptions& sample_options, const std::filesystem::path& run_dir,
     const std::optional<std::filesystem::path>& crasher_dir,
     const std::optional<std::filesystem::path>& summary_file,
-    bool force_failure) {
+    bool force_failure, const SampleRunner::Commands& commands) {
   Stopwatch stopwatch;
   XLS_ASSIGN_OR_RETURN(Sample smp, GenerateSample(ast_generator_options,
                                                   sample_options, bit_gen));
   absl::Duration generate_sample_elapsed = stopwatch.GetElapsedTime();
 
   absl::Status status =
-      RunSample(smp, run_dir, summary_file, generate_sample_elapsed);
+      RunSample(smp, run_dir, summary_file, generate_sample_elapsed, commands);
   if (force_failure) {
     status = absl::InternalError("Forced sample failure.");
   }
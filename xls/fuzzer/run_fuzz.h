@@ -24,18 +24,21 @@
 #include "absl/time/time.h"
 #include "xls/fuzzer/ast_generator.h"
 #include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_runner.h"
 
 namespace xls {
 
 // Runs the given sample in `run_dir`. If `summary_file` is given, the sample
 // summary will be appended to this file; if `generate_sample_elapsed` is also
-// given, it will be recorded in the timings in the sample summary.
+// given, it will be recorded in the timings in the sample summary. The
+// sample's tools are run with `commands` (see SampleRunner::Commands).
 //
 // `run_dir` must be an empty directory.
 absl::Status RunSample(
     const Sample& smp, const std::filesystem::path& run_dir,
     const std::optional<std::filesystem::path>& summary_file = std::nullopt,
-    std::optional<absl::Duration> generate_sample_elapsed = std::nullopt);
+    std::optional<absl::Duration> generate_sample_elapsed = std::nullopt,
+    const SampleRunner::Commands& commands = {});
 
 absl::StatusOr<Sample> GenerateSampleAndRun(
     absl::BitGenRef bit_gen,
@@ -43,7 +46,7 @@ absl::StatusOr<Sample> GenerateSampleAndRun(
     const SampleOptions& sample_options, const std::filesystem::path& run_dir,
     const std::optional<std::filesystem::path>& crasher_dir = std::nullopt,
     const std::optional<std::filesystem::path>& summary_file = std::nullopt,
-    bool force_failure = false);
+    bool force_failure = false, const SampleRunner::Commands& commands = {});
 
 }  // namespace xls
 
@@ -23,6 +23,7 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/container/btree_set.h"
 #include "absl/log/log.h"
 #include "absl/random/distributions.h"
 #include "absl/random/random.h"
@@ -38,8 +39,11 @@
 #include "xls/common/stopwatch.h"
 #include "xls/common/thread.h"
 #include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/coverage_scheduler.h"
+#include "xls/fuzzer/in_process_commands.h"
 #include "xls/fuzzer/run_fuzz.h"
 #include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_runner.h"
 
 namespace xls {
 namespace {
@@ -56,7 +60,9 @@ absl::Status GenerateAndRunSamples(
     const std::optional<std::filesystem::path>& crasher_dir,
     const std::optional<std::filesystem::path>& summary_dir,
     std::optional<int64_t> sample_count,
-    const std::optional<absl::Duration>& duration, bool force_failure) {
+    const std::optional<absl::Duration>& duration, bool force_failure,
+    CoverageGuidedScheduler* scheduler,
+    const SampleRunner::Commands& commands) {
   int64_t crashers = 0;
   LOG(INFO) << "--- Started worker " << worker_number;
   Stopwatch stopwatch;
@@ -94,9 +100,18 @@ absl::Status GenerateAndRunSamples(
       run_dir = temp_run_dir->path();
     }
 
+    int64_t arm = 0;
+    const dslx::AstGeneratorOptions* sample_ast_generator_options =
+        &ast_generator_options;
+    if (scheduler != nullptr) {
+      arm = scheduler->ChooseArm(rng);
+      sample_ast_generator_options = &scheduler->GetArmOptions(arm);
+    }
+
     absl::Status sample_status =
-        GenerateSampleAndRun(rng, ast_generator_options, sample_options,
-                             run_dir, crasher_dir, summary_file, force_failure)
+        GenerateSampleAndRun(rng, *sample_ast_generator_options,
+                             sample_options, run_dir, crasher_dir,
+                             summary_file, force_failure, commands)
             .status();
     if (!sample_status.ok()) {
       LOG(INFO) << kRedText
@@ -107,6 +122,21 @@ absl::Status GenerateAndRunSamples(
       crashers++;
     }
 
+    if (scheduler != nullptr) {
+      absl::StatusOr<absl::btree_set<std::string>> features =
+          GetSampleCoverageFeatures(run_dir);
+      if (features.ok()) {
+        int64_t new_features = scheduler->RecordSample(arm, *features);
+        VLOG(1) << absl::StreamFormat(
+            "--- Worker #%d: sample %d (%s) exercised %d new coverage "
+            "features",
+            worker_number, sample, scheduler->GetArmName(arm), new_features);
+      } else {
+        LOG(WARNING) << "Failed to collect coverage of sample: "
+                     << features.status();
+      }
+    }
+
     absl::Duration elapsed = stopwatch.GetElapsedTime();
     if (sample > 0 && sample % 16 == 0) {
       std::vector<std::string> metrics;
@@ -166,7 +196,15 @@ absl::Status ParallelGenerateAndRunSamples(
     const std::optional<std::filesystem::path>& crasher_dir,
     const std::optional<std::filesystem::path>& summary_dir,
     std::optional<int64_t> sample_count, std::optional<absl::Duration> duration,
-    bool force_failure) {
+    bool force_failure, bool coverage_guided, bool in_process) {
+  std::optional<CoverageGuidedScheduler> scheduler;
+  if (coverage_guided) {
+    scheduler.emplace(ast_generator_options);
+  }
+  SampleRunner::Commands commands;
+  if (in_process) {
+    commands = InProcessCommands();
+  }
   std::vector<std::unique_ptr<Thread>> workers;
   workers.resize(worker_count);
   std::vector<absl::Status> worker_status;
@@ -182,7 +220,9 @@ absl::Status ParallelGenerateAndRunSamples(
       *status =
           GenerateAndRunSamples(i, ast_generator_options, sample_options, seed,
                                 top_run_dir, crasher_dir, summary_dir,
-                                worker_sample_count, duration, force_failure);
+                                worker_sample_count, duration, force_failure,
+                                scheduler.has_value() ? &*scheduler : nullptr,
+                                commands);
     });
   }
   for (int64_t i = 0; i < workers.size(); ++i) {
@@ -193,6 +233,9 @@ absl::Status ParallelGenerateAndRunSamples(
                  << " failed: " << worker_status[i] << kDefaultColor;
     }
   }
+  if (scheduler.has_value()) {
+    LOG(INFO) << "-- Coverage-guided scheduling:\n" << scheduler->ToString();
+  }
   return absl::OkStatus();
 }
 
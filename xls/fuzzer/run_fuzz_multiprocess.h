@@ -37,6 +37,14 @@ namespace xls {
 //
 // If `force_failure` is true, every sample run will be considered a failure.
 // This is useful for testing failure paths.
+//
+// If `coverage_guided` is true, the workers share a CoverageGuidedScheduler
+// which biases the generator options of each sample toward those which
+// recently exercised rarely seen IR features. The samples generated then
+// depend on the interleaving of the workers, even if `seed` is specified.
+//
+// If `in_process` is true, DSLX conversion, optimization and IR evaluation run
+// in the worker threads rather than as subprocesses (see InProcessCommands).
 absl::Status ParallelGenerateAndRunSamples(
     int64_t worker_count,
     const dslx::AstGeneratorOptions& ast_generator_options,
@@ -47,7 +55,8 @@ absl::Status ParallelGenerateAndRunSamples(
     const std::optional<std::filesystem::path>& summary_dir = std::nullopt,
     std::optional<int64_t> sample_count = std::nullopt,
     std::optional<absl::Duration> duration = std::nullopt,
-    bool force_failure = false);
+    bool force_failure = false, bool coverage_guided = false,
+    bool in_process = false);
 
 }  // namespace xls
 
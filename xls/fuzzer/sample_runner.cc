@@ -38,6 +38,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -71,10 +72,12 @@
 #include "xls/fuzzer/sample.pb.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
 #include "xls/ir/value.h"
 #include "xls/public/runtime_build_actions.h"
 #include "xls/simulation/check_simulator.h"
 #include "xls/tools/eval_utils.h"
+#include "xls/tools/typed_value_file.h"
 #include "re2/re2.h"
 
 // These are used to forward, but also see comment below.
@@ -296,6 +299,51 @@ absl::StatusOr<std::vector<dslx::InterpValue>> ParseValues(std::string_view s) {
   return values;
 }
 
+// Returns the path of the file to which eval_ir_main writes the JIT compile
+// time when evaluating the given IR file.
+std::filesystem::path GetJitCompileTimePath(
+    const std::filesystem::path& ir_path) {
+  return absl::StrCat(ir_path.string(), ".jit_compile_ns");
+}
+
+// Returns the JIT compile time reported when evaluating the given IR file, if
+// the evaluation command reported it.
+std::optional<int64_t> GetJitCompileNs(const std::filesystem::path& ir_path) {
+  absl::StatusOr<std::string> contents =
+      GetFileContents(GetJitCompileTimePath(ir_path));
+  int64_t nanoseconds;
+  if (!contents.ok() ||
+      !absl::SimpleAtoi(absl::StripAsciiWhitespace(*contents), &nanoseconds)) {
+    return std::nullopt;
+  }
+  return nanoseconds;
+}
+
+// Writes the arguments of `args_batch` to a typed value file (one tuple of the
+// arguments per sample), which eval_ir_main reads far faster than the text of
+// args.txt when the arguments are large arrays.
+absl::Status WriteTypedArgsFile(const ArgsBatch& args_batch,
+                                const std::filesystem::path& path) {
+  XLS_RET_CHECK(!args_batch.empty());
+  std::vector<Value> tuples;
+  tuples.reserve(args_batch.size());
+  for (const std::vector<dslx::InterpValue>& args : args_batch) {
+    std::vector<Value> ir_args;
+    ir_args.reserve(args.size());
+    for (const dslx::InterpValue& arg : args) {
+      XLS_ASSIGN_OR_RETURN(Value ir_arg, arg.ConvertToIr());
+      ir_args.push_back(std::move(ir_arg));
+    }
+    tuples.push_back(Value::TupleOwned(std::move(ir_args)));
+  }
+  Package package("args");
+  XLS_ASSIGN_OR_RETURN(
+      std::string contents,
+      EncodeTypedValues(package.GetTypeForValue(tuples.front())->ToProto(),
+                        tuples));
+  return SetFileContents(path, contents);
+}
+
 // Evaluate the IR file with a function as its top and return the result Values.
 absl::StatusOr<std::vector<dslx::InterpValue>> EvaluateIrFunction(
     const std::filesystem::path& ir_path,
@@ -316,6 +364,8 @@ absl::StatusOr<std::vector<dslx::InterpValue>> EvaluateIrFunction(
                  {
                      absl::StrCat("--input_file=", args_path.string()),
                      absl::StrFormat("--%suse_llvm_jit", use_jit ? "" : "no"),
+                     absl::StrCat("--jit_compile_time_output=",
+                                  GetJitCompileTimePath(ir_path).string()),
                      ir_path,
                  },
                  run_dir, options));
@@ -908,23 +958,36 @@ absl::Status SampleRunner::RunFunction(
     XLS_RETURN_IF_ERROR(SetFileContents(ir_path, input_text));
   }
 
+  // The IR is evaluated with the arguments in binary form; args.txt remains the
+  // input of the DSLX interpreter and the simulator.
+  std::optional<std::filesystem::path> ir_args_path = args_path;
+  if (args_batch.has_value() && !args_batch->empty()) {
+    ir_args_path = run_dir_ / "args.bin";
+    XLS_RETURN_IF_ERROR(WriteTypedArgsFile(*args_batch, *ir_args_path));
+  }
+
   if (args_path.has_value()) {
     Stopwatch t;
 
     // Unconditionally evaluate with the interpreter even if using the JIT. This
     // exercises the interpreter and serves as a reference.
     XLS_ASSIGN_OR_RETURN(results["evaluated unopt IR (interpreter)"],
-                         EvaluateIrFunction(ir_path, *args_path, false, options,
-                                            run_dir_, commands_));
+                         EvaluateIrFunction(ir_path, *ir_args_path, false,
+                                            options, run_dir_, commands_));
     timing_.set_unoptimized_interpret_ir_ns(
         absl::ToInt64Nanoseconds(t.GetElapsedTime()));
 
     if (options.use_jit()) {
+      t.Reset();
       XLS_ASSIGN_OR_RETURN(results["evaluated unopt IR (JIT)"],
-                           EvaluateIrFunction(ir_path, *args_path, true,
+                           EvaluateIrFunction(ir_path, *ir_args_path, true,
                                               options, run_dir_, commands_));
       timing_.set_unoptimized_jit_ns(
           absl::ToInt64Nanoseconds(t.GetElapsedTime()));
+      if (std::optional<int64_t> compile_ns = GetJitCompileNs(ir_path);
+          compile_ns.has_value()) {
+        timing_.set_unoptimized_jit_compile_ns(*compile_ns);
+      }
     }
   }
 
@@ -937,16 +1000,22 @@ absl::Status SampleRunner::RunFunction(
     if (args_path.has_value()) {
       if (options.use_jit()) {
         t.Reset();
-        XLS_ASSIGN_OR_RETURN(results["evaluated opt IR (JIT)"],
-                             EvaluateIrFunction(opt_ir_path, *args_path, true,
-                                                options, run_dir_, commands_));
+        XLS_ASSIGN_OR_RETURN(
+            results["evaluated opt IR (JIT)"],
+            EvaluateIrFunction(opt_ir_path, *ir_args_path, true, options,
+                               run_dir_, commands_));
         timing_.set_optimized_jit_ns(
             absl::ToInt64Nanoseconds(t.GetElapsedTime()));
+        if (std::optional<int64_t> compile_ns = GetJitCompileNs(opt_ir_path);
+            compile_ns.has_value()) {
+          timing_.set_optimized_jit_compile_ns(*compile_ns);
+        }
       }
       t.Reset();
-      XLS_ASSIGN_OR_RETURN(results["evaluated opt IR (interpreter)"],
-                           EvaluateIrFunction(opt_ir_path, *args_path, false,
-                                              options, run_dir_, commands_));
+      XLS_ASSIGN_OR_RETURN(
+          results["evaluated opt IR (interpreter)"],
+          EvaluateIrFunction(opt_ir_path, *ir_args_path, false, options,
+                             run_dir_, commands_));
       timing_.set_optimized_interpret_ir_ns(
           absl::ToInt64Nanoseconds(t.GetElapsedTime()));
     }
@@ -29,6 +29,8 @@
 #include "xls/common/exit_status.h"
 #include "xls/common/file/temp_directory.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/fuzzer/in_process_commands.h"
 #include "xls/fuzzer/sample_runner.h"
 
 constexpr std::string_view kUsage = R"(Sample runner program.
@@ -41,6 +43,13 @@ sample_runner_main --options_file=OPT_FILE \
   --input_file=INPUT_FILE \
   --args_file=ARGS_FILE \
   [RUN_DIR]
+
+With --server, instead reads paths of code input files from stdin, one per
+line, and runs each of them as a sample in a temporary directory, replying to
+each with a line on stdout which is 1 if the sample failed and 0 otherwise.
+This is the protocol of ir_minimizer_main --test_server:
+
+sample_runner_main --server --options_file=OPT_FILE --args_file=ARGS_FILE
 )";
 
 ABSL_FLAG(std::string, options_file, "",
@@ -51,6 +60,11 @@ ABSL_FLAG(std::optional<std::string>, args_file, std::nullopt,
           "simulation.");
 ABSL_FLAG(std::optional<std::string>, ir_channel_names_file, std::nullopt,
           "Optional file containing IR names of input channels for a proc.");
+ABSL_FLAG(bool, server, false,
+          "Run as a test server, reading code input files from stdin rather "
+          "than --input_file. IR conversion, optimization and evaluation run "
+          "in this process so that their setup (e.g. initializing LLVM) is "
+          "shared between samples.");
 
 namespace xls {
 
@@ -68,14 +82,13 @@ std::filesystem::path MaybeCopyFile(const std::filesystem::path& file_path,
   return dir_path / basename;
 }
 
-}  // namespace
-
 // Runs the sample in the given run directory.
-static absl::Status RealMain(
+absl::Status RunSample(
     const std::filesystem::path& run_dir, const std::string& options_file,
     const std::string& input_file, const std::optional<std::string>& args_file,
-    const std::optional<std::string>& ir_channel_names_file) {
-  SampleRunner runner(run_dir);
+    const std::optional<std::string>& ir_channel_names_file,
+    SampleRunner::Commands commands = {}) {
+  SampleRunner runner(run_dir, std::move(commands));
   std::filesystem::path input_filename = MaybeCopyFile(input_file, run_dir);
   std::filesystem::path options_filename = MaybeCopyFile(options_file, run_dir);
   std::optional<std::filesystem::path> args_filename =
@@ -90,6 +103,53 @@ static absl::Status RealMain(
                              ir_channel_names_filename);
 }
 
+// Runs the sample in a new temporary directory with in-process commands,
+// falling back to subprocesses if the sample uses options the in-process
+// commands do not support.
+absl::Status RunServerSample(
+    const std::string& options_file, const std::string& input_file,
+    const std::optional<std::string>& args_file,
+    const std::optional<std::string>& ir_channel_names_file) {
+  {
+    XLS_ASSIGN_OR_RETURN(TempDirectory temp_dir, TempDirectory::Create());
+    absl::Status status =
+        RunSample(temp_dir.path(), options_file, input_file, args_file,
+                  ir_channel_names_file, InProcessCommands());
+    if (!absl::IsUnimplemented(status)) {
+      return status;
+    }
+    VLOG(1) << "Falling back to subprocesses: " << status;
+  }
+  XLS_ASSIGN_OR_RETURN(TempDirectory temp_dir, TempDirectory::Create());
+  return RunSample(temp_dir.path(), options_file, input_file, args_file,
+                   ir_channel_names_file);
+}
+
+}  // namespace
+
+static absl::Status RealMain(
+    const std::filesystem::path& run_dir, const std::string& options_file,
+    const std::string& input_file, const std::optional<std::string>& args_file,
+    const std::optional<std::string>& ir_channel_names_file) {
+  return RunSample(run_dir, options_file, input_file, args_file,
+                   ir_channel_names_file);
+}
+
+// Serves requests to run samples until stdin is closed.
+static absl::Status RealServerMain(
+    const std::string& options_file,
+    const std::optional<std::string>& args_file,
+    const std::optional<std::string>& ir_channel_names_file) {
+  std::string input_file;
+  while (std::getline(std::cin, input_file)) {
+    absl::Status status = RunServerSample(options_file, input_file, args_file,
+                                          ir_channel_names_file);
+    VLOG(1) << "Sample " << input_file << ": " << status;
+    std::cout << (status.ok() ? "0" : "1") << std::endl;
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace xls
 
 int main(int argc, char** argv) {
@@ -98,6 +158,13 @@ int main(int argc, char** argv) {
 
   QCHECK(!absl::GetFlag(FLAGS_options_file).empty())
       << "--options_file is required.";
+  if (absl::GetFlag(FLAGS_server)) {
+    QCHECK(positional_arguments.empty())
+        << "A run directory cannot be given with --server.";
+    return xls::ExitStatus(xls::RealServerMain(
+        absl::GetFlag(FLAGS_options_file), absl::GetFlag(FLAGS_args_file),
+        absl::GetFlag(FLAGS_ir_channel_names_file)));
+  }
   QCHECK(!absl::GetFlag(FLAGS_input_file).empty())
       << "--input_file is required.";
 
@@ -116,7 +116,6 @@ TEST_P(BlockEvaluatorTest, OutputOnlyBlock) {
 }
 
 TEST_P(BlockEvaluatorTest, StatelessInstantiatedPassthrough) {
-  // TODO(rigge): add instantiation support to block jit and remove this guard.
   if (!SupportsHierarchicalBlocks()) {
     GTEST_SKIP();
     return;
@@ -147,7 +146,6 @@ TEST_P(BlockEvaluatorTest, StatelessInstantiatedPassthrough) {
 }
 
 TEST_P(BlockEvaluatorTest, PipelinedHierarchicalRotate) {
-  // TODO(rigge): add instantiation support to block jit and remove this guard.
   if (!SupportsHierarchicalBlocks()) {
     GTEST_SKIP();
     return;
@@ -303,8 +301,8 @@ MATCHER(NoTryPopValue, "") {
 }
 
 TEST_P(BlockEvaluatorTest, SingleElementFifoInstantiationNoBypassWorks) {
-  // TODO(rigge): add instantiation support to block jit and remove this guard.
-  if (!SupportsHierarchicalBlocks()) {
+  // TODO(rigge): add fifo support to block jit and remove this guard.
+  if (!SupportsFifos()) {
     GTEST_SKIP();
     return;
   }
@@ -376,8 +374,8 @@ TEST_P(BlockEvaluatorTest, SingleElementFifoInstantiationNoBypassWorks) {
 }
 
 TEST_P(BlockEvaluatorTest, SingleElementFifoInstantiationWithBypassWorks) {
-  // TODO(rigge): add instantiation support to block jit and remove this guard.
-  if (!SupportsHierarchicalBlocks()) {
+  // TODO(rigge): add fifo support to block jit and remove this guard.
+  if (!SupportsFifos()) {
     GTEST_SKIP();
     return;
   }
@@ -449,8 +447,8 @@ TEST_P(BlockEvaluatorTest, SingleElementFifoInstantiationWithBypassWorks) {
 }
 
 TEST_P(BlockEvaluatorTest, FifoInstantiationNoBypassWorks) {
-  // TODO(rigge): add instantiation support to block jit and remove this guard.
-  if (!SupportsHierarchicalBlocks()) {
+  // TODO(rigge): add fifo support to block jit and remove this guard.
+  if (!SupportsFifos()) {
     GTEST_SKIP();
     return;
   }
@@ -548,8 +546,8 @@ TEST_P(BlockEvaluatorTest, FifoInstantiationNoBypassWorks) {
 }
 
 TEST_P(BlockEvaluatorTest, FifoInstantiationWithBypassWorks) {
-  // TODO(rigge): add instantiation support to block jit and remove this guard.
-  if (!SupportsHierarchicalBlocks()) {
+  // TODO(rigge): add fifo support to block jit and remove this guard.
+  if (!SupportsFifos()) {
     GTEST_SKIP();
     return;
   }
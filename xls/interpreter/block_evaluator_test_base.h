@@ -24,6 +24,7 @@ namespace xls {
 struct BlockEvaluatorTestParam {
   const BlockEvaluator* evaluator;
   bool supports_hierarhical_blocks;
+  bool supports_fifos;
 };
 
 class BlockEvaluatorTest
@@ -35,6 +36,8 @@ class BlockEvaluatorTest
   bool SupportsHierarchicalBlocks() {
     return GetParam().supports_hierarhical_blocks;
   }
+
+  bool SupportsFifos() { return GetParam().supports_fifos; }
 };
 }  // namespace xls
 
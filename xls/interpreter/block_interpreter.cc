@@ -15,16 +15,19 @@
 #include "xls/interpreter/block_interpreter.h"
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -36,6 +39,7 @@
 #include "xls/interpreter/block_evaluator.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
 #include "xls/ir/block.h"
 #include "xls/ir/block_elaboration.h"
 #include "xls/ir/channel.h"
@@ -44,7 +48,10 @@
 #include "xls/ir/instantiation.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/register.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
 
@@ -707,6 +714,498 @@ class ElaboratedBlockInterpreter final : public ElaboratedBlockDfsVisitor {
   BlockInterpreter* current_interpreter_ = nullptr;
 };
 
+// A flat block (one without instantiations) compiled for repeated evaluation.
+// Each node is assigned a slot in a dense value array in topological order and
+// ports and registers are referred to by index, so a cycle is evaluated without
+// any string-keyed or node-keyed lookups. Common bits operations are evaluated
+// directly; the remaining operations are delegated to an IrInterpreter over
+// slot storage. Maps of names to values are only used at the API boundary.
+class CompiledBlockContinuation final : public BlockContinuation {
+ public:
+  // Returns nullptr if the block cannot be compiled or `initial_registers` does
+  // not name exactly the registers of the block, in which case the generic
+  // continuation (which reports the mismatch) should be used.
+  static std::unique_ptr<CompiledBlockContinuation> Create(
+      Block* block,
+      const absl::flat_hash_map<std::string, Value>& initial_registers) {
+    if (!block->GetInstantiations().empty() ||
+        initial_registers.size() != block->GetRegisters().size()) {
+      return nullptr;
+    }
+    for (Register* reg : block->GetRegisters()) {
+      auto it = initial_registers.find(reg->name());
+      if (it == initial_registers.end() ||
+          !ValueConformsToType(it->second, reg->type())) {
+        return nullptr;
+      }
+    }
+    auto continuation =
+        absl::WrapUnique(new CompiledBlockContinuation(block));
+    for (int64_t i = 0; i < block->GetRegisters().size(); ++i) {
+      continuation->registers_[i] =
+          initial_registers.at(block->GetRegisters()[i]->name());
+      *continuation->register_values_[i] = continuation->registers_[i];
+    }
+    return continuation;
+  }
+
+  const absl::flat_hash_map<std::string, Value>& output_ports() final {
+    return output_ports_;
+  }
+  const absl::flat_hash_map<std::string, Value>& registers() final {
+    return register_map_;
+  }
+  const InterpreterEvents& events() final { return events_; }
+
+  absl::Status RunOneCycle(
+      const absl::flat_hash_map<std::string, Value>& inputs) final {
+    int64_t matched_inputs = 0;
+    for (int64_t i = 0; i < input_slots_.size(); ++i) {
+      auto it = inputs.find(input_names_[i]);
+      if (it == inputs.end()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Missing input for port '%s'", input_names_[i]));
+      }
+      // The operations evaluated inline rely on the values having the types
+      // of their nodes.
+      if (!ValueConformsToType(it->second, input_types_[i])) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Value %s for input port '%s' does not have type %s",
+            it->second.ToString(), input_names_[i],
+            input_types_[i]->ToString()));
+      }
+      values_[input_slots_[i]] = it->second;
+      ++matched_inputs;
+    }
+    if (matched_inputs != inputs.size()) {
+      for (const auto& [name, value] : inputs) {
+        // Empty tuples don't have data
+        if (value.GetFlatBitCount() != 0 &&
+            absl::c_find(input_names_, name) == input_names_.end()) {
+          return absl::InvalidArgumentError(
+              absl::StrFormat("Block has no input port '%s'", name));
+        }
+      }
+    }
+
+    events_.Clear();
+    XLS_RETURN_IF_ERROR(Evaluate());
+
+    for (int64_t i = 0; i < output_slots_.size(); ++i) {
+      *output_values_[i] = values_[output_slots_[i]];
+    }
+    for (int64_t reg : written_registers_) {
+      std::swap(registers_[reg], next_registers_[reg]);
+      *register_values_[reg] = registers_[reg];
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status SetRegisters(
+      const absl::flat_hash_map<std::string, Value>& regs) final {
+    XLS_RET_CHECK_EQ(regs.size(), registers_.size());
+    for (const auto& [key, _] : regs) {
+      XLS_RET_CHECK(register_map_.contains(key)) << key;
+    }
+    for (int64_t i = 0; i < registers_.size(); ++i) {
+      Register* reg = block_->GetRegisters()[i];
+      const Value& value = regs.at(reg->name());
+      if (!ValueConformsToType(value, reg->type())) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Value %s for register '%s' does not have type %s",
+                            value.ToString(), reg->name(),
+                            reg->type()->ToString()));
+      }
+    }
+    for (int64_t i = 0; i < registers_.size(); ++i) {
+      registers_[i] = regs.at(block_->GetRegisters()[i]->name());
+      *register_values_[i] = registers_[i];
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  enum class SlotOp : uint8_t {
+    kConstant,
+    kRegisterRead,
+    kRegisterWrite,
+    kIdentity,
+    kAdd,
+    kSub,
+    kAnd,
+    kOr,
+    kXor,
+    kNot,
+    kEq,
+    kNe,
+    kULt,
+    kULe,
+    kUGt,
+    kUGe,
+    kSel,
+    kConcat,
+    kBitSlice,
+    kZeroExt,
+    kSignExt,
+    kTuple,
+    kTupleIndex,
+    // Evaluated by the IrInterpreter.
+    kGeneric,
+  };
+
+  // An operation writing the slot with the same index as the instruction.
+  struct Instruction {
+    SlotOp op;
+    Node* node;
+    // The slots of the operands are operand_slots_[operands_begin,
+    // operands_begin + operand_count).
+    int64_t operands_begin;
+    int64_t operand_count;
+    // The register index for register operations, the number of cases of a
+    // select, or the start, new bit count or tuple index of the operation.
+    int64_t immediate = 0;
+    // The width of a bit slice.
+    int64_t width = 0;
+    // The slots of the load enable and reset of a register write, if any.
+    int64_t load_enable_slot = -1;
+    int64_t reset_slot = -1;
+  };
+
+  explicit CompiledBlockContinuation(Block* block)
+      : block_(block), slots_(block), interpreter_(slots_, &events_) {
+    std::vector<Node*> order = TopoSort(block);
+    absl::flat_hash_map<Node*, int64_t> slot_of;
+    slot_of.reserve(order.size());
+    for (Node* node : order) {
+      slot_of.emplace(node, slot_of.size());
+    }
+    absl::flat_hash_map<Register*, int64_t> register_index;
+    for (Register* reg : block->GetRegisters()) {
+      register_index.emplace(reg, register_index.size());
+    }
+    absl::flat_hash_map<InputPort*, int64_t> input_index;
+    for (InputPort* port : block->GetInputPorts()) {
+      input_index.emplace(port, input_index.size());
+    }
+
+    values_.resize(order.size());
+    input_slots_.resize(block->GetInputPorts().size());
+    for (InputPort* port : block->GetInputPorts()) {
+      input_names_.push_back(port->GetName());
+      input_types_.push_back(port->GetType());
+    }
+    instructions_.reserve(order.size());
+    for (Node* node : order) {
+      Instruction inst{.op = SlotOp::kGeneric,
+                       .node = node,
+                       .operands_begin =
+                           static_cast<int64_t>(operand_slots_.size()),
+                       .operand_count = node->operand_count()};
+      for (Node* operand : node->operands()) {
+        operand_slots_.push_back(slot_of.at(operand));
+      }
+      const bool bits_typed =
+          node->GetType()->IsBits() &&
+          absl::c_all_of(node->operands(),
+                         [](Node* n) { return n->GetType()->IsBits(); });
+      switch (node->op()) {
+        case Op::kInputPort:
+          input_slots_[input_index.at(node->As<InputPort>())] =
+              slot_of.at(node);
+          inst.op = SlotOp::kConstant;
+          break;
+        case Op::kOutputPort:
+          output_slots_.push_back(slot_of.at(node->operand(0)));
+          values_[slot_of.at(node)] = Value::Tuple({});
+          inst.op = SlotOp::kConstant;
+          break;
+        case Op::kLiteral:
+          values_[slot_of.at(node)] = node->As<Literal>()->value();
+          inst.op = SlotOp::kConstant;
+          break;
+        case Op::kRegisterRead:
+          inst.op = SlotOp::kRegisterRead;
+          inst.immediate =
+              register_index.at(node->As<RegisterRead>()->GetRegister());
+          break;
+        case Op::kRegisterWrite: {
+          auto* reg_write = node->As<RegisterWrite>();
+          inst.op = SlotOp::kRegisterWrite;
+          inst.immediate = register_index.at(reg_write->GetRegister());
+          if (reg_write->load_enable().has_value()) {
+            inst.load_enable_slot = slot_of.at(*reg_write->load_enable());
+          }
+          if (reg_write->reset().has_value()) {
+            inst.reset_slot = slot_of.at(*reg_write->reset());
+          }
+          written_registers_.push_back(inst.immediate);
+          values_[slot_of.at(node)] = Value::Tuple({});
+          break;
+        }
+        case Op::kIdentity:
+          inst.op = SlotOp::kIdentity;
+          break;
+        case Op::kEq:
+          inst.op = SlotOp::kEq;
+          break;
+        case Op::kNe:
+          inst.op = SlotOp::kNe;
+          break;
+        case Op::kSel:
+          inst.op = SlotOp::kSel;
+          inst.immediate = node->As<Select>()->cases().size();
+          break;
+        case Op::kTuple:
+          inst.op = SlotOp::kTuple;
+          break;
+        case Op::kTupleIndex:
+          inst.op = SlotOp::kTupleIndex;
+          inst.immediate = node->As<TupleIndex>()->index();
+          break;
+        default:
+          if (bits_typed) {
+            inst.op = BitsSlotOp(node, inst);
+          }
+          break;
+      }
+      instructions_.push_back(inst);
+    }
+
+    registers_.resize(block->GetRegisters().size());
+    next_registers_.resize(block->GetRegisters().size());
+    output_ports_.reserve(block->GetOutputPorts().size());
+    for (OutputPort* port : block->GetOutputPorts()) {
+      output_ports_.emplace(port->GetName(),
+                            ZeroOfType(port->operand(0)->GetType()));
+    }
+    register_map_.reserve(block->GetRegisters().size());
+    for (Register* reg : block->GetRegisters()) {
+      register_map_.emplace(reg->name(), ZeroOfType(reg->type()));
+    }
+    // The maps are not modified after this point so pointers into them are
+    // stable.
+    for (OutputPort* port : block->GetOutputPorts()) {
+      output_values_.push_back(&output_ports_.at(port->GetName()));
+    }
+    for (Register* reg : block->GetRegisters()) {
+      register_values_.push_back(&register_map_.at(reg->name()));
+    }
+  }
+
+  // Returns the operation used for a bits-typed node with bits-typed operands
+  // (other than those handled for all types), filling in its immediates.
+  static SlotOp BitsSlotOp(Node* node, Instruction& inst) {
+    switch (node->op()) {
+      case Op::kAdd:
+        return SlotOp::kAdd;
+      case Op::kSub:
+        return SlotOp::kSub;
+      case Op::kAnd:
+        return SlotOp::kAnd;
+      case Op::kOr:
+        return SlotOp::kOr;
+      case Op::kXor:
+        return SlotOp::kXor;
+      case Op::kNot:
+        return SlotOp::kNot;
+      case Op::kULt:
+        return SlotOp::kULt;
+      case Op::kULe:
+        return SlotOp::kULe;
+      case Op::kUGt:
+        return SlotOp::kUGt;
+      case Op::kUGe:
+        return SlotOp::kUGe;
+      case Op::kConcat:
+        return SlotOp::kConcat;
+      case Op::kBitSlice:
+        inst.immediate = node->As<BitSlice>()->start();
+        inst.width = node->As<BitSlice>()->width();
+        return SlotOp::kBitSlice;
+      case Op::kZeroExt:
+        inst.immediate = node->As<ExtendOp>()->new_bit_count();
+        return SlotOp::kZeroExt;
+      case Op::kSignExt:
+        inst.immediate = node->As<ExtendOp>()->new_bit_count();
+        return SlotOp::kSignExt;
+      default:
+        return SlotOp::kGeneric;
+    }
+  }
+
+  absl::Status Evaluate() {
+    slots_.Clear();
+    for (int64_t i = 0; i < instructions_.size(); ++i) {
+      const Instruction& inst = instructions_[i];
+      const int64_t* operands = operand_slots_.data() + inst.operands_begin;
+      auto operand = [&](int64_t j) -> const Value& {
+        return values_[operands[j]];
+      };
+      auto operand_bits = [&](int64_t j) -> const Bits& {
+        return values_[operands[j]].bits();
+      };
+      switch (inst.op) {
+        case SlotOp::kConstant:
+          break;
+        case SlotOp::kRegisterRead:
+          values_[i] = registers_[inst.immediate];
+          break;
+        case SlotOp::kRegisterWrite: {
+          const int64_t reg = inst.immediate;
+          const Register* reg_ptr = block_->GetRegisters()[reg];
+          if (inst.reset_slot >= 0 &&
+              values_[inst.reset_slot].bits().IsOne() !=
+                  reg_ptr->reset()->active_low) {
+            // Reset is activated. Next register state is the reset value.
+            next_registers_[reg] = reg_ptr->reset()->reset_value;
+          } else if (inst.load_enable_slot >= 0 &&
+                     values_[inst.load_enable_slot].bits().IsZero()) {
+            // Load enable is not activated. Next register state is the
+            // previous register value.
+            next_registers_[reg] = registers_[reg];
+          } else {
+            next_registers_[reg] = operand(0);
+          }
+          break;
+        }
+        case SlotOp::kIdentity:
+          values_[i] = operand(0);
+          break;
+        case SlotOp::kAdd:
+          values_[i] = Value(bits_ops::Add(operand_bits(0), operand_bits(1)));
+          break;
+        case SlotOp::kSub:
+          values_[i] = Value(bits_ops::Sub(operand_bits(0), operand_bits(1)));
+          break;
+        case SlotOp::kAnd:
+        case SlotOp::kOr:
+        case SlotOp::kXor: {
+          Bits result = operand_bits(0);
+          for (int64_t j = 1; j < inst.operand_count; ++j) {
+            if (inst.op == SlotOp::kAnd) {
+              result = bits_ops::And(result, operand_bits(j));
+            } else if (inst.op == SlotOp::kOr) {
+              result = bits_ops::Or(result, operand_bits(j));
+            } else {
+              result = bits_ops::Xor(result, operand_bits(j));
+            }
+          }
+          values_[i] = Value(std::move(result));
+          break;
+        }
+        case SlotOp::kNot:
+          values_[i] = Value(bits_ops::Not(operand_bits(0)));
+          break;
+        case SlotOp::kEq:
+          values_[i] = Value::Bool(operand(0) == operand(1));
+          break;
+        case SlotOp::kNe:
+          values_[i] = Value::Bool(operand(0) != operand(1));
+          break;
+        case SlotOp::kULt:
+          values_[i] = Value::Bool(
+              bits_ops::ULessThan(operand_bits(0), operand_bits(1)));
+          break;
+        case SlotOp::kULe:
+          values_[i] = Value::Bool(
+              bits_ops::ULessThanOrEqual(operand_bits(0), operand_bits(1)));
+          break;
+        case SlotOp::kUGt:
+          values_[i] = Value::Bool(
+              bits_ops::UGreaterThan(operand_bits(0), operand_bits(1)));
+          break;
+        case SlotOp::kUGe:
+          values_[i] = Value::Bool(
+              bits_ops::UGreaterThanOrEqual(operand_bits(0), operand_bits(1)));
+          break;
+        case SlotOp::kSel: {
+          // Operands are the selector, the cases and the optional default.
+          const Bits& selector = operand_bits(0);
+          const int64_t case_count = inst.immediate;
+          if (bits_ops::ULessThan(selector, case_count)) {
+            XLS_ASSIGN_OR_RETURN(uint64_t index, selector.ToUint64());
+            values_[i] = operand(1 + index);
+          } else {
+            XLS_RET_CHECK_EQ(inst.operand_count, case_count + 2);
+            values_[i] = operand(case_count + 1);
+          }
+          break;
+        }
+        case SlotOp::kConcat: {
+          std::vector<Bits> bits;
+          bits.reserve(inst.operand_count);
+          for (int64_t j = 0; j < inst.operand_count; ++j) {
+            bits.push_back(operand_bits(j));
+          }
+          values_[i] = Value(bits_ops::Concat(bits));
+          break;
+        }
+        case SlotOp::kBitSlice:
+          values_[i] =
+              Value(operand_bits(0).Slice(inst.immediate, inst.width));
+          break;
+        case SlotOp::kZeroExt:
+          values_[i] =
+              Value(bits_ops::ZeroExtend(operand_bits(0), inst.immediate));
+          break;
+        case SlotOp::kSignExt:
+          values_[i] =
+              Value(bits_ops::SignExtend(operand_bits(0), inst.immediate));
+          break;
+        case SlotOp::kTuple: {
+          std::vector<Value> elements;
+          elements.reserve(inst.operand_count);
+          for (int64_t j = 0; j < inst.operand_count; ++j) {
+            elements.push_back(operand(j));
+          }
+          values_[i] = Value::TupleOwned(std::move(elements));
+          break;
+        }
+        case SlotOp::kTupleIndex:
+          values_[i] = operand(0).element(inst.immediate);
+          break;
+        case SlotOp::kGeneric: {
+          for (int64_t j = 0; j < inst.operand_count; ++j) {
+            Node* operand_node = inst.node->operand(j);
+            if (!slots_.Contains(operand_node)) {
+              slots_.Set(operand_node, operand(j));
+            }
+          }
+          XLS_RETURN_IF_ERROR(inst.node->VisitSingleNode(&interpreter_));
+          values_[i] = slots_.Get(inst.node);
+          break;
+        }
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  Block* block_;
+  InterpreterEvents events_;
+  NodeValueSlots slots_;
+  IrInterpreter interpreter_;
+
+  std::vector<Instruction> instructions_;
+  std::vector<int64_t> operand_slots_;
+  // The value of each node, indexed by slot.
+  std::vector<Value> values_;
+
+  // Indexed by port or register index in the block.
+  std::vector<std::string> input_names_;
+  std::vector<Type*> input_types_;
+  std::vector<int64_t> input_slots_;
+  std::vector<int64_t> output_slots_;
+  std::vector<Value> registers_;
+  std::vector<Value> next_registers_;
+  // The indices of registers which are written each cycle.
+  std::vector<int64_t> written_registers_;
+
+  absl::flat_hash_map<std::string, Value> output_ports_;
+  absl::flat_hash_map<std::string, Value> register_map_;
+  std::vector<Value*> output_values_;
+  std::vector<Value*> register_values_;
+};
+
 }  // namespace
 
 absl::StatusOr<BlockRunResult> BlockRun(
@@ -774,4 +1273,39 @@ absl::StatusOr<BlockRunResult> BlockRun(
   return result;
 }
 
+absl::StatusOr<std::vector<absl::flat_hash_map<std::string, Value>>>
+InterpreterBlockEvaluator::EvaluateSequentialBlock(
+    Block* block,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const {
+  if (!block->GetInstantiations().empty()) {
+    return BlockEvaluator::EvaluateSequentialBlock(block, inputs);
+  }
+  // Initial register state is zero for all registers.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<BlockContinuation> continuation,
+                       NewContinuation(block));
+  std::vector<absl::flat_hash_map<std::string, Value>> outputs;
+  outputs.reserve(inputs.size());
+  for (const absl::flat_hash_map<std::string, Value>& input_set : inputs) {
+    XLS_RETURN_IF_ERROR(continuation->RunOneCycle(input_set));
+    outputs.push_back(continuation->output_ports());
+  }
+  return outputs;
+}
+
+absl::StatusOr<std::unique_ptr<BlockContinuation>>
+InterpreterBlockEvaluator::NewContinuation(
+    BlockElaboration&& elaboration,
+    const absl::flat_hash_map<std::string, Value>& initial_registers) const {
+  if (elaboration.instances().size() == 1) {
+    std::unique_ptr<CompiledBlockContinuation> continuation =
+        CompiledBlockContinuation::Create(*elaboration.top()->block(),
+                                          initial_registers);
+    if (continuation != nullptr) {
+      return continuation;
+    }
+  }
+  return BlockEvaluator::NewContinuation(std::move(elaboration),
+                                         initial_registers);
+}
+
 }  // namespace xls
@@ -16,6 +16,7 @@
 #define XLS_INTERPRETER_BLOCK_INTERPRETER_H_
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -48,6 +49,29 @@ class InterpreterBlockEvaluator final : public BlockEvaluator {
       const BlockElaboration& elaboration) const final {
     return BlockRun(inputs, registers, elaboration);
   }
+
+  // Blocks without instantiations are evaluated by a continuation which
+  // compiles the block once into a flat program (see NewContinuation below)
+  // rather than interpreting the block from scratch each cycle.
+  absl::StatusOr<std::vector<absl::flat_hash_map<std::string, Value>>>
+  EvaluateSequentialBlock(
+      Block* block,
+      absl::Span<const absl::flat_hash_map<std::string, Value>> inputs)
+      const final;
+  using BlockEvaluator::EvaluateSequentialBlock;
+
+  // Expose the overloads without `elaboration`.
+  using BlockEvaluator::NewContinuation;
+
+ protected:
+  // Blocks without instantiations are compiled into a program over a dense
+  // array of node values with ports and registers addressed by index; the
+  // name-keyed maps are only used to pass values in and out each cycle. Other
+  // blocks use the generic continuation which calls BlockRun every cycle.
+  absl::StatusOr<std::unique_ptr<BlockContinuation>> NewContinuation(
+      BlockElaboration&& elaboration,
+      const absl::flat_hash_map<std::string, Value>& initial_registers)
+      const final;
 };
 
 // Runs the interpreter on a combinational block. `inputs` must contain a
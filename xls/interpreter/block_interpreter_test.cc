@@ -14,10 +14,25 @@
 
 #include "xls/interpreter/block_interpreter.h"
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/block_evaluator.h"
 #include "xls/interpreter/block_evaluator_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/block_elaboration.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/register.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 namespace {
@@ -25,10 +40,89 @@ namespace {
 INSTANTIATE_TEST_SUITE_P(BlockInterpreterTest, BlockEvaluatorTest,
                          testing::Values(BlockEvaluatorTestParam{
                              .evaluator = &kInterpreterBlockEvaluator,
-                             .supports_hierarhical_blocks = true}),
+                             .supports_hierarhical_blocks = true,
+                             .supports_fifos = true}),
                          [](const auto& v) -> std::string {
                            return std::string(v.param.evaluator->name());
                          });
 
+class CompiledBlockTest : public IrTestBase {};
+
+// Checks that the compiled continuation used for flat blocks matches BlockRun
+// cycle by cycle, including operations delegated to the generic interpreter.
+TEST_F(CompiledBlockTest, MatchesBlockRun) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  BValue x = b.InputPort("x", package->GetBitsType(16));
+  BValue y = b.InputPort("y", package->GetBitsType(16));
+  BValue en = b.InputPort("en", package->GetBitsType(1));
+  BValue rst = b.InputPort("rst", package->GetBitsType(1));
+
+  BValue acc = b.InsertRegister(
+      "acc", b.Add(x, b.UMul(x, y, 16)), rst,
+      Reset{Value(UBits(7, 16)), /*asynchronous=*/false, /*active_low=*/false},
+      en);
+  BValue prev = b.InsertRegister("prev", b.Sub(x, acc));
+  BValue tuple = b.Tuple({b.Xor(x, acc), b.Not(prev)});
+  BValue sel = b.Select(b.BitSlice(acc, 0, 2),
+                        {b.TupleIndex(tuple, 0), b.TupleIndex(tuple, 1),
+                         b.And({x, y, acc})},
+                        b.Or(y, prev));
+  b.OutputPort("sel", sel);
+  b.OutputPort("cmp", b.Concat({b.ULt(x, acc), b.Eq(y, prev),
+                                b.SignExtend(b.BitSlice(x, 12, 4), 8)}));
+  b.OutputPort("wide", b.ZeroExtend(b.Shll(acc, y), 40));
+  b.Assert(b.ULt(x, b.Literal(UBits(1000, 16))), "x is too large");
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(BlockElaboration elaboration,
+                           BlockElaboration::Elaborate(block));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BlockContinuation> continuation,
+      kInterpreterBlockEvaluator.NewContinuation(block));
+  absl::flat_hash_map<std::string, Value> reg_state = continuation->registers();
+  for (int64_t cycle = 0; cycle < 64; ++cycle) {
+    absl::flat_hash_map<std::string, Value> inputs = {
+        {"x", Value(UBits((cycle * 37 + 5) % 1200, 16))},
+        {"y", Value(UBits(cycle * 11, 16))},
+        {"en", Value(UBits(cycle % 3 != 0, 1))},
+        {"rst", Value(UBits(cycle % 17 == 1, 1))}};
+    XLS_ASSERT_OK_AND_ASSIGN(BlockRunResult expected,
+                             BlockRun(inputs, reg_state, elaboration));
+    XLS_ASSERT_OK(continuation->RunOneCycle(inputs));
+    EXPECT_EQ(continuation->output_ports(), expected.outputs) << cycle;
+    EXPECT_EQ(continuation->registers(), expected.reg_state) << cycle;
+    EXPECT_EQ(continuation->events().assert_msgs,
+              expected.interpreter_events.assert_msgs)
+        << cycle;
+    reg_state = std::move(expected.reg_state);
+  }
+}
+
+TEST_F(CompiledBlockTest, InputAndRegisterErrors) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  BValue x = b.InputPort("x", package->GetBitsType(8));
+  b.OutputPort("out", b.InsertRegister("r", x));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BlockContinuation> continuation,
+      kInterpreterBlockEvaluator.NewContinuation(block));
+  EXPECT_THAT(continuation->RunOneCycle({{"x", Value(UBits(1, 4))}}),
+              status_testing::StatusIs(
+                  absl::StatusCode::kInvalidArgument,
+                  testing::HasSubstr("does not have type bits[8]")));
+  EXPECT_THAT(continuation->SetRegisters({{"r", Value::Tuple({})}}),
+              status_testing::StatusIs(absl::StatusCode::kInvalidArgument,
+                                       testing::HasSubstr("register 'r'")));
+  XLS_ASSERT_OK(continuation->SetRegisters({{"r", Value(UBits(3, 8))}}));
+  XLS_ASSERT_OK(continuation->RunOneCycle({{"x", Value(UBits(9, 8))}}));
+  EXPECT_EQ(continuation->output_ports().at("out"), Value(UBits(3, 8)));
+  EXPECT_EQ(continuation->registers().at("r"), Value(UBits(9, 8)));
+}
+
 }  // namespace
 }  // namespace xls
@@ -38,6 +38,76 @@
 #include "xls/ir/value_utils.h"
 
 namespace xls {
+namespace {
+
+// Returns a well-mixed hash of `x` (the splitmix64 finalizer), used as a
+// stateless source of randomness for reservoir sampling.
+uint64_t MixBits(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+}  // namespace
+
+void ChannelActivityCounters::RecordWrite() {
+  int64_t writes = writes_.fetch_add(1, std::memory_order_relaxed) + 1;
+  int64_t occupancy =
+      is_single_value_ ? 1 : writes - reads_.load(std::memory_order_relaxed);
+  int64_t max_occupancy = max_occupancy_.load(std::memory_order_relaxed);
+  while (occupancy > max_occupancy &&
+         !max_occupancy_.compare_exchange_weak(max_occupancy, occupancy,
+                                               std::memory_order_relaxed)) {
+  }
+}
+
+std::optional<int64_t> ChannelActivityCounters::RecordRead() {
+  // Zero-based index of this read among all reads.
+  int64_t index = reads_.fetch_add(1, std::memory_order_relaxed);
+  if (index < reservoir_size_) {
+    return index;
+  }
+  // Reservoir sampling (Algorithm R): the value replaces a random slot with
+  // probability reservoir_size / (index + 1).
+  int64_t slot =
+      static_cast<int64_t>(MixBits(index) % static_cast<uint64_t>(index + 1));
+  if (slot < reservoir_size_) {
+    return slot;
+  }
+  return std::nullopt;
+}
+
+void ChannelActivityCounters::SampleValue(int64_t slot, Value value) {
+  absl::MutexLock lock(&reservoir_mutex_);
+  if (reservoir_.size() <= slot) {
+    reservoir_.resize(slot + 1);
+  }
+  reservoir_[slot] = std::move(value);
+}
+
+ChannelActivity ChannelActivityCounters::Get() const {
+  absl::MutexLock lock(&reservoir_mutex_);
+  return ChannelActivity{
+      .writes = writes_.load(std::memory_order_relaxed),
+      .reads = reads_.load(std::memory_order_relaxed),
+      .empty_reads = empty_reads_.load(std::memory_order_relaxed),
+      .max_occupancy = max_occupancy_.load(std::memory_order_relaxed),
+      .sampled_values = reservoir_,
+  };
+}
+
+void ChannelQueue::EnableActivityCounting(int64_t reservoir_size) {
+  activity_ = std::make_unique<ChannelActivityCounters>(
+      reservoir_size, channel()->kind() == ChannelKind::kSingleValue);
+}
+
+std::optional<ChannelActivity> ChannelQueue::GetActivity() const {
+  if (activity_ == nullptr) {
+    return std::nullopt;
+  }
+  return activity_->Get();
+}
 
 absl::Status ChannelQueue::AttachGenerator(GeneratorFn generator) {
   absl::MutexLock lock(&mutex_);
@@ -70,6 +140,9 @@ absl::Status ChannelQueue::Write(const Value& value) {
   }
 
   WriteInternal(value);
+  if (activity_ != nullptr) {
+    activity_->RecordWrite();
+  }
   VLOG(4) << absl::StreamFormat("Channel now has %d elements", queue_.size());
   return absl::OkStatus();
 }
@@ -96,9 +169,20 @@ std::optional<Value> ChannelQueue::Read() {
     std::optional<Value> generated_value = (*generator_)();
     if (generated_value.has_value()) {
       WriteInternal(generated_value.value());
+      if (activity_ != nullptr) {
+        activity_->RecordWrite();
+      }
     }
   }
   std::optional<Value> value = ReadInternal();
+  if (activity_ != nullptr) {
+    if (!value.has_value()) {
+      activity_->RecordEmptyRead();
+    } else if (std::optional<int64_t> slot = activity_->RecordRead();
+               slot.has_value()) {
+      activity_->SampleValue(*slot, *value);
+    }
+  }
   VLOG(4) << absl::StreamFormat(
       "Reading data from channel instance %s: %s",
       channel_instance()->ToString(),
@@ -107,6 +191,52 @@ std::optional<Value> ChannelQueue::Read() {
   return value;
 }
 
+std::vector<Value> ChannelQueue::GetContents() {
+  absl::MutexLock lock(&mutex_);
+  // Queues may store values in other forms (e.g., the native layout of the
+  // JIT) so read the values out and write them back in the same order.
+  int64_t size = GetSizeInternal();
+  std::vector<Value> values;
+  values.reserve(size);
+  for (int64_t i = 0; i < size; ++i) {
+    values.push_back(ReadInternal().value());
+  }
+  for (const Value& value : values) {
+    WriteInternal(value);
+  }
+  return values;
+}
+
+absl::Status ChannelQueue::SetContents(absl::Span<const Value> values) {
+  absl::MutexLock lock(&mutex_);
+  for (const Value& value : values) {
+    if (!ValueConformsToType(value, channel()->type())) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Channel `%s` expects values to have type %s, got: %s",
+          channel()->name(), channel()->type()->ToString(), value.ToString()));
+    }
+  }
+  if (channel()->kind() == ChannelKind::kSingleValue) {
+    if (values.size() > 1) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Single-value channel `%s` cannot hold %d values", channel()->name(),
+          values.size()));
+    }
+    if (values.empty() && GetSizeInternal() != 0) {
+      return absl::FailedPreconditionError(absl::StrFormat(
+          "Single-value channel `%s` cannot be emptied", channel()->name()));
+    }
+  } else {
+    while (GetSizeInternal() > 0) {
+      ReadInternal();
+    }
+  }
+  for (const Value& value : values) {
+    WriteInternal(value);
+  }
+  return absl::OkStatus();
+}
+
 int64_t ChannelQueue::GetSizeInternal() const { return queue_.size(); }
 
 std::optional<Value> ChannelQueue::ReadInternal() {
@@ -15,6 +15,7 @@
 #ifndef XLS_INTERPRETER_CHANNEL_QUEUE_H_
 #define XLS_INTERPRETER_CHANNEL_QUEUE_H_
 
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <functional>
@@ -37,6 +38,57 @@
 
 namespace xls {
 
+// Summary of the traffic through a channel queue, collected when activity
+// counting is enabled on the queue.
+struct ChannelActivity {
+  // Number of values written to the channel.
+  int64_t writes = 0;
+  // Number of values read from the channel.
+  int64_t reads = 0;
+  // Number of reads which found the channel empty, e.g., activations in which
+  // a receive stalled waiting on the channel.
+  int64_t empty_reads = 0;
+  // Largest number of elements held by the channel at once.
+  int64_t max_occupancy = 0;
+  // A uniformly random sample of the values read from the channel.
+  std::vector<Value> sampled_values;
+};
+
+// Counters of channel activity which are cheap enough to update on every
+// transfer: counts are relaxed atomics and a value is only copied when it is
+// selected for the reservoir sample, which is bounded in size regardless of
+// the length of the run.
+class ChannelActivityCounters {
+ public:
+  ChannelActivityCounters(int64_t reservoir_size, bool is_single_value)
+      : reservoir_size_(reservoir_size), is_single_value_(is_single_value) {}
+
+  void RecordWrite();
+  void RecordEmptyRead() {
+    empty_reads_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Records a successful read. Returns the reservoir slot in which the value
+  // read should be stored with `SampleValue`, or std::nullopt if the value is
+  // not sampled.
+  std::optional<int64_t> RecordRead();
+  void SampleValue(int64_t slot, Value value);
+
+  ChannelActivity Get() const;
+
+ private:
+  int64_t reservoir_size_;
+  bool is_single_value_;
+
+  std::atomic<int64_t> writes_ = 0;
+  std::atomic<int64_t> reads_ = 0;
+  std::atomic<int64_t> empty_reads_ = 0;
+  std::atomic<int64_t> max_occupancy_ = 0;
+
+  mutable absl::Mutex reservoir_mutex_;
+  std::vector<Value> reservoir_ ABSL_GUARDED_BY(reservoir_mutex_);
+};
+
 // Abstract base class for queues which represent channels during IR
 // interpretation. During interpretation of a network of procs each channel
 // instance is backed by exactly one ChannelQueue. ChannelQueues are
@@ -76,15 +128,38 @@ class ChannelQueue {
   // the channel is empty.
   std::optional<Value> Read();
 
+  // Returns the values in the queue, oldest first, leaving the queue
+  // unchanged. Neither this nor SetContents calls an attached generator or
+  // counts as activity on the queue.
+  std::vector<Value> GetContents();
+
+  // Replaces the values in the queue with `values`. A single-value channel
+  // which holds a value cannot be made empty.
+  absl::Status SetContents(absl::Span<const Value> values);
+
   // Attaches a function which generates values for the channel. The generator
   // is called when a value is needed for reading. If a generator is attached
   // then calling `Write` returns an error.
   using GeneratorFn = std::function<std::optional<Value>()>;
   absl::Status AttachGenerator(GeneratorFn generator);
 
+  // Enables counting of the transfers through the queue and sampling of up to
+  // `reservoir_size` of the values read from it. Must be called before the
+  // queue is used.
+  void EnableActivityCounting(int64_t reservoir_size);
+
+  // Returns the activity on the queue since counting was enabled, or
+  // std::nullopt if it is not enabled.
+  std::optional<ChannelActivity> GetActivity() const;
+
  protected:
   mutable absl::Mutex mutex_;
 
+  // Non-null if activity counting is enabled. Counters are updated by the
+  // public Read/Write methods; derived queues with other access paths must
+  // update them as well.
+  std::unique_ptr<ChannelActivityCounters> activity_;
+
   virtual int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_);
   virtual void WriteInternal(const Value& value)
       ABSL_SHARED_LOCKS_REQUIRED(mutex_);
@@ -71,6 +71,42 @@ TEST_P(ChannelQueueTestBase, FifoChannelQueueTest) {
   EXPECT_EQ(queue->Read(), std::nullopt);
 }
 
+TEST_P(ChannelQueueTestBase, ActivityCounting) {
+  Package package(TestName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+  auto queue =
+      GetParam().CreateQueue(elaboration.GetUniqueInstance(channel).value());
+  EXPECT_EQ(queue->GetActivity(), std::nullopt);
+
+  constexpr int64_t kReservoirSize = 4;
+  queue->EnableActivityCounting(kReservoirSize);
+  EXPECT_EQ(queue->Read(), std::nullopt);
+  for (int64_t i = 0; i < 100; ++i) {
+    XLS_ASSERT_OK(queue->Write(Value(UBits(i, 32))));
+    XLS_ASSERT_OK(queue->Write(Value(UBits(i, 32))));
+    EXPECT_TRUE(queue->Read().has_value());
+  }
+  while (queue->Read().has_value()) {
+  }
+
+  std::optional<ChannelActivity> activity = queue->GetActivity();
+  ASSERT_TRUE(activity.has_value());
+  EXPECT_EQ(activity->writes, 200);
+  EXPECT_EQ(activity->reads, 200);
+  EXPECT_EQ(activity->empty_reads, 2);
+  EXPECT_EQ(activity->max_occupancy, 101);
+  EXPECT_EQ(activity->sampled_values.size(), kReservoirSize);
+  for (const Value& value : activity->sampled_values) {
+    ASSERT_TRUE(value.IsBits());
+    EXPECT_LT(value.bits().ToUint64().value(), 100);
+  }
+}
+
 TEST_P(ChannelQueueTestBase, SingleValueChannelQueueTest) {
   Package package(TestName());
   XLS_ASSERT_OK_AND_ASSIGN(
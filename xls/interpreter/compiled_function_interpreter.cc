@@ -0,0 +1,249 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/interpreter/compiled_function_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+/* static */ absl::StatusOr<std::unique_ptr<CompiledFunctionInterpreter>>
+CompiledFunctionInterpreter::Create(Function* function) {
+  auto interpreter =
+      absl::WrapUnique(new CompiledFunctionInterpreter(function));
+  absl::flat_hash_map<Node*, int64_t> slot_of;
+  for (Node* node : TopoSort(function)) {
+    int64_t slot = interpreter->slots_.size();
+    slot_of[node] = slot;
+    if (node->Is<Literal>()) {
+      interpreter->slots_.push_back(node->As<Literal>()->value());
+      continue;
+    }
+    interpreter->slots_.push_back(Value());
+    if (node->Is<Param>()) {
+      continue;
+    }
+    Instruction instruction{.node = node, .slot = slot};
+    instruction.operand_slots.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      instruction.operand_slots.push_back(slot_of.at(operand));
+    }
+    interpreter->instructions_.push_back(std::move(instruction));
+  }
+  for (Param* param : function->params()) {
+    interpreter->param_slots_.push_back(slot_of.at(param));
+  }
+  interpreter->return_slot_ = slot_of.at(function->return_value());
+  return interpreter;
+}
+
+absl::StatusOr<InterpreterResult<Value>> CompiledFunctionInterpreter::Run(
+    absl::Span<const Value> args) {
+  if (args.size() != param_slots_.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Function `%s` (type: `%s`) wants %d arguments, got %d.",
+        function_->name(), function_->GetType()->ToString(),
+        param_slots_.size(), args.size()));
+  }
+  for (int64_t argno = 0; argno < args.size(); ++argno) {
+    Type* param_type = function_->param(argno)->GetType();
+    if (function_->package()->GetTypeForValue(args[argno]) != param_type) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Got argument %s for parameter %d which is not of type %s",
+          args[argno].ToString(), argno, param_type->ToString()));
+    }
+    slots_[param_slots_[argno]] = args[argno];
+  }
+
+  // Only nodes without a direct implementation (and their operands) are
+  // entered into the fallback interpreter's map.
+  absl::flat_hash_map<Node*, Value> fallback_values;
+  InterpreterEvents events;
+  IrInterpreter fallback(&fallback_values, &events);
+  for (const Instruction& instruction : instructions_) {
+    if (!TryExecuteDirectly(instruction)) {
+      XLS_RETURN_IF_ERROR(ExecuteWithFallback(instruction, fallback));
+    }
+  }
+  return InterpreterResult<Value>{slots_[return_slot_], std::move(events)};
+}
+
+bool CompiledFunctionInterpreter::TryExecuteDirectly(
+    const Instruction& instruction) {
+  Node* node = instruction.node;
+  Value& result = slots_[instruction.slot];
+  auto bits = [&](int64_t i) -> const Bits& {
+    return operand(instruction, i).bits();
+  };
+  auto nary_bits = [&]() {
+    std::vector<Bits> operands;
+    operands.reserve(instruction.operand_slots.size());
+    for (int64_t i = 0; i < instruction.operand_slots.size(); ++i) {
+      operands.push_back(bits(i));
+    }
+    return operands;
+  };
+  switch (node->op()) {
+    case Op::kIdentity:
+      result = operand(instruction, 0);
+      return true;
+    case Op::kAdd:
+      result = Value(bits_ops::Add(bits(0), bits(1)));
+      return true;
+    case Op::kSub:
+      result = Value(bits_ops::Sub(bits(0), bits(1)));
+      return true;
+    case Op::kNeg:
+      result = Value(bits_ops::Negate(bits(0)));
+      return true;
+    case Op::kNot:
+      result = Value(bits_ops::Not(bits(0)));
+      return true;
+    case Op::kAnd:
+      result = Value(instruction.operand_slots.size() == 2
+                         ? bits_ops::And(bits(0), bits(1))
+                         : bits_ops::NaryAnd(nary_bits()));
+      return true;
+    case Op::kOr:
+      result = Value(instruction.operand_slots.size() == 2
+                         ? bits_ops::Or(bits(0), bits(1))
+                         : bits_ops::NaryOr(nary_bits()));
+      return true;
+    case Op::kXor:
+      result = Value(instruction.operand_slots.size() == 2
+                         ? bits_ops::Xor(bits(0), bits(1))
+                         : bits_ops::NaryXor(nary_bits()));
+      return true;
+    case Op::kEq:
+      result = Value::Bool(operand(instruction, 0) == operand(instruction, 1));
+      return true;
+    case Op::kNe:
+      result = Value::Bool(operand(instruction, 0) != operand(instruction, 1));
+      return true;
+    case Op::kULt:
+      result = Value::Bool(bits_ops::ULessThan(bits(0), bits(1)));
+      return true;
+    case Op::kULe:
+      result = Value::Bool(bits_ops::ULessThanOrEqual(bits(0), bits(1)));
+      return true;
+    case Op::kUGt:
+      result = Value::Bool(bits_ops::UGreaterThan(bits(0), bits(1)));
+      return true;
+    case Op::kUGe:
+      result = Value::Bool(bits_ops::UGreaterThanOrEqual(bits(0), bits(1)));
+      return true;
+    case Op::kSLt:
+      result = Value::Bool(bits_ops::SLessThan(bits(0), bits(1)));
+      return true;
+    case Op::kSLe:
+      result = Value::Bool(bits_ops::SLessThanOrEqual(bits(0), bits(1)));
+      return true;
+    case Op::kSGt:
+      result = Value::Bool(bits_ops::SGreaterThan(bits(0), bits(1)));
+      return true;
+    case Op::kSGe:
+      result = Value::Bool(bits_ops::SGreaterThanOrEqual(bits(0), bits(1)));
+      return true;
+    case Op::kConcat:
+      result = Value(bits_ops::Concat(nary_bits()));
+      return true;
+    case Op::kBitSlice: {
+      BitSlice* bit_slice = node->As<BitSlice>();
+      result = Value(bits(0).Slice(bit_slice->start(), bit_slice->width()));
+      return true;
+    }
+    case Op::kZeroExt:
+      result = Value(bits_ops::ZeroExtend(
+          bits(0), node->As<ExtendOp>()->new_bit_count()));
+      return true;
+    case Op::kSignExt:
+      result = Value(bits_ops::SignExtend(
+          bits(0), node->As<ExtendOp>()->new_bit_count()));
+      return true;
+    case Op::kSel: {
+      Select* sel = node->As<Select>();
+      const Bits& selector = bits(0);
+      const int64_t case_count = sel->cases().size();
+      // Operand 0 is the selector, followed by the cases and the optional
+      // default value.
+      if (bits_ops::UGreaterThan(selector,
+                                 UBits(case_count - 1, selector.bit_count()))) {
+        if (!sel->default_value().has_value()) {
+          // Malformed; let the fallback report the error.
+          return false;
+        }
+        result = operand(instruction, case_count + 1);
+      } else {
+        result = operand(instruction, 1 + selector.ToUint64().value());
+      }
+      return true;
+    }
+    case Op::kTuple: {
+      std::vector<Value> elements;
+      elements.reserve(instruction.operand_slots.size());
+      for (int64_t slot : instruction.operand_slots) {
+        elements.push_back(slots_[slot]);
+      }
+      result = Value::TupleOwned(std::move(elements));
+      return true;
+    }
+    case Op::kTupleIndex:
+      result = operand(instruction, 0).element(node->As<TupleIndex>()->index());
+      return true;
+    default:
+      return false;
+  }
+}
+
+absl::Status CompiledFunctionInterpreter::ExecuteWithFallback(
+    const Instruction& instruction, IrInterpreter& fallback) {
+  Node* node = instruction.node;
+  for (int64_t i = 0; i < node->operand_count(); ++i) {
+    // Operands may be duplicated or already entered by an earlier fallback.
+    if (!fallback.HasResult(node->operand(i))) {
+      XLS_RETURN_IF_ERROR(
+          fallback.SetValueResult(node->operand(i), operand(instruction, i)));
+    }
+  }
+  XLS_RETURN_IF_ERROR(node->VisitSingleNode(&fallback));
+  // Some side-effecting operations (e.g., cover) produce no value.
+  slots_[instruction.slot] =
+      fallback.HasResult(node) ? fallback.ResolveAsValue(node) : Value();
+  return absl::OkStatus();
+}
+
+}  // namespace xls
@@ -0,0 +1,88 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_INTERPRETER_COMPILED_FUNCTION_INTERPRETER_H_
+#define XLS_INTERPRETER_COMPILED_FUNCTION_INTERPRETER_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// An interpreter for XLS functions which flattens the function once into a
+// topologically ordered instruction array in which each node's value lives in
+// a dense slot index, rather than visiting the graph and looking values up in
+// a hash map on every invocation. Literals are evaluated when the interpreter
+// is created and value slots are reused across invocations. Common bits and
+// tuple operations are evaluated directly on the slots; all other operations
+// are delegated to an IrInterpreter so the results (and events) are the same
+// as those of InterpretFunction.
+//
+// This pays off when the same function is evaluated many times, e.g. for each
+// of a set of inputs. Run is not thread-safe.
+class CompiledFunctionInterpreter {
+ public:
+  static absl::StatusOr<std::unique_ptr<CompiledFunctionInterpreter>> Create(
+      Function* function);
+
+  // Evaluates the function on the given arguments.
+  absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
+
+  Function* function() const { return function_; }
+
+ private:
+  struct Instruction {
+    Node* node;
+    int64_t slot;
+    std::vector<int64_t> operand_slots;
+  };
+
+  explicit CompiledFunctionInterpreter(Function* function)
+      : function_(function) {}
+
+  // Evaluates `instruction` directly on the value slots. Returns false if the
+  // operation has no direct implementation.
+  bool TryExecuteDirectly(const Instruction& instruction);
+
+  // Evaluates `instruction` with `fallback`, seeding it with the operand
+  // values.
+  absl::Status ExecuteWithFallback(const Instruction& instruction,
+                                   IrInterpreter& fallback);
+
+  const Value& operand(const Instruction& instruction, int64_t i) const {
+    return slots_[instruction.operand_slots[i]];
+  }
+
+  Function* function_;
+  std::vector<Instruction> instructions_;
+  // Slot indices of the parameters in order.
+  std::vector<int64_t> param_slots_;
+  int64_t return_slot_ = 0;
+  std::vector<Value> slots_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_COMPILED_FUNCTION_INTERPRETER_H_
@@ -0,0 +1,132 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/interpreter/compiled_function_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/ir_evaluator_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/keyword_args.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::xls::status_testing::StatusIs;
+
+INSTANTIATE_TEST_SUITE_P(
+    CompiledFunctionInterpreterTest, IrEvaluatorTestBase,
+    testing::Values(IrEvaluatorTestParam(
+        [](Function* function, absl::Span<const Value> args)
+            -> absl::StatusOr<InterpreterResult<Value>> {
+          XLS_ASSIGN_OR_RETURN(
+              std::unique_ptr<CompiledFunctionInterpreter> interpreter,
+              CompiledFunctionInterpreter::Create(function));
+          return interpreter->Run(args);
+        },
+        [](Function* function,
+           const absl::flat_hash_map<std::string, Value>& kwargs)
+            -> absl::StatusOr<InterpreterResult<Value>> {
+          XLS_ASSIGN_OR_RETURN(std::vector<Value> args,
+                               KeywordArgsToPositional(*function, kwargs));
+          XLS_ASSIGN_OR_RETURN(
+              std::unique_ptr<CompiledFunctionInterpreter> interpreter,
+              CompiledFunctionInterpreter::Create(function));
+          return interpreter->Run(args);
+        })));
+
+class CompiledFunctionInterpreterOnlyTest : public IrTestBase {};
+
+TEST_F(CompiledFunctionInterpreterOnlyTest, ReusedAcrossInvocations) {
+  Package package(TestName());
+  // Mixes directly evaluated operations with ones handled by the fallback
+  // interpreter (umul, array_index, trace).
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, Parser::ParseFunction(R"(
+    fn f(tkn: token, x: bits[8], y: bits[8]) -> (bits[8], bits[16], bits[1]) {
+      literal.1: bits[8] = literal(value=3)
+      add.2: bits[8] = add(x, literal.1)
+      umul.3: bits[16] = umul(add.2, y)
+      array.4: bits[8][2] = array(x, y)
+      ult.5: bits[1] = ult(x, y)
+      array_index.6: bits[8] = array_index(array.4, indices=[ult.5])
+      trace.7: token = trace(tkn, ult.5, format="x={}", data_operands=[x])
+      ret tuple.8: (bits[8], bits[16], bits[1]) = tuple(array_index.6, umul.3, ult.5)
+    }
+  )",
+                                                                 &package));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CompiledFunctionInterpreter> interpreter,
+      CompiledFunctionInterpreter::Create(function));
+  for (int64_t x = 0; x < 256; x += 7) {
+    for (int64_t y = 0; y < 256; y += 11) {
+      std::vector<Value> args = {Value::Token(), Value(UBits(x, 8)),
+                                 Value(UBits(y, 8))};
+      XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                               InterpretFunction(function, args));
+      XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> actual,
+                               interpreter->Run(args));
+      EXPECT_EQ(actual.value, expected.value);
+      EXPECT_EQ(actual.events.trace_msgs.size(),
+                expected.events.trace_msgs.size());
+    }
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpreterResult<Value> result,
+      interpreter->Run(
+          {Value::Token(), Value(UBits(1, 8)), Value(UBits(2, 8))}));
+  EXPECT_THAT(result.events.trace_msgs,
+              ElementsAre(testing::Field(&TraceMessage::message, "x=1")));
+}
+
+TEST_F(CompiledFunctionInterpreterOnlyTest, WrongArguments) {
+  Package package(TestName());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, Parser::ParseFunction(R"(
+    fn f(x: bits[8]) -> bits[8] {
+      ret neg.1: bits[8] = neg(x)
+    }
+  )",
+                                                                 &package));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CompiledFunctionInterpreter> interpreter,
+      CompiledFunctionInterpreter::Create(function));
+  EXPECT_THAT(interpreter->Run({}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("wants 1 arguments, got 0")));
+  EXPECT_THAT(interpreter->Run({Value(UBits(1, 4))}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("which is not of type bits[8]")));
+}
+
+}  // namespace
+}  // namespace xls
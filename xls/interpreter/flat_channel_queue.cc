@@ -0,0 +1,178 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/interpreter/flat_channel_queue.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/math_util.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+// Ors the low `width` bits of `value` (which must be zero above `width`) into
+// `words` starting at bit `offset`.
+void WriteBits(uint64_t* words, int64_t offset, uint64_t value,
+               int64_t width) {
+  int64_t word = offset / 64;
+  int64_t shift = offset % 64;
+  words[word] |= value << shift;
+  if (shift + width > 64) {
+    words[word + 1] |= value >> (64 - shift);
+  }
+}
+
+// Returns the `width` bits of `words` starting at bit `offset`. `width` must
+// be in the range [1, 64].
+uint64_t ReadBits(const uint64_t* words, int64_t offset, int64_t width) {
+  int64_t word = offset / 64;
+  int64_t shift = offset % 64;
+  uint64_t result = words[word] >> shift;
+  if (shift + width > 64) {
+    result |= words[word + 1] << (64 - shift);
+  }
+  return width == 64 ? result : result & ((uint64_t{1} << width) - 1);
+}
+
+// Writes the leaf bits of `value` in depth-first order starting at bit
+// `offset` of `words`, advancing `offset` past them.
+void FlattenValue(const Value& value, uint64_t* words, int64_t& offset) {
+  if (value.IsBits()) {
+    const InlineBitmap& bitmap = value.bits().bitmap();
+    for (int64_t i = 0; i < bitmap.word_count(); ++i) {
+      int64_t width = std::min<int64_t>(bitmap.bit_count() - 64 * i, 64);
+      WriteBits(words, offset, bitmap.GetWord(i), width);
+      offset += width;
+    }
+    return;
+  }
+  if (value.IsToken()) {
+    return;
+  }
+  for (const Value& element : value.elements()) {
+    FlattenValue(element, words, offset);
+  }
+}
+
+// Inverse of FlattenValue: materializes a value of the given type from the
+// bits of `words` starting at `offset`.
+Value UnflattenValue(const Type* type, const uint64_t* words,
+                     int64_t& offset) {
+  switch (type->kind()) {
+    case TypeKind::kBits: {
+      InlineBitmap bitmap(type->AsBitsOrDie()->bit_count());
+      for (int64_t i = 0; i < bitmap.word_count(); ++i) {
+        int64_t width = std::min<int64_t>(bitmap.bit_count() - 64 * i, 64);
+        bitmap.SetWord(i, ReadBits(words, offset, width));
+        offset += width;
+      }
+      return Value(Bits::FromBitmap(std::move(bitmap)));
+    }
+    case TypeKind::kTuple: {
+      std::vector<Value> elements;
+      elements.reserve(type->AsTupleOrDie()->size());
+      for (const Type* element_type : type->AsTupleOrDie()->element_types()) {
+        elements.push_back(UnflattenValue(element_type, words, offset));
+      }
+      return Value::TupleOwned(std::move(elements));
+    }
+    case TypeKind::kArray: {
+      const ArrayType* array_type = type->AsArrayOrDie();
+      std::vector<Value> elements;
+      elements.reserve(array_type->size());
+      for (int64_t i = 0; i < array_type->size(); ++i) {
+        elements.push_back(
+            UnflattenValue(array_type->element_type(), words, offset));
+      }
+      return Value::ArrayOwned(std::move(elements));
+    }
+    case TypeKind::kToken:
+      return Value::Token();
+  }
+  LOG(FATAL) << "Invalid type kind: " << type->kind();
+}
+
+}  // namespace
+
+FlatChannelQueue::FlatChannelQueue(ChannelInstance* channel_instance)
+    : ChannelQueue(channel_instance),
+      type_(channel_instance->channel->type()),
+      slot_word_count_(std::max<int64_t>(
+          CeilOfRatio(type_->GetFlatBitCount(), int64_t{64}), 1)) {
+  absl::MutexLock lock(&mutex_);
+  buffer_.resize(capacity_ * slot_word_count_);
+}
+
+int64_t FlatChannelQueue::GetSizeInternal() const { return size_; }
+
+void FlatChannelQueue::Grow() {
+  std::vector<uint64_t> new_buffer(2 * capacity_ * slot_word_count_);
+  for (int64_t i = 0; i < size_; ++i) {
+    std::copy_n(Slot(i), slot_word_count_,
+                new_buffer.data() + i * slot_word_count_);
+  }
+  buffer_ = std::move(new_buffer);
+  capacity_ *= 2;
+  head_ = 0;
+}
+
+void FlatChannelQueue::WriteInternal(const Value& value) {
+  uint64_t* slot;
+  if (channel()->kind() == ChannelKind::kSingleValue) {
+    // Single-value channels hold at most one value which is overwritten.
+    size_ = 1;
+    slot = Slot(0);
+  } else {
+    CHECK_EQ(channel()->kind(), ChannelKind::kStreaming);
+    if (size_ == capacity_) {
+      Grow();
+    }
+    slot = Slot(size_);
+    ++size_;
+  }
+  std::fill_n(slot, slot_word_count_, 0);
+  int64_t offset = 0;
+  FlattenValue(value, slot, offset);
+  CHECK_EQ(offset, type_->GetFlatBitCount())
+      << "Value " << value << " does not match channel type " << *type_;
+}
+
+std::optional<Value> FlatChannelQueue::ReadInternal() {
+  if (size_ == 0) {
+    return std::nullopt;
+  }
+  int64_t offset = 0;
+  Value value = UnflattenValue(type_, Slot(0), offset);
+  if (channel()->kind() != ChannelKind::kSingleValue) {
+    head_ = (head_ + 1) % capacity_;
+    --size_;
+  }
+  return value;
+}
+
+}  // namespace xls
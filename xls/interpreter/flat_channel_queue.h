@@ -0,0 +1,78 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_INTERPRETER_FLAT_CHANNEL_QUEUE_H_
+#define XLS_INTERPRETER_FLAT_CHANNEL_QUEUE_H_
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// A channel queue which stores its elements in a contiguous ring buffer of
+// 64-bit words rather than as a deque of Values. Each element occupies a
+// fixed-size slot holding the leaf bits of the value concatenated in
+// depth-first order. Values are flattened on write and only materialized when
+// read, so a queue holding many aggregate values performs a single allocation
+// (amortized) rather than one per element.
+class FlatChannelQueue : public ChannelQueue {
+ public:
+  explicit FlatChannelQueue(ChannelInstance* channel_instance);
+  ~FlatChannelQueue() override = default;
+
+  // Returns the number of elements the ring buffer can hold before growing.
+  int64_t capacity() const {
+    absl::MutexLock lock(&mutex_);
+    return capacity_;
+  }
+
+ protected:
+  int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  void WriteInternal(const Value& value)
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  std::optional<Value> ReadInternal()
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+
+ private:
+  static constexpr int64_t kInitialCapacity = 8;
+
+  uint64_t* Slot(int64_t index) ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+    return buffer_.data() + ((head_ + index) % capacity_) * slot_word_count_;
+  }
+
+  // Doubles the capacity of the ring buffer, moving the elements to the front.
+  void Grow() ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+
+  Type* type_;
+  // Number of words in each slot. At least one so zero-width types (e.g.,
+  // tokens and empty tuples) still have distinct slots.
+  int64_t slot_word_count_;
+  int64_t capacity_ ABSL_GUARDED_BY(mutex_) = kInitialCapacity;
+  // Index of the slot holding the oldest element.
+  int64_t head_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t size_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::vector<uint64_t> buffer_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_FLAT_CHANNEL_QUEUE_H_
@@ -0,0 +1,98 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/interpreter/flat_channel_queue.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/channel_queue_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::testing::Optional;
+
+// Instantiate and run all the tests in channel_queue_test_base.cc.
+INSTANTIATE_TEST_SUITE_P(FlatChannelQueueTest, ChannelQueueTestBase,
+                         testing::Values(ChannelQueueTestParam(
+                             [](ChannelInstance* channel_instance) {
+                               return std::make_unique<FlatChannelQueue>(
+                                   channel_instance);
+                             })));
+
+class FlatChannelQueueTest : public IrTestBase {};
+
+TEST_F(FlatChannelQueueTest, AggregateValuesAcrossGrowth) {
+  Package package(TestName());
+  // Leaves of various widths so that values straddle word boundaries.
+  Type* type = package.GetTupleType(
+      {package.GetBitsType(3),
+       package.GetArrayType(4, package.GetBitsType(61)),
+       package.GetTokenType(), package.GetBitsType(130)});
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     type));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+  FlatChannelQueue queue(elaboration.GetUniqueInstance(channel).value());
+
+  auto make_value = [](int64_t i) {
+    std::vector<Value> array;
+    for (int64_t j = 0; j < 4; ++j) {
+      array.push_back(Value(UBits((i << 32) + j, 61)));
+    }
+    return Value::Tuple(
+        {Value(UBits(i % 8, 3)), Value::ArrayOrDie(array), Value::Token(),
+         Value(bits_ops::Concat({UBits(i, 64), UBits(3, 2), UBits(~static_cast<uint64_t>(i), 64)}))});
+  };
+
+  // Interleave reads and writes so the ring buffer wraps around before it
+  // grows.
+  int64_t next_write = 0;
+  int64_t next_read = 0;
+  for (int64_t round = 0; round < 5; ++round) {
+    for (int64_t i = 0; i < 7; ++i) {
+      XLS_ASSERT_OK(queue.Write(make_value(next_write++)));
+    }
+    for (int64_t i = 0; i < 3; ++i) {
+      EXPECT_THAT(queue.Read(), Optional(make_value(next_read++)));
+    }
+  }
+  EXPECT_EQ(queue.GetSize(), next_write - next_read);
+  EXPECT_GE(queue.capacity(), queue.GetSize());
+  while (next_read < next_write) {
+    EXPECT_THAT(queue.Read(), Optional(make_value(next_read++)));
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+}  // namespace
+}  // namespace xls
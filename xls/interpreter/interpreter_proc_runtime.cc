@@ -18,12 +18,16 @@
 #include <utility>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/flat_channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/proc_interpreter.h"
+#include "xls/interpreter/proc_runtime.h"
 #include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/channel.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/value.h"
@@ -31,12 +35,29 @@
 namespace xls {
 namespace {
 
+absl::StatusOr<std::unique_ptr<ChannelQueueManager>> CreateQueueManager(
+    ProcElaboration elaboration, const InterpreterProcRuntimeOptions& options) {
+  if (!options.flat_channel_queues) {
+    return ChannelQueueManager::Create(std::move(elaboration));
+  }
+  std::vector<std::unique_ptr<ChannelQueue>> queues;
+  for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
+    if (channel_instance->channel->kind() != ChannelKind::kStreaming &&
+        channel_instance->channel->kind() != ChannelKind::kSingleValue) {
+      return absl::UnimplementedError(
+          "Only streaming and single-value channels are supported.");
+    }
+    queues.push_back(std::make_unique<FlatChannelQueue>(channel_instance));
+  }
+  return ChannelQueueManager::Create(std::move(queues), std::move(elaboration));
+}
+
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
-    ProcElaboration elaboration) {
+    ProcElaboration elaboration, const InterpreterProcRuntimeOptions& options) {
   // Create a queue manager for the queues. This factory verifies that there an
   // receive only queue for every receive only channel.
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<ChannelQueueManager> queue_manager,
-                       ChannelQueueManager::Create(std::move(elaboration)));
+                       CreateQueueManager(std::move(elaboration), options));
 
   // Create a ProcInterpreter for each Proc.
   std::vector<std::unique_ptr<ProcEvaluator>> proc_interpreters;
@@ -67,17 +88,31 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
-CreateInterpreterSerialProcRuntime(Package* package) {
+CreateInterpreterSerialProcRuntime(
+    Package* package, const InterpreterProcRuntimeOptions& options) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
                        ProcElaboration::ElaborateOldStylePackage(package));
-  return CreateRuntime(std::move(elaboration));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> runtime,
+                       CreateRuntime(std::move(elaboration), options));
+  runtime->set_factory(
+      [package, options]() -> absl::StatusOr<std::unique_ptr<ProcRuntime>> {
+        return CreateInterpreterSerialProcRuntime(package, options);
+      });
+  return std::move(runtime);
 }
 
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
-CreateInterpreterSerialProcRuntime(Proc* top) {
+CreateInterpreterSerialProcRuntime(
+    Proc* top, const InterpreterProcRuntimeOptions& options) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
                        ProcElaboration::Elaborate(top));
-  return CreateRuntime(std::move(elaboration));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> runtime,
+                       CreateRuntime(std::move(elaboration), options));
+  runtime->set_factory(
+      [top, options]() -> absl::StatusOr<std::unique_ptr<ProcRuntime>> {
+        return CreateInterpreterSerialProcRuntime(top, options);
+      });
+  return std::move(runtime);
 }
 
 }  // namespace xls
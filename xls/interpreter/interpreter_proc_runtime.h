@@ -23,15 +23,24 @@
 
 namespace xls {
 
+struct InterpreterProcRuntimeOptions {
+  // Whether channel queues hold their elements in a contiguous flat-bit ring
+  // buffer (FlatChannelQueue) rather than as a deque of Values. Values are then
+  // only materialized when a proc reads them.
+  bool flat_channel_queues = false;
+};
+
 // Create a SerialProcRuntime composed of ProcInterpreters. Supports old-style
 // procs.
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
-CreateInterpreterSerialProcRuntime(Package* package);
+CreateInterpreterSerialProcRuntime(
+    Package* package, const InterpreterProcRuntimeOptions& options = {});
 
 // Create a SerialProcRuntime composed of ProcInterpreters. Constructed from the
 // elaboration of the given proc. Supports new-style procs.
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
-CreateInterpreterSerialProcRuntime(Proc* top);
+CreateInterpreterSerialProcRuntime(
+    Proc* top, const InterpreterProcRuntimeOptions& options = {});
 
 }  // namespace xls
 
@@ -26,7 +26,6 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
-#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
@@ -88,14 +87,24 @@ absl::StatusOr<Value> InterpretNode(Node* node,
   return visitor.ResolveAsValue(node);
 }
 
+NodeValueSlots::NodeValueSlots(FunctionBase* function_base)
+    : values_(function_base->node_count()),
+      slot_generations_(function_base->node_count(), 0) {
+  slot_indices_.reserve(function_base->node_count());
+  for (Node* node : function_base->nodes()) {
+    slot_indices_.emplace(node, slot_indices_.size());
+  }
+}
+
 absl::Status IrInterpreter::AddInterpreterEvents(
     const InterpreterEvents& events) {
   for (const TraceMessage& trace_msg : events.trace_msgs) {
-    GetInterpreterEvents().trace_msgs.push_back(trace_msg);
+    GetInterpreterEvents().AddTrace(
+        TraceEvent(trace_msg.message, trace_msg.verbosity));
   }
 
   for (const std::string& assert_msg : events.assert_msgs) {
-    GetInterpreterEvents().assert_msgs.push_back(assert_msg);
+    GetInterpreterEvents().AddAssert(assert_msg);
   }
 
   return absl::OkStatus();
@@ -442,6 +451,11 @@ absl::Status IrInterpreter::HandleArrayIndex(ArrayIndex* index) {
   for (Node* index_operand : index->indices()) {
     uint64_t idx =
         BitsToBoundedUint64(ResolveAsBits(index_operand), array->size() - 1);
+    if (array->IsPackedBitsArray()) {
+      // Packed arrays hold bits so this is the last index. Read the element
+      // directly rather than boxing every element of (e.g.) a large table.
+      return SetValueResult(index, Value(array->GetBitsElement(idx)));
+    }
     array = &array->element(idx);
   }
   return SetValueResult(index, *array);
@@ -503,7 +517,7 @@ absl::Status IrInterpreter::HandleAssert(Assert* assert_op) {
   VLOG(2) << "Checking assert " << assert_op->ToString();
   VLOG(2) << "Condition is " << ResolveAsBool(assert_op->condition());
   if (!ResolveAsBool(assert_op->condition())) {
-    GetInterpreterEvents().assert_msgs.push_back(assert_op->message());
+    GetInterpreterEvents().AddAssert(assert_op->message());
   }
   return SetValueResult(assert_op, Value::Token());
 }
@@ -522,20 +536,16 @@ absl::Status IrInterpreter::HandleTrace(Trace* trace_op) {
           StepsToXlsFormatString(trace_op->format()), trace_op->ToString()));
     };
 
-    std::string trace_output;
-
+    // Formatting is deferred to the consumer of the event so the arguments
+    // are only collected here.
+    std::vector<Value> args;
+    args.reserve(arg_nodes.size());
     for (auto step : trace_op->format()) {
-      if (std::holds_alternative<std::string>(step)) {
-        absl::StrAppend(&trace_output, std::get<std::string>(step));
-      }
-
       if (std::holds_alternative<FormatPreference>(step)) {
         if (arg_node == arg_nodes.end()) {
           return make_error("Not enough operands");
         }
-        auto arg_format = std::get<FormatPreference>(step);
-        absl::StrAppend(&trace_output,
-                        ResolveAsValue(*arg_node).ToHumanString(arg_format));
+        args.push_back(ResolveAsValue(*arg_node));
         arg_node++;
       }
     }
@@ -544,12 +554,11 @@ absl::Status IrInterpreter::HandleTrace(Trace* trace_op) {
       return make_error("Too many operands");
     }
 
-    VLOG(3) << "Trace output: " << trace_output;
+    TraceEvent event(trace_op->format(), std::move(args),
+                     trace_op->verbosity());
+    VLOG(3) << "Trace output: " << event.Format();
 
-    GetInterpreterEvents().trace_msgs.push_back(TraceMessage{
-        .message = trace_output,
-        .verbosity = trace_op->verbosity(),
-    });
+    GetInterpreterEvents().AddTrace(event);
   }
   return SetValueResult(trace_op, Value::Token());
 }
@@ -834,11 +843,11 @@ absl::Status IrInterpreter::VerifyAllBitsTypes(Node* node) {
 }
 
 const Bits& IrInterpreter::ResolveAsBits(Node* node) {
-  return NodeValuesMap().at(node).bits();
+  return ResolveAsValue(node).bits();
 }
 
 bool IrInterpreter::ResolveAsBool(Node* node) {
-  const Bits& bits = NodeValuesMap().at(node).bits();
+  const Bits& bits = ResolveAsValue(node).bits();
   CHECK_EQ(bits.bit_count(), 1);
   return bits.IsAllOnes();
 }
@@ -872,7 +881,7 @@ absl::Status IrInterpreter::SetBitsResult(Node* node, const Bits& result) {
 absl::Status IrInterpreter::SetValueResult(Node* node, Value result) {
   if (VLOG_IS_ON(4) &&
       std::all_of(node->operands().begin(), node->operands().end(),
-                  [this](Node* o) { return NodeValuesMap().contains(o); })) {
+                  [this](Node* o) { return HasResult(o); })) {
     VLOG(4) << absl::StreamFormat("%s operands:", node->GetName());
     for (int64_t i = 0; i < node->operand_count(); ++i) {
       VLOG(4) << absl::StreamFormat(
@@ -883,13 +892,17 @@ absl::Status IrInterpreter::SetValueResult(Node* node, Value result) {
   VLOG(3) << absl::StreamFormat("Result of %s: %s", node->ToString(),
                                 result.ToString());
 
-  XLS_RET_CHECK(!NodeValuesMap().contains(node));
+  XLS_RET_CHECK(!HasResult(node));
   if (!ValueConformsToType(result, node->GetType())) {
     return absl::InternalError(absl::StrFormat(
         "Expected value %s to match type %s of node %s", result.ToString(),
         node->GetType()->ToString(), node->GetName()));
   }
-  NodeValuesMap()[node] = std::move(result);
+  if (node_value_slots_ != nullptr) {
+    node_value_slots_->Set(node, std::move(result));
+  } else {
+    NodeValuesMap()[node] = std::move(result);
+  }
   return absl::OkStatus();
 }
 
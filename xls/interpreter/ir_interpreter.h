@@ -16,15 +16,18 @@
 #define XLS_INTERPRETER_IR_INTERPRETER_H_
 
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/events.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/value.h"
@@ -36,6 +39,44 @@ namespace xls {
 absl::StatusOr<Value> InterpretNode(Node* node,
                                     absl::Span<const Value> operand_values);
 
+// Storage for the values of the nodes of a FunctionBase which is evaluated
+// repeatedly, such as the ticks of a proc. Each node is assigned a fixed slot
+// when the storage is created so values are overwritten in place rather than
+// inserted into a map, and Clear() is constant time and frees nothing.
+class NodeValueSlots {
+ public:
+  explicit NodeValueSlots(FunctionBase* function_base);
+
+  bool Contains(Node* node) const {
+    auto it = slot_indices_.find(node);
+    return it != slot_indices_.end() &&
+           slot_generations_[it->second] == generation_;
+  }
+  const Value& Get(Node* node) const {
+    int64_t slot = slot_indices_.at(node);
+    CHECK_EQ(slot_generations_[slot], generation_)
+        << "No value for node " << node->GetName();
+    return values_[slot];
+  }
+  void Set(Node* node, Value value) {
+    int64_t slot = slot_indices_.at(node);
+    values_[slot] = std::move(value);
+    slot_generations_[slot] = generation_;
+  }
+
+  // Marks all slots as empty. The previously stored values are retained until
+  // overwritten.
+  void Clear() { ++generation_; }
+
+ private:
+  absl::flat_hash_map<Node*, int64_t> slot_indices_;
+  std::vector<Value> values_;
+  // A slot holds a value for the current evaluation iff its generation matches
+  // `generation_`.
+  std::vector<int64_t> slot_generations_;
+  int64_t generation_ = 1;
+};
+
 // A visitor for traversing and evaluating XLS IR.
 class IrInterpreter : public DfsVisitor {
  public:
@@ -48,6 +89,13 @@ class IrInterpreter : public DfsVisitor {
                 InterpreterEvents* events)
       : node_values_ptr_(node_values), events_ptr_(events) {}
 
+  // Constructor which stores node values in preallocated slots which persist
+  // across evaluations. NodeValuesMap() must not be used with this storage.
+  IrInterpreter(NodeValueSlots& node_value_slots, InterpreterEvents* events)
+      : node_values_ptr_(nullptr),
+        node_value_slots_(&node_value_slots),
+        events_ptr_(events) {}
+
   // Sets the evaluated value for 'node' to the given Value. 'value' must be
   // passed in by value (ha!) because a use case is passing in a previously
   // evaluated value and inserting a into flat_hash_map (done below) invalidates
@@ -56,6 +104,9 @@ class IrInterpreter : public DfsVisitor {
 
   // Returns the previously evaluated value of 'node' as a Value.
   const Value& ResolveAsValue(Node* node) const {
+    if (node_value_slots_ != nullptr) {
+      return node_value_slots_->Get(node);
+    }
     return NodeValuesMap().at(node);
   }
 
@@ -69,7 +120,12 @@ class IrInterpreter : public DfsVisitor {
   absl::Status AddInterpreterEvents(const InterpreterEvents& events);
 
   // Returns true if a value has been set for the result of the given node.
-  bool HasResult(Node* node) const { return NodeValuesMap().contains(node); }
+  bool HasResult(Node* node) const {
+    if (node_value_slots_ != nullptr) {
+      return node_value_slots_->Contains(node);
+    }
+    return NodeValuesMap().contains(node);
+  }
 
   absl::Status HandleAdd(BinOp* add) override;
   absl::Status HandleAfterAll(AfterAll* after_all) override;
@@ -201,6 +257,10 @@ class IrInterpreter : public DfsVisitor {
   absl::flat_hash_map<Node*, Value>* node_values_ptr_;
   absl::flat_hash_map<Node*, Value> node_values_;
 
+  // Slot storage for the node values. If not null, takes the place of the map
+  // above.
+  NodeValueSlots* node_value_slots_ = nullptr;
+
   // Events observed while interpreting (currently only trace messages). To
   // support continuations, an existing events object can either be passed in at
   // construction time (`events_ptr_` is not null), or a fresh events object is
@@ -14,6 +14,7 @@
 
 #include "xls/interpreter/ir_interpreter.h"
 
+#include <cstdint>
 #include <string>
 
 #include "gmock/gmock.h"
@@ -83,6 +84,34 @@ TEST_F(IrInterpreterOnlyTest, EvaluateNode) {
               IsOkAndHolds(Value(UBits(6, 4))));
 }
 
+TEST_F(IrInterpreterOnlyTest, NodeValueSlotsReusedAcrossEvaluations) {
+  Package package("my_package");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, Parser::ParseFunction(R"(
+    fn f(x: bits[4]) -> bits[4] {
+      literal.1: bits[4] = literal(value=6)
+      ret and.2: bits[4] = and(literal.1, x)
+    }
+    )",
+                                                                 &package));
+  Node* x = function->param(0);
+  Node* literal = FindNode("literal.1", function);
+  Node* and_node = FindNode("and.2", function);
+  NodeValueSlots slots(function);
+  for (int64_t i = 0; i < 4; ++i) {
+    IrInterpreter visitor(slots, /*events=*/nullptr);
+    EXPECT_FALSE(visitor.HasResult(x));
+    EXPECT_FALSE(visitor.HasResult(and_node));
+    XLS_ASSERT_OK(visitor.SetValueResult(x, Value(UBits(i, 4))));
+    XLS_ASSERT_OK(literal->VisitSingleNode(&visitor));
+    XLS_ASSERT_OK(and_node->VisitSingleNode(&visitor));
+    EXPECT_EQ(visitor.ResolveAsValue(and_node), Value(UBits(i & 6, 4)));
+    // Values may not be set twice within an evaluation.
+    EXPECT_THAT(visitor.SetValueResult(x, Value(UBits(i, 4))),
+                StatusIs(absl::StatusCode::kInternal));
+    slots.Clear();
+  }
+}
+
 TEST_F(IrInterpreterOnlyTest, SideEffectingNodes) {
   Package package("my_package");
   const std::string fn_text = R"(
@@ -0,0 +1,282 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/parallel_proc_runtime.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/events.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc_elaboration.h"
+
+namespace xls {
+
+/* static */ absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+ParallelProcRuntime::Create(
+    std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+    std::unique_ptr<ChannelQueueManager>&& queue_manager,
+    std::optional<int64_t> thread_count) {
+  XLS_RET_CHECK(!thread_count.has_value() || *thread_count > 0)
+      << "Thread count must be positive";
+  // Verify there exists exactly one evaluator per proc in the package.
+  absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>> evaluator_map;
+  for (std::unique_ptr<ProcEvaluator>& evaluator : evaluators) {
+    Proc* proc = evaluator->proc();
+    auto [it, inserted] = evaluator_map.insert({proc, std::move(evaluator)});
+    XLS_RET_CHECK(inserted) << absl::StreamFormat(
+        "More than one evaluator given for proc `%s`", proc->name());
+  }
+  for (Proc* proc : queue_manager->elaboration().procs()) {
+    XLS_RET_CHECK(evaluator_map.contains(proc))
+        << absl::StreamFormat("No evaluator given for proc `%s`", proc->name());
+  }
+  XLS_RET_CHECK_EQ(evaluator_map.size(),
+                   queue_manager->elaboration().procs().size())
+      << "More evaluators than procs given.";
+  // There is no point in having more workers than proc instances.
+  int64_t instance_count =
+      queue_manager->elaboration().proc_instances().size();
+  int64_t threads = std::max<int64_t>(
+      1, std::min<int64_t>(thread_count.value_or(AvailableCPUs()),
+                           instance_count));
+  return absl::WrapUnique(new ParallelProcRuntime(
+      std::move(evaluator_map), std::move(queue_manager), threads));
+}
+
+ParallelProcRuntime::ParallelProcRuntime(
+    absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
+    std::unique_ptr<ChannelQueueManager>&& queue_manager, int64_t thread_count)
+    : ProcRuntime(std::move(evaluators), std::move(queue_manager)) {
+  worker_queues_.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    worker_queues_.push_back(std::make_unique<WorkerQueue>());
+  }
+  workers_.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    workers_.push_back(std::make_unique<Thread>([this, i]() { WorkerLoop(i); }));
+  }
+}
+
+ParallelProcRuntime::~ParallelProcRuntime() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+  }
+  for (std::unique_ptr<Thread>& worker : workers_) {
+    worker->Join();
+  }
+}
+
+ParallelProcRuntime::Task ParallelProcRuntime::MakeTask(
+    ProcInstance* instance) {
+  return Task{.instance = instance,
+              .evaluator = evaluators_.at(instance->proc()).get(),
+              .continuation = continuations_.at(instance).get()};
+}
+
+void ParallelProcRuntime::Push(int64_t worker, const Task& task) {
+  outstanding_tasks_.fetch_add(1, std::memory_order_acq_rel);
+  WorkerQueue& queue = *worker_queues_[worker];
+  absl::MutexLock lock(&queue.mutex);
+  queue.tasks.push_back(task);
+}
+
+std::optional<ParallelProcRuntime::Task> ParallelProcRuntime::PopOrSteal(
+    int64_t worker) {
+  {
+    WorkerQueue& queue = *worker_queues_[worker];
+    absl::MutexLock lock(&queue.mutex);
+    if (!queue.tasks.empty()) {
+      Task task = queue.tasks.front();
+      queue.tasks.pop_front();
+      return task;
+    }
+  }
+  int64_t worker_count = worker_queues_.size();
+  for (int64_t i = 1; i < worker_count; ++i) {
+    WorkerQueue& victim = *worker_queues_[(worker + i) % worker_count];
+    absl::MutexLock lock(&victim.mutex);
+    if (!victim.tasks.empty()) {
+      Task task = victim.tasks.back();
+      victim.tasks.pop_back();
+      return task;
+    }
+  }
+  return std::nullopt;
+}
+
+absl::Status ParallelProcRuntime::RunTask(int64_t worker, const Task& task) {
+  VLOG(3) << absl::StreamFormat("Worker %d ticking proc instance `%s`", worker,
+                                task.instance->GetName());
+  XLS_ASSIGN_OR_RETURN(TickResult tick_result,
+                       task.evaluator->Tick(*task.continuation));
+  XLS_RETURN_IF_ERROR(InterpreterEventsToStatus(task.continuation->GetEvents()));
+  VLOG(3) << "Tick result: " << tick_result;
+
+  if (tick_result.progress_made) {
+    progress_made_.store(true, std::memory_order_relaxed);
+    if (task.evaluator->ProcHasIoOperations()) {
+      progress_made_on_io_procs_.store(true, std::memory_order_relaxed);
+    }
+  }
+  if (tick_result.execution_state == TickExecutionState::kSentOnChannel) {
+    ChannelInstance* channel_instance = tick_result.channel_instance.value();
+    std::optional<Task> unblocked;
+    {
+      absl::MutexLock lock(&blocked_mutex_);
+      auto it = blocked_instances_.find(channel_instance);
+      if (it != blocked_instances_.end()) {
+        unblocked = it->second;
+        blocked_instances_.erase(it);
+      }
+    }
+    if (unblocked.has_value()) {
+      VLOG(3) << absl::StreamFormat(
+          "Unblocking proc instance `%s` and adding to ready list",
+          unblocked->instance->GetName());
+      Push(worker, *unblocked);
+    }
+    // This proc instance can go back on the ready queue.
+    Push(worker, task);
+  } else if (tick_result.execution_state ==
+             TickExecutionState::kBlockedOnReceive) {
+    ChannelInstance* channel_instance = tick_result.channel_instance.value();
+    absl::MutexLock lock(&blocked_mutex_);
+    // A sender on another worker may have written to the channel after this
+    // instance found it empty. Senders write before checking for blocked
+    // receivers, so checking the queue while holding the lock avoids losing
+    // the wakeup.
+    if (!queue_manager().GetQueue(channel_instance).IsEmpty()) {
+      Push(worker, task);
+    } else {
+      VLOG(3) << absl::StreamFormat(
+          "Proc instance `%s` is now blocked on channel instance `%s`",
+          task.instance->GetName(), channel_instance->ToString());
+      blocked_instances_[channel_instance] = task;
+    }
+  }
+  return absl::OkStatus();
+}
+
+void ParallelProcRuntime::WorkerLoop(int64_t worker) {
+  int64_t seen_generation = 0;
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      auto tick_started_or_shutdown = [&]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+        return shutdown_ || generation_ != seen_generation;
+      };
+      mutex_.Await(absl::Condition(&tick_started_or_shutdown));
+      if (shutdown_) {
+        return;
+      }
+      seen_generation = generation_;
+    }
+    while (outstanding_tasks_.load(std::memory_order_acquire) > 0) {
+      std::optional<Task> task = PopOrSteal(worker);
+      if (!task.has_value()) {
+        // Other workers are still running tasks which may produce more work.
+        std::this_thread::yield();
+        continue;
+      }
+      if (!failed_.load(std::memory_order_relaxed)) {
+        absl::Status status = RunTask(worker, *task);
+        if (!status.ok()) {
+          absl::MutexLock lock(&mutex_);
+          if (status_.ok()) {
+            status_ = std::move(status);
+          }
+          failed_.store(true, std::memory_order_relaxed);
+        }
+      }
+      if (outstanding_tasks_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // Last task of the network tick. Release the mutex so the waiting
+        // TickInternal call re-evaluates its condition.
+        absl::MutexLock lock(&mutex_);
+      }
+    }
+  }
+}
+
+absl::StatusOr<ParallelProcRuntime::NetworkTickResult>
+ParallelProcRuntime::TickInternal() {
+  VLOG(3) << absl::StreamFormat("TickInternal on package %s",
+                                package()->name());
+  progress_made_.store(false);
+  progress_made_on_io_procs_.store(false);
+  failed_.store(false);
+  {
+    absl::MutexLock lock(&mutex_);
+    status_ = absl::OkStatus();
+  }
+  {
+    absl::MutexLock lock(&blocked_mutex_);
+    blocked_instances_.clear();
+  }
+
+  // Put all proc instances on the ready lists, distributing them round-robin
+  // across the workers.
+  int64_t worker = 0;
+  for (ProcInstance* instance : elaboration().proc_instances()) {
+    VLOG(3) << absl::StreamFormat("Proc instance `%s` added to ready list",
+                                  instance->GetName());
+    Push(worker, MakeTask(instance));
+    worker = (worker + 1) % worker_queues_.size();
+  }
+
+  {
+    absl::MutexLock lock(&mutex_);
+    ++generation_;
+    auto tick_complete = [&]() {
+      return outstanding_tasks_.load(std::memory_order_acquire) == 0;
+    };
+    mutex_.Await(absl::Condition(&tick_complete));
+    XLS_RETURN_IF_ERROR(status_);
+  }
+
+  std::vector<ChannelInstance*> blocked_channel_instances;
+  {
+    absl::MutexLock lock(&blocked_mutex_);
+    for (ChannelInstance* instance : elaboration().channel_instances()) {
+      if (blocked_instances_.contains(instance)) {
+        blocked_channel_instances.push_back(instance);
+      }
+    }
+  }
+  return NetworkTickResult{
+      .progress_made = progress_made_.load(),
+      .progress_made_on_io_procs = progress_made_on_io_procs_.load(),
+      .blocked_channel_instances = std::move(blocked_channel_instances),
+  };
+}
+
+}  // namespace xls
@@ -0,0 +1,130 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
+#define XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/proc_elaboration.h"
+
+namespace xls {
+
+// Class for interpreting a network of procs across a pool of worker threads.
+// Each proc instance is a task which is run until it completes its tick or
+// blocks on a receive from an empty channel. Blocked instances are parked
+// until a send on the channel they are blocked on wakes them. Workers take
+// tasks from their own queue and steal from the queues of other workers when
+// their own queue is empty.
+//
+// All channel queues must be thread-safe (e.g., created with
+// JitChannelQueueManager::CreateThreadSafe or ChannelQueueManager::Create).
+// For deterministic networks (no non-blocking receives and no single-value
+// channels feeding data dependent control) the results are identical to those
+// of the SerialProcRuntime. With a single worker thread the order in which
+// proc instances are ticked matches the SerialProcRuntime exactly.
+//
+// ParallelProcRuntimes are thread-compatible, but not thread-safe.
+class ParallelProcRuntime : public ProcRuntime {
+ public:
+  // Creates and returns a proc network runtime for the given evaluators which
+  // uses (at most) `thread_count` worker threads. If `thread_count` is not
+  // given then the number of available CPUs is used.
+  static absl::StatusOr<std::unique_ptr<ParallelProcRuntime>> Create(
+      std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      std::optional<int64_t> thread_count = std::nullopt);
+
+  ~ParallelProcRuntime() override;
+
+  int64_t thread_count() const { return workers_.size(); }
+
+ private:
+  ParallelProcRuntime(
+      absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      int64_t thread_count);
+
+  absl::StatusOr<NetworkTickResult> TickInternal() override;
+
+  // An instance of a proc which is ready to run.
+  struct Task {
+    ProcInstance* instance;
+    ProcEvaluator* evaluator;
+    ProcContinuation* continuation;
+  };
+
+  // The queue of ready tasks owned by a single worker. Other workers steal
+  // from the back of the queue while the owner takes from the front.
+  struct WorkerQueue {
+    absl::Mutex mutex;
+    std::deque<Task> tasks ABSL_GUARDED_BY(mutex);
+  };
+
+  Task MakeTask(ProcInstance* instance);
+
+  // Adds a task to the queue of the given worker.
+  void Push(int64_t worker, const Task& task);
+
+  // Returns a task from the given worker's queue, or one stolen from another
+  // worker. Returns std::nullopt if all queues are empty.
+  std::optional<Task> PopOrSteal(int64_t worker);
+
+  // Ticks the given task once and reschedules it (and any instance it
+  // unblocks) as appropriate.
+  absl::Status RunTask(int64_t worker, const Task& task);
+
+  void WorkerLoop(int64_t worker);
+
+  std::vector<std::unique_ptr<WorkerQueue>> worker_queues_;
+  std::vector<std::unique_ptr<Thread>> workers_;
+
+  // Number of tasks in worker queues plus tasks currently being run. The
+  // network tick is complete when this reaches zero.
+  std::atomic<int64_t> outstanding_tasks_ = 0;
+  std::atomic<bool> progress_made_ = false;
+  std::atomic<bool> progress_made_on_io_procs_ = false;
+  std::atomic<bool> failed_ = false;
+
+  // Proc instances which are blocked on receives, indexed by the channel
+  // instance they are blocked on.
+  absl::Mutex blocked_mutex_;
+  absl::flat_hash_map<ChannelInstance*, Task> blocked_instances_
+      ABSL_GUARDED_BY(blocked_mutex_);
+
+  // Guards the state used to start network ticks and shut down the workers.
+  absl::Mutex mutex_;
+  int64_t generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
@@ -0,0 +1,171 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/parallel_proc_runtime.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/interpreter/proc_runtime_test_base.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_proc_runtime.h"
+
+namespace xls {
+namespace {
+
+class ParallelProcRuntimeTest : public IrTestBase {};
+
+// Creates a proc which sends 0, 1, 2, ... on `out`.
+absl::StatusOr<Proc*> CreateIotaProc(std::string_view name, Channel* out,
+                                     Package* package) {
+  ProcBuilder pb(name, package);
+  BValue st = pb.StateElement("st", Value(UBits(0, 32)));
+  pb.Send(out, pb.Literal(Value::Token()), st);
+  return pb.Build({pb.Add(st, pb.Literal(UBits(1, 32)))});
+}
+
+// Creates a proc which receives a value on `in`, adds it to a running sum and
+// `addend`, and sends the result on `out`.
+absl::StatusOr<Proc*> CreateStageProc(std::string_view name, int64_t addend,
+                                      Channel* in, Channel* out,
+                                      Package* package) {
+  ProcBuilder pb(name, package);
+  BValue accum = pb.StateElement("accum", Value(UBits(0, 32)));
+  BValue recv = pb.Receive(in, pb.Literal(Value::Token()));
+  BValue next_accum = pb.Add(
+      accum, pb.Add(pb.TupleIndex(recv, 1), pb.Literal(UBits(addend, 32))));
+  pb.Send(out, pb.TupleIndex(recv, 0), next_accum);
+  return pb.Build({next_accum});
+}
+
+// Builds a network of `width` independent pipelines each `depth` stages deep.
+// Returns the output channels of the pipelines.
+absl::StatusOr<std::vector<Channel*>> BuildPipelines(int64_t width,
+                                                     int64_t depth,
+                                                     Package* package) {
+  std::vector<Channel*> outputs;
+  for (int64_t w = 0; w < width; ++w) {
+    XLS_ASSIGN_OR_RETURN(
+        Channel * prev,
+        package->CreateStreamingChannel(absl::StrFormat("ch_%d_0", w),
+                                        ChannelOps::kSendReceive,
+                                        package->GetBitsType(32)));
+    XLS_RETURN_IF_ERROR(
+        CreateIotaProc(absl::StrFormat("iota_%d", w), prev, package).status());
+    for (int64_t d = 1; d <= depth; ++d) {
+      XLS_ASSIGN_OR_RETURN(
+          Channel * next,
+          package->CreateStreamingChannel(
+              absl::StrFormat("ch_%d_%d", w, d),
+              d == depth ? ChannelOps::kSendOnly : ChannelOps::kSendReceive,
+              package->GetBitsType(32)));
+      XLS_RETURN_IF_ERROR(CreateStageProc(absl::StrFormat("stage_%d_%d", w, d),
+                                          /*addend=*/w + d, prev, next, package)
+                              .status());
+      prev = next;
+    }
+    outputs.push_back(prev);
+  }
+  return outputs;
+}
+
+std::vector<Value> DrainQueue(ChannelQueue& queue) {
+  std::vector<Value> values;
+  while (std::optional<Value> value = queue.Read()) {
+    values.push_back(*value);
+  }
+  return values;
+}
+
+TEST_F(ParallelProcRuntimeTest, MatchesSerialRuntime) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Channel*> outputs,
+                           BuildPipelines(/*width=*/4, /*depth=*/8,
+                                          package.get()));
+  absl::flat_hash_map<Channel*, int64_t> output_counts;
+  for (Channel* output : outputs) {
+    output_counts[output] = 100;
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SerialProcRuntime> serial,
+                           CreateJitSerialProcRuntime(package.get()));
+  XLS_ASSERT_OK(serial->TickUntilOutput(output_counts).status());
+  absl::flat_hash_map<Channel*, std::vector<Value>> expected;
+  for (Channel* output : outputs) {
+    expected[output] = DrainQueue(serial->queue_manager().GetQueue(output));
+  }
+
+  for (int64_t thread_count : {1, 2, 4, 8}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<ParallelProcRuntime> parallel,
+        CreateJitParallelProcRuntime(package.get(), thread_count));
+    EXPECT_EQ(parallel->thread_count(), thread_count);
+    XLS_ASSERT_OK(parallel->TickUntilOutput(output_counts).status());
+    for (Channel* output : outputs) {
+      EXPECT_EQ(DrainQueue(parallel->queue_manager().GetQueue(output)),
+                expected.at(output))
+          << "thread count: " << thread_count
+          << " channel: " << output->name();
+    }
+  }
+}
+
+TEST_F(ParallelProcRuntimeTest, ThreadCountLimitedByProcInstances) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK(BuildPipelines(/*width=*/1, /*depth=*/2, package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ParallelProcRuntime> runtime,
+                           CreateJitParallelProcRuntime(package.get(), 64));
+  EXPECT_EQ(runtime->thread_count(), 3);
+}
+
+// Instantiate and run all the tests in proc_runtime_test_base.cc using a
+// parallel runtime with a single worker. A single worker ticks procs in the
+// same order as the serial runtime so order-sensitive tests (e.g., non-blocking
+// receives) produce identical results.
+INSTANTIATE_TEST_SUITE_P(
+    ProcRuntimeTest, ProcRuntimeTestBase,
+    testing::Values(
+        ProcRuntimeTestParam(
+            "jit_single_thread",
+            [](Package* package) -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(package, 1).value();
+            },
+            [](Proc* top) -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(top, 1).value();
+            })),
+    [](const testing::TestParamInfo<ProcRuntimeTestBase::ParamType>& info) {
+      return info.param.name();
+    });
+
+}  // namespace
+}  // namespace xls
@@ -25,6 +25,21 @@
 
 namespace xls {
 
+ProcPerformanceCounters& ProcPerformanceCounters::operator+=(
+    const ProcPerformanceCounters& other) {
+  activations += other.activations;
+  completed_ticks += other.completed_ticks;
+  blocked_on_receive += other.blocked_on_receive;
+  cycles += other.cycles;
+  for (const auto& [channel_instance, count] : other.sends) {
+    sends[channel_instance] += count;
+  }
+  for (const auto& [channel_instance, count] : other.receives) {
+    receives[channel_instance] += count;
+  }
+  return *this;
+}
+
 bool TickResult::operator==(const TickResult& other) const {
   return execution_state == other.execution_state &&
          channel_instance == other.channel_instance &&
@@ -22,6 +22,8 @@
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/ir/events.h"
 #include "xls/ir/proc.h"
@@ -30,6 +32,26 @@
 
 namespace xls {
 
+// Counters describing the runtime behavior of a proc instance. Collected by
+// evaluators which support them (currently the JIT) once enabled with
+// ProcRuntime::EnablePerformanceCounters.
+struct ProcPerformanceCounters {
+  // Number of calls to Tick, including ones which did not complete a tick.
+  int64_t activations = 0;
+  // Number of ticks completed.
+  int64_t completed_ticks = 0;
+  // Number of activations which ended blocked on a receive.
+  int64_t blocked_on_receive = 0;
+  // Time spent executing the proc. On x86 this is measured in time-stamp
+  // counter cycles, elsewhere in nanoseconds.
+  int64_t cycles = 0;
+  // Number of values sent and received on each channel instance.
+  absl::flat_hash_map<ChannelInstance*, int64_t> sends;
+  absl::flat_hash_map<ChannelInstance*, int64_t> receives;
+
+  ProcPerformanceCounters& operator+=(const ProcPerformanceCounters& other);
+};
+
 // Abstract base class representing a continuation for the evaluation of a
 // Proc. The continuation captures the control and data state of the execution
 // of a proc tick.
@@ -43,6 +65,11 @@ class ProcContinuation {
   // executed.
   virtual std::vector<Value> GetState() const = 0;
 
+  // Sets the Proc state at the beginning of the next tick. The continuation
+  // must be at the start of a tick. The values must conform to the types of
+  // the state elements.
+  virtual absl::Status SetState(std::vector<Value> state) = 0;
+
   // Returns the events recorded during execution of this continuation.
   virtual const InterpreterEvents& GetEvents() const = 0;
   virtual InterpreterEvents& GetEvents() = 0;
@@ -53,6 +80,17 @@ class ProcContinuation {
   // a tick execution.
   virtual bool AtStartOfTick() const = 0;
 
+  // Starts collecting performance counters for this continuation. Returns false
+  // if the evaluator does not support performance counters.
+  virtual bool EnablePerformanceCounters() { return false; }
+
+  // Returns the performance counters collected since they were enabled, or
+  // std::nullopt if they are not enabled.
+  virtual std::optional<ProcPerformanceCounters> GetPerformanceCounters()
+      const {
+    return std::nullopt;
+  }
+
   ProcInstance* proc_instance() const { return proc_instance_; }
   Proc* proc() const { return proc_instance_->proc(); }
 
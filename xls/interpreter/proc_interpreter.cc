@@ -47,7 +47,8 @@
 namespace xls {
 namespace {
 
-// A continuation used by the ProcInterpreter.
+// A continuation used by the ProcInterpreter. The storage for node values and
+// state is allocated once and reused across ticks.
 class ProcInterpreterContinuation : public ProcContinuation {
  public:
   // Construct a new continuation. Execution the proc begins with the state set
@@ -55,11 +56,20 @@ class ProcInterpreterContinuation : public ProcContinuation {
   explicit ProcInterpreterContinuation(ProcInstance* proc_instance)
       : ProcContinuation(proc_instance),
         node_index_(0),
-        state_(proc()->InitValues().begin(), proc()->InitValues().end()) {}
+        state_(proc()->InitValues().begin(), proc()->InitValues().end()),
+        next_state_(state_.size()),
+        node_values_(proc()) {}
 
   ~ProcInterpreterContinuation() override = default;
 
   std::vector<Value> GetState() const override { return state_; }
+  absl::Status SetState(std::vector<Value> state) override {
+    XLS_RET_CHECK(AtStartOfTick());
+    XLS_RET_CHECK_EQ(state.size(), state_.size());
+    state_ = std::move(state);
+    return absl::OkStatus();
+  }
+  absl::Span<const Value> state() const { return state_; }
   const InterpreterEvents& GetEvents() const override { return events_; }
   InterpreterEvents& GetEvents() override { return events_; }
   void ClearEvents() override { events_.Clear(); }
@@ -72,14 +82,22 @@ class ProcInterpreterContinuation : public ProcContinuation {
   absl::flat_hash_map<Param*, std::vector<Next*>>& GetActiveNextValues() {
     return active_next_values_;
   }
-  void ClearActiveNextValues() { active_next_values_.clear(); }
+  // Empties the lists of active next values while keeping their storage.
+  void ClearActiveNextValues() {
+    for (auto& [_, next_values] : active_next_values_) {
+      next_values.clear();
+    }
+  }
+
+  // Returns the buffer in which the state for the next tick is built.
+  std::vector<Value>& GetNextState() { return next_state_; }
 
   // Resets the continuation so it will start executing at the beginning of the
-  // proc with the given state values.
-  void NextTick(std::vector<Value>&& next_state) {
+  // proc with the state values in the next state buffer.
+  void NextTick() {
     node_index_ = 0;
-    state_ = next_state;
-    node_values_.clear();
+    state_.swap(next_state_);
+    node_values_.Clear();
   }
 
   // Gets/sets the index of the node to be executed next. This index refers to a
@@ -87,18 +105,17 @@ class ProcInterpreterContinuation : public ProcContinuation {
   int64_t GetNodeExecutionIndex() const { return node_index_; }
   void SetNodeExecutionIndex(int64_t index) { node_index_ = index; }
 
-  // Returns the map of node values computed in the tick so far.
-  absl::flat_hash_map<Node*, Value>& GetNodeValues() { return node_values_; }
-  const absl::flat_hash_map<Node*, Value>& GetNodeValues() const {
-    return node_values_;
-  }
+  // Returns the node values computed in the tick so far.
+  NodeValueSlots& GetNodeValues() { return node_values_; }
+  const NodeValueSlots& GetNodeValues() const { return node_values_; }
 
  private:
   int64_t node_index_;
   std::vector<Value> state_;
+  std::vector<Value> next_state_;
 
   InterpreterEvents events_;
-  absl::flat_hash_map<Node*, Value> node_values_;
+  NodeValueSlots node_values_;
   absl::flat_hash_map<Param*, std::vector<Next*>> active_next_values_;
 };
 
@@ -110,18 +127,18 @@ class ProcIrInterpreter : public IrInterpreter {
   //   proc_instance: the instance of the proc which is being interpreted.
   //   state: is the value to use for the proc state in the tick being
   //     interpreted.
-  //   node_values: map from Node to Value for already computed values in this
-  //     tick of the proc. Used for continuations.
+  //   node_values: storage holding the already computed values in this tick
+  //     of the proc. Used for continuations.
   //   events: events object to record events in (e.g, traces).
   //   queue_manager: manager for channel queues.
   ProcIrInterpreter(
       ProcInstance* proc_instance, absl::Span<const Value> state,
-      absl::flat_hash_map<Node*, Value>* node_values, InterpreterEvents* events,
+      NodeValueSlots& node_values, InterpreterEvents* events,
       ChannelQueueManager* queue_manager,
       absl::flat_hash_map<Param*, std::vector<Next*>>* active_next_values)
       : IrInterpreter(node_values, events),
         proc_instance_(proc_instance),
-        state_(state.begin(), state.end()),
+        state_(state),
         queue_manager_(queue_manager),
         active_next_values_(active_next_values) {}
 
@@ -219,8 +236,7 @@ class ProcIrInterpreter : public IrInterpreter {
     if (proc_instance_->path().has_value()) {
       // New-style proc-scoped channel.
       XLS_ASSIGN_OR_RETURN(ChannelInstance * channel_instance,
-                           queue_manager_->elaboration().GetChannelInstance(
-                               name, *proc_instance_->path()));
+                           proc_instance_->GetChannelInstance(name));
       return &queue_manager_->GetQueue(channel_instance);
     }
     // Old-style global channel.
@@ -228,7 +244,7 @@ class ProcIrInterpreter : public IrInterpreter {
   }
 
   ProcInstance* proc_instance_;
-  std::vector<Value> state_;
+  absl::Span<const Value> state_;
   ChannelQueueManager* queue_manager_;
 
   absl::flat_hash_map<Param*, std::vector<Next*>>* active_next_values_;
@@ -259,7 +275,7 @@ absl::StatusOr<TickResult> ProcInterpreter::Tick(
                                      "of type ProcInterpreterContinuation";
 
   ProcIrInterpreter ir_interpreter(
-      cont->proc_instance(), cont->GetState(), &cont->GetNodeValues(),
+      cont->proc_instance(), cont->state(), cont->GetNodeValues(),
       &cont->GetEvents(), queue_manager_, &cont->GetActiveNextValues());
 
   // Resume execution at the node indicated in the continuation
@@ -299,13 +315,15 @@ absl::StatusOr<TickResult> ProcInterpreter::Tick(
   // continuation.
   //
   // TODO: Simplify this once fully transitioned over to `next_value` nodes.
-  std::vector<Value> next_state;
-  next_state.resize(proc()->GetStateElementCount());
+  std::vector<Value>& next_state = cont->GetNextState();
   for (int64_t index = 0; index < proc()->NextState().size(); ++index) {
     next_state[index] =
         ir_interpreter.ResolveAsValue(proc()->GetNextStateElement(index));
   }
   for (const auto& [param, next_values] : cont->GetActiveNextValues()) {
+    if (next_values.empty()) {
+      continue;
+    }
     if (next_values.size() > 1) {
       return absl::AlreadyExistsError(absl::StrFormat(
           "Multiple active next values for param \"%s\" in a "
@@ -320,7 +338,7 @@ absl::StatusOr<TickResult> ProcInterpreter::Tick(
     next_state[index] = ir_interpreter.ResolveAsValue(next_values[0]->value());
   }
   cont->ClearActiveNextValues();
-  cont->NextTick(std::move(next_state));
+  cont->NextTick();
 
   // Raise a status error if interpreter events indicate failure such as a
   // failed assert.
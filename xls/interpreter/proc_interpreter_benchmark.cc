@@ -0,0 +1,79 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+
+namespace xls {
+namespace {
+
+// Measures the tick throughput of the proc interpreter on the example procs.
+// Channels which are only received on by the network are kept fed with zero
+// values and channels which are only sent on are drained after every tick, so
+// the network never stalls on external I/O.
+void BM_InterpretProcNetwork(benchmark::State& state,
+                             const std::string& ir_path) {
+  std::filesystem::path path = GetXlsRunfilePath(ir_path).value();
+  std::string ir_text = GetFileContents(path).value();
+  std::unique_ptr<Package> package =
+      Parser::ParsePackage(ir_text, path.string()).value();
+  std::unique_ptr<SerialProcRuntime> runtime =
+      CreateInterpreterSerialProcRuntime(package.get()).value();
+  ChannelQueueManager& queue_manager = runtime->queue_manager();
+  for (auto _ : state) {
+    for (Channel* channel : package->channels()) {
+      ChannelQueue& queue = queue_manager.GetQueue(channel);
+      if (channel->supported_ops() == ChannelOps::kReceiveOnly &&
+          queue.IsEmpty()) {
+        CHECK_OK(queue.Write(ZeroOfType(channel->type())));
+      }
+    }
+    CHECK_OK(runtime->Tick());
+    for (Channel* channel : package->channels()) {
+      if (channel->supported_ops() == ChannelOps::kSendOnly) {
+        ChannelQueue& queue = queue_manager.GetQueue(channel);
+        while (std::optional<Value> value = queue.Read()) {
+          benchmark::DoNotOptimize(value);
+        }
+      }
+    }
+  }
+  state.counters["ticks"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_CAPTURE(BM_InterpretProcNetwork, proc_iota,
+                  std::string("xls/examples/proc_iota.ir"));
+BENCHMARK_CAPTURE(BM_InterpretProcNetwork, delay,
+                  std::string("xls/examples/delay.ir"));
+
+}  // namespace
+}  // namespace xls
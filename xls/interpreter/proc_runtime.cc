@@ -22,19 +22,29 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime_checkpoint.pb.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
+#include "xls/ir/events.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
 #include "xls/ir/proc_elaboration.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/ir/xls_value.pb.h"
 #include "xls/jit/jit_channel_queue.h"
 
 namespace xls {
@@ -156,9 +166,208 @@ absl::StatusOr<int64_t> ProcRuntime::TickUntilBlocked(
 
 void ProcRuntime::ResetState() {
   for (ProcInstance* instance : elaboration().proc_instances()) {
-    continuations_[instance] =
-        evaluators_.at(instance->proc())->NewContinuation(instance);
+    std::unique_ptr<ProcContinuation>& continuation = continuations_[instance];
+    if (performance_counters_enabled_ && continuation != nullptr) {
+      past_performance_counters_[instance] +=
+          continuation->GetPerformanceCounters().value();
+    }
+    continuation = evaluators_.at(instance->proc())->NewContinuation(instance);
+    continuation->GetEvents().sink = event_sink_;
+    if (performance_counters_enabled_) {
+      CHECK(continuation->EnablePerformanceCounters());
+    }
+  }
+}
+
+void ProcRuntime::SetEventSink(InterpreterEventSink* sink) {
+  event_sink_ = sink;
+  for (auto& [_, continuation] : continuations_) {
+    continuation->GetEvents().sink = sink;
+  }
+}
+
+absl::StatusOr<ProcRuntimeCheckpointProto> ProcRuntime::SaveCheckpoint() {
+  ProcRuntimeCheckpointProto checkpoint;
+  for (ProcInstance* instance : elaboration().proc_instances()) {
+    const ProcContinuation& continuation = *continuations_.at(instance);
+    if (!continuation.AtStartOfTick()) {
+      return absl::FailedPreconditionError(absl::StrFormat(
+          "Cannot checkpoint proc instance `%s` which is part way through a "
+          "tick",
+          instance->GetName()));
+    }
+    ProcRuntimeCheckpointProto::ProcInstanceState* proc_state =
+        checkpoint.add_proc_states();
+    proc_state->set_proc_instance(instance->GetName());
+    for (const Value& value : continuation.GetState()) {
+      XLS_ASSIGN_OR_RETURN(*proc_state->add_state(), value.AsProto());
+    }
+  }
+  for (ChannelInstance* instance : elaboration().channel_instances()) {
+    ProcRuntimeCheckpointProto::ChannelQueueContents* queue_contents =
+        checkpoint.add_channel_queues();
+    queue_contents->set_channel_instance(instance->ToString());
+    for (const Value& value :
+         queue_manager_->GetQueue(instance).GetContents()) {
+      XLS_ASSIGN_OR_RETURN(*queue_contents->add_values(), value.AsProto());
+    }
+  }
+  return checkpoint;
+}
+
+absl::Status ProcRuntime::RestoreCheckpoint(
+    const ProcRuntimeCheckpointProto& checkpoint) {
+  absl::flat_hash_map<std::string, ProcInstance*> proc_instances;
+  for (ProcInstance* instance : elaboration().proc_instances()) {
+    proc_instances[instance->GetName()] = instance;
+  }
+  absl::flat_hash_map<std::string, ChannelInstance*> channel_instances;
+  for (ChannelInstance* instance : elaboration().channel_instances()) {
+    channel_instances[instance->ToString()] = instance;
+  }
+
+  // Convert and validate everything before modifying the runtime.
+  std::vector<std::pair<ProcInstance*, std::vector<Value>>> states;
+  for (const ProcRuntimeCheckpointProto::ProcInstanceState& proc_state :
+       checkpoint.proc_states()) {
+    auto it = proc_instances.find(proc_state.proc_instance());
+    if (it == proc_instances.end()) {
+      return absl::NotFoundError(
+          absl::StrFormat("Checkpoint refers to unknown proc instance `%s`",
+                          proc_state.proc_instance()));
+    }
+    Proc* proc = it->second->proc();
+    if (proc_state.state_size() != proc->GetStateElementCount()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Checkpoint has %d state elements for proc instance `%s`, expected "
+          "%d",
+          proc_state.state_size(), proc_state.proc_instance(),
+          proc->GetStateElementCount()));
+    }
+    std::vector<Value> state;
+    state.reserve(proc_state.state_size());
+    for (int64_t i = 0; i < proc_state.state_size(); ++i) {
+      Type* type = proc->GetStateElementType(i);
+      XLS_ASSIGN_OR_RETURN(Value value, Value::FromProto(proc_state.state(i)));
+      if (!ValueConformsToType(value, type)) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Checkpoint state element %d of proc instance `%s` has value %s "
+            "which does not conform to type %s",
+            i, proc_state.proc_instance(), value.ToString(),
+            type->ToString()));
+      }
+      state.push_back(std::move(value));
+    }
+    states.push_back({it->second, std::move(state)});
+  }
+  std::vector<std::pair<ChannelInstance*, std::vector<Value>>> contents;
+  for (const ProcRuntimeCheckpointProto::ChannelQueueContents& queue_contents :
+       checkpoint.channel_queues()) {
+    auto it = channel_instances.find(queue_contents.channel_instance());
+    if (it == channel_instances.end()) {
+      return absl::NotFoundError(
+          absl::StrFormat("Checkpoint refers to unknown channel instance `%s`",
+                          queue_contents.channel_instance()));
+    }
+    std::vector<Value> values;
+    values.reserve(queue_contents.values_size());
+    for (const ValueProto& value_proto : queue_contents.values()) {
+      XLS_ASSIGN_OR_RETURN(Value value, Value::FromProto(value_proto));
+      values.push_back(std::move(value));
+    }
+    contents.push_back({it->second, std::move(values)});
+  }
+
+  ResetState();
+  for (auto& [instance, state] : states) {
+    XLS_RETURN_IF_ERROR(
+        continuations_.at(instance)->SetState(std::move(state)));
+  }
+  for (const auto& [instance, values] : contents) {
+    XLS_RETURN_IF_ERROR(queue_manager_->GetQueue(instance).SetContents(values));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<ProcRuntime>> ProcRuntime::Clone() {
+  if (factory_ == nullptr) {
+    return absl::UnimplementedError(
+        "Runtime has no factory set and cannot be cloned");
+  }
+  for (ProcInstance* instance : elaboration().proc_instances()) {
+    if (!continuations_.at(instance)->AtStartOfTick()) {
+      return absl::FailedPreconditionError(absl::StrFormat(
+          "Cannot clone runtime while proc instance `%s` is part way through "
+          "a tick",
+          instance->GetName()));
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<ProcRuntime> clone, factory_());
+  if (clone->factory_ == nullptr) {
+    clone->factory_ = factory_;
+  }
+
+  // The clone elaborates the same procs so the instances appear in the same
+  // order.
+  absl::Span<ProcInstance* const> proc_instances =
+      elaboration().proc_instances();
+  absl::Span<ProcInstance* const> clone_proc_instances =
+      clone->elaboration().proc_instances();
+  XLS_RET_CHECK_EQ(proc_instances.size(), clone_proc_instances.size());
+  for (int64_t i = 0; i < proc_instances.size(); ++i) {
+    XLS_RET_CHECK_EQ(proc_instances[i]->GetName(),
+                     clone_proc_instances[i]->GetName());
+    XLS_RETURN_IF_ERROR(
+        clone->continuations_.at(clone_proc_instances[i])
+            ->SetState(continuations_.at(proc_instances[i])->GetState()));
+  }
+  absl::Span<ChannelInstance* const> channel_instances =
+      elaboration().channel_instances();
+  absl::Span<ChannelInstance* const> clone_channel_instances =
+      clone->elaboration().channel_instances();
+  XLS_RET_CHECK_EQ(channel_instances.size(), clone_channel_instances.size());
+  for (int64_t i = 0; i < channel_instances.size(); ++i) {
+    XLS_RET_CHECK_EQ(channel_instances[i]->ToString(),
+                     clone_channel_instances[i]->ToString());
+    XLS_RETURN_IF_ERROR(
+        clone->queue_manager_->GetQueue(clone_channel_instances[i])
+            .SetContents(
+                queue_manager_->GetQueue(channel_instances[i]).GetContents()));
+  }
+  if (performance_counters_enabled_) {
+    XLS_RETURN_IF_ERROR(clone->EnablePerformanceCounters());
+  }
+  return std::move(clone);
+}
+
+absl::Status ProcRuntime::EnablePerformanceCounters() {
+  if (performance_counters_enabled_) {
+    return absl::OkStatus();
+  }
+  for (const auto& [instance, continuation] : continuations_) {
+    if (!continuation->EnablePerformanceCounters()) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "Evaluator of proc `%s` does not support performance counters",
+          instance->proc()->name()));
+    }
+  }
+  performance_counters_enabled_ = true;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<ProcPerformanceCounters> ProcRuntime::GetPerformanceCounters(
+    ProcInstance* instance) const {
+  if (!performance_counters_enabled_) {
+    return absl::FailedPreconditionError(
+        "Performance counters are not enabled");
+  }
+  ProcPerformanceCounters counters;
+  if (auto it = past_performance_counters_.find(instance);
+      it != past_performance_counters_.end()) {
+    counters += it->second;
   }
+  counters += continuations_.at(instance)->GetPerformanceCounters().value();
+  return counters;
 }
 
 absl::StatusOr<JitChannelQueueManager*>
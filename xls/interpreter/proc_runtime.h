@@ -16,6 +16,7 @@
 #define XLS_INTERPRETER_PROC_RUNTIME_H_
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -25,6 +26,7 @@
 #include "absl/status/statusor.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime_checkpoint.pb.h"
 #include "xls/ir/elaboration.h"
 #include "xls/ir/events.h"
 #include "xls/ir/package.h"
@@ -94,6 +96,37 @@ class ProcRuntime {
   // Reset the state of all of the procs to their initial state.
   void ResetState();
 
+  // Returns a checkpoint holding the state of every proc instance and the
+  // contents of every channel queue. Every proc instance must be at the start
+  // of a tick (i.e., not blocked part way through an iteration) as the
+  // position within a tick is specific to the evaluator. Interpreter events,
+  // performance counters and queue generators are not included.
+  absl::StatusOr<ProcRuntimeCheckpointProto> SaveCheckpoint();
+
+  // Resets the runtime and then sets the proc state and channel queue
+  // contents from the given checkpoint. The checkpoint may have been saved
+  // from a runtime using a different evaluator but must have been saved from
+  // the same elaboration. Proc instances and channel queues not mentioned in
+  // the checkpoint are left in their initial state.
+  absl::Status RestoreCheckpoint(const ProcRuntimeCheckpointProto& checkpoint);
+
+  // A function which creates a new runtime for the same procs with the same
+  // evaluator and options as this one, in its initial state.
+  using Factory =
+      std::function<absl::StatusOr<std::unique_ptr<ProcRuntime>>()>;
+  void set_factory(Factory factory) { factory_ = std::move(factory); }
+
+  // Returns a new runtime, independent of this one, with the same proc state
+  // and channel queue contents. Scenarios can then branch from a common
+  // warmed-up state and run concurrently in different threads. Every proc
+  // instance must be at the start of a tick. Aggregate values share their
+  // (immutable) element storage with this runtime so the copy is cheap in the
+  // interpreter; JIT runtimes recompile the procs in the clone. Interpreter
+  // events and runtime-specific settings (e.g., the scheduling order of a
+  // SerialProcRuntime) are not copied. Requires a factory to have been set,
+  // which the Create*ProcRuntime functions do.
+  absl::StatusOr<std::unique_ptr<ProcRuntime>> Clone();
+
   // Returns the events for each proc in the network.
   const InterpreterEvents& GetInterpreterEvents(ProcInstance* instance) const {
     return continuations_.at(instance)->GetEvents();
@@ -103,6 +136,24 @@ class ProcRuntime {
         ->GetEvents();
   }
 
+  // Enables collection of performance counters (activations, blocked
+  // receives, channel operations and time spent) for every proc instance.
+  // Returns an error if the evaluators do not support performance counters.
+  absl::Status EnablePerformanceCounters();
+
+  // Returns the performance counters of the given proc instance accumulated
+  // since they were enabled, including across calls to ResetState.
+  absl::StatusOr<ProcPerformanceCounters> GetPerformanceCounters(
+      ProcInstance* instance) const;
+
+  // Passes the trace events of every proc instance to `sink` instead of
+  // accumulating them in the events returned by GetInterpreterEvents. The sink
+  // is not owned and is kept across ResetState. Pass nullptr to resume
+  // accumulating events. JIT evaluators defer formatting the arguments of
+  // traces passed to a sink until the message is requested; such events must
+  // be consumed before the runtime is destroyed.
+  void SetEventSink(InterpreterEventSink* sink);
+
   void ClearInterpreterEvents() const {
     for (const auto& [_, continuation] : continuations_) {
       continuation->ClearEvents();
@@ -132,6 +183,16 @@ class ProcRuntime {
   absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>> evaluators_;
   absl::flat_hash_map<ProcInstance*, std::unique_ptr<ProcContinuation>>
       continuations_;
+
+  // Whether performance counters are enabled, and the counters of
+  // continuations discarded by ResetState.
+  bool performance_counters_enabled_ = false;
+  absl::flat_hash_map<ProcInstance*, ProcPerformanceCounters>
+      past_performance_counters_;
+
+  Factory factory_;
+
+  InterpreterEventSink* event_sink_ = nullptr;
 };
 
 }  // namespace xls
@@ -28,10 +28,12 @@
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_runtime_checkpoint.pb.h"
 #include "xls/interpreter/proc_runtime.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
+#include "xls/ir/events.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/ir_test_base.h"
@@ -44,7 +46,9 @@ namespace {
 
 using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
 using ::testing::Optional;
 
 // Creates a proc which has a single send operation using the given channel
@@ -765,6 +769,167 @@ TEST_P(ProcRuntimeTestBase, StateReset) {
   EXPECT_THAT(output_queue.Read(), Optional(Value(SBits(14, 32))));
 }
 
+TEST_P(ProcRuntimeTestBase, CheckpointAndRestore) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * iota_accum_channel,
+      package->CreateStreamingChannel("iota_accum", ChannelOps::kSendReceive,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out_channel,
+      package->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK(CreateIotaProc("iota", /*starting_value=*/5, /*step=*/1,
+                               iota_accum_channel, package.get())
+                    .status());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * accum,
+      CreateAccumProc("accum", iota_accum_channel, out_channel, package.get()));
+
+  std::unique_ptr<ProcRuntime> runtime =
+      GetParam().CreateRuntime(package.get());
+  XLS_ASSERT_OK(runtime->Tick());
+  XLS_ASSERT_OK(runtime->Tick());
+  XLS_ASSERT_OK(runtime->Tick());
+
+  // Round trip the checkpoint through its serialized form and restore it into
+  // a fresh runtime. Both runtimes should then behave identically.
+  XLS_ASSERT_OK_AND_ASSIGN(ProcRuntimeCheckpointProto checkpoint,
+                           runtime->SaveCheckpoint());
+  ProcRuntimeCheckpointProto parsed;
+  ASSERT_TRUE(parsed.ParseFromString(checkpoint.SerializeAsString()));
+
+  std::unique_ptr<ProcRuntime> restored =
+      GetParam().CreateRuntime(package.get());
+  XLS_ASSERT_OK(restored->RestoreCheckpoint(parsed));
+  EXPECT_EQ(restored->ResolveState(accum), runtime->ResolveState(accum));
+  EXPECT_EQ(restored->queue_manager().GetQueue(out_channel).GetContents(),
+            runtime->queue_manager().GetQueue(out_channel).GetContents());
+
+  XLS_ASSERT_OK(runtime->Tick());
+  XLS_ASSERT_OK(restored->Tick());
+  for (ProcRuntime* r : {runtime.get(), restored.get()}) {
+    ChannelQueue& queue = r->queue_manager().GetQueue(out_channel);
+    EXPECT_EQ(queue.GetSize(), 4);
+    EXPECT_THAT(queue.Read(), Optional(Value(UBits(5, 32))));
+    EXPECT_THAT(queue.Read(), Optional(Value(UBits(11, 32))));
+    EXPECT_THAT(queue.Read(), Optional(Value(UBits(18, 32))));
+    EXPECT_THAT(queue.Read(), Optional(Value(UBits(26, 32))));
+  }
+}
+
+TEST_P(ProcRuntimeTestBase, CloneBranchesFromCommonState) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * iota_accum_channel,
+      package->CreateStreamingChannel("iota_accum", ChannelOps::kSendReceive,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out_channel,
+      package->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK(CreateIotaProc("iota", /*starting_value=*/5, /*step=*/1,
+                               iota_accum_channel, package.get())
+                    .status());
+  XLS_ASSERT_OK(
+      CreateAccumProc("accum", iota_accum_channel, out_channel, package.get())
+          .status());
+
+  std::unique_ptr<ProcRuntime> runtime =
+      GetParam().CreateRuntime(package.get());
+  XLS_ASSERT_OK(runtime->Tick());
+  XLS_ASSERT_OK(runtime->Tick());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ProcRuntime> clone,
+                           runtime->Clone());
+
+  // The clone starts with the outputs produced so far and then runs
+  // independently of the original.
+  ChannelQueue& queue = runtime->queue_manager().GetQueue(out_channel);
+  ChannelQueue& clone_queue = clone->queue_manager().GetQueue(out_channel);
+  EXPECT_THAT(queue.Read(), Optional(Value(UBits(5, 32))));
+  EXPECT_THAT(queue.Read(), Optional(Value(UBits(11, 32))));
+  EXPECT_EQ(clone_queue.GetSize(), 2);
+
+  XLS_ASSERT_OK(clone->Tick());
+  EXPECT_EQ(queue.GetSize(), 0);
+  EXPECT_THAT(clone_queue.Read(), Optional(Value(UBits(5, 32))));
+  EXPECT_THAT(clone_queue.Read(), Optional(Value(UBits(11, 32))));
+  EXPECT_THAT(clone_queue.Read(), Optional(Value(UBits(18, 32))));
+
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_THAT(queue.Read(), Optional(Value(UBits(18, 32))));
+
+  // Clones may themselves be cloned.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ProcRuntime> clone_of_clone,
+                           clone->Clone());
+  XLS_ASSERT_OK(clone_of_clone->Tick());
+  EXPECT_THAT(clone_of_clone->queue_manager().GetQueue(out_channel).Read(),
+              Optional(Value(UBits(26, 32))));
+}
+
+TEST_P(ProcRuntimeTestBase, TracesToEventSink) {
+  auto package = CreatePackage();
+  ProcBuilder pb("tracer", package.get());
+  BValue st = pb.StateElement("st", Value(UBits(0, 32)));
+  pb.Trace(pb.Literal(Value::Token()), pb.Literal(UBits(1, 1)), {st},
+           "st is {}");
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc,
+                           pb.Build({pb.Add(st, pb.Literal(UBits(1, 32)))}));
+
+  std::unique_ptr<ProcRuntime> runtime =
+      GetParam().CreateRuntime(package.get());
+  RingBufferEventSink sink(/*capacity=*/2);
+  runtime->SetEventSink(&sink);
+  for (int64_t i = 0; i < 5; ++i) {
+    XLS_ASSERT_OK(runtime->Tick());
+  }
+  EXPECT_THAT(runtime->GetInterpreterEvents(proc).trace_msgs, IsEmpty());
+  EXPECT_THAT(sink.GetTraceMessages(),
+              ElementsAre(TraceMessage{.message = "st is 3", .verbosity = 0},
+                          TraceMessage{.message = "st is 4", .verbosity = 0}));
+  EXPECT_EQ(sink.dropped_count(), 3);
+
+  // The sink is kept across a reset and can be removed.
+  runtime->ResetState();
+  XLS_ASSERT_OK(runtime->Tick());
+  runtime->SetEventSink(nullptr);
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_THAT(sink.GetTraceMessages(),
+              ElementsAre(TraceMessage{.message = "st is 4", .verbosity = 0},
+                          TraceMessage{.message = "st is 0", .verbosity = 0}));
+  EXPECT_THAT(runtime->GetInterpreterEvents(proc).trace_msgs,
+              ElementsAre(TraceMessage{.message = "st is 1", .verbosity = 0}));
+}
+
+TEST_P(ProcRuntimeTestBase, RestoreInvalidCheckpoint) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out_channel,
+      package->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK(CreateIotaProc("iota", /*starting_value=*/0, /*step=*/1,
+                               out_channel, package.get())
+                    .status());
+  std::unique_ptr<ProcRuntime> runtime =
+      GetParam().CreateRuntime(package.get());
+
+  ProcRuntimeCheckpointProto checkpoint;
+  checkpoint.add_proc_states()->set_proc_instance("not_a_proc");
+  EXPECT_THAT(runtime->RestoreCheckpoint(checkpoint),
+              StatusIs(absl::StatusCode::kNotFound,
+                       HasSubstr("unknown proc instance `not_a_proc`")));
+
+  checkpoint.Clear();
+  ProcRuntimeCheckpointProto::ProcInstanceState* proc_state =
+      checkpoint.add_proc_states();
+  proc_state->set_proc_instance("iota");
+  XLS_ASSERT_OK_AND_ASSIGN(*proc_state->add_state(),
+                           Value(UBits(0, 8)).AsProto());
+  EXPECT_THAT(runtime->RestoreCheckpoint(checkpoint),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("does not conform to type bits[32]")));
+}
+
 TEST_P(ProcRuntimeTestBase, NonBlockingReceivesProc) {
   auto package = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(Channel * in0, package->CreateStreamingChannel(
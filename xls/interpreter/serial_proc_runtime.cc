@@ -14,25 +14,112 @@
 
 #include "xls/interpreter/serial_proc_runtime.h"
 
+#include <cstdint>
 #include <deque>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/channel.h"
 #include "xls/ir/events.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
 
 namespace xls {
+namespace {
+
+// Returns the proc instances of `elaboration` in topological order of the
+// channel dataflow (see SerialProcRuntime::SchedulingOrder::kDataflow).
+absl::StatusOr<std::vector<ProcInstance*>> DataflowOrder(
+    const ProcElaboration& elaboration) {
+  absl::flat_hash_map<ChannelInstance*, std::vector<ProcInstance*>> senders;
+  absl::flat_hash_map<ChannelInstance*, std::vector<ProcInstance*>> receivers;
+  for (ProcInstance* proc_instance : elaboration.proc_instances()) {
+    for (Node* node : proc_instance->proc()->nodes()) {
+      if (node->Is<Send>()) {
+        XLS_ASSIGN_OR_RETURN(ChannelInstance * channel_instance,
+                             proc_instance->GetChannelInstance(
+                                 node->As<Send>()->channel_name()));
+        senders[channel_instance].push_back(proc_instance);
+      } else if (node->Is<Receive>()) {
+        XLS_ASSIGN_OR_RETURN(ChannelInstance * channel_instance,
+                             proc_instance->GetChannelInstance(
+                                 node->As<Receive>()->channel_name()));
+        receivers[channel_instance].push_back(proc_instance);
+      }
+    }
+  }
+
+  // Edges from each proc instance to the proc instances receiving its data.
+  absl::flat_hash_map<ProcInstance*, absl::flat_hash_set<ProcInstance*>>
+      successors;
+  absl::flat_hash_map<ProcInstance*, int64_t> pending_predecessors;
+  for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
+    if (!channel_instance->channel->initial_values().empty()) {
+      continue;
+    }
+    for (ProcInstance* sender : senders[channel_instance]) {
+      for (ProcInstance* receiver : receivers[channel_instance]) {
+        if (sender != receiver && successors[sender].insert(receiver).second) {
+          ++pending_predecessors[receiver];
+        }
+      }
+    }
+  }
+
+  // Kahn's algorithm. When every remaining proc instance waits on a
+  // predecessor the network has a cycle which is broken by taking the
+  // earliest remaining proc instance in elaboration order.
+  std::vector<ProcInstance*> order;
+  absl::flat_hash_set<ProcInstance*> visited;
+  std::deque<ProcInstance*> ready;
+  auto visit = [&](ProcInstance* proc_instance) {
+    visited.insert(proc_instance);
+    order.push_back(proc_instance);
+    for (ProcInstance* successor : successors[proc_instance]) {
+      if (!visited.contains(successor) &&
+          --pending_predecessors[successor] == 0) {
+        ready.push_back(successor);
+      }
+    }
+  };
+  for (ProcInstance* proc_instance : elaboration.proc_instances()) {
+    if (pending_predecessors[proc_instance] == 0) {
+      ready.push_back(proc_instance);
+    }
+  }
+  while (order.size() < elaboration.proc_instances().size()) {
+    if (ready.empty()) {
+      for (ProcInstance* proc_instance : elaboration.proc_instances()) {
+        if (!visited.contains(proc_instance)) {
+          ready.push_back(proc_instance);
+          break;
+        }
+      }
+    }
+    ProcInstance* proc_instance = ready.front();
+    ready.pop_front();
+    if (!visited.contains(proc_instance)) {
+      visit(proc_instance);
+    }
+  }
+  return order;
+}
+
+}  // namespace
 
 /* static */ absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
 SerialProcRuntime::Create(
@@ -58,6 +145,20 @@ SerialProcRuntime::Create(
   return std::move(network_interpreter);
 }
 
+absl::Status SerialProcRuntime::SetSchedulingOrder(SchedulingOrder order) {
+  switch (order) {
+    case SchedulingOrder::kElaboration:
+      activation_order_.assign(elaboration().proc_instances().begin(),
+                               elaboration().proc_instances().end());
+      return absl::OkStatus();
+    case SchedulingOrder::kDataflow: {
+      XLS_ASSIGN_OR_RETURN(activation_order_, DataflowOrder(elaboration()));
+      return absl::OkStatus();
+    }
+  }
+  return absl::InvalidArgumentError("Unknown scheduling order");
+}
+
 absl::StatusOr<SerialProcRuntime::NetworkTickResult>
 SerialProcRuntime::TickInternal() {
   VLOG(3) << absl::StreamFormat("TickInternal on package %s",
@@ -74,7 +175,7 @@ SerialProcRuntime::TickInternal() {
   std::deque<QueueElement> ready_instances;
 
   // Put all proc instances on the ready list.
-  for (ProcInstance* instance : elaboration().proc_instances()) {
+  for (ProcInstance* instance : activation_order_) {
     VLOG(3) << absl::StreamFormat("Proc instance `%s` added to ready list",
                                   instance->GetName());
     ready_instances.push_back(
@@ -93,6 +194,7 @@ SerialProcRuntime::TickInternal() {
                                   element.instance->GetName());
     XLS_ASSIGN_OR_RETURN(TickResult tick_result,
                          element.evaluator->Tick(*element.continuation));
+    ++scheduling_stats_.activations;
     const InterpreterEvents& events =
         this->GetInterpreterEvents(element.instance);
     XLS_RETURN_IF_ERROR(InterpreterEventsToStatus(events));
@@ -118,6 +220,7 @@ SerialProcRuntime::TickInternal() {
       ready_instances.push_back(element);
     } else if (tick_result.execution_state ==
                TickExecutionState::kBlockedOnReceive) {
+      ++scheduling_stats_.blocked_activations;
       ChannelInstance* channel_instance = tick_result.channel_instance.value();
       VLOG(3) << absl::StreamFormat(
           "Proc instance `%s` is now blocked on channel instance `%s`",
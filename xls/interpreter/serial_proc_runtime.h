@@ -15,11 +15,13 @@
 #ifndef XLS_INTERPRETER_SERIAL_PROC_RUNTIME_H_
 #define XLS_INTERPRETER_SERIAL_PROC_RUNTIME_H_
 
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
@@ -40,13 +42,43 @@ class SerialProcRuntime : public ProcRuntime {
       std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
       std::unique_ptr<ChannelQueueManager>&& queue_manager);
 
+  // The order in which proc instances are activated at the start of each
+  // network tick. In either order a proc instance blocked on a receive is only
+  // activated again once a value is sent on the channel it is waiting on.
+  enum class SchedulingOrder {
+    // The order of ProcElaboration::proc_instances().
+    kElaboration,
+    // Topological order along the channel dataflow: proc instances sending on
+    // a channel are activated before the proc instances receiving on it, so
+    // in feed-forward networks receivers rarely block. Channels with initial
+    // values are ignored and cycles are broken in elaboration order.
+    kDataflow,
+  };
+  absl::Status SetSchedulingOrder(SchedulingOrder order);
+
+  // Counts of proc activations (calls to ProcEvaluator::Tick) accumulated over
+  // all network ticks since creation or the last ResetSchedulingStats call.
+  struct SchedulingStats {
+    int64_t activations = 0;
+    // Activations which ended blocked on a receive.
+    int64_t blocked_activations = 0;
+  };
+  const SchedulingStats& scheduling_stats() const { return scheduling_stats_; }
+  void ResetSchedulingStats() { scheduling_stats_ = SchedulingStats(); }
+
  private:
   SerialProcRuntime(
       absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
       std::unique_ptr<ChannelQueueManager>&& queue_manager)
-      : ProcRuntime(std::move(evaluators), std::move(queue_manager)) {}
+      : ProcRuntime(std::move(evaluators), std::move(queue_manager)),
+        activation_order_(elaboration().proc_instances().begin(),
+                          elaboration().proc_instances().end()) {}
 
   absl::StatusOr<SerialProcRuntime::NetworkTickResult> TickInternal() override;
+
+  // The proc instances in the order they are activated at the start of a tick.
+  std::vector<ProcInstance*> activation_order_;
+  SchedulingStats scheduling_stats_;
 };
 
 }  // namespace xls
@@ -14,15 +14,18 @@
 
 #include "xls/interpreter/serial_proc_runtime.h"
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
+#include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
@@ -34,6 +37,7 @@
 #include "xls/interpreter/proc_interpreter.h"
 #include "xls/interpreter/proc_runtime.h"
 #include "xls/interpreter/proc_runtime_test_base.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
@@ -98,18 +102,37 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateMixedSerialProcRuntime(
   return std::move(proc_runtime);
 }
 
+// Returns `runtime` after switching it to the dataflow scheduling order.
+std::unique_ptr<ProcRuntime> WithDataflowOrder(
+    std::unique_ptr<SerialProcRuntime> runtime) {
+  CHECK_OK(runtime->SetSchedulingOrder(
+      SerialProcRuntime::SchedulingOrder::kDataflow));
+  return runtime;
+}
+
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateMixedSerialProcRuntime(
     Package* package) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
                        ProcElaboration::ElaborateOldStylePackage(package));
-  return CreateMixedSerialProcRuntime(std::move(elaboration));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> runtime,
+                       CreateMixedSerialProcRuntime(std::move(elaboration)));
+  runtime->set_factory(
+      [package]() -> absl::StatusOr<std::unique_ptr<ProcRuntime>> {
+        return CreateMixedSerialProcRuntime(package);
+      });
+  return std::move(runtime);
 }
 
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateMixedSerialProcRuntime(
     Proc* top) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
                        ProcElaboration::Elaborate(top));
-  return CreateMixedSerialProcRuntime(std::move(elaboration));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> runtime,
+                       CreateMixedSerialProcRuntime(std::move(elaboration)));
+  runtime->set_factory([top]() -> absl::StatusOr<std::unique_ptr<ProcRuntime>> {
+    return CreateMixedSerialProcRuntime(top);
+  });
+  return std::move(runtime);
 }
 
 // Negative test - can we handle asserts
@@ -144,6 +167,86 @@ TEST(SerialProcRuntimeTest, InterpreterAsserts) {
                   ::testing::HasSubstr("Assertion failure via fail!")));
 }
 
+// A three stage pipeline whose procs are declared (and so elaborated) in the
+// reverse order of the dataflow.
+constexpr std::string_view kReversedPipelineIr = R"(
+package p
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=none, metadata="")
+chan s0_s1(bits[32], id=1, kind=streaming, ops=send_receive, flow_control=none, metadata="")
+chan s1_s2(bits[32], id=2, kind=streaming, ops=send_receive, flow_control=none, metadata="")
+chan out(bits[32], id=3, kind=streaming, ops=send_only, flow_control=none, metadata="")
+
+proc stage2(my_token: token, state: (), init={token, ()}) {
+  receive.1: (token, bits[32]) = receive(my_token, channel=s1_s2)
+  tuple_index.2: token = tuple_index(receive.1, index=0)
+  tuple_index.3: bits[32] = tuple_index(receive.1, index=1)
+  literal.4: bits[32] = literal(value=100)
+  add.5: bits[32] = add(tuple_index.3, literal.4)
+  send.6: token = send(tuple_index.2, add.5, channel=out)
+  next (send.6, state)
+}
+
+proc stage1(my_token: token, state: (), init={token, ()}) {
+  receive.11: (token, bits[32]) = receive(my_token, channel=s0_s1)
+  tuple_index.12: token = tuple_index(receive.11, index=0)
+  tuple_index.13: bits[32] = tuple_index(receive.11, index=1)
+  literal.14: bits[32] = literal(value=10)
+  add.15: bits[32] = add(tuple_index.13, literal.14)
+  send.16: token = send(tuple_index.12, add.15, channel=s1_s2)
+  next (send.16, state)
+}
+
+proc stage0(my_token: token, state: (), init={token, ()}) {
+  receive.21: (token, bits[32]) = receive(my_token, channel=in)
+  tuple_index.22: token = tuple_index(receive.21, index=0)
+  tuple_index.23: bits[32] = tuple_index(receive.21, index=1)
+  literal.24: bits[32] = literal(value=1)
+  add.25: bits[32] = add(tuple_index.23, literal.24)
+  send.26: token = send(tuple_index.22, add.25, channel=s0_s1)
+  next (send.26, state)
+}
+)";
+
+TEST(SerialProcRuntimeTest, DataflowOrderAvoidsBlockedActivations) {
+  constexpr int64_t kNumInputs = 8;
+  for (SerialProcRuntime::SchedulingOrder order :
+       {SerialProcRuntime::SchedulingOrder::kElaboration,
+        SerialProcRuntime::SchedulingOrder::kDataflow}) {
+    XLS_ASSERT_OK_AND_ASSIGN(auto package,
+                             Parser::ParsePackage(kReversedPipelineIr));
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SerialProcRuntime> runtime,
+                             CreateInterpreterSerialProcRuntime(package.get()));
+    XLS_ASSERT_OK(runtime->SetSchedulingOrder(order));
+    XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * in,
+                             runtime->queue_manager().GetQueueById(0));
+    XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * out,
+                             runtime->queue_manager().GetQueueById(3));
+    for (int64_t i = 0; i < kNumInputs; ++i) {
+      XLS_ASSERT_OK(in->Write(Value(UBits(i, 32))));
+    }
+    for (int64_t i = 0; i < kNumInputs; ++i) {
+      XLS_ASSERT_OK(runtime->Tick());
+    }
+    for (int64_t i = 0; i < kNumInputs; ++i) {
+      EXPECT_EQ(out->Read(), Value(UBits(i + 111, 32)));
+    }
+
+    const SerialProcRuntime::SchedulingStats& stats =
+        runtime->scheduling_stats();
+    if (order == SerialProcRuntime::SchedulingOrder::kDataflow) {
+      EXPECT_EQ(stats.blocked_activations, 0);
+    } else {
+      // stage2 and stage1 block once per tick before stage0 runs.
+      EXPECT_EQ(stats.blocked_activations, 2 * kNumInputs);
+    }
+    EXPECT_GE(stats.activations, 3 * kNumInputs);
+
+    runtime->ResetSchedulingStats();
+    EXPECT_EQ(runtime->scheduling_stats().activations, 0);
+  }
+}
+
 // Instantiate and run all the tests in proc_runtime_test_base.cc using
 // proc interpreters.
 INSTANTIATE_TEST_SUITE_P(
@@ -157,6 +260,18 @@ INSTANTIATE_TEST_SUITE_P(
             [](Proc* top) -> std::unique_ptr<ProcRuntime> {
               return CreateInterpreterSerialProcRuntime(top).value();
             }),
+        ProcRuntimeTestParam(
+            "flat_interpreter",
+            [](Package* package) -> std::unique_ptr<ProcRuntime> {
+              return CreateInterpreterSerialProcRuntime(
+                         package, {.flat_channel_queues = true})
+                  .value();
+            },
+            [](Proc* top) -> std::unique_ptr<ProcRuntime> {
+              return CreateInterpreterSerialProcRuntime(
+                         top, {.flat_channel_queues = true})
+                  .value();
+            }),
         ProcRuntimeTestParam(
             "jit",
             [](Package* package) -> std::unique_ptr<ProcRuntime> {
@@ -165,6 +280,25 @@ INSTANTIATE_TEST_SUITE_P(
             [](Proc* top) -> std::unique_ptr<ProcRuntime> {
               return CreateJitSerialProcRuntime(top).value();
             }),
+        ProcRuntimeTestParam(
+            "dataflow_interpreter",
+            [](Package* package) -> std::unique_ptr<ProcRuntime> {
+              return WithDataflowOrder(
+                  CreateInterpreterSerialProcRuntime(package).value());
+            },
+            [](Proc* top) -> std::unique_ptr<ProcRuntime> {
+              return WithDataflowOrder(
+                  CreateInterpreterSerialProcRuntime(top).value());
+            }),
+        ProcRuntimeTestParam(
+            "dataflow_jit",
+            [](Package* package) -> std::unique_ptr<ProcRuntime> {
+              return WithDataflowOrder(
+                  CreateJitSerialProcRuntime(package).value());
+            },
+            [](Proc* top) -> std::unique_ptr<ProcRuntime> {
+              return WithDataflowOrder(CreateJitSerialProcRuntime(top).value());
+            }),
         ProcRuntimeTestParam(
             "mixed",
             [](Package* package) -> std::unique_ptr<ProcRuntime> {
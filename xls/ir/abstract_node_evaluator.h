@@ -565,6 +565,13 @@ class AbstractNodeEvaluator : public DfsVisitorWithDefault {
     return std::move(values_);
   }
 
+  // Replaces the values of all nodes with `values`. This allows evaluation to
+  // resume from values computed previously. Nodes which already have a value
+  // must not be visited again.
+  void SetValues(absl::flat_hash_map<Node*, LeafTypeTree<LeafValueT>> values) {
+    values_ = std::move(values);
+  }
+
  protected:
   AbstractEvaluatorT& evaluator() { return evaluator_; }
 
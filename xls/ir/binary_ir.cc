@@ -0,0 +1,1191 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/ir/binary_ir.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/fileno.h"
+#include "xls/ir/foreign_function_data.pb.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/lsb_or_msb.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/op.pb.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/verifier.h"
+
+namespace xls {
+namespace {
+
+enum class TypeKind : uint8_t { kToken, kBits, kTuple, kArray };
+enum class ValueKind : uint8_t { kToken, kBits, kTuple, kArray };
+
+// Flags of a serialized function.
+constexpr uint64_t kHasInitiationInterval = 1 << 0;
+constexpr uint64_t kHasForeignFunctionData = 1 << 1;
+constexpr uint64_t kHasReturnValue = 1 << 2;
+
+class BinaryIrWriter {
+ public:
+  void WriteUnsigned(uint64_t value) {
+    while (value >= 0x80) {
+      out_.push_back(static_cast<char>((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+    out_.push_back(static_cast<char>(value));
+  }
+  // Signed values are zigzag encoded so small negative numbers stay short.
+  void WriteSigned(int64_t value) {
+    WriteUnsigned((static_cast<uint64_t>(value) << 1) ^
+                  static_cast<uint64_t>(value >> 63));
+  }
+  void WriteString(std::string_view s) {
+    WriteUnsigned(s.size());
+    out_.append(s);
+  }
+  void WriteOptionalString(const std::optional<std::string>& s) {
+    WriteUnsigned(s.has_value() ? 1 : 0);
+    if (s.has_value()) {
+      WriteString(*s);
+    }
+  }
+  void WriteBytes(std::string_view bytes) { out_.append(bytes); }
+
+  std::string& out() { return out_; }
+
+ private:
+  std::string out_;
+};
+
+class BinaryIrReader {
+ public:
+  explicit BinaryIrReader(std::string_view data) : data_(data) {}
+
+  absl::StatusOr<uint64_t> ReadUnsigned() {
+    uint64_t value = 0;
+    for (int64_t shift = 0; shift < 64; shift += 7) {
+      if (pos_ >= data_.size()) {
+        return TruncatedError();
+      }
+      uint8_t byte = static_cast<uint8_t>(data_[pos_++]);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Malformed varint at offset %d of binary IR", pos_));
+  }
+  absl::StatusOr<int64_t> ReadSigned() {
+    XLS_ASSIGN_OR_RETURN(uint64_t value, ReadUnsigned());
+    return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+  }
+  // Reads an unsigned value which is used as a count or index and so must not
+  // exceed the size of the remaining input.
+  absl::StatusOr<int64_t> ReadCount() {
+    XLS_ASSIGN_OR_RETURN(uint64_t value, ReadUnsigned());
+    if (value > data_.size()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid count %d at offset %d of binary IR", value, pos_));
+    }
+    return static_cast<int64_t>(value);
+  }
+  // Reads a bit count or array size.
+  absl::StatusOr<int64_t> ReadWidth() {
+    XLS_ASSIGN_OR_RETURN(uint64_t value, ReadUnsigned());
+    if (value > std::numeric_limits<int32_t>::max()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid width %d at offset %d of binary IR", value, pos_));
+    }
+    return static_cast<int64_t>(value);
+  }
+  absl::StatusOr<bool> ReadBool() {
+    XLS_ASSIGN_OR_RETURN(uint64_t value, ReadUnsigned());
+    return value != 0;
+  }
+  // The returned view points into the underlying data.
+  absl::StatusOr<std::string_view> ReadBytes(int64_t count) {
+    if (count > data_.size() - pos_) {
+      return TruncatedError();
+    }
+    std::string_view result = data_.substr(pos_, count);
+    pos_ += count;
+    return result;
+  }
+  absl::StatusOr<std::string_view> ReadString() {
+    XLS_ASSIGN_OR_RETURN(int64_t size, ReadCount());
+    return ReadBytes(size);
+  }
+  absl::StatusOr<std::optional<std::string>> ReadOptionalString() {
+    XLS_ASSIGN_OR_RETURN(bool present, ReadBool());
+    if (!present) {
+      return std::nullopt;
+    }
+    XLS_ASSIGN_OR_RETURN(std::string_view s, ReadString());
+    return std::string(s);
+  }
+
+  bool AtEnd() const { return pos_ == data_.size(); }
+
+ private:
+  absl::Status TruncatedError() const {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Binary IR is truncated at offset %d", pos_));
+  }
+
+  std::string_view data_;
+  int64_t pos_ = 0;
+};
+
+void WriteValue(const Value& value, BinaryIrWriter& writer) {
+  if (value.IsToken()) {
+    writer.WriteUnsigned(static_cast<uint64_t>(ValueKind::kToken));
+  } else if (value.IsBits()) {
+    writer.WriteUnsigned(static_cast<uint64_t>(ValueKind::kBits));
+    writer.WriteUnsigned(value.bits().bit_count());
+    std::vector<uint8_t> bytes = value.bits().ToBytes();
+    writer.WriteBytes(std::string_view(reinterpret_cast<const char*>(
+                                           bytes.data()),
+                                       bytes.size()));
+  } else {
+    writer.WriteUnsigned(static_cast<uint64_t>(
+        value.IsTuple() ? ValueKind::kTuple : ValueKind::kArray));
+    writer.WriteUnsigned(value.elements().size());
+    for (const Value& element : value.elements()) {
+      WriteValue(element, writer);
+    }
+  }
+}
+
+absl::StatusOr<Value> ReadValue(BinaryIrReader& reader) {
+  XLS_ASSIGN_OR_RETURN(uint64_t kind, reader.ReadUnsigned());
+  switch (static_cast<ValueKind>(kind)) {
+    case ValueKind::kToken:
+      return Value::Token();
+    case ValueKind::kBits: {
+      XLS_ASSIGN_OR_RETURN(int64_t bit_count, reader.ReadWidth());
+      XLS_ASSIGN_OR_RETURN(std::string_view bytes,
+                           reader.ReadBytes((bit_count + 7) / 8));
+      return Value(Bits::FromBytes(
+          absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(bytes.data()),
+                              bytes.size()),
+          bit_count));
+    }
+    case ValueKind::kTuple:
+    case ValueKind::kArray: {
+      XLS_ASSIGN_OR_RETURN(int64_t size, reader.ReadCount());
+      std::vector<Value> elements;
+      elements.reserve(size);
+      for (int64_t i = 0; i < size; ++i) {
+        XLS_ASSIGN_OR_RETURN(Value element, ReadValue(reader));
+        elements.push_back(std::move(element));
+      }
+      if (static_cast<ValueKind>(kind) == ValueKind::kTuple) {
+        return Value::TupleOwned(std::move(elements));
+      }
+      return Value::Array(elements);
+    }
+  }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Invalid value kind %d in binary IR", kind));
+}
+
+// Serializes the functions of a package. Types are interned into a separate
+// table which is emitted ahead of the functions so that readers can resolve
+// type references as they go.
+class PackageSerializer {
+ public:
+  explicit PackageSerializer(const Package& package) : package_(package) {}
+
+  absl::StatusOr<std::string> Serialize() {
+    if (!package_.channels().empty() || !package_.procs().empty() ||
+        !package_.blocks().empty()) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "Binary IR does not support channels, procs or blocks; package `%s` "
+          "must be emitted as text",
+          package_.name()));
+    }
+    body_.WriteUnsigned(package_.functions().size());
+    for (int64_t i = 0; i < package_.functions().size(); ++i) {
+      Function* function = package_.functions()[i].get();
+      function_indices_[function] = i;
+      XLS_RETURN_IF_ERROR(WriteFunction(function));
+    }
+    std::optional<FunctionBase*> top = package_.GetTop();
+    body_.WriteUnsigned(top.has_value() ? 1 : 0);
+    if (top.has_value()) {
+      body_.WriteUnsigned(function_indices_.at(top.value()));
+    }
+
+    BinaryIrWriter header;
+    header.WriteBytes(kBinaryIrMagic);
+    header.WriteUnsigned(kBinaryIrVersion);
+    header.WriteString(package_.name());
+    std::vector<std::pair<Fileno, std::string>> files(
+        package_.fileno_to_name().begin(), package_.fileno_to_name().end());
+    absl::c_sort(files);
+    header.WriteUnsigned(files.size());
+    for (const auto& [fileno, filename] : files) {
+      header.WriteSigned(fileno.value());
+      header.WriteString(filename);
+    }
+    header.WriteUnsigned(type_count_);
+    header.WriteBytes(types_.out());
+    header.WriteBytes(body_.out());
+    return std::move(header.out());
+  }
+
+ private:
+  // Returns the index of `type` in the type table, adding it (and its element
+  // types) if not yet present.
+  int64_t TypeIndex(Type* type) {
+    auto it = type_indices_.find(type);
+    if (it != type_indices_.end()) {
+      return it->second;
+    }
+    if (type->IsToken()) {
+      types_.WriteUnsigned(static_cast<uint64_t>(TypeKind::kToken));
+    } else if (type->IsBits()) {
+      types_.WriteUnsigned(static_cast<uint64_t>(TypeKind::kBits));
+      types_.WriteUnsigned(type->AsBitsOrDie()->bit_count());
+    } else if (type->IsTuple()) {
+      std::vector<int64_t> elements;
+      for (Type* element : type->AsTupleOrDie()->element_types()) {
+        elements.push_back(TypeIndex(element));
+      }
+      types_.WriteUnsigned(static_cast<uint64_t>(TypeKind::kTuple));
+      types_.WriteUnsigned(elements.size());
+      for (int64_t element : elements) {
+        types_.WriteUnsigned(element);
+      }
+    } else {
+      int64_t element = TypeIndex(type->AsArrayOrDie()->element_type());
+      types_.WriteUnsigned(static_cast<uint64_t>(TypeKind::kArray));
+      types_.WriteUnsigned(type->AsArrayOrDie()->size());
+      types_.WriteUnsigned(element);
+    }
+    int64_t index = type_count_++;
+    type_indices_[type] = index;
+    return index;
+  }
+
+  absl::Status WriteFunction(Function* function) {
+    body_.WriteString(function->name());
+    uint64_t flags = 0;
+    if (function->GetInitiationInterval().has_value()) {
+      flags |= kHasInitiationInterval;
+    }
+    if (function->ForeignFunctionData().has_value()) {
+      flags |= kHasForeignFunctionData;
+    }
+    if (function->return_value() != nullptr) {
+      flags |= kHasReturnValue;
+    }
+    body_.WriteUnsigned(flags);
+    if (function->GetInitiationInterval().has_value()) {
+      body_.WriteSigned(*function->GetInitiationInterval());
+    }
+    if (function->ForeignFunctionData().has_value()) {
+      body_.WriteString(function->ForeignFunctionData()->SerializeAsString());
+    }
+
+    // Params come first in declaration order, followed by the remaining nodes
+    // in the same order DumpIr emits them.
+    body_.WriteUnsigned(function->node_count());
+    for (Param* param : function->params()) {
+      XLS_RETURN_IF_ERROR(WriteNode(param));
+    }
+    for (Node* node : TopoSort(function)) {
+      if (!node->Is<Param>()) {
+        XLS_RETURN_IF_ERROR(WriteNode(node));
+      }
+    }
+    if (function->return_value() != nullptr) {
+      body_.WriteSigned(function->return_value()->id());
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status WriteNode(Node* node) {
+    body_.WriteUnsigned(ToOpProto(node->op()));
+    body_.WriteSigned(node->id());
+    body_.WriteOptionalString(node->HasAssignedName()
+                                  ? std::make_optional(node->GetName())
+                                  : std::nullopt);
+    body_.WriteUnsigned(TypeIndex(node->GetType()));
+    body_.WriteUnsigned(node->loc().locations.size());
+    for (const SourceLocation& location : node->loc().locations) {
+      body_.WriteSigned(location.fileno().value());
+      body_.WriteSigned(location.lineno().value());
+      body_.WriteSigned(location.colno().value());
+    }
+    body_.WriteUnsigned(node->operand_count());
+    for (Node* operand : node->operands()) {
+      body_.WriteSigned(operand->id());
+    }
+    return WriteAttributes(node);
+  }
+
+  // Writes the data members of `node` which are not implied by its operands
+  // and type.
+  absl::Status WriteAttributes(Node* node) {
+    switch (node->op()) {
+      case Op::kMinDelay:
+        body_.WriteSigned(node->As<MinDelay>()->delay());
+        break;
+      case Op::kArraySlice:
+        body_.WriteSigned(node->As<ArraySlice>()->width());
+        break;
+      case Op::kSMul:
+      case Op::kUMul:
+        body_.WriteSigned(node->As<ArithOp>()->width());
+        break;
+      case Op::kSMulp:
+      case Op::kUMulp:
+        body_.WriteSigned(node->As<PartialProductOp>()->width());
+        break;
+      case Op::kAssert: {
+        Assert* assert = node->As<Assert>();
+        body_.WriteString(assert->message());
+        body_.WriteOptionalString(assert->label());
+        body_.WriteOptionalString(assert->original_label());
+        break;
+      }
+      case Op::kCover: {
+        Cover* cover = node->As<Cover>();
+        body_.WriteString(cover->label());
+        body_.WriteOptionalString(cover->original_label());
+        break;
+      }
+      case Op::kTrace: {
+        Trace* trace = node->As<Trace>();
+        body_.WriteSigned(trace->verbosity());
+        body_.WriteUnsigned(trace->format().size());
+        for (const FormatStep& step : trace->format()) {
+          if (std::holds_alternative<std::string>(step)) {
+            body_.WriteUnsigned(0);
+            body_.WriteString(std::get<std::string>(step));
+          } else {
+            body_.WriteUnsigned(
+                1 + static_cast<uint64_t>(std::get<FormatPreference>(step)));
+          }
+        }
+        break;
+      }
+      case Op::kBitSlice:
+        body_.WriteSigned(node->As<BitSlice>()->start());
+        body_.WriteSigned(node->As<BitSlice>()->width());
+        break;
+      case Op::kDynamicBitSlice:
+        body_.WriteSigned(node->As<DynamicBitSlice>()->width());
+        break;
+      case Op::kCountedFor: {
+        CountedFor* counted_for = node->As<CountedFor>();
+        body_.WriteSigned(counted_for->trip_count());
+        body_.WriteSigned(counted_for->stride());
+        XLS_RETURN_IF_ERROR(WriteFunctionRef(counted_for->body()));
+        break;
+      }
+      case Op::kDynamicCountedFor:
+        XLS_RETURN_IF_ERROR(
+            WriteFunctionRef(node->As<DynamicCountedFor>()->body()));
+        break;
+      case Op::kSignExt:
+      case Op::kZeroExt:
+        body_.WriteSigned(node->As<ExtendOp>()->new_bit_count());
+        break;
+      case Op::kInvoke:
+        XLS_RETURN_IF_ERROR(WriteFunctionRef(node->As<Invoke>()->to_apply()));
+        break;
+      case Op::kLiteral:
+        WriteValue(node->As<Literal>()->value(), body_);
+        break;
+      case Op::kMap:
+        XLS_RETURN_IF_ERROR(WriteFunctionRef(node->As<Map>()->to_apply()));
+        break;
+      case Op::kOneHot:
+        body_.WriteUnsigned(
+            static_cast<uint64_t>(node->As<OneHot>()->priority()));
+        break;
+      case Op::kSel:
+        body_.WriteUnsigned(
+            node->As<Select>()->default_value().has_value() ? 1 : 0);
+        break;
+      case Op::kTupleIndex:
+        body_.WriteSigned(node->As<TupleIndex>()->index());
+        break;
+      case Op::kDecode:
+        body_.WriteSigned(node->As<Decode>()->width());
+        break;
+      case Op::kReceive:
+      case Op::kSend:
+      case Op::kNext:
+      case Op::kInputPort:
+      case Op::kOutputPort:
+      case Op::kRegisterRead:
+      case Op::kRegisterWrite:
+      case Op::kInstantiationInput:
+      case Op::kInstantiationOutput:
+        return absl::UnimplementedError(absl::StrFormat(
+            "Binary IR does not support node: %s", node->ToString()));
+      default:
+        // Everything else is fully described by its op, operands and type.
+        break;
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status WriteFunctionRef(Function* function) {
+    auto it = function_indices_.find(function);
+    XLS_RET_CHECK(it != function_indices_.end())
+        << "Function `" << function->name()
+        << "` is called before it is defined";
+    body_.WriteUnsigned(it->second);
+    return absl::OkStatus();
+  }
+
+  const Package& package_;
+  BinaryIrWriter types_;
+  BinaryIrWriter body_;
+  int64_t type_count_ = 0;
+  absl::flat_hash_map<Type*, int64_t> type_indices_;
+  absl::flat_hash_map<const FunctionBase*, int64_t> function_indices_;
+};
+
+class PackageDeserializer {
+ public:
+  explicit PackageDeserializer(std::string_view data) : reader_(data) {}
+
+  absl::StatusOr<std::unique_ptr<Package>> Deserialize() {
+    XLS_ASSIGN_OR_RETURN(std::string_view magic,
+                         reader_.ReadBytes(kBinaryIrMagic.size()));
+    if (magic != kBinaryIrMagic) {
+      return absl::InvalidArgumentError("Input is not binary IR");
+    }
+    XLS_ASSIGN_OR_RETURN(uint64_t version, reader_.ReadUnsigned());
+    if (version != kBinaryIrVersion) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Unsupported binary IR version %d; expected %d",
+                          version, kBinaryIrVersion));
+    }
+    XLS_ASSIGN_OR_RETURN(std::string_view name, reader_.ReadString());
+    package_ = std::make_unique<Package>(name);
+
+    XLS_ASSIGN_OR_RETURN(int64_t file_count, reader_.ReadCount());
+    for (int64_t i = 0; i < file_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(int64_t fileno, reader_.ReadSigned());
+      XLS_ASSIGN_OR_RETURN(std::string_view filename, reader_.ReadString());
+      package_->SetFileno(Fileno(static_cast<int32_t>(fileno)), filename);
+    }
+
+    XLS_ASSIGN_OR_RETURN(int64_t type_count, reader_.ReadCount());
+    types_.reserve(type_count);
+    for (int64_t i = 0; i < type_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(Type * type, ReadTypeEntry());
+      types_.push_back(type);
+    }
+
+    XLS_ASSIGN_OR_RETURN(int64_t function_count, reader_.ReadCount());
+    for (int64_t i = 0; i < function_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(Function * function, ReadFunction());
+      functions_.push_back(function);
+    }
+    XLS_ASSIGN_OR_RETURN(bool has_top, reader_.ReadBool());
+    if (has_top) {
+      XLS_ASSIGN_OR_RETURN(Function * top, ReadFunctionRef());
+      XLS_RETURN_IF_ERROR(package_->SetTop(top));
+    }
+    if (!reader_.AtEnd()) {
+      return absl::InvalidArgumentError("Trailing data after binary IR");
+    }
+    XLS_RETURN_IF_ERROR(VerifyPackage(package_.get()));
+    return std::move(package_);
+  }
+
+ private:
+  absl::StatusOr<Type*> ReadTypeEntry() {
+    XLS_ASSIGN_OR_RETURN(uint64_t kind, reader_.ReadUnsigned());
+    switch (static_cast<TypeKind>(kind)) {
+      case TypeKind::kToken:
+        return package_->GetTokenType();
+      case TypeKind::kBits: {
+        XLS_ASSIGN_OR_RETURN(int64_t bit_count, reader_.ReadWidth());
+        return package_->GetBitsType(bit_count);
+      }
+      case TypeKind::kTuple: {
+        XLS_ASSIGN_OR_RETURN(int64_t size, reader_.ReadCount());
+        std::vector<Type*> elements;
+        elements.reserve(size);
+        for (int64_t i = 0; i < size; ++i) {
+          XLS_ASSIGN_OR_RETURN(Type * element, ReadTypeRef());
+          elements.push_back(element);
+        }
+        return package_->GetTupleType(elements);
+      }
+      case TypeKind::kArray: {
+        XLS_ASSIGN_OR_RETURN(int64_t size, reader_.ReadWidth());
+        XLS_ASSIGN_OR_RETURN(Type * element, ReadTypeRef());
+        return package_->GetArrayType(size, element);
+      }
+    }
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid type kind %d in binary IR", kind));
+  }
+
+  absl::StatusOr<Type*> ReadTypeRef() {
+    XLS_ASSIGN_OR_RETURN(int64_t index, reader_.ReadCount());
+    if (index >= types_.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid type index %d in binary IR", index));
+    }
+    return types_[index];
+  }
+
+  absl::StatusOr<Function*> ReadFunctionRef() {
+    XLS_ASSIGN_OR_RETURN(int64_t index, reader_.ReadCount());
+    if (index >= functions_.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid function index %d in binary IR", index));
+    }
+    return functions_[index];
+  }
+
+  absl::StatusOr<Function*> ReadFunction() {
+    XLS_ASSIGN_OR_RETURN(std::string_view name, reader_.ReadString());
+    Function* function = package_->AddFunction(
+        std::make_unique<Function>(name, package_.get()));
+    XLS_ASSIGN_OR_RETURN(uint64_t flags, reader_.ReadUnsigned());
+    if (flags & kHasInitiationInterval) {
+      XLS_ASSIGN_OR_RETURN(int64_t ii, reader_.ReadSigned());
+      function->SetInitiationInterval(ii);
+    }
+    if (flags & kHasForeignFunctionData) {
+      XLS_ASSIGN_OR_RETURN(std::string_view serialized, reader_.ReadString());
+      ForeignFunctionData ffi;
+      if (!ffi.ParseFromArray(serialized.data(), serialized.size())) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Invalid foreign function data for function `%s` in binary IR",
+            name));
+      }
+      function->SetForeignFunctionData(ffi);
+    }
+
+    absl::flat_hash_map<int64_t, Node*> nodes;
+    XLS_ASSIGN_OR_RETURN(int64_t node_count, reader_.ReadCount());
+    nodes.reserve(node_count);
+    for (int64_t i = 0; i < node_count; ++i) {
+      XLS_RETURN_IF_ERROR(ReadNode(function, nodes));
+    }
+    if (flags & kHasReturnValue) {
+      XLS_ASSIGN_OR_RETURN(Node * return_value, ReadNodeRef(nodes));
+      XLS_RETURN_IF_ERROR(function->set_return_value(return_value));
+    }
+    return function;
+  }
+
+  absl::StatusOr<Node*> ReadNodeRef(
+      const absl::flat_hash_map<int64_t, Node*>& nodes) {
+    XLS_ASSIGN_OR_RETURN(int64_t id, reader_.ReadSigned());
+    auto it = nodes.find(id);
+    if (it == nodes.end()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Reference to undefined node id %d in binary IR", id));
+    }
+    return it->second;
+  }
+
+  absl::Status ReadNode(Function* function,
+                        absl::flat_hash_map<int64_t, Node*>& nodes) {
+    XLS_ASSIGN_OR_RETURN(uint64_t op_proto, reader_.ReadUnsigned());
+    if (!OpProto_IsValid(static_cast<int>(op_proto)) ||
+        op_proto == OP_INVALID) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid op %d in binary IR", op_proto));
+    }
+    Op op = FromOpProto(static_cast<OpProto>(op_proto));
+    XLS_ASSIGN_OR_RETURN(int64_t id, reader_.ReadSigned());
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> name,
+                         reader_.ReadOptionalString());
+    XLS_ASSIGN_OR_RETURN(Type * type, ReadTypeRef());
+    XLS_ASSIGN_OR_RETURN(int64_t location_count, reader_.ReadCount());
+    SourceInfo loc;
+    loc.locations.reserve(location_count);
+    for (int64_t i = 0; i < location_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(int64_t fileno, reader_.ReadSigned());
+      XLS_ASSIGN_OR_RETURN(int64_t lineno, reader_.ReadSigned());
+      XLS_ASSIGN_OR_RETURN(int64_t colno, reader_.ReadSigned());
+      loc.locations.push_back(SourceLocation(
+          Fileno(static_cast<int32_t>(fileno)),
+          Lineno(static_cast<int32_t>(lineno)),
+          Colno(static_cast<int32_t>(colno))));
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t operand_count, reader_.ReadCount());
+    std::vector<Node*> operands;
+    operands.reserve(operand_count);
+    for (int64_t i = 0; i < operand_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(Node * operand, ReadNodeRef(nodes));
+      operands.push_back(operand);
+    }
+
+    XLS_ASSIGN_OR_RETURN(
+        Node * node, MakeNode(function, op, loc, name.value_or(""), type,
+                              absl::MakeConstSpan(operands)));
+    if (node->GetType() != type) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Declared type %s of node %s does not match its computed type %s",
+          type->ToString(), node->GetName(), node->GetType()->ToString()));
+    }
+    node->SetId(id);
+    if (!nodes.emplace(id, node).second) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Duplicate node id %d in binary IR", id));
+    }
+    return absl::OkStatus();
+  }
+
+  // Constructs the node for `op` from `operands`, reading any remaining
+  // attributes from the stream.
+  absl::StatusOr<Node*> MakeNode(FunctionBase* f, Op op, const SourceInfo& loc,
+                                 std::string_view name, Type* type,
+                                 absl::Span<Node* const> operands) {
+    auto check_operands = [&](int64_t min_count,
+                              std::optional<int64_t> max_count =
+                                  std::nullopt) -> absl::Status {
+      if (operands.size() < min_count ||
+          operands.size() > max_count.value_or(min_count)) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Invalid operand count %d for %s node %s in binary IR",
+            operands.size(), OpToString(op), name));
+      }
+      return absl::OkStatus();
+    };
+    constexpr int64_t kUnbounded = std::numeric_limits<int64_t>::max();
+    switch (op) {
+      case Op::kAdd:
+      case Op::kSDiv:
+      case Op::kSMod:
+      case Op::kShll:
+      case Op::kShrl:
+      case Op::kShra:
+      case Op::kSub:
+      case Op::kUDiv:
+      case Op::kUMod:
+        XLS_RETURN_IF_ERROR(check_operands(2));
+        return f->MakeNodeWithName<BinOp>(loc, operands[0], operands[1], op,
+                                          name);
+      case Op::kAnd:
+      case Op::kNand:
+      case Op::kNor:
+      case Op::kOr:
+      case Op::kXor:
+        return f->MakeNodeWithName<NaryOp>(loc, operands, op, name);
+      case Op::kAndReduce:
+      case Op::kOrReduce:
+      case Op::kXorReduce:
+        XLS_RETURN_IF_ERROR(check_operands(1));
+        return f->MakeNodeWithName<BitwiseReductionOp>(loc, operands[0], op,
+                                                       name);
+      case Op::kAssert: {
+        XLS_RETURN_IF_ERROR(check_operands(2));
+        XLS_ASSIGN_OR_RETURN(std::string_view message, reader_.ReadString());
+        XLS_ASSIGN_OR_RETURN(std::optional<std::string> label,
+                             reader_.ReadOptionalString());
+        XLS_ASSIGN_OR_RETURN(std::optional<std::string> original_label,
+                             reader_.ReadOptionalString());
+        return f->MakeNodeWithName<Assert>(loc, operands[0], operands[1],
+                                           message, label, original_label,
+                                           name);
+      }
+      case Op::kCover: {
+        XLS_RETURN_IF_ERROR(check_operands(1));
+        XLS_ASSIGN_OR_RETURN(std::string_view label, reader_.ReadString());
+        XLS_ASSIGN_OR_RETURN(std::optional<std::string> original_label,
+                             reader_.ReadOptionalString());
+        return f->MakeNodeWithName<Cover>(loc, operands[0], label,
+                                          original_label, name);
+      }
+      case Op::kTrace: {
+        XLS_RETURN_IF_ERROR(check_operands(2, kUnbounded));
+        XLS_ASSIGN_OR_RETURN(int64_t verbosity, reader_.ReadSigned());
+        XLS_ASSIGN_OR_RETURN(int64_t step_count, reader_.ReadCount());
+        std::vector<FormatStep> format;
+        format.reserve(step_count);
+        for (int64_t i = 0; i < step_count; ++i) {
+          XLS_ASSIGN_OR_RETURN(uint64_t step_kind, reader_.ReadUnsigned());
+          if (step_kind == 0) {
+            XLS_ASSIGN_OR_RETURN(std::string_view text, reader_.ReadString());
+            format.push_back(std::string(text));
+          } else if (step_kind - 1 <=
+                     static_cast<uint64_t>(FormatPreference::kPlainHex)) {
+            format.push_back(static_cast<FormatPreference>(step_kind - 1));
+          } else {
+            return absl::InvalidArgumentError(absl::StrFormat(
+                "Invalid format step %d in binary IR", step_kind));
+          }
+        }
+        return f->MakeNodeWithName<Trace>(loc, operands[0], operands[1],
+                                          operands.subspan(2), format,
+                                          verbosity, name);
+      }
+      case Op::kAfterAll:
+        return f->MakeNodeWithName<AfterAll>(loc, operands, name);
+      case Op::kMinDelay: {
+        XLS_RETURN_IF_ERROR(check_operands(1));
+        XLS_ASSIGN_OR_RETURN(int64_t delay, reader_.ReadSigned());
+        return f->MakeNodeWithName<MinDelay>(loc, operands[0], delay, name);
+      }
+      case Op::kArray: {
+        if (!type->IsArray()) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Array node %s in binary IR has non-array type %s", name,
+              type->ToString()));
+        }
+        return f->MakeNodeWithName<Array>(
+            loc, operands, type->AsArrayOrDie()->element_type(), name);
+      }
+      case Op::kArrayIndex:
+        XLS_RETURN_IF_ERROR(check_operands(1, kUnbounded));
+        return f->MakeNodeWithName<ArrayIndex>(loc, operands[0],
+                                               operands.subspan(1), name);
+      case Op::kArraySlice: {
+        XLS_RETURN_IF_ERROR(check_operands(2));
+        XLS_ASSIGN_OR_RETURN(int64_t width, reader_.ReadSigned());
+        return f->MakeNodeWithName<ArraySlice>(loc, operands[0], operands[1],
+                                               width, name);
+      }
+      case Op::kArrayUpdate:
+        XLS_RETURN_IF_ERROR(check_operands(2, kUnbounded));
+        return f->MakeNodeWithName<ArrayUpdate>(
+            loc, operands[0], operands[1], operands.subspan(2), name);
+      case Op::kArrayConcat:
+        return f->MakeNodeWithName<ArrayConcat>(loc, operands, name);
+      case Op::kBitSlice: {
+        XLS_RETURN_IF_ERROR(check_operands(1));
+        XLS_ASSIGN_OR_RETURN(int64_t start, reader_.ReadSigned());
+        XLS_ASSIGN_OR_RETURN(int64_t width, reader_.ReadSigned());
+        return f->MakeNodeWithName<BitSlice>(loc, operands[0], start, width,
+                                             name);
+      }
+      case Op::kDynamicBitSlice: {
+        XLS_RETURN_IF_ERROR(check_operands(2));
+        XLS_ASSIGN_OR_RETURN(int64_t width, reader_.ReadSigned());
+        return f->MakeNodeWithName<DynamicBitSlice>(loc, operands[0],
+                                                    operands[1], width, name);
+      }
+      case Op::kBitSliceUpdate:
+        XLS_RETURN_IF_ERROR(check_operands(3));
+        return f->MakeNodeWithName<BitSliceUpdate>(
+            loc, operands[0], operands[1], operands[2], name);
+      case Op::kConcat:
+        return f->MakeNodeWithName<Concat>(loc, operands, name);
+      case Op::kCountedFor: {
+        XLS_RETURN_IF_ERROR(check_operands(1, kUnbounded));
+        XLS_ASSIGN_OR_RETURN(int64_t trip_count, reader_.ReadSigned());
+        XLS_ASSIGN_OR_RETURN(int64_t stride, reader_.ReadSigned());
+        XLS_ASSIGN_OR_RETURN(Function * body, ReadFunctionRef());
+        return f->MakeNodeWithName<CountedFor>(loc, operands[0],
+                                               operands.subspan(1), trip_count,
+                                               stride, body, name);
+      }
+      case Op::kDynamicCountedFor: {
+        XLS_RETURN_IF_ERROR(check_operands(3, kUnbounded));
+        XLS_ASSIGN_OR_RETURN(Function * body, ReadFunctionRef());
+        return f->MakeNodeWithName<DynamicCountedFor>(
+            loc, operands[0], operands[1], operands[2], operands.subspan(3),
+            body, name);
+      }
+      case Op::kDecode: {
+        XLS_RETURN_IF_ERROR(check_operands(1));
+        XLS_ASSIGN_OR_RETURN(int64_t width, reader_.ReadSigned());
+        return f->MakeNodeWithName<Decode>(loc, operands[0], width, name);
+      }
+      case Op::kEncode:
+        XLS_RETURN_IF_ERROR(check_operands(1));
+        return f->MakeNodeWithName<Encode>(loc, operands[0], name);
+      case Op::kEq:
+      case Op::kNe:
+      case Op::kSGe:
+      case Op::kSGt:
+      case Op::kSLe:
+      case Op::kSLt:
+      case Op::kUGe:
+      case Op::kUGt:
+      case Op::kULe:
+      case Op::kULt:
+        XLS_RETURN_IF_ERROR(check_operands(2));
+        return f->MakeNodeWithName<CompareOp>(loc, operands[0], operands[1],
+                                              op, name);
+      case Op::kIdentity:
+      case Op::kNeg:
+      case Op::kNot:
+      case Op::kReverse:
+        XLS_RETURN_IF_ERROR(check_operands(1));
+        return f->MakeNodeWithName<UnOp>(loc, operands[0], op, name);
+      case Op::kInvoke: {
+        XLS_ASSIGN_OR_RETURN(Function * to_apply, ReadFunctionRef());
+        return f->MakeNodeWithName<Invoke>(loc, operands, to_apply, name);
+      }
+      case Op::kLiteral: {
+        XLS_RETURN_IF_ERROR(check_operands(0));
+        XLS_ASSIGN_OR_RETURN(Value value, ReadValue(reader_));
+        return f->MakeNodeWithName<Literal>(loc, std::move(value), name);
+      }
+      case Op::kMap: {
+        XLS_RETURN_IF_ERROR(check_operands(1));
+        XLS_ASSIGN_OR_RETURN(Function * to_apply, ReadFunctionRef());
+        return f->MakeNodeWithName<Map>(loc, operands[0], to_apply, name);
+      }
+      case Op::kOneHot: {
+        XLS_RETURN_IF_ERROR(check_operands(1));
+        XLS_ASSIGN_OR_RETURN(uint64_t priority, reader_.ReadUnsigned());
+        if (priority > static_cast<uint64_t>(LsbOrMsb::kMsb)) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Invalid one-hot priority %d in binary IR", priority));
+        }
+        return f->MakeNodeWithName<OneHot>(
+            loc, operands[0], static_cast<LsbOrMsb>(priority), name);
+      }
+      case Op::kOneHotSel:
+        XLS_RETURN_IF_ERROR(check_operands(1, kUnbounded));
+        return f->MakeNodeWithName<OneHotSelect>(loc, operands[0],
+                                                 operands.subspan(1), name);
+      case Op::kPrioritySel:
+        XLS_RETURN_IF_ERROR(check_operands(2, kUnbounded));
+        return f->MakeNodeWithName<PrioritySelect>(
+            loc, operands[0], operands.subspan(1, operands.size() - 2),
+            operands.back(), name);
+      case Op::kParam:
+        XLS_RETURN_IF_ERROR(check_operands(0));
+        return f->MakeNodeWithName<Param>(loc, type, name);
+      case Op::kSel: {
+        XLS_ASSIGN_OR_RETURN(bool has_default, reader_.ReadBool());
+        XLS_RETURN_IF_ERROR(check_operands(has_default ? 2 : 1, kUnbounded));
+        std::optional<Node*> default_value;
+        absl::Span<Node* const> cases = operands.subspan(1);
+        if (has_default) {
+          default_value = operands.back();
+          cases.remove_suffix(1);
+        }
+        return f->MakeNodeWithName<Select>(loc, operands[0], cases,
+                                           default_value, name);
+      }
+      case Op::kSignExt:
+      case Op::kZeroExt: {
+        XLS_RETURN_IF_ERROR(check_operands(1));
+        XLS_ASSIGN_OR_RETURN(int64_t new_bit_count, reader_.ReadSigned());
+        return f->MakeNodeWithName<ExtendOp>(loc, operands[0], new_bit_count,
+                                             op, name);
+      }
+      case Op::kSMul:
+      case Op::kUMul: {
+        XLS_RETURN_IF_ERROR(check_operands(2));
+        XLS_ASSIGN_OR_RETURN(int64_t width, reader_.ReadSigned());
+        return f->MakeNodeWithName<ArithOp>(loc, operands[0], operands[1],
+                                            width, op, name);
+      }
+      case Op::kSMulp:
+      case Op::kUMulp: {
+        XLS_RETURN_IF_ERROR(check_operands(2));
+        XLS_ASSIGN_OR_RETURN(int64_t width, reader_.ReadSigned());
+        return f->MakeNodeWithName<PartialProductOp>(
+            loc, operands[0], operands[1], width, op, name);
+      }
+      case Op::kTuple:
+        return f->MakeNodeWithName<Tuple>(loc, operands, name);
+      case Op::kTupleIndex: {
+        XLS_RETURN_IF_ERROR(check_operands(1));
+        XLS_ASSIGN_OR_RETURN(int64_t index, reader_.ReadSigned());
+        return f->MakeNodeWithName<TupleIndex>(loc, operands[0], index, name);
+      }
+      case Op::kGate:
+        XLS_RETURN_IF_ERROR(check_operands(2));
+        return f->MakeNodeWithName<Gate>(loc, operands[0], operands[1], name);
+      default:
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Binary IR does not support %s nodes", OpToString(op)));
+    }
+  }
+
+  BinaryIrReader reader_;
+  std::unique_ptr<Package> package_;
+  std::vector<Type*> types_;
+  std::vector<Function*> functions_;
+};
+
+// Decodes binary IR for ScanBinaryIr. Mirrors PackageDeserializer but keeps
+// only the flat bit count of each type and skips over node attributes.
+class PackageScanner {
+ public:
+  PackageScanner(std::string_view data, BinaryIrScanVisitor& visitor)
+      : reader_(data), visitor_(visitor) {}
+
+  absl::Status Scan() {
+    XLS_ASSIGN_OR_RETURN(std::string_view magic,
+                         reader_.ReadBytes(kBinaryIrMagic.size()));
+    if (magic != kBinaryIrMagic) {
+      return absl::InvalidArgumentError("Input is not binary IR");
+    }
+    XLS_ASSIGN_OR_RETURN(uint64_t version, reader_.ReadUnsigned());
+    if (version != kBinaryIrVersion) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Unsupported binary IR version %d; expected %d",
+                          version, kBinaryIrVersion));
+    }
+    XLS_RETURN_IF_ERROR(reader_.ReadString().status());
+
+    XLS_ASSIGN_OR_RETURN(int64_t file_count, reader_.ReadCount());
+    for (int64_t i = 0; i < file_count; ++i) {
+      XLS_RETURN_IF_ERROR(reader_.ReadSigned().status());
+      XLS_RETURN_IF_ERROR(reader_.ReadString().status());
+    }
+
+    XLS_ASSIGN_OR_RETURN(int64_t type_count, reader_.ReadCount());
+    flat_bit_counts_.reserve(type_count);
+    for (int64_t i = 0; i < type_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(int64_t flat_bit_count, ReadTypeEntry());
+      flat_bit_counts_.push_back(flat_bit_count);
+    }
+
+    XLS_ASSIGN_OR_RETURN(int64_t function_count, reader_.ReadCount());
+    for (int64_t i = 0; i < function_count; ++i) {
+      XLS_RETURN_IF_ERROR(ScanFunction());
+    }
+    XLS_ASSIGN_OR_RETURN(bool has_top, reader_.ReadBool());
+    if (has_top) {
+      XLS_RETURN_IF_ERROR(reader_.ReadCount().status());
+    }
+    if (!reader_.AtEnd()) {
+      return absl::InvalidArgumentError("Trailing data after binary IR");
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  // Returns the flat bit count of the type entry.
+  absl::StatusOr<int64_t> ReadTypeEntry() {
+    XLS_ASSIGN_OR_RETURN(uint64_t kind, reader_.ReadUnsigned());
+    switch (static_cast<TypeKind>(kind)) {
+      case TypeKind::kToken:
+        return 0;
+      case TypeKind::kBits:
+        return reader_.ReadWidth();
+      case TypeKind::kTuple: {
+        XLS_ASSIGN_OR_RETURN(int64_t size, reader_.ReadCount());
+        int64_t flat_bit_count = 0;
+        for (int64_t i = 0; i < size; ++i) {
+          XLS_ASSIGN_OR_RETURN(int64_t element, ReadTypeRef());
+          flat_bit_count += element;
+        }
+        return flat_bit_count;
+      }
+      case TypeKind::kArray: {
+        XLS_ASSIGN_OR_RETURN(int64_t size, reader_.ReadWidth());
+        XLS_ASSIGN_OR_RETURN(int64_t element, ReadTypeRef());
+        return size * element;
+      }
+    }
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid type kind %d in binary IR", kind));
+  }
+
+  absl::StatusOr<int64_t> ReadTypeRef() {
+    XLS_ASSIGN_OR_RETURN(int64_t index, reader_.ReadCount());
+    if (index >= flat_bit_counts_.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid type index %d in binary IR", index));
+    }
+    return flat_bit_counts_[index];
+  }
+
+  absl::Status ScanFunction() {
+    XLS_ASSIGN_OR_RETURN(std::string_view name, reader_.ReadString());
+    visitor_.StartFunction(name);
+    XLS_ASSIGN_OR_RETURN(uint64_t flags, reader_.ReadUnsigned());
+    if (flags & kHasInitiationInterval) {
+      XLS_RETURN_IF_ERROR(reader_.ReadSigned().status());
+    }
+    if (flags & kHasForeignFunctionData) {
+      XLS_RETURN_IF_ERROR(reader_.ReadString().status());
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t node_count, reader_.ReadCount());
+    for (int64_t i = 0; i < node_count; ++i) {
+      XLS_RETURN_IF_ERROR(ScanNode());
+    }
+    if (flags & kHasReturnValue) {
+      XLS_RETURN_IF_ERROR(reader_.ReadSigned().status());
+    }
+    visitor_.EndFunction();
+    return absl::OkStatus();
+  }
+
+  absl::Status ScanNode() {
+    XLS_ASSIGN_OR_RETURN(uint64_t op_proto, reader_.ReadUnsigned());
+    if (!OpProto_IsValid(static_cast<int>(op_proto)) ||
+        op_proto == OP_INVALID) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid op %d in binary IR", op_proto));
+    }
+    Op op = FromOpProto(static_cast<OpProto>(op_proto));
+    XLS_RETURN_IF_ERROR(reader_.ReadSigned().status());
+    XLS_RETURN_IF_ERROR(reader_.ReadOptionalString().status());
+    XLS_ASSIGN_OR_RETURN(int64_t flat_bit_count, ReadTypeRef());
+    XLS_ASSIGN_OR_RETURN(int64_t location_count, reader_.ReadCount());
+    XLS_RETURN_IF_ERROR(SkipVarints(3 * location_count));
+    XLS_ASSIGN_OR_RETURN(int64_t operand_count, reader_.ReadCount());
+    XLS_RETURN_IF_ERROR(SkipVarints(operand_count));
+    XLS_RETURN_IF_ERROR(SkipAttributes(op));
+    visitor_.VisitNode(op, flat_bit_count);
+    return absl::OkStatus();
+  }
+
+  absl::Status SkipVarints(int64_t count) {
+    for (int64_t i = 0; i < count; ++i) {
+      XLS_RETURN_IF_ERROR(reader_.ReadUnsigned().status());
+    }
+    return absl::OkStatus();
+  }
+
+  // Skips the attributes written by PackageSerializer::WriteAttributes.
+  absl::Status SkipAttributes(Op op) {
+    switch (op) {
+      case Op::kMinDelay:
+      case Op::kArraySlice:
+      case Op::kSMul:
+      case Op::kUMul:
+      case Op::kSMulp:
+      case Op::kUMulp:
+      case Op::kDynamicBitSlice:
+      case Op::kDynamicCountedFor:
+      case Op::kSignExt:
+      case Op::kZeroExt:
+      case Op::kInvoke:
+      case Op::kMap:
+      case Op::kOneHot:
+      case Op::kSel:
+      case Op::kTupleIndex:
+      case Op::kDecode:
+        return SkipVarints(1);
+      case Op::kBitSlice:
+        return SkipVarints(2);
+      case Op::kCountedFor:
+        return SkipVarints(3);
+      case Op::kAssert:
+        XLS_RETURN_IF_ERROR(reader_.ReadString().status());
+        XLS_RETURN_IF_ERROR(reader_.ReadOptionalString().status());
+        return reader_.ReadOptionalString().status();
+      case Op::kCover:
+        XLS_RETURN_IF_ERROR(reader_.ReadString().status());
+        return reader_.ReadOptionalString().status();
+      case Op::kTrace: {
+        XLS_RETURN_IF_ERROR(reader_.ReadSigned().status());
+        XLS_ASSIGN_OR_RETURN(int64_t step_count, reader_.ReadCount());
+        for (int64_t i = 0; i < step_count; ++i) {
+          XLS_ASSIGN_OR_RETURN(uint64_t step, reader_.ReadUnsigned());
+          if (step == 0) {
+            XLS_RETURN_IF_ERROR(reader_.ReadString().status());
+          }
+        }
+        return absl::OkStatus();
+      }
+      case Op::kLiteral:
+        return SkipValue();
+      default:
+        return absl::OkStatus();
+    }
+  }
+
+  absl::Status SkipValue() {
+    XLS_ASSIGN_OR_RETURN(uint64_t kind, reader_.ReadUnsigned());
+    switch (static_cast<ValueKind>(kind)) {
+      case ValueKind::kToken:
+        return absl::OkStatus();
+      case ValueKind::kBits: {
+        XLS_ASSIGN_OR_RETURN(int64_t bit_count, reader_.ReadWidth());
+        return reader_.ReadBytes((bit_count + 7) / 8).status();
+      }
+      case ValueKind::kTuple:
+      case ValueKind::kArray: {
+        XLS_ASSIGN_OR_RETURN(int64_t size, reader_.ReadCount());
+        for (int64_t i = 0; i < size; ++i) {
+          XLS_RETURN_IF_ERROR(SkipValue());
+        }
+        return absl::OkStatus();
+      }
+    }
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid value kind %d in binary IR", kind));
+  }
+
+  BinaryIrReader reader_;
+  BinaryIrScanVisitor& visitor_;
+  std::vector<int64_t> flat_bit_counts_;
+};
+
+}  // namespace
+
+absl::StatusOr<std::string> SerializePackageToBinaryIr(const Package& package) {
+  return PackageSerializer(package).Serialize();
+}
+
+bool IsBinaryIr(std::string_view data) {
+  return data.starts_with(kBinaryIrMagic);
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ParsePackageFromBinaryIr(
+    std::string_view data) {
+  return PackageDeserializer(data).Deserialize();
+}
+
+absl::Status ScanBinaryIr(std::string_view data,
+                          BinaryIrScanVisitor& visitor) {
+  return PackageScanner(data, visitor).Scan();
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ParsePackageFromTextOrBinaryIr(
+    std::string_view contents, std::optional<std::string_view> filename) {
+  if (IsBinaryIr(contents)) {
+    return ParsePackageFromBinaryIr(contents);
+  }
+  return Parser::ParsePackage(contents, filename);
+}
+
+}  // namespace xls
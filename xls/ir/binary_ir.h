@@ -0,0 +1,88 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// A compact binary serialization of XLS IR packages.
+//
+// The format is a flat byte stream of LEB128 varints and length-prefixed
+// strings which a reader can consume in place (e.g., straight out of a mapped
+// file) without first tokenizing text. It begins with the magic bytes
+// kBinaryIrMagic followed by the format version, then the package name, the
+// file number table, a table of every type used, and the functions of the
+// package in definition order. Nodes refer to their operands by node id and
+// carry their ids, names and source locations, so parsing the binary form of
+// a package yields a package whose DumpIr() is identical to the original's.
+//
+// Only packages of functions are currently supported. Serializing a package
+// containing channels, procs or blocks returns an UnimplementedError.
+
+#ifndef XLS_IR_BINARY_IR_H_
+#define XLS_IR_BINARY_IR_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+inline constexpr std::string_view kBinaryIrMagic = "XLSB";
+
+// Version of the format written by SerializePackageToBinaryIr. Bumped whenever
+// the encoding changes incompatibly; the reader rejects other versions.
+inline constexpr int64_t kBinaryIrVersion = 1;
+
+// Returns the binary IR encoding of `package`.
+absl::StatusOr<std::string> SerializePackageToBinaryIr(const Package& package);
+
+// Returns whether `data` starts with the binary IR magic bytes.
+bool IsBinaryIr(std::string_view data);
+
+// Parses a package from its binary IR encoding. The returned package is
+// verified.
+absl::StatusOr<std::unique_ptr<Package>> ParsePackageFromBinaryIr(
+    std::string_view data);
+
+// Parses a package from `contents` which may be either textual or binary IR.
+// `filename`, if given, is used for error messages when parsing text.
+absl::StatusOr<std::unique_ptr<Package>> ParsePackageFromTextOrBinaryIr(
+    std::string_view contents,
+    std::optional<std::string_view> filename = std::nullopt);
+
+// Receives the structure of a binary IR package from ScanBinaryIr.
+class BinaryIrScanVisitor {
+ public:
+  virtual ~BinaryIrScanVisitor() = default;
+
+  virtual void StartFunction(std::string_view name) = 0;
+  // Called for each node of the current function, in definition order, with
+  // its op and the flat bit count of its type.
+  virtual void VisitNode(Op op, int64_t flat_bit_count) = 0;
+  virtual void EndFunction() = 0;
+};
+
+// Walks the functions and nodes of the binary IR `data` without constructing a
+// package, for tools which only need summary information. Only the type table
+// is held in memory. The IR is decoded but not verified.
+absl::Status ScanBinaryIr(std::string_view data, BinaryIrScanVisitor& visitor);
+
+}  // namespace xls
+
+#endif  // XLS_IR_BINARY_IR_H_
@@ -0,0 +1,233 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/ir/binary_ir.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/topo_sort.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+// Records what ScanBinaryIr visits as one "function: op/bits op/bits ..."
+// line per function.
+class RecordingVisitor : public BinaryIrScanVisitor {
+ public:
+  void StartFunction(std::string_view name) override {
+    absl::StrAppend(&record_, name, ":");
+  }
+  void VisitNode(Op op, int64_t flat_bit_count) override {
+    absl::StrAppend(&record_, " ", OpToString(op), "/", flat_bit_count);
+  }
+  void EndFunction() override { absl::StrAppend(&record_, "\n"); }
+
+  const std::string& record() const { return record_; }
+
+ private:
+  std::string record_;
+};
+
+// Returns what ScanBinaryIr is expected to visit for `package`.
+std::string ExpectedScan(Package& package) {
+  std::string record;
+  for (const std::unique_ptr<Function>& function : package.functions()) {
+    absl::StrAppend(&record, function->name(), ":");
+    for (Node* param : function->params()) {
+      absl::StrAppend(&record, " ", OpToString(param->op()), "/",
+                      param->GetType()->GetFlatBitCount());
+    }
+    for (Node* node : TopoSort(function.get())) {
+      if (!node->Is<Param>()) {
+        absl::StrAppend(&record, " ", OpToString(node->op()), "/",
+                        node->GetType()->GetFlatBitCount());
+      }
+    }
+    absl::StrAppend(&record, "\n");
+  }
+  return record;
+}
+
+// Parses `ir_text`, serializes it to binary IR and checks that parsing the
+// binary form gives back the same IR.
+void ExpectRoundTrip(std::string_view ir_text) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           SerializePackageToBinaryIr(*package));
+  EXPECT_TRUE(IsBinaryIr(binary));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> round_tripped,
+                           ParsePackageFromBinaryIr(binary));
+  EXPECT_EQ(round_tripped->DumpIr(), package->DumpIr());
+  EXPECT_LT(binary.size(), package->DumpIr().size());
+
+  RecordingVisitor visitor;
+  XLS_ASSERT_OK(ScanBinaryIr(binary, visitor));
+  EXPECT_EQ(visitor.record(), ExpectedScan(*package));
+}
+
+TEST(BinaryIrTest, RoundTripsBitsOps) {
+  ExpectRoundTrip(R"(package test
+
+file_number 0 "fake/file.x"
+file_number 3 "other.x"
+
+top fn main(x: bits[32], y: bits[32], s: bits[2]) -> bits[64] {
+  add.4: bits[32] = add(x, y, id=4, pos=[(0,1,2), (3,4,5)])
+  umul.5: bits[32] = umul(add.4, y, id=5)
+  sum: bits[32] = sub(umul.5, x, id=6, pos=[(0,10,0)])
+  not.7: bits[32] = not(sum, id=7)
+  and.8: bits[32] = and(x, y, not.7, id=8)
+  ult.9: bits[1] = ult(x, y, id=9)
+  bit_slice.10: bits[8] = bit_slice(and.8, start=4, width=8, id=10)
+  dynamic_bit_slice.11: bits[4] = dynamic_bit_slice(x, s, width=4, id=11)
+  bit_slice_update.12: bits[32] = bit_slice_update(x, s, bit_slice.10, id=12)
+  sign_ext.13: bits[40] = sign_ext(bit_slice.10, new_bit_count=40, id=13)
+  literal.14: bits[24] = literal(value=0xabcdef, id=14)
+  concat.15: bits[64] = concat(literal.14, sign_ext.13, id=15)
+  sel.16: bits[32] = sel(s, cases=[x, y], default=sum, id=16)
+  one_hot.17: bits[3] = one_hot(s, lsb_prio=true, id=17)
+  one_hot_sel.18: bits[32] = one_hot_sel(s, cases=[x, y], id=18)
+  priority_sel.19: bits[32] = priority_sel(s, cases=[x, y], default=sum, id=19)
+  decode.20: bits[4] = decode(s, width=4, id=20)
+  encode.21: bits[2] = encode(decode.20, id=21)
+  or_reduce.22: bits[1] = or_reduce(x, id=22)
+  smulp.23: (bits[32], bits[32]) = smulp(x, y, id=23)
+  tuple.24: (bits[32], bits[1], bits[32]) = tuple(sel.16, ult.9, priority_sel.19, id=24)
+  tuple_index.25: bits[32] = tuple_index(tuple.24, index=2, id=25)
+  gate.26: bits[32] = gate(or_reduce.22, tuple_index.25, id=26)
+  ret zero_ext.27: bits[64] = zero_ext(gate.26, new_bit_count=64, id=27)
+}
+)");
+}
+
+TEST(BinaryIrTest, RoundTripsAggregatesAndCalls) {
+  ExpectRoundTrip(R"(package test
+
+fn body(i: bits[4], acc: bits[8], inv: bits[8]) -> bits[8] {
+  ret add.4: bits[8] = add(acc, inv, id=4)
+}
+
+fn square(x: bits[8]) -> bits[8] {
+  ret umul.6: bits[8] = umul(x, x, id=6)
+}
+
+#[initiation_interval(2)]
+top fn main(a: bits[8][4], i: bits[2], t: token) -> (bits[8][4], bits[8], (), bits[8][2]) {
+  literal.10: bits[8][2] = literal(value=[1, 2], id=10)
+  literal.11: (bits[1], (bits[8], bits[8][2])) = literal(value=(1, (3, [4, 5])), id=11)
+  array_index.12: bits[8] = array_index(a, indices=[i], id=12)
+  array_update.13: bits[8][4] = array_update(a, array_index.12, indices=[i], id=13)
+  array_slice.14: bits[8][2] = array_slice(a, i, width=2, id=14)
+  array_concat.15: bits[8][6] = array_concat(a, literal.10, id=15)
+  array.16: bits[8][2] = array(array_index.12, array_index.12, id=16)
+  map.17: bits[8][4] = map(array_update.13, to_apply=square, id=17)
+  invoke.18: bits[8] = invoke(array_index.12, to_apply=square, id=18)
+  counted_for.19: bits[8] = counted_for(invoke.18, trip_count=3, stride=2, body=body, invariant_args=[array_index.12], id=19)
+  after_all.20: token = after_all(t, id=20)
+  tuple.21: () = tuple(id=21)
+  ret tuple.22: (bits[8][4], bits[8], (), bits[8][2]) = tuple(map.17, counted_for.19, tuple.21, array_slice.14, id=22)
+}
+)");
+}
+
+TEST(BinaryIrTest, RoundTripsSideEffectingOps) {
+  ExpectRoundTrip(R"(package test
+
+top fn main(t: token, c: bits[1], x: bits[32]) -> token {
+  assert.4: token = assert(t, c, message="x is bad", label="my_label", id=4)
+  trace.5: token = trace(assert.4, c, format="x = {:#x} and {}", data_operands=[x, x], verbosity=1, id=5)
+  cover.6: () = cover(c, label="covered", id=6)
+  ret min_delay.7: token = min_delay(trace.5, delay=3, id=7)
+}
+)");
+}
+
+TEST(BinaryIrTest, ParsesTextOrBinary) {
+  constexpr std::string_view kIr = R"(package test
+
+top fn main(x: bits[32]) -> bits[32] {
+  ret neg.2: bits[32] = neg(x, id=2)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> from_text,
+                           ParsePackageFromTextOrBinaryIr(kIr));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           SerializePackageToBinaryIr(*from_text));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> from_binary,
+                           ParsePackageFromTextOrBinaryIr(binary));
+  EXPECT_EQ(from_binary->DumpIr(), from_text->DumpIr());
+  EXPECT_FALSE(IsBinaryIr(kIr));
+}
+
+TEST(BinaryIrTest, RejectsMalformedInput) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(package test
+
+top fn main(x: bits[32]) -> bits[32] {
+  ret neg.2: bits[32] = neg(x, id=2)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           SerializePackageToBinaryIr(*package));
+
+  EXPECT_THAT(ParsePackageFromBinaryIr("package test"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not binary IR")));
+  EXPECT_THAT(ParsePackageFromBinaryIr(binary.substr(0, binary.size() / 2)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("truncated")));
+  EXPECT_THAT(ParsePackageFromBinaryIr(binary + "x"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Trailing data")));
+
+  std::string bad_version = binary;
+  bad_version[kBinaryIrMagic.size()] = 127;
+  EXPECT_THAT(ParsePackageFromBinaryIr(bad_version),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Unsupported binary IR version")));
+}
+
+TEST(BinaryIrTest, ProcsAreUnsupported) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(package test
+
+top proc main(x: bits[32], init={0}) {
+  next_value.1: () = next_value(param=x, value=x, id=1)
+}
+)"));
+  EXPECT_THAT(SerializePackageToBinaryIr(*package),
+              StatusIs(absl::StatusCode::kUnimplemented));
+}
+
+}  // namespace
+}  // namespace xls
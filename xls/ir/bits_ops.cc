@@ -23,6 +23,8 @@
 
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/numeric/bits.h"
+#include "absl/numeric/int128.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
@@ -38,146 +40,264 @@ namespace xls {
 namespace bits_ops {
 namespace {
 
-// Converts the given bits value to signed value of the given bit count. Uses
-// truncation or sign-extension to narrow/widen the value.
-Bits TruncateOrSignExtend(Bits bits, int64_t bit_count) {
-  if (bits.bit_count() == bit_count) {
-    return bits;
-  }
-  if (bits.bit_count() < bit_count) {
-    return SignExtend(std::move(bits), bit_count);
+// Returns the result of applying `op` to each pair of 64-bit words of `lhs`
+// and `rhs`, which must have the same bit count. Bits of the last word beyond
+// the bit count are masked off by InlineBitmap::SetWord.
+template <typename WordOp>
+Bits BinaryWordOp(const Bits& lhs, const Bits& rhs, WordOp op) {
+  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
+  const InlineBitmap& rhs_bitmap = rhs.bitmap();
+  InlineBitmap result = lhs.bitmap();
+  for (int64_t i = 0; i < result.word_count(); ++i) {
+    result.SetWord(i, op(result.GetWord(i), rhs_bitmap.GetWord(i)));
   }
-  return Truncate(std::move(bits), bit_count);
+  return Bits::FromBitmap(std::move(result));
 }
 
-}  // namespace
+// Folds `op` over the 64-bit words of all `operands` in a single pass rather
+// than materializing an intermediate value per operand. The result is
+// inverted if `invert` is true.
+template <typename WordOp>
+Bits NaryWordOp(absl::Span<const Bits> operands, WordOp op, bool invert) {
+  InlineBitmap result = operands.at(0).bitmap();
+  for (int64_t i = 1; i < operands.size(); ++i) {
+    CHECK_EQ(operands[i].bit_count(), result.bit_count());
+  }
+  for (int64_t w = 0; w < result.word_count(); ++w) {
+    uint64_t word = result.GetWord(w);
+    for (int64_t i = 1; i < operands.size(); ++i) {
+      word = op(word, operands[i].bitmap().GetWord(w));
+    }
+    result.SetWord(w, invert ? ~word : word);
+  }
+  return Bits::FromBitmap(std::move(result));
+}
 
-Bits And(const Bits& lhs, const Bits& rhs) {
-  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    return UBits(lhs.ToUint64().value() & rhs.ToUint64().value(),
-                 lhs.bit_count());
+std::vector<uint64_t> GetWords(const Bits& bits) {
+  const InlineBitmap& bitmap = bits.bitmap();
+  std::vector<uint64_t> words(bitmap.word_count());
+  for (int64_t i = 0; i < words.size(); ++i) {
+    words[i] = bitmap.GetWord(i);
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] & rhs_bytes[i];
+  return words;
+}
+
+// Returns a value of the given bit count holding the little-endian `words`.
+// Missing words are zero and excess words are dropped.
+Bits FromWords(absl::Span<const uint64_t> words, int64_t bit_count) {
+  InlineBitmap bitmap(bit_count);
+  for (int64_t i = 0; i < bitmap.word_count() && i < words.size(); ++i) {
+    bitmap.SetWord(i, words[i]);
   }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return Bits::FromBitmap(std::move(bitmap));
 }
 
-Bits NaryAnd(absl::Span<const Bits> operands) {
-  Bits accum = operands.at(0);
-  for (int64_t i = 1; i < operands.size(); ++i) {
-    accum = And(accum, operands[i]);
+// Returns the low `result_word_count` words of the product of the unsigned
+// values whose little-endian words are `lhs` and `rhs` using schoolbook
+// multiplication. For the widths which appear in IR (a few dozen words at
+// most) this beats Karatsuba-style algorithms.
+std::vector<uint64_t> MulWords(absl::Span<const uint64_t> lhs,
+                               absl::Span<const uint64_t> rhs,
+                               int64_t result_word_count) {
+  std::vector<uint64_t> result(result_word_count, 0);
+  for (int64_t i = 0; i < lhs.size() && i < result_word_count; ++i) {
+    if (lhs[i] == 0) {
+      continue;
+    }
+    uint64_t carry = 0;
+    int64_t j = 0;
+    for (; j < rhs.size() && i + j < result_word_count; ++j) {
+      // Cannot overflow: (2^64-1)^2 + 2 * (2^64-1) == 2^128-1.
+      absl::uint128 t =
+          absl::uint128(lhs[i]) * rhs[j] + result[i + j] + carry;
+      result[i + j] = absl::Uint128Low64(t);
+      carry = absl::Uint128High64(t);
+    }
+    if (i + j < result_word_count) {
+      result[i + j] = carry;
+    }
   }
-  return accum;
+  return result;
 }
 
-Bits Or(const Bits& lhs, const Bits& rhs) {
-  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int | rhs_int);
-    return UBits(result, lhs.bit_count());
+struct DivModResult {
+  std::vector<uint64_t> quotient;
+  std::vector<uint64_t> remainder;
+};
+
+// Divides the unsigned values whose little-endian words are `dividend` and
+// `divisor` (which must be non-zero) using Knuth's Algorithm D (TAOCP Vol. 2,
+// 4.3.1) over 32-bit digits so that every intermediate product fits in 64
+// bits.
+DivModResult DivModWords(absl::Span<const uint64_t> dividend,
+                         absl::Span<const uint64_t> divisor) {
+  auto to_digits = [](absl::Span<const uint64_t> words) {
+    std::vector<uint32_t> digits;
+    digits.reserve(2 * words.size());
+    for (uint64_t word : words) {
+      digits.push_back(static_cast<uint32_t>(word));
+      digits.push_back(static_cast<uint32_t>(word >> 32));
+    }
+    while (!digits.empty() && digits.back() == 0) {
+      digits.pop_back();
+    }
+    return digits;
+  };
+  auto to_words = [](absl::Span<const uint32_t> digits) {
+    std::vector<uint64_t> words((digits.size() + 1) / 2, 0);
+    for (int64_t i = 0; i < digits.size(); ++i) {
+      words[i / 2] |= uint64_t{digits[i]} << (32 * (i % 2));
+    }
+    return words;
+  };
+
+  std::vector<uint32_t> u = to_digits(dividend);
+  std::vector<uint32_t> v = to_digits(divisor);
+  CHECK(!v.empty()) << "Division by zero";
+  const int64_t m = u.size();
+  const int64_t n = v.size();
+  if (m < n) {
+    return DivModResult{.quotient = {}, .remainder = to_words(u)};
+  }
+  std::vector<uint32_t> q(m - n + 1, 0);
+  if (n == 1) {
+    // Short division by a single digit.
+    uint64_t remainder = 0;
+    for (int64_t j = m - 1; j >= 0; --j) {
+      uint64_t current = (remainder << 32) | u[j];
+      q[j] = static_cast<uint32_t>(current / v[0]);
+      remainder = current % v[0];
+    }
+    return DivModResult{.quotient = to_words(q), .remainder = {remainder}};
+  }
+
+  // Normalize so that the most significant digit of the divisor has its high
+  // bit set, which bounds the error of the quotient digit estimates below.
+  // The shifts are done in 64 bits so a shift amount of zero is well defined.
+  const int s = absl::countl_zero(v[n - 1]);
+  std::vector<uint32_t> vn(n);
+  for (int64_t i = n - 1; i > 0; --i) {
+    vn[i] = (v[i] << s) | static_cast<uint32_t>(uint64_t{v[i - 1]} >> (32 - s));
+  }
+  vn[0] = v[0] << s;
+  std::vector<uint32_t> un(m + 1);
+  un[m] = static_cast<uint32_t>(uint64_t{u[m - 1]} >> (32 - s));
+  for (int64_t i = m - 1; i > 0; --i) {
+    un[i] = (u[i] << s) | static_cast<uint32_t>(uint64_t{u[i - 1]} >> (32 - s));
+  }
+  un[0] = u[0] << s;
+
+  constexpr uint64_t kBase = uint64_t{1} << 32;
+  for (int64_t j = m - n; j >= 0; --j) {
+    // Estimate the quotient digit from the top digits of the running
+    // remainder. The estimate is at most one too large after the correction.
+    uint64_t numerator = (uint64_t{un[j + n]} << 32) | un[j + n - 1];
+    uint64_t qhat = numerator / vn[n - 1];
+    uint64_t rhat = numerator % vn[n - 1];
+    while (qhat >= kBase ||
+           qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+      --qhat;
+      rhat += vn[n - 1];
+      if (rhat >= kBase) {
+        break;
+      }
+    }
+
+    // Multiply and subtract qhat * divisor from the running remainder.
+    int64_t borrow = 0;
+    int64_t t;
+    for (int64_t i = 0; i < n; ++i) {
+      uint64_t p = qhat * vn[i];
+      t = int64_t{un[i + j]} - borrow - static_cast<int64_t>(p & 0xffffffff);
+      un[i + j] = static_cast<uint32_t>(t);
+      borrow = static_cast<int64_t>(p >> 32) - (t >> 32);
+    }
+    t = int64_t{un[j + n]} - borrow;
+    un[j + n] = static_cast<uint32_t>(t);
+
+    q[j] = static_cast<uint32_t>(qhat);
+    if (t < 0) {
+      // The estimate was one too large; add the divisor back.
+      --q[j];
+      uint64_t carry = 0;
+      for (int64_t i = 0; i < n; ++i) {
+        uint64_t sum = uint64_t{un[i + j]} + vn[i] + carry;
+        un[i + j] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+      }
+      un[j + n] += static_cast<uint32_t>(carry);
+    }
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] | rhs_bytes[i];
+
+  // Denormalize the remainder.
+  std::vector<uint32_t> r(n);
+  for (int64_t i = 0; i < n; ++i) {
+    r[i] = (un[i] >> s) |
+           static_cast<uint32_t>(uint64_t{un[i + 1]} << (32 - s));
   }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return DivModResult{.quotient = to_words(q), .remainder = to_words(r)};
+}
+
+}  // namespace
+
+Bits And(const Bits& lhs, const Bits& rhs) {
+  return BinaryWordOp(lhs, rhs, [](uint64_t a, uint64_t b) { return a & b; });
+}
+
+Bits NaryAnd(absl::Span<const Bits> operands) {
+  return NaryWordOp(
+      operands, [](uint64_t a, uint64_t b) { return a & b; },
+      /*invert=*/false);
+}
+
+Bits Or(const Bits& lhs, const Bits& rhs) {
+  return BinaryWordOp(lhs, rhs, [](uint64_t a, uint64_t b) { return a | b; });
 }
 
 Bits NaryOr(absl::Span<const Bits> operands) {
-  Bits accum = operands.at(0);
-  for (int64_t i = 1; i < operands.size(); ++i) {
-    accum = Or(accum, operands[i]);
-  }
-  return accum;
+  return NaryWordOp(
+      operands, [](uint64_t a, uint64_t b) { return a | b; },
+      /*invert=*/false);
 }
 
 Bits Xor(const Bits& lhs, const Bits& rhs) {
-  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int ^ rhs_int);
-    return UBits(result, lhs.bit_count());
-  }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] ^ rhs_bytes[i];
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return BinaryWordOp(lhs, rhs, [](uint64_t a, uint64_t b) { return a ^ b; });
 }
 
 Bits NaryXor(absl::Span<const Bits> operands) {
-  Bits accum = operands.at(0);
-  for (int64_t i = 1; i < operands.size(); ++i) {
-    accum = Xor(accum, operands[i]);
-  }
-  return accum;
+  return NaryWordOp(
+      operands, [](uint64_t a, uint64_t b) { return a ^ b; },
+      /*invert=*/false);
 }
 
 Bits Nand(const Bits& lhs, const Bits& rhs) {
-  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    return UBits(~(lhs.ToUint64().value() & rhs.ToUint64().value()) &
-                     Mask(lhs.bit_count()),
-                 lhs.bit_count());
-  }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = ~(bytes[i] & rhs_bytes[i]);
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return BinaryWordOp(lhs, rhs,
+                      [](uint64_t a, uint64_t b) { return ~(a & b); });
 }
 
 Bits NaryNand(absl::Span<const Bits> operands) {
-  Bits accum = operands.at(0);
-  for (int64_t i = 1; i < operands.size(); ++i) {
-    accum = And(accum, operands[i]);
-  }
-  return Not(accum);
+  return NaryWordOp(
+      operands, [](uint64_t a, uint64_t b) { return a & b; },
+      /*invert=*/true);
 }
 
 Bits Nor(const Bits& lhs, const Bits& rhs) {
-  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    return UBits(~(lhs.ToUint64().value() | rhs.ToUint64().value()) &
-                     Mask(lhs.bit_count()),
-                 lhs.bit_count());
-  }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = ~(bytes[i] | rhs_bytes[i]);
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return BinaryWordOp(lhs, rhs,
+                      [](uint64_t a, uint64_t b) { return ~(a | b); });
 }
 
 Bits NaryNor(absl::Span<const Bits> operands) {
-  Bits accum = operands.at(0);
-  for (int64_t i = 1; i < operands.size(); ++i) {
-    accum = Or(accum, operands[i]);
-  }
-  return Not(accum);
+  return NaryWordOp(
+      operands, [](uint64_t a, uint64_t b) { return a | b; },
+      /*invert=*/true);
 }
 
 Bits Not(const Bits& bits) {
-  if (bits.bit_count() <= 64) {
-    return UBits((~bits.ToUint64().value()) & Mask(bits.bit_count()),
-                 bits.bit_count());
-  }
-  std::vector<uint8_t> bytes = bits.ToBytes();
-  for (uint8_t& byte : bytes) {
-    byte = ~byte;
+  InlineBitmap result = bits.bitmap();
+  for (int64_t i = 0; i < result.word_count(); ++i) {
+    result.SetWord(i, ~result.GetWord(i));
   }
-  return Bits::FromBytes(bytes, bits.bit_count());
+  return Bits::FromBitmap(std::move(result));
 }
 
 Bits AndReduce(const Bits& operand) {
@@ -204,9 +324,19 @@ Bits Add(const Bits& lhs, const Bits& rhs) {
     return UBits(result, lhs.bit_count());
   }
 
-  Bits sum = BigInt::Add(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
-                 .ToSignedBits();
-  return TruncateOrSignExtend(std::move(sum), lhs.bit_count());
+  const InlineBitmap& rhs_bitmap = rhs.bitmap();
+  InlineBitmap result = lhs.bitmap();
+  uint64_t carry = 0;
+  for (int64_t i = 0; i < result.word_count(); ++i) {
+    uint64_t a = result.GetWord(i);
+    uint64_t sum = a + rhs_bitmap.GetWord(i);
+    uint64_t carry_out = sum < a ? 1 : 0;
+    sum += carry;
+    carry_out |= sum < carry ? 1 : 0;
+    result.SetWord(i, sum);
+    carry = carry_out;
+  }
+  return Bits::FromBitmap(std::move(result));
 }
 
 Bits Sub(const Bits& lhs, const Bits& rhs) {
@@ -217,9 +347,20 @@ Bits Sub(const Bits& lhs, const Bits& rhs) {
     uint64_t result = (lhs_int - rhs_int) & Mask(lhs.bit_count());
     return UBits(result, lhs.bit_count());
   }
-  Bits diff = BigInt::Sub(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
-                  .ToSignedBits();
-  return TruncateOrSignExtend(std::move(diff), lhs.bit_count());
+  const InlineBitmap& rhs_bitmap = rhs.bitmap();
+  InlineBitmap result = lhs.bitmap();
+  uint64_t borrow = 0;
+  for (int64_t i = 0; i < result.word_count(); ++i) {
+    uint64_t a = result.GetWord(i);
+    uint64_t b = rhs_bitmap.GetWord(i);
+    uint64_t diff = a - b;
+    uint64_t borrow_out = a < b ? 1 : 0;
+    borrow_out |= diff < borrow ? 1 : 0;
+    diff -= borrow;
+    result.SetWord(i, diff);
+    borrow = borrow_out;
+  }
+  return Bits::FromBitmap(std::move(result));
 }
 
 Bits Increment(const Bits& x) {
@@ -257,9 +398,16 @@ Bits SMul(const Bits& lhs, const Bits& rhs) {
     return SBits(result, result_width);
   }
 
-  BigInt product =
-      BigInt::Mul(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
-  return product.ToSignedBitsWithBitCount(result_width).value();
+  if (lhs.bit_count() == 0 || rhs.bit_count() == 0) {
+    return Bits(result_width);
+  }
+  // The low result_width bits of the product of the operands sign-extended to
+  // result_width are the full signed product.
+  std::vector<uint64_t> product =
+      MulWords(GetWords(SignExtend(lhs, result_width)),
+               GetWords(SignExtend(rhs, result_width)),
+               CeilOfRatio(result_width, int64_t{64}));
+  return FromWords(product, result_width);
 }
 
 Bits UMul(const Bits& lhs, const Bits& rhs) {
@@ -271,27 +419,34 @@ Bits UMul(const Bits& lhs, const Bits& rhs) {
     return UBits(result, result_width);
   }
 
-  BigInt product =
-      BigInt::Mul(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
-  return product.ToUnsignedBitsWithBitCount(result_width).value();
+  std::vector<uint64_t> product =
+      MulWords(GetWords(lhs), GetWords(rhs),
+               CeilOfRatio(result_width, int64_t{64}));
+  return FromWords(product, result_width);
 }
 
 Bits UDiv(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits::AllOnes(lhs.bit_count());
   }
-  BigInt quotient =
-      BigInt::Div(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
-  return ZeroExtend(quotient.ToUnsignedBits(), lhs.bit_count());
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    return UBits(lhs.ToUint64().value() / rhs.ToUint64().value(),
+                 lhs.bit_count());
+  }
+  return FromWords(DivModWords(GetWords(lhs), GetWords(rhs)).quotient,
+                   lhs.bit_count());
 }
 
 Bits UMod(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits(rhs.bit_count());
   }
-  BigInt modulo =
-      BigInt::Mod(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
-  return ZeroExtend(modulo.ToUnsignedBits(), rhs.bit_count());
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    return UBits(lhs.ToUint64().value() % rhs.ToUint64().value(),
+                 rhs.bit_count());
+  }
+  return FromWords(DivModWords(GetWords(lhs), GetWords(rhs)).remainder,
+                   rhs.bit_count());
 }
 
 Bits SDiv(const Bits& lhs, const Bits& rhs) {
@@ -308,17 +463,25 @@ Bits SDiv(const Bits& lhs, const Bits& rhs) {
     // 0b0111...111.
     return ZeroExtend(Bits::AllOnes(lhs.bit_count() - 1), lhs.bit_count());
   }
-  BigInt quotient =
-      BigInt::Div(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
-  return TruncateOrSignExtend(quotient.ToSignedBits(), lhs.bit_count());
+  // Divide the magnitudes, rounding toward zero. Note that the magnitude of
+  // the most negative value is representable as an unsigned value of the
+  // same width.
+  const bool lhs_negative = lhs.msb();
+  const bool rhs_negative = rhs.msb();
+  Bits quotient = UDiv(lhs_negative ? Negate(lhs) : lhs,
+                       rhs_negative ? Negate(rhs) : rhs);
+  return lhs_negative != rhs_negative ? Negate(quotient) : quotient;
 }
 
 Bits SMod(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits(rhs.bit_count());
   }
-  BigInt modulo = BigInt::Mod(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
-  return TruncateOrSignExtend(modulo.ToSignedBits(), rhs.bit_count());
+  // The remainder takes the sign of the dividend.
+  const bool lhs_negative = lhs.msb();
+  Bits remainder =
+      UMod(lhs_negative ? Negate(lhs) : lhs, rhs.msb() ? Negate(rhs) : rhs);
+  return lhs_negative ? Negate(remainder) : remainder;
 }
 
 bool UEqual(const Bits& lhs, const Bits& rhs) { return UCmp(lhs, rhs) == 0; }
@@ -450,8 +613,8 @@ Bits Negate(const Bits& bits) {
     return UBits((-bits.ToInt64().value()) & Mask(bits.bit_count()),
                  bits.bit_count());
   }
-  Bits negated = BigInt::Negate(BigInt::MakeSigned(bits)).ToSignedBits();
-  return TruncateOrSignExtend(std::move(negated), bits.bit_count());
+  // Two's complement negation: ~x + 1.
+  return Increment(Not(bits));
 }
 
 Bits Abs(const Bits& bits) {
@@ -17,6 +17,7 @@
 #include <array>
 #include <cstdint>
 #include <limits>
+#include <random>
 #include <string>
 #include <utility>
 #include <vector>
@@ -29,6 +30,7 @@
 #include "absl/strings/str_split.h"
 #include "xls/common/status/matchers.h"
 #include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/big_int.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_test_utils.h"
 #include "xls/ir/format_preference.h"
@@ -214,6 +216,85 @@ void DecrementEqualsSub1(const Bits& bits) {
 }
 FUZZ_TEST(BitsOpsFuzzTest, DecrementEqualsSub1).WithDomains(NonemptyBits());
 
+// Converts `bits` to the given bit count by truncation or sign extension.
+Bits TruncateOrSignExtend(const Bits& bits, int64_t bit_count) {
+  return bits.bit_count() < bit_count ? bits_ops::SignExtend(bits, bit_count)
+                                      : bits_ops::Truncate(bits, bit_count);
+}
+
+// The wide arithmetic operations work on 64-bit words; check them against the
+// BigInt implementation.
+void WideAddSubMatchBigInt(const Bits& lhs, const Bits& rhs) {
+  EXPECT_EQ(bits_ops::Add(lhs, rhs),
+            TruncateOrSignExtend(BigInt::Add(BigInt::MakeUnsigned(lhs),
+                                             BigInt::MakeUnsigned(rhs))
+                                     .ToSignedBits(),
+                                 lhs.bit_count()));
+  EXPECT_EQ(bits_ops::Sub(lhs, rhs),
+            TruncateOrSignExtend(BigInt::Sub(BigInt::MakeUnsigned(lhs),
+                                             BigInt::MakeUnsigned(rhs))
+                                     .ToSignedBits(),
+                                 lhs.bit_count()));
+  EXPECT_EQ(bits_ops::Negate(lhs),
+            TruncateOrSignExtend(
+                BigInt::Negate(BigInt::MakeSigned(lhs)).ToSignedBits(),
+                lhs.bit_count()));
+}
+FUZZ_TEST(BitsOpsFuzzTest, WideAddSubMatchBigInt)
+    .WithDomains(ArbitraryBits(200), ArbitraryBits(200));
+
+void WideMulMatchesBigInt(const Bits& lhs, const Bits& rhs) {
+  const int64_t result_width = lhs.bit_count() + rhs.bit_count();
+  EXPECT_EQ(bits_ops::UMul(lhs, rhs),
+            BigInt::Mul(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs))
+                .ToUnsignedBitsWithBitCount(result_width)
+                .value());
+  EXPECT_EQ(bits_ops::SMul(lhs, rhs),
+            BigInt::Mul(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
+                .ToSignedBitsWithBitCount(result_width)
+                .value());
+}
+FUZZ_TEST(BitsOpsFuzzTest, WideMulMatchesBigInt)
+    .WithDomains(ArbitraryBits(200), ArbitraryBits(130));
+
+void WideDivModMatchesBigInt(const Bits& lhs, const Bits& rhs) {
+  if (rhs.IsZero()) {
+    return;
+  }
+  BigInt ulhs = BigInt::MakeUnsigned(lhs);
+  BigInt urhs = BigInt::MakeUnsigned(rhs);
+  EXPECT_EQ(bits_ops::UDiv(lhs, rhs),
+            bits_ops::ZeroExtend(BigInt::Div(ulhs, urhs).ToUnsignedBits(),
+                                 lhs.bit_count()));
+  EXPECT_EQ(bits_ops::UMod(lhs, rhs),
+            bits_ops::ZeroExtend(BigInt::Mod(ulhs, urhs).ToUnsignedBits(),
+                                 rhs.bit_count()));
+  EXPECT_EQ(bits_ops::SDiv(lhs, rhs),
+            TruncateOrSignExtend(
+                BigInt::Div(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
+                    .ToSignedBits(),
+                lhs.bit_count()));
+  EXPECT_EQ(bits_ops::SMod(lhs, rhs),
+            TruncateOrSignExtend(
+                BigInt::Mod(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
+                    .ToSignedBits(),
+                rhs.bit_count()));
+}
+FUZZ_TEST(BitsOpsFuzzTest, WideDivModMatchesBigInt)
+    .WithDomains(ArbitraryBits(300), ArbitraryBits(70));
+
+TEST(BitsOpsTest, WideDivMod) {
+  // A divisor whose top digit is small needs a large normalization shift.
+  Bits lhs = bits_ops::Concat({UBits(0x1234, 16), Bits::AllOnes(180)});
+  Bits rhs = bits_ops::Concat({UBits(1, 1), UBits(0, 64), UBits(3, 64)});
+  WideDivModMatchesBigInt(lhs, rhs);
+  WideDivModMatchesBigInt(rhs, lhs);
+  WideDivModMatchesBigInt(Bits::AllOnes(256), Bits::AllOnes(256));
+  WideDivModMatchesBigInt(Bits::AllOnes(256), UBits(7, 256));
+  WideDivModMatchesBigInt(bits_ops::Concat({UBits(1, 1), Bits(127)}),
+                          SBits(-1, 128));
+}
+
 TEST(BitsOpsTest, UMul) {
   EXPECT_EQ(bits_ops::UMul(Bits(), Bits()), Bits());
   EXPECT_EQ(bits_ops::UMul(UBits(100, 24), UBits(55, 22)), UBits(5500, 46));
@@ -1222,5 +1303,71 @@ void BM_ZeroExtendMove(benchmark::State& state) {
 }
 BENCHMARK(BM_ZeroExtendMove)->Range(33, 1 << 20);
 
+// Returns a value of the given width with pseudo-random contents.
+Bits RandomBits(int64_t bit_count, std::mt19937_64& rng) {
+  InlineBitmap bitmap(bit_count);
+  for (int64_t i = 0; i < bitmap.word_count(); ++i) {
+    bitmap.SetWord(i, rng());
+  }
+  return Bits::FromBitmap(std::move(bitmap));
+}
+
+void BM_And(benchmark::State& state) {
+  std::mt19937_64 rng;
+  Bits lhs = RandomBits(state.range(0), rng);
+  Bits rhs = RandomBits(state.range(0), rng);
+  for (auto _ : state) {
+    auto v = bits_ops::And(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_And)->Range(64, 1 << 20);
+
+void BM_NaryXor(benchmark::State& state) {
+  std::mt19937_64 rng;
+  std::vector<Bits> operands;
+  for (int64_t i = 0; i < 8; ++i) {
+    operands.push_back(RandomBits(state.range(0), rng));
+  }
+  for (auto _ : state) {
+    auto v = bits_ops::NaryXor(operands);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_NaryXor)->Range(64, 1 << 20);
+
+void BM_Add(benchmark::State& state) {
+  std::mt19937_64 rng;
+  Bits lhs = RandomBits(state.range(0), rng);
+  Bits rhs = RandomBits(state.range(0), rng);
+  for (auto _ : state) {
+    auto v = bits_ops::Add(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_Add)->Range(64, 1 << 20);
+
+void BM_UMul(benchmark::State& state) {
+  std::mt19937_64 rng;
+  Bits lhs = RandomBits(state.range(0), rng);
+  Bits rhs = RandomBits(state.range(0), rng);
+  for (auto _ : state) {
+    auto v = bits_ops::UMul(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_UMul)->Range(64, 4096);
+
+void BM_UDiv(benchmark::State& state) {
+  std::mt19937_64 rng;
+  Bits lhs = RandomBits(state.range(0), rng);
+  Bits rhs = RandomBits(state.range(0) / 2, rng);
+  for (auto _ : state) {
+    auto v = bits_ops::UDiv(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_UDiv)->Range(128, 4096);
+
 }  // namespace
 }  // namespace xls
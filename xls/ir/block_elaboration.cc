@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <deque>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -713,8 +714,6 @@ static absl::StatusOr<std::unique_ptr<BlockInstance>> ElaborateBlock(
   XLS_ASSIGN_OR_RETURN(elaboration.top_,
                        ElaborateBlock(top, std::nullopt, std::move(path)));
   elaboration.instance_ptrs_.push_back(elaboration.top_.get());
-  elaboration.instances_by_path_[elaboration.top_->path()] =
-      elaboration.top_.get();
   elaboration.instances_of_function_[elaboration.top_->block().value()] = {
       elaboration.top_.get()};
 
@@ -723,7 +722,6 @@ static absl::StatusOr<std::unique_ptr<BlockInstance>> ElaborateBlock(
     for (const std::unique_ptr<BlockInstance>& inst :
          elaboration.instance_ptrs_[idx]->child_instances()) {
       elaboration.instance_ptrs_.push_back(inst.get());
-      elaboration.instances_by_path_[inst->path()] = inst.get();
       if (inst->block().has_value()) {
         elaboration.instances_of_function_[inst->block().value()].push_back(
             inst.get());
@@ -731,29 +729,49 @@ static absl::StatusOr<std::unique_ptr<BlockInstance>> ElaborateBlock(
     }
     idx++;
   }
-  absl::flat_hash_set<Block*> block_set;
-  block_set.reserve(elaboration.instance_ptrs_.size());
   for (BlockInstance* block_instance : elaboration.instance_ptrs_) {
-    if (block_instance->block().has_value()) {
-      auto [_, inserted] = block_set.insert(*block_instance->block());
-      if (inserted) {
-        elaboration.blocks_.push_back(*block_instance->block());
+    if (!block_instance->block().has_value()) {
+      continue;
+    }
+    Block* block = *block_instance->block();
+    auto [it, inserted] = elaboration.node_indices_.try_emplace(block);
+    if (inserted) {
+      elaboration.blocks_.push_back(block);
+      it->second = std::make_unique<absl::flat_hash_map<Node*, int64_t>>();
+      it->second->reserve(block->node_count());
+      for (Node* node : block->nodes()) {
+        it->second->insert({node, it->second->size()});
       }
     }
+    block_instance->node_indices_ = it->second.get();
+    block_instance->node_index_offset_ = elaboration.elaborated_node_count_;
+    elaboration.elaborated_node_count_ += block->node_count();
   }
   return elaboration;
 }
 
 absl::StatusOr<BlockInstance*> BlockElaboration::GetInstance(
     const BlockInstantiationPath& path) const {
-  auto it = instances_by_path_.find(path);
-  if (it == instances_by_path_.end()) {
+  // Instances are found by walking down from the top rather than through an
+  // index of all paths, which would hold a copy of every instance's path.
+  auto not_found = [&]() {
     return absl::NotFoundError(
         absl::StrFormat("Instantiation path `%s` does not exist in "
                         "elaboration from proc `%s`",
                         path.ToString(), top()->block().value()->name()));
+  };
+  if (path.top != top()->block()) {
+    return not_found();
+  }
+  BlockInstance* instance = top();
+  for (Instantiation* instantiation : path.path) {
+    auto it = instance->instantiation_to_instance().find(instantiation);
+    if (it == instance->instantiation_to_instance().end()) {
+      return not_found();
+    }
+    instance = it->second;
   }
-  return it->second;
+  return instance;
 }
 
 absl::StatusOr<BlockInstance*> BlockElaboration::GetInstance(
@@ -833,6 +851,9 @@ absl::StatusOr<BlockInstantiationPath> BlockElaboration::CreatePath(
 
 absl::Status BlockElaboration::Accept(
     ElaboratedBlockDfsVisitor& visitor) const {
+  if (visitor.GetVisitedCount() == 0) {
+    visitor.UseDenseVisitedState(*this);
+  }
   int64_t node_count = 0;
   for (BlockInstance* instance : instance_ptrs_) {
     if (!instance->block().has_value()) {
@@ -861,6 +882,7 @@ absl::Status BlockElaboration::Accept(
       }
     };
     CycleChecker cycle_checker;
+    cycle_checker.UseDenseVisitedState(*this);
     for (BlockInstance* instance : instance_ptrs_) {
       if (!instance->block().has_value()) {
         continue;
@@ -907,13 +929,23 @@ std::vector<ElaboratedNode> ElaboratedReverseTopoSort(
   //
   // NOTE: sorts reverse-topologically.  To sort topologically, reverse the
   // result.
-  absl::flat_hash_map<ElaboratedNode, int64_t> pending_to_remaining_successors;
+  //
+  // The remaining successor counts are kept in a flat array indexed by
+  // BlockElaboration::NodeIndex; kUnseen marks nodes not yet pending.
+  constexpr int64_t kUnseen = std::numeric_limits<int64_t>::min();
+  std::vector<int64_t> remaining_successors_by_index(
+      elaboration.elaborated_node_count(), kUnseen);
+  auto remaining_successors_of = [&](const ElaboratedNode& n) -> int64_t& {
+    return remaining_successors_by_index[elaboration.NodeIndex(n)];
+  };
   std::vector<ElaboratedNode> ordered;
   std::deque<ElaboratedNode> ready;
 
   auto seed_ready = [&](ElaboratedNode n) {
     ready.push_front(n);
-    CHECK(pending_to_remaining_successors.insert({n, -1}).second);
+    int64_t& remaining_successors = remaining_successors_of(n);
+    CHECK_EQ(remaining_successors, kUnseen);
+    remaining_successors = -1;
   };
 
   int64_t node_count = 0;
@@ -944,18 +976,15 @@ std::vector<ElaboratedNode> ElaboratedReverseTopoSort(
     CHECK_OK(inter_instance_users_or.status());
     for (const ElaboratedNode& inter_instance_user :
          inter_instance_users_or.value()) {
-      auto it = pending_to_remaining_successors.find(inter_instance_user);
-      if (it == pending_to_remaining_successors.end() || it->second >= 0) {
+      int64_t remaining = remaining_successors_of(inter_instance_user);
+      if (remaining == kUnseen || remaining >= 0) {
         return false;
       }
     }
     return absl::c_all_of(n.node->users(), [&](Node* user) {
-      auto it = pending_to_remaining_successors.find(
+      int64_t remaining = remaining_successors_of(
           ElaboratedNode{.node = user, .instance = n.instance});
-      if (it == pending_to_remaining_successors.end()) {
-        return false;
-      }
-      return it->second < 0;
+      return remaining != kUnseen && remaining < 0;
     });
   };
   auto bump_down_remaining_successors = [&](const ElaboratedNode& n) {
@@ -963,19 +992,19 @@ std::vector<ElaboratedNode> ElaboratedReverseTopoSort(
         InterInstanceSuccessors(n);
     CHECK_OK(inter_instance_users_or.status());
     CHECK(!n.node->users().empty() || !inter_instance_users_or.value().empty());
-    auto [it, inserted] =
-        pending_to_remaining_successors.insert({n, n.node->users().size()});
-    int64_t& remaining_successors = it->second;
-    // If we inserted, add inter-instance users.
-    if (inserted) {
-      remaining_successors += inter_instance_users_or.value().size();
+    int64_t& remaining_successors = remaining_successors_of(n);
+    // If this is the first time we've seen the node, count its users including
+    // inter-instance users.
+    if (remaining_successors == kUnseen) {
+      remaining_successors =
+          n.node->users().size() + inter_instance_users_or.value().size();
     }
     CHECK_GT(remaining_successors, 0);
     remaining_successors -= 1;
     VLOG(5) << "Bumped down remaining successors for: " << n
             << "; now: " << remaining_successors;
     if (remaining_successors == 0) {
-      ready.push_back(it->first);
+      ready.push_back(n);
       remaining_successors -= 1;
     }
   };
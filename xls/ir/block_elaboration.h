@@ -15,6 +15,7 @@
 #ifndef XLS_IR_BLOCK_ELABORATION_H_
 #define XLS_IR_BLOCK_ELABORATION_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -126,6 +127,8 @@ class BlockInstance {
   }
 
  private:
+  friend class BlockElaboration;
+
   std::optional<Block*> block_;
   std::optional<Instantiation*> instantiation_;
   BlockInstantiationPath path_;
@@ -141,6 +144,12 @@ class BlockInstance {
   // Each pointer (keys and values!) must be non-null.
   absl::flat_hash_map<Instantiation*, BlockInstance*>
       instantiation_to_instance_;
+
+  // Numbering of the nodes of block() shared by all instances of the block,
+  // and the offset of this instance's nodes in the elaboration-wide numbering
+  // (see BlockElaboration::NodeIndex). Owned by the elaboration.
+  const absl::flat_hash_map<Node*, int64_t>* node_indices_ = nullptr;
+  int64_t node_index_offset_ = 0;
 };
 
 // Data structure representing the elaboration tree starting from a root block.
@@ -168,6 +177,20 @@ class BlockElaboration {
 
   Package* package() const { return package_; }
 
+  // Returns the total number of nodes in all block instances of the
+  // elaboration.
+  int64_t elaborated_node_count() const { return elaborated_node_count_; }
+
+  // Returns a dense index in [0, elaborated_node_count()) uniquely identifying
+  // the given node of the elaboration. Nodes are numbered once per block and
+  // each instance is assigned a range of indices, so per-node data for large
+  // elaborations (e.g., visited state or values) can be kept in flat arrays
+  // rather than hash maps keyed on ElaboratedNode.
+  int64_t NodeIndex(const ElaboratedNode& node) const {
+    return node.instance->node_index_offset_ +
+           node.instance->node_indices_->at(node.node);
+  }
+
   // Create path from the given path string serialization. Example input:
   //
   //    top_proc::inst1->other_proc::inst2->that_proc
@@ -193,12 +216,15 @@ class BlockElaboration {
   // List of all blocks that are instantiated.
   std::vector<Block*> blocks_;
 
-  // All proc instances in the elaboration indexed by instantiation path.
-  absl::flat_hash_map<BlockInstantiationPath, BlockInstance*>
-      instances_by_path_;
-
   absl::flat_hash_map<Block*, std::vector<BlockInstance*>>
       instances_of_function_;
+
+  // Numbering of the nodes of each block, shared by all of its instances.
+  // Unique pointers are used for pointer stability as instances refer to them.
+  absl::flat_hash_map<Block*,
+                      std::unique_ptr<absl::flat_hash_map<Node*, int64_t>>>
+      node_indices_;
+  int64_t elaborated_node_count_ = 0;
 };
 
 // Returns a list of every (Node, BlockInstance) in the elaboration in topo
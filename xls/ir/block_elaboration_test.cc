@@ -15,12 +15,14 @@
 #include "xls/ir/block_elaboration.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <optional>
 #include <string_view>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
@@ -226,6 +228,32 @@ TEST_F(ElaborationTest, ElaborateMultipleBlockInstantiations) {
                           "instance count: 3")));
 }
 
+TEST_F(ElaborationTest, NodeIndicesAreDense) {
+  auto p = CreatePackage();
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, MultipleAddInstantiations(*p));
+
+  XLS_ASSERT_OK_AND_ASSIGN(BlockElaboration elab,
+                           BlockElaboration::Elaborate(block));
+
+  int64_t node_count = 0;
+  absl::flat_hash_set<int64_t> indices;
+  for (BlockInstance* instance : elab.instances()) {
+    if (!instance->block().has_value()) {
+      continue;
+    }
+    for (Node* node : (*instance->block())->nodes()) {
+      ++node_count;
+      int64_t index =
+          elab.NodeIndex(ElaboratedNode{.node = node, .instance = instance});
+      EXPECT_GE(index, 0);
+      EXPECT_LT(index, elab.elaborated_node_count());
+      EXPECT_TRUE(indices.insert(index).second);
+    }
+  }
+  EXPECT_EQ(elab.elaborated_node_count(), node_count);
+}
+
 TEST_F(ElaborationTest, ElaborateFifoInstantiation) {
   auto p = CreatePackage();
 
@@ -15,9 +15,13 @@
 #ifndef XLS_IR_DFS_VISITOR_H_
 #define XLS_IR_DFS_VISITOR_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
@@ -139,11 +143,76 @@ class DfsVisitor {
   int64_t GetVisitedCount() const { return visited_.size(); }
 
  private:
+  friend class FunctionBase;
+  friend class Node;
+
+  // A set of nodes stored in a table indexed by node ID, so membership tests
+  // on the traversal's hot path don't hash. Nodes from another package may
+  // share an ID with a node already in the table; those go in a hash set.
+  class NodeSet {
+   public:
+    bool contains(Node* node) const {
+      int64_t id = node->id();
+      if (id < by_id_.size() && by_id_[id] == node) {
+        return true;
+      }
+      return !overflow_.empty() && overflow_.contains(node);
+    }
+    void insert(Node* node) {
+      if (contains(node)) {
+        return;
+      }
+      int64_t id = node->id();
+      DCHECK_GE(id, 0);
+      if (id >= by_id_.size()) {
+        by_id_.resize(std::max<int64_t>(id + 1, 2 * by_id_.size()), nullptr);
+      }
+      if (by_id_[id] == nullptr) {
+        by_id_[id] = node;
+      } else {
+        overflow_.insert(node);
+      }
+      ++size_;
+    }
+    void erase(Node* node) {
+      int64_t id = node->id();
+      if (id < by_id_.size() && by_id_[id] == node) {
+        by_id_[id] = nullptr;
+        --size_;
+      } else if (overflow_.erase(node) > 0) {
+        --size_;
+      }
+    }
+    // Sizes the table for nodes with IDs below `id_limit`.
+    void reserve(int64_t id_limit) {
+      if (id_limit > by_id_.size()) {
+        by_id_.resize(id_limit, nullptr);
+      }
+    }
+    void clear() {
+      by_id_.clear();
+      overflow_.clear();
+      size_ = 0;
+    }
+    int64_t size() const { return size_; }
+
+   private:
+    std::vector<Node*> by_id_;
+    absl::flat_hash_set<Node*> overflow_;
+    int64_t size_ = 0;
+  };
+
   // Set of nodes which have been visited.
-  absl::flat_hash_set<Node*> visited_;
+  NodeSet visited_;
 
   // Set of nodes which are being traversed through.
-  absl::flat_hash_set<Node*> traversing_;
+  NodeSet traversing_;
+
+  // Explicit stack used by Node::Accept in place of recursion: each entry is a
+  // node being traversed and the index of its next operand to visit. Nested
+  // Accept calls (e.g. from a handler) push above the entries of the outer
+  // call, so the storage is kept and reused across calls.
+  std::vector<std::pair<Node*, int64_t>> dfs_stack_;
 };
 
 // Visitor with a default action. If the Handle<Op> method is not overridden
@@ -26,6 +26,7 @@
 #include "absl/status/status.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
@@ -147,5 +148,45 @@ fn graph(p: bits[42], q: bits[42]) -> bits[42] {
   }
 }
 
+TEST_F(DfsVisitorTest, DeepChain) {
+  // Deep enough to overflow the stack of a recursive traversal.
+  constexpr int64_t kDepth = 200000;
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  for (int64_t i = 0; i < kDepth; ++i) {
+    x = fb.Not(x);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  TestVisitor v;
+  XLS_ASSERT_OK(f->Accept(&v));
+  EXPECT_EQ(v.visited_count(), kDepth + 1);
+  EXPECT_TRUE(v.visited().front()->Is<Param>());
+  EXPECT_EQ(v.visited().back(), f->return_value());
+}
+
+TEST_F(DfsVisitorTest, NodesWithSameIdInDifferentPackages) {
+  std::string input = R"(
+fn graph(p: bits[42], q: bits[42]) -> bits[42] {
+  and.1: bits[42] = and(p, q)
+  ret add.2: bits[42] = add(and.1, q)
+}
+)";
+  auto p1 = CreatePackage();
+  auto p2 = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f1, ParseFunction(input, p1.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f2, ParseFunction(input, p2.get()));
+
+  TestVisitor v;
+  XLS_ASSERT_OK(f1->Accept(&v));
+  XLS_ASSERT_OK(f2->Accept(&v));
+  EXPECT_EQ(v.visited_count(), 8);
+  EXPECT_EQ(v.unique_visited_count(), 8);
+  EXPECT_EQ(v.GetVisitedCount(), 8);
+  EXPECT_TRUE(v.IsVisited(FindNode("add.2", f1)));
+  EXPECT_TRUE(v.IsVisited(FindNode("add.2", f2)));
+}
+
 }  // namespace
 }  // namespace xls
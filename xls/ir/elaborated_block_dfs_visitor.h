@@ -16,8 +16,10 @@
 #define XLS_IR_ELABORATED_BLOCK_DFS_VISITOR_H_
 
 #include <cstdint>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "xls/ir/block_elaboration.h"
 #include "xls/ir/node.h"
@@ -151,11 +153,36 @@ class ElaboratedBlockDfsVisitor {
 
   // Returns true if the given node has been visited.
   bool IsVisited(const ElaboratedNode& node) const {
+    if (elaboration_ != nullptr) {
+      return dense_visited_[elaboration_->NodeIndex(node)];
+    }
     return visited_.contains(node);
   }
 
   // Marks the given node as visited.
-  void MarkVisited(const ElaboratedNode& node) { visited_.insert(node); }
+  void MarkVisited(const ElaboratedNode& node) {
+    if (elaboration_ != nullptr) {
+      std::vector<bool>::reference visited =
+          dense_visited_[elaboration_->NodeIndex(node)];
+      if (!visited) {
+        visited = true;
+        ++dense_visited_count_;
+      }
+      return;
+    }
+    visited_.insert(node);
+  }
+
+  // Tracks visited nodes of the given elaboration in a bit vector indexed by
+  // BlockElaboration::NodeIndex rather than in a set of nodes, which is much
+  // more compact for large elaborations. Only nodes of `elaboration` may be
+  // visited afterwards. Called by BlockElaboration::Accept.
+  void UseDenseVisitedState(const BlockElaboration& elaboration) {
+    CHECK(visited_.empty());
+    elaboration_ = &elaboration;
+    dense_visited_.assign(elaboration.elaborated_node_count(), false);
+    dense_visited_count_ = 0;
+  }
 
   // Returns whether the given node is on path from the root of the traversal
   // to the currently visited node. Used to identify cycles in the graph.
@@ -176,12 +203,21 @@ class ElaboratedBlockDfsVisitor {
   void ResetVisitedState() {
     visited_.clear();
     traversing_.clear();
+    dense_visited_.assign(dense_visited_.size(), false);
+    dense_visited_count_ = 0;
   }
 
   // Return the total number of nodes visited.
-  int64_t GetVisitedCount() const { return visited_.size(); }
+  int64_t GetVisitedCount() const {
+    return elaboration_ != nullptr ? dense_visited_count_ : visited_.size();
+  }
 
  private:
+  // If set, visited state is kept in `dense_visited_` instead of `visited_`.
+  const BlockElaboration* elaboration_ = nullptr;
+  std::vector<bool> dense_visited_;
+  int64_t dense_visited_count_ = 0;
+
   // Set of nodes which have been visited.
   absl::flat_hash_set<ElaboratedNode> visited_;
 
@@ -14,10 +14,91 @@
 
 #include "xls/ir/events.h"
 
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 
+std::string TraceEvent::Format() const {
+  if (is_formatted_) {
+    return message_;
+  }
+  if (formatter_ != nullptr) {
+    return formatter_();
+  }
+  std::string message;
+  auto arg = args_.begin();
+  for (const FormatStep& step : format_) {
+    if (std::holds_alternative<std::string>(step)) {
+      absl::StrAppend(&message, std::get<std::string>(step));
+    } else if (arg != args_.end()) {
+      absl::StrAppend(&message,
+                      arg->ToHumanString(std::get<FormatPreference>(step)));
+      ++arg;
+    }
+  }
+  return message;
+}
+
+void StreamEventSink::HandleTrace(const TraceEvent& event) {
+  std::string message = event.Format();
+  absl::MutexLock lock(&mutex_);
+  *stream_ << message << "\n";
+}
+
+void RingBufferEventSink::HandleTrace(const TraceEvent& event) {
+  absl::MutexLock lock(&mutex_);
+  if (capacity_ <= 0) {
+    ++dropped_count_;
+    return;
+  }
+  if (static_cast<int64_t>(events_.size()) >= capacity_) {
+    events_.pop_front();
+    ++dropped_count_;
+  }
+  events_.push_back(event);
+}
+
+std::vector<TraceMessage> RingBufferEventSink::GetTraceMessages() const {
+  absl::MutexLock lock(&mutex_);
+  std::vector<TraceMessage> messages;
+  messages.reserve(events_.size());
+  for (const TraceEvent& event : events_) {
+    messages.push_back(event.ToTraceMessage());
+  }
+  return messages;
+}
+
+int64_t RingBufferEventSink::dropped_count() const {
+  absl::MutexLock lock(&mutex_);
+  return dropped_count_;
+}
+
+void InterpreterEvents::AddTrace(const TraceEvent& event) {
+  if (sink != nullptr) {
+    sink->HandleTrace(event);
+    return;
+  }
+  trace_msgs.push_back(event.ToTraceMessage());
+}
+
+void InterpreterEvents::AddAssert(std::string message) {
+  if (sink != nullptr) {
+    sink->HandleAssert(message);
+  }
+  assert_msgs.push_back(std::move(message));
+}
+
 absl::Status InterpreterEventsToStatus(const InterpreterEvents& events) {
   if (events.assert_msgs.empty()) {
     return absl::OkStatus();
@@ -17,12 +17,22 @@
 
 #include <compare>
 #include <cstdint>
+#include <deque>
+#include <functional>
+#include <ostream>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 
@@ -49,12 +59,126 @@ struct TraceMessage {
   }
 };
 
+// A trace produced by an evaluator. The message is either already formatted,
+// held as the format steps of the trace operation and the values of its
+// arguments, or produced by a formatter function. In the latter cases it is
+// only formatted if a consumer asks for it.
+class TraceEvent {
+ public:
+  TraceEvent(std::string message, int64_t verbosity)
+      : message_(std::move(message)), verbosity_(verbosity) {}
+
+  // `format` is not copied and must outlive the event. It is typically owned
+  // by the trace node so its address also identifies the trace operation.
+  TraceEvent(absl::Span<const FormatStep> format, std::vector<Value> args,
+             int64_t verbosity)
+      : format_(format),
+        args_(std::move(args)),
+        verbosity_(verbosity),
+        is_formatted_(false) {}
+
+  TraceEvent(std::function<std::string()> formatter, int64_t verbosity)
+      : formatter_(std::move(formatter)),
+        verbosity_(verbosity),
+        is_formatted_(false) {}
+
+  int64_t verbosity() const { return verbosity_; }
+  bool is_formatted() const { return is_formatted_; }
+
+  // The format steps and arguments of an unformatted event.
+  absl::Span<const FormatStep> format() const { return format_; }
+  absl::Span<const Value> args() const { return args_; }
+
+  // Returns the formatted message.
+  std::string Format() const;
+  TraceMessage ToTraceMessage() const {
+    return TraceMessage{.message = Format(), .verbosity = verbosity_};
+  }
+
+ private:
+  std::string message_;
+  absl::Span<const FormatStep> format_;
+  std::vector<Value> args_;
+  std::function<std::string()> formatter_;
+  int64_t verbosity_;
+  bool is_formatted_ = true;
+};
+
+// Receives events as they are produced instead of InterpreterEvents
+// accumulating them. A sink may be shared by the proc instances of a
+// ParallelProcRuntime and so must then be thread-safe; the sinks below are.
+class InterpreterEventSink {
+ public:
+  virtual ~InterpreterEventSink() = default;
+
+  virtual void HandleTrace(const TraceEvent& event) = 0;
+
+  // Assertion failures are passed to the sink in addition to being recorded in
+  // InterpreterEvents::assert_msgs, which determines the result status.
+  virtual void HandleAssert(std::string_view message) {}
+};
+
+// A sink which writes each trace message as a line to a stream.
+class StreamEventSink : public InterpreterEventSink {
+ public:
+  explicit StreamEventSink(std::ostream* stream) : stream_(stream) {}
+
+  void HandleTrace(const TraceEvent& event) override;
+
+ private:
+  absl::Mutex mutex_;
+  std::ostream* stream_ ABSL_GUARDED_BY(mutex_);
+};
+
+// A sink which passes each event to a function. The function is called
+// concurrently if the sink is shared between threads.
+class CallbackEventSink : public InterpreterEventSink {
+ public:
+  explicit CallbackEventSink(std::function<void(const TraceEvent&)> callback)
+      : callback_(std::move(callback)) {}
+
+  void HandleTrace(const TraceEvent& event) override { callback_(event); }
+
+ private:
+  std::function<void(const TraceEvent&)> callback_;
+};
+
+// A sink which keeps only the last `capacity` trace events. Events are
+// formatted when retrieved rather than when recorded.
+class RingBufferEventSink : public InterpreterEventSink {
+ public:
+  explicit RingBufferEventSink(int64_t capacity) : capacity_(capacity) {}
+
+  void HandleTrace(const TraceEvent& event) override;
+
+  // Returns the retained trace messages, oldest first.
+  std::vector<TraceMessage> GetTraceMessages() const;
+
+  // Returns the number of trace events which have been discarded.
+  int64_t dropped_count() const;
+
+ private:
+  int64_t capacity_;
+  mutable absl::Mutex mutex_;
+  std::deque<TraceEvent> events_ ABSL_GUARDED_BY(mutex_);
+  int64_t dropped_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
 // Common structure capturing events that can be produced by any XLS interpreter
 // (DSLX, IR, JIT, etc.)
 struct InterpreterEvents {
   std::vector<TraceMessage> trace_msgs;
   std::vector<std::string> assert_msgs;
 
+  // If set, trace events are passed to the sink instead of being accumulated
+  // in `trace_msgs`. Not owned.
+  InterpreterEventSink* sink = nullptr;
+
+  // Records a trace or assertion failure, passing it to the sink if any.
+  void AddTrace(const TraceEvent& event);
+  void AddAssert(std::string message);
+
+  // Clears the recorded events. The sink is kept.
   void Clear() {
     trace_msgs.clear();
     assert_msgs.clear();
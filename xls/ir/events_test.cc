@@ -0,0 +1,113 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/ir/events.h"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(EventsTest, FormatDeferredTrace) {
+  std::vector<FormatStep> format = {"x is ", FormatPreference::kHex,
+                                    " and y is ", FormatPreference::kDefault};
+  TraceEvent event(format, {Value(UBits(42, 8)), Value(UBits(7, 4))},
+                   /*verbosity=*/2);
+  EXPECT_FALSE(event.is_formatted());
+  EXPECT_EQ(event.Format(), "x is 0x2a and y is 7");
+  EXPECT_EQ(event.ToTraceMessage(),
+            (TraceMessage{.message = "x is 0x2a and y is 7", .verbosity = 2}));
+}
+
+TEST(EventsTest, FormatTraceWithFormatter) {
+  int64_t calls = 0;
+  TraceEvent event(
+      [&]() {
+        ++calls;
+        return std::string("formatted");
+      },
+      /*verbosity=*/1);
+  EXPECT_FALSE(event.is_formatted());
+  EXPECT_EQ(calls, 0);
+  EXPECT_EQ(event.Format(), "formatted");
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(EventsTest, EventsWithoutSinkAccumulate) {
+  InterpreterEvents events;
+  events.AddTrace(TraceEvent("hello", /*verbosity=*/0));
+  events.AddAssert("oops");
+  EXPECT_THAT(events.trace_msgs,
+              ElementsAre(TraceMessage{.message = "hello", .verbosity = 0}));
+  EXPECT_THAT(events.assert_msgs, ElementsAre("oops"));
+}
+
+TEST(EventsTest, StreamSink) {
+  std::stringstream stream;
+  StreamEventSink sink(&stream);
+  InterpreterEvents events;
+  events.sink = &sink;
+  events.AddTrace(TraceEvent("first", /*verbosity=*/0));
+  events.AddTrace(TraceEvent("second", /*verbosity=*/1));
+  EXPECT_THAT(events.trace_msgs, IsEmpty());
+  EXPECT_EQ(stream.str(), "first\nsecond\n");
+
+  // Assertion failures are still recorded as they determine the status.
+  events.AddAssert("oops");
+  EXPECT_THAT(events.assert_msgs, ElementsAre("oops"));
+}
+
+TEST(EventsTest, CallbackSink) {
+  std::vector<int64_t> verbosities;
+  CallbackEventSink sink([&](const TraceEvent& event) {
+    verbosities.push_back(event.verbosity());
+  });
+  InterpreterEvents events;
+  events.sink = &sink;
+  events.AddTrace(TraceEvent("a", /*verbosity=*/3));
+  events.AddTrace(TraceEvent("b", /*verbosity=*/1));
+  EXPECT_THAT(verbosities, ElementsAre(3, 1));
+}
+
+TEST(EventsTest, RingBufferSinkKeepsLastEvents) {
+  std::vector<FormatStep> format = {"value: ", FormatPreference::kDefault};
+  RingBufferEventSink sink(/*capacity=*/2);
+  InterpreterEvents events;
+  events.sink = &sink;
+  for (int64_t i = 0; i < 5; ++i) {
+    events.AddTrace(TraceEvent(format, {Value(UBits(i, 8))}, /*verbosity=*/0));
+  }
+  EXPECT_THAT(events.trace_msgs, IsEmpty());
+  EXPECT_THAT(sink.GetTraceMessages(),
+              ElementsAre(TraceMessage{.message = "value: 3", .verbosity = 0},
+                          TraceMessage{.message = "value: 4", .verbosity = 0}));
+  EXPECT_EQ(sink.dropped_count(), 3);
+}
+
+}  // namespace
+}  // namespace xls
@@ -35,6 +35,7 @@
 #include "xls/ir/package.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
+#include "xls/ir/verify_node.h"
 
 namespace xls {
 
@@ -88,7 +89,6 @@ absl::StatusOr<Function*> Function::Clone(
     std::string_view new_name, Package* target_package,
     const absl::flat_hash_map<const Function*, Function*>& call_remapping)
     const {
-  absl::flat_hash_map<Node*, Node*> original_to_clone;
   if (target_package == nullptr) {
     target_package = package();
   }
@@ -96,16 +96,36 @@ absl::StatusOr<Function*> Function::Clone(
       std::make_unique<Function>(new_name, target_package));
   cloned_function->SetForeignFunctionData(foreign_function_);
 
+  // The nodes of this function already have unique names and were verified
+  // when created so they are cloned in bulk without re-verifying or
+  // re-uniquifying each one.
+  cloned_function->BeginBulkClone(*this);
+  absl::StatusOr<Node*> cloned_return_value =
+      CloneNodesInto(cloned_function, call_remapping);
+  cloned_function->EndBulkClone();
+  XLS_RETURN_IF_ERROR(cloned_return_value.status());
+  XLS_RETURN_IF_ERROR(cloned_function->set_return_value(*cloned_return_value));
+  return cloned_function;
+}
+
+absl::StatusOr<Node*> Function::CloneNodesInto(
+    Function* cloned_function,
+    const absl::flat_hash_map<const Function*, Function*>& call_remapping)
+    const {
+  absl::flat_hash_map<Node*, Node*> original_to_clone;
+  original_to_clone.reserve(node_count());
+
   // Clone parameters over first to maintain order.
   for (Param* param : (const_cast<Function*>(this))->params()) {
     XLS_ASSIGN_OR_RETURN(original_to_clone[param],
                          param->CloneInNewFunction({}, cloned_function));
   }
+  std::vector<Node*> cloned_operands;
   for (Node* node : TopoSort(const_cast<Function*>(this))) {
     if (node->Is<Param>()) {  // Params were already copied.
       continue;
     }
-    std::vector<Node*> cloned_operands;
+    cloned_operands.clear();
     for (Node* operand : node->operands()) {
       cloned_operands.push_back(original_to_clone.at(operand));
     }
@@ -157,10 +177,14 @@ absl::StatusOr<Function*> Function::Clone(
         break;
       }
     }
+    // Nodes are not verified while cloning in bulk, but a remapped callee may
+    // not match the signature of the original.
+    if (node->op() == Op::kCountedFor || node->op() == Op::kMap ||
+        node->op() == Op::kInvoke) {
+      XLS_RETURN_IF_ERROR(VerifyNode(original_to_clone.at(node)));
+    }
   }
-  XLS_RETURN_IF_ERROR(
-      cloned_function->set_return_value(original_to_clone.at(return_value())));
-  return cloned_function;
+  return original_to_clone.at(return_value());
 }
 
 // Helper function for IsDefinitelyEqualTo. Recursively compares 'node' and
@@ -50,7 +50,11 @@ class Function : public FunctionBase {
     XLS_RET_CHECK_EQ(n->function_base(), this) << absl::StreamFormat(
         "Return value node %s is not in this function %s (is in function %s)",
         n->GetName(), name(), n->function_base()->name());
-    return_value_ = n;
+    if (return_value_ != n) {
+      return_value_ = n;
+      // The return value is ordered specially by TopoSort.
+      NextChangeEpoch();
+    }
     return absl::OkStatus();
   }
 
@@ -80,6 +84,13 @@ class Function : public FunctionBase {
   bool HasImplicitUse(Node* node) const final { return node == return_value(); }
 
  private:
+  // Clones the nodes of this function into `cloned_function` and returns the
+  // clone of the return value.
+  absl::StatusOr<Node*> CloneNodesInto(
+      Function* cloned_function,
+      const absl::flat_hash_map<const Function*, Function*>& call_remapping)
+      const;
+
   Node* return_value_ = nullptr;
 };
 
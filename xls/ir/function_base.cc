@@ -15,7 +15,9 @@
 #include "xls/ir/function_base.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <ostream>
@@ -31,6 +33,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "google/protobuf/text_format.h"
 #include "xls/common/casts.h"
 #include "xls/common/status/ret_check.h"
@@ -43,6 +46,7 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
+#include "xls/ir/structural_hash_index.h"
 
 namespace xls {
 
@@ -98,6 +102,39 @@ absl::Status FunctionBase::MoveParamToIndex(Param* param, int64_t index) {
   return absl::OkStatus();
 }
 
+/* static */ int64_t FunctionBase::GetNextUid() {
+  static std::atomic<int64_t> next_uid = 0;
+  return next_uid.fetch_add(1, std::memory_order_relaxed);
+}
+
+int64_t FunctionBase::GetNextNodeId() {
+  if (isolated_state_.has_value()) {
+    return isolated_state_->next_node_id++;
+  }
+  return package()->GetNextNodeId();
+}
+
+TransformMetrics& FunctionBase::transform_metrics() {
+  if (isolated_state_.has_value()) {
+    return isolated_state_->transform_metrics;
+  }
+  return package()->transform_metrics();
+}
+
+void FunctionBase::BeginIsolation(int64_t first_node_id) {
+  CHECK(!isolated_state_.has_value()) << name();
+  isolated_state_ = IsolatedState{.first_node_id = first_node_id,
+                                  .next_node_id = first_node_id,
+                                  .transform_metrics = TransformMetrics{}};
+}
+
+FunctionBase::IsolatedState FunctionBase::EndIsolation() {
+  CHECK(isolated_state_.has_value()) << name();
+  IsolatedState state = *isolated_state_;
+  isolated_state_.reset();
+  return state;
+}
+
 absl::StatusOr<Node*> FunctionBase::GetNodeById(int64_t id) const {
   for (Node* node : nodes()) {
     if (node->id() == id) {
@@ -128,7 +165,10 @@ absl::Status FunctionBase::RemoveNode(Node* node) {
   XLS_RET_CHECK(!HasImplicitUse(node)) << node->GetName();
   VLOG(4) << absl::StrFormat("Removing node from FunctionBase %s: %s", name(),
                              node->ToString());
-  ++package()->transform_metrics().nodes_removed;
+  ++transform_metrics().nodes_removed;
+  if (structural_hash_index_ != nullptr) {
+    structural_hash_index_->Remove(node);
+  }
   std::vector<Node*> unique_operands;
   for (Node* operand : node->operands()) {
     if (!absl::c_linear_search(unique_operands, operand)) {
@@ -155,10 +195,27 @@ absl::Status FunctionBase::RemoveNode(Node* node) {
   XLS_RET_CHECK(node_it != node_iterators_.end());
   nodes_.erase(node_it->second);
   node_iterators_.erase(node_it);
+  // Removing a node without operands changes no users, so advance the epoch
+  // explicitly.
+  NextChangeEpoch();
   return absl::OkStatus();
 }
 
+std::vector<Node*> FunctionBase::CachedReverseTopoSort(
+    const std::function<std::vector<Node*>(FunctionBase*)>& compute) {
+  absl::MutexLock lock(&topo_sort_cache_mutex_);
+  if (!topo_sort_cache_.has_value() ||
+      topo_sort_cache_->change_epoch != change_epoch_) {
+    topo_sort_cache_ = TopoSortCache{.change_epoch = change_epoch_,
+                                     .reverse_order = compute(this)};
+  }
+  return topo_sort_cache_->reverse_order;
+}
+
 absl::Status FunctionBase::Accept(DfsVisitor* visitor) {
+  visitor->visited_.reserve(package()->next_node_id());
+  visitor->traversing_.reserve(package()->next_node_id());
+  visitor->dfs_stack_.reserve(node_count());
   for (Node* node : nodes()) {
     if (node->users().empty()) {
       XLS_RETURN_IF_ERROR(node->Accept(visitor));
@@ -230,7 +287,7 @@ Block* FunctionBase::AsBlockOrDie() {
 Node* FunctionBase::AddNodeInternal(std::unique_ptr<Node> node) {
   VLOG(4) << absl::StrFormat("Adding node to FunctionBase %s: %s", name(),
                              node->ToString());
-  ++package()->transform_metrics().nodes_added;
+  ++transform_metrics().nodes_added;
   if (node->Is<Param>()) {
     params_.push_back(node->As<Param>());
     next_values_by_param_[node->As<Param>()];
@@ -242,10 +299,30 @@ Node* FunctionBase::AddNodeInternal(std::unique_ptr<Node> node) {
     next_values_by_param_.at(param).insert(next);
   }
   Node* ptr = node.get();
+  ptr->MarkOperandsChanged();
   node_iterators_[ptr] = nodes_.insert(nodes_.end(), std::move(node));
+  if (structural_hash_index_ != nullptr) {
+    structural_hash_index_->Add(ptr);
+  }
   return ptr;
 }
 
+void FunctionBase::BeginBulkClone(const FunctionBase& source) {
+  CHECK(nodes_.empty()) << name();
+  node_name_uniquer_.CopyFrom(source.node_name_uniquer_);
+  node_iterators_.reserve(source.node_count());
+  params_.reserve(source.params_.size());
+  next_values_.reserve(source.next_values_.size());
+  bulk_cloning_ = true;
+}
+
+StructuralHashIndex* FunctionBase::EnableStructuralHashing() {
+  if (structural_hash_index_ == nullptr) {
+    structural_hash_index_ = std::make_unique<StructuralHashIndex>(this);
+  }
+  return structural_hash_index_.get();
+}
+
 /* static */ std::vector<std::string> FunctionBase::GetIrReservedWords() {
   std::vector<std::string> words(Token::GetKeywords().begin(),
                                  Token::GetKeywords().end());
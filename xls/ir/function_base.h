@@ -16,6 +16,7 @@
 #define XLS_IR_FUNCTION_BASE_H_
 
 #include <cstdint>
+#include <functional>
 #include <list>
 #include <memory>
 #include <optional>
@@ -29,6 +30,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/iterator_range.h"
 #include "xls/common/status/status_macros.h"
@@ -38,6 +40,7 @@
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/structural_hash_index.h"
 #include "xls/ir/unwrapping_iterator.h"
 #include "xls/ir/verify_node.h"
 
@@ -53,7 +56,7 @@ class FunctionBase {
 
  public:
   FunctionBase(std::string_view name, Package* package)
-      : name_(name), package_(package) {}
+      : name_(name), package_(package), uid_(GetNextUid()) {}
   FunctionBase(const FunctionBase& other) = delete;
   void operator=(const FunctionBase& other) = delete;
 
@@ -143,10 +146,86 @@ class FunctionBase {
   absl::StatusOr<NodeT*> MakeNodeWithName(Args&&... args) {
     NodeT* new_node =
         AddNode(std::make_unique<NodeT>(std::forward<Args>(args)..., this));
-    XLS_RETURN_IF_ERROR(VerifyNode(new_node));
+    if (!bulk_cloning_) {
+      XLS_RETURN_IF_ERROR(VerifyNode(new_node));
+    }
     return new_node;
   }
 
+  // Returns a new unique id for a node of this function base. Ids are normally
+  // drawn from the package (see Package::GetNextNodeId), or from a private
+  // range if the function base is isolated.
+  int64_t GetNextNodeId();
+
+  // Returns the metrics to update for transformations of this function base.
+  // These are the package's metrics unless the function base is isolated.
+  TransformMetrics& transform_metrics();
+
+  // Package state which is tracked by the function base while it is isolated.
+  struct IsolatedState {
+    // Nodes created while isolated were given ids in
+    // [first_node_id, next_node_id).
+    int64_t first_node_id;
+    int64_t next_node_id;
+
+    // Metrics for the transformations made while isolated.
+    TransformMetrics transform_metrics;
+  };
+
+  // Isolates this function base from the mutable state shared through its
+  // package so that it can be transformed concurrently with other function
+  // bases of the same package. While isolated, new nodes are given ids
+  // starting at `first_node_id` rather than ids from the package, and
+  // transform metrics are accumulated locally. The caller must ensure that the
+  // id ranges of concurrently isolated function bases do not overlap, and that
+  // the isolated function bases do not access one another. The package's type
+  // manager is thread-safe and node names are uniquified per function base so
+  // neither requires isolation.
+  void BeginIsolation(int64_t first_node_id);
+
+  // Ends the isolation started by BeginIsolation and returns the state
+  // accumulated while isolated. The caller is responsible for merging it into
+  // the package.
+  IsolatedState EndIsolation();
+
+  // Returns the current change epoch. The epoch is advanced on every change to
+  // the graph (node additions and changes to operands or users) and each
+  // changed node records the epoch of its most recent change (see
+  // Node::change_epoch). The nodes changed since some point are thus those
+  // with a change epoch greater than the epoch at that point.
+  int64_t change_epoch() const { return change_epoch_; }
+
+  // Advances the change epoch and returns the new epoch.
+  int64_t NextChangeEpoch() { return ++change_epoch_; }
+
+  // Returns the reverse topological order computed by `compute`, reusing the
+  // order from the previous call if the change epoch hasn't advanced since.
+  // Used by TopoSort and ReverseTopoSort.
+  std::vector<Node*> CachedReverseTopoSort(
+      const std::function<std::vector<Node*>(FunctionBase*)>& compute);
+
+  // Enables structural hashing (hash-consing) of the nodes of this function
+  // base. While enabled the function base maintains an index of its nodes by
+  // structure, updated as nodes are added and removed and as their operands
+  // change, so nodes equivalent to a new or changed node can be found without
+  // rehashing the whole graph. Returns the index, which is created on the first
+  // call.
+  StructuralHashIndex* EnableStructuralHashing();
+
+  // Disables structural hashing and frees the index.
+  void DisableStructuralHashing() { structural_hash_index_.reset(); }
+
+  // Returns the structural hash index, or nullptr if structural hashing is not
+  // enabled.
+  StructuralHashIndex* structural_hash_index() const {
+    return structural_hash_index_.get();
+  }
+
+  // Returns an identifier of this function base which is unique within the
+  // process. Unlike the address of the function base it is never reused so it
+  // may be used to key state which outlives the function base.
+  int64_t uid() const { return uid_; }
+
   // Find a node by its name, as generated by DumpIr.
   absl::StatusOr<Node*> GetNode(std::string_view standard_node_name) const;
 
@@ -166,6 +245,9 @@ class FunctionBase {
   // uniquer. Registers the uniquified name in the uniquer so it is not handed
   // out again.
   std::string UniquifyNodeName(std::string_view name) {
+    if (bulk_cloning_ && NameUniquer::IsValidIdentifier(name)) {
+      return std::string(name);
+    }
     return node_name_uniquer_.GetSanitizedUniqueName(name);
   }
 
@@ -214,11 +296,25 @@ class FunctionBase {
   // added node.
   virtual Node* AddNodeInternal(std::unique_ptr<Node> node);
 
+  // Prepares this function base, which must be empty, to receive clones of
+  // the nodes of `source`. Until EndBulkClone is called nodes created with
+  // MakeNodeWithName are not verified individually, and names which are
+  // valid identifiers are adopted verbatim rather than uniquified; the names
+  // of `source` are already unique and are reserved by copying its name
+  // uniquer.
+  void BeginBulkClone(const FunctionBase& source);
+  void EndBulkClone() { bulk_cloning_ = false; }
+
   // Returns a vector containing the reserved words in the IR.
   static std::vector<std::string> GetIrReservedWords();
 
+  // Returns a new process-unique function base identifier.
+  static int64_t GetNextUid();
+
   std::string name_;
   Package* package_;
+  int64_t uid_;
+  int64_t change_epoch_ = 0;
   std::optional<int64_t> initiation_interval_;
 
   // Store Nodes in std::list as they can be added and removed arbitrarily and
@@ -235,7 +331,26 @@ class FunctionBase {
   NameUniquer node_name_uniquer_ =
       NameUniquer(/*separator=*/"__", GetIrReservedWords());
 
+  // Set between BeginBulkClone and EndBulkClone.
+  bool bulk_cloning_ = false;
+
   std::optional<xls::ForeignFunctionData> foreign_function_;
+
+  // Set while the function base is isolated from its package.
+  std::optional<IsolatedState> isolated_state_;
+
+  // Set while structural hashing is enabled.
+  std::unique_ptr<StructuralHashIndex> structural_hash_index_;
+
+  // The most recently computed reverse topological order and the change epoch
+  // at which it was computed.
+  struct TopoSortCache {
+    int64_t change_epoch;
+    std::vector<Node*> reverse_order;
+  };
+  absl::Mutex topo_sort_cache_mutex_;
+  std::optional<TopoSortCache> topo_sort_cache_
+      ABSL_GUARDED_BY(topo_sort_cache_mutex_);
 };
 
 std::ostream& operator<<(std::ostream& os, const FunctionBase& function);
@@ -125,6 +125,35 @@ fn add(x: bits[32], y: bits[32]) -> bits[32] {
   EXPECT_EQ(func_clone->node_count(), 7);
 }
 
+TEST_F(FunctionTest, CloneKeepsNodeNames) {
+  auto p = CreatePackage();
+  FunctionBuilder b("f", p.get());
+  BValue x = b.Param("x", p->GetBitsType(32));
+  BValue y = b.Param("y", p->GetBitsType(32));
+  BValue sum = b.Add(x, y, SourceInfo(), "sum");
+  BValue sum2 = b.Add(sum, y, SourceInfo(), "sum__2");
+  BValue diff = b.Subtract(sum2, x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, b.BuildWithReturnValue(diff));
+
+  auto new_package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_clone,
+                           func->Clone("f_clone", new_package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * sum_clone, func_clone->GetNode("sum"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * sum2_clone, func_clone->GetNode("sum__2"));
+  EXPECT_EQ(sum2_clone->operand(0), sum_clone);
+  EXPECT_FALSE(func_clone->return_value()->HasAssignedName());
+
+  // Names of the original are reserved in the clone.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_sum, func_clone->MakeNodeWithName<UnOp>(
+                          SourceInfo(), sum_clone, Op::kNeg, "sum"));
+  EXPECT_EQ(new_sum->GetName(), "sum__1");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * newer_sum, func_clone->MakeNodeWithName<UnOp>(
+                            SourceInfo(), sum_clone, Op::kNeg, "sum"));
+  EXPECT_EQ(newer_sum->GetName(), "sum__3");
+}
+
 TEST_F(FunctionTest, IsDefinitelyEqualTo) {
   XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
 package function_is_equal
@@ -373,6 +402,25 @@ TEST_F(FunctionTest, CloneInvokeForRemap) {
   EXPECT_EQ(invoke_b_clone->to_apply(), apply_b);
 }
 
+TEST_F(FunctionTest, CloneInvokeRemapToMismatchedSignature) {
+  auto p = CreatePackage();
+  FunctionBuilder fb_a("apply_a", p.get());
+  fb_a.Literal(UBits(0b11, 2));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * apply_a, fb_a.Build());
+  FunctionBuilder fb_b("apply_b", p.get());
+  fb_b.Param("x", p->GetBitsType(2));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * apply_b, fb_b.Build());
+
+  FunctionBuilder fb_main("main", p.get());
+  fb_main.Invoke(/*args=*/{}, apply_a, SourceInfo(), "invoke_a");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, fb_main.Build());
+
+  absl::flat_hash_map<const Function*, Function*> remap;
+  remap[apply_a] = apply_b;
+  EXPECT_FALSE(main->Clone("main_clone", /*target_package=*/p.get(), remap)
+                   .ok());
+}
+
 TEST_F(FunctionTest, IrReservedWordIdentifiers) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
@@ -369,7 +369,7 @@ IntervalSet PerformVariadicOp(Calculate calc,
     std::vector<Bits> upper_bounds;
     upper_bounds.reserve(indexes.size());
     for (int64_t i = 0; i < indexes.size(); ++i) {
-      Interval interval = operands[i].Intervals()[indexes[i]];
+      const Interval& interval = operands[i].Intervals()[indexes[i]];
       switch (behaviors[i].tonicity) {
         case Tonicity::Monotone: {
           // The essential property of a unary monotone function `f` is that
@@ -597,14 +597,12 @@ IntervalSet MinimizeIntervals(IntervalSet interval_set, int64_t size) {
     }
   }
 
-  // Now 'first, ...merge_list' is `size` elements.
-  IntervalSet result;
-  std::vector<Interval> final_intervals{std::move(first.final_interval)};
-  final_intervals.reserve(size);
-  for (std::unique_ptr<MergeInterval>& mi : merge_list) {
-    final_intervals.push_back(std::move(mi->final_interval));
+  // Now 'first, ...merge_list' is `size` elements. Walk them in order through
+  // the intrusive list so normalization only needs to merge any which abut.
+  IntervalSet result(interval_set.BitCount());
+  for (const MergeInterval* mi = &first; mi != nullptr; mi = mi->next) {
+    result.AddInterval(mi->final_interval);
   }
-  result.SetIntervals(final_intervals);
   result.Normalize();
   return result;
 }
@@ -17,11 +17,12 @@
 #include <algorithm>
 #include <cstdint>
 #include <functional>
-#include <list>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -31,6 +32,36 @@
 #include "xls/ir/interval.h"
 
 namespace xls {
+namespace {
+
+// The largest number of sorted runs which SortRuns merges before falling back
+// to sorting from scratch.
+constexpr int64_t kMaxMergedRuns = 4;
+
+// Sorts `elements` according to `less`. The intervals of a set are usually a
+// few sorted runs (e.g. the intervals of two normalized sets which are being
+// combined, or intervals which were added in increasing order), so the runs are
+// merged rather than sorting from scratch unless there are many of them.
+template <typename T, typename Less>
+void SortRuns(absl::Span<T> elements, Less less) {
+  absl::InlinedVector<int64_t, kMaxMergedRuns + 1> run_ends;
+  for (int64_t i = 1; i < elements.size(); ++i) {
+    if (less(elements[i], elements[i - 1])) {
+      run_ends.push_back(i);
+      if (run_ends.size() >= kMaxMergedRuns) {
+        std::sort(elements.begin(), elements.end(), less);
+        return;
+      }
+    }
+  }
+  run_ends.push_back(elements.size());
+  for (int64_t i = 1; i < run_ends.size(); ++i) {
+    std::inplace_merge(elements.begin(), elements.begin() + run_ends[i - 1],
+                       elements.begin() + run_ends[i], less);
+  }
+}
+
+}  // namespace
 
 IntervalSet IntervalSet::Maximal(int64_t bit_count) {
   IntervalSet result(bit_count);
@@ -74,25 +105,34 @@ void IntervalSet::Normalize() {
   }
 
   // Fastpath single proper interval
-  if (intervals_.size() == 1 && !intervals_.front().IsImproper()) {
+  if (intervals_.empty() ||
+      (intervals_.size() == 1 && !intervals_.front().IsImproper())) {
     // A single proper interval is definitionally normalized.
     is_normalized_ = true;
     return;
   }
 
+  if (BitCount() <= 64) {
+    NormalizeNarrow();
+    is_normalized_ = true;
+    return;
+  }
+
   Bits zero(BitCount());
   Bits max = Bits::AllOnes(BitCount());
-  std::vector<Interval> expand_improper;
-  for (const Interval& interval : intervals_) {
+  absl::InlinedVector<Interval, 4> expand_improper;
+  expand_improper.reserve(intervals_.size());
+  for (Interval& interval : intervals_) {
     if (interval.IsImproper()) {
       expand_improper.push_back(Interval(zero, interval.UpperBound()));
       expand_improper.push_back(Interval(interval.LowerBound(), max));
     } else {
-      expand_improper.push_back(interval);
+      expand_improper.push_back(std::move(interval));
     }
   }
 
-  std::sort(expand_improper.begin(), expand_improper.end());
+  SortRuns(absl::MakeSpan(expand_improper),
+           [](const Interval& a, const Interval& b) { return a < b; });
 
   intervals_.clear();
   for (int32_t i = 0; i < expand_improper.size();) {
@@ -109,6 +149,45 @@ void IntervalSet::Normalize() {
   is_normalized_ = true;
 }
 
+void IntervalSet::NormalizeNarrow() {
+  const int64_t bit_count = BitCount();
+  const uint64_t max =
+      bit_count == 64 ? ~uint64_t{0} : (uint64_t{1} << bit_count) - 1;
+  // Inclusive [lower, upper] bounds of proper intervals.
+  absl::InlinedVector<std::pair<uint64_t, uint64_t>, 4> ranges;
+  ranges.reserve(intervals_.size() + 1);
+  for (const Interval& interval : intervals_) {
+    uint64_t lower = interval.LowerBound().bitmap().GetWord(0);
+    uint64_t upper = interval.UpperBound().bitmap().GetWord(0);
+    if (lower > upper) {
+      ranges.push_back({0, upper});
+      ranges.push_back({lower, max});
+    } else {
+      ranges.push_back({lower, upper});
+    }
+  }
+
+  SortRuns(absl::MakeSpan(ranges), std::less<>());
+
+  intervals_.clear();
+  uint64_t lower = ranges.front().first;
+  uint64_t upper = ranges.front().second;
+  for (int64_t i = 1; i < ranges.size(); ++i) {
+    // Merge overlapping or abutting ranges. Every later range overlaps one
+    // which reaches `max`.
+    if (upper == max || ranges[i].first <= upper + 1) {
+      upper = std::max(upper, ranges[i].second);
+      continue;
+    }
+    intervals_.push_back(
+        Interval(UBits(lower, bit_count), UBits(upper, bit_count)));
+    lower = ranges[i].first;
+    upper = ranges[i].second;
+  }
+  intervals_.push_back(
+      Interval(UBits(lower, bit_count), UBits(upper, bit_count)));
+}
+
 std::optional<Interval> IntervalSet::ConvexHull() const {
   CHECK_GE(bit_count_, 0);
   std::optional<Bits> lower = LowerBound();
@@ -237,55 +316,30 @@ IntervalSet IntervalSet::Intersect(const IntervalSet& lhs,
   CHECK(lhs.is_normalized_);
   CHECK(rhs.is_normalized_);
   IntervalSet result(lhs.BitCount());
-  std::list<Interval> lhs_intervals(lhs.Intervals().begin(),
-                                    lhs.Intervals().end());
-  std::list<Interval> rhs_intervals(rhs.Intervals().begin(),
-                                    rhs.Intervals().end());
-  auto left = lhs_intervals.begin();
-  auto right = rhs_intervals.begin();
-  // lhs/rhs_intervals should be sorted in increasing lexicographic order
-  // (i.e.: compare on lower bound, then upper bound if lower bounds are equal)
-  // at this point, since we CHECK that they are normalized.
-  while ((left != lhs_intervals.end()) && (right != rhs_intervals.end())) {
-    if (bits_ops::ULessThan(left->UpperBound(), right->UpperBound())) {
-      if (std::optional<Interval> intersection =
-              Interval::Intersect(*left, *right)) {
-        result.AddInterval(*intersection);
-        // The difference should only ever contain 0 or 1 interval.
-        std::vector<Interval> difference = Interval::Difference(*right, *left);
-        std::reverse(difference.begin(), difference.end());
-        for (const Interval& remainder : difference) {
-          right = rhs_intervals.insert(right, remainder);
-        }
-      }
-      ++left;
-      continue;
+  // Both sets are sorted and consist of disjoint, non-abutting intervals, so a
+  // single merge-like pass over them yields the (normalized) intersection:
+  // each step intersects the current pair of intervals and moves past the one
+  // which ends first.
+  auto left = lhs.intervals_.begin();
+  auto right = rhs.intervals_.begin();
+  while (left != lhs.intervals_.end() && right != rhs.intervals_.end()) {
+    const Bits& lower =
+        bits_ops::ULessThan(left->LowerBound(), right->LowerBound())
+            ? right->LowerBound()
+            : left->LowerBound();
+    const bool left_ends_first =
+        bits_ops::ULessThan(left->UpperBound(), right->UpperBound());
+    const Bits& upper =
+        left_ends_first ? left->UpperBound() : right->UpperBound();
+    if (bits_ops::ULessThanOrEqual(lower, upper)) {
+      result.intervals_.push_back(Interval(lower, upper));
     }
-    if (bits_ops::ULessThan(right->UpperBound(), left->UpperBound())) {
-      if (std::optional<Interval> intersection =
-              Interval::Intersect(*left, *right)) {
-        result.AddInterval(*intersection);
-        // The difference should only ever contain 0 or 1 interval.
-        std::vector<Interval> difference = Interval::Difference(*left, *right);
-        std::reverse(difference.begin(), difference.end());
-        for (const Interval& remainder : difference) {
-          left = lhs_intervals.insert(left, remainder);
-        }
-      }
-      ++right;
-      continue;
-    }
-    if (bits_ops::UEqual(left->UpperBound(), right->UpperBound())) {
-      if (std::optional<Interval> intersection =
-              Interval::Intersect(*left, *right)) {
-        result.AddInterval(*intersection);
-      }
+    if (left_ends_first) {
       ++left;
+    } else {
       ++right;
-      continue;
     }
   }
-  result.Normalize();
   return result;
 }
 
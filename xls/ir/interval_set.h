@@ -18,10 +18,12 @@
 #include <cstdint>
 #include <functional>
 #include <iosfwd>
+#include <iterator>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/types/span.h"
 #include "xls/ir/bits.h"
@@ -71,7 +73,8 @@ class IntervalSet {
 
   std::vector<Interval> Intervals() && {
     CHECK(is_normalized_);
-    return intervals_;
+    return std::vector<Interval>(std::make_move_iterator(intervals_.begin()),
+                                 std::make_move_iterator(intervals_.end()));
   }
 
   // Returns the `BitCount()` of all intervals in the interval set.
@@ -107,6 +110,9 @@ class IntervalSet {
   // 5. The result of a call to `Intervals()` has the smallest possible size
   //    of any set of intervals representing the same set of points that
   //    contains no improper intervals (hence the name "normalization").
+  //
+  // Intervals which were added in order (e.g. those of normalized sets) are
+  // merged rather than sorted from scratch.
   void Normalize();
 
   // Return the smallest single proper interval that contains all points in this
@@ -230,9 +236,15 @@ class IntervalSet {
   }
 
  private:
+  // Normalize() for sets of width at most 64, which operates on the bounds as
+  // uint64_t values rather than as Bits.
+  void NormalizeNarrow();
+
   bool is_normalized_;
   int64_t bit_count_;
-  std::vector<Interval> intervals_;
+  // Nearly all interval sets built by the analyses hold one or two intervals,
+  // so those are stored inline.
+  absl::InlinedVector<Interval, 2> intervals_;
 };
 
 inline std::ostream& operator<<(std::ostream& os,
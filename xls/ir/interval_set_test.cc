@@ -21,6 +21,7 @@
 #include <utility>
 #include <vector>
 
+#include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "fuzztest/fuzztest.h"
@@ -84,6 +85,32 @@ TEST(IntervalTest, Normalize) {
                 MakeInterval(20, std::numeric_limits<uint32_t>::max(), 32)}));
 }
 
+TEST(IntervalTest, NormalizeSortedRuns) {
+  // Several sorted runs, as produced by combining normalized sets.
+  for (int64_t width : {8, 64, 100}) {
+    IntervalSet runs(width);
+    runs.AddInterval(MakeInterval(10, 20, width));
+    runs.AddInterval(MakeInterval(40, 50, width));
+    runs.AddInterval(MakeInterval(5, 12, width));
+    runs.AddInterval(MakeInterval(51, 60, width));
+    runs.AddInterval(MakeInterval(30, 30, width));
+    runs.AddInterval(MakeInterval(200, 2, width));
+    runs.Normalize();
+    EXPECT_EQ(runs.Intervals(),
+              (std::vector<Interval>{
+                  MakeInterval(0, 2, width), MakeInterval(5, 20, width),
+                  MakeInterval(30, 30, width), MakeInterval(40, 60, width),
+                  Interval(UBits(200, width), Bits::AllOnes(width))}))
+        << "width " << width;
+  }
+
+  IntervalSet maximal(64);
+  maximal.AddInterval(Interval::Maximal(64));
+  maximal.AddInterval(MakeInterval(10, 20, 64));
+  maximal.Normalize();
+  EXPECT_EQ(maximal, IntervalSet::Maximal(64));
+}
+
 TEST(IntervalTest, ConvexHull) {
   IntervalSet example(32);
   example.AddInterval(MakeInterval(10, 20, 32));
@@ -534,5 +561,36 @@ FUZZ_TEST(IntervalFuzzTest, DisjointEquivalentToEmptyIntersection)
     .WithDomains(ArbitraryNormalizedIntervalSet(32),
                  ArbitraryNormalizedIntervalSet(32));
 
+// Returns a normalized set of `count` disjoint intervals of the given width,
+// offset by `offset`.
+IntervalSet MakeStripedSet(int64_t width, int64_t count, int64_t offset) {
+  IntervalSet result(width);
+  for (int64_t i = 0; i < count; ++i) {
+    result.AddInterval(MakeInterval(8 * i + offset, 8 * i + offset + 3, width));
+  }
+  result.Normalize();
+  return result;
+}
+
+void BM_Combine(benchmark::State& state) {
+  IntervalSet lhs = MakeStripedSet(state.range(0), state.range(1), 0);
+  IntervalSet rhs = MakeStripedSet(state.range(0), state.range(1), 2);
+  for (auto _ : state) {
+    IntervalSet combined = IntervalSet::Combine(lhs, rhs);
+    benchmark::DoNotOptimize(combined);
+  }
+}
+BENCHMARK(BM_Combine)->ArgsProduct({{32, 128}, {1, 2, 16}});
+
+void BM_Intersect(benchmark::State& state) {
+  IntervalSet lhs = MakeStripedSet(state.range(0), state.range(1), 0);
+  IntervalSet rhs = MakeStripedSet(state.range(0), state.range(1), 2);
+  for (auto _ : state) {
+    IntervalSet intersection = IntervalSet::Intersect(lhs, rhs);
+    benchmark::DoNotOptimize(intersection);
+  }
+}
+BENCHMARK(BM_Intersect)->ArgsProduct({{32, 128}, {1, 2, 16}});
+
 }  // namespace
 }  // namespace xls
@@ -78,7 +78,7 @@ absl::Status Parser::ParseKeywordArguments(
     XLS_ASSIGN_OR_RETURN(Token name,
                          scanner_.PopKeywordOrIdentToken("argument"));
     XLS_RETURN_IF_ERROR(scanner_.DropTokenOrError(LexicalTokenType::kEquals));
-    if (!seen_keywords.insert(name.value()).second) {
+    if (!seen_keywords.insert(std::string(name.value())).second) {
       return absl::InvalidArgumentError(
           absl::StrFormat("Duplicate keyword argument `%s` @ %s", name.value(),
                           name.pos().ToHumanString()));
@@ -120,7 +120,7 @@ absl::StatusOr<std::vector<Parser::TypedArgument>> Parser::ParseTypedArguments(
                            scanner_.PopTokenOrError(LexicalTokenType::kIdent));
       XLS_RETURN_IF_ERROR(scanner_.DropTokenOrError(LexicalTokenType::kColon));
       XLS_ASSIGN_OR_RETURN(Type * type, ParseType(package));
-      args.push_back(TypedArgument{name.value(), type, name});
+      args.push_back(TypedArgument{std::string(name.value()), type, name});
     } while (scanner_.TryDropToken(LexicalTokenType::kComma));
   }
   return args;
@@ -389,7 +389,7 @@ absl::StatusOr<std::string> Parser::ParseIdentifier(TokenPos* pos) {
   if (pos != nullptr) {
     *pos = token.pos();
   }
-  return token.value();
+  return std::string(token.value());
 }
 
 absl::StatusOr<std::string> Parser::ParseQuotedString(TokenPos* pos) {
@@ -398,7 +398,7 @@ absl::StatusOr<std::string> Parser::ParseQuotedString(TokenPos* pos) {
   if (pos != nullptr) {
     *pos = token.pos();
   }
-  return token.value();
+  return std::string(token.value());
 }
 
 absl::StatusOr<BValue> Parser::ParseAndResolveIdentifier(
@@ -464,12 +464,15 @@ absl::StatusOr<Value> Parser::ParseValueInternal(std::optional<Type*> type) {
   if (type_kind == TypeKind::kArray) {
     XLS_RETURN_IF_ERROR(
         scanner_.DropTokenOrError(LexicalTokenType::kBracketOpen));
+    // Arrays of bits (e.g. large lookup tables) are stored packed, other
+    // arrays hold boxed elements.
+    std::vector<Bits> bits_values;
     std::vector<Value> values;
     while (true) {
       if (scanner_.TryDropToken(LexicalTokenType::kBracketClose)) {
         break;
       }
-      if (!values.empty()) {
+      if (!values.empty() || !bits_values.empty()) {
         XLS_RETURN_IF_ERROR(scanner_.DropTokenOrError(LexicalTokenType::kComma,
                                                       "',' in array literal"));
       }
@@ -479,7 +482,18 @@ absl::StatusOr<Value> Parser::ParseValueInternal(std::optional<Type*> type) {
       }
       XLS_ASSIGN_OR_RETURN(Value element_value,
                            ParseValueInternal(element_type));
-      values.push_back(std::move(element_value));
+      if (element_value.IsBits() && values.empty()) {
+        bits_values.push_back(element_value.bits());
+      } else if (bits_values.empty()) {
+        values.push_back(std::move(element_value));
+      } else {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Array elements must all have the same type @ %s",
+            start_pos.ToHumanString()));
+      }
+    }
+    if (!bits_values.empty()) {
+      return Value::PackedBitsArray(bits_values);
     }
     return Value::Array(values);
   }
@@ -693,7 +707,8 @@ absl::StatusOr<BValue> Parser::ParseNode(
   // should be given when constructing the node as the name is autogenerated
   // (the node has no meaningful given name). Otherwise, output_name is the
   // name of the node.
-  std::string node_name = split_name.has_value() ? "" : output_name.value();
+  std::string node_name =
+      split_name.has_value() ? "" : std::string(output_name.value());
 
   std::vector<BValue> operands;
   switch (op) {
@@ -1403,7 +1418,7 @@ absl::StatusOr<ProcInstantiation*> Parser::ParseProcInstantiation(Proc* proc) {
     XLS_ASSIGN_OR_RETURN(Token channel_name,
                          scanner_.PopTokenOrError(LexicalTokenType::kIdent,
                                                   "channel reference name"));
-    channel_arg_names.push_back(channel_name.value());
+    channel_arg_names.push_back(std::string(channel_name.value()));
   } while (scanner_.TryDropToken(LexicalTokenType::kComma));
 
   // Then parse keyword arguments.
@@ -2013,7 +2028,7 @@ absl::StatusOr<Parser::BlockSignature> Parser::ParseBlockSignature(
     if (!scanner_.TryDropKeyword("clock")) {
       XLS_ASSIGN_OR_RETURN(type, ParseType(package));
     }
-    signature.ports.push_back(Port{port_name.value(), type});
+    signature.ports.push_back(Port{std::string(port_name.value()), type});
     must_end = !scanner_.TryDropToken(LexicalTokenType::kComma);
   }
 
@@ -2028,7 +2043,7 @@ absl::StatusOr<std::string> Parser::ParsePackageName() {
   XLS_ASSIGN_OR_RETURN(
       Token package_name,
       scanner_.PopTokenOrError(LexicalTokenType::kIdent, "package name"));
-  return package_name.value();
+  return std::string(package_name.value());
 }
 
 absl::Status Parser::ParseFileNumber(Package* package,
@@ -2097,7 +2112,8 @@ absl::StatusOr<Function*> Parser::ParseFunction(
       result->SetInitiationInterval(ii);
     } else if (attribute == "ffi_proto") {
       ForeignFunctionData ffi;
-      if (!google::protobuf::TextFormat::ParseFromString(literal.value(), &ffi)) {
+      if (!google::protobuf::TextFormat::ParseFromString(
+              std::string(literal.value()), &ffi)) {
         return absl::InvalidArgumentError("Non-parseable FFI metadata proto.");
       }
       // Dummy parse to make sure it is a valid template.
@@ -2327,8 +2343,8 @@ absl::StatusOr<Channel*> Parser::ParseChannel(Package* package,
         Token metadata_token,
         scanner_.PopTokenOrError(LexicalTokenType::kQuotedString));
     ChannelMetadataProto proto;
-    bool success =
-        google::protobuf::TextFormat::ParseFromString(metadata_token.value(), &proto);
+    bool success = google::protobuf::TextFormat::ParseFromString(
+        std::string(metadata_token.value()), &proto);
     if (!success) {
       return absl::InvalidArgumentError(
           absl::StrFormat("Invalid channel metadata @ %s",
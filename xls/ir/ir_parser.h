@@ -135,7 +135,7 @@ class Parser {
  private:
   friend class ArgParser;
 
-  explicit Parser(Scanner scanner) : scanner_(scanner) {}
+  explicit Parser(Scanner scanner) : scanner_(std::move(scanner)) {}
 
   // Parse a function starting at the current scanner position.
   absl::StatusOr<Function*> ParseFunction(
@@ -2376,6 +2376,24 @@ TEST(IrParserTest, ParsesComplexValueWithEmbeddedTypes) {
   EXPECT_EQ(expected, v);
 }
 
+TEST(IrParserTest, ParsesBitsArraysPacked) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Value v, Parser::ParseTypedValue("[bits[12]:0xba5, bits[12]:0xba7]"));
+  EXPECT_TRUE(v.IsPackedBitsArray());
+  EXPECT_EQ(v, Value::UBitsArray({0xba5, 0xba7}, 12).value());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      v, Parser::ParseTypedValue("[[bits[2]:1, bits[2]:2], [bits[2]:3, "
+                                 "bits[2]:0]]"));
+  EXPECT_FALSE(v.IsPackedBitsArray());
+  EXPECT_TRUE(v.element(0).IsPackedBitsArray());
+  EXPECT_EQ(v, Value::UBits2DArray({{1, 2}, {3, 0}}, 2).value());
+
+  EXPECT_THAT(Parser::ParseTypedValue("[bits[1]:0, (bits[1]:0)]").status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("must all have the same type")));
+}
+
 TEST(IrParserTest, ParsesTokenType) {
   const std::string input = "token";
   XLS_ASSERT_OK_AND_ASSIGN(Value v, Parser::ParseTypedValue(input));
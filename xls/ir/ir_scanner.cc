@@ -16,7 +16,6 @@
 
 #include <cctype>
 #include <cstdint>
-#include <functional>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -125,299 +124,257 @@ std::string Token::ToString() const {
                          pos_.ToHumanString());
 }
 
-namespace {
-
-// Helper class for tokenizing a string.
-// TODO(meheff): This could be combined into Scanner class and made lazy at the
-// same time.
-class Tokenizer {
- public:
-  // Tokenizes the given string and returns the vector of Tokens.
-  static absl::StatusOr<std::vector<Token>> TokenizeString(
-      std::string_view str) {
-    Tokenizer tokenizer(str);
-    return tokenizer.Tokenize();
+bool Tokenizer::DropWhiteSpace() {
+  int64_t old_index = index_;
+  while (!EndOfString() && absl::ascii_isspace(current())) {
+    Advance();
   }
+  return old_index != index_;
+}
 
- private:
-  // Drops all whitespace starting at current index. Returns true if any
-  // whitespace was dropped.
-  bool DropWhiteSpace() {
-    int64_t old_index = index();
-    while (!EndOfString() && absl::ascii_isspace(current())) {
-      Advance();
+bool Tokenizer::DropEndOfLineComment() {
+  if (MatchSubstring("//")) {
+    Advance(2);
+    while (!EndOfString() && current() != '\n') {
+      Advance(1);
     }
-    return old_index != index();
+    return true;
   }
+  return false;
+}
 
-  // Tries to drop an end of line comment starting with "//" at the current
-  // index up to the newline. Returns true an end of line comment was found.
-  bool DropEndOfLineComment() {
-    if (MatchSubstring("//")) {
-      Advance(2);
-      while (!EndOfString() && current() != '\n') {
-        Advance(1);
-      }
-      return true;
-    }
-    return false;
-  }
+bool Tokenizer::MatchSubstring(std::string_view substr) const {
+  return index_ + substr.size() <= str_.size() &&
+         substr == std::string_view(str_.data() + index_, substr.size());
+}
 
-  // Returns true if the given string matches the substring starting at the
-  // current index in the tokenized string.
-  bool MatchSubstring(std::string_view substr) {
-    return index_ + substr.size() <= str_.size() &&
-           substr == std::string_view(str_.data() + index_, substr.size());
+absl::StatusOr<std::optional<std::string_view>> Tokenizer::MatchQuotedString(
+    std::string_view quote, bool allow_multiline) {
+  if (!MatchSubstring(quote)) {
+    return std::nullopt;
   }
-
-  // Tries to match a quoted string with the given quote character sequence
-  // (e.g., """). Returns the contents of the quoted string or nullopt if no
-  // quoted string was matched. allow_multine indicates whether a newline
-  // character is allowed in the quoted string.
-  absl::StatusOr<std::optional<std::string_view>> MatchQuotedString(
-      std::string_view quote, bool allow_multiline) {
-    if (!MatchSubstring(quote)) {
-      return std::nullopt;
+  int64_t start_colno = colno_;
+  int64_t start_lineno = lineno_;
+  Advance(quote.size());
+  int64_t content_start = index_;
+  while (!EndOfString()) {
+    if (MatchSubstring(quote)) {
+      std::string_view content =
+          std::string_view(str_.data() + content_start, index_ - content_start);
+      Advance(quote.size());
+      return content;
     }
-    int64_t start_colno = colno();
-    int64_t start_lineno = lineno();
-    Advance(quote.size());
-    int64_t content_start = index();
-    while (!EndOfString()) {
-      if (MatchSubstring(quote)) {
-        std::string_view content = std::string_view(str_.data() + content_start,
-                                                    index() - content_start);
-        Advance(quote.size());
-        return content;
-      }
-      if (!allow_multiline && current() == '\n') {
-        break;
-      }
-      Advance();
+    if (!allow_multiline && current() == '\n') {
+      break;
     }
-    return absl::InvalidArgumentError(
-        absl::StrFormat("Unterminated quoted string starting at %s",
-                        TokenPos{start_lineno, start_colno}.ToHumanString()));
+    Advance();
   }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Unterminated quoted string starting at %s",
+                      TokenPos{start_lineno, start_colno}.ToHumanString()));
+}
 
-  // Advances the current index into the tokenized string by the given
-  // amount. Updates column and line numbers.
-  int64_t Advance(int64_t amount = 1) {
-    CHECK_LE(index_ + amount, str_.size());
-    for (int64_t i = 0; i < amount; ++i) {
-      if (current() == '\t') {
-        colno_ += 2;
-      } else if (current() == '\n') {
-        colno_ = 0;
-        ++lineno_;
-      } else {
-        ++colno_;
-      }
-      ++index_;
+void Tokenizer::Advance(int64_t amount) {
+  CHECK_LE(index_ + amount, str_.size());
+  for (int64_t i = 0; i < amount; ++i) {
+    if (current() == '\t') {
+      colno_ += 2;
+    } else if (current() == '\n') {
+      colno_ = 0;
+      ++lineno_;
+    } else {
+      ++colno_;
     }
-    return index_;
+    ++index_;
   }
+}
 
-  // Returns whether the current index is at the end of the string.
-  bool EndOfString() const { return index_ >= str_.size(); }
-
-  // Returns the sequence of all characters which satisfy the given test
-  // starting at the current index. Current index is updated to one past the
-  // last matching character. min_chars is the minimum number of characters
-  // which are unconditionally captured.
-  std::string_view CaptureWhile(std::function<bool(char)> test_f,
-                                int64_t min_chars = 0) {
-    int64_t start = index();
-    while (!EndOfString() &&
-           ((index() < min_chars + start) || test_f(current()))) {
-      Advance();
-    }
-    return std::string_view(str_.data() + start, index_ - start);
+// Returns the sequence of all characters which satisfy the given test starting
+// at the current index. Current index is updated to one past the last matching
+// character. min_chars is the minimum number of characters which are
+// unconditionally captured.
+template <typename TestFn>
+std::string_view Tokenizer::CaptureWhile(TestFn test_f, int64_t min_chars) {
+  int64_t start = index_;
+  while (!EndOfString() &&
+         ((index_ < min_chars + start) || test_f(current()))) {
+    Advance();
   }
+  return std::string_view(str_.data() + start, index_ - start);
+}
 
-  // Tokenizes the internal string.
-  absl::StatusOr<std::vector<Token>> Tokenize() {
-    std::vector<Token> tokens;
-    while (!EndOfString()) {
-      if (DropWhiteSpace() || DropEndOfLineComment()) {
-        continue;
-      }
-
-      const int64_t start_lineno = lineno();
-      const int64_t start_colno = colno();
-
-      // Literal numbers can decimal, binary (eg, 0b0101) or hexadecimal (eg,
-      // 0xbeef) so capture all alphanumeric characters after the initial
-      // digit. Literal numbers can also contain '_'s after the first
-      // character which are used to improve readability (example:
-      // '0xabcd_ef00').
-      if (isdigit(current()) ||
-          (current() == '-' && next().has_value() && isdigit(*next()))) {
-        std::string_view value = CaptureWhile(
-            [](char c) { return absl::ascii_isalnum(c) || c == '_'; },
-            /*min_chars=*/1);
-        tokens.push_back(Token(LexicalTokenType::kLiteral, value, start_lineno,
-                               start_colno));
-        continue;
-      }
-
-      if (isalpha(current()) != 0 || current() == '_') {
-        std::string_view value = CaptureWhile([](char c) {
-          return isalpha(c) != 0 || c == '_' || c == '.' || isdigit(c) != 0;
-        });
-        tokens.push_back(
-            Token::MakeIdentOrKeyword(value, start_lineno, start_colno));
-        continue;
-      }
-
-      // Look for multi-character tokens.
-      if (MatchSubstring("->")) {
-        tokens.push_back(Token(LexicalTokenType::kRightArrow, "->",
-                               start_lineno, start_colno));
-        Advance(2);
-        continue;
-      }
-
-      // Match quoted strings. Double-quoted strings (e.g., "foo") and
-      // triple-double-quoted strings (e.g., """foo""") are allowed. Only
-      // triple-double-quoted strings can contain new lines.
-      std::optional<std::string_view> content;
-      XLS_ASSIGN_OR_RETURN(
-          content, MatchQuotedString("\"\"\"", /*allow_multiline=*/true));
-      if (content.has_value()) {
-        tokens.push_back(Token(LexicalTokenType::kQuotedString, content.value(),
-                               start_lineno, start_colno));
-        continue;
-      }
-      XLS_ASSIGN_OR_RETURN(content,
-                           MatchQuotedString("\"", /*allow_multiline=*/false));
-      if (content.has_value()) {
-        tokens.push_back(Token(LexicalTokenType::kQuotedString, content.value(),
-                               start_lineno, start_colno));
-        continue;
-      }
-
-      // Handle single-character tokens.
-      LexicalTokenType token_type;
-
-      switch (current()) {
-        case '-':
-          token_type = LexicalTokenType::kMinus;
-          break;
-        case '+':
-          token_type = LexicalTokenType::kAdd;
-          break;
-        case '.':
-          token_type = LexicalTokenType::kDot;
-          break;
-        case ':':
-          token_type = LexicalTokenType::kColon;
-          break;
-        case ',':
-          token_type = LexicalTokenType::kComma;
-          break;
-        case '=':
-          token_type = LexicalTokenType::kEquals;
-          break;
-        case '[':
-          token_type = LexicalTokenType::kBracketOpen;
-          break;
-        case ']':
-          token_type = LexicalTokenType::kBracketClose;
-          break;
-        case '{':
-          token_type = LexicalTokenType::kCurlOpen;
-          break;
-        case '}':
-          token_type = LexicalTokenType::kCurlClose;
-          break;
-        case '(':
-          token_type = LexicalTokenType::kParenOpen;
-          break;
-        case ')':
-          token_type = LexicalTokenType::kParenClose;
-          break;
-        case '>':
-          token_type = LexicalTokenType::kGt;
-          break;
-        case '<':
-          token_type = LexicalTokenType::kLt;
-          break;
-        case '#':
-          token_type = LexicalTokenType::kHash;
-          break;
-        default:
-          std::string char_str = absl::ascii_iscntrl(current())
-                                     ? absl::StrFormat("\\x%02x", current())
-                                     : std::string(1, current());
-          LOG(ERROR) << "IR text with error: " << str_;
-          return absl::InvalidArgumentError(absl::StrFormat(
-              "Invalid character in IR text \"%s\" @ %s", char_str,
-              TokenPos{lineno(), colno()}.ToHumanString()));
-      }
-      tokens.push_back(Token(token_type, lineno(), colno()));
-      Advance();
+absl::StatusOr<std::optional<Token>> Tokenizer::Next() {
+  while (!EndOfString()) {
+    if (DropWhiteSpace() || DropEndOfLineComment()) {
+      continue;
     }
-    return tokens;
-  }
-
-  // Returns the character at the current index.
-  char current() const { return str_.at(index_); }
 
-  // Returns the character at the current index + 1, or nullopt if current index
-  // + 1 is beyond the end of the string.
-  std::optional<char> next() const {
-    if (index_ + 1 < str_.size()) {
-      return str_[index_ + 1];
+    const int64_t start_lineno = lineno_;
+    const int64_t start_colno = colno_;
+
+    // Literal numbers can decimal, binary (eg, 0b0101) or hexadecimal (eg,
+    // 0xbeef) so capture all alphanumeric characters after the initial
+    // digit. Literal numbers can also contain '_'s after the first
+    // character which are used to improve readability (example:
+    // '0xabcd_ef00').
+    if (isdigit(current()) ||
+        (current() == '-' && next().has_value() && isdigit(*next()))) {
+      std::string_view value = CaptureWhile(
+          [](char c) { return absl::ascii_isalnum(c) || c == '_'; },
+          /*min_chars=*/1);
+      return Token(LexicalTokenType::kLiteral, value, start_lineno,
+                   start_colno);
     }
-    return std::nullopt;
-  }
-
-  // Returns the current index in the string.
-  int64_t index() const { return index_; }
 
-  // Returns the current line/column number.
-  int64_t lineno() const { return lineno_; }
-  int64_t colno() const { return colno_; }
-
- private:
-  explicit Tokenizer(std::string_view str) : str_(str) {}
+    if (isalpha(current()) != 0 || current() == '_') {
+      std::string_view value = CaptureWhile([](char c) {
+        return isalpha(c) != 0 || c == '_' || c == '.' || isdigit(c) != 0;
+      });
+      return Token::MakeIdentOrKeyword(value, start_lineno, start_colno);
+    }
 
-  // The string being tokenized.
-  std::string_view str_;
+    // Look for multi-character tokens.
+    if (MatchSubstring("->")) {
+      Advance(2);
+      return Token(LexicalTokenType::kRightArrow, "->", start_lineno,
+                   start_colno);
+    }
 
-  // Current index.
-  int64_t index_ = 0;
+    // Match quoted strings. Double-quoted strings (e.g., "foo") and
+    // triple-double-quoted strings (e.g., """foo""") are allowed. Only
+    // triple-double-quoted strings can contain new lines.
+    std::optional<std::string_view> content;
+    XLS_ASSIGN_OR_RETURN(
+        content, MatchQuotedString("\"\"\"", /*allow_multiline=*/true));
+    if (content.has_value()) {
+      return Token(LexicalTokenType::kQuotedString, content.value(),
+                   start_lineno, start_colno);
+    }
+    XLS_ASSIGN_OR_RETURN(content,
+                         MatchQuotedString("\"", /*allow_multiline=*/false));
+    if (content.has_value()) {
+      return Token(LexicalTokenType::kQuotedString, content.value(),
+                   start_lineno, start_colno);
+    }
 
-  // Line/column number based on the current index.
-  int64_t lineno_ = 0;
-  int64_t colno_ = 0;
-};
+    // Handle single-character tokens.
+    LexicalTokenType token_type;
 
-}  // namespace
+    switch (current()) {
+      case '-':
+        token_type = LexicalTokenType::kMinus;
+        break;
+      case '+':
+        token_type = LexicalTokenType::kAdd;
+        break;
+      case '.':
+        token_type = LexicalTokenType::kDot;
+        break;
+      case ':':
+        token_type = LexicalTokenType::kColon;
+        break;
+      case ',':
+        token_type = LexicalTokenType::kComma;
+        break;
+      case '=':
+        token_type = LexicalTokenType::kEquals;
+        break;
+      case '[':
+        token_type = LexicalTokenType::kBracketOpen;
+        break;
+      case ']':
+        token_type = LexicalTokenType::kBracketClose;
+        break;
+      case '{':
+        token_type = LexicalTokenType::kCurlOpen;
+        break;
+      case '}':
+        token_type = LexicalTokenType::kCurlClose;
+        break;
+      case '(':
+        token_type = LexicalTokenType::kParenOpen;
+        break;
+      case ')':
+        token_type = LexicalTokenType::kParenClose;
+        break;
+      case '>':
+        token_type = LexicalTokenType::kGt;
+        break;
+      case '<':
+        token_type = LexicalTokenType::kLt;
+        break;
+      case '#':
+        token_type = LexicalTokenType::kHash;
+        break;
+      default:
+        std::string char_str = absl::ascii_iscntrl(current())
+                                   ? absl::StrFormat("\\x%02x", current())
+                                   : std::string(1, current());
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Invalid character in IR text \"%s\" @ %s", char_str,
+            TokenPos{lineno_, colno_}.ToHumanString()));
+    }
+    Token token(token_type, lineno_, colno_);
+    Advance();
+    return token;
+  }
+  return std::nullopt;
+}
 
 absl::StatusOr<std::vector<Token>> TokenizeString(std::string_view str) {
-  return Tokenizer::TokenizeString(str);
+  Tokenizer tokenizer(str);
+  std::vector<Token> tokens;
+  while (true) {
+    XLS_ASSIGN_OR_RETURN(std::optional<Token> token, tokenizer.Next());
+    if (!token.has_value()) {
+      return tokens;
+    }
+    tokens.push_back(*std::move(token));
+  }
 }
 
 absl::StatusOr<Scanner> Scanner::Create(std::string_view text) {
-  XLS_ASSIGN_OR_RETURN(auto tokens, TokenizeString(text));
-  return Scanner(std::move(tokens));
+  return Scanner(text);
+}
+
+bool Scanner::Fill(int64_t n) const {
+  while (lookahead_.size() < n) {
+    if (at_end_ || !status_.ok()) {
+      return false;
+    }
+    absl::StatusOr<std::optional<Token>> token = tokenizer_.Next();
+    if (!token.ok()) {
+      status_ = token.status();
+      return false;
+    }
+    if (!token->has_value()) {
+      at_end_ = true;
+      return false;
+    }
+    lookahead_.push_back(**std::move(token));
+  }
+  return true;
+}
+
+absl::Status Scanner::EofError(std::string_view message) const {
+  if (!status_.ok()) {
+    return status_;
+  }
+  return absl::InvalidArgumentError(message);
 }
 
 absl::StatusOr<Token> Scanner::PeekToken() const {
-  if (AtEof()) {
-    return absl::InvalidArgumentError("Expected token, but found EOF.");
+  if (!Fill(1)) {
+    return EofError("Expected token, but found EOF.");
   }
-  return tokens_[token_idx_];
+  return lookahead_.front();
 }
 
 absl::StatusOr<Token> Scanner::PopTokenOrError(std::string_view context) {
-  if (AtEof()) {
+  if (!Fill(1)) {
     std::string context_str =
         context.empty() ? std::string("") : absl::StrCat(" in ", context);
-    return absl::InvalidArgumentError("Expected token" + context_str +
-                                      ", but found EOF.");
+    return EofError("Expected token" + context_str + ", but found EOF.");
   }
   return PopToken();
 }
@@ -432,12 +389,12 @@ bool Scanner::TryDropToken(LexicalTokenType target) {
 
 absl::Status Scanner::DropTokenOrError(LexicalTokenType target,
                                        std::string_view context) {
-  if (AtEof()) {
+  if (!Fill(1)) {
     std::string context_str =
         context.empty() ? std::string("") : absl::StrCat(" in ", context);
-    return absl::InvalidArgumentError(
-        absl::StrFormat("Expected token of type %s%s; found EOF.",
-                        LexicalTokenTypeToString(target), context_str));
+    return EofError(absl::StrFormat("Expected token of type %s%s; found EOF.",
+                                    LexicalTokenTypeToString(target),
+                                    context_str));
   }
   XLS_ASSIGN_OR_RETURN(Token dropped, PopTokenOrError(target, context));
   (void)dropped;
@@ -16,6 +16,8 @@
 #define XLS_IR_IR_SCANNER_H_
 
 #include <cstdint>
+#include <deque>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <string_view>
@@ -97,7 +99,9 @@ class Token {
       : type_(type), value_(value), pos_({lineno, colno}) {}
 
   LexicalTokenType type() const { return type_; }
-  const std::string& value() const { return value_; }
+  // Note: the value refers into the text the token was scanned from, which
+  // must outlive the token.
+  std::string_view value() const { return value_; }
   const TokenPos& pos() const { return pos_; }
 
   // Returns the token as a (u)int64_t value. Token must be a literal. The
@@ -121,7 +125,7 @@ class Token {
 
  private:
   LexicalTokenType type_;
-  std::string value_;
+  std::string_view value_;
   TokenPos pos_;
 };
 
@@ -130,12 +134,58 @@ inline std::ostream& operator<<(std::ostream& os, const Token& token) {
   return os;
 }
 
-// Tokenizes the given string and returns the tokens. It maintains precise
-// source location information.  Right now this is a eager implementation - it
-// tokenizes the whole input. This can be easily changed later to a more demand
-// driven tokenization.
+// Produces the tokens of a string one at a time, maintaining precise source
+// location information. The values of the tokens refer into the string.
+class Tokenizer {
+ public:
+  explicit Tokenizer(std::string_view str) : str_(str) {}
+
+  // Returns the next token, or std::nullopt at the end of the string.
+  absl::StatusOr<std::optional<Token>> Next();
+
+ private:
+  bool DropWhiteSpace();
+  bool DropEndOfLineComment();
+  bool MatchSubstring(std::string_view substr) const;
+  absl::StatusOr<std::optional<std::string_view>> MatchQuotedString(
+      std::string_view quote, bool allow_multiline);
+  void Advance(int64_t amount = 1);
+  template <typename TestFn>
+  std::string_view CaptureWhile(TestFn test_f, int64_t min_chars = 0);
+
+  bool EndOfString() const { return index_ >= str_.size(); }
+  char current() const { return str_[index_]; }
+  std::optional<char> next() const {
+    if (index_ + 1 < str_.size()) {
+      return str_[index_ + 1];
+    }
+    return std::nullopt;
+  }
+
+  // The string being tokenized.
+  std::string_view str_;
+
+  // Current index.
+  int64_t index_ = 0;
+
+  // Line/column number based on the current index.
+  int64_t lineno_ = 0;
+  int64_t colno_ = 0;
+};
+
+// Tokenizes the given string and returns all the tokens; see Tokenizer.
 absl::StatusOr<std::vector<Token>> TokenizeString(std::string_view str);
 
+// Token stream over an IR text for the parser. Tokens are scanned on demand
+// (only as far as the parser looks ahead) rather than the whole text being
+// tokenized up front, and token values are views into the text, so scanning
+// does not allocate per token. The text must outlive the scanner and all the
+// tokens it produces.
+//
+// Because scanning is lazy, an invalid character is only reported once the
+// parser reaches it: the scanner then behaves as if positioned before a token
+// that can never be consumed, i.e. it is not at EOF, PeekTokenIs() is false
+// for every type and the fallible accessors return the scanning error.
 class Scanner {
  public:
   static absl::StatusOr<Scanner> Create(std::string_view text);
@@ -146,26 +196,27 @@ class Scanner {
 
   // Return the current token.
   const Token& PeekTokenOrDie() const {
-    CHECK(!AtEof());
-    return tokens_[token_idx_];
+    CHECK(Fill(1)) << status_;
+    return lookahead_.front();
   }
 
   // Returns true if the next token is the given type.
   bool PeekTokenIs(LexicalTokenType target) const {
-    return !AtEof() && PeekTokenOrDie().type() == target;
+    return PeekNthTokenIs(0, target);
   }
 
   // Returns true if the nth next token is the given type. If `n` is zero this
   // peeks at the immediate next token.
   bool PeekNthTokenIs(int64_t n, LexicalTokenType target) const {
-    return (token_idx_ + n < tokens_.size()) &&
-           tokens_[token_idx_ + n].type() == target;
+    return Fill(n + 1) && lookahead_[n].type() == target;
   }
 
   // Pop the current token, advance token pointer to next token.
   Token PopToken() {
-    VLOG(6) << "Popping token: " << tokens_[token_idx_];
-    return tokens_.at(token_idx_++);
+    Token token = PeekTokenOrDie();
+    VLOG(6) << "Popping token: " << token;
+    lookahead_.pop_front();
+    return token;
   }
 
   // Same as PopToken() but returns a status error if we are at EOF (in which
@@ -217,13 +268,25 @@ class Scanner {
   absl::Status DropKeywordOrError(std::string_view keyword);
 
   // Check if more tokens are available.
-  bool AtEof() const { return token_idx_ >= tokens_.size(); }
+  bool AtEof() const { return !Fill(1) && status_.ok(); }
 
  private:
-  explicit Scanner(std::vector<Token> tokens) : tokens_(tokens) {}
-
-  int64_t token_idx_ = 0;
-  std::vector<Token> tokens_;
+  explicit Scanner(std::string_view text) : tokenizer_(text) {}
+
+  // Scans ahead until at least `n` tokens are buffered. Returns false if that
+  // is not possible because the end of the text or a scanning error was
+  // reached first.
+  bool Fill(int64_t n) const;
+
+  // Returns the error for reaching EOF (or the scanning error, if any).
+  absl::Status EofError(std::string_view message) const;
+
+  // Scanning state: the lookahead only holds the tokens peeked at but not yet
+  // popped. Mutable as peeking may need to scan further.
+  mutable Tokenizer tokenizer_;
+  mutable std::deque<Token> lookahead_;
+  mutable bool at_end_ = false;
+  mutable absl::Status status_;
 };
 
 }  // namespace xls
@@ -34,7 +34,7 @@ using testing::HasSubstr;
 std::vector<std::string> TokensToStrings(absl::Span<const Token> tokens) {
   std::vector<std::string> strs;
   for (const Token& token : tokens) {
-    strs.push_back(token.value());
+    strs.push_back(std::string(token.value()));
   }
   return strs;
 }
@@ -178,5 +178,33 @@ TEST(IrScannerTest, UnterminatedTripleQuotedStrings) {
                HasSubstr("Unterminated quoted string starting at 1:1")));
 }
 
+TEST(IrScannerTest, ScannerLooksAhead) {
+  XLS_ASSERT_OK_AND_ASSIGN(Scanner scanner, Scanner::Create("fn f(x"));
+  EXPECT_TRUE(scanner.PeekNthTokenIs(3, LexicalTokenType::kIdent));
+  EXPECT_FALSE(scanner.PeekNthTokenIs(4, LexicalTokenType::kIdent));
+  EXPECT_TRUE(scanner.PeekTokenIs(LexicalTokenType::kKeyword));
+  XLS_ASSERT_OK(scanner.DropKeywordOrError("fn"));
+  XLS_ASSERT_OK_AND_ASSIGN(Token name,
+                           scanner.PopTokenOrError(LexicalTokenType::kIdent));
+  EXPECT_EQ(name.value(), "f");
+  XLS_ASSERT_OK(scanner.DropTokenOrError(LexicalTokenType::kParenOpen));
+  EXPECT_TRUE(scanner.TryDropToken(LexicalTokenType::kIdent));
+  EXPECT_TRUE(scanner.AtEof());
+  EXPECT_THAT(scanner.PopTokenOrError(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("found EOF")));
+}
+
+// Scanning errors are reported when the scanner reaches them.
+TEST(IrScannerTest, ScannerReportsInvalidCharacterWhenReached) {
+  XLS_ASSERT_OK_AND_ASSIGN(Scanner scanner, Scanner::Create("fn $"));
+  XLS_ASSERT_OK(scanner.DropKeywordOrError("fn"));
+  EXPECT_FALSE(scanner.AtEof());
+  EXPECT_FALSE(scanner.PeekTokenIs(LexicalTokenType::kIdent));
+  EXPECT_THAT(scanner.PopTokenOrError(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Invalid character in IR text \"$\" @ 1:4")));
+}
+
 }  // namespace
 }  // namespace xls
@@ -103,6 +103,12 @@ std::string NameUniquer::GetSanitizedUniqueName(std::string_view prefix) {
   return root;
 }
 
+void NameUniquer::CopyFrom(const NameUniquer& other) {
+  separator_ = other.separator_;
+  reserved_names_ = other.reserved_names_;
+  generated_names_ = other.generated_names_;
+}
+
 /* static */ bool NameUniquer::IsValidIdentifier(std::string_view str) {
   if (str.empty()) {
     return false;
@@ -40,6 +40,10 @@ class NameUniquer {
   NameUniquer(const NameUniquer&) = delete;
   NameUniquer operator=(const NameUniquer&) = delete;
 
+  // Replaces the state of this uniquer with that of `other`. Names handed out
+  // by `other` are then not handed out again by this uniquer.
+  void CopyFrom(const NameUniquer& other);
+
   // Return a sanitized unique name which starts with the given (sanitized)
   // prefix. Names are uniqued by adding a numeric suffix if necessary separated
   // from the given prefix by "separator_". For example,
@@ -24,6 +24,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -39,6 +40,7 @@
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/format_strings.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/instantiation.h"
 #include "xls/ir/lsb_or_msb.h"
 #include "xls/ir/nodes.h"
@@ -47,6 +49,7 @@
 #include "xls/ir/proc.h"
 #include "xls/ir/register.h"
 #include "xls/ir/source_location.h"
+#include "xls/ir/structural_hash_index.h"
 #include "xls/ir/type.h"
 #include "xls/ir/verify_node.h"
 
@@ -55,7 +58,7 @@ namespace xls {
 Node::Node(Op op, Type* type, const SourceInfo& loc, std::string_view name,
            FunctionBase* function_base)
     : function_base_(function_base),
-      id_(function_base_->package()->GetNextNodeId()),
+      id_(function_base_->GetNextNodeId()),
       op_(op),
       type_(type),
       loc_(loc),
@@ -91,10 +94,37 @@ absl::Status Node::AddNodeToFunctionAndReplace(
   return ReplaceUsesWith(replacement_ptr);
 }
 
-void Node::AddUser(Node* user) { users_.insert(user); }
+void Node::MarkChanged() { change_epoch_ = function_base_->NextChangeEpoch(); }
+
+void Node::MarkOperandsChanged() {
+  MarkChanged();
+  operands_change_epoch_ = change_epoch_;
+  if (StructuralHashIndex* index = function_base_->structural_hash_index();
+      index != nullptr) {
+    index->MarkOperandsChanged(this);
+  }
+}
+
+void Node::AddUser(Node* user) {
+  MarkChanged();
+  user->MarkOperandsChanged();
+  // Nodes are generally created in id order so the common case is appending.
+  if (users_.empty() || NodeIdLessThan()(users_.back(), user)) {
+    users_.push_back(user);
+    return;
+  }
+  auto it = absl::c_lower_bound(users_, user, NodeIdLessThan());
+  if (*it != user) {
+    users_.insert(it, user);
+  }
+}
 
 void Node::RemoveUser(Node* user) {
-  CHECK_EQ(users_.erase(user), 1) << GetName();
+  MarkChanged();
+  user->MarkOperandsChanged();
+  auto it = absl::c_lower_bound(users_, user, NodeIdLessThan());
+  CHECK(it != users_.end() && *it == user) << GetName();
+  users_.erase(it);
 }
 
 absl::Status Node::VisitSingleNode(DfsVisitor* visitor) {
@@ -352,35 +382,70 @@ absl::Status Node::VisitSingleNode(DfsVisitor* visitor) {
   return absl::OkStatus();
 }
 
+namespace {
+
+// Returns an error describing the cycle through `start`, which must be on the
+// current traversal path of `visitor`.
+absl::Status CycleError(Node* start, DfsVisitor* visitor) {
+  std::vector<std::string> cycle_names = {start->GetName()};
+  Node* node = start;
+  do {
+    bool broke = false;
+    for (Node* operand : node->operands()) {
+      if (visitor->IsTraversing(operand)) {
+        node = operand;
+        broke = true;
+        break;
+      }
+    }
+    CHECK(broke);
+    cycle_names.push_back(node->GetName());
+  } while (node != start);
+  return absl::InternalError(absl::StrFormat(
+      "Cycle detected: [%s]", absl::StrJoin(cycle_names, " -> ")));
+}
+
+}  // namespace
+
 absl::Status Node::Accept(DfsVisitor* visitor) {
   if (visitor->IsVisited(this)) {
     return absl::OkStatus();
   }
   if (visitor->IsTraversing(this)) {
-    std::vector<std::string> cycle_names = {GetName()};
-    Node* node = this;
-    do {
-      bool broke = false;
-      for (Node* operand : node->operands()) {
-        if (visitor->IsTraversing(operand)) {
-          node = operand;
-          broke = true;
-          break;
-        }
-      }
-      CHECK(broke);
-      cycle_names.push_back(node->GetName());
-    } while (node != this);
-    return absl::InternalError(absl::StrFormat(
-        "Cycle detected: [%s]", absl::StrJoin(cycle_names, " -> ")));
+    return CycleError(this, visitor);
   }
+  // Post-order traversal with an explicit stack so that deep graphs don't
+  // overflow the call stack.
+  std::vector<std::pair<Node*, int64_t>>& stack = visitor->dfs_stack_;
+  const int64_t base = stack.size();
   visitor->SetTraversing(this);
-  for (Node* operand : operands()) {
-    XLS_RETURN_IF_ERROR(operand->Accept(visitor));
+  stack.push_back({this, 0});
+  while (stack.size() > base) {
+    auto& [node, next_operand] = stack.back();
+    if (next_operand < node->operand_count()) {
+      Node* operand = node->operand(next_operand++);
+      if (visitor->IsVisited(operand)) {
+        continue;
+      }
+      if (visitor->IsTraversing(operand)) {
+        stack.resize(base);
+        return CycleError(operand, visitor);
+      }
+      visitor->SetTraversing(operand);
+      stack.push_back({operand, 0});
+      continue;
+    }
+    Node* finished = node;
+    stack.pop_back();
+    visitor->UnsetTraversing(finished);
+    visitor->MarkVisited(finished);
+    absl::Status status = finished->VisitSingleNode(visitor);
+    if (!status.ok()) {
+      stack.resize(base);
+      return status;
+    }
   }
-  visitor->UnsetTraversing(this);
-  visitor->MarkVisited(this);
-  return VisitSingleNode(visitor);
+  return absl::OkStatus();
 }
 
 bool Node::IsDefinitelyEqualTo(const Node* other) const {
@@ -672,7 +737,8 @@ std::string Node::GetUsersString() const {
 }
 
 bool Node::HasUser(const Node* target) const {
-  return users_.contains(const_cast<Node*>(target));
+  return absl::c_binary_search(users_, const_cast<Node*>(target),
+                               NodeIdLessThan());
 }
 
 bool Node::IsDead() const {
@@ -700,15 +766,16 @@ int64_t Node::OperandInstanceCount(const Node* target) const {
 }
 
 void Node::SetId(int64_t id) {
-  // The data structure (btree) containing the users of each node is sorted by
-  // node id. To avoid violating invariants of the data structure, remove this
-  // node from all users lists, change id, then read to users list.
+  // The users of each node are sorted by node id. To maintain the order, remove
+  // this node from all users lists, change id, then re-add to users lists.
   for (Node* operand : operands()) {
-    operand->users_.erase(this);
+    if (operand->HasUser(this)) {
+      operand->RemoveUser(this);
+    }
   }
   id_ = id;
   for (Node* operand : operands()) {
-    operand->users_.insert(this);
+    operand->AddUser(this);
   }
   package()->set_next_node_id(std::max(id + 1, package()->next_node_id()));
 }
@@ -726,7 +793,7 @@ bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
   if (this == new_operand) {
     return true;
   }
-  ++package()->transform_metrics().operands_replaced;
+  ++function_base()->transform_metrics().operands_replaced;
   bool did_replace = false;
   for (int64_t i = 0; i < operand_count(); ++i) {
     if (operands_[i] == old_operand) {
@@ -750,7 +817,7 @@ absl::Status Node::ReplaceOperandNumber(int64_t operand_no, Node* new_operand,
         << "old operand type: " << old_operand->GetType()->ToString()
         << " new operand type: " << new_operand->GetType()->ToString();
   }
-  ++package()->transform_metrics().operands_replaced;
+  ++function_base()->transform_metrics().operands_replaced;
 
   // AddUser is idempotent so even if the new operand is already used by this
   // node in another operand slot, it is safe to call.
@@ -774,7 +841,10 @@ absl::Status Node::ReplaceUsesWith(Node* replacement,
   XLS_RET_CHECK(GetType() == replacement->GetType())
       << "type was: " << GetType()->ToString()
       << " replacement: " << replacement->GetType()->ToString();
-  ++package()->transform_metrics().nodes_replaced;
+  ++function_base()->transform_metrics().nodes_replaced;
+  // Implicit uses are not recorded as users so mark both nodes explicitly.
+  MarkChanged();
+  replacement->MarkChanged();
   bool all_replaced = true;
   std::vector<Node*> orig_users(users().begin(), users().end());
   for (Node* user : orig_users) {
@@ -15,6 +15,7 @@
 #ifndef XLS_IR_NODE_H_
 #define XLS_IR_NODE_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -24,13 +25,14 @@
 #include <utility>
 #include <vector>
 
-#include "absl/container/btree_set.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/casts.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/node_allocator.h"
 #include "xls/ir/op.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
@@ -52,6 +54,16 @@ class Node {
  public:
   virtual ~Node() = default;
 
+  // Nodes are allocated from slabs rather than individually (see
+  // NodeAllocator). The destructor is virtual so the size passed to operator
+  // delete is the size of the most-derived type.
+  static void* operator new(size_t size) {
+    return NodeAllocator::Allocate(size);
+  }
+  static void operator delete(void* ptr, size_t size) {
+    NodeAllocator::Deallocate(ptr, size);
+  }
+
   // Accepts the visitor, instructing it to visit this node.
   //
   // The visitor is instructed to visit this node with:
@@ -225,7 +237,7 @@ class Node {
   };
 
   // Returns the unique set of users of this node sorted by id.
-  const absl::btree_set<Node*, NodeIdLessThan>& users() const { return users_; }
+  absl::Span<Node* const> users() const { return users_; }
 
   // Helper for querying whether "target" is a user of this node.
   bool HasUser(const Node* target) const;
@@ -258,6 +270,16 @@ class Node {
   // TODO(meheff): 2021/05/05 Remove this method.
   void SetId(int64_t id);
 
+  // Returns the change epoch of the function base (see
+  // FunctionBase::change_epoch) at the most recent change to this node: its
+  // addition to the function base, or a change to its operands or users.
+  int64_t change_epoch() const { return change_epoch_; }
+
+  // Returns the change epoch at the most recent change to the operands of this
+  // node (or its addition to the function base). Changes to the users of the
+  // node do not affect this epoch.
+  int64_t operands_change_epoch() const { return operands_change_epoch_; }
+
   // Clones the node with the new operands. Returns the newly created
   // instruction.
   absl::StatusOr<Node*> Clone(absl::Span<Node* const> new_operands) const {
@@ -309,8 +331,17 @@ class Node {
   void AddUser(Node* user);
   void RemoveUser(Node* user);
 
+  // Records that this node changed in the current change epoch of the function
+  // base.
+  void MarkChanged();
+
+  // As MarkChanged but also records that the operands of this node changed.
+  void MarkOperandsChanged();
+
   FunctionBase* function_base_;
   int64_t id_;
+  int64_t change_epoch_ = 0;
+  int64_t operands_change_epoch_ = 0;
   Op op_;
   Type* type_;
   SourceInfo loc_;
@@ -318,8 +349,10 @@ class Node {
 
   std::vector<Node*> operands_;
 
-  // Set of users sorted by node_id for stability.
-  absl::btree_set<Node*, NodeIdLessThan> users_;
+  // Set of users sorted by NodeIdLessThan for stability. Most nodes have very
+  // few users so they are stored inline. Users are nearly always added in
+  // increasing id order so maintaining the order is cheap.
+  absl::InlinedVector<Node*, 2> users_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Node& node) {
@@ -0,0 +1,198 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/ir/node_allocator.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "absl/base/attributes.h"
+#include "absl/base/config.h"
+#include "absl/base/no_destructor.h"
+#include "absl/base/optimization.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+#if defined(ABSL_HAVE_ADDRESS_SANITIZER) ||                        \
+    defined(ABSL_HAVE_MEMORY_SANITIZER) ||                         \
+    defined(ABSL_HAVE_THREAD_SANITIZER) ||                         \
+    defined(ABSL_HAVE_HWADDRESS_SANITIZER) || defined(XLS_DISABLE_NODE_ARENA)
+#define XLS_NODE_ARENA_ENABLED 0
+#else
+#define XLS_NODE_ARENA_ENABLED 1
+#endif
+
+namespace xls {
+namespace {
+
+#if XLS_NODE_ARENA_ENABLED
+
+// Granularity of the size classes. Every block is aligned to this.
+constexpr size_t kBlockAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+constexpr size_t kSizeClassCount =
+    NodeAllocator::kMaxSlabAllocationSize / kBlockAlignment;
+
+static_assert(NodeAllocator::kMaxSlabAllocationSize % kBlockAlignment == 0);
+static_assert(NodeAllocator::kSlabSize >=
+              NodeAllocator::kMaxSlabAllocationSize);
+
+// Header written into each free block to link it into a free list.
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+using FreeLists = std::array<FreeBlock*, kSizeClassCount>;
+
+size_t SizeClass(size_t size) {
+  return size == 0 ? 0 : (size - 1) / kBlockAlignment;
+}
+
+size_t BlockSize(size_t size_class) {
+  return (size_class + 1) * kBlockAlignment;
+}
+
+std::atomic<int64_t> slab_bytes = 0;
+
+// Free blocks returned by threads which have exited, shared by all threads.
+class GlobalPool {
+ public:
+  // Removes and returns all free blocks of the given size class. Returns
+  // nullptr if there are none.
+  FreeBlock* TakeList(size_t size_class) {
+    absl::MutexLock lock(&mutex_);
+    FreeBlock* list = lists_[size_class];
+    lists_[size_class] = nullptr;
+    return list;
+  }
+
+  // Adds all blocks in `list` to the pool.
+  void AddList(size_t size_class, FreeBlock* list) {
+    FreeBlock* tail = list;
+    while (tail->next != nullptr) {
+      tail = tail->next;
+    }
+    absl::MutexLock lock(&mutex_);
+    tail->next = lists_[size_class];
+    lists_[size_class] = list;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  FreeLists lists_ ABSL_GUARDED_BY(mutex_) = {};
+};
+
+GlobalPool& GetGlobalPool() {
+  static absl::NoDestructor<GlobalPool> pool;
+  return *pool;
+}
+
+// The free lists of the current thread. This is trivially destructible so it
+// remains usable for the entire lifetime of the thread, including while other
+// thread-local objects (which may own nodes) are destroyed.
+ABSL_CONST_INIT thread_local FreeLists thread_free_lists = {};
+
+// Returns the thread's free lists to the global pool on thread exit.
+class ThreadFreeListReleaser {
+ public:
+  ~ThreadFreeListReleaser() {
+    for (size_t size_class = 0; size_class < kSizeClassCount; ++size_class) {
+      if (thread_free_lists[size_class] != nullptr) {
+        GetGlobalPool().AddList(size_class, thread_free_lists[size_class]);
+        thread_free_lists[size_class] = nullptr;
+      }
+    }
+  }
+
+  // Ensures the releaser for the current thread is constructed. Must be called
+  // before a free list of the thread becomes non-empty.
+  void Register() {}
+};
+
+thread_local ThreadFreeListReleaser thread_free_list_releaser;
+
+// Fills the thread's (empty) free list for the given size class, either from
+// the global pool or from a new slab.
+ABSL_ATTRIBUTE_NOINLINE void RefillFreeList(size_t size_class) {
+  thread_free_list_releaser.Register();
+  FreeBlock* list = GetGlobalPool().TakeList(size_class);
+  if (list == nullptr) {
+    char* slab = static_cast<char*>(::operator new(NodeAllocator::kSlabSize));
+    slab_bytes.fetch_add(NodeAllocator::kSlabSize, std::memory_order_relaxed);
+    size_t block_size = BlockSize(size_class);
+    // Link the blocks in address order so consecutive allocations are
+    // adjacent in memory.
+    for (size_t offset = (NodeAllocator::kSlabSize / block_size) * block_size;
+         offset > 0;) {
+      offset -= block_size;
+      FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + offset);
+      block->next = list;
+      list = block;
+    }
+  }
+  thread_free_lists[size_class] = list;
+}
+
+#endif  // XLS_NODE_ARENA_ENABLED
+
+}  // namespace
+
+/* static */ void* NodeAllocator::Allocate(size_t size) {
+#if XLS_NODE_ARENA_ENABLED
+  if (size <= kMaxSlabAllocationSize) {
+    size_t size_class = SizeClass(size);
+    FreeBlock*& list = thread_free_lists[size_class];
+    if (ABSL_PREDICT_FALSE(list == nullptr)) {
+      RefillFreeList(size_class);
+    }
+    FreeBlock* block = list;
+    list = block->next;
+    return block;
+  }
+#endif
+  return ::operator new(size);
+}
+
+/* static */ void NodeAllocator::Deallocate(void* ptr, size_t size) {
+#if XLS_NODE_ARENA_ENABLED
+  if (size <= kMaxSlabAllocationSize) {
+    FreeBlock*& list = thread_free_lists[SizeClass(size)];
+    if (ABSL_PREDICT_FALSE(list == nullptr)) {
+      // The thread may never have allocated (e.g. it only frees nodes created
+      // elsewhere), so make sure its blocks are released when it exits.
+      thread_free_list_releaser.Register();
+    }
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = list;
+    list = block;
+    return;
+  }
+#endif
+  ::operator delete(ptr, size);
+}
+
+/* static */ bool NodeAllocator::IsEnabled() { return XLS_NODE_ARENA_ENABLED; }
+
+/* static */ int64_t NodeAllocator::GetSlabBytes() {
+#if XLS_NODE_ARENA_ENABLED
+  return slab_bytes.load(std::memory_order_relaxed);
+#else
+  return 0;
+#endif
+}
+
+}  // namespace xls
@@ -0,0 +1,65 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_IR_NODE_ALLOCATOR_H_
+#define XLS_IR_NODE_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace xls {
+
+// Allocator for IR nodes. Nodes are small and are created and destroyed at a
+// very high rate by the optimizer so rather than going to the general-purpose
+// allocator for each one, memory is carved out of large slabs and freed nodes
+// are kept on per-size-class free lists for reuse. This also keeps nodes
+// allocated together close together in memory. Slabs are never returned to
+// the system.
+//
+// Each thread has its own free lists so allocation and deallocation do not
+// take locks in the common case. Free lists are refilled from, and on thread
+// exit returned to, a global pool shared by all threads. Memory may be freed
+// on a different thread than the one which allocated it.
+//
+// The slab allocator is disabled in sanitizer builds (and if
+// XLS_DISABLE_NODE_ARENA is defined) so that use-after-free and leaks of nodes
+// are still diagnosed; in this case all requests are forwarded to
+// ::operator new/delete.
+class NodeAllocator {
+ public:
+  // Requests larger than this are always forwarded to ::operator new.
+  static constexpr size_t kMaxSlabAllocationSize = 512;
+
+  // Size of each slab of memory obtained from ::operator new.
+  static constexpr size_t kSlabSize = 64 * 1024;
+
+  // Returns storage for an object of `size` bytes aligned to
+  // __STDCPP_DEFAULT_NEW_ALIGNMENT__.
+  static void* Allocate(size_t size);
+
+  // Releases storage returned by Allocate. `size` must be the value passed to
+  // Allocate.
+  static void Deallocate(void* ptr, size_t size);
+
+  // Returns whether requests are served from slabs.
+  static bool IsEnabled();
+
+  // Returns the total number of bytes allocated for slabs across all threads.
+  static int64_t GetSlabBytes();
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_NODE_ALLOCATOR_H_
@@ -0,0 +1,130 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/ir/node_allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xls/common/thread.h"
+
+namespace xls {
+namespace {
+
+TEST(NodeAllocatorTest, AllocationsAreAlignedAndDistinct) {
+  std::vector<void*> ptrs;
+  for (size_t size : {1, 8, 16, 24, 100, 512, 513, 4096}) {
+    for (int64_t i = 0; i < 100; ++i) {
+      void* ptr = NodeAllocator::Allocate(size);
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) %
+                    __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                0);
+      // Write the entire allocation to catch overlaps under sanitizers.
+      std::memset(ptr, 0xab, size);
+      ptrs.push_back(ptr);
+    }
+    for (void* ptr : ptrs) {
+      NodeAllocator::Deallocate(ptr, size);
+    }
+    ptrs.clear();
+  }
+}
+
+TEST(NodeAllocatorTest, FreedMemoryIsReused) {
+  if (!NodeAllocator::IsEnabled()) {
+    GTEST_SKIP() << "Node allocator is disabled in this build.";
+  }
+  void* ptr = NodeAllocator::Allocate(64);
+  NodeAllocator::Deallocate(ptr, 64);
+  EXPECT_EQ(NodeAllocator::Allocate(64), ptr);
+  NodeAllocator::Deallocate(ptr, 64);
+
+  int64_t slab_bytes = NodeAllocator::GetSlabBytes();
+  for (int64_t i = 0; i < 1000; ++i) {
+    NodeAllocator::Deallocate(NodeAllocator::Allocate(128), 128);
+  }
+  EXPECT_LE(NodeAllocator::GetSlabBytes(),
+            slab_bytes + NodeAllocator::kSlabSize);
+}
+
+TEST(NodeAllocatorTest, FreeOnDifferentThread) {
+  constexpr int64_t kCount = 10000;
+  std::vector<void*> ptrs(kCount);
+  Thread allocator([&]() {
+    for (void*& ptr : ptrs) {
+      ptr = NodeAllocator::Allocate(48);
+      std::memset(ptr, 0, 48);
+    }
+  });
+  allocator.Join();
+  Thread deallocator([&]() {
+    for (void* ptr : ptrs) {
+      NodeAllocator::Deallocate(ptr, 48);
+    }
+  });
+  deallocator.Join();
+
+  // Blocks released by exited threads are available to other threads.
+  for (void*& ptr : ptrs) {
+    ptr = NodeAllocator::Allocate(48);
+  }
+  for (void* ptr : ptrs) {
+    NodeAllocator::Deallocate(ptr, 48);
+  }
+}
+
+TEST(NodeAllocatorTest, FreeOnlyThreadReturnsBlocksToGlobalPool) {
+  if (!NodeAllocator::IsEnabled()) {
+    GTEST_SKIP() << "Node allocator is disabled in this build.";
+  }
+  // A size class not used by the other tests.
+  constexpr size_t kSize = 200;
+  constexpr int64_t kCount = 1000;
+  std::vector<void*> ptrs(kCount);
+  Thread allocator([&]() {
+    for (void*& ptr : ptrs) {
+      ptr = NodeAllocator::Allocate(kSize);
+    }
+  });
+  allocator.Join();
+  // This thread never allocates so its free list is only ever filled by
+  // Deallocate.
+  Thread deallocator([&]() {
+    for (void* ptr : ptrs) {
+      NodeAllocator::Deallocate(ptr, kSize);
+    }
+  });
+  deallocator.Join();
+
+  // All the blocks are back in the global pool, so a fresh thread can
+  // allocate as many again without new slabs.
+  int64_t slab_bytes = NodeAllocator::GetSlabBytes();
+  Thread reallocator([&]() {
+    for (void*& ptr : ptrs) {
+      ptr = NodeAllocator::Allocate(kSize);
+    }
+    for (void* ptr : ptrs) {
+      NodeAllocator::Deallocate(ptr, kSize);
+    }
+  });
+  reallocator.Join();
+  EXPECT_EQ(NodeAllocator::GetSlabBytes(), slab_bytes);
+}
+
+}  // namespace
+}  // namespace xls
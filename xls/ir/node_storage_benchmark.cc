@@ -0,0 +1,185 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Benchmarks of the core IR data structures on a package which grows large
+// after inlining: parsing, cloning and running the full optimization pipeline.
+// Besides time, each benchmark reports the number of nodes in the package, the
+// peak resident set size of the process (as reported by getrusage) and the
+// bytes held by the node allocator. To compare against allocating every node
+// from the general-purpose allocator, build with
+// --copt=-DXLS_DISABLE_NODE_ARENA.
+
+#include <sys/resource.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node_allocator.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/passes/optimization_pass_pipeline.h"
+
+namespace xls {
+namespace {
+
+constexpr int64_t kOpsPerFunction = 32;
+constexpr int64_t kInvocationsPerFunction = 4;
+
+// Returns the IR text of a package with `function_count` leaf functions, each
+// a chain of arithmetic and bitwise operations, and a top function which
+// invokes each of them several times.
+std::string BuildPackageIr(int64_t function_count) {
+  Package package("node_storage");
+  std::vector<Function*> leaves;
+  for (int64_t i = 0; i < function_count; ++i) {
+    FunctionBuilder fb(absl::StrFormat("leaf%d", i), &package);
+    BValue x = fb.Param("x", package.GetBitsType(32));
+    BValue y = fb.Param("y", package.GetBitsType(32));
+    BValue value = x;
+    for (int64_t j = 0; j < kOpsPerFunction; ++j) {
+      switch (j % 4) {
+        case 0:
+          value = fb.Add(value, fb.Literal(UBits(i * kOpsPerFunction + j, 32)));
+          break;
+        case 1:
+          value = fb.UMul(value, y);
+          break;
+        case 2:
+          value = fb.Xor(value, fb.Shrl(value, fb.Literal(UBits(j, 32))));
+          break;
+        default:
+          value = fb.Select(fb.ULt(value, y), value, fb.Subtract(value, y));
+          break;
+      }
+    }
+    leaves.push_back(fb.Build().value());
+  }
+
+  FunctionBuilder fb("top", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  BValue y = fb.Param("y", package.GetBitsType(32));
+  std::vector<BValue> results;
+  for (Function* leaf : leaves) {
+    BValue arg = x;
+    for (int64_t i = 0; i < kInvocationsPerFunction; ++i) {
+      arg = fb.Invoke({arg, y}, leaf);
+      results.push_back(arg);
+    }
+  }
+  fb.Xor(results);
+  CHECK_OK(package.SetTop(fb.Build().value()));
+  return package.DumpIr();
+}
+
+// Clones all functions of `source` into `target`.
+absl::Status ClonePackage(Package* source, Package* target) {
+  absl::flat_hash_map<const Function*, Function*> call_remapping;
+  for (FunctionBase* fb : FunctionsInPostOrder(source)) {
+    Function* f = fb->AsFunctionOrDie();
+    XLS_ASSIGN_OR_RETURN(call_remapping[f],
+                         f->Clone(f->name(), target, call_remapping));
+  }
+  return absl::OkStatus();
+}
+
+void SetMemoryCounters(benchmark::State& state, const Package& package) {
+  struct rusage usage;
+  CHECK_EQ(getrusage(RUSAGE_SELF, &usage), 0);
+  state.counters["nodes"] = package.GetNodeCount();
+  state.counters["peak_rss"] = usage.ru_maxrss;
+  state.counters["node_slab_bytes"] = NodeAllocator::GetSlabBytes();
+}
+
+// Argument is the number of leaf functions.
+void BM_ParsePackage(benchmark::State& state) {
+  std::string ir = BuildPackageIr(state.range(0));
+  std::unique_ptr<Package> package;
+  for (auto _ : state) {
+    package = Parser::ParsePackage(ir).value();
+    benchmark::DoNotOptimize(package);
+  }
+  SetMemoryCounters(state, *package);
+}
+
+void BM_ClonePackage(benchmark::State& state) {
+  std::unique_ptr<Package> source =
+      Parser::ParsePackage(BuildPackageIr(state.range(0))).value();
+  for (auto _ : state) {
+    Package target("clone");
+    CHECK_OK(ClonePackage(source.get(), &target));
+    benchmark::DoNotOptimize(target);
+  }
+  SetMemoryCounters(state, *source);
+}
+
+// Argument is the number of nodes in the cloned function.
+void BM_CloneLargeFunction(benchmark::State& state) {
+  Package source("large_function");
+  FunctionBuilder fb("f", &source);
+  BValue x = fb.Param("x", source.GetBitsType(32));
+  BValue value = x;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    value = (i % 2 == 0) ? fb.Add(value, x, SourceInfo(),
+                                  absl::StrFormat("sum_%d", i))
+                         : fb.Not(value);
+  }
+  Function* f = fb.BuildWithReturnValue(value).value();
+  for (auto _ : state) {
+    Package target("clone");
+    benchmark::DoNotOptimize(f->Clone(f->name(), &target).value());
+  }
+  SetMemoryCounters(state, source);
+}
+
+void BM_OptimizePackage(benchmark::State& state) {
+  std::string ir = BuildPackageIr(state.range(0));
+  int64_t optimized_nodes = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::unique_ptr<Package> package = Parser::ParsePackage(ir).value();
+    state.ResumeTiming();
+    CHECK_OK(RunOptimizationPassPipeline(package.get()).status());
+    state.PauseTiming();
+    optimized_nodes = package->GetNodeCount();
+    package.reset();
+    state.ResumeTiming();
+  }
+  std::unique_ptr<Package> package = Parser::ParsePackage(ir).value();
+  SetMemoryCounters(state, *package);
+  state.counters["optimized_nodes"] = optimized_nodes;
+}
+
+BENCHMARK(BM_ParsePackage)->Range(16, 1024)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ClonePackage)->Range(16, 1024)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CloneLargeFunction)
+    ->Range(1024, 1 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_OptimizePackage)->Range(16, 256)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace xls
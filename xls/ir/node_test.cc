@@ -42,6 +42,7 @@ namespace {
 
 using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::UnorderedElementsAre;
 
@@ -462,6 +463,34 @@ fn ReplaceUses(x: bits[8], y: bits[8]) -> bits[8] {
   EXPECT_TRUE(FindNode("and.1", f)->users().empty());
 }
 
+TEST_F(NodeTest, UsersSortedById) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn UsersSortedById(x: bits[8], y: bits[8]) -> bits[8] {
+  and.5: bits[8] = and(x, y)
+  or.3: bits[8] = or(x, x)
+  sub.7: bits[8] = sub(y, x)
+  ret add.4: bits[8] = add(x, and.5)
+}
+)",
+                                                       p.get()));
+  Node* x = FindNode("x", f);
+  Node* or_node = FindNode("or.3", f);
+  Node* add = FindNode("add.4", f);
+  Node* and_node = FindNode("and.5", f);
+  Node* sub = FindNode("sub.7", f);
+  EXPECT_THAT(x->users(), ElementsAre(or_node, add, and_node, sub));
+  EXPECT_TRUE(x->HasUser(sub));
+  EXPECT_FALSE(x->HasUser(FindNode("y", f)));
+
+  // Changing the id of a user keeps the users sorted.
+  sub->SetId(1);
+  EXPECT_THAT(x->users(), ElementsAre(sub, or_node, add, and_node));
+
+  XLS_ASSERT_OK(f->RemoveNode(or_node));
+  EXPECT_THAT(x->users(), ElementsAre(sub, add, and_node));
+}
+
 TEST_F(NodeTest, ReplaceUsesReturnValue) {
   auto p = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
@@ -190,10 +190,19 @@ class FunctionAttribute(Attribute):
     )
 
 
-class ValueAttribute(Attribute):
+class PooledValueAttribute(Attribute):
+  """A Value held in the value pool of the package of the node."""
 
   def __init__(self, name):
-    super().__init__(name, cpp_type='Value', return_cpp_type='const Value&')
+    super().__init__(
+        name,
+        cpp_type='std::shared_ptr<const Value>',
+        arg_cpp_type='const Value&',
+        return_cpp_type='const Value&',
+        equals_tmpl='({lhs} == {rhs} || *{lhs} == *{rhs})',
+        init_args=[f'function->package()->value_pool().Intern({name})'],
+    )
+    self.method.expression = f'*{self.data_member.name}'
 
 
 class StringAttribute(Attribute):
@@ -924,7 +933,7 @@ OpClass.kinds['LITERAL'] = OpClass(
     op='Op::kLiteral',
     operands=[],
     xls_type_expression='function->package()->GetTypeForValue(value)',
-    attributes=[ValueAttribute('value')],
+    attributes=[PooledValueAttribute('value')],
     extra_methods=[
         Method('IsZero', 'bool', 'value().IsBits() && value().bits().IsZero()')
     ],
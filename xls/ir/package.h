@@ -38,6 +38,7 @@
 #include "xls/ir/type.h"
 #include "xls/ir/type_manager.h"
 #include "xls/ir/value.h"
+#include "xls/ir/value_pool.h"
 #include "xls/ir/xls_type.pb.h"
 
 namespace xls {
@@ -105,6 +106,9 @@ class Package {
 
   TypeManager& type_manager() { return type_manager_; }
   const TypeManager& type_manager() const { return type_manager_; }
+
+  // Pool holding the values of the literals of this package.
+  ValuePool& value_pool() { return value_pool_; }
   // Returns whether the given type is one of the types owned by this package.
   bool IsOwnedType(const Type* type) const {
     return type_manager_.IsOwnedType(type);
@@ -442,6 +446,9 @@ class Package {
   // Ordinal to assign to the next node created in this package.
   int64_t next_node_id_ = 1;
 
+  // Declared before the function bases so that it outlives their literals.
+  ValuePool value_pool_;
+
   std::vector<std::unique_ptr<Function>> functions_;
   std::vector<std::unique_ptr<Proc>> procs_;
   std::vector<std::unique_ptr<Block>> blocks_;
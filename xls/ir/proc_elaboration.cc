@@ -61,8 +61,9 @@ absl::StatusOr<std::unique_ptr<ProcInstance>> CreateNewStyleProcInstance(
   }
   std::vector<std::unique_ptr<ChannelInstance>> declared_channels;
   for (Channel* channel : proc->channels()) {
-    declared_channels.push_back(std::make_unique<ChannelInstance>(
-        ChannelInstance{.channel = channel, .path = path}));
+    // The path is filled in by the ProcInstance, which holds it.
+    declared_channels.push_back(
+        std::make_unique<ChannelInstance>(ChannelInstance{.channel = channel}));
     ChannelInstance* channel_instance = declared_channels.back().get();
     XLS_ASSIGN_OR_RETURN(ChannelReference * send_reference,
                          proc->GetSendChannelReference(channel->name()));
@@ -115,7 +116,7 @@ absl::StatusOr<std::unique_ptr<ProcInstance>> CreateNewStyleProcInstance(
 }  // namespace
 
 std::string ChannelInstance::ToString() const {
-  if (path.has_value()) {
+  if (path != nullptr) {
     return absl::StrFormat("%s [%s]", channel->name(), path->ToString());
   }
   return std::string{channel->name()};
@@ -133,6 +134,12 @@ ProcInstance::ProcInstance(
       channel_instances_(std::move(channel_instances)),
       instantiated_procs_(std::move(instantiated_procs)),
       channel_bindings_(std::move(channel_bindings)) {
+  if (path_.has_value()) {
+    for (const std::unique_ptr<ChannelInstance>& channel_instance :
+         channel_instances_) {
+      channel_instance->path = &*path_;
+    }
+  }
   if (proc->is_new_style_proc()) {
     for (const std::unique_ptr<ChannelReference>& channel_reference :
          proc->channel_references()) {
@@ -149,8 +156,9 @@ ProcInstance::ProcInstance(
 
 absl::StatusOr<ChannelInstance*> ProcInstance::GetChannelInstance(
     std::string_view channel_reference_name) const {
-  if (channel_name_map_.contains(channel_reference_name)) {
-    return channel_name_map_.at(channel_reference_name);
+  auto it = channel_name_map_.find(channel_reference_name);
+  if (it != channel_name_map_.end()) {
+    return it->second;
   }
   return absl::NotFoundError(
       absl::StrFormat("No channel reference named `%s` in proc `%s`",
@@ -207,7 +215,7 @@ absl::Status ProcElaboration::BuildInstanceMaps(ProcInstance* proc_instance) {
   proc_instance_ptrs_.push_back(proc_instance);
   instances_of_proc_[proc_instance->proc()].push_back(proc_instance);
 
-  proc_instances_by_path_[proc_instance->path().value()] = proc_instance;
+  proc_instances_by_path_[PathRef{&*proc_instance->path()}] = proc_instance;
   for (const std::unique_ptr<ChannelInstance>& channel_instance :
        proc_instance->channels()) {
     instances_of_channel_[channel_instance->channel].push_back(
@@ -220,9 +228,6 @@ absl::Status ProcElaboration::BuildInstanceMaps(ProcInstance* proc_instance) {
     XLS_ASSIGN_OR_RETURN(
         ChannelInstance * channel_instance,
         proc_instance->GetChannelInstance(channel_reference->name()));
-    channel_instances_by_path_[{std::string{channel_reference->name()},
-                                proc_instance->path().value()}] =
-        channel_instance;
     instances_of_channel_reference_[channel_reference.get()].push_back(
         channel_instance);
   }
@@ -278,7 +283,7 @@ absl::Status ProcElaboration::BuildInstanceMaps(ProcInstance* proc_instance) {
     elaboration.interface_channel_instances_.push_back(
         std::make_unique<ChannelInstance>(ChannelInstance{
             .channel = elaboration.interface_channels_.back().get(),
-            .path = std::nullopt}));
+            .path = nullptr}));
     interface_bindings.push_back(ChannelBinding{
         .instance = elaboration.interface_channel_instances_.back().get(),
         .parent_reference = std::nullopt});
@@ -319,7 +324,7 @@ std::string ProcElaboration::ToString() const {
 
 absl::StatusOr<ProcInstance*> ProcElaboration::GetProcInstance(
     const ProcInstantiationPath& path) const {
-  auto it = proc_instances_by_path_.find(path);
+  auto it = proc_instances_by_path_.find(PathRef{&path});
   if (it == proc_instances_by_path_.end()) {
     return absl::NotFoundError(absl::StrFormat(
         "Instantiation path `%s` does not exist in elaboration from proc `%s`",
@@ -339,14 +344,18 @@ absl::StatusOr<ProcInstance*> ProcElaboration::GetProcInstance(
 
 absl::StatusOr<ChannelInstance*> ProcElaboration::GetChannelInstance(
     std::string_view channel_name, const ProcInstantiationPath& path) const {
-  auto it = channel_instances_by_path_.find({std::string{channel_name}, path});
-  if (it == channel_instances_by_path_.end()) {
+  auto it = proc_instances_by_path_.find(PathRef{&path});
+  absl::StatusOr<ChannelInstance*> channel_instance =
+      it == proc_instances_by_path_.end()
+          ? absl::NotFoundError("")
+          : it->second->GetChannelInstance(channel_name);
+  if (!channel_instance.ok()) {
     return absl::NotFoundError(
         absl::StrFormat("No channel `%s` at instantiation path `%s` in "
                         "elaboration from proc `%s`",
                         channel_name, path.ToString(), top()->proc()->name()));
   }
-  return it->second;
+  return channel_instance;
 }
 
 absl::StatusOr<ChannelInstance*> ProcElaboration::GetChannelInstance(
@@ -381,7 +390,7 @@ ProcElaboration::ElaborateOldStylePackage(Package* package) {
   absl::flat_hash_map<ChannelRef, ChannelBinding> channel_bindings;
   for (Channel* channel : package->channels()) {
     elaboration.channel_instances_.push_back(std::make_unique<ChannelInstance>(
-        ChannelInstance{.channel = channel, .path = std::nullopt}));
+        ChannelInstance{.channel = channel, .path = nullptr}));
     ChannelInstance* channel_instance =
         elaboration.channel_instances_.back().get();
 
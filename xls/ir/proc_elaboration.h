@@ -89,8 +89,10 @@ struct ChannelInstance {
   Channel* channel;
 
   // Instantiation path of the proc instance in which this channel is
-  // defined. Is nullopt for old-style channels.
-  std::optional<ProcInstantiationPath> path;
+  // defined. This points at the path held by that proc instance rather than
+  // holding a copy, as there may be very many instances. Is nullptr for
+  // old-style channels and the interface channels of the top proc.
+  const ProcInstantiationPath* path = nullptr;
 
   std::string ToString() const;
 };
@@ -193,8 +195,8 @@ class ProcInstance {
   absl::flat_hash_map<ChannelRef, ChannelBinding> channel_bindings_;
 
   // Map from channel reference name to channel instance for all channel
-  // references in the proc.
-  absl::flat_hash_map<std::string, ChannelInstance*> channel_name_map_;
+  // references in the proc. The names are owned by the IR.
+  absl::flat_hash_map<std::string_view, ChannelInstance*> channel_name_map_;
 };
 
 // Data structure representing the elaboration tree.
@@ -300,15 +302,21 @@ class ProcElaboration {
   // Channel instances for the interface channels.
   std::vector<std::unique_ptr<ChannelInstance>> interface_channel_instances_;
 
+  // Refers to the instantiation path held by a proc instance, hashing and
+  // comparing by the path, so that the paths are not copied into the map keys.
+  struct PathRef {
+    const ProcInstantiationPath* path;
+
+    template <typename H>
+    friend H AbslHashValue(H h, const PathRef& p) {
+      return H::combine(std::move(h), *p.path);
+    }
+    bool operator==(const PathRef& other) const { return *path == *other.path; }
+  };
+
   // All proc instances in the elaboration indexed by instantiation path.
-  absl::flat_hash_map<ProcInstantiationPath, ProcInstance*>
-      proc_instances_by_path_;
-
-  // All channel instances in the elaboration indexed by channel reference name
-  // (new style) or channel name (old style) and instantiation path.
-  absl::flat_hash_map<std::pair<std::string, ProcInstantiationPath>,
-                      ChannelInstance*>
-      channel_instances_by_path_;
+  // Channel instances are found through the proc instance at their path.
+  absl::flat_hash_map<PathRef, ProcInstance*> proc_instances_by_path_;
 
   // List of instances of each Proc/Channel.
   absl::flat_hash_map<Proc*, std::vector<ProcInstance*>> instances_of_proc_;
@@ -193,6 +193,14 @@ TEST_F(ElaborationTest, ProcInstantiatingProc) {
   EXPECT_THAT(
       elab.GetChannelInstance("leaf_ch0", leaf_instance->path().value()),
       IsOkAndHolds(leaf_instance->GetChannelInstance("leaf_ch0").value()));
+  EXPECT_THAT(elab.GetChannelInstance("no_such_ch",
+                                      leaf_instance->path().value()),
+              StatusIs(absl::StatusCode::kNotFound));
+
+  // Channel instances refer to the path held by the declaring proc instance.
+  ChannelInstance* the_ch_instance = elab.top()->channels().front().get();
+  EXPECT_EQ(the_ch_instance->path, &elab.top()->path().value());
+  EXPECT_EQ(the_ch_instance->ToString(), "the_ch [top_proc]");
 
   EXPECT_EQ(elab.ToString(), R"(top_proc<in_ch>
   chan the_ch
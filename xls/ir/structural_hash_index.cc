@@ -0,0 +1,166 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/structural_hash_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/hash/hash.h"
+#include "absl/log/check.h"
+#include "absl/types/span.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+namespace {
+
+// Returns the operands of the node in a canonical order. Commutative ops are
+// agnostic to operand order so their operands are sorted.
+absl::InlinedVector<Node*, 4> CanonicalOperands(const Node* node) {
+  absl::InlinedVector<Node*, 4> operands(node->operands().begin(),
+                                         node->operands().end());
+  if (OpIsCommutative(node->op())) {
+    std::sort(operands.begin(), operands.end(), std::less<Node*>());
+  }
+  return operands;
+}
+
+uint64_t StructuralHash(const Node* node) {
+  absl::InlinedVector<Node*, 4> operands = CanonicalOperands(node);
+  uint64_t hash = absl::Hash<std::pair<Op, absl::Span<Node* const>>>()(
+      {node->op(), absl::MakeConstSpan(operands)});
+  // Literals have no operands so include the value to avoid putting all
+  // literals in one bucket.
+  if (node->Is<Literal>() && node->As<Literal>()->value().IsBits()) {
+    hash = absl::Hash<std::pair<uint64_t, Bits>>()(
+        {hash, node->As<Literal>()->value().bits()});
+  }
+  return hash;
+}
+
+bool IsEquivalent(const Node* a, const Node* b) {
+  return a->op() == b->op() && CanonicalOperands(a) == CanonicalOperands(b) &&
+         a->IsDefinitelyEqualTo(b);
+}
+
+}  // namespace
+
+StructuralHashIndex::StructuralHashIndex(FunctionBase* f) {
+  hashes_.reserve(f->node_count());
+  for (Node* node : f->nodes()) {
+    Add(node);
+  }
+}
+
+void StructuralHashIndex::Add(Node* node) {
+  if (OpIsSideEffecting(node->op())) {
+    return;
+  }
+  Insert(node);
+}
+
+void StructuralHashIndex::Remove(Node* node) {
+  if (!hashes_.contains(node)) {
+    return;
+  }
+  Erase(node);
+  stale_.erase(node);
+  potential_duplicates_.erase(node);
+}
+
+void StructuralHashIndex::MarkOperandsChanged(Node* node) {
+  if (hashes_.contains(node)) {
+    stale_.insert(node);
+  }
+}
+
+std::optional<Node*> StructuralHashIndex::FindEquivalent(Node* node) {
+  if (OpIsSideEffecting(node->op())) {
+    return std::nullopt;
+  }
+  RehashStale();
+  auto hash_it = hashes_.find(node);
+  uint64_t hash =
+      hash_it == hashes_.end() ? StructuralHash(node) : hash_it->second;
+  auto bucket_it = buckets_.find(hash);
+  if (bucket_it == buckets_.end()) {
+    return std::nullopt;
+  }
+  std::optional<Node*> result;
+  for (Node* candidate : bucket_it->second) {
+    if (candidate != node &&
+        (!result.has_value() || candidate->id() < (*result)->id()) &&
+        IsEquivalent(node, candidate)) {
+      result = candidate;
+    }
+  }
+  return result;
+}
+
+std::vector<Node*> StructuralHashIndex::TakePotentialDuplicates() {
+  RehashStale();
+  std::vector<Node*> result(potential_duplicates_.begin(),
+                            potential_duplicates_.end());
+  potential_duplicates_.clear();
+  return result;
+}
+
+void StructuralHashIndex::RehashStale() {
+  // Erase all stale nodes first so they are not considered duplicates of one
+  // another's stale entries.
+  for (Node* node : stale_) {
+    Erase(node);
+  }
+  for (Node* node : stale_) {
+    Insert(node);
+  }
+  stale_.clear();
+}
+
+void StructuralHashIndex::Insert(Node* node) {
+  uint64_t hash = StructuralHash(node);
+  hashes_[node] = hash;
+  std::vector<Node*>& bucket = buckets_[hash];
+  if (!bucket.empty()) {
+    potential_duplicates_.insert(node);
+  }
+  bucket.push_back(node);
+}
+
+void StructuralHashIndex::Erase(Node* node) {
+  auto hash_it = hashes_.find(node);
+  CHECK(hash_it != hashes_.end()) << node->GetName();
+  auto bucket_it = buckets_.find(hash_it->second);
+  std::vector<Node*>& bucket = bucket_it->second;
+  auto it = absl::c_find(bucket, node);
+  CHECK(it != bucket.end()) << node->GetName();
+  *it = bucket.back();
+  bucket.pop_back();
+  if (bucket.empty()) {
+    buckets_.erase(bucket_it);
+  }
+  hashes_.erase(hash_it);
+}
+
+}  // namespace xls
@@ -0,0 +1,85 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_STRUCTURAL_HASH_INDEX_H_
+#define XLS_IR_STRUCTURAL_HASH_INDEX_H_
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+
+namespace xls {
+
+class FunctionBase;
+class Node;
+
+// An index of the nodes of a function base by their structure: the op, the
+// operands (in any order for commutative ops) and, for literals, the value.
+// Used to hash-cons the nodes of a function base; see
+// FunctionBase::EnableStructuralHashing.
+//
+// The index is kept up to date by the function base as nodes are added and
+// removed and as their operands change. Nodes whose operands changed are only
+// rehashed when the index is next queried, so a node may be rewired several
+// times at the cost of a single rehash. Side-effecting nodes are never
+// equivalent to another node and are not indexed.
+class StructuralHashIndex {
+ public:
+  // Creates an index of the current nodes of `f`.
+  explicit StructuralHashIndex(FunctionBase* f);
+
+  StructuralHashIndex(const StructuralHashIndex&) = delete;
+  StructuralHashIndex& operator=(const StructuralHashIndex&) = delete;
+
+  // Returns true if the node is in the index.
+  bool Contains(Node* node) const { return hashes_.contains(node); }
+
+  // Adds the node to the index. Side-effecting nodes are ignored.
+  void Add(Node* node);
+
+  // Removes the node from the index, if present.
+  void Remove(Node* node);
+
+  // Notes that the operands of the node changed so its hash is stale.
+  void MarkOperandsChanged(Node* node);
+
+  // Returns the node with the smallest id, other than `node`, which is
+  // equivalent to `node` (as for common subexpression elimination) if any.
+  std::optional<Node*> FindEquivalent(Node* node);
+
+  // Returns (and forgets) the nodes which were hashed into the same bucket as
+  // another node since the last call. These are the only nodes which may have
+  // become equivalent to another node since then, barring changes to node
+  // attributes other than operands.
+  std::vector<Node*> TakePotentialDuplicates();
+
+ private:
+  // Rehashes the nodes whose operands changed.
+  void RehashStale();
+
+  void Insert(Node* node);
+  void Erase(Node* node);
+
+  absl::flat_hash_map<Node*, uint64_t> hashes_;
+  absl::flat_hash_map<uint64_t, std::vector<Node*>> buckets_;
+  absl::flat_hash_set<Node*> stale_;
+  absl::flat_hash_set<Node*> potential_duplicates_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_STRUCTURAL_HASH_INDEX_H_
@@ -0,0 +1,104 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/structural_hash_index.h"
+
+#include <optional>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Optional;
+using ::testing::UnorderedElementsAre;
+
+class StructuralHashIndexTest : public IrTestBase {};
+
+TEST_F(StructuralHashIndexTest, FindsEquivalentNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue add_xy = fb.Add(x, y);
+  BValue add_yx = fb.Add(y, x);
+  BValue sub_xy = fb.Subtract(x, y);
+  BValue sub_yx = fb.Subtract(y, x);
+  BValue one = fb.Literal(UBits(1, 32));
+  BValue two = fb.Literal(UBits(2, 32));
+  BValue another_one = fb.Literal(UBits(1, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f,
+      fb.BuildWithReturnValue(
+          fb.Tuple({add_xy, add_yx, sub_xy, sub_yx, one, two, another_one})));
+
+  StructuralHashIndex* index = f->EnableStructuralHashing();
+  EXPECT_EQ(f->EnableStructuralHashing(), index);
+  EXPECT_THAT(index->FindEquivalent(add_yx.node()), Optional(add_xy.node()));
+  EXPECT_THAT(index->FindEquivalent(add_xy.node()), Optional(add_yx.node()));
+  EXPECT_EQ(index->FindEquivalent(sub_yx.node()), std::nullopt);
+  EXPECT_THAT(index->FindEquivalent(another_one.node()), Optional(one.node()));
+  EXPECT_EQ(index->FindEquivalent(two.node()), std::nullopt);
+  EXPECT_THAT(index->TakePotentialDuplicates(),
+              UnorderedElementsAre(add_yx.node(), another_one.node()));
+  EXPECT_THAT(index->TakePotentialDuplicates(), IsEmpty());
+}
+
+TEST_F(StructuralHashIndexTest, TracksGraphChanges) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue neg_x = fb.Negate(x);
+  BValue neg_y = fb.Negate(y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Tuple({neg_x, neg_y})));
+  StructuralHashIndex* index = f->EnableStructuralHashing();
+  EXPECT_THAT(index->TakePotentialDuplicates(), IsEmpty());
+
+  // New nodes are indexed on creation.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * another_neg_x,
+                           f->MakeNode<UnOp>(SourceInfo(), x.node(), Op::kNeg));
+  EXPECT_TRUE(index->Contains(another_neg_x));
+  EXPECT_THAT(index->TakePotentialDuplicates(), ElementsAre(another_neg_x));
+  EXPECT_THAT(index->FindEquivalent(another_neg_x), Optional(neg_x.node()));
+
+  // Changing the operand of a node rehashes it.
+  ASSERT_TRUE(neg_y.node()->ReplaceOperand(y.node(), x.node()));
+  EXPECT_THAT(index->TakePotentialDuplicates(), ElementsAre(neg_y.node()));
+  EXPECT_THAT(index->FindEquivalent(neg_y.node()), Optional(neg_x.node()));
+
+  // Removed nodes are dropped from the index.
+  XLS_ASSERT_OK(f->RemoveNode(another_neg_x));
+  EXPECT_THAT(index->FindEquivalent(neg_x.node()), Optional(neg_y.node()));
+
+  f->DisableStructuralHashing();
+  EXPECT_EQ(f->structural_hash_index(), nullptr);
+}
+
+}  // namespace
+}  // namespace xls
@@ -102,6 +102,66 @@ absl::StatusOr<TernaryVector> StringToTernaryVector(std::string_view s) {
   return result;
 }
 
+namespace {
+
+constexpr int64_t kWordBits = 64;
+
+}  // namespace
+
+PackedTernaryVector::PackedTernaryVector(InlineBitmap known,
+                                         InlineBitmap values)
+    : known_(std::move(known)), values_(std::move(values)) {
+  CHECK_EQ(known_.bit_count(), values_.bit_count());
+  values_.Intersect(known_);
+}
+
+/* static */ PackedTernaryVector PackedTernaryVector::FromTernary(
+    TernarySpan ternary) {
+  const int64_t bit_count = ternary.size();
+  PackedTernaryVector result(bit_count);
+  for (int64_t wordno = 0; wordno < result.known_.word_count(); ++wordno) {
+    uint64_t known = 0;
+    uint64_t values = 0;
+    const int64_t start = wordno * kWordBits;
+    const int64_t end = std::min(start + kWordBits, bit_count);
+    for (int64_t i = start; i < end; ++i) {
+      const uint64_t bit = uint64_t{1} << (i - start);
+      if (ternary[i] == TernaryValue::kKnownOne) {
+        known |= bit;
+        values |= bit;
+      } else if (ternary[i] == TernaryValue::kKnownZero) {
+        known |= bit;
+      }
+    }
+    result.known_.SetWord(wordno, known);
+    result.values_.SetWord(wordno, values);
+  }
+  return result;
+}
+
+/* static */ PackedTernaryVector PackedTernaryVector::FromBits(
+    const Bits& bits) {
+  return PackedTernaryVector(InlineBitmap(bits.bit_count(), /*fill=*/true),
+                             bits.bitmap());
+}
+
+TernaryVector PackedTernaryVector::ToTernary() const {
+  TernaryVector result;
+  result.reserve(bit_count());
+  for (int64_t i = 0; i < bit_count(); ++i) {
+    result.push_back(Get(i));
+  }
+  return result;
+}
+
+Bits PackedTernaryVector::UnsignedMax() const {
+  InlineBitmap result(bit_count());
+  for (int64_t wordno = 0; wordno < result.word_count(); ++wordno) {
+    result.SetWord(wordno, values_.GetWord(wordno) | ~known_.GetWord(wordno));
+  }
+  return Bits::FromBitmap(std::move(result));
+}
+
 namespace ternary_ops {
 
 TernaryVector FromKnownBits(const Bits& known_bits,
@@ -280,6 +340,139 @@ TernaryVector BitsToTernary(const Bits& bits) {
   return result;
 }
 
+namespace {
+
+// Builds a packed vector word by word from the words of `lhs` and `rhs`.
+// `f(lhs_known, lhs_values, rhs_known, rhs_values)` returns the known mask and
+// the values of the corresponding result word.
+template <typename F>
+PackedTernaryVector CombineWords(const PackedTernaryVector& lhs,
+                                 const PackedTernaryVector& rhs, F f) {
+  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
+  InlineBitmap known(lhs.bit_count());
+  InlineBitmap values(lhs.bit_count());
+  for (int64_t wordno = 0; wordno < known.word_count(); ++wordno) {
+    auto [known_word, values_word] =
+        f(lhs.known().GetWord(wordno), lhs.values().GetWord(wordno),
+          rhs.known().GetWord(wordno), rhs.values().GetWord(wordno));
+    known.SetWord(wordno, known_word);
+    values.SetWord(wordno, values_word);
+  }
+  return PackedTernaryVector(std::move(known), std::move(values));
+}
+
+// Adds two words with a carry in, updating `carry` to the carry out.
+uint64_t AddWithCarry(uint64_t a, uint64_t b, bool& carry) {
+  uint64_t sum = a + b;
+  bool carry_out = sum < a;
+  uint64_t sum_with_carry = sum + (carry ? 1 : 0);
+  carry = carry_out || sum_with_carry < sum;
+  return sum_with_carry;
+}
+
+}  // namespace
+
+PackedTernaryVector Not(const PackedTernaryVector& v) {
+  InlineBitmap values(v.bit_count());
+  for (int64_t wordno = 0; wordno < values.word_count(); ++wordno) {
+    values.SetWord(wordno, ~v.values().GetWord(wordno));
+  }
+  return PackedTernaryVector(v.known(), std::move(values));
+}
+
+PackedTernaryVector And(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs) {
+  return CombineWords(lhs, rhs,
+                      [](uint64_t lhs_known, uint64_t lhs_values,
+                         uint64_t rhs_known, uint64_t rhs_values) {
+                        uint64_t ones = lhs_values & rhs_values;
+                        uint64_t zeros = (lhs_known & ~lhs_values) |
+                                         (rhs_known & ~rhs_values);
+                        return std::make_pair(ones | zeros, ones);
+                      });
+}
+
+PackedTernaryVector Or(const PackedTernaryVector& lhs,
+                       const PackedTernaryVector& rhs) {
+  return CombineWords(lhs, rhs,
+                      [](uint64_t lhs_known, uint64_t lhs_values,
+                         uint64_t rhs_known, uint64_t rhs_values) {
+                        uint64_t ones = lhs_values | rhs_values;
+                        uint64_t zeros = (lhs_known & ~lhs_values) &
+                                         (rhs_known & ~rhs_values);
+                        return std::make_pair(ones | zeros, ones);
+                      });
+}
+
+PackedTernaryVector Xor(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs) {
+  return CombineWords(lhs, rhs,
+                      [](uint64_t lhs_known, uint64_t lhs_values,
+                         uint64_t rhs_known, uint64_t rhs_values) {
+                        uint64_t known = lhs_known & rhs_known;
+                        return std::make_pair(known, lhs_values ^ rhs_values);
+                      });
+}
+
+PackedTernaryVector Add(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs) {
+  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
+  InlineBitmap known(lhs.bit_count());
+  InlineBitmap values(lhs.bit_count());
+  // Sums of the smallest and of the largest possible operand values. The carry
+  // into any bit of the smallest sum is the smallest possible carry into that
+  // bit, and likewise for the largest sum.
+  bool min_carry = false;
+  bool max_carry = false;
+  for (int64_t wordno = 0; wordno < known.word_count(); ++wordno) {
+    uint64_t lhs_known = lhs.known().GetWord(wordno);
+    uint64_t lhs_values = lhs.values().GetWord(wordno);
+    uint64_t rhs_known = rhs.known().GetWord(wordno);
+    uint64_t rhs_values = rhs.values().GetWord(wordno);
+    uint64_t min_sum = AddWithCarry(lhs_values, rhs_values, min_carry);
+    uint64_t max_sum = AddWithCarry(lhs_values | ~lhs_known,
+                                    rhs_values | ~rhs_known, max_carry);
+    // Recover the carry into each bit by removing the operand bits from the
+    // sum bit. Where the operand bits are known this is exact.
+    uint64_t min_carries = min_sum ^ lhs_values ^ rhs_values;
+    uint64_t max_carries = max_sum ^ lhs_values ^ rhs_values;
+    uint64_t carry_known = min_carries | ~max_carries;
+    uint64_t known_word = lhs_known & rhs_known & carry_known;
+    known.SetWord(wordno, known_word);
+    values.SetWord(wordno, min_sum & known_word);
+  }
+  return PackedTernaryVector(std::move(known), std::move(values));
+}
+
+TernaryValue Eq(const PackedTernaryVector& lhs,
+                const PackedTernaryVector& rhs) {
+  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
+  for (int64_t wordno = 0; wordno < lhs.known().word_count(); ++wordno) {
+    uint64_t both_known =
+        lhs.known().GetWord(wordno) & rhs.known().GetWord(wordno);
+    if ((both_known &
+         (lhs.values().GetWord(wordno) ^ rhs.values().GetWord(wordno))) != 0) {
+      return TernaryValue::kKnownZero;
+    }
+  }
+  if (lhs.IsFullyKnown() && rhs.IsFullyKnown()) {
+    return TernaryValue::kKnownOne;
+  }
+  return TernaryValue::kUnknown;
+}
+
+TernaryValue ULt(const PackedTernaryVector& lhs,
+                 const PackedTernaryVector& rhs) {
+  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
+  if (lhs.UnsignedMax().bitmap().UCmp(rhs.UnsignedMin().bitmap()) < 0) {
+    return TernaryValue::kKnownOne;
+  }
+  if (lhs.UnsignedMin().bitmap().UCmp(rhs.UnsignedMax().bitmap()) >= 0) {
+    return TernaryValue::kKnownZero;
+  }
+  return TernaryValue::kUnknown;
+}
+
 /* static */ std::vector<int64_t> RealizedTernaryIterator::FindUnknownOffsets(
     TernarySpan span) {
   std::vector<int64_t> result;
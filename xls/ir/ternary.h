@@ -31,6 +31,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/common/iterator_range.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/ir/bits.h"
 
 namespace xls {
@@ -68,6 +69,55 @@ inline std::ostream& operator<<(std::ostream& os, TernarySpan vector) {
   return os;
 }
 
+// A ternary vector packed into two bitmaps: a mask of the known bits and the
+// values of those known bits. Unknown positions always have a value of zero.
+// Unlike TernaryVector, which spends a byte per bit, the packed form lets the
+// ternary_ops below operate on 64 bits at a time.
+class PackedTernaryVector {
+ public:
+  // Creates a vector of `bit_count` unknown bits.
+  explicit PackedTernaryVector(int64_t bit_count)
+      : known_(bit_count), values_(bit_count) {}
+
+  // Creates a vector from a mask of known bits and their values. Values at
+  // unknown positions are ignored.
+  PackedTernaryVector(InlineBitmap known, InlineBitmap values);
+
+  static PackedTernaryVector FromTernary(TernarySpan ternary);
+  static PackedTernaryVector FromBits(const Bits& bits);
+
+  TernaryVector ToTernary() const;
+
+  int64_t bit_count() const { return known_.bit_count(); }
+  const InlineBitmap& known() const { return known_; }
+  const InlineBitmap& values() const { return values_; }
+
+  TernaryValue Get(int64_t index) const {
+    if (!known_.Get(index)) {
+      return TernaryValue::kUnknown;
+    }
+    return values_.Get(index) ? TernaryValue::kKnownOne
+                              : TernaryValue::kKnownZero;
+  }
+  bool IsFullyKnown() const { return known_.IsAllOnes(); }
+
+  // Returns the smallest (all unknown bits zero) and largest (all unknown bits
+  // one) unsigned values the vector can take.
+  Bits UnsignedMin() const { return Bits::FromBitmap(values_); }
+  Bits UnsignedMax() const;
+
+  bool operator==(const PackedTernaryVector& other) const {
+    return known_ == other.known_ && values_ == other.values_;
+  }
+  bool operator!=(const PackedTernaryVector& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  InlineBitmap known_;
+  InlineBitmap values_;
+};
+
 namespace ternary_ops {
 
 // Returns a vector with known bits as represented in `known_bits`, with values
@@ -169,6 +219,30 @@ inline TernaryValue Or(const TernaryValue& a, const TernaryValue& b) {
 
 TernaryVector BitsToTernary(const Bits& bits);
 
+// Word-parallel operations on packed ternary vectors. All CHECK fail if the
+// operands have different widths.
+PackedTernaryVector Not(const PackedTernaryVector& v);
+PackedTernaryVector And(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs);
+PackedTernaryVector Or(const PackedTernaryVector& lhs,
+                       const PackedTernaryVector& rhs);
+PackedTernaryVector Xor(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs);
+
+// Returns the bits of `lhs + rhs` (modulo 2^bit_count) which are the same for
+// every possible value of the operands. A bit of the sum is known when both
+// operand bits are known and the carry into it is the same whether all unknown
+// operand bits are zero or all are one.
+PackedTernaryVector Add(const PackedTernaryVector& lhs,
+                        const PackedTernaryVector& rhs);
+
+// Returns whether `lhs == rhs` (resp. `lhs < rhs` unsigned) for every possible
+// value of the operands (kKnownOne), for none of them (kKnownZero), or only for
+// some of them (kUnknown).
+TernaryValue Eq(const PackedTernaryVector& lhs, const PackedTernaryVector& rhs);
+TernaryValue ULt(const PackedTernaryVector& lhs,
+                 const PackedTernaryVector& rhs);
+
 // An iterator of possible ternary values.
 class RealizedTernaryIterator {
  public:
@@ -15,7 +15,9 @@
 #include "xls/ir/ternary.h"
 
 #include <cstdint>
+#include <limits>
 #include <optional>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -64,6 +66,141 @@ TEST(Ternary, NumberOfKnownBits) {
   EXPECT_EQ(ternary_ops::NumberOfKnownBits(TernaryVector()), 0);
 }
 
+// Returns all ternary vectors of the given width.
+std::vector<TernaryVector> AllTernaryVectors(int64_t width) {
+  std::vector<TernaryVector> result = {TernaryVector()};
+  for (int64_t i = 0; i < width; ++i) {
+    std::vector<TernaryVector> extended;
+    for (const TernaryVector& v : result) {
+      for (TernaryValue t : {TernaryValue::kKnownZero, TernaryValue::kKnownOne,
+                             TernaryValue::kUnknown}) {
+        extended.push_back(v);
+        extended.back().push_back(t);
+      }
+    }
+    result = std::move(extended);
+  }
+  return result;
+}
+
+TEST(PackedTernary, RoundTrip) {
+  XLS_ASSERT_OK_AND_ASSIGN(TernaryVector small,
+                           StringToTernaryVector("0b1101X1X001"));
+  EXPECT_EQ(PackedTernaryVector::FromTernary(small).ToTernary(), small);
+
+  TernaryVector large(130, TernaryValue::kUnknown);
+  large[0] = TernaryValue::kKnownOne;
+  large[64] = TernaryValue::kKnownZero;
+  large[129] = TernaryValue::kKnownOne;
+  PackedTernaryVector packed = PackedTernaryVector::FromTernary(large);
+  EXPECT_EQ(packed.ToTernary(), large);
+  EXPECT_EQ(packed.Get(64), TernaryValue::kKnownZero);
+  EXPECT_EQ(packed.Get(65), TernaryValue::kUnknown);
+  EXPECT_FALSE(packed.IsFullyKnown());
+
+  EXPECT_EQ(PackedTernaryVector::FromBits(UBits(0b1010, 4)).ToTernary(),
+            *StringToTernaryVector("0b1010"));
+  EXPECT_EQ(PackedTernaryVector::FromTernary(TernaryVector()).bit_count(), 0);
+}
+
+TEST(PackedTernary, BitwiseOpsMatchElementwise) {
+  for (const TernaryVector& lhs : AllTernaryVectors(3)) {
+    PackedTernaryVector packed_lhs = PackedTernaryVector::FromTernary(lhs);
+    TernaryVector expected_not;
+    for (TernaryValue t : lhs) {
+      expected_not.push_back(t == TernaryValue::kUnknown
+                                 ? t
+                                 : (t == TernaryValue::kKnownOne
+                                        ? TernaryValue::kKnownZero
+                                        : TernaryValue::kKnownOne));
+    }
+    EXPECT_EQ(ternary_ops::Not(packed_lhs).ToTernary(), expected_not);
+    for (const TernaryVector& rhs : AllTernaryVectors(3)) {
+      PackedTernaryVector packed_rhs = PackedTernaryVector::FromTernary(rhs);
+      TernaryVector expected_and;
+      TernaryVector expected_or;
+      TernaryVector expected_xor;
+      for (int64_t i = 0; i < 3; ++i) {
+        expected_and.push_back(ternary_ops::And(lhs[i], rhs[i]));
+        expected_or.push_back(ternary_ops::Or(lhs[i], rhs[i]));
+        expected_xor.push_back(
+            ternary_ops::IsKnown(lhs[i]) && ternary_ops::IsKnown(rhs[i])
+                ? (lhs[i] == rhs[i] ? TernaryValue::kKnownZero
+                                    : TernaryValue::kKnownOne)
+                : TernaryValue::kUnknown);
+      }
+      EXPECT_EQ(ternary_ops::And(packed_lhs, packed_rhs).ToTernary(),
+                expected_and);
+      EXPECT_EQ(ternary_ops::Or(packed_lhs, packed_rhs).ToTernary(),
+                expected_or);
+      EXPECT_EQ(ternary_ops::Xor(packed_lhs, packed_rhs).ToTernary(),
+                expected_xor);
+    }
+  }
+}
+
+TEST(PackedTernary, ArithmeticIsExact) {
+  // Add and the comparisons give the most precise answer possible; check them
+  // against every realization of the operands.
+  for (const TernaryVector& lhs : AllTernaryVectors(3)) {
+    for (const TernaryVector& rhs : AllTernaryVectors(3)) {
+      std::optional<TernaryVector> sum;
+      std::optional<TernaryValue> eq;
+      std::optional<TernaryValue> ult;
+      auto merge = [](std::optional<TernaryValue>& acc, bool value) {
+        TernaryValue t =
+            value ? TernaryValue::kKnownOne : TernaryValue::kKnownZero;
+        acc = (!acc.has_value() || *acc == t) ? t : TernaryValue::kUnknown;
+      };
+      for (const Bits& a : ternary_ops::AllBitsValues(lhs)) {
+        for (const Bits& b : ternary_ops::AllBitsValues(rhs)) {
+          TernaryVector s = ternary_ops::BitsToTernary(bits_ops::Add(a, b));
+          if (sum.has_value()) {
+            ternary_ops::UpdateWithIntersection(*sum, s);
+          } else {
+            sum = s;
+          }
+          merge(eq, a == b);
+          merge(ult, bits_ops::ULessThan(a, b));
+        }
+      }
+      PackedTernaryVector packed_lhs = PackedTernaryVector::FromTernary(lhs);
+      PackedTernaryVector packed_rhs = PackedTernaryVector::FromTernary(rhs);
+      EXPECT_EQ(ternary_ops::Add(packed_lhs, packed_rhs).ToTernary(), *sum)
+          << ToString(lhs) << " + " << ToString(rhs);
+      EXPECT_EQ(ternary_ops::Eq(packed_lhs, packed_rhs), *eq)
+          << ToString(lhs) << " == " << ToString(rhs);
+      EXPECT_EQ(ternary_ops::ULt(packed_lhs, packed_rhs), *ult)
+          << ToString(lhs) << " < " << ToString(rhs);
+    }
+  }
+}
+
+TEST(PackedTernary, AddCarriesAcrossWords) {
+  // 0x0..0_FFFF_FFFF_FFFF_FFFX + 1: the carry out of the low word depends on
+  // the unknown bit, so bit 64 of the sum is unknown but everything above it
+  // is known zero.
+  TernaryVector lhs = ternary_ops::BitsToTernary(
+      bits_ops::ZeroExtend(UBits(std::numeric_limits<uint64_t>::max(), 64),
+                           128));
+  lhs[0] = TernaryValue::kUnknown;
+  TernaryVector result =
+      ternary_ops::Add(PackedTernaryVector::FromTernary(lhs),
+                       PackedTernaryVector::FromBits(UBits(1, 128)))
+          .ToTernary();
+  EXPECT_EQ(result[0], TernaryValue::kUnknown);
+  EXPECT_EQ(result[63], TernaryValue::kUnknown);
+  EXPECT_EQ(result[64], TernaryValue::kUnknown);
+  EXPECT_EQ(result[65], TernaryValue::kKnownZero);
+
+  lhs[0] = TernaryValue::kKnownOne;
+  EXPECT_EQ(ternary_ops::Add(PackedTernaryVector::FromTernary(lhs),
+                             PackedTernaryVector::FromBits(UBits(1, 128)))
+                .ToTernary(),
+            ternary_ops::BitsToTernary(bits_ops::ShiftLeftLogical(
+                UBits(1, 128), 64)));
+}
+
 MATCHER_P(ToVector, m,
           testing::DescribeMatcher<std::vector<Bits>>(m, negation)) {
   return testing::ExplainMatchResult(
@@ -32,7 +32,9 @@
 
 namespace xls {
 
-std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
+namespace {
+
+std::vector<Node*> ComputeReverseTopoSort(FunctionBase* f) {
   // For topological traversal we only add nodes to the order when all of its
   // users have been scheduled.
   //
@@ -155,6 +157,12 @@ std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
   return ordered;
 }
 
+}  // namespace
+
+std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
+  return f->CachedReverseTopoSort(ComputeReverseTopoSort);
+}
+
 std::vector<Node*> TopoSort(FunctionBase* f) {
   std::vector<Node*> ordered = ReverseTopoSort(f);
   std::reverse(ordered.begin(), ordered.end());
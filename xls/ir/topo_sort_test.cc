@@ -22,6 +22,7 @@
 
 #include "benchmark/benchmark.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/benchmark_support.h"
 #include "xls/ir/bits.h"
@@ -288,6 +289,60 @@ TEST(NodeIteratorTest, RpoVsTopo) {
 
 // LINT.ThenChange(//xls/ir/block_elaboration_test.cc)
 
+// Checks that `order` contains every node of `f` exactly once with each node
+// after its operands.
+void ExpectValidTopoOrder(FunctionBase* f, const std::vector<Node*>& order) {
+  EXPECT_EQ(order.size(), f->node_count());
+  absl::flat_hash_set<Node*> seen;
+  for (Node* node : order) {
+    for (Node* operand : node->operands()) {
+      EXPECT_TRUE(seen.contains(operand))
+          << node->GetName() << " precedes operand " << operand->GetName();
+    }
+    EXPECT_TRUE(seen.insert(node).second) << node->GetName();
+  }
+}
+
+TEST(NodeIteratorTest, CachedOrderTracksMutations) {
+  std::string program = R"(
+  fn f(x: bits[32]) -> bits[32] {
+    literal.1: bits[32] = literal(value=1)
+    neg.2: bits[32] = neg(x)
+    ret add.3: bits[32] = add(neg.2, literal.1)
+  })";
+
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, Parser::ParseFunction(program, &p));
+  ExpectValidTopoOrder(f, TopoSort(f));
+  EXPECT_EQ(TopoSort(f), TopoSort(f));
+
+  // Adding a node.
+  Node* add = f->return_value();
+  XLS_ASSERT_OK_AND_ASSIGN(Node * x, f->GetNode("x"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * not_x,
+                           f->MakeNode<UnOp>(SourceInfo(), x, Op::kNot));
+  ExpectValidTopoOrder(f, TopoSort(f));
+
+  // Rewiring an operand.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * literal, f->GetNode("literal.1"));
+  XLS_ASSERT_OK(literal->ReplaceUsesWith(not_x));
+  ExpectValidTopoOrder(f, TopoSort(f));
+
+  // Removing a node with no operands.
+  XLS_ASSERT_OK(f->RemoveNode(literal));
+  ExpectValidTopoOrder(f, TopoSort(f));
+
+  // Changing the return value.
+  XLS_ASSERT_OK(f->set_return_value(not_x));
+  std::vector<Node*> order = TopoSort(f);
+  ExpectValidTopoOrder(f, order);
+  EXPECT_EQ(TopoSort(f), order);
+
+  // Removing the old return value.
+  XLS_ASSERT_OK(f->RemoveNode(add));
+  ExpectValidTopoOrder(f, TopoSort(f));
+}
+
 void BM_TopoSortBinaryTree(benchmark::State& state) {
   std::unique_ptr<VerifiedPackage> p =
       std::make_unique<VerifiedPackage>("balanced_tree_pkg");
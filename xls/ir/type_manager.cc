@@ -14,17 +14,21 @@
 
 #include "xls/ir/type_manager.h"
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/type.h"
@@ -32,44 +36,117 @@
 #include "xls/ir/xls_type.pb.h"
 
 namespace xls {
+namespace {
 
-TypeManager::TypeManager() { owned_types_.insert(&token_type_); }
-BitsType* TypeManager::GetBitsType(int64_t bit_count) {
-  if (bit_count_to_type_.find(bit_count) != bit_count_to_type_.end()) {
-    return &bit_count_to_type_.at(bit_count);
+// Holds `mutex` in shared mode for the lifetime of the object if `mutex` is
+// not null. The shared-mode counterpart of absl::MutexLockMaybe.
+class ReaderMutexLockMaybe {
+ public:
+  explicit ReaderMutexLockMaybe(absl::Mutex* mutex) : mutex_(mutex) {
+    if (mutex_ != nullptr) {
+      mutex_->ReaderLock();
+    }
   }
-  auto it = bit_count_to_type_.emplace(bit_count, BitsType(bit_count));
-  BitsType* new_type = &(it.first->second);
-  owned_types_.insert(new_type);
-  return new_type;
+  ~ReaderMutexLockMaybe() {
+    if (mutex_ != nullptr) {
+      mutex_->ReaderUnlock();
+    }
+  }
+
+  ReaderMutexLockMaybe(const ReaderMutexLockMaybe&) = delete;
+  ReaderMutexLockMaybe& operator=(const ReaderMutexLockMaybe&) = delete;
+
+ private:
+  absl::Mutex* mutex_;
+};
+
+}  // namespace
+
+TypeManager::TypeManager() { AddOwnedType(&token_type_); }
+
+bool TypeManager::IsOwnedType(const Type* type) const {
+  const OwnedTypesShard& shard =
+      owned_types_[ShardIndex(absl::HashOf(type))];
+  ReaderMutexLockMaybe lock(concurrent() ? &shard.mutex : nullptr);
+  return shard.types.contains(type);
 }
 
-ArrayType* TypeManager::GetArrayType(int64_t size, Type* element_type) {
-  ArrayKey key{size, element_type};
-  if (array_types_.find(key) != array_types_.end()) {
-    return &array_types_.at(key);
-  }
-  CHECK(IsOwnedType(element_type))
-      << "Type is not owned by package: " << *element_type;
-  auto it = array_types_.emplace(key, ArrayType(size, element_type));
-  ArrayType* new_type = &(it.first->second);
-  owned_types_.insert(new_type);
+bool TypeManager::IsOwnedFunctionType(
+    const FunctionType* function_type) const {
+  ReaderMutexLockMaybe lock(concurrent() ? &function_mutex_ : nullptr);
+  return owned_function_types_.contains(function_type);
+}
+
+void TypeManager::BeginConcurrentAccess() {
+  concurrent_sections_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TypeManager::EndConcurrentAccess() {
+  int64_t previous =
+      concurrent_sections_.fetch_sub(1, std::memory_order_relaxed);
+  CHECK_GT(previous, 0) << "EndConcurrentAccess without BeginConcurrentAccess";
+}
+
+void TypeManager::AddOwnedType(const Type* type) {
+  OwnedTypesShard& shard = owned_types_[ShardIndex(absl::HashOf(type))];
+  absl::MutexLockMaybe lock(concurrent() ? &shard.mutex : nullptr);
+  shard.types.insert(type);
+}
+
+template <typename Key, typename T, typename MakeFn>
+T* TypeManager::Intern(ShardedTable<Key, T>& table, const Key& key,
+                       MakeFn make) {
+  Shard<Key, T>& shard = table[ShardIndex(absl::HashOf(key))];
+  absl::Mutex* mutex = concurrent() ? &shard.mutex : nullptr;
+  {
+    ReaderMutexLockMaybe lock(mutex);
+    if (auto it = shard.types.find(key); it != shard.types.end()) {
+      return &it->second;
+    }
+  }
+  absl::MutexLockMaybe lock(mutex);
+  if (auto it = shard.types.find(key); it != shard.types.end()) {
+    return &it->second;
+  }
+  T* new_type = &shard.types.emplace(key, make()).first->second;
+  // Record ownership before the type becomes visible to other threads.
+  AddOwnedType(new_type);
   return new_type;
 }
 
-TupleType* TypeManager::GetTupleType(absl::Span<Type* const> element_types) {
-  TypeVec key(element_types.begin(), element_types.end());
-  if (tuple_types_.find(key) != tuple_types_.end()) {
-    return &tuple_types_.at(key);
+BitsType* TypeManager::GetBitsType(int64_t bit_count) {
+  const bool cached = bit_count >= 0 && bit_count < kCachedBitsTypeCount;
+  if (cached) {
+    if (BitsType* type =
+            cached_bits_types_[bit_count].load(std::memory_order_acquire)) {
+      return type;
+    }
+  }
+  BitsType* type =
+      Intern(bits_types_, bit_count, [&] { return BitsType(bit_count); });
+  if (cached) {
+    cached_bits_types_[bit_count].store(type, std::memory_order_release);
   }
-  for (const Type* element_type : element_types) {
+  return type;
+}
+
+ArrayType* TypeManager::GetArrayType(int64_t size, Type* element_type) {
+  return Intern(array_types_, ArrayKey{size, element_type}, [&] {
     CHECK(IsOwnedType(element_type))
         << "Type is not owned by package: " << *element_type;
-  }
-  auto it = tuple_types_.emplace(key, TupleType(element_types));
-  TupleType* new_type = &(it.first->second);
-  owned_types_.insert(new_type);
-  return new_type;
+    return ArrayType(size, element_type);
+  });
+}
+
+TupleType* TypeManager::GetTupleType(absl::Span<Type* const> element_types) {
+  return Intern(
+      tuple_types_, TypeVec(element_types.begin(), element_types.end()), [&] {
+        for (const Type* element_type : element_types) {
+          CHECK(IsOwnedType(element_type))
+              << "Type is not owned by package: " << *element_type;
+        }
+        return TupleType(element_types);
+      });
 }
 
 TokenType* TypeManager::GetTokenType() { return &token_type_; }
@@ -111,8 +188,9 @@ absl::StatusOr<Type*> TypeManager::MapTypeFromOtherArena(
 FunctionType* TypeManager::GetFunctionType(absl::Span<Type* const> args_types,
                                          Type* return_type) {
   std::string key = FunctionType(args_types, return_type).ToString();
-  if (function_types_.find(key) != function_types_.end()) {
-    return &function_types_.at(key);
+  absl::MutexLockMaybe lock(concurrent() ? &function_mutex_ : nullptr);
+  if (auto it = function_types_.find(key); it != function_types_.end()) {
+    return &it->second;
   }
   for (Type* t : args_types) {
     CHECK(IsOwnedType(t)) << "Parameter type is not owned by package: "
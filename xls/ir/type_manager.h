@@ -15,6 +15,9 @@
 #ifndef XLS_IR_TYPE_MANAGER_H_
 #define XLS_IR_TYPE_MANAGER_H_
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <utility>
@@ -23,12 +26,22 @@
 #include "absl/container/inlined_vector.h"
 #include "absl/container/node_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 
 namespace xls {
 
+// Owns the types of a package and uniquifies them so types may be compared by
+// pointer.
+//
+// Types are usually only looked up by one thread at a time, so by default no
+// locks are taken. Code which uses the type manager from several threads at
+// once (e.g. passes transforming function bases concurrently) must enable
+// locking by bracketing that section with BeginConcurrentAccess and
+// EndConcurrentAccess. While enabled, looking up an existing type does not
+// block on other threads looking up or creating types.
 class TypeManager {
  public:
   explicit TypeManager();
@@ -37,13 +50,16 @@ class TypeManager {
   TypeManager(const TypeManager&) = delete;
   TypeManager& operator=(const TypeManager&) = delete;
   // Returns whether the given type is one of the types owned by this package.
-  bool IsOwnedType(const Type* type) const {
-    return owned_types_.find(type) != owned_types_.end();
-  }
-  bool IsOwnedFunctionType(const FunctionType* function_type) const {
-    return owned_function_types_.find(function_type) !=
-           owned_function_types_.end();
-  }
+  bool IsOwnedType(const Type* type) const;
+  bool IsOwnedFunctionType(const FunctionType* function_type) const;
+
+  // Enables (respectively disables) locking of the type tables so that the
+  // type manager may be used by several threads at once. Calls may be nested;
+  // locking stays enabled until the outermost section ends. The outermost
+  // calls must be made while no other thread is using the type manager, e.g.
+  // before worker threads are started and after they are joined.
+  void BeginConcurrentAccess();
+  void EndConcurrentAccess();
 
   BitsType* GetBitsType(int64_t bit_count);
   ArrayType* GetArrayType(int64_t size, Type* element_type);
@@ -63,30 +79,80 @@ class TypeManager {
   Type* GetTypeForValue(const Value& value);
 
  private:
-  // Set of owned types in this package.
-  absl::flat_hash_set<const Type*> owned_types_;
+  // The interning tables are split into shards, each guarded by its own mutex
+  // while concurrent access is enabled, so that passes creating types
+  // concurrently rarely contend. Lookups of existing types (by far the common
+  // case) only take a reader lock.
+  static constexpr int64_t kShardCount = 16;
+
+  // Bits types narrower than this are additionally cached in an array which is
+  // read without locking.
+  static constexpr int64_t kCachedBitsTypeCount = 1024;
+
+  // One shard of an interning table mapping keys to the owned types. Uses
+  // node_hash_map for pointer stability. `types` is guarded by `mutex` while
+  // concurrent access is enabled.
+  template <typename Key, typename T>
+  struct Shard {
+    mutable absl::Mutex mutex;
+    absl::node_hash_map<Key, T> types;
+  };
+  template <typename Key, typename T>
+  using ShardedTable = std::array<Shard<Key, T>, kShardCount>;
+
+  struct OwnedTypesShard {
+    mutable absl::Mutex mutex;
+    absl::flat_hash_set<const Type*> types;
+  };
+
+  static int64_t ShardIndex(size_t hash) {
+    // The low bits of the hash are used within the shard's table.
+    return (hash >> 32) % kShardCount;
+  }
 
-  // Set of owned function types in this package.
-  absl::flat_hash_set<const FunctionType*> owned_function_types_;
+  // Returns the type for `key` in `table`, creating it with `make()` if there
+  // is none.
+  template <typename Key, typename T, typename MakeFn>
+  T* Intern(ShardedTable<Key, T>& table, const Key& key, MakeFn make);
 
-  // Mapping from bit count to the owned "bits" type with that many bits. Use
-  // node_hash_map for pointer stability.
-  absl::node_hash_map<int64_t, BitsType> bit_count_to_type_;
+  void AddOwnedType(const Type* type);
+
+  // Returns whether the type tables must be locked.
+  bool concurrent() const {
+    return concurrent_sections_.load(std::memory_order_relaxed) > 0;
+  }
+
+  // Number of open BeginConcurrentAccess sections.
+  std::atomic<int64_t> concurrent_sections_ = 0;
+
+  // Set of owned types in this package, sharded by address.
+  std::array<OwnedTypesShard, kShardCount> owned_types_;
+
+  // Bits types indexed by bit count; null until first requested.
+  std::array<std::atomic<BitsType*>, kCachedBitsTypeCount> cached_bits_types_;
+
+  // Mapping from bit count to the owned "bits" type with that many bits.
+  ShardedTable<int64_t, BitsType> bits_types_;
 
   // Mapping from the size and element type of an array type to the owned
-  // ArrayType. Use node_hash_map for pointer stability.
+  // ArrayType.
   using ArrayKey = std::pair<int64_t, const Type*>;
-  absl::node_hash_map<ArrayKey, ArrayType> array_types_;
+  ShardedTable<ArrayKey, ArrayType> array_types_;
 
   // Mapping from elements to the owned tuple type.
-  //
-  // Uses node_hash_map for pointer stability.
   using TypeVec = absl::InlinedVector<const Type*, 4>;
-  absl::node_hash_map<TypeVec, TupleType> tuple_types_;
+  ShardedTable<TypeVec, TupleType> tuple_types_;
 
   // Owned token type.
   TokenType token_type_;
 
+  // Function types are rarely created, so they are kept in a single table,
+  // guarded by `function_mutex_` while concurrent access is enabled.
+  mutable absl::Mutex function_mutex_;
+
+  // Set of owned function types in this package.
+  absl::flat_hash_set<const FunctionType*> owned_function_types_;
+
   // Mapping from Type:ToString to the owned function type. Use
   // node_hash_map for pointer stability.
   absl::node_hash_map<std::string, FunctionType> function_types_;
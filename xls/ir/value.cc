@@ -16,12 +16,16 @@
 
 #include <cstdint>
 #include <cstring>
+#include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/call_once.h"
+#include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -32,6 +36,7 @@
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/ir/bit_push_buffer.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
@@ -41,6 +46,129 @@
 
 namespace xls {
 
+struct Value::PackedArray {
+  int64_t element_bit_count;
+  int64_t size;
+  Bits bits;
+
+  // Boxed elements, only materialized if PackedElements() is called.
+  mutable absl::once_flag boxed_once;
+  mutable std::vector<Value> boxed;
+};
+
+/* static */ absl::StatusOr<Value> Value::PackedBitsArray(
+    absl::Span<const Bits> elements) {
+  if (elements.empty()) {
+    return absl::UnimplementedError("Empty array Values are not supported.");
+  }
+  const int64_t element_bit_count = elements.front().bit_count();
+  InlineBitmap bitmap(element_bit_count * elements.size());
+  for (int64_t i = 0; i < elements.size(); ++i) {
+    const Bits& element = elements[i];
+    XLS_RET_CHECK_EQ(element.bit_count(), element_bit_count);
+    const int64_t start = i * element_bit_count;
+    if (element_bit_count <= 64) {
+      if (element_bit_count == 0) {
+        continue;
+      }
+      // Write the element a word at a time; it spans at most two words.
+      const uint64_t word = element.bitmap().GetWord(0);
+      const int64_t wordno = start / 64;
+      const int64_t shift = start % 64;
+      bitmap.SetWord(wordno, bitmap.GetWord(wordno) | (word << shift));
+      if (shift + element_bit_count > 64) {
+        bitmap.SetWord(wordno + 1,
+                       bitmap.GetWord(wordno + 1) | (word >> (64 - shift)));
+      }
+      continue;
+    }
+    for (int64_t b = 0; b < element_bit_count; ++b) {
+      bitmap.Set(start + b, element.Get(b));
+    }
+  }
+  return PackedBitsArrayFromBits(Bits::FromBitmap(std::move(bitmap)),
+                                 elements.size());
+}
+
+/* static */ absl::StatusOr<Value> Value::PackedBitsArrayFromBits(
+    Bits packed, int64_t size) {
+  if (size == 0) {
+    return absl::UnimplementedError("Empty array Values are not supported.");
+  }
+  XLS_RET_CHECK_GT(size, 0);
+  XLS_RET_CHECK_EQ(packed.bit_count() % size, 0);
+  // PackedArray is neither copyable nor movable (because of its once_flag) so
+  // it is filled in place.
+  auto array = std::make_shared<PackedArray>();
+  array->element_bit_count = packed.bit_count() / size;
+  array->size = size;
+  array->bits = std::move(packed);
+  Value result;
+  result.kind_ = ValueKind::kArray;
+  result.payload_ = PackedStorage(std::move(array));
+  return result;
+}
+
+const Bits& Value::packed_bits() const {
+  return std::get<PackedStorage>(payload_)->bits;
+}
+
+int64_t Value::packed_element_bit_count() const {
+  return std::get<PackedStorage>(payload_)->element_bit_count;
+}
+
+int64_t Value::size() const {
+  if (auto* packed = std::get_if<PackedStorage>(&payload_)) {
+    return (*packed)->size;
+  }
+  return std::get<ElementStorage>(payload_)->size();
+}
+
+Bits Value::GetBitsElement(int64_t i) const {
+  auto* packed = std::get_if<PackedStorage>(&payload_);
+  if (packed == nullptr) {
+    return element(i).bits();
+  }
+  const PackedArray& array = **packed;
+  CHECK(i >= 0 && i < array.size)
+      << "index " << i << " out of bounds for array of size " << array.size;
+  const int64_t width = array.element_bit_count;
+  const int64_t start = i * width;
+  if (width == 0 || width > 64) {
+    return array.bits.Slice(start, width);
+  }
+  // Read the element a word at a time; it spans at most two words.
+  const InlineBitmap& bitmap = array.bits.bitmap();
+  const int64_t wordno = start / 64;
+  const int64_t shift = start % 64;
+  uint64_t word = bitmap.GetWord(wordno) >> shift;
+  if (shift + width > 64) {
+    word |= bitmap.GetWord(wordno + 1) << (64 - shift);
+  }
+  return Bits::FromBitmap(InlineBitmap::FromWord(word, width));
+}
+
+absl::Span<const Value> Value::PackedElements() const {
+  const PackedArray& array = *std::get<PackedStorage>(payload_);
+  absl::call_once(array.boxed_once, [&] {
+    array.boxed.reserve(array.size);
+    for (int64_t i = 0; i < array.size; ++i) {
+      array.boxed.push_back(Value(GetBitsElement(i)));
+    }
+  });
+  return array.boxed;
+}
+
+std::optional<int64_t> Value::GetBitsElementBitCount() const {
+  if (IsPackedBitsArray()) {
+    return packed_element_bit_count();
+  }
+  if (IsArray() && !empty() && element(0).IsBits()) {
+    return element(0).bits().bit_count();
+  }
+  return std::nullopt;
+}
+
 /* static */ absl::StatusOr<Value> Value::Array(
     absl::Span<const Value> elements) {
   if (elements.empty()) {
@@ -168,6 +296,9 @@ int64_t Value::GetFlatBitCount() const {
     if (empty()) {
       return 0;
     }
+    if (IsPackedBitsArray()) {
+      return packed_bits().bit_count();
+    }
     return size() * element(0).GetFlatBitCount();
   }
   LOG(FATAL) << "Invalid value kind: " << kind();
@@ -177,6 +308,9 @@ bool Value::IsAllZeros() const {
   if (kind() == ValueKind::kBits) {
     return bits().IsZero();
   }
+  if (IsPackedBitsArray()) {
+    return packed_bits().IsZero();
+  }
   if (kind() == ValueKind::kTuple || kind() == ValueKind::kArray) {
     for (const Value& e : elements()) {
       if (!e.IsAllZeros()) {
@@ -193,6 +327,9 @@ bool Value::IsAllOnes() const {
   if (kind() == ValueKind::kBits) {
     return bits().IsAllOnes();
   }
+  if (IsPackedBitsArray()) {
+    return packed_bits().IsAllOnes();
+  }
   if (kind() == ValueKind::kTuple || kind() == ValueKind::kArray) {
     for (const Value& e : elements()) {
       if (!e.IsAllOnes()) {
@@ -221,6 +358,15 @@ std::string Value::ToString(FormatPreference preference) const {
                         }),
           ")");
     case ValueKind::kArray:
+      if (IsPackedBitsArray()) {
+        std::string result = "[";
+        for (int64_t i = 0; i < size(); ++i) {
+          absl::StrAppendFormat(&result, "%sbits[%d]:%s", i == 0 ? "" : ", ",
+                                packed_element_bit_count(),
+                                BitsToString(GetBitsElement(i), preference));
+        }
+        return absl::StrCat(result, "]");
+      }
       return absl::StrCat(
           "[",
           absl::StrJoin(elements(), ", ",
@@ -241,6 +387,12 @@ void Value::FlattenTo(BitPushBuffer* buffer) const {
       return;
     case ValueKind::kTuple:
     case ValueKind::kArray:
+      if (IsPackedBitsArray()) {
+        for (int64_t i = 0; i < size(); ++i) {
+          GetBitsElement(i).FlattenTo(buffer);
+        }
+        return;
+      }
       for (const Value& element : elements()) {
         element.FlattenTo(buffer);
       }
@@ -253,7 +405,7 @@ void Value::FlattenTo(BitPushBuffer* buffer) const {
 }
 
 absl::StatusOr<std::vector<Value>> Value::GetElements() const {
-  if (!std::holds_alternative<std::vector<Value>>(payload_)) {
+  if (!HasElements()) {
     return absl::InvalidArgumentError("Value does not hold elements.");
   }
   return std::vector<Value>(elements().begin(), elements().end());
@@ -274,6 +426,14 @@ std::string Value::ToHumanString(FormatPreference preference) const {
     case ValueKind::kBits:
       return BitsToString(bits(), preference);
     case ValueKind::kArray:
+      if (IsPackedBitsArray()) {
+        std::string result = "[";
+        for (int64_t i = 0; i < size(); ++i) {
+          absl::StrAppend(&result, i == 0 ? "" : ", ",
+                          BitsToString(GetBitsElement(i), preference));
+        }
+        return absl::StrCat(result, "]");
+      }
       return absl::StrCat("[",
                           absl::StrJoin(elements(), ", ",
                                         [&](std::string* out, const Value& v) {
@@ -313,7 +473,13 @@ bool Value::SameTypeAs(const Value& other) const {
       }
       return true;
     case ValueKind::kArray: {
-      return size() == other.size() && element(0).SameTypeAs(other.element(0));
+      if (size() != other.size()) {
+        return false;
+      }
+      if (IsPackedBitsArray() || other.IsPackedBitsArray()) {
+        return GetBitsElementBitCount() == other.GetBitsElementBitCount();
+      }
+      return element(0).SameTypeAs(other.element(0));
     }
     case ValueKind::kToken:
       return true;
@@ -343,6 +509,13 @@ absl::StatusOr<ValueProto> Value::AsProto() const {
     }
     case ValueKind::kArray: {
       ValueProto::Array* array = v.mutable_array();
+      if (IsPackedBitsArray()) {
+        for (int64_t i = 0; i < size(); ++i) {
+          XLS_ASSIGN_OR_RETURN(*array->add_elements(),
+                               Value(GetBitsElement(i)).AsProto());
+        }
+        break;
+      }
       for (const Value& e : elements()) {
         XLS_ASSIGN_OR_RETURN(*array->add_elements(), e.AsProto());
       }
@@ -439,12 +612,18 @@ absl::StatusOr<TypeProto> Value::TypeAsProto() const {
       }
       break;
     case ValueKind::kArray: {
-      if (elements().empty()) {
+      if (empty()) {
         return absl::InternalError(
             "Cannot determine type of empty array value");
       }
       proto.set_type_enum(TypeProto::ARRAY);
       proto.set_array_size(size());
+      if (IsPackedBitsArray()) {
+        proto.mutable_array_element()->set_type_enum(TypeProto::BITS);
+        proto.mutable_array_element()->set_bit_count(
+            packed_element_bit_count());
+        break;
+      }
       XLS_ASSIGN_OR_RETURN(*proto.mutable_array_element(),
                            elements().front().TypeAsProto());
       break;
@@ -468,10 +647,29 @@ bool Value::operator==(const Value& other) const {
   }
 
   // All non-Bits types are container types -- should have a size attribute.
+  // Copies of the same value share their elements.
+  if (payload_ == other.payload_) {
+    return true;
+  }
   if (size() != other.size()) {
     return false;
   }
 
+  if (IsPackedBitsArray() || other.IsPackedBitsArray()) {
+    if (!SameTypeAs(other)) {
+      return false;
+    }
+    if (IsPackedBitsArray() && other.IsPackedBitsArray()) {
+      return packed_bits() == other.packed_bits();
+    }
+    for (int64_t i = 0; i < size(); ++i) {
+      if (GetBitsElement(i) != other.GetBitsElement(i)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   return absl::c_equal(elements(), other.elements());
 }
 
@@ -17,6 +17,8 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -42,8 +44,9 @@ enum class ValueKind {
   kTuple,
 
   // Arrays must be homogeneous in their elements, and may choose to use a
-  // more efficient storage mechanism as a result. For now we always used the
-  // boxed Value type, though.
+  // more efficient storage mechanism as a result: one-dimensional arrays of
+  // bits may be stored packed (see Value::PackedBitsArray), otherwise elements
+  // are boxed Values.
   kArray,
 
   kToken
@@ -60,6 +63,11 @@ inline std::ostream& operator<<(std::ostream& os, ValueKind kind) {
 // values, or arrays or values. Arrays are represented similarly to tuples, but
 // are monomorphic and potentially multi-dimensional.
 //
+// Values are immutable. The elements of tuples and arrays are held in storage
+// which is shared between copies, so copying an aggregate value (e.g. into a
+// channel queue or between interpreter nodes) is constant time regardless of
+// its size.
+//
 // TODO(leary): 2019-04-04 Arrays are not currently multi-dimensional, we had
 // some discussion around this, maybe they should be?
 class Value {
@@ -68,7 +76,7 @@ class Value {
     return Value(ValueKind::kTuple, elements);
   }
   static Value TupleOwned(std::vector<Value>&& elements) {
-    return Value(ValueKind::kTuple, elements);
+    return Value(ValueKind::kTuple, std::move(elements));
   }
 
   // All members of "elements" must be of the same type, or an error status will
@@ -86,6 +94,17 @@ class Value {
   static absl::StatusOr<Value> SBits2DArray(
       absl::Span<const absl::Span<const int64_t>> elements, int64_t bit_count);
 
+  // Returns an array of the given bits values, which must all have the same bit
+  // count, with the elements packed into a single contiguous bit buffer rather
+  // than boxed individually. This is far more compact for large constant
+  // arrays such as lookup tables or ROM contents; see IsPackedBitsArray().
+  static absl::StatusOr<Value> PackedBitsArray(absl::Span<const Bits> elements);
+
+  // As above, but takes the already packed bits of the `size` elements (element
+  // i in bits [i * w, (i + 1) * w) where w is `packed.bit_count() / size`).
+  static absl::StatusOr<Value> PackedBitsArrayFromBits(Bits packed,
+                                                        int64_t size);
+
   // As above, but as a precondition all elements must be known to be of the
   // same type.
   //
@@ -137,6 +156,23 @@ class Value {
   bool IsTuple() const { return kind_ == ValueKind::kTuple; }
   bool IsArray() const { return kind_ == ValueKind::kArray; }
   bool IsBits() const { return std::holds_alternative<Bits>(payload_); }
+  bool HasElements() const {
+    return std::holds_alternative<ElementStorage>(payload_) ||
+           std::holds_alternative<PackedStorage>(payload_);
+  }
+
+  // Returns whether this is an array of bits whose elements are stored packed
+  // (see PackedBitsArray()). Packed arrays behave like any other array but
+  // their elements are boxed, once, only when elements() or element() is first
+  // called; code handling large constant arrays should use GetBitsElement(),
+  // packed_bits() and packed_element_bit_count() instead.
+  bool IsPackedBitsArray() const {
+    return std::holds_alternative<PackedStorage>(payload_);
+  }
+  // The elements of a packed bits array: element i occupies bits
+  // [i * packed_element_bit_count(), (i + 1) * packed_element_bit_count()).
+  const Bits& packed_bits() const;
+  int64_t packed_element_bit_count() const;
   bool IsToken() const { return kind_ == ValueKind::kToken; }
   const Bits& bits() const { return std::get<Bits>(payload_); }
   absl::StatusOr<Bits> GetBitsWithStatus() const;
@@ -144,11 +180,18 @@ class Value {
   absl::StatusOr<std::vector<Value>> GetElements() const;
 
   absl::Span<const Value> elements() const {
-    return std::get<std::vector<Value>>(payload_);
+    if (auto* storage = std::get_if<ElementStorage>(&payload_)) {
+      return **storage;
+    }
+    return PackedElements();
   }
   const Value& element(int64_t i) const { return elements().at(i); }
-  int64_t size() const { return elements().size(); }
-  bool empty() const { return elements().empty(); }
+  int64_t size() const;
+  bool empty() const { return size() == 0; }
+
+  // Returns element i of an array of bits. Unlike element(), this does not box
+  // the elements of packed arrays.
+  Bits GetBitsElement(int64_t i) const;
 
   // Returns the total number of bits in this value.
   int64_t GetFlatBitCount() const;
@@ -189,16 +232,57 @@ class Value {
     absl::Format(&sink, "%s", v.ToString(FormatPreference::kDefault));
   }
 
+  // Consistent with operator==: packed and unpacked arrays with the same
+  // elements hash equally.
+  template <typename H>
+  friend H AbslHashValue(H h, const Value& v) {
+    h = H::combine(std::move(h), v.kind());
+    if (v.IsBits()) {
+      return H::combine(std::move(h), v.bits());
+    }
+    if (!v.HasElements()) {
+      return h;
+    }
+    if (v.IsPackedBitsArray()) {
+      for (int64_t i = 0; i < v.size(); ++i) {
+        h = H::combine(std::move(h), ValueKind::kBits, v.GetBitsElement(i));
+      }
+    } else {
+      for (const Value& element : v.elements()) {
+        h = H::combine(std::move(h), element);
+      }
+    }
+    return H::combine(std::move(h), v.size());
+  }
+
  private:
+  // Immutable element storage shared by copies of a tuple, array or token.
+  using ElementStorage = std::shared_ptr<const std::vector<Value>>;
+
+  // Storage of a packed bits array, also shared by copies; defined in
+  // value.cc.
+  struct PackedArray;
+  using PackedStorage = std::shared_ptr<const PackedArray>;
+
+  // Returns the (lazily boxed) elements of a packed bits array.
+  absl::Span<const Value> PackedElements() const;
+
+  // If this is an array of bits (packed or not), returns the bit count of its
+  // elements.
+  std::optional<int64_t> GetBitsElementBitCount() const;
+
   Value(ValueKind kind, absl::Span<const Value> elements)
       : kind_(kind),
-        payload_(std::vector<Value>(elements.begin(), elements.end())) {}
+        payload_(std::make_shared<const std::vector<Value>>(elements.begin(),
+                                                            elements.end())) {}
 
   Value(ValueKind kind, std::vector<Value>&& elements)
-      : kind_(kind), payload_(std::move(elements)) {}
+      : kind_(kind),
+        payload_(std::make_shared<const std::vector<Value>>(
+            std::move(elements))) {}
 
   ValueKind kind_;
-  std::variant<std::nullptr_t, std::vector<Value>, Bits> payload_;
+  std::variant<std::nullptr_t, ElementStorage, Bits, PackedStorage> payload_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Value& value) {
@@ -16,12 +16,14 @@
 
 #include <cstdint>
 #include <iterator>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "xls/common/status/ret_check.h"
@@ -145,7 +147,36 @@ absl::StatusOr<Value> ValueBuilder::Build() const {
   }
   XLS_RET_CHECK(IsTuple());
   XLS_ASSIGN_OR_RETURN(auto vals, BuildAll(std::get<TupleHolder>(my_value_).v));
-  return Value::Tuple(vals);
+  return Value::TupleOwned(std::move(vals));
+}
+
+absl::Status ValueBuilder::SetElement(int64_t index,
+                                      MaybeValueBuilder element) {
+  if (std::holds_alternative<Value>(my_value_)) {
+    const Value& value = std::get<Value>(my_value_);
+    if (!value.IsArray() && !value.IsTuple()) {
+      return absl::InvalidArgumentError(
+          "Cannot set an element of a non-aggregate value");
+    }
+    std::vector<MaybeValueBuilder> elements(value.elements().begin(),
+                                            value.elements().end());
+    if (value.IsArray()) {
+      my_value_ = ArrayHolder{.v = std::move(elements)};
+    } else {
+      my_value_ = TupleHolder{.v = std::move(elements)};
+    }
+  }
+  std::vector<MaybeValueBuilder>& elements =
+      IsArray() ? std::get<ArrayHolder>(my_value_).v
+                : std::get<TupleHolder>(my_value_).v;
+  if (index < 0 || index >= elements.size()) {
+    return absl::OutOfRangeError(
+        absl::StrFormat("Element index %d is out of range for an aggregate "
+                        "of %d elements",
+                        index, elements.size()));
+  }
+  elements[index] = std::move(element);
+  return absl::OkStatus();
 }
 
 }  // namespace xls
@@ -19,6 +19,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/ir/bits.h"
@@ -78,6 +79,14 @@ class ValueBuilder {
 
   absl::StatusOr<Value> Build() const;
 
+  // Replaces the element at `index` of this array or tuple. Values are
+  // immutable, so this is a copy-on-write update: if the builder holds an
+  // already-built aggregate Value, its elements are unpacked into the builder
+  // but continue to share their storage with the original, and only the path
+  // to the replaced element is copied by Build(). Type mismatches of array
+  // elements are reported by Build().
+  absl::Status SetElement(int64_t index, MaybeValueBuilder element);
+
   bool IsArray() const {
     return std::holds_alternative<ArrayHolder>(my_value_) ||
            (std::holds_alternative<Value>(my_value_) &&
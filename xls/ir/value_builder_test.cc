@@ -90,5 +90,32 @@ TEST(ValueBuilderTest, Tuple) {
   EXPECT_EQ(value.element(1).element(1), Value(UBits(4, 4)));
 }
 
+TEST(ValueBuilderTest, SetElementCopiesOnWrite) {
+  XLS_ASSERT_OK_AND_ASSIGN(Value inner, Value::UBitsArray({1, 2, 3}, 8));
+  Value original = Value::Tuple({inner, Value(UBits(7, 4))});
+
+  ValueBuilder builder(original);
+  XLS_ASSERT_OK(builder.SetElement(1, Value(UBits(9, 4))));
+  XLS_ASSERT_OK_AND_ASSIGN(Value updated, builder.Build());
+
+  EXPECT_EQ(updated, Value::Tuple({inner, Value(UBits(9, 4))}));
+  // The original is unchanged and the untouched element is shared.
+  EXPECT_EQ(original.element(1), Value(UBits(7, 4)));
+  EXPECT_EQ(updated.element(0).elements().data(), inner.elements().data());
+}
+
+TEST(ValueBuilderTest, SetElementErrors) {
+  ValueBuilder bits = ValueBuilder::Bits(UBits(1, 3));
+  EXPECT_THAT(bits.SetElement(0, Value(UBits(0, 3))),
+              status_testing::StatusIs(absl::StatusCode::kInvalidArgument));
+
+  ValueBuilder array = ValueBuilder::UBitsArray({1, 2}, 3);
+  EXPECT_THAT(array.SetElement(2, Value(UBits(0, 3))),
+              status_testing::StatusIs(absl::StatusCode::kOutOfRange));
+  XLS_ASSERT_OK(array.SetElement(1, Value(UBits(0, 5))));
+  EXPECT_THAT(array.Build(),
+              status_testing::StatusIs(absl::StatusCode::kInternal));
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,82 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/ir/value_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "absl/hash/hash.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+std::shared_ptr<const Value> ValuePool::Intern(const Value& value) {
+  const size_t hash = absl::HashOf(value);
+  // The low bits of the hash are used within the shard's table.
+  Shard& shard = shards_[(hash >> 32) % kShardCount];
+  const Key key{hash, &value};
+  {
+    absl::ReaderMutexLock lock(&shard.mutex);
+    if (auto it = shard.values.find(key); it != shard.values.end()) {
+      if (std::shared_ptr<const Value> pooled = it->second.lock()) {
+        return pooled;
+      }
+    }
+  }
+  absl::MutexLock lock(&shard.mutex);
+  auto it = shard.values.find(key);
+  if (it != shard.values.end()) {
+    if (std::shared_ptr<const Value> pooled = it->second.lock()) {
+      return pooled;
+    }
+    // The pooled value is being released; its key points at the dying value
+    // so replace the entry rather than just the weak reference.
+    shard.values.erase(it);
+  }
+  std::shared_ptr<const Value> pooled(
+      new Value(value), [shard = &shard, hash](const Value* v) {
+        Release(shard, hash, v);
+      });
+  shard.values.emplace(Key{hash, pooled.get()}, pooled);
+  return pooled;
+}
+
+/* static */ void ValuePool::Release(Shard* shard, size_t hash,
+                                     const Value* value) {
+  {
+    absl::MutexLock lock(&shard->mutex);
+    auto it = shard->values.find(Key{hash, value});
+    // The entry may already have been replaced by an equal value interned
+    // after the last reference to this one was dropped.
+    if (it != shard->values.end() && it->first.value == value) {
+      shard->values.erase(it);
+    }
+  }
+  delete value;
+}
+
+int64_t ValuePool::size() const {
+  int64_t size = 0;
+  for (const Shard& shard : shards_) {
+    absl::ReaderMutexLock lock(&shard.mutex);
+    size += shard.values.size();
+  }
+  return size;
+}
+
+}  // namespace xls
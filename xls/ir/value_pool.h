@@ -0,0 +1,81 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_IR_VALUE_POOL_H_
+#define XLS_IR_VALUE_POOL_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// Deduplicates the values held by the literals of a package, so that a value
+// which is materialized many times (large array constants in particular) is
+// stored once. Pooled values are reference counted and leave the pool when the
+// last reference to them is dropped, so removed literals do not keep their
+// values alive. Thread-safe.
+class ValuePool {
+ public:
+  ValuePool() = default;
+  ValuePool(const ValuePool&) = delete;
+  ValuePool& operator=(const ValuePool&) = delete;
+
+  // Returns the pooled value equal to `value`, adding a copy of `value` to the
+  // pool if there is none. The returned references must not outlive the pool.
+  std::shared_ptr<const Value> Intern(const Value& value);
+
+  // Returns the number of distinct values in the pool.
+  int64_t size() const;
+
+ private:
+  static constexpr int64_t kShardCount = 16;
+
+  // A pooled value and its (cached) hash; compares by value.
+  struct Key {
+    size_t hash;
+    const Value* value;
+
+    template <typename H>
+    friend H AbslHashValue(H h, const Key& key) {
+      return H::combine(std::move(h), key.hash);
+    }
+    bool operator==(const Key& other) const {
+      return hash == other.hash && *value == *other.value;
+    }
+  };
+
+  struct Shard {
+    mutable absl::Mutex mutex;
+    absl::flat_hash_map<Key, std::weak_ptr<const Value>> values
+        ABSL_GUARDED_BY(mutex);
+  };
+
+  // Called when the last reference to `value` is dropped.
+  static void Release(Shard* shard, size_t hash, const Value* value);
+
+  std::array<Shard, kShardCount> shards_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_VALUE_POOL_H_
@@ -0,0 +1,97 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/ir/value_pool.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xls/common/thread.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+TEST(ValuePoolTest, DeduplicatesEqualValues) {
+  ValuePool pool;
+  std::shared_ptr<const Value> a = pool.Intern(Value(UBits(42, 32)));
+  std::shared_ptr<const Value> b = pool.Intern(Value(UBits(42, 32)));
+  std::shared_ptr<const Value> c = pool.Intern(Value(UBits(42, 33)));
+  EXPECT_EQ(a.get(), b.get());
+  EXPECT_NE(a.get(), c.get());
+  EXPECT_EQ(*a, Value(UBits(42, 32)));
+  EXPECT_EQ(*c, Value(UBits(42, 33)));
+  EXPECT_EQ(pool.size(), 2);
+}
+
+TEST(ValuePoolTest, PackedAndBoxedArraysShareEntry) {
+  ValuePool pool;
+  std::shared_ptr<const Value> packed = pool.Intern(
+      Value::PackedBitsArray({UBits(1, 8), UBits(2, 8)}).value());
+  std::shared_ptr<const Value> boxed =
+      pool.Intern(Value::UBitsArray({1, 2}, /*bit_count=*/8).value());
+  EXPECT_EQ(packed.get(), boxed.get());
+  EXPECT_EQ(pool.size(), 1);
+}
+
+TEST(ValuePoolTest, ReleasedValuesLeavePool) {
+  ValuePool pool;
+  std::shared_ptr<const Value> a = pool.Intern(Value(UBits(1, 8)));
+  std::shared_ptr<const Value> b = pool.Intern(Value(UBits(2, 8)));
+  EXPECT_EQ(pool.size(), 2);
+  a.reset();
+  EXPECT_EQ(pool.size(), 1);
+  a = pool.Intern(Value(UBits(1, 8)));
+  EXPECT_EQ(*a, Value(UBits(1, 8)));
+  EXPECT_EQ(pool.size(), 2);
+  a.reset();
+  b.reset();
+  EXPECT_EQ(pool.size(), 0);
+}
+
+TEST(ValuePoolTest, ConcurrentIntern) {
+  constexpr int64_t kThreadCount = 8;
+  constexpr int64_t kValueCount = 256;
+  ValuePool pool;
+  std::vector<std::vector<std::shared_ptr<const Value>>> results(kThreadCount);
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t t = 0; t < kThreadCount; ++t) {
+      threads.push_back(std::make_unique<Thread>([&pool, &results, t]() {
+        for (int64_t round = 0; round < 4; ++round) {
+          results[t].clear();
+          for (int64_t i = 0; i < kValueCount; ++i) {
+            results[t].push_back(pool.Intern(Value(UBits(i, 16))));
+          }
+        }
+      }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  EXPECT_EQ(pool.size(), kValueCount);
+  for (int64_t t = 1; t < kThreadCount; ++t) {
+    for (int64_t i = 0; i < kValueCount; ++i) {
+      EXPECT_EQ(results[t][i].get(), results[0][i].get());
+    }
+  }
+}
+
+}  // namespace
+}  // namespace xls
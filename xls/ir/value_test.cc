@@ -16,16 +16,20 @@
 
 #include <cstdint>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "fuzztest/fuzztest.h"
+#include "absl/hash/hash_testing.h"
 #include "absl/status/status.h"
 #include "absl/types/span.h"
 #include "google/protobuf/text_format.h"
 #include "xls/common/proto_test_utils.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/xls_value.pb.h"
 
@@ -112,6 +116,104 @@ TEST(ValueTest, SameTypeAs) {
   EXPECT_FALSE(b1.SameTypeAs(token_a));
 }
 
+TEST(ValueTest, CopiesShareElements) {
+  std::vector<Value> elements;
+  for (int64_t i = 0; i < 1024; ++i) {
+    elements.push_back(Value(UBits(i, 32)));
+  }
+  Value array = Value::ArrayOwned(std::move(elements));
+  Value copy = array;
+  EXPECT_EQ(copy.elements().data(), array.elements().data());
+  EXPECT_EQ(copy, array);
+  EXPECT_EQ(copy.element(1000), Value(UBits(1000, 32)));
+
+  // A value built separately from equal elements compares equal too.
+  XLS_ASSERT_OK_AND_ASSIGN(Value rebuilt, Value::Array(array.elements()));
+  EXPECT_NE(rebuilt.elements().data(), array.elements().data());
+  EXPECT_EQ(rebuilt, array);
+
+  Value tuple = Value::Tuple({array, Value(UBits(1, 1))});
+  Value tuple_copy = tuple;
+  EXPECT_EQ(tuple_copy.element(0).elements().data(), array.elements().data());
+  EXPECT_NE(tuple_copy, Value::Tuple({array, Value(UBits(0, 1))}));
+}
+
+TEST(ValueTest, PackedBitsArray) {
+  for (int64_t bit_count : {1, 7, 63, 64, 65, 100}) {
+    std::vector<Bits> bits;
+    std::vector<Value> boxed;
+    for (int64_t i = 0; i < 37; ++i) {
+      Bits element =
+          bits_ops::ZeroExtend(UBits(i * 0x9e3779b97f4a7c15ULL, 64), 128)
+              .Slice(i % 5, bit_count);
+      bits.push_back(element);
+      boxed.push_back(Value(element));
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(Value packed, Value::PackedBitsArray(bits));
+    XLS_ASSERT_OK_AND_ASSIGN(Value expected, Value::Array(boxed));
+    EXPECT_TRUE(packed.IsPackedBitsArray());
+    EXPECT_FALSE(expected.IsPackedBitsArray());
+    EXPECT_EQ(packed.packed_element_bit_count(), bit_count);
+    EXPECT_EQ(packed.size(), 37);
+    EXPECT_EQ(packed.GetFlatBitCount(), 37 * bit_count);
+    EXPECT_TRUE(packed.SameTypeAs(expected));
+    EXPECT_EQ(packed.ToString(), expected.ToString());
+    EXPECT_EQ(packed.ToHumanString(), expected.ToHumanString());
+    for (int64_t i = 0; i < 37; ++i) {
+      EXPECT_EQ(packed.GetBitsElement(i), bits[i]) << i;
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(ValueProto packed_proto, packed.AsProto());
+    XLS_ASSERT_OK_AND_ASSIGN(ValueProto expected_proto, expected.AsProto());
+    EXPECT_THAT(packed_proto, EqualsProto(expected_proto));
+    EXPECT_EQ(packed, expected);
+    EXPECT_EQ(expected, packed);
+    // Boxing the elements does not change the value.
+    EXPECT_EQ(packed.elements(), expected.elements());
+    EXPECT_EQ(packed, expected);
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Value packed, Value::PackedBitsArray({UBits(1, 8), UBits(2, 8)}));
+  XLS_ASSERT_OK_AND_ASSIGN(Value other,
+                           Value::PackedBitsArray({UBits(1, 8), UBits(3, 8)}));
+  EXPECT_NE(packed, other);
+  EXPECT_NE(packed, Value::UBitsArray({1, 2}, 9).value());
+  EXPECT_FALSE(packed.SameTypeAs(Value::UBitsArray({1, 2}, 9).value()));
+  EXPECT_FALSE(Value::PackedBitsArray({UBits(1, 8), UBits(2, 9)}).ok());
+  EXPECT_FALSE(Value::PackedBitsArray({}).ok());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Value from_bits, Value::PackedBitsArrayFromBits(UBits(0x0201, 16), 2));
+  EXPECT_TRUE(from_bits.IsPackedBitsArray());
+  EXPECT_EQ(from_bits, packed);
+  EXPECT_FALSE(Value::PackedBitsArrayFromBits(UBits(0, 16), 3).ok());
+  EXPECT_FALSE(Value::PackedBitsArrayFromBits(Bits(), 0).ok());
+}
+
+TEST(ValueTest, Hash) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Value packed, Value::PackedBitsArray({UBits(1, 8), UBits(2, 8)}));
+  XLS_ASSERT_OK_AND_ASSIGN(Value boxed,
+                           Value::UBitsArray({1, 2}, /*bit_count=*/8));
+  XLS_ASSERT_OK_AND_ASSIGN(Value nested, Value::Array({packed, boxed}));
+  EXPECT_TRUE(absl::VerifyTypeImplementsAbslHashCorrectly({
+      Value(UBits(0, 0)),
+      Value(UBits(1, 8)),
+      Value(UBits(2, 8)),
+      Value(UBits(1, 9)),
+      Value::Token(),
+      Value::Tuple({}),
+      Value::Tuple({Value(UBits(1, 8))}),
+      Value::Tuple({Value(UBits(1, 8)), Value(UBits(2, 8))}),
+      Value::Tuple({Value::Tuple({Value(UBits(1, 8))}), Value(UBits(2, 8))}),
+      packed,
+      boxed,
+      Value::UBitsArray({1, 2}, /*bit_count=*/9).value(),
+      Value::UBitsArray({1}, /*bit_count=*/8).value(),
+      nested,
+  }));
+}
+
 TEST(ValueTest, IsAllZeroOnes) {
   EXPECT_TRUE(Value(UBits(0, 0)).IsAllZeros());
   EXPECT_TRUE(Value(UBits(0, 0)).IsAllOnes());
@@ -102,37 +102,69 @@ absl::Status VerifyName(FunctionBase* function_base) {
   return absl::OkStatus();
 }
 
-// Verify common invariants to function-level constructs.
-absl::Status VerifyFunctionBase(FunctionBase* function) {
+// Returns the nodes of `function` which changed after change epoch
+// `since_epoch` (added, or with changed operands or users), or all of its
+// nodes if `since_epoch` is not given.
+std::vector<Node*> GetNodesToVerify(FunctionBase* function,
+                                    std::optional<int64_t> since_epoch) {
+  std::vector<Node*> nodes;
+  for (Node* node : function->nodes()) {
+    if (!since_epoch.has_value() || node->change_epoch() > *since_epoch) {
+      nodes.push_back(node);
+    }
+  }
+  return nodes;
+}
+
+// Verify common invariants to function-level constructs. If `since_epoch` is
+// given only the invariants which may have been violated by changes after
+// that change epoch are verified (see VerifyPackageIncrementally).
+absl::Status VerifyFunctionBase(
+    FunctionBase* function,
+    std::optional<int64_t> since_epoch = std::nullopt) {
   VLOG(2) << absl::StreamFormat("Verifying function %s:", function->name());
   XLS_VLOG_LINES(4, function->DumpIr());
 
   XLS_RETURN_IF_ERROR(VerifyName(function));
 
+  std::vector<Node*> nodes = GetNodesToVerify(function, since_epoch);
+
   // Verify all types are owned by package.
-  for (Node* node : function->nodes()) {
+  for (Node* node : nodes) {
     XLS_RET_CHECK(node->package()->IsOwnedType(node->GetType()));
     XLS_RET_CHECK(node->package() == function->package());
   }
 
-  // Verify ids are unique within the function.
-  absl::flat_hash_set<int64_t> ids;
-  ids.reserve(function->node_count());
-  for (Node* node : function->nodes()) {
-    XLS_RETURN_IF_ERROR(VerifyNodeIdUnique(node, &ids));
+  // Verify ids are unique within the function. Nodes added since
+  // `since_epoch` draw fresh ids from the package.
+  if (!since_epoch.has_value()) {
+    absl::flat_hash_set<int64_t> ids;
+    ids.reserve(function->node_count());
+    for (Node* node : function->nodes()) {
+      XLS_RETURN_IF_ERROR(VerifyNodeIdUnique(node, &ids));
+    }
   }
 
-  // Verify that there are no cycles in the node graph.
+  // Verify that there are no cycles in the node graph. Any new cycle passes
+  // through a node whose operands changed so it suffices to search from those.
   class CycleChecker : public DfsVisitorWithDefault {
     absl::Status DefaultHandler(Node* node) override {
       return absl::OkStatus();
     }
   };
   CycleChecker cycle_checker;
-  XLS_RETURN_IF_ERROR(function->Accept(&cycle_checker));
+  if (!since_epoch.has_value()) {
+    XLS_RETURN_IF_ERROR(function->Accept(&cycle_checker));
+  } else {
+    for (Node* node : nodes) {
+      if (node->operands_change_epoch() > *since_epoch) {
+        XLS_RETURN_IF_ERROR(node->Accept(&cycle_checker));
+      }
+    }
+  }
 
   // Verify consistency of node::users() and node::operands().
-  for (Node* node : function->nodes()) {
+  for (Node* node : nodes) {
     XLS_RETURN_IF_ERROR(VerifyNode(node));
   }
 
@@ -148,18 +180,49 @@ absl::Status VerifyFunctionBase(FunctionBase* function) {
         << " is duplicated in Function::params()";
   }
   int64_t param_node_count = 0;
-  for (Node* node : function->nodes()) {
+  for (Node* node : nodes) {
     if (node->Is<Param>()) {
       XLS_RET_CHECK(param_set.contains(node))
           << "Param " << node->GetName() << " is not in Function::params()";
       param_node_count++;
     }
   }
-  XLS_RET_CHECK_EQ(param_set.size(), param_node_count)
-      << "Number of param nodes not equal to Function::params() size for "
-         "function "
-      << function->name();
+  if (!since_epoch.has_value()) {
+    XLS_RET_CHECK_EQ(param_set.size(), param_node_count)
+        << "Number of param nodes not equal to Function::params() size for "
+           "function "
+        << function->name();
+  }
+
+  return absl::OkStatus();
+}
+
+// Verify function, proc, block names are unique among functions/procs/blocks.
+absl::Status VerifyFunctionBaseNamesUnique(Package* package) {
+  absl::flat_hash_set<FunctionBase*> function_bases;
+  absl::flat_hash_set<std::string> function_names;
+  absl::flat_hash_set<std::string> proc_names;
+  absl::flat_hash_set<std::string> block_names;
+  for (FunctionBase* function_base : package->GetFunctionBases()) {
+    absl::flat_hash_set<std::string>* name_set;
+    if (function_base->IsFunction()) {
+      name_set = &function_names;
+    } else if (function_base->IsProc()) {
+      name_set = &proc_names;
+    } else {
+      XLS_RET_CHECK(function_base->IsBlock());
+      name_set = &block_names;
+    }
+    XLS_RET_CHECK(!name_set->contains(function_base->name()))
+        << "Function/proc/block with name " << function_base->name()
+        << " is not unique within package " << package->name();
+    name_set->insert(function_base->name());
 
+    XLS_RET_CHECK(!function_bases.contains(function_base))
+        << "Function or proc with name " << function_base->name()
+        << " appears more than once in within package" << package->name();
+    function_bases.insert(function_base);
+  }
   return absl::OkStatus();
 }
 
@@ -410,31 +473,7 @@ absl::Status VerifyPackage(Package* package, bool codegen) {
   }
   XLS_RET_CHECK_GT(package->next_node_id(), max_id_seen);
 
-  // Verify function, proc, block names are unique among functions/procs/blocks.
-  absl::flat_hash_set<FunctionBase*> function_bases;
-  absl::flat_hash_set<std::string> function_names;
-  absl::flat_hash_set<std::string> proc_names;
-  absl::flat_hash_set<std::string> block_names;
-  for (FunctionBase* function_base : package->GetFunctionBases()) {
-    absl::flat_hash_set<std::string>* name_set;
-    if (function_base->IsFunction()) {
-      name_set = &function_names;
-    } else if (function_base->IsProc()) {
-      name_set = &proc_names;
-    } else {
-      XLS_RET_CHECK(function_base->IsBlock());
-      name_set = &block_names;
-    }
-    XLS_RET_CHECK(!name_set->contains(function_base->name()))
-        << "Function/proc/block with name " << function_base->name()
-        << " is not unique within package " << package->name();
-    name_set->insert(function_base->name());
-
-    XLS_RET_CHECK(!function_bases.contains(function_base))
-        << "Function or proc with name " << function_base->name()
-        << " appears more than once in within package" << package->name();
-    function_bases.insert(function_base);
-  }
+  XLS_RETURN_IF_ERROR(VerifyFunctionBaseNamesUnique(package));
 
   XLS_RETURN_IF_ERROR(VerifyChannels(package, codegen));
 
@@ -446,13 +485,11 @@ absl::Status VerifyPackage(Package* package, bool codegen) {
   return absl::OkStatus();
 }
 
-absl::Status VerifyFunction(Function* function, bool codegen) {
-  VLOG(4) << "Verifying function:\n";
-  XLS_VLOG_LINES(4, function->DumpIr());
-
-  XLS_RETURN_IF_ERROR(VerifyFunctionBase(function));
+static absl::Status VerifyFunctionSince(Function* function,
+                                        std::optional<int64_t> since_epoch) {
+  XLS_RETURN_IF_ERROR(VerifyFunctionBase(function, since_epoch));
 
-  for (Node* node : function->nodes()) {
+  for (Node* node : GetNodesToVerify(function, since_epoch)) {
     if (node->Is<Send>() || node->Is<Receive>()) {
       return absl::InternalError(absl::StrFormat(
           "Send and receive nodes can only be in procs, not functions (%s)",
@@ -463,6 +500,13 @@ absl::Status VerifyFunction(Function* function, bool codegen) {
   return absl::OkStatus();
 }
 
+absl::Status VerifyFunction(Function* function, bool codegen) {
+  VLOG(4) << "Verifying function:\n";
+  XLS_VLOG_LINES(4, function->DumpIr());
+
+  return VerifyFunctionSince(function, /*since_epoch=*/std::nullopt);
+}
+
 static absl::Status VerifyProcScopedChannels(Proc* proc) {
   // Verify channel references contains exactly the set expected from the
   // interface and channel definitions. Map value is used to track how many
@@ -618,11 +662,9 @@ static absl::Status VerifyProcInstantiations(Proc* proc) {
   return absl::OkStatus();
 }
 
-absl::Status VerifyProc(Proc* proc, bool codegen) {
-  VLOG(4) << "Verifying proc:\n";
-  XLS_VLOG_LINES(4, proc->DumpIr());
-
-  XLS_RETURN_IF_ERROR(VerifyFunctionBase(proc));
+static absl::Status VerifyProcSince(Proc* proc,
+                                    std::optional<int64_t> since_epoch) {
+  XLS_RETURN_IF_ERROR(VerifyFunctionBase(proc, since_epoch));
 
   if (proc->is_new_style_proc()) {
     XLS_RETURN_IF_ERROR(VerifyProcScopedChannels(proc));
@@ -670,6 +712,13 @@ absl::Status VerifyProc(Proc* proc, bool codegen) {
   return absl::OkStatus();
 }
 
+absl::Status VerifyProc(Proc* proc, bool codegen) {
+  VLOG(4) << "Verifying proc:\n";
+  XLS_VLOG_LINES(4, proc->DumpIr());
+
+  return VerifyProcSince(proc, /*since_epoch=*/std::nullopt);
+}
+
 // Verify that the given set of port nodes on the instantiated block match
 // one-to-one with the instantiation input/output nodes in the instantiating
 // block.
@@ -1020,4 +1069,46 @@ absl::Status VerifyBlock(Block* block, bool codegen) {
   return absl::OkStatus();
 }
 
+absl::Status VerifyPackageIncrementally(Package* package,
+                                        VerifiedEpochs* verified_epochs,
+                                        bool codegen) {
+  VLOG(4) << absl::StreamFormat("Incrementally verifying package %s:\n",
+                                package->name());
+
+  VerifiedEpochs epochs;
+  bool procs_changed = false;
+  for (FunctionBase* function_base : package->GetFunctionBases()) {
+    XLS_RET_CHECK(function_base->package() == package);
+    epochs[function_base->uid()] = function_base->change_epoch();
+
+    std::optional<int64_t> since_epoch;
+    if (auto it = verified_epochs->find(function_base->uid());
+        it != verified_epochs->end()) {
+      if (it->second == function_base->change_epoch()) {
+        continue;
+      }
+      since_epoch = it->second;
+    }
+    if (function_base->IsFunction()) {
+      XLS_RETURN_IF_ERROR(
+          VerifyFunctionSince(function_base->AsFunctionOrDie(), since_epoch));
+    } else if (function_base->IsProc()) {
+      procs_changed = true;
+      XLS_RETURN_IF_ERROR(
+          VerifyProcSince(function_base->AsProcOrDie(), since_epoch));
+    } else {
+      XLS_RETURN_IF_ERROR(VerifyBlock(function_base->AsBlockOrDie(), codegen));
+    }
+  }
+
+  XLS_RETURN_IF_ERROR(VerifyFunctionBaseNamesUnique(package));
+
+  if (procs_changed) {
+    XLS_RETURN_IF_ERROR(VerifyChannels(package, codegen));
+  }
+
+  *verified_epochs = std::move(epochs);
+  return absl::OkStatus();
+}
+
 }  // namespace xls
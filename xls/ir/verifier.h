@@ -15,6 +15,9 @@
 #ifndef XLS_IR_VERIFIER_H_
 #define XLS_IR_VERIFIER_H_
 
+#include <cstdint>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 
 namespace xls {
@@ -32,6 +35,26 @@ absl::Status VerifyFunction(Function* function, bool codegen = false);
 absl::Status VerifyProc(Proc* Proc, bool codegen = false);
 absl::Status VerifyBlock(Block* Block, bool codegen = false);
 
+// Change epochs (see FunctionBase::change_epoch) at which the function bases of
+// a package were last verified, keyed by FunctionBase::uid.
+using VerifiedEpochs = absl::flat_hash_map<int64_t, int64_t>;
+
+// Verifies the invariants of the package which may have been violated since
+// the change epochs recorded in `verified_epochs`, and on success replaces
+// them with the current change epochs. Function bases without a recorded
+// epoch are verified in full and unchanged ones are skipped. Of the changed
+// functions and procs only the nodes which were added or whose operands or
+// users changed are verified, along with the function-level invariants these
+// affect; changed blocks are verified in full. Channels are verified if any
+// proc changed.
+//
+// Changes which do not advance the change epoch (e.g., renaming a node or
+// changing node attributes in place) are not detected, nor are node id
+// collisions, so callers should periodically fall back to VerifyPackage.
+absl::Status VerifyPackageIncrementally(Package* package,
+                                        VerifiedEpochs* verified_epochs,
+                                        bool codegen = false);
+
 }  // namespace xls
 
 #endif  // XLS_IR_VERIFIER_H_
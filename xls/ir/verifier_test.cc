@@ -14,6 +14,7 @@
 
 #include "xls/ir/verifier.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -24,6 +25,7 @@
 #include "absl/strings/substitute.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/package.h"
@@ -544,5 +546,81 @@ block my_block(push_valid: bits[1], push_data: bits[1], push_ready: bits[1], out
                        HasSubstr("Expected fifo depth >= 0, got -3")));
 }
 
+TEST_F(VerifierTest, IncrementalVerificationRecordsEpochs) {
+  std::string input = R"(
+package IncrementalVerification
+
+fn graph(p: bits[42], q: bits[42]) -> bits[42] {
+  and.1: bits[42] = and(p, q)
+  add.2: bits[42] = add(and.1, q)
+  ret sub.3: bits[42] = sub(add.2, add.2)
+}
+
+fn graph2(a: bits[16]) -> bits[16] {
+  neg.4: bits[16] = neg(a)
+  ret not.5: bits[16] = not(neg.4)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackageNoVerify(input));
+  Function* graph = FindFunction("graph", p.get());
+  Function* graph2 = FindFunction("graph2", p.get());
+
+  VerifiedEpochs epochs;
+  XLS_ASSERT_OK(VerifyPackageIncrementally(p.get(), &epochs));
+  EXPECT_EQ(epochs.size(), 2);
+  EXPECT_EQ(epochs.at(graph->uid()), graph->change_epoch());
+  EXPECT_EQ(epochs.at(graph2->uid()), graph2->change_epoch());
+
+  XLS_ASSERT_OK(FindNode("and.1", graph)->ReplaceOperandNumber(
+      1, FindNode("p", graph)));
+  XLS_ASSERT_OK(VerifyPackageIncrementally(p.get(), &epochs));
+  EXPECT_EQ(epochs.at(graph->uid()), graph->change_epoch());
+}
+
+TEST_F(VerifierTest, IncrementalVerificationDetectsCycle) {
+  std::string input = R"(
+package IncrementalCycle
+
+fn graph(p: bits[42], q: bits[42]) -> bits[42] {
+  and.1: bits[42] = and(p, q)
+  add.2: bits[42] = add(and.1, q)
+  ret sub.3: bits[42] = sub(add.2, add.2)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackageNoVerify(input));
+  Function* graph = FindFunction("graph", p.get());
+  VerifiedEpochs epochs;
+  XLS_ASSERT_OK(VerifyPackageIncrementally(p.get(), &epochs));
+  int64_t verified_epoch = epochs.at(graph->uid());
+
+  XLS_ASSERT_OK(FindNode("and.1", graph)->ReplaceOperandNumber(
+      0, FindNode("sub.3", graph)));
+  EXPECT_THAT(VerifyPackageIncrementally(p.get(), &epochs),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Cycle detected")));
+  // The epochs are only updated on success.
+  EXPECT_EQ(epochs.at(graph->uid()), verified_epoch);
+}
+
+TEST_F(VerifierTest, IncrementalVerificationDetectsTypeMismatch) {
+  std::string input = R"(
+package IncrementalTypeMismatch
+
+fn graph(p: bits[42], q: bits[42], r: bits[8]) -> bits[42] {
+  and.1: bits[42] = and(p, q)
+  ret add.2: bits[42] = add(and.1, q)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackageNoVerify(input));
+  Function* graph = FindFunction("graph", p.get());
+  VerifiedEpochs epochs;
+  XLS_ASSERT_OK(VerifyPackageIncrementally(p.get(), &epochs));
+
+  XLS_ASSERT_OK(FindNode("add.2", graph)->ReplaceOperandNumber(
+      1, FindNode("r", graph), /*type_must_match=*/false));
+  EXPECT_THAT(VerifyPackageIncrementally(p.get(), &epochs),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
 }  // namespace
 }  // namespace xls
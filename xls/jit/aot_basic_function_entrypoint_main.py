@@ -14,7 +14,8 @@
 
 """Compatibility implementation of the old aot_compiler API.
 
-This generates a single entrypoint for an XLS function.
+This generates a single entrypoint for an XLS function, or a class modeling
+an XLS block cycle by cycle.
 """
 
 from collections.abc import Sequence
@@ -123,6 +124,90 @@ class BasicFunctionAot:
   extern_sanitizer: bool
 
 
+@dataclasses.dataclass(frozen=True)
+class BlockAot:
+  """AOT data for a block.
+
+  Attributes:
+    namespace: The namespace in which to place the generated code.
+    header_filename: The filename of the header file to be #included.
+    extern_fn: The name of the function to be called.
+    block_name: The name of the block.
+    class_name: The name of the class to be generated.
+    input_ports: The names of the input ports.
+    output_ports: The names of the output ports.
+    entrypoints: The AotPackageEntrypointsProto of the block.
+    extern_sanitizer: Whether msan is linked in.
+  """
+
+  namespace: str
+  header_filename: str
+  extern_fn: str
+  block_name: str
+  class_name: str
+  input_ports: Sequence[str]
+  output_ports: Sequence[str]
+  entrypoints: aot_entrypoint_pb2.AotPackageEntrypointsProto
+  extern_sanitizer: bool
+
+
+def _render(aot, template_prefix: str) -> None:
+  """Writes the header and source generated from the given templates."""
+  env = jinja2.Environment(undefined=jinja2.StrictUndefined)
+  env.filters["append_each"] = lambda vs, suffix: [v + suffix for v in vs]
+  env.filters["add_prefix"] = lambda v, prefix: prefix + v
+  bindings = {
+      "aot": aot,
+      "len": len,
+      "MessageToString": text_format.MessageToString,
+  }
+  with open(_OUTPUT_HEADER.value, "wt") as h_file:
+    h_template = env.from_string(
+        runfiles.get_contents_as_text(f"xls/jit/{template_prefix}_h.tmpl")
+    )
+    h_file.write("// Generated File. Do not edit.\n")
+    h_file.write(h_template.render(bindings))
+    h_file.write("\n")
+  with open(_OUTPUT_SOURCE.value, "wt") as cc_file:
+    cc_template = env.from_string(
+        runfiles.get_contents_as_text(f"xls/jit/{template_prefix}_cc.tmpl")
+    )
+    cc_file.write("// Generated File. Do not edit.\n")
+    cc_file.write(cc_template.render(bindings))
+    cc_file.write("\n")
+
+
+def _generate_block(
+    all_entrypoints: aot_entrypoint_pb2.AotPackageEntrypointsProto,
+) -> None:
+  """Generates a class modeling the block of the single entrypoint."""
+  entrypoint = all_entrypoints.entrypoint[0]
+  block_name = entrypoint.xls_function_identifier.removeprefix(
+      f"__{entrypoint.xls_package_name}__"
+  )
+  register_count = len(entrypoint.register_names)
+  input_ports = entrypoint.inputs_names[
+      : len(entrypoint.inputs_names) - register_count
+  ]
+  output_ports = entrypoint.outputs_names[
+      : len(entrypoint.outputs_names) - register_count
+  ]
+  aot = BlockAot(
+      namespace="::".join(_NAMESPACES.value.split(",")),
+      header_filename=_HEADER_INCLUDE_PATH.value,
+      extern_fn=entrypoint.function_symbol,
+      block_name=block_name,
+      class_name="".join(
+          part[:1].upper() + part[1:] for part in block_name.split("_")
+      ),
+      input_ports=input_ports,
+      output_ports=output_ports,
+      entrypoints=all_entrypoints,
+      extern_sanitizer=entrypoint.has_msan,
+  )
+  _render(aot, "aot_block")
+
+
 def main(argv: Sequence[str]) -> None:
   if len(argv) != 2:
     raise app.UsageError(f"Usage: {argv[0]} [flags] AotEntrypointProto")
@@ -138,8 +223,11 @@ def main(argv: Sequence[str]) -> None:
   if len(all_entrypoints.entrypoint) != 1:
     raise app.UsageError("Multiple entrypoints are not supported.")
   entrypoint = all_entrypoints.entrypoint[0]
+  if entrypoint.type == aot_entrypoint_pb2.AotEntrypointProto.BLOCK:
+    _generate_block(all_entrypoints)
+    return
   if entrypoint.type != aot_entrypoint_pb2.AotEntrypointProto.FUNCTION:
-    raise app.UsageError("Only functions are supported!")
+    raise app.UsageError("Only functions and blocks are supported!")
   params = []
   for name, size, align in zip(
       entrypoint.inputs_names,
@@ -163,27 +251,7 @@ def main(argv: Sequence[str]) -> None:
       result_layout=entrypoint.outputs_layout,
       extern_sanitizer=entrypoint.has_msan,
   )
-  env = jinja2.Environment(undefined=jinja2.StrictUndefined)
-  env.filters["append_each"] = lambda vs, suffix: [v + suffix for v in vs]
-  bindings = {
-      "aot": aot,
-      "len": len,
-      "MessageToString": text_format.MessageToString,
-  }
-  with open(_OUTPUT_HEADER.value, "wt") as h_file:
-    h_template = env.from_string(
-        runfiles.get_contents_as_text("xls/jit/aot_basic_function_h.tmpl")
-    )
-    h_file.write("// Generated File. Do not edit.\n")
-    h_file.write(h_template.render(bindings))
-    h_file.write("\n")
-  with open(_OUTPUT_SOURCE.value, "wt") as cc_file:
-    cc_template = env.from_string(
-        runfiles.get_contents_as_text("xls/jit/aot_basic_function_cc.tmpl")
-    )
-    cc_file.write("// Generated File. Do not edit.\n")
-    cc_file.write(cc_template.render(bindings))
-    cc_file.write("\n")
+  _render(aot, "aot_basic_function")
 
 
 if __name__ == "__main__":
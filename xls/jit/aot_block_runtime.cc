@@ -0,0 +1,197 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/jit/aot_block_runtime.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "google/protobuf/text_format.h"
+#include "llvm/include/llvm/IR/DataLayout.h"
+#include "llvm/include/llvm/Support/Error.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/events.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/aot_entrypoint.pb.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_buffer.h"
+#include "xls/jit/jit_callbacks.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls::aot_compile {
+
+/* static */ absl::StatusOr<std::unique_ptr<AotBlockRuntime>>
+AotBlockRuntime::Create(std::string_view serialized_entrypoints,
+                        JitFunctionType function) {
+  AotPackageEntrypointsProto entrypoints;
+  if (!google::protobuf::TextFormat::ParseFromString(std::string(serialized_entrypoints),
+                                           &entrypoints)) {
+    return absl::InvalidArgumentError(
+        "Unable to parse AotPackageEntrypointsProto for block");
+  }
+  XLS_RET_CHECK_EQ(entrypoints.entrypoint_size(), 1);
+  const AotEntrypointProto& entrypoint = entrypoints.entrypoint(0);
+  XLS_RET_CHECK_EQ(entrypoint.type(), AotEntrypointProto::BLOCK);
+  XLS_RET_CHECK(entrypoints.has_data_layout())
+      << "Data layout required to create an aot runtime";
+  llvm::Expected<llvm::DataLayout> data_layout =
+      llvm::DataLayout::parse(entrypoints.data_layout());
+  XLS_RET_CHECK(data_layout) << "Unable to parse '"
+                             << entrypoints.data_layout()
+                             << "' to an llvm data-layout.";
+
+  auto package = std::make_unique<Package>("__aot_block_runtime");
+  std::vector<TypeLayout> input_layouts;
+  for (const TypeLayoutProto& proto : entrypoint.inputs_layout().layouts()) {
+    XLS_ASSIGN_OR_RETURN(TypeLayout layout,
+                         TypeLayout::FromProto(proto, package.get()));
+    input_layouts.push_back(std::move(layout));
+  }
+  std::vector<TypeLayout> output_layouts;
+  for (const TypeLayoutProto& proto : entrypoint.outputs_layout().layouts()) {
+    XLS_ASSIGN_OR_RETURN(TypeLayout layout,
+                         TypeLayout::FromProto(proto, package.get()));
+    output_layouts.push_back(std::move(layout));
+  }
+  XLS_RET_CHECK_EQ(input_layouts.size(), entrypoint.inputs_names_size());
+  XLS_RET_CHECK_EQ(output_layouts.size(), entrypoint.outputs_names_size());
+  XLS_RET_CHECK_EQ(input_layouts.size(), entrypoint.input_buffer_sizes_size());
+  XLS_RET_CHECK_EQ(output_layouts.size(),
+                   entrypoint.output_buffer_sizes_size());
+  XLS_RET_CHECK_GE(input_layouts.size(), entrypoint.register_names_size());
+  XLS_RET_CHECK_GE(output_layouts.size(), entrypoint.register_names_size());
+  return absl::WrapUnique(new AotBlockRuntime(
+      std::move(package), entrypoint,
+      std::make_unique<JitRuntime>(*std::move(data_layout)), function,
+      std::move(input_layouts), std::move(output_layouts)));
+}
+
+AotBlockRuntime::AotBlockRuntime(std::unique_ptr<Package> package,
+                                 AotEntrypointProto entrypoint,
+                                 std::unique_ptr<JitRuntime> jit_runtime,
+                                 JitFunctionType function,
+                                 std::vector<TypeLayout> input_layouts,
+                                 std::vector<TypeLayout> output_layouts)
+    : package_(std::move(package)),
+      entrypoint_(std::move(entrypoint)),
+      jit_runtime_(std::move(jit_runtime)),
+      function_(function),
+      input_layouts_(std::move(input_layouts)),
+      output_layouts_(std::move(output_layouts)),
+      register_count_(entrypoint_.register_names_size()),
+      instance_context_(InstanceContext::CreateForBlock()) {
+  input_port_count_ = input_layouts_.size() - register_count_;
+  output_port_count_ = output_layouts_.size() - register_count_;
+
+  // Lay out every buffer in a single zeroed allocation: the input ports, the
+  // output ports, two banks of registers and the temporary buffer.
+  int64_t max_alignment = 1;
+  int64_t size = 0;
+  auto place = [&](int64_t bytes, int64_t alignment) {
+    alignment = std::max<int64_t>(alignment, 1);
+    max_alignment = std::max(max_alignment, alignment);
+    int64_t offset = RoundUpToNearest<int64_t>(size, alignment);
+    size = offset + bytes;
+    return offset;
+  };
+  std::vector<int64_t> input_offsets(input_layouts_.size());
+  std::vector<int64_t> output_offsets(output_layouts_.size());
+  for (int64_t i = 0; i < input_port_count_; ++i) {
+    input_offsets[i] = place(entrypoint_.input_buffer_sizes(i),
+                             entrypoint_.input_buffer_alignments(i));
+  }
+  for (int64_t i = 0; i < output_port_count_; ++i) {
+    output_offsets[i] = place(entrypoint_.output_buffer_sizes(i),
+                              entrypoint_.output_buffer_alignments(i));
+  }
+  for (int64_t i = 0; i < register_count_; ++i) {
+    int64_t in = input_port_count_ + i;
+    int64_t out = output_port_count_ + i;
+    int64_t bytes = std::max(entrypoint_.input_buffer_sizes(in),
+                             entrypoint_.output_buffer_sizes(out));
+    int64_t alignment = std::max(entrypoint_.input_buffer_alignments(in),
+                                 entrypoint_.output_buffer_alignments(out));
+    input_offsets[in] = place(bytes, alignment);
+    output_offsets[out] = place(bytes, alignment);
+  }
+  int64_t temp_offset = place(entrypoint_.temp_buffer_size(),
+                              entrypoint_.temp_buffer_alignment());
+  size = RoundUpToNearest<int64_t>(std::max<int64_t>(size, 1), max_alignment);
+  memory_.reset(static_cast<uint8_t*>(AllocateAligned(max_alignment, size)));
+  std::memset(memory_.get(), 0, size);
+
+  inputs_.reserve(input_offsets.size());
+  for (int64_t offset : input_offsets) {
+    inputs_.push_back(memory_.get() + offset);
+  }
+  outputs_.reserve(output_offsets.size());
+  for (int64_t offset : output_offsets) {
+    outputs_.push_back(memory_.get() + offset);
+  }
+  temp_buffer_ = memory_.get() + temp_offset;
+}
+
+absl::Status AotBlockRuntime::SetInputPorts(absl::Span<const Value> values) {
+  XLS_RET_CHECK_EQ(values.size(), input_port_count_);
+  for (int64_t i = 0; i < input_port_count_; ++i) {
+    SetInputPort(i, values[i]);
+  }
+  return absl::OkStatus();
+}
+
+std::vector<Value> AotBlockRuntime::GetOutputPorts() const {
+  std::vector<Value> result;
+  result.reserve(output_port_count_);
+  for (int64_t i = 0; i < output_port_count_; ++i) {
+    result.push_back(GetOutputPort(i));
+  }
+  return result;
+}
+
+absl::Status AotBlockRuntime::Tick() {
+  int64_t assert_count = events_.assert_msgs.size();
+  function_(inputs_.data(), outputs_.data(), temp_buffer_, &events_,
+            &instance_context_, jit_runtime_.get(),
+            /*continuation_point=*/0);
+  // The next register values are now in the bank the outputs point at; make
+  // them the current values.
+  for (int64_t i = 0; i < register_count_; ++i) {
+    std::swap(inputs_[input_port_count_ + i],
+              outputs_[output_port_count_ + i]);
+  }
+  if (events_.assert_msgs.size() > assert_count) {
+    return absl::AbortedError(absl::StrFormat(
+        "Assertion failure(s) in block %s: %s",
+        entrypoint_.xls_function_identifier(), events_.assert_msgs.back()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls::aot_compile
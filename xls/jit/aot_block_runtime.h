@@ -0,0 +1,152 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Runtime support for blocks compiled ahead of time. Like aot_proc_runtime.h
+// this does not depend on the AOT compiler or the LLVM optimization and codegen
+// pipeline, so linking an AOT-compiled block into a binary does not pull them
+// in.
+
+#ifndef XLS_JIT_AOT_BLOCK_RUNTIME_H_
+#define XLS_JIT_AOT_BLOCK_RUNTIME_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/events.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/aot_entrypoint.pb.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_buffer.h"
+#include "xls/jit/jit_callbacks.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls::aot_compile {
+
+// Cycle-accurate model of a block compiled ahead of time. Holds the port and
+// register buffers of one instance of the block in the native data layout
+// used by the JIT; each call to Tick() evaluates one clock cycle.
+//
+// All registers start out zero, as they do with the BlockJit.
+class AotBlockRuntime {
+ public:
+  // Creates a runtime for the block compiled to `function`.
+  // `serialized_entrypoints` is a text serialization of the
+  // AotPackageEntrypointsProto emitted by the AOT compiler for the block.
+  static absl::StatusOr<std::unique_ptr<AotBlockRuntime>> Create(
+      std::string_view serialized_entrypoints, JitFunctionType function);
+
+  int64_t input_port_count() const { return input_port_count_; }
+  int64_t output_port_count() const { return output_port_count_; }
+  int64_t register_count() const { return register_count_; }
+
+  const std::string& input_port_name(int64_t i) const {
+    return entrypoint_.inputs_names(i);
+  }
+  const std::string& output_port_name(int64_t i) const {
+    return entrypoint_.outputs_names(i);
+  }
+  const std::string& register_name(int64_t i) const {
+    return entrypoint_.register_names(i);
+  }
+
+  // Sets the value of the `i`-th input port for the following cycles. The
+  // value must conform to the type of the port.
+  void SetInputPort(int64_t i, const Value& value) {
+    input_layouts_[i].ValueToNativeLayout(value, inputs_[i]);
+  }
+  absl::Status SetInputPorts(absl::Span<const Value> values);
+
+  // Returns the value of the `i`-th output port as computed by the last call
+  // to Tick().
+  Value GetOutputPort(int64_t i) const {
+    return output_layouts_[i].NativeLayoutToValue(outputs_[i]);
+  }
+  std::vector<Value> GetOutputPorts() const;
+
+  // Returns/sets the current value of the `i`-th register.
+  Value GetRegister(int64_t i) const {
+    return register_layouts()[i].NativeLayoutToValue(
+        inputs_[input_port_count_ + i]);
+  }
+  void SetRegister(int64_t i, const Value& value) {
+    register_layouts()[i].ValueToNativeLayout(value,
+                                              inputs_[input_port_count_ + i]);
+  }
+
+  // Raw buffers of the ports in the native data layout, for callers which
+  // hold their stimulus in that layout already.
+  uint8_t* input_port_buffer(int64_t i) { return inputs_[i]; }
+  const uint8_t* output_port_buffer(int64_t i) const { return outputs_[i]; }
+
+  // Evaluates one clock cycle: computes the output ports from the input ports
+  // and the current register values and then latches the next register
+  // values. Returns an error if an assertion failed during the cycle.
+  absl::Status Tick();
+
+  // The trace and assertion messages recorded by all cycles so far.
+  InterpreterEvents& events() { return events_; }
+
+ private:
+  AotBlockRuntime(std::unique_ptr<Package> package,
+                  AotEntrypointProto entrypoint,
+                  std::unique_ptr<JitRuntime> jit_runtime,
+                  JitFunctionType function,
+                  std::vector<TypeLayout> input_layouts,
+                  std::vector<TypeLayout> output_layouts);
+
+  absl::Span<const TypeLayout> register_layouts() const {
+    return absl::MakeConstSpan(input_layouts_).subspan(input_port_count_);
+  }
+
+  // Dummy package used for owning Types required by the TypeLayout data
+  // structures.
+  std::unique_ptr<Package> package_;
+  AotEntrypointProto entrypoint_;
+  std::unique_ptr<JitRuntime> jit_runtime_;
+  JitFunctionType function_;
+  // Layouts of the input ports followed by the registers, and of the output
+  // ports followed by the registers.
+  std::vector<TypeLayout> input_layouts_;
+  std::vector<TypeLayout> output_layouts_;
+  int64_t input_port_count_;
+  int64_t output_port_count_;
+  int64_t register_count_;
+
+  // Backing storage of all buffers, including both banks of registers.
+  std::unique_ptr<uint8_t, DeleteAligned> memory_;
+  uint8_t* temp_buffer_;
+  // Pointers passed to the compiled code. The register entries of `inputs_`
+  // point at the current register values and those of `outputs_` at the other
+  // bank, which receives the next values; the two are swapped after each
+  // cycle.
+  std::vector<uint8_t*> inputs_;
+  std::vector<uint8_t*> outputs_;
+
+  InterpreterEvents events_;
+  InstanceContext instance_context_;
+};
+
+}  // namespace xls::aot_compile
+
+#endif  // XLS_JIT_AOT_BLOCK_RUNTIME_H_
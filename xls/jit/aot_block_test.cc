@@ -0,0 +1,82 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstdint>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/value.h"
+#include "xls/jit/accumulator_block_cc.h"
+#include "xls/jit/aot_block_runtime.h"
+
+namespace xls {
+namespace {
+
+Value U32(uint64_t v) { return Value(UBits(v, 32)); }
+
+TEST(AotBlockTest, Accumulate) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<foo::Accumulator> block,
+                           foo::Accumulator::Create());
+  // Registers start out zero.
+  block->SetInputs(/*x=*/U32(3), /*en=*/Value(UBits(1, 1)));
+  XLS_ASSERT_OK(block->Tick());
+  EXPECT_EQ(block->GetOutputs().sum, U32(0));
+  XLS_ASSERT_OK(block->Tick());
+  EXPECT_EQ(block->GetOutputs().sum, U32(3));
+  block->SetInputs(/*x=*/U32(10), /*en=*/Value(UBits(1, 1)));
+  XLS_ASSERT_OK(block->Tick());
+  EXPECT_EQ(block->GetOutputs().sum, U32(6));
+  XLS_ASSERT_OK(block->Tick());
+  EXPECT_EQ(block->GetOutputs().sum, U32(16));
+}
+
+TEST(AotBlockTest, LoadEnable) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<foo::Accumulator> block,
+                           foo::Accumulator::Create());
+  block->SetInputs(/*x=*/U32(5), /*en=*/Value(UBits(0, 1)));
+  for (int64_t i = 0; i < 4; ++i) {
+    XLS_ASSERT_OK(block->Tick());
+    EXPECT_EQ(block->GetOutputs().sum, U32(0));
+  }
+  block->SetInputs(/*x=*/U32(5), /*en=*/Value(UBits(1, 1)));
+  XLS_ASSERT_OK(block->Tick());
+  XLS_ASSERT_OK(block->Tick());
+  EXPECT_EQ(block->GetOutputs().sum, U32(5));
+}
+
+TEST(AotBlockTest, RuntimeAccess) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<foo::Accumulator> block,
+                           foo::Accumulator::Create());
+  aot_compile::AotBlockRuntime& runtime = block->runtime();
+  ASSERT_EQ(runtime.input_port_count(), 2);
+  ASSERT_EQ(runtime.output_port_count(), 1);
+  ASSERT_EQ(runtime.register_count(), 1);
+  EXPECT_EQ(runtime.input_port_name(0), "x");
+  EXPECT_EQ(runtime.input_port_name(1), "en");
+  EXPECT_EQ(runtime.output_port_name(0), "sum");
+  EXPECT_EQ(runtime.register_name(0), "acc");
+
+  runtime.SetRegister(0, U32(100));
+  EXPECT_EQ(runtime.GetRegister(0), U32(100));
+  block->SetInputs(/*x=*/U32(1), /*en=*/Value(UBits(1, 1)));
+  XLS_ASSERT_OK(block->Tick());
+  EXPECT_EQ(block->GetOutputs().sum, U32(100));
+  EXPECT_EQ(runtime.GetRegister(0), U32(101));
+}
+
+}  // namespace
+}  // namespace xls
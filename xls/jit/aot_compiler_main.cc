@@ -40,12 +40,15 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/block.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/register.h"
 #include "xls/ir/type.h"
 #include "xls/jit/aot_entrypoint.pb.h"
+#include "xls/jit/block_jit.h"
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/function_jit.h"
 #include "xls/jit/jit_proc_runtime.h"
@@ -55,7 +58,7 @@
 
 ABSL_FLAG(std::string, input, "", "Path to the IR to compile.");
 ABSL_FLAG(std::optional<std::string>, top, std::nullopt,
-          "IR function to compile. "
+          "IR function, proc or block to compile. "
           "If unspecified, the package top function will be used - "
           "in that case, the package-scoping mangling will be removed.");
 ABSL_FLAG(std::optional<std::string>, output_object, std::nullopt,
@@ -145,7 +148,28 @@ absl::StatusOr<AotEntrypointProto> GenerateEntrypointProto(
       *proto.mutable_outputs_layout()->add_layouts() = layout_proto;
     }
   } else {
-    return absl::UnimplementedError("block aot dumping unsupported!");
+    proto.set_type(AotEntrypointProto::BLOCK);
+    Block* block = func->AsBlockOrDie();
+    for (const InputPort* port : block->GetInputPorts()) {
+      proto.add_inputs_names(port->name());
+      *proto.mutable_inputs_layout()->add_layouts() =
+          type_converter.CreateTypeLayout(port->GetType()).ToProto();
+    }
+    for (const OutputPort* port : block->GetOutputPorts()) {
+      proto.add_outputs_names(port->name());
+      *proto.mutable_outputs_layout()->add_layouts() =
+          type_converter.CreateTypeLayout(port->operand(0)->GetType())
+              .ToProto();
+    }
+    for (const Register* reg : block->GetRegisters()) {
+      proto.add_inputs_names(reg->name());
+      proto.add_outputs_names(reg->name());
+      proto.add_register_names(reg->name());
+      TypeLayoutProto layout_proto =
+          type_converter.CreateTypeLayout(reg->type()).ToProto();
+      *proto.mutable_inputs_layout()->add_layouts() = layout_proto;
+      *proto.mutable_outputs_layout()->add_layouts() = layout_proto;
+    }
   }
   proto.set_xls_package_name(package->name());
   proto.set_xls_function_identifier(func->name());
@@ -235,8 +259,10 @@ absl::Status RealMain(const std::string& input_ir_path,
                                             package.get(), include_msan, &obs));
     }
   } else {
-    return absl::UnimplementedError(
-        "Dumping block jit code is not yet supported");
+    XLS_ASSIGN_OR_RETURN(
+        object_code,
+        BlockJit::CreateObjectCode(f->AsBlockOrDie(),
+                                   /*opt_level = */ 3, include_msan, &obs));
   }
   AotPackageEntrypointsProto all_entrypoints;
   if (output_object_path) {
@@ -14,56 +14,94 @@
 
 #include "xls/jit/block_jit.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <random>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "llvm/include/llvm/IR/DataLayout.h"
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/block_evaluator.h"
 #include "xls/ir/block.h"
+#include "xls/ir/block_elaboration.h"
 #include "xls/ir/elaboration.h"
 #include "xls/ir/events.h"
+#include "xls/ir/instantiation.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/register.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
+#include "xls/jit/aot_compiler.h"
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_callbacks.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
 
 namespace xls {
 
 absl::StatusOr<std::unique_ptr<BlockJit>> BlockJit::Create(Block* block) {
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
-  XLS_ASSIGN_OR_RETURN(auto function,
-                       JittedFunctionBase::Build(block, *orc_jit));
   if (!block->GetInstantiations().empty()) {
     return absl::UnimplementedError(
-        "Jitting of blocks with instantiations is not yet supported.");
+        "BlockJit does not support blocks with instantiations; use "
+        "ElaboratedBlockJit.");
   }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
+  XLS_ASSIGN_OR_RETURN(auto function,
+                       JittedFunctionBase::Build(block, *orc_jit));
   XLS_ASSIGN_OR_RETURN(auto data_layout, orc_jit->CreateDataLayout());
   return std::unique_ptr<BlockJit>(
       new BlockJit(block, std::make_unique<JitRuntime>(data_layout),
                    std::move(orc_jit), std::move(function)));
 }
 
+absl::StatusOr<JitObjectCode> BlockJit::CreateObjectCode(
+    Block* block, int64_t opt_level, bool include_msan,
+    JitObserver* observer) {
+  if (!block->GetInstantiations().empty()) {
+    return absl::UnimplementedError(
+        "AOT compilation of blocks with instantiations is not supported; "
+        "flatten the block hierarchy first.");
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<AotCompiler> comp,
+                       AotCompiler::Create(include_msan, opt_level, observer));
+  XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout, comp->CreateDataLayout());
+  XLS_ASSIGN_OR_RETURN(JittedFunctionBase jfb,
+                       JittedFunctionBase::Build(block, *comp));
+  XLS_ASSIGN_OR_RETURN(auto obj_code, std::move(comp)->GetObjectCode());
+  return JitObjectCode{.object_code = std::move(obj_code),
+                       .entrypoints =
+                           {
+                               FunctionEntrypoint{
+                                   .function = block,
+                                   .jit_info = std::move(jfb),
+                               },
+                           },
+                       .data_layout = data_layout};
+}
+
 std::unique_ptr<BlockJitContinuation> BlockJit::NewContinuation() {
   return std::unique_ptr<BlockJitContinuation>(
       new BlockJitContinuation(block_, this, function_));
@@ -80,6 +118,75 @@ absl::Status BlockJit::RunOneCycle(BlockJitContinuation& continuation) {
   return absl::OkStatus();
 }
 
+absl::Status BlockJit::RunCyclesInJit(BlockJitContinuation& continuation,
+                                      int64_t cycle_count) {
+  if (!function_.HasMultiCycleFunction()) {
+    for (int64_t i = 0; i < cycle_count; ++i) {
+      XLS_RETURN_IF_ERROR(RunOneCycle(continuation));
+    }
+    return absl::OkStatus();
+  }
+  function_.RunMultiCycleJittedFunction(
+      continuation.input_buffers_.current().get(),
+      continuation.output_buffers_.current().get(),
+      continuation.temp_buffer_.get(), &continuation.GetEvents(),
+      /*instance_context=*/&continuation.callbacks_, runtime_.get(),
+      cycle_count);
+  // The jitted loop flips the register spaces in a local copy of the pointer
+  // arrays so only the parity of the cycle count matters here.
+  if (cycle_count % 2 == 1) {
+    continuation.SwapRegisters();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status BlockJit::RunCycles(BlockJitContinuation& continuation,
+                                 int64_t cycle_count,
+                                 const InputGenerator& input_generator,
+                                 const OutputSink& output_sink,
+                                 const RunCyclesOptions& options) {
+  XLS_RET_CHECK_GE(cycle_count, 0);
+  XLS_RET_CHECK_GT(options.sample_period, 0);
+  absl::Span<const int64_t> output_port_sizes =
+      absl::MakeConstSpan(function_.output_buffer_sizes())
+          .subspan(0, block_->GetOutputPorts().size());
+  // The output port values last passed to `output_sink`. Only used if
+  // `options.only_changed_outputs` is set.
+  std::optional<std::vector<std::vector<uint8_t>>> last_outputs;
+  auto outputs_changed = [&]() {
+    absl::Span<const uint8_t* const> outputs =
+        continuation.output_port_pointers();
+    bool changed = !last_outputs.has_value();
+    if (!last_outputs.has_value()) {
+      last_outputs.emplace(outputs.size());
+    }
+    for (int64_t i = 0; i < outputs.size(); ++i) {
+      std::vector<uint8_t>& last = (*last_outputs)[i];
+      if (changed || !std::equal(last.begin(), last.end(), outputs[i])) {
+        last.assign(outputs[i], outputs[i] + output_port_sizes[i]);
+        changed = true;
+      }
+    }
+    return changed;
+  };
+
+  for (int64_t cycle = 0; cycle < cycle_count;
+       cycle += options.sample_period) {
+    int64_t segment_length =
+        std::min(options.sample_period, cycle_count - cycle);
+    if (input_generator) {
+      XLS_RETURN_IF_ERROR(
+          input_generator(cycle, continuation.input_port_pointers()));
+    }
+    XLS_RETURN_IF_ERROR(RunCyclesInJit(continuation, segment_length));
+    if (output_sink && (!options.only_changed_outputs || outputs_changed())) {
+      XLS_RETURN_IF_ERROR(output_sink(cycle + segment_length - 1,
+                                      continuation.output_port_pointers()));
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<JitArgumentSet> BlockJitContinuation::CombineBuffers(
     const JittedFunctionBase& jit_func, const JitArgumentSet& left,
     int64_t left_count, const JitArgumentSet& rest, int64_t rest_start,
@@ -343,13 +450,400 @@ absl::flat_hash_map<std::string, Value> BlockJitContinuation::GetRegistersMap()
   return result;
 }
 
+namespace {
+
+// Returns the index of the port named `name` in `ports`.
+template <typename PortT>
+absl::StatusOr<int64_t> PortIndex(absl::Span<PortT* const> ports,
+                                  std::string_view name) {
+  for (int64_t i = 0; i < ports.size(); ++i) {
+    if (ports[i]->name() == name) {
+      return i;
+    }
+  }
+  return absl::NotFoundError(absl::StrFormat("No port named `%s`", name));
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<ElaboratedBlockJit>> ElaboratedBlockJit::Create(
+    BlockElaboration&& elaboration) {
+  std::unique_ptr<ElaboratedBlockJit> jit(
+      new ElaboratedBlockJit(std::move(elaboration)));
+  absl::flat_hash_map<BlockInstance*, InstanceState*> instance_states;
+  // Children are evaluated before their parents so that, in the common case,
+  // values produced by children are available when the parent is evaluated.
+  absl::Span<BlockInstance* const> instances = jit->elaboration_.instances();
+  for (auto it = instances.rbegin(); it != instances.rend(); ++it) {
+    BlockInstance* instance = *it;
+    if (!instance->block().has_value()) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "ElaboratedBlockJit does not support non-block instance `%s`",
+          instance->ToString()));
+    }
+    Block* block = *instance->block();
+    auto [compiled_it, inserted] = jit->compiled_blocks_.try_emplace(block);
+    if (inserted) {
+      auto compiled = std::make_unique<CompiledBlock>();
+      XLS_ASSIGN_OR_RETURN(compiled->orc_jit, OrcJit::Create());
+      XLS_ASSIGN_OR_RETURN(compiled->function, JittedFunctionBase::Build(
+                                                   block, *compiled->orc_jit));
+      if (jit->runtime_ == nullptr) {
+        XLS_ASSIGN_OR_RETURN(auto data_layout,
+                             compiled->orc_jit->CreateDataLayout());
+        jit->runtime_ = std::make_unique<JitRuntime>(data_layout);
+      }
+      compiled_it->second = std::move(compiled);
+    }
+    const JittedFunctionBase& function = compiled_it->second->function;
+    jit->instances_.push_back(absl::WrapUnique(new InstanceState{
+        .instance = instance,
+        .function = &function,
+        .inputs = function.CreateInputBuffer(),
+        .outputs = function.CreateOutputBuffer(),
+        .temp_buffer = function.CreateTempBuffer(),
+        .callbacks = InstanceContext::CreateForBlock(),
+    }));
+    instance_states[instance] = jit->instances_.back().get();
+  }
+
+  // Connect each instantiation to the ports of the instantiated block.
+  int64_t connection_count = 0;
+  for (const std::unique_ptr<InstanceState>& state : jit->instances_) {
+    Block* block = *state->instance->block();
+    int64_t input_index =
+        block->GetInputPorts().size() + block->GetRegisters().size();
+    int64_t output_index =
+        block->GetOutputPorts().size() + block->GetRegisters().size();
+    for (Instantiation* instantiation : block->GetInstantiations()) {
+      InstanceState* child = instance_states.at(
+          state->instance->instantiation_to_instance().at(instantiation));
+      Block* child_block = *child->instance->block();
+      for (InstantiationInput* input :
+           block->GetInstantiationInputs(instantiation)) {
+        XLS_ASSIGN_OR_RETURN(
+            int64_t port,
+            PortIndex(child_block->GetInputPorts(), input->port_name()));
+        state->connections.push_back(Connection{
+            .source = state->outputs.pointers()[output_index],
+            .destination = child->inputs.pointers()[port],
+            .size = state->function->output_buffer_sizes()[output_index],
+        });
+        ++output_index;
+      }
+      for (InstantiationOutput* output :
+           block->GetInstantiationOutputs(instantiation)) {
+        XLS_ASSIGN_OR_RETURN(
+            int64_t port,
+            PortIndex(child_block->GetOutputPorts(), output->port_name()));
+        child->connections.push_back(Connection{
+            .source = child->outputs.pointers()[port],
+            .destination = state->inputs.pointers()[input_index],
+            .size = state->function->input_buffer_sizes()[input_index],
+        });
+        ++input_index;
+      }
+    }
+    connection_count += state->connections.size();
+  }
+  // Each evaluation settles at least one more instance boundary crossing along
+  // every combinational path, and one more is needed to observe that nothing
+  // changed.
+  jit->max_evaluations_per_cycle_ = connection_count + 2;
+  return jit;
+}
+
+bool ElaboratedBlockJit::EvaluateInstances() {
+  bool changed = false;
+  for (std::unique_ptr<InstanceState>& state : instances_) {
+    state->events.Clear();
+    state->function->RunJittedFunction(
+        state->inputs, state->outputs, state->temp_buffer, &state->events,
+        /*instance_context=*/&state->callbacks, runtime_.get(),
+        /*continuation_point=*/0);
+    for (const Connection& connection : state->connections) {
+      if (std::memcmp(connection.destination, connection.source,
+                      connection.size) != 0) {
+        std::memcpy(connection.destination, connection.source,
+                    connection.size);
+        changed = true;
+      }
+    }
+  }
+  return changed;
+}
+
+absl::Status ElaboratedBlockJit::RunOneCycle() {
+  int64_t evaluations = 1;
+  while (EvaluateInstances()) {
+    if (++evaluations > max_evaluations_per_cycle_) {
+      return absl::InternalError(absl::StrFormat(
+          "Values crossing block instance boundaries of `%s` did not settle "
+          "after %d evaluations; the hierarchy may contain a combinational "
+          "loop",
+          elaboration_.top()->ToString(), max_evaluations_per_cycle_));
+    }
+  }
+  for (std::unique_ptr<InstanceState>& state : instances_) {
+    absl::c_move(state->events.trace_msgs,
+                 std::back_inserter(events_.trace_msgs));
+    absl::c_move(state->events.assert_msgs,
+                 std::back_inserter(events_.assert_msgs));
+    // Latch the new register values.
+    Block* block = *state->instance->block();
+    int64_t input_port_count = block->GetInputPorts().size();
+    int64_t output_port_count = block->GetOutputPorts().size();
+    for (int64_t i = 0; i < block->GetRegisters().size(); ++i) {
+      std::memcpy(state->inputs.pointers()[input_port_count + i],
+                  state->outputs.pointers()[output_port_count + i],
+                  state->function->input_buffer_sizes()[input_port_count + i]);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ElaboratedBlockJit::SetInputPorts(
+    const absl::flat_hash_map<std::string, Value>& inputs) {
+  InstanceState& top = *instances_.back();
+  Block* block = *top.instance->block();
+  if (block->GetInputPorts().size() != inputs.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected %d input port values but got %d",
+                        block->GetInputPorts().size(), inputs.size()));
+  }
+  std::vector<Value> values;
+  std::vector<Type*> types;
+  values.reserve(inputs.size());
+  types.reserve(inputs.size());
+  for (InputPort* port : block->GetInputPorts()) {
+    auto it = inputs.find(port->name());
+    if (it == inputs.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Missing input for port '%s'", port->name()));
+    }
+    XLS_RET_CHECK(ValueConformsToType(it->second, port->GetType()))
+        << "input port " << port->name() << " cannot be set to value of "
+        << it->second << " due to type mismatch with input port type of "
+        << port->GetType()->ToString();
+    values.push_back(it->second);
+    types.push_back(port->GetType());
+  }
+  return runtime_->PackArgs(
+      values, types, top.inputs.pointers().subspan(0, values.size()));
+}
+
+absl::Status ElaboratedBlockJit::SetRegisters(
+    const absl::flat_hash_map<std::string, Value>& regs) {
+  int64_t register_count = 0;
+  for (std::unique_ptr<InstanceState>& state : instances_) {
+    Block* block = *state->instance->block();
+    int64_t input_port_count = block->GetInputPorts().size();
+    for (int64_t i = 0; i < block->GetRegisters().size(); ++i) {
+      Register* reg = block->GetRegisters()[i];
+      std::string name =
+          absl::StrCat(state->instance->RegisterPrefix(), reg->name());
+      auto it = regs.find(name);
+      if (it == regs.end()) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Missing value for register '%s'", name));
+      }
+      XLS_RET_CHECK(ValueConformsToType(it->second, reg->type()))
+          << "register " << name << " cannot be set to value of "
+          << it->second << " due to type mismatch with register type of "
+          << reg->type()->ToString();
+      XLS_RETURN_IF_ERROR(runtime_->PackArgs(
+          {it->second}, {reg->type()},
+          state->inputs.pointers().subspan(input_port_count + i, 1)));
+      ++register_count;
+    }
+  }
+  if (register_count != regs.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected %d register values but got %d",
+                        register_count, regs.size()));
+  }
+  return absl::OkStatus();
+}
+
+absl::flat_hash_map<std::string, Value> ElaboratedBlockJit::GetOutputPortsMap()
+    const {
+  const InstanceState& top = *instances_.back();
+  Block* block = *top.instance->block();
+  absl::flat_hash_map<std::string, Value> result;
+  result.reserve(block->GetOutputPorts().size());
+  for (int64_t i = 0; i < block->GetOutputPorts().size(); ++i) {
+    OutputPort* port = block->GetOutputPorts()[i];
+    result[port->name()] = runtime_->UnpackBuffer(top.outputs.pointers()[i],
+                                                  port->operand(0)->GetType());
+  }
+  return result;
+}
+
+absl::flat_hash_map<std::string, Value> ElaboratedBlockJit::GetRegistersMap()
+    const {
+  absl::flat_hash_map<std::string, Value> result;
+  for (const std::unique_ptr<InstanceState>& state : instances_) {
+    Block* block = *state->instance->block();
+    int64_t input_port_count = block->GetInputPorts().size();
+    for (int64_t i = 0; i < block->GetRegisters().size(); ++i) {
+      Register* reg = block->GetRegisters()[i];
+      result[absl::StrCat(state->instance->RegisterPrefix(), reg->name())] =
+          runtime_->UnpackBuffer(
+              state->inputs.pointers()[input_port_count + i], reg->type());
+    }
+  }
+  return result;
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<LaneParallelBlockJit>>
+LaneParallelBlockJit::Create(Block* block, int64_t lane_count,
+                             int64_t vector_width) {
+  XLS_RET_CHECK_GT(lane_count, 0);
+  if (!block->GetInstantiations().empty()) {
+    return absl::UnimplementedError(
+        "LaneParallelBlockJit does not support blocks with instantiations");
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
+  XLS_ASSIGN_OR_RETURN(
+      JittedFunctionBase function,
+      JittedFunctionBase::Build(block, *orc_jit,
+                                /*lane_parallel_width=*/vector_width));
+  XLS_RET_CHECK(function.HasBatchedFunction());
+  XLS_ASSIGN_OR_RETURN(auto data_layout, orc_jit->CreateDataLayout());
+  return absl::WrapUnique(new LaneParallelBlockJit(
+      block, lane_count, std::make_unique<JitRuntime>(data_layout),
+      std::move(orc_jit), std::move(function)));
+}
+
+LaneParallelBlockJit::LaneParallelBlockJit(Block* block, int64_t lane_count,
+                                           std::unique_ptr<JitRuntime> runtime,
+                                           std::unique_ptr<OrcJit> jit,
+                                           JittedFunctionBase function)
+    : block_(block),
+      lane_count_(lane_count),
+      runtime_(std::move(runtime)),
+      jit_(std::move(jit)),
+      function_(std::move(function)),
+      temp_buffer_(function_.CreateTempBuffer()),
+      callbacks_(InstanceContext::CreateForBlock()) {
+  auto allocate_arrays = [&](absl::Span<const int64_t> sizes,
+                             absl::Span<const int64_t> alignments,
+                             std::vector<uint8_t*>& arrays) {
+    for (int64_t i = 0; i < sizes.size(); ++i) {
+      int64_t bytes = std::max<int64_t>(sizes[i] * lane_count_, 1);
+      std::unique_ptr<uint8_t[], DeleteAligned> array(
+          static_cast<uint8_t*>(AllocateAligned(alignments[i], bytes)));
+      std::memset(array.get(), 0, bytes);
+      arrays.push_back(array.get());
+      memory_.push_back(std::move(array));
+    }
+  };
+  allocate_arrays(function_.input_buffer_sizes(),
+                  function_.input_buffer_preferred_alignments(), inputs_);
+  allocate_arrays(function_.output_buffer_sizes(),
+                  function_.output_buffer_preferred_alignments(), outputs_);
+}
+
+absl::Status LaneParallelBlockJit::SetInputPorts(
+    int64_t lane, const absl::flat_hash_map<std::string, Value>& inputs) {
+  XLS_RET_CHECK(lane >= 0 && lane < lane_count_) << "lane " << lane;
+  for (const auto& [name, value] : inputs) {
+    XLS_ASSIGN_OR_RETURN(int64_t index,
+                         PortIndex(block_->GetInputPorts(), name));
+    Type* type = block_->GetInputPorts()[index]->GetType();
+    XLS_RET_CHECK(ValueConformsToType(value, type))
+        << "input port " << name << " cannot be set to value of " << value
+        << " due to type mismatch with input port type of "
+        << type->ToString();
+    int64_t size = input_port_sizes()[index];
+    runtime_->BlitValueToBuffer(
+        value, type, absl::MakeSpan(inputs_[index] + lane * size, size));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status LaneParallelBlockJit::SetRegisters(
+    int64_t lane, const absl::flat_hash_map<std::string, Value>& regs) {
+  XLS_RET_CHECK(lane >= 0 && lane < lane_count_) << "lane " << lane;
+  absl::Span<Register* const> registers = block_->GetRegisters();
+  for (const auto& [name, value] : regs) {
+    XLS_ASSIGN_OR_RETURN(Register * reg, block_->GetRegister(name));
+    int64_t index = std::distance(registers.begin(),
+                                  std::find(registers.begin(),
+                                            registers.end(), reg));
+    XLS_RET_CHECK(ValueConformsToType(value, reg->type()))
+        << "register " << name << " cannot be set to value of " << value
+        << " due to type mismatch with register type of "
+        << reg->type()->ToString();
+    int64_t size = register_sizes()[index];
+    runtime_->BlitValueToBuffer(
+        value, reg->type(),
+        absl::MakeSpan(register_arrays()[index] + lane * size, size));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status LaneParallelBlockJit::RunOneCycle() {
+  function_.RunBatchedJittedFunction(
+      inputs_.data(), outputs_.data(), temp_buffer_.get(), &events_,
+      /*instance_context=*/&callbacks_, runtime_.get(),
+      /*batch_size=*/lane_count_);
+  // The next-state values of the registers become the current values.
+  int64_t input_port_count = block_->GetInputPorts().size();
+  int64_t output_port_count = block_->GetOutputPorts().size();
+  for (int64_t i = 0; i < block_->GetRegisters().size(); ++i) {
+    std::swap(inputs_[input_port_count + i], outputs_[output_port_count + i]);
+  }
+  return absl::OkStatus();
+}
+
+absl::flat_hash_map<std::string, Value> LaneParallelBlockJit::GetOutputPortsMap(
+    int64_t lane) const {
+  CHECK(lane >= 0 && lane < lane_count_) << "lane " << lane;
+  absl::flat_hash_map<std::string, Value> result;
+  result.reserve(block_->GetOutputPorts().size());
+  for (int64_t i = 0; i < block_->GetOutputPorts().size(); ++i) {
+    OutputPort* port = block_->GetOutputPorts()[i];
+    result[port->name()] =
+        runtime_->UnpackBuffer(outputs_[i] + lane * output_port_sizes()[i],
+                               port->operand(0)->GetType());
+  }
+  return result;
+}
+
+absl::flat_hash_map<std::string, Value> LaneParallelBlockJit::GetRegistersMap(
+    int64_t lane) const {
+  CHECK(lane >= 0 && lane < lane_count_) << "lane " << lane;
+  absl::flat_hash_map<std::string, Value> result;
+  result.reserve(block_->GetRegisters().size());
+  for (int64_t i = 0; i < block_->GetRegisters().size(); ++i) {
+    Register* reg = block_->GetRegisters()[i];
+    result[reg->name()] = runtime_->UnpackBuffer(
+        register_arrays()[i] + lane * register_sizes()[i], reg->type());
+  }
+  return result;
+}
+
 absl::StatusOr<BlockRunResult> JitBlockEvaluator::EvaluateBlock(
     const absl::flat_hash_map<std::string, Value>& inputs,
     const absl::flat_hash_map<std::string, Value>& reg_state,
     const BlockElaboration& elaboration) const {
   Block* top_block = *elaboration.top()->block();
-  XLS_RET_CHECK_EQ(elaboration.instances().size(), 1)
-      << "StreamingJitBlockEvaluator does not support instantiations";
+  if (elaboration.instances().size() > 1) {
+    XLS_ASSIGN_OR_RETURN(BlockElaboration owned_elaboration,
+                         BlockElaboration::Elaborate(top_block));
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<ElaboratedBlockJit> jit,
+        ElaboratedBlockJit::Create(std::move(owned_elaboration)));
+    XLS_RETURN_IF_ERROR(jit->SetInputPorts(inputs));
+    XLS_RETURN_IF_ERROR(jit->SetRegisters(reg_state));
+    XLS_RETURN_IF_ERROR(jit->RunOneCycle());
+    return BlockRunResult{
+        .outputs = jit->GetOutputPortsMap(),
+        .reg_state = jit->GetRegistersMap(),
+        .interpreter_events = jit->GetEvents(),
+    };
+  }
 
   XLS_ASSIGN_OR_RETURN(auto jit, BlockJit::Create(top_block));
   auto continuation = jit->NewContinuation();
@@ -367,6 +861,28 @@ absl::StatusOr<std::vector<absl::flat_hash_map<std::string, Value>>>
 StreamingJitBlockEvaluator::EvaluateSequentialBlock(
     Block* block,
     absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const {
+  if (!block->GetInstantiations().empty()) {
+    XLS_ASSIGN_OR_RETURN(BlockElaboration elaboration,
+                         BlockElaboration::Elaborate(block));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<ElaboratedBlockJit> jit,
+                         ElaboratedBlockJit::Create(std::move(elaboration)));
+    absl::flat_hash_map<std::string, Value> reg_state;
+    for (BlockInstance* inst : jit->elaboration().instances()) {
+      for (Register* reg : (*inst->block())->GetRegisters()) {
+        reg_state[absl::StrCat(inst->RegisterPrefix(), reg->name())] =
+            ZeroOfType(reg->type());
+      }
+    }
+    XLS_RETURN_IF_ERROR(jit->SetRegisters(reg_state));
+    std::vector<absl::flat_hash_map<std::string, Value>> outputs;
+    for (const absl::flat_hash_map<std::string, Value>& input_set : inputs) {
+      XLS_RETURN_IF_ERROR(jit->SetInputPorts(input_set));
+      XLS_RETURN_IF_ERROR(jit->RunOneCycle());
+      outputs.push_back(jit->GetOutputPortsMap());
+    }
+    return std::move(outputs);
+  }
+
   // Initial register state is zero for all registers.
   absl::flat_hash_map<std::string, Value> reg_state;
   for (Register* reg : block->GetRegisters()) {
@@ -502,6 +1018,45 @@ class BlockContinuationJitWrapper final : public BlockContinuation {
   // copying.
   std::optional<absl::flat_hash_map<std::string, Value>> temporary_regs_;
 };
+
+// As above but for a block hierarchy with instantiations.
+class ElaboratedBlockContinuationJitWrapper final : public BlockContinuation {
+ public:
+  explicit ElaboratedBlockContinuationJitWrapper(
+      std::unique_ptr<ElaboratedBlockJit>&& jit)
+      : jit_(std::move(jit)) {}
+  const absl::flat_hash_map<std::string, Value>& output_ports() final {
+    if (!temporary_outputs_) {
+      temporary_outputs_.emplace(jit_->GetOutputPortsMap());
+    }
+    return *temporary_outputs_;
+  }
+  const absl::flat_hash_map<std::string, Value>& registers() final {
+    if (!temporary_regs_) {
+      temporary_regs_.emplace(jit_->GetRegistersMap());
+    }
+    return *temporary_regs_;
+  }
+  const InterpreterEvents& events() final { return jit_->GetEvents(); }
+  absl::Status RunOneCycle(
+      const absl::flat_hash_map<std::string, Value>& inputs) final {
+    temporary_outputs_.reset();
+    temporary_regs_.reset();
+    jit_->ClearEvents();
+    XLS_RETURN_IF_ERROR(jit_->SetInputPorts(inputs));
+    return jit_->RunOneCycle();
+  }
+  absl::Status SetRegisters(
+      const absl::flat_hash_map<std::string, Value>& regs) final {
+    temporary_regs_.reset();
+    return jit_->SetRegisters(regs);
+  }
+
+ private:
+  std::unique_ptr<ElaboratedBlockJit> jit_;
+  std::optional<absl::flat_hash_map<std::string, Value>> temporary_outputs_;
+  std::optional<absl::flat_hash_map<std::string, Value>> temporary_regs_;
+};
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<BlockContinuation>>
@@ -509,8 +1064,13 @@ StreamingJitBlockEvaluator::NewContinuation(
     BlockElaboration&& elaboration,
     const absl::flat_hash_map<std::string, Value>& initial_registers) const {
   Block* top_block = *elaboration.top()->block();
-  XLS_RET_CHECK_EQ(elaboration.instances().size(), 1)
-      << "StreamingJitBlockEvaluator does not support instantiations";
+  if (elaboration.instances().size() > 1) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<ElaboratedBlockJit> jit,
+                         ElaboratedBlockJit::Create(std::move(elaboration)));
+    XLS_RETURN_IF_ERROR(jit->SetRegisters(initial_registers));
+    return std::make_unique<ElaboratedBlockContinuationJitWrapper>(
+        std::move(jit));
+  }
   XLS_ASSIGN_OR_RETURN(auto jit, BlockJit::Create(top_block));
   auto jit_cont = jit->NewContinuation();
   XLS_RETURN_IF_ERROR(jit_cont->SetRegisters(initial_registers));
@@ -19,6 +19,7 @@
 
 #include <array>
 #include <cstdint>
+#include <functional>
 #include <initializer_list>
 #include <memory>
 #include <optional>
@@ -35,6 +36,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/block_evaluator.h"
 #include "xls/ir/block.h"
+#include "xls/ir/block_elaboration.h"
 #include "xls/ir/elaboration.h"
 #include "xls/ir/events.h"
 #include "xls/ir/value.h"
@@ -42,6 +44,7 @@
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_callbacks.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
 
 namespace xls {
@@ -51,6 +54,14 @@ class BlockJit {
  public:
   static absl::StatusOr<std::unique_ptr<BlockJit>> Create(Block* block);
 
+  // Returns the bytes of an object file containing the compiled XLS block. The
+  // entry point has the same ABI as the jitted function of a BlockJit: the
+  // inputs are the input ports followed by the registers and the outputs are
+  // the output ports followed by the next values of the registers.
+  static absl::StatusOr<JitObjectCode> CreateObjectCode(
+      Block* block, int64_t opt_level, bool include_msan,
+      JitObserver* observer = nullptr);
+
   // Create a new blank block with no registers or ports set. Can be cycled
   // independently of other blocks/continuations.
   std::unique_ptr<BlockJitContinuation> NewContinuation();
@@ -58,6 +69,45 @@ class BlockJit {
   // Runs a single cycle of a block with the given continuation.
   absl::Status RunOneCycle(BlockJitContinuation& continuation);
 
+  // Called by RunCycles before the cycle `cycle` (counted from the start of the
+  // RunCycles call) at each sample point. `input_ports` are the native-layout
+  // buffers of the input ports (see
+  // BlockJitContinuation::input_port_pointers); ports which are not written
+  // keep their previous values.
+  using InputGenerator = std::function<absl::Status(
+      int64_t cycle, absl::Span<uint8_t* const> input_ports)>;
+  // Called by RunCycles after the cycle `cycle` at each sample point with the
+  // native-layout buffers of the output ports.
+  using OutputSink = std::function<absl::Status(
+      int64_t cycle, absl::Span<const uint8_t* const> output_ports)>;
+
+  struct RunCyclesOptions {
+    // The number of cycles between sample points. The cycles between sample
+    // points run entirely in jitted code without returning to the caller.
+    int64_t sample_period = 1;
+    // If true, `output_sink` is only called at sample points where the output
+    // ports differ from the values last passed to it.
+    bool only_changed_outputs = false;
+  };
+
+  // Runs `cycle_count` cycles of the block with the given continuation. This is
+  // equivalent to calling RunOneCycle `cycle_count` times but the cycle loop
+  // and register swapping are performed in jitted code so there is no
+  // per-cycle host overhead between sample points. Either callback may be
+  // null. Errors returned by a callback stop the run and are returned.
+  absl::Status RunCycles(BlockJitContinuation& continuation,
+                         int64_t cycle_count,
+                         const InputGenerator& input_generator,
+                         const OutputSink& output_sink,
+                         const RunCyclesOptions& options);
+  absl::Status RunCycles(BlockJitContinuation& continuation,
+                         int64_t cycle_count,
+                         const InputGenerator& input_generator = nullptr,
+                         const OutputSink& output_sink = nullptr) {
+    return RunCycles(continuation, cycle_count, input_generator, output_sink,
+                     RunCyclesOptions());
+  }
+
   OrcJit& orc_jit() const { return *jit_; }
 
   JitRuntime* runtime() const { return runtime_.get(); }
@@ -75,6 +125,10 @@ class BlockJit {
   }
 
  private:
+  // Runs `cycle_count` cycles without calling back to the host.
+  absl::Status RunCyclesInJit(BlockJitContinuation& continuation,
+                              int64_t cycle_count);
+
   BlockJit(Block* block, std::unique_ptr<JitRuntime> runtime,
            std::unique_ptr<OrcJit> jit, JittedFunctionBase function)
       : block_(block),
@@ -258,6 +312,195 @@ class BlockJitContinuation {
   friend class BlockJit;
 };
 
+// Jit which simulates many independent instances ("lanes") of a block at once,
+// for example to run a design against many stimulus sets or seeds.
+//
+// Ports and registers are stored structure-of-arrays: the values of a port or
+// register for all lanes are contiguous in native layout, the value for lane
+// `l` being at offset `l * size` of its array. Each cycle is evaluated by a
+// single call to the batched entry point of the compiled block. If the block
+// is lane-parallelizable (see CheckLaneParallelizable) that entry point
+// evaluates `vector_width` lanes at a time with LLVM vector operations;
+// otherwise it loops over the lanes with the scalar block code.
+//
+// Events raised by any lane are collected together. Not thread safe.
+class LaneParallelBlockJit {
+ public:
+  static constexpr int64_t kDefaultVectorWidth = 8;
+
+  // `vector_width` must be a power of two. `lane_count` need not be a multiple
+  // of it. Blocks with instantiations are not supported.
+  static absl::StatusOr<std::unique_ptr<LaneParallelBlockJit>> Create(
+      Block* block, int64_t lane_count,
+      int64_t vector_width = kDefaultVectorWidth);
+
+  int64_t lane_count() const { return lane_count_; }
+
+  // Returns whether the lanes are evaluated with vector operations.
+  bool vectorized() const { return function_.batched_lane_count() > 1; }
+
+  // Sets the given input ports of lane `lane`. Ports not in `inputs` keep
+  // their values.
+  absl::Status SetInputPorts(
+      int64_t lane, const absl::flat_hash_map<std::string, Value>& inputs);
+  // Sets the given registers of lane `lane`. Registers not in `regs` keep
+  // their values.
+  absl::Status SetRegisters(
+      int64_t lane, const absl::flat_hash_map<std::string, Value>& regs);
+
+  // Runs a single cycle of every lane.
+  absl::Status RunOneCycle();
+
+  absl::flat_hash_map<std::string, Value> GetOutputPortsMap(
+      int64_t lane) const;
+  absl::flat_hash_map<std::string, Value> GetRegistersMap(int64_t lane) const;
+
+  // The arrays holding the values of each input port (in
+  // Block::GetInputPorts() order) for all lanes. Written values are used by the
+  // next cycle.
+  absl::Span<uint8_t* const> input_port_arrays() const {
+    return absl::MakeConstSpan(inputs_).subspan(
+        0, block_->GetInputPorts().size());
+  }
+  // The arrays holding the values of each output port for all lanes.
+  absl::Span<uint8_t const* const> output_port_arrays() const {
+    return absl::MakeConstSpan(outputs_).subspan(
+        0, block_->GetOutputPorts().size());
+  }
+  // The arrays holding the current values of each register for all lanes.
+  absl::Span<uint8_t* const> register_arrays() const {
+    return absl::MakeConstSpan(inputs_).subspan(block_->GetInputPorts().size());
+  }
+
+  // The size of the value of one lane of each input port, output port and
+  // register.
+  absl::Span<const int64_t> input_port_sizes() const {
+    return absl::MakeConstSpan(function_.input_buffer_sizes())
+        .subspan(0, block_->GetInputPorts().size());
+  }
+  absl::Span<const int64_t> output_port_sizes() const {
+    return absl::MakeConstSpan(function_.output_buffer_sizes())
+        .subspan(0, block_->GetOutputPorts().size());
+  }
+  absl::Span<const int64_t> register_sizes() const {
+    return absl::MakeConstSpan(function_.input_buffer_sizes())
+        .subspan(block_->GetInputPorts().size());
+  }
+
+  const InterpreterEvents& GetEvents() const { return events_; }
+  void ClearEvents() { events_.Clear(); }
+
+  JitRuntime* runtime() const { return runtime_.get(); }
+
+ private:
+  LaneParallelBlockJit(Block* block, int64_t lane_count,
+                       std::unique_ptr<JitRuntime> runtime,
+                       std::unique_ptr<OrcJit> jit,
+                       JittedFunctionBase function);
+
+  Block* block_;
+  int64_t lane_count_;
+  std::unique_ptr<JitRuntime> runtime_;
+  std::unique_ptr<OrcJit> jit_;
+  JittedFunctionBase function_;
+
+  // Storage for the arrays of the inputs (<input ports><registers>) and outputs
+  // (<output ports><registers>) of the block.
+  std::vector<std::unique_ptr<uint8_t[], DeleteAligned>> memory_;
+  // The arrays passed to the jitted code. The register arrays are exchanged
+  // between the two after each cycle so the next-state values become current.
+  std::vector<uint8_t*> inputs_;
+  std::vector<uint8_t*> outputs_;
+
+  JitTempBuffer temp_buffer_;
+  InstanceContext callbacks_;
+  InterpreterEvents events_;
+};
+
+// Jit for a block hierarchy with instantiations of other blocks. Each distinct
+// block of the elaboration is compiled once and every instance of it is
+// evaluated by calling the same compiled code with its own port, register and
+// scratch storage, so the hierarchy need not be flattened first.
+//
+// Values crossing instance boundaries are copied between the instances after
+// each instance is evaluated. Combinational paths may cross instance
+// boundaries any number of times so a cycle evaluates the instances
+// repeatedly until no boundary value changes. Only the events of the final
+// evaluation of each instance are reported.
+//
+// Holds the state of a single simulation of the hierarchy. Not thread safe.
+class ElaboratedBlockJit {
+ public:
+  static absl::StatusOr<std::unique_ptr<ElaboratedBlockJit>> Create(
+      BlockElaboration&& elaboration);
+
+  // Overwrite all input ports of the top block with the given values.
+  absl::Status SetInputPorts(
+      const absl::flat_hash_map<std::string, Value>& inputs);
+  // Overwrite all registers of the hierarchy with the given values. Registers
+  // are named hierarchically (see BlockInstance::RegisterPrefix).
+  absl::Status SetRegisters(
+      const absl::flat_hash_map<std::string, Value>& regs);
+
+  // Runs a single cycle of the hierarchy.
+  absl::Status RunOneCycle();
+
+  absl::flat_hash_map<std::string, Value> GetOutputPortsMap() const;
+  absl::flat_hash_map<std::string, Value> GetRegistersMap() const;
+
+  const InterpreterEvents& GetEvents() const { return events_; }
+  void ClearEvents() { events_.Clear(); }
+
+  const BlockElaboration& elaboration() const { return elaboration_; }
+
+ private:
+  // The compiled code for one distinct block.
+  struct CompiledBlock {
+    std::unique_ptr<OrcJit> orc_jit;
+    JittedFunctionBase function;
+  };
+
+  // A value copied from one buffer to another after an instance is evaluated.
+  struct Connection {
+    const uint8_t* source;
+    uint8_t* destination;
+    int64_t size;
+  };
+
+  // The storage of a single instance. The inputs are organized as
+  // <input ports><registers><instantiation outputs> and the outputs as
+  // <output ports><registers><instantiation inputs>.
+  struct InstanceState {
+    BlockInstance* instance;
+    const JittedFunctionBase* function;
+    JitArgumentSet inputs;
+    JitArgumentSet outputs;
+    JitTempBuffer temp_buffer;
+    InstanceContext callbacks;
+    InterpreterEvents events;
+    // Values produced by this instance which are consumed by its parent or
+    // children.
+    std::vector<Connection> connections;
+  };
+
+  explicit ElaboratedBlockJit(BlockElaboration&& elaboration)
+      : elaboration_(std::move(elaboration)) {}
+
+  // Evaluates every instance once and propagates the values crossing instance
+  // boundaries. Returns whether any such value changed.
+  bool EvaluateInstances();
+
+  BlockElaboration elaboration_;
+  std::unique_ptr<JitRuntime> runtime_;
+  absl::flat_hash_map<Block*, std::unique_ptr<CompiledBlock>> compiled_blocks_;
+  // Instances ordered with children before their parents. The top instance is
+  // last.
+  std::vector<std::unique_ptr<InstanceState>> instances_;
+  // The maximum number of times a cycle evaluates the instances.
+  int64_t max_evaluations_per_cycle_ = 0;
+  InterpreterEvents events_;
+};
+
 // Most basic jit-evaluator. This is basically only for testing the core
 // jit-behaviors in isolation from the continuation update behaviors.
 class JitBlockEvaluator : public BlockEvaluator {
@@ -15,17 +15,32 @@
 #include "xls/jit/block_jit.h"
 
 #include <cstdint>
+#include <cstring>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/common/status/matchers.h"
 #include "xls/interpreter/block_evaluator_test_base.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/block_elaboration.h"
 #include "xls/ir/function_builder.h"
+#include "xls/ir/instantiation.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/package.h"
+#include "xls/ir/register.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_view.h"
 #include "xls/jit/jit_runtime.h"
@@ -33,7 +48,10 @@
 namespace xls {
 namespace {
 
+using status_testing::StatusIs;
 using testing::ElementsAre;
+using testing::Pair;
+using testing::UnorderedElementsAre;
 
 class BlockJitTest : public IrTestBase {};
 TEST_F(BlockJitTest, ConstantToPort) {
@@ -167,13 +185,309 @@ TEST_F(BlockJitTest, SetRegistersWithViews) {
                   testing::Pair("test1", Value(UBits(0, 16))),
                   testing::Pair("test2", Value(UBits(0, 16)))));
 }
+// Builds a block with an accumulator register `acc` which adds input port `x`
+// each cycle, a register `prev` holding the previous value of `acc` and an
+// output port `out` driven by `acc`.
+absl::StatusOr<Block*> BuildAccumulatorBlock(std::string_view name,
+                                             Package* p) {
+  BlockBuilder bb(name, p);
+  XLS_RETURN_IF_ERROR(bb.block()->AddClockPort("clk"));
+  XLS_ASSIGN_OR_RETURN(Register * acc,
+                       bb.block()->AddRegister("acc", p->GetBitsType(32)));
+  XLS_ASSIGN_OR_RETURN(Register * prev,
+                       bb.block()->AddRegister("prev", p->GetBitsType(32)));
+  BValue x = bb.InputPort("x", p->GetBitsType(32));
+  BValue acc_value = bb.RegisterRead(acc);
+  bb.RegisterWrite(acc, bb.Add(acc_value, x));
+  bb.RegisterWrite(prev, acc_value);
+  bb.RegisterRead(prev);
+  bb.OutputPort("out", acc_value);
+  return bb.Build();
+}
+
+TEST_F(BlockJitTest, RunCycles) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b,
+                           BuildAccumulatorBlock(TestName(), p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b));
+  auto cont = jit->NewContinuation();
+  XLS_ASSERT_OK(cont->SetRegisters(
+      std::vector<Value>{Value(UBits(0, 32)), Value(UBits(0, 32))}));
+  XLS_ASSERT_OK(cont->SetInputPorts({Value(UBits(3, 32))}));
+
+  XLS_ASSERT_OK(jit->RunCycles(*cont, 7));
+  EXPECT_THAT(cont->GetRegistersMap(),
+              testing::UnorderedElementsAre(
+                  testing::Pair("acc", Value(UBits(21, 32))),
+                  testing::Pair("prev", Value(UBits(18, 32)))));
+  EXPECT_THAT(cont->GetOutputPorts(), ElementsAre(Value(UBits(18, 32))));
+
+  // An even number of cycles leaves the register spaces as they were.
+  XLS_ASSERT_OK(jit->RunCycles(*cont, 2));
+  EXPECT_THAT(cont->GetRegistersMap(),
+              testing::UnorderedElementsAre(
+                  testing::Pair("acc", Value(UBits(27, 32))),
+                  testing::Pair("prev", Value(UBits(24, 32)))));
+
+  // Single cycles still work after running in the jitted loop.
+  XLS_ASSERT_OK(jit->RunOneCycle(*cont));
+  EXPECT_THAT(cont->GetOutputPorts(), ElementsAre(Value(UBits(27, 32))));
+}
+
+TEST_F(BlockJitTest, RunCyclesMatchesRunOneCycle) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b,
+                           BuildAccumulatorBlock(TestName(), p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b));
+  constexpr int64_t kCycles = 20;
+  constexpr int64_t kSamplePeriod = 3;
+
+  // Reference: set `x` to the cycle number at each sample point.
+  auto expected_cont = jit->NewContinuation();
+  XLS_ASSERT_OK(expected_cont->SetRegisters(
+      std::vector<Value>{Value(UBits(0, 32)), Value(UBits(0, 32))}));
+  std::vector<std::pair<int64_t, Value>> expected;
+  for (int64_t cycle = 0; cycle < kCycles; ++cycle) {
+    if (cycle % kSamplePeriod == 0) {
+      XLS_ASSERT_OK(expected_cont->SetInputPorts({Value(UBits(cycle, 32))}));
+    }
+    XLS_ASSERT_OK(jit->RunOneCycle(*expected_cont));
+    if (cycle % kSamplePeriod == kSamplePeriod - 1 || cycle == kCycles - 1) {
+      expected.push_back({cycle, expected_cont->GetOutputPorts()[0]});
+    }
+  }
+
+  auto cont = jit->NewContinuation();
+  XLS_ASSERT_OK(cont->SetRegisters(
+      std::vector<Value>{Value(UBits(0, 32)), Value(UBits(0, 32))}));
+  std::vector<std::pair<int64_t, Value>> actual;
+  XLS_ASSERT_OK(jit->RunCycles(
+      *cont, kCycles,
+      [](int64_t cycle, absl::Span<uint8_t* const> inputs) {
+        uint32_t x = cycle;
+        std::memcpy(inputs[0], &x, sizeof(x));
+        return absl::OkStatus();
+      },
+      [&](int64_t cycle, absl::Span<const uint8_t* const> outputs) {
+        uint32_t out;
+        std::memcpy(&out, outputs[0], sizeof(out));
+        actual.push_back({cycle, Value(UBits(out, 32))});
+        return absl::OkStatus();
+      },
+      BlockJit::RunCyclesOptions{.sample_period = kSamplePeriod}));
+  EXPECT_EQ(actual, expected);
+  EXPECT_EQ(cont->GetRegisters(), expected_cont->GetRegisters());
+}
+
+TEST_F(BlockJitTest, RunCyclesOnlyChangedOutputs) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b,
+                           BuildAccumulatorBlock(TestName(), p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b));
+  auto cont = jit->NewContinuation();
+  XLS_ASSERT_OK(cont->SetRegisters(
+      std::vector<Value>{Value(UBits(5, 32)), Value(UBits(0, 32))}));
+  // With a zero input the accumulator never changes.
+  XLS_ASSERT_OK(cont->SetInputPorts({Value(UBits(0, 32))}));
+
+  std::vector<int64_t> sampled_cycles;
+  XLS_ASSERT_OK(jit->RunCycles(
+      *cont, 10, /*input_generator=*/nullptr,
+      [&](int64_t cycle, absl::Span<const uint8_t* const> outputs) {
+        sampled_cycles.push_back(cycle);
+        return absl::OkStatus();
+      },
+      BlockJit::RunCyclesOptions{.sample_period = 2,
+                                 .only_changed_outputs = true}));
+  EXPECT_THAT(sampled_cycles, ElementsAre(1));
+}
+
+TEST_F(BlockJitTest, RunCyclesCallbackError) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b,
+                           BuildAccumulatorBlock(TestName(), p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b));
+  auto cont = jit->NewContinuation();
+  EXPECT_THAT(
+      jit->RunCycles(*cont, 10,
+                     [](int64_t cycle, absl::Span<uint8_t* const> inputs) {
+                       return absl::InternalError("stop");
+                     }),
+      status_testing::StatusIs(absl::StatusCode::kInternal));
+}
+
+TEST_F(BlockJitTest, ElaboratedChainedAccumulators) {
+  auto p = CreatePackage();
+  Type* u32 = p->GetBitsType(32);
+  Block* accumulator;
+  {
+    BlockBuilder bb(absl::StrCat(TestName(), "_accumulator"), p.get());
+    XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+    XLS_ASSERT_OK_AND_ASSIGN(Register * r, bb.block()->AddRegister("r", u32));
+    BValue sum = bb.Add(bb.InputPort("x", u32), bb.RegisterRead(r));
+    bb.RegisterWrite(r, sum);
+    bb.OutputPort("sum", sum);
+    XLS_ASSERT_OK_AND_ASSIGN(accumulator, bb.Build());
+  }
+  // Two instances of the same block where the output of the first feeds the
+  // second combinationally.
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BlockInstantiation * a,
+      bb.block()->AddBlockInstantiation("a", accumulator));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BlockInstantiation * b,
+      bb.block()->AddBlockInstantiation("b", accumulator));
+  bb.InstantiationInput(a, "x", bb.InputPort("in", u32));
+  bb.InstantiationInput(b, "x", bb.InstantiationOutput(a, "sum"));
+  bb.OutputPort("out", bb.InstantiationOutput(b, "sum"));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * top, bb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(BlockElaboration elaboration,
+                           BlockElaboration::Elaborate(top));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ElaboratedBlockJit> jit,
+      ElaboratedBlockJit::Create(std::move(elaboration)));
+  XLS_ASSERT_OK(jit->SetRegisters(
+      {{"a::r", Value(UBits(0, 32))}, {"b::r", Value(UBits(0, 32))}}));
+
+  XLS_ASSERT_OK(jit->SetInputPorts({{"in", Value(UBits(1, 32))}}));
+  XLS_ASSERT_OK(jit->RunOneCycle());
+  EXPECT_THAT(jit->GetOutputPortsMap(),
+              UnorderedElementsAre(Pair("out", Value(UBits(1, 32)))));
+
+  XLS_ASSERT_OK(jit->SetInputPorts({{"in", Value(UBits(2, 32))}}));
+  XLS_ASSERT_OK(jit->RunOneCycle());
+  EXPECT_THAT(jit->GetOutputPortsMap(),
+              UnorderedElementsAre(Pair("out", Value(UBits(4, 32)))));
+  EXPECT_THAT(jit->GetRegistersMap(),
+              UnorderedElementsAre(Pair("a::r", Value(UBits(3, 32))),
+                                   Pair("b::r", Value(UBits(4, 32)))));
+}
+
+// Builds a block with a counter register `count` which adds input port `step`
+// when `en` is set and is reset to 5 when `rst` is set. If `use_division` is
+// set the output is `count / 3`, which cannot be lane-parallelized, otherwise
+// it is `count`.
+absl::StatusOr<Block*> BuildCounterBlock(std::string_view name, Package* p,
+                                         bool use_division) {
+  BlockBuilder bb(name, p);
+  XLS_RETURN_IF_ERROR(bb.block()->AddClockPort("clk"));
+  XLS_ASSIGN_OR_RETURN(
+      Register * count,
+      bb.block()->AddRegister(
+          "count", p->GetBitsType(8),
+          Reset{.reset_value = Value(UBits(5, 8)),
+                .asynchronous = false,
+                .active_low = false}));
+  BValue en = bb.InputPort("en", p->GetBitsType(1));
+  BValue rst = bb.InputPort("rst", p->GetBitsType(1));
+  BValue step = bb.InputPort("step", p->GetBitsType(8));
+  BValue count_value = bb.RegisterRead(count);
+  bb.RegisterWrite(count, bb.Add(count_value, step), en, rst);
+  bb.OutputPort("out", use_division
+                           ? bb.UDiv(count_value, bb.Literal(UBits(3, 8)))
+                           : count_value);
+  return bb.Build();
+}
+
+// Runs `lane_count` lanes of `block` with a LaneParallelBlockJit and checks
+// every lane against a separate BlockJit simulation with the same inputs.
+void ExpectLaneParallelMatchesBlockJit(Block* block, int64_t lane_count,
+                                       bool expect_vectorized) {
+  constexpr int64_t kCycles = 12;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<LaneParallelBlockJit> lanes,
+      LaneParallelBlockJit::Create(block, lane_count, /*vector_width=*/4));
+  EXPECT_EQ(lanes->vectorized(), expect_vectorized);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  std::vector<std::unique_ptr<BlockJitContinuation>> continuations;
+  for (int64_t lane = 0; lane < lane_count; ++lane) {
+    absl::flat_hash_map<std::string, Value> regs = {
+        {"count", Value(UBits(lane, 8))}};
+    XLS_ASSERT_OK(lanes->SetRegisters(lane, regs));
+    continuations.push_back(jit->NewContinuation());
+    XLS_ASSERT_OK(continuations.back()->SetRegisters(regs));
+  }
+  for (int64_t cycle = 0; cycle < kCycles; ++cycle) {
+    for (int64_t lane = 0; lane < lane_count; ++lane) {
+      absl::flat_hash_map<std::string, Value> inputs = {
+          {"en", Value(UBits((cycle + lane) % 3 != 0, 1))},
+          {"rst", Value(UBits((cycle * lane) % 7 == 6, 1))},
+          {"step", Value(UBits(lane * 7 + cycle, 8))}};
+      XLS_ASSERT_OK(lanes->SetInputPorts(lane, inputs));
+      XLS_ASSERT_OK(continuations[lane]->SetInputPorts(inputs));
+      XLS_ASSERT_OK(jit->RunOneCycle(*continuations[lane]));
+    }
+    XLS_ASSERT_OK(lanes->RunOneCycle());
+    for (int64_t lane = 0; lane < lane_count; ++lane) {
+      EXPECT_EQ(lanes->GetOutputPortsMap(lane),
+                continuations[lane]->GetOutputPortsMap())
+          << "cycle " << cycle << " lane " << lane;
+      EXPECT_EQ(lanes->GetRegistersMap(lane),
+                continuations[lane]->GetRegistersMap())
+          << "cycle " << cycle << " lane " << lane;
+    }
+  }
+}
+
+TEST_F(BlockJitTest, LaneParallelCounter) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * b,
+      BuildCounterBlock(TestName(), p.get(), /*use_division=*/false));
+  // Not a multiple of the vector width so the scalar tail is exercised too.
+  ExpectLaneParallelMatchesBlockJit(b, /*lane_count=*/11,
+                                    /*expect_vectorized=*/true);
+}
+
+TEST_F(BlockJitTest, LaneParallelFallsBackToScalarLanes) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * b, BuildCounterBlock(TestName(), p.get(), /*use_division=*/true));
+  ExpectLaneParallelMatchesBlockJit(b, /*lane_count=*/5,
+                                    /*expect_vectorized=*/false);
+}
+
+TEST_F(BlockJitTest, LaneParallelSoAInputArrays) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * b,
+      BuildCounterBlock(TestName(), p.get(), /*use_division=*/false));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<LaneParallelBlockJit> lanes,
+      LaneParallelBlockJit::Create(b, /*lane_count=*/8));
+  // Write the ports of every lane directly into the per-port arrays.
+  absl::Span<uint8_t* const> ports = lanes->input_port_arrays();
+  for (int64_t lane = 0; lane < 8; ++lane) {
+    ports[0][lane * lanes->input_port_sizes()[0]] = 1;     // en
+    ports[1][lane * lanes->input_port_sizes()[1]] = 0;     // rst
+    ports[2][lane * lanes->input_port_sizes()[2]] = lane;  // step
+  }
+  XLS_ASSERT_OK(lanes->RunOneCycle());
+  XLS_ASSERT_OK(lanes->RunOneCycle());
+  for (int64_t lane = 0; lane < 8; ++lane) {
+    EXPECT_THAT(lanes->GetRegistersMap(lane),
+                UnorderedElementsAre(Pair("count", Value(UBits(2 * lane, 8)))));
+    EXPECT_EQ(lanes->output_port_arrays()[0][lane], lane);
+  }
+  EXPECT_THAT(lanes->SetInputPorts(8, {{"en", Value(UBits(1, 1))}}),
+              StatusIs(absl::StatusCode::kInternal));
+  EXPECT_THAT(lanes->SetInputPorts(0, {{"nope", Value(UBits(1, 1))}}),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     JitBlockCommonTest, BlockEvaluatorTest,
     testing::Values(
         BlockEvaluatorTestParam{.evaluator = &kJitBlockEvaluator,
-                                .supports_hierarhical_blocks = false},
+                                .supports_hierarhical_blocks = true,
+                                .supports_fifos = false},
         BlockEvaluatorTestParam{.evaluator = &kStreamingJitBlockEvaluator,
-                                .supports_hierarhical_blocks = false}),
+                                .supports_hierarhical_blocks = true,
+                                .supports_fifos = false}),
     [](const auto& v) { return std::string(v.param.evaluator->name()); });
 
 }  // namespace
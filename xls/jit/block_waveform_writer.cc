@@ -0,0 +1,482 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/jit/block_waveform_writer.h"
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "llvm/include/llvm/IR/DataLayout.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/block_evaluator.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/register.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/block_jit.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
+#include "zlib.h"
+
+namespace xls {
+namespace {
+
+// The pending chunk is handed to the writer thread once it holds this many
+// bytes of values or this many changes.
+constexpr int64_t kChunkBytes = 1 << 18;
+constexpr int64_t kChunkChanges = 1 << 14;
+// The simulation thread blocks once this many chunks are waiting to be
+// written.
+constexpr int64_t kMaxQueuedChunks = 16;
+constexpr int64_t kFileBufferSize = 1 << 18;
+
+// Native layout of the clock (a bits[1]) when high and low.
+constexpr uint8_t kClockHigh = 1;
+constexpr uint8_t kClockLow = 0;
+
+// Returns the VCD identifier code of the `index`-th signal: a base-94 number
+// using the printable characters '!' to '~' as digits.
+std::string VcdIdentifier(int64_t index) {
+  std::string id;
+  do {
+    id.push_back(static_cast<char>('!' + index % 94));
+    index /= 94;
+  } while (index > 0);
+  return id;
+}
+
+// Appends the bits of `value` to `out`, most significant first, flattened in
+// the same order as Value::FlattenTo.
+void AppendFlatBits(const Value& value, std::string& out) {
+  auto append_bits = [&](const Bits& bits) {
+    for (int64_t i = bits.bit_count() - 1; i >= 0; --i) {
+      out.push_back(bits.Get(i) ? '1' : '0');
+    }
+  };
+  if (value.IsBits()) {
+    append_bits(value.bits());
+  } else if (value.IsPackedBitsArray()) {
+    for (int64_t i = 0; i < value.size(); ++i) {
+      append_bits(value.GetBitsElement(i));
+    }
+  } else if (value.IsTuple() || value.IsArray()) {
+    for (const Value& element : value.elements()) {
+      AppendFlatBits(element, out);
+    }
+  }
+}
+
+absl::Span<const uint8_t* const> AsConst(absl::Span<uint8_t* const> values) {
+  return absl::MakeConstSpan(
+      reinterpret_cast<const uint8_t* const*>(values.data()), values.size());
+}
+
+}  // namespace
+
+// A (possibly gzip-compressed) output file.
+class BlockWaveformWriter::File {
+ public:
+  static absl::StatusOr<std::unique_ptr<File>> Open(
+      const std::filesystem::path& path, bool compress) {
+    // "T" writes the file uncompressed through the same interface.
+    gzFile file = gzopen(path.c_str(), compress ? "wb6" : "wbT");
+    if (file == nullptr) {
+      return absl::UnavailableError(
+          absl::StrFormat("Unable to open %s for writing", path.string()));
+    }
+    gzbuffer(file, kFileBufferSize);
+    return absl::WrapUnique(new File(file, path));
+  }
+
+  ~File() {
+    if (file_ != nullptr) {
+      gzclose(file_);
+    }
+  }
+
+  absl::Status Write(std::string_view text) {
+    if (text.empty()) {
+      return absl::OkStatus();
+    }
+    if (gzwrite(file_, text.data(), text.size()) !=
+        static_cast<int>(text.size())) {
+      return absl::UnavailableError(
+          absl::StrFormat("Unable to write waveform %s", path_.string()));
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Close() {
+    int result = gzclose(file_);
+    file_ = nullptr;
+    if (result != Z_OK) {
+      return absl::UnavailableError(
+          absl::StrFormat("Unable to write waveform %s", path_.string()));
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  File(gzFile file, std::filesystem::path path)
+      : file_(file), path_(std::move(path)) {}
+
+  gzFile file_;
+  std::filesystem::path path_;
+};
+
+/* static */ absl::StatusOr<std::unique_ptr<BlockWaveformWriter>>
+BlockWaveformWriter::Create(Block* block, const std::filesystem::path& path,
+                            const Options& options) {
+  if (options.clock_period < 2 || options.clock_period % 2 != 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Waveform clock period must be even and positive, got %d",
+        options.clock_period));
+  }
+  // The values are compared and queued in the native layout of the JIT on this
+  // host.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
+  XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
+                       orc_jit->CreateDataLayout());
+  JitRuntime runtime(data_layout);
+
+  std::vector<Signal> signals;
+  int64_t offset = 0;
+  auto add_signal = [&](std::string_view name, Type* type) {
+    const TypeLayout& layout = runtime.GetTypeLayout(type);
+    signals.push_back(Signal{.name = std::string(name),
+                             .layout = layout,
+                             .bit_count = type->GetFlatBitCount(),
+                             .id = VcdIdentifier(signals.size()),
+                             .offset = offset});
+    offset += layout.size();
+  };
+  add_signal(block->GetClockPort().has_value()
+                 ? block->GetClockPort()->name
+                 : "clk",
+             block->package()->GetBitsType(1));
+  for (InputPort* port : block->GetInputPorts()) {
+    add_signal(port->name(), port->GetType());
+  }
+  for (OutputPort* port : block->GetOutputPorts()) {
+    add_signal(port->name(), port->operand(0)->GetType());
+  }
+  for (Register* reg : block->GetRegisters()) {
+    add_signal(reg->name(), reg->type());
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<File> file,
+                       File::Open(path, options.compress));
+  auto writer = absl::WrapUnique(new BlockWaveformWriter(
+      block, options, std::move(signals), std::move(file)));
+
+  // Write the header; values are unknown until they are first recorded.
+  std::string header = absl::StrFormat(
+      "$version XLS block waveform writer $end\n"
+      "$timescale %s $end\n"
+      "$scope module %s $end\n",
+      options.timescale, block->name());
+  const std::vector<Signal>& sigs = writer->signals_;
+  auto declare = [&](int64_t begin, int64_t end, std::string_view kind) {
+    for (int64_t i = begin; i < end; ++i) {
+      if (sigs[i].bit_count > 0) {
+        absl::StrAppendFormat(&header, "$var %s %d %s %s $end\n", kind,
+                              sigs[i].bit_count, sigs[i].id, sigs[i].name);
+      }
+    }
+  };
+  declare(0, writer->first_register(), "wire");
+  if (!block->GetRegisters().empty()) {
+    absl::StrAppend(&header, "$scope module registers $end\n");
+    declare(writer->first_register(), sigs.size(), "reg");
+    absl::StrAppend(&header, "$upscope $end\n");
+  }
+  absl::StrAppend(&header,
+                  "$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n");
+  for (const Signal& signal : sigs) {
+    if (signal.bit_count == 1) {
+      absl::StrAppend(&header, "x", signal.id, "\n");
+    } else if (signal.bit_count > 1) {
+      absl::StrAppend(&header, "bx ", signal.id, "\n");
+    }
+  }
+  absl::StrAppend(&header, "$end\n");
+  XLS_RETURN_IF_ERROR(writer->file_->Write(header));
+
+  BlockWaveformWriter* raw = writer.get();
+  writer->thread_ = std::make_unique<Thread>([raw]() { raw->WriteChunks(); });
+  return writer;
+}
+
+BlockWaveformWriter::BlockWaveformWriter(Block* block, const Options& options,
+                                         std::vector<Signal> signals,
+                                         std::unique_ptr<File> file)
+    : block_(block),
+      options_(options),
+      signals_(std::move(signals)),
+      file_(std::move(file)) {
+  for (InputPort* port : block_->GetInputPorts()) {
+    input_port_names_.push_back(port->name());
+  }
+  for (OutputPort* port : block_->GetOutputPorts()) {
+    output_port_names_.push_back(port->name());
+  }
+  for (Register* reg : block_->GetRegisters()) {
+    register_names_.push_back(reg->name());
+  }
+  int64_t size = 0;
+  for (const Signal& signal : signals_) {
+    size += signal.layout.size();
+  }
+  previous_values_.resize(size);
+  scratch_.resize(size);
+  known_.resize(signals_.size(), false);
+}
+
+BlockWaveformWriter::~BlockWaveformWriter() {
+  if (!closed_) {
+    absl::Status status = Close();
+    if (!status.ok()) {
+      LOG(ERROR) << "Error writing waveform: " << status;
+    }
+  }
+}
+
+void BlockWaveformWriter::AppendChange(int64_t time, int64_t signal,
+                                       const uint8_t* value) {
+  pending_.changes.push_back(
+      Change{.time = time,
+             .signal = signal,
+             .offset = static_cast<int64_t>(pending_.data.size())});
+  pending_.data.insert(pending_.data.end(), value,
+                       value + signals_[signal].layout.size());
+}
+
+void BlockWaveformWriter::AppendChanges(
+    int64_t time, int64_t first_signal,
+    absl::Span<const uint8_t* const> values) {
+  for (int64_t i = 0; i < values.size(); ++i) {
+    const int64_t signal = first_signal + i;
+    const Signal& s = signals_[signal];
+    if (s.bit_count == 0) {
+      continue;
+    }
+    uint8_t* previous = previous_values_.data() + s.offset;
+    if (known_[signal] &&
+        std::memcmp(previous, values[i], s.layout.size()) == 0) {
+      continue;
+    }
+    std::memcpy(previous, values[i], s.layout.size());
+    known_[signal] = true;
+    AppendChange(time, signal, values[i]);
+  }
+}
+
+absl::Status BlockWaveformWriter::AppendValueChanges(
+    int64_t time, int64_t first_signal, absl::Span<const std::string> names,
+    const absl::flat_hash_map<std::string, Value>& values) {
+  scratch_pointers_.clear();
+  for (int64_t i = 0; i < names.size(); ++i) {
+    const Signal& s = signals_[first_signal + i];
+    auto it = values.find(names[i]);
+    if (it == values.end()) {
+      return absl::NotFoundError(
+          absl::StrFormat("No value given for %s", names[i]));
+    }
+    uint8_t* buffer = scratch_.data() + s.offset;
+    s.layout.ValueToNativeLayout(it->second, buffer);
+    scratch_pointers_.push_back(buffer);
+  }
+  AppendChanges(time, first_signal, scratch_pointers_);
+  return absl::OkStatus();
+}
+
+absl::Status BlockWaveformWriter::RecordInitialRegisters(
+    const BlockJitContinuation& continuation) {
+  XLS_RET_CHECK_EQ(cycle_count_, 0) << "Registers must be recorded first";
+  AppendChanges(/*time=*/0, first_register(),
+                AsConst(continuation.register_pointers()));
+  return absl::OkStatus();
+}
+
+absl::Status BlockWaveformWriter::RecordInitialRegisters(
+    BlockContinuation& continuation) {
+  XLS_RET_CHECK_EQ(cycle_count_, 0) << "Registers must be recorded first";
+  return AppendValueChanges(/*time=*/0, first_register(), register_names_,
+                            continuation.registers());
+}
+
+absl::Status BlockWaveformWriter::RecordCycle(
+    const BlockJitContinuation& continuation) {
+  XLS_RET_CHECK(!closed_);
+  const int64_t start = cycle_count_ * options_.clock_period;
+  AppendChange(start, /*signal=*/0, &kClockHigh);
+  AppendChanges(start, first_input_port(),
+                AsConst(continuation.input_port_pointers()));
+  AppendChanges(start, first_output_port(),
+                continuation.output_port_pointers());
+  AppendChange(start + options_.clock_period / 2, /*signal=*/0, &kClockLow);
+  AppendChanges(start + options_.clock_period, first_register(),
+                AsConst(continuation.register_pointers()));
+  return FinishCycle();
+}
+
+absl::Status BlockWaveformWriter::RecordCycle(
+    const absl::flat_hash_map<std::string, Value>& inputs,
+    BlockContinuation& continuation) {
+  XLS_RET_CHECK(!closed_);
+  const int64_t start = cycle_count_ * options_.clock_period;
+  AppendChange(start, /*signal=*/0, &kClockHigh);
+  XLS_RETURN_IF_ERROR(AppendValueChanges(start, first_input_port(),
+                                         input_port_names_, inputs));
+  XLS_RETURN_IF_ERROR(AppendValueChanges(start, first_output_port(),
+                                         output_port_names_,
+                                         continuation.output_ports()));
+  AppendChange(start + options_.clock_period / 2, /*signal=*/0, &kClockLow);
+  XLS_RETURN_IF_ERROR(AppendValueChanges(start + options_.clock_period,
+                                         first_register(), register_names_,
+                                         continuation.registers()));
+  return FinishCycle();
+}
+
+absl::Status BlockWaveformWriter::FinishCycle() {
+  ++cycle_count_;
+  if (pending_.data.size() >= kChunkBytes ||
+      pending_.changes.size() >= kChunkChanges) {
+    return FlushChunk();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status BlockWaveformWriter::FlushChunk() {
+  if (pending_.changes.empty()) {
+    return absl::OkStatus();
+  }
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(this, &BlockWaveformWriter::QueueHasRoom));
+  XLS_RETURN_IF_ERROR(write_status_);
+  queue_.push_back(std::move(pending_));
+  pending_ = Chunk();
+  return absl::OkStatus();
+}
+
+absl::Status BlockWaveformWriter::Close() {
+  XLS_RET_CHECK(!closed_);
+  absl::Status status = FlushChunk();
+  {
+    absl::MutexLock lock(&mutex_);
+    done_ = true;
+  }
+  if (thread_ != nullptr) {
+    thread_->Join();
+  }
+  closed_ = true;
+  {
+    absl::MutexLock lock(&mutex_);
+    status.Update(write_status_);
+  }
+  const int64_t end = cycle_count_ * options_.clock_period;
+  if (status.ok() && last_time_ < end) {
+    // Let viewers show the last cycle in full.
+    status = file_->Write(absl::StrCat("#", end, "\n"));
+  }
+  status.Update(file_->Close());
+  return status;
+}
+
+bool BlockWaveformWriter::ChunksReadyOrDone() const {
+  return !queue_.empty() || done_;
+}
+
+bool BlockWaveformWriter::QueueHasRoom() const {
+  return queue_.size() < kMaxQueuedChunks || !write_status_.ok();
+}
+
+void BlockWaveformWriter::WriteChunks() {
+  std::string text;
+  while (true) {
+    std::deque<Chunk> chunks;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(
+          absl::Condition(this, &BlockWaveformWriter::ChunksReadyOrDone));
+      if (queue_.empty()) {
+        return;
+      }
+      chunks.swap(queue_);
+    }
+    for (const Chunk& chunk : chunks) {
+      text.clear();
+      WriteChunk(chunk, text);
+      absl::Status status = file_->Write(text);
+      if (!status.ok()) {
+        absl::MutexLock lock(&mutex_);
+        write_status_ = status;
+        return;
+      }
+    }
+  }
+}
+
+void BlockWaveformWriter::WriteChunk(const Chunk& chunk, std::string& text) {
+  for (const Change& change : chunk.changes) {
+    if (change.time != last_time_) {
+      absl::StrAppend(&text, "#", change.time, "\n");
+      last_time_ = change.time;
+    }
+    const Signal& signal = signals_[change.signal];
+    Value value =
+        signal.layout.NativeLayoutToValue(chunk.data.data() + change.offset);
+    if (signal.bit_count == 1) {
+      AppendFlatBits(value, text);
+    } else {
+      text.push_back('b');
+      const int64_t start = text.size();
+      AppendFlatBits(value, text);
+      // Leading zeros may be omitted.
+      std::string::size_type first_one = text.find('1', start);
+      if (first_one == std::string::npos) {
+        text.resize(start + 1);
+      } else {
+        text.erase(start, first_one - start);
+      }
+      text.push_back(' ');
+    }
+    absl::StrAppend(&text, signal.id, "\n");
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,183 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_JIT_BLOCK_WAVEFORM_WRITER_H_
+#define XLS_JIT_BLOCK_WAVEFORM_WRITER_H_
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/block_evaluator.h"
+#include "xls/ir/block.h"
+#include "xls/ir/value.h"
+#include "xls/jit/block_jit.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+
+// Writes a VCD waveform of the clock, ports and registers of a block simulated
+// by the block JIT or by any BlockEvaluator (e.g. the block interpreter).
+//
+// Call one of the RecordCycle overloads after each cycle of the simulation.
+// Values are compared against those of the previous cycle in the native data
+// layout of the JIT and only the changed ones are copied into a queue; a
+// background thread turns them into VCD text and writes (and optionally
+// gzip-compresses) the file, so the simulation thread does little more than a
+// memcmp per signal.
+//
+// Cycle `t` spans the times [t * clock_period, (t + 1) * clock_period). The
+// input and output ports change at the rising clock edge starting the cycle
+// and the registers at the edge ending it, when they latch their next values.
+// Registers are unknown ('x') until the end of the first cycle unless
+// RecordInitialRegisters is called before it. Signals with no bits (tokens,
+// empty tuples) are omitted and aggregates are dumped as flat bit vectors.
+class BlockWaveformWriter {
+ public:
+  struct Options {
+    // The length of a cycle in units of `timescale`. Must be even.
+    int64_t clock_period = 2;
+    std::string timescale = "1ns";
+    // Whether to gzip-compress the file.
+    bool compress = false;
+  };
+
+  static absl::StatusOr<std::unique_ptr<BlockWaveformWriter>> Create(
+      Block* block, const std::filesystem::path& path, const Options& options);
+  static absl::StatusOr<std::unique_ptr<BlockWaveformWriter>> Create(
+      Block* block, const std::filesystem::path& path) {
+    return Create(block, path, Options());
+  }
+
+  // Closes the file if Close() was not called, logging any error.
+  ~BlockWaveformWriter();
+
+  // Records the register values before the first cycle.
+  absl::Status RecordInitialRegisters(const BlockJitContinuation& continuation);
+  absl::Status RecordInitialRegisters(BlockContinuation& continuation);
+
+  // Records the cycle `continuation` last ran: the values of the input ports
+  // and output ports during the cycle and the register values latched at its
+  // end.
+  absl::Status RecordCycle(const BlockJitContinuation& continuation);
+  absl::Status RecordCycle(
+      const absl::flat_hash_map<std::string, Value>& inputs,
+      BlockContinuation& continuation);
+
+  // Waits for all recorded cycles to be written and closes the file. Returns
+  // the first error encountered while writing.
+  absl::Status Close();
+
+  // The number of cycles recorded so far.
+  int64_t cycle_count() const { return cycle_count_; }
+
+ private:
+  // One dumped signal. Signal 0 is the clock, followed by the input ports, the
+  // output ports and the registers in block order.
+  struct Signal {
+    std::string name;
+    TypeLayout layout;
+    int64_t bit_count;
+    // Identifier code of the signal in the VCD file.
+    std::string id;
+    // Offset of the last recorded value in `previous_values_`.
+    int64_t offset;
+  };
+  // A change of the value of `signal` at `time`. The new value is at `offset`
+  // in the data of the chunk.
+  struct Change {
+    int64_t time;
+    int64_t signal;
+    int64_t offset;
+  };
+  struct Chunk {
+    std::vector<Change> changes;
+    std::vector<uint8_t> data;
+  };
+  class File;
+
+  BlockWaveformWriter(Block* block, const Options& options,
+                      std::vector<Signal> signals, std::unique_ptr<File> file);
+
+  int64_t first_input_port() const { return 1; }
+  int64_t first_output_port() const {
+    return first_input_port() + block_->GetInputPorts().size();
+  }
+  int64_t first_register() const {
+    return first_output_port() + block_->GetOutputPorts().size();
+  }
+
+  // Appends changes of the signals starting at `first_signal` whose values,
+  // in native layout, are pointed at by `values`.
+  void AppendChanges(int64_t time, int64_t first_signal,
+                     absl::Span<const uint8_t* const> values);
+  void AppendChange(int64_t time, int64_t signal, const uint8_t* value);
+  // Converts `values` of the signals starting at `first_signal` to native
+  // layout and appends the changed ones.
+  absl::Status AppendValueChanges(
+      int64_t time, int64_t first_signal,
+      absl::Span<const std::string> names,
+      const absl::flat_hash_map<std::string, Value>& values);
+  absl::Status FinishCycle();
+  // Hands the pending chunk to the writer thread.
+  absl::Status FlushChunk();
+
+  // Body of the writer thread.
+  void WriteChunks();
+  void WriteChunk(const Chunk& chunk, std::string& text);
+  bool ChunksReadyOrDone() const ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+  bool QueueHasRoom() const ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+
+  Block* block_;
+  Options options_;
+  std::vector<Signal> signals_;
+  std::vector<std::string> input_port_names_;
+  std::vector<std::string> output_port_names_;
+  std::vector<std::string> register_names_;
+  int64_t cycle_count_ = 0;
+  bool closed_ = false;
+
+  // Producer state, used by the simulation thread only.
+  std::vector<uint8_t> previous_values_;
+  std::vector<bool> known_;
+  std::vector<uint8_t> scratch_;
+  std::vector<const uint8_t*> scratch_pointers_;
+  Chunk pending_;
+
+  // Consumer state, used by the writer thread only.
+  std::unique_ptr<File> file_;
+  int64_t last_time_ = 0;
+
+  absl::Mutex mutex_;
+  std::deque<Chunk> queue_ ABSL_GUARDED_BY(mutex_);
+  bool done_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status write_status_ ABSL_GUARDED_BY(mutex_);
+
+  std::unique_ptr<Thread> thread_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_BLOCK_WAVEFORM_WRITER_H_
@@ -0,0 +1,205 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/jit/block_waveform_writer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/block_evaluator.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/register.h"
+#include "xls/ir/value.h"
+#include "xls/jit/block_jit.h"
+
+namespace xls {
+namespace {
+
+using testing::HasSubstr;
+
+int64_t CountOccurrences(std::string_view text, std::string_view pattern) {
+  int64_t count = 0;
+  for (size_t pos = text.find(pattern); pos != std::string_view::npos;
+       pos = text.find(pattern, pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+// The value changes dumped for two cycles of the block built by DelayBlock
+// with inputs 42 and 12.
+constexpr std::string_view kExpectedChanges = R"(#0
+$dumpvars
+x!
+bx "
+bx #
+bx $
+$end
+b0 $
+1!
+b101010 "
+b0 #
+#1
+0!
+#2
+b101010 $
+1!
+b1100 "
+b101010 #
+#3
+0!
+#4
+b1100 $
+)";
+
+class BlockWaveformWriterTest : public IrTestBase {
+ protected:
+  absl::StatusOr<Block*> DelayBlock(Package* p) {
+    BlockBuilder bb(TestName(), p);
+    XLS_ASSIGN_OR_RETURN(Register * r,
+                         bb.block()->AddRegister("r", p->GetBitsType(8)));
+    XLS_RETURN_IF_ERROR(bb.block()->AddClockPort("clk"));
+    BValue x = bb.InputPort("x", p->GetBitsType(8));
+    bb.RegisterWrite(r, x);
+    bb.OutputPort("y", bb.RegisterRead(r));
+    return bb.Build();
+  }
+};
+
+TEST_F(BlockWaveformWriterTest, JitCycles) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, DelayBlock(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "wave.vcd";
+  XLS_ASSERT_OK_AND_ASSIGN(auto writer, BlockWaveformWriter::Create(b, path));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b));
+  auto cont = jit->NewContinuation();
+  XLS_ASSERT_OK(writer->RecordInitialRegisters(*cont));
+  for (uint64_t x : {42, 12}) {
+    XLS_ASSERT_OK(cont->SetInputPorts({Value(UBits(x, 8))}));
+    XLS_ASSERT_OK(jit->RunOneCycle(*cont));
+    XLS_ASSERT_OK(writer->RecordCycle(*cont));
+  }
+  EXPECT_EQ(writer->cycle_count(), 2);
+  XLS_ASSERT_OK(writer->Close());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string vcd, GetFileContents(path));
+  EXPECT_THAT(vcd, HasSubstr("$timescale 1ns $end\n"));
+  EXPECT_THAT(vcd, HasSubstr("$var wire 1 ! clk $end\n"));
+  EXPECT_THAT(vcd, HasSubstr("$var wire 8 \" x $end\n"));
+  EXPECT_THAT(vcd, HasSubstr("$var wire 8 # y $end\n"));
+  EXPECT_THAT(vcd, HasSubstr("$scope module registers $end\n"
+                             "$var reg 8 $ r $end\n"));
+  EXPECT_TRUE(vcd.ends_with(kExpectedChanges)) << vcd;
+}
+
+TEST_F(BlockWaveformWriterTest, InterpreterMatchesJit) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, DelayBlock(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "wave.vcd";
+  XLS_ASSERT_OK_AND_ASSIGN(auto writer, BlockWaveformWriter::Create(b, path));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockContinuation> cont,
+                           kInterpreterBlockEvaluator.NewContinuation(b));
+  XLS_ASSERT_OK(writer->RecordInitialRegisters(*cont));
+  for (uint64_t x : {42, 12}) {
+    absl::flat_hash_map<std::string, Value> inputs = {
+        {"x", Value(UBits(x, 8))}};
+    XLS_ASSERT_OK(cont->RunOneCycle(inputs));
+    XLS_ASSERT_OK(writer->RecordCycle(inputs, *cont));
+  }
+  XLS_ASSERT_OK(writer->Close());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string vcd, GetFileContents(path));
+  EXPECT_TRUE(vcd.ends_with(kExpectedChanges)) << vcd;
+}
+
+TEST_F(BlockWaveformWriterTest, OnlyChangesAreWritten) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, DelayBlock(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "wave.vcd";
+  XLS_ASSERT_OK_AND_ASSIGN(auto writer, BlockWaveformWriter::Create(b, path));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b));
+  auto cont = jit->NewContinuation();
+  XLS_ASSERT_OK(cont->SetInputPorts({Value(UBits(7, 8))}));
+  for (int64_t i = 0; i < 1000; ++i) {
+    XLS_ASSERT_OK(jit->RunOneCycle(*cont));
+    XLS_ASSERT_OK(writer->RecordCycle(*cont));
+  }
+  XLS_ASSERT_OK(writer->Close());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string vcd, GetFileContents(path));
+  // The input changes once, the register once and the output twice (from
+  // zero to 7).
+  EXPECT_EQ(CountOccurrences(vcd, "b111 \""), 1);
+  EXPECT_EQ(CountOccurrences(vcd, "b111 $"), 1);
+  EXPECT_EQ(CountOccurrences(vcd, "b111 #"), 1);
+  EXPECT_TRUE(vcd.ends_with("#2000\n")) << vcd.substr(vcd.size() - 100);
+}
+
+TEST_F(BlockWaveformWriterTest, Compressed) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, DelayBlock(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "wave.vcd.gz";
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto writer,
+      BlockWaveformWriter::Create(
+          b, path, BlockWaveformWriter::Options{.compress = true}));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b));
+  auto cont = jit->NewContinuation();
+  XLS_ASSERT_OK(jit->RunOneCycle(*cont));
+  XLS_ASSERT_OK(writer->RecordCycle(*cont));
+  XLS_ASSERT_OK(writer->Close());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string contents, GetFileContents(path));
+  ASSERT_GE(contents.size(), 2);
+  // gzip magic number.
+  EXPECT_EQ(static_cast<uint8_t>(contents[0]), 0x1f);
+  EXPECT_EQ(static_cast<uint8_t>(contents[1]), 0x8b);
+}
+
+TEST_F(BlockWaveformWriterTest, OddClockPeriodIsRejected) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, DelayBlock(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  EXPECT_THAT(
+      BlockWaveformWriter::Create(b, temp_dir.path() / "wave.vcd",
+                                  BlockWaveformWriter::Options{
+                                      .clock_period = 3}),
+      status_testing::StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace xls
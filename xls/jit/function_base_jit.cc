@@ -37,7 +37,10 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "llvm/include/llvm/IR/Attributes.h"
 #include "llvm/include/llvm/IR/Constants.h"
 #include "llvm/include/llvm/IR/DerivedTypes.h"
 #include "llvm/include/llvm/IR/Function.h"
@@ -66,8 +69,10 @@
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_callbacks.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/lane_parallel_builder.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
 
 namespace xls {
@@ -318,6 +323,31 @@ class BufferAllocator {
     return allocation_kinds_.at(node);
   }
 
+  // Assigns `node` the buffer already allocated for `source` rather than a
+  // buffer of its own. `source` must have allocation kind kTempBlock or
+  // kAlloca and the value of `source` must be dead once `node` is computed.
+  // This is used to perform updates in place (e.g., chains of array updates).
+  void ShareBuffer(Node* node, Node* source) {
+    CHECK(!allocation_kinds_.contains(node));
+    AllocationKind kind = allocation_kinds_.at(source);
+    CHECK(kind == AllocationKind::kTempBlock ||
+          kind == AllocationKind::kAlloca);
+    allocation_kinds_[node] = kind;
+    if (kind == AllocationKind::kTempBlock) {
+      temp_block_offsets_[node] = temp_block_offsets_.at(source);
+    }
+    shared_buffers_[node] = source;
+    VLOG(3) << absl::StreamFormat("Sharing buffer of %s with %s",
+                                  source->GetName(), node->GetName());
+  }
+
+  // Returns the node whose buffer is shared by `node` (see ShareBuffer) or
+  // nullptr if `node` has its own buffer.
+  Node* GetSharedBufferSource(Node* node) const {
+    auto it = shared_buffers_.find(node);
+    return it == shared_buffers_.end() ? nullptr : it->second;
+  }
+
   // Returns the offset within the temp block for the buffer allocated for
   // `node`. Node must be assigned allocation kind kTempblock.
   int64_t GetOffset(Node* node) const {
@@ -352,11 +382,21 @@ class BufferAllocator {
   int64_t current_offset_ = 0;
   int64_t alignment_ = 1;
   absl::flat_hash_map<Node*, AllocationKind> allocation_kinds_;
+  absl::flat_hash_map<Node*, Node*> shared_buffers_;
 };
 
 // The maximum number of xls::Nodes in a partition.
 static constexpr int64_t kMaxPartitionSize = 100;
 
+// FunctionBases with more nodes than this keep each partition a separate LLVM
+// function through optimization by marking the partition functions noinline.
+// Register allocation and instruction scheduling are superlinear in function
+// size so letting the inliner fold thousands of partitions back into one
+// function makes compile time and memory blow up for very large designs. The
+// partitions of smaller FunctionBases are left to the inliner as the calls and
+// the values passed between partitions through the temp buffer cost run time.
+static constexpr int64_t kNoInlinePartitionsMinNodeCount = 10000;
+
 // Abstraction representing a point (partition function) at which an early exit
 // can occur.
 struct EarlyExitPoint {
@@ -503,7 +543,8 @@ Type* InputType(const Node* node) { return node->GetType(); }
 
 // Get the type this node outputs into the functions return value.
 Type* OutputType(const Node* node) {
-  if (node->Is<RegisterWrite>() || node->Is<OutputPort>()) {
+  if (node->Is<RegisterWrite>() || node->Is<OutputPort>() ||
+      node->Is<InstantiationInput>()) {
     // Operand 0 is the data we write to the register/port
     return node->operand(0)->GetType();
   }
@@ -608,8 +649,16 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
       // nor has a temp buffer). Allocate a buffer on the stack with alloca.
       XLS_RET_CHECK(!node->Is<RegisterWrite>());
       XLS_RET_CHECK(!node->Is<OutputPort>());
-      output_buffers = {b.CreateAlloca(
-          jit_context.type_converter().ConvertToLlvmType(node->GetType()))};
+      if (Node* source = allocator.GetSharedBufferSource(node);
+          source != nullptr) {
+        // `node` is computed in place in the buffer of `source` which is
+        // necessarily in this partition.
+        XLS_RET_CHECK(value_buffers.contains(source)) << node;
+        output_buffers = {value_buffers.at(source)};
+      } else {
+        output_buffers = {b.CreateAlloca(
+            jit_context.type_converter().ConvertToLlvmType(node->GetType()))};
+      }
     } else {
       // Node has no allocation and is not an output buffer. Nothing to emit for
       // this node.
@@ -684,6 +733,33 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
   return wrapper.function();
 }
 
+// Returns whether the array update `update` with allocation kind `kind` can be
+// computed in place in the buffer of the array it updates. This is the case if
+// the updated array has a buffer which no other node reads. Chains of
+// single-use array updates (e.g., updates of a proc state array) then share a
+// single buffer and only the first update in the chain copies the array.
+bool CanUpdateArrayInPlace(ArrayUpdate* update, AllocationKind kind,
+                           const BufferAllocator& allocator) {
+  Node* array = update->array_to_update();
+  if (array->users().size() != 1 ||
+      array->function_base()->HasImplicitUse(array)) {
+    return false;
+  }
+  switch (allocator.GetAllocationKind(array)) {
+    case AllocationKind::kTempBlock:
+      // The temp block outlives any partition.
+      return true;
+    case AllocationKind::kAlloca:
+      // An alloca'd buffer is scoped to its partition so it can only be used
+      // if the update value is also only used within the partition.
+      return kind == AllocationKind::kAlloca;
+    case AllocationKind::kNone:
+      // The array is an input, an output or has no buffer.
+      return false;
+  }
+  return false;
+}
+
 // Determine the type of buffers required by each node. Allocates the temporary
 // buffers for nodes as needed.
 absl::Status AllocateBuffers(absl::Span<const Partition> partitions,
@@ -696,15 +772,23 @@ absl::Status AllocateBuffers(absl::Span<const Partition> partitions,
       if (wrapper.IsInputNode(node) || wrapper.IsOutputNode(node) ||
           ShouldMaterializeAtUse(node)) {
         allocator.SetAllocationKind(node, AllocationKind::kNone);
-      } else if (!node->function_base()->HasImplicitUse(node) &&
-                 std::all_of(
-                     node->users().begin(), node->users().end(),
-                     [&](Node* u) { return partition_set.contains(u); })) {
+        continue;
+      }
+      AllocationKind kind;
+      if (!node->function_base()->HasImplicitUse(node) &&
+          std::all_of(node->users().begin(), node->users().end(),
+                      [&](Node* u) { return partition_set.contains(u); })) {
         // All of the uses of node are in the partition.
-        allocator.SetAllocationKind(node, AllocationKind::kAlloca);
+        kind = AllocationKind::kAlloca;
       } else {
         // Node has a use in another partition.
-        allocator.SetAllocationKind(node, AllocationKind::kTempBlock);
+        kind = AllocationKind::kTempBlock;
+      }
+      if (node->Is<ArrayUpdate>() &&
+          CanUpdateArrayInPlace(node->As<ArrayUpdate>(), kind, allocator)) {
+        allocator.ShareBuffer(node, node->As<ArrayUpdate>()->array_to_update());
+      } else {
+        allocator.SetAllocationKind(node, kind);
       }
     }
   }
@@ -722,6 +806,11 @@ std::vector<Node*> GetJittedFunctionInputs(FunctionBase* function_base) {
     absl::c_transform(
         block->GetRegisters(), std::back_inserter(out),
         [&](Register* r) -> Node* { return *block->GetRegisterRead(r); });
+    // The values produced by instantiated blocks are supplied by the caller.
+    for (Instantiation* instantiation : block->GetInstantiations()) {
+      absl::c_copy(block->GetInstantiationOutputs(instantiation),
+                   std::back_inserter(out));
+    }
     return out;
   }
   std::vector<Node*> inputs(function_base->params().begin(),
@@ -745,6 +834,11 @@ std::vector<Node*> GetJittedFunctionOutputs(FunctionBase* function_base) {
     absl::c_transform(
         block->GetRegisters(), std::back_inserter(out),
         [&](Register* r) -> Node* { return *block->GetRegisterWrite(r); });
+    // The values passed to instantiated blocks are returned to the caller.
+    for (Instantiation* instantiation : block->GetInstantiations()) {
+      absl::c_copy(block->GetInstantiationInputs(instantiation),
+                   std::back_inserter(out));
+    }
     return out;
   }
   // The outputs of a proc are the next state values.
@@ -851,6 +945,9 @@ absl::StatusOr<PartitionedFunction> BuildFunctionInternal(
         llvm::Function * partition_function,
         BuildPartitionFunction(name, partitions[i], inputs, outputs, allocator,
                                jit_context));
+    if (xls_function->node_count() > kNoInlinePartitionsMinNodeCount) {
+      partition_function->addFnAttr(llvm::Attribute::NoInline);
+    }
     partition_functions.push_back(partition_function);
   }
 
@@ -1243,6 +1340,211 @@ absl::StatusOr<llvm::Function*> BuildPackedWrapper(
   return wrapper.function();
 }
 
+// Builds a wrapper around the jitted function `callee` which invokes it
+// `batch_size` times in a loop. Each input (output) pointer passed to the
+// wrapper points to a contiguous array of `batch_size` values in LLVM native
+// data layout with a stride equal to the allocation size of the type. The same
+// temp buffer is reused by every invocation.
+absl::StatusOr<llvm::Function*> BuildBatchedWrapper(
+    FunctionBase* xls_function, llvm::Function* callee,
+    JitBuilderContext& jit_context) {
+  llvm::LLVMContext* context = &jit_context.context();
+  std::vector<Node*> inputs = GetJittedFunctionInputs(xls_function);
+  std::vector<Node*> outputs = GetJittedFunctionOutputs(xls_function);
+  llvm::Type* i64 = llvm::Type::getInt64Ty(*context);
+  LlvmFunctionWrapper wrapper = LlvmFunctionWrapper::Create(
+      absl::StrFormat("%s_batched", xls_function->name()), inputs, outputs,
+      i64, jit_context,
+      LlvmFunctionWrapper::FunctionArg{.name = "batch_size", .type = i64});
+  llvm::IRBuilder<>& entry_builder = wrapper.entry_builder();
+
+  // Arrays of pointers to the current element of each input and output. These
+  // are passed on to the wrapped function and updated on each iteration.
+  llvm::Value* input_arg_array = entry_builder.CreateAlloca(
+      llvm::ArrayType::get(llvm::PointerType::get(*context, 0), inputs.size()));
+  llvm::Value* output_arg_array =
+      entry_builder.CreateAlloca(llvm::ArrayType::get(
+          llvm::PointerType::get(*context, 0), outputs.size()));
+  llvm::Type* pointer_array_type =
+      llvm::ArrayType::get(llvm::PointerType::getUnqual(*context), 0);
+  std::vector<llvm::Value*> input_bases;
+  input_bases.reserve(inputs.size());
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    input_bases.push_back(
+        LoadPointerFromPointerArray(i, wrapper.GetInputsArg(), &entry_builder));
+  }
+  std::vector<llvm::Value*> output_bases;
+  output_bases.reserve(outputs.size());
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    output_bases.push_back(LoadPointerFromPointerArray(
+        i, wrapper.GetOutputsArg(), &entry_builder));
+  }
+
+  llvm::BasicBlock* loop_header =
+      llvm::BasicBlock::Create(*context, "loop_header", wrapper.function());
+  llvm::BasicBlock* loop_body =
+      llvm::BasicBlock::Create(*context, "loop_body", wrapper.function());
+  llvm::BasicBlock* exit =
+      llvm::BasicBlock::Create(*context, "exit", wrapper.function());
+  llvm::BasicBlock* entry_block = entry_builder.GetInsertBlock();
+  entry_builder.CreateBr(loop_header);
+
+  llvm::IRBuilder<> header_builder(loop_header);
+  llvm::PHINode* index = header_builder.CreatePHI(i64, 2, "index");
+  index->addIncoming(llvm::ConstantInt::get(i64, 0), entry_block);
+  header_builder.CreateCondBr(
+      header_builder.CreateICmpSLT(index, wrapper.GetExtraArg().value()),
+      loop_body, exit);
+
+  llvm::IRBuilder<> body_builder(loop_body);
+  auto store_element_pointer = [&](llvm::Value* base, Type* xls_type,
+                                   llvm::Value* arg_array, int64_t i) {
+    llvm::Value* stride = llvm::ConstantInt::get(
+        i64, jit_context.type_converter().GetTypeByteSize(xls_type));
+    llvm::Value* element = body_builder.CreateGEP(
+        body_builder.getInt8Ty(), base, body_builder.CreateMul(index, stride));
+    llvm::Value* gep = body_builder.CreateGEP(
+        pointer_array_type, arg_array,
+        {
+            llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0),
+            llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), i),
+        });
+    body_builder.CreateStore(element, gep);
+  };
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    store_element_pointer(input_bases[i], InputType(inputs[i]),
+                          input_arg_array, i);
+  }
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    store_element_pointer(output_bases[i], OutputType(outputs[i]),
+                          output_arg_array, i);
+  }
+
+  std::vector<llvm::Value*> args;
+  args.push_back(input_arg_array);
+  args.push_back(output_arg_array);
+  args.push_back(wrapper.GetTempBufferArg());
+  args.push_back(wrapper.GetInterpreterEventsArg());
+  args.push_back(wrapper.GetInstanceContextArg());
+  args.push_back(wrapper.GetJitRuntimeArg());
+  // Functions have no continuation points so always start at the beginning.
+  args.push_back(llvm::ConstantInt::get(i64, 0));
+  body_builder.CreateCall(callee, args);
+
+  index->addIncoming(
+      body_builder.CreateAdd(index, llvm::ConstantInt::get(i64, 1)),
+      loop_body);
+  body_builder.CreateBr(loop_header);
+
+  llvm::IRBuilder<> exit_builder(exit);
+  exit_builder.CreateRet(llvm::ConstantInt::get(i64, 0));
+
+  return wrapper.function();
+}
+
+// Builds a wrapper around the jitted block `callee` which evaluates
+// `cycle_count` clock cycles in a loop. The input and output pointer arrays
+// are copied into local arrays and after each cycle the register entries of
+// the two are exchanged so the register outputs of one cycle become the
+// register inputs of the next without copying any data.
+absl::StatusOr<llvm::Function*> BuildMultiCycleWrapper(
+    Block* block, llvm::Function* callee, JitBuilderContext& jit_context) {
+  llvm::LLVMContext* context = &jit_context.context();
+  std::vector<Node*> inputs = GetJittedFunctionInputs(block);
+  std::vector<Node*> outputs = GetJittedFunctionOutputs(block);
+  int64_t input_port_count = block->GetInputPorts().size();
+  int64_t output_port_count = block->GetOutputPorts().size();
+  int64_t register_count = block->GetRegisters().size();
+  // Values exchanged with instantiated blocks follow the registers and are not
+  // updated between cycles, so this is only meaningful for blocks without
+  // instantiations.
+  XLS_RET_CHECK_GE(inputs.size(), input_port_count + register_count);
+  XLS_RET_CHECK_GE(outputs.size(), output_port_count + register_count);
+
+  llvm::Type* i64 = llvm::Type::getInt64Ty(*context);
+  llvm::Type* ptr_type = llvm::PointerType::get(*context, 0);
+  LlvmFunctionWrapper wrapper = LlvmFunctionWrapper::Create(
+      absl::StrFormat("%s_cycles", block->name()), inputs, outputs, i64,
+      jit_context,
+      LlvmFunctionWrapper::FunctionArg{.name = "cycle_count", .type = i64});
+  llvm::IRBuilder<>& entry_builder = wrapper.entry_builder();
+
+  llvm::Type* pointer_array_type = llvm::ArrayType::get(ptr_type, 0);
+  auto element_pointer = [&](llvm::IRBuilder<>& builder,
+                             llvm::Value* arg_array, int64_t i) {
+    return builder.CreateGEP(
+        pointer_array_type, arg_array,
+        {
+            llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0),
+            llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), i),
+        });
+  };
+  llvm::Value* input_arg_array = entry_builder.CreateAlloca(
+      llvm::ArrayType::get(ptr_type, inputs.size()));
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    entry_builder.CreateStore(
+        LoadPointerFromPointerArray(i, wrapper.GetInputsArg(), &entry_builder),
+        element_pointer(entry_builder, input_arg_array, i));
+  }
+  llvm::Value* output_arg_array = entry_builder.CreateAlloca(
+      llvm::ArrayType::get(ptr_type, outputs.size()));
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    entry_builder.CreateStore(
+        LoadPointerFromPointerArray(i, wrapper.GetOutputsArg(), &entry_builder),
+        element_pointer(entry_builder, output_arg_array, i));
+  }
+
+  llvm::BasicBlock* loop_header =
+      llvm::BasicBlock::Create(*context, "loop_header", wrapper.function());
+  llvm::BasicBlock* loop_body =
+      llvm::BasicBlock::Create(*context, "loop_body", wrapper.function());
+  llvm::BasicBlock* exit =
+      llvm::BasicBlock::Create(*context, "exit", wrapper.function());
+  llvm::BasicBlock* entry_block = entry_builder.GetInsertBlock();
+  entry_builder.CreateBr(loop_header);
+
+  llvm::IRBuilder<> header_builder(loop_header);
+  llvm::PHINode* cycle = header_builder.CreatePHI(i64, 2, "cycle");
+  cycle->addIncoming(llvm::ConstantInt::get(i64, 0), entry_block);
+  header_builder.CreateCondBr(
+      header_builder.CreateICmpSLT(cycle, wrapper.GetExtraArg().value()),
+      loop_body, exit);
+
+  llvm::IRBuilder<> body_builder(loop_body);
+  std::vector<llvm::Value*> args;
+  args.push_back(input_arg_array);
+  args.push_back(output_arg_array);
+  args.push_back(wrapper.GetTempBufferArg());
+  args.push_back(wrapper.GetInterpreterEventsArg());
+  args.push_back(wrapper.GetInstanceContextArg());
+  args.push_back(wrapper.GetJitRuntimeArg());
+  // Blocks have no continuation points so always start at the beginning.
+  args.push_back(llvm::ConstantInt::get(i64, 0));
+  body_builder.CreateCall(callee, args);
+
+  // Flip the register spaces for the next cycle.
+  for (int64_t i = 0; i < register_count; ++i) {
+    llvm::Value* input_gep =
+        element_pointer(body_builder, input_arg_array, input_port_count + i);
+    llvm::Value* output_gep =
+        element_pointer(body_builder, output_arg_array, output_port_count + i);
+    llvm::Value* current = body_builder.CreateLoad(ptr_type, input_gep);
+    llvm::Value* next = body_builder.CreateLoad(ptr_type, output_gep);
+    body_builder.CreateStore(next, input_gep);
+    body_builder.CreateStore(current, output_gep);
+  }
+
+  cycle->addIncoming(
+      body_builder.CreateAdd(cycle, llvm::ConstantInt::get(i64, 1)),
+      loop_body);
+  body_builder.CreateBr(loop_header);
+
+  llvm::IRBuilder<> exit_builder(exit);
+  exit_builder.CreateRet(llvm::ConstantInt::get(i64, 0));
+
+  return wrapper.function();
+}
+
 }  // namespace
 
 JitArgumentSet JittedFunctionBase::CreateInputBuffer() const {
@@ -1271,7 +1573,8 @@ JitTempBuffer JittedFunctionBase::CreateTempBuffer() const {
 // dependent xls::Functions which may be called by `xls_function`.
 absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
     FunctionBase* xls_function, JitBuilderContext& jit_context,
-    bool build_packed_wrapper) {
+    bool build_packed_wrapper, std::optional<int64_t> lane_parallel_width) {
+  absl::Time build_start = absl::Now();
   std::vector<FunctionBase*> functions = GetDependentFunctions(xls_function);
   BufferAllocator allocator(&jit_context.type_converter());
   llvm::Function* top_function = nullptr;
@@ -1303,13 +1606,53 @@ absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
 
   std::string function_name = MangleForLLVM(top_function->getName().str());
   std::string packed_wrapper_name;
+  std::string batched_wrapper_name;
+  int64_t batched_lane_count = 1;
   if (build_packed_wrapper) {
     XLS_ASSIGN_OR_RETURN(
         llvm::Function * packed_wrapper_function,
         BuildPackedWrapper(xls_function, top_function, jit_context));
     packed_wrapper_name = packed_wrapper_function->getName().str();
   }
+  // Blocks only get a batched entry point when compiled for multiple lanes.
+  const bool build_batched_wrapper =
+      build_packed_wrapper || lane_parallel_width.has_value();
+  if (build_batched_wrapper) {
+    XLS_ASSIGN_OR_RETURN(
+        llvm::Function * batched_wrapper_function,
+        BuildBatchedWrapper(xls_function, top_function, jit_context));
+    batched_wrapper_name = batched_wrapper_function->getName().str();
+    if (lane_parallel_width.has_value()) {
+      absl::Status parallelizable = CheckLaneParallelizable(xls_function);
+      if (parallelizable.ok()) {
+        XLS_ASSIGN_OR_RETURN(
+            llvm::Function * lane_parallel_function,
+            BuildLaneParallelFunction(xls_function, *lane_parallel_width,
+                                      batched_wrapper_function, jit_context));
+        batched_wrapper_name = lane_parallel_function->getName().str();
+        batched_lane_count = *lane_parallel_width;
+      } else {
+        VLOG(2) << absl::StreamFormat(
+            "Function `%s` is not lane-parallelizable: %s",
+            xls_function->name(), parallelizable.message());
+      }
+    }
+  }
+
+  std::string multi_cycle_wrapper_name;
+  if (xls_function->IsBlock()) {
+    XLS_ASSIGN_OR_RETURN(llvm::Function * multi_cycle_wrapper_function,
+                         BuildMultiCycleWrapper(xls_function->AsBlockOrDie(),
+                                                top_function, jit_context));
+    multi_cycle_wrapper_name = multi_cycle_wrapper_function->getName().str();
+  }
 
+  if (jit_context.llvm_compiler().IsOrcJit()) {
+    XLS_ASSIGN_OR_RETURN(OrcJit * orc_jit,
+                         jit_context.llvm_compiler().AsOrcJit());
+    orc_jit->ReportCompilePhaseTime(JitCompilePhase::kIrBuilding,
+                                    absl::Now() - build_start);
+  }
   XLS_RETURN_IF_ERROR(
       jit_context.llvm_compiler().CompileModule(jit_context.ConsumeModule()));
 
@@ -1341,6 +1684,34 @@ absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
       jitted_function.packed_function_ = InvalidJitFunctionUse;
     }
   }
+  if (build_batched_wrapper) {
+    jitted_function.batched_function_name_ = batched_wrapper_name;
+    jitted_function.batched_lane_count_ = batched_lane_count;
+    if (jit_context.llvm_compiler().IsOrcJit()) {
+      XLS_ASSIGN_OR_RETURN(auto* orc_jit,
+                           jit_context.llvm_compiler().AsOrcJit());
+      XLS_ASSIGN_OR_RETURN(auto batched_fn_address,
+                           orc_jit->LoadSymbol(batched_wrapper_name));
+      jitted_function.batched_function_ =
+          absl::bit_cast<JitFunctionType>(batched_fn_address);
+    } else {
+      jitted_function.batched_function_ = InvalidJitFunctionUse;
+    }
+  }
+
+  if (xls_function->IsBlock()) {
+    jitted_function.multi_cycle_function_name_ = multi_cycle_wrapper_name;
+    if (jit_context.llvm_compiler().IsOrcJit()) {
+      XLS_ASSIGN_OR_RETURN(auto* orc_jit,
+                           jit_context.llvm_compiler().AsOrcJit());
+      XLS_ASSIGN_OR_RETURN(auto multi_cycle_fn_address,
+                           orc_jit->LoadSymbol(multi_cycle_wrapper_name));
+      jitted_function.multi_cycle_function_ =
+          absl::bit_cast<JitFunctionType>(multi_cycle_fn_address);
+    } else {
+      jitted_function.multi_cycle_function_ = InvalidJitFunctionUse;
+    }
+  }
 
   for (const Node* input : GetJittedFunctionInputs(xls_function)) {
     Type* input_type = InputType(input);
@@ -1381,11 +1752,28 @@ absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
   return std::move(jitted_function);
 }
 
+namespace {
+
+absl::Status CheckLaneParallelWidth(std::optional<int64_t> width) {
+  if (width.has_value() && (*width <= 0 || (*width & (*width - 1)) != 0)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Lane-parallel width must be a power of two, got %d", *width));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
 absl::StatusOr<JittedFunctionBase> JittedFunctionBase::Build(
-    Function* xls_function, LlvmCompiler& compiler) {
-  JitBuilderContext jit_context(compiler, xls_function);
+    Function* xls_function, LlvmCompiler& compiler,
+    std::optional<int64_t> lane_parallel_width, bool inline_loop_bodies,
+    bool narrow_with_known_bits) {
+  XLS_RETURN_IF_ERROR(CheckLaneParallelWidth(lane_parallel_width));
+  JitBuilderContext jit_context(compiler, xls_function, inline_loop_bodies,
+                                narrow_with_known_bits);
   return JittedFunctionBase::BuildInternal(xls_function, jit_context,
-                                           /*build_packed_wrapper=*/true);
+                                           /*build_packed_wrapper=*/true,
+                                           lane_parallel_width);
 }
 
 absl::StatusOr<JittedFunctionBase> JittedFunctionBase::Build(
@@ -1396,10 +1784,13 @@ absl::StatusOr<JittedFunctionBase> JittedFunctionBase::Build(
 }
 
 absl::StatusOr<JittedFunctionBase> JittedFunctionBase::Build(
-    Block* block, LlvmCompiler& compiler) {
+    Block* block, LlvmCompiler& compiler,
+    std::optional<int64_t> lane_parallel_width) {
+  XLS_RETURN_IF_ERROR(CheckLaneParallelWidth(lane_parallel_width));
   JitBuilderContext jit_context(compiler, block);
   return JittedFunctionBase::BuildInternal(block, jit_context,
-                                           /*build_packed_wrapper=*/false);
+                                           /*build_packed_wrapper=*/false,
+                                           lane_parallel_width);
 }
 
 absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildFromAot(
@@ -1555,4 +1946,29 @@ std::optional<int64_t> JittedFunctionBase::RunPackedJittedFunction(
   }
   return std::nullopt;
 }
+
+std::optional<int64_t> JittedFunctionBase::RunBatchedJittedFunction(
+    const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+    InterpreterEvents* events, InstanceContext* instance_context,
+    JitRuntime* jit_runtime, int64_t batch_size) const {
+  if (batched_function_) {
+    DCHECK(IsAligned(temp_buffer, temp_buffer_alignment_));
+    return (*batched_function_)(inputs, outputs, temp_buffer, events,
+                                instance_context, jit_runtime, batch_size);
+  }
+  return std::nullopt;
+}
+
+std::optional<int64_t> JittedFunctionBase::RunMultiCycleJittedFunction(
+    const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+    InterpreterEvents* events, InstanceContext* instance_context,
+    JitRuntime* jit_runtime, int64_t cycle_count) const {
+  if (multi_cycle_function_) {
+    DCHECK(IsAligned(temp_buffer, temp_buffer_alignment_));
+    return (*multi_cycle_function_)(inputs, outputs, temp_buffer, events,
+                                    instance_context, jit_runtime,
+                                    cycle_count);
+  }
+  return std::nullopt;
+}
 }  // namespace xls
@@ -44,10 +44,13 @@ namespace xls {
 // descriptions:
 //   inputs: array of pointers to input buffers (e.g., parameter values). Note
 //        that for Block* functions specifically the inputs are all the input
-//        ports followed by all the registers.
+//        ports followed by all the registers followed by the
+//        instantiation-output nodes of each instantiation in order.
 //   outputs: array of pointers to output buffers (e.g., function return value,
 //        proc next state values). Note that for Block* specifically the outputs
-//        are all the output-ports followed by all the new register values.
+//        are all the output-ports followed by all the new register values
+//        followed by the instantiation-input nodes of each instantiation in
+//        order.
 //   temp_buffer: heap-allocated scratch space for the JITed funcion. This
 //       buffer hold temporary node values which cannot be stack allocated via
 //       allocas.
@@ -80,8 +83,22 @@ class JittedFunctionBase {
   JittedFunctionBase() = default;
   // Builds and returns an LLVM IR function implementing the given XLS
   // function.
-  static absl::StatusOr<JittedFunctionBase> Build(Function* xls_function,
-                                                  LlvmCompiler& compiler);
+  //
+  // If `lane_parallel_width` is given and the function is lane-parallelizable
+  // (see CheckLaneParallelizable) the batched entry point evaluates the
+  // function on vectors of `lane_parallel_width` batch elements at once.
+  // Otherwise the batched entry point evaluates one element at a time.
+  // `lane_parallel_width` must be a power of two.
+  //
+  // If `inline_loop_bodies` is true the bodies of counted_for loops are
+  // inlined into the loop (see JitBuilderContext).
+  //
+  // If `narrow_with_known_bits` is true unsigned arithmetic is lowered at a
+  // narrower width where known-bits analysis allows (see JitBuilderContext).
+  static absl::StatusOr<JittedFunctionBase> Build(
+      Function* xls_function, LlvmCompiler& compiler,
+      std::optional<int64_t> lane_parallel_width = std::nullopt,
+      bool inline_loop_bodies = false, bool narrow_with_known_bits = false);
 
   // Builds and returns an LLVM IR function implementing the given XLS
   // proc.
@@ -90,8 +107,14 @@ class JittedFunctionBase {
 
   // Builds and returns an LLVM IR function implementing the given XLS
   // block.
-  static absl::StatusOr<JittedFunctionBase> Build(Block* block,
-                                                  LlvmCompiler& compiler);
+  //
+  // If `lane_parallel_width` is given a batched entry point is also built in
+  // which each batch element is one instance of the block evaluated for one
+  // cycle. It is lane-parallel, as for functions, if the block is
+  // lane-parallelizable. `lane_parallel_width` must be a power of two.
+  static absl::StatusOr<JittedFunctionBase> Build(
+      Block* block, LlvmCompiler& compiler,
+      std::optional<int64_t> lane_parallel_width = std::nullopt);
 
   // Builds and returns a JittedFunctionBase using code and ABIs provided by an
   // earlier AOT compile.
@@ -156,6 +179,55 @@ class JittedFunctionBase {
                : std::nullopt;
   }
 
+  // Executes the batched version of the function which invokes the function
+  // `batch_size` times reusing `temp_buffer`. Each element of `inputs` and
+  // `outputs` points to a contiguous array of `batch_size` values in native
+  // LLVM layout with a stride of the corresponding entry of
+  // `input_buffer_sizes()` or `output_buffer_sizes()`. Each array must satisfy
+  // the ABI alignment of its type. Returns std::nullopt if there is no batched
+  // version of the function.
+  std::optional<int64_t> RunBatchedJittedFunction(
+      const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+      InterpreterEvents* events, InstanceContext* instance_context,
+      JitRuntime* jit_runtime, int64_t batch_size) const;
+
+  // Checks if we have a batched version of the function.
+  bool HasBatchedFunction() const { return batched_function_.has_value(); }
+  std::optional<std::string_view> batched_function_name() const {
+    return HasBatchedFunction()
+               ? std::make_optional<std::string_view>(*batched_function_name_)
+               : std::nullopt;
+  }
+
+  // Returns the number of batch elements the batched function evaluates at
+  // once. Greater than one if the function was compiled in lane-parallel mode.
+  int64_t batched_lane_count() const { return batched_lane_count_; }
+
+  // Executes the multi-cycle version of a jitted block which evaluates
+  // `cycle_count` clock cycles. `inputs` and `outputs` are as for
+  // RunJittedFunction. After each cycle the register pointers of `inputs` and
+  // `outputs` are exchanged (in a local copy) so the next-state values written
+  // by one cycle are the register values read by the next. After an odd number
+  // of cycles the current register values are therefore in the buffers
+  // pointed to by the register entries of `outputs`. Input ports hold their
+  // values for all cycles and output ports hold the values from the final
+  // cycle. Returns std::nullopt if there is no multi-cycle version of the
+  // function.
+  std::optional<int64_t> RunMultiCycleJittedFunction(
+      const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+      InterpreterEvents* events, InstanceContext* instance_context,
+      JitRuntime* jit_runtime, int64_t cycle_count) const;
+
+  // Checks if we have a multi-cycle version of the function.
+  bool HasMultiCycleFunction() const {
+    return multi_cycle_function_.has_value();
+  }
+  std::optional<std::string_view> multi_cycle_function_name() const {
+    return HasMultiCycleFunction() ? std::make_optional<std::string_view>(
+                                         *multi_cycle_function_name_)
+                                   : std::nullopt;
+  }
+
   std::string_view function_name() const { return function_name_; }
 
   absl::Span<int64_t const> input_buffer_sizes() const {
@@ -210,6 +282,11 @@ class JittedFunctionBase {
     JittedFunctionBase res = *this;
     res.function_ = entrypoint;
     res.packed_function_ = packed_entrypoint;
+    res.batched_function_name_ = std::nullopt;
+    res.batched_function_ = std::nullopt;
+    res.batched_lane_count_ = 1;
+    res.multi_cycle_function_name_ = std::nullopt;
+    res.multi_cycle_function_ = std::nullopt;
     return res;
   }
 
@@ -249,7 +326,8 @@ class JittedFunctionBase {
 
   static absl::StatusOr<JittedFunctionBase> BuildInternal(
       FunctionBase* function, JitBuilderContext& jit_context,
-      bool build_packed_wrapper);
+      bool build_packed_wrapper,
+      std::optional<int64_t> lane_parallel_width = std::nullopt);
 
   // Name and function pointer for the jitted function which accepts/produces
   // arguments/results in LLVM native format.
@@ -262,6 +340,22 @@ class JittedFunctionBase {
   std::optional<std::string> packed_function_name_;
   std::optional<JitFunctionType> packed_function_;
 
+  // Name and function pointer for the jitted function which invokes the
+  // function over a batch of arguments/results in LLVM native format. The
+  // final argument of the function is the batch size rather than a
+  // continuation point. Only exists for JITted xls::Functions and is not
+  // available for AOT compiled code.
+  std::optional<std::string> batched_function_name_;
+  std::optional<JitFunctionType> batched_function_;
+  int64_t batched_lane_count_ = 1;
+
+  // Name and function pointer for the jitted function which evaluates a block
+  // for a number of cycles. The final argument of the function is the cycle
+  // count. Only exists for JITted xls::Blocks and is not available for AOT
+  // compiled code.
+  std::optional<std::string> multi_cycle_function_name_;
+  std::optional<JitFunctionType> multi_cycle_function_;
+
   // Sizes of the inputs/outputs in native LLVM format for `function_base`.
   std::vector<int64_t> input_buffer_sizes_;
   std::vector<int64_t> output_buffer_sizes_;
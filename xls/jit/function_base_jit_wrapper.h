@@ -15,6 +15,8 @@
 #ifndef XLS_JIT_FUNCTION_BASE_JIT_WRAPPER_H_
 #define XLS_JIT_FUNCTION_BASE_JIT_WRAPPER_H_
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <iterator>
 #include <memory>
@@ -38,6 +40,9 @@
 #include "xls/jit/aot_entrypoint.pb.h"
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/function_jit.h"
+#include "xls/jit/jit_arg_marshaller.h"
+#include "xls/jit/jit_buffer.h"
+#include "xls/jit/type_layout.h"
 #include "xls/public/ir_parser.h"
 
 namespace xls {
@@ -51,13 +56,55 @@ class BaseFunctionJitWrapper {
  public:
   FunctionJit* jit() { return jit_.get(); }
 
+  // Runs the jitted function on arguments of struct types generated by the
+  // DSLX-to-C++ transpiler with `--jit_buffer_conversions` (see
+  // xls/dslx/cpp_transpiler) and returns a result of the struct type `Result`.
+  // The arguments are written and the result read directly in the native
+  // layout of the JIT, so no xls::Value is built on the way.
+  template <typename Result, typename... Args>
+  absl::StatusOr<Result> RunTyped(const Args&... args) {
+    int64_t first_arg = needs_fake_token_ ? 2 : 0;
+    XLS_RET_CHECK_EQ(first_arg + sizeof...(Args), arg_leaf_offsets_.size());
+    absl::Span<uint8_t* const> arg_buffers = typed_arg_buffers_.pointers();
+    if (needs_fake_token_) {
+      *arg_buffers[1] = 1;
+    }
+    XLS_RETURN_IF_ERROR(WriteTypedArgs(std::index_sequence_for<Args...>(),
+                                       arg_buffers.subspan(first_arg),
+                                       absl::MakeConstSpan(arg_leaf_offsets_)
+                                           .subspan(first_arg),
+                                       args...));
+    uint8_t* result_buffer = typed_result_buffer_.pointers()[0];
+    InterpreterEvents events;
+    XLS_RETURN_IF_ERROR(jit_->RunWithViews</*kForceZeroCopy=*/true>(
+        arg_buffers, absl::MakeSpan(result_buffer, jit_->GetReturnTypeSize()),
+        &events));
+    XLS_RETURN_IF_ERROR(InterpreterEventsToStatus(events));
+    return Result::FromJitBuffer(result_leaf_offsets_, result_buffer);
+  }
+
  protected:
   BaseFunctionJitWrapper(std::unique_ptr<Package> package,
                          std::unique_ptr<FunctionJit> jit,
                          bool needs_fake_token)
       : package_(std::move(package)),
         jit_(std::move(jit)),
-        needs_fake_token_(needs_fake_token) {}
+        needs_fake_token_(needs_fake_token),
+        typed_arg_buffers_(jit_->jitted_function_base().CreateInputBuffer()),
+        typed_result_buffer_(
+            jit_->jitted_function_base().CreateOutputBuffer()),
+        packed_result_buffer_(
+            std::max<int64_t>(jit_->GetPackedReturnTypeSize(), 1)) {
+    const JitArgMarshaller& marshaller = jit_->arg_marshaller();
+    for (int64_t i = 0; i < marshaller.arg_count(); ++i) {
+      arg_leaf_offsets_.push_back(LeafOffsets(marshaller.arg_layout(i)));
+    }
+    result_leaf_offsets_ = LeafOffsets(marshaller.result_layout());
+    if (needs_fake_token_) {
+      // The result is a (token, value) tuple; skip the token leaf.
+      result_leaf_offsets_.erase(result_leaf_offsets_.begin());
+    }
+  }
 
   template <typename RealType>
   static absl::StatusOr<std::unique_ptr<RealType>> Create(
@@ -123,6 +170,44 @@ class BaseFunctionJitWrapper {
     return jit_->RunWithPackedViews(args...);
   }
 
+  // Run the jitted function using packed views of the arguments and return a
+  // packed view of type `ResultT` of the result. The result is written to a
+  // buffer owned by the wrapper so it is only valid until the next call.
+  template <typename ResultT, typename... Args>
+  absl::StatusOr<ResultT> RunInternalPackedWithOwnedResult(Args... args) {
+    ResultT result(packed_result_buffer_.data(), 0);
+    XLS_RETURN_IF_ERROR(RunInternalPacked(args..., result));
+    return result;
+  }
+
+  // Run the jitted function on a batch of packed values (see
+  // FunctionJit::RunPackedBatched).
+  absl::Status RunInternalPackedBatched(absl::Span<const uint8_t* const> args,
+                                        absl::Span<const int64_t> arg_strides,
+                                        int64_t batch_size,
+                                        uint8_t* result_buffer,
+                                        int64_t result_stride) {
+    if (needs_fake_token_) {
+      // The token and activation bit are the same for every batch element.
+      static constexpr uint8_t kTokenValue = 0;
+      static constexpr uint8_t kActivatedValue = 1;
+      std::vector<const uint8_t*> ext_args;
+      ext_args.reserve(args.size() + 2);
+      ext_args.push_back(&kTokenValue);
+      ext_args.push_back(&kActivatedValue);
+      absl::c_copy(args, std::back_inserter(ext_args));
+      std::vector<int64_t> ext_strides;
+      ext_strides.reserve(arg_strides.size() + 2);
+      ext_strides.push_back(0);
+      ext_strides.push_back(0);
+      absl::c_copy(arg_strides, std::back_inserter(ext_strides));
+      return jit_->RunPackedBatched(ext_args, ext_strides, batch_size,
+                                    result_buffer, result_stride);
+    }
+    return jit_->RunPackedBatched(args, arg_strides, batch_size, result_buffer,
+                                  result_stride);
+  }
+
   // Run the jitted function using unpacked views
   template <typename... Args>
   absl::Status RunInternalUnpacked(Args... args) {
@@ -139,6 +224,38 @@ class BaseFunctionJitWrapper {
   std::unique_ptr<Package> package_;
   std::unique_ptr<FunctionJit> jit_;
   const bool needs_fake_token_;
+
+ private:
+  static std::vector<int64_t> LeafOffsets(const TypeLayout& layout) {
+    std::vector<int64_t> offsets;
+    offsets.reserve(layout.elements().size());
+    for (const ElementLayout& element : layout.elements()) {
+      offsets.push_back(element.offset);
+    }
+    return offsets;
+  }
+
+  template <size_t... kIndices, typename... Args>
+  static absl::Status WriteTypedArgs(
+      std::index_sequence<kIndices...>, absl::Span<uint8_t* const> buffers,
+      absl::Span<const std::vector<int64_t>> leaf_offsets,
+      const Args&... args) {
+    absl::Status status;
+    (status.Update(
+         args.ToJitBuffer(leaf_offsets[kIndices], buffers[kIndices])),
+     ...);
+    return status;
+  }
+
+  // Preallocated buffers and per-leaf byte offsets of the arguments and result
+  // used by RunTyped.
+  JitArgumentSet typed_arg_buffers_;
+  JitArgumentSet typed_result_buffer_;
+  std::vector<std::vector<int64_t>> arg_leaf_offsets_;
+  std::vector<int64_t> result_leaf_offsets_;
+  // Preallocated storage for the packed result of
+  // RunInternalPackedWithOwnedResult.
+  std::vector<uint8_t> packed_result_buffer_;
 };
 
 }  // namespace xls
@@ -14,7 +14,9 @@
 
 #include "xls/jit/function_jit.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <string>
@@ -22,7 +24,10 @@
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/base/casts.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -32,7 +37,9 @@
 #include "llvm/include/llvm/IR/DataLayout.h"
 #include "llvm/include/llvm/Support/Error.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/keyword_args.h"
@@ -49,8 +56,12 @@
 namespace xls {
 
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::Create(
-    Function* xls_function, int64_t opt_level, JitObserver* observer) {
-  return CreateInternal(xls_function, opt_level, observer);
+    Function* xls_function, int64_t opt_level, JitObserver* observer,
+    std::optional<int64_t> lane_parallel_width, bool inline_loop_bodies,
+    bool narrow_with_known_bits) {
+  return CreateInternal(xls_function, opt_level, observer,
+                        lane_parallel_width, inline_loop_bodies,
+                        narrow_with_known_bits);
 }
 
 // Returns an object containing an AOT-compiled version of the specified XLS
@@ -100,12 +111,16 @@ absl::StatusOr<JitObjectCode> FunctionJit::CreateObjectCode(
 }
 
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateInternal(
-    Function* xls_function, int64_t opt_level, JitObserver* observer) {
+    Function* xls_function, int64_t opt_level, JitObserver* observer,
+    std::optional<int64_t> lane_parallel_width, bool inline_loop_bodies,
+    bool narrow_with_known_bits) {
   XLS_ASSIGN_OR_RETURN(auto orc_jit, OrcJit::Create(opt_level, observer));
   XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
                        orc_jit->CreateDataLayout());
-  XLS_ASSIGN_OR_RETURN(auto function_base,
-                       JittedFunctionBase::Build(xls_function, *orc_jit));
+  XLS_ASSIGN_OR_RETURN(
+      auto function_base,
+      JittedFunctionBase::Build(xls_function, *orc_jit, lane_parallel_width,
+                                inline_loop_bodies, narrow_with_known_bits));
 
   return std::unique_ptr<FunctionJit>(new FunctionJit(
       xls_function, std::move(orc_jit), std::move(function_base),
@@ -129,22 +144,16 @@ absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
     }
   }
 
-  std::vector<Type*> param_types;
-  for (const Param* param : xls_function_->params()) {
-    param_types.push_back(param->GetType());
-  }
-
-  // Allocate argument buffers and copy in arg Values.
   XLS_RETURN_IF_ERROR(
-      jit_runtime_->PackArgs(args, param_types, arg_buffers_.pointers()));
+      arg_marshaller_.MarshalArgs(args, arg_buffers_.pointers()));
 
   InterpreterEvents events;
   jitted_function_base_.RunJittedFunction(
       arg_buffers_, result_buffers_, temp_buffer_, &events,
       /*instance_context=*/&callbacks_, /*jit_runtime=*/runtime(),
       /*continuation_point=*/0);
-  Value result = jit_runtime_->UnpackBuffer(
-      result_buffers_.pointers()[0], xls_function_->return_value()->GetType());
+  Value result =
+      arg_marshaller_.UnmarshalResult(result_buffers_.pointers()[0]);
 
   return InterpreterResult<Value>{std::move(result), std::move(events)};
 }
@@ -185,6 +194,182 @@ template absl::Status FunctionJit::RunWithViews</*kForceZeroCopy=*/false>(
     absl::Span<uint8_t* const> args, absl::Span<uint8_t> result_buffer,
     InterpreterEvents* events);
 
+absl::Status FunctionJit::CheckBatchedBuffers(
+    absl::Span<const uint8_t* const> args, int64_t batch_size,
+    absl::Span<uint8_t> result_buffer) const {
+  if (args.size() != xls_function_->params().size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Arg list has the wrong size: %d vs expected %d.",
+                        args.size(), xls_function_->params().size()));
+  }
+  if (batch_size < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Batch size must be non-negative, got %d", batch_size));
+  }
+  if (result_buffer.size() < batch_size * GetReturnTypeSize()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Result buffer too small - must be at least %d bytes!",
+        batch_size * GetReturnTypeSize()));
+  }
+  for (int64_t i = 0; i < args.size(); ++i) {
+    if (absl::bit_cast<uintptr_t>(args[i]) % GetArgTypeAlignment(i) != 0) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Argument %d does not have alignment of %d. Pointer is %p", i,
+          GetArgTypeAlignment(i), args[i]));
+    }
+  }
+  if (absl::bit_cast<uintptr_t>(result_buffer.data()) %
+          GetReturnTypeAlignment() !=
+      0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Result buffer does not have alignment of %d. Pointer is %p",
+        GetReturnTypeAlignment(), result_buffer.data()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status FunctionJit::RunBatched(absl::Span<const uint8_t* const> args,
+                                     int64_t batch_size,
+                                     absl::Span<uint8_t> result_buffer,
+                                     InterpreterEvents* events,
+                                     int64_t thread_count) {
+  XLS_RETURN_IF_ERROR(CheckBatchedBuffers(args, batch_size, result_buffer));
+  if (thread_count < 1) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Thread count must be positive, got %d", thread_count));
+  }
+  if (batch_size == 0) {
+    return absl::OkStatus();
+  }
+
+  thread_count = std::min(thread_count, batch_size);
+  std::vector<InterpreterEvents> chunk_events(thread_count);
+  if (thread_count == 1) {
+    RunBatchChunk(args, result_buffer.data(), /*start=*/0, batch_size,
+                  temp_buffer_.get(), &chunk_events[0]);
+  } else {
+    // Each thread needs its own temporary buffer. The first chunk reuses the
+    // pre-allocated one.
+    std::vector<JitTempBuffer> temp_buffers;
+    temp_buffers.reserve(thread_count - 1);
+    for (int64_t i = 1; i < thread_count; ++i) {
+      temp_buffers.push_back(jitted_function_base_.CreateTempBuffer());
+    }
+    int64_t chunk_size = CeilOfRatio(batch_size, thread_count);
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t i = 0; i < thread_count; ++i) {
+      int64_t start = std::min(i * chunk_size, batch_size);
+      int64_t count = std::min(chunk_size, batch_size - start);
+      void* temp = i == 0 ? temp_buffer_.get() : temp_buffers[i - 1].get();
+      threads.push_back(std::make_unique<Thread>([&, i, start, count, temp]() {
+        RunBatchChunk(args, result_buffer.data(), start, count, temp,
+                      &chunk_events[i]);
+      }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+
+  absl::Status status = absl::OkStatus();
+  for (InterpreterEvents& chunk : chunk_events) {
+    if (status.ok()) {
+      status = InterpreterEventsToStatus(chunk);
+    }
+    if (events != nullptr) {
+      absl::c_move(chunk.trace_msgs, std::back_inserter(events->trace_msgs));
+      absl::c_move(chunk.assert_msgs, std::back_inserter(events->assert_msgs));
+    }
+  }
+  return status;
+}
+
+absl::Status FunctionJit::RunPackedBatched(
+    absl::Span<const uint8_t* const> args,
+    absl::Span<const int64_t> arg_strides, int64_t batch_size,
+    uint8_t* result_buffer, int64_t result_stride, InterpreterEvents* events) {
+  XLS_RET_CHECK(jitted_function_base_.HasPackedFunction());
+  if (args.size() != xls_function_->params().size() ||
+      arg_strides.size() != args.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Arg list has the wrong size: %d args and %d strides vs expected %d.",
+        args.size(), arg_strides.size(), xls_function_->params().size()));
+  }
+  if (batch_size < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Batch size must be non-negative, got %d", batch_size));
+  }
+
+  absl::InlinedVector<const uint8_t*, 8> arg_buffers(args.begin(), args.end());
+  uint8_t* output_buffers[1] = {result_buffer};
+  InterpreterEvents batch_events;
+  for (int64_t n = 0; n < batch_size; ++n) {
+    jitted_function_base_.RunPackedJittedFunction(
+        arg_buffers.data(), output_buffers, temp_buffer_.get(), &batch_events,
+        /*instance_context=*/&callbacks_, runtime(), /*continuation_point=*/0);
+    for (int64_t i = 0; i < args.size(); ++i) {
+      arg_buffers[i] += arg_strides[i];
+    }
+    output_buffers[0] += result_stride;
+  }
+
+  absl::Status status = InterpreterEventsToStatus(batch_events);
+  if (events != nullptr) {
+    absl::c_move(batch_events.trace_msgs,
+                 std::back_inserter(events->trace_msgs));
+    absl::c_move(batch_events.assert_msgs,
+                 std::back_inserter(events->assert_msgs));
+  }
+  return status;
+}
+
+absl::Status FunctionJit::RunBatchedWithTempBuffer(
+    absl::Span<const uint8_t* const> args, int64_t batch_size,
+    absl::Span<uint8_t> result_buffer, JitTempBuffer& temp_buffer,
+    InterpreterEvents* events) {
+  XLS_RETURN_IF_ERROR(CheckBatchedBuffers(args, batch_size, result_buffer));
+  XLS_RET_CHECK_EQ(temp_buffer.source(), &jitted_function_base_);
+  InterpreterEvents batch_events;
+  RunBatchChunk(args, result_buffer.data(), /*start=*/0, batch_size,
+                temp_buffer.get(), &batch_events);
+  absl::Status status = InterpreterEventsToStatus(batch_events);
+  if (events != nullptr) {
+    absl::c_move(batch_events.trace_msgs,
+                 std::back_inserter(events->trace_msgs));
+    absl::c_move(batch_events.assert_msgs,
+                 std::back_inserter(events->assert_msgs));
+  }
+  return status;
+}
+
+void FunctionJit::RunBatchChunk(absl::Span<const uint8_t* const> args,
+                                uint8_t* results, int64_t start, int64_t count,
+                                void* temp_buffer, InterpreterEvents* events) {
+  absl::InlinedVector<const uint8_t*, 8> arg_buffers(args.size());
+  for (int64_t i = 0; i < args.size(); ++i) {
+    arg_buffers[i] = args[i] + start * GetArgTypeSize(i);
+  }
+  uint8_t* output_buffers[1] = {results + start * GetReturnTypeSize()};
+  if (jitted_function_base_.HasBatchedFunction()) {
+    jitted_function_base_.RunBatchedJittedFunction(
+        arg_buffers.data(), output_buffers, temp_buffer, events,
+        /*instance_context=*/&callbacks_, runtime(), /*batch_size=*/count);
+    return;
+  }
+  // No batched entry point (e.g., AOT compiled code). Loop over the batch
+  // invoking the unbatched function.
+  for (int64_t n = 0; n < count; ++n) {
+    jitted_function_base_.RunUnalignedJittedFunction</*kForceZeroCopy=*/true>(
+        arg_buffers.data(), output_buffers, temp_buffer, events,
+        /*instance_context=*/&callbacks_, runtime(), /*continuation=*/0);
+    for (int64_t i = 0; i < args.size(); ++i) {
+      arg_buffers[i] += GetArgTypeSize(i);
+    }
+    output_buffers[0] += GetReturnTypeSize();
+  }
+}
+
 template <bool kForceZeroCopy>
 void FunctionJit::InvokeUnalignedJitFunction(
     absl::Span<const uint8_t* const> arg_buffers, uint8_t* output_buffer,
@@ -33,6 +33,7 @@
 #include "xls/ir/value.h"
 #include "xls/jit/aot_entrypoint.pb.h"
 #include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_arg_marshaller.h"
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_callbacks.h"
 #include "xls/jit/jit_runtime.h"
@@ -49,9 +50,28 @@ class FunctionJit {
  public:
   // Returns an object containing a host-compiled version of the specified XLS
   // function.
+  //
+  // If `lane_parallel_width` is given, RunBatched evaluates
+  // `lane_parallel_width` batch elements at once using vector instructions if
+  // the function is supported by the lane-parallel compilation mode (all
+  // values are bits types of at most 64 bits and only simple operations are
+  // used, see CheckLaneParallelizable). Unsupported functions silently fall
+  // back to evaluating the batch one element at a time.
+  //
+  // If `inline_loop_bodies` is true the bodies of counted_for loops are
+  // inlined into the loop which enables LLVM to vectorize and unroll simple
+  // loops (e.g., reductions) at the cost of compile time.
+  //
+  // If `narrow_with_known_bits` is true the function is analyzed with the
+  // ternary and range query engines before lowering, and unsigned additions,
+  // multiplications and comparisons whose operands have known-zero high bits
+  // are performed at a narrower width (e.g., a 128-bit add of values known to
+  // fit in 63 bits executes as a 64-bit add).
   static absl::StatusOr<std::unique_ptr<FunctionJit>> Create(
       Function* xls_function, int64_t opt_level = 3,
-      JitObserver* observer = nullptr);
+      JitObserver* observer = nullptr,
+      std::optional<int64_t> lane_parallel_width = std::nullopt,
+      bool inline_loop_bodies = false, bool narrow_with_known_bits = false);
 
   // Returns an object containing an AOT-compiled version of the specified XLS
   // function.
@@ -89,6 +109,58 @@ class FunctionJit {
                             absl::Span<uint8_t> result_buffer,
                             InterpreterEvents* events);
 
+  // Executes the compiled function `batch_size` times. Arguments and results
+  // are in a structure-of-arrays layout: `args[i]` points to a contiguous array
+  // of `batch_size` values of the i-th parameter in the native LLVM data layout,
+  // each `GetArgTypeSize(i)` bytes apart, and `result_buffer` holds
+  // `batch_size` results each `GetReturnTypeSize()` bytes apart. Every array
+  // must be aligned to the ABI alignment of its type (see GetArgTypeAlignment
+  // and GetReturnTypeAlignment); no copies are made to fix up misalignment.
+  //
+  // The batch is split into `thread_count` contiguous chunks which are run in
+  // parallel, each chunk reusing a single temporary buffer. Events from all
+  // chunks are appended to `events` (if non-null) in batch order. Returns an
+  // error if any element of the batch raised an assertion.
+  absl::Status RunBatched(absl::Span<const uint8_t* const> args,
+                          int64_t batch_size, absl::Span<uint8_t> result_buffer,
+                          InterpreterEvents* events = nullptr,
+                          int64_t thread_count = 1);
+
+  // As RunBatched, but runs the whole batch on the calling thread using
+  // `temp_buffer` (see CreateTempBuffer) instead of storage owned by this
+  // object. Calls with distinct temporary buffers may run concurrently on the
+  // same FunctionJit.
+  absl::Status RunBatchedWithTempBuffer(absl::Span<const uint8_t* const> args,
+                                        int64_t batch_size,
+                                        absl::Span<uint8_t> result_buffer,
+                                        JitTempBuffer& temp_buffer,
+                                        InterpreterEvents* events = nullptr);
+
+  // Creates temporary storage for RunBatchedWithTempBuffer.
+  JitTempBuffer CreateTempBuffer() const {
+    return jitted_function_base_.CreateTempBuffer();
+  }
+
+  // Executes the compiled function `batch_size` times with arguments and
+  // results in the packed layout (see RunWithPackedViews). `args[i]` points to
+  // the first of `batch_size` packed values of the i-th parameter, each
+  // `arg_strides[i]` bytes after the last; a stride of zero passes the same
+  // value to every element of the batch. Results are likewise written
+  // `result_stride` bytes apart starting at `result_buffer`. A stride may
+  // exceed the packed size of its type, e.g. to read and write arrays of C++
+  // values wider than the XLS type.
+  //
+  // The batch is run on the calling thread reusing a single temporary buffer,
+  // so this avoids the per-call overhead of RunWithPackedViews but not the
+  // per-element call into the jitted code. Events from all elements are
+  // appended to `events` (if non-null) in batch order. Returns an error if any
+  // element of the batch raised an assertion.
+  absl::Status RunPackedBatched(absl::Span<const uint8_t* const> args,
+                                absl::Span<const int64_t> arg_strides,
+                                int64_t batch_size, uint8_t* result_buffer,
+                                int64_t result_stride,
+                                InterpreterEvents* events = nullptr);
+
   // Similar to RunWithViews(), except the arguments here are _packed_views_ -
   // views whose data elements are tightly packed, with no padding bits or bytes
   // between them. The function return value is specified as the last arg - its
@@ -191,6 +263,12 @@ class FunctionJit {
 
   JitRuntime* runtime() const { return jit_runtime_.get(); }
 
+  // Returns the converter between Values and the native layout of the
+  // function's parameters and result. Callers which run the function many
+  // times can use it to write arguments directly into their own preallocated
+  // buffers for use with RunWithViews.
+  const JitArgMarshaller& arg_marshaller() const { return arg_marshaller_; }
+
  private:
   FunctionJit(Function* xls_function, std::unique_ptr<OrcJit>&& orc_jit,
               JittedFunctionBase&& jitted_function_base,
@@ -201,10 +279,14 @@ class FunctionJit {
         arg_buffers_(jitted_function_base_.CreateInputBuffer()),
         result_buffers_(jitted_function_base_.CreateOutputBuffer()),
         temp_buffer_(jitted_function_base_.CreateTempBuffer()),
-        jit_runtime_(std::move(runtime)) {}
+        jit_runtime_(std::move(runtime)),
+        arg_marshaller_(JitArgMarshaller::Create(xls_function, *jit_runtime_)) {
+  }
 
   static absl::StatusOr<std::unique_ptr<FunctionJit>> CreateInternal(
-      Function* xls_function, int64_t opt_level, JitObserver* observer);
+      Function* xls_function, int64_t opt_level, JitObserver* observer,
+      std::optional<int64_t> lane_parallel_width, bool inline_loop_bodies,
+      bool narrow_with_known_bits);
 
   template <bool kForceZeroCopy, typename... ArgsT>
   absl::Status RunWithUnpackedViewsCommon(ArgsT... args) {
@@ -257,6 +339,17 @@ class FunctionJit {
     *result_buffer = front.mutable_buffer();
   }
 
+  // Checks the arguments of RunBatched and RunBatchedWithTempBuffer.
+  absl::Status CheckBatchedBuffers(absl::Span<const uint8_t* const> args,
+                                   int64_t batch_size,
+                                   absl::Span<uint8_t> result_buffer) const;
+
+  // Runs elements [start, start + count) of a batch (see RunBatched) using
+  // `temp_buffer` as the temporary storage.
+  void RunBatchChunk(absl::Span<const uint8_t* const> args, uint8_t* results,
+                     int64_t start, int64_t count, void* temp_buffer,
+                     InterpreterEvents* events);
+
   // Invokes the jitted function with the given argument and outputs.
   template <bool kForceZeroCopy = false>
   void InvokeUnalignedJitFunction(absl::Span<const uint8_t* const> arg_buffers,
@@ -281,6 +374,10 @@ class FunctionJit {
   InstanceContext callbacks_ = InstanceContext::CreateForFunc();
 
   std::unique_ptr<JitRuntime> jit_runtime_;
+
+  // Converts arguments and results of Run between Values and the native
+  // layout.
+  JitArgMarshaller arg_marshaller_;
 };
 
 }  // namespace xls
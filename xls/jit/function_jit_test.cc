@@ -14,6 +14,7 @@
 
 #include "xls/jit/function_jit.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <cstring>
@@ -26,11 +27,13 @@
 #include <string>
 #include <string_view>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "fuzztest/fuzztest.h"
+#include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -41,13 +44,19 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "llvm/include/llvm/IR/BasicBlock.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
+#include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/Instruction.h"
+#include "llvm/include/llvm/IR/Module.h"
 #include "xls/common/bits_util.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/ir_evaluator_test_base.h"
 #include "xls/interpreter/random_value.h"
 #include "xls/ir/bits.h"
@@ -64,6 +73,7 @@
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
 
 namespace xls {
@@ -745,6 +755,143 @@ TEST(FunctionJitTest, ArrayConcatArrayOfArrays) {
   EXPECT_THAT(RunJitNoEvents(jit.get(), args), IsOkAndHolds(ret));
 }
 
+TEST(FunctionJitTest, ArrayUpdateChain) {
+  Package package("my_package");
+
+  // array_update.2 has two users so array_update.3 may not update it in place.
+  // array_update.5 has an out-of-bounds index and is a no-op.
+  std::string ir_text = R"(
+  fn f(a: bits[32][4], x: bits[32]) -> (bits[32][4], bits[32][4]) {
+    literal.1: bits[32] = literal(value=1)
+    array_update.2: bits[32][4] = array_update(a, x, indices=[literal.1])
+    array_update.3: bits[32][4] = array_update(array_update.2, x, indices=[x])
+    literal.4: bits[32] = literal(value=7)
+    array_update.5: bits[32][4] = array_update(array_update.3, x, indices=[literal.4])
+    literal.6: bits[2] = literal(value=3)
+    array_update.7: bits[32][4] = array_update(array_update.5, literal.1, indices=[literal.6])
+    ret tuple.8: (bits[32][4], bits[32][4]) = tuple(array_update.2, array_update.7)
+  }
+  )";
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Value a, Value::UBitsArray({10, 11, 12, 13}, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Value updated_a,
+                           Value::UBitsArray({10, 2, 12, 13}, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Value updated_twice_a,
+                           Value::UBitsArray({10, 2, 2, 1}, 32));
+  std::vector<Value> args = {a, Value(UBits(2, 32))};
+  EXPECT_THAT(RunJitNoEvents(jit.get(), args),
+              IsOkAndHolds(Value::Tuple({updated_a, updated_twice_a})));
+  // The argument is unchanged.
+  EXPECT_EQ(args[0], a);
+}
+
+TEST(FunctionJitTest, LongArrayUpdateChainSharesBuffer) {
+  // A chain of array updates long enough to span several partitions of the
+  // jitted function. Each update is performed in place so the chain needs at
+  // most a single array-sized buffer in the temp block.
+  constexpr int64_t kArraySize = 16;
+  constexpr int64_t kChainLength = 500;
+  Package package("my_package");
+  FunctionBuilder fb("f", &package);
+  BValue array = fb.Param(
+      "a", package.GetArrayType(kArraySize, package.GetBitsType(32)));
+  std::vector<uint64_t> expected(kArraySize, 0);
+  for (int64_t i = 0; i < kChainLength; ++i) {
+    array = fb.ArrayUpdate(array, fb.Literal(UBits(i, 32)),
+                           {fb.Literal(UBits(i % kArraySize, 32))});
+    expected[i % kArraySize] = i;
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  EXPECT_LE(jit->GetTempBufferSize(), kArraySize * sizeof(uint32_t));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Value a, Value::UBitsArray(std::vector<uint64_t>(kArraySize, 7), 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Value result, Value::UBitsArray(expected, 32));
+  std::vector<Value> args = {a};
+  EXPECT_THAT(RunJitNoEvents(jit.get(), args), IsOkAndHolds(result));
+}
+
+class CountedForInlineTest : public ::testing::TestWithParam<bool> {};
+
+TEST_P(CountedForInlineTest, DotProduct) {
+  std::string ir_text = R"(
+  package my_package
+
+  fn body(i: bits[32], acc: bits[32], a: bits[32][8], b: bits[32][8]) -> bits[32] {
+    array_index.1: bits[32] = array_index(a, indices=[i])
+    array_index.2: bits[32] = array_index(b, indices=[i])
+    umul.3: bits[32] = umul(array_index.1, array_index.2)
+    ret add.4: bits[32] = add(acc, umul.3)
+  }
+
+  top fn dot(a: bits[32][8], b: bits[32][8]) -> bits[32] {
+    literal.5: bits[32] = literal(value=0)
+    ret counted_for.6: bits[32] = counted_for(literal.5, trip_count=8, stride=1, body=body, invariant_args=[a, b])
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, p->GetTopAsFunction());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto jit, FunctionJit::Create(function, /*opt_level=*/3,
+                                    /*observer=*/nullptr,
+                                    /*lane_parallel_width=*/std::nullopt,
+                                    /*inline_loop_bodies=*/GetParam()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Value a,
+                           Value::UBitsArray({1, 2, 3, 4, 5, 6, 7, 8}, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Value b,
+                           Value::UBitsArray({8, 7, 6, 5, 4, 3, 2, 1}, 32));
+  std::vector<Value> args = {a, b};
+  EXPECT_THAT(RunJitNoEvents(jit.get(), args),
+              IsOkAndHolds(Value(UBits(120, 32))));
+}
+
+TEST_P(CountedForInlineTest, ArrayState) {
+  std::string ir_text = R"(
+  package my_package
+
+  fn body(i: bits[4], state: bits[16][4], x: bits[16]) -> bits[16][4] {
+    array_index.1: bits[16] = array_index(state, indices=[i])
+    add.2: bits[16] = add(array_index.1, x)
+    zero_ext.3: bits[16] = zero_ext(i, new_bit_count=16)
+    add.4: bits[16] = add(add.2, zero_ext.3)
+    ret array_update.5: bits[16][4] = array_update(state, add.4, indices=[i])
+  }
+
+  top fn f(init: bits[16][4], x: bits[16]) -> bits[16][4] {
+    ret counted_for.6: bits[16][4] = counted_for(init, trip_count=2, stride=2, body=body, invariant_args=[x])
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, p->GetTopAsFunction());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto jit, FunctionJit::Create(function, /*opt_level=*/3,
+                                    /*observer=*/nullptr,
+                                    /*lane_parallel_width=*/std::nullopt,
+                                    /*inline_loop_bodies=*/GetParam()));
+
+  // Iterations have index 0 and 2.
+  XLS_ASSERT_OK_AND_ASSIGN(Value init, Value::UBitsArray({1, 2, 3, 4}, 16));
+  XLS_ASSERT_OK_AND_ASSIGN(Value expected,
+                           Value::UBitsArray({11, 2, 15, 4}, 16));
+  std::vector<Value> args = {init, Value(UBits(10, 16))};
+  EXPECT_THAT(RunJitNoEvents(jit.get(), args), IsOkAndHolds(expected));
+}
+
+INSTANTIATE_TEST_SUITE_P(CountedForInlineTestInstantiation,
+                         CountedForInlineTest, ::testing::Bool(),
+                         [](const TestParamInfo<bool>& info) {
+                           return info.param ? "Inlined" : "NotInlined";
+                         });
+
 // The assert tests below are duplicates of the ones in
 // xls/interpereter/ir_evaluator_test_base.cc because those recompile
 // the test function each time they run it. These tests check that
@@ -1079,6 +1226,432 @@ TEST(FunctionJitDeathTest, MisalignedPointerCaught) {
 #endif
 }
 
+TEST(FunctionJitTest, RunBatched) {
+  Package package("my_package");
+  FunctionBuilder fb("test", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  BValue y = fb.Param("y", package.GetBitsType(32));
+  fb.Add(fb.UMul(x, x), y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  ASSERT_TRUE(jit->jitted_function_base().HasBatchedFunction());
+  ASSERT_EQ(jit->GetArgTypeSize(0), sizeof(uint32_t));
+  ASSERT_EQ(jit->GetReturnTypeSize(), sizeof(uint32_t));
+
+  constexpr int64_t kBatchSize = 1001;
+  std::vector<uint32_t> xs(kBatchSize);
+  std::vector<uint32_t> ys(kBatchSize);
+  std::vector<uint32_t> expected(kBatchSize);
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    xs[i] = i;
+    ys[i] = 3 * i + 7;
+    expected[i] = xs[i] * xs[i] + ys[i];
+  }
+  std::vector<const uint8_t*> args = {
+      reinterpret_cast<const uint8_t*>(xs.data()),
+      reinterpret_cast<const uint8_t*>(ys.data())};
+  for (int64_t thread_count : {1, 4}) {
+    std::vector<uint32_t> results(kBatchSize);
+    XLS_ASSERT_OK(jit->RunBatched(
+        args, kBatchSize,
+        absl::MakeSpan(reinterpret_cast<uint8_t*>(results.data()),
+                       results.size() * sizeof(uint32_t)),
+        /*events=*/nullptr, thread_count));
+    EXPECT_EQ(results, expected) << "thread count: " << thread_count;
+  }
+}
+
+TEST(FunctionJitTest, RunBatchedWithTempBufferFromManyThreads) {
+  Package package("my_package");
+  FunctionBuilder fb("test", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  BValue y = fb.Param("y", package.GetBitsType(32));
+  fb.Add(fb.UMul(x, x), y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  // Each thread evaluates its own batch through the shared jit.
+  constexpr int64_t kThreadCount = 4;
+  constexpr int64_t kBatchSize = 257;
+  std::vector<std::vector<uint32_t>> xs(kThreadCount);
+  std::vector<std::vector<uint32_t>> ys(kThreadCount);
+  std::vector<std::vector<uint32_t>> results(kThreadCount);
+  std::vector<absl::Status> statuses(kThreadCount);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t t = 0; t < kThreadCount; ++t) {
+    for (int64_t i = 0; i < kBatchSize; ++i) {
+      xs[t].push_back(t * kBatchSize + i);
+      ys[t].push_back(t + 1);
+    }
+    results[t].resize(kBatchSize);
+    threads.push_back(std::make_unique<Thread>([&, t]() {
+      JitTempBuffer temp_buffer = jit->CreateTempBuffer();
+      std::vector<const uint8_t*> args = {
+          reinterpret_cast<const uint8_t*>(xs[t].data()),
+          reinterpret_cast<const uint8_t*>(ys[t].data())};
+      for (int64_t rep = 0; rep < 10; ++rep) {
+        statuses[t] = jit->RunBatchedWithTempBuffer(
+            args, kBatchSize,
+            absl::MakeSpan(reinterpret_cast<uint8_t*>(results[t].data()),
+                           kBatchSize * sizeof(uint32_t)),
+            temp_buffer);
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  for (int64_t t = 0; t < kThreadCount; ++t) {
+    XLS_EXPECT_OK(statuses[t]);
+    for (int64_t i = 0; i < kBatchSize; ++i) {
+      EXPECT_EQ(results[t][i], xs[t][i] * xs[t][i] + ys[t][i])
+          << "thread " << t << " element " << i;
+    }
+  }
+}
+
+TEST(FunctionJitTest, RunPackedBatched) {
+  Package package("my_package");
+  FunctionBuilder fb("test", &package);
+  BValue x = fb.Param("x", package.GetBitsType(17));
+  BValue y = fb.Param("y", package.GetBitsType(17));
+  fb.Add(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  // Values are read from and written to uint32_t arrays, wider than the packed
+  // 3-byte layout. `y` is broadcast to the whole batch with a zero stride.
+  constexpr int64_t kBatchSize = 101;
+  std::vector<uint32_t> xs(kBatchSize);
+  uint32_t y_value = 0x1ff00;
+  std::vector<uint32_t> expected(kBatchSize);
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    xs[i] = 1001 * i;
+    expected[i] = (xs[i] + y_value) & 0x1ffff;
+  }
+  std::vector<const uint8_t*> args = {
+      reinterpret_cast<const uint8_t*>(xs.data()),
+      reinterpret_cast<const uint8_t*>(&y_value)};
+  std::vector<int64_t> strides = {sizeof(uint32_t), 0};
+  std::vector<uint32_t> results(kBatchSize, 0);
+  XLS_ASSERT_OK(jit->RunPackedBatched(
+      args, strides, kBatchSize, reinterpret_cast<uint8_t*>(results.data()),
+      sizeof(uint32_t)));
+  EXPECT_EQ(results, expected);
+}
+
+TEST(FunctionJitTest, RunBatchedLaneParallel) {
+  Package package("my_package");
+  FunctionBuilder fb("test", &package);
+  BValue x = fb.Param("x", package.GetBitsType(13));
+  BValue y = fb.Param("y", package.GetBitsType(7));
+  BValue y_wide = fb.SignExtend(y, 13);
+  BValue shifted = fb.Or(fb.Shll(x, y), fb.Shra(x, fb.BitSlice(y, 0, 3)));
+  BValue product = fb.SMul(x, y, 20);
+  BValue selector = fb.Concat({fb.XorReduce(x), fb.SLt(x, y_wide)});
+  BValue selected = fb.Select(
+      selector, {fb.Add(x, y_wide), fb.Subtract(x, y_wide), fb.Shrl(x, y)},
+      /*default_value=*/fb.Not(x));
+  fb.Concat({fb.BitSlice(product, 4, 16), fb.Xor(shifted, selected),
+             fb.UGt(x, y_wide)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto scalar_jit, FunctionJit::Create(function));
+  EXPECT_EQ(scalar_jit->jitted_function_base().batched_lane_count(), 1);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto jit, FunctionJit::Create(function, /*opt_level=*/3,
+                                    /*observer=*/nullptr,
+                                    /*lane_parallel_width=*/8));
+  EXPECT_EQ(jit->jitted_function_base().batched_lane_count(), 8);
+
+  // Use a batch size which is not a multiple of the lane count to exercise the
+  // scalar tail.
+  constexpr int64_t kBatchSize = 101;
+  std::minstd_rand bitgen;
+  std::vector<std::vector<Value>> batch_args(kBatchSize);
+  std::vector<std::unique_ptr<uint8_t[], DeleteAligned>> arg_arrays;
+  for (int64_t i = 0; i < function->params().size(); ++i) {
+    Type* type = function->param(i)->GetType();
+    int64_t size = jit->GetArgTypeSize(i);
+    arg_arrays.emplace_back(static_cast<uint8_t*>(
+        AllocateAligned(jit->GetArgTypeAlignment(i), size * kBatchSize)));
+    for (int64_t n = 0; n < kBatchSize; ++n) {
+      Value value = RandomValue(type, bitgen);
+      jit->runtime()->BlitValueToBuffer(
+          value, type, absl::MakeSpan(arg_arrays.back().get() + n * size, size));
+      batch_args[n].push_back(value);
+    }
+  }
+  std::vector<const uint8_t*> args;
+  for (const auto& array : arg_arrays) {
+    args.push_back(array.get());
+  }
+  int64_t result_size = jit->GetReturnTypeSize();
+  std::unique_ptr<uint8_t[], DeleteAligned> results(static_cast<uint8_t*>(
+      AllocateAligned(jit->GetReturnTypeAlignment(), result_size * kBatchSize)));
+  XLS_ASSERT_OK(
+      jit->RunBatched(args, kBatchSize,
+                      absl::MakeSpan(results.get(), result_size * kBatchSize)));
+
+  for (int64_t n = 0; n < kBatchSize; ++n) {
+    XLS_ASSERT_OK_AND_ASSIGN(Value expected,
+                             RunJitNoEvents(scalar_jit.get(), batch_args[n]));
+    EXPECT_EQ(jit->runtime()->UnpackBuffer(results.get() + n * result_size,
+                                           function->GetType()->return_type()),
+              expected)
+        << "batch element " << n;
+  }
+}
+
+TEST(FunctionJitTest, RunBatchedLaneParallelUnsupportedFallsBack) {
+  Package package("my_package");
+  FunctionBuilder fb("test", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  fb.UDiv(x, fb.Literal(UBits(7, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto jit, FunctionJit::Create(function, /*opt_level=*/3,
+                                    /*observer=*/nullptr,
+                                    /*lane_parallel_width=*/8));
+  EXPECT_EQ(jit->jitted_function_base().batched_lane_count(), 1);
+
+  std::vector<uint32_t> xs = {0, 7, 70, 71, 1000};
+  std::vector<uint32_t> results(xs.size());
+  std::vector<const uint8_t*> args = {
+      reinterpret_cast<const uint8_t*>(xs.data())};
+  XLS_ASSERT_OK(jit->RunBatched(
+      args, xs.size(),
+      absl::MakeSpan(reinterpret_cast<uint8_t*>(results.data()),
+                     results.size() * sizeof(uint32_t))));
+  EXPECT_THAT(results, ElementsAre(0, 1, 10, 10, 142));
+}
+
+TEST(FunctionJitTest, LaneParallelWidthMustBePowerOfTwo) {
+  Package package("my_package");
+  FunctionBuilder fb("test", &package);
+  fb.Not(fb.Param("x", package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  EXPECT_THAT(FunctionJit::Create(function, /*opt_level=*/3,
+                                  /*observer=*/nullptr,
+                                  /*lane_parallel_width=*/6),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("power of two")));
+}
+
+TEST(FunctionJitTest, RunBatchedAssert) {
+  Package package("my_package");
+  FunctionBuilder fb("test", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  fb.Assert(fb.Literal(Value::Token()),
+            fb.ULt(x, fb.Literal(UBits(100, 32))), "x is too big");
+  fb.Add(x, fb.Literal(UBits(1, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  std::vector<uint32_t> xs = {1, 2, 300, 4};
+  std::vector<uint32_t> results(xs.size());
+  std::vector<const uint8_t*> args = {
+      reinterpret_cast<const uint8_t*>(xs.data())};
+  InterpreterEvents events;
+  EXPECT_THAT(jit->RunBatched(
+                  args, xs.size(),
+                  absl::MakeSpan(reinterpret_cast<uint8_t*>(results.data()),
+                                 results.size() * sizeof(uint32_t)),
+                  &events),
+              StatusIs(absl::StatusCode::kAborted, HasSubstr("x is too big")));
+  EXPECT_EQ(events.assert_msgs.size(), 1);
+}
+
+TEST(FunctionJitTest, RunBatchedResultBufferTooSmall) {
+  Package package("my_package");
+  FunctionBuilder fb("test", &package);
+  fb.Not(fb.Param("x", package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  std::vector<uint32_t> xs(8);
+  std::vector<uint32_t> results(4);
+  std::vector<const uint8_t*> args = {
+      reinterpret_cast<const uint8_t*>(xs.data())};
+  EXPECT_THAT(jit->RunBatched(
+                  args, xs.size(),
+                  absl::MakeSpan(reinterpret_cast<uint8_t*>(results.data()),
+                                 results.size() * sizeof(uint32_t))),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Result buffer too small")));
+}
+
+TEST(FunctionJitTest, ConcurrentCompilation) {
+  OrcJit::SetDefaultCompileThreadCount(4);
+  absl::Cleanup reset_thread_count = [] {
+    OrcJit::SetDefaultCompileThreadCount(1);
+  };
+
+  // A chain of functions each calling the previous one so the module splits
+  // into many partitions with cross-partition calls.
+  Package package("my_package");
+  Function* callee = nullptr;
+  for (int64_t i = 0; i < 16; ++i) {
+    FunctionBuilder fb(absl::StrFormat("f%d", i), &package);
+    BValue x = fb.Param("x", package.GetBitsType(32));
+    if (callee != nullptr) {
+      x = fb.Invoke({x}, callee);
+    }
+    fb.Add(x, fb.Literal(UBits(i, 32)));
+    XLS_ASSERT_OK_AND_ASSIGN(callee, fb.Build());
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(callee));
+  // 1 + (0 + 1 + ... + 15)
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {Value(UBits(1, 32))}),
+              IsOkAndHolds(Value(UBits(121, 32))));
+}
+
+// Records the number of functions defined in optimized modules.
+class DefinedFunctionCounter final : public JitObserver {
+ public:
+  JitObserverRequests GetNotificationOptions() const final {
+    return JitObserverRequests{.optimized_module = true};
+  }
+  void OptimizedModule(const llvm::Module* module) final {
+    for (const llvm::Function& function : *module) {
+      if (!function.isDeclaration()) {
+        ++count_;
+      }
+    }
+  }
+  int64_t count() const { return count_; }
+
+ private:
+  int64_t count_ = 0;
+};
+
+TEST(FunctionJitTest, HugeFunctionKeepsPartitionsSeparate) {
+  // A long enough chain of adds that the partitions of the function are not
+  // inlined back into a single LLVM function.
+  constexpr int64_t kAdds = 6000;
+  Package package("my_package");
+  FunctionBuilder fb("f", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  for (int64_t i = 0; i < kAdds; ++i) {
+    x = fb.Add(x, fb.Literal(UBits(1, 32)));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  DefinedFunctionCounter counter;
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit,
+                           FunctionJit::Create(f, /*opt_level=*/3, &counter));
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {Value(UBits(7, 32))}),
+              IsOkAndHolds(Value(UBits(7 + kAdds, 32))));
+  // At least one function per 100 node partition survives optimization.
+  EXPECT_GT(counter.count(), 2 * kAdds / 100);
+}
+
+TEST(FunctionJitTest, ReportsCompilePhaseTimes) {
+  Package package("my_package");
+  FunctionBuilder fb("f", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  fb.UMul(x, fb.Add(x, fb.Literal(UBits(3, 32))));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  JitCompileTimeObserver observer;
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit,
+                           FunctionJit::Create(f, /*opt_level=*/3, &observer));
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {Value(UBits(2, 32))}),
+              IsOkAndHolds(Value(UBits(10, 32))));
+  EXPECT_GT(observer.GetTotal(JitCompilePhase::kIrBuilding),
+            absl::ZeroDuration());
+  EXPECT_GT(observer.GetTotal(JitCompilePhase::kOptimization),
+            absl::ZeroDuration());
+  EXPECT_GT(observer.GetTotal(JitCompilePhase::kCodegen),
+            absl::ZeroDuration());
+  EXPECT_THAT(observer.ToString(), HasSubstr("optimization: "));
+}
+
+TEST(FunctionJitTest, ModulesOverInstructionBudgetStillCompile) {
+  // Every module is over a budget of one instruction so is optimized at the
+  // cheaper level.
+  OrcJit::SetDefaultLargeModuleInstructionCount(1);
+  absl::Cleanup reset_budget = [] {
+    OrcJit::SetDefaultLargeModuleInstructionCount(
+        OrcJit::kDefaultLargeModuleInstructionCount);
+  };
+  Package package("my_package");
+  FunctionBuilder fb("f", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  fb.UMul(x, fb.Add(x, fb.Literal(UBits(3, 32))));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+  EXPECT_THAT(RunJitNoEvents(jit.get(), {Value(UBits(2, 32))}),
+              IsOkAndHolds(Value(UBits(10, 32))));
+}
+
+// Records the widest integer add or multiply in unoptimized modules.
+class WidestArithmeticObserver final : public JitObserver {
+ public:
+  JitObserverRequests GetNotificationOptions() const final {
+    return JitObserverRequests{.unoptimized_module = true};
+  }
+  void UnoptimizedModule(const llvm::Module* module) final {
+    for (const llvm::Function& function : *module) {
+      for (const llvm::BasicBlock& block : function) {
+        for (const llvm::Instruction& inst : block) {
+          if ((inst.getOpcode() == llvm::Instruction::Add ||
+               inst.getOpcode() == llvm::Instruction::Mul) &&
+              inst.getType()->isIntegerTy()) {
+            widest_ = std::max<int64_t>(widest_,
+                                        inst.getType()->getIntegerBitWidth());
+          }
+        }
+      }
+    }
+  }
+  int64_t widest() const { return widest_; }
+
+ private:
+  int64_t widest_ = 0;
+};
+
+class KnownBitsNarrowingTest : public ::testing::TestWithParam<bool> {};
+
+TEST_P(KnownBitsNarrowingTest, WideArithmeticOnNarrowValues) {
+  Package package("my_package");
+  FunctionBuilder fb("f", &package);
+  BValue x = fb.ZeroExtend(fb.Param("x", package.GetBitsType(32)), 128);
+  BValue y = fb.ZeroExtend(fb.Param("y", package.GetBitsType(32)), 128);
+  fb.Tuple({fb.Add(x, y), fb.UMul(x, y), fb.ULt(x, y), fb.UGe(x, y)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  WidestArithmeticObserver observer;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto jit, FunctionJit::Create(f, /*opt_level=*/3, &observer,
+                                    /*lane_parallel_width=*/std::nullopt,
+                                    /*inline_loop_bodies=*/false,
+                                    /*narrow_with_known_bits=*/GetParam()));
+  // The 33-bit sum and 64-bit product fit in 64 bits.
+  EXPECT_EQ(observer.widest(), GetParam() ? 64 : 128);
+
+  for (auto [a, b] : std::vector<std::pair<uint64_t, uint64_t>>{
+           {0, 0}, {3, 7}, {0xffffffff, 0xffffffff}, {0x80000000, 2}}) {
+    Bits a_wide = UBits(a, 128);
+    Bits b_wide = UBits(b, 128);
+    Value expected = Value::Tuple(
+        {Value(bits_ops::Add(a_wide, b_wide)),
+         Value(bits_ops::UMul(a_wide, b_wide).Slice(0, 128)),
+         Value::Bool(a < b), Value::Bool(a >= b)});
+    EXPECT_THAT(
+        RunJitNoEvents(jit.get(), {Value(UBits(a, 32)), Value(UBits(b, 32))}),
+        IsOkAndHolds(expected));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(KnownBitsNarrowingTestInstantiation,
+                         KnownBitsNarrowingTest, ::testing::Bool(),
+                         [](const TestParamInfo<bool>& info) {
+                           return info.param ? "Narrowed" : "NotNarrowed";
+                         });
+
 // Check that expected_data matched output_data.
 // Log values of expected_data, output_data, and whatever entries are in
 // extra_data.
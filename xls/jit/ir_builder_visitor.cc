@@ -35,10 +35,13 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "llvm/include/llvm/IR/Attributes.h"
 #include "llvm/include/llvm/IR/BasicBlock.h"
 #include "llvm/include/llvm/IR/Constants.h"
 #include "llvm/include/llvm/IR/DerivedTypes.h"
+#include "llvm/include/llvm/IR/Function.h"
 #include "llvm/include/llvm/IR/IRBuilder.h"
+#include "llvm/include/llvm/IR/Instruction.h"
 #include "llvm/include/llvm/IR/Instructions.h"
 #include "llvm/include/llvm/IR/Intrinsics.h"
 #include "llvm/include/llvm/IR/LLVMContext.h"
@@ -66,6 +69,10 @@
 #include "xls/ir/value_utils.h"
 #include "xls/jit/jit_callbacks.h"
 #include "xls/jit/llvm_type_converter.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/range_query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+#include "xls/passes/union_query_engine.h"
 
 namespace xls {
 
@@ -77,6 +84,24 @@ bool ShouldMaterializeAtUse(Node* node) {
   return node->Is<Literal>() && node->GetType()->IsBits();
 }
 
+absl::StatusOr<const QueryEngine*> JitBuilderContext::GetQueryEngine(
+    FunctionBase* f) {
+  if (!narrow_with_known_bits_) {
+    return nullptr;
+  }
+  std::unique_ptr<QueryEngine>& query_engine = query_engines_[f];
+  if (query_engine == nullptr) {
+    std::vector<std::unique_ptr<QueryEngine>> query_engines;
+    query_engines.push_back(std::make_unique<TernaryQueryEngine>());
+    query_engines.push_back(std::make_unique<RangeQueryEngine>());
+    auto union_engine =
+        std::make_unique<UnionQueryEngine>(std::move(query_engines));
+    XLS_RETURN_IF_ERROR(union_engine->Populate(f).status());
+    query_engine = std::move(union_engine);
+  }
+  return query_engine.get();
+}
+
 namespace {
 
 // Abstraction representing a value carried across iterations of the loop.
@@ -1032,6 +1057,8 @@ class IrBuilderVisitor : public DfsVisitorWithDefault {
 
   absl::Status HandleRegisterWrite(RegisterWrite* write) override;
   absl::Status HandleOutputPort(OutputPort* write) override;
+  absl::Status HandleInstantiationInput(
+      InstantiationInput* instantiation_input) override;
   absl::Status HandleAdd(BinOp* binop) override;
   absl::Status HandleAndReduce(BitwiseReductionOp* op) override;
   absl::Status HandleAfterAll(AfterAll* after_all) override;
@@ -1135,6 +1162,23 @@ class IrBuilderVisitor : public DfsVisitorWithDefault {
           build_result,
       bool is_signed);
 
+  // How the width of the result of an unsigned operation depends on the
+  // widths of its operands.
+  enum class UnsignedOpKind { kAdd, kMul, kCompare };
+
+  // Handler for unsigned add, multiply and comparison nodes. If known-bits
+  // narrowing is enabled and the operands have enough known-zero high bits,
+  // `build_result` is applied to the operands zero-extended or truncated to a
+  // narrower LLVM integer type than the operation would otherwise use, and
+  // the result is zero-extended back to the type of `node`. Otherwise the node
+  // is lowered as by HandleBinaryOp (or HandleBinaryOpWithOperandConversion
+  // for multiplies).
+  absl::Status HandleUnsignedBinaryOp(
+      Node* node, UnsignedOpKind kind,
+      std::function<llvm::Value*(llvm::Value*, llvm::Value*,
+                                 llvm::IRBuilder<>&)>
+          build_result);
+
   // Gets the built function representing the given XLS function.
   absl::StatusOr<llvm::Function*> GetFunction(Function* function) {
     return jit_context_.GetLlvmFunction(function);
@@ -1348,9 +1392,24 @@ absl::Status IrBuilderVisitor::HandleOutputPort(OutputPort* write) {
       /*result_type=*/write->operand(0)->GetType());
 }
 
+absl::Status IrBuilderVisitor::HandleInstantiationInput(
+    InstantiationInput* instantiation_input) {
+  XLS_RET_CHECK(instantiation_input->function_base()->IsBlock())
+      << "instantiation-input in non-block function.";
+  XLS_ASSIGN_OR_RETURN(NodeIrContext node_context,
+                       NewNodeIrContext(instantiation_input, {"data"},
+                                        /*include_wrapper_args=*/false));
+  auto value = node_context.LoadOperand(0);
+  return FinalizeNodeIrContextWithValue(
+      std::move(node_context), value, /*exit_builder=*/std::nullopt,
+      /*return_value=*/std::nullopt,
+      /*result_type=*/instantiation_input->data()->GetType());
+}
+
 absl::Status IrBuilderVisitor::HandleAdd(BinOp* binop) {
-  return HandleBinaryOp(
-      binop, [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
+  return HandleUnsignedBinaryOp(
+      binop, UnsignedOpKind::kAdd,
+      [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
         return b.CreateAdd(lhs, rhs);
       });
 }
@@ -1628,9 +1687,24 @@ absl::Status IrBuilderVisitor::HandleArrayUpdate(ArrayUpdate* update) {
   llvm::IRBuilder<>& b = node_context.entry_builder();
 
   // First, copy the entire array to update (operand 0) to the output buffer.
+  // The buffer allocator may assign the output the same buffer as the array to
+  // update (e.g., in chains of array updates) in which case the update is
+  // performed in place and no copy is necessary.
   llvm::Value* output_buffer = node_context.GetOutputPtr(0);
-  LlvmMemcpy(output_buffer, node_context.GetOperandPtr(0),
-             type_converter()->GetTypeByteSize(update->GetType()), b);
+  llvm::Value* array_buffer = node_context.GetOperandPtr(0);
+  llvm::Value* update_value_buffer = node_context.GetOperandPtr(1);
+  llvm::BasicBlock* copy_block =
+      llvm::BasicBlock::Create(ctx(), "copy", node_context.llvm_function());
+  llvm::IRBuilder<> copy_builder(copy_block);
+  LlvmMemcpy(output_buffer, array_buffer,
+             type_converter()->GetTypeByteSize(update->GetType()),
+             copy_builder);
+  llvm::BasicBlock* update_block =
+      llvm::BasicBlock::Create(ctx(), "update", node_context.llvm_function());
+  copy_builder.CreateBr(update_block);
+  b.CreateCondBr(b.CreateICmpEQ(output_buffer, array_buffer), update_block,
+                 copy_block);
+  llvm::IRBuilder<> update_builder(update_block);
 
   // Determine whether the indices are all inbounds. If any are out of bounds
   // then the array update operation is a NOP. Also, gather the GEP indices for
@@ -1643,16 +1717,17 @@ absl::Status IrBuilderVisitor::HandleArrayUpdate(ArrayUpdate* update) {
   };
   llvm::Type* i64 = llvm::Type::getInt64Ty(ctx());
   for (int64_t i = 2; i < update->operand_count(); ++i) {
-    llvm::Value* index_value = node_context.LoadOperand(i);
-    is_inbounds = b.CreateAnd(
+    llvm::Value* index_value = node_context.LoadOperand(i, &update_builder);
+    is_inbounds = update_builder.CreateAnd(
         is_inbounds,
-        IsIndexInBounds(index_value, array_type->AsArrayOrDie(), b));
+        IsIndexInBounds(index_value, array_type->AsArrayOrDie(),
+                        update_builder));
     // Cast the index to i64 for use as a gep index. LLVM does not like GEP
     // indices of unusual widths. This is safe because if the cast to i64 ends
     // up truncating the value, the gep is unused because the index is
     // necessarily out of bounds.
     gep_indices.push_back(
-        b.CreateIntCast(index_value, i64, /*isSigned=*/false));
+        update_builder.CreateIntCast(index_value, i64, /*isSigned=*/false));
     array_type = array_type->AsArrayOrDie()->element_type();
   }
 
@@ -1669,14 +1744,14 @@ absl::Status IrBuilderVisitor::HandleArrayUpdate(ArrayUpdate* update) {
   llvm::Value* output_element = inbounds_builder.CreateGEP(
       type_converter()->ConvertToLlvmType(update->GetType()), output_buffer,
       gep_indices);
-  LlvmMemcpy(output_element, node_context.GetOperandPtr(1),
+  LlvmMemcpy(output_element, update_value_buffer,
              type_converter()->GetTypeByteSize(update->operand(1)->GetType()),
              inbounds_builder);
   inbounds_builder.CreateBr(exit_block);
 
-  // From the entry block, branch to the inbounds block if the index is
+  // From the update block, branch to the inbounds block if the index is
   // inbounds. Otherwise branch to the exit block.
-  b.CreateCondBr(is_inbounds, inbounds_block, exit_block);
+  update_builder.CreateCondBr(is_inbounds, inbounds_block, exit_block);
 
   return FinalizeNodeIrContextWithPointerToValue(std::move(node_context),
                                                  output_buffer, &exit_builder);
@@ -1886,29 +1961,39 @@ absl::Status IrBuilderVisitor::HandleCountedFor(CountedFor* counted_for) {
                                         counted_for->invariant_args().size())),
           /*include_wrapper_args=*/true));
   XLS_ASSIGN_OR_RETURN(llvm::Function * body, GetFunction(counted_for->body()));
+  llvm::IRBuilder<>& b = node_context.entry_builder();
 
-  // Create a buffer to hold the loop state and write in the initial value.
+  // Create buffers to pass the index and loop state to the body function and
+  // to receive the next loop state. The buffers are allocated in the entry
+  // block (rather than within the loop) so LLVM can promote them to registers
+  // once the body function is inlined.
   llvm::Type* state_type = type_converter()->ConvertToLlvmType(
       counted_for->initial_value()->GetType());
-  llvm::Value* loop_state_buffer =
-      node_context.entry_builder().CreateAlloca(state_type);
-  node_context.entry_builder().CreateStore(node_context.LoadOperand(0),
-                                           loop_state_buffer);
+  llvm::Type* index_type = type_converter()->ConvertToLlvmType(
+      counted_for->body()->param(0)->GetType());
+  llvm::Value* loop_state_buffer = b.CreateAlloca(state_type);
+  llvm::Value* next_state_buffer = b.CreateAlloca(state_type);
+  llvm::Value* index_buffer = b.CreateAlloca(index_type);
 
   std::vector<llvm::Value*> invariant_arg_buffers;
   for (int64_t i = 1; i < counted_for->operand_count(); ++i) {
     invariant_arg_buffers.push_back(node_context.GetOperandPtr(i));
   }
 
-  LlvmIrLoop loop(counted_for->trip_count(), node_context.entry_builder(),
-                  counted_for->stride());
+  // The loop state is carried across iterations as an SSA value and is only
+  // stored to memory to pass it to the body function.
+  LlvmIrLoop loop(counted_for->trip_count(), b, counted_for->stride(),
+                  /*insert_before=*/nullptr,
+                  {LoopCarriedValue{.name = "loop_state",
+                                    .initial_value =
+                                        node_context.LoadOperand(0)}});
+  llvm::IRBuilder<>& body_builder = loop.body_builder();
 
-  llvm::Type* index_type = type_converter()->ConvertToLlvmType(
-      counted_for->body()->param(0)->GetType());
-  llvm::Value* cast_index = loop.body_builder().CreateIntCast(
+  llvm::Value* cast_index = body_builder.CreateIntCast(
       loop.index(), index_type, /*isSigned=*/false);
-  llvm::Value* index_buffer = loop.body_builder().CreateAlloca(index_type);
-  loop.body_builder().CreateStore(cast_index, index_buffer);
+  body_builder.CreateStore(cast_index, index_buffer);
+  body_builder.CreateStore(loop.GetLoopCarriedValue("loop_state"),
+                           loop_state_buffer);
 
   // Signature of body function is:
   //
@@ -1921,25 +2006,37 @@ absl::Status IrBuilderVisitor::HandleCountedFor(CountedFor* counted_for) {
   input_arg_ptrs.insert(input_arg_ptrs.end(), invariant_arg_buffers.begin(),
                         invariant_arg_buffers.end());
 
-  llvm::Value* next_state_buffer = loop.body_builder().CreateAlloca(state_type);
-  XLS_RETURN_IF_ERROR(CallFunction(body, input_arg_ptrs, {next_state_buffer},
-                                   node_context.GetTempBufferArg(),
-                                   node_context.GetInterpreterEventsArg(),
-                                   node_context.GetInstanceContextArg(),
-                                   node_context.GetJitRuntimeArg(),
-                                   loop.body_builder())
-                          .status());
-  // TODO(meheff): 2022/09/09 Rather than loading the state and storing it in
-  // the state buffer for the next iteration, simply swap the state and
-  // next-state buffer pointers passed to the loop body function.
+  XLS_ASSIGN_OR_RETURN(
+      llvm::Value * body_call,
+      CallFunction(body, input_arg_ptrs, {next_state_buffer},
+                   node_context.GetTempBufferArg(),
+                   node_context.GetInterpreterEventsArg(),
+                   node_context.GetInstanceContextArg(),
+                   node_context.GetJitRuntimeArg(), body_builder));
+  if (jit_context_.inline_loop_bodies()) {
+    // Inline the body function and the partition functions it calls so the
+    // loop body is visible to the LLVM loop optimizations.
+    llvm::cast<llvm::CallInst>(body_call)->addFnAttr(
+        llvm::Attribute::AlwaysInline);
+    for (llvm::BasicBlock& block : *body) {
+      for (llvm::Instruction& instruction : block) {
+        if (auto* call = llvm::dyn_cast<llvm::CallInst>(&instruction);
+            call != nullptr && call->getCalledFunction() != nullptr &&
+            !call->getCalledFunction()->isDeclaration()) {
+          call->addFnAttr(llvm::Attribute::AlwaysInline);
+        }
+      }
+    }
+  }
   llvm::Value* next_state =
-      loop.body_builder().CreateLoad(state_type, next_state_buffer);
-  loop.body_builder().CreateStore(next_state, loop_state_buffer);
+      body_builder.CreateLoad(state_type, next_state_buffer);
 
-  loop.Finalize();
+  loop.Finalize(/*final_body_block_builder=*/std::nullopt,
+                {{"loop_state", next_state}});
 
-  return FinalizeNodeIrContextWithPointerToValue(
-      std::move(node_context), loop_state_buffer, &loop.exit_builder());
+  return FinalizeNodeIrContextWithValue(std::move(node_context),
+                                        loop.GetLoopCarriedValue("loop_state"),
+                                        &loop.exit_builder());
 }
 
 absl::Status IrBuilderVisitor::HandleCover(Cover* cover) {
@@ -2314,12 +2411,11 @@ absl::Status IrBuilderVisitor::HandleSMul(ArithOp* mul) {
 }
 
 absl::Status IrBuilderVisitor::HandleUMul(ArithOp* mul) {
-  return HandleBinaryOpWithOperandConversion(
-      mul,
+  return HandleUnsignedBinaryOp(
+      mul, UnsignedOpKind::kMul,
       [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
         return b.CreateMul(lhs, rhs);
-      },
-      /*is_signed=*/false);
+      });
 }
 
 namespace {
@@ -2951,29 +3047,33 @@ absl::Status IrBuilderVisitor::HandleUMod(BinOp* binop) {
 }
 
 absl::Status IrBuilderVisitor::HandleUGe(CompareOp* ge) {
-  return HandleBinaryOp(
-      ge, [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
+  return HandleUnsignedBinaryOp(
+      ge, UnsignedOpKind::kCompare,
+      [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
         return b.CreateICmpUGE(lhs, rhs);
       });
 }
 
 absl::Status IrBuilderVisitor::HandleUGt(CompareOp* gt) {
-  return HandleBinaryOp(
-      gt, [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
+  return HandleUnsignedBinaryOp(
+      gt, UnsignedOpKind::kCompare,
+      [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
         return b.CreateICmpUGT(lhs, rhs);
       });
 }
 
 absl::Status IrBuilderVisitor::HandleULe(CompareOp* le) {
-  return HandleBinaryOp(
-      le, [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
+  return HandleUnsignedBinaryOp(
+      le, UnsignedOpKind::kCompare,
+      [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
         return b.CreateICmpULE(lhs, rhs);
       });
 }
 
 absl::Status IrBuilderVisitor::HandleULt(CompareOp* lt) {
-  return HandleBinaryOp(
-      lt, [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
+  return HandleUnsignedBinaryOp(
+      lt, UnsignedOpKind::kCompare,
+      [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
         return b.CreateICmpULT(lhs, rhs);
       });
 }
@@ -3105,9 +3205,16 @@ absl::StatusOr<llvm::Value*> IrBuilderVisitor::CallFunction(
     absl::Span<llvm::Value* const> outputs, llvm::Value* temp_buffer,
     llvm::Value* events, llvm::Value* instance_context, llvm::Value* runtime,
     llvm::IRBuilder<>& builder) {
+  // Allocate the argument arrays in the entry block of the calling function.
+  // The call may be inside a loop and allocas outside of the entry block grow
+  // the stack on every iteration and are not promoted to registers by LLVM.
+  llvm::Function* caller = builder.GetInsertBlock()->getParent();
+  llvm::IRBuilder<> alloca_builder(&caller->getEntryBlock(),
+                                   caller->getEntryBlock().begin());
   llvm::Type* input_pointer_array_type =
       llvm::ArrayType::get(llvm::PointerType::get(ctx(), 0), inputs.size());
-  llvm::Value* input_arg_array = builder.CreateAlloca(input_pointer_array_type);
+  llvm::Value* input_arg_array =
+      alloca_builder.CreateAlloca(input_pointer_array_type);
   input_arg_array->setName("input_arg_array");
   for (int64_t i = 0; i < inputs.size(); ++i) {
     llvm::Value* input_buffer = inputs[i];
@@ -3123,7 +3230,7 @@ absl::StatusOr<llvm::Value*> IrBuilderVisitor::CallFunction(
   llvm::Type* output_pointer_array_type =
       llvm::ArrayType::get(llvm::PointerType::get(ctx(), 0), outputs.size());
   llvm::Value* output_arg_array =
-      builder.CreateAlloca(output_pointer_array_type);
+      alloca_builder.CreateAlloca(output_pointer_array_type);
   output_arg_array->setName("output_arg_array");
   for (int64_t i = 0; i < outputs.size(); ++i) {
     llvm::Value* output_buffer = outputs[i];
@@ -3338,6 +3445,68 @@ absl::Status IrBuilderVisitor::HandleSend(Send* send) {
 
 }  // namespace
 
+absl::Status IrBuilderVisitor::HandleUnsignedBinaryOp(
+    Node* node, UnsignedOpKind kind,
+    std::function<llvm::Value*(llvm::Value*, llvm::Value*, llvm::IRBuilder<>&)>
+        build_result) {
+  XLS_RET_CHECK_EQ(node->operand_count(), 2);
+  XLS_ASSIGN_OR_RETURN(const QueryEngine* query_engine,
+                       jit_context_.GetQueryEngine(node->function_base()));
+  std::optional<int64_t> narrowed_bit_count;
+  if (query_engine != nullptr) {
+    // The number of low bits of each operand which may be non-zero.
+    auto significant_bit_count = [&](Node* operand) {
+      Bits max_value = query_engine->MaxUnsignedValue(operand);
+      return max_value.bit_count() - max_value.CountLeadingZeros();
+    };
+    int64_t lhs_bit_count = significant_bit_count(node->operand(0));
+    int64_t rhs_bit_count = significant_bit_count(node->operand(1));
+    // The number of bits needed to hold the exact result and the width of
+    // the operation as lowered without narrowing.
+    int64_t required_bit_count;
+    int64_t natural_bit_count;
+    switch (kind) {
+      case UnsignedOpKind::kAdd:
+        required_bit_count = std::max(lhs_bit_count, rhs_bit_count) + 1;
+        natural_bit_count = node->BitCountOrDie();
+        break;
+      case UnsignedOpKind::kMul:
+        required_bit_count = lhs_bit_count + rhs_bit_count;
+        natural_bit_count = node->BitCountOrDie();
+        break;
+      case UnsignedOpKind::kCompare:
+        required_bit_count = std::max(lhs_bit_count, rhs_bit_count);
+        natural_bit_count = node->operand(0)->BitCountOrDie();
+        break;
+    }
+    int64_t llvm_bit_count =
+        type_converter()->GetLlvmBitCount(required_bit_count);
+    if (llvm_bit_count < type_converter()->GetLlvmBitCount(natural_bit_count)) {
+      narrowed_bit_count = llvm_bit_count;
+    }
+  }
+  if (!narrowed_bit_count.has_value()) {
+    if (kind == UnsignedOpKind::kMul) {
+      return HandleBinaryOpWithOperandConversion(node, build_result,
+                                                 /*is_signed=*/false);
+    }
+    return HandleBinaryOp(node, build_result);
+  }
+
+  XLS_ASSIGN_OR_RETURN(NodeIrContext node_context,
+                       NewNodeIrContext(node, {"lhs", "rhs"}));
+  llvm::IRBuilder<>& b = node_context.entry_builder();
+  llvm::Type* narrowed_type = b.getIntNTy(*narrowed_bit_count);
+  llvm::Value* result = build_result(
+      b.CreateZExtOrTrunc(node_context.LoadOperand(0), narrowed_type),
+      b.CreateZExtOrTrunc(node_context.LoadOperand(1), narrowed_type), b);
+  if (kind != UnsignedOpKind::kCompare) {
+    result = b.CreateZExt(result,
+                          type_converter()->ConvertToLlvmType(node->GetType()));
+  }
+  return FinalizeNodeIrContextWithValue(std::move(node_context), result);
+}
+
 llvm::Value* LlvmMemcpy(llvm::Value* tgt, llvm::Value* src, int64_t size,
                         llvm::IRBuilder<>& builder) {
   CHECK(tgt->getType()->isPointerTy());
@@ -32,6 +32,7 @@
 #include "xls/ir/node.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/llvm_type_converter.h"
+#include "xls/passes/query_engine.h"
 
 namespace xls {
 
@@ -44,12 +45,27 @@ bool ShouldMaterializeAtUse(Node* node);
 // etc.
 class JitBuilderContext {
  public:
-  explicit JitBuilderContext(LlvmCompiler& llvm_compiler, FunctionBase* top)
+  // If `inline_loop_bodies` is true then the functions implementing the bodies
+  // of counted_for loops are always inlined into the loop so LLVM can keep the
+  // loop state in registers, vectorize and unroll the loop. This may increase
+  // compile time for large loop bodies.
+  //
+  // If `narrow_with_known_bits` is true then unsigned additions,
+  // multiplications and comparisons are lowered at a narrower width when
+  // ternary and range analysis shows that the high bits of their operands are
+  // zero (e.g., a 128-bit add of values which fit in 32 bits is performed as a
+  // 64-bit add). The analysis adds compile time proportional to the size of
+  // the function.
+  explicit JitBuilderContext(LlvmCompiler& llvm_compiler, FunctionBase* top,
+                             bool inline_loop_bodies = false,
+                             bool narrow_with_known_bits = false)
       : module_(llvm_compiler.NewModule("__module")),
         llvm_compiler_(llvm_compiler),
         top_(top),
         type_converter_(llvm_compiler_.GetContext(),
-                        llvm_compiler_.CreateDataLayout().value()) {
+                        llvm_compiler_.CreateDataLayout().value()),
+        inline_loop_bodies_(inline_loop_bodies),
+        narrow_with_known_bits_(narrow_with_known_bits) {
     CHECK_EQ(module_->getTargetTriple(), llvm_compiler_.target_triple());
   }
 
@@ -58,6 +74,13 @@ class JitBuilderContext {
   LlvmCompiler& llvm_compiler() { return llvm_compiler_; }
   LlvmTypeConverter& type_converter() { return type_converter_; }
   FunctionBase* top() const { return top_; }
+  bool inline_loop_bodies() const { return inline_loop_bodies_; }
+  bool narrow_with_known_bits() const { return narrow_with_known_bits_; }
+
+  // Returns a query engine holding known-bits information about the nodes of
+  // `f`, populating it on first use. Returns nullptr if
+  // `narrow_with_known_bits` is false.
+  absl::StatusOr<const QueryEngine*> GetQueryEngine(FunctionBase* f);
 
   // Destructively returns the underlying llvm::Module.
   std::unique_ptr<llvm::Module> ConsumeModule() { return std::move(module_); }
@@ -104,6 +127,12 @@ class JitBuilderContext {
   LlvmCompiler& llvm_compiler_;
   FunctionBase* top_;
   LlvmTypeConverter type_converter_;
+  bool inline_loop_bodies_;
+  bool narrow_with_known_bits_;
+
+  // Query engines used for known-bits narrowing, keyed by function.
+  absl::flat_hash_map<FunctionBase*, std::unique_ptr<QueryEngine>>
+      query_engines_;
 
   // Map from FunctionBase to the associated JITed llvm::Function.
   absl::flat_hash_map<FunctionBase*, llvm::Function*> llvm_functions_;
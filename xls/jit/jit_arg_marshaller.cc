@@ -0,0 +1,59 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_arg_marshaller.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/ir/function.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+
+/* static */ JitArgMarshaller JitArgMarshaller::Create(Function* function,
+                                                       JitRuntime& runtime) {
+  std::vector<TypeLayout> arg_layouts;
+  arg_layouts.reserve(function->params().size());
+  for (Param* param : function->params()) {
+    arg_layouts.push_back(runtime.CreateTypeLayout(param->GetType()));
+  }
+  return JitArgMarshaller(
+      std::move(arg_layouts),
+      runtime.CreateTypeLayout(function->return_value()->GetType()));
+}
+
+absl::Status JitArgMarshaller::MarshalArgs(
+    absl::Span<const Value> args,
+    absl::Span<uint8_t* const> arg_buffers) const {
+  if (args.size() != arg_layouts_.size() ||
+      arg_buffers.size() < arg_layouts_.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Expected %d arguments and buffers, got %d arguments and %d buffers",
+        arg_layouts_.size(), args.size(), arg_buffers.size()));
+  }
+  for (int64_t i = 0; i < arg_layouts_.size(); ++i) {
+    arg_layouts_[i].ValueToNativeLayout(args[i], arg_buffers[i]);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls
@@ -0,0 +1,75 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_ARG_MARSHALLER_H_
+#define XLS_JIT_JIT_ARG_MARSHALLER_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "xls/ir/function.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+
+// Converts the arguments and result of a function with a fixed signature
+// between Values and the native layout used by the JIT. The layout of each
+// parameter and of the result is computed once on construction so each
+// conversion is a flat walk over the leaves of the value which copies the data
+// directly into (or out of) caller-provided buffers. Unlike
+// JitRuntime::PackArgs/UnpackBuffer no locks are taken and no LLVM types are
+// consulted.
+//
+// Thread-compatible: const methods may be called concurrently.
+class JitArgMarshaller {
+ public:
+  JitArgMarshaller(std::vector<TypeLayout> arg_layouts,
+                   TypeLayout result_layout)
+      : arg_layouts_(std::move(arg_layouts)),
+        result_layout_(std::move(result_layout)) {}
+
+  // Returns a marshaller for the parameters and return value of `function`
+  // using the native layout of `runtime`.
+  static JitArgMarshaller Create(Function* function, JitRuntime& runtime);
+
+  // Writes `args` in the native layout to `arg_buffers`. `arg_buffers[i]` must
+  // be suitably aligned for the i-th parameter and have room for at least
+  // `arg_layout(i).size()` bytes. Returns an error if the number of arguments
+  // does not match the signature. Argument types are only checked in debug
+  // builds.
+  absl::Status MarshalArgs(absl::Span<const Value> args,
+                           absl::Span<uint8_t* const> arg_buffers) const;
+
+  // Returns the result stored in the native layout in `buffer`.
+  Value UnmarshalResult(const uint8_t* buffer) const {
+    return result_layout_.NativeLayoutToValue(buffer);
+  }
+
+  int64_t arg_count() const { return arg_layouts_.size(); }
+  const TypeLayout& arg_layout(int64_t i) const { return arg_layouts_[i]; }
+  const TypeLayout& result_layout() const { return result_layout_; }
+
+ private:
+  std::vector<TypeLayout> arg_layouts_;
+  TypeLayout result_layout_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_ARG_MARSHALLER_H_
@@ -0,0 +1,110 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_arg_marshaller.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "llvm/include/llvm/IR/DataLayout.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+
+class JitArgMarshallerTest : public IrTestBase {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
+    XLS_ASSERT_OK_AND_ASSIGN(llvm::DataLayout data_layout,
+                             orc_jit->CreateDataLayout());
+    runtime_ = std::make_unique<JitRuntime>(data_layout);
+  }
+
+  std::unique_ptr<JitRuntime> runtime_;
+};
+
+// Checks that marshalling writes the same bytes as JitRuntime::PackArgs and
+// that unmarshalling recovers the value.
+TEST_F(JitArgMarshallerTest, MatchesJitRuntime) {
+  constexpr std::string_view kTypes[] = {
+      "()",
+      "bits[1]",
+      "bits[42]",
+      "bits[1024]",
+      "bits[37][3]",
+      "(bits[2], (bits[15], bits[4]))",
+      "(bits[1], (bits[32], bits[64], bits[1][32])[5], bits[100])",
+      "(bits[3], (), bits[5], bits[7])[3][10]",
+  };
+  std::minstd_rand bitgen;
+  for (std::string_view type_str : kTypes) {
+    auto p = CreatePackage();
+    XLS_ASSERT_OK_AND_ASSIGN(Type * type, Parser::ParseType(type_str, p.get()));
+    FunctionBuilder fb(TestName(), p.get());
+    fb.Identity(fb.Param("x", type));
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+    JitArgMarshaller marshaller = JitArgMarshaller::Create(f, *runtime_);
+    ASSERT_EQ(marshaller.arg_count(), 1);
+    int64_t size = runtime_->GetTypeByteSize(type);
+    EXPECT_EQ(marshaller.arg_layout(0).size(), size);
+    EXPECT_EQ(marshaller.result_layout().size(), size);
+
+    for (int64_t i = 0; i < 8; ++i) {
+      Value value = RandomValue(type, bitgen);
+      std::vector<uint8_t> expected(size);
+      std::vector<uint8_t> actual(size);
+      std::vector<uint8_t*> expected_buffers = {expected.data()};
+      std::vector<uint8_t*> actual_buffers = {actual.data()};
+      XLS_ASSERT_OK(runtime_->PackArgs({value}, {type}, expected_buffers));
+      XLS_ASSERT_OK(marshaller.MarshalArgs({value}, actual_buffers));
+      EXPECT_EQ(actual, expected) << type_str << ": " << value;
+      EXPECT_EQ(marshaller.UnmarshalResult(actual.data()), value);
+    }
+  }
+}
+
+TEST_F(JitArgMarshallerTest, WrongArgumentCount) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Add(fb.Param("x", p->GetBitsType(32)), fb.Param("y", p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  JitArgMarshaller marshaller = JitArgMarshaller::Create(f, *runtime_);
+  std::vector<uint8_t> buffer(4);
+  std::vector<uint8_t*> buffers = {buffer.data(), buffer.data()};
+  EXPECT_THAT(marshaller.MarshalArgs({Value(UBits(1, 32))}, buffers),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,8 +14,13 @@
 
 #include "xls/jit/jit_callbacks.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/strings/str_cat.h"
@@ -31,46 +36,88 @@ namespace xls {
 
 namespace {
 void PerformStringStep(InstanceContext* thiz, char* step_string,
-                       std::string* buffer) {
-  buffer->append(step_string);
+                       JitTraceBuffer* buffer) {
+  buffer->message.append(step_string);
 }
 
 void PerformFormatStep(InstanceContext* thiz, JitRuntime* runtime,
                        const uint8_t* proto_data, int64_t proto_data_size,
                        const uint8_t* value, uint64_t format_u64,
-                       std::string* buffer) {
+                       JitTraceBuffer* buffer) {
   Type* type = thiz->ParseTypeFromProto(
       absl::Span<uint8_t const>(proto_data, proto_data_size));
+  int64_t size = runtime->GetTypeByteSize(type);
 #ifdef ABSL_HAVE_MEMORY_SANITIZER
-  __msan_unpoison(value, runtime->GetTypeByteSize(type));
+  __msan_unpoison(value, size);
 #endif
   FormatPreference format = static_cast<FormatPreference>(format_u64);
+  if (buffer->deferred) {
+    buffer->runtime = runtime;
+    buffer->arguments.push_back(JitTraceBuffer::Argument{
+        .offset = buffer->message.size(),
+        .type = type,
+        .format = format,
+        .bytes = std::vector<uint8_t>(value, value + size)});
+    return;
+  }
   Value ir_value = runtime->UnpackBuffer(value, type);
-  absl::StrAppend(buffer, ir_value.ToHumanString(format));
+  absl::StrAppend(&buffer->message, ir_value.ToHumanString(format));
 }
 
-void RecordTrace(InstanceContext* thiz, std::string* buffer, int64_t verbosity,
-                 InterpreterEvents* events) {
-  events->trace_msgs.push_back(
-      TraceMessage{.message = *buffer, .verbosity = verbosity});
-  delete buffer;
+// Returns the message of a trace whose arguments were deferred.
+std::string FormatDeferredTrace(const JitTraceBuffer& buffer) {
+  std::string_view fragments = buffer.message;
+  std::string message;
+  size_t offset = 0;
+  for (const JitTraceBuffer::Argument& argument : buffer.arguments) {
+    Value value =
+        buffer.runtime->UnpackBuffer(argument.bytes.data(), argument.type);
+    absl::StrAppend(&message,
+                    fragments.substr(offset, argument.offset - offset),
+                    value.ToHumanString(argument.format));
+    offset = argument.offset;
+  }
+  absl::StrAppend(&message, fragments.substr(offset));
+  return message;
 }
-std::string* CreateTraceBuffer(InstanceContext* thiz) {
-  return new std::string();
+
+void RecordTrace(InstanceContext* thiz, JitTraceBuffer* buffer,
+                 int64_t verbosity, InterpreterEvents* events) {
+  std::unique_ptr<JitTraceBuffer> owned_buffer(buffer);
+  if (owned_buffer->arguments.empty()) {
+    events->AddTrace(TraceEvent(std::move(owned_buffer->message), verbosity));
+    return;
+  }
+  owned_buffer->type_manager = thiz->type_manager;
+  std::shared_ptr<const JitTraceBuffer> deferred = std::move(owned_buffer);
+  events->AddTrace(TraceEvent(
+      [deferred]() { return FormatDeferredTrace(*deferred); }, verbosity));
+}
+JitTraceBuffer* CreateTraceBuffer(InstanceContext* thiz) {
+  JitTraceBuffer* buffer = new JitTraceBuffer();
+  buffer->deferred = thiz->defer_trace_formatting;
+  return buffer;
 }
 void RecordAssertion(InstanceContext* thiz, const char* msg,
                      InterpreterEvents* events) {
-  events->assert_msgs.push_back(msg);
+  events->AddAssert(msg);
 }
 
 bool QueueReceiveWrapper(InstanceContext* thiz, int64_t queue_index,
                          uint8_t* buffer) {
-  return thiz->channel_queues[queue_index]->ReadRaw(buffer);
+  bool received = thiz->channel_queues[queue_index]->ReadRaw(buffer);
+  if (thiz->count_channel_operations && received) {
+    ++thiz->receive_counts[queue_index];
+  }
+  return received;
 }
 
 void QueueSendWrapper(InstanceContext* thiz, int64_t queue_index,
                       const uint8_t* data) {
   thiz->channel_queues[queue_index]->WriteRaw(data);
+  if (thiz->count_channel_operations) {
+    ++thiz->send_counts[queue_index];
+  }
 }
 
 void RecordActiveNextValue(InstanceContext* thiz, int64_t param_id,
@@ -90,10 +137,15 @@ InstanceContextVTable::InstanceContextVTable()
       record_active_next_value(&RecordActiveNextValue) {}
 
 Type* InstanceContext::ParseTypeFromProto(absl::Span<uint8_t const> data) {
+  auto [it, inserted] = parsed_types.try_emplace(data.data(), nullptr);
+  if (!inserted) {
+    return it->second;
+  }
   TypeProto proto;
   CHECK(proto.ParseFromArray(data.data(), data.size()));
   auto type_or = type_manager->GetTypeFromProto(proto);
   CHECK_OK(type_or);
+  it->second = *type_or;
   return *type_or;
 }
 }  // namespace xls
@@ -27,6 +27,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/types/span.h"
 #include "xls/ir/events.h"
+#include "xls/ir/format_preference.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/type.h"
 #include "xls/ir/type_manager.h"
@@ -36,6 +37,29 @@
 namespace xls {
 
 struct InstanceContext;
+
+// Accumulates the fragments of a trace message as the JIT code performs the
+// steps of a trace operation.
+struct JitTraceBuffer {
+  // The string fragments of the message, and the formatted arguments unless
+  // formatting is deferred.
+  std::string message;
+
+  // If set, arguments are copied as raw bytes and only formatted when the
+  // trace event is consumed. Each argument is to be inserted in `message` at
+  // `offset`.
+  bool deferred = false;
+  struct Argument {
+    size_t offset;
+    Type* type;
+    FormatPreference format;
+    std::vector<uint8_t> bytes;
+  };
+  std::vector<Argument> arguments;
+  JitRuntime* runtime = nullptr;
+  // Keeps the argument types alive.
+  std::shared_ptr<TypeManager> type_manager;
+};
 // Manual vtable of an InstanceContext. Called directly from LLVM jit code.
 //
 // TODO(allight): Instead of using this Vtable passed as an argument we could
@@ -48,23 +72,24 @@ struct InstanceContextVTable {
   explicit InstanceContextVTable();
 
   using PerformStringStepFn = void (*)(InstanceContext* thiz, char* step_string,
-                                       std::string* buffer);
+                                       JitTraceBuffer* buffer);
   // This is a shim to let JIT code add a new trace fragment to an existing
   // trace buffer.
   const PerformStringStepFn perform_string_step;
   using PerformFormatStepFn =
       void (*)(InstanceContext* thiz, JitRuntime* runtime,
                const uint8_t* type_proto_data, int64_t type_proto_data_size,
-               const uint8_t* value, uint64_t format_u64, std::string* buffer);
+               const uint8_t* value, uint64_t format_u64,
+               JitTraceBuffer* buffer);
   const PerformFormatStepFn perform_format_step;
 
-  using RecordTraceFn = void (*)(InstanceContext* thiz, std::string* buffer,
+  using RecordTraceFn = void (*)(InstanceContext* thiz, JitTraceBuffer* buffer,
                                  int64_t verbosity, InterpreterEvents* events);
   // This a shim to let JIT code record a completed trace as an interpreter
   // event.
   const RecordTraceFn record_trace;
 
-  using CreateTraceBufferFn = std::string* (*)(InstanceContext* thiz);
+  using CreateTraceBufferFn = JitTraceBuffer* (*)(InstanceContext* thiz);
   // This is a shim to let JIT code create a buffer for accumulating trace
   // fragments.
   const CreateTraceBufferFn create_trace_buffer;
@@ -147,8 +172,25 @@ struct InstanceContext {
   // into the JITted code for sends and receives.
   std::vector<JitChannelQueue*> channel_queues;
 
-  // Arena used to materialize types that are passed to callbacks.
-  std::unique_ptr<TypeManager> type_manager = std::make_unique<TypeManager>();
+  // Whether the sends and successful receives on each queue are counted in
+  // `send_counts` and `receive_counts`, which are indexed like
+  // `channel_queues`.
+  bool count_channel_operations = false;
+  std::vector<int64_t> send_counts;
+  std::vector<int64_t> receive_counts;
+
+  // Whether the arguments of traces are formatted only when the trace event is
+  // consumed. Deferred events refer to the JitRuntime, so they must be
+  // consumed before it is destroyed.
+  bool defer_trace_formatting = false;
+
+  // Arena used to materialize types that are passed to callbacks. Shared with
+  // deferred trace events which refer to the types.
+  std::shared_ptr<TypeManager> type_manager = std::make_shared<TypeManager>();
+
+  // Types already parsed by ParseTypeFromProto, keyed by the address of the
+  // serialized proto which is a constant in the JIT code.
+  absl::flat_hash_map<const uint8_t*, Type*> parsed_types;
 };
 
 static_assert(offsetof(InstanceContext, vtable) == 0);
@@ -22,6 +22,8 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/memory/memory.h"
@@ -30,6 +32,10 @@
 #include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/value.h"
@@ -55,6 +61,47 @@ std::optional<Value> ReadValueFromQueue(Type* type, JitRuntime& runtime,
   return runtime.UnpackBuffer(buffer.data(), type);
 }
 
+// Returns the streaming channel instances which are sent on by exactly one proc
+// instance and received on by exactly one proc instance. Queues for these
+// channels are only accessed by one writer and one reader thread at a time.
+absl::StatusOr<absl::flat_hash_set<ChannelInstance*>>
+GetSingleProducerSingleConsumerChannels(const ProcElaboration& elaboration) {
+  absl::flat_hash_map<ChannelInstance*, absl::flat_hash_set<ProcInstance*>>
+      senders;
+  absl::flat_hash_map<ChannelInstance*, absl::flat_hash_set<ProcInstance*>>
+      receivers;
+  for (ProcInstance* proc_instance : elaboration.proc_instances()) {
+    for (Node* node : proc_instance->proc()->nodes()) {
+      if (node->Is<Send>()) {
+        XLS_ASSIGN_OR_RETURN(ChannelInstance * channel_instance,
+                             proc_instance->GetChannelInstance(
+                                 node->As<Send>()->channel_name()));
+        senders[channel_instance].insert(proc_instance);
+      } else if (node->Is<Receive>()) {
+        XLS_ASSIGN_OR_RETURN(ChannelInstance * channel_instance,
+                             proc_instance->GetChannelInstance(
+                                 node->As<Receive>()->channel_name()));
+        receivers[channel_instance].insert(proc_instance);
+      }
+    }
+  }
+  absl::flat_hash_set<ChannelInstance*> result;
+  for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
+    if (channel_instance->channel->kind() != ChannelKind::kStreaming ||
+        channel_instance->channel->supported_ops() !=
+            ChannelOps::kSendReceive) {
+      continue;
+    }
+    auto sender_it = senders.find(channel_instance);
+    auto receiver_it = receivers.find(channel_instance);
+    if (sender_it != senders.end() && sender_it->second.size() == 1 &&
+        receiver_it != receivers.end() && receiver_it->second.size() == 1) {
+      result.insert(channel_instance);
+    }
+  }
+  return result;
+}
+
 }  // namespace
 
 ByteQueue::ByteQueue(int64_t channel_element_size, bool is_single_value)
@@ -105,6 +152,18 @@ int64_t ThreadSafeJitChannelQueue::GetSizeInternal() const {
   return byte_queue_.size();
 }
 
+void JitChannelQueue::RecordRawReadActivity(bool read,
+                                            const uint8_t* buffer) {
+  if (!read) {
+    activity_->RecordEmptyRead();
+    return;
+  }
+  if (std::optional<int64_t> slot = activity_->RecordRead(); slot.has_value()) {
+    activity_->SampleValue(*slot,
+                           jit_runtime_->UnpackBuffer(buffer, channel()->type()));
+  }
+}
+
 void ThreadSafeJitChannelQueue::WriteInternal(const Value& value) {
   WriteValueOnQueue(value, channel()->type(), *jit_runtime_, byte_queue_);
 }
@@ -113,6 +172,45 @@ std::optional<Value> ThreadSafeJitChannelQueue::ReadInternal() {
   return ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
 }
 
+SpscJitChannelQueue::SpscJitChannelQueue(ChannelInstance* channel_instance,
+                                         JitRuntime* jit_runtime,
+                                         int64_t capacity)
+    : JitChannelQueue(channel_instance, jit_runtime),
+      element_size_(
+          jit_runtime->GetTypeByteSize(channel_instance->channel->type())),
+      // Empty tuples still need a distinct slot per element.
+      slot_size_(std::max<int64_t>(
+          1, RoundUpToNearest(element_size_,
+                              static_cast<int64_t>(alignof(std::max_align_t))))),
+      capacity_(int64_t{1} << CeilOfLog2(std::max<int64_t>(capacity, 1))),
+      buffer_(new uint8_t[capacity_ * slot_size_]),
+      overflow_(element_size_, /*is_single_value=*/false) {
+  CHECK_EQ(channel_instance->channel->kind(), ChannelKind::kStreaming)
+      << "SpscJitChannelQueue only supports streaming channels";
+}
+
+int64_t SpscJitChannelQueue::GetSizeInternal() const {
+  return write_count_.load(std::memory_order_acquire) -
+         read_count_.load(std::memory_order_acquire) +
+         overflow_size_.load(std::memory_order_acquire);
+}
+
+void SpscJitChannelQueue::WriteInternal(const Value& value) {
+  absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
+      element_size_);
+  jit_runtime_->BlitValueToBuffer(value, channel()->type(),
+                                  absl::MakeSpan(buffer));
+  WriteToQueue(buffer.data());
+}
+
+std::optional<Value> SpscJitChannelQueue::ReadInternal() {
+  std::vector<uint8_t> buffer(element_size_);
+  if (!ReadFromQueue(buffer.data())) {
+    return std::nullopt;
+  }
+  return jit_runtime_->UnpackBuffer(buffer.data(), channel()->type());
+}
+
 int64_t ThreadUnsafeJitChannelQueue::GetSizeInternal() const {
   return byte_queue_.size();
 }
@@ -136,10 +234,18 @@ JitChannelQueueManager::CreateThreadSafe(Package* package,
 /* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
 JitChannelQueueManager::CreateThreadSafe(ProcElaboration&& elaboration,
                                          std::unique_ptr<JitRuntime> runtime) {
+  XLS_ASSIGN_OR_RETURN(
+      absl::flat_hash_set<ChannelInstance*> spsc_channels,
+      GetSingleProducerSingleConsumerChannels(elaboration));
   std::vector<std::unique_ptr<ChannelQueue>> queues;
   for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
-    queues.push_back(std::make_unique<ThreadSafeJitChannelQueue>(
-        channel_instance, runtime.get()));
+    if (spsc_channels.contains(channel_instance)) {
+      queues.push_back(std::make_unique<SpscJitChannelQueue>(channel_instance,
+                                                             runtime.get()));
+    } else {
+      queues.push_back(std::make_unique<ThreadSafeJitChannelQueue>(
+          channel_instance, runtime.get()));
+    }
   }
   return absl::WrapUnique(new JitChannelQueueManager(
       std::move(elaboration), std::move(queues), std::move(runtime)));
@@ -14,6 +14,7 @@
 #ifndef XLS_JIT_JIT_CHANNEL_QUEUE_H_
 #define XLS_JIT_JIT_CHANNEL_QUEUE_H_
 
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -21,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/optimization.h"
 #include "absl/base/thread_annotations.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/status/statusor.h"
@@ -125,7 +127,23 @@ class JitChannelQueue : public ChannelQueue {
   virtual bool ReadRaw(uint8_t* buffer) = 0;
 
  protected:
+  // Update the activity counters, if enabled, for a raw write and for a raw
+  // read which returned `read` with the value in `buffer`.
+  void RecordRawWrite() {
+    if (activity_ != nullptr) {
+      activity_->RecordWrite();
+    }
+  }
+  void RecordRawRead(bool read, const uint8_t* buffer) {
+    if (activity_ != nullptr) {
+      RecordRawReadActivity(read, buffer);
+    }
+  }
+
   JitRuntime* jit_runtime_;
+
+ private:
+  void RecordRawReadActivity(bool read, const uint8_t* buffer);
 };
 
 // A thread-safe version of the JIT channel queue. All accesses are guarded by a
@@ -144,6 +162,7 @@ class ThreadSafeJitChannelQueue : public JitChannelQueue {
   void WriteRaw(const uint8_t* data) override {
     absl::MutexLock lock(&mutex_);
     byte_queue_.Write(data);
+    RecordRawWrite();
   }
 
   // Reads raw bytes representing a value in LLVM's native format. Returns
@@ -154,9 +173,12 @@ class ThreadSafeJitChannelQueue : public JitChannelQueue {
       std::optional<Value> generated_value = (*generator_)();
       if (generated_value.has_value()) {
         WriteInternal(generated_value.value());
+        RecordRawWrite();
       }
     }
-    return byte_queue_.Read(buffer);
+    bool read = byte_queue_.Read(buffer);
+    RecordRawRead(read, buffer);
+    return read;
   }
 
  protected:
@@ -180,15 +202,21 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
             channel_instance->channel->kind() == ChannelKind::kSingleValue) {}
   ~ThreadUnsafeJitChannelQueue() override = default;
 
-  void WriteRaw(const uint8_t* data) override { byte_queue_.Write(data); }
+  void WriteRaw(const uint8_t* data) override {
+    byte_queue_.Write(data);
+    RecordRawWrite();
+  }
   bool ReadRaw(uint8_t* buffer) override {
     if (generator_.has_value()) {
       std::optional<Value> generated_value = (*generator_)();
       if (generated_value.has_value()) {
         WriteInternal(generated_value.value());
+        RecordRawWrite();
       }
     }
-    return byte_queue_.Read(buffer);
+    bool read = byte_queue_.Read(buffer);
+    RecordRawRead(read, buffer);
+    return read;
   }
 
  protected:
@@ -199,13 +227,130 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
   ByteQueue byte_queue_;
 };
 
+// A lock-free version of the JIT channel queue for streaming channels with
+// exactly one sending thread and one receiving thread (e.g., a channel between
+// two proc instances). Values are held in a fixed-capacity ring buffer indexed
+// by atomic read and write counters which live on separate cache lines. If the
+// ring buffer is full, values spill into a mutex-guarded overflow queue until
+// the receiver drains it so writes never fail or block.
+//
+// WriteRaw may only be called from one thread at a time and ReadRaw may only be
+// called from one (possibly different) thread at a time.
+class SpscJitChannelQueue : public JitChannelQueue {
+ public:
+  static constexpr int64_t kDefaultCapacity = 64;
+
+  // `capacity` is the number of elements held in the ring buffer and is
+  // rounded up to a power of two.
+  SpscJitChannelQueue(ChannelInstance* channel_instance,
+                      JitRuntime* jit_runtime,
+                      int64_t capacity = kDefaultCapacity);
+  ~SpscJitChannelQueue() override = default;
+
+  void WriteRaw(const uint8_t* data) override {
+    WriteToQueue(data);
+    RecordRawWrite();
+  }
+
+  bool ReadRaw(uint8_t* buffer) override {
+    if (generator_.has_value()) {
+      std::optional<Value> generated_value = (*generator_)();
+      if (generated_value.has_value()) {
+        WriteInternal(generated_value.value());
+        RecordRawWrite();
+      }
+    }
+    bool read = ReadFromQueue(buffer);
+    RecordRawRead(read, buffer);
+    return read;
+  }
+
+  int64_t capacity() const { return capacity_; }
+
+ protected:
+  int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  void WriteInternal(const Value& value) override;
+  std::optional<Value> ReadInternal() override;
+
+ private:
+  uint8_t* Slot(int64_t count) {
+    return buffer_.get() + (count & (capacity_ - 1)) * slot_size_;
+  }
+
+  void WriteToQueue(const uint8_t* data) {
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+    __msan_unpoison(data, element_size_);
+#endif
+    if (overflow_size_.load(std::memory_order_acquire) == 0) {
+      int64_t write_count = write_count_.load(std::memory_order_relaxed);
+      if (write_count - cached_read_count_ == capacity_) {
+        cached_read_count_ = read_count_.load(std::memory_order_acquire);
+      }
+      if (write_count - cached_read_count_ < capacity_) {
+        memcpy(Slot(write_count), data, element_size_);
+        write_count_.store(write_count + 1, std::memory_order_release);
+        return;
+      }
+    }
+    // The ring is full or values have already spilled. Values must go to the
+    // overflow queue until it is drained to preserve FIFO order.
+    absl::MutexLock lock(&overflow_mutex_);
+    overflow_.Write(data);
+    overflow_size_.fetch_add(1, std::memory_order_release);
+  }
+
+  bool ReadFromQueue(uint8_t* buffer) {
+    int64_t read_count = read_count_.load(std::memory_order_relaxed);
+    if (read_count == cached_write_count_) {
+      cached_write_count_ = write_count_.load(std::memory_order_acquire);
+    }
+    if (read_count != cached_write_count_) {
+      memcpy(buffer, Slot(read_count), element_size_);
+      read_count_.store(read_count + 1, std::memory_order_release);
+      return true;
+    }
+    // Values only spill once the ring is full so anything in the overflow
+    // queue is newer than everything in the (now empty) ring.
+    if (overflow_size_.load(std::memory_order_acquire) == 0) {
+      return false;
+    }
+    absl::MutexLock lock(&overflow_mutex_);
+    if (!overflow_.Read(buffer)) {
+      return false;
+    }
+    overflow_size_.fetch_sub(1, std::memory_order_release);
+    return true;
+  }
+
+  int64_t element_size_;
+  int64_t slot_size_;
+  int64_t capacity_;
+  std::unique_ptr<uint8_t[]> buffer_;
+
+  // Written by the sender only. `cached_read_count_` is the sender's possibly
+  // stale copy of `read_count_`.
+  alignas(ABSL_CACHELINE_SIZE) std::atomic<int64_t> write_count_ = 0;
+  int64_t cached_read_count_ = 0;
+
+  // Written by the receiver only. `cached_write_count_` is the receiver's
+  // possibly stale copy of `write_count_`.
+  alignas(ABSL_CACHELINE_SIZE) std::atomic<int64_t> read_count_ = 0;
+  int64_t cached_write_count_ = 0;
+
+  alignas(ABSL_CACHELINE_SIZE) std::atomic<int64_t> overflow_size_ = 0;
+  absl::Mutex overflow_mutex_;
+  ByteQueue overflow_ ABSL_GUARDED_BY(overflow_mutex_);
+};
+
 // A Channel manager which holds exclusively JitChannelQueues.
 class JitChannelQueueManager : public ChannelQueueManager {
  public:
   ~JitChannelQueueManager() override = default;
 
   // Factories which create a queue manager with exclusively ThreadSafe/Unsafe
-  // queues.
+  // queues. The thread-safe factories use a SpscJitChannelQueue for streaming
+  // channel instances which have exactly one sending and one receiving proc
+  // instance in the elaboration.
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
   CreateThreadSafe(Package* package, std::unique_ptr<JitRuntime> runtime);
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
@@ -24,10 +24,12 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/channel_queue_test_base.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/value.h"
@@ -67,7 +69,8 @@ template <typename QueueT>
 class JitChannelQueueTest : public ::testing::Test {};
 
 using QueueTypes =
-    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue>;
+    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue,
+                     SpscJitChannelQueue>;
 TYPED_TEST_SUITE(JitChannelQueueTest, QueueTypes);
 
 // An empty tuple represents a zero width.
@@ -145,6 +148,36 @@ TYPED_TEST(JitChannelQueueTest, BasicAccess) {
   EXPECT_TRUE(queue.IsEmpty());
 }
 
+// Writes enough elements to force the queue to grow (or spill into overflow
+// storage) before reading any back.
+TYPED_TEST(JitChannelQueueTest, ManyElements) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  TypeParam queue(elaboration.GetUniqueInstance(channel).value(),
+                  GetJitRuntime());
+
+  constexpr int64_t kCount = 1000;
+  for (int64_t round = 0; round < 3; ++round) {
+    for (uint32_t i = 0; i < kCount; ++i) {
+      queue.WriteRaw(reinterpret_cast<const uint8_t*>(&i));
+    }
+    EXPECT_EQ(queue.GetSize(), kCount);
+    // Interleave a few writes with reads to exercise wrap around.
+    for (uint32_t i = 0; i < kCount; ++i) {
+      uint32_t result;
+      EXPECT_TRUE(queue.ReadRaw(reinterpret_cast<uint8_t*>(&result)));
+      EXPECT_EQ(result, i);
+    }
+    EXPECT_TRUE(queue.IsEmpty());
+  }
+}
+
 TYPED_TEST(JitChannelQueueTest, IotaGeneratorWithRawApi) {
   Package package("test");
   XLS_ASSERT_OK_AND_ASSIGN(
@@ -180,5 +213,78 @@ TYPED_TEST(JitChannelQueueTest, IotaGeneratorWithRawApi) {
                                  "a generator function")));
 }
 
+TEST(SpscJitChannelQueueTest, ConcurrentProducerConsumer) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(64)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+  SpscJitChannelQueue queue(elaboration.GetUniqueInstance(channel).value(),
+                            GetJitRuntime(), /*capacity=*/16);
+  EXPECT_EQ(queue.capacity(), 16);
+
+  constexpr uint64_t kCount = 200000;
+  Thread producer([&]() {
+    for (uint64_t i = 0; i < kCount; ++i) {
+      queue.WriteRaw(reinterpret_cast<const uint8_t*>(&i));
+    }
+  });
+  uint64_t expected = 0;
+  while (expected < kCount) {
+    uint64_t result;
+    if (queue.ReadRaw(reinterpret_cast<uint8_t*>(&result))) {
+      ASSERT_EQ(result, expected);
+      ++expected;
+    }
+  }
+  producer.Join();
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(JitChannelQueueManagerTest, ThreadSafeManagerUsesSpscForOneToOne) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * internal,
+      package.CreateStreamingChannel("internal", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out,
+      package.CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * single_value,
+      package.CreateSingleValueChannel("sv", ChannelOps::kSendReceive,
+                                       package.GetBitsType(32)));
+  {
+    ProcBuilder pb("producer", &package);
+    BValue st = pb.StateElement("st", Value(UBits(0, 32)));
+    BValue tok = pb.Send(internal, pb.Literal(Value::Token()), st);
+    pb.Send(single_value, tok, st);
+    XLS_ASSERT_OK(pb.Build({pb.Add(st, pb.Literal(UBits(1, 32)))}).status());
+  }
+  {
+    ProcBuilder pb("consumer", &package);
+    BValue recv = pb.Receive(internal, pb.Literal(Value::Token()));
+    BValue sv = pb.Receive(single_value, pb.TupleIndex(recv, 0));
+    pb.Send(out, pb.TupleIndex(sv, 0),
+            pb.Add(pb.TupleIndex(recv, 1), pb.TupleIndex(sv, 1)));
+    XLS_ASSERT_OK(pb.Build({}).status());
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> manager,
+      JitChannelQueueManager::CreateThreadSafe(
+          &package, std::make_unique<JitRuntime>(
+                        GetJitRuntime()->data_layout())));
+  EXPECT_NE(dynamic_cast<SpscJitChannelQueue*>(&manager->GetJitQueue(internal)),
+            nullptr);
+  EXPECT_NE(dynamic_cast<ThreadSafeJitChannelQueue*>(&manager->GetJitQueue(out)),
+            nullptr);
+  EXPECT_NE(dynamic_cast<ThreadSafeJitChannelQueue*>(
+                &manager->GetJitQueue(single_value)),
+            nullptr);
+}
+
 }  // namespace
 }  // namespace xls
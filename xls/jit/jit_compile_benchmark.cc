@@ -0,0 +1,101 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/strings/str_format.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_object_cache.h"
+#include "xls/jit/orc_jit.h"
+
+namespace xls {
+namespace {
+
+// Measures JIT startup time (the time to create a FunctionJit) for a package
+// with many functions, compiling serially or with multiple compile threads.
+
+constexpr int64_t kFunctionCount = 200;
+constexpr int64_t kOpsPerFunction = 32;
+
+// Builds a package of `kFunctionCount` leaf functions, each a chain of
+// arithmetic and bitwise operations, and a top function which invokes all of
+// them and xors the results together.
+Function* BuildManyFunctionPackage(Package* package) {
+  std::vector<Function*> leaves;
+  for (int64_t i = 0; i < kFunctionCount; ++i) {
+    FunctionBuilder fb(absl::StrFormat("leaf%d", i), package);
+    BValue x = fb.Param("x", package->GetBitsType(64));
+    BValue y = fb.Param("y", package->GetBitsType(64));
+    BValue value = x;
+    for (int64_t j = 0; j < kOpsPerFunction; ++j) {
+      switch (j % 4) {
+        case 0:
+          value = fb.Add(value, fb.Literal(UBits(i * kOpsPerFunction + j, 64)));
+          break;
+        case 1:
+          value = fb.UMul(value, y);
+          break;
+        case 2:
+          value = fb.Xor(value, fb.Shrl(value, fb.Literal(UBits(j, 64))));
+          break;
+        default:
+          value = fb.Select(fb.ULt(value, y), value, fb.Subtract(value, y));
+          break;
+      }
+    }
+    leaves.push_back(fb.Build().value());
+  }
+
+  FunctionBuilder fb("top", package);
+  BValue x = fb.Param("x", package->GetBitsType(64));
+  BValue y = fb.Param("y", package->GetBitsType(64));
+  std::vector<BValue> results;
+  for (Function* leaf : leaves) {
+    results.push_back(fb.Invoke({x, y}, leaf));
+  }
+  fb.Xor(results);
+  return fb.Build().value();
+}
+
+// Argument is the number of compile threads.
+static void BM_CreateFunctionJit(benchmark::State& state) {
+  // Never serve objects from a cache; this measures compilation.
+  SetDefaultJitObjectCache(nullptr);
+  OrcJit::SetDefaultCompileThreadCount(state.range(0));
+  Package package("BM");
+  Function* top = BuildManyFunctionPackage(&package);
+  for (auto _ : state) {
+    std::unique_ptr<FunctionJit> jit = FunctionJit::Create(top).value();
+    benchmark::DoNotOptimize(jit);
+  }
+  OrcJit::SetDefaultCompileThreadCount(1);
+}
+
+BENCHMARK(BM_CreateFunctionJit)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace xls
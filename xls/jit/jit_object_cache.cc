@@ -0,0 +1,69 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/base/const_init.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/include/llvm/Config/llvm-config.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+namespace {
+
+ABSL_CONST_INIT absl::Mutex default_cache_mutex(absl::kConstInit);
+JitObjectCache* default_cache ABSL_GUARDED_BY(default_cache_mutex) = nullptr;
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<JitObjectCache>>
+JitObjectCache::Create(const std::filesystem::path& directory) {
+  XLS_ASSIGN_OR_RETURN(
+      ContentAddressedCache cache,
+      ContentAddressedCache::Create(directory, ".o", "JIT object cache"));
+  return absl::WrapUnique(new JitObjectCache(std::move(cache)));
+}
+
+/* static */ std::string JitObjectCache::ComputeKey(
+    std::string_view ir_text, const KeyOptions& options) {
+  return ContentAddressedCache::ComputeKey(
+      {LLVM_VERSION_STRING, options.target_triple, options.target_cpu,
+       options.target_features, ir_text, absl::StrCat("O", options.opt_level),
+       options.include_msan ? "msan" : "nomsan"});
+}
+
+void SetDefaultJitObjectCache(std::unique_ptr<JitObjectCache> cache) {
+  absl::MutexLock lock(&default_cache_mutex);
+  // Previously set caches may still be referenced by existing OrcJits so they
+  // are intentionally leaked.
+  default_cache = cache.release();
+}
+
+JitObjectCache* GetDefaultJitObjectCache() {
+  absl::MutexLock lock(&default_cache_mutex);
+  return default_cache;
+}
+
+}  // namespace xls
@@ -0,0 +1,90 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_OBJECT_CACHE_H_
+#define XLS_JIT_JIT_OBJECT_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/content_addressed_cache.h"
+
+namespace xls {
+
+// A persistent cache of JIT-compiled object files stored in a directory on disk
+// (see ContentAddressedCache). Each entry is keyed on a hash of everything
+// which affects the generated code: the unoptimized LLVM IR text, the
+// optimization level, the target triple, CPU and features, whether msan
+// instrumentation is included, and the LLVM version. The IR text is a function
+// of the XLS IR being compiled so an unchanged design maps to the same key
+// across runs.
+class JitObjectCache {
+ public:
+  // Creates a cache backed by `directory`, creating the directory if it does
+  // not exist.
+  static absl::StatusOr<std::unique_ptr<JitObjectCache>> Create(
+      const std::filesystem::path& directory);
+
+  // Components of a cache key in addition to the IR text.
+  struct KeyOptions {
+    int64_t opt_level;
+    bool include_msan;
+    std::string target_triple;
+    std::string target_cpu;
+    std::string target_features;
+  };
+
+  // Returns the cache key for the given unoptimized LLVM IR text.
+  static std::string ComputeKey(std::string_view ir_text,
+                                const KeyOptions& options);
+
+  // Returns the cached object file for `key` or std::nullopt if there is none.
+  absl::StatusOr<std::optional<std::string>> Lookup(
+      std::string_view key) const {
+    return cache_.Lookup(key);
+  }
+
+  // Stores `object_code` under `key`, replacing any existing entry.
+  absl::Status Insert(std::string_view key, std::string_view object_code) {
+    return cache_.Insert(key, object_code);
+  }
+
+  const std::filesystem::path& directory() const { return cache_.directory(); }
+
+ private:
+  explicit JitObjectCache(ContentAddressedCache cache)
+      : cache_(std::move(cache)) {}
+
+  ContentAddressedCache cache_;
+};
+
+// Sets the object cache used by all subsequently created OrcJits. Passing
+// nullptr disables caching. Typically called once at binary startup (e.g., by
+// InitJitObjectCacheFromFlags).
+void SetDefaultJitObjectCache(std::unique_ptr<JitObjectCache> cache);
+
+// Returns the object cache used by newly created OrcJits, or nullptr if caching
+// is disabled.
+JitObjectCache* GetDefaultJitObjectCache();
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_OBJECT_CACHE_H_
@@ -0,0 +1,172 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/llvm_compiler.h"
+#include "xls/jit/orc_jit.h"
+
+namespace xls {
+namespace {
+
+JitObjectCache::KeyOptions DefaultKeyOptions() {
+  return JitObjectCache::KeyOptions{.opt_level = 3,
+                                    .include_msan = false,
+                                    .target_triple = "x86_64-unknown-linux-gnu",
+                                    .target_cpu = "skylake",
+                                    .target_features = "+avx2"};
+}
+
+int64_t CountCacheEntries(const std::filesystem::path& directory) {
+  int64_t count = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+    if (entry.path().extension() == ".o") {
+      ++count;
+    }
+  }
+  return count;
+}
+
+class JitObjectCacheTest : public IrTestBase {
+ protected:
+  void TearDown() override {
+    SetDefaultJitObjectCache(nullptr);
+    OrcJit::SetDefaultLargeModuleInstructionCount(
+        OrcJit::kDefaultLargeModuleInstructionCount);
+  }
+};
+
+TEST_F(JitObjectCacheTest, KeyDependsOnAllInputs) {
+  const JitObjectCache::KeyOptions options = DefaultKeyOptions();
+  std::string key = JitObjectCache::ComputeKey("ir", options);
+  EXPECT_EQ(key, JitObjectCache::ComputeKey("ir", options));
+  EXPECT_NE(key, JitObjectCache::ComputeKey("ir2", options));
+
+  JitObjectCache::KeyOptions other = options;
+  other.opt_level = 1;
+  EXPECT_NE(key, JitObjectCache::ComputeKey("ir", other));
+  other = options;
+  other.include_msan = true;
+  EXPECT_NE(key, JitObjectCache::ComputeKey("ir", other));
+  other = options;
+  other.target_triple = "aarch64-unknown-linux-gnu";
+  EXPECT_NE(key, JitObjectCache::ComputeKey("ir", other));
+  other = options;
+  other.target_cpu = "znver3";
+  EXPECT_NE(key, JitObjectCache::ComputeKey("ir", other));
+  other = options;
+  other.target_features = "+avx512f";
+  EXPECT_NE(key, JitObjectCache::ComputeKey("ir", other));
+}
+
+TEST_F(JitObjectCacheTest, FunctionJitReusesCachedObject) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitObjectCache> cache,
+                           JitObjectCache::Create(temp_dir.path()));
+  SetDefaultJitObjectCache(std::move(cache));
+
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Add(fb.Param("x", p->GetBitsType(32)), fb.Literal(UBits(42, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                             FunctionJit::Create(f));
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                             jit->Run({Value(UBits(1, 32))}));
+    EXPECT_EQ(result.value, Value(UBits(43, 32)));
+  }
+  int64_t entries = CountCacheEntries(temp_dir.path());
+  EXPECT_GT(entries, 0);
+
+  // The second compilation should be served from the cache without adding
+  // any new entries.
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                             FunctionJit::Create(f));
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                             jit->Run({Value(UBits(2, 32))}));
+    EXPECT_EQ(result.value, Value(UBits(44, 32)));
+  }
+  EXPECT_EQ(CountCacheEntries(temp_dir.path()), entries);
+
+  // Different optimization levels produce different entries.
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                             FunctionJit::Create(f, /*opt_level=*/1));
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                             jit->Run({Value(UBits(3, 32))}));
+    EXPECT_EQ(result.value, Value(UBits(45, 32)));
+  }
+  EXPECT_GT(CountCacheEntries(temp_dir.path()), entries);
+}
+
+TEST_F(JitObjectCacheTest, InstructionBudgetSelectsDistinctEntries) {
+  static_assert(LlvmCompiler::kLargeModuleOptLevel < 3);
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitObjectCache> cache,
+                           JitObjectCache::Create(temp_dir.path()));
+  SetDefaultJitObjectCache(std::move(cache));
+
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Add(fb.Param("x", p->GetBitsType(32)), fb.Literal(UBits(42, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  auto compile_and_run = [&](int64_t budget, uint64_t x) {
+    OrcJit::SetDefaultLargeModuleInstructionCount(budget);
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                             FunctionJit::Create(f, /*opt_level=*/3));
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                             jit->Run({Value(UBits(x, 32))}));
+    EXPECT_EQ(result.value, Value(UBits(x + 42, 32)));
+  };
+
+  // Without a budget the module is optimized at the requested level.
+  compile_and_run(/*budget=*/0, 1);
+  int64_t unbudgeted_entries = CountCacheEntries(temp_dir.path());
+  EXPECT_GT(unbudgeted_entries, 0);
+
+  // A budget of one instruction puts every module over it so the same module
+  // is optimized at kLargeModuleOptLevel and must not reuse the object above.
+  compile_and_run(/*budget=*/1, 2);
+  int64_t all_entries = CountCacheEntries(temp_dir.path());
+  EXPECT_EQ(all_entries, 2 * unbudgeted_entries);
+
+  // Each budget is now served from its own entries.
+  compile_and_run(/*budget=*/1, 3);
+  compile_and_run(/*budget=*/0, 4);
+  EXPECT_EQ(CountCacheEntries(temp_dir.path()), all_entries);
+}
+
+}  // namespace
+}  // namespace xls
@@ -17,34 +17,30 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
-#include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
-#include "absl/algorithm/container.h"
-#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
-#include "absl/types/span.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
 #include "llvm/include/llvm/IR/LLVMContext.h"
 #include "llvm/include/llvm/IR/Module.h"
-#include "llvm/include/llvm/Support/Error.h"
 #include "llvm/include/llvm/Target/TargetMachine.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/parallel_proc_runtime.h"
 #include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/proc_elaboration.h"
-#include "xls/ir/value.h"
 #include "xls/jit/aot_compiler.h"
-#include "xls/jit/aot_entrypoint.pb.h"
+#include "xls/jit/aot_proc_runtime.h"
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_runtime.h"
@@ -55,19 +51,6 @@
 namespace xls {
 namespace {
 
-absl::Status InsertInitialChannelValues(const ProcElaboration& elaboration,
-                                        ChannelQueueManager& queue_mgr) {
-  // Inject initial values into channel queues.
-  for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
-    Channel* channel = channel_instance->channel;
-    ChannelQueue& queue = queue_mgr.GetQueue(channel_instance);
-    for (const Value& value : channel->initial_values()) {
-      XLS_RETURN_IF_ERROR(queue.Write(value));
-    }
-  }
-  return absl::OkStatus();
-}
-
 // Wrapper compiler which just shares a single llvm::Module with multiple
 // targets.
 class SharedCompiler final : public LlvmCompiler {
@@ -152,102 +135,63 @@ absl::StatusOr<JitObjectCode> GetAotObjectCode(ProcElaboration elaboration,
   };
 }
 
-namespace {
-struct AotProcJitArgs {
-  AotEntrypointProto entrypoint;
-  Proc* proc;
-  JitFunctionType unpacked;
-  std::optional<JitFunctionType> packed;
+// The queue manager and ProcJits for a JIT-compiled proc network.
+struct JitProcNetwork {
+  std::unique_ptr<JitChannelQueueManager> queue_manager;
+  std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
 };
-}  // namespace
 
-absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotRuntime(
-    ProcElaboration elaboration, const AotPackageEntrypointsProto& entrypoints,
-    absl::Span<ProcAotEntrypoints const> impls) {
-  XLS_RET_CHECK_EQ(elaboration.procs().size(), entrypoints.entrypoint_size());
-  XLS_RET_CHECK_EQ(elaboration.procs().size(), impls.size());
-  absl::flat_hash_map<std::string, AotProcJitArgs> procs_by_name;
-  for (const auto& entrypoint : entrypoints.entrypoint()) {
-    XLS_RET_CHECK(!procs_by_name.contains(entrypoint.xls_function_identifier()))
-        << "Multiple definitions for " << entrypoint.xls_function_identifier();
-    procs_by_name[entrypoint.xls_function_identifier()] = {
-        .entrypoint = entrypoint,
-        .proc = nullptr,
-        .unpacked = nullptr,
-        .packed = std::nullopt};
-  }
-  for (const auto& impl : impls) {
-    XLS_RET_CHECK(procs_by_name.contains(impl.proc->name()))
-        << "Unknown implementation of " << impl.proc->name();
-    AotProcJitArgs& args = procs_by_name[impl.proc->name()];
-    XLS_RET_CHECK(args.proc == nullptr)
-        << "Multiple copies of impl for " << impl.proc->name();
-    args.proc = impl.proc;
-    args.unpacked = impl.unpacked;
-    args.packed = impl.packed;
-  }
-  XLS_RET_CHECK(absl::c_all_of(elaboration.procs(), [&](Proc* p) {
-    return procs_by_name.contains(p->name()) &&
-           procs_by_name[p->name()].proc == p;
-  })) << "Elaboration has unknown procs";
-  XLS_RET_CHECK(entrypoints.has_data_layout())
-      << "Data layout required to create an aot runtime";
-  llvm::Expected<llvm::DataLayout> layout =
-      llvm::DataLayout::parse(entrypoints.data_layout());
-  XLS_RET_CHECK(layout) << "Unable to parse '" << entrypoints.data_layout()
-                        << "' to an llvm data-layout.";
+absl::StatusOr<JitProcNetwork> CreateJitProcNetwork(
+    ProcElaboration elaboration) {
+  // We use the compiler to know the data layout.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> comp, OrcJit::Create());
+  XLS_ASSIGN_OR_RETURN(llvm::DataLayout layout, comp->CreateDataLayout());
   // Create a queue manager for the queues. This factory verifies that there an
   // receive only queue for every receive only channel.
+  JitProcNetwork network;
   XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      network.queue_manager,
       JitChannelQueueManager::CreateThreadSafe(
-          std::move(elaboration), std::make_unique<JitRuntime>(*layout)));
+          std::move(elaboration), std::make_unique<JitRuntime>(layout)));
+
   // Create a ProcJit for each Proc.
-  std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
-  for (const auto& [_, jit_args] : procs_by_name) {
-    XLS_ASSIGN_OR_RETURN(
-        std::unique_ptr<ProcJit> proc_jit,
-        ProcJit::CreateFromAot(jit_args.proc, &queue_manager->runtime(),
-                               queue_manager.get(), jit_args.entrypoint,
-                               jit_args.unpacked, jit_args.packed));
-    proc_jits.push_back(std::move(proc_jit));
+  for (Proc* proc : network.queue_manager->elaboration().procs()) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<ProcJit> proc_jit,
+                         ProcJit::Create(proc, &network.queue_manager->runtime(),
+                                         network.queue_manager.get()));
+    network.proc_jits.push_back(std::move(proc_jit));
   }
+  return std::move(network);
+}
+
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
+    ProcElaboration elaboration) {
+  XLS_ASSIGN_OR_RETURN(JitProcNetwork network,
+                       CreateJitProcNetwork(std::move(elaboration)));
 
   // Create a runtime.
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> proc_runtime,
-                       SerialProcRuntime::Create(std::move(proc_jits),
-                                                 std::move(queue_manager)));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<SerialProcRuntime> proc_runtime,
+      SerialProcRuntime::Create(std::move(network.proc_jits),
+                                std::move(network.queue_manager)));
 
   XLS_RETURN_IF_ERROR(InsertInitialChannelValues(
       proc_runtime->elaboration(), proc_runtime->queue_manager()));
   return std::move(proc_runtime);
 }
 
-absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
-    ProcElaboration elaboration) {
-  // We use the compiler to know the data layout.
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> comp, OrcJit::Create());
-  XLS_ASSIGN_OR_RETURN(llvm::DataLayout layout, comp->CreateDataLayout());
-  // Create a queue manager for the queues. This factory verifies that there an
-  // receive only queue for every receive only channel.
-  XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<JitChannelQueueManager> queue_manager,
-      JitChannelQueueManager::CreateThreadSafe(
-          std::move(elaboration), std::make_unique<JitRuntime>(layout)));
-
-  // Create a ProcJit for each Proc.
-  std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
-  for (Proc* proc : queue_manager->elaboration().procs()) {
-    XLS_ASSIGN_OR_RETURN(
-        std::unique_ptr<ProcJit> proc_jit,
-        ProcJit::Create(proc, &queue_manager->runtime(), queue_manager.get()));
-    proc_jits.push_back(std::move(proc_jit));
-  }
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>> CreateParallelRuntime(
+    ProcElaboration elaboration, std::optional<int64_t> thread_count) {
+  XLS_ASSIGN_OR_RETURN(JitProcNetwork network,
+                       CreateJitProcNetwork(std::move(elaboration)));
 
-  // Create a runtime.
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> proc_runtime,
-                       SerialProcRuntime::Create(std::move(proc_jits),
-                                                 std::move(queue_manager)));
+  // Create a runtime. The queue manager holds ThreadSafeJitChannelQueues so
+  // the channels may be accessed from any worker thread.
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ParallelProcRuntime> proc_runtime,
+      ParallelProcRuntime::Create(std::move(network.proc_jits),
+                                  std::move(network.queue_manager),
+                                  thread_count));
 
   XLS_RETURN_IF_ERROR(InsertInitialChannelValues(
       proc_runtime->elaboration(), proc_runtime->queue_manager()));
@@ -260,14 +204,54 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
     Package* package) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
                        ProcElaboration::ElaborateOldStylePackage(package));
-  return CreateRuntime(std::move(elaboration));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> runtime,
+                       CreateRuntime(std::move(elaboration)));
+  runtime->set_factory(
+      [package]() -> absl::StatusOr<std::unique_ptr<ProcRuntime>> {
+        return CreateJitSerialProcRuntime(package);
+      });
+  return std::move(runtime);
 }
 
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
     Proc* top) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
                        ProcElaboration::Elaborate(top));
-  return CreateRuntime(std::move(elaboration));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> runtime,
+                       CreateRuntime(std::move(elaboration)));
+  runtime->set_factory([top]() -> absl::StatusOr<std::unique_ptr<ProcRuntime>> {
+    return CreateJitSerialProcRuntime(top);
+  });
+  return std::move(runtime);
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(Package* package,
+                             std::optional<int64_t> thread_count) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::ElaborateOldStylePackage(package));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ParallelProcRuntime> runtime,
+      CreateParallelRuntime(std::move(elaboration), thread_count));
+  runtime->set_factory([package, thread_count]()
+                           -> absl::StatusOr<std::unique_ptr<ProcRuntime>> {
+    return CreateJitParallelProcRuntime(package, thread_count);
+  });
+  return std::move(runtime);
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(Proc* top, std::optional<int64_t> thread_count) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::Elaborate(top));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ParallelProcRuntime> runtime,
+      CreateParallelRuntime(std::move(elaboration), thread_count));
+  runtime->set_factory(
+      [top, thread_count]() -> absl::StatusOr<std::unique_ptr<ProcRuntime>> {
+        return CreateJitParallelProcRuntime(top, thread_count);
+      });
+  return std::move(runtime);
 }
 
 absl::StatusOr<JitObjectCode> CreateProcAotObjectCode(Package* package,
@@ -284,26 +268,4 @@ absl::StatusOr<JitObjectCode> CreateProcAotObjectCode(Proc* top, bool with_msan,
   return GetAotObjectCode(std::move(elaboration), with_msan, observer);
 }
 
-// Create a SerialProcRuntime composed of ProcJits. Constructed from the
-// elaboration of the given proc using the given impls. All procs in the
-// elaboration must have an associated entry in the entrypoints and impls lists.
-absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotSerialProcRuntime(
-    Proc* top, const AotPackageEntrypointsProto& entrypoints,
-    absl::Span<ProcAotEntrypoints const> impls) {
-  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
-                       ProcElaboration::Elaborate(top));
-  return CreateAotRuntime(std::move(elaboration), entrypoints, impls);
-}
-
-// Create a SerialProcRuntime composed of ProcJits. Constructed from the
-// elaboration of the given package using the given impls. All procs in the
-// elaboration must have an associated entry in the entrypoints and impls lists.
-absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotSerialProcRuntime(
-    Package* package, const AotPackageEntrypointsProto& entrypoints,
-    absl::Span<ProcAotEntrypoints const> impls) {
-  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
-                       ProcElaboration::ElaborateOldStylePackage(package));
-  return CreateAotRuntime(std::move(elaboration), entrypoints, impls);
-}
-
 }  // namespace xls
@@ -15,14 +15,15 @@
 #ifndef XLS_JIT_JIT_PROC_RUNTIME_H_
 #define XLS_JIT_JIT_PROC_RUNTIME_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 
 #include "absl/status/statusor.h"
-#include "absl/types/span.h"
+#include "xls/interpreter/parallel_proc_runtime.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/package.h"
-#include "xls/jit/aot_entrypoint.pb.h"
+#include "xls/jit/aot_proc_runtime.h"  // IWYU pragma: export
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/observer.h"
 
@@ -38,32 +39,18 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
     Proc* top);
 
-struct ProcAotEntrypoints {
-  // What proc these entrypoints are associated with.
-  Proc* proc;
-  // unpacked entrypoint
-  JitFunctionType unpacked;
-  // packed entrypoint
-  std::optional<JitFunctionType> packed = std::nullopt;
-};
+// Create a ParallelProcRuntime composed of ProcJits which ticks procs on a
+// pool of (at most) `thread_count` worker threads. If `thread_count` is not
+// given the number of available CPUs is used. Supports old-style procs.
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(Package* package,
+                             std::optional<int64_t> thread_count = std::nullopt);
 
-// Create a SerialProcRuntime composed of ProcJits. Constructed from the
-// elaboration of the given proc using the given impls. All procs in the
-// elaboration must have an associated entry in the entrypoints and impls lists.
-// TODO(allight): Requiring the whole package here makes a lot of things simpler
-// but it would be nice to not need to parse the package in the aot case.
-absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotSerialProcRuntime(
-    Proc* top, const AotPackageEntrypointsProto& entrypoints,
-    absl::Span<ProcAotEntrypoints const> impls);
-
-// Create a SerialProcRuntime composed of ProcJits. Constructed from the
-// elaboration of the given package using the given impls. All procs in the
-// elaboration must have an associated entry in the entrypoints and impls lists.
-// TODO(allight): Requiring the whole package here makes a lot of things simpler
-// but it would be nice to not need to parse the package in the aot case.
-absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotSerialProcRuntime(
-    Package* package, const AotPackageEntrypointsProto& entrypoints,
-    absl::Span<ProcAotEntrypoints const> impls);
+// Create a ParallelProcRuntime composed of ProcJits. Constructed from the
+// elaboration of the given proc. Supports new-style procs.
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(Proc* top,
+                             std::optional<int64_t> thread_count = std::nullopt);
 
 // Generate AOT code for the given proc elaboration.
 absl::StatusOr<JitObjectCode> CreateProcAotObjectCode(
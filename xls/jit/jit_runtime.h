@@ -18,21 +18,29 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
 #include "xls/ir/type.h"
+#include "xls/ir/type_manager.h"
 #include "xls/ir/value.h"
 #include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
 // JitRuntime contains routines necessary for executing code generated by the
 // IR JIT. For type resolution, the JIT packs input data into and pulls
 // data out of a flat character buffer, thus these routines are necessary.
+//
+// Values are marshalled through TypeLayouts which are computed once per type
+// and then immutable, so concurrent callers do not serialize on the LLVM type
+// converter.
 class JitRuntime {
  public:
   explicit JitRuntime(llvm::DataLayout data_layout);
@@ -98,8 +106,7 @@ class JitRuntime {
   }
 
   int64_t GetTypeByteSize(Type* xls_type) {
-    absl::MutexLock lock(&mutex_);
-    return type_converter_->GetTypeByteSize(xls_type);
+    return GetTypeLayout(xls_type).size();
   }
 
   int64_t GetTypeAlignment(Type* xls_type) {
@@ -107,20 +114,37 @@ class JitRuntime {
     return type_converter_->GetTypePreferredAlignment(xls_type);
   }
 
+  // Returns the native layout of `xls_type`.
+  TypeLayout CreateTypeLayout(Type* xls_type) {
+    absl::MutexLock lock(&mutex_);
+    return type_converter_->CreateTypeLayout(xls_type);
+  }
+
+  // Returns the cached native layout of `xls_type`, computing it on first use.
+  // The returned layout is owned by the runtime and refers to a copy of the
+  // type, so it remains valid even if `xls_type` is destroyed. Lookups only
+  // take a reader lock.
+  const TypeLayout& GetTypeLayout(const Type* xls_type);
+
   const llvm::DataLayout& data_layout() const { return data_layout_; }
 
  private:
-  Value UnpackBufferInternal(const uint8_t* buffer, const Type* result_type)
-      ABSL_SHARED_LOCKS_REQUIRED(mutex_);
-  void BlitValueToBufferInternal(const Value& value, const Type* type,
-                                 absl::Span<uint8_t> buffer)
-      ABSL_SHARED_LOCKS_REQUIRED(mutex_);
-
   mutable absl::Mutex mutex_;
 
   const llvm::DataLayout data_layout_;
   std::unique_ptr<llvm::LLVMContext> context_ ABSL_GUARDED_BY(mutex_);
   std::unique_ptr<LlvmTypeConverter> type_converter_ ABSL_GUARDED_BY(mutex_);
+
+  // Layouts by the address of the type they were requested for. As a type at
+  // a given address may be destroyed and another allocated in its place, a
+  // cached layout is only used if its type is equal to the requested one. The
+  // layouts refer to copies of the types owned by `type_manager_`.
+  absl::Mutex layouts_mutex_;
+  absl::flat_hash_map<const Type*, std::unique_ptr<const TypeLayout>> layouts_
+      ABSL_GUARDED_BY(layouts_mutex_);
+  std::vector<std::unique_ptr<const TypeLayout>> stale_layouts_
+      ABSL_GUARDED_BY(layouts_mutex_);
+  TypeManager type_manager_ ABSL_GUARDED_BY(layouts_mutex_);
 };
 
 }  // namespace xls
@@ -0,0 +1,176 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/jit/jit_runtime.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/synchronization/barrier.h"
+#include "absl/types/span.h"
+#include "xls/common/thread.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/type.h"
+#include "xls/ir/type_manager.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+namespace {
+
+using ::testing::Each;
+using ::testing::ElementsAreArray;
+
+std::unique_ptr<JitRuntime> CreateJitRuntime() {
+  std::unique_ptr<OrcJit> orc_jit = OrcJit::Create().value();
+  return std::make_unique<JitRuntime>(orc_jit->CreateDataLayout().value());
+}
+
+TEST(JitRuntimeTest, TypeLayoutIsCached) {
+  std::unique_ptr<JitRuntime> runtime = CreateJitRuntime();
+  TypeManager types;
+  Type* type = types.GetTupleType(
+      {types.GetBitsType(2),
+       types.GetTupleType({types.GetBitsType(15), types.GetBitsType(4)})});
+  const TypeLayout& layout = runtime->GetTypeLayout(type);
+  EXPECT_EQ(&runtime->GetTypeLayout(type), &layout);
+  EXPECT_TRUE(layout.type()->IsEqualTo(type));
+  TypeLayout expected = runtime->CreateTypeLayout(type);
+  EXPECT_EQ(layout.size(), expected.size());
+  EXPECT_THAT(layout.elements(), ElementsAreArray(expected.elements()));
+  EXPECT_EQ(runtime->GetTypeByteSize(type), expected.size());
+}
+
+TEST(JitRuntimeTest, LayoutOutlivesType) {
+  std::unique_ptr<JitRuntime> runtime = CreateJitRuntime();
+  auto types = std::make_unique<TypeManager>();
+  Type* array_type = types->GetArrayType(3, types->GetBitsType(37));
+  const TypeLayout& layout = runtime->GetTypeLayout(array_type);
+  types.reset();
+
+  // A different type may be allocated at the same address; it must not be
+  // given the layout of the destroyed type.
+  types = std::make_unique<TypeManager>();
+  Type* bits_type = types->GetBitsType(8);
+  EXPECT_TRUE(runtime->GetTypeLayout(bits_type).type()->IsEqualTo(bits_type));
+  EXPECT_EQ(layout.elements().size(), 3);
+
+  Value value = Value::ArrayOrDie({Value(UBits(1, 37)), Value(UBits(2, 37)),
+                                   Value(UBits(3, 37))});
+  std::vector<uint8_t> buffer(layout.size());
+  layout.ValueToNativeLayout(value, buffer.data());
+  EXPECT_EQ(layout.NativeLayoutToValue(buffer.data()), value);
+}
+
+TEST(JitRuntimeTest, BlitClearsPadding) {
+  std::unique_ptr<JitRuntime> runtime = CreateJitRuntime();
+  TypeManager types;
+  Type* type =
+      types.GetTupleType({types.GetBitsType(2), types.GetBitsType(42)});
+  int64_t size = runtime->GetTypeByteSize(type);
+  std::vector<uint8_t> buffer(size, 0xff);
+  Value value = Value::Tuple({Value(UBits(3, 2)), Value(UBits(0, 42))});
+  runtime->BlitValueToBuffer(value, type, absl::MakeSpan(buffer));
+  EXPECT_EQ(buffer[0], 3);
+  for (int64_t i = 1; i < size; ++i) {
+    EXPECT_EQ(buffer[i], 0) << i;
+  }
+  EXPECT_EQ(runtime->UnpackBuffer(buffer.data(), type), value);
+}
+
+TEST(JitRuntimeTest, ConcurrentMarshalling) {
+  std::unique_ptr<JitRuntime> runtime = CreateJitRuntime();
+  TypeManager types;
+  Type* type = types.GetTupleType(
+      {types.GetBitsType(17), types.GetArrayType(4, types.GetBitsType(9))});
+  int64_t size = runtime->GetTypeByteSize(type);
+
+  constexpr int64_t kThreadCount = 8;
+  constexpr int64_t kIterations = 1000;
+  std::vector<std::unique_ptr<Thread>> threads;
+  std::vector<int64_t> mismatches(kThreadCount, 0);
+  for (int64_t t = 0; t < kThreadCount; ++t) {
+    threads.push_back(std::make_unique<Thread>([&, t]() {
+      std::vector<uint8_t> buffer(size);
+      for (int64_t i = 0; i < kIterations; ++i) {
+        Value value = Value::Tuple(
+            {Value(UBits(t * kIterations + i, 17)),
+             Value::ArrayOrDie({Value(UBits(t, 9)), Value(UBits(i % 512, 9)),
+                                Value(UBits(0, 9)), Value(UBits(511, 9))})});
+        runtime->BlitValueToBuffer(value, type, absl::MakeSpan(buffer));
+        if (runtime->UnpackBuffer(buffer.data(), type) != value) {
+          ++mismatches[t];
+        }
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  EXPECT_THAT(mismatches, Each(0));
+}
+
+TEST(JitRuntimeTest, ConcurrentFirstUseOfFreshTypes) {
+  std::unique_ptr<JitRuntime> runtime = CreateJitRuntime();
+  TypeManager types;
+  constexpr int64_t kTypeCount = 64;
+  std::vector<Type*> fresh_types;
+  for (int64_t i = 1; i <= kTypeCount; ++i) {
+    fresh_types.push_back(types.GetTupleType(
+        {types.GetBitsType(i), types.GetArrayType(i, types.GetBitsType(3))}));
+  }
+
+  // Every thread requests every type, starting at a different one, so that
+  // threads race to add layouts to the cache rather than read existing ones.
+  constexpr int64_t kThreadCount = 8;
+  absl::Barrier barrier(kThreadCount);
+  std::vector<std::vector<const TypeLayout*>> layouts(kThreadCount);
+  std::vector<int64_t> mismatches(kThreadCount, 0);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t t = 0; t < kThreadCount; ++t) {
+    threads.push_back(std::make_unique<Thread>([&, t]() {
+      layouts[t].resize(kTypeCount);
+      barrier.Block();
+      for (int64_t j = 0; j < kTypeCount; ++j) {
+        int64_t i = (j + t * kTypeCount / kThreadCount) % kTypeCount;
+        Type* type = fresh_types[i];
+        layouts[t][i] = &runtime->GetTypeLayout(type);
+        Value value = ZeroOfType(type);
+        std::vector<uint8_t> buffer(layouts[t][i]->size());
+        runtime->BlitValueToBuffer(value, type, absl::MakeSpan(buffer));
+        if (!layouts[t][i]->type()->IsEqualTo(type) ||
+            runtime->UnpackBuffer(buffer.data(), type) != value) {
+          ++mismatches[t];
+        }
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  EXPECT_THAT(mismatches, Each(0));
+  // Each type has exactly one cached layout.
+  for (int64_t t = 1; t < kThreadCount; ++t) {
+    EXPECT_THAT(layouts[t], ElementsAreArray(layouts[0]));
+  }
+}
+
+}  // namespace
+}  // namespace xls
@@ -134,6 +134,14 @@ class XlsNamedValue:
   def specialized_arg(self):
     return f"{self.specialized_type} {self.name}"
 
+  @property
+  def batched_arg(self):
+    return f"absl::Span<const {self.specialized_type}> {self.name}"
+
+  @property
+  def batched_result_arg(self):
+    return f"absl::Span<{self.specialized_type}> {self.name}"
+
 
 class JitType(enum.Enum):
   FUNCTION = 1
@@ -15,13 +15,16 @@
 #include <array>
 #include <bit>
 #include <cstdint>
+#include <cstring>
 #include <optional>
 #include <string_view>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/algorithm/container.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/stdlib/float32_mul_jit_wrapper.h"
 #include "xls/dslx/stdlib/float32_upcast_jit_wrapper.h"
@@ -32,12 +35,18 @@
 #include "xls/ir/value_builder.h"
 #include "xls/ir/value_view.h"
 #include "xls/jit/compound_type_jit_wrapper.h"
+#include "xls/jit/struct_type_cc_types.h"
+#include "xls/jit/struct_type_jit_wrapper.h"
 
 namespace xls {
 namespace {
 
 using something::cool::CompoundJitWrapper;
+using something::cool::Point;
+using something::cool::Segment;
+using something::cool::StructTypeJitWrapper;
 using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
 using testing::Optional;
 
 TEST(JitWrapperTest, BasicFunctionCall) {
@@ -63,6 +72,20 @@ TEST(JitWrapperTest, BasicFunctionCall) {
                                   complex_value}));
 }
 
+TEST(JitWrapperTest, TypedFunctionCall) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, StructTypeJitWrapper::Create());
+  Segment s{.start = Point{.x = 1, .y = -2}, .end = Point{.x = 30, .y = 10}};
+  Point d{.x = 5, .y = -6};
+  EXPECT_THAT(jit->RunTyped<Segment>(s, d),
+              IsOkAndHolds(Segment{.start = Point{.x = 6, .y = -8},
+                                   .end = Point{.x = 35, .y = 4}}));
+
+  // Out-of-range fields are rejected before running the function.
+  Point too_wide{.x = 0, .y = 40};
+  EXPECT_THAT(jit->RunTyped<Segment>(s, too_wide),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 TEST(JitWrapperTest, SpecializedFunctionCall) {
   XLS_ASSERT_OK_AND_ASSIGN(auto jit, fp::F32ToF64::Create());
   XLS_ASSERT_OK_AND_ASSIGN(double dv, jit->Run(3.14f));
@@ -75,6 +98,21 @@ TEST(JitWrapperTest, SpecializedFunctionCall2) {
   EXPECT_EQ(res, 3.14f * 1.2345f);
 }
 
+TEST(JitWrapperTest, BatchedFunctionCall) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, fp::Float32Mul::Create());
+  std::vector<float> lhs = {3.14f, -2.0f, 0.5f, 1e10f};
+  std::vector<float> rhs = {1.2345f, 8.0f, -0.25f, 1e-10f};
+  std::vector<float> results(lhs.size());
+  XLS_ASSERT_OK(jit->RunBatched(lhs, rhs, absl::MakeSpan(results)));
+  for (int64_t i = 0; i < lhs.size(); ++i) {
+    EXPECT_EQ(results[i], lhs[i] * rhs[i]) << "element " << i;
+  }
+
+  std::vector<float> too_short(1);
+  EXPECT_THAT(jit->RunBatched(lhs, too_short, absl::MakeSpan(results)),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
 TEST(JitWrapperTest, PackedFunctionCall) {
   XLS_ASSERT_OK_AND_ASSIGN(auto jit, fp::F32ToF64::Create());
   double dv = -1.23;
@@ -100,6 +138,25 @@ TEST(JitWrapperTest, PackedFunctionCall2) {
   EXPECT_EQ(rv, 1.2345f);
 }
 
+TEST(JitWrapperTest, PackedFunctionCallWithOwnedResult) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, fp::Float32Mul::Create());
+  float lv = 3.14f;
+  float rv = 1.2345f;
+  PackedFloat plv(std::bit_cast<uint8_t*>(&lv), 0);
+  PackedFloat prv(std::bit_cast<uint8_t*>(&rv), 0);
+  XLS_ASSERT_OK_AND_ASSIGN(PackedFloat pres, jit->RunPacked(plv, prv));
+  float result;
+  std::memcpy(&result, pres.buffer(), sizeof(result));
+  EXPECT_EQ(result, 3.14f * 1.2345f);
+
+  // The result buffer is reused by the next call.
+  rv = 2.0f;
+  XLS_ASSERT_OK_AND_ASSIGN(PackedFloat pres2, jit->RunPacked(plv, prv));
+  EXPECT_EQ(pres2.buffer(), pres.buffer());
+  std::memcpy(&result, pres2.buffer(), sizeof(result));
+  EXPECT_EQ(result, 3.14f * 2.0f);
+}
+
 std::array<uint8_t, 8> StrArray(std::string_view sv) {
   EXPECT_EQ(sv.size(), 8);
   std::array<uint8_t, 8> ret;
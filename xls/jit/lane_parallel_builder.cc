@@ -0,0 +1,611 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/lane_parallel_builder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "llvm/include/llvm/IR/BasicBlock.h"
+#include "llvm/include/llvm/IR/Constants.h"
+#include "llvm/include/llvm/IR/DerivedTypes.h"
+#include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/IRBuilder.h"
+#include "llvm/include/llvm/IR/Instructions.h"
+#include "llvm/include/llvm/IR/Intrinsics.h"
+#include "llvm/include/llvm/IR/Type.h"
+#include "llvm/include/llvm/IR/Value.h"
+#include "llvm/include/llvm/Support/Alignment.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/register.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/jit/ir_builder_visitor.h"
+
+namespace xls {
+namespace {
+
+bool IsSupportedOp(Op op) {
+  switch (op) {
+    case Op::kParam:
+    case Op::kInputPort:
+    case Op::kOutputPort:
+    case Op::kRegisterRead:
+    case Op::kRegisterWrite:
+    case Op::kLiteral:
+    case Op::kIdentity:
+    case Op::kAnd:
+    case Op::kOr:
+    case Op::kXor:
+    case Op::kNand:
+    case Op::kNor:
+    case Op::kNot:
+    case Op::kNeg:
+    case Op::kAdd:
+    case Op::kSub:
+    case Op::kUMul:
+    case Op::kSMul:
+    case Op::kEq:
+    case Op::kNe:
+    case Op::kULt:
+    case Op::kULe:
+    case Op::kUGt:
+    case Op::kUGe:
+    case Op::kSLt:
+    case Op::kSLe:
+    case Op::kSGt:
+    case Op::kSGe:
+    case Op::kSel:
+    case Op::kShll:
+    case Op::kShrl:
+    case Op::kShra:
+    case Op::kZeroExt:
+    case Op::kSignExt:
+    case Op::kBitSlice:
+    case Op::kConcat:
+    case Op::kAndReduce:
+    case Op::kOrReduce:
+    case Op::kXorReduce:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Emits the vectorized computation of the nodes of a function. Each node value
+// is an LLVM vector <lane_count x iN> where N is the bit width of the node.
+class LaneParallelEmitter {
+ public:
+  LaneParallelEmitter(int64_t lane_count, llvm::IRBuilder<>& builder,
+                      JitBuilderContext& jit_context)
+      : lane_count_(lane_count),
+        builder_(builder),
+        jit_context_(jit_context) {}
+
+  llvm::VectorType* VectorType(int64_t bit_count) {
+    return llvm::FixedVectorType::get(builder_.getIntNTy(bit_count),
+                                      lane_count_);
+  }
+
+  llvm::Value* Splat(int64_t bit_count, uint64_t value) {
+    return llvm::ConstantInt::get(VectorType(bit_count), value);
+  }
+
+  // Zero or sign-extends, or truncates, `value` from `from` to `to` bits.
+  llvm::Value* Resize(llvm::Value* value, int64_t from, int64_t to,
+                      bool is_signed = false) {
+    if (from == to) {
+      return value;
+    }
+    if (to < from) {
+      return builder_.CreateTrunc(value, VectorType(to));
+    }
+    return is_signed ? builder_.CreateSExt(value, VectorType(to))
+                     : builder_.CreateZExt(value, VectorType(to));
+  }
+
+  void SetValue(Node* node, llvm::Value* value) { values_[node] = value; }
+  llvm::Value* GetValue(Node* node) const { return values_.at(node); }
+
+  absl::StatusOr<llvm::Value*> EmitNode(Node* node);
+
+ private:
+  llvm::Value* Operand(Node* node, int64_t i) const {
+    return values_.at(node->operand(i));
+  }
+
+  llvm::Value* EmitShift(Node* node);
+  llvm::Value* EmitSelect(Select* sel);
+  llvm::Value* EmitConcat(Node* node);
+
+  int64_t lane_count_;
+  llvm::IRBuilder<>& builder_;
+  JitBuilderContext& jit_context_;
+  absl::flat_hash_map<Node*, llvm::Value*> values_;
+};
+
+llvm::Value* LaneParallelEmitter::EmitShift(Node* node) {
+  llvm::Value* value = Operand(node, 0);
+  llvm::Value* amount = Operand(node, 1);
+  int64_t width = node->BitCountOrDie();
+  int64_t amount_width = node->operand(1)->BitCountOrDie();
+
+  // Shifting by the bit width or more is poison in LLVM but well defined in
+  // XLS so compare in a width which can hold both the amount and the width.
+  int64_t common_width = std::max(width, amount_width);
+  llvm::Value* wide_amount = Resize(amount, amount_width, common_width);
+  llvm::Value* overshift =
+      builder_.CreateICmpUGE(wide_amount, Splat(common_width, width));
+  llvm::Value* safe_amount = Resize(
+      builder_.CreateSelect(overshift, Splat(common_width, 0), wide_amount),
+      common_width, width);
+
+  llvm::Value* shifted;
+  llvm::Value* overshift_value;
+  switch (node->op()) {
+    case Op::kShll:
+      shifted = builder_.CreateShl(value, safe_amount);
+      overshift_value = Splat(width, 0);
+      break;
+    case Op::kShrl:
+      shifted = builder_.CreateLShr(value, safe_amount);
+      overshift_value = Splat(width, 0);
+      break;
+    default:
+      shifted = builder_.CreateAShr(value, safe_amount);
+      overshift_value = builder_.CreateAShr(value, Splat(width, width - 1));
+      break;
+  }
+  return builder_.CreateSelect(overshift, overshift_value, shifted);
+}
+
+llvm::Value* LaneParallelEmitter::EmitSelect(Select* sel) {
+  llvm::Value* selector = GetValue(sel->selector());
+  int64_t selector_width = sel->selector()->BitCountOrDie();
+  absl::Span<Node* const> cases = sel->cases();
+  // Build a chain of selects starting from the value chosen when no other case
+  // matches: the default value or, if there is none, the last case.
+  int64_t case_count = cases.size();
+  llvm::Value* result;
+  if (sel->default_value().has_value()) {
+    result = GetValue(*sel->default_value());
+  } else {
+    --case_count;
+    result = GetValue(cases.back());
+  }
+  for (int64_t i = case_count - 1; i >= 0; --i) {
+    llvm::Value* matches =
+        builder_.CreateICmpEQ(selector, Splat(selector_width, i));
+    result = builder_.CreateSelect(matches, GetValue(cases[i]), result);
+  }
+  return result;
+}
+
+llvm::Value* LaneParallelEmitter::EmitConcat(Node* node) {
+  // Operand zero is the most significant.
+  int64_t width = node->BitCountOrDie();
+  llvm::Value* result = Splat(width, 0);
+  int64_t offset = 0;
+  for (int64_t i = node->operand_count() - 1; i >= 0; --i) {
+    int64_t operand_width = node->operand(i)->BitCountOrDie();
+    llvm::Value* wide = Resize(Operand(node, i), operand_width, width);
+    if (offset > 0) {
+      wide = builder_.CreateShl(wide, Splat(width, offset));
+    }
+    result = builder_.CreateOr(result, wide);
+    offset += operand_width;
+  }
+  return result;
+}
+
+absl::StatusOr<llvm::Value*> LaneParallelEmitter::EmitNode(Node* node) {
+  int64_t width = node->BitCountOrDie();
+  switch (node->op()) {
+    case Op::kLiteral: {
+      XLS_ASSIGN_OR_RETURN(llvm::Constant * scalar,
+                           jit_context_.type_converter().ToLlvmConstant(
+                               builder_.getIntNTy(width),
+                               node->As<Literal>()->value()));
+      return llvm::ConstantVector::getSplat(
+          llvm::ElementCount::getFixed(lane_count_), scalar);
+    }
+    case Op::kIdentity:
+      return Operand(node, 0);
+    case Op::kAnd:
+    case Op::kOr:
+    case Op::kXor:
+    case Op::kNand:
+    case Op::kNor: {
+      llvm::Value* result = Operand(node, 0);
+      for (int64_t i = 1; i < node->operand_count(); ++i) {
+        if (node->op() == Op::kAnd || node->op() == Op::kNand) {
+          result = builder_.CreateAnd(result, Operand(node, i));
+        } else if (node->op() == Op::kOr || node->op() == Op::kNor) {
+          result = builder_.CreateOr(result, Operand(node, i));
+        } else {
+          result = builder_.CreateXor(result, Operand(node, i));
+        }
+      }
+      if (node->op() == Op::kNand || node->op() == Op::kNor) {
+        result = builder_.CreateNot(result);
+      }
+      return result;
+    }
+    case Op::kNot:
+      return builder_.CreateNot(Operand(node, 0));
+    case Op::kNeg:
+      return builder_.CreateNeg(Operand(node, 0));
+    case Op::kAdd:
+      return builder_.CreateAdd(Operand(node, 0), Operand(node, 1));
+    case Op::kSub:
+      return builder_.CreateSub(Operand(node, 0), Operand(node, 1));
+    case Op::kUMul:
+    case Op::kSMul: {
+      // The low `width` bits of the product only depend on the low `width`
+      // bits of the (extended) operands.
+      bool is_signed = node->op() == Op::kSMul;
+      llvm::Value* lhs = Resize(Operand(node, 0),
+                                node->operand(0)->BitCountOrDie(), width,
+                                is_signed);
+      llvm::Value* rhs = Resize(Operand(node, 1),
+                                node->operand(1)->BitCountOrDie(), width,
+                                is_signed);
+      return builder_.CreateMul(lhs, rhs);
+    }
+    case Op::kEq:
+      return builder_.CreateICmpEQ(Operand(node, 0), Operand(node, 1));
+    case Op::kNe:
+      return builder_.CreateICmpNE(Operand(node, 0), Operand(node, 1));
+    case Op::kULt:
+      return builder_.CreateICmpULT(Operand(node, 0), Operand(node, 1));
+    case Op::kULe:
+      return builder_.CreateICmpULE(Operand(node, 0), Operand(node, 1));
+    case Op::kUGt:
+      return builder_.CreateICmpUGT(Operand(node, 0), Operand(node, 1));
+    case Op::kUGe:
+      return builder_.CreateICmpUGE(Operand(node, 0), Operand(node, 1));
+    case Op::kSLt:
+      return builder_.CreateICmpSLT(Operand(node, 0), Operand(node, 1));
+    case Op::kSLe:
+      return builder_.CreateICmpSLE(Operand(node, 0), Operand(node, 1));
+    case Op::kSGt:
+      return builder_.CreateICmpSGT(Operand(node, 0), Operand(node, 1));
+    case Op::kSGe:
+      return builder_.CreateICmpSGE(Operand(node, 0), Operand(node, 1));
+    case Op::kSel:
+      return EmitSelect(node->As<Select>());
+    case Op::kShll:
+    case Op::kShrl:
+    case Op::kShra:
+      return EmitShift(node);
+    case Op::kZeroExt:
+      return Resize(Operand(node, 0), node->operand(0)->BitCountOrDie(), width);
+    case Op::kSignExt:
+      return Resize(Operand(node, 0), node->operand(0)->BitCountOrDie(), width,
+                    /*is_signed=*/true);
+    case Op::kBitSlice: {
+      BitSlice* slice = node->As<BitSlice>();
+      int64_t operand_width = slice->operand(0)->BitCountOrDie();
+      llvm::Value* value = Operand(node, 0);
+      if (slice->start() > 0) {
+        value = builder_.CreateLShr(value,
+                                    Splat(operand_width, slice->start()));
+      }
+      return Resize(value, operand_width, width);
+    }
+    case Op::kConcat:
+      return EmitConcat(node);
+    case Op::kAndReduce:
+      return builder_.CreateICmpEQ(
+          Operand(node, 0),
+          llvm::Constant::getAllOnesValue(
+              VectorType(node->operand(0)->BitCountOrDie())));
+    case Op::kOrReduce:
+      return builder_.CreateICmpNE(
+          Operand(node, 0), Splat(node->operand(0)->BitCountOrDie(), 0));
+    case Op::kXorReduce:
+      return builder_.CreateTrunc(
+          builder_.CreateUnaryIntrinsic(llvm::Intrinsic::ctpop,
+                                        Operand(node, 0)),
+          VectorType(1));
+    default:
+      return absl::UnimplementedError(
+          absl::StrFormat("Unsupported lane-parallel operation: %s",
+                          node->ToString()));
+  }
+}
+
+llvm::Value* LoadPointer(int64_t index, llvm::Value* pointer_array,
+                         llvm::IRBuilder<>& builder) {
+  llvm::Type* ptr_type = llvm::PointerType::get(builder.getContext(), 0);
+  return builder.CreateLoad(
+      ptr_type, builder.CreateConstGEP1_64(ptr_type, pointer_array, index));
+}
+
+void StorePointer(int64_t index, llvm::Value* pointer,
+                  llvm::Value* pointer_array, llvm::IRBuilder<>& builder) {
+  builder.CreateStore(
+      pointer,
+      builder.CreateConstGEP1_64(
+          llvm::PointerType::get(builder.getContext(), 0), pointer_array,
+          index));
+}
+
+// Returns the nodes whose values are passed into the jitted function in the
+// order of its `inputs` argument: the parameters of a function or the input
+// ports followed by the register reads of a block.
+std::vector<Node*> GetInputNodes(FunctionBase* function_base) {
+  if (function_base->IsFunction()) {
+    absl::Span<Param* const> params = function_base->params();
+    return std::vector<Node*>(params.begin(), params.end());
+  }
+  Block* block = function_base->AsBlockOrDie();
+  std::vector<Node*> inputs(block->GetInputPorts().begin(),
+                            block->GetInputPorts().end());
+  for (Register* reg : block->GetRegisters()) {
+    inputs.push_back(*block->GetRegisterRead(reg));
+  }
+  return inputs;
+}
+
+// Returns the nodes whose values are passed out of the jitted function in the
+// order of its `outputs` argument: the return value of a function or the output
+// ports followed by the register writes of a block.
+std::vector<Node*> GetOutputNodes(FunctionBase* function_base) {
+  if (function_base->IsFunction()) {
+    return {function_base->AsFunctionOrDie()->return_value()};
+  }
+  Block* block = function_base->AsBlockOrDie();
+  std::vector<Node*> outputs(block->GetOutputPorts().begin(),
+                             block->GetOutputPorts().end());
+  for (Register* reg : block->GetRegisters()) {
+    outputs.push_back(*block->GetRegisterWrite(reg));
+  }
+  return outputs;
+}
+
+bool IsBlockOutput(Node* node) {
+  return node->Is<OutputPort>() || node->Is<RegisterWrite>();
+}
+
+// Returns the type of the value written to the output buffer for `node`.
+Type* OutputType(Node* node) {
+  return IsBlockOutput(node) ? node->operand(0)->GetType() : node->GetType();
+}
+
+// Returns the value stored to the output buffer for `node`.
+absl::StatusOr<llvm::Value*> EmitOutputValue(Node* node,
+                                             LaneParallelEmitter& emitter,
+                                             llvm::IRBuilder<>& builder,
+                                             JitBuilderContext& jit_context) {
+  if (node->Is<OutputPort>()) {
+    return emitter.GetValue(node->operand(0));
+  }
+  if (!node->Is<RegisterWrite>()) {
+    return emitter.GetValue(node);
+  }
+  // As in the scalar JIT reset takes priority over the load enable.
+  RegisterWrite* write = node->As<RegisterWrite>();
+  llvm::Value* result = emitter.GetValue(write->data());
+  if (write->load_enable().has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        RegisterRead * read,
+        write->function_base()->AsBlockOrDie()->GetRegisterRead(
+            write->GetRegister()));
+    result = builder.CreateSelect(emitter.GetValue(*write->load_enable()),
+                                  result, emitter.GetValue(read));
+  }
+  if (write->reset().has_value()) {
+    const std::optional<Reset>& reset = write->GetRegister()->reset();
+    XLS_RET_CHECK(reset.has_value())
+        << "reset argument without reset behavior set";
+    llvm::Value* reset_asserted = emitter.GetValue(*write->reset());
+    if (reset->active_low) {
+      reset_asserted = builder.CreateNot(reset_asserted);
+    }
+    int64_t width = write->data()->BitCountOrDie();
+    XLS_ASSIGN_OR_RETURN(llvm::Constant * reset_value,
+                         jit_context.type_converter().ToLlvmConstant(
+                             builder.getIntNTy(width), reset->reset_value));
+    result = builder.CreateSelect(
+        reset_asserted,
+        llvm::ConstantVector::getSplat(
+            llvm::cast<llvm::VectorType>(result->getType())->getElementCount(),
+            reset_value),
+        result);
+  }
+  return result;
+}
+
+}  // namespace
+
+absl::Status CheckLaneParallelizable(FunctionBase* function) {
+  if (function->IsProc()) {
+    return absl::InvalidArgumentError("Procs are not lane-parallelizable");
+  }
+  if (function->IsBlock() &&
+      !function->AsBlockOrDie()->GetInstantiations().empty()) {
+    return absl::InvalidArgumentError(
+        "Blocks with instantiations are not lane-parallelizable");
+  }
+  for (Node* node : function->nodes()) {
+    if (IsBlockOutput(node)) {
+      // These produce no value; the values they write are checked as nodes.
+      continue;
+    }
+    if (!node->GetType()->IsBits()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Node %s is not of bits type", node->GetName()));
+    }
+    int64_t bit_count = node->BitCountOrDie();
+    if (bit_count == 0 || bit_count > kMaxLaneParallelBitWidth) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Node %s has bit width %d which is not in the range [1, %d]",
+          node->GetName(), bit_count, kMaxLaneParallelBitWidth));
+    }
+    if (!IsSupportedOp(node->op())) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Node %s has unsupported operation %s",
+                          node->GetName(), OpToString(node->op())));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<llvm::Function*> BuildLaneParallelFunction(
+    FunctionBase* function, int64_t lane_count, llvm::Function* scalar_batched,
+    JitBuilderContext& jit_context) {
+  XLS_RET_CHECK_GT(lane_count, 0);
+  XLS_RET_CHECK_EQ(lane_count & (lane_count - 1), 0)
+      << "Lane count must be a power of two";
+  XLS_RETURN_IF_ERROR(CheckLaneParallelizable(function));
+
+  llvm::LLVMContext& context = jit_context.context();
+  llvm::Function* fn = llvm::Function::Create(
+      scalar_batched->getFunctionType(), llvm::Function::ExternalLinkage,
+      absl::StrFormat("%s_lane_parallel", function->name()),
+      jit_context.module());
+  llvm::Value* input_ptrs = fn->getArg(0);
+  llvm::Value* output_ptrs = fn->getArg(1);
+  llvm::Value* batch_size = fn->getArg(6);
+  input_ptrs->setName("input_ptrs");
+  output_ptrs->setName("output_ptrs");
+  batch_size->setName("batch_size");
+
+  LlvmTypeConverter& type_converter = jit_context.type_converter();
+  std::vector<Node*> inputs = GetInputNodes(function);
+  std::vector<Node*> outputs = GetOutputNodes(function);
+
+  llvm::BasicBlock* entry = llvm::BasicBlock::Create(context, "entry", fn);
+  llvm::BasicBlock* loop_header =
+      llvm::BasicBlock::Create(context, "loop_header", fn);
+  llvm::BasicBlock* loop_body =
+      llvm::BasicBlock::Create(context, "loop_body", fn);
+  llvm::BasicBlock* tail = llvm::BasicBlock::Create(context, "tail", fn);
+
+  llvm::IRBuilder<> entry_builder(entry);
+  llvm::Type* i64 = entry_builder.getInt64Ty();
+  std::vector<llvm::Value*> input_bases;
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    input_bases.push_back(LoadPointer(i, input_ptrs, entry_builder));
+  }
+  std::vector<llvm::Value*> output_bases;
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    output_bases.push_back(LoadPointer(i, output_ptrs, entry_builder));
+  }
+  llvm::Type* ptr_type = llvm::PointerType::get(context, 0);
+  llvm::Value* tail_input_ptrs = entry_builder.CreateAlloca(
+      llvm::ArrayType::get(ptr_type, inputs.size()));
+  llvm::Value* tail_output_ptrs = entry_builder.CreateAlloca(
+      llvm::ArrayType::get(ptr_type, outputs.size()));
+  // Number of batch elements handled by the vector loop.
+  llvm::Value* vector_end = entry_builder.CreateAnd(
+      batch_size, llvm::ConstantInt::get(i64, -lane_count));
+  entry_builder.CreateBr(loop_header);
+
+  llvm::IRBuilder<> header_builder(loop_header);
+  llvm::PHINode* index = header_builder.CreatePHI(i64, 2, "index");
+  index->addIncoming(llvm::ConstantInt::get(i64, 0), entry);
+  header_builder.CreateCondBr(header_builder.CreateICmpSLT(index, vector_end),
+                              loop_body, tail);
+
+  // Values are stored in memory as integers of their allocation size so load
+  // and store vectors of that width and truncate/extend to the XLS width.
+  llvm::IRBuilder<> body_builder(loop_body);
+  auto element_pointer = [&](llvm::Value* base, Type* type) {
+    llvm::Value* stride =
+        llvm::ConstantInt::get(i64, type_converter.GetTypeByteSize(type));
+    return body_builder.CreateGEP(body_builder.getInt8Ty(), base,
+                                  body_builder.CreateMul(index, stride));
+  };
+  auto storage_width = [&](Type* type) {
+    return type_converter.GetTypeByteSize(type) * 8;
+  };
+  LaneParallelEmitter emitter(lane_count, body_builder, jit_context);
+  absl::flat_hash_set<Node*> input_set(inputs.begin(), inputs.end());
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    Type* type = inputs[i]->GetType();
+    llvm::Value* loaded = body_builder.CreateAlignedLoad(
+        emitter.VectorType(storage_width(type)),
+        element_pointer(input_bases[i], type),
+        llvm::Align(type_converter.GetTypeAbiAlignment(type)));
+    emitter.SetValue(inputs[i], emitter.Resize(loaded, storage_width(type),
+                                               type->GetFlatBitCount()));
+  }
+  for (Node* node : TopoSort(function)) {
+    if (input_set.contains(node) || IsBlockOutput(node)) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(llvm::Value* value, emitter.EmitNode(node));
+    emitter.SetValue(node, value);
+  }
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    Type* type = OutputType(outputs[i]);
+    XLS_ASSIGN_OR_RETURN(
+        llvm::Value* value,
+        EmitOutputValue(outputs[i], emitter, body_builder, jit_context));
+    body_builder.CreateAlignedStore(
+        emitter.Resize(value, type->GetFlatBitCount(), storage_width(type)),
+        element_pointer(output_bases[i], type),
+        llvm::Align(type_converter.GetTypeAbiAlignment(type)));
+  }
+  index->addIncoming(
+      body_builder.CreateAdd(index, llvm::ConstantInt::get(i64, lane_count)),
+      loop_body);
+  body_builder.CreateBr(loop_header);
+
+  // Evaluate the remaining elements which do not fill a vector with the scalar
+  // batched function.
+  llvm::IRBuilder<> tail_builder(tail);
+  auto offset_pointer = [&](llvm::Value* base, Type* type) {
+    return tail_builder.CreateGEP(
+        tail_builder.getInt8Ty(), base,
+        tail_builder.CreateMul(
+            vector_end,
+            llvm::ConstantInt::get(i64, type_converter.GetTypeByteSize(type))));
+  };
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    StorePointer(i, offset_pointer(input_bases[i], inputs[i]->GetType()),
+                 tail_input_ptrs, tail_builder);
+  }
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    StorePointer(i, offset_pointer(output_bases[i], OutputType(outputs[i])),
+                 tail_output_ptrs, tail_builder);
+  }
+  tail_builder.CreateCall(
+      scalar_batched,
+      {tail_input_ptrs, tail_output_ptrs, fn->getArg(2), fn->getArg(3),
+       fn->getArg(4), fn->getArg(5),
+       tail_builder.CreateSub(batch_size, vector_end)});
+  tail_builder.CreateRet(llvm::ConstantInt::get(i64, 0));
+
+  return fn;
+}
+
+}  // namespace xls
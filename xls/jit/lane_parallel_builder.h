@@ -0,0 +1,62 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_LANE_PARALLEL_BUILDER_H_
+#define XLS_JIT_LANE_PARALLEL_BUILDER_H_
+
+#include <cstdint>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "llvm/include/llvm/IR/Function.h"
+#include "xls/ir/function_base.h"
+#include "xls/jit/ir_builder_visitor.h"
+
+namespace xls {
+
+// The maximum bit width of any value in a function compiled in lane-parallel
+// mode.
+inline constexpr int64_t kMaxLaneParallelBitWidth = 64;
+
+// Returns an error describing why `function` cannot be compiled in
+// lane-parallel mode, or OkStatus if it can. A function is lane-parallelizable
+// if every node produces a bits type of between 1 and kMaxLaneParallelBitWidth
+// bits and every operation is one of a supported set of side-effect free
+// operations (bitwise, arithmetic excluding division, comparisons, shifts,
+// selects, extensions, slices and concats). `function` may also be a block
+// without instantiations, in which case ports and registers are supported too.
+absl::Status CheckLaneParallelizable(FunctionBase* function);
+
+// Builds a function with the batched JitFunctionType signature (the final
+// argument is the batch size) which evaluates `function` across `lane_count`
+// batch elements at once. Each node is computed on LLVM vectors of type
+// <lane_count x iN> so a single vector instruction evaluates an operation for
+// all lanes. Inputs and outputs are in the structure-of-arrays layout used by
+// the batched wrapper. Any trailing batch elements which do not fill a full
+// vector are evaluated by calling `scalar_batched`, which must be the batched
+// wrapper of the scalar jitted function.
+//
+// For a block the inputs are the input ports followed by the register reads and
+// the outputs are the output ports followed by the register writes, as for the
+// scalar block JIT, so each batch element is one instance of the block.
+//
+// `lane_count` must be a power of two. CheckLaneParallelizable(function) must
+// hold.
+absl::StatusOr<llvm::Function*> BuildLaneParallelFunction(
+    FunctionBase* function, int64_t lane_count, llvm::Function* scalar_batched,
+    JitBuilderContext& jit_context);
+
+}  // namespace xls
+
+#endif  // XLS_JIT_LANE_PARALLEL_BUILDER_H_
@@ -0,0 +1,82 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/lane_parallel_builder.h"
+
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOk;
+using status_testing::StatusIs;
+using testing::HasSubstr;
+
+class LaneParallelBuilderTest : public IrTestBase {};
+
+TEST_F(LaneParallelBuilderTest, SupportedFunction) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(16));
+  BValue sum = fb.Add(x, fb.ZeroExtend(y, 32));
+  BValue cmp = fb.ULt(sum, fb.Literal(UBits(1000, 32)));
+  fb.Select(cmp, {fb.Shll(sum, y), fb.BitSlice(sum, 0, 32)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  EXPECT_THAT(CheckLaneParallelizable(f), IsOk());
+}
+
+TEST_F(LaneParallelBuilderTest, WideBits) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Not(fb.Param("x", p->GetBitsType(65)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  EXPECT_THAT(CheckLaneParallelizable(f),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("bit width 65")));
+}
+
+TEST_F(LaneParallelBuilderTest, AggregateType) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  fb.Tuple({x, x});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  EXPECT_THAT(CheckLaneParallelizable(f),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not of bits type")));
+}
+
+TEST_F(LaneParallelBuilderTest, UnsupportedOp) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  fb.UDiv(x, fb.Literal(UBits(3, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  EXPECT_THAT(CheckLaneParallelizable(f),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("unsupported operation udiv")));
+}
+
+}  // namespace
+}  // namespace xls
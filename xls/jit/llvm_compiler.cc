@@ -16,6 +16,7 @@
 
 #include <cerrno>
 #include <cstdint>
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -133,6 +134,14 @@ char BadOptLevelError::ID;
 
 }  // namespace
 
+int64_t LlvmCompiler::GetModuleOptLevel(const llvm::Module& module) const {
+  if (large_module_instruction_count_.has_value() &&
+      module.getInstructionCount() > *large_module_instruction_count_) {
+    return std::min(opt_level_, kLargeModuleOptLevel);
+  }
+  return opt_level_;
+}
+
 llvm::Error LlvmCompiler::PerformStandardOptimization(
     llvm::Module* bare_module) {
   // Follow the directions at llvm.org/docs/NewPassManager.html to run the
@@ -159,8 +168,17 @@ llvm::Error LlvmCompiler::PerformStandardOptimization(
   pass_builder.registerLoopAnalyses(lam);
   pass_builder.crossRegisterProxies(lam, fam, cgam, mam);
 
+  int64_t opt_level = GetModuleOptLevel(*bare_module);
+  if (opt_level != opt_level_) {
+    VLOG(1) << absl::StreamFormat(
+        "Module `%s` has %d instructions (budget %d); optimizing at level %d "
+        "instead of %d",
+        bare_module->getModuleIdentifier(),
+        bare_module->getInstructionCount(), *large_module_instruction_count_,
+        opt_level, opt_level_);
+  }
   llvm::OptimizationLevel llvm_opt_level;
-  switch (opt_level_) {
+  switch (opt_level) {
     case 0:
       llvm_opt_level = llvm::OptimizationLevel::O0;
       break;
@@ -174,7 +192,7 @@ llvm::Error LlvmCompiler::PerformStandardOptimization(
       llvm_opt_level = llvm::OptimizationLevel::O3;
       break;
     default:
-      return llvm::Error(std::make_unique<BadOptLevelError>(opt_level_));
+      return llvm::Error(std::make_unique<BadOptLevelError>(opt_level));
   }
   llvm::ModulePassManager mpm;
   if (llvm_opt_level == llvm::OptimizationLevel::O0) {
@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -42,6 +43,9 @@ class OrcJit;
 class LlvmCompiler {
  public:
   static constexpr int64_t kDefaultOptLevel = 3;
+  // The optimization level at which modules over the instruction budget (see
+  // set_large_module_instruction_count) are optimized.
+  static constexpr int64_t kLargeModuleOptLevel = 1;
   static void InitializeLlvm();
 
   virtual ~LlvmCompiler() = default;
@@ -89,6 +93,22 @@ class LlvmCompiler {
   int64_t opt_level() const { return opt_level_; }
   bool include_msan() const { return include_msan_; }
 
+  // Sets the compile-time budget of the optimizer. Modules with more LLVM
+  // instructions than `count` (before optimization) are optimized at no more
+  // than kLargeModuleOptLevel. Optimization cost grows superlinearly with
+  // function size at the higher levels so this bounds the startup time of very
+  // large designs while small ones still get opt_level(). std::nullopt (the
+  // default) optimizes every module at opt_level().
+  void set_large_module_instruction_count(std::optional<int64_t> count) {
+    large_module_instruction_count_ = count;
+  }
+  std::optional<int64_t> large_module_instruction_count() const {
+    return large_module_instruction_count_;
+  }
+
+  // Returns the optimization level `module` is optimized at.
+  int64_t GetModuleOptLevel(const llvm::Module& module) const;
+
  protected:
   absl::Status Init();
 
@@ -115,6 +135,7 @@ class LlvmCompiler {
   llvm::DataLayout data_layout_;
 
   int64_t opt_level_;
+  std::optional<int64_t> large_module_instruction_count_;
   // If the jitted code should include msan calls. Defaults to whatever 'this'
   // process is doing and should only be overridden for AOT generators.
   const bool include_msan_;
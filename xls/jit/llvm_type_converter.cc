@@ -112,7 +112,7 @@ absl::StatusOr<llvm::Constant*> LlvmTypeConverter::ToLlvmConstant(
 absl::StatusOr<llvm::Constant*> LlvmTypeConverter::ToLlvmConstant(
     llvm::Type* type, const Value& value) const {
   if (type->isIntegerTy()) {
-    return ToIntegralConstant(type, value);
+    return ToIntegralConstant(type, value.bits());
   }
   if (type->isStructTy()) {
     std::vector<llvm::Constant*> llvm_elements;
@@ -129,6 +129,19 @@ absl::StatusOr<llvm::Constant*> LlvmTypeConverter::ToLlvmConstant(
   if (type->isArrayTy()) {
     std::vector<llvm::Constant*> elements;
     llvm::Type* element_type = type->getArrayElementType();
+    if (value.IsPackedBitsArray()) {
+      // Read packed elements directly rather than boxing them.
+      elements.reserve(value.size());
+      for (int64_t i = 0; i < value.size(); ++i) {
+        XLS_ASSIGN_OR_RETURN(
+            llvm::Constant * llvm_element,
+            ToIntegralConstant(element_type, value.GetBitsElement(i)));
+        elements.push_back(llvm_element);
+      }
+      return llvm::ConstantArray::get(
+          llvm::ArrayType::get(element_type, type->getArrayNumElements()),
+          elements);
+    }
     for (const Value& element : value.elements()) {
       XLS_ASSIGN_OR_RETURN(llvm::Constant * llvm_element,
                            ToLlvmConstant(element_type, element));
@@ -164,9 +177,7 @@ llvm::Constant* LlvmTypeConverter::ZeroOfType(llvm::Type* type) {
 }
 
 absl::StatusOr<llvm::Constant*> LlvmTypeConverter::ToIntegralConstant(
-    llvm::Type* type, const Value& value) const {
-  const Bits& xls_bits = value.bits();
-
+    llvm::Type* type, const Bits& xls_bits) const {
   if (xls_bits.bit_count() > 64) {
     std::vector<uint8_t> bytes = xls_bits.ToBytes();
     bytes.resize(xls::RoundUpToNearest(bytes.size(), 8UL), 0);
@@ -178,7 +189,7 @@ absl::StatusOr<llvm::Constant*> LlvmTypeConverter::ToIntegralConstant(
     int64_t llvm_bit_count = GetLlvmBitCount(xls_bits.bit_count());
     return llvm::ConstantInt::get(type, llvm::APInt(llvm_bit_count, array_ref));
   }
-  XLS_ASSIGN_OR_RETURN(uint64_t bits, value.bits().ToUint64());
+  XLS_ASSIGN_OR_RETURN(uint64_t bits, xls_bits.ToUint64());
   return llvm::ConstantInt::get(type, bits);
 }
 
@@ -22,6 +22,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "llvm/include/llvm/IR/IRBuilder.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/jit/type_layout.h"
@@ -148,7 +149,7 @@ class LlvmTypeConverter {
 
   // Handles the special (and base) case of converting Bits types to LLVM.
   absl::StatusOr<llvm::Constant*> ToIntegralConstant(llvm::Type* type,
-                                                     const Value& value) const;
+                                                     const Bits& bits) const;
 
   // Helper method for computing the layouts of leaf elements for building a
   // TypeLayout object.
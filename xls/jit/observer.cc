@@ -14,14 +14,31 @@
 
 #include "xls/jit/observer.h"
 
+#include <cstdint>
+#include <string>
 #include <string_view>
 
 #include "absl/algorithm/container.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/Module.h"
 
 namespace xls {
 
+std::string_view JitCompilePhaseToString(JitCompilePhase phase) {
+  switch (phase) {
+    case JitCompilePhase::kIrBuilding:
+      return "ir_building";
+    case JitCompilePhase::kOptimization:
+      return "optimization";
+    case JitCompilePhase::kCodegen:
+      return "codegen";
+  }
+  return "unknown";
+}
+
 CompoundObserver::CompoundObserver(absl::Span<JitObserver* const> observers)
     : observers_(observers.begin(), observers.end()) {}
 
@@ -40,6 +57,11 @@ JitObserverRequests CompoundObserver::GetNotificationOptions() const {
                          [](auto* o) {
                            return o->GetNotificationOptions().assembly_code_str;
                          }),
+      .compile_phase_times = absl::c_any_of(
+          observers_,
+          [](auto* o) {
+            return o->GetNotificationOptions().compile_phase_times;
+          }),
   };
 }
 void CompoundObserver::UnoptimizedModule(const llvm::Module* module) {
@@ -65,5 +87,37 @@ void CompoundObserver::AssemblyCodeString(const llvm::Module* module,
   }
 }
 
+void CompoundObserver::CompilePhaseTime(JitCompilePhase phase,
+                                        absl::Duration duration) {
+  for (auto* o : observers_) {
+    if (o->GetNotificationOptions().compile_phase_times) {
+      o->CompilePhaseTime(phase, duration);
+    }
+  }
+}
+
 void CompoundObserver::AddObserver(JitObserver* o) { observers_.push_back(o); }
+
+void JitCompileTimeObserver::CompilePhaseTime(JitCompilePhase phase,
+                                              absl::Duration duration) {
+  absl::MutexLock lock(&mutex_);
+  totals_[static_cast<int64_t>(phase)] += duration;
+}
+
+absl::Duration JitCompileTimeObserver::GetTotal(JitCompilePhase phase) const {
+  absl::MutexLock lock(&mutex_);
+  return totals_[static_cast<int64_t>(phase)];
+}
+
+std::string JitCompileTimeObserver::ToString() const {
+  std::string result;
+  for (JitCompilePhase phase :
+       {JitCompilePhase::kIrBuilding, JitCompilePhase::kOptimization,
+        JitCompilePhase::kCodegen}) {
+    absl::StrAppend(&result, JitCompilePhaseToString(phase), ": ",
+                    absl::ToInt64Nanoseconds(GetTotal(phase)), "\n");
+  }
+  return result;
+}
+
 }  // namespace xls
@@ -15,15 +15,34 @@
 #ifndef XLS_JIT_OBSERVER_H_
 #define XLS_JIT_OBSERVER_H_
 
+#include <array>
+#include <cstdint>
+#include <string>
 #include <string_view>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/Module.h"
 
 namespace xls {
 
+// The phases of compiling a FunctionBase with the JIT.
+enum class JitCompilePhase : uint8_t {
+  // Building the LLVM IR from the XLS IR.
+  kIrBuilding,
+  // Running the LLVM optimization pipeline.
+  kOptimization,
+  // Generating machine code from the optimized LLVM IR.
+  kCodegen,
+};
+inline constexpr int64_t kJitCompilePhaseCount = 3;
+
+std::string_view JitCompilePhaseToString(JitCompilePhase phase);
+
 // All the things an observer can handle. Setting these flags tells users that
 // they do not need to call the observer methods. They should be considered
 // purely advisory however.
@@ -34,6 +53,8 @@ struct JitObserverRequests {
   bool optimized_module = false;
   // Do we want to get called with optimized asm code.
   bool assembly_code_str = false;
+  // Do we want to get called with the time spent in each compile phase.
+  bool compile_phase_times = false;
 };
 
 // Basic observer for JIT compilation events
@@ -49,6 +70,11 @@ class JitObserver {
   // Called when a LLVM module has been compiled with the module code.
   virtual void AssemblyCodeString(const llvm::Module* module,
                                   std::string_view asm_code) {}
+  // Called with the wall time spent in a phase of compilation. Optimization and
+  // codegen are reported once per module compiled, which may be several per
+  // FunctionBase (and from several threads) when compiling concurrently.
+  virtual void CompilePhaseTime(JitCompilePhase phase,
+                                absl::Duration duration) {}
 };
 
 // A compound observer that lets one trigger multiple observers at once.
@@ -61,6 +87,7 @@ class CompoundObserver final : public JitObserver {
   void OptimizedModule(const llvm::Module* module) final;
   void AssemblyCodeString(const llvm::Module* module,
                           std::string_view asm_code) final;
+  void CompilePhaseTime(JitCompilePhase phase, absl::Duration duration) final;
 
   void AddObserver(JitObserver* o);
 
@@ -68,6 +95,25 @@ class CompoundObserver final : public JitObserver {
   std::vector<JitObserver*> observers_;
 };
 
+// An observer which totals the time spent in each phase of compilation.
+class JitCompileTimeObserver final : public JitObserver {
+ public:
+  JitObserverRequests GetNotificationOptions() const final {
+    return JitObserverRequests{.compile_phase_times = true};
+  }
+  void CompilePhaseTime(JitCompilePhase phase, absl::Duration duration) final;
+
+  absl::Duration GetTotal(JitCompilePhase phase) const;
+
+  // Returns one `<phase>: <nanoseconds>` line per phase.
+  std::string ToString() const;
+
+ private:
+  mutable absl::Mutex mutex_;
+  std::array<absl::Duration, kJitCompilePhaseCount> totals_
+      ABSL_GUARDED_BY(mutex_);
+};
+
 }  // namespace xls
 
 #endif  // XLS_JIT_OBSERVER_H_
@@ -14,21 +14,34 @@
 
 #include "xls/jit/orc_jit.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/strip.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "llvm/include/llvm/ADT/SmallVector.h"
 #include "llvm/include/llvm/Analysis/CGSCCPassManager.h"
+#include "llvm/include/llvm/Bitcode/BitcodeReader.h"
+#include "llvm/include/llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/include/llvm/ExecutionEngine/JITEventListener.h"
+#include "llvm/include/llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ExecutionUtils.h"
@@ -37,38 +50,142 @@
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRTransformLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Layer.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/Mangling.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Shared/ExecutorAddress.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Shared/ExecutorSymbolDef.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/TaskDispatch.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/include/llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/include/llvm/IR/BasicBlock.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
+#include "llvm/include/llvm/IR/Function.h"
 #include "llvm/include/llvm/IR/Instruction.h"
+#include "llvm/include/llvm/IR/LLVMContext.h"
 #include "llvm/include/llvm/IR/LegacyPassManager.h"
 #include "llvm/include/llvm/IR/Module.h"
 #include "llvm/include/llvm/IRPrinter/IRPrintingPasses.h"
 #include "llvm/include/llvm/Passes/PassBuilder.h"
 #include "llvm/include/llvm/Support/CodeGen.h"
 #include "llvm/include/llvm/Support/Error.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "llvm/include/llvm/Transforms/Instrumentation/MemorySanitizer.h"
+#include "llvm/include/llvm/Transforms/Utils/SplitModule.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/jit/jit_emulated_tls.h"  // NOLINT: Used with MSAN
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 
 namespace xls {
+namespace {
+
+std::atomic<int64_t> default_compile_thread_count = 1;
+
+std::atomic<JitProfiler> default_profiler = JitProfiler::kNone;
+
+// A value of zero or less means modules are not subject to an instruction
+// budget.
+std::atomic<int64_t> default_large_module_instruction_count =
+    OrcJit::kDefaultLargeModuleInstructionCount;
+
+// The number of partitions per compile thread a module is split into when
+// compiling concurrently. More partitions than threads balances load between
+// threads as partitions vary considerably in size.
+constexpr int64_t kPartitionsPerCompileThread = 4;
+
+// Runs ORC tasks (e.g., materializing a module) on a fixed number of threads.
+class ThreadPoolTaskDispatcher : public llvm::orc::TaskDispatcher {
+ public:
+  explicit ThreadPoolTaskDispatcher(int64_t thread_count) {
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads_.push_back(std::make_unique<Thread>([this]() { WorkerLoop(); }));
+    }
+  }
+  ~ThreadPoolTaskDispatcher() override { shutdown(); }
+
+  void dispatch(std::unique_ptr<llvm::orc::Task> task) final {
+    absl::MutexLock lock(&mutex_);
+    tasks_.push_back(std::move(task));
+  }
+
+  // Waits for all outstanding tasks, including any they dispatch, to finish.
+  void shutdown() final {
+    {
+      absl::MutexLock lock(&mutex_);
+      shutdown_ = true;
+    }
+    for (std::unique_ptr<Thread>& thread : threads_) {
+      thread->Join();
+    }
+    threads_.clear();
+  }
+
+ private:
+  void WorkerLoop() {
+    while (true) {
+      std::unique_ptr<llvm::orc::Task> task;
+      {
+        absl::MutexLock lock(&mutex_);
+        auto task_or_shutdown = [&]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+          return shutdown_ || !tasks_.empty();
+        };
+        mutex_.Await(absl::Condition(&task_or_shutdown));
+        if (tasks_.empty()) {
+          // Tasks only run on worker threads so there is nothing left to do
+          // once the queue is drained after shutdown.
+          if (busy_count_ == 0) {
+            return;
+          }
+          auto task_or_idle = [&]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+            return !tasks_.empty() || busy_count_ == 0;
+          };
+          mutex_.Await(absl::Condition(&task_or_idle));
+          continue;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+        ++busy_count_;
+      }
+      task->run();
+      task.reset();
+      absl::MutexLock lock(&mutex_);
+      --busy_count_;
+    }
+  }
+
+  absl::Mutex mutex_;
+  std::deque<std::unique_ptr<llvm::orc::Task>> tasks_ ABSL_GUARDED_BY(mutex_);
+  // The number of tasks currently running.
+  int64_t busy_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+  std::vector<std::unique_ptr<Thread>> threads_;
+};
+
+std::unique_ptr<llvm::orc::ExecutorProcessControl> CreateExecutorProcessControl(
+    int64_t compile_thread_count) {
+  if (compile_thread_count <= 1) {
+    return std::make_unique<llvm::orc::UnsupportedExecutorProcessControl>();
+  }
+  return std::make_unique<llvm::orc::UnsupportedExecutorProcessControl>(
+      /*SSP=*/nullptr,
+      std::make_unique<ThreadPoolTaskDispatcher>(compile_thread_count));
+}
 
-OrcJit::OrcJit(int64_t opt_level, bool include_msan)
+}  // namespace
+
+OrcJit::OrcJit(int64_t opt_level, bool include_msan,
+               int64_t compile_thread_count)
     : LlvmCompiler(opt_level, include_msan),
       context_(std::make_unique<llvm::LLVMContext>()),
-      execution_session_(
-          std::make_unique<llvm::orc::UnsupportedExecutorProcessControl>()),
+      execution_session_(CreateExecutorProcessControl(compile_thread_count)),
       object_layer_(
           execution_session_,
           []() { return std::make_unique<llvm::SectionMemoryManager>(); }),
-      dylib_(execution_session_.createBareJITDylib("main")) {}
+      dylib_(execution_session_.createBareJITDylib("main")),
+      compile_thread_count_(std::max<int64_t>(compile_thread_count, 1)) {}
 
 OrcJit::~OrcJit() {
   if (auto err = execution_session_.endSession()) {
@@ -88,10 +205,13 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
     jit_observer_->UnoptimizedModule(bare_module);
   }
 
+  absl::Time optimization_start = absl::Now();
   auto error = PerformStandardOptimization(bare_module);
   if (error) {
     return llvm::Expected<llvm::orc::ThreadSafeModule>(std::move(error));
   }
+  ReportCompilePhaseTime(JitCompilePhase::kOptimization,
+                         absl::Now() - optimization_start);
 
   VLOG(2) << "Optimized module IR:";
   XLS_VLOG_LINES(2, DumpLlvmModuleToString(bare_module));
@@ -111,12 +231,15 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
     // are declared.
     llvm::SmallVector<char, 0> stream_buffer;
     llvm::raw_svector_ostream ostream(stream_buffer);
-    llvm::legacy::PassManager mpm;
-    if (target_machine_->addPassesToEmitFile(
-            mpm, ostream, nullptr, llvm::CodeGenFileType::AssemblyFile)) {
-      VLOG(3) << "Could not create ASM generation pass!";
+    {
+      absl::MutexLock lock(&target_machine_mutex_);
+      llvm::legacy::PassManager mpm;
+      if (target_machine_->addPassesToEmitFile(
+              mpm, ostream, nullptr, llvm::CodeGenFileType::AssemblyFile)) {
+        VLOG(3) << "Could not create ASM generation pass!";
+      }
+      mpm.run(*bare_module);
     }
-    mpm.run(*bare_module);
     VLOG(3) << "Generated ASM:";
     std::string asm_code(stream_buffer.begin(), stream_buffer.end());
     XLS_VLOG_LINES(3, asm_code);
@@ -128,23 +251,93 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
   return module;
 }
 
-absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(int64_t opt_level,
-                                                       JitObserver* observer) {
+absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(
+    int64_t opt_level, JitObserver* observer,
+    std::optional<int64_t> compile_thread_count) {
   LlvmCompiler::InitializeLlvm();
 #ifdef ABSL_HAVE_MEMORY_SANITIZER
   constexpr bool kHasMsan = true;
 #else
   constexpr bool kHasMsan = false;
 #endif
-  std::unique_ptr<OrcJit> jit =
-      absl::WrapUnique(new OrcJit(opt_level, kHasMsan));
+  std::unique_ptr<OrcJit> jit = absl::WrapUnique(new OrcJit(
+      opt_level, kHasMsan,
+      compile_thread_count.value_or(GetDefaultCompileThreadCount())));
   jit->SetJitObserver(observer);
+  jit->SetObjectCache(GetDefaultJitObjectCache());
+  jit->profiler_ = GetDefaultProfiler();
+  if (int64_t count = GetDefaultLargeModuleInstructionCount(); count > 0) {
+    jit->set_large_module_instruction_count(count);
+  }
   XLS_RETURN_IF_ERROR(jit->Init());
   return std::move(jit);
 }
 
-absl::StatusOr<std::unique_ptr<llvm::TargetMachine>>
-OrcJit::CreateTargetMachine() {
+void OrcJit::SetDefaultCompileThreadCount(int64_t thread_count) {
+  default_compile_thread_count.store(thread_count);
+}
+
+int64_t OrcJit::GetDefaultCompileThreadCount() {
+  return default_compile_thread_count.load();
+}
+
+void OrcJit::SetDefaultProfiler(JitProfiler profiler) {
+  default_profiler.store(profiler);
+}
+
+JitProfiler OrcJit::GetDefaultProfiler() { return default_profiler.load(); }
+
+void OrcJit::SetDefaultLargeModuleInstructionCount(int64_t count) {
+  default_large_module_instruction_count.store(count);
+}
+
+int64_t OrcJit::GetDefaultLargeModuleInstructionCount() {
+  return default_large_module_instruction_count.load();
+}
+
+void OrcJit::ReportCompilePhaseTime(JitCompilePhase phase,
+                                    absl::Duration duration) {
+  VLOG(2) << absl::StreamFormat("JIT %s took %s",
+                                JitCompilePhaseToString(phase),
+                                absl::FormatDuration(duration));
+  if (jit_observer_ != nullptr &&
+      jit_observer_->GetNotificationOptions().compile_phase_times) {
+    jit_observer_->CompilePhaseTime(phase, duration);
+  }
+}
+
+absl::Status OrcJit::RegisterProfiler() {
+  // The listeners are process-wide singletons owned by LLVM. The factories
+  // return nullptr if LLVM was built without support for the profiler.
+  llvm::JITEventListener* listener = nullptr;
+  switch (profiler_) {
+    case JitProfiler::kNone:
+      return absl::OkStatus();
+    case JitProfiler::kPerf:
+      listener = llvm::JITEventListener::createPerfJITEventListener();
+      if (listener == nullptr) {
+        return absl::UnimplementedError(
+            "perf JIT profiling is not supported: LLVM was built without "
+            "LLVM_USE_PERF");
+      }
+      break;
+    case JitProfiler::kIntelJitEvents:
+      listener = llvm::JITEventListener::createIntelJITEventListener();
+      if (listener == nullptr) {
+        return absl::UnimplementedError(
+            "Intel JIT profiling is not supported: LLVM was built without "
+            "LLVM_USE_INTEL_JITEVENTS");
+      }
+      break;
+  }
+  // Objects loaded from the object cache also pass through the object layer
+  // so they are registered as well.
+  object_layer_.registerJITEventListener(*listener);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<llvm::orc::JITTargetMachineBuilder>
+OrcJit::CreateTargetMachineBuilder() {
   auto error_or_target_builder =
       llvm::orc::JITTargetMachineBuilder::detectHost();
   if (!error_or_target_builder) {
@@ -152,9 +345,15 @@ OrcJit::CreateTargetMachine() {
         absl::StrCat("Unable to detect host: ",
                      llvm::toString(error_or_target_builder.takeError())));
   }
-
   error_or_target_builder->setRelocationModel(llvm::Reloc::Model::PIC_);
-  auto error_or_target_machine = error_or_target_builder->createTargetMachine();
+  return std::move(error_or_target_builder.get());
+}
+
+absl::StatusOr<std::unique_ptr<llvm::TargetMachine>>
+OrcJit::CreateTargetMachine() {
+  XLS_ASSIGN_OR_RETURN(llvm::orc::JITTargetMachineBuilder target_builder,
+                       CreateTargetMachineBuilder());
+  auto error_or_target_machine = target_builder.createTargetMachine();
   if (!error_or_target_machine) {
     return absl::InternalError(
         absl::StrCat("Unable to create target machine: ",
@@ -203,6 +402,67 @@ class MsanHostEmuTls : public llvm::orc::DefinitionGenerator {
   }
 };
 
+// Prefix of the identifier given to modules whose compiled object should be
+// added to the persistent object cache. The remainder is the cache key.
+constexpr std::string_view kObjectCacheKeyPrefix = "__xls_object_cache_";
+
+// Adds objects compiled from modules tagged with a cache key to the persistent
+// object cache. Lookups happen in OrcJit::CompileModule before the module is
+// optimized so this never provides objects itself.
+class ObjectCacheWriter : public llvm::ObjectCache {
+ public:
+  explicit ObjectCacheWriter(const OrcJit* jit) : jit_(jit) {}
+
+  void notifyObjectCompiled(const llvm::Module* module,
+                            llvm::MemoryBufferRef object) final {
+    std::string_view identifier = module->getModuleIdentifier();
+    if (jit_->object_cache() == nullptr ||
+        !absl::ConsumePrefix(&identifier, kObjectCacheKeyPrefix)) {
+      return;
+    }
+    absl::Status status = jit_->object_cache()->Insert(
+        identifier,
+        std::string_view(object.getBufferStart(), object.getBufferSize()));
+    if (!status.ok()) {
+      LOG(WARNING) << "Unable to write JIT object cache entry: " << status;
+    }
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer> getObject(
+      const llvm::Module* module) final {
+    return nullptr;
+  }
+
+ private:
+  const OrcJit* jit_;
+};
+
+// Reports the time taken by `compiler` to generate the machine code of each
+// module as the codegen phase of the JIT.
+class TimedIRCompiler : public llvm::orc::IRCompileLayer::IRCompiler {
+ public:
+  TimedIRCompiler(
+      std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler> compiler,
+      OrcJit* jit)
+      : IRCompiler(compiler->getManglingOptions()),
+        compiler_(std::move(compiler)),
+        jit_(jit) {}
+
+  llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> operator()(
+      llvm::Module& module) final {
+    absl::Time start = absl::Now();
+    llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> object =
+        (*compiler_)(module);
+    jit_->ReportCompilePhaseTime(JitCompilePhase::kCodegen,
+                                 absl::Now() - start);
+    return object;
+  }
+
+ private:
+  std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler> compiler_;
+  OrcJit* jit_;
+};
+
 }  // namespace
 
 absl::Status OrcJit::InitInternal() {
@@ -213,9 +473,24 @@ absl::Status OrcJit::InitInternal() {
             data_layout_.getGlobalPrefix())));
   });
 
-  auto compiler = std::make_unique<llvm::orc::SimpleCompiler>(*target_machine_);
+  XLS_RETURN_IF_ERROR(RegisterProfiler());
+
+  object_cache_writer_ = std::make_unique<ObjectCacheWriter>(this);
+  std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler> compiler;
+  if (compile_thread_count_ > 1) {
+    // SimpleCompiler shares `target_machine_` between all compilations so
+    // concurrent compilation requires a target machine per compile.
+    XLS_ASSIGN_OR_RETURN(llvm::orc::JITTargetMachineBuilder target_builder,
+                         CreateTargetMachineBuilder());
+    compiler = std::make_unique<llvm::orc::ConcurrentIRCompiler>(
+        std::move(target_builder), object_cache_writer_.get());
+  } else {
+    compiler = std::make_unique<llvm::orc::SimpleCompiler>(
+        *target_machine_, object_cache_writer_.get());
+  }
   compile_layer_ = std::make_unique<llvm::orc::IRCompileLayer>(
-      execution_session_, object_layer_, std::move(compiler));
+      execution_session_, object_layer_,
+      std::make_unique<TimedIRCompiler>(std::move(compiler), this));
 
   llvm::orc::IRLayer* parent_layer =
       static_cast<llvm::orc::IRLayer*>(compile_layer_.get());
@@ -231,8 +506,111 @@ absl::Status OrcJit::InitInternal() {
 
 absl::Status OrcJit::CompileModule(std::unique_ptr<llvm::Module>&& module) {
   XLS_RETURN_IF_ERROR(VerifyModule(*module));
+  if (compile_thread_count_ > 1) {
+    return CompileModuleConcurrently(std::move(module));
+  }
+  return AddModule(std::move(module), context_);
+}
+
+absl::Status OrcJit::CompileModuleConcurrently(
+    std::unique_ptr<llvm::Module> module) {
+  int64_t function_count = 0;
+  for (const llvm::Function& function : *module) {
+    if (!function.isDeclaration()) {
+      ++function_count;
+    }
+  }
+  int64_t partition_count = std::clamp<int64_t>(
+      function_count, 1, kPartitionsPerCompileThread * compile_thread_count_);
+  std::vector<std::unique_ptr<llvm::Module>> partitions;
+  llvm::SplitModule(*module, partition_count,
+                    [&](std::unique_ptr<llvm::Module> partition) {
+                      partitions.push_back(std::move(partition));
+                    });
+  module.reset();
+
+  llvm::orc::MangleAndInterner mangle(execution_session_, data_layout_);
+  llvm::orc::SymbolLookupSet symbols;
+  for (std::unique_ptr<llvm::Module>& partition : partitions) {
+    // ORC locks the context of a module while operating on it so partitions
+    // must each live in their own context to be compiled concurrently. Moving
+    // a module between contexts requires a round trip through bitcode.
+    llvm::SmallVector<char, 0> bitcode;
+    llvm::raw_svector_ostream ostream(bitcode);
+    llvm::WriteBitcodeToFile(*partition, ostream);
+    std::string identifier = partition->getModuleIdentifier();
+    partition.reset();
+
+    llvm::orc::ThreadSafeContext context(std::make_unique<llvm::LLVMContext>());
+    llvm::Expected<std::unique_ptr<llvm::Module>> error_or_module =
+        llvm::parseBitcodeFile(
+            llvm::MemoryBufferRef(
+                llvm::StringRef(bitcode.data(), bitcode.size()), identifier),
+            *context.getContext());
+    if (!error_or_module) {
+      return absl::InternalError(
+          absl::StrCat("Unable to copy module partition: ",
+                       llvm::toString(error_or_module.takeError())));
+    }
+    for (const llvm::Function& function : **error_or_module) {
+      if (!function.isDeclaration() && function.hasExternalLinkage()) {
+        symbols.add(mangle(function.getName()));
+      }
+    }
+    XLS_RETURN_IF_ERROR(
+        AddModule(std::move(error_or_module.get()), std::move(context)));
+  }
+
+  // Adding a module only registers it with the JIT. Look up every partition's
+  // symbols at once so all of them are materialized concurrently by the task
+  // dispatcher rather than on demand, one dependency chain at a time.
+  llvm::Expected<llvm::orc::SymbolMap> materialized = execution_session_.lookup(
+      llvm::orc::makeJITDylibSearchOrder(&dylib_), std::move(symbols));
+  if (!materialized) {
+    return absl::UnknownError(
+        absl::StrFormat("Error compiling converted IR: %s",
+                        llvm::toString(materialized.takeError())));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status OrcJit::AddModule(std::unique_ptr<llvm::Module> module,
+                               llvm::orc::ThreadSafeContext context) {
+  if (object_cache_ != nullptr) {
+    // Key on the level the module is actually optimized at so that objects
+    // compiled under the instruction budget are never served to a JIT
+    // without one (and vice versa). This must be computed on the module as
+    // it is handed to the transform layer, as PerformStandardOptimization
+    // does.
+    int64_t effective_opt_level = GetModuleOptLevel(*module);
+    std::string key = JitObjectCache::ComputeKey(
+        DumpLlvmModuleToString(module.get()),
+        {.opt_level = effective_opt_level,
+         .include_msan = include_msan_,
+         .target_triple = target_machine_->getTargetTriple().str(),
+         .target_cpu = target_machine_->getTargetCPU().str(),
+         .target_features = target_machine_->getTargetFeatureString().str()});
+    absl::StatusOr<std::optional<std::string>> cached =
+        object_cache_->Lookup(key);
+    if (!cached.ok()) {
+      LOG(WARNING) << "Unable to read JIT object cache entry: "
+                   << cached.status();
+    } else if (cached->has_value()) {
+      VLOG(1) << "Loading JIT object code from cache entry " << key;
+      llvm::Error error = object_layer_.add(
+          dylib_, llvm::MemoryBuffer::getMemBufferCopy(**cached, key));
+      if (error) {
+        return absl::UnknownError(
+            absl::StrFormat("Error loading cached object code: %s",
+                            llvm::toString(std::move(error))));
+      }
+      return absl::OkStatus();
+    }
+    module->setModuleIdentifier(absl::StrCat(kObjectCacheKeyPrefix, key));
+  }
   llvm::Error error = transform_layer_->add(
-      dylib_, llvm::orc::ThreadSafeModule(std::move(module), context_));
+      dylib_,
+      llvm::orc::ThreadSafeModule(std::move(module), std::move(context)));
   if (error) {
     return absl::UnknownError(absl::StrFormat(
         "Error compiling converted IR: %s", llvm::toString(std::move(error))));
@@ -22,9 +22,13 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "llvm/include/llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRCompileLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRTransformLayer.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Shared/ExecutorAddress.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
@@ -32,10 +36,25 @@
 #include "llvm/include/llvm/Support/Error.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "llvm/include/llvm/Target/TargetMachine.h"
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 
 namespace xls {
+
+// External profilers which can be told about the code emitted by the JIT so
+// that samples in jitted code are attributed to symbols rather than to
+// anonymous addresses.
+enum class JitProfiler : int8_t {
+  kNone,
+  // Writes /tmp/perf-<pid>.map and a jitdump file for `perf inject --jit`.
+  // Requires LLVM to be built with LLVM_USE_PERF.
+  kPerf,
+  // Registers code with Intel VTune through the JIT profiling API. Requires
+  // LLVM to be built with LLVM_USE_INTEL_JITEVENTS.
+  kIntelJitEvents,
+};
+
 // A wrapper around ORC JIT which hides some of the internals of the LLVM
 // interface.
 class OrcJit : public LlvmCompiler {
@@ -51,13 +70,58 @@ class OrcJit : public LlvmCompiler {
   // compiler should use the 3-argument version above. Passing nullopt to
   // emit_msan directs the jit to use MSAN if the running binary is MSAN and
   // vice-versa.
+  //
+  // `compile_thread_count` is the number of threads used to optimize and
+  // compile each module passed to CompileModule. If std::nullopt,
+  // GetDefaultCompileThreadCount() is used. With more than one thread each
+  // module is split into per-function partitions which are compiled
+  // concurrently and linked together in the JIT dylib. This reduces startup
+  // time for large designs at the cost of cross-partition inlining. In this
+  // mode the observer may be notified concurrently from several threads.
   static absl::StatusOr<std::unique_ptr<OrcJit>> Create(
-      int64_t opt_level = kDefaultOptLevel, JitObserver* observer = nullptr);
+      int64_t opt_level = kDefaultOptLevel, JitObserver* observer = nullptr,
+      std::optional<int64_t> compile_thread_count = std::nullopt);
+
+  // Sets the number of compile threads used by subsequently created OrcJits
+  // which do not specify one. Values less than or equal to one mean modules
+  // are compiled serially on the calling thread, which is the default.
+  static void SetDefaultCompileThreadCount(int64_t thread_count);
+  static int64_t GetDefaultCompileThreadCount();
+
+  // Sets the profiler with which subsequently created OrcJits register the
+  // functions they emit. Symbols are named after the XLS function or proc
+  // they implement (see JitBuilderContext::MangleFunctionName). Creating an
+  // OrcJit fails if LLVM was built without support for the profiler.
+  static void SetDefaultProfiler(JitProfiler profiler);
+  static JitProfiler GetDefaultProfiler();
+
+  // The default instruction budget of subsequently created OrcJits (see
+  // LlvmCompiler::set_large_module_instruction_count). Values less than or
+  // equal to zero disable the budget so every module is optimized at the
+  // requested level. With concurrent compilation the budget applies to each
+  // module partition, i.e. to a group of functions.
+  static constexpr int64_t kDefaultLargeModuleInstructionCount = 500000;
+  static void SetDefaultLargeModuleInstructionCount(int64_t count);
+  static int64_t GetDefaultLargeModuleInstructionCount();
 
   void SetJitObserver(JitObserver* o) { jit_observer_ = o; }
 
   JitObserver* jit_observer() const { return jit_observer_; }
 
+  // Passes the time spent in a phase of compilation to the observer if it
+  // requested compile phase times. May be called concurrently.
+  void ReportCompilePhaseTime(JitCompilePhase phase, absl::Duration duration);
+
+  // Sets the persistent object cache consulted by CompileModule. Defaults to
+  // GetDefaultJitObjectCache(). Passing nullptr disables caching. Must be
+  // called before CompileModule. When a module is found in the cache the
+  // observer is not notified of the (skipped) optimization and codegen steps.
+  void SetObjectCache(JitObjectCache* cache) { object_cache_ = cache; }
+
+  JitObjectCache* object_cache() const { return object_cache_; }
+
+  int64_t compile_thread_count() const { return compile_thread_count_; }
+
   // Compiles the given LLVM module into the JIT's execution session.
   absl::Status CompileModule(std::unique_ptr<llvm::Module>&& module) override;
 
@@ -75,7 +139,23 @@ class OrcJit : public LlvmCompiler {
   absl::Status InitInternal() override;
 
  private:
-  OrcJit(int64_t opt_level, bool include_msan);
+  OrcJit(int64_t opt_level, bool include_msan, int64_t compile_thread_count);
+
+  // Registers the event listener of `profiler_` with the object layer.
+  absl::Status RegisterProfiler();
+
+  // Returns a builder for target machines matching the host.
+  static absl::StatusOr<llvm::orc::JITTargetMachineBuilder>
+  CreateTargetMachineBuilder();
+
+  // Adds `module` to the transform layer, or adds its object code directly to
+  // the object layer if it is present in the object cache.
+  absl::Status AddModule(std::unique_ptr<llvm::Module> module,
+                         llvm::orc::ThreadSafeContext context);
+
+  // Splits `module` into partitions each in their own LLVM context, adds them
+  // to the JIT and materializes them all concurrently.
+  absl::Status CompileModuleConcurrently(std::unique_ptr<llvm::Module> module);
 
   // Method which optimizes the given module. Used within the JIT to form an IR
   // transform layer.
@@ -88,11 +168,23 @@ class OrcJit : public LlvmCompiler {
   llvm::orc::RTDyldObjectLinkingLayer object_layer_;
   llvm::orc::JITDylib& dylib_;
 
+  // Writes compiled objects to `object_cache_`.
+  std::unique_ptr<llvm::ObjectCache> object_cache_writer_;
   std::unique_ptr<llvm::orc::IRCompileLayer> compile_layer_;
   std::unique_ptr<llvm::orc::IRTransformLayer> transform_layer_;
 
   JitObserver* jit_observer_ = nullptr;
 
+  JitObjectCache* object_cache_ = nullptr;
+
+  int64_t compile_thread_count_;
+
+  JitProfiler profiler_ = JitProfiler::kNone;
+
+  // Guards use of `target_machine_` for assembly generation in Optimizer,
+  // which may run concurrently when compiling with multiple threads.
+  absl::Mutex target_machine_mutex_;
+
   // If the jitted code should include msan calls. Defaults to whatever 'this'
   // process is doing and should only be overridden for AOT generators.
   bool include_msan_;
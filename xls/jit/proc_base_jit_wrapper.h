@@ -37,9 +37,9 @@
 #include "xls/ir/proc.h"
 #include "xls/ir/value.h"
 #include "xls/jit/aot_entrypoint.pb.h"
+#include "xls/jit/aot_proc_runtime.h"
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_channel_queue.h"
-#include "xls/jit/jit_proc_runtime.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/public/ir_parser.h"
 
@@ -32,6 +32,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -51,10 +52,24 @@
 #include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
 namespace xls {
 
 namespace {
 
+// Returns a timestamp for measuring the time spent in a proc: the time-stamp
+// counter on x86, nanoseconds elsewhere.
+int64_t ReadCycleCounter() {
+#if defined(__x86_64__) || defined(__i386__)
+  return static_cast<int64_t>(__rdtsc());
+#else
+  return absl::GetCurrentTimeNanos();
+#endif
+}
+
 // A continuation used by the ProcJit. Stores control and data state of proc
 // execution for the JIT.
 class ProcJitContinuation : public ProcContinuation {
@@ -72,6 +87,7 @@ class ProcJitContinuation : public ProcContinuation {
   ~ProcJitContinuation() override = default;
 
   std::vector<Value> GetState() const override;
+  absl::Status SetState(std::vector<Value> state) override;
   const InterpreterEvents& GetEvents() const override { return events_; }
   InterpreterEvents& GetEvents() override { return events_; }
   void ClearEvents() override { events_.Clear(); }
@@ -98,6 +114,18 @@ class ProcJitContinuation : public ProcContinuation {
 
   InstanceContext* instance_context() { return &instance_context_; }
 
+  bool EnablePerformanceCounters() override;
+  std::optional<ProcPerformanceCounters> GetPerformanceCounters()
+      const override;
+
+  // Returns the counters updated by ProcJit::Tick or nullptr if performance
+  // counters are not enabled. Channel operations are counted separately in the
+  // instance context.
+  ProcPerformanceCounters* performance_counters() {
+    return performance_counters_.has_value() ? &*performance_counters_
+                                             : nullptr;
+  }
+
  private:
   int64_t continuation_point_;
   JitRuntime* jit_runtime_;
@@ -113,6 +141,8 @@ class ProcJitContinuation : public ProcContinuation {
   // Data structure passed to the JIT function which holds instance related
   // information.
   InstanceContext instance_context_;
+
+  std::optional<ProcPerformanceCounters> performance_counters_;
 };
 
 ProcJitContinuation::ProcJitContinuation(ProcInstance* proc_instance,
@@ -149,6 +179,52 @@ std::vector<Value> ProcJitContinuation::GetState() const {
   return state;
 }
 
+absl::Status ProcJitContinuation::SetState(std::vector<Value> state) {
+  XLS_RET_CHECK(AtStartOfTick());
+  XLS_RET_CHECK_EQ(state.size(), proc()->GetStateElementCount());
+  for (Param* state_param : proc()->StateParams()) {
+    int64_t param_index = proc()->GetParamIndex(state_param).value();
+    int64_t state_index = proc()->GetStateParamIndex(state_param).value();
+    jit_runtime_->BlitValueToBuffer(
+        state[state_index], state_param->GetType(),
+        absl::Span<uint8_t>(
+            input_.pointers()[param_index],
+            jit_runtime_->GetTypeByteSize(state_param->GetType())));
+  }
+  return absl::OkStatus();
+}
+
+bool ProcJitContinuation::EnablePerformanceCounters() {
+  if (!performance_counters_.has_value()) {
+    performance_counters_.emplace();
+    int64_t queue_count = instance_context_.channel_queues.size();
+    instance_context_.send_counts.assign(queue_count, 0);
+    instance_context_.receive_counts.assign(queue_count, 0);
+    instance_context_.count_channel_operations = true;
+  }
+  return true;
+}
+
+std::optional<ProcPerformanceCounters>
+ProcJitContinuation::GetPerformanceCounters() const {
+  if (!performance_counters_.has_value()) {
+    return std::nullopt;
+  }
+  ProcPerformanceCounters counters = *performance_counters_;
+  for (int64_t i = 0; i < instance_context_.channel_queues.size(); ++i) {
+    ChannelInstance* channel_instance =
+        instance_context_.channel_queues[i]->channel_instance();
+    if (instance_context_.send_counts[i] > 0) {
+      counters.sends[channel_instance] += instance_context_.send_counts[i];
+    }
+    if (instance_context_.receive_counts[i] > 0) {
+      counters.receives[channel_instance] +=
+          instance_context_.receive_counts[i];
+    }
+  }
+  return counters;
+}
+
 std::string NameOfNodeOrDefault(Proc* p, int64_t id,
                                 std::string_view default_res) {
   absl::StatusOr<Node*> node = p->GetNodeById(id);
@@ -203,9 +279,10 @@ absl::StatusOr<ChannelInstance*> GetChannelInstance(
     ProcInstance* proc_instance, std::string_view channel_name,
     JitChannelQueueManager* queue_mgr) {
   if (proc_instance->path().has_value()) {
-    // New-style proc-scoped channels.
-    return queue_mgr->elaboration().GetChannelInstance(channel_name,
-                                                       *proc_instance->path());
+    // New-style proc-scoped channels. These are resolved through the proc
+    // instance directly rather than by instantiation path, which would hash
+    // the whole path on each lookup.
+    return proc_instance->GetChannelInstance(channel_name);
   }
   // Old-style global channels.
   XLS_ASSIGN_OR_RETURN(
@@ -282,6 +359,13 @@ absl::StatusOr<TickResult> ProcJit::Tick(ProcContinuation& continuation) const {
   XLS_RET_CHECK_NE(cont, nullptr)
       << "ProcJit requires a continuation of type ProcJitContinuation";
   int64_t start_continuation_point = cont->GetContinuationPoint();
+  ProcPerformanceCounters* counters = cont->performance_counters();
+  int64_t start_cycles = counters != nullptr ? ReadCycleCounter() : 0;
+
+  // Traces passed to an event sink are only formatted if the sink asks for
+  // the message, keeping formatting out of the simulation loop.
+  cont->instance_context()->defer_trace_formatting =
+      cont->GetEvents().sink != nullptr;
 
   // The jitted function returns the early exit point at which execution
   // halted. A return value of zero indicates that the tick completed.
@@ -289,8 +373,16 @@ absl::StatusOr<TickResult> ProcJit::Tick(ProcContinuation& continuation) const {
       cont->input(), cont->output(), cont->temp_buffer(), &cont->GetEvents(),
       cont->instance_context(), runtime(), cont->GetContinuationPoint());
 
+  if (counters != nullptr) {
+    counters->cycles += ReadCycleCounter() - start_cycles;
+    ++counters->activations;
+  }
+
   if (next_continuation_point == 0) {
     // The proc successfully completed its tick.
+    if (counters != nullptr) {
+      ++counters->completed_ticks;
+    }
     XLS_RETURN_IF_ERROR(cont->NextTick());
     return TickResult{.execution_state = TickExecutionState::kCompleted,
                       .channel_instance = std::nullopt,
@@ -318,6 +410,9 @@ absl::StatusOr<TickResult> ProcJit::Tick(ProcContinuation& continuation) const {
                       .progress_made = true};
   }
   XLS_RET_CHECK(early_exit_node->Is<Receive>());
+  if (counters != nullptr) {
+    ++counters->blocked_on_receive;
+  }
   XLS_ASSIGN_OR_RETURN(
       ChannelInstance * channel_instance,
       GetChannelInstance(continuation.proc_instance(),
@@ -15,14 +15,24 @@
 #include "xls/jit/proc_jit.h"
 
 #include <memory>
+#include <optional>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/log/check.h"
+#include "xls/common/status/matchers.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/proc_evaluator_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/ir/value.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
@@ -30,6 +40,9 @@
 namespace xls {
 namespace {
 
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
 JitRuntime* GetJitRuntime() {
   static auto orc_jit = OrcJit::Create().value();
   static auto jit_runtime =
@@ -56,5 +69,62 @@ INSTANTIATE_TEST_SUITE_P(
               .value();
         })));
 
+class ProcJitPerformanceCountersTest : public IrTestBase {};
+
+TEST_F(ProcJitPerformanceCountersTest, CountsActivationsAndChannelOps) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in_ch,
+      package->CreateStreamingChannel("in", ChannelOps::kReceiveOnly,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out_ch,
+      package->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                      package->GetBitsType(32)));
+  ProcBuilder pb(TestName(), package.get());
+  BValue rcv = pb.Receive(in_ch, pb.Literal(Value::Token()));
+  pb.Send(out_ch, pb.TupleIndex(rcv, 0), pb.TupleIndex(rcv, 1));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      JitChannelQueueManager::CreateThreadSafe(
+          package.get(),
+          std::make_unique<JitRuntime>(GetJitRuntime()->data_layout())));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcJit> jit,
+      ProcJit::Create(proc, GetJitRuntime(), queue_manager.get()));
+  std::unique_ptr<ProcContinuation> continuation = jit->NewContinuation(
+      queue_manager->elaboration().GetUniqueInstance(proc).value());
+
+  EXPECT_EQ(continuation->GetPerformanceCounters(), std::nullopt);
+  ASSERT_TRUE(continuation->EnablePerformanceCounters());
+
+  // Nothing to receive: the proc blocks.
+  XLS_ASSERT_OK_AND_ASSIGN(TickResult result, jit->Tick(*continuation));
+  EXPECT_EQ(result.execution_state, TickExecutionState::kBlockedOnReceive);
+
+  XLS_ASSERT_OK(queue_manager->GetQueue(in_ch).Write(Value(UBits(42, 32))));
+  do {
+    XLS_ASSERT_OK_AND_ASSIGN(result, jit->Tick(*continuation));
+  } while (result.execution_state != TickExecutionState::kCompleted);
+
+  std::optional<ProcPerformanceCounters> counters =
+      continuation->GetPerformanceCounters();
+  ASSERT_TRUE(counters.has_value());
+  EXPECT_GE(counters->activations, 2);
+  EXPECT_EQ(counters->completed_ticks, 1);
+  EXPECT_EQ(counters->blocked_on_receive, 1);
+  EXPECT_GE(counters->cycles, 0);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ChannelInstance * in_instance,
+      queue_manager->elaboration().GetUniqueInstance(in_ch));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ChannelInstance * out_instance,
+      queue_manager->elaboration().GetUniqueInstance(out_ch));
+  EXPECT_THAT(counters->receives, UnorderedElementsAre(Pair(in_instance, 1)));
+  EXPECT_THAT(counters->sends, UnorderedElementsAre(Pair(out_instance, 1)));
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,162 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/jit/random_native_values.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/math_util.h"
+#include "xls/common/philox_random.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_buffer.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+namespace {
+
+// Appends the bit counts of the leaves of `type` (zero for tokens) in the order
+// of the element layouts of a TypeLayout.
+void AppendLeafBitCounts(Type* type, std::vector<int64_t>& bit_counts) {
+  if (type->IsBits()) {
+    bit_counts.push_back(type->AsBitsOrDie()->bit_count());
+  } else if (type->IsToken()) {
+    bit_counts.push_back(0);
+  } else if (type->IsTuple()) {
+    for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+      AppendLeafBitCounts(element_type, bit_counts);
+    }
+  } else {
+    CHECK(type->IsArray());
+    ArrayType* array_type = type->AsArrayOrDie();
+    for (int64_t i = 0; i < array_type->size(); ++i) {
+      AppendLeafBitCounts(array_type->element_type(), bit_counts);
+    }
+  }
+}
+
+}  // namespace
+
+RandomNativeValueGenerator::RandomNativeValueGenerator(
+    const TypeLayout& layout, uint64_t seed, uint32_t lane)
+    : layout_(layout), seed_(seed), lane_(lane) {
+  std::vector<int64_t> bit_counts;
+  bit_counts.reserve(layout.elements().size());
+  AppendLeafBitCounts(layout.type(), bit_counts);
+  CHECK_EQ(bit_counts.size(), layout.elements().size());
+  for (int64_t i = 0; i < bit_counts.size(); ++i) {
+    if (bit_counts[i] == 0) {
+      continue;
+    }
+    int64_t byte_count = CeilOfRatio(bit_counts[i], int64_t{8});
+    int64_t high_bits = bit_counts[i] - (byte_count - 1) * 8;
+    leaves_.push_back(RandomLeaf{
+        .offset = layout.elements()[i].offset,
+        .byte_count = byte_count,
+        .high_byte_mask = static_cast<uint8_t>((1 << high_bits) - 1)});
+  }
+}
+
+void RandomNativeValueGenerator::FillOne(int64_t index, uint8_t* buffer) const {
+  // Padding (within and between leaves) must be zero.
+  std::memset(buffer, 0, layout_.size());
+  PhiloxRandom rng(seed_, index, lane_);
+  for (const RandomLeaf& leaf : leaves_) {
+    uint8_t* leaf_buffer = buffer + leaf.offset;
+    rng.Fill(absl::MakeSpan(leaf_buffer, leaf.byte_count));
+    leaf_buffer[leaf.byte_count - 1] &= leaf.high_byte_mask;
+  }
+}
+
+absl::Status RandomNativeValueGenerator::Fill(
+    int64_t first_index, int64_t count, absl::Span<uint8_t> buffer) const {
+  XLS_RET_CHECK_GE(count, 0);
+  if (buffer.size() < count * layout_.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Buffer of %d bytes is too small for %d values of %d bytes",
+        buffer.size(), count, layout_.size()));
+  }
+  for (int64_t i = 0; i < count; ++i) {
+    FillOne(first_index + i, buffer.data() + i * layout_.size());
+  }
+  return absl::OkStatus();
+}
+
+Value RandomNativeValueGenerator::GetValue(int64_t index) const {
+  std::vector<uint8_t> buffer(layout_.size());
+  FillOne(index, buffer.data());
+  return layout_.NativeLayoutToValue(buffer.data());
+}
+
+/* static */ absl::StatusOr<RandomBatchedArguments>
+RandomBatchedArguments::Create(FunctionJit& jit, uint64_t seed,
+                               int64_t batch_size) {
+  XLS_RET_CHECK_GT(batch_size, 0);
+  RandomBatchedArguments result(batch_size);
+  absl::Span<Param* const> params = jit.function()->params();
+  for (int64_t i = 0; i < params.size(); ++i) {
+    const TypeLayout& layout =
+        jit.runtime()->GetTypeLayout(params[i]->GetType());
+    XLS_RET_CHECK_EQ(layout.size(), jit.GetArgTypeSize(i));
+    result.generators_.emplace_back(layout, seed, /*lane=*/i);
+    int64_t alignment = jit.GetArgTypeAlignment(i);
+    // Allocate at least one byte so that every parameter has a distinct,
+    // non-null array.
+    int64_t size = RoundUpToNearest<int64_t>(
+        std::max<int64_t>(batch_size * layout.size(), 1), alignment);
+    std::unique_ptr<uint8_t[], DeleteAligned> buffer(
+        static_cast<uint8_t*>(AllocateAligned(alignment, size)));
+    XLS_RET_CHECK(buffer != nullptr);
+    result.pointers_.push_back(buffer.get());
+    result.buffer_sizes_.push_back(size);
+    result.buffers_.push_back(std::move(buffer));
+  }
+  return result;
+}
+
+absl::Status RandomBatchedArguments::Fill(int64_t first_index) {
+  for (int64_t i = 0; i < generators_.size(); ++i) {
+    XLS_RETURN_IF_ERROR(generators_[i].Fill(
+        first_index, batch_size_,
+        absl::MakeSpan(buffers_[i].get(), buffer_sizes_[i])));
+  }
+  return absl::OkStatus();
+}
+
+std::vector<Value> RandomBatchedArguments::GetArguments(int64_t index) const {
+  std::vector<Value> arguments;
+  arguments.reserve(generators_.size());
+  for (const RandomNativeValueGenerator& generator : generators_) {
+    arguments.push_back(generator.GetValue(index));
+  }
+  return arguments;
+}
+
+}  // namespace xls
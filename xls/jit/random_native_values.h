@@ -0,0 +1,126 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_JIT_RANDOM_NATIVE_VALUES_H_
+#define XLS_JIT_RANDOM_NATIVE_VALUES_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_buffer.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+
+// Generates random values of a type directly in the native layout used by the
+// JIT, for feeding large numbers of quickcheck or fuzz inputs to the jitted
+// code without building a Value for each of them.
+//
+// Every bit of a value is uniformly distributed (as with RandomValue). The
+// value with index `i` depends only on the seed, the lane and `i`: it is drawn
+// from PhiloxRandom(seed, i, lane). Values can therefore be generated in any
+// order or in parallel, and any single value can be regenerated later (e.g.
+// to report a failing input) with GetValue.
+class RandomNativeValueGenerator {
+ public:
+  // `lane` selects an independent set of values for the same seed and
+  // indices, e.g. one per parameter of a function.
+  RandomNativeValueGenerator(const TypeLayout& layout, uint64_t seed,
+                             uint32_t lane = 0);
+
+  // Writes the values with indices [first_index, first_index + count) back to
+  // back, `layout().size()` bytes apart, starting at `buffer` (the
+  // structure-of-arrays layout used by FunctionJit::RunBatched).
+  absl::Status Fill(int64_t first_index, int64_t count,
+                    absl::Span<uint8_t> buffer) const;
+
+  // Writes the value with index `index` to `buffer`, which must have room for
+  // `layout().size()` bytes.
+  void FillOne(int64_t index, uint8_t* buffer) const;
+
+  // Returns the value with index `index`.
+  Value GetValue(int64_t index) const;
+
+  const TypeLayout& layout() const { return layout_; }
+
+ private:
+  // A leaf element which holds random bits.
+  struct RandomLeaf {
+    int64_t offset;
+    int64_t byte_count;
+    // Mask applied to the most significant byte to clear the bits beyond the
+    // bit count of the leaf.
+    uint8_t high_byte_mask;
+  };
+
+  TypeLayout layout_;
+  uint64_t seed_;
+  uint32_t lane_;
+  std::vector<RandomLeaf> leaves_;
+};
+
+// Batches of random arguments for FunctionJit::RunBatched: `batch_size` values
+// of each parameter of the function in the structure-of-arrays layout, each
+// array aligned as RunBatched requires. The i-th set of arguments of a batch
+// filled by Fill(first_index) is the set with index `first_index + i`, and the
+// argument of parameter `p` of the set with index `j` is the value with index
+// `j` of a RandomNativeValueGenerator with the given seed and lane `p`.
+//
+//   XLS_ASSIGN_OR_RETURN(RandomBatchedArguments args,
+//                        RandomBatchedArguments::Create(*jit, seed, 1024));
+//   for (int64_t first = 0; first < n; first += args.batch_size()) {
+//     XLS_RETURN_IF_ERROR(args.Fill(first));
+//     XLS_RETURN_IF_ERROR(jit->RunBatched(args.args(), args.batch_size(),
+//                                         results));
+//     ... on a mismatch at i, report args.GetArguments(first + i) ...
+//   }
+class RandomBatchedArguments {
+ public:
+  static absl::StatusOr<RandomBatchedArguments> Create(FunctionJit& jit,
+                                                       uint64_t seed,
+                                                       int64_t batch_size);
+
+  // Fills the batch with the argument sets with indices
+  // [first_index, first_index + batch_size()).
+  absl::Status Fill(int64_t first_index);
+
+  // The arrays of arguments, one per parameter, for RunBatched.
+  absl::Span<const uint8_t* const> args() const { return pointers_; }
+
+  int64_t batch_size() const { return batch_size_; }
+
+  // Returns the set of arguments with index `index` as Values.
+  std::vector<Value> GetArguments(int64_t index) const;
+
+ private:
+  explicit RandomBatchedArguments(int64_t batch_size)
+      : batch_size_(batch_size) {}
+
+  int64_t batch_size_;
+  std::vector<RandomNativeValueGenerator> generators_;
+  std::vector<std::unique_ptr<uint8_t[], DeleteAligned>> buffers_;
+  std::vector<int64_t> buffer_sizes_;
+  std::vector<const uint8_t*> pointers_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_RANDOM_NATIVE_VALUES_H_
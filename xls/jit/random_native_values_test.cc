@@ -0,0 +1,121 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/jit/random_native_values.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+namespace {
+
+TEST(RandomNativeValuesTest, ValuesAreCanonicalAndReproducible) {
+  Package package("my_package");
+  Type* type = package.GetTupleType(
+      {package.GetBitsType(2), package.GetBitsType(9), package.GetBitsType(0),
+       package.GetArrayType(3, package.GetBitsType(37)),
+       package.GetBitsType(130)});
+  FunctionBuilder fb("identity", &package);
+  fb.Param("x", type);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  const TypeLayout& layout = jit->runtime()->GetTypeLayout(type);
+
+  constexpr int64_t kCount = 100;
+  RandomNativeValueGenerator generator(layout, /*seed=*/1234);
+  std::vector<uint8_t> buffer(kCount * layout.size());
+  XLS_ASSERT_OK(generator.Fill(/*first_index=*/10, kCount,
+                               absl::MakeSpan(buffer)));
+
+  absl::flat_hash_set<Value> values;
+  std::vector<uint8_t> canonical(layout.size());
+  for (int64_t i = 0; i < kCount; ++i) {
+    const uint8_t* raw = buffer.data() + i * layout.size();
+    Value value = layout.NativeLayoutToValue(raw);
+    EXPECT_EQ(value, generator.GetValue(10 + i));
+    values.insert(value);
+
+    // Bits beyond the width of each leaf and all padding must be zero, i.e.
+    // the buffer must match the layout the JIT itself would produce.
+    std::fill(canonical.begin(), canonical.end(), 0);
+    layout.ValueToNativeLayout(value, canonical.data());
+    EXPECT_EQ(std::vector<uint8_t>(raw, raw + layout.size()), canonical);
+  }
+  EXPECT_EQ(values.size(), kCount);
+
+  // Values depend only on the seed, lane and index.
+  std::vector<uint8_t> one(layout.size());
+  RandomNativeValueGenerator same(layout, /*seed=*/1234);
+  same.FillOne(42, one.data());
+  EXPECT_EQ(layout.NativeLayoutToValue(one.data()), generator.GetValue(42));
+  EXPECT_NE(RandomNativeValueGenerator(layout, /*seed=*/1235).GetValue(42),
+            generator.GetValue(42));
+  EXPECT_NE(RandomNativeValueGenerator(layout, /*seed=*/1234, /*lane=*/1)
+                .GetValue(42),
+            generator.GetValue(42));
+
+  std::vector<uint8_t> too_small(layout.size());
+  EXPECT_FALSE(generator.Fill(0, 2, absl::MakeSpan(too_small)).ok());
+}
+
+TEST(RandomNativeValuesTest, RandomBatchedArguments) {
+  Package package("my_package");
+  FunctionBuilder fb("test", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  BValue y = fb.Param("y", package.GetBitsType(7));
+  fb.Add(fb.UMul(x, x), fb.ZeroExtend(y, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  constexpr int64_t kBatchSize = 64;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      RandomBatchedArguments args,
+      RandomBatchedArguments::Create(*jit, /*seed=*/7, kBatchSize));
+  ASSERT_EQ(args.args().size(), 2);
+  std::vector<uint8_t> results(kBatchSize * jit->GetReturnTypeSize());
+  for (int64_t first_index : {0, 1000}) {
+    XLS_ASSERT_OK(args.Fill(first_index));
+    XLS_ASSERT_OK(jit->RunBatched(args.args(), kBatchSize,
+                                  absl::MakeSpan(results)));
+    const TypeLayout& result_layout =
+        jit->runtime()->GetTypeLayout(function->GetType()->return_type());
+    for (int64_t i = 0; i < kBatchSize; ++i) {
+      std::vector<Value> arguments = args.GetArguments(first_index + i);
+      XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                               jit->Run(arguments));
+      EXPECT_EQ(result_layout.NativeLayoutToValue(
+                    results.data() + i * jit->GetReturnTypeSize()),
+                expected.value)
+          << "index " << first_index + i;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,24 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+pub struct Point { x: u32, y: s6 }
+
+pub struct Segment { start: Point, end: Point }
+
+pub fn translate(s: Segment, d: Point) -> Segment {
+  Segment {
+    start: Point { x: s.start.x + d.x, y: s.start.y + d.y },
+    end: Point { x: s.end.x + d.x, y: s.end.y + d.y },
+  }
+}
@@ -23,14 +23,17 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
 #include "xls/ir/value.h"
 #include "xls/jit/function_jit.h"
 #include "xls/jit/observer.h"
@@ -63,6 +66,24 @@ SwitchableFunctionJit::CreateInterpreter(Function* xls_function) {
       new SwitchableFunctionJit(xls_function, /*use_jit=*/false, nullptr));
 }
 
+absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
+SwitchableFunctionJit::CreateTiered(Function* xls_function, int64_t opt_level,
+                                    JitObserver* observer,
+                                    int64_t compile_threshold) {
+  XLS_RET_CHECK_GE(compile_threshold, 0);
+  auto tiered = std::make_unique<TieredState>();
+  tiered->opt_level = opt_level;
+  tiered->observer = observer;
+  tiered->compile_threshold = compile_threshold;
+  std::unique_ptr<SwitchableFunctionJit> result(
+      new SwitchableFunctionJit(xls_function, /*use_jit=*/false, nullptr,
+                                std::move(tiered)));
+  if (compile_threshold == 0) {
+    result->StartCompilation();
+  }
+  return result;
+}
+
 absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
 SwitchableFunctionJit::Create(Function* xls_function, ExecutionType execution,
                               int64_t opt_level, JitObserver* observer) {
@@ -77,6 +98,9 @@ SwitchableFunctionJit::Create(Function* xls_function, ExecutionType execution,
     case ExecutionType::kJit:
       return SwitchableFunctionJit::CreateJit(xls_function, opt_level,
                                               observer);
+    case ExecutionType::kTiered:
+      return SwitchableFunctionJit::CreateTiered(xls_function, opt_level,
+                                                 observer);
     case ExecutionType::kDefault:
       LOG(FATAL) << "Unreachable";
   }
@@ -127,8 +151,81 @@ absl::StatusOr<InterpreterResult<Value>> Interpret(
 }
 }  // namespace
 
+void SwitchableFunctionJit::StartCompilation() {
+  TieredState* tiered = tiered_.get();
+  Function* function = xls_function_;
+  VLOG(2) << "Starting background JIT compilation of " << function->name();
+  tiered->locked_type_manager = &function->package()->type_manager();
+  tiered->locked_type_manager->BeginConcurrentAccess();
+  tiered->compile_thread = std::make_unique<Thread>([tiered, function]() {
+    absl::StatusOr<std::unique_ptr<FunctionJit>> jit =
+        FunctionJit::Create(function, tiered->opt_level, tiered->observer);
+    absl::MutexLock lock(&tiered->mutex);
+    tiered->compiled_jit = std::move(jit);
+    tiered->compile_done = true;
+  });
+}
+
+absl::Status SwitchableFunctionJit::FinishCompilation(bool wait) {
+  TieredState* tiered = tiered_.get();
+  absl::StatusOr<std::unique_ptr<FunctionJit>> jit;
+  {
+    absl::MutexLock lock(&tiered->mutex);
+    if (wait) {
+      tiered->mutex.Await(absl::Condition(&tiered->compile_done));
+    } else if (!tiered->compile_done) {
+      return absl::OkStatus();
+    }
+    jit = std::move(tiered->compiled_jit);
+  }
+  tiered->compile_thread->Join();
+  tiered->locked_type_manager->EndConcurrentAccess();
+  tiered->locked_type_manager = nullptr;
+  if (!jit.ok()) {
+    LOG(WARNING) << "JIT compilation of " << xls_function_->name()
+                 << " failed, continuing to interpret: " << jit.status();
+    tiered->final_status = jit.status();
+    return jit.status();
+  }
+  VLOG(2) << "Switching " << xls_function_->name() << " to the JIT after "
+          << tiered->invocation_count << " interpreted invocations";
+  function_jit_ = std::move(jit).value();
+  use_jit_ = true;
+  tiered->final_status = absl::OkStatus();
+  return absl::OkStatus();
+}
+
+void SwitchableFunctionJit::AdvanceTier() {
+  if (tiered_ == nullptr || tiered_->final_status.has_value()) {
+    return;
+  }
+  if (tiered_->compile_thread == nullptr) {
+    if (++tiered_->invocation_count >= tiered_->compile_threshold) {
+      StartCompilation();
+    }
+    return;
+  }
+  ++tiered_->invocation_count;
+  // Failures are logged and leave the object interpreting.
+  FinishCompilation(/*wait=*/false).IgnoreError();
+}
+
+absl::Status SwitchableFunctionJit::WaitForJit() {
+  if (tiered_ == nullptr) {
+    return absl::OkStatus();
+  }
+  if (tiered_->final_status.has_value()) {
+    return *tiered_->final_status;
+  }
+  if (tiered_->compile_thread == nullptr) {
+    StartCompilation();
+  }
+  return FinishCompilation(/*wait=*/true);
+}
+
 absl::StatusOr<InterpreterResult<Value>> SwitchableFunctionJit::Run(
     absl::Span<const Value> args) {
+  AdvanceTier();
   if (use_jit_) {
     return function_jit_->Run(args);
   }
@@ -138,6 +235,7 @@ absl::StatusOr<InterpreterResult<Value>> SwitchableFunctionJit::Run(
 
 absl::StatusOr<InterpreterResult<Value>> SwitchableFunctionJit::Run(
     const absl::flat_hash_map<std::string, Value>& kwargs) {
+  AdvanceTier();
   if (use_jit_) {
     return function_jit_->Run(kwargs);
   }
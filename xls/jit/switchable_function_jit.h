@@ -21,11 +21,16 @@
 #include <string>
 #include <utility>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "xls/common/thread.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
+#include "xls/ir/type_manager.h"
 #include "xls/ir/value.h"
 #include "xls/jit/function_jit.h"
 #include "xls/jit/observer.h"
@@ -36,6 +41,10 @@ enum class ExecutionType {
   kDefault,
   kJit,
   kInterpreter,
+  // Start in the interpreter and switch to the JIT once the function has been
+  // invoked enough times to be worth compiling. Compilation happens on a
+  // background thread so no call waits on LLVM.
+  kTiered,
 };
 
 // A wrapper for the jit structures that can be turned off at build time if
@@ -51,6 +60,20 @@ class SwitchableFunctionJit {
       JitObserver* observer = nullptr);
   static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
   CreateInterpreter(Function* xls_function);
+
+  // Number of invocations after which a tiered SwitchableFunctionJit starts
+  // compiling the function.
+  static constexpr int64_t kDefaultTieredCompileThreshold = 16;
+
+  // Returns an object which interprets the function until it has been invoked
+  // `compile_threshold` times, then compiles it in the background and runs
+  // the compiled code once compilation finishes. A threshold of zero starts
+  // compilation immediately. If compilation fails the function keeps being
+  // interpreted. `observer`, if given, is notified from the background thread.
+  static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>> CreateTiered(
+      Function* xls_function, int64_t opt_level = 3,
+      JitObserver* observer = nullptr,
+      int64_t compile_threshold = kDefaultTieredCompileThreshold);
   static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>> Create(
       Function* xls_function, ExecutionType execution = ExecutionType::kDefault,
       int64_t opt_level = 3, JitObserver* observer = nullptr);
@@ -74,16 +97,65 @@ class SwitchableFunctionJit {
     return std::nullopt;
   }
 
+  // For a tiered object, starts compilation if it has not been started, waits
+  // for it to finish and switches to the JIT. Returns the compilation status.
+  // Returns OkStatus for non-tiered objects.
+  absl::Status WaitForJit();
+
  private:
+  // Background compilation state of a tiered SwitchableFunctionJit.
+  struct TieredState {
+    ~TieredState() {
+      if (locked_type_manager != nullptr) {
+        compile_thread->Join();
+        locked_type_manager->EndConcurrentAccess();
+      }
+    }
+
+    int64_t opt_level;
+    JitObserver* observer;
+    int64_t compile_threshold;
+    int64_t invocation_count = 0;
+    // Set once the object has switched to the JIT or compilation failed.
+    std::optional<absl::Status> final_status;
+
+    absl::Mutex mutex;
+    bool compile_done ABSL_GUARDED_BY(mutex) = false;
+    absl::StatusOr<std::unique_ptr<FunctionJit>> compiled_jit
+        ABSL_GUARDED_BY(mutex);
+
+    // The type manager of the function's package, which must lock while the
+    // compile thread runs concurrently with the interpreter. Null when the
+    // compile thread is not running or has been joined.
+    TypeManager* locked_type_manager = nullptr;
+
+    // Declared last so the thread is joined before the state it writes is
+    // destroyed.
+    std::unique_ptr<Thread> compile_thread;
+  };
+
   explicit SwitchableFunctionJit(Function* xls_function, bool use_jit,
-                                 std::unique_ptr<FunctionJit>&& jit)
+                                 std::unique_ptr<FunctionJit>&& jit,
+                                 std::unique_ptr<TieredState> tiered = nullptr)
       : xls_function_(xls_function),
         use_jit_(use_jit),
-        function_jit_(std::move(jit)) {}
+        function_jit_(std::move(jit)),
+        tiered_(std::move(tiered)) {}
+
+  // Counts an invocation of a tiered object, starting compilation once the
+  // threshold is reached and switching to the JIT if compilation has
+  // finished.
+  void AdvanceTier();
+  void StartCompilation();
+  // Switches to the JIT once compilation has finished. If `wait` is true
+  // blocks until then.
+  absl::Status FinishCompilation(bool wait);
 
   Function* xls_function_;
   bool use_jit_;
   std::unique_ptr<FunctionJit> function_jit_;
+  // Null unless this object is tiered.
+  std::unique_ptr<TieredState> tiered_;
 };
 }  // namespace xls
 
@@ -14,9 +14,12 @@
 
 #include "xls/jit/switchable_function_jit.h"
 
+#include <cstdint>
+#include <string>
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
@@ -79,5 +82,61 @@ TEST_F(SwitchableFunctionJitTest, CanExecuteDefault) {
             Value::Tuple({Value(UBits(12, 8)), Value(UBits(32, 8))}));
 }
 
+TEST_F(SwitchableFunctionJitTest, TieredSwitchesToJit) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(auto f, TestFunction(p.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto runner, SwitchableFunctionJit::CreateTiered(
+                       f, /*opt_level=*/3, /*observer=*/nullptr,
+                       /*compile_threshold=*/2));
+  std::vector<Value> args = {Value(UBits(8, 8)), Value(UBits(4, 8))};
+  Value expected = Value::Tuple({Value(UBits(12, 8)), Value(UBits(32, 8))});
+
+  // The first invocation is below the threshold and is interpreted.
+  XLS_ASSERT_OK_AND_ASSIGN(auto result, runner->Run(args));
+  EXPECT_EQ(result.value, expected);
+  EXPECT_FALSE(runner->function_jit().has_value());
+
+  // The second starts compilation but does not wait for it.
+  XLS_ASSERT_OK_AND_ASSIGN(result, runner->Run(args));
+  EXPECT_EQ(result.value, expected);
+
+  XLS_ASSERT_OK(runner->WaitForJit());
+  EXPECT_TRUE(runner->function_jit().has_value());
+  XLS_ASSERT_OK_AND_ASSIGN(result, runner->Run(args));
+  EXPECT_EQ(result.value, expected);
+}
+
+TEST_F(SwitchableFunctionJitTest, TieredDefaultThreshold) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(auto f, TestFunction(p.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto runner, SwitchableFunctionJit::Create(f, ExecutionType::kTiered));
+  EXPECT_FALSE(runner->function_jit().has_value());
+  absl::flat_hash_map<std::string, Value> kwargs = {
+      {"p1", Value(UBits(3, 8))}, {"p2", Value(UBits(5, 8))}};
+  for (int64_t i = 0; i < SwitchableFunctionJit::kDefaultTieredCompileThreshold;
+       ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(auto result, runner->Run(kwargs));
+    EXPECT_EQ(result.value,
+              Value::Tuple({Value(UBits(8, 8)), Value(UBits(15, 8))}));
+  }
+  XLS_ASSERT_OK(runner->WaitForJit());
+  EXPECT_TRUE(runner->function_jit().has_value());
+}
+
+TEST_F(SwitchableFunctionJitTest, TieredDestroyedWhileCompiling) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(auto f, TestFunction(p.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto runner, SwitchableFunctionJit::CreateTiered(
+                       f, /*opt_level=*/3, /*observer=*/nullptr,
+                       /*compile_threshold=*/0));
+  runner.reset();
+}
+
 }  // namespace
 }  // namespace xls
@@ -19,9 +19,13 @@
 
 #include "include/benchmark/benchmark.h"
 #include "xls/interpreter/random_value.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
+#include "xls/jit/jit_arg_marshaller.h"
+#include "xls/jit/jit_runtime.h"
 #include "xls/jit/llvm_type_converter.h"
 #include "xls/jit/orc_jit.h"
 #include "xls/jit/type_layout.h"
@@ -75,8 +79,78 @@ static void BM_NativeLayoutToValue(benchmark::State& state) {
   }
 }
 
+static std::unique_ptr<JitRuntime> CreateJitRuntime() {
+  std::unique_ptr<OrcJit> orc_jit = OrcJit::Create().value();
+  return std::make_unique<JitRuntime>(orc_jit->CreateDataLayout().value());
+}
+
+// Returns the identity function on `type` so the arg marshaller has a
+// signature to precompute.
+static Function* CreateIdentityFunction(Type* type, Package* package) {
+  FunctionBuilder fb("identity", package);
+  fb.Identity(fb.Param("x", type));
+  return fb.Build().value();
+}
+
+// The following compare JitRuntime's conversions (used by FunctionJit::Run
+// before JitArgMarshaller) against the precomputed JitArgMarshaller.
+static void BM_JitRuntimePackArgs(benchmark::State& state) {
+  Package package("BM");
+  Type* type = Parser::ParseType(kValueTypes[state.range(0)], &package).value();
+  std::minstd_rand bitgen;
+  std::vector<Value> args = {RandomValue(type, bitgen)};
+  std::vector<Type*> arg_types = {type};
+  std::unique_ptr<JitRuntime> runtime = CreateJitRuntime();
+  std::vector<uint8_t> buffer(runtime->GetTypeByteSize(type));
+  std::vector<uint8_t*> buffers = {buffer.data()};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(runtime->PackArgs(args, arg_types, buffers));
+  }
+}
+
+static void BM_MarshalArgs(benchmark::State& state) {
+  Package package("BM");
+  Type* type = Parser::ParseType(kValueTypes[state.range(0)], &package).value();
+  std::minstd_rand bitgen;
+  std::vector<Value> args = {RandomValue(type, bitgen)};
+  std::unique_ptr<JitRuntime> runtime = CreateJitRuntime();
+  JitArgMarshaller marshaller =
+      JitArgMarshaller::Create(CreateIdentityFunction(type, &package), *runtime);
+  std::vector<uint8_t> buffer(marshaller.arg_layout(0).size());
+  std::vector<uint8_t*> buffers = {buffer.data()};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(marshaller.MarshalArgs(args, buffers));
+  }
+}
+
+static void BM_JitRuntimeUnpackBuffer(benchmark::State& state) {
+  Package package("BM");
+  Type* type = Parser::ParseType(kValueTypes[state.range(0)], &package).value();
+  std::unique_ptr<JitRuntime> runtime = CreateJitRuntime();
+  std::vector<uint8_t> buffer(runtime->GetTypeByteSize(type), 0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(runtime->UnpackBuffer(buffer.data(), type));
+  }
+}
+
+static void BM_UnmarshalResult(benchmark::State& state) {
+  Package package("BM");
+  Type* type = Parser::ParseType(kValueTypes[state.range(0)], &package).value();
+  std::unique_ptr<JitRuntime> runtime = CreateJitRuntime();
+  JitArgMarshaller marshaller =
+      JitArgMarshaller::Create(CreateIdentityFunction(type, &package), *runtime);
+  std::vector<uint8_t> buffer(marshaller.result_layout().size(), 0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(marshaller.UnmarshalResult(buffer.data()));
+  }
+}
+
 BENCHMARK(BM_ValueToNativeLayout)->DenseRange(0, kNumTypes - 1);
 BENCHMARK(BM_NativeLayoutToValue)->DenseRange(0, kNumTypes - 1);
+BENCHMARK(BM_JitRuntimePackArgs)->DenseRange(0, kNumTypes - 1);
+BENCHMARK(BM_MarshalArgs)->DenseRange(0, kNumTypes - 1);
+BENCHMARK(BM_JitRuntimeUnpackBuffer)->DenseRange(0, kNumTypes - 1);
+BENCHMARK(BM_UnmarshalResult)->DenseRange(0, kNumTypes - 1);
 
 }  // namespace
 }  // namespace xls
@@ -16,6 +16,7 @@
 #define XLS_NETLIST_CELL_LIBRARY_H_
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -232,18 +233,44 @@ class AbstractCellLibrary {
     return FromProto(proto, EvalT{false}, EvalT{true});
   }
 
+  // Returns the proto for the named cell, or std::nullopt if the loader
+  // doesn't know of it.
+  using EntryLoader =
+      std::function<absl::StatusOr<std::optional<CellLibraryEntryProto>>(
+          std::string_view name)>;
+
   // Returns a NOT_FOUND status if there is not entry with the given name.
+  //
+  // If an entry loader has been set, entries not yet in the library are
+  // loaded through it on first use. Such libraries must not be queried from
+  // several threads at once.
   absl::StatusOr<const AbstractCellLibraryEntry<EvalT>*> GetEntry(
       std::string_view name) const;
 
   absl::Status AddEntry(AbstractCellLibraryEntry<EvalT> entry);
 
+  // Makes GetEntry consult `loader` for names not in the library, so large
+  // libraries need only materialize the cells that are actually referenced.
+  void SetEntryLoader(EntryLoader loader, EvalT zero, EvalT one) {
+    loader_ = std::move(loader);
+    zero_ = zero;
+    one_ = one;
+  }
+  template <typename = std::is_constructible<EvalT, bool>>
+  void SetEntryLoader(EntryLoader loader) {
+    SetEntryLoader(std::move(loader), EvalT{false}, EvalT{true});
+  }
+
   absl::StatusOr<CellLibraryProto> ToProto() const;
 
  private:
-  absl::flat_hash_map<std::string,
-                      std::unique_ptr<AbstractCellLibraryEntry<EvalT>>>
+  // Entries loaded by GetEntry are added lazily, hence mutable.
+  mutable absl::flat_hash_map<std::string,
+                              std::unique_ptr<AbstractCellLibraryEntry<EvalT>>>
       entries_;
+  EntryLoader loader_;
+  EvalT zero_;
+  EvalT one_;
 };
 
 using CellLibrary = AbstractCellLibrary<>;
@@ -591,11 +618,25 @@ template <typename EvalT>
 absl::StatusOr<const AbstractCellLibraryEntry<EvalT>*>
 AbstractCellLibrary<EvalT>::GetEntry(std::string_view name) const {
   auto it = entries_.find(name);
-  if (it == entries_.end()) {
-    return absl::NotFoundError(
-        absl::StrCat("Cell not found in library: ", name));
+  if (it != entries_.end()) {
+    return it->second.get();
+  }
+  if (loader_) {
+    XLS_ASSIGN_OR_RETURN(std::optional<CellLibraryEntryProto> entry_proto,
+                         loader_(name));
+    if (entry_proto.has_value()) {
+      XLS_ASSIGN_OR_RETURN(auto entry,
+                           AbstractCellLibraryEntry<EvalT>::FromProto(
+                               *entry_proto, zero_, one_));
+      it = entries_
+               .insert({std::string(name),
+                        std::make_unique<AbstractCellLibraryEntry<EvalT>>(
+                            entry)})
+               .first;
+      return it->second.get();
+    }
   }
-  return it->second.get();
+  return absl::NotFoundError(absl::StrCat("Cell not found in library: ", name));
 }
 
 }  // namespace netlist
@@ -16,6 +16,8 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <memory>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
@@ -26,6 +28,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/union_find.h"
 #include "xls/netlist/cell_library.h"
 #include "xls/netlist/netlist.h"
@@ -50,113 +53,157 @@ void Cluster::SortCells() {
   std::sort(other_cells_.begin(), other_cells_.end(), cell_name_lt);
 }
 
-std::vector<Cluster> FindLogicClouds(const Module& module,
-                                     bool include_vacuous) {
-  UnionFind<Cell*> cell_to_uf;
+namespace {
 
-  // Gets-or-adds the given cell to the UnionFind.
-  auto get_uf = [&cell_to_uf](Cell* c) -> Cell* {
-    cell_to_uf.Insert(c);
-    return cell_to_uf.Find(c);
-  };
+// Returns the first cell connected to `net` which is not a flop, or nullptr if
+// there is none.
+Cell* FirstNonFlopCell(NetRef net) {
+  for (Cell* cell : net->connected_cells()) {
+    if (cell->kind() != CellKind::kFlop) {
+      return cell;
+    }
+  }
+  return nullptr;
+}
 
-  // Helper for debugging that counts the number of equivalence classes in
-  // cell_to_uf.
-  auto count_equivalence_classes = [&cell_to_uf]() -> int64_t {
-    return cell_to_uf.GetRepresentatives().size();
+// Unions the equivalence classes of the cells with ids in [begin, end) (their
+// indices in `module.cells()`) with those of the cells they are connected to.
+// Flop output connectivity is excluded, so that the classes are partitioned
+// along flop (output) boundaries: all non-flop cells connected to a net are in
+// one class, and a flop is in the class of the non-flop cell driving it.
+void UnionConnectedCells(
+    const Module& module,
+    const absl::flat_hash_map<const Cell*, int64_t>& cell_ids, int64_t begin,
+    int64_t end, DenseUnionFind& cell_classes) {
+  // Each cell is unioned with a representative non-flop cell of each net it is
+  // connected to rather than with all of the net's cells, which would be
+  // quadratic in the fanout of the net.
+  absl::flat_hash_map<NetRef, int64_t> net_representatives;
+  auto union_with_net = [&](int64_t cell_id, NetRef net) {
+    auto [it, inserted] = net_representatives.try_emplace(net, -1);
+    if (inserted) {
+      if (Cell* representative = FirstNonFlopCell(net);
+          representative != nullptr) {
+        it->second = cell_ids.at(representative);
+      }
+    }
+    if (it->second != -1) {
+      cell_classes.Union(cell_id, it->second);
+    }
   };
 
-  for (auto& item : module.cells()) {
-    Cell* cell = item.get();
-    VLOG(4) << "Considering cell: " << cell->name();
-
-    // Flop output connectivity is excluded from the equivalence class, so we
-    // get partitions along flop (output) boundaries.
+  for (int64_t id = begin; id < end; ++id) {
+    const Cell* cell = module.cells()[id].get();
     if (cell->kind() == CellKind::kFlop) {
-      // For flops we just make sure an equivalence class is present in the
-      // map, in case it doesn't have any cells on the input side.
-      get_uf(cell);
-      VLOG(4) << "--- Now " << count_equivalence_classes()
-              << " equivalence classes for " << cell_to_uf.size() << " cells.";
       continue;
     }
-
-    for (auto& input : cell->inputs()) {
-      VLOG(4) << "- Considering input net: " << input.netref->name();
-      for (Cell* connected : input.netref->connected_cells()) {
-        if (cell == connected) {
-          continue;
-        }
+    for (const auto& input : cell->inputs()) {
+      union_with_net(id, input.netref);
+    }
+    for (const auto& output : cell->outputs()) {
+      union_with_net(id, output.netref);
+      for (Cell* connected : output.netref->connected_cells()) {
         if (connected->kind() == CellKind::kFlop) {
-          VLOG(4) << absl::StreamFormat(
-              "-- Cell is connected to flop cell %s on an input pin; not "
-              "merging equivalence classes.",
-              connected->name());
-          continue;
+          VLOG(4) << absl::StreamFormat("-- Cell %s drives flop %s",
+                                        cell->name(), connected->name());
+          cell_classes.Union(id, cell_ids.at(connected));
         }
-        VLOG(4) << absl::StreamFormat("-- Cell %s is connected to cell %s",
-                                      cell->name(), connected->name());
-        cell_to_uf.Union(get_uf(cell), get_uf(connected));
-        VLOG(4) << "--- Now " << count_equivalence_classes()
-                << " equivalence classes for " << cell_to_uf.size()
-                << " cells.";
       }
     }
+  }
+}
 
-    for (const auto& iter : cell->outputs()) {
-      NetRef output = iter.netref;
-      VLOG(4) << "- Considering output net: " << output->name();
-      for (Cell* connected : output->connected_cells()) {
-        if (cell == connected) {
-          continue;
-        }
-        VLOG(4) << absl::StreamFormat("-- Cell %s is connected to cell %s",
-                                      cell->name(), connected->name());
-        cell_to_uf.Union(get_uf(cell), get_uf(connected));
-        VLOG(4) << "--- Now " << count_equivalence_classes()
-                << " equivalence classes for " << cell_to_uf.size()
-                << " cells.";
-      }
-    }
+}  // namespace
+
+std::vector<Cluster> FindLogicClouds(const Module& module,
+                                     bool include_vacuous) {
+  return FindLogicClouds(
+      module, FindLogicCloudsOptions{.include_vacuous = include_vacuous});
+}
+
+std::vector<Cluster> FindLogicClouds(const Module& module,
+                                     const FindLogicCloudsOptions& options) {
+  absl::Span<const std::unique_ptr<Cell>> cells = module.cells();
+  const int64_t cell_count = cells.size();
+  absl::flat_hash_map<const Cell*, int64_t> cell_ids;
+  cell_ids.reserve(cell_count);
+  for (int64_t id = 0; id < cell_count; ++id) {
+    cell_ids[cells[id].get()] = id;
   }
 
-  // Run through the cells and put them into clusters according to their
-  // equivalence classes.
-  absl::flat_hash_map<Cell*, Cluster> equivalence_set_to_cluster;
-  for (auto& item : module.cells()) {
-    Cell* cell = item.get();
-    equivalence_set_to_cluster[get_uf(cell)].Add(cell);
+  // Traverses the connectivity of contiguous ranges of the cells in parallel.
+  DenseUnionFind cell_classes(cell_count);
+  const int64_t thread_count =
+      std::max<int64_t>(1, std::min(options.thread_count, cell_count));
+  if (thread_count == 1) {
+    UnionConnectedCells(module, cell_ids, 0, cell_count, cell_classes);
+  } else {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t t = 0; t < thread_count; ++t) {
+      const int64_t begin = cell_count * t / thread_count;
+      const int64_t end = cell_count * (t + 1) / thread_count;
+      threads.push_back(std::make_unique<Thread>([&, begin, end]() {
+        UnionConnectedCells(module, cell_ids, begin, end, cell_classes);
+      }));
+    }
+    for (auto& thread : threads) {
+      thread->Join();
+    }
   }
 
-  // Put them into a vector and sort each cluster's internal cells for
-  // determinism.
+  // Run through the cells and put them into clusters according to their
+  // equivalence classes. The representative of a class is its first cell, so
+  // the clusters are created in the order of their first cells.
+  std::vector<int64_t> class_to_cluster(cell_count, -1);
   std::vector<Cluster> clusters;
-  for (auto& item : equivalence_set_to_cluster) {
-    Cluster& cluster = item.second;
-    if (!include_vacuous && (cluster.terminating_flops().size() == 1 &&
-                             cluster.other_cells().empty())) {
-      // Vacuous 'just a flop' cluster.
-      continue;
+  for (int64_t id = 0; id < cell_count; ++id) {
+    int64_t& cluster = class_to_cluster[cell_classes.Find(id)];
+    if (cluster == -1) {
+      cluster = clusters.size();
+      clusters.emplace_back();
     }
-    cluster.SortCells();
-    clusters.push_back(std::move(cluster));
+    clusters[cluster].Add(cells[id].get());
+  }
+  VLOG(2) << absl::StreamFormat("%d equivalence classes for %d cells",
+                                clusters.size(), cell_count);
+
+  if (!options.include_vacuous) {
+    // Drop vacuous 'just a flop' clusters.
+    std::erase_if(clusters, [](const Cluster& cluster) {
+      return cluster.terminating_flops().size() == 1 &&
+             cluster.other_cells().empty();
+    });
+  }
+  if (!options.sort_by_name) {
+    return clusters;
   }
 
-  // For convenience (for now) we convert the cell names to a string and rely on
-  // string comparison for deterministic order.
+  // Sort each cluster's internal cells for determinism, then order the
+  // clusters by the string of their cell names. The strings are built once
+  // per cluster rather than for each comparison.
   auto cells_to_str = [](absl::Span<const Cell* const> cells) {
     return absl::StrJoin(cells, ", ", [](std::string* out, const Cell* cell) {
       absl::StrAppend(out, cell->name());
     });
   };
-  auto cluster_sort_lt = [cells_to_str](const Cluster& a, const Cluster& b) {
-    return std::make_pair(cells_to_str(a.terminating_flops()),
-                          cells_to_str(a.other_cells())) <
-           std::make_pair(cells_to_str(b.terminating_flops()),
-                          cells_to_str(b.other_cells()));
-  };
-  std::sort(clusters.begin(), clusters.end(), cluster_sort_lt);
-  return clusters;
+  std::vector<std::pair<std::string, std::string>> keys;
+  keys.reserve(clusters.size());
+  for (Cluster& cluster : clusters) {
+    cluster.SortCells();
+    keys.push_back({cells_to_str(cluster.terminating_flops()),
+                    cells_to_str(cluster.other_cells())});
+  }
+  std::vector<int64_t> order(clusters.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&keys](int64_t a, int64_t b) { return keys[a] < keys[b]; });
+  std::vector<Cluster> sorted_clusters;
+  sorted_clusters.reserve(clusters.size());
+  for (int64_t index : order) {
+    sorted_clusters.push_back(std::move(clusters[index]));
+  }
+  return sorted_clusters;
 }
 
 std::string ClustersToString(absl::Span<const Cluster> clusters) {
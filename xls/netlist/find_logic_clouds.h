@@ -15,6 +15,7 @@
 #ifndef XLS_NETLIST_FIND_LOGIC_CLOUDS_H_
 #define XLS_NETLIST_FIND_LOGIC_CLOUDS_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -56,6 +57,24 @@ class Cluster {
 std::vector<Cluster> FindLogicClouds(const Module& module,
                                      bool include_vacuous = false);
 
+struct FindLogicCloudsOptions {
+  // As for FindLogicClouds() above.
+  bool include_vacuous = false;
+
+  // The number of threads the connectivity of the cells is traversed with.
+  int64_t thread_count = 1;
+
+  // If true, the cells of each cluster and the clusters are sorted by name, as
+  // FindLogicClouds() above does. Otherwise the cells of each cluster are in
+  // the order they were added to the module, and the clusters in the order of
+  // their first cell, which avoids comparing names on large netlists.
+  bool sort_by_name = true;
+};
+
+// As above, with the given options.
+std::vector<Cluster> FindLogicClouds(const Module& module,
+                                     const FindLogicCloudsOptions& options);
+
 // Converts the clusters to a string suitable for debugging/testing.
 std::string ClustersToString(absl::Span<const Cluster> clusters);
 
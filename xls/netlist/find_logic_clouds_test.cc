@@ -133,6 +133,57 @@ cluster {
             ClustersToString(clusters));
 }
 
+TEST(ClusterTest, UnsortedParallelClustersAreInDeclarationOrder) {
+  // The AND gate reads a net with a fanout of several gates, which all end up
+  // in its cluster.
+  std::string netlist = R"(module main(clk, a0, b0, ao, bo, co);
+  input clk;
+  input a0, b0;
+  output ao, bo, co;
+  wire a1, b1, ab, an, bn;
+
+  DFF dff_b(.D(b0), .Q(b1), .CLK(clk));
+  DFF dff_a(.D(a0), .Q(a1), .CLK(clk));
+  INV inv_b(.A(b1), .ZN(bn));
+  AND and_ab(.A(a1), .B(b1), .Z(ab));
+  INV inv_a(.A(a1), .ZN(an));
+  DFF dff_an(.D(an), .Q(ao), .CLK(clk));
+  DFF dff_bn(.D(bn), .Q(bo), .CLK(clk));
+  DFF dff_ab(.D(ab), .Q(co), .CLK(clk));
+endmodule)";
+  Scanner scanner(netlist);
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Netlist> n,
+                           Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* m, n->GetModule("main"));
+  std::vector<Cluster> clusters = FindLogicClouds(
+      *m, FindLogicCloudsOptions{.include_vacuous = true,
+                                 .thread_count = 3,
+                                 .sort_by_name = false});
+  EXPECT_EQ(R"(cluster {
+  terminating_flop: dff_b
+}
+cluster {
+  terminating_flop: dff_a
+}
+cluster {
+  terminating_flop: dff_an
+  terminating_flop: dff_bn
+  terminating_flop: dff_ab
+  other_cell: inv_b
+  other_cell: and_ab
+  other_cell: inv_a
+}
+)",
+            ClustersToString(clusters));
+
+  // Sorting by name gives the same clusters as the original ordering.
+  EXPECT_EQ(ClustersToString(FindLogicClouds(
+                *m, FindLogicCloudsOptions{.include_vacuous = true,
+                                           .thread_count = 3})),
+            ClustersToString(FindLogicClouds(*m, /*include_vacuous=*/true)));
+}
+
 }  // namespace
 }  // namespace rtl
 }  // namespace netlist
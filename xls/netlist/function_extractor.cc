@@ -14,13 +14,16 @@
 
 #include "xls/netlist/function_extractor.h"
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -300,6 +303,50 @@ absl::StatusOr<CellLibraryProto> ExtractFunctions(
   return proto;
 }
 
+absl::StatusOr<CellLibraryProto> IndexCells(std::string_view text) {
+  XLS_ASSIGN_OR_RETURN(std::vector<cell_lib::CellLocation> cells,
+                       cell_lib::FindCells(text));
+  CellLibraryProto proto;
+  for (const cell_lib::CellLocation& cell : cells) {
+    LibertyCellOffsetProto* cell_proto = proto.add_liberty_cells();
+    cell_proto->set_name(cell.name);
+    cell_proto->set_offset(cell.offset);
+    cell_proto->set_size(cell.size);
+  }
+  return proto;
+}
+
+absl::StatusOr<CellLibraryEntryProto> ExtractCell(std::string_view cell_text) {
+  XLS_ASSIGN_OR_RETURN(cell_lib::CharStream stream,
+                       cell_lib::CharStream::FromText(std::string(cell_text)));
+  cell_lib::Scanner scanner(&stream);
+  cell_lib::Parser parser(&scanner);
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<cell_lib::Block> block,
+                       parser.ParseGroup("cell"));
+  CellLibraryEntryProto proto;
+  XLS_RETURN_IF_ERROR(ExtractFromCell(*block, &proto));
+  return proto;
+}
+
+std::function<absl::StatusOr<std::optional<CellLibraryEntryProto>>(
+    std::string_view name)>
+MakeCellLoader(std::string_view text, const CellLibraryProto& index) {
+  absl::flat_hash_map<std::string, std::string_view> cell_texts;
+  for (const LibertyCellOffsetProto& cell : index.liberty_cells()) {
+    cell_texts[cell.name()] = text.substr(cell.offset(), cell.size());
+  }
+  return [cell_texts = std::move(cell_texts)](std::string_view name)
+             -> absl::StatusOr<std::optional<CellLibraryEntryProto>> {
+    auto it = cell_texts.find(name);
+    if (it == cell_texts.end()) {
+      return std::nullopt;
+    }
+    XLS_ASSIGN_OR_RETURN(CellLibraryEntryProto proto, ExtractCell(it->second),
+                         _ << "while extracting cell " << name);
+    return proto;
+  };
+}
+
 }  // namespace function
 }  // namespace netlist
 }  // namespace xls
@@ -15,7 +15,10 @@
 #ifndef XLS_NETLIST_FUNCTION_EXTRACTOR_H_
 #define XLS_NETLIST_FUNCTION_EXTRACTOR_H_
 
+#include <functional>
+#include <optional>
 #include <string>
+#include <string_view>
 
 #include "absl/status/statusor.h"
 #include "xls/netlist/lib_parser.h"
@@ -31,6 +34,21 @@ namespace function {
 // logical operation of the cell or pin (in the case of multiple output pins).
 absl::StatusOr<CellLibraryProto> ExtractFunctions(cell_lib::CharStream* stream);
 
+// Builds an index of the cells in the Liberty-formatted `text`: the returned
+// proto has no entries, only the location of each cell's block. It can be
+// saved alongside the library so later loads skip the scan.
+absl::StatusOr<CellLibraryProto> IndexCells(std::string_view text);
+
+// As ExtractFunctions, but for the text of a single "cell" block.
+absl::StatusOr<CellLibraryEntryProto> ExtractCell(std::string_view cell_text);
+
+// Returns a loader for AbstractCellLibrary::SetEntryLoader which extracts the
+// cells located by `index` (as produced by IndexCells) out of `text` when they
+// are first referenced. `text` must outlive the loader.
+std::function<absl::StatusOr<std::optional<CellLibraryEntryProto>>(
+    std::string_view name)>
+MakeCellLoader(std::string_view text, const CellLibraryProto& index);
+
 }  // namespace function
 }  // namespace netlist
 }  // namespace xls
@@ -23,6 +23,7 @@
 #include "google/protobuf/text_format.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -35,19 +36,30 @@ ABSL_FLAG(std::string, output_path, "",
           "Path to the file in which to write the output.");
 ABSL_FLAG(bool, output_textproto, false,
           "If true, write the output as a text-format protobuf.");
+ABSL_FLAG(bool, index_only, false,
+          "If true, only record where each cell is in the library instead of "
+          "extracting the cells. Cells are then extracted as they are used.");
 
 namespace xls::netlist::function {
 
 static absl::Status RealMain(const std::string& cell_library_path,
                              const std::string& output_path,
-                             bool output_textproto) {
-  XLS_ASSIGN_OR_RETURN(std::string cell_library_text,
-                       GetFileContents(cell_library_path));
-  XLS_ASSIGN_OR_RETURN(
-      auto char_stream,
-      netlist::cell_lib::CharStream::FromText(cell_library_text));
-  XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto lib_proto,
-                       netlist::function::ExtractFunctions(&char_stream));
+                             bool output_textproto, bool index_only) {
+  netlist::CellLibraryProto lib_proto;
+  if (index_only) {
+    XLS_ASSIGN_OR_RETURN(MappedFile cell_library_file,
+                         MappedFile::Open(cell_library_path));
+    XLS_ASSIGN_OR_RETURN(
+        lib_proto, netlist::function::IndexCells(cell_library_file.contents()));
+  } else {
+    XLS_ASSIGN_OR_RETURN(std::string cell_library_text,
+                         GetFileContents(cell_library_path));
+    XLS_ASSIGN_OR_RETURN(
+        auto char_stream,
+        netlist::cell_lib::CharStream::FromText(cell_library_text));
+    XLS_ASSIGN_OR_RETURN(lib_proto,
+                         netlist::function::ExtractFunctions(&char_stream));
+  }
 
   if (output_textproto) {
     std::string output;
@@ -69,5 +81,6 @@ int main(int argc, char* argv[]) {
   QCHECK(!output_path.empty()) << "--output_path must be specified.";
 
   return xls::ExitStatus(xls::netlist::function::RealMain(
-      cell_library_path, output_path, absl::GetFlag(FLAGS_output_textproto)));
+      cell_library_path, output_path, absl::GetFlag(FLAGS_output_textproto),
+      absl::GetFlag(FLAGS_index_only)));
 }
@@ -14,11 +14,15 @@
 
 #include "xls/netlist/function_extractor.h"
 
+#include <optional>
 #include <string>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
 #include "xls/common/status/matchers.h"
+#include "xls/netlist/cell_library.h"
 #include "xls/netlist/lib_parser.h"
 #include "xls/netlist/netlist.pb.h"
 
@@ -27,6 +31,8 @@ namespace netlist {
 namespace function {
 namespace {
 
+using status_testing::StatusIs;
+
 TEST(FunctionExtractorTest, BasicFunctionality) {
   std::string lib = R"(
 library (blah) {
@@ -217,6 +223,65 @@ library (simple_statetable_cells) {
   EXPECT_EQ(row.next_internal_signals().at("X"), STATE_TABLE_SIGNAL_HIGH);
 }
 
+TEST(FunctionExtractorTest, IndexAndLoadCellsOnDemand) {
+  std::string lib = R"(
+library (blah) {
+  /* cell (not_a_cell) { } */
+  blah: "cell (also_not_a_cell) { }";
+  cell (cell_1) {
+    pin (i) {
+      direction: input;
+    }
+    pin (o) {
+      direction: output;
+      function: "!i";
+    }
+  }
+  cell ("cell_2") {
+    pin (i) { direction: input; }
+    pin (o) { direction: output; function: "i"; }
+  }
+})";
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto index, IndexCells(lib));
+  EXPECT_EQ(index.entries_size(), 0);
+  ASSERT_EQ(index.liberty_cells_size(), 2);
+  EXPECT_EQ(index.liberty_cells(0).name(), "cell_1");
+  EXPECT_EQ(index.liberty_cells(1).name(), "cell_2");
+  EXPECT_EQ(lib.substr(index.liberty_cells(1).offset(),
+                       index.liberty_cells(1).size()),
+            R"(cell ("cell_2") {
+    pin (i) { direction: input; }
+    pin (o) { direction: output; function: "i"; }
+  })");
+
+  auto loader = MakeCellLoader(lib, index);
+  XLS_ASSERT_OK_AND_ASSIGN(std::optional<CellLibraryEntryProto> entry,
+                           loader("cell_1"));
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->name(), "cell_1");
+  ASSERT_EQ(entry->input_names_size(), 1);
+  EXPECT_EQ(entry->input_names(0), "i");
+  ASSERT_EQ(entry->output_pin_list().pins_size(), 1);
+  EXPECT_EQ(entry->output_pin_list().pins(0).function(), "!i");
+
+  XLS_ASSERT_OK_AND_ASSIGN(entry, loader("not_a_cell"));
+  EXPECT_FALSE(entry.has_value());
+
+  // A library built from the index materializes cells as they are looked up.
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library,
+                           CellLibrary::FromProto(index));
+  cell_library.SetEntryLoader(loader);
+  XLS_ASSERT_OK_AND_ASSIGN(const CellLibraryEntry* cell_2,
+                           cell_library.GetEntry("cell_2"));
+  EXPECT_EQ(cell_2->name(), "cell_2");
+  XLS_ASSERT_OK_AND_ASSIGN(const CellLibraryEntry* cell_2_again,
+                           cell_library.GetEntry("cell_2"));
+  EXPECT_EQ(cell_2, cell_2_again);
+  EXPECT_THAT(cell_library.GetEntry("cell_3"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
 }  // namespace
 }  // namespace function
 }  // namespace netlist
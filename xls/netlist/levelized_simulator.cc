@@ -0,0 +1,409 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/netlist/levelized_simulator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/function_parser.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+// Returns the net ultimately assigned to `net` by the module's assign
+// statements.
+absl::StatusOr<rtl::NetRef> FollowAssigns(const rtl::Module* module,
+                                          rtl::NetRef net) {
+  for (int64_t i = 0; i <= module->assigns().size(); ++i) {
+    auto it = module->assigns().find(net);
+    if (it == module->assigns().end()) {
+      return net;
+    }
+    net = it->second;
+  }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Assignments to net \"%s\" in module \"%s\" form a cycle",
+                      net->name(), module->name()));
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<LevelizedSimulator> LevelizedSimulator::Create(
+    const rtl::Netlist& netlist, const rtl::Module* module) {
+  LevelizedSimulator simulator(netlist);
+  NetSlots net_slots;
+  for (rtl::NetRef input : module->inputs()) {
+    uint32_t slot = simulator.NewSlot(/*level=*/0);
+    net_slots[input] = slot;
+    simulator.input_slots_.push_back(slot);
+  }
+  XLS_RETURN_IF_ERROR(simulator.CompileModule(module, net_slots));
+  for (rtl::NetRef output : module->outputs()) {
+    XLS_ASSIGN_OR_RETURN(uint32_t slot,
+                         simulator.ResolveSlot(module, net_slots, output));
+    simulator.output_slots_.push_back(slot);
+  }
+  simulator.level_count_ = *std::max_element(simulator.slot_levels_.begin(),
+                                             simulator.slot_levels_.end());
+  simulator.parsed_functions_.clear();
+  return simulator;
+}
+
+absl::Status LevelizedSimulator::CompileModule(const rtl::Module* module,
+                                               NetSlots& net_slots) {
+  absl::Span<const std::unique_ptr<rtl::Cell>> cells = module->cells();
+
+  // Find the cell driving each net.
+  absl::flat_hash_map<rtl::NetRef, int64_t> driver;
+  for (int64_t i = 0; i < cells.size(); ++i) {
+    for (const rtl::Cell::OutputPin& output : cells[i]->outputs()) {
+      if (output.netref != module->GetDummyRef()) {
+        driver[output.netref] = i;
+      }
+    }
+  }
+
+  // Levelize the cells of the module: a cell's level is one more than the
+  // maximum level of the cells driving its inputs.
+  std::vector<std::vector<int64_t>> users(cells.size());
+  std::vector<int64_t> pending_inputs(cells.size(), 0);
+  for (int64_t i = 0; i < cells.size(); ++i) {
+    for (const rtl::Cell::Pin& input : cells[i]->inputs()) {
+      XLS_ASSIGN_OR_RETURN(rtl::NetRef net,
+                           FollowAssigns(module, input.netref));
+      auto it = driver.find(net);
+      if (it != driver.end()) {
+        users[it->second].push_back(i);
+        ++pending_inputs[i];
+      }
+    }
+  }
+  std::vector<int64_t> levels(cells.size(), 0);
+  std::deque<int64_t> worklist;
+  for (int64_t i = 0; i < cells.size(); ++i) {
+    if (pending_inputs[i] == 0) {
+      worklist.push_back(i);
+    }
+  }
+  std::vector<int64_t> order;
+  order.reserve(cells.size());
+  while (!worklist.empty()) {
+    int64_t i = worklist.front();
+    worklist.pop_front();
+    order.push_back(i);
+    for (int64_t user : users[i]) {
+      levels[user] = std::max(levels[user], levels[i] + 1);
+      if (--pending_inputs[user] == 0) {
+        worklist.push_back(user);
+      }
+    }
+  }
+  if (order.size() != cells.size()) {
+    for (int64_t i = 0; i < cells.size(); ++i) {
+      if (pending_inputs[i] != 0) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Module \"%s\" is not combinational: cell \"%s\" is part of a "
+            "cycle",
+            module->name(), cells[i]->name()));
+      }
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return levels[a] < levels[b];
+  });
+
+  for (int64_t i : order) {
+    const rtl::Cell& cell = *cells[i];
+    std::vector<uint32_t> input_slots;
+    input_slots.reserve(cell.inputs().size());
+    for (const rtl::Cell::Pin& input : cell.inputs()) {
+      XLS_ASSIGN_OR_RETURN(uint32_t slot,
+                           ResolveSlot(module, net_slots, input.netref));
+      input_slots.push_back(slot);
+    }
+
+    std::optional<const rtl::Module*> submodule =
+        netlist_->MaybeGetModule(cell.cell_library_entry()->name());
+    if (!submodule.has_value()) {
+      XLS_RETURN_IF_ERROR(CompileCell(cell, input_slots, net_slots));
+      continue;
+    }
+
+    // Inline the instantiated module: its inputs share the slots of the
+    // cell's input nets and the cell's output nets share the slots of the
+    // module's outputs.
+    const rtl::Module* child = submodule.value();
+    absl::Span<const std::string> child_input_names =
+        child->AsCellLibraryEntry()->input_names();
+    NetSlots child_slots;
+    for (int64_t j = 0; j < cell.inputs().size(); ++j) {
+      auto it = std::find(child_input_names.begin(), child_input_names.end(),
+                          cell.inputs()[j].name);
+      XLS_RET_CHECK(it != child_input_names.end()) << absl::StrFormat(
+          "Could not find input pin \"%s\" in module \"%s\", referenced in "
+          "cell \"%s\"",
+          cell.inputs()[j].name, child->name(), cell.name());
+      child_slots[child->inputs()[it - child_input_names.begin()]] =
+          input_slots[j];
+    }
+    XLS_RETURN_IF_ERROR(CompileModule(child, child_slots));
+    for (const rtl::Cell::OutputPin& output : cell.outputs()) {
+      auto it = std::find_if(
+          child->outputs().begin(), child->outputs().end(),
+          [&](rtl::NetRef net) { return net->name() == output.name; });
+      XLS_RET_CHECK(it != child->outputs().end()) << absl::StrFormat(
+          "Could not find output pin \"%s\" in module \"%s\", referenced in "
+          "cell \"%s\"",
+          output.name, child->name(), cell.name());
+      XLS_ASSIGN_OR_RETURN(net_slots[output.netref],
+                           ResolveSlot(child, child_slots, *it));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status LevelizedSimulator::CompileCell(
+    const rtl::Cell& cell, absl::Span<const uint32_t> input_slots,
+    NetSlots& net_slots) {
+  ++cell_count_;
+  int64_t level = 0;
+  for (uint32_t slot : input_slots) {
+    level = std::max(level, slot_levels_[slot]);
+  }
+  ++level;
+
+  const CellLibraryEntry* entry = cell.cell_library_entry();
+  for (const rtl::Cell::OutputPin& output : cell.outputs()) {
+    uint32_t dst = NewSlot(level);
+    net_slots[output.netref] = dst;
+    if (output.eval != nullptr) {
+      // The order of the arguments is the order of the cell's inputs.
+      callbacks_.push_back(Callback{
+          .args = std::vector<uint32_t>(input_slots.begin(),
+                                        input_slots.end()),
+          .fn = output.eval});
+      Emit(OpKind::kCallback, dst, callbacks_.size() - 1);
+      continue;
+    }
+    auto it = entry->output_pin_to_function().find(output.name);
+    if (it == entry->output_pin_to_function().end()) {
+      return absl::NotFoundError(absl::StrFormat(
+          "No function for output pin \"%s\" of cell \"%s\"", output.name,
+          cell.name()));
+    }
+    XLS_ASSIGN_OR_RETURN(const function::Ast* ast, ParseFunction(it->second));
+    XLS_RETURN_IF_ERROR(
+        CompileAst(cell, input_slots, *ast, level, dst).status());
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<uint32_t> LevelizedSimulator::CompileAst(
+    const rtl::Cell& cell, absl::Span<const uint32_t> input_slots,
+    const function::Ast& ast, int64_t level, std::optional<uint32_t> dst) {
+  auto compile_unary = [&](OpKind kind) -> absl::StatusOr<uint32_t> {
+    XLS_ASSIGN_OR_RETURN(uint32_t operand,
+                         CompileAst(cell, input_slots, ast.children()[0],
+                                    level, std::nullopt));
+    uint32_t result = dst.has_value() ? *dst : NewSlot(level);
+    Emit(kind, result, operand);
+    return result;
+  };
+  auto compile_binary = [&](OpKind kind) -> absl::StatusOr<uint32_t> {
+    XLS_ASSIGN_OR_RETURN(uint32_t lhs,
+                         CompileAst(cell, input_slots, ast.children()[0],
+                                    level, std::nullopt));
+    XLS_ASSIGN_OR_RETURN(uint32_t rhs,
+                         CompileAst(cell, input_slots, ast.children()[1],
+                                    level, std::nullopt));
+    uint32_t result = dst.has_value() ? *dst : NewSlot(level);
+    Emit(kind, result, lhs, rhs);
+    return result;
+  };
+  // Leaves only need an instruction if the value must land in `dst`.
+  auto leaf = [&](uint32_t slot) -> uint32_t {
+    if (!dst.has_value()) {
+      return slot;
+    }
+    Emit(OpKind::kCopy, *dst, slot);
+    return *dst;
+  };
+
+  switch (ast.kind()) {
+    case function::Ast::Kind::kLiteralZero:
+      return leaf(kZeroSlot);
+    case function::Ast::Kind::kLiteralOne:
+      return leaf(kOneSlot);
+    case function::Ast::Kind::kNot:
+      return compile_unary(OpKind::kNot);
+    case function::Ast::Kind::kAnd:
+      return compile_binary(OpKind::kAnd);
+    case function::Ast::Kind::kOr:
+      return compile_binary(OpKind::kOr);
+    case function::Ast::Kind::kXor:
+      return compile_binary(OpKind::kXor);
+    case function::Ast::Kind::kIdentifier:
+      break;
+  }
+
+  const std::string name = ast.name();
+  for (int64_t i = 0; i < cell.inputs().size(); ++i) {
+    if (cell.inputs()[i].name == name) {
+      return leaf(input_slots[i]);
+    }
+  }
+
+  // Internal pins are defined by the cell's state table, which is evaluated
+  // one lane at a time with the cell's input pins as the stimulus.
+  for (const rtl::Cell::Pin& internal : cell.internal_pins()) {
+    if (internal.name != name) {
+      continue;
+    }
+    XLS_RET_CHECK(cell.cell_library_entry()->state_table().has_value());
+    const StateTable* state_table =
+        &cell.cell_library_entry()->state_table().value();
+    std::vector<std::string> input_names;
+    for (const rtl::Cell::Pin& input : cell.inputs()) {
+      input_names.push_back(input.name);
+    }
+    callbacks_.push_back(Callback{
+        .args = std::vector<uint32_t>(input_slots.begin(), input_slots.end()),
+        .fn = [state_table, input_names = std::move(input_names),
+               name](const std::vector<bool>& args) -> absl::StatusOr<bool> {
+          StateTable::InputStimulus stimulus;
+          for (int64_t i = 0; i < args.size(); ++i) {
+            stimulus[input_names[i]] = args[i];
+          }
+          return state_table->GetSignalValue(stimulus, name);
+        }});
+    uint32_t result = dst.has_value() ? *dst : NewSlot(level);
+    Emit(OpKind::kCallback, result, callbacks_.size() - 1);
+    return result;
+  }
+
+  return absl::NotFoundError(absl::StrFormat(
+      "Identifier \"%s\" not found in cell %s's inputs or internal signals.",
+      name, cell.name()));
+}
+
+absl::StatusOr<uint32_t> LevelizedSimulator::ResolveSlot(
+    const rtl::Module* module, const NetSlots& net_slots,
+    rtl::NetRef net) const {
+  XLS_ASSIGN_OR_RETURN(rtl::NetRef source, FollowAssigns(module, net));
+  if (source == module->zero()) {
+    return kZeroSlot;
+  }
+  if (source == module->one()) {
+    return kOneSlot;
+  }
+  auto it = net_slots.find(source);
+  if (it == net_slots.end()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Net \"%s\" in module \"%s\" is not driven",
+                        net->name(), module->name()));
+  }
+  return it->second;
+}
+
+absl::StatusOr<const function::Ast*> LevelizedSimulator::ParseFunction(
+    const std::string& function) {
+  auto it = parsed_functions_.find(function);
+  if (it == parsed_functions_.end()) {
+    XLS_ASSIGN_OR_RETURN(function::Ast ast,
+                         function::Parser::ParseFunction(function));
+    it = parsed_functions_
+             .emplace(function, std::make_unique<function::Ast>(std::move(ast)))
+             .first;
+  }
+  return it->second.get();
+}
+
+absl::StatusOr<std::vector<uint64_t>> LevelizedSimulator::Run(
+    absl::Span<const uint64_t> inputs) const {
+  if (inputs.size() != input_slots_.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected %d inputs, got %d", input_slots_.size(),
+                        inputs.size()));
+  }
+  std::vector<uint64_t> slots(slot_levels_.size());
+  slots[kZeroSlot] = 0;
+  slots[kOneSlot] = ~uint64_t{0};
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    slots[input_slots_[i]] = inputs[i];
+  }
+
+  std::vector<bool> args;
+  for (const Instruction& instruction : instructions_) {
+    uint64_t& dst = slots[instruction.dst];
+    switch (instruction.kind) {
+      case OpKind::kCopy:
+        dst = slots[instruction.lhs];
+        break;
+      case OpKind::kNot:
+        dst = ~slots[instruction.lhs];
+        break;
+      case OpKind::kAnd:
+        dst = slots[instruction.lhs] & slots[instruction.rhs];
+        break;
+      case OpKind::kOr:
+        dst = slots[instruction.lhs] | slots[instruction.rhs];
+        break;
+      case OpKind::kXor:
+        dst = slots[instruction.lhs] ^ slots[instruction.rhs];
+        break;
+      case OpKind::kCallback: {
+        const Callback& callback = callbacks_[instruction.lhs];
+        args.resize(callback.args.size());
+        uint64_t result = 0;
+        for (int64_t lane = 0; lane < kLaneCount; ++lane) {
+          for (int64_t i = 0; i < callback.args.size(); ++i) {
+            args[i] = (slots[callback.args[i]] >> lane) & 1;
+          }
+          XLS_ASSIGN_OR_RETURN(bool value, callback.fn(args));
+          result |= static_cast<uint64_t>(value) << lane;
+        }
+        dst = result;
+        break;
+      }
+    }
+  }
+
+  std::vector<uint64_t> outputs;
+  outputs.reserve(output_slots_.size());
+  for (uint32_t slot : output_slots_) {
+    outputs.push_back(slots[slot]);
+  }
+  return outputs;
+}
+
+}  // namespace netlist
+}  // namespace xls
@@ -0,0 +1,167 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_NETLIST_LEVELIZED_SIMULATOR_H_
+#define XLS_NETLIST_LEVELIZED_SIMULATOR_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/netlist/function_parser.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+
+// Simulates a combinational netlist module many input vectors at a time.
+//
+// Unlike the (Abstract)Interpreter, which discovers the evaluation order of
+// cells anew for every input and re-walks each cell's function AST, the
+// simulator orders the cells of the module by level once at construction
+// (flattening any submodule instances) and compiles each cell's function into
+// a flat sequence of bitwise operations over a table of 64-bit slots. Each
+// slot holds the value of one net for 64 independent input vectors, so a
+// single pass over the program evaluates 64 vectors. Output pins with
+// user-provided evaluation functions and pins defined by state tables can't be
+// expressed as bitwise operations; they are evaluated one lane at a time.
+//
+// The simulator refers to the cell library entries of the netlist, which must
+// outlive it.
+class LevelizedSimulator {
+ public:
+  // Number of input vectors evaluated by each call to Run.
+  static constexpr int64_t kLaneCount = 64;
+
+  static absl::StatusOr<LevelizedSimulator> Create(
+      const rtl::Netlist& netlist, const rtl::Module* module);
+
+  // Evaluates the module for up to kLaneCount input vectors. `inputs[i]` holds
+  // the values of the module's i-th input net (in the order of
+  // Module::inputs()), with bit j of the word being the value of the net in
+  // vector j. Returns the values of the module's output nets (in the order of
+  // Module::outputs()) in the same layout.
+  absl::StatusOr<std::vector<uint64_t>> Run(
+      absl::Span<const uint64_t> inputs) const;
+
+  int64_t input_count() const { return input_slots_.size(); }
+  int64_t output_count() const { return output_slots_.size(); }
+
+  // The number of cells (after flattening submodules) and the length of the
+  // longest chain of cells in the module.
+  int64_t cell_count() const { return cell_count_; }
+  int64_t level_count() const { return level_count_; }
+
+  // Number of operations executed per pass.
+  int64_t instruction_count() const { return instructions_.size(); }
+
+ private:
+  enum class OpKind : uint8_t {
+    kCopy,
+    kNot,
+    kAnd,
+    kOr,
+    kXor,
+    // Evaluates callbacks_[lhs] for each lane.
+    kCallback,
+  };
+
+  struct Instruction {
+    OpKind kind;
+    uint32_t dst;
+    uint32_t lhs;
+    uint32_t rhs;
+  };
+
+  // A function of the values of a cell's input pins which is evaluated one
+  // lane at a time.
+  struct Callback {
+    std::vector<uint32_t> args;
+    std::function<absl::StatusOr<bool>(const std::vector<bool>&)> fn;
+  };
+
+  // Slots holding the constant nets.
+  static constexpr uint32_t kZeroSlot = 0;
+  static constexpr uint32_t kOneSlot = 1;
+
+  explicit LevelizedSimulator(const rtl::Netlist& netlist)
+      : netlist_(&netlist) {}
+
+  using NetSlots = absl::flat_hash_map<rtl::NetRef, uint32_t>;
+
+  // Emits the instructions computing every cell of `module`, inlining
+  // instances of other modules of the netlist. `net_slots` must hold the slots
+  // of the module's inputs and is updated with the slots of every net driven
+  // by a cell.
+  absl::Status CompileModule(const rtl::Module* module, NetSlots& net_slots);
+
+  // Emits the instructions computing the output pins of the library cell
+  // `cell` whose input pins are held in `input_slots`.
+  absl::Status CompileCell(const rtl::Cell& cell,
+                           absl::Span<const uint32_t> input_slots,
+                           NetSlots& net_slots);
+
+  // Emits the instructions for `ast` and returns the slot holding its value.
+  // The value is computed into `dst` if given.
+  absl::StatusOr<uint32_t> CompileAst(const rtl::Cell& cell,
+                                      absl::Span<const uint32_t> input_slots,
+                                      const function::Ast& ast, int64_t level,
+                                      std::optional<uint32_t> dst);
+
+  // Returns the slot holding the value of `net`, following assignments.
+  absl::StatusOr<uint32_t> ResolveSlot(const rtl::Module* module,
+                                       const NetSlots& net_slots,
+                                       rtl::NetRef net) const;
+
+  absl::StatusOr<const function::Ast*> ParseFunction(
+      const std::string& function);
+
+  // Returns a new slot computed at the given level.
+  uint32_t NewSlot(int64_t level) {
+    slot_levels_.push_back(level);
+    return slot_levels_.size() - 1;
+  }
+  void Emit(OpKind kind, uint32_t dst, uint32_t lhs, uint32_t rhs = 0) {
+    instructions_.push_back(Instruction{kind, dst, lhs, rhs});
+  }
+
+  const rtl::Netlist* netlist_;
+  std::vector<Instruction> instructions_;
+  std::vector<Callback> callbacks_;
+  std::vector<uint32_t> input_slots_;
+  std::vector<uint32_t> output_slots_;
+  int64_t cell_count_ = 0;
+  int64_t level_count_ = 0;
+
+  // The level of the cell computing each slot; module inputs and constants are
+  // at level zero.
+  std::vector<int64_t> slot_levels_ = {0, 0};
+
+  // Cell functions are shared by many cells, so each is only parsed once.
+  absl::flat_hash_map<std::string, std::unique_ptr<function::Ast>>
+      parsed_functions_;
+};
+
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_LEVELIZED_SIMULATOR_H_
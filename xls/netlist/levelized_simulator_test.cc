@@ -0,0 +1,232 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/netlist/levelized_simulator.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/fake_cell_library.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+using status_testing::StatusIs;
+using testing::HasSubstr;
+
+// Evaluates every combination of the (at most six) inputs of `module` in a
+// single pass of the simulator and compares each lane against the
+// interpreter.
+void ExpectMatchesInterpreter(rtl::Netlist* netlist,
+                              const rtl::Module* module) {
+  int64_t input_count = module->inputs().size();
+  ASSERT_LE(input_count, 6);
+  XLS_ASSERT_OK_AND_ASSIGN(LevelizedSimulator simulator,
+                           LevelizedSimulator::Create(*netlist, module));
+  ASSERT_EQ(simulator.input_count(), input_count);
+  ASSERT_EQ(simulator.output_count(), module->outputs().size());
+
+  // Bit `j` of input `i` is bit `i` of the vector index `j`.
+  std::vector<uint64_t> inputs(input_count, 0);
+  for (int64_t j = 0; j < LevelizedSimulator::kLaneCount; ++j) {
+    for (int64_t i = 0; i < input_count; ++i) {
+      inputs[i] |= static_cast<uint64_t>((j >> i) & 1) << j;
+    }
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<uint64_t> outputs,
+                           simulator.Run(inputs));
+  ASSERT_EQ(outputs.size(), module->outputs().size());
+
+  Interpreter interpreter(netlist);
+  for (int64_t j = 0; j < (int64_t{1} << input_count); ++j) {
+    NetRef2Value interpreter_inputs;
+    for (int64_t i = 0; i < input_count; ++i) {
+      interpreter_inputs[module->inputs()[i]] = (j >> i) & 1;
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(
+        NetRef2Value expected,
+        interpreter.InterpretModule(module, interpreter_inputs));
+    for (int64_t i = 0; i < outputs.size(); ++i) {
+      EXPECT_EQ((outputs[i] >> j) & 1, expected.at(module->outputs()[i]))
+          << "output " << module->outputs()[i]->name() << ", vector " << j;
+    }
+  }
+}
+
+TEST(LevelizedSimulatorTest, Submodules) {
+  std::string module_text = R"(
+module submodule_0 (i2_0, i2_1, o2_0);
+  input i2_0, i2_1;
+  output o2_0;
+
+  AND and0( .A(i2_0), .B(i2_1), .Z(o2_0) );
+endmodule
+
+module submodule_1 (i2_2, i2_3, o2_1);
+  input i2_2, i2_3;
+  output o2_1;
+
+  OR or0( .A(i2_2), .B(i2_3), .Z(o2_1) );
+endmodule
+
+module submodule_2 (i1_0, i1_1, i1_2, i1_3, o1_0);
+  input i1_0, i1_1, i1_2, i1_3;
+  output o1_0;
+  wire res0, res1;
+
+  submodule_0 and0 ( .i2_0(i1_0), .i2_1(i1_1), .o2_0(res0) );
+  submodule_1 or0 ( .i2_2(i1_2), .i2_3(i1_3), .o2_1(res1) );
+  XOR xor0 ( .A(res0), .B(res1), .Z(o1_0) );
+endmodule
+
+module main (i0, i1, i2, i3, o0);
+  input i0, i1, i2, i3;
+  output o0;
+
+  submodule_2 bleh( .i1_0(i0), .i1_1(i1), .i1_2(i2), .i1_3(i3), .o1_0(o0) );
+endmodule
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(LevelizedSimulator simulator,
+                           LevelizedSimulator::Create(*netlist, module));
+  EXPECT_EQ(simulator.cell_count(), 3);
+  EXPECT_EQ(simulator.level_count(), 2);
+  ExpectMatchesInterpreter(netlist.get(), module);
+}
+
+TEST(LevelizedSimulatorTest, StateTables) {
+  std::string module_text = R"(
+module main(i0, i1, i2, i3, o0, o1);
+  input i0, i1, i2, i3;
+  output o0, o1;
+  wire and0_out, and1_out, inv_out;
+
+  AND and0 ( .A(i0), .B(i1), .Z(and0_out) );
+  STATETABLE_AND and1 (.A(i2), .B(i3), .Z(and1_out) );
+  INV inv0 ( .A(and1_out), .ZN(inv_out) );
+  AND and2 ( .A(and0_out), .B(and1_out), .Z(o0) );
+  OR or0 ( .A(inv_out), .B(i0), .Z(o1) );
+endmodule
+  )";
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  ExpectMatchesInterpreter(netlist.get(), module);
+}
+
+TEST(LevelizedSimulatorTest, ComplexMixedInputAndWireAssigns) {
+  std::string module_text = R"(
+module main (A, B, out);
+  input A;
+  input B;
+  wire [1:0] i0;
+  wire [2:0] i1;
+  wire [3:0] i2;
+  wire [4:0] i3;
+  output [15:0] out;
+  wire [15:0] out;
+
+  assign i0 = { A, B };
+  assign i1 = { 1'b1, i0 };
+  assign { i2, i3 }  = { i1, i1, i1, i1 };
+  assign out = { i3, i2, 7'h4a };
+endmodule
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(LevelizedSimulator simulator,
+                           LevelizedSimulator::Create(*netlist, module));
+  EXPECT_EQ(simulator.cell_count(), 0);
+  EXPECT_EQ(simulator.instruction_count(), 0);
+  ExpectMatchesInterpreter(netlist.get(), module);
+}
+
+TEST(LevelizedSimulatorTest, RejectsCycles) {
+  std::string module_text = R"(
+module main(i0, o0);
+  input i0;
+  output o0;
+  wire a, b;
+
+  AND and0 ( .A(i0), .B(b), .Z(a) );
+  AND and1 ( .A(a), .B(i0), .Z(b) );
+  AND and2 ( .A(a), .B(b), .Z(o0) );
+endmodule
+  )";
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  EXPECT_THAT(LevelizedSimulator::Create(*netlist, module),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("is part of a cycle")));
+}
+
+TEST(LevelizedSimulatorTest, WrongInputCount) {
+  std::string module_text = R"(
+module main(i0, i1, o0);
+  input i0, i1;
+  output o0;
+
+  AND and0 ( .A(i0), .B(i1), .Z(o0) );
+endmodule
+  )";
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(LevelizedSimulator simulator,
+                           LevelizedSimulator::Create(*netlist, module));
+  EXPECT_THAT(simulator.Run({0}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
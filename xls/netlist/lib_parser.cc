@@ -29,6 +29,7 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -399,6 +400,96 @@ absl::StatusOr<std::unique_ptr<Block>> Parser::ParseBlock(
   return block;
 }
 
+absl::StatusOr<std::vector<CellLocation>> FindCells(std::string_view text) {
+  std::vector<CellLocation> cells;
+  auto is_identifier_char = [](char c) {
+    return std::isalnum(c) != 0 || c == '_';
+  };
+  auto at = [&](int64_t i, std::string_view s) {
+    return text.substr(i, s.size()) == s;
+  };
+
+  // Nesting depth of curly braces; cells are blocks at depth 1, i.e. directly
+  // within the "library" block.
+  int64_t depth = 0;
+  // The cell whose block is being scanned, if any, and whether its opening
+  // curly brace has been seen yet.
+  std::optional<CellLocation> cell;
+  bool cell_open = false;
+  int64_t i = 0;
+  while (i < text.size()) {
+    char c = text[i];
+    if (at(i, "/*")) {
+      size_t end = text.find("*/", i + 2);
+      i = end == std::string_view::npos ? text.size() : end + 2;
+    } else if (at(i, "//")) {
+      size_t end = text.find('\n', i + 2);
+      i = end == std::string_view::npos ? text.size() : end + 1;
+    } else if (c == '"') {
+      size_t end = text.find('"', i + 1);
+      if (end == std::string_view::npos) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Unexpected end-of-file in string starting at offset %d", i));
+      }
+      i = end + 1;
+    } else if (c == '{') {
+      if (cell.has_value() && depth == 1) {
+        cell_open = true;
+      }
+      ++depth;
+      ++i;
+    } else if (c == '}') {
+      if (depth == 0) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Unbalanced '}' at offset %d", i));
+      }
+      --depth;
+      ++i;
+      if (cell.has_value() && cell_open && depth == 1) {
+        cell->size = i - cell->offset;
+        cells.push_back(*std::move(cell));
+        cell = std::nullopt;
+        cell_open = false;
+      }
+    } else if (c == ';' && depth == 1 && cell.has_value() && !cell_open) {
+      // A "cell (name);" statement without a body.
+      cell = std::nullopt;
+      ++i;
+    } else if (is_identifier_char(c)) {
+      int64_t start = i;
+      while (i < text.size() && is_identifier_char(text[i])) {
+        ++i;
+      }
+      if (depth != 1 || cell.has_value() ||
+          text.substr(start, i - start) != "cell") {
+        continue;
+      }
+      size_t open = text.find_first_not_of(" \t\n\\", i);
+      if (open == std::string_view::npos || text[open] != '(') {
+        continue;
+      }
+      size_t close = text.find(')', open);
+      if (close == std::string_view::npos) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Unterminated cell name starting at offset %d", open));
+      }
+      std::string_view name = absl::StripAsciiWhitespace(
+          text.substr(open + 1, close - open - 1));
+      if (name.size() >= 2 && name.front() == '"' && name.back() == '"') {
+        name = name.substr(1, name.size() - 2);
+      }
+      cell = CellLocation{std::string(name), start, 0};
+      i = close + 1;
+    } else {
+      ++i;
+    }
+  }
+  if (depth != 0) {
+    return absl::InvalidArgumentError("Unexpected end-of-file within a block");
+  }
+  return cells;
+}
+
 }  // namespace cell_lib
 }  // namespace netlist
 }  // namespace xls
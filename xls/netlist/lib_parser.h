@@ -366,6 +366,13 @@ class Parser {
     return ParseBlock("library");
   }
 
+  // Parses a single block of the given kind; e.g. a "cell" block located by
+  // FindCells().
+  absl::StatusOr<std::unique_ptr<Block>> ParseGroup(std::string_view kind) {
+    XLS_RETURN_IF_ERROR(DropIdentifierOrError(kind));
+    return ParseBlock(std::string(kind));
+  }
+
  private:
   absl::StatusOr<bool> TryDropToken(TokenKind target, Pos* pos = nullptr);
   absl::Status DropTokenOrError(TokenKind kind);
@@ -407,6 +414,21 @@ class Parser {
   std::optional<absl::flat_hash_set<std::string>> kind_allowlist_;
 };
 
+// The location of a "cell" block within the text of a library.
+struct CellLocation {
+  std::string name;
+  // Byte offset of the "cell" keyword.
+  int64_t offset;
+  // Size of the block in bytes, through its closing curly brace.
+  int64_t size;
+};
+
+// Finds the cells of the library in `text` without tokenizing or parsing it:
+// only comments, quoted strings and curly braces are recognized. This is much
+// cheaper than parsing a whole library when only a few of its cells are
+// needed; each cell can then be parsed on its own with Parser::ParseGroup.
+absl::StatusOr<std::vector<CellLocation>> FindCells(std::string_view text);
+
 }  // namespace cell_lib
 }  // namespace netlist
 }  // namespace xls
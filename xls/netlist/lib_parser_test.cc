@@ -18,6 +18,7 @@
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
@@ -163,6 +164,42 @@ library (foo) {
             "))");
 }
 
+TEST(LibParserTest, FindCells) {
+  std::string text = R"(
+library (foo) {
+  // cell (commented) {
+  cell (and2) {
+    pin (o) { function: "a}b"; }
+  }
+  cell (decl_only);
+  group (g) {
+    cell (nested) { }
+  }
+  cell ( "or2" ) { }
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<CellLocation> cells, FindCells(text));
+  ASSERT_EQ(cells.size(), 2);
+  EXPECT_EQ(cells[0].name, "and2");
+  EXPECT_EQ(text.substr(cells[0].offset, cells[0].size),
+            "cell (and2) {\n    pin (o) { function: \"a}b\"; }\n  }");
+  EXPECT_EQ(cells[1].name, "or2");
+  EXPECT_EQ(text.substr(cells[1].offset, cells[1].size),
+            "cell ( \"or2\" ) { }");
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto cs,
+      CharStream::FromText(text.substr(cells[0].offset, cells[0].size)));
+  Scanner scanner(&cs);
+  Parser parser(&scanner);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Block> cell,
+                           parser.ParseGroup("cell"));
+  EXPECT_EQ(cell->ToString(),
+            "(block cell (and2) ((block pin (o) ((function \"a}b\")))))");
+
+  EXPECT_FALSE(FindCells("library (foo) { cell (x) {").ok());
+}
+
 }  // namespace
 }  // namespace cell_lib
 }  // namespace netlist
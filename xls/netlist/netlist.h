@@ -502,7 +502,7 @@ class AbstractNetlist {
   // Useful when looking for a module expects to get false results most of the
   // time.
   std::optional<const AbstractModule<EvalT>*> MaybeGetModule(
-      const std::string& module_name) const;
+      std::string_view module_name) const;
   absl::Span<const std::unique_ptr<AbstractModule<EvalT>>> modules() {
     return modules_;
   }
@@ -829,7 +829,7 @@ void AbstractNetlist<EvalT>::AddModule(
 
 template <typename EvalT>
 std::optional<const AbstractModule<EvalT>*>
-AbstractNetlist<EvalT>::MaybeGetModule(const std::string& module_name) const {
+AbstractNetlist<EvalT>::MaybeGetModule(std::string_view module_name) const {
   for (const auto& module : modules_) {
     if (module->name() == module_name) {
       return module.get();
@@ -15,7 +15,11 @@
 #include "xls/netlist/netlist_parser.h"
 
 #include <cctype>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -183,9 +187,7 @@ absl::StatusOr<Token> Scanner::Pop() {
   return result;
 }
 
-absl::StatusOr<Token> Scanner::ScanNumber(char startc, Pos pos) {
-  std::string chars;
-  chars.push_back(startc);
+absl::StatusOr<Token> Scanner::ScanNumber(int64_t start, Pos pos) {
   bool seen_separator = false;
   auto is_hex_char = [](char c) {
     return absl::ascii_isxdigit(absl::ascii_toupper(c));
@@ -200,20 +202,19 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, Pos pos) {
   while (!AtEofInternal()) {
     char c = PeekCharOrDie();
     if (is_hex_char(c)) {
-      chars.push_back(PopCharOrDie());
+      DropCharOrDie();
     } else if (c == '\'' && !seen_separator) {
       // If we see a base separator, pop it, then the optional signedness
       // indicator (s|S), then the base indicator (d|b|o|h|D|B|O|H).
-      chars.push_back(PopCharOrDie());
+      DropCharOrDie();
       XLS_RET_CHECK(!AtEofInternal()) << "Saw EOF while scanning number base!";
-      chars.push_back(PopCharOrDie());
-      if (chars.back() == 's' || chars.back() == 'S') {
+      c = PopCharOrDie();
+      if (c == 's' || c == 'S') {
         XLS_RET_CHECK(!AtEofInternal())
             << "Saw EOF while scanning number base (post-signedness)!";
-        chars.push_back(PopCharOrDie());
+        c = PopCharOrDie();
       }
 
-      c = chars.back();
       XLS_RET_CHECK(c == 'd' || c == 'b' || c == 'o' || c == 'h' || c == 'D' ||
                     c == 'B' || c == 'O' || c == 'H')
           << "Expected [dbohDBOH], saw '" << c << "'";
@@ -224,23 +225,22 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, Pos pos) {
     }
   }
 
-  return Token{TokenKind::kNumber, pos, chars};
+  return Token{TokenKind::kNumber, pos, text_.substr(start, index_ - start)};
 }
 
-absl::StatusOr<Token> Scanner::ScanName(char startc, Pos pos, bool is_escaped) {
-  std::string chars;
-  chars.push_back(startc);
+absl::StatusOr<Token> Scanner::ScanName(int64_t start, Pos pos,
+                                        bool is_escaped) {
   while (!AtEofInternal()) {
     char c = PeekCharOrDie();
     bool is_whitespace = c == ' ' || c == '\t' || c == '\n';
     if ((is_escaped && !is_whitespace) || isalpha(c) || isdigit(c) ||
         c == '_') {
-      chars.push_back(PopCharOrDie());
+      DropCharOrDie();
     } else {
       break;
     }
   }
-  return Token{TokenKind::kName, pos, chars};
+  return Token{TokenKind::kName, pos, text_.substr(start, index_ - start)};
 }
 
 absl::StatusOr<Token> Scanner::PeekInternal() {
@@ -249,6 +249,7 @@ absl::StatusOr<Token> Scanner::PeekInternal() {
     return absl::FailedPreconditionError("Scan has reached EOF.");
   }
   auto pos = GetPos();
+  int64_t start = index_;
   char c = PopCharOrDie();
   switch (c) {
     case '(':
@@ -283,16 +284,112 @@ absl::StatusOr<Token> Scanner::PeekInternal() {
       [[fallthrough]];
     default:
       if (isdigit(c)) {
-        return ScanNumber(c, pos);
+        return ScanNumber(start, pos);
       }
       if (isalpha(c) || c == '\\' || c == '_') {
-        return ScanName(c, pos, c == '\\');
+        return ScanName(start, pos, c == '\\');
       }
       return absl::UnimplementedError(absl::StrFormat(
           "Unsupported character: '%c' (%#x) @ %s", c, c, pos.ToHumanString()));
   }
 }
 
+std::vector<NetlistStatement> SplitNetlistStatements(std::string_view text) {
+  std::vector<NetlistStatement> statements;
+  int64_t index = 0;
+
+  // Positions are computed lazily at the start of each statement by counting
+  // the newlines since the previous one.
+  int64_t pos_index = 0;
+  int64_t lineno = 0;
+  int64_t line_start = 0;
+  auto get_pos = [&](int64_t at) {
+    for (; pos_index < at; ++pos_index) {
+      if (text[pos_index] == '\n') {
+        ++lineno;
+        line_start = pos_index + 1;
+      }
+    }
+    return Pos{lineno, at - line_start};
+  };
+  auto at = [&](int64_t i, char c) { return i < text.size() && text[i] == c; };
+  // If a comment or attribute starts at `index`, skips past it and returns
+  // true. Unterminated comments extend to the end of the text.
+  auto skip_comment_or_attribute = [&]() {
+    std::string_view terminator;
+    if (at(index, '/') && at(index + 1, '/')) {
+      terminator = "\n";
+    } else if (at(index, '/') && at(index + 1, '*')) {
+      terminator = "*/";
+    } else if (at(index, '(') && at(index + 1, '*')) {
+      terminator = "*)";
+    } else {
+      return false;
+    }
+    size_t end = text.find(terminator, index + 2);
+    index = end == std::string_view::npos ? text.size()
+                                          : end + terminator.size();
+    return true;
+  };
+  auto is_name_char = [](char c) {
+    return absl::ascii_isalnum(c) || c == '_';
+  };
+
+  while (true) {
+    // Drop whitespace and comments between statements.
+    while (index < text.size()) {
+      char c = text[index];
+      if (c == ' ' || c == '\n' || c == '\t') {
+        ++index;
+      } else if (!skip_comment_or_attribute()) {
+        break;
+      }
+    }
+    if (index >= text.size()) {
+      break;
+    }
+
+    int64_t start = index;
+    while (index < text.size() && is_name_char(text[index])) {
+      ++index;
+    }
+    std::string_view keyword = text.substr(start, index - start);
+    NetlistStatement::Kind kind = NetlistStatement::Kind::kInstance;
+    if (keyword == "endmodule") {
+      statements.push_back(NetlistStatement{NetlistStatement::Kind::kEndModule,
+                                            keyword, get_pos(start)});
+      continue;
+    }
+    if (keyword == "module") {
+      kind = NetlistStatement::Kind::kModule;
+    } else if (keyword == "input" || keyword == "output" ||
+               keyword == "wire" || keyword == "assign") {
+      kind = NetlistStatement::Kind::kDeclaration;
+    }
+
+    // Find the end of the statement.
+    while (index < text.size()) {
+      char c = text[index];
+      if (c == ';') {
+        ++index;
+        break;
+      }
+      if (c == '\\') {
+        // Escaped names extend to the next whitespace.
+        while (index < text.size() && text[index] != ' ' &&
+               text[index] != '\t' && text[index] != '\n') {
+          ++index;
+        }
+      } else if (!skip_comment_or_attribute()) {
+        ++index;
+      }
+    }
+    statements.push_back(NetlistStatement{
+        kind, text.substr(start, index - start), get_pos(start)});
+  }
+  return statements;
+}
+
 }  // namespace rtl
 }  // namespace netlist
 }  // namespace xls
@@ -17,6 +17,7 @@
 
 #include <sys/types.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -37,9 +38,11 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/substitute.h"
+#include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/string_to_int.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/netlist/cell_library.h"
 #include "xls/netlist/netlist.h"
@@ -83,7 +86,9 @@ struct Pos {
 struct Token {
   TokenKind kind;
   Pos pos;
-  std::string value;
+  // Text of name and number tokens. This is a view into the scanned text, so
+  // it is only valid for as long as that text is.
+  std::string_view value;
 
   std::string ToString() const;
 };
@@ -93,6 +98,11 @@ class Scanner {
  public:
   explicit Scanner(std::string_view text) : text_(text) {}
 
+  // Scans a fragment of a larger text which starts at `start` in that text;
+  // positions of tokens are reported relative to the larger text.
+  Scanner(std::string_view text, Pos start)
+      : text_(text), lineno_(start.lineno), colno_(start.colno) {}
+
   absl::StatusOr<Token> Peek();
 
   absl::StatusOr<Token> Pop();
@@ -103,8 +113,9 @@ class Scanner {
   }
 
  private:
-  absl::StatusOr<Token> ScanName(char startc, Pos pos, bool is_escaped);
-  absl::StatusOr<Token> ScanNumber(char startc, Pos pos);
+  // Scans the rest of a name or number whose first character is at `start`.
+  absl::StatusOr<Token> ScanName(int64_t start, Pos pos, bool is_escaped);
+  absl::StatusOr<Token> ScanNumber(int64_t start, Pos pos);
   absl::StatusOr<Token> PeekInternal();
 
   // Drops any characters that should not be converted to Tokens, including
@@ -133,6 +144,29 @@ class Scanner {
   std::optional<Token> lookahead_;
 };
 
+// A top-level statement of a netlist: a module header, a statement in a module
+// body, or the "endmodule" keyword which ends the body.
+struct NetlistStatement {
+  enum class Kind {
+    kModule,
+    kEndModule,
+    // Net declarations and assignments.
+    kDeclaration,
+    kInstance,
+  };
+
+  Kind kind;
+  // The text of the statement, including its terminating semicolon.
+  std::string_view text;
+  Pos pos;
+};
+
+// Splits `text` into statements without tokenizing it: only comments,
+// attributes and escaped names are recognized so that semicolons within them
+// aren't mistaken for statement boundaries. This lets the statements of a
+// netlist be scanned independently (and concurrently).
+std::vector<NetlistStatement> SplitNetlistStatements(std::string_view text);
+
 template <typename EvalT = bool>
 class AbstractParser {
  public:
@@ -147,7 +181,44 @@ class AbstractParser {
     return ParseNetlist(cell_library, scanner, EvalT{false}, EvalT{true});
   }
 
+  // Parses the netlist in `text` like ParseNetlist, but tokenizes the cell
+  // instances of each module on up to `thread_count` threads. Declarations
+  // are parsed in order first; the instances are then linked against the
+  // module's nets in their original order, so the result is identical to that
+  // of ParseNetlist. `text` only needs to outlive this call (e.g. it may be a
+  // mapped file).
+  static absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>>
+  ParseNetlistParallel(AbstractCellLibrary<EvalT>* cell_library,
+                       std::string_view text, int64_t thread_count, EvalT zero,
+                       EvalT one);
+  template <typename = std::is_constructible<EvalT, bool>>
+  static absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>>
+  ParseNetlistParallel(AbstractCellLibrary<EvalT>* cell_library,
+                       std::string_view text, int64_t thread_count) {
+    return ParseNetlistParallel(cell_library, text, thread_count, EvalT{false},
+                                EvalT{true});
+  }
+
  private:
+  // A cell instantiation as scanned from the token stream, before its cell
+  // and nets are resolved. Names are views into the scanned text.
+  struct InstanceStatement {
+    struct Connection {
+      std::string_view pin_name;
+      // A net name or a number literal.
+      std::variant<std::string_view, int64_t> net;
+      // The subscript of a net name, if any.
+      std::optional<int64_t> index;
+    };
+
+    Pos pos;
+    std::string_view cell_name;
+    // The LUT_INIT parameter of SB_LUT4 cells.
+    std::optional<int64_t> lut_mask;
+    std::string_view name;
+    std::vector<Connection> connections;
+  };
+
   explicit AbstractParser(AbstractCellLibrary<EvalT>* cell_library,
                           Scanner* scanner, EvalT zero, EvalT one)
       : cell_library_(cell_library),
@@ -159,10 +230,29 @@ class AbstractParser {
   absl::Status ParseInstance(AbstractModule<EvalT>* module,
                              AbstractNetlist<EvalT>& netlist);
 
-  // Parses a cell module name out of the token stream and returns the
-  // corresponding AbstractCellLibraryEntry for that module name.
-  absl::StatusOr<const AbstractCellLibraryEntry<EvalT>*> ParseCellModule(
-      AbstractNetlist<EvalT>& netlist);
+  // Scans a cell instantiation out of the token stream. This does not modify
+  // the netlist, so instances may be scanned concurrently.
+  absl::StatusOr<InstanceStatement> ParseInstanceStatement(
+      const AbstractNetlist<EvalT>& netlist);
+
+  // Resolves the cell and nets of `instance` and adds it to `module`.
+  absl::Status AddInstance(AbstractModule<EvalT>* module,
+                           AbstractNetlist<EvalT>& netlist,
+                           const InstanceStatement& instance);
+
+  // Returns the AbstractCellLibraryEntry for the cell module of `instance`.
+  absl::StatusOr<const AbstractCellLibraryEntry<EvalT>*> ResolveCellModule(
+      AbstractNetlist<EvalT>& netlist, const InstanceStatement& instance);
+
+  // Scans and adds the cell instantiations in `statements` to `module`.
+  static absl::Status ParseInstancesInParallel(
+      AbstractCellLibrary<EvalT>* cell_library,
+      absl::Span<const NetlistStatement* const> statements,
+      int64_t thread_count, EvalT zero, EvalT one,
+      AbstractModule<EvalT>* module, AbstractNetlist<EvalT>& netlist);
+
+  // Returns an error if the scanner has not consumed all of its text.
+  absl::Status ExpectEof();
 
   // Parses a wire declaration at the module scope.
   absl::Status ParseNetDecl(AbstractModule<EvalT>* module, NetDeclKind kind);
@@ -241,13 +331,14 @@ class AbstractParser {
   absl::StatusOr<std::unique_ptr<AbstractModule<EvalT>>> ParseModule(
       AbstractNetlist<EvalT>& netlist);
 
-  // Parses a reference to an already- declared net.
-  absl::StatusOr<AbstractNetRef<EvalT>> ParseNetRef(
-      AbstractModule<EvalT>* module);
+  // Parses the "module name(ports);" header of a module definition.
+  absl::StatusOr<std::unique_ptr<AbstractModule<EvalT>>> ParseModuleHeader();
 
   // Pops a name token and returns its contents or gives an error status if a
   // name token is not immediately present in the stream.
   absl::StatusOr<std::string> PopNameOrError();
+  // As above, but returns a view into the scanned text.
+  absl::StatusOr<std::string_view> PopNameViewOrError();
 
   // Pops a name token and returns its value or gives an error status if a
   // number token is not immediately present in the stream.  The overload
@@ -300,7 +391,7 @@ class AbstractParser {
 using Parser = AbstractParser<>;
 
 template <typename EvalT>
-absl::StatusOr<std::string> AbstractParser<EvalT>::PopNameOrError() {
+absl::StatusOr<std::string_view> AbstractParser<EvalT>::PopNameViewOrError() {
   XLS_ASSIGN_OR_RETURN(Token token, scanner_->Pop());
   if (token.kind == TokenKind::kName) {
     return token.value;
@@ -309,6 +400,12 @@ absl::StatusOr<std::string> AbstractParser<EvalT>::PopNameOrError() {
                                     token.ToString());
 }
 
+template <typename EvalT>
+absl::StatusOr<std::string> AbstractParser<EvalT>::PopNameOrError() {
+  XLS_ASSIGN_OR_RETURN(std::string_view name, PopNameViewOrError());
+  return std::string(name);
+}
+
 template <typename EvalT>
 absl::StatusOr<int64_t> AbstractParser<EvalT>::PopNumberOrError(size_t& width) {
   // We're assuming we won't see > 64b values. Fine for now, at least.
@@ -351,8 +448,8 @@ absl::StatusOr<int64_t> AbstractParser<EvalT>::PopNumberOrError(size_t& width) {
     int64_t result;
     if (!absl::SimpleAtoi(token.value, &result)) {
       return absl::InternalError(
-          "Number token's value cannot be parsed as an int64_t: " +
-          token.value);
+          absl::StrCat("Number token's value cannot be parsed as an int64_t: ",
+                       token.value));
     }
     // Size field defaults to 32 when not explicitly specified.
     width = 32;
@@ -375,7 +472,7 @@ AbstractParser<EvalT>::PopNameOrNumberOrError(size_t& width) {
   switch (kind) {
     case TokenKind::kName: {
       XLS_ASSIGN_OR_RETURN(Token token, scanner_->Pop());
-      return token.value;
+      return std::string(token.value);
     }
     case TokenKind::kNumber:
       return PopNumberOrError(width);
@@ -435,75 +532,109 @@ absl::Status AbstractParser<EvalT>::DropKeywordOrError(
 }
 
 template <typename EvalT>
-absl::StatusOr<const AbstractCellLibraryEntry<EvalT>*>
-AbstractParser<EvalT>::ParseCellModule(AbstractNetlist<EvalT>& netlist) {
-  XLS_ASSIGN_OR_RETURN(std::string name, PopNameOrError());
-  auto maybe_module = netlist.MaybeGetModule(name);
-  if (maybe_module.has_value()) {
-    return maybe_module.value()->AsCellLibraryEntry();
-  }
-  if (name == "SB_LUT4") {
+absl::Status AbstractParser<EvalT>::ParseInstance(
+    AbstractModule<EvalT>* module, AbstractNetlist<EvalT>& netlist) {
+  XLS_ASSIGN_OR_RETURN(InstanceStatement instance,
+                       ParseInstanceStatement(netlist));
+  return AddInstance(module, netlist, instance);
+}
+
+template <typename EvalT>
+absl::StatusOr<typename AbstractParser<EvalT>::InstanceStatement>
+AbstractParser<EvalT>::ParseInstanceStatement(
+    const AbstractNetlist<EvalT>& netlist) {
+  InstanceStatement instance;
+  XLS_ASSIGN_OR_RETURN(Token peek, scanner_->Peek());
+  instance.pos = peek.pos;
+
+  XLS_ASSIGN_OR_RETURN(instance.cell_name, PopNameViewOrError());
+  if (instance.cell_name == "SB_LUT4" &&
+      !netlist.MaybeGetModule(instance.cell_name).has_value()) {
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kStartParams));
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kDot));
-    XLS_ASSIGN_OR_RETURN(std::string param_name, PopNameOrError());
+    XLS_ASSIGN_OR_RETURN(std::string_view param_name, PopNameViewOrError());
     if (param_name != "LUT_INIT") {
-      return absl::InvalidArgumentError(
-          "Expected a single .LUT_INIT named parameter, got: " + param_name);
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Expected a single .LUT_INIT named parameter, got: ", param_name));
     }
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kOpenParen));
-    XLS_ASSIGN_OR_RETURN(int64_t lut_mask, PopNumberOrError());
+    XLS_ASSIGN_OR_RETURN(instance.lut_mask, PopNumberOrError());
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kCloseParen));
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kCloseParen));
-    return netlist.GetOrCreateLut4CellEntry(lut_mask, zero_, one_);
   }
-  return cell_library_->GetEntry(name);
+  XLS_ASSIGN_OR_RETURN(instance.name, PopNameViewOrError());
+  XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kOpenParen));
+  // LRM 23.3.2 Calls these "named parameter assignments".
+  while (true) {
+    typename InstanceStatement::Connection connection;
+    XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kDot));
+    XLS_ASSIGN_OR_RETURN(connection.pin_name, PopNameViewOrError());
+    XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kOpenParen));
+    XLS_ASSIGN_OR_RETURN(Token net, scanner_->Peek());
+    if (net.kind == TokenKind::kNumber) {
+      XLS_ASSIGN_OR_RETURN(connection.net, PopNumberOrError());
+    } else {
+      XLS_ASSIGN_OR_RETURN(connection.net, PopNameViewOrError());
+      if (TryDropToken(TokenKind::kOpenBracket)) {
+        XLS_ASSIGN_OR_RETURN(connection.index, PopNumberOrError());
+        XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kCloseBracket));
+      }
+    }
+    XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kCloseParen));
+    instance.connections.push_back(connection);
+    if (!TryDropToken(TokenKind::kComma)) {
+      break;
+    }
+  }
+  XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kCloseParen));
+  XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kSemicolon));
+  return instance;
 }
 
 template <typename EvalT>
-absl::StatusOr<AbstractNetRef<EvalT>> AbstractParser<EvalT>::ParseNetRef(
-    AbstractModule<EvalT>* module) {
-  using TokenT = std::variant<std::string, int64_t>;
-  XLS_ASSIGN_OR_RETURN(TokenT token, PopNameOrNumberOrError());
-  if (std::holds_alternative<int64_t>(token)) {
-    int64_t value = std::get<int64_t>(token);
-    return module->AddOrResolveNumber(value);
+absl::StatusOr<const AbstractCellLibraryEntry<EvalT>*>
+AbstractParser<EvalT>::ResolveCellModule(AbstractNetlist<EvalT>& netlist,
+                                         const InstanceStatement& instance) {
+  auto maybe_module = netlist.MaybeGetModule(instance.cell_name);
+  if (maybe_module.has_value()) {
+    return maybe_module.value()->AsCellLibraryEntry();
   }
-
-  std::string name = std::get<std::string>(token);
-  if (TryDropToken(TokenKind::kOpenBracket)) {
-    XLS_ASSIGN_OR_RETURN(int64_t index, PopNumberOrError());
-    XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kCloseBracket));
-    absl::StrAppend(&name, "[", index, "]");
+  if (instance.lut_mask.has_value()) {
+    return netlist.GetOrCreateLut4CellEntry(*instance.lut_mask, zero_, one_);
   }
-  return module->ResolveNet(name);
+  return cell_library_->GetEntry(instance.cell_name);
 }
 
 template <typename EvalT>
-absl::Status AbstractParser<EvalT>::ParseInstance(
-    AbstractModule<EvalT>* module, AbstractNetlist<EvalT>& netlist) {
-  XLS_ASSIGN_OR_RETURN(Token peek, scanner_->Peek());
-  const Pos pos = peek.pos;
-
+absl::Status AbstractParser<EvalT>::AddInstance(
+    AbstractModule<EvalT>* module, AbstractNetlist<EvalT>& netlist,
+    const InstanceStatement& instance) {
   XLS_ASSIGN_OR_RETURN(const AbstractCellLibraryEntry<EvalT>* cle,
-                       ParseCellModule(netlist));
-  XLS_ASSIGN_OR_RETURN(std::string name, PopNameOrError());
-  XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kOpenParen));
-  // LRM 23.3.2 Calls these "named parameter assignments".
+                       ResolveCellModule(netlist, instance));
   absl::flat_hash_map<std::string, AbstractNetRef<EvalT>>
       named_parameter_assignments;
-  while (true) {
-    XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kDot));
-    XLS_ASSIGN_OR_RETURN(std::string pin_name, PopNameOrError());
-    XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kOpenParen));
-    XLS_ASSIGN_OR_RETURN(AbstractNetRef<EvalT> net, ParseNetRef(module));
-    XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kCloseParen));
-    VLOG(3) << "Adding named parameter assignment: " << pin_name;
-    bool is_new = named_parameter_assignments.insert({pin_name, net}).second;
-    if (!is_new) {
-      return absl::InvalidArgumentError("Duplicate port seen: " + pin_name);
+  named_parameter_assignments.reserve(instance.connections.size());
+  std::string net_name;
+  for (const auto& connection : instance.connections) {
+    AbstractNetRef<EvalT> net;
+    if (std::holds_alternative<int64_t>(connection.net)) {
+      XLS_ASSIGN_OR_RETURN(
+          net, module->AddOrResolveNumber(std::get<int64_t>(connection.net)));
+    } else if (connection.index.has_value()) {
+      net_name.assign(std::get<std::string_view>(connection.net));
+      absl::StrAppend(&net_name, "[", *connection.index, "]");
+      XLS_ASSIGN_OR_RETURN(net, module->ResolveNet(net_name));
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          net, module->ResolveNet(std::get<std::string_view>(connection.net)));
     }
-    if (!TryDropToken(TokenKind::kComma)) {
-      break;
+    VLOG(3) << "Adding named parameter assignment: " << connection.pin_name;
+    bool is_new = named_parameter_assignments
+                      .insert({std::string(connection.pin_name), net})
+                      .second;
+    if (!is_new) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Duplicate port seen: ", connection.pin_name));
     }
   }
   std::optional<AbstractNetRef<EvalT>> clock;
@@ -512,16 +643,17 @@ absl::Status AbstractParser<EvalT>::ParseInstance(
     if (it == named_parameter_assignments.end()) {
       return absl::InvalidArgumentError(absl::StrFormat(
           "Cell %s named %s requires a clock connection %s but none was found.",
-          cle->name(), name, cle->clock_name().value()));
+          cle->name(), instance.name, cle->clock_name().value()));
     }
     clock = it->second;
     named_parameter_assignments.erase(it);
   }
   XLS_ASSIGN_OR_RETURN(
       AbstractCell<EvalT> cell,
-      AbstractCell<EvalT>::Create(cle, name, named_parameter_assignments, clock,
+      AbstractCell<EvalT>::Create(cle, instance.name,
+                                  named_parameter_assignments, clock,
                                   module->GetDummyRef()),
-      _ << " @ " << pos.ToHumanString());
+      _ << " @ " << instance.pos.ToHumanString());
   XLS_ASSIGN_OR_RETURN(AbstractCell<EvalT> * cell_ptr,
                        module->AddCell(std::move(cell)));
   absl::flat_hash_set<AbstractNetRef<EvalT>> connected_wires;
@@ -532,11 +664,19 @@ absl::Status AbstractParser<EvalT>::ParseInstance(
     item.second->NoteConnectedCell(cell_ptr);
     connected_wires.insert(item.second);
   }
-  XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kCloseParen));
-  XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kSemicolon));
   return absl::OkStatus();
 }
 
+template <typename EvalT>
+absl::Status AbstractParser<EvalT>::ExpectEof() {
+  if (scanner_->AtEof()) {
+    return absl::OkStatus();
+  }
+  XLS_ASSIGN_OR_RETURN(Token token, scanner_->Peek());
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Expected end of statement; got: %s", token.ToString()));
+}
+
 template <typename EvalT>
 bool AbstractParser<EvalT>::TryDropToken(TokenKind target) {
   if (scanner_->AtEof()) {
@@ -764,7 +904,7 @@ absl::Status AbstractParser<EvalT>::ParseModuleStatement(
 
 template <typename EvalT>
 absl::StatusOr<std::unique_ptr<AbstractModule<EvalT>>>
-AbstractParser<EvalT>::ParseModule(AbstractNetlist<EvalT>& netlist) {
+AbstractParser<EvalT>::ParseModuleHeader() {
   XLS_RETURN_IF_ERROR(DropKeywordOrError("module"));
   XLS_ASSIGN_OR_RETURN(std::string module_name, PopNameOrError());
   XLS_ASSIGN_OR_RETURN(std::vector<std::string> module_ports,
@@ -773,7 +913,14 @@ AbstractParser<EvalT>::ParseModule(AbstractNetlist<EvalT>& netlist) {
 
   auto module = std::make_unique<AbstractModule<EvalT>>(module_name);
   module->DeclarePortsOrder(module_ports);
+  return module;
+}
 
+template <typename EvalT>
+absl::StatusOr<std::unique_ptr<AbstractModule<EvalT>>>
+AbstractParser<EvalT>::ParseModule(AbstractNetlist<EvalT>& netlist) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<AbstractModule<EvalT>> module,
+                       ParseModuleHeader());
   while (true) {
     if (TryDropKeyword("endmodule")) {
       break;
@@ -797,6 +944,101 @@ AbstractParser<EvalT>::ParseNetlist(AbstractCellLibrary<EvalT>* cell_library,
   return std::move(netlist);
 }
 
+template <typename EvalT>
+absl::Status AbstractParser<EvalT>::ParseInstancesInParallel(
+    AbstractCellLibrary<EvalT>* cell_library,
+    absl::Span<const NetlistStatement* const> statements, int64_t thread_count,
+    EvalT zero, EvalT one, AbstractModule<EvalT>* module,
+    AbstractNetlist<EvalT>& netlist) {
+  // Below this many instances per thread, starting threads isn't worthwhile.
+  constexpr int64_t kMinInstancesPerChunk = 1024;
+  int64_t chunk_count =
+      std::clamp<int64_t>(statements.size() / kMinInstancesPerChunk, 1,
+                          std::max<int64_t>(thread_count, 1));
+  int64_t chunk_size = (statements.size() + chunk_count - 1) / chunk_count;
+
+  // The netlist and module are only read while scanning.
+  std::vector<InstanceStatement> instances(statements.size());
+  std::vector<absl::Status> chunk_status(chunk_count);
+  auto scan_chunk = [&](int64_t chunk) {
+    int64_t end = std::min<int64_t>(statements.size(),
+                                    (chunk + 1) * chunk_size);
+    for (int64_t i = chunk * chunk_size; i < end; ++i) {
+      Scanner scanner(statements[i]->text, statements[i]->pos);
+      AbstractParser<EvalT> p(cell_library, &scanner, zero, one);
+      absl::StatusOr<InstanceStatement> instance =
+          p.ParseInstanceStatement(netlist);
+      absl::Status status = instance.ok() ? p.ExpectEof() : instance.status();
+      if (!status.ok()) {
+        chunk_status[chunk] = status;
+        return;
+      }
+      instances[i] = *std::move(instance);
+    }
+  };
+  if (chunk_count == 1) {
+    scan_chunk(0);
+  } else {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(chunk_count);
+    for (int64_t chunk = 0; chunk < chunk_count; ++chunk) {
+      threads.push_back(
+          std::make_unique<Thread>([&scan_chunk, chunk] { scan_chunk(chunk); }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  for (const absl::Status& status : chunk_status) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+
+  // Link the instances in their original order.
+  AbstractParser<EvalT> p(cell_library, /*scanner=*/nullptr, zero, one);
+  for (const InstanceStatement& instance : instances) {
+    XLS_RETURN_IF_ERROR(p.AddInstance(module, netlist, instance));
+  }
+  return absl::OkStatus();
+}
+
+template <typename EvalT>
+absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>>
+AbstractParser<EvalT>::ParseNetlistParallel(
+    AbstractCellLibrary<EvalT>* cell_library, std::string_view text,
+    int64_t thread_count, EvalT zero, EvalT one) {
+  auto netlist = std::make_unique<AbstractNetlist<EvalT>>();
+  std::vector<NetlistStatement> statements = SplitNetlistStatements(text);
+  std::unique_ptr<AbstractModule<EvalT>> module;
+  std::vector<const NetlistStatement*> instances;
+  for (const NetlistStatement& statement : statements) {
+    if (statement.kind == NetlistStatement::Kind::kInstance &&
+        module != nullptr) {
+      instances.push_back(&statement);
+      continue;
+    }
+    Scanner scanner(statement.text, statement.pos);
+    AbstractParser<EvalT> p(cell_library, &scanner, zero, one);
+    if (module == nullptr) {
+      XLS_ASSIGN_OR_RETURN(module, p.ParseModuleHeader());
+    } else if (statement.kind == NetlistStatement::Kind::kEndModule) {
+      XLS_RETURN_IF_ERROR(p.DropKeywordOrError("endmodule"));
+      XLS_RETURN_IF_ERROR(ParseInstancesInParallel(cell_library, instances,
+                                                   thread_count, zero, one,
+                                                   module.get(), *netlist));
+      instances.clear();
+      netlist->AddModule(std::move(module));
+    } else {
+      XLS_RETURN_IF_ERROR(p.ParseModuleStatement(module.get(), *netlist));
+    }
+    XLS_RETURN_IF_ERROR(p.ExpectEof());
+  }
+  if (module != nullptr) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Module %s is missing \"endmodule\"", module->name()));
+  }
+  return std::move(netlist);
+}
+
 }  // namespace rtl
 }  // namespace netlist
 }  // namespace xls
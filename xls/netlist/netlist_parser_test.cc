@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -26,6 +27,8 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/substitute.h"
 #include "xls/common/status/matchers.h"
 #include "xls/netlist/cell_library.h"
@@ -447,6 +450,137 @@ endmodule)";
   TestAssignHelper(m);
 }
 
+TEST(NetlistParserTest, SplitStatements) {
+  std::string netlist = R"(// comment; not a statement
+module main(a, \b;c , o);
+  (* attr = "x;y" *) input a;
+  input \b;c ;
+  /* ; */ output o;
+  AND and0 ( .A(a), .B(\b;c ), .Z(o) );
+endmodule
+)";
+  std::vector<NetlistStatement> statements = SplitNetlistStatements(netlist);
+  ASSERT_EQ(statements.size(), 6);
+  EXPECT_EQ(statements[0].kind, NetlistStatement::Kind::kModule);
+  EXPECT_EQ(statements[0].text, R"(module main(a, \b;c , o);)");
+  EXPECT_EQ(statements[0].pos.lineno, 1);
+  EXPECT_EQ(statements[0].pos.colno, 0);
+  EXPECT_EQ(statements[1].kind, NetlistStatement::Kind::kDeclaration);
+  EXPECT_EQ(statements[1].text, "input a;");
+  EXPECT_EQ(statements[1].pos.lineno, 2);
+  EXPECT_EQ(statements[1].pos.colno, 21);
+  EXPECT_EQ(statements[2].text, R"(input \b;c ;)");
+  EXPECT_EQ(statements[3].text, "output o;");
+  EXPECT_EQ(statements[4].kind, NetlistStatement::Kind::kInstance);
+  EXPECT_EQ(statements[4].text, R"(AND and0 ( .A(a), .B(\b;c ), .Z(o) );)");
+  EXPECT_EQ(statements[5].kind, NetlistStatement::Kind::kEndModule);
+  EXPECT_EQ(statements[5].pos.lineno, 6);
+}
+
+// Returns a description of the cells and connections of every module in the
+// netlist.
+std::string DescribeNetlist(Netlist& netlist) {
+  std::string result;
+  for (const auto& module : netlist.modules()) {
+    absl::StrAppend(&result, "module ", module->name(), " nets ",
+                    module->nets().size(), " assigns ",
+                    module->assigns().size(), "\n");
+    for (const auto& cell : module->cells()) {
+      absl::StrAppend(&result, "  ", cell->cell_library_entry()->name(), " ",
+                      cell->name());
+      for (const auto& pin : cell->inputs()) {
+        absl::StrAppend(&result, " ", pin.name, "=", pin.netref->name());
+      }
+      for (const auto& pin : cell->outputs()) {
+        absl::StrAppend(&result, " ", pin.name, "=", pin.netref->name());
+      }
+      absl::StrAppend(&result, "\n");
+    }
+  }
+  return result;
+}
+
+TEST(NetlistParserTest, ParallelMatchesSequential) {
+  // A module with enough cells to be split across threads, which also
+  // instantiates a submodule and LUTs and connects constants.
+  std::string netlist = R"(
+module sub(a, b, o);
+  input a, b;
+  output o;
+  OR or0 ( .A(a), .B(b), .Z(o) );
+endmodule
+
+module main(i, o);
+  input [3:0] i;
+  output [1:0] o;
+)";
+  constexpr int64_t kCellCount = 5000;
+  for (int64_t n = 0; n < kCellCount; ++n) {
+    absl::StrAppendFormat(&netlist, "  wire w%d;\n", n);
+  }
+  absl::StrAppend(&netlist, "  INV inv0 ( .A(i[0]), .ZN(w0) );\n");
+  for (int64_t n = 1; n < kCellCount; ++n) {
+    switch (n % 4) {
+      case 0:
+        absl::StrAppendFormat(
+            &netlist, "  // cell %d;\n  AND and%d ( .A(w%d), .B(1'b1), .Z(w%d) );\n",
+            n, n, n - 1, n);
+        break;
+      case 1:
+        absl::StrAppendFormat(
+            &netlist, "  sub sub%d ( .a(w%d), .b(i[%d]), .o(w%d) );\n", n,
+            n - 1, n % 4, n);
+        break;
+      case 2:
+        absl::StrAppendFormat(&netlist,
+                              "  SB_LUT4 #(.LUT_INIT(16'h%04x)) lut%d ( "
+                              ".I0(w%d), .I1(i[1]), .I2(i[2]), .I3(i[3]), "
+                              ".O(w%d) );\n",
+                              n, n, n - 1, n);
+        break;
+      default:
+        absl::StrAppendFormat(
+            &netlist, "  (* keep *) XOR xor%d ( .A(w%d), .B(i[3]), .Z(w%d) );\n",
+            n, n - 1, n);
+        break;
+    }
+  }
+  absl::StrAppendFormat(&netlist, "  assign o = { w%d, i[0] };\nendmodule\n",
+                        kCellCount - 1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  Scanner scanner(netlist);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Netlist> expected,
+                           Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Netlist> actual,
+      Parser::ParseNetlistParallel(&cell_library, netlist, /*thread_count=*/4));
+  EXPECT_EQ(DescribeNetlist(*actual), DescribeNetlist(*expected));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* m, actual->GetModule("main"));
+  EXPECT_EQ(m->cells().size(), kCellCount);
+}
+
+TEST(NetlistParserTest, ParallelReportsErrors) {
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  std::string_view bad_cell = R"(module main(a, o);
+  input a;
+  output o;
+  INV inv0 ( .A(a) .ZN(o) );
+endmodule)";
+  EXPECT_THAT(
+      Parser::ParseNetlistParallel(&cell_library, bad_cell, /*thread_count=*/2),
+      StatusIs(absl::StatusCode::kUnimplemented, HasSubstr("@4:20")));
+
+  std::string_view missing_end = R"(module main(a, o);
+  input a;
+  output o;
+  INV inv0 ( .A(a), .ZN(o) );)";
+  EXPECT_THAT(Parser::ParseNetlistParallel(&cell_library, missing_end,
+                                           /*thread_count=*/2),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("missing \"endmodule\"")));
+}
+
 }  // namespace
 }  // namespace rtl
 }  // namespace netlist
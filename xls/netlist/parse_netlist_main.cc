@@ -19,6 +19,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -27,15 +28,26 @@
 #include "absl/strings/str_format.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/netlist/cell_library.h"
 #include "xls/netlist/find_logic_clouds.h"
+#include "xls/netlist/function_extractor.h"
 #include "xls/netlist/netlist.h"
 #include "xls/netlist/netlist.pb.h"
 #include "xls/netlist/netlist_parser.h"
 
 ABSL_FLAG(bool, show_clusters, false, "Show the logic clusters found.");
+ABSL_FLAG(int64_t, parse_threads, 0,
+          "Number of threads used to parse the netlist and to find its logic "
+          "clusters. If zero, one thread per available CPU is used.");
+ABSL_FLAG(std::string, liberty, "",
+          "Liberty file from which to extract cells as the netlist references "
+          "them. If the cell library has an index of this file (see "
+          "function_extractor_main --index_only), that is used; otherwise the "
+          "file is indexed on load.");
 
 namespace xls {
 namespace {
@@ -43,19 +55,38 @@ namespace {
 absl::Status RealMain(std::string_view netlist_path,
                       std::optional<std::string_view> cell_library_path) {
   netlist::CellLibrary cell_library;
+  netlist::CellLibraryProto cell_library_index;
   if (cell_library_path) {
     XLS_ASSIGN_OR_RETURN(
         netlist::CellLibraryProto cell_library_proto,
         ParseTextProtoFile<netlist::CellLibraryProto>(*cell_library_path));
     XLS_ASSIGN_OR_RETURN(cell_library,
                          netlist::CellLibrary::FromProto(cell_library_proto));
+    cell_library_index = std::move(cell_library_proto);
+  }
+  std::optional<MappedFile> liberty_file;
+  if (std::string liberty_path = absl::GetFlag(FLAGS_liberty);
+      !liberty_path.empty()) {
+    XLS_ASSIGN_OR_RETURN(liberty_file, MappedFile::Open(liberty_path));
+    if (cell_library_index.liberty_cells().empty()) {
+      XLS_ASSIGN_OR_RETURN(
+          cell_library_index,
+          netlist::function::IndexCells(liberty_file->contents()));
+    }
+    cell_library.SetEntryLoader(netlist::function::MakeCellLoader(
+        liberty_file->contents(), cell_library_index));
   }
 
-  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
-  XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<netlist::rtl::Netlist> netlist,
-      netlist::rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  int64_t parse_threads = absl::GetFlag(FLAGS_parse_threads);
+  if (parse_threads == 0) {
+    parse_threads = AvailableCPUs();
+  }
+  // Post-synthesis netlists can be many gigabytes, so parse them in place.
+  XLS_ASSIGN_OR_RETURN(MappedFile netlist_file, MappedFile::Open(netlist_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<netlist::rtl::Netlist> netlist,
+                       netlist::rtl::Parser::ParseNetlistParallel(
+                           &cell_library, netlist_file.contents(),
+                           parse_threads));
   netlist::rtl::Module* module = netlist->modules()[0].get();
   std::cout << "nets:  " << module->nets().size() << '\n';
   std::cout << "cells: " << module->cells().size() << '\n';
@@ -73,8 +104,11 @@ absl::Status RealMain(std::string_view netlist_path,
               << '\n';
   }
 
-  std::vector<netlist::rtl::Cluster> clusters =
-      netlist::rtl::FindLogicClouds(*module);
+  // Cluster names are only needed (and sorted) if the clusters are shown.
+  std::vector<netlist::rtl::Cluster> clusters = netlist::rtl::FindLogicClouds(
+      *module, netlist::rtl::FindLogicCloudsOptions{
+                   .thread_count = parse_threads,
+                   .sort_by_name = absl::GetFlag(FLAGS_show_clusters)});
   std::cout << "logic clusters: " << clusters.size() << '\n';
   if (absl::GetFlag(FLAGS_show_clusters)) {
     std::cout << netlist::rtl::ClustersToString(clusters) << '\n';
@@ -31,6 +31,10 @@ namespace xls::noc {
 
 int64_t NetworkComponent::GetPortCount() const { return ports_.size(); }
 
+NetworkComponentPort& NetworkComponent::GetPort(const int64_t index) const {
+  return *ports_.at(index);
+}
+
 void NetworkComponent::SetName(std::string name) { name_ = std::move(name); }
 
 const std::string& NetworkComponent::GetName() const { return name_; }
@@ -45,6 +49,10 @@ NetworkComponentPort& NetworkComponent::AddPort(const PortType port_type,
   return (*ports_.back());
 }
 
+void NetworkComponent::ReservePorts(const int64_t count) {
+  ports_.reserve(count);
+}
+
 xabsl::iterator_range<UnwrappingIterator<
     std::vector<std::unique_ptr<NetworkComponentPort>>::iterator>>
 NetworkComponent::ports() {
@@ -52,6 +52,10 @@ class NetworkComponent {
   // to the lifetime of the component.
   NetworkComponentPort& AddPort(PortType port_type, PortDirection direction);
 
+  // Reserves storage for `count` ports in total, so that adding the ports of a
+  // component with a large radix does not repeatedly reallocate.
+  void ReservePorts(int64_t count);
+
   // Returns an iterator range for the ports. The objects are guaranteed to be
   // non-null. Note that, when using the result of this function, if the
   // component is modified (e.g. a port is added), the returned result may
@@ -72,6 +76,10 @@ class NetworkComponent {
   // Returns the number of ports.
   int64_t GetPortCount() const;
 
+  // Returns the port at `index`, the position of the port in the order the
+  // ports were added to the component.
+  NetworkComponentPort& GetPort(int64_t index) const;
+
   // Sets the name of the component.
   void SetName(std::string name);
 
@@ -15,9 +15,11 @@
 #include "xls/noc/config_ng/network_topology_view.h"
 
 #include <cstdint>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/noc/config_ng/network_component.h"
 #include "xls/noc/config_ng/network_component_port.h"
@@ -41,6 +43,21 @@ ChannelTopologyComponent& NetworkTopologyView::AddChannel() {
   return AddComponent<ChannelTopologyComponent>();
 }
 
+std::vector<SendPortTopologyComponent*> NetworkTopologyView::AddSendPorts(
+    const int64_t count) {
+  return AddComponents<SendPortTopologyComponent>(count);
+}
+
+std::vector<ReceivePortTopologyComponent*>
+NetworkTopologyView::AddReceivePorts(const int64_t count) {
+  return AddComponents<ReceivePortTopologyComponent>(count);
+}
+
+std::vector<RouterTopologyComponent*> NetworkTopologyView::AddRouters(
+    const int64_t count) {
+  return AddComponents<RouterTopologyComponent>(count);
+}
+
 int64_t NetworkTopologyView::GetSendPortCount() const {
   return GetCount<SendPortTopologyComponent>();
 }
@@ -83,9 +100,51 @@ NetworkTopologyView::ConnectThroughChannel(NetworkComponent& source,
   return &channel;
 }
 
+absl::StatusOr<std::vector<ChannelTopologyComponent*>>
+NetworkTopologyView::ConnectThroughChannels(
+    absl::Span<NetworkComponent* const> sources,
+    absl::Span<NetworkComponent* const> sinks) {
+  if (sources.size() != sinks.size()) {
+    return absl::FailedPreconditionError(
+        "number of source and sink components differ.");
+  }
+  for (int64_t i = 0; i < sources.size(); ++i) {
+    if (&sources[i]->GetNetworkView() != this ||
+        &sinks[i]->GetNetworkView() != this) {
+      return absl::FailedPreconditionError(
+          "source or sink component is from a different view.");
+    }
+  }
+  ReserveConnections(GetConnectionCount() + 2 * sources.size());
+  std::vector<ChannelTopologyComponent*> channels =
+      AddComponents<ChannelTopologyComponent>(sources.size());
+  for (int64_t i = 0; i < sources.size(); ++i) {
+    ChannelTopologyComponent& channel = *channels[i];
+    channel.ReservePorts(2);
+    // connect source component to channel component
+    this->AddConnection()
+        .ConnectToSourcePort(
+            &sources[i]->AddPort(PortType::kData, PortDirection::kOutput))
+        .ConnectToSinkPort(
+            &channel.AddPort(PortType::kData, PortDirection::kInput));
+    // connect channel component to sink component
+    this->AddConnection()
+        .ConnectToSourcePort(
+            &channel.AddPort(PortType::kData, PortDirection::kOutput))
+        .ConnectToSinkPort(
+            &sinks[i]->AddPort(PortType::kData, PortDirection::kInput));
+  }
+  return channels;
+}
+
 absl::StatusOr<RouterTopologyComponent*> NetworkTopologyView::AddRouter(
     int64_t send_port_count, int64_t recv_port_count) {
+  ReserveComponents(GetComponentCount() + 1 +
+                    2 * (send_port_count + recv_port_count));
+  ReserveConnections(GetConnectionCount() +
+                     2 * (send_port_count + recv_port_count));
   RouterTopologyComponent& router = this->AddRouter();
+  router.ReservePorts(send_port_count + recv_port_count);
   for (int64_t count = 0; count < send_port_count; count++) {
     XLS_RETURN_IF_ERROR(
         this->ConnectThroughChannel(this->AddSendPort(), router).status());
@@ -20,6 +20,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/noc/config_ng/network_topology_component.h"
 #include "xls/noc/config_ng/network_view.h"
 
@@ -44,6 +45,12 @@ class NetworkTopologyView final : public NetworkView {
   // See xls::noc::NetworkView::AddComponent.
   ChannelTopologyComponent& AddChannel();
 
+  // Bulk variants of the functions above for building regular topologies. See
+  // xls::noc::NetworkView::AddComponents.
+  std::vector<SendPortTopologyComponent*> AddSendPorts(int64_t count);
+  std::vector<ReceivePortTopologyComponent*> AddReceivePorts(int64_t count);
+  std::vector<RouterTopologyComponent*> AddRouters(int64_t count);
+
   int64_t GetSendPortCount() const;
 
   int64_t GetReceivePortCount() const;
@@ -62,6 +69,19 @@ class NetworkTopologyView final : public NetworkView {
   absl::StatusOr<ChannelTopologyComponent*> ConnectThroughChannel(
       NetworkComponent& source, NetworkComponent& sink);
 
+  // Connects sources[i] to sinks[i] through a new channel for every i, as
+  // ConnectThroughChannel does. The storage for the channels and connections
+  // is reserved up front, making this the preferred way to wire the stages of
+  // large regular topologies (e.g. butterflies). The source and sink spans must
+  // have the same size.
+  //
+  // Returns the newly created channels, in the order of the pairs, on success.
+  // Otherwise, returns an absl::FailedPreconditionError and leaves the view
+  // unmodified.
+  absl::StatusOr<std::vector<ChannelTopologyComponent*>> ConnectThroughChannels(
+      absl::Span<NetworkComponent* const> sources,
+      absl::Span<NetworkComponent* const> sinks);
+
   // TODO(vmirian) 02-05-2021 return send ports, receive ports and channels
   // Adds a router to the view and connects the router to send ports
   // and receive ports through channels.
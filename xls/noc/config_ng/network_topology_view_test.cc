@@ -14,9 +14,13 @@
 
 #include "xls/noc/config_ng/network_topology_view.h"
 
+#include <cstdint>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
 #include "xls/noc/config_ng/network_component.h"
+#include "xls/noc/config_ng/network_topology_component.h"
 
 namespace xls::noc {
 namespace {
@@ -93,6 +97,41 @@ TEST(NetworkTopologyViewTest, ConnectThroughChannel) {
   EXPECT_EQ(view.GetConnectionCount(), 2);
 }
 
+// Test ConnectThroughChannels function for network topology view.
+TEST(NetworkTopologyViewTest, ConnectThroughChannels) {
+  NetworkTopologyView view;
+  std::vector<RouterTopologyComponent*> routers = view.AddRouters(4);
+  EXPECT_EQ(view.GetRouterCount(), 4);
+  // Connect the routers as a ring.
+  std::vector<NetworkComponent*> sources;
+  std::vector<NetworkComponent*> sinks;
+  for (int64_t i = 0; i < routers.size(); ++i) {
+    sources.push_back(routers[i]);
+    sinks.push_back(routers[(i + 1) % routers.size()]);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<ChannelTopologyComponent*> channels,
+                           view.ConnectThroughChannels(sources, sinks));
+  EXPECT_EQ(channels.size(), 4);
+  EXPECT_EQ(view.GetChannelCount(), 4);
+  EXPECT_EQ(view.GetComponentCount(), 8);
+  EXPECT_EQ(view.GetConnectionCount(), 8);
+  for (RouterTopologyComponent* router : routers) {
+    EXPECT_EQ(router->GetPortCount(), 2);
+  }
+  for (ChannelTopologyComponent* channel : channels) {
+    EXPECT_EQ(channel->GetPortCount(), 2);
+  }
+}
+
+// Test ConnectThroughChannels function with mismatched sizes.
+TEST(NetworkTopologyViewTest, ConnectThroughChannelsSizeMismatch) {
+  NetworkTopologyView view;
+  std::vector<NetworkComponent*> sources = {&view.AddSendPort()};
+  EXPECT_FALSE(view.ConnectThroughChannels(sources, {}).ok());
+  EXPECT_EQ(view.GetComponentCount(), 1);
+  EXPECT_EQ(view.GetConnectionCount(), 0);
+}
+
 // Test AddRouter function for network topology view.
 TEST(NetworkTopologyViewTest, AddRouterTopologyComponentSendPortReceivePort) {
   NetworkTopologyView view;
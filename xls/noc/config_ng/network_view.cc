@@ -41,12 +41,28 @@ NetworkView::components() const {
 
 int64_t NetworkView::GetComponentCount() const { return components_.size(); }
 
+NetworkComponent& NetworkView::GetComponent(const int64_t index) const {
+  return *components_.at(index);
+}
+
+void NetworkView::ReserveComponents(const int64_t count) {
+  components_.reserve(count);
+}
+
 NetworkConnection& NetworkView::AddConnection() {
   // Using `new` to access a non-public constructor.
   connections_.emplace_back(absl::WrapUnique(new NetworkConnection(this)));
   return *connections_.back();
 }
 
+void NetworkView::ReserveConnections(const int64_t count) {
+  connections_.reserve(count);
+}
+
+NetworkConnection& NetworkView::GetConnection(const int64_t index) const {
+  return *connections_.at(index);
+}
+
 xabsl::iterator_range<UnwrappingIterator<
     std::vector<std::unique_ptr<NetworkConnection>>::iterator>>
 NetworkView::connections() {
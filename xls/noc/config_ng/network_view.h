@@ -18,8 +18,11 @@
 #include <cstdint>
 #include <memory>
 #include <type_traits>
+#include <typeindex>
+#include <typeinfo>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "xls/noc/config_ng/network_component.h"
 #include "xls/noc/config_ng/network_connection.h"
 
@@ -44,24 +47,42 @@ class NetworkView {
     static_assert(std::is_base_of<NetworkComponent, Type>::value,
                   "Type is not a Network Component subclass");
     components_.emplace_back(std::make_unique<Type>(this));
+    ++component_counts_[std::type_index(typeid(Type))];
     return static_cast<Type&>(*components_.back());
   }
 
+  // Adds `count` components of the type specified by the template, see
+  // AddComponent. Returns the newly added components in the order they were
+  // added; their indices in the view are contiguous.
+  template <typename Type>
+  std::vector<Type*> AddComponents(int64_t count) {
+    static_assert(std::is_base_of<NetworkComponent, Type>::value,
+                  "Type is not a Network Component subclass");
+    std::vector<Type*> result;
+    result.reserve(count);
+    components_.reserve(components_.size() + count);
+    for (int64_t i = 0; i < count; ++i) {
+      components_.emplace_back(std::make_unique<Type>(this));
+      result.push_back(static_cast<Type*>(components_.back().get()));
+    }
+    component_counts_[std::type_index(typeid(Type))] += count;
+    return result;
+  }
+
   // Counts the number of a components of the type specified by the template.
   // The component type must be a network component base class or derived class.
   template <typename Type>
   int64_t GetCount() const {
     static_assert(std::is_base_of<NetworkComponent, Type>::value,
                   "Type is not a Network Component subclass");
-    int64_t count = 0;
-    for (const NetworkComponent* component : components()) {
-      if (typeid(*component) == typeid(Type)) {
-        count++;
-      }
-    }
-    return count;
+    auto it = component_counts_.find(std::type_index(typeid(Type)));
+    return it == component_counts_.end() ? 0 : it->second;
   }
 
+  // Reserves storage for `count` components in total, so that building a large
+  // view does not repeatedly reallocate.
+  void ReserveComponents(int64_t count);
+
   // Returns an iterator range for the components. The objects are guaranteed to
   // be non-null. Note that, when using the result of this function, if the view
   // is modified (e.g. a component is added), the returned result may become
@@ -76,10 +97,17 @@ class NetworkView {
   // Returns the number of components.
   int64_t GetComponentCount() const;
 
+  // Returns the component at `index`, the position of the component in the
+  // order the components were added to the view.
+  NetworkComponent& GetComponent(int64_t index) const;
+
   // Add a connection to the view. The connection is owned by the view, the
   // lifetime of the connection is equivalent to the lifetime of the view.
   NetworkConnection& AddConnection();
 
+  // Reserves storage for `count` connections in total, see ReserveComponents.
+  void ReserveConnections(int64_t count);
+
   // Returns an iterator range for the connections. The objects are guaranteed
   // to be non-null. Note that, when using the result of this function, if the
   // view is modified (e.g. a connection is added), the returned result may
@@ -94,11 +122,17 @@ class NetworkView {
   // Returns the number of connections.
   int64_t GetConnectionCount() const;
 
+  // Returns the connection at `index`, the position of the connection in the
+  // order the connections were added to the view.
+  NetworkConnection& GetConnection(int64_t index) const;
+
   virtual ~NetworkView() = default;
 
  private:
   std::vector<std::unique_ptr<NetworkComponent>> components_;
   std::vector<std::unique_ptr<NetworkConnection>> connections_;
+  // The number of components of each (dynamic) type in the view.
+  absl::flat_hash_map<std::type_index, int64_t> component_counts_;
 };
 
 }  // namespace xls::noc
@@ -14,6 +14,9 @@
 
 #include "xls/noc/config_ng/network_view.h"
 
+#include <cstdint>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "xls/noc/config_ng/fake_network_component.h"
 #include "xls/noc/config_ng/network_connection.h"
@@ -35,5 +38,26 @@ TEST(NetworkViewTest, MemberFunction) {
   EXPECT_EQ(*view.connections().begin(), &connection);
 }
 
+// Test bulk addition and indexed access for network view.
+TEST(NetworkViewTest, AddComponentsAndIndexedAccess) {
+  NetworkView view;
+  view.ReserveComponents(5);
+  view.ReserveConnections(2);
+  FakeNetworkComponent& first = view.AddComponent<FakeNetworkComponent>();
+  std::vector<FakeNetworkComponent*> components =
+      view.AddComponents<FakeNetworkComponent>(4);
+  ASSERT_EQ(components.size(), 4);
+  EXPECT_EQ(view.GetComponentCount(), 5);
+  EXPECT_EQ(view.GetCount<FakeNetworkComponent>(), 5);
+  EXPECT_EQ(&view.GetComponent(0), &first);
+  for (int64_t i = 0; i < components.size(); ++i) {
+    EXPECT_EQ(&view.GetComponent(i + 1), components[i]);
+  }
+  NetworkConnection& connection0 = view.AddConnection();
+  NetworkConnection& connection1 = view.AddConnection();
+  EXPECT_EQ(&view.GetConnection(0), &connection0);
+  EXPECT_EQ(&view.GetConnection(1), &connection1);
+}
+
 }  // namespace
 }  // namespace xls::noc
@@ -0,0 +1,190 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/noc/drivers/traffic_sweep.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/noc/config/network_config.pb.h"
+#include "xls/noc/drivers/experiment.h"
+#include "xls/noc/simulation/common.h"
+#include "xls/noc/simulation/global_routing_table.h"
+#include "xls/noc/simulation/network_graph_builder.h"
+#include "xls/noc/simulation/noc_traffic_injector.h"
+#include "xls/noc/simulation/random_number_interface.h"
+#include "xls/noc/simulation/sim_objects.h"
+#include "xls/noc/simulation/simulator_to_traffic_injector_shim.h"
+#include "xls/noc/simulation/traffic_description.h"
+
+namespace xls::noc {
+
+absl::StatusOr<NocTrafficManager> ScaleTrafficMode(
+    const NocTrafficManager& traffic, std::string_view mode_name,
+    double scale) {
+  XLS_RET_CHECK_GE(scale, 0.0);
+  NocTrafficManager scaled = traffic;
+  XLS_ASSIGN_OR_RETURN(TrafficModeId mode_id,
+                       scaled.GetTrafficModeIdByName(mode_name));
+  constexpr int64_t kPsPerSec = 1'000'000'000'000;
+  for (TrafficFlowId flow_id :
+       scaled.GetTrafficMode(mode_id).GetTrafficFlows()) {
+    TrafficFlow& flow = scaled.GetTrafficFlow(flow_id);
+    if (flow.IsReplay()) {
+      continue;
+    }
+    flow.SetTrafficRateInBitsPerPS(
+        std::llround(flow.GetTrafficPerNumPsInBits(kPsPerSec) * scale),
+        kPsPerSec);
+  }
+  return scaled;
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<TrafficSweep>> TrafficSweep::Create(
+    const NetworkConfigProto& network,
+    DistributedRoutingTableBuilderBase&& distributed_routing_table_builder) {
+  std::unique_ptr<TrafficSweep> sweep(new TrafficSweep());
+  // The parameters refer to the protos they were built from, so build them
+  // from the copy owned by the sweep.
+  sweep->network_config_ = network;
+  XLS_RETURN_IF_ERROR(BuildNetworkGraphFromProto(
+      sweep->network_config_, &sweep->graph_, &sweep->params_));
+  XLS_ASSIGN_OR_RETURN(
+      DistributedRoutingTable routing_table,
+      distributed_routing_table_builder.BuildNetworkRoutingTables(
+          sweep->graph_.GetNetworkIds()[0], sweep->graph_, sweep->params_));
+  sweep->routing_table_ =
+      std::make_unique<DistributedRoutingTable>(std::move(routing_table));
+  // The routing tables are shared by every point of the sweep so the cost of
+  // compiling them is amortized.
+  XLS_RETURN_IF_ERROR(sweep->routing_table_->CompileRouterRoutingTables());
+  return sweep;
+}
+
+absl::StatusOr<TrafficSweepResult> TrafficSweep::RunPoint(
+    const NocTrafficManager& traffic, std::string_view mode_name,
+    const TrafficSweepPoint& point) {
+  XLS_RET_CHECK_GT(cycle_time_in_ps_, 0);
+  XLS_ASSIGN_OR_RETURN(
+      NocTrafficManager traffic_manager,
+      ScaleTrafficMode(traffic, mode_name, point.injection_rate_scale));
+  XLS_ASSIGN_OR_RETURN(TrafficModeId mode_id,
+                       traffic_manager.GetTrafficModeIdByName(mode_name));
+
+  NetworkId network_id = graph_.GetNetworkIds()[0];
+  RandomNumberInterface rnd;
+  rnd.SetSeed(point.seed);
+  XLS_ASSIGN_OR_RETURN(
+      NocTrafficInjector traffic_injector,
+      NocTrafficInjectorBuilder().Build(
+          cycle_time_in_ps_, mode_id,
+          routing_table_->GetSourceIndices().GetNetworkComponents(),
+          routing_table_->GetSinkIndices().GetNetworkComponents(),
+          params_.GetNetworkParam(network_id)->GetVirtualChannels(),
+          traffic_manager, graph_, params_, rnd));
+
+  NocSimulator simulator;
+  XLS_RETURN_IF_ERROR(
+      simulator.Initialize(graph_, params_, *routing_table_, network_id));
+  NocSimulatorToNocTrafficInjectorShim injector_shim(simulator,
+                                                     traffic_injector);
+  traffic_injector.SetSimulatorShim(injector_shim);
+  simulator.RegisterPreCycleService(injector_shim);
+
+  for (int64_t i = 0; i < total_simulation_cycle_count_; ++i) {
+    XLS_RETURN_IF_ERROR(simulator.RunCycle());
+  }
+
+  TrafficSweepResult result;
+  result.point = point;
+  for (int64_t i = 0; i < traffic_injector.FlowCount(); ++i) {
+    result.injected_traffic_rate_in_mibps +=
+        traffic_injector.MeasuredTrafficRateInMiBps(cycle_time_in_ps_, i);
+  }
+
+  int64_t vc_count = params_.GetNetworkParam(network_id)->VirtualChannelCount();
+  std::vector<internal::PacketInfo> packets;
+  for (NetworkComponentId sink_id :
+       routing_table_->GetSinkIndices().GetNetworkComponents()) {
+    XLS_ASSIGN_OR_RETURN(SimNetworkInterfaceSink * sink,
+                         simulator.GetSimNetworkInterfaceSink(sink_id));
+    result.received_traffic_rate_in_mibps +=
+        sink->MeasuredTrafficRateInMiBps(cycle_time_in_ps_);
+    for (int64_t vc = 0; vc < std::max<int64_t>(vc_count, 1); ++vc) {
+      std::vector<internal::PacketInfo> sink_packets =
+          internal::GetPacketInfo(sink->GetReceivedTraffic(), vc);
+      packets.insert(packets.end(), sink_packets.begin(), sink_packets.end());
+    }
+  }
+
+  internal::Stats stats = internal::GetStats(packets);
+  result.packet_count = packets.size();
+  if (!packets.empty()) {
+    result.min_latency = stats.min_latency;
+    result.max_latency = stats.max_latency;
+    result.average_latency = stats.average_latency;
+  }
+  result.latency_histogram.insert(stats.latency_histogram.begin(),
+                                  stats.latency_histogram.end());
+  return result;
+}
+
+absl::StatusOr<std::vector<TrafficSweepResult>> TrafficSweep::Run(
+    const NocTrafficManager& traffic, std::string_view mode_name,
+    absl::Span<const TrafficSweepPoint> points, int64_t thread_count) {
+  XLS_RET_CHECK_GE(thread_count, 1);
+  std::vector<absl::StatusOr<TrafficSweepResult>> results(points.size());
+  thread_count = std::min<int64_t>(thread_count, points.size());
+  if (thread_count <= 1) {
+    for (int64_t i = 0; i < points.size(); ++i) {
+      results[i] = RunPoint(traffic, mode_name, points[i]);
+    }
+  } else {
+    std::atomic<int64_t> next_point = 0;
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t t = 0; t < thread_count; ++t) {
+      threads.push_back(std::make_unique<Thread>([&] {
+        for (int64_t i = next_point++; i < points.size(); i = next_point++) {
+          results[i] = RunPoint(traffic, mode_name, points[i]);
+        }
+      }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+
+  std::vector<TrafficSweepResult> ret;
+  ret.reserve(results.size());
+  for (absl::StatusOr<TrafficSweepResult>& result : results) {
+    XLS_RETURN_IF_ERROR(result.status());
+    ret.push_back(*std::move(result));
+  }
+  return ret;
+}
+
+}  // namespace xls::noc
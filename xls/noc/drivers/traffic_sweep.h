@@ -0,0 +1,130 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NOC_DRIVERS_TRAFFIC_SWEEP_H_
+#define XLS_NOC_DRIVERS_TRAFFIC_SWEEP_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/noc/config/network_config.pb.h"
+#include "xls/noc/simulation/global_routing_table.h"
+#include "xls/noc/simulation/network_graph.h"
+#include "xls/noc/simulation/parameters.h"
+#include "xls/noc/simulation/traffic_description.h"
+
+// This file contains classes used to simulate a single network under many
+// traffic configurations, e.g. to characterize latency versus injection rate.
+
+namespace xls::noc {
+
+// A single configuration of a TrafficSweep.
+struct TrafficSweepPoint {
+  // Factor applied to the rate of each non-replay flow of the traffic mode.
+  double injection_rate_scale = 1.0;
+
+  // Seed of the random number generator driving the traffic models.
+  int16_t seed = 0;
+};
+
+// Measurements from simulating a single TrafficSweepPoint.
+struct TrafficSweepResult {
+  TrafficSweepPoint point;
+
+  // Sum of the traffic rates injected by all flows.
+  double injected_traffic_rate_in_mibps = 0.0;
+
+  // Sum of the traffic rates received by all sinks.
+  double received_traffic_rate_in_mibps = 0.0;
+
+  // Number of packets received by all sinks.
+  int64_t packet_count = 0;
+
+  // Latency in cycles from injection to arrival over all received packets.
+  int64_t min_latency = 0;
+  int64_t max_latency = 0;
+  double average_latency = 0.0;
+
+  // The key represents the latency, the value represents the packet count.
+  absl::btree_map<int64_t, int64_t> latency_histogram;
+};
+
+// Simulates one network under many traffic configurations.
+//
+// The network graph, parameters and routing tables are built once on
+// creation and shared read-only by all simulations, each of which only
+// creates its own traffic injector and simulator.
+class TrafficSweep {
+ public:
+  static absl::StatusOr<std::unique_ptr<TrafficSweep>> Create(
+      const NetworkConfigProto& network,
+      DistributedRoutingTableBuilderBase&& distributed_routing_table_builder =
+          DistributedRoutingTableBuilderForTrees());
+
+  TrafficSweep& SetSimulationCycleCount(int64_t count) {
+    CHECK_GE(count, 0);
+    total_simulation_cycle_count_ = count;
+    return *this;
+  }
+
+  TrafficSweep& SetCycleTimeInPs(int64_t ps) {
+    CHECK_GT(ps, 0);
+    cycle_time_in_ps_ = ps;
+    return *this;
+  }
+
+  int64_t GetSimulationCycleCount() const {
+    return total_simulation_cycle_count_;
+  }
+  int64_t GetCycleTimeInPs() const { return cycle_time_in_ps_; }
+
+  // Simulates the given traffic mode for a single point.
+  absl::StatusOr<TrafficSweepResult> RunPoint(const NocTrafficManager& traffic,
+                                              std::string_view mode_name,
+                                              const TrafficSweepPoint& point);
+
+  // Simulates the given traffic mode for each point using up to
+  // `thread_count` threads. Results are returned in the order of `points`.
+  absl::StatusOr<std::vector<TrafficSweepResult>> Run(
+      const NocTrafficManager& traffic, std::string_view mode_name,
+      absl::Span<const TrafficSweepPoint> points, int64_t thread_count);
+
+ private:
+  TrafficSweep() = default;
+
+  int64_t total_simulation_cycle_count_ = 0;
+  int64_t cycle_time_in_ps_ = 0;
+
+  NetworkConfigProto network_config_;
+  NetworkManager graph_;
+  NocParameters params_;
+  std::unique_ptr<DistributedRoutingTable> routing_table_;
+};
+
+// Returns a copy of `traffic` with the rate of each non-replay flow of
+// `mode_name` multiplied by `scale`.
+absl::StatusOr<NocTrafficManager> ScaleTrafficMode(
+    const NocTrafficManager& traffic, std::string_view mode_name,
+    double scale);
+
+}  // namespace xls::noc
+
+#endif  // XLS_NOC_DRIVERS_TRAFFIC_SWEEP_H_
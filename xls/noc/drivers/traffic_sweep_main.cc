@@ -0,0 +1,140 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Simulates the base configuration of a sample experiment over a sweep of
+// injection rates and seeds and prints the latency histogram of each point.
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/noc/drivers/experiment.h"
+#include "xls/noc/drivers/experiment_factory.h"
+#include "xls/noc/drivers/sample_experiments.h"
+#include "xls/noc/drivers/traffic_sweep.h"
+
+static constexpr std::string_view kUsage = R"(
+Simulates the base configuration of a sample experiment for each combination
+of injection rate scale and seed, and prints the latency histogram of each.
+The network and its routing tables are only built once. Example invocation:
+
+   traffic_sweep_main --experiment=SimpleVCExperiment \
+       --injection_rate_scales=0.25,0.5,1,2 --seeds=1,2,3
+)";
+
+ABSL_FLAG(std::string, experiment, "",
+          "Tag of the sample experiment to sweep.");
+ABSL_FLAG(std::vector<std::string>, injection_rate_scales, {"1"},
+          "Factors applied to the rate of each flow of the traffic mode.");
+ABSL_FLAG(std::vector<std::string>, seeds, {"0"},
+          "Seeds of the random traffic models.");
+ABSL_FLAG(int64_t, cycles, 0,
+          "Number of cycles to simulate for each point. Defaults to the cycle "
+          "count of the experiment.");
+ABSL_FLAG(int64_t, threads, 0,
+          "Number of points simulated concurrently. Defaults to the number of "
+          "available CPUs.");
+
+namespace xls::noc {
+namespace {
+
+absl::Status RealMain() {
+  ExperimentFactory factory;
+  XLS_RETURN_IF_ERROR(RegisterSampleExperiments(factory));
+  if (absl::GetFlag(FLAGS_experiment).empty()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("--experiment is required, one of: %s",
+                        absl::StrJoin(factory.ListExperimentTags(), ", ")));
+  }
+  XLS_ASSIGN_OR_RETURN(
+      Experiment experiment,
+      factory.BuildExperiment(absl::GetFlag(FLAGS_experiment)));
+  const ExperimentConfig& config = experiment.GetBaseConfig();
+  const ExperimentRunner& runner = experiment.GetRunner();
+
+  std::vector<TrafficSweepPoint> points;
+  for (const std::string& scale_str :
+       absl::GetFlag(FLAGS_injection_rate_scales)) {
+    double scale;
+    if (!absl::SimpleAtod(scale_str, &scale)) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid injection rate scale: %s", scale_str));
+    }
+    for (const std::string& seed_str : absl::GetFlag(FLAGS_seeds)) {
+      int32_t seed;
+      if (!absl::SimpleAtoi(seed_str, &seed)) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Invalid seed: %s", seed_str));
+      }
+      points.push_back({.injection_rate_scale = scale,
+                        .seed = static_cast<int16_t>(seed)});
+    }
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<TrafficSweep> sweep,
+                       TrafficSweep::Create(config.GetNetworkConfig()));
+  int64_t cycles = absl::GetFlag(FLAGS_cycles);
+  sweep
+      ->SetSimulationCycleCount(cycles > 0 ? cycles
+                                           : runner.GetSimulationCycleCount())
+      .SetCycleTimeInPs(runner.GetCycleTimeInPs());
+  int64_t threads = absl::GetFlag(FLAGS_threads);
+  if (threads <= 0) {
+    threads = std::max(AvailableCPUs(), 1);
+  }
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<TrafficSweepResult> results,
+      sweep->Run(config.GetTrafficConfig(), runner.GetTrafficMode(), points,
+                 threads));
+
+  for (const TrafficSweepResult& result : results) {
+    std::cout << absl::StreamFormat(
+        "scale %g seed %d: injected %.3f MiBps, received %.3f MiBps, %d "
+        "packets, latency min %d avg %.3f max %d\n",
+        result.point.injection_rate_scale, result.point.seed,
+        result.injected_traffic_rate_in_mibps,
+        result.received_traffic_rate_in_mibps, result.packet_count,
+        result.min_latency, result.average_latency, result.max_latency);
+    for (const auto& [latency, count] : result.latency_histogram) {
+      std::cout << absl::StreamFormat("  %d %d\n", latency, count);
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls::noc
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+  if (!positional_arguments.empty()) {
+    LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s", argv[0]);
+  }
+  return xls::ExitStatus(xls::noc::RealMain());
+}
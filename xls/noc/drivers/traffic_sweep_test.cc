@@ -0,0 +1,119 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/noc/drivers/traffic_sweep.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/noc/config/network_config.pb.h"
+#include "xls/noc/simulation/common.h"
+#include "xls/noc/simulation/global_routing_table.h"
+#include "xls/noc/simulation/network_graph.h"
+#include "xls/noc/simulation/parameters.h"
+#include "xls/noc/simulation/sample_network_graphs.h"
+#include "xls/noc/simulation/traffic_description.h"
+
+namespace xls::noc {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+// Returns traffic with a single random flow in mode "Mode 0".
+NocTrafficManager BuildTraffic() {
+  NocTrafficManager traffic;
+  TrafficFlowId flow0_id = traffic.CreateTrafficFlow().value();
+  traffic.GetTrafficFlow(flow0_id)
+      .SetName("flow0")
+      .SetSource("SendPort0")
+      .SetDestination("RecvPort0")
+      .SetVC("VC0")
+      .SetTrafficRateInMiBps(512)
+      .SetPacketSizeInBits(128)
+      .SetBurstProbInMils(7);
+  TrafficModeId mode0_id = traffic.CreateTrafficMode().value();
+  traffic.GetTrafficMode(mode0_id).SetName("Mode 0").RegisterTrafficFlow(
+      flow0_id);
+  return traffic;
+}
+
+TEST(TrafficSweepTest, ScaleTrafficMode) {
+  NocTrafficManager traffic = BuildTraffic();
+  XLS_ASSERT_OK_AND_ASSIGN(NocTrafficManager scaled,
+                           ScaleTrafficMode(traffic, "Mode 0", 0.5));
+  XLS_ASSERT_OK_AND_ASSIGN(TrafficFlowId flow0_id,
+                           scaled.GetTrafficFlowIdByName("flow0"));
+  EXPECT_DOUBLE_EQ(scaled.GetTrafficFlow(flow0_id).GetTrafficRateInMiBps(),
+                   256.0);
+  EXPECT_DOUBLE_EQ(traffic.GetTrafficFlow(flow0_id).GetTrafficRateInMiBps(),
+                   512.0);
+  EXPECT_FALSE(ScaleTrafficMode(traffic, "Mode 1", 0.5).ok());
+}
+
+TEST(TrafficSweepTest, ParallelSweepMatchesSequentialRuns) {
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphLinear000(&proto, &graph, &params));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TrafficSweep> sweep,
+                           TrafficSweep::Create(proto));
+  sweep->SetSimulationCycleCount(20'000).SetCycleTimeInPs(400);
+
+  NocTrafficManager traffic = BuildTraffic();
+  std::vector<TrafficSweepPoint> points = {
+      {.injection_rate_scale = 0.5, .seed = 1},
+      {.injection_rate_scale = 1.0, .seed = 1},
+      {.injection_rate_scale = 2.0, .seed = 1},
+      {.injection_rate_scale = 2.0, .seed = 2},
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<TrafficSweepResult> results,
+                           sweep->Run(traffic, "Mode 0", points,
+                                      /*thread_count=*/4));
+  ASSERT_EQ(results.size(), points.size());
+
+  for (int64_t i = 0; i < points.size(); ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(TrafficSweepResult expected,
+                             sweep->RunPoint(traffic, "Mode 0", points[i]));
+    EXPECT_EQ(results[i].point.injection_rate_scale,
+              points[i].injection_rate_scale);
+    EXPECT_EQ(results[i].point.seed, points[i].seed);
+    EXPECT_EQ(results[i].packet_count, expected.packet_count);
+    EXPECT_GT(results[i].packet_count, 0);
+    EXPECT_EQ(results[i].injected_traffic_rate_in_mibps,
+              expected.injected_traffic_rate_in_mibps);
+    EXPECT_THAT(results[i].latency_histogram,
+                ElementsAreArray(expected.latency_histogram));
+
+    int64_t histogram_packet_count = 0;
+    for (const auto& [latency, count] : results[i].latency_histogram) {
+      EXPECT_GE(latency, results[i].min_latency);
+      EXPECT_LE(latency, results[i].max_latency);
+      histogram_packet_count += count;
+    }
+    EXPECT_EQ(histogram_packet_count, results[i].packet_count);
+  }
+
+  // The injected traffic follows the scaled rate.
+  EXPECT_NEAR(results[0].injected_traffic_rate_in_mibps, 256.0, 256.0 * 0.1);
+  EXPECT_NEAR(results[1].injected_traffic_rate_in_mibps, 512.0, 512.0 * 0.1);
+  EXPECT_NEAR(results[2].injected_traffic_rate_in_mibps, 1024.0, 1024.0 * 0.1);
+}
+
+}  // namespace
+}  // namespace xls::noc
@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <string>
+#include <utility>
 
 #include "absl/container/inlined_vector.h"
 #include "absl/status/statusor.h"
@@ -243,7 +244,7 @@ class MetadataFlitBuilder {
   }
 
   MetadataFlitBuilder& Data(Bits data) {
-    flit_.data = data;
+    flit_.data = std::move(data);
     return *this;
   }
 
@@ -294,7 +295,7 @@ class DataFlitBuilder {
   }
 
   DataFlitBuilder& Data(Bits bits) {
-    data_ = bits;
+    data_ = std::move(bits);
     return *this;
   }
 
@@ -14,6 +14,7 @@
 
 #include "xls/noc/simulation/global_routing_table.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <ostream>
 #include <queue>
@@ -203,6 +204,66 @@ DistributedRoutingTable::GetRouterOutputPortByIndex(PortAndVCIndex from,
                       sink.AsUInt64()));
 }
 
+absl::Status DistributedRoutingTable::CompileRouterRoutingTables() {
+  compiled_routing_tables_.resize(routing_tables_.size());
+  compiled_routing_tables_.at(network_.id())
+      .resize(routing_tables_.at(network_.id()).size());
+  int64_t destination_count = sink_indices_.NetworkComponentCount();
+
+  const Network& network = network_manager_->GetNetwork(network_);
+  for (const NetworkComponentId& nc_id : network.GetNetworkComponentIds()) {
+    const NetworkComponent& nc = network.GetNetworkComponent(nc_id);
+    if (nc.kind() != NetworkComponentKind::kRouter) {
+      continue;
+    }
+    RouterRoutingTable& router_routing_table = GetRoutingTable(nc_id);
+    XLS_ASSIGN_OR_RETURN(int64_t input_port_count,
+                         port_indices_.InputPortCount(nc_id));
+
+    // Ports without vcs route on vc index 0.
+    int64_t vc_count = 1;
+    for (int64_t i = 0; i < input_port_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          PortId input_port_id,
+          port_indices_.GetPortByIndex(nc_id, PortDirection::kInput, i));
+      XLS_ASSIGN_OR_RETURN(PortParam input_port_param,
+                           network_parameters_->GetPortParam(input_port_id));
+      vc_count = std::max(vc_count, input_port_param.VirtualChannelCount());
+    }
+
+    CompiledRouterRoutingTable& compiled =
+        compiled_routing_tables_[nc_id.network()][nc_id.id()];
+    compiled.vc_count = vc_count;
+    compiled.destination_count = destination_count;
+    compiled.routes.assign(input_port_count * vc_count * destination_count,
+                           PortIndexAndVCIndex{-1, -1});
+    for (int64_t i = 0; i < input_port_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          PortId input_port_id,
+          port_indices_.GetPortByIndex(nc_id, PortDirection::kInput, i));
+      if (input_port_id.id() >= router_routing_table.routes.size()) {
+        continue;
+      }
+      const std::vector<PortRoutingList>& vc_routes =
+          router_routing_table.routes[input_port_id.id()];
+      for (int64_t vc = 0; vc < vc_routes.size(); ++vc) {
+        for (const auto& [destination_index, port_and_vc] : vc_routes[vc]) {
+          XLS_RET_CHECK_LT(vc, vc_count);
+          XLS_RET_CHECK_LT(destination_index, destination_count);
+          XLS_ASSIGN_OR_RETURN(
+              int64_t output_port_index,
+              port_indices_.GetPortIndex(port_and_vc.port_id_,
+                                         PortDirection::kOutput));
+          compiled.routes[(i * vc_count + vc) * destination_count +
+                          destination_index] =
+              PortIndexAndVCIndex{output_port_index, port_and_vc.vc_index_};
+        }
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status DistributedRoutingTable::DumpRouterRoutingTable(
     NetworkId network_id) const {
   const Network& network = network_manager_->GetNetwork(network_id);
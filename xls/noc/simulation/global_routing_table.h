@@ -49,6 +49,27 @@ struct PortIndexAndVCIndex {
   int64_t vc_index_;
 };
 
+// Routing table of a single router flattened into a dense array.
+//
+// Indexed by input port index, input vc index and destination (sink) index
+// so that routing a flit is a single load.
+struct CompiledRouterRoutingTable {
+  // Returns the output port index and vc of a flit arriving on the given
+  // input port index and vc with the given destination index. The port
+  // index is -1 if there is no route.
+  const PortIndexAndVCIndex& GetRoute(int64_t input_port_index,
+                                      int64_t vc_index,
+                                      int64_t destination_index) const {
+    return routes[(input_port_index * vc_count + vc_index) *
+                      destination_count +
+                  destination_index];
+  }
+
+  int64_t vc_count = 0;
+  int64_t destination_count = 0;
+  std::vector<PortIndexAndVCIndex> routes;
+};
+
 // Generic class to store routing tables for an entire network.
 class DistributedRoutingTable {
  public:
@@ -107,8 +128,21 @@ class DistributedRoutingTable {
   absl::StatusOr<PortAndVCIndex> GetRouterOutputPortByIndex(
       PortAndVCIndex from, int64_t destination_index);
 
-  // TODO(tedhong): 2020-01-25 Add indexer for input/output ports of a router
-  //                          and support routing directly via indices.
+  // Flattens the routing table of each router into a
+  // CompiledRouterRoutingTable, trading memory (proportional to the number of
+  // input ports, vcs and sinks of each router) for faster routing.
+  absl::Status CompileRouterRoutingTables();
+
+  // Returns the compiled routing table of a router or nullptr if
+  // CompileRouterRoutingTables has not been called.
+  const CompiledRouterRoutingTable* GetCompiledRouterRoutingTable(
+      NetworkComponentId nc_id) const {
+    if (compiled_routing_tables_.size() <= nc_id.network() ||
+        compiled_routing_tables_[nc_id.network()].size() <= nc_id.id()) {
+      return nullptr;
+    }
+    return &compiled_routing_tables_[nc_id.network()][nc_id.id()];
+  }
 
   // Returns mapping of vc params to local indicies.
   const VirtualChannelIndexMap& GetVirtualChannelIndices() {
@@ -164,6 +198,11 @@ class DistributedRoutingTable {
   // ie. routing table for ComponentId id is
   //  routing_tables_[id.network()][id.id()]
   std::vector<std::vector<RouterRoutingTable>> routing_tables_;
+
+  // Compiled routing tables indexed like routing_tables_. Empty until
+  // CompileRouterRoutingTables is called.
+  std::vector<std::vector<CompiledRouterRoutingTable>>
+      compiled_routing_tables_;
 };
 
 // Abstract base class for distributed routing table builder.
@@ -22,6 +22,7 @@
 #include "gtest/gtest.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
@@ -29,6 +30,7 @@
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/config/network_config_proto_builder.h"
 #include "xls/noc/simulation/common.h"
+#include "xls/noc/simulation/indexer.h"
 #include "xls/noc/simulation/network_graph_builder.h"
 #include "xls/noc/simulation/parameters.h"
 #include "xls/noc/simulation/sample_network_graphs.h"
@@ -387,6 +389,70 @@ TEST(GlobalRoutingTableTest, MultiplePathsBetweenRouters) {
                                               linkbo1_id, recvport1));
 }
 
+TEST(GlobalRoutingTableTest, CompiledRoutingTablesMatchRoutingTables) {
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphLinear001(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForMultiplePaths route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                           route_builder.BuildNetworkRoutingTables(
+                               graph.GetNetworkIds()[0], graph, params));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId routera_id,
+      FindNetworkComponentByName("RouterA", graph, params));
+  EXPECT_EQ(routing_table.GetCompiledRouterRoutingTable(routera_id), nullptr);
+  XLS_ASSERT_OK(routing_table.CompileRouterRoutingTables());
+
+  const PortIndexMap& port_indices = routing_table.GetPortIndices();
+  int64_t destination_count =
+      routing_table.GetSinkIndices().NetworkComponentCount();
+  int64_t route_count = 0;
+  for (NetworkComponentId nc_id :
+       graph.GetNetwork(graph.GetNetworkIds()[0]).GetNetworkComponentIds()) {
+    if (graph.GetNetworkComponent(nc_id).kind() !=
+        NetworkComponentKind::kRouter) {
+      continue;
+    }
+    const CompiledRouterRoutingTable* compiled =
+        routing_table.GetCompiledRouterRoutingTable(nc_id);
+    ASSERT_NE(compiled, nullptr);
+    EXPECT_EQ(compiled->destination_count, destination_count);
+
+    XLS_ASSERT_OK_AND_ASSIGN(int64_t input_port_count,
+                             port_indices.InputPortCount(nc_id));
+    for (int64_t i = 0; i < input_port_count; ++i) {
+      XLS_ASSERT_OK_AND_ASSIGN(
+          PortId input_port,
+          port_indices.GetPortByIndex(nc_id, PortDirection::kInput, i));
+      for (int64_t vc = 0; vc < compiled->vc_count; ++vc) {
+        for (int64_t d = 0; d < destination_count; ++d) {
+          const PortIndexAndVCIndex& route = compiled->GetRoute(i, vc, d);
+          absl::StatusOr<PortAndVCIndex> expected =
+              routing_table.GetRouterOutputPortByIndex(
+                  PortAndVCIndex{input_port, vc}, d);
+          if (!expected.ok()) {
+            EXPECT_EQ(route.port_index_, -1);
+            continue;
+          }
+          XLS_ASSERT_OK_AND_ASSIGN(
+              int64_t expected_port_index,
+              port_indices.GetPortIndex(expected->port_id_,
+                                        PortDirection::kOutput));
+          EXPECT_EQ(route.port_index_, expected_port_index);
+          EXPECT_EQ(route.vc_index_, expected->vc_index_);
+          ++route_count;
+        }
+      }
+    }
+  }
+
+  // Each of the two routers routes from each of its two inputs to both sinks.
+  EXPECT_GE(route_count, 8);
+}
+
 TEST(GlobalRoutingTableTest, MultiplePathsBetweenRoutersWithLoop0) {
   // Build and assign simulation objects
   NetworkConfigProto proto;
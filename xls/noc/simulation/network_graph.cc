@@ -16,12 +16,14 @@
 
 #include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/noc/simulation/common.h"
@@ -55,6 +57,15 @@ absl::StatusOr<NetworkComponentId> NetworkManager::CreateNetworkComponent(
   return networks_[network.id()].CreateNetworkComponent(kind);
 }
 
+absl::StatusOr<std::vector<NetworkComponentId>>
+NetworkManager::CreateNetworkComponents(NetworkId network,
+                                        NetworkComponentKind kind,
+                                        int64_t count) {
+  XLS_RET_CHECK(network.id() < networks_.size());
+
+  return networks_[network.id()].CreateNetworkComponents(kind, count);
+}
+
 absl::StatusOr<PortId> NetworkManager::CreatePort(NetworkComponentId component,
                                                   PortDirection dir) {
   XLS_RET_CHECK(component.GetNetworkId().id() < networks_.size());
@@ -62,6 +73,16 @@ absl::StatusOr<PortId> NetworkManager::CreatePort(NetworkComponentId component,
   return networks_[component.GetNetworkId().id()].CreatePort(component, dir);
 }
 
+absl::StatusOr<std::vector<PortId>> NetworkManager::CreatePorts(
+    NetworkComponentId component, PortDirection dir, int64_t count) {
+  XLS_RET_CHECK(component.GetNetworkId().id() < networks_.size());
+
+  Network& network = networks_[component.GetNetworkId().id()];
+  XLS_RET_CHECK(component.id() < network.GetNetworkComponentCount());
+
+  return network.GetNetworkComponent(component).CreatePorts(dir, count);
+}
+
 absl::StatusOr<ConnectionId> NetworkManager::CreateConnection(
     NetworkId network) {
   XLS_RET_CHECK(network.id() < networks_.size());
@@ -77,6 +98,14 @@ absl::StatusOr<ConnectionId> NetworkManager::CreateConnection(NetworkId network,
   return networks_.at(network.id()).CreateConnection(src, sink);
 }
 
+absl::StatusOr<std::vector<ConnectionId>> NetworkManager::CreateConnections(
+    NetworkId network,
+    absl::Span<const std::pair<PortId, PortId>> src_sink_pairs) {
+  XLS_RET_CHECK(network.id() < networks_.size());
+
+  return networks_.at(network.id()).CreateConnections(src_sink_pairs);
+}
+
 void NetworkManager::Attach(ConnectionId conn, PortId p) {
   return networks_.at(conn.GetNetworkId().id()).Attach(conn, p);
 }
@@ -141,6 +170,31 @@ absl::StatusOr<NetworkComponentId> Network::CreateNetworkComponent(
   return next_id;
 }
 
+absl::StatusOr<std::vector<NetworkComponentId>>
+Network::CreateNetworkComponents(NetworkComponentKind kind, int64_t count) {
+  XLS_RET_CHECK_GE(count, 0);
+  int64_t n_network_components = components_.size();
+  std::vector<NetworkComponentId> ret;
+  if (count == 0) {
+    return ret;
+  }
+
+  // Ids are allocated sequentially so only the last needs validation.
+  XLS_RETURN_IF_ERROR(NetworkComponentId::ValidateAndReturnId(
+                          id_.id(),  // NetworkId
+                          n_network_components + count - 1)
+                          .status());
+  components_.reserve(n_network_components + count);
+  ret.reserve(count);
+  for (int64_t i = n_network_components; i < n_network_components + count;
+       ++i) {
+    NetworkComponentId next_id(id_.id(), i);
+    components_.emplace_back(next_id, kind);
+    ret.push_back(next_id);
+  }
+  return ret;
+}
+
 absl::StatusOr<PortId> Network::CreatePort(NetworkComponentId component,
                                            PortDirection dir) {
   if (component.GetNetworkId() != id_) {
@@ -192,6 +246,41 @@ absl::StatusOr<ConnectionId> Network::CreateConnection() {
   return next_id;
 }
 
+absl::StatusOr<std::vector<ConnectionId>> Network::CreateConnections(
+    absl::Span<const std::pair<PortId, PortId>> src_sink_pairs) {
+  for (const auto& [src, sink] : src_sink_pairs) {
+    if (src.GetNetworkId() != id_ || sink.GetNetworkId() != id_) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Cannot CreateConnection from src port %x "
+                          "to sink port %x, expected network %x",
+                          src.AsUInt64(), sink.AsUInt64(), id_.id()));
+    }
+  }
+
+  int64_t n_connections = connections_.size();
+  std::vector<ConnectionId> ret;
+  if (src_sink_pairs.empty()) {
+    return ret;
+  }
+
+  // Ids are allocated sequentially so only the last needs validation.
+  XLS_RETURN_IF_ERROR(
+      ConnectionId::ValidateAndReturnId(id_.id(),  // NetworkId
+                                        n_connections +
+                                            src_sink_pairs.size() - 1)
+          .status());
+  connections_.reserve(n_connections + src_sink_pairs.size());
+  ret.reserve(src_sink_pairs.size());
+  for (const auto& [src, sink] : src_sink_pairs) {
+    ConnectionId next_id(id_.id(), connections_.size());
+    connections_.emplace_back(mgr_, next_id);
+    connections_.back().Attach(src);
+    connections_.back().Attach(sink);
+    ret.push_back(next_id);
+  }
+  return ret;
+}
+
 void Network::Attach(ConnectionId conn, PortId p) {
   connections_.at(conn.id()).Attach(p);
 }
@@ -254,6 +343,31 @@ absl::StatusOr<PortId> NetworkComponent::CreatePort(PortDirection dir) {
   return next_id;
 }
 
+absl::StatusOr<std::vector<PortId>> NetworkComponent::CreatePorts(
+    PortDirection dir, int64_t count) {
+  XLS_RET_CHECK_GE(count, 0);
+  int64_t n_ports = ports_.size();
+  std::vector<PortId> ret;
+  if (count == 0) {
+    return ret;
+  }
+
+  // Ids are allocated sequentially so only the last needs validation.
+  XLS_RETURN_IF_ERROR(
+      PortId::ValidateAndReturnId(id_.GetNetworkId().id(),  // Network
+                                  id_.id(),                 // Component
+                                  n_ports + count - 1)
+          .status());
+  ports_.reserve(n_ports + count);
+  ret.reserve(count);
+  for (int64_t i = n_ports; i < n_ports + count; ++i) {
+    PortId next_id = GetPortIdByIndex(i);
+    ports_.emplace_back(next_id, dir);
+    ret.push_back(next_id);
+  }
+  return ret;
+}
+
 Port& NetworkComponent::GetPort(PortId id) { return ports_.at(id.id()); }
 const Port& NetworkComponent::GetPort(PortId id) const {
   return ports_.at(id.id());
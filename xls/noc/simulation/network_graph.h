@@ -16,6 +16,7 @@
 #define XLS_NOC_SIMULATION_NETWORK_GRAPH_H_
 
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 #include "absl/status/statusor.h"
@@ -123,6 +124,14 @@ class NetworkComponent {
   // Creates/adds a port to a network component.
   absl::StatusOr<PortId> CreatePort(PortDirection dir);
 
+  // Creates/adds count ports with the same direction to a network component.
+  // The ids of the new ports are contiguous and returned in order.
+  absl::StatusOr<std::vector<PortId>> CreatePorts(PortDirection dir,
+                                                  int64_t count);
+
+  // Reserves storage for count ports in total.
+  void ReservePorts(int64_t count) { ports_.reserve(count); }
+
   // Get Port object given an id.
   Port& GetPort(PortId id);
 
@@ -187,6 +196,11 @@ class Network {
   absl::StatusOr<NetworkComponentId> CreateNetworkComponent(
       NetworkComponentKind kind);
 
+  // Create count new network components of the same kind under a network.
+  // The ids of the new components are contiguous and returned in order.
+  absl::StatusOr<std::vector<NetworkComponentId>> CreateNetworkComponents(
+      NetworkComponentKind kind, int64_t count);
+
   // Creates/adds a port to a network component.
   absl::StatusOr<PortId> CreatePort(NetworkComponentId component,
                                     PortDirection dir);
@@ -200,6 +214,20 @@ class Network {
   // Either from or to PortIds may be invalid to create a dangling connection.
   absl::StatusOr<ConnectionId> CreateConnection(PortId src, PortId sink);
 
+  // Create a connection between each (src, sink) pair of ports.
+  // The ids of the new connections are contiguous and returned in order.
+  // No connection is created if any of the ports is from another network.
+  absl::StatusOr<std::vector<ConnectionId>> CreateConnections(
+      absl::Span<const std::pair<PortId, PortId>> src_sink_pairs);
+
+  // Reserves storage for the given total number of components and
+  // connections so that building large networks does not repeatedly
+  // reallocate.
+  void Reserve(int64_t component_count, int64_t connection_count) {
+    components_.reserve(component_count);
+    connections_.reserve(connection_count);
+  }
+
   // Associate a connection with a specific port.
   // If necessary, this will dissociate the connection with its exiting
   // port.
@@ -275,8 +303,8 @@ class Network {
 
   // Return a vector of all managed Connection ids.
   std::vector<ConnectionId> GetConnectionIds() const {
-    std::vector<ConnectionId> ret(components_.size());
-    for (int64_t i = 0; i < components_.size(); ++i) {
+    std::vector<ConnectionId> ret(connections_.size());
+    for (int64_t i = 0; i < connections_.size(); ++i) {
       ret[i] = ConnectionId(id_.id(), i);
     }
     return ret;
@@ -320,10 +348,21 @@ class NetworkManager {
   absl::StatusOr<NetworkComponentId> CreateNetworkComponent(
       NetworkId network, NetworkComponentKind kind);
 
+  // Create count new network components of the same kind under a network.
+  // The ids of the new components are contiguous and returned in order.
+  absl::StatusOr<std::vector<NetworkComponentId>> CreateNetworkComponents(
+      NetworkId network, NetworkComponentKind kind, int64_t count);
+
   // Creates/adds a port to a network component.
   absl::StatusOr<PortId> CreatePort(NetworkComponentId component,
                                     PortDirection dir);
 
+  // Creates/adds count ports with the same direction to a network component.
+  // The ids of the new ports are contiguous and returned in order.
+  absl::StatusOr<std::vector<PortId>> CreatePorts(NetworkComponentId component,
+                                                  PortDirection dir,
+                                                  int64_t count);
+
   // Create a connection between two ports.
   // Either from or to PortIds may be invalid to create a dangling connection.
   absl::StatusOr<ConnectionId> CreateConnection(NetworkId network, PortId src,
@@ -334,6 +373,12 @@ class NetworkManager {
   // with a port.
   absl::StatusOr<ConnectionId> CreateConnection(NetworkId network);
 
+  // Create a connection between each (src, sink) pair of ports.
+  // The ids of the new connections are contiguous and returned in order.
+  absl::StatusOr<std::vector<ConnectionId>> CreateConnections(
+      NetworkId network,
+      absl::Span<const std::pair<PortId, PortId>> src_sink_pairs);
+
   // Associate a connection with a specific port.
   // If necessary, this will dissociate the connection with its exiting
   // port.
@@ -14,14 +14,13 @@
 
 #include "xls/noc/simulation/network_graph_builder.h"
 
-#include <string>
+#include <cstdint>
 #include <string_view>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
-#include "absl/types/variant.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/simulation/common.h"
@@ -75,10 +74,10 @@ class NetworkGraphBuilderImpl {
                                      const PortConfigProto& port);
 
   // Memoizes mapping from proto naming of ports to PortIds.
-  void MemoizePortNameToId(const std::string& name, PortId id);
+  void MemoizePortNameToId(std::string_view name, PortId id);
 
   // Retreives PortId given the proto naming of a port.
-  absl::StatusOr<PortId> GetPortIdFromName(const std::string& name);
+  absl::StatusOr<PortId> GetPortIdFromName(std::string_view name) const;
 
   // External reference to NetworkGraph that will be built.
   NetworkManager* mgr_;
@@ -87,7 +86,8 @@ class NetworkGraphBuilderImpl {
   NocParameters* params_;
 
   // Map from proto port names to PortIds used in the NetworkGraph.
-  absl::flat_hash_map<std::string, PortId> network_ports_;
+  //   The names are owned by the proto being built.
+  absl::flat_hash_map<std::string_view, PortId> network_ports_;
 };
 
 absl::StatusOr<PortConfigProto::Direction> GetPortConfigProtoDirection(
@@ -109,6 +109,18 @@ absl::Status NetworkGraphBuilderImpl::BuildNetwork(
   XLS_ASSIGN_OR_RETURN(NetworkId network_id, mgr_->CreateNetwork());
   params_->SetNetworkParam(network_id, network_param);
 
+  // Each network interface and router is a component, each link is a
+  // component with two connections.
+  mgr_->GetNetwork(network_id)
+      .Reserve(network.ports_size() + network.routers_size() +
+                   network.links_size(),
+               2 * network.links_size());
+  int64_t port_count = network.ports_size();
+  for (const RouterConfigProto& router : network.routers()) {
+    port_count += router.ports_size();
+  }
+  network_ports_.reserve(network_ports_.size() + port_count);
+
   for (const PortConfigProto& port : network.ports()) {
     XLS_RETURN_IF_ERROR(BuildNetworkInterface(network_id, network, port));
   }
@@ -132,6 +144,7 @@ absl::Status NetworkGraphBuilderImpl::BuildRouter(
       NetworkComponentId component_id,
       mgr_->CreateNetworkComponent(network_id, NetworkComponentKind::kRouter));
   params_->SetNetworkComponentParam(component_id, RouterParam(network, router));
+  mgr_->GetNetworkComponent(component_id).ReservePorts(router.ports_size());
 
   for (const PortConfigProto& port : router.ports()) {
     XLS_RETURN_IF_ERROR(BuildRouterPort(component_id, network, port));
@@ -163,6 +176,7 @@ absl::Status NetworkGraphBuilderImpl::BuildLink(
       NetworkComponentId component_id,
       mgr_->CreateNetworkComponent(network_id, NetworkComponentKind::kLink));
   params_->SetNetworkComponentParam(component_id, LinkParam(network, link));
+  mgr_->GetNetworkComponent(component_id).ReservePorts(2);
 
   // Create ports and create connections to the other side of the link.
   ConnectionId conn_id;
@@ -233,15 +247,16 @@ absl::Status NetworkGraphBuilderImpl::BuildNetworkInterface(
   return absl::OkStatus();
 }
 
-void NetworkGraphBuilderImpl::MemoizePortNameToId(const std::string& name,
+void NetworkGraphBuilderImpl::MemoizePortNameToId(std::string_view name,
                                                   PortId id) {
   network_ports_[name] = id;
 }
 
 absl::StatusOr<PortId> NetworkGraphBuilderImpl::GetPortIdFromName(
-    const std::string& name) {
-  if (network_ports_.contains(name)) {
-    return network_ports_[name];
+    std::string_view name) const {
+  auto iter = network_ports_.find(name);
+  if (iter != network_ports_.end()) {
+    return iter->second;
   }
 
   return absl::InternalError(
@@ -267,43 +282,34 @@ absl::Status BuildNetworkGraphFromProto(const NetworkConfigProto& proto,
 absl::StatusOr<NetworkComponentId> FindNetworkComponentByName(
     std::string_view name, NetworkManager& network_mgr,
     NocParameters& noc_parameters) {
-  for (Network& network : network_mgr.GetNetworks()) {
-    for (NetworkComponentId nc : network.GetNetworkComponentIds()) {
-      absl::StatusOr<NetworkComponentParam> param_status =
-          noc_parameters.GetNetworkComponentParam(nc);
-
-      if (param_status.ok()) {
-        std::string_view nc_name =
-            absl::visit([](auto nc) { return nc.GetName(); }, *param_status);
-        if (nc_name == name) {
-          return nc;
-        }
-      }
-    }
+  XLS_ASSIGN_OR_RETURN(NetworkComponentId nc,
+                       noc_parameters.GetNetworkComponentIdByName(name));
+
+  if (nc.network() >= network_mgr.GetNetworkCount() ||
+      nc.id() >= network_mgr.GetNetwork(nc.GetNetworkId())
+                     .GetNetworkComponentCount()) {
+    return absl::NotFoundError(absl::StrFormat(
+        "Unable to find network component with param name %s", name));
   }
 
-  return absl::NotFoundError(absl::StrFormat(
-      "Unable to find network component with param name %s", name));
+  return nc;
 }
 
 absl::StatusOr<PortId> FindPortByName(std::string_view name,
                                       NetworkManager& network_mgr,
                                       NocParameters& noc_parameters) {
-  for (Network& network : network_mgr.GetNetworks()) {
-    for (NetworkComponent& nc : network.GetNetworkComponents()) {
-      for (PortId port : nc.GetPortIds()) {
-        absl::StatusOr<PortParam> param_status =
-            noc_parameters.GetPortParam(port);
-
-        if (param_status.ok() && param_status->GetName() == name) {
-          return port;
-        }
-      }
-    }
+  XLS_ASSIGN_OR_RETURN(PortId port, noc_parameters.GetPortIdByName(name));
+
+  if (port.network() >= network_mgr.GetNetworkCount() ||
+      port.component() >= network_mgr.GetNetwork(port.GetNetworkId())
+                              .GetNetworkComponentCount() ||
+      port.id() >= network_mgr.GetNetworkComponent(port.GetNetworkComponentId())
+                       .GetPortCount()) {
+    return absl::NotFoundError(
+        absl::StrFormat("Unable to find port with param name %s", name));
   }
 
-  return absl::NotFoundError(
-      absl::StrFormat("Unable to find port with param name %s", name));
+  return port;
 }
 
 }  // namespace noc
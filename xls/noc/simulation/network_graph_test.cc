@@ -14,7 +14,12 @@
 
 #include "xls/noc/simulation/network_graph.h"
 
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 #include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
 #include "xls/noc/simulation/common.h"
 
 namespace xls {
@@ -155,6 +160,79 @@ TEST(SimNetworkGraph, CreateUnitTest) {
   EXPECT_EQ(mgr.GetNetworkComponent(dest).GetPortIdByIndex(0), dest_p0);
 }
 
+TEST(SimNetworkGraph, BulkCreateTest) {
+  constexpr int64_t kCount = 64;
+  NetworkManager mgr;
+
+  XLS_ASSERT_OK_AND_ASSIGN(NetworkId network, mgr.CreateNetwork());
+  Network& network_obj = mgr.GetNetwork(network);
+  network_obj.Reserve(2 * kCount, kCount);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<NetworkComponentId> srcs,
+      mgr.CreateNetworkComponents(network, NetworkComponentKind::kNISrc,
+                                  kCount));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<NetworkComponentId> sinks,
+      mgr.CreateNetworkComponents(network, NetworkComponentKind::kNISink,
+                                  kCount));
+  ASSERT_EQ(srcs.size(), kCount);
+  ASSERT_EQ(sinks.size(), kCount);
+  EXPECT_EQ(network_obj.GetNetworkComponentCount(), 2 * kCount);
+
+  std::vector<std::pair<PortId, PortId>> src_sink_pairs;
+  for (int64_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(srcs[i], network_obj.GetNetworkComponentIdByIndex(i));
+    EXPECT_EQ(sinks[i], network_obj.GetNetworkComponentIdByIndex(kCount + i));
+    EXPECT_EQ(mgr.GetNetworkComponent(srcs[i]).kind(),
+              NetworkComponentKind::kNISrc);
+
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::vector<PortId> src_ports,
+        mgr.CreatePorts(srcs[i], PortDirection::kOutput, 1));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::vector<PortId> sink_ports,
+        mgr.CreatePorts(sinks[i], PortDirection::kInput, 1));
+    src_sink_pairs.push_back({src_ports[0], sink_ports[0]});
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<ConnectionId> conns,
+                           mgr.CreateConnections(network, src_sink_pairs));
+  ASSERT_EQ(conns.size(), kCount);
+  EXPECT_EQ(network_obj.GetConnectionCount(), kCount);
+  EXPECT_EQ(network_obj.GetConnectionIds().size(), kCount);
+  for (int64_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(network_obj.GetConnectionIds()[i], conns[i]);
+    EXPECT_EQ(mgr.GetConnection(conns[i]).src(), src_sink_pairs[i].first);
+    EXPECT_EQ(mgr.GetConnection(conns[i]).sink(), src_sink_pairs[i].second);
+    EXPECT_EQ(mgr.GetPort(src_sink_pairs[i].first).connection(), conns[i]);
+    EXPECT_EQ(mgr.GetPort(src_sink_pairs[i].second).connection(), conns[i]);
+  }
+
+  // Multiple ports of a component are allocated contiguously.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<PortId> ports,
+      mgr.CreatePorts(srcs[0], PortDirection::kInput, 3));
+  ASSERT_EQ(ports.size(), 3);
+  for (int64_t i = 0; i < ports.size(); ++i) {
+    EXPECT_EQ(ports[i],
+              mgr.GetNetworkComponent(srcs[0]).GetPortIdByIndex(i + 1));
+  }
+  EXPECT_EQ(mgr.GetNetworkComponent(srcs[0]).GetPortCount(), 4);
+
+  // Ports must belong to the network.
+  XLS_ASSERT_OK_AND_ASSIGN(NetworkId other_network, mgr.CreateNetwork());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId other_src,
+      mgr.CreateNetworkComponent(other_network, NetworkComponentKind::kNISrc));
+  XLS_ASSERT_OK_AND_ASSIGN(PortId other_port,
+                           mgr.CreatePort(other_src, PortDirection::kOutput));
+  std::vector<std::pair<PortId, PortId>> bad_pairs = {
+      {other_port, src_sink_pairs[0].second}};
+  EXPECT_FALSE(mgr.CreateConnections(network, bad_pairs).ok());
+  EXPECT_EQ(mgr.GetNetwork(network).GetConnectionCount(), kCount);
+}
+
 }  // namespace
 }  // namespace noc
 }  // namespace xls
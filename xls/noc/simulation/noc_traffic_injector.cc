@@ -50,14 +50,17 @@ absl::Status NocTrafficInjector::RunCycle() {
   ++cycle_;
 
   for (int64_t i = 0; i < traffic_models_.size(); ++i) {
-    // Retrieve packets.
-    std::vector<DataPacket> packets =
-        traffic_models_[i]->GetNewCyclePackets(cycle_);
+    // Retrieve the number of packets sent this cycle.
+    int64_t packet_count = traffic_models_[i]->GetNewCyclePacketCount(cycle_);
 
-    this->traffic_model_monitor_[i].AcceptNewPackets(absl::MakeSpan(packets),
-                                                     cycle_);
+    traffic_model_monitor_[i].AcceptNewPacketCount(
+        packet_count, traffic_models_[i]->GetPacketSizeInBits(), cycle_);
 
-    // Convert to flits, and sequence them for injection.
+    if (packet_count == 0) {
+      continue;
+    }
+
+    // Sequence the flits of each packet for injection.
     int64_t source_index = flows_index_to_sources_index_map_.at(i);
     NetworkComponentId source = source_network_interfaces_.at(source_index);
 
@@ -71,18 +74,14 @@ absl::Status NocTrafficInjector::RunCycle() {
     //
     // TODO(tedhong): 2021-06-29 - Model priority between different flows.
     //                             so packets are not handled and sent in-order.
-
-    DePacketizer& depacketizer = depacketizers_[source_index];
-    for (DataPacket& p : packets) {
-      XLS_RET_CHECK_OK(depacketizer.AcceptNewPacket(p));
-
-      while (!depacketizer.IsIdle()) {
-        XLS_ASSIGN_OR_RETURN(DataFlit flit, depacketizer.ComputeNextFlit());
+    for (int64_t p = 0; p < packet_count; ++p) {
+      for (const DataFlit& flit : flows_index_to_flits_[i]) {
         // Add information defining the cycle iteration the flit is injected
         // into the network.
         TimedDataFlitInfo info{cycle_};
-        TimedDataFlit timed_data_flit{cycle_, flit, info};
-        XLS_RET_CHECK_OK(simulator_->SendFlitAtTime(timed_data_flit, source));
+        TimedDataFlit timed_data_flit{cycle_, flit, std::move(info)};
+        XLS_RET_CHECK_OK(
+            simulator_->SendFlitAtTime(std::move(timed_data_flit), source));
       }
     }
   }
@@ -367,4 +366,24 @@ absl::Status NocTrafficInjectorBuilder::BuildPerInterfaceDepacketizer(
   return absl::OkStatus();
 }
 
+absl::Status NocTrafficInjectorBuilder::BuildPerFlowFlits(
+    NocTrafficInjector& injector) {
+  injector.flows_index_to_flits_.reserve(injector.traffic_models_.size());
+  for (int64_t i = 0; i < injector.traffic_models_.size(); ++i) {
+    // Use a copy so the injector's depacketizer is left idle.
+    DePacketizer depacketizer = injector.depacketizers_.at(
+        injector.flows_index_to_sources_index_map_.at(i));
+    XLS_RET_CHECK_OK(depacketizer.AcceptNewPacket(
+        injector.traffic_models_[i]->GetPacketTemplate()));
+
+    std::vector<DataFlit>& flits =
+        injector.flows_index_to_flits_.emplace_back();
+    while (!depacketizer.IsIdle()) {
+      XLS_ASSIGN_OR_RETURN(DataFlit flit, depacketizer.ComputeNextFlit());
+      flits.push_back(std::move(flit));
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace xls::noc
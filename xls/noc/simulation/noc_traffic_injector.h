@@ -27,6 +27,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/noc/simulation/common.h"
+#include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/indexer.h"
 #include "xls/noc/simulation/network_graph.h"
 #include "xls/noc/simulation/packetizer.h"
@@ -145,6 +146,11 @@ class NocTrafficInjector {
   // each packet is injected and how big each packet is.
   std::vector<std::unique_ptr<TrafficModel>> traffic_models_;
 
+  // The flits each packet of a flow is sent as. Every packet of a flow is
+  // identical, so the packet is depacketized once when the injector is built
+  // and RunCycle() only copies these flits.
+  std::vector<std::vector<DataFlit>> flows_index_to_flits_;
+
   // Measure injected traffic rate.
   std::vector<TrafficModelMonitor> traffic_model_monitor_;
 };
@@ -186,6 +192,7 @@ class NocTrafficInjectorBuilder {
     XLS_RET_CHECK_OK(BuildPerInterfaceDepacketizer(
         network_sources, absl::MakeSpan(max_packet_size_per_source),
         network_manager, noc_parameters, traffic_injector));
+    XLS_RET_CHECK_OK(BuildPerFlowFlits(traffic_injector));
 
     return traffic_injector;
   }
@@ -247,6 +254,10 @@ class NocTrafficInjectorBuilder {
       absl::Span<int64_t> max_packet_size_per_source,
       const NetworkManager& network_manager,
       const NocParameters& noc_parameters, NocTrafficInjector& injector);
+
+  // Setup the flits sent for each packet of each flow, using the depacketizer
+  // of the flow's source.
+  absl::Status BuildPerFlowFlits(NocTrafficInjector& injector);
 };
 
 // Shim to call the NocTrafficInjector from a simulator.
@@ -15,6 +15,7 @@
 #include "xls/noc/simulation/packetizer.h"
 
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 #include "absl/log/log.h"
@@ -59,14 +60,29 @@ Packetizer::AllocateOrRetrievePartialPacketStore(int64_t source_index) {
 void Packetizer::DeallocatePartialPacketStore(int64_t source_index) {
   int64_t partial_packet_index = partial_packet_index_map_.at(source_index);
   partial_packets_.at(partial_packet_index).clear();
-  partial_packet_index_map_.erase(partial_packet_index);
+  partial_packet_index_map_.erase(source_index);
 }
 
 absl::Status Packetizer::AcceptNewFlit(DataFlit flit) {
+  if (flit.type == FlitType::kTail &&
+      !partial_packet_index_map_.contains(flit.source_index)) {
+    // A single flit packet; its data is the data of the packet.
+    XLS_ASSIGN_OR_RETURN(DataPacket received_packet,
+                         DataPacketBuilder()
+                             .Data(std::move(flit.data))
+                             .VirtualChannel(flit.vc)
+                             .SourceIndex(flit.source_index)
+                             .DestinationIndex(flit.destination_index)
+                             .Valid(true)
+                             .Build());
+    received_packets_.push_back(std::move(received_packet));
+    return absl::OkStatus();
+  }
+
   XLS_ASSIGN_OR_RETURN(std::vector<Bits> * partial_packet_store,
                        AllocateOrRetrievePartialPacketStore(flit.source_index));
 
-  partial_packet_store->push_back(flit.data);
+  partial_packet_store->push_back(std::move(flit.data));
 
   if (flit.type == FlitType::kTail) {
     // Concat all received flits together.
@@ -96,7 +112,7 @@ absl::Status Packetizer::AcceptNewFlit(DataFlit flit) {
                              .Valid(true)
                              .Build());
 
-    received_packets_.push_back(received_packet);
+    received_packets_.push_back(std::move(received_packet));
   }
 
   return absl::OkStatus();
@@ -136,7 +136,7 @@ class DePacketizer {
       return absl::InternalError("Packetize already handling a packet");
     }
 
-    packet_ = packet;
+    packet_ = std::move(packet);
     bits_left_to_send_ = packet_.data.bit_count();
 
     return absl::OkStatus();
@@ -174,21 +174,23 @@ class DePacketizer {
         "%d",
         reserved_bits, max_bits_to_send, bits_already_sent, bits_left_to_send_);
 
-    Bits data_to_send(max_bits_to_send);
-
     if (bits_left_to_send_ <= max_bits_to_send) {
       next_flit.Type(FlitType::kTail);
-      data_to_send = packet_.data.Slice(bits_already_sent, bits_left_to_send_);
+      if (bits_already_sent == 0) {
+        // Single flit packet, send the data without slicing it.
+        next_flit.Data(std::move(packet_.data));
+      } else {
+        next_flit.Data(
+            packet_.data.Slice(bits_already_sent, bits_left_to_send_));
+      }
       bits_left_to_send_ = 0;
     } else {
       next_flit.Type(bits_already_sent == 0 ? FlitType::kHead
                                             : FlitType::kBody);
-      data_to_send = packet_.data.Slice(bits_already_sent, max_bits_to_send);
+      next_flit.Data(packet_.data.Slice(bits_already_sent, max_bits_to_send));
       bits_left_to_send_ -= max_bits_to_send;
     }
 
-    next_flit.Data(data_to_send);
-
     return next_flit.BuildFlit();
   }
 
@@ -315,7 +317,9 @@ class Packetizer {
   // Maximum size of the packet.
   int64_t max_packet_bit_count_;
 
-  // Flit buffer for packets that are in the midst of being received.
+  // Flit buffer for packets that are in the midst of being received. The
+  // buffers are cleared rather than freed once a packet is received, so their
+  // storage is reused by later packets.
   std::vector<std::vector<Bits>> partial_packets_;
 
   // The packetizer uses partial_packet_index_ to index into partial_packets_.
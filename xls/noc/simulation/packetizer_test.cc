@@ -14,6 +14,7 @@
 
 #include "xls/noc/simulation/packetizer.h"
 
+#include <cstdint>
 #include <string>
 
 #include "gtest/gtest.h"
@@ -158,5 +159,49 @@ TEST(PacketizerTest, SendMultiplePhit) {
   EXPECT_EQ(recv_packet.data, packet.data);
 }
 
+TEST(PacketizerTest, InterleavedSources) {
+  auto flit = [](FlitType type, int16_t source_index, uint64_t data) {
+    return DataFlitBuilder()
+        .Type(type)
+        .SourceIndex(source_index)
+        .DestinationIndex(0)
+        .VirtualChannel(0)
+        .Data(UBits(data, 8))
+        .BuildFlit();
+  };
+
+  // Packets from sources 3, 5 and 7 are interleaved so that the buffer used
+  // for the first packet of source 3 is reused by source 7 while source 3
+  // sends its second packet.
+  Packetizer packetizer(16, 3, 128, 2);
+  XLS_ASSERT_OK_AND_ASSIGN(DataFlit a0, flit(FlitType::kHead, 3, 0xa0));
+  XLS_ASSERT_OK_AND_ASSIGN(DataFlit b0, flit(FlitType::kHead, 5, 0xb0));
+  XLS_ASSERT_OK_AND_ASSIGN(DataFlit a1, flit(FlitType::kTail, 3, 0xa1));
+  XLS_ASSERT_OK_AND_ASSIGN(DataFlit c0, flit(FlitType::kHead, 7, 0xc0));
+  XLS_ASSERT_OK_AND_ASSIGN(DataFlit b1, flit(FlitType::kTail, 5, 0xb1));
+  XLS_ASSERT_OK_AND_ASSIGN(DataFlit d0, flit(FlitType::kHead, 3, 0xd0));
+  XLS_ASSERT_OK_AND_ASSIGN(DataFlit c1, flit(FlitType::kTail, 7, 0xc1));
+  XLS_ASSERT_OK_AND_ASSIGN(DataFlit d1, flit(FlitType::kTail, 3, 0xd1));
+  XLS_ASSERT_OK_AND_ASSIGN(DataFlit e0, flit(FlitType::kTail, 5, 0xe0));
+  for (const DataFlit& f : {a0, b0, a1, c0, b1, d0, c1, d1, e0}) {
+    XLS_ASSERT_OK(packetizer.AcceptNewFlit(f));
+  }
+  EXPECT_EQ(packetizer.PartialPacketCount(), 0);
+
+  absl::Span<const DataPacket> packets = packetizer.GetPackets();
+  ASSERT_EQ(packets.size(), 5);
+  EXPECT_EQ(packets[0].source_index, 3);
+  EXPECT_EQ(packets[0].data, UBits(0xa1a0, 16));
+  EXPECT_EQ(packets[1].source_index, 5);
+  EXPECT_EQ(packets[1].data, UBits(0xb1b0, 16));
+  EXPECT_EQ(packets[2].source_index, 7);
+  EXPECT_EQ(packets[2].data, UBits(0xc1c0, 16));
+  EXPECT_EQ(packets[3].source_index, 3);
+  EXPECT_EQ(packets[3].data, UBits(0xd1d0, 16));
+  // A single flit packet.
+  EXPECT_EQ(packets[4].source_index, 5);
+  EXPECT_EQ(packets[4].data, UBits(0xe0, 8));
+}
+
 }  // namespace
 }  // namespace xls::noc
@@ -16,7 +16,9 @@
 #define XLS_NOC_SIMULATION_PARAMETERS_H_
 
 #include <cstdint>
+#include <optional>
 #include <string_view>
+#include <tuple>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -40,10 +42,8 @@ namespace noc {
 //     and abstractions to the proto description of a network.  These objects
 //     useful when specific concepts in the proto description are implicitly
 //     defined.
-//  2. NocParameters which associates NetworkGraph objects to Param objects.
-//
-// TODO(tedhong): 2020-12-23 - Add a third abstraction that maps proto names
-//                             to network graph ids.
+//  2. NocParameters which associates NetworkGraph objects to Param objects,
+//     and maps proto names to NetworkGraph ids.
 
 
 // Interface to protos describing a virtual channel
@@ -276,72 +276,164 @@ using NetworkComponentParam =
                  RouterParam, LinkParam>;
 
 // Associates Param objects with NetworkGraph objects.
+//
+// Params are stored in vectors indexed by the local ids of the objects they
+// are associated with, mirroring the storage of the NetworkManager, so that
+// lookups on large networks are a few array accesses.
+//
+// The names of components and ports (as specified in the proto) are also
+// indexed so that objects can be found by name in constant time.  The index
+// refers to the names held by the protos, which must outlive this object
+// (as is already required by the Param objects).
 class NocParameters {
  public:
   // Associates a Network's Id and Param.
   void SetNetworkParam(NetworkId id, NetworkParam p) {
-    networks_.emplace(std::make_pair(id, p));
+    CHECK(id.IsValid());
+    if (id.id() >= networks_.size()) {
+      networks_.resize(id.id() + 1);
+    }
+    if (!networks_[id.id()].has_value()) {
+      networks_[id.id()].emplace(p);
+    }
   }
 
   // Retrieves associated NetworkParam.
   absl::StatusOr<NetworkParam> GetNetworkParam(NetworkId id) const {
-    auto i = networks_.find(id);
-
-    if (i == networks_.end()) {
+    if (id.id() >= networks_.size() || !networks_[id.id()].has_value()) {
       return absl::InternalError(
           absl::StrFormat("NetworkId %d is missing associated "
                           "Param mapping",
                           id.AsUInt64()));
-    } else {
-      return i->second;
     }
+    return *networks_[id.id()];
   }
 
   // Associates a NetworkComponent's Id and Param.
   void SetNetworkComponentParam(NetworkComponentId id,
                                 NetworkComponentParam p) {
-    components_.emplace(std::make_pair(id, p));
+    CHECK(id.IsValid());
+    std::optional<NetworkComponentParam>& slot =
+        GetOrCreateSlot(components_, id.network(), id.id());
+    if (slot.has_value()) {
+      return;
+    }
+    std::string_view name =
+        std::visit([](const auto& param) { return param.GetName(); }, p);
+    slot.emplace(p);
+    IndexName(component_names_, name, id);
   }
 
   // Retrieves associated NetworkComponentParam.
   absl::StatusOr<NetworkComponentParam> GetNetworkComponentParam(
       NetworkComponentId id) const {
-    auto i = components_.find(id);
-
-    if (i == components_.end()) {
+    if (id.network() >= components_.size() ||
+        id.id() >= components_[id.network()].size() ||
+        !components_[id.network()][id.id()].has_value()) {
       return absl::InternalError(
           absl::StrFormat("NetworkComponentId %d is missing associated "
                           "Param mapping",
                           id.AsUInt64()));
-    } else {
-      return i->second;
     }
+    return *components_[id.network()][id.id()];
   }
 
   // Associated a Port's Id and Param.
   void SetPortParam(PortId id, PortParam p) {
-    ports_.emplace(std::make_pair(id, p));
+    CHECK(id.IsValid());
+    std::optional<PortParam>& slot = GetOrCreateSlot(
+        GetOrCreateSlot(ports_, id.network(), id.component()), id.id());
+    if (slot.has_value()) {
+      return;
+    }
+    slot.emplace(p);
+    IndexName(port_names_, p.GetName(), id);
   }
 
   // Retrieves associated PortParam.
   absl::StatusOr<PortParam> GetPortParam(PortId id) const {
-    auto i = ports_.find(id);
-
-    if (i == ports_.end()) {
+    if (id.network() >= ports_.size() ||
+        id.component() >= ports_[id.network()].size() ||
+        id.id() >= ports_[id.network()][id.component()].size() ||
+        !ports_[id.network()][id.component()][id.id()].has_value()) {
       return absl::InternalError(
           absl::StrFormat("PortId %d is missing associated "
                           "Param mapping",
                           id.AsUInt64()));
-    } else {
-      return i->second;
     }
+    return *ports_[id.network()][id.component()][id.id()];
+  }
+
+  // Retrieves the id of the network component with the given name.
+  // If several components share a name, the one with the lowest id is
+  // returned.
+  absl::StatusOr<NetworkComponentId> GetNetworkComponentIdByName(
+      std::string_view name) const {
+    auto i = component_names_.find(name);
+    if (i == component_names_.end()) {
+      return absl::NotFoundError(absl::StrFormat(
+          "Unable to find network component with param name %s", name));
+    }
+    return i->second;
+  }
+
+  // Retrieves the id of the port with the given name.
+  // If several ports share a name (i.e. the ports of a link share the
+  // names of the ports the link is connected to), the one with the lowest id
+  // is returned.
+  absl::StatusOr<PortId> GetPortIdByName(std::string_view name) const {
+    auto i = port_names_.find(name);
+    if (i == port_names_.end()) {
+      return absl::NotFoundError(
+          absl::StrFormat("Unable to find port with param name %s", name));
+    }
+    return i->second;
   }
 
  protected:
-  // TODO(tedhong): 2020-12-14, use vectors based off of local ids vs maps.
-  absl::flat_hash_map<NetworkId, NetworkParam> networks_;
-  absl::flat_hash_map<PortId, PortParam> ports_;
-  absl::flat_hash_map<NetworkComponentId, NetworkComponentParam> components_;
+  // Returns the index-th element of v, growing v if needed.
+  template <typename T>
+  static T& GetOrCreateSlot(std::vector<T>& v, int64_t index) {
+    if (index >= v.size()) {
+      v.resize(index + 1);
+    }
+    return v[index];
+  }
+
+  // Returns the (outer, inner)-th element of v, growing v if needed.
+  template <typename T>
+  static T& GetOrCreateSlot(std::vector<std::vector<T>>& v, int64_t outer,
+                            int64_t inner) {
+    return GetOrCreateSlot(GetOrCreateSlot(v, outer), inner);
+  }
+
+  // Adds name to the index unless it is already associated with a lower id.
+  template <typename IdT>
+  static void IndexName(absl::flat_hash_map<std::string_view, IdT>& names,
+                        std::string_view name, IdT id) {
+    auto [i, inserted] = names.try_emplace(name, id);
+    if (!inserted && IdOrder(id) < IdOrder(i->second)) {
+      i->second = id;
+    }
+  }
+
+  static std::tuple<uint16_t, uint32_t> IdOrder(NetworkComponentId id) {
+    return {id.network(), id.id()};
+  }
+
+  static std::tuple<uint16_t, uint32_t, uint16_t> IdOrder(PortId id) {
+    return {id.network(), id.component(), id.id()};
+  }
+
+  // Indexed by network id.
+  std::vector<std::optional<NetworkParam>> networks_;
+  // Indexed by network id, then component id.
+  std::vector<std::vector<std::optional<NetworkComponentParam>>> components_;
+  // Indexed by network id, component id, then port id.
+  std::vector<std::vector<std::vector<std::optional<PortParam>>>> ports_;
+
+  absl::flat_hash_map<std::string_view, NetworkComponentId> component_names_;
+  absl::flat_hash_map<std::string_view, PortId> port_names_;
 };
 
 }  // namespace noc
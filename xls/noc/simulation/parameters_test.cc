@@ -208,6 +208,45 @@ TEST(SimParametersTest, NocParametersMap) {
   param_map.SetPortParam(port_id_0, port_param_0);
   EXPECT_EQ(param_map.GetPortParam(port_id_0)->GetName(), "in0");
   EXPECT_EQ(param_map.GetPortParam(port_id_1)->GetName(), "out0");
+
+  // Ids without an associated param.
+  EXPECT_FALSE(param_map.GetNetworkParam(NetworkId(1)).ok());
+  EXPECT_FALSE(
+      param_map.GetNetworkComponentParam(NetworkComponentId(0, 4)).ok());
+  EXPECT_FALSE(param_map.GetPortParam(PortId(0, 1, 0)).ok());
+  EXPECT_FALSE(param_map.GetPortParam(PortId::kInvalid).ok());
+}
+
+TEST(SimParametersTest, NocParametersNameIndex) {
+  NetworkConfigProtoBuilder builder("Test");
+  builder.WithLink("Link0");
+  auto router = builder.WithRouter("Router0");
+  router.WithInputPort("in0");
+  XLS_ASSERT_OK_AND_ASSIGN(NetworkConfigProto nc_proto, builder.Build());
+
+  const RouterConfigProto& router_proto = nc_proto.routers(0);
+  const PortConfigProto& port_proto = router_proto.ports(0);
+
+  NetworkComponentId router_id(0, 0);
+  NetworkComponentId link_id(0, 1);
+  PortId router_port_id(0, 0, 0);
+  PortId link_port_id(0, 1, 0);
+
+  NocParameters param_map;
+  param_map.SetNetworkComponentParam(link_id,
+                                     LinkParam(nc_proto, nc_proto.links(0)));
+  param_map.SetNetworkComponentParam(router_id,
+                                     RouterParam(nc_proto, router_proto));
+  // The ports of a link share the proto of the port they are connected to,
+  // lookups by name resolve to the lowest id.
+  param_map.SetPortParam(link_port_id, PortParam(nc_proto, port_proto));
+  param_map.SetPortParam(router_port_id, PortParam(nc_proto, port_proto));
+
+  EXPECT_EQ(*param_map.GetNetworkComponentIdByName("Router0"), router_id);
+  EXPECT_EQ(*param_map.GetNetworkComponentIdByName("Link0"), link_id);
+  EXPECT_EQ(*param_map.GetPortIdByName("in0"), router_port_id);
+  EXPECT_FALSE(param_map.GetNetworkComponentIdByName("Router1").ok());
+  EXPECT_FALSE(param_map.GetPortIdByName("out0").ok());
 }
 
 }  // namespace
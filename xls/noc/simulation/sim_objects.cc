@@ -14,20 +14,28 @@
 
 #include "xls/noc/simulation/sim_objects.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <deque>
+#include <memory>
 #include <queue>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/data_structures/union_find.h"
 #include "xls/ir/bits.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
@@ -132,6 +140,39 @@ bool SimplePipelineImpl<DataTimePhitT>::TryPropagation(
 
 }  // namespace
 
+void DataFlitQueue::Reserve(NocSimulator& simulator) {
+  store_start = simulator.GetNewDataFlitStore(max_queue_size);
+  head = 0;
+  size = 0;
+}
+
+DataFlitQueueElement& DataFlitQueue::Front(NocSimulator& simulator) {
+  DCHECK_GT(size, 0);
+  return simulator.GetDataFlitStore(store_start, max_queue_size)[head];
+}
+
+void DataFlitQueue::Push(NocSimulator& simulator,
+                         DataFlitQueueElement element) {
+  CHECK_LT(size, max_queue_size) << "Flit queue overflow, flow control should "
+                                    "prevent more phits than credits.";
+  int64_t tail = head + size;
+  if (tail >= max_queue_size) {
+    tail -= max_queue_size;
+  }
+  simulator.GetDataFlitStore(store_start, max_queue_size)[tail] =
+      std::move(element);
+  ++size;
+}
+
+void DataFlitQueue::Pop() {
+  DCHECK_GT(size, 0);
+  ++head;
+  if (head == max_queue_size) {
+    head = 0;
+  }
+  --size;
+}
+
 absl::Status NocSimulator::CreateSimulationObjects(NetworkId network) {
   Network& network_obj = mgr_->GetNetwork(network);
 
@@ -147,9 +188,200 @@ absl::Status NocSimulator::CreateSimulationObjects(NetworkId network) {
     XLS_RETURN_IF_ERROR(CreateNetworkComponent(id));
   }
 
+  BuildComponentNeighbors();
+
+  return SetThreadCount(thread_count_);
+}
+
+void NocSimulator::BuildComponentNeighbors() {
+  components_.clear();
+  for (SimNetworkInterfaceSrc& nc : network_interface_sources_) {
+    components_.push_back(&nc);
+  }
+  for (SimLink& nc : links_) {
+    components_.push_back(&nc);
+  }
+  for (SimInputBufferedVCRouter& nc : routers_) {
+    components_.push_back(&nc);
+  }
+  for (SimNetworkInterfaceSink& nc : network_interface_sinks_) {
+    components_.push_back(&nc);
+  }
+
+  absl::flat_hash_map<NetworkComponentId, int64_t> component_index;
+  for (int64_t i = 0; i < components_.size(); ++i) {
+    component_index[components_[i]->GetId()] = i;
+  }
+
+  component_neighbors_.assign(components_.size(), {});
+  for (int64_t i = 0; i < components_.size(); ++i) {
+    absl::flat_hash_set<int64_t> neighbors;
+    for (PortId port_id :
+         mgr_->GetNetworkComponent(components_[i]->GetId()).GetPortIds()) {
+      ConnectionId connection_id = mgr_->GetPort(port_id).connection();
+      if (!connection_id.IsValid()) {
+        continue;
+      }
+      const Connection& connection = mgr_->GetConnection(connection_id);
+      for (PortId endpoint : {connection.src(), connection.sink()}) {
+        if (!endpoint.IsValid()) {
+          continue;
+        }
+        auto it = component_index.find(endpoint.GetNetworkComponentId());
+        if (it != component_index.end() && it->second != i) {
+          neighbors.insert(it->second);
+        }
+      }
+    }
+    component_neighbors_[i].assign(neighbors.begin(), neighbors.end());
+    absl::c_sort(component_neighbors_[i]);
+  }
+}
+
+NocSimulator::~NocSimulator() { StopWorkers(); }
+
+absl::Status NocSimulator::SetThreadCount(int64_t thread_count) {
+  XLS_RET_CHECK_GE(thread_count, 1);
+  StopWorkers();
+  thread_count_ = thread_count;
+  if (mgr_ == nullptr) {
+    // Partitioned once the simulation objects are created by Initialize.
+    return absl::OkStatus();
+  }
+  PartitionComponents();
+  StartWorkers();
   return absl::OkStatus();
 }
 
+void NocSimulator::PartitionComponents() {
+  // Links with pipeline stages in both directions drive their outputs from
+  // flits received in earlier cycles, so they can be simulated in two halves
+  // at cycle boundaries, decoupling the components on either side.
+  std::vector<bool> is_boundary(components_.size(), false);
+  boundary_links_.clear();
+  if (thread_count_ > 1) {
+    int64_t link_offset = network_interface_sources_.size();
+    for (int64_t i = 0; i < links_.size(); ++i) {
+      if (links_[i].GetForwardPipelineStageCount() > 0 &&
+          links_[i].GetReversePipelineStageCount() > 0) {
+        is_boundary[link_offset + i] = true;
+        boundary_links_.push_back(link_offset + i);
+      }
+    }
+  }
+
+  // Components connected other than through a boundary link form a region
+  // which has to be simulated by a single thread.
+  UnionFind<int64_t> union_find;
+  for (int64_t i = 0; i < components_.size(); ++i) {
+    if (!is_boundary[i]) {
+      union_find.Insert(i);
+    }
+  }
+  for (int64_t i = 0; i < components_.size(); ++i) {
+    if (is_boundary[i]) {
+      continue;
+    }
+    for (int64_t neighbor : component_neighbors_[i]) {
+      if (!is_boundary[neighbor]) {
+        union_find.Union(i, neighbor);
+      }
+    }
+  }
+  std::vector<std::vector<int64_t>> regions;
+  absl::flat_hash_map<int64_t, int64_t> region_index;
+  for (int64_t i = 0; i < components_.size(); ++i) {
+    if (is_boundary[i]) {
+      continue;
+    }
+    auto [it, inserted] =
+        region_index.insert({union_find.Find(i), regions.size()});
+    if (inserted) {
+      regions.emplace_back();
+    }
+    regions[it->second].push_back(i);
+  }
+
+  // Assign the largest remaining region to the partition with the fewest
+  // components.
+  absl::c_stable_sort(regions, [](const std::vector<int64_t>& a,
+                                  const std::vector<int64_t>& b) {
+    return a.size() > b.size();
+  });
+  partitions_.assign(
+      std::max<int64_t>(std::min<int64_t>(thread_count_, regions.size()), 1),
+      {});
+  for (std::vector<int64_t>& region : regions) {
+    std::vector<int64_t>& partition = *absl::c_min_element(
+        partitions_,
+        [](const std::vector<int64_t>& a, const std::vector<int64_t>& b) {
+          return a.size() < b.size();
+        });
+    partition.insert(partition.end(), region.begin(), region.end());
+  }
+
+  component_partition_.assign(components_.size(), -1);
+  for (int64_t p = 0; p < partitions_.size(); ++p) {
+    absl::c_sort(partitions_[p]);
+    for (int64_t i : partitions_[p]) {
+      component_partition_[i] = p;
+    }
+  }
+  VLOG(1) << absl::StreamFormat(
+      "Partitioned %d components into %d partitions with %d boundary links",
+      components_.size(), partitions_.size(), boundary_links_.size());
+}
+
+void NocSimulator::StartWorkers() {
+  {
+    absl::MutexLock lock(&worker_mutex_);
+    workers_shutdown_ = false;
+    partition_ticks_.assign(partitions_.size(), 0);
+  }
+  for (int64_t p = 1; p < partitions_.size(); ++p) {
+    workers_.push_back(std::make_unique<Thread>([this, p] { WorkerLoop(p); }));
+  }
+}
+
+void NocSimulator::StopWorkers() {
+  {
+    absl::MutexLock lock(&worker_mutex_);
+    workers_shutdown_ = true;
+  }
+  for (std::unique_ptr<Thread>& worker : workers_) {
+    worker->Join();
+  }
+  workers_.clear();
+}
+
+void NocSimulator::WorkerLoop(int64_t partition) {
+  int64_t seen_generation = 0;
+  {
+    absl::MutexLock lock(&worker_mutex_);
+    seen_generation = worker_generation_;
+  }
+  while (true) {
+    int64_t max_ticks;
+    {
+      absl::MutexLock lock(&worker_mutex_);
+      auto cycle_started_or_shutdown =
+          [&]() ABSL_SHARED_LOCKS_REQUIRED(worker_mutex_) {
+            return workers_shutdown_ || worker_generation_ != seen_generation;
+          };
+      worker_mutex_.Await(absl::Condition(&cycle_started_or_shutdown));
+      if (workers_shutdown_) {
+        return;
+      }
+      seen_generation = worker_generation_;
+      max_ticks = worker_max_ticks_;
+    }
+    absl::StatusOr<int64_t> ticks = RunPartition(partition, max_ticks);
+    absl::MutexLock lock(&worker_mutex_);
+    partition_ticks_[partition] = std::move(ticks);
+    --workers_running_;
+  }
+}
+
 absl::Status NocSimulator::CreateConnection(ConnectionId connection) {
   // Find number of vc's.
   Connection& connection_obj = mgr_->GetConnection(connection);
@@ -267,16 +499,21 @@ absl::Status NocSimulator::RunCycle(int64_t max_ticks) {
     XLS_RET_CHECK_OK(svc->RunCycle());
   }
 
-  bool converged = false;
-  int64_t nticks = 0;
-  while (!converged) {
-    VLOG(2) << absl::StreamFormat("Tick %d", nticks);
-    converged = Tick();
-    ++nticks;
-    if (nticks >= max_ticks) {
-      return absl::InternalError(absl::StrFormat(
-          "Simulator unable to converge after %d ticks for cycle %d", nticks,
-          cycle_));
+  if (scheduling_ == Scheduling::kEventDriven) {
+    XLS_RETURN_IF_ERROR(RunEventDrivenCycle(max_ticks));
+  } else {
+    bool converged = false;
+    int64_t nticks = 0;
+    while (!converged) {
+      VLOG(2) << absl::StreamFormat("Tick %d", nticks);
+      converged = Tick();
+      component_tick_count_ += components_.size();
+      ++nticks;
+      if (nticks >= max_ticks) {
+        return absl::InternalError(absl::StrFormat(
+            "Simulator unable to converge after %d ticks for cycle %d", nticks,
+            cycle_));
+      }
     }
   }
 
@@ -300,6 +537,114 @@ absl::Status NocSimulator::RunCycle(int64_t max_ticks) {
   return absl::OkStatus();
 }
 
+absl::Status NocSimulator::RunEventDrivenCycle(int64_t max_ticks) {
+  // Drive the outputs of the boundary links from the flits they received in
+  // earlier cycles. Their inputs are not ready yet, so they cannot converge.
+  for (int64_t i : boundary_links_) {
+    XLS_RET_CHECK(!components_[i]->Tick(*this));
+  }
+  int64_t nticks = boundary_links_.size();
+
+  if (workers_.empty()) {
+    XLS_ASSIGN_OR_RETURN(int64_t partition_ticks, RunPartition(0, max_ticks));
+    nticks += partition_ticks;
+  } else {
+    {
+      absl::MutexLock lock(&worker_mutex_);
+      worker_max_ticks_ = max_ticks;
+      workers_running_ = workers_.size();
+      ++worker_generation_;
+    }
+    absl::StatusOr<int64_t> partition_ticks = RunPartition(0, max_ticks);
+    absl::MutexLock lock(&worker_mutex_);
+    auto cycle_done = [&]() ABSL_SHARED_LOCKS_REQUIRED(worker_mutex_) {
+      return workers_running_ == 0;
+    };
+    worker_mutex_.Await(absl::Condition(&cycle_done));
+    partition_ticks_[0] = std::move(partition_ticks);
+    for (const absl::StatusOr<int64_t>& ticks : partition_ticks_) {
+      XLS_RETURN_IF_ERROR(ticks.status());
+      nticks += *ticks;
+    }
+  }
+
+  // The boundary links now receive the flits sent to them during this cycle.
+  for (int64_t i : boundary_links_) {
+    if (!components_[i]->Tick(*this)) {
+      return absl::InternalError(absl::StrFormat(
+          "Simulator unable to converge boundary link %x for cycle %d",
+          components_[i]->GetId().AsUInt64(), cycle_));
+    }
+  }
+  nticks += boundary_links_.size();
+  component_tick_count_ += nticks;
+
+  return absl::OkStatus();
+}
+
+absl::StatusOr<int64_t> NocSimulator::RunPartition(int64_t partition,
+                                                   int64_t max_ticks) {
+  // Every component is ticked at least once per cycle. Afterwards a component
+  // is only ticked again once it or a component it shares a connection with
+  // has made progress, as that is the only way its inputs can have changed.
+  absl::Span<const int64_t> members = partitions_[partition];
+  std::deque<int64_t> worklist(members.begin(), members.end());
+  std::vector<bool> queued(components_.size(), false);
+  for (int64_t i : members) {
+    queued[i] = true;
+  }
+  auto enqueue = [&](int64_t i) {
+    if (component_partition_[i] == partition && !queued[i] &&
+        !components_[i]->HasConverged(cycle_)) {
+      queued[i] = true;
+      worklist.push_back(i);
+    }
+  };
+
+  int64_t max_total_ticks = max_ticks * std::max<int64_t>(members.size(), 1);
+  int64_t nticks = 0;
+  int64_t converged_count = 0;
+  while (!worklist.empty()) {
+    int64_t i = worklist.front();
+    worklist.pop_front();
+    queued[i] = false;
+
+    SimNetworkComponentBase* nc = components_[i];
+    bool forward_propagated = nc->HasForwardPropagated(cycle_);
+    bool reverse_propagated = nc->HasReversePropagated(cycle_);
+    bool converged = nc->Tick(*this);
+    ++nticks;
+    VLOG(2) << absl::StreamFormat(" NC %x Converged %d", nc->GetId().AsUInt64(),
+                                  converged);
+    if (nticks >= max_total_ticks) {
+      return absl::InternalError(absl::StrFormat(
+          "Simulator unable to converge after %d component ticks for cycle %d",
+          nticks, cycle_));
+    }
+
+    if (converged) {
+      ++converged_count;
+    }
+    if (forward_propagated != nc->HasForwardPropagated(cycle_) ||
+        reverse_propagated != nc->HasReversePropagated(cycle_)) {
+      // Progress may unblock the rest of this component as well as its
+      // neighbors.
+      enqueue(i);
+      for (int64_t neighbor : component_neighbors_[i]) {
+        enqueue(neighbor);
+      }
+    }
+  }
+
+  if (converged_count != members.size()) {
+    return absl::InternalError(absl::StrFormat(
+        "Simulator unable to converge for cycle %d: %d of %d components "
+        "converged",
+        cycle_, converged_count, members.size()));
+  }
+  return nticks;
+}
+
 bool NocSimulator::Tick() {
   // Goes through each simulator object and run atick.
   // Converges when everyone returns True -- that determines new cycle
@@ -485,6 +830,8 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
   NetworkComponent& nc = network_manager->GetNetworkComponent(id_);
   const PortIndexMap& port_indexer =
       simulator.GetRoutingTable()->GetPortIndices();
+  compiled_routing_table_ =
+      simulator.GetRoutingTable()->GetCompiledRouterRoutingTable(id_);
 
   // Setup structures associated with the inputs.
   //  - input to SimConnectionState (input_connection_index_start_ and count_)
@@ -513,6 +860,7 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
     input_buffers_[i].resize(port_param.VirtualChannelCount());
     for (int64_t vc = 0; vc < port_param.VirtualChannelCount(); ++vc) {
       input_buffers_[i][vc].max_queue_size = vc_params[vc].GetDepth();
+      input_buffers_[i][vc].Reserve(simulator);
     }
     input_credit_to_send_[i].resize(port_param.VirtualChannelCount());
     if (max_vc_ < port_param.VirtualChannelCount()) {
@@ -708,6 +1056,20 @@ absl::StatusOr<SimInputBufferedVCRouter::PortIndexAndVCIndex>
 SimInputBufferedVCRouter::GetDestinationPortIndexAndVcIndex(
     NocSimulator& simulator, PortIndexAndVCIndex input,
     int64_t destination_index) {
+  if (compiled_routing_table_ != nullptr) {
+    const ::xls::noc::PortIndexAndVCIndex& route =
+        compiled_routing_table_->GetRoute(input.port_index, input.vc_index,
+                                          destination_index);
+    if (route.port_index_ < 0) {
+      return absl::NotFoundError(absl::StrFormat(
+          "Router %x has no route from port index %d vc %d to destination "
+          "index %d",
+          GetId().AsUInt64(), input.port_index, input.vc_index,
+          destination_index));
+    }
+    return PortIndexAndVCIndex{route.port_index_, route.vc_index_};
+  }
+
   DistributedRoutingTable* routes = simulator.GetRoutingTable();
 
   XLS_ASSIGN_OR_RETURN(PortId input_port,
@@ -793,7 +1155,8 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
 
     if (input.forward_channels.flit.type != FlitType::kInvalid) {
       int64_t vc = input.forward_channels.flit.vc;
-      input_buffers_[i][vc].queue.push(
+      input_buffers_[i][vc].Push(
+          simulator,
           {input.forward_channels.flit, input.forward_channels.metadata});
 
       VLOG(2) << absl::StrFormat(
@@ -812,12 +1175,12 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
       }
 
       // See if we have a flit to route and can route it.
-      if (input_buffers_[i][vc].queue.empty()) {
+      if (input_buffers_[i][vc].Empty()) {
         continue;
       }
 
-      DataFlit flit = input_buffers_[i][vc].queue.front().flit;
-      TimedDataFlitInfo metadata = input_buffers_[i][vc].queue.front().metadata;
+      DataFlitQueueElement& front = input_buffers_[i][vc].Front(simulator);
+      const DataFlit& flit = front.flit;
       int64_t destination_index = flit.destination_index;
 
       PortIndexAndVCIndex input{i, vc};
@@ -849,7 +1212,7 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
       output_state.forward_channels.flit = flit;
       output_state.forward_channels.flit.vc = output.vc_index;
       output_state.forward_channels.cycle = current_cycle;
-      output_state.forward_channels.metadata = metadata;
+      output_state.forward_channels.metadata = std::move(front.metadata);
       output_state.forward_channels.metadata.timed_route_info.route.push_back(
           TimedRouteItem{id_, current_cycle});
 
@@ -858,7 +1221,7 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
 
       // Update credit to send back to input.
       ++input_credit_to_send_[i][vc];
-      input_buffers_[i][vc].queue.pop();
+      input_buffers_[i][vc].Pop();
 
       flit_sent = true;
 
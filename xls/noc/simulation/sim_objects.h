@@ -16,13 +16,17 @@
 #define XLS_NOC_SIMULATION_SIM_OBJECTS_H_
 
 #include <cstdint>
+#include <memory>
 #include <queue>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "xls/common/thread.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/global_routing_table.h"
@@ -51,21 +55,42 @@ struct CreditState {
   int64_t credit;
 };
 
+class NocSimulator;
+
 struct DataFlitQueueElement {
   DataFlit flit;
   TimedDataFlitInfo metadata;
 };
 
 // Represents a fifo/buffer used to store phits.
+//
+// Phits are kept in a fixed-capacity ring buffer of max_queue_size elements
+// reserved from the simulator's flit store with
+// NocSimulator::GetNewDataFlitStore. Credit-based flow control guarantees
+// that no more than max_queue_size phits are ever buffered.
 struct DataFlitQueue {
-  std::queue<DataFlitQueueElement> queue;
+  // Reserves the ring buffer, must be called once max_queue_size is set.
+  void Reserve(NocSimulator& simulator);
+
+  bool Empty() const { return size == 0; }
+
+  // Returns the oldest phit in the queue.
+  DataFlitQueueElement& Front(NocSimulator& simulator);
+
+  void Push(NocSimulator& simulator, DataFlitQueueElement element);
+  void Pop();
+
   int64_t max_queue_size;
+
+  // Index of the ring buffer within the simulator's flit store.
+  int64_t store_start = -1;
+  // Offset of the oldest phit within the ring buffer.
+  int64_t head = 0;
+  int64_t size = 0;
 };
 
 // Represents a fifo/buffer used to store metadata phits.
 
-class NocSimulator;
-
 // Common functionality and base class for all simulator objects.
 class SimNetworkComponentBase {
  public:
@@ -83,6 +108,22 @@ class SimNetworkComponentBase {
   // Returns the associated NetworkComponentId.
   NetworkComponentId GetId() const { return id_; }
 
+  // Returns true if forward propagation has completed for the given cycle.
+  bool HasForwardPropagated(int64_t cycle) const {
+    return forward_propagated_cycle_ == cycle;
+  }
+
+  // Returns true if reverse propagation has completed for the given cycle.
+  bool HasReversePropagated(int64_t cycle) const {
+    return reverse_propagated_cycle_ == cycle;
+  }
+
+  // Returns true if both forward and reverse propagation have completed for
+  // the given cycle.
+  bool HasConverged(int64_t cycle) const {
+    return HasForwardPropagated(cycle) && HasReversePropagated(cycle);
+  }
+
   virtual ~SimNetworkComponentBase() = default;
 
  protected:
@@ -154,6 +195,16 @@ class SimLink : public SimNetworkComponentBase {
 
   // Get the sink connection index that in used in the simulator.
 
+  // Returns the number of pipeline stages from source to sink.
+  int64_t GetForwardPipelineStageCount() const {
+    return forward_pipeline_stages_;
+  }
+
+  // Returns the number of pipeline stages from sink to source.
+  int64_t GetReversePipelineStageCount() const {
+    return reverse_pipeline_stages_;
+  }
+
  private:
   SimLink() = default;
 
@@ -325,6 +376,10 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
       NocSimulator& simulator, PortIndexAndVCIndex input,
       int64_t destination_index);
 
+  // Routing table of this router if the routing tables have been compiled
+  // (see DistributedRoutingTable::CompileRouterRoutingTables).
+  const CompiledRouterRoutingTable* compiled_routing_table_;
+
   // Index for the input connections associated with this router.
   // Each input port is associated with a single connection.
   int64_t input_connection_index_start_;
@@ -365,8 +420,22 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
 // state and objects.
 class NocSimulator {
  public:
+  // How RunCycle schedules the evaluation of network components within a
+  // cycle.
+  enum class Scheduling : uint8_t {
+    // Every component is ticked on each sweep until all components have
+    // converged. Kept as a reference for kEventDriven.
+    kSweep,
+    // A component is only ticked again once a component sharing one of its
+    // connections (or the component itself) has made progress. At low
+    // injection rates most components converge on their first tick so this
+    // avoids most of the work of kSweep.
+    kEventDriven,
+  };
+
   NocSimulator()
       : mgr_(nullptr), params_(nullptr), routing_(nullptr), cycle_(-1) {}
+  ~NocSimulator();
 
   // Creates all simulation objects for a given network.
   // NetworkManager, NocParameters, and DistributedRoutingTable should
@@ -420,6 +489,22 @@ class NocSimulator {
     return next_start;
   }
 
+  // Allocates and returns an index that can then be used
+  // with GetDataFlitStore to retrieve an array of size.
+  int64_t GetNewDataFlitStore(int64_t size) {
+    int64_t next_start = data_flit_store_.size();
+    data_flit_store_.resize(next_start + size);
+    return next_start;
+  }
+
+  // Returns a reference to the store previously reserved with
+  // GetNewDataFlitStore.
+  absl::Span<DataFlitQueueElement> GetDataFlitStore(int64_t start,
+                                                    int64_t size) {
+    return absl::Span<DataFlitQueueElement>(data_flit_store_.data() + start,
+                                            size);
+  }
+
   // Allocates and returns an index that can be used with
   // GetPortIdStore to retreive an array of size)
 
@@ -433,11 +518,38 @@ class NocSimulator {
   void Dump();
 
   // Run a single cycle of the simulator.
+  //
+  // With kSweep scheduling, at most `max_ticks` sweeps are performed. With
+  // kEventDriven scheduling, at most `max_ticks` ticks per component are
+  // performed.
   absl::Status RunCycle(int64_t max_ticks = 9999);
 
   // Runs a single tick of the simulator.
   bool Tick();
 
+  void SetScheduling(Scheduling scheduling) { scheduling_ = scheduling; }
+  Scheduling GetScheduling() const { return scheduling_; }
+
+  // Returns the number of times a network component has been ticked by
+  // RunCycle since the simulator was initialized.
+  int64_t GetComponentTickCount() const { return component_tick_count_; }
+
+  // Sets the number of threads used by RunCycle with kEventDriven scheduling.
+  // kSweep scheduling always runs on the calling thread.
+  //
+  // With more than one thread the network is split into regions at links
+  // with at least one pipeline stage in each direction. The outputs of such a
+  // link only depend on flits it received in earlier cycles, so the regions
+  // are simulated concurrently and only exchange flits over those links at
+  // cycle boundaries. Simulation results do not depend on the thread count.
+  //
+  // May be called before or after Initialize.
+  absl::Status SetThreadCount(int64_t thread_count);
+  int64_t GetThreadCount() const { return thread_count_; }
+
+  // Returns the number of regions the network has been partitioned into.
+  int64_t GetPartitionCount() const { return partitions_.size(); }
+
   // Register a service to run once at the beginning of each cycle.
   // TODO(tedhong): 2021-07-27 Add a scheme to provide a total order
   //                of services.
@@ -473,6 +585,27 @@ class NocSimulator {
   absl::Status CreateLink(NetworkComponentId nc_id);
   absl::Status CreateRouter(NetworkComponentId nc_id);
 
+  // Collects the simulation objects of all components and the components
+  // sharing a connection with each of them. Used by kEventDriven scheduling.
+  void BuildComponentNeighbors();
+
+  // Splits components_ into at most thread_count_ regions. See
+  // SetThreadCount.
+  void PartitionComponents();
+
+  // Runs a cycle with kEventDriven scheduling.
+  absl::Status RunEventDrivenCycle(int64_t max_ticks);
+
+  // Ticks the components of the given partition until all of them have
+  // converged for the current cycle. Returns the number of component ticks.
+  absl::StatusOr<int64_t> RunPartition(int64_t partition, int64_t max_ticks);
+
+  // Starts a thread for each partition other than the first, which is run by
+  // the thread calling RunCycle.
+  void StartWorkers();
+  void StopWorkers();
+  void WorkerLoop(int64_t partition);
+
   NetworkManager* mgr_;
   NocParameters* params_;
   DistributedRoutingTable* routing_;
@@ -501,6 +634,10 @@ class NocSimulator {
   std::vector<int64_t> component_to_connection_index_;
   std::vector<SimConnectionState> connections_;
 
+  // Backing storage of the ring buffers of all DataFlitQueues, kept in one
+  // allocation so that the buffers of a router are adjacent in memory.
+  std::vector<DataFlitQueueElement> data_flit_store_;
+
   // Stores port ids for routers.
   std::vector<PortId> port_id_store_;
 
@@ -514,6 +651,40 @@ class NocSimulator {
 
   // Shims to services to run at the end of each cycle.
   std::vector<NocSimulatorServiceShim*> post_cycle_services_;
+
+  Scheduling scheduling_ = Scheduling::kEventDriven;
+  int64_t component_tick_count_ = 0;
+
+  // All component simulation objects in the order that Tick visits them.
+  std::vector<SimNetworkComponentBase*> components_;
+
+  // For each entry in components_, the indices of the other components which
+  // share a connection with it.
+  std::vector<std::vector<int64_t>> component_neighbors_;
+
+  int64_t thread_count_ = 1;
+
+  // Indices into components_ of the components in each partition.
+  std::vector<std::vector<int64_t>> partitions_;
+
+  // For each entry in components_, the index of its partition or -1 if it is
+  // a link at a partition boundary.
+  std::vector<int64_t> component_partition_;
+
+  // Indices into components_ of the links at partition boundaries. These are
+  // ticked by the thread calling RunCycle before and after the partitions.
+  std::vector<int64_t> boundary_links_;
+
+  // Worker threads for all but the first partition along with the state used
+  // to hand them a cycle to run.
+  std::vector<std::unique_ptr<Thread>> workers_;
+  absl::Mutex worker_mutex_;
+  int64_t worker_generation_ ABSL_GUARDED_BY(worker_mutex_) = 0;
+  int64_t workers_running_ ABSL_GUARDED_BY(worker_mutex_) = 0;
+  bool workers_shutdown_ ABSL_GUARDED_BY(worker_mutex_) = false;
+  int64_t worker_max_ticks_ ABSL_GUARDED_BY(worker_mutex_) = 0;
+  std::vector<absl::StatusOr<int64_t>> partition_ticks_
+      ABSL_GUARDED_BY(worker_mutex_);
 };
 
 }  // namespace noc
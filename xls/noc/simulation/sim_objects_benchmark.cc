@@ -0,0 +1,153 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "include/benchmark/benchmark.h"
+#include "xls/noc/config/network_config.pb.h"
+#include "xls/noc/simulation/common.h"
+#include "xls/noc/simulation/global_routing_table.h"
+#include "xls/noc/simulation/network_graph_builder.h"
+#include "xls/noc/simulation/network_graph.h"
+#include "xls/noc/simulation/noc_traffic_injector.h"
+#include "xls/noc/simulation/parameters.h"
+#include "xls/noc/simulation/random_number_interface.h"
+#include "xls/noc/simulation/sample_network_graphs.h"
+#include "xls/noc/simulation/sim_objects.h"
+#include "xls/noc/simulation/simulator_to_traffic_injector_shim.h"
+#include "xls/noc/simulation/traffic_description.h"
+
+namespace xls::noc {
+namespace {
+
+using SampleNetworkBuilder = absl::Status (*)(NetworkConfigProto*,
+                                              NetworkManager*, NocParameters*);
+
+// Simulates random traffic from each source to each listed sink of a sample
+// network and reports the number of flits delivered per second of wall time.
+void SimulateSampleNetwork(
+    benchmark::State& state, SampleNetworkBuilder build_network,
+    const std::vector<std::pair<std::string_view, std::string_view>>& flows) {
+  constexpr int64_t kCyclesPerIteration = 1000;
+  constexpr int64_t kCycleTimeInPs = 400;
+
+  NocTrafficManager traffic_mgr;
+  TrafficModeId mode_id = traffic_mgr.CreateTrafficMode().value();
+  TrafficMode& mode = traffic_mgr.GetTrafficMode(mode_id);
+  mode.SetName("Mode 0");
+  for (const auto& [source, destination] : flows) {
+    TrafficFlowId flow_id = traffic_mgr.CreateTrafficFlow().value();
+    traffic_mgr.GetTrafficFlow(flow_id)
+        .SetName(absl::StrCat(source, "->", destination))
+        .SetSource(source)
+        .SetDestination(destination)
+        .SetVC("VC0")
+        .SetTrafficRateInMiBps(2 * 1024)
+        .SetPacketSizeInBits(128)
+        .SetBurstProbInMils(7);
+    mode.RegisterTrafficFlow(flow_id);
+  }
+
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  CHECK_OK(build_network(&proto, &graph, &params));
+  DistributedRoutingTableBuilderForMultiplePaths route_builder;
+  DistributedRoutingTable routing_table =
+      route_builder
+          .BuildNetworkRoutingTables(graph.GetNetworkIds()[0], graph, params)
+          .value();
+
+  RandomNumberInterface rnd;
+  rnd.SetSeed(1000);
+  NocTrafficInjector traffic_injector =
+      NocTrafficInjectorBuilder()
+          .Build(kCycleTimeInPs, mode_id,
+                 routing_table.GetSourceIndices().GetNetworkComponents(),
+                 routing_table.GetSinkIndices().GetNetworkComponents(),
+                 params.GetNetworkParam(graph.GetNetworkIds()[0])
+                     ->GetVirtualChannels(),
+                 traffic_mgr, graph, params, rnd)
+          .value();
+
+  NocSimulator simulator;
+  CHECK_OK(simulator.Initialize(graph, params, routing_table,
+                                graph.GetNetworkIds()[0]));
+  NocSimulatorToNocTrafficInjectorShim injector_shim(simulator,
+                                                     traffic_injector);
+  traffic_injector.SetSimulatorShim(injector_shim);
+  simulator.RegisterPreCycleService(injector_shim);
+
+  std::vector<SimNetworkInterfaceSink*> sinks;
+  for (const auto& [source, destination] : flows) {
+    NetworkComponentId sink_id =
+        FindNetworkComponentByName(destination, graph, params).value();
+    sinks.push_back(simulator.GetSimNetworkInterfaceSink(sink_id).value());
+  }
+
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kCyclesPerIteration; ++i) {
+      CHECK_OK(simulator.RunCycle());
+    }
+  }
+
+  int64_t flit_count = 0;
+  for (SimNetworkInterfaceSink* sink : sinks) {
+    flit_count += sink->GetReceivedTraffic().size();
+  }
+  state.counters["flits"] =
+      benchmark::Counter(flit_count, benchmark::Counter::kIsRate);
+  state.counters["cycles"] = benchmark::Counter(
+      state.iterations() * kCyclesPerIteration, benchmark::Counter::kIsRate);
+}
+
+void BM_Linear000(benchmark::State& state) {
+  SimulateSampleNetwork(state, BuildNetworkGraphLinear000,
+                        {{"SendPort0", "RecvPort0"}});
+}
+
+void BM_Linear001(benchmark::State& state) {
+  SimulateSampleNetwork(
+      state, BuildNetworkGraphLinear001,
+      {{"SendPort0", "RecvPort0"}, {"SendPort1", "RecvPort1"}});
+}
+
+void BM_Tree000(benchmark::State& state) {
+  SimulateSampleNetwork(state, BuildNetworkGraphTree000,
+                        {{"SendPort0", "RecvPort0"},
+                         {"SendPort1", "RecvPort1"},
+                         {"SendPort2", "RecvPort3"}});
+}
+
+void BM_Loop001(benchmark::State& state) {
+  SimulateSampleNetwork(state, BuildNetworkGraphLoop001,
+                        {{"SendPort0", "RecvPort2"},
+                         {"SendPort1", "RecvPort3"},
+                         {"SendPort2", "RecvPort0"},
+                         {"SendPort3", "RecvPort1"}});
+}
+
+BENCHMARK(BM_Linear000);
+BENCHMARK(BM_Linear001);
+BENCHMARK(BM_Tree000);
+BENCHMARK(BM_Loop001);
+
+}  // namespace
+}  // namespace xls::noc
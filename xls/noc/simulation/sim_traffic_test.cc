@@ -12,12 +12,21 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cstdint>
+#include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/global_routing_table.h"
@@ -35,6 +44,257 @@
 namespace xls::noc {
 namespace {
 
+using ::testing::ElementsAreArray;
+
+struct TrafficRunResult {
+  double measured_traffic_sent;
+  double measured_traffic_recv;
+  int64_t component_tick_count;
+  int64_t partition_count;
+  int64_t flits_received;
+  std::vector<int64_t> router_utilization;
+  absl::Duration run_time;
+};
+
+// Runs random traffic from SendPort0 to RecvPort0 of the linear sample network
+// with the given scheduling.
+absl::StatusOr<TrafficRunResult> RunLinearTraffic(
+    NocSimulator::Scheduling scheduling, int64_t cycle_count,
+    int64_t traffic_rate_in_mibps = 256) {
+  NocTrafficManager traffic_mgr;
+  XLS_ASSIGN_OR_RETURN(TrafficFlowId flow0_id,
+                       traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow0_id)
+      .SetName("flow0")
+      .SetSource("SendPort0")
+      .SetDestination("RecvPort0")
+      .SetVC("VC0")
+      .SetTrafficRateInMiBps(traffic_rate_in_mibps)
+      .SetPacketSizeInBits(128)
+      .SetBurstProbInMils(7);
+  XLS_ASSIGN_OR_RETURN(TrafficModeId mode0_id,
+                       traffic_mgr.CreateTrafficMode());
+  traffic_mgr.GetTrafficMode(mode0_id).SetName("Mode 0").RegisterTrafficFlow(
+      flow0_id);
+
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_RETURN_IF_ERROR(BuildNetworkGraphLinear000(&proto, &graph, &params));
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSIGN_OR_RETURN(DistributedRoutingTable routing_table,
+                       route_builder.BuildNetworkRoutingTables(
+                           graph.GetNetworkIds()[0], graph, params));
+
+  RandomNumberInterface rnd;
+  int64_t cycle_time_in_ps = 400;
+  rnd.SetSeed(1000);
+  XLS_ASSIGN_OR_RETURN(
+      NocTrafficInjector traffic_injector,
+      NocTrafficInjectorBuilder().Build(
+          cycle_time_in_ps, mode0_id,
+          routing_table.GetSourceIndices().GetNetworkComponents(),
+          routing_table.GetSinkIndices().GetNetworkComponents(),
+          params.GetNetworkParam(graph.GetNetworkIds()[0])
+              ->GetVirtualChannels(),
+          traffic_mgr, graph, params, rnd));
+
+  NocSimulator simulator;
+  XLS_RETURN_IF_ERROR(simulator.Initialize(graph, params, routing_table,
+                                           graph.GetNetworkIds()[0]));
+  simulator.SetScheduling(scheduling);
+  NocSimulatorToNocTrafficInjectorShim injector_shim(simulator,
+                                                     traffic_injector);
+  traffic_injector.SetSimulatorShim(injector_shim);
+  simulator.RegisterPreCycleService(injector_shim);
+
+  absl::Time start = absl::Now();
+  for (int64_t i = 0; i < cycle_count; ++i) {
+    XLS_RETURN_IF_ERROR(simulator.RunCycle());
+  }
+  absl::Duration run_time = absl::Now() - start;
+
+  XLS_ASSIGN_OR_RETURN(NetworkComponentId recv_port_0,
+                       FindNetworkComponentByName("RecvPort0", graph, params));
+  XLS_ASSIGN_OR_RETURN(SimNetworkInterfaceSink * sim_recv_port_0,
+                       simulator.GetSimNetworkInterfaceSink(recv_port_0));
+  return TrafficRunResult{
+      .measured_traffic_sent =
+          traffic_injector.MeasuredTrafficRateInMiBps(cycle_time_in_ps, 0),
+      .measured_traffic_recv =
+          sim_recv_port_0->MeasuredTrafficRateInMiBps(cycle_time_in_ps),
+      .component_tick_count = simulator.GetComponentTickCount(),
+      .partition_count = simulator.GetPartitionCount(),
+      .flits_received =
+          static_cast<int64_t>(sim_recv_port_0->GetReceivedTraffic().size()),
+      .run_time = run_time,
+  };
+}
+
+// Runs random traffic over both paths of the sample network with two routers
+// in series using the given number of simulation threads.
+absl::StatusOr<TrafficRunResult> RunMultiplePathsTraffic(int64_t thread_count,
+                                                         int64_t cycle_count) {
+  NocTrafficManager traffic_mgr;
+  XLS_ASSIGN_OR_RETURN(TrafficFlowId flow0_id,
+                       traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow0_id)
+      .SetName("flow0")
+      .SetSource("SendPort0")
+      .SetDestination("RecvPort0")
+      .SetVC("VC0")
+      .SetTrafficRateInMiBps(1024)
+      .SetPacketSizeInBits(128)
+      .SetBurstProbInMils(7);
+  XLS_ASSIGN_OR_RETURN(TrafficFlowId flow1_id,
+                       traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow1_id)
+      .SetName("flow1")
+      .SetSource("SendPort1")
+      .SetDestination("RecvPort1")
+      .SetVC("VC0")
+      .SetTrafficRateInMiBps(512)
+      .SetPacketSizeInBits(128)
+      .SetBurstProbInMils(7);
+  XLS_ASSIGN_OR_RETURN(TrafficModeId mode0_id,
+                       traffic_mgr.CreateTrafficMode());
+  traffic_mgr.GetTrafficMode(mode0_id)
+      .SetName("Mode 0")
+      .RegisterTrafficFlow(flow0_id)
+      .RegisterTrafficFlow(flow1_id);
+
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_RETURN_IF_ERROR(BuildNetworkGraphLinear001(&proto, &graph, &params));
+  DistributedRoutingTableBuilderForMultiplePaths route_builder;
+  XLS_ASSIGN_OR_RETURN(DistributedRoutingTable routing_table,
+                       route_builder.BuildNetworkRoutingTables(
+                           graph.GetNetworkIds()[0], graph, params));
+
+  RandomNumberInterface rnd;
+  int64_t cycle_time_in_ps = 400;
+  rnd.SetSeed(1000);
+  XLS_ASSIGN_OR_RETURN(
+      NocTrafficInjector traffic_injector,
+      NocTrafficInjectorBuilder().Build(
+          cycle_time_in_ps, mode0_id,
+          routing_table.GetSourceIndices().GetNetworkComponents(),
+          routing_table.GetSinkIndices().GetNetworkComponents(),
+          params.GetNetworkParam(graph.GetNetworkIds()[0])
+              ->GetVirtualChannels(),
+          traffic_mgr, graph, params, rnd));
+
+  NocSimulator simulator;
+  XLS_RETURN_IF_ERROR(simulator.SetThreadCount(thread_count));
+  XLS_RETURN_IF_ERROR(simulator.Initialize(graph, params, routing_table,
+                                           graph.GetNetworkIds()[0]));
+  NocSimulatorToNocTrafficInjectorShim injector_shim(simulator,
+                                                     traffic_injector);
+  traffic_injector.SetSimulatorShim(injector_shim);
+  simulator.RegisterPreCycleService(injector_shim);
+
+  absl::Time start = absl::Now();
+  for (int64_t i = 0; i < cycle_count; ++i) {
+    XLS_RETURN_IF_ERROR(simulator.RunCycle());
+  }
+  absl::Duration run_time = absl::Now() - start;
+
+  XLS_ASSIGN_OR_RETURN(NetworkComponentId recv_port_0,
+                       FindNetworkComponentByName("RecvPort0", graph, params));
+  XLS_ASSIGN_OR_RETURN(SimNetworkInterfaceSink * sim_recv_port_0,
+                       simulator.GetSimNetworkInterfaceSink(recv_port_0));
+  std::vector<int64_t> router_utilization;
+  for (const SimInputBufferedVCRouter& router : simulator.GetRouters()) {
+    router_utilization.push_back(router.GetUtilizationCycleCount());
+  }
+  return TrafficRunResult{
+      .measured_traffic_sent =
+          traffic_injector.MeasuredTrafficRateInMiBps(cycle_time_in_ps, 0),
+      .measured_traffic_recv =
+          sim_recv_port_0->MeasuredTrafficRateInMiBps(cycle_time_in_ps),
+      .component_tick_count = simulator.GetComponentTickCount(),
+      .partition_count = simulator.GetPartitionCount(),
+      .flits_received =
+          static_cast<int64_t>(sim_recv_port_0->GetReceivedTraffic().size()),
+      .router_utilization = std::move(router_utilization),
+      .run_time = run_time,
+  };
+}
+
+TEST(SimTrafficTest, EventDrivenSchedulingMatchesSweep) {
+  constexpr int64_t kCycleCount = 50'000;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TrafficRunResult sweep,
+      RunLinearTraffic(NocSimulator::Scheduling::kSweep, kCycleCount));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TrafficRunResult event_driven,
+      RunLinearTraffic(NocSimulator::Scheduling::kEventDriven, kCycleCount));
+
+  EXPECT_EQ(event_driven.measured_traffic_sent, sweep.measured_traffic_sent);
+  EXPECT_EQ(event_driven.measured_traffic_recv, sweep.measured_traffic_recv);
+  EXPECT_LT(event_driven.component_tick_count, sweep.component_tick_count);
+
+  LOG(INFO) << absl::StreamFormat(
+      "Sweep: %d component ticks in %s; event driven: %d component ticks in "
+      "%s (%.2fx fewer ticks, %.2fx speedup)",
+      sweep.component_tick_count, absl::FormatDuration(sweep.run_time),
+      event_driven.component_tick_count,
+      absl::FormatDuration(event_driven.run_time),
+      static_cast<double>(sweep.component_tick_count) /
+          event_driven.component_tick_count,
+      absl::FDivDuration(sweep.run_time,
+                         std::max(event_driven.run_time,
+                                  absl::Nanoseconds(1))));
+}
+
+// Reports the rate (in flits per second of wall time) at which flits are
+// injected and delivered, at a low and a high injection rate.
+TEST(SimTrafficTest, FlitThroughput) {
+  constexpr int64_t kCycleCount = 100'000;
+  for (int64_t traffic_rate_in_mibps : {256, 4096}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        TrafficRunResult result,
+        RunLinearTraffic(NocSimulator::Scheduling::kEventDriven, kCycleCount,
+                         traffic_rate_in_mibps));
+    EXPECT_GT(result.flits_received, 0);
+    EXPECT_GT(result.measured_traffic_recv, 0.0);
+
+    LOG(INFO) << absl::StreamFormat(
+        "%d MiBps: %d flits in %s (%.0f flits/sec)", traffic_rate_in_mibps,
+        result.flits_received, absl::FormatDuration(result.run_time),
+        static_cast<double>(result.flits_received) /
+            absl::ToDoubleSeconds(
+                std::max(result.run_time, absl::Nanoseconds(1))));
+  }
+}
+
+TEST(SimTrafficTest, PartitionedSimulationMatchesSingleThreaded) {
+  constexpr int64_t kCycleCount = 20'000;
+  XLS_ASSERT_OK_AND_ASSIGN(TrafficRunResult single,
+                           RunMultiplePathsTraffic(1, kCycleCount));
+  XLS_ASSERT_OK_AND_ASSIGN(TrafficRunResult partitioned,
+                           RunMultiplePathsTraffic(4, kCycleCount));
+
+  // Every link of the network is pipelined in both directions so each
+  // interface and router is a region of its own.
+  EXPECT_EQ(single.partition_count, 1);
+  EXPECT_EQ(partitioned.partition_count, 4);
+  EXPECT_EQ(partitioned.measured_traffic_sent, single.measured_traffic_sent);
+  EXPECT_EQ(partitioned.measured_traffic_recv, single.measured_traffic_recv);
+  EXPECT_THAT(partitioned.router_utilization,
+              ElementsAreArray(single.router_utilization));
+  EXPECT_GT(single.measured_traffic_recv, 0.0);
+
+  LOG(INFO) << absl::StreamFormat(
+      "Single threaded: %s; %d partitions: %s (%.2fx speedup)",
+      absl::FormatDuration(single.run_time), partitioned.partition_count,
+      absl::FormatDuration(partitioned.run_time),
+      absl::FDivDuration(single.run_time,
+                         std::max(partitioned.run_time,
+                                  absl::Nanoseconds(1))));
+}
+
 TEST(SimTrafficTest, BackToBackNetwork0) {
   // Construct traffic flows
   NocTrafficManager traffic_mgr;
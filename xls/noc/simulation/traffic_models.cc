@@ -28,60 +28,38 @@
 
 namespace xls::noc {
 
-std::vector<DataPacket> GeneralizedGeometricTrafficModel::GetNewCyclePackets(
+int64_t GeneralizedGeometricTrafficModel::GetNewCyclePacketCount(
     int64_t cycle) {
   if (next_packet_cycle_ > cycle) {
     // No packets to be sent until next_packet_cycle_.
-    return std::vector<DataPacket>();
+    return 0;
   }
 
-  std::vector<DataPacket> packets;
+  int64_t packet_count = 0;
 
   if (next_packet_cycle_ == -1) {
     // Packet sent on cycle 0 will only be due to a burst.
     next_packet_cycle_ = 0;
   } else {
     // Except for the initial packet.
-    // We expect GetNewCyclePackets to be called without skipping
+    // We expect GetNewCyclePacketCount to be called without skipping
     // a cycle in which a packet would be sent.
     CHECK_EQ(cycle, next_packet_cycle_);
-    packets.push_back(next_packet_);
+    ++packet_count;
   }
 
   // See if we have a burst of packets.
   int64_t next_packet_delta =
       random_interface_->GeneralizedGeometric(lambda_, burst_prob_);
   while (next_packet_delta == 0) {
-    // New burst packet.  Rest of the packet fields other than size
-    // will be filled later.
-    absl::StatusOr<DataPacket> burst_packet =
-        DataPacketBuilder()
-            .Valid(true)
-            .ZeroedData(packet_size_bits_)
-            .VirtualChannel(vc_)
-            .SourceIndex(source_index_)
-            .DestinationIndex(destination_index_)
-            .Build();
-    CHECK(burst_packet.ok());
-    packets.push_back(burst_packet.value());
-
+    ++packet_count;
     next_packet_delta =
         random_interface_->GeneralizedGeometric(lambda_, burst_prob_);
   }
 
-  absl::StatusOr<DataPacket> future_packet =
-      DataPacketBuilder()
-          .Valid(true)
-          .ZeroedData(packet_size_bits_)
-          .VirtualChannel(vc_)
-          .SourceIndex(source_index_)
-          .DestinationIndex(destination_index_)
-          .Build();
-  CHECK(future_packet.ok());
-  next_packet_ = future_packet.value();
   next_packet_cycle_ += next_packet_delta;
 
-  return packets;
+  return packet_count;
 }
 
 GeneralizedGeometricTrafficModelBuilder::
@@ -124,7 +102,7 @@ ReplayTrafficModel::ReplayTrafficModel(int64_t packet_size_bits,
   clock_cycle_iter_ = clock_cycles_.cbegin();
 }
 
-std::vector<DataPacket> ReplayTrafficModel::GetNewCyclePackets(int64_t cycle) {
+int64_t ReplayTrafficModel::GetNewCyclePacketCount(int64_t cycle) {
   if (cycle > cycle_count_) {
     cycle_count_ = cycle;
   }
@@ -132,24 +110,11 @@ std::vector<DataPacket> ReplayTrafficModel::GetNewCyclePackets(int64_t cycle) {
   if ((clock_cycle_iter_ == clock_cycles_.end()) ||
       (*clock_cycle_iter_ != cycle)) {
     // No packets to be sent until next_packet_cycle_.
-    return std::vector<DataPacket>();
+    return 0;
   }
 
-  std::vector<DataPacket> packets;
-
-  CHECK_EQ(cycle, *clock_cycle_iter_);
-
-  absl::StatusOr<DataPacket> packet = DataPacketBuilder()
-                                          .Valid(true)
-                                          .ZeroedData(packet_size_bits_)
-                                          .VirtualChannel(vc_)
-                                          .SourceIndex(source_index_)
-                                          .DestinationIndex(destination_index_)
-                                          .Build();
-  CHECK(packet.ok());
-  packets.push_back(packet.value());
   clock_cycle_iter_++;
-  return packets;
+  return 1;
 }
 
 double ReplayTrafficModel::ExpectedTrafficRateInMiBps(
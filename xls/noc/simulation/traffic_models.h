@@ -24,6 +24,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/packetizer.h"
 #include "xls/noc/simulation/random_number_interface.h"
@@ -47,7 +48,26 @@ class TrafficModel {
   //       GetNewCyclePackets(1), GetNewCyclePackets(2), ...
   //
   // TODO(tedhong): 2021-06-27 Add an interface to support fast-forwarding.
-  virtual std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) = 0;
+  std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) {
+    return std::vector<DataPacket>(GetNewCyclePacketCount(cycle),
+                                   GetPacketTemplate());
+  }
+
+  // As GetNewCyclePackets() but only returns the number of packets sent.
+  //
+  // All packets of a model are identical to GetPacketTemplate(), so injectors
+  // can convert the template to flits once and avoid building packets.
+  virtual int64_t GetNewCyclePacketCount(int64_t cycle) = 0;
+
+  // Returns the packet sent by this model.
+  DataPacket GetPacketTemplate() const {
+    return DataPacket{.valid = true,
+                      .source_index = static_cast<int16_t>(source_index_),
+                      .destination_index =
+                          static_cast<int16_t>(destination_index_),
+                      .vc = static_cast<int16_t>(vc_),
+                      .data = Bits(packet_size_bits_)};
+  }
 
   // Returns expected rate of traffic injected in MebiBytes Per Sec.
   virtual double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const = 0;
@@ -142,7 +162,7 @@ class GeneralizedGeometricTrafficModel : public TrafficModel {
         next_packet_cycle_(-1),
         random_interface_(&rnd) {}
 
-  std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) override;
+  int64_t GetNewCyclePacketCount(int64_t cycle) override;
 
   double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const override {
     double num_cycles = 1.0e12 / static_cast<double>(cycle_time_ps);
@@ -165,8 +185,6 @@ class GeneralizedGeometricTrafficModel : public TrafficModel {
   }
 
  private:
-  DataPacket next_packet_;
-
   double lambda_;      // Lambda of the distribution (unit 1/cycle)
   double burst_prob_;  // Probability of a burst
 
@@ -204,7 +222,7 @@ class ReplayTrafficModel : public TrafficModel {
   ReplayTrafficModel(int64_t packet_size_bits,
                      absl::Span<const int64_t> clock_cycles);
 
-  std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) override;
+  int64_t GetNewCyclePacketCount(int64_t cycle) override;
 
   double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const override;
 
@@ -249,6 +267,17 @@ class TrafficModelMonitor {
     }
   }
 
+  // Measures `packet_count` packets of `packet_bit_count` bits each that were
+  // sent on cycle.
+  void AcceptNewPacketCount(int64_t packet_count, int64_t packet_bit_count,
+                            int64_t cycle) {
+    if (cycle > max_cycle_) {
+      max_cycle_ = cycle;
+    }
+    num_bits_sent_ += packet_count * packet_bit_count;
+    packets_sent_count_ += packet_count;
+  }
+
   // Returns observed count of packets sent in all previous calls to
   // AcceptNewPackets().
   int64_t MeasuredPacketCount() const { return packets_sent_count_; }
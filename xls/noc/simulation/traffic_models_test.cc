@@ -22,6 +22,7 @@
 #include "absl/log/log.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
 #include "xls/noc/simulation/packetizer.h"
 #include "xls/noc/simulation/random_number_interface.h"
 
@@ -88,6 +89,39 @@ TEST(TrafficModelsTest, GeneralizedGeometricModelTest) {
                    lambda * 128.0 / 500.0e-12 / 1024.0 / 1024.0 / 8.0);
 }
 
+TEST(TrafficModelsTest, PacketCountMatchesPackets) {
+  RandomNumberInterface rnd0;
+  RandomNumberInterface rnd1;
+  rnd0.SetSeed(100);
+  rnd1.SetSeed(100);
+  GeneralizedGeometricTrafficModel model0(0.3, 0.2, 64, rnd0);
+  GeneralizedGeometricTrafficModel model1(0.3, 0.2, 64, rnd1);
+  model1.SetVCIndex(1);
+  model1.SetSourceIndex(2);
+  model1.SetDestinationIndex(3);
+
+  TrafficModelMonitor monitor0;
+  TrafficModelMonitor monitor1;
+  for (int64_t cycle = 0; cycle < 100'000; ++cycle) {
+    std::vector<DataPacket> packets = model0.GetNewCyclePackets(cycle);
+    int64_t packet_count = model1.GetNewCyclePacketCount(cycle);
+    ASSERT_EQ(static_cast<int64_t>(packets.size()), packet_count) << cycle;
+    monitor0.AcceptNewPackets(absl::MakeSpan(packets), cycle);
+    monitor1.AcceptNewPacketCount(packet_count, 64, cycle);
+  }
+  EXPECT_EQ(monitor0.MeasuredBitsSent(), monitor1.MeasuredBitsSent());
+  EXPECT_EQ(monitor0.MeasuredPacketCount(), monitor1.MeasuredPacketCount());
+  EXPECT_DOUBLE_EQ(monitor0.MeasuredTrafficRateInMiBps(500),
+                   monitor1.MeasuredTrafficRateInMiBps(500));
+
+  DataPacket packet = model1.GetPacketTemplate();
+  EXPECT_TRUE(packet.valid);
+  EXPECT_EQ(packet.vc, 1);
+  EXPECT_EQ(packet.source_index, 2);
+  EXPECT_EQ(packet.destination_index, 3);
+  EXPECT_EQ(packet.data, Bits(64));
+}
+
 TEST(TrafficModelsTest, GeneralizedGeometricModelBuilderTest) {
   double lambda = 0.2;
   double burst_prob = 0.1;
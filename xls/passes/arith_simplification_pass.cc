@@ -1312,7 +1312,7 @@ absl::StatusOr<bool> MatchArithPatterns(int64_t opt_level, Node* n,
 absl::StatusOr<bool> ArithSimplificationPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
-  return TransformNodesToFixedPoint(f, [this](Node* n) {
+  return TransformNodesToFixedPoint(f, options, [this](Node* n) {
     return MatchArithPatterns(opt_level_, n, StatelessQueryEngine());
   });
 }
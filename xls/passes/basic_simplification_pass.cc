@@ -461,7 +461,7 @@ absl::StatusOr<bool> MatchPatterns(Node* n) {
 absl::StatusOr<bool> BasicSimplificationPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
-  return TransformNodesToFixedPoint(f, MatchPatterns);
+  return TransformNodesToFixedPoint(f, options, MatchPatterns);
 }
 
 REGISTER_OPT_PASS(BasicSimplificationPass);
@@ -17,9 +17,13 @@
 #include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include <random>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -28,6 +32,8 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/delay_model/delay_estimators.h"
+#include "xls/ir/abstract_evaluator.h"
+#include "xls/ir/abstract_node_evaluator.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/topo_sort.h"
@@ -96,26 +102,116 @@ absl::StatusOr<std::vector<Node*>> GetNodeOrder(FunctionBase* f) {
   return nodes;
 }
 
+// An evaluator which simulates 64 input vectors at once: each element holds
+// the value of one bit in each of 64 simulation lanes.
+class BitParallelEvaluator
+    : public AbstractEvaluator<uint64_t, BitParallelEvaluator> {
+ public:
+  uint64_t One() const { return ~uint64_t{0}; }
+  uint64_t Zero() const { return 0; }
+  uint64_t Not(const uint64_t& input) const { return ~input; }
+  uint64_t And(const uint64_t& a, const uint64_t& b) const { return a & b; }
+  uint64_t Or(const uint64_t& a, const uint64_t& b) const { return a | b; }
+};
+
+// Returns a 64-bit signature of the value of each bits-typed node under 64
+// pseudo-random input vectors. Nodes which the BDD analysis evaluates (cheap
+// nodes with bits-typed operands) are simulated exactly and every other node
+// gets fresh random lanes, just as the BDD analysis gives it fresh variables.
+// Hence nodes with equal BDDs always have equal signatures and only nodes
+// with matching signatures need to be compared with BDDs.
+absl::StatusOr<absl::flat_hash_map<Node*, int64_t>> ComputeSignatures(
+    FunctionBase* f) {
+  // Fixed seed so the pass is deterministic.
+  std::mt19937_64 rng(0);
+  auto random_lanes = [&](Node* n) {
+    BitParallelEvaluator::Vector lanes(n->BitCountOrDie());
+    for (uint64_t& lane : lanes) {
+      lane = rng();
+    }
+    return lanes;
+  };
+
+  BitParallelEvaluator evaluator;
+  absl::flat_hash_map<Node*, BitParallelEvaluator::Vector> values;
+  absl::flat_hash_map<Node*, int64_t> signatures;
+  for (Node* node : TopoSort(f)) {
+    if (!node->GetType()->IsBits()) {
+      continue;
+    }
+    if (!IsCheapForBdds(node) ||
+        std::any_of(node->operands().begin(), node->operands().end(),
+                    [](Node* o) { return !o->GetType()->IsBits(); })) {
+      values[node] = random_lanes(node);
+    } else {
+      std::vector<BitParallelEvaluator::Span> operand_values;
+      operand_values.reserve(node->operand_count());
+      for (Node* operand : node->operands()) {
+        operand_values.push_back(values.at(operand));
+      }
+      XLS_ASSIGN_OR_RETURN(values[node],
+                           AbstractEvaluate(node, operand_values, &evaluator,
+                                            /*default_handler=*/random_lanes));
+    }
+    signatures[node] = absl::HashOf(values.at(node));
+  }
+  return signatures;
+}
+
 }  // namespace
 
 absl::StatusOr<bool> BddCsePass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
+  // Only nodes which share a simulation signature with another node can be
+  // equivalent. These are usually a small fraction of the function so the
+  // (comparatively expensive) BDDs are only built for their fan-in cones.
+  XLS_ASSIGN_OR_RETURN(auto signatures, ComputeSignatures(f));
+  absl::flat_hash_map<int64_t, int64_t> signature_counts;
+  for (Node* node : f->nodes()) {
+    if (node->GetType()->IsBits() && !node->Is<Literal>()) {
+      ++signature_counts[signatures.at(node)];
+    }
+  }
+  std::vector<Node*> worklist;
+  for (Node* node : f->nodes()) {
+    if (node->GetType()->IsBits() && !node->Is<Literal>() &&
+        signature_counts.at(signatures.at(node)) > 1) {
+      worklist.push_back(node);
+    }
+  }
+  if (worklist.empty()) {
+    return false;
+  }
+  absl::flat_hash_set<Node*> cone(worklist.begin(), worklist.end());
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    for (Node* operand : node->operands()) {
+      if (cone.insert(operand).second) {
+        worklist.push_back(operand);
+      }
+    }
+  }
+
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BddFunction> bdd_function,
-      BddFunction::Run(f, BddFunction::kDefaultPathLimit, IsCheapForBdds));
+      BddFunction::Run(f, BddFunction::kDefaultPathLimit,
+                       [&](const Node* n) {
+                         return IsCheapForBdds(n) && cone.contains(n);
+                       }));
 
   // To improve efficiency, bucket potentially common nodes together. The
-  // bucketing is done via a int64_t hash value of the BDD node indices of each
-  // bit of the node.
-  auto hasher = absl::Hash<std::vector<int64_t>>();
+  // bucketing is done via a int64_t hash value of the simulation signature and
+  // the BDD node indices of each bit of the node.
+  auto hasher = absl::Hash<std::pair<int64_t, std::vector<int64_t>>>();
   auto node_hash = [&](Node* n) {
     CHECK(n->GetType()->IsBits());
     std::vector<int64_t> values_to_hash;
     for (int64_t i = 0; i < n->BitCountOrDie(); ++i) {
       values_to_hash.push_back(bdd_function->GetBddNode(n, i).value());
     }
-    return hasher(values_to_hash);
+    return hasher({signatures.at(n), values_to_hash});
   };
 
   auto is_same_value = [&](Node* a, Node* b) {
@@ -135,7 +231,8 @@ absl::StatusOr<bool> BddCsePass::RunOnFunctionBaseInternal(
   node_buckets.reserve(f->node_count());
   XLS_ASSIGN_OR_RETURN(std::vector<Node*> node_order, GetNodeOrder(f));
   for (Node* node : node_order) {
-    if (!node->GetType()->IsBits() || node->Is<Literal>()) {
+    if (!node->GetType()->IsBits() || node->Is<Literal>() ||
+        signature_counts.at(signatures.at(node)) < 2) {
       continue;
     }
 
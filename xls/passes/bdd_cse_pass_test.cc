@@ -89,5 +89,39 @@ TEST_F(BddCsePassTest, DecodeEquivalentToDeconstructedDecode) {
   EXPECT_THAT(f->return_value(), m::Tuple(m::Decode(), m::Decode()));
 }
 
+TEST_F(BddCsePassTest, EquivalentExpressionsOfExpensiveNode) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue sum = fb.Add(x, y);
+  BValue product = fb.UMul(x, y);
+  BValue forty_two = fb.Literal(UBits(42, 32));
+  BValue sum_eq_42 = fb.Eq(sum, forty_two);
+  BValue forty_two_not_ne_sum = fb.Not(fb.Ne(forty_two, sum));
+  BValue product_eq_42 = fb.Eq(product, forty_two);
+  fb.Tuple({sum_eq_42, forty_two_not_ne_sum, product_eq_42});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Tuple(m::Eq(m::Add(), m::Literal(42)),
+                       m::Eq(m::Add(), m::Literal(42)),
+                       m::Eq(m::UMul(), m::Literal(42))));
+}
+
+TEST_F(BddCsePassTest, IdenticalExpensiveNodesAreNotMerged) {
+  // The BDD analysis models expensive nodes as opaque variables so identical
+  // expensive expressions are left for CSE.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  fb.Tuple({fb.Add(x, y), fb.Add(x, y)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f), IsOkAndHolds(false));
+}
+
 }  // namespace
 }  // namespace xls
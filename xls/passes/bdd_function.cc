@@ -404,6 +404,18 @@ class BddStatistics {
     if (stop_watch.has_value()) {
       bdd_stats.AddOp(node->op(), stop_watch->GetElapsedTime());
     }
+
+    // Reclaim the intermediate nodes created while evaluating the nodes so far.
+    // Only the expressions of the XLS nodes themselves are kept.
+    if (bdd_function->bdd().ShouldGarbageCollect()) {
+      std::vector<BddNodeIndex> roots;
+      for (const auto& [_, value] : values) {
+        for (const SaturatingBddNodeIndex& bit : value) {
+          roots.push_back(std::get<BddNodeIndex>(bit));
+        }
+      }
+      bdd_function->bdd().GarbageCollect(roots);
+    }
   }
   XLS_VLOG_LINES(2, bdd_stats.ToString());
 
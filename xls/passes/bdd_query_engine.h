@@ -113,7 +113,7 @@ class BddQueryEngine : public QueryEngine {
   // performed and the BDD method returns a union of path limit exceeded or
   // the result of the query.
   bool ExceedsPathLimit(BddNodeIndex node) const {
-    return path_limit_ > 0 && bdd().GetNode(node).path_count > path_limit_;
+    return path_limit_ > 0 && bdd().path_count(node) > path_limit_;
   }
 
   // The maximum number of paths in expression in the BDD before truncating.
@@ -319,7 +319,7 @@ static absl::StatusOr<bool> CanonicalizeNode(Node* n) {
 absl::StatusOr<bool> CanonicalizationPass::RunOnFunctionBaseInternal(
     FunctionBase* func, const OptimizationPassOptions& options,
     PassResults* results) const {
-  return TransformNodesToFixedPoint(func, CanonicalizeNode);
+  return TransformNodesToFixedPoint(func, options, CanonicalizeNode);
 }
 
 REGISTER_OPT_PASS(CanonicalizationPass);
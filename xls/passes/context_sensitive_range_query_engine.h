@@ -56,6 +56,16 @@ class ContextSensitiveRangeQueryEngine final : public QueryEngine {
     return base_case_ranges_.GetIntervals(node);
   }
 
+  SharedLeafTypeTree<IntervalSet> GetIntervalsShared(
+      Node* node) const override {
+    return base_case_ranges_.GetIntervalsShared(node);
+  }
+
+  IntervalSet GetIntervalsElement(
+      Node* node, absl::Span<const int64_t> index = {}) const override {
+    return base_case_ranges_.GetIntervalsElement(node, index);
+  }
+
   LeafTypeTree<IntervalSet> GetIntervalsGivenPredicates(
       Node* node, const absl::flat_hash_set<PredicateState>& state) const {
     return SpecializeGivenPredicate(state)->GetIntervals(node);
@@ -69,6 +79,11 @@ class ContextSensitiveRangeQueryEngine final : public QueryEngine {
     return base_case_ranges_.GetTernary(node);
   }
 
+  TernaryVector GetTernaryElement(
+      Node* node, absl::Span<const int64_t> index = {}) const override {
+    return base_case_ranges_.GetTernaryElement(node, index);
+  }
+
   bool AtMostOneTrue(absl::Span<TreeBitLocation const> bits) const override {
     return base_case_ranges_.AtMostOneTrue(bits);
   }
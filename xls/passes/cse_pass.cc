@@ -14,20 +14,28 @@
 
 #include "xls/passes/cse_pass.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/op.h"
+#include "xls/ir/structural_hash_index.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
@@ -60,34 +68,74 @@ absl::Span<Node* const> GetOperandsForCse(
   return *span_backing_store;
 }
 
+// Returns the value used to bucket potentially common nodes together. It is
+// constructed from the op() of the node and the uid's of the node's operands.
+int64_t NodeHash(Node* n) {
+  std::vector<int64_t> values_to_hash = {static_cast<int64_t>(n->op())};
+  std::vector<Node*> span_backing_store;
+  for (Node* operand : GetOperandsForCse(n, &span_backing_store)) {
+    values_to_hash.push_back(operand->id());
+  }
+  // If this is slow because of many literals, the Literal values could be
+  // combined into the hash. As is, all literals get the same hash value.
+  return absl::Hash<std::vector<int64_t>>()(values_to_hash);
+}
+
+// Returns the NodeHash of each of `nodes`, computed by `threads` threads which
+// each hash a contiguous chunk of the nodes. Side-effecting nodes, which are
+// never commoned, are not hashed.
+std::vector<int64_t> ComputeNodeHashes(absl::Span<Node* const> nodes,
+                                       int64_t threads) {
+  std::vector<int64_t> hashes(nodes.size());
+  const int64_t chunk_size =
+      CeilOfRatio(static_cast<int64_t>(nodes.size()), threads);
+  std::vector<std::unique_ptr<Thread>> workers;
+  for (int64_t start = 0; start < nodes.size(); start += chunk_size) {
+    const int64_t end =
+        std::min(start + chunk_size, static_cast<int64_t>(nodes.size()));
+    workers.push_back(std::make_unique<Thread>([&nodes, &hashes, start, end]() {
+      for (int64_t i = start; i < end; ++i) {
+        if (!OpIsSideEffecting(nodes[i]->op())) {
+          hashes[i] = NodeHash(nodes[i]);
+        }
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& worker : workers) {
+    worker->Join();
+  }
+  return hashes;
+}
+
 }  // namespace
 
 absl::StatusOr<bool> RunCse(FunctionBase* f,
-                            absl::flat_hash_map<Node*, Node*>* replacements) {
-  // To improve efficiency, bucket potentially common nodes together. The
-  // bucketing is done via an int64_t hash value which is constructed from the
-  // op() of the node and the uid's of the node's operands.
-  auto hasher = absl::Hash<std::vector<int64_t>>();
-  auto node_hash = [&](Node* n) {
-    std::vector<int64_t> values_to_hash = {static_cast<int64_t>(n->op())};
-    std::vector<Node*> span_backing_store;
-    for (Node* operand : GetOperandsForCse(n, &span_backing_store)) {
-      values_to_hash.push_back(operand->id());
-    }
-    // If this is slow because of many literals, the Literal values could be
-    // combined into the hash. As is, all literals get the same hash value.
-    return hasher(values_to_hash);
-  };
+                            absl::flat_hash_map<Node*, Node*>* replacements,
+                            int64_t threads) {
+  std::vector<Node*> nodes = TopoSort(f);
+
+  // Hashing only reads the IR so it can be done for all nodes up front, in
+  // parallel. Commoning a node changes the operands of its users though, so
+  // the hashes of those users are stale and are recomputed when reached.
+  std::vector<int64_t> precomputed_hashes;
+  if (threads > 1) {
+    precomputed_hashes = ComputeNodeHashes(nodes, threads);
+  }
+  absl::flat_hash_set<Node*> stale_hashes;
 
+  // To improve efficiency, bucket potentially common nodes together.
   bool changed = false;
   absl::flat_hash_map<int64_t, std::vector<Node*>> node_buckets;
   node_buckets.reserve(f->node_count());
-  for (Node* node : TopoSort(f)) {
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    Node* node = nodes[i];
     if (OpIsSideEffecting(node->op())) {
       continue;
     }
 
-    int64_t hash = node_hash(node);
+    int64_t hash = precomputed_hashes.empty() || stale_hashes.contains(node)
+                       ? NodeHash(node)
+                       : precomputed_hashes[i];
     if (!node_buckets.contains(hash)) {
       node_buckets[hash].push_back(node);
       continue;
@@ -103,6 +151,9 @@ absl::StatusOr<bool> RunCse(FunctionBase* f,
           node->IsDefinitelyEqualTo(candidate)) {
         VLOG(3) << absl::StreamFormat("Replacing %s with equivalent node %s",
                                       node->GetName(), candidate->GetName());
+        if (!precomputed_hashes.empty()) {
+          stale_hashes.insert(node->users().begin(), node->users().end());
+        }
         XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(candidate));
         if (replacements != nullptr) {
           (*replacements)[node] = candidate;
@@ -120,10 +171,56 @@ absl::StatusOr<bool> RunCse(FunctionBase* f,
   return changed;
 }
 
+absl::StatusOr<bool> RunIncrementalCse(
+    FunctionBase* f, absl::flat_hash_map<Node*, Node*>* replacements) {
+  StructuralHashIndex* index = f->EnableStructuralHashing();
+  bool changed = false;
+  // Commoning a node changes the operands of its users which may make them
+  // duplicates in turn, so iterate until there are no potential duplicates.
+  for (std::vector<Node*> candidates = index->TakePotentialDuplicates();
+       !candidates.empty(); candidates = index->TakePotentialDuplicates()) {
+    SortByNodeId(&candidates);
+    for (Node* node : candidates) {
+      // The node may have been replaced already.
+      if (!index->Contains(node)) {
+        continue;
+      }
+      std::optional<Node*> equivalent = index->FindEquivalent(node);
+      if (!equivalent.has_value()) {
+        continue;
+      }
+      // Equivalent nodes have the same operands so neither depends on the
+      // other. Keep the older one as a full run would.
+      Node* replaced = node;
+      Node* kept = *equivalent;
+      if (kept->id() > replaced->id()) {
+        std::swap(replaced, kept);
+      }
+      VLOG(3) << absl::StreamFormat("Replacing %s with equivalent node %s",
+                                    replaced->GetName(), kept->GetName());
+      XLS_RETURN_IF_ERROR(replaced->ReplaceUsesWith(kept));
+      // The replaced node is now dead. Drop it from the index so it is not
+      // commoned again before it is removed.
+      index->Remove(replaced);
+      if (replacements != nullptr) {
+        (*replacements)[replaced] = kept;
+      }
+      changed = true;
+    }
+  }
+  return changed;
+}
+
 absl::StatusOr<bool> CsePass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
-  return RunCse(f, nullptr);
+  if (options.incremental_passes) {
+    return RunIncrementalCse(f, nullptr);
+  }
+  return RunCse(f, nullptr,
+                f->node_count() >= kMinNodesForParallelHashing
+                    ? options.node_threads
+                    : 1);
 }
 
 REGISTER_OPT_PASS(CsePass);
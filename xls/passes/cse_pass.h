@@ -15,6 +15,7 @@
 #ifndef XLS_PASSES_CSE_PASS_H_
 #define XLS_PASSES_CSE_PASS_H_
 
+#include <cstdint>
 #include <string_view>
 
 #include "absl/container/flat_hash_map.h"
@@ -32,8 +33,22 @@ namespace xls {
 // to the `replacements` hash map if it is not `nullptr`. Note that for many
 // common uses of the `replacements` map, you'll want to compute the transitive
 // closure of the relation rather than using it as-is.
+//
+// If `threads` is greater than one, the nodes are hashed into buckets by that
+// many threads. The nodes are still commoned serially so the result is the same
+// for any number of threads.
 absl::StatusOr<bool> RunCse(FunctionBase* f,
-                            absl::flat_hash_map<Node*, Node*>* replacements);
+                            absl::flat_hash_map<Node*, Node*>* replacements,
+                            int64_t threads = 1);
+
+// As RunCse, but uses the structural hash index of `f` (enabling structural
+// hashing on `f` if necessary) so that only the nodes added or changed since
+// the index was last used are considered. The first call on a function base
+// indexes all of its nodes. Of two equivalent nodes the one with the smaller id
+// is kept, so the result may differ from RunCse, which keeps the node earlier in
+// topological order.
+absl::StatusOr<bool> RunIncrementalCse(
+    FunctionBase* f, absl::flat_hash_map<Node*, Node*>* replacements);
 
 // Computes the fixed point of a strict partial order, i.e.: the relation that
 // solves the equation `F = R ∘ F` where `R` is the given strict partial order.
@@ -56,10 +71,17 @@ absl::flat_hash_map<T, T> FixedPointOfSPO(
 
 // Pass which performs common subexpression elimination. Equivalent ops with the
 // same operands are commoned. The pass can find arbitrarily large common
-// expressions.
+// expressions. With OptimizationPassOptions::incremental_passes the pass uses
+// RunIncrementalCse so repeated runs only consider changed nodes.
 class CsePass : public OptimizationFunctionBasePass {
  public:
   static constexpr std::string_view kName = "cse";
+
+  // Function bases with fewer nodes than this are hashed serially regardless
+  // of OptimizationPassOptions::node_threads as starting threads would cost
+  // more than it saves.
+  static constexpr int64_t kMinNodesForParallelHashing = 100000;
+
   CsePass()
       : OptimizationFunctionBasePass(kName,
                                      "Common subexpression elimination") {}
@@ -14,7 +14,9 @@
 
 #include "xls/passes/cse_pass.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -26,8 +28,11 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
@@ -234,5 +239,70 @@ TEST_F(CsePassTest, NonCommutativeOperands) {
   EXPECT_NE(f->return_value()->operand(0), f->return_value()->operand(1));
 }
 
+TEST_F(CsePassTest, ParallelHashingMatchesSerial) {
+  // Builds a function with redundant expressions several levels deep so that
+  // commoning a node changes the operands (and hashes) of later nodes.
+  auto build = [&](Package* p) -> absl::StatusOr<Function*> {
+    FunctionBuilder fb(TestName(), p);
+    Type* u32 = p->GetBitsType(32);
+    std::vector<BValue> values = {fb.Param("x", u32), fb.Param("y", u32)};
+    for (int64_t i = 0; i < 200; ++i) {
+      BValue a = values[values.size() - 1];
+      BValue b = values[values.size() - 1 - (i % 2)];
+      values.push_back(fb.Add(a, b));
+      values.push_back(fb.Add(b, a));
+      values.push_back(fb.Xor(values[values.size() - 1],
+                              values[values.size() - 2]));
+    }
+    return fb.BuildWithReturnValue(fb.Tuple(values));
+  };
+  auto serial_package = CreatePackage();
+  auto parallel_package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * serial, build(serial_package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * parallel, build(parallel_package.get()));
+
+  absl::flat_hash_map<Node*, Node*> serial_replacements;
+  absl::flat_hash_map<Node*, Node*> parallel_replacements;
+  EXPECT_THAT(RunCse(serial, &serial_replacements, /*threads=*/1),
+              IsOkAndHolds(true));
+  EXPECT_THAT(RunCse(parallel, &parallel_replacements, /*threads=*/4),
+              IsOkAndHolds(true));
+  EXPECT_EQ(serial->DumpIr(), parallel->DumpIr());
+  EXPECT_EQ(serial_replacements.size(), parallel_replacements.size());
+}
+
+TEST_F(CsePassTest, IncrementalCse) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  BValue x = fb.Param("x", u32);
+  BValue y = fb.Param("y", u32);
+  BValue add_xy = fb.Add(x, y);
+  BValue add_yx = fb.Add(y, x);
+  BValue neg_xy = fb.Negate(add_xy);
+  BValue neg_yx = fb.Negate(add_yx);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Tuple({neg_xy, neg_yx})));
+
+  absl::flat_hash_map<Node*, Node*> replacements;
+  EXPECT_THAT(RunIncrementalCse(f, &replacements), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Tuple(m::Neg(m::Add()), m::Neg(m::Add())));
+  EXPECT_EQ(f->return_value()->operand(0), f->return_value()->operand(1));
+  EXPECT_EQ(replacements.at(add_yx.node()), add_xy.node());
+  EXPECT_EQ(replacements.at(neg_yx.node()), neg_xy.node());
+
+  // Nothing changed since the last run.
+  EXPECT_THAT(RunIncrementalCse(f, nullptr), IsOkAndHolds(false));
+
+  // A new duplicate is found without revisiting the rest of the graph.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * another_add,
+      f->MakeNode<BinOp>(SourceInfo(), x.node(), y.node(), Op::kAdd));
+  XLS_ASSERT_OK(f->return_value()->ReplaceOperandNumber(1, another_add));
+  EXPECT_THAT(RunIncrementalCse(f, nullptr), IsOkAndHolds(true));
+  EXPECT_EQ(f->return_value()->operand(1), add_xy.node());
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,95 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/fifo_depth_pass.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/casts.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/optimization_pass_registry.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+
+namespace {
+
+// Sets the FIFO depth of `channel` from `options`. Returns whether the channel
+// changed.
+absl::StatusOr<bool> UpdateFifoDepth(Channel* channel,
+                                     const OptimizationPassOptions& options) {
+  auto it = options.fifo_depths.find(channel->name());
+  if (it == options.fifo_depths.end() ||
+      channel->kind() != ChannelKind::kStreaming) {
+    return false;
+  }
+  int64_t depth = it->second;
+  if (depth < 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "FIFO depth of channel %s must be non-negative, got %d",
+        channel->name(), depth));
+  }
+  StreamingChannel* streaming_channel = down_cast<StreamingChannel*>(channel);
+  const std::optional<FifoConfig>& config = streaming_channel->fifo_config();
+  if (!config.has_value() || config->depth() == depth) {
+    return false;
+  }
+  VLOG(2) << absl::StreamFormat("Setting FIFO depth of channel %s: %d -> %d",
+                                channel->name(), config->depth(), depth);
+  streaming_channel->fifo_config(
+      FifoConfig(depth, config->bypass(), config->register_push_outputs(),
+                 config->register_pop_outputs()));
+  return true;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> FifoDepthPass::RunInternal(
+    Package* p, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  if (options.fifo_depths.empty()) {
+    return false;
+  }
+  bool changed = false;
+  for (Channel* channel : p->channels()) {
+    XLS_ASSIGN_OR_RETURN(bool channel_changed,
+                         UpdateFifoDepth(channel, options));
+    changed |= channel_changed;
+  }
+  for (const std::unique_ptr<Proc>& proc : p->procs()) {
+    if (!proc->is_new_style_proc()) {
+      continue;
+    }
+    for (Channel* channel : proc->channels()) {
+      XLS_ASSIGN_OR_RETURN(bool channel_changed,
+                           UpdateFifoDepth(channel, options));
+      changed |= channel_changed;
+    }
+  }
+  return changed;
+}
+
+REGISTER_OPT_PASS(FifoDepthPass);
+
+}  // namespace xls
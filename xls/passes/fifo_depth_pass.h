@@ -0,0 +1,47 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_FIFO_DEPTH_PASS_H_
+#define XLS_PASSES_FIFO_DEPTH_PASS_H_
+
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+
+// Pass which sets the depth of the FIFOs of streaming channels to the values
+// given in OptimizationPassOptions::fifo_depths, e.g. the depths suggested by
+// eval_proc_main from the peak occupancy of each channel in simulation. The
+// other parameters of each FIFO are unchanged. Channels without a FIFO
+// configuration (e.g. I/O channels) and names which do not match a channel are
+// ignored.
+class FifoDepthPass : public OptimizationPass {
+ public:
+  static constexpr std::string_view kName = "fifo_depth";
+  FifoDepthPass() : OptimizationPass(kName, "Set FIFO depths") {}
+  ~FifoDepthPass() override = default;
+
+ protected:
+  absl::StatusOr<bool> RunInternal(Package* p,
+                                   const OptimizationPassOptions& options,
+                                   PassResults* results) const override;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_FIFO_DEPTH_PASS_H_
@@ -0,0 +1,120 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/fifo_depth_pass.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::Eq;
+using ::testing::HasSubstr;
+using ::testing::Optional;
+
+class FifoDepthPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(
+      Package* p, const absl::flat_hash_map<std::string, int64_t>& depths) {
+    PassResults results;
+    OptimizationPassOptions options;
+    options.fifo_depths = depths;
+    return FifoDepthPass().Run(p, options, &results);
+  }
+
+  absl::StatusOr<StreamingChannel*> CreateChannel(
+      Package* p, std::string_view name,
+      std::optional<FifoConfig> fifo_config) {
+    return p->CreateStreamingChannel(name, ChannelOps::kSendReceive,
+                                     p->GetBitsType(32),
+                                     /*initial_values=*/{}, fifo_config);
+  }
+};
+
+TEST_F(FifoDepthPassTest, SetsDepths) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      StreamingChannel * a,
+      CreateChannel(p.get(), "a",
+                    FifoConfig(/*depth=*/1, /*bypass=*/true,
+                               /*register_push_outputs=*/false,
+                               /*register_pop_outputs=*/true)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      StreamingChannel * b,
+      CreateChannel(p.get(), "b",
+                    FifoConfig(/*depth=*/4, /*bypass=*/false,
+                               /*register_push_outputs=*/false,
+                               /*register_pop_outputs=*/false)));
+  XLS_ASSERT_OK_AND_ASSIGN(StreamingChannel * io,
+                           CreateChannel(p.get(), "io", std::nullopt));
+
+  EXPECT_THAT(Run(p.get(), {{"a", 5}, {"b", 2}, {"io", 3}, {"gone", 7}}),
+              IsOkAndHolds(true));
+  EXPECT_THAT(a->fifo_config(),
+              Optional(Eq(FifoConfig(/*depth=*/5, /*bypass=*/true,
+                                     /*register_push_outputs=*/false,
+                                     /*register_pop_outputs=*/true))));
+  EXPECT_THAT(b->GetFifoDepth(), Optional(2));
+  // Channels without a FIFO are left alone.
+  EXPECT_EQ(io->fifo_config(), std::nullopt);
+
+  // Applying the same depths again is a no-op.
+  EXPECT_THAT(Run(p.get(), {{"a", 5}, {"b", 2}}), IsOkAndHolds(false));
+}
+
+TEST_F(FifoDepthPassTest, NoDepthsIsNoOp) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      StreamingChannel * a,
+      CreateChannel(p.get(), "a",
+                    FifoConfig(/*depth=*/1, /*bypass=*/false,
+                               /*register_push_outputs=*/false,
+                               /*register_pop_outputs=*/false)));
+  EXPECT_THAT(Run(p.get(), {}), IsOkAndHolds(false));
+  EXPECT_THAT(a->GetFifoDepth(), Optional(1));
+}
+
+TEST_F(FifoDepthPassTest, NegativeDepthIsAnError) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK(CreateChannel(p.get(), "a",
+                              FifoConfig(/*depth=*/1, /*bypass=*/false,
+                                         /*register_push_outputs=*/false,
+                                         /*register_pop_outputs=*/false))
+                    .status());
+  EXPECT_THAT(Run(p.get(), {{"a", -1}}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("must be non-negative")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,6 +14,7 @@
 
 #include "xls/passes/inlining_pass.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <optional>
 #include <string>
@@ -22,6 +23,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
@@ -95,10 +97,51 @@ static bool IsInlineable(const Invoke* invoke) {
   return !invoke->to_apply()->ForeignFunctionData().has_value();
 }
 
+// Returns the functions whose invokes are too costly to inline. Inlining a
+// function which is instantiated N times (counting each copy of its callers
+// which full inlining would create) duplicates its nodes N - 1 times. A
+// function is deferred if that number of duplicated nodes exceeds
+// `threshold`. A deferred function is instantiated once regardless of the
+// number of copies of its callers. The size of each function is estimated by
+// its node count before anything is inlined into it.
+absl::flat_hash_set<const Function*> GetDeferredFunctions(Package* p,
+                                                          int64_t threshold) {
+  // Saturate the instance counts rather than overflow; they grow exponentially
+  // with the depth of the call graph.
+  constexpr int64_t kMaxInstances = int64_t{1} << 40;
+  absl::flat_hash_set<const Function*> deferred;
+  absl::flat_hash_map<const FunctionBase*, int64_t> instances;
+  std::vector<FunctionBase*> post_order = FunctionsInPostOrder(p);
+  // Visit callers before callees so the instance count of a function is
+  // complete when it is visited.
+  for (auto it = post_order.rbegin(); it != post_order.rend(); ++it) {
+    FunctionBase* f = *it;
+    // Functions without (inlineable) callers are instantiated once.
+    int64_t f_instances = std::max(instances[f], int64_t{1});
+    if (f->IsFunction() && f_instances > 1 &&
+        static_cast<double>(f_instances - 1) *
+                static_cast<double>(f->node_count()) >
+            static_cast<double>(threshold)) {
+      deferred.insert(f->AsFunctionOrDie());
+      f_instances = 1;
+    }
+    for (Node* node : f->nodes()) {
+      if (node->Is<Invoke>() && IsInlineable(node->As<Invoke>())) {
+        int64_t& callee_instances = instances[node->As<Invoke>()->to_apply()];
+        callee_instances =
+            std::min(callee_instances + f_instances, kMaxInstances);
+      }
+    }
+  }
+  return deferred;
+}
+
 // Inlines the node "invoke" by replacing it with the contents of the called
-// function.
+// function. Invokes of functions in `deferred` are left in place.
 template <bool kCheckNoSubInvokes = true>
-absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
+absl::Status InlineInvoke(
+    Invoke* invoke, int inline_count,
+    const absl::flat_hash_set<const Function*>& deferred = {}) {
   Function* invoked = invoke->to_apply();
   absl::flat_hash_map<Node*, Node*> invoked_node_to_replacement;
   for (int64_t i = 0; i < invoked->params().size(); ++i) {
@@ -112,9 +155,12 @@ absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
       continue;
     }
     XLS_RET_CHECK(!kCheckNoSubInvokes ||
-                  // All invokes before us should've been inlined (except ffi)
-                  !node->Is<Invoke>() || !IsInlineable(node->As<Invoke>()))
-        << "No invokes that are not FFI should remain in function to inline: "
+                  // All invokes before us should've been inlined (except ffi
+                  // and deferred functions)
+                  !node->Is<Invoke>() || !IsInlineable(node->As<Invoke>()) ||
+                  deferred.contains(node->As<Invoke>()->to_apply()))
+        << "No invokes that are not FFI or deferred should remain in function "
+           "to inline: "
         << node->GetName() << ": " << node->As<Invoke>()->to_apply()->name();
     std::vector<Node*> new_operands;
     for (Node* operand : node->operands()) {
@@ -214,14 +260,25 @@ absl::StatusOr<bool> InliningPass::RunInternal(
   // post order of the call graph (leaves first). This ensures that when a
   // function Foo is inlined into its callsites, no invokes remain in Foo. This
   // avoid duplicate work.
+  //
+  // In cost-based mode the invokes of functions which are too costly to inline
+  // are left in place so the callee is optimized once rather than once per
+  // callsite.
+  absl::flat_hash_set<const Function*> deferred;
+  if (mode_ == Mode::kCostBased &&
+      options.inlining_cost_threshold.has_value()) {
+    deferred = GetDeferredFunctions(p, *options.inlining_cost_threshold);
+  }
   int inline_count = 0;
   for (FunctionBase* f : FunctionsInPostOrder(p)) {
     // Create copy of nodes() because we will be adding and removing nodes
     // during inlining.
     std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
     for (Node* node : nodes) {
-      if (node->Is<Invoke>() && IsInlineable(node->As<Invoke>())) {
-        XLS_RETURN_IF_ERROR(InlineInvoke(node->As<Invoke>(), inline_count++));
+      if (node->Is<Invoke>() && IsInlineable(node->As<Invoke>()) &&
+          !deferred.contains(node->As<Invoke>()->to_apply())) {
+        XLS_RETURN_IF_ERROR(
+            InlineInvoke(node->As<Invoke>(), inline_count++, deferred));
         changed = true;
       }
     }
@@ -29,7 +29,20 @@ namespace xls {
 class InliningPass : public OptimizationPass {
  public:
   static constexpr std::string_view kName = "inlining";
-  InliningPass() : OptimizationPass(kName, "Inlines invocations") {}
+
+  enum class Mode {
+    // Inline every invoke of a non-FFI function.
+    kFull,
+    // Leave the invokes of functions which are too costly to inline as
+    // determined by OptimizationPassOptions::inlining_cost_threshold. The
+    // callees are then optimized once on their own and should be inlined later
+    // by a kFull instance of the pass. Equivalent to kFull if no threshold is
+    // set.
+    kCostBased,
+  };
+
+  explicit InliningPass(Mode mode = Mode::kFull)
+      : OptimizationPass(kName, "Inlines invocations"), mode_(mode) {}
 
   // Inline a single invoke instruction. Provided for test and utility
   // (ir_minimizer) use.
@@ -41,6 +54,9 @@ class InliningPass : public OptimizationPass {
   absl::StatusOr<bool> RunInternal(Package* p,
                                    const OptimizationPassOptions& options,
                                    PassResults* results) const override;
+
+ private:
+  Mode mode_;
 };
 
 }  // namespace xls
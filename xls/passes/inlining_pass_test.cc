@@ -14,8 +14,11 @@
 
 #include "xls/passes/inlining_pass.h"
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -294,5 +297,71 @@ fn caller(the_token: token, x: bits[32]) -> (token, bits[32]) {
   }
 }
 
+// `big` is instantiated twice once `mid` is inlined into both of its callsites
+// in `caller`; `small` is instantiated once.
+constexpr std::string_view kSharedCalleeProgram = R"(
+package some_package
+
+fn big(x: bits[32], y: bits[32]) -> bits[32] {
+  add.1: bits[32] = add(x, y)
+  sub.2: bits[32] = sub(x, y)
+  and.3: bits[32] = and(add.1, sub.2)
+  ret or.4: bits[32] = or(and.3, x)
+}
+
+fn small(x: bits[32]) -> bits[32] {
+  ret neg.5: bits[32] = neg(x)
+}
+
+fn mid(x: bits[32]) -> bits[32] {
+  ret invoke.6: bits[32] = invoke(x, x, to_apply=big)
+}
+
+fn caller(x: bits[32], y: bits[32]) -> bits[32] {
+  invoke.7: bits[32] = invoke(x, to_apply=mid)
+  invoke.8: bits[32] = invoke(y, to_apply=mid)
+  invoke.9: bits[32] = invoke(invoke.8, to_apply=small)
+  ret add.10: bits[32] = add(invoke.7, invoke.9)
+}
+)";
+
+TEST_F(InliningPassTest, CostBasedDefersLargeSharedCallee) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(kSharedCalleeProgram));
+  OptimizationPassOptions options;
+  options.inlining_cost_threshold = 4;
+  PassResults results;
+  ASSERT_THAT(InliningPass(InliningPass::Mode::kCostBased)
+                  .Run(package.get(), options, &results),
+              IsOkAndHolds(true));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * caller, package->GetFunction("caller"));
+  EXPECT_THAT(caller->return_value(),
+              m::Add(m::Invoke(m::Param("x"), m::Param("x")),
+                     m::Neg(m::Invoke(m::Param("y"), m::Param("y")))));
+
+  // A full inlining pass inlines the deferred function.
+  ASSERT_THAT(InliningPass().Run(package.get(), options, &results),
+              IsOkAndHolds(true));
+  EXPECT_THAT(caller->return_value(),
+              m::Add(m::Or(m::And(), m::Param("x")),
+                     m::Neg(m::Or(m::And(), m::Param("y")))));
+}
+
+TEST_F(InliningPassTest, CostBasedInlinesCalleesWithinThreshold) {
+  PassResults results;
+  for (std::optional<int64_t> threshold :
+       {std::optional<int64_t>(), std::optional<int64_t>(1000)}) {
+    XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(kSharedCalleeProgram));
+    OptimizationPassOptions options;
+    options.inlining_cost_threshold = threshold;
+    ASSERT_THAT(InliningPass(InliningPass::Mode::kCostBased)
+                    .Run(p.get(), options, &results),
+                IsOkAndHolds(true));
+    XLS_ASSERT_OK_AND_ASSIGN(Function * caller, p->GetFunction("caller"));
+    for (Node* node : caller->nodes()) {
+      EXPECT_FALSE(node->Is<Invoke>()) << node->ToString();
+    }
+  }
+}
+
 }  // namespace
 }  // namespace xls
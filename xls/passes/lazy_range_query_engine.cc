@@ -0,0 +1,49 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/passes/lazy_range_query_engine.h"
+
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/range_query_engine.h"
+
+namespace xls {
+
+absl::StatusOr<ReachedFixpoint> LazyRangeQueryEngine::Populate(
+    FunctionBase* f) {
+  function_ = f;
+  ranges_ = RangeQueryEngine(ranges_.max_interval_set_size());
+  // Nothing is computed until queried so whether anything was learned is not
+  // known here.
+  return ReachedFixpoint::Unknown;
+}
+
+void LazyRangeQueryEngine::EnsurePopulated(Node* node) const {
+  CHECK(IsTracked(node)) << node << " is not in the populated function";
+  CHECK_OK(ranges_.PopulateNode(node));
+}
+
+void LazyRangeQueryEngine::EnsurePopulated(
+    absl::Span<TreeBitLocation const> bits) const {
+  for (const TreeBitLocation& location : bits) {
+    EnsurePopulated(location.node());
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,144 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_PASSES_LAZY_RANGE_QUERY_ENGINE_H_
+#define XLS_PASSES_LAZY_RANGE_QUERY_ENGINE_H_
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/leaf_type_tree.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/interval_set.h"
+#include "xls/ir/node.h"
+#include "xls/ir/ternary.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/range_query_engine.h"
+
+namespace xls {
+
+// A range query engine which computes interval sets on demand. Populate only
+// records the function; the first query about a node computes (and memoizes)
+// the ranges of that node and of its not-yet-analyzed transitive operands.
+// Passes which only query a small fraction of a large function therefore avoid
+// paying for the analysis of the whole graph, as RangeQueryEngine::Populate
+// does.
+//
+// Interval sets are widened to at most `max_interval_set_size` intervals (see
+// RangeQueryEngine) so the cost of each node stays bounded on deep arithmetic
+// chains. The results for a queried node are the same as RangeQueryEngine with
+// the same widening limit would produce.
+//
+// Like the other engines the memoized information is not invalidated when the
+// function is modified; call Populate again to start over.
+class LazyRangeQueryEngine final : public QueryEngine {
+ public:
+  static constexpr int64_t kDefaultMaxIntervalSetSize = 16;
+
+  explicit LazyRangeQueryEngine(
+      std::optional<int64_t> max_interval_set_size = kDefaultMaxIntervalSetSize)
+      : ranges_(max_interval_set_size) {}
+
+  absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
+
+  bool IsTracked(Node* node) const override {
+    return function_ != nullptr && node->function_base() == function_;
+  }
+
+  LeafTypeTree<TernaryVector> GetTernary(Node* node) const override {
+    EnsurePopulated(node);
+    return ranges_.GetTernary(node);
+  }
+
+  TernaryVector GetTernaryElement(
+      Node* node, absl::Span<const int64_t> index = {}) const override {
+    EnsurePopulated(node);
+    return ranges_.GetTernaryElement(node, index);
+  }
+
+  LeafTypeTree<IntervalSet> GetIntervals(Node* node) const override {
+    EnsurePopulated(node);
+    return ranges_.GetIntervals(node);
+  }
+
+  SharedLeafTypeTree<IntervalSet> GetIntervalsShared(
+      Node* node) const override {
+    EnsurePopulated(node);
+    return ranges_.GetIntervalsShared(node);
+  }
+
+  IntervalSet GetIntervalsElement(
+      Node* node, absl::Span<const int64_t> index = {}) const override {
+    EnsurePopulated(node);
+    return ranges_.GetIntervalsElement(node, index);
+  }
+
+  bool AtMostOneTrue(absl::Span<TreeBitLocation const> bits) const override {
+    EnsurePopulated(bits);
+    return ranges_.AtMostOneTrue(bits);
+  }
+
+  bool AtLeastOneTrue(absl::Span<TreeBitLocation const> bits) const override {
+    EnsurePopulated(bits);
+    return ranges_.AtLeastOneTrue(bits);
+  }
+
+  bool KnownEquals(const TreeBitLocation& a,
+                   const TreeBitLocation& b) const override {
+    EnsurePopulated({a, b});
+    return ranges_.KnownEquals(a, b);
+  }
+
+  bool KnownNotEquals(const TreeBitLocation& a,
+                      const TreeBitLocation& b) const override {
+    EnsurePopulated({a, b});
+    return ranges_.KnownNotEquals(a, b);
+  }
+
+  bool Implies(const TreeBitLocation& a,
+               const TreeBitLocation& b) const override {
+    return false;
+  }
+
+  std::optional<Bits> ImpliedNodeValue(
+      absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+      Node* node) const override {
+    return std::nullopt;
+  }
+
+  std::optional<TernaryVector> ImpliedNodeTernary(
+      absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+      Node* node) const override {
+    return std::nullopt;
+  }
+
+  // Returns true if the ranges of `node` have already been computed.
+  bool IsAnalyzed(Node* node) const { return ranges_.IsTracked(node); }
+
+ private:
+  void EnsurePopulated(Node* node) const;
+  void EnsurePopulated(absl::Span<TreeBitLocation const> bits) const;
+
+  FunctionBase* function_ = nullptr;
+  mutable RangeQueryEngine ranges_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_LAZY_RANGE_QUERY_ENGINE_H_
@@ -0,0 +1,174 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/passes/lazy_range_query_engine.h"
+
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "include/benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "xls/common/status/matchers.h"
+#include "xls/examples/sample_packages.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/interval.h"
+#include "xls/ir/interval_set.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/passes/range_query_engine.h"
+
+namespace xls {
+namespace {
+
+class LazyRangeQueryEngineTest : public IrTestBase {};
+
+TEST_F(LazyRangeQueryEngineTest, OnlyAnalyzesQueriedCone) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue small = fb.ZeroExtend(fb.BitSlice(x, 0, 4), 8);
+  BValue sum = fb.Add(small, fb.Literal(UBits(1, 8)));
+  BValue other = fb.UMul(y, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Tuple({sum, other})));
+
+  LazyRangeQueryEngine engine;
+  XLS_ASSERT_OK(engine.Populate(f));
+  EXPECT_TRUE(engine.IsTracked(sum.node()));
+  EXPECT_FALSE(engine.IsAnalyzed(sum.node()));
+
+  IntervalSet expected(8);
+  expected.AddInterval(Interval(UBits(1, 8), UBits(16, 8)));
+  expected.Normalize();
+  EXPECT_EQ(engine.GetIntervals(sum.node()).Get({}), expected);
+  EXPECT_TRUE(engine.IsAnalyzed(sum.node()));
+  EXPECT_TRUE(engine.IsAnalyzed(small.node()));
+  EXPECT_TRUE(engine.IsAnalyzed(x.node()));
+  EXPECT_FALSE(engine.IsAnalyzed(y.node()));
+  EXPECT_FALSE(engine.IsAnalyzed(other.node()));
+  EXPECT_FALSE(engine.IsAnalyzed(f->return_value()));
+}
+
+TEST_F(LazyRangeQueryEngineTest, WideningProducesConvexHull) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue s = fb.Param("s", p->GetBitsType(2));
+  BValue sel = fb.Select(s, {fb.Literal(UBits(1, 8)), fb.Literal(UBits(5, 8)),
+                             fb.Literal(UBits(9, 8))},
+                         /*default_value=*/fb.Literal(UBits(9, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  LazyRangeQueryEngine precise(/*max_interval_set_size=*/std::nullopt);
+  XLS_ASSERT_OK(precise.Populate(f));
+  EXPECT_EQ(precise.GetIntervals(sel.node()).Get({}).NumberOfIntervals(), 3);
+
+  LazyRangeQueryEngine hull(/*max_interval_set_size=*/1);
+  XLS_ASSERT_OK(hull.Populate(f));
+  IntervalSet expected(8);
+  expected.AddInterval(Interval(UBits(1, 8), UBits(9, 8)));
+  expected.Normalize();
+  EXPECT_EQ(hull.GetIntervals(sel.node()).Get({}), expected);
+}
+
+TEST_F(LazyRangeQueryEngineTest, MatchesEagerEngine) {
+  for (std::string_view benchmark :
+       {"examples/crc32/crc32", "examples/sha256"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<Package> p,
+        sample_packages::GetBenchmark(benchmark, /*optimized=*/true));
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetTopAsFunction());
+
+    RangeQueryEngine eager(LazyRangeQueryEngine::kDefaultMaxIntervalSetSize);
+    XLS_ASSERT_OK(eager.Populate(f));
+    LazyRangeQueryEngine lazy;
+    XLS_ASSERT_OK(lazy.Populate(f));
+    // Query in reverse topological order so most nodes are computed as part of
+    // the cone of an earlier query.
+    for (Node* node : ReverseTopoSort(f)) {
+      EXPECT_EQ(lazy.GetIntervals(node), eager.GetIntervals(node))
+          << benchmark << ": " << node;
+    }
+  }
+}
+
+// Loads the optimized `benchmark` sample package.
+Function* GetBenchmarkFunction(std::string_view benchmark,
+                               std::unique_ptr<Package>& package) {
+  package =
+      sample_packages::GetBenchmark(benchmark, /*optimized=*/true).value();
+  return package->GetTopAsFunction().value();
+}
+
+// Computes the ranges of only the return value, as a pass which inspects a
+// handful of nodes would.
+template <typename Engine>
+void ReturnValueRange(benchmark::State& state, std::string_view benchmark) {
+  std::unique_ptr<Package> package;
+  Function* f = GetBenchmarkFunction(benchmark, package);
+  for (auto _ : state) {
+    Engine engine(LazyRangeQueryEngine::kDefaultMaxIntervalSetSize);
+    CHECK_OK(engine.Populate(f));
+    benchmark::DoNotOptimize(engine.GetIntervals(f->return_value()));
+  }
+}
+
+// Computes the ranges of every node.
+template <typename Engine>
+void AllNodeRanges(benchmark::State& state, std::string_view benchmark) {
+  std::unique_ptr<Package> package;
+  Function* f = GetBenchmarkFunction(benchmark, package);
+  for (auto _ : state) {
+    Engine engine(LazyRangeQueryEngine::kDefaultMaxIntervalSetSize);
+    CHECK_OK(engine.Populate(f));
+    for (Node* node : f->nodes()) {
+      benchmark::DoNotOptimize(engine.GetIntervals(node));
+    }
+  }
+}
+
+void BM_EagerReturnValueRange(benchmark::State& state,
+                              std::string_view benchmark) {
+  ReturnValueRange<RangeQueryEngine>(state, benchmark);
+}
+void BM_LazyReturnValueRange(benchmark::State& state,
+                             std::string_view benchmark) {
+  ReturnValueRange<LazyRangeQueryEngine>(state, benchmark);
+}
+void BM_EagerAllNodeRanges(benchmark::State& state,
+                           std::string_view benchmark) {
+  AllNodeRanges<RangeQueryEngine>(state, benchmark);
+}
+void BM_LazyAllNodeRanges(benchmark::State& state,
+                          std::string_view benchmark) {
+  AllNodeRanges<LazyRangeQueryEngine>(state, benchmark);
+}
+
+BENCHMARK_CAPTURE(BM_EagerReturnValueRange, crc32, "examples/crc32/crc32");
+BENCHMARK_CAPTURE(BM_LazyReturnValueRange, crc32, "examples/crc32/crc32");
+BENCHMARK_CAPTURE(BM_EagerReturnValueRange, sha256, "examples/sha256");
+BENCHMARK_CAPTURE(BM_LazyReturnValueRange, sha256, "examples/sha256");
+BENCHMARK_CAPTURE(BM_EagerAllNodeRanges, sha256, "examples/sha256");
+BENCHMARK_CAPTURE(BM_LazyAllNodeRanges, sha256, "examples/sha256");
+
+}  // namespace
+}  // namespace xls
@@ -65,6 +65,7 @@
 #include "xls/passes/predicate_dominator_analysis.h"
 #include "xls/passes/predicate_state.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/range_query_engine.h"
 #include "xls/passes/stateless_query_engine.h"
 #include "xls/passes/ternary_query_engine.h"
@@ -204,7 +205,8 @@ class NarrowVisitor final : public DfsVisitorWithDefault {
       Node* to_replace, const QueryEngine& query_engine,
       const std::function<absl::Status(const Value&)>& replace_with,
       std::string_view context) {
-    LeafTypeTree<TernaryVector> ternary = query_engine.GetTernary(to_replace);
+    SharedLeafTypeTree<TernaryVector> ternary =
+        query_engine.GetTernaryShared(to_replace);
     for (Type* leaf_type : ternary.leaf_types()) {
       if (leaf_type->IsToken()) {
         XLS_RETURN_IF_ERROR(NoChange());
@@ -1420,12 +1422,12 @@ class NarrowVisitor final : public DfsVisitorWithDefault {
       const QueryEngine& array_engine =
           specialized_query_engine_.ForNode(array_index);
       if (analysis_ != AnalysisType::kRangeWithContext) {
-        return array_engine.GetIntervals(value).Get({});
+        return array_engine.GetIntervalsElement(value);
       }
       const QueryEngine& value_engine =
           specialized_query_engine_.ForNode(value);
-      return IntervalSet::Intersect(value_engine.GetIntervals(value).Get({}),
-                                    array_engine.GetIntervals(value).Get({}));
+      return IntervalSet::Intersect(value_engine.GetIntervalsElement(value),
+                                    array_engine.GetIntervalsElement(value));
     };
     {
       ArrayType* array_type = array_index->array()->GetType()->AsArrayOrDie();
@@ -1655,7 +1657,7 @@ static void RangeAnalysisLog(FunctionBase* f,
   StatelessQueryEngine stateless_query_engine;
   for (Node* node : f->nodes()) {
     if (node->GetType()->IsBits()) {
-      IntervalSet intervals = range_query_engine.GetIntervals(node).Get({});
+      IntervalSet intervals = range_query_engine.GetIntervalsElement(node);
       int64_t current_size = node->BitCountOrDie();
       Bits compressed_total(current_size + 1);
       for (const Interval& interval : intervals.Intervals()) {
@@ -1684,8 +1686,7 @@ static void RangeAnalysisLog(FunctionBase* f,
         if (!operand->GetType()->IsBits()) {
           break;
         }
-        IntervalSet intervals =
-            range_query_engine.GetIntervals(operand).Get({});
+        IntervalSet intervals = range_query_engine.GetIntervalsElement(operand);
         intervals.Normalize();
         if (!intervals.IsMaximal()) {
           inputs_all_maximal = false;
@@ -1693,7 +1694,7 @@ static void RangeAnalysisLog(FunctionBase* f,
         }
       }
       if (!inputs_all_maximal &&
-          range_query_engine.GetIntervals(node).Get({}).IsMaximal()) {
+          range_query_engine.GetIntervalsElement(node).IsMaximal()) {
         VLOG(3) << "narrowing_pass: range analysis lost precision for " << node
                 << "\n";
       }
@@ -1701,9 +1702,8 @@ static void RangeAnalysisLog(FunctionBase* f,
       if (ternary_query_engine.IsTracked(node) &&
           range_query_engine.IsTracked(node)) {
         TernaryVector ternary_result =
-            ternary_query_engine.GetTernary(node).Get({});
-        TernaryVector range_result =
-            range_query_engine.GetTernary(node).Get({});
+            ternary_query_engine.GetTernaryElement(node);
+        TernaryVector range_result = range_query_engine.GetTernaryElement(node);
         std::optional<TernaryVector> difference =
             ternary_ops::Difference(range_result, ternary_result);
         CHECK(difference.has_value())
@@ -1719,8 +1719,36 @@ static void RangeAnalysisLog(FunctionBase* f,
   }
 }
 
+// Returns a query engine for `analysis` built from the engines in `cache`. The
+// context-sensitive range analysis is not cached.
+static absl::StatusOr<std::unique_ptr<QueryEngine>> GetCachedQueryEngine(
+    FunctionBase* f, AnalysisType analysis, QueryEngineCache& cache) {
+  std::vector<QueryEngine*> cached_engines;
+  XLS_ASSIGN_OR_RETURN(TernaryQueryEngine * ternary_query_engine,
+                       cache.GetTernaryQueryEngine(f));
+  cached_engines.push_back(ternary_query_engine);
+  if (analysis == AnalysisType::kRange) {
+    XLS_ASSIGN_OR_RETURN(RangeQueryEngine * range_query_engine,
+                         cache.GetRangeQueryEngine(f));
+    if (VLOG_IS_ON(3)) {
+      RangeAnalysisLog(f, *ternary_query_engine, *range_query_engine);
+    }
+    cached_engines.push_back(range_query_engine);
+  }
+
+  // The cached engines are already populated so the union is not populated.
+  std::vector<std::unique_ptr<QueryEngine>> engines;
+  engines.push_back(std::make_unique<StatelessQueryEngine>());
+  engines.push_back(
+      std::make_unique<UnownedUnionQueryEngine>(std::move(cached_engines)));
+  return std::make_unique<UnionQueryEngine>(std::move(engines));
+}
+
 static absl::StatusOr<std::unique_ptr<QueryEngine>> GetQueryEngine(
-    FunctionBase* f, AnalysisType analysis) {
+    FunctionBase* f, AnalysisType analysis, QueryEngineCache* cache) {
+  if (cache != nullptr && analysis != AnalysisType::kRangeWithContext) {
+    return GetCachedQueryEngine(f, analysis, *cache);
+  }
   std::unique_ptr<QueryEngine> query_engine;
   if (analysis == AnalysisType::kRangeWithContext) {
     auto ternary_query_engine = std::make_unique<TernaryQueryEngine>();
@@ -1763,7 +1791,8 @@ absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<QueryEngine> query_engine,
-                       GetQueryEngine(f, RealAnalysis(options)));
+                       GetQueryEngine(f, RealAnalysis(options),
+                                      options.query_engine_cache));
 
   PredicateDominatorAnalysis pda = PredicateDominatorAnalysis::Run(f);
   SpecializedQueryEngines sqe(RealAnalysis(options), pda, *query_engine);
@@ -14,10 +14,13 @@
 
 #include "xls/passes/node_dependency_analysis.h"
 
+#include <algorithm>
 #include <cstdint>
-#include <tuple>
+#include <memory>
 #include <utility>
+#include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
@@ -26,87 +29,164 @@
 #include "xls/data_structures/inline_bitmap.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
-#include "xls/ir/topo_sort.h"
 
 namespace xls {
 
-namespace {
-
-// Perform actual analysis.
-// f is the function to analyze. We only care about getting results for
-// 'interesting_nodes' if the set is non-empty (otherwise all nodes are
-// searched). Preds returns the nodes the argument depends on. iter is the
-// iterator to walk the function in the topological order defined by preds.
-template <typename Predecessors>
-std::tuple<absl::flat_hash_map<Node*, InlineBitmap>,
-           absl::flat_hash_map<Node*, int64_t>>
-AnalyzeDependents(FunctionBase* f,
-                  const absl::flat_hash_set<Node*>& interesting_nodes,
-                  Predecessors preds, absl::Span<Node* const> topo_sort) {
-  absl::flat_hash_map<Node*, int64_t> node_ids;
-  node_ids.reserve(f->node_count());
-  int64_t cnt = 0;
-  for (Node* n : f->nodes()) {
-    node_ids[n] = cnt++;
+NodeDependencyAnalysis::NodeDependencyAnalysis(
+    bool is_forwards, FunctionBase* fb,
+    absl::Span<Node* const> interesting_nodes)
+    : is_forward_(is_forwards),
+      interesting_nodes_(interesting_nodes.begin(), interesting_nodes.end()) {
+  std::vector<Node*> nodes;
+  nodes.reserve(fb->node_count());
+  node_indices_.reserve(fb->node_count());
+  for (Node* n : fb->nodes()) {
+    node_indices_[n] = nodes.size();
+    nodes.push_back(n);
   }
-  auto is_interesting = [&](Node* n) {
-    return interesting_nodes.empty() || interesting_nodes.contains(n);
-  };
-  int64_t seen_interesting_nodes_count = 0;
-  auto is_last_interesting_node = [&](Node* node) {
-    if (interesting_nodes.empty()) {
-      return false;
-    }
-    if (interesting_nodes.contains(node)) {
-      ++seen_interesting_nodes_count;
-    }
-    return seen_interesting_nodes_count == interesting_nodes.size();
-  };
-  int64_t bitmap_size = f->node_count();
-  absl::flat_hash_map<Node*, InlineBitmap> results;
-  results.reserve(f->node_count());
-  for (Node* n : topo_sort) {
-    InlineBitmap& bm = results.emplace(n, bitmap_size).first->second;
-    bm.Set(node_ids[n]);
-    for (Node* pred : preds(n)) {
-      bm.Union(results.at(pred));
+  edges_.resize(nodes.size());
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    absl::Span<Node* const> next =
+        is_forward_ ? nodes[i]->users() : nodes[i]->operands();
+    edges_[i].reserve(next.size());
+    for (Node* n : next) {
+      edges_[i].push_back(node_indices_.at(n));
     }
-    if (is_last_interesting_node(n)) {
-      break;
+  }
+
+  // GRAIL-style interval labeling: each labeling is a post-order traversal of
+  // the DAG, with nodes and edges visited in a different order per labeling to
+  // make false positives of one labeling unlikely to be repeated by another.
+  labels_.resize(nodes.size());
+  for (int64_t labeling = 0; labeling < kLabelings; ++labeling) {
+    const bool reversed = labeling % 2 == 1;
+    auto child = [&](int64_t node, int64_t i) {
+      return reversed ? edges_[node][edges_[node].size() - 1 - i]
+                      : edges_[node][i];
+    };
+    std::vector<bool> visited(nodes.size(), false);
+    // The nodes being visited and the number of their children visited.
+    std::vector<std::pair<int64_t, int64_t>> stack;
+    int64_t rank = 0;
+    for (int64_t r = 0; r < nodes.size(); ++r) {
+      int64_t root = reversed ? nodes.size() - 1 - r : r;
+      if (visited[root]) {
+        continue;
+      }
+      visited[root] = true;
+      stack.push_back({root, 0});
+      while (!stack.empty()) {
+        auto& [node, next_child] = stack.back();
+        if (next_child < edges_[node].size()) {
+          int64_t c = child(node, next_child++);
+          if (!visited[c]) {
+            visited[c] = true;
+            stack.push_back({c, 0});
+          }
+          continue;
+        }
+        Interval& label = labels_[node][labeling];
+        label.rank = rank++;
+        label.low = label.rank;
+        for (int64_t c : edges_[node]) {
+          label.low = std::min(label.low, labels_[c][labeling].low);
+        }
+        stack.pop_back();
+      }
     }
   }
-  // To avoid any bugs delete everything that's not specifically requested.
-  absl::erase_if(results,
-                 [&](auto& pair) { return !is_interesting(pair.first); });
-  return {results, node_ids};
 }
 
-}  // namespace
+bool NodeDependencyAnalysis::MayReach(int64_t from, int64_t to) const {
+  for (int64_t labeling = 0; labeling < kLabelings; ++labeling) {
+    const Interval& outer = labels_[from][labeling];
+    const Interval& inner = labels_[to][labeling];
+    if (inner.low < outer.low || inner.rank > outer.rank) {
+      return false;
+    }
+  }
+  return true;
+}
 
 absl::StatusOr<DependencyBitmap> NodeDependencyAnalysis::GetDependents(
     Node* node) const {
   if (!IsAnalyzed(node)) {
     return absl::InvalidArgumentError("Node is not analyzed");
   }
-  return DependencyBitmap(dependents_.at(node), node_indices_);
+  auto it = bitmap_cache_.find(node);
+  if (it != bitmap_cache_.end()) {
+    it->second.last_use = cache_clock_++;
+    return DependencyBitmap(it->second.bitmap, node_indices_);
+  }
+
+  auto bitmap = std::make_shared<InlineBitmap>(edges_.size());
+  std::vector<int64_t> worklist = {node_indices_.at(node)};
+  bitmap->Set(worklist.front());
+  while (!worklist.empty()) {
+    int64_t current = worklist.back();
+    worklist.pop_back();
+    for (int64_t next : edges_[current]) {
+      if (!bitmap->Get(next)) {
+        bitmap->Set(next);
+        worklist.push_back(next);
+      }
+    }
+  }
+
+  if (bitmap_cache_.size() >= kMaxCachedBitmaps) {
+    bitmap_cache_.erase(absl::c_min_element(
+        bitmap_cache_, [](const auto& a, const auto& b) {
+          return a.second.last_use < b.second.last_use;
+        }));
+  }
+  bitmap_cache_[node] = CachedBitmap{.bitmap = bitmap,
+                                     .last_use = cache_clock_++};
+  return DependencyBitmap(std::move(bitmap), node_indices_);
+}
+
+absl::StatusOr<bool> NodeDependencyAnalysis::IsDependent(Node* from,
+                                                         Node* to) const {
+  if (!IsAnalyzed(from)) {
+    return absl::InvalidArgumentError("Node is not analyzed");
+  }
+  if (!node_indices_.contains(to)) {
+    return absl::InvalidArgumentError("node is from a different function!");
+  }
+  int64_t source = node_indices_.at(from);
+  int64_t target = node_indices_.at(to);
+  if (source == target) {
+    return true;
+  }
+  if (!MayReach(source, target)) {
+    return false;
+  }
+  // The labels can't rule it out; search, only entering nodes whose labels
+  // might reach the target.
+  std::vector<int64_t> worklist = {source};
+  absl::flat_hash_set<int64_t> visited = {source};
+  while (!worklist.empty()) {
+    int64_t current = worklist.back();
+    worklist.pop_back();
+    for (int64_t next : edges_[current]) {
+      if (next == target) {
+        return true;
+      }
+      if (MayReach(next, target) && visited.insert(next).second) {
+        worklist.push_back(next);
+      }
+    }
+  }
+  return false;
 }
 
 NodeDependencyAnalysis NodeDependencyAnalysis::BackwardDependents(
     FunctionBase* fb, absl::Span<Node* const> nodes) {
-  absl::flat_hash_set<Node*> interesting(nodes.begin(), nodes.end());
-  auto [dependents, node_ids] = AnalyzeDependents(
-      fb, interesting, [](Node* node) { return node->operands(); },
-      TopoSort(fb));
-  return NodeDependencyAnalysis(/*is_forwards=*/false, dependents, node_ids);
+  return NodeDependencyAnalysis(/*is_forwards=*/false, fb, nodes);
 }
 
 NodeDependencyAnalysis NodeDependencyAnalysis::ForwardDependents(
     FunctionBase* fb, absl::Span<Node* const> nodes) {
-  absl::flat_hash_set<Node*> interesting(nodes.begin(), nodes.end());
-  auto [dependents, node_ids] = AnalyzeDependents(
-      fb, interesting, [](Node* node) { return node->users(); },
-      ReverseTopoSort(fb));
-  return NodeDependencyAnalysis(/*is_forwards=*/true, dependents, node_ids);
+  return NodeDependencyAnalysis(/*is_forwards=*/true, fb, nodes);
 }
 
 }  // namespace xls
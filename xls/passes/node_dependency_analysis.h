@@ -15,15 +15,18 @@
 #ifndef XLS_PASSES_NODE_DEPENDENCY_ANALYSIS_H_
 #define XLS_PASSES_NODE_DEPENDENCY_ANALYSIS_H_
 
+#include <array>
 #include <cstdint>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/base/attributes.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
-#include "xls/common/status/status_macros.h"
 #include "xls/data_structures/inline_bitmap.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
@@ -35,11 +38,11 @@ class DependencyBitmap {
  public:
   DependencyBitmap(const DependencyBitmap&) = default;
   DependencyBitmap(DependencyBitmap&&) = default;
-  // Deleted because bitmap_ is const reference.
+  // Deleted because node_indices_ is const reference.
   DependencyBitmap& operator=(const DependencyBitmap&) = delete;
   DependencyBitmap& operator=(DependencyBitmap&&) = delete;
 
-  const InlineBitmap& bitmap() const { return bitmap_; }
+  const InlineBitmap& bitmap() const { return *bitmap_; }
   const absl::flat_hash_map<Node*, int64_t>& node_indices() const {
     return node_indices_;
   }
@@ -47,23 +50,36 @@ class DependencyBitmap {
     if (!node_indices_.contains(n)) {
       return absl::InvalidArgumentError("node is from a different function!");
     }
-    return bitmap_.Get(node_indices_.at(n));
+    return bitmap_->Get(node_indices_.at(n));
   }
 
  private:
-  DependencyBitmap(const InlineBitmap& bitmap ABSL_ATTRIBUTE_LIFETIME_BOUND,
+  DependencyBitmap(std::shared_ptr<const InlineBitmap> bitmap,
                    const absl::flat_hash_map<Node*, int64_t>& node_indices
                        ABSL_ATTRIBUTE_LIFETIME_BOUND)
-      : bitmap_(bitmap), node_indices_(node_indices) {}
-  const InlineBitmap& bitmap_;
+      : bitmap_(std::move(bitmap)), node_indices_(node_indices) {}
+  // Shared with the analysis' cache so the bitmap stays valid if the analysis
+  // evicts it.
+  std::shared_ptr<const InlineBitmap> bitmap_;
   const absl::flat_hash_map<Node*, int64_t>& node_indices_;
   friend class NodeDependencyAnalysis;
 };
 
 // Analysis which lets us check whether different nodes are connected or over a
 // horizon from each other.
+//
+// Construction only records the dependency graph and a reachability index, in
+// O(nodes + edges) space. IsDependent queries use the index and never build a
+// bitmap. Bitmaps from GetDependents are computed on demand, and only the
+// most recently used kMaxCachedBitmaps of them are kept by the analysis.
+//
+// Queries are const but update that cache, so an analysis must not be queried
+// from multiple threads at once.
 class NodeDependencyAnalysis {
  public:
+  // The number of dependency bitmaps kept by the analysis.
+  static constexpr int64_t kMaxCachedBitmaps = 64;
+
   NodeDependencyAnalysis(NodeDependencyAnalysis&&) = default;
   NodeDependencyAnalysis(const NodeDependencyAnalysis&) = default;
   NodeDependencyAnalysis& operator=(NodeDependencyAnalysis&&) = default;
@@ -91,32 +107,54 @@ class NodeDependencyAnalysis {
 
   // Returns if the dependents are analyzed for this node. If this returns false
   // other calls will return error.
-  bool IsAnalyzed(Node* node) const { return dependents_.contains(node); }
+  bool IsAnalyzed(Node* node) const {
+    return interesting_nodes_.empty() ? node_indices_.contains(node)
+                                      : interesting_nodes_.contains(node);
+  }
 
-  // Get the bitmap for Node->GetId() -> bool for dependents of 'node'. Return
-  // is owned by the NodeDependencyAnalysis object.
+  // Get the bitmap for Node->GetId() -> bool for dependents of 'node'. The
+  // bitmap is shared with the analysis; the node indices are owned by the
+  // NodeDependencyAnalysis object.
   absl::StatusOr<DependencyBitmap> GetDependents(Node* node) const;
 
   // Return if 'to' is a dependent of 'from'
-  absl::StatusOr<bool> IsDependent(Node* from, Node* to) const {
-    XLS_ASSIGN_OR_RETURN(auto bitmap, GetDependents(from));
-    return bitmap.IsDependent(to);
-  }
+  absl::StatusOr<bool> IsDependent(Node* from, Node* to) const;
+
   const absl::flat_hash_map<Node*, int64_t>& node_indices() const {
     return node_indices_;
   }
 
  private:
-  NodeDependencyAnalysis(bool is_forwards,
-                         absl::flat_hash_map<Node*, InlineBitmap> dependents,
-                         absl::flat_hash_map<Node*, int64_t> node_ids)
-      : is_forward_(is_forwards),
-        dependents_(std::move(dependents)),
-        node_indices_(std::move(node_ids)) {}
+  // The number of independent interval labelings of the graph.
+  static constexpr int64_t kLabelings = 2;
+
+  // A post-order interval label. If 'a' reaches 'b' then b's interval is
+  // contained in a's for every labeling; the converse does not hold.
+  struct Interval {
+    int64_t low;
+    int64_t rank;
+  };
+
+  struct CachedBitmap {
+    std::shared_ptr<const InlineBitmap> bitmap;
+    int64_t last_use;
+  };
+
+  NodeDependencyAnalysis(bool is_forwards, FunctionBase* fb,
+                         absl::Span<Node* const> interesting_nodes);
+
+  // Returns false if 'to' is definitely not reachable from 'from'.
+  bool MayReach(int64_t from, int64_t to) const;
 
   bool is_forward_;
-  absl::flat_hash_map<Node*, InlineBitmap> dependents_;
   absl::flat_hash_map<Node*, int64_t> node_indices_;
+  absl::flat_hash_set<Node*> interesting_nodes_;
+  // For each node index, the indices of the nodes directly dependent on it.
+  std::vector<std::vector<int64_t>> edges_;
+  std::vector<std::array<Interval, kLabelings>> labels_;
+
+  mutable absl::flat_hash_map<Node*, CachedBitmap> bitmap_cache_;
+  mutable int64_t cache_clock_ = 0;
 };
 
 }  // namespace xls
@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
@@ -294,6 +295,53 @@ TEST_F(NodeDependencyAnalysisTest, WorksWithNodeIdGaps) {
               testing::Not(status_testing::IsOk()));
 }
 
+TEST_F(NodeDependencyAnalysisTest, IsDependentMatchesBitmaps) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  // A mesh of adds where node i reads node i-1 and some earlier node, so that
+  // the reachability labels see plenty of shared descendants.
+  std::vector<BValue> values = {fb.Param("x", p->GetBitsType(8)),
+                                fb.Param("y", p->GetBitsType(8))};
+  for (int64_t i = 2; i < 40; ++i) {
+    values.push_back(fb.Add(values[i - 1], values[(i * 7) % (i - 1)]));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(auto* f, fb.Build());
+  for (bool forward : {true, false}) {
+    NodeDependencyAnalysis nda(
+        forward ? NodeDependencyAnalysis::ForwardDependents(f)
+                : NodeDependencyAnalysis::BackwardDependents(f));
+    for (Node* from : f->nodes()) {
+      XLS_ASSERT_OK_AND_ASSIGN(DependencyBitmap bitmap,
+                               nda.GetDependents(from));
+      for (Node* to : f->nodes()) {
+        XLS_ASSERT_OK_AND_ASSIGN(bool expected, bitmap.IsDependent(to));
+        EXPECT_THAT(nda.IsDependent(from, to),
+                    status_testing::IsOkAndHolds(expected))
+            << from << (forward ? " -> " : " <- ") << to;
+      }
+    }
+  }
+}
+
+TEST_F(NodeDependencyAnalysisTest, BitmapsOutliveCacheEviction) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue last = x;
+  for (int64_t i = 0; i < 2 * NodeDependencyAnalysis::kMaxCachedBitmaps; ++i) {
+    last = fb.Not(last);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(auto* f, fb.Build());
+  NodeDependencyAnalysis nda(NodeDependencyAnalysis::ForwardDependents(f));
+  XLS_ASSERT_OK_AND_ASSIGN(DependencyBitmap first, nda.GetDependents(x.node()));
+  for (Node* n : f->nodes()) {
+    XLS_ASSERT_OK(nda.GetDependents(n).status());
+  }
+  EXPECT_THAT(first.IsDependent(last.node()),
+              status_testing::IsOkAndHolds(true));
+  EXPECT_TRUE(first.bitmap().IsAllOnes());
+}
+
 template <typename Iter>
 Node* NodeAt(Iter nodes, int64_t off) {
   return *std::next(nodes.begin(), off);
@@ -14,14 +14,20 @@
 
 #include "xls/passes/optimization_pass.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
@@ -29,9 +35,14 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/math_util.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/ir/call_graph.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/package.h"
@@ -113,6 +124,12 @@ absl::StatusOr<RamKind> RamKindFromProto(RamKindProto proto) {
       .to_config = to_config,
       .to_name_prefix = proto.to_name_prefix(),
       .model_builder = std::nullopt,
+      .bank_count = proto.has_bank_count() ? std::optional(proto.bank_count())
+                                           : std::nullopt,
+      .worst_case_throughput =
+          proto.has_worst_case_throughput()
+              ? std::optional(proto.worst_case_throughput())
+              : std::nullopt,
   };
 }
 
@@ -148,6 +165,9 @@ absl::StatusOr<bool> OptimizationFunctionBasePass::RunOnFunctionBase(
 absl::StatusOr<bool> OptimizationFunctionBasePass::RunInternal(
     Package* p, const OptimizationPassOptions& options,
     PassResults* results) const {
+  if (options.function_base_threads > 1 && p->GetFunctionBases().size() > 1) {
+    return RunOnFunctionBasesConcurrently(p, options, results);
+  }
   bool changed = false;
   for (FunctionBase* f : p->GetFunctionBases()) {
     XLS_ASSIGN_OR_RETURN(bool function_changed,
@@ -157,9 +177,183 @@ absl::StatusOr<bool> OptimizationFunctionBasePass::RunInternal(
   return changed;
 }
 
-absl::StatusOr<bool> OptimizationFunctionBasePass::TransformNodesToFixedPoint(
-    FunctionBase* f,
-    std::function<absl::StatusOr<bool>(Node*)> simplify_f) const {
+namespace {
+
+// Function bases transformed concurrently are given disjoint ranges of node
+// ids of this size.
+constexpr int64_t kIsolatedNodeIdStride = int64_t{1} << 32;
+
+// Returns, for each of `function_bases`, the indices of the later function
+// bases which may only be transformed after it. To produce the same result as
+// transforming the function bases serially in order, a function base must be
+// transformed after all earlier function bases which call it or which it
+// calls, transitively. Unrelated function bases cannot observe one another.
+//
+// GetDependentFunctions returns the transitive closure of the callees of a
+// function base, so e.g. for the call chain A -> B -> C the function bases A
+// and C are ordered directly rather than only through B.
+std::vector<std::vector<int64_t>> GetSuccessors(
+    absl::Span<FunctionBase* const> function_bases) {
+  absl::flat_hash_map<FunctionBase*, int64_t> indices;
+  for (int64_t i = 0; i < function_bases.size(); ++i) {
+    indices[function_bases[i]] = i;
+  }
+  std::vector<std::vector<int64_t>> successors(function_bases.size());
+  for (int64_t i = 0; i < function_bases.size(); ++i) {
+    for (FunctionBase* callee : GetDependentFunctions(function_bases[i])) {
+      auto it = indices.find(callee);
+      if (callee == function_bases[i] || it == indices.end()) {
+        continue;
+      }
+      if (it->second < i) {
+        successors[it->second].push_back(i);
+      } else {
+        successors[i].push_back(it->second);
+      }
+    }
+  }
+  return successors;
+}
+
+}  // namespace
+
+absl::StatusOr<bool>
+OptimizationFunctionBasePass::RunOnFunctionBasesConcurrently(
+    Package* p, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  std::vector<FunctionBase*> function_bases = p->GetFunctionBases();
+  const int64_t count = function_bases.size();
+  std::vector<std::vector<int64_t>> successors = GetSuccessors(function_bases);
+
+  // Each function base is isolated from the package and given a disjoint range
+  // of node ids above all existing ids. Within a function base, new nodes are
+  // therefore ordered by id exactly as when run serially; the ids are made
+  // dense again below.
+  const int64_t first_node_id = p->next_node_id();
+  for (int64_t i = 0; i < count; ++i) {
+    function_bases[i]->BeginIsolation(first_node_id +
+                                      i * kIsolatedNodeIdStride);
+  }
+
+  std::vector<PassResults> function_base_results(count);
+  std::vector<absl::StatusOr<bool>> function_base_changed(count, false);
+  // Types are shared by all function bases, so the type manager must lock
+  // while the workers run.
+  p->type_manager().BeginConcurrentAccess();
+  {
+    absl::Mutex mutex;
+    std::deque<int64_t> ready;
+    std::vector<int64_t> pending_predecessors(count, 0);
+    int64_t remaining = count;
+    bool failed = false;
+    for (int64_t i = 0; i < count; ++i) {
+      for (int64_t successor : successors[i]) {
+        ++pending_predecessors[successor];
+      }
+    }
+    for (int64_t i = 0; i < count; ++i) {
+      if (pending_predecessors[i] == 0) {
+        ready.push_back(i);
+      }
+    }
+
+    auto worker = [&]() {
+      while (true) {
+        int64_t i;
+        {
+          absl::MutexLock lock(&mutex);
+          auto work_or_done = [&]() ABSL_SHARED_LOCKS_REQUIRED(mutex) {
+            return !ready.empty() || remaining == 0 || failed;
+          };
+          mutex.Await(absl::Condition(&work_or_done));
+          if (failed || ready.empty()) {
+            return;
+          }
+          i = ready.front();
+          ready.pop_front();
+        }
+        absl::StatusOr<bool> changed = RunOnFunctionBaseInternal(
+            function_bases[i], options, &function_base_results[i]);
+        absl::MutexLock lock(&mutex);
+        failed = failed || !changed.ok();
+        function_base_changed[i] = std::move(changed);
+        --remaining;
+        for (int64_t successor : successors[i]) {
+          if (--pending_predecessors[successor] == 0) {
+            ready.push_back(successor);
+          }
+        }
+      }
+    };
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t t = 0; t < std::min(options.function_base_threads, count);
+         ++t) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  p->type_manager().EndConcurrentAccess();
+
+  // Merge the isolated state back into the package in package order, giving
+  // new nodes the ids they would have received if run serially.
+  int64_t next_node_id = first_node_id;
+  for (FunctionBase* f : function_bases) {
+    FunctionBase::IsolatedState state = f->EndIsolation();
+    int64_t allocated = state.next_node_id - state.first_node_id;
+    XLS_RET_CHECK_LT(allocated, kIsolatedNodeIdStride) << f->name();
+    if (state.first_node_id != next_node_id) {
+      for (Node* node : f->nodes()) {
+        if (node->id() >= state.first_node_id) {
+          node->SetId(node->id() - state.first_node_id + next_node_id);
+        }
+      }
+    }
+    next_node_id += allocated;
+    p->transform_metrics() =
+        p->transform_metrics() + state.transform_metrics;
+  }
+  p->set_next_node_id(next_node_id);
+
+  bool changed = false;
+  for (int64_t i = 0; i < count; ++i) {
+    XLS_RETURN_IF_ERROR(function_base_changed[i].status());
+    changed = changed || *function_base_changed[i];
+    absl::c_move(function_base_results[i].invocations,
+                 std::back_inserter(results->invocations));
+  }
+  return changed;
+}
+
+namespace {
+
+// Returns the nodes of `f` changed after change epoch `epoch` along with their
+// users and the users of their users. These are the nodes whose simplification
+// may have been enabled by the changes.
+absl::flat_hash_set<Node*> GetNodesAffectedSince(FunctionBase* f,
+                                                 int64_t epoch) {
+  absl::flat_hash_set<Node*> affected;
+  for (Node* node : f->nodes()) {
+    if (node->change_epoch() <= epoch) {
+      continue;
+    }
+    affected.insert(node);
+    for (Node* user : node->users()) {
+      affected.insert(user);
+      affected.insert(user->users().begin(), user->users().end());
+    }
+  }
+  return affected;
+}
+
+// Implementation of TransformNodesToFixedPoint. If `since_epoch` is given only
+// the nodes affected by changes after that epoch are visited in the first
+// sweep. If `incremental` is true each subsequent sweep only visits the nodes
+// affected by the changes of the previous sweep.
+absl::StatusOr<bool> TransformNodesToFixedPointImpl(
+    FunctionBase* f, std::optional<int64_t> since_epoch, bool incremental,
+    const std::function<absl::StatusOr<bool>(Node*)>& simplify_f) {
   // Store nodes by id to avoid running afoul of Node* pointer values being
   // reused.
   absl::flat_hash_set<int64_t> simplified_node_ids;
@@ -167,12 +361,25 @@ absl::StatusOr<bool> OptimizationFunctionBasePass::TransformNodesToFixedPoint(
   bool changed_this_time = false;
   do {
     changed_this_time = false;
+    std::optional<absl::flat_hash_set<Node*>> nodes_to_visit;
+    if (since_epoch.has_value()) {
+      nodes_to_visit = GetNodesAffectedSince(f, *since_epoch);
+    }
+    if (incremental) {
+      since_epoch = f->change_epoch();
+    }
     auto node_it = f->nodes().begin();
     while (node_it != f->nodes().end()) {
       // Save the next iterator because node_it may be invalidated by the call
       // to simplify_f if simpplify_f ends up deleting 'node'.
       auto next_it = std::next(node_it);
       Node* node = *node_it;
+      // Nodes created during this sweep are not in `nodes_to_visit` but they
+      // are visited in the next sweep.
+      if (nodes_to_visit.has_value() && !nodes_to_visit->contains(node)) {
+        node_it = next_it;
+        continue;
+      }
       // If the node was previously simplified and is now dead, avoid running
       // simplification on it again to avoid inf-looping while simplifying the
       // same node over and over again.
@@ -194,6 +401,37 @@ absl::StatusOr<bool> OptimizationFunctionBasePass::TransformNodesToFixedPoint(
   return changed;
 }
 
+}  // namespace
+
+absl::StatusOr<bool> OptimizationFunctionBasePass::TransformNodesToFixedPoint(
+    FunctionBase* f,
+    std::function<absl::StatusOr<bool>(Node*)> simplify_f) const {
+  return TransformNodesToFixedPointImpl(f, /*since_epoch=*/std::nullopt,
+                                        /*incremental=*/false, simplify_f);
+}
+
+absl::StatusOr<bool> OptimizationFunctionBasePass::TransformNodesToFixedPoint(
+    FunctionBase* f, const OptimizationPassOptions& options,
+    std::function<absl::StatusOr<bool>(Node*)> simplify_f) const {
+  if (!options.incremental_passes) {
+    return TransformNodesToFixedPoint(f, std::move(simplify_f));
+  }
+  std::optional<int64_t> since_epoch;
+  {
+    absl::MutexLock lock(&fixed_point_epochs_mutex_);
+    auto it = fixed_point_epochs_.find(f->uid());
+    if (it != fixed_point_epochs_.end()) {
+      since_epoch = it->second;
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(bool changed,
+                       TransformNodesToFixedPointImpl(
+                           f, since_epoch, /*incremental=*/true, simplify_f));
+  absl::MutexLock lock(&fixed_point_epochs_mutex_);
+  fixed_point_epochs_[f->uid()] = f->change_epoch();
+  return changed;
+}
+
 absl::StatusOr<bool> OptimizationProcPass::RunOnProc(
     Proc* proc, const OptimizationPassOptions& options,
     PassResults* results) const {
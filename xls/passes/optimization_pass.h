@@ -23,8 +23,10 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/package.h"
@@ -37,6 +39,8 @@
 
 namespace xls {
 
+class QueryEngineCache;
+
 // Metadata for RAMs.
 // TODO(google/xls#873): Ideally this metadata should live in the IR.
 //
@@ -93,6 +97,21 @@ struct RamRewrite {
   // If populated, also add a RAM model of kind "to_kind" driving the new
   // channels using the builder function.
   std::optional<ram_model_builder_t> model_builder;
+  // If populated, split the RAM into this many banks, interleaved on the low
+  // address bits: word `addr` is held by bank `addr % bank_count` at address
+  // `addr / bank_count`, so accesses to neighboring words can be served in the
+  // same cycle. Each bank is a RAM of kind `to_config.kind` and depth
+  // `to_config.depth / bank_count` with channels named
+  // `<to_name_prefix>_bank<i>_*`. Must be a power of two dividing the depth.
+  // Only supported when rewriting from an abstract RAM without a model
+  // builder, and each response must be received under the same predicate as
+  // its request.
+  std::optional<int64_t> bank_count = std::nullopt;
+  // If populated and `bank_count` is not, choose the smallest bank count for
+  // which no bank is asked to serve more accesses per proc activation than its
+  // ports can serve in this many cycles (using the known bits of the addresses
+  // to rule out banks). No banking is done if no bank count achieves this.
+  std::optional<int64_t> worst_case_throughput = std::nullopt;
 
   static absl::StatusOr<RamRewrite> FromProto(const RamRewriteProto& proto);
 };
@@ -131,8 +150,65 @@ struct OptimizationPassOptions : public PassOptionsBase {
   // variants.
   std::vector<RamRewrite> ram_rewrites;
 
+  // Depths to give the FIFOs of streaming channels, keyed by channel name
+  // (see FifoDepthPass). Typically suggested from simulation by eval_proc_main.
+  absl::flat_hash_map<std::string, int64_t> fifo_depths;
+
   // Use select context during narrowing range analysis.
   bool use_context_narrowing_analysis = false;
+
+  // Number of threads used by function-base passes to transform the function
+  // bases of a package concurrently. Function bases which call one another
+  // (transitively) are still transformed in package order, and the results
+  // are merged so the output IR is the same as when run serially. Values less
+  // than two run serially.
+  int64_t function_base_threads = 1;
+
+  // Number of threads used by passes which support it (currently CSE and
+  // select simplification) to analyze the nodes of a single large function
+  // base concurrently. The IR is still transformed serially so the output IR is
+  // the same as when run serially. Values less than two run serially.
+  int64_t node_threads = 1;
+
+  // Whether passes which support incremental operation only revisit the nodes
+  // changed since they last reached a fixed point on a function base (and the
+  // neighborhood of those nodes) rather than the entire graph. This makes the
+  // later iterations of fixed-point compound passes, which typically change
+  // few nodes, much cheaper.
+  bool incremental_passes = false;
+
+  // If set, counted_for loops with at least this many trips are unrolled by
+  // inlining the body once per trip and constant folding, commoning and
+  // removing dead nodes of each iteration as it is emitted, rather than by
+  // emitting an invoke per trip to be inlined and simplified later. This
+  // bounds the size of the graph while unrolling loops with large trip counts.
+  std::optional<int64_t> streaming_unroll_min_trip_count = std::nullopt;
+
+  // If set, the early (cost-based) inlining pass leaves the invokes of a
+  // function in place when inlining it everywhere would duplicate more than
+  // this many nodes. Such functions are optimized once on their own through the
+  // mid-level pipeline and inlined late, which bounds the size of the graph for
+  // designs with large functions called from many places.
+  std::optional<int64_t> inlining_cost_threshold = std::nullopt;
+
+  // If set, the proc state passes first simulate each proc for this many ticks
+  // with random inputs (see ProcStateToggles) and skip their static analyses
+  // of state elements which the simulation shows cannot be optimized. The
+  // results are the same as without simulation.
+  std::optional<int64_t> proc_state_simulation_ticks = std::nullopt;
+
+  // If set, the select simplification pass answers at most this many query
+  // engine queries per invocation on a function base and falls back on purely
+  // local reasoning beyond that. This bounds the time spent on large
+  // selector-heavy function bases at the cost of missed simplifications; the
+  // number of nodes whose analysis was skipped is logged.
+  std::optional<int64_t> select_simplification_query_budget = std::nullopt;
+
+  // If not null, passes which support it take their query engines from this
+  // cache rather than populating new ones, which avoids recomputing analyses
+  // of the parts of a function base which did not change. The cache must
+  // outlive the pass invocation.
+  QueryEngineCache* query_engine_cache = nullptr;
 };
 
 // An object containing information about the invocation of a pass (single call
@@ -188,6 +264,12 @@ class OptimizationFunctionBasePass : public OptimizationPass {
       FunctionBase* f, const OptimizationPassOptions& options,
       PassResults* results) const = 0;
 
+  // Calls RunOnFunctionBaseInternal for independent function bases of the
+  // package concurrently using `options.function_base_threads` threads.
+  absl::StatusOr<bool> RunOnFunctionBasesConcurrently(
+      Package* p, const OptimizationPassOptions& options,
+      PassResults* results) const;
+
   // Calls the given function for every node in the graph in a loop until no
   // further simplifications are possible.  simplify_f should return true if the
   // IR was modified. simplify_f can add or remove nodes including the node
@@ -198,6 +280,23 @@ class OptimizationFunctionBasePass : public OptimizationPass {
   absl::StatusOr<bool> TransformNodesToFixedPoint(
       FunctionBase* f,
       std::function<absl::StatusOr<bool>(Node*)> simplify_f) const;
+
+  // As above, but if `options.incremental_passes` is set only visits the nodes
+  // changed since this pass last reached a fixed point on `f` and their users
+  // (transitively up to two levels), both on entry and between sweeps. This is
+  // only equivalent to visiting every node if whether simplify_f changes a
+  // node depends only on the node, its users and the operands of the node
+  // (transitively up to two levels) and not on the pass options.
+  absl::StatusOr<bool> TransformNodesToFixedPoint(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      std::function<absl::StatusOr<bool>(Node*)> simplify_f) const;
+
+ private:
+  // The change epoch of each function base (by uid) when this pass last
+  // reached a fixed point on it in incremental mode.
+  mutable absl::Mutex fixed_point_epochs_mutex_;
+  mutable absl::flat_hash_map<int64_t, int64_t> fixed_point_epochs_
+      ABSL_GUARDED_BY(fixed_point_epochs_mutex_);
 };
 
 // Abstract base class for passes operate on procs. The derived
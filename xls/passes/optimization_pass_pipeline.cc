@@ -49,6 +49,7 @@
 #include "xls/passes/dataflow_simplification_pass.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/dfe_pass.h"
+#include "xls/passes/fifo_depth_pass.h"
 #include "xls/passes/identity_removal_pass.h"
 #include "xls/passes/inlining_pass.h"
 #include "xls/passes/label_recovery_pass.h"
@@ -160,7 +161,7 @@ UnrollingAndInliningPassGroup::UnrollingAndInliningPassGroup(int64_t opt_level)
                                "full function inlining passes") {
   Add<UnrollPass>();
   Add<MapInliningPass>();
-  Add<InliningPass>();
+  Add<InliningPass>(InliningPass::Mode::kCostBased);
   Add<DeadFunctionEliminationPass>();
 }
 
@@ -194,6 +195,7 @@ PostInliningPassGroup::PostInliningPassGroup(int64_t opt_level)
   Add<DeadCodeEliminationPass>();
   Add<UselessAssertRemovalPass>();
   Add<RamRewritePass>();
+  Add<FifoDepthPass>();
   Add<UselessIORemovalPass>();
   Add<DeadCodeEliminationPass>();
 
@@ -223,6 +225,11 @@ PostInliningPassGroup::PostInliningPassGroup(int64_t opt_level)
   Add<ProcStateOptimizationPass>();
   Add<DeadCodeEliminationPass>();
 
+  // Inline the functions left in place by the cost-based inlining pass now
+  // that they have been optimized on their own. The passes below clean up.
+  Add<InliningPass>();
+  Add<DeadFunctionEliminationPass>();
+
   Add<BddSimplificationPass>(std::min(int64_t{3}, opt_level));
   Add<DeadCodeEliminationPass>();
   Add<BddCsePass>();
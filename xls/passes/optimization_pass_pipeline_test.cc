@@ -19,21 +19,27 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/log/check.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/examples/sample_packages.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_parser.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
 
 namespace m = ::xls::op_matchers;
 
@@ -275,5 +281,63 @@ TEST_F(OptimizationPipelineTest, LogicCombining) {
   EXPECT_THAT(f->return_value(), m::Param("x"));
 }
 
+// Returns a package with several leaf functions containing simplification
+// opportunities, a function which invokes some of them and a top function.
+std::unique_ptr<Package> BuildMultiFunctionPackage() {
+  auto p = std::make_unique<Package>("multi_function");
+  std::vector<Function*> leaves;
+  for (int64_t i = 0; i < 8; ++i) {
+    FunctionBuilder fb(absl::StrFormat("leaf%d", i), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue y = fb.Param("y", p->GetBitsType(32));
+    BValue value = fb.Add(x, fb.Literal(UBits(0, 32)));
+    value = fb.Add(fb.Add(value, fb.Literal(UBits(i, 32))),
+                   fb.Literal(UBits(3, 32)));
+    value = fb.Select(fb.ULt(value, y), fb.Negate(fb.Negate(value)),
+                      fb.Subtract(value, fb.And(y, y)));
+    value = fb.Concat({fb.BitSlice(value, 16, 16), fb.BitSlice(value, 0, 16)});
+    leaves.push_back(fb.Build().value());
+  }
+  FunctionBuilder mid_fb("mid", p.get());
+  BValue x = mid_fb.Param("x", p->GetBitsType(32));
+  BValue y = mid_fb.Param("y", p->GetBitsType(32));
+  mid_fb.Xor(mid_fb.Invoke({x, y}, leaves[0]),
+             mid_fb.Invoke({y, x}, leaves[1]));
+  Function* mid = mid_fb.Build().value();
+
+  FunctionBuilder top_fb("top", p.get());
+  x = top_fb.Param("x", p->GetBitsType(32));
+  y = top_fb.Param("y", p->GetBitsType(32));
+  std::vector<BValue> results = {top_fb.Invoke({x, y}, mid)};
+  for (Function* leaf : leaves) {
+    results.push_back(top_fb.Invoke({x, y}, leaf));
+  }
+  top_fb.Add(top_fb.Xor(results), x);
+  CHECK_OK(p->SetTop(top_fb.Build().value()));
+  return p;
+}
+
+TEST_F(OptimizationPipelineTest, ConcurrentFunctionBasesMatchSerial) {
+  std::string ir = BuildMultiFunctionPackage()->DumpIr();
+  auto optimize = [&](int64_t threads) -> absl::StatusOr<std::string> {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> p, Parser::ParsePackage(ir));
+    OptimizationPassOptions options;
+    options.function_base_threads = threads;
+    PassResults results;
+    XLS_RETURN_IF_ERROR(
+        CreateOptimizationPassPipeline()->Run(p.get(), options, &results)
+            .status());
+    std::string pass_names;
+    for (const PassInvocation& invocation : results.invocations) {
+      absl::StrAppend(&pass_names, invocation.pass_name, " ");
+    }
+    return absl::StrCat(pass_names, "\n", p->DumpIr(), "\n",
+                        p->next_node_id());
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(std::string serial, optimize(1));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string concurrent, optimize(4));
+  EXPECT_EQ(concurrent, serial);
+}
+
 }  // namespace
 }  // namespace xls
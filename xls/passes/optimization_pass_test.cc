@@ -14,6 +14,7 @@
 
 #include "xls/passes/optimization_pass.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -24,11 +25,16 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/common/casts.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
@@ -37,9 +43,12 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/ram_rewrite.pb.h"
+#include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
+#include "xls/ir/value.h"
 #include "xls/passes/pass_base.h"
 
 namespace xls {
@@ -50,6 +59,7 @@ using status_testing::StatusIs;
 using ::testing::Contains;
 using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::UnorderedElementsAre;
 
 class DummyPass : public OptimizationPass {
  public:
@@ -422,6 +432,181 @@ TEST(PassesTest, TestTransformNodesToFixedPointWhileRemovingNodes) {
       IsOkAndHolds(false));
 }
 
+// Pass which records the nodes visited by an incremental
+// TransformNodesToFixedPoint and never changes anything.
+class VisitRecordingPass : public OptimizationFunctionBasePass {
+ public:
+  VisitRecordingPass()
+      : OptimizationFunctionBasePass("visit_recording", "visit recording") {}
+
+  std::vector<Node*>& visited() const { return visited_; }
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override {
+    return TransformNodesToFixedPoint(
+        f, options, [&](Node* n) -> absl::StatusOr<bool> {
+          visited_.push_back(n);
+          return false;
+        });
+  }
+
+ private:
+  mutable std::vector<Node*> visited_;
+};
+
+TEST(PassesTest, IncrementalTransformNodesToFixedPointVisitsChangedNodes) {
+  auto m = std::make_unique<Package>("m");
+  FunctionBuilder fb("test", m.get());
+  BValue x = fb.Param("x", m->GetBitsType(32));
+  BValue y = fb.Param("y", m->GetBitsType(32));
+  BValue a = fb.Add(x, y);
+  BValue b = fb.Not(a);
+  BValue c = fb.Negate(b);
+  BValue d = fb.Negate(c);
+  BValue e = fb.Not(y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Tuple({d, e})));
+  OptimizationPassOptions options;
+  options.incremental_passes = true;
+  VisitRecordingPass pass;
+  PassResults results;
+
+  // The first run visits every node.
+  ASSERT_THAT(pass.RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(false));
+  EXPECT_EQ(pass.visited().size(), f->node_count());
+
+  // Nothing changed so nothing is visited.
+  pass.visited().clear();
+  ASSERT_THAT(pass.RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(false));
+  EXPECT_THAT(pass.visited(), ElementsAre());
+
+  // Replacing an operand of `b` affects `b`, its old and new operands, and
+  // their users up to two levels.
+  pass.visited().clear();
+  XLS_ASSERT_OK(b.node()->ReplaceOperandNumber(0, x.node()));
+  ASSERT_THAT(pass.RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(false));
+  EXPECT_THAT(pass.visited(),
+              UnorderedElementsAre(x.node(), a.node(), b.node(), c.node(),
+                                   d.node()));
+
+  // Without incremental mode every node is visited.
+  pass.visited().clear();
+  ASSERT_THAT(pass.RunOnFunctionBase(f, OptimizationPassOptions(), &results),
+              IsOkAndHolds(false));
+  EXPECT_EQ(pass.visited().size(), f->node_count());
+}
+
+// Pass which adds a literal of a type not yet used by the function and a `not`
+// of its first parameter to every function base, and records when it starts
+// and finishes each function base. Function bases named in `slow` take longer
+// so that concurrently transformed function bases overlap.
+class NodeAddingPass : public OptimizationFunctionBasePass {
+ public:
+  explicit NodeAddingPass(absl::flat_hash_set<std::string> slow = {})
+      : OptimizationFunctionBasePass("node_adding", "node adding"),
+        slow_(std::move(slow)) {}
+
+  std::vector<std::string> events() const {
+    absl::MutexLock lock(&mutex_);
+    return events_;
+  }
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override {
+    Record(absl::StrCat("start ", f->name()));
+    if (slow_.contains(f->name())) {
+      absl::SleepFor(absl::Milliseconds(50));
+    }
+    XLS_RETURN_IF_ERROR(
+        f->MakeNode<Literal>(SourceInfo(),
+                             Value(UBits(1, 100 + f->node_count())))
+            .status());
+    XLS_RETURN_IF_ERROR(
+        f->MakeNode<UnOp>(SourceInfo(), f->params().front(), Op::kNot)
+            .status());
+    Record(absl::StrCat("end ", f->name()));
+    return true;
+  }
+
+ private:
+  void Record(std::string event) const {
+    absl::MutexLock lock(&mutex_);
+    events_.push_back(std::move(event));
+  }
+
+  absl::flat_hash_set<std::string> slow_;
+  mutable absl::Mutex mutex_;
+  mutable std::vector<std::string> events_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Returns a package with the call chain a -> b -> c and functions u0 to u5
+// which are unrelated to it and to each other.
+std::unique_ptr<Package> BuildCallChainPackage() {
+  auto p = std::make_unique<Package>("call_chain");
+  auto add_function = [&](std::string_view name,
+                          std::optional<Function*> callee) {
+    FunctionBuilder fb(name, p.get());
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue result = fb.Add(x, x);
+    if (callee.has_value()) {
+      result = fb.Invoke({result}, *callee);
+    }
+    return fb.BuildWithReturnValue(result).value();
+  };
+  Function* c = add_function("c", std::nullopt);
+  Function* b = add_function("b", c);
+  add_function("a", b);
+  for (int64_t i = 0; i < 6; ++i) {
+    add_function(absl::StrFormat("u%d", i), std::nullopt);
+  }
+  return p;
+}
+
+TEST(PassesTest, ConcurrentFunctionBasesRespectTransitiveCalls) {
+  std::unique_ptr<Package> p = BuildCallChainPackage();
+  OptimizationPassOptions options;
+  options.function_base_threads = 4;
+  NodeAddingPass pass(/*slow=*/{"c"});
+  PassResults results;
+  ASSERT_THAT(pass.Run(p.get(), options, &results), IsOkAndHolds(true));
+
+  std::vector<std::string> events = pass.events();
+  auto position = [&](std::string_view event) {
+    return std::find(events.begin(), events.end(), event) - events.begin();
+  };
+  ASSERT_EQ(events.size(), 2 * p->GetFunctionBases().size());
+  EXPECT_LT(position("end c"), position("start b"));
+  EXPECT_LT(position("end b"), position("start a"));
+  // `a` only calls `c` through `b`, but must still see `c` as transformed.
+  EXPECT_LT(position("end c"), position("start a"));
+}
+
+TEST(PassesTest, ConcurrentFunctionBasesMatchSerialByteForByte) {
+  auto run = [](int64_t threads) -> absl::StatusOr<std::string> {
+    std::unique_ptr<Package> p = BuildCallChainPackage();
+    OptimizationPassOptions options;
+    options.function_base_threads = threads;
+    NodeAddingPass pass(/*slow=*/{"u0", "u3"});
+    PassResults results;
+    // Run twice so the second run starts from the node ids assigned when the
+    // results of the first were merged.
+    for (int64_t i = 0; i < 2; ++i) {
+      XLS_RETURN_IF_ERROR(pass.Run(p.get(), options, &results).status());
+    }
+    return absl::StrCat(p->DumpIr(), "\nnext_node_id=", p->next_node_id());
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(std::string serial, run(1));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string concurrent, run(4));
+  EXPECT_EQ(concurrent, serial);
+}
+
 TEST(RamDatastructuresTest, AddrWidthCorrect) {
   RamConfig config{.kind = RamKind::kAbstract, .depth = 2};
   EXPECT_EQ(config.addr_width(), 1);
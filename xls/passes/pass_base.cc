@@ -16,7 +16,6 @@
 
 #include <algorithm>
 #include <string>
-#include <string_view>
 #include <vector>
 
 #include "absl/strings/str_format.h"
@@ -25,14 +24,16 @@
 
 namespace xls {
 
-void CompoundPassResult::AddSinglePassResult(std::string_view pass_name,
-                                             bool changed,
-                                             absl::Duration duration,
+void CompoundPassResult::AddSinglePassResult(const PassInvocation& invocation,
                                              const TransformMetrics& metrics) {
-  SinglePassResult& result = pass_results_[pass_name];
+  SinglePassResult& result = pass_results_[invocation.pass_name];
   ++result.run_count;
-  result.changed_count += changed ? 1 : 0;
-  result.duration = result.duration + duration;
+  result.changed_count += invocation.ir_changed ? 1 : 0;
+  result.duration = result.duration + invocation.run_duration;
+  result.cpu_duration = result.cpu_duration + invocation.cpu_duration;
+  result.peak_rss_delta_bytes += invocation.peak_rss_delta_bytes;
+  result.node_count_delta +=
+      invocation.node_count_after - invocation.node_count_before;
   result.metrics = result.metrics + metrics;
 }
 
@@ -44,6 +45,10 @@ void CompoundPassResult::AccumulateCompoundPassResult(
     pass_result.changed_count += other_pass_result.changed_count;
     pass_result.run_count += other_pass_result.run_count;
     pass_result.duration = pass_result.duration + other_pass_result.duration;
+    pass_result.cpu_duration =
+        pass_result.cpu_duration + other_pass_result.cpu_duration;
+    pass_result.peak_rss_delta_bytes += other_pass_result.peak_rss_delta_bytes;
+    pass_result.node_count_delta += other_pass_result.node_count_delta;
     pass_result.metrics = pass_result.metrics + other_pass_result.metrics;
   }
 }
@@ -64,8 +69,12 @@ std::string CompoundPassResult::ToString() const {
   for (const std::string& name : pass_names) {
     SinglePassResult result = pass_results_.at(name);
     absl::StrAppendFormat(
-        &s, "  %15s: changed %d/%d, total time %s, metrics %s\n", name,
-        result.changed_count, result.run_count, FormatDuration(result.duration),
+        &s,
+        "  %15s: changed %d/%d, total time %s, cpu time %s, peak rss delta "
+        "%d bytes, node delta %d, metrics %s\n",
+        name, result.changed_count, result.run_count,
+        FormatDuration(result.duration), FormatDuration(result.cpu_duration),
+        result.peak_rss_delta_bytes, result.node_count_delta,
         result.metrics.ToString());
   }
   return s;
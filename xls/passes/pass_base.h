@@ -37,6 +37,7 @@
 #include "xls/common/casts.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/logging/log_lines.h"
+#include "xls/common/resource_usage.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/package.h"
@@ -79,6 +80,22 @@ struct PassInvocation {
 
   // The run duration of the pass.
   absl::Duration run_duration;
+
+  // The wall-clock time at which the pass started running.
+  absl::Time start_time;
+
+  // The CPU time (user + system, summed over all threads of the process)
+  // consumed while running the pass.
+  absl::Duration cpu_duration;
+
+  // The growth of the peak resident set size of the process while running the
+  // pass. As the peak is a high-water mark this is zero unless the pass pushed
+  // memory usage beyond anything seen before.
+  int64_t peak_rss_delta_bytes = 0;
+
+  // The number of nodes in the IR before and after running the pass.
+  int64_t node_count_before = 0;
+  int64_t node_count_after = 0;
 };
 
 // A object to which metadata may be written in each pass invocation. This data
@@ -186,6 +203,12 @@ struct SinglePassResult {
   TransformMetrics metrics;
   // Total duration of the running of the pass.
   absl::Duration duration;
+  // Total CPU time consumed by the runs.
+  absl::Duration cpu_duration;
+  // Total growth of the peak resident set size across the runs.
+  int64_t peak_rss_delta_bytes = 0;
+  // Total change in the number of nodes across the runs.
+  int64_t node_count_delta = 0;
 };
 
 // Data structure returned by contains aggregate statistics about the passes run
@@ -197,8 +220,7 @@ class CompoundPassResult {
   void set_changed(bool value) { changed_ = value; }
 
   // Add the results of a single run of a pass.
-  void AddSinglePassResult(std::string_view pass_name, bool changed,
-                           absl::Duration duration,
+  void AddSinglePassResult(const PassInvocation& invocation,
                            const TransformMetrics& metrics);
 
   // Accumulates the statistics in `other` into this one.
@@ -411,6 +433,8 @@ CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
     std::string ir_before = ir->DumpIr();
 #endif
     absl::Time start = absl::Now();
+    ResourceUsage usage_before = GetResourceUsage();
+    int64_t node_count_before = ir->GetNodeCount();
     bool pass_changed;
     if (pass->IsCompound()) {
       XLS_ASSIGN_OR_RETURN(
@@ -424,6 +448,7 @@ CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
       XLS_ASSIGN_OR_RETURN(pass_changed, pass->Run(ir, options, results));
     }
     absl::Duration duration = absl::Now() - start;
+    ResourceUsage usage_after = GetResourceUsage();
 #ifdef DEBUG
     std::string ir_after = ir->DumpIr();
     if (pass_changed) {
@@ -450,9 +475,19 @@ CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
     if (pass_changed) {
       VLOG(1) << absl::StrFormat("Metrics: %s", pass_metrics.ToString());
     }
+    PassInvocation invocation{
+        .pass_name = pass->short_name(),
+        .ir_changed = pass_changed,
+        .run_duration = duration,
+        .start_time = start,
+        .cpu_duration = usage_after.cpu_time - usage_before.cpu_time,
+        .peak_rss_delta_bytes =
+            usage_after.peak_rss_bytes - usage_before.peak_rss_bytes,
+        .node_count_before = node_count_before,
+        .node_count_after = ir->GetNodeCount(),
+    };
     if (!pass->IsCompound()) {
-      results->invocations.push_back(
-          {pass->short_name(), pass_changed, duration});
+      results->invocations.push_back(invocation);
     }
     if (!options.ir_dump_path.empty()) {
       XLS_RETURN_IF_ERROR(DumpIr(options.ir_dump_path, ir, top_level_name,
@@ -461,8 +496,7 @@ CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
                                  /*changed=*/pass_changed));
     }
 
-    aggregate_result.AddSinglePassResult(pass->short_name(), pass_changed,
-                                         duration, pass_metrics);
+    aggregate_result.AddSinglePassResult(invocation, pass_metrics);
 
     // Only run the verifiers if the pass changed.
     if (pass_changed) {
@@ -22,6 +22,7 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
@@ -288,5 +289,31 @@ TEST_F(PassBaseTest, BisectLimitZero) {
   EXPECT_THAT(results.invocations, IsEmpty());
 }
 
+TEST_F(PassBaseTest, InvocationsRecordNodeCounts) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Literal(UBits(0, 64));
+  XLS_ASSERT_OK(fb.Build().status());
+  OptimizationCompoundPass opt("opt", "opt");
+  opt.Add<LevelUpPass>();
+  opt.Add<DeadCodeEliminationPass>();
+  PassResults results;
+  XLS_ASSERT_OK(opt.Run(p.get(), OptimizationPassOptions(), &results));
+
+  // Level up adds a literal which DCE then removes.
+  ASSERT_THAT(results.invocations, ElementsAre(LevelUpInvoke(), DceInvoke()));
+  EXPECT_EQ(results.invocations[0].node_count_before, 1);
+  EXPECT_EQ(results.invocations[0].node_count_after, 2);
+  EXPECT_EQ(results.invocations[1].node_count_before, 2);
+  EXPECT_EQ(results.invocations[1].node_count_after, 1);
+  for (const PassInvocation& invocation : results.invocations) {
+    EXPECT_TRUE(invocation.ir_changed);
+    EXPECT_GE(invocation.cpu_duration, absl::ZeroDuration());
+    EXPECT_GE(invocation.peak_rss_delta_bytes, 0);
+  }
+  EXPECT_LE(results.invocations[0].start_time,
+            results.invocations[1].start_time);
+}
+
 }  // namespace
 }  // namespace xls
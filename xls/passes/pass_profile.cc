@@ -0,0 +1,90 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/pass_profile.h"
+
+#include <filesystem>  // NOLINT
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "nlohmann/json.hpp"
+#include "xls/common/file/filesystem.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/pass_profile.pb.h"
+
+namespace xls {
+
+PassPipelineProfileProto PassResultsToProfileProto(const PassResults& results) {
+  PassPipelineProfileProto proto;
+  for (const PassInvocation& invocation : results.invocations) {
+    PassInvocationProfileProto* invocation_proto = proto.add_invocations();
+    invocation_proto->set_pass_name(invocation.pass_name);
+    invocation_proto->set_ir_changed(invocation.ir_changed);
+    invocation_proto->set_start_time_us(
+        absl::ToUnixMicros(invocation.start_time));
+    invocation_proto->set_wall_time_us(
+        absl::ToInt64Microseconds(invocation.run_duration));
+    invocation_proto->set_cpu_time_us(
+        absl::ToInt64Microseconds(invocation.cpu_duration));
+    invocation_proto->set_peak_rss_delta_bytes(invocation.peak_rss_delta_bytes);
+    invocation_proto->set_node_count_before(invocation.node_count_before);
+    invocation_proto->set_node_count_after(invocation.node_count_after);
+  }
+  return proto;
+}
+
+std::string PassResultsToChromeTrace(const PassResults& results) {
+  // Timestamps are relative to the first invocation to keep them small.
+  absl::Time origin = results.invocations.empty()
+                          ? absl::UnixEpoch()
+                          : results.invocations.front().start_time;
+  nlohmann::json events = nlohmann::json::array();
+  for (const PassInvocation& invocation : results.invocations) {
+    nlohmann::json event;
+    event["name"] = invocation.pass_name;
+    event["cat"] = "pass";
+    event["ph"] = "X";
+    event["pid"] = 0;
+    event["tid"] = 0;
+    event["ts"] = absl::ToInt64Microseconds(invocation.start_time - origin);
+    event["dur"] = absl::ToInt64Microseconds(invocation.run_duration);
+    event["args"] = {
+        {"ir_changed", invocation.ir_changed},
+        {"cpu_time_us", absl::ToInt64Microseconds(invocation.cpu_duration)},
+        {"peak_rss_delta_bytes", invocation.peak_rss_delta_bytes},
+        {"node_count_before", invocation.node_count_before},
+        {"node_count_after", invocation.node_count_after},
+    };
+    events.push_back(std::move(event));
+  }
+  nlohmann::json trace;
+  trace["traceEvents"] = std::move(events);
+  trace["displayTimeUnit"] = "ms";
+  return trace.dump();
+}
+
+absl::Status WritePassProfile(const PassResults& results,
+                              const std::filesystem::path& path) {
+  if (path.extension() == ".json") {
+    return SetFileContents(path, PassResultsToChromeTrace(results));
+  }
+  if (path.extension() == ".pb") {
+    return SetProtobinFile(path, PassResultsToProfileProto(results));
+  }
+  return SetTextProtoFile(path, PassResultsToProfileProto(results));
+}
+
+}  // namespace xls
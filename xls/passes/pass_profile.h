@@ -0,0 +1,45 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_PASS_PROFILE_H_
+#define XLS_PASSES_PASS_PROFILE_H_
+
+#include <filesystem>  // NOLINT
+#include <string>
+
+#include "absl/status/status.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/pass_profile.pb.h"
+
+namespace xls {
+
+// Returns a proto holding the per-invocation profile (wall time, CPU time, peak
+// RSS delta and node counts) of each pass recorded in `results`.
+PassPipelineProfileProto PassResultsToProfileProto(const PassResults& results);
+
+// Returns the profile of the invocations in `results` in the Chrome
+// trace-event JSON format. The result can be loaded in chrome://tracing or
+// https://ui.perfetto.dev. Each invocation is a complete ("X") event with the
+// node counts and memory usage attached as arguments.
+std::string PassResultsToChromeTrace(const PassResults& results);
+
+// Writes the profile of `results` to `path`. The format is chosen by the file
+// extension: ".json" writes a Chrome trace, ".pb" writes a binary
+// PassPipelineProfileProto, and anything else writes the proto in text format.
+absl::Status WritePassProfile(const PassResults& results,
+                              const std::filesystem::path& path);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_PASS_PROFILE_H_
@@ -0,0 +1,111 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/pass_profile.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "nlohmann/json.hpp"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/pass_profile.pb.h"
+
+namespace xls {
+namespace {
+
+PassResults MakeResults() {
+  absl::Time start = absl::FromUnixMicros(1000000);
+  PassResults results;
+  results.invocations.push_back(PassInvocation{
+      .pass_name = "dce",
+      .ir_changed = true,
+      .run_duration = absl::Microseconds(20),
+      .start_time = start,
+      .cpu_duration = absl::Microseconds(15),
+      .peak_rss_delta_bytes = 4096,
+      .node_count_before = 10,
+      .node_count_after = 7,
+  });
+  results.invocations.push_back(PassInvocation{
+      .pass_name = "cse \"quoted\"",
+      .ir_changed = false,
+      .run_duration = absl::Microseconds(5),
+      .start_time = start + absl::Microseconds(30),
+      .cpu_duration = absl::Microseconds(4),
+      .peak_rss_delta_bytes = 0,
+      .node_count_before = 7,
+      .node_count_after = 7,
+  });
+  return results;
+}
+
+TEST(PassProfileTest, ProfileProto) {
+  PassPipelineProfileProto proto = PassResultsToProfileProto(MakeResults());
+  ASSERT_EQ(proto.invocations_size(), 2);
+  const PassInvocationProfileProto& dce = proto.invocations(0);
+  EXPECT_EQ(dce.pass_name(), "dce");
+  EXPECT_TRUE(dce.ir_changed());
+  EXPECT_EQ(dce.start_time_us(), 1000000);
+  EXPECT_EQ(dce.wall_time_us(), 20);
+  EXPECT_EQ(dce.cpu_time_us(), 15);
+  EXPECT_EQ(dce.peak_rss_delta_bytes(), 4096);
+  EXPECT_EQ(dce.node_count_before(), 10);
+  EXPECT_EQ(dce.node_count_after(), 7);
+  EXPECT_FALSE(proto.invocations(1).ir_changed());
+}
+
+TEST(PassProfileTest, ChromeTrace) {
+  nlohmann::json trace =
+      nlohmann::json::parse(PassResultsToChromeTrace(MakeResults()));
+  const nlohmann::json& events = trace["traceEvents"];
+  ASSERT_EQ(events.size(), 2);
+  EXPECT_EQ(events[0]["name"], "dce");
+  EXPECT_EQ(events[0]["ph"], "X");
+  EXPECT_EQ(events[0]["ts"], 0);
+  EXPECT_EQ(events[0]["dur"], 20);
+  EXPECT_EQ(events[0]["args"]["node_count_before"], 10);
+  EXPECT_EQ(events[0]["args"]["node_count_after"], 7);
+  EXPECT_EQ(events[0]["args"]["peak_rss_delta_bytes"], 4096);
+  EXPECT_EQ(events[1]["name"], "cse \"quoted\"");
+  EXPECT_EQ(events[1]["ts"], 30);
+  EXPECT_EQ(events[1]["args"]["ir_changed"], false);
+}
+
+TEST(PassProfileTest, WriteFormatFromExtension) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  PassResults results = MakeResults();
+
+  XLS_ASSERT_OK(WritePassProfile(results, temp_dir.path() / "profile.json"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string json,
+                           GetFileContents(temp_dir.path() / "profile.json"));
+  EXPECT_TRUE(nlohmann::json::parse(json).contains("traceEvents"));
+
+  XLS_ASSERT_OK(WritePassProfile(results, temp_dir.path() / "profile.pb"));
+  PassPipelineProfileProto binary;
+  XLS_ASSERT_OK(ParseProtobinFile(temp_dir.path() / "profile.pb", &binary));
+  EXPECT_EQ(binary.invocations_size(), 2);
+
+  XLS_ASSERT_OK(WritePassProfile(results, temp_dir.path() / "profile.txtpb"));
+  PassPipelineProfileProto text;
+  XLS_ASSERT_OK(ParseTextProtoFile(temp_dir.path() / "profile.txtpb", &text));
+  EXPECT_EQ(text.invocations_size(), 2);
+}
+
+}  // namespace
+}  // namespace xls
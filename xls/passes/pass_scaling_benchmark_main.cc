@@ -0,0 +1,256 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Microbenchmarks which run every registered optimization pass individually on
+// synthetic graphs (see xls/ir/benchmark_support.h) of 1k to 1M nodes. In
+// addition to the usual benchmark output, a table of scaling exponents is
+// printed at the end: the slope of log(cpu time) against log(node count) for
+// each pass and graph shape. A linear pass has an exponent close to 1 and an
+// accidentally quadratic one an exponent close to 2.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/init_xls.h"
+#include "xls/ir/benchmark_support.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/optimization_pass_registry.h"
+#include "xls/passes/pass_base.h"
+
+static constexpr std::string_view kUsage = R"(
+Runs each registered optimization pass on synthetic graphs of increasing size
+and reports how the run time of each pass scales with the number of nodes.
+
+Example invocation (one pass, all shapes):
+
+  pass_scaling_benchmark_main --benchmark_filter='BM_Pass/cse/.*'
+)";
+
+namespace xls {
+namespace {
+
+using benchmark_support::strategy::BinaryAdd;
+using benchmark_support::strategy::CaseSelect;
+using benchmark_support::strategy::DistinctLiteral;
+using benchmark_support::strategy::NullaryNode;
+
+// Exponent above which a pass is flagged in the scaling table.
+constexpr double kSuperlinearExponent = 1.5;
+
+// Leaf strategy which returns the same parameter of the given type every time.
+// Unlike literals this keeps the graph from being constant folded away.
+class SharedParam final : public NullaryNode {
+ public:
+  explicit SharedParam(std::string name, int64_t bit_count)
+      : name_(std::move(name)), bit_count_(bit_count) {}
+
+  absl::StatusOr<BValue> GenerateNullaryNode(
+      FunctionBuilder& builder) const final {
+    if (!param_.has_value()) {
+      param_ = builder.Param(name_, builder.package()->GetBitsType(bit_count_));
+    }
+    return *param_;
+  }
+
+ private:
+  std::string name_;
+  int64_t bit_count_;
+  mutable std::optional<BValue> param_;
+};
+
+// Generates a function with approximately `node_count` nodes.
+using GraphGenerator =
+    absl::StatusOr<Function*> (*)(Package* package, int64_t node_count);
+
+// A chain of adds of a shared parameter: (+ (+ (+ ... x) x) x). Each link adds
+// one node.
+absl::StatusOr<Function*> GenerateAddChain(Package* package,
+                                           int64_t node_count) {
+  return benchmark_support::GenerateChain(package, /*depth=*/node_count,
+                                          /*num_children=*/2, BinaryAdd(),
+                                          SharedParam("x", 32));
+}
+
+// A balanced binary tree of adds over distinct literals. Every node is
+// foldable.
+absl::StatusOr<Function*> GenerateLiteralAddTree(Package* package,
+                                                 int64_t node_count) {
+  int64_t depth = std::max<int64_t>(1, std::log2(node_count) - 1);
+  return benchmark_support::GenerateBalancedTree(
+      package, depth, /*fan_out=*/2, BinaryAdd(), DistinctLiteral());
+}
+
+// A balanced binary tree of selects which all share one parameter as the
+// selector and have distinct literal leaves.
+absl::StatusOr<Function*> GenerateSelectTree(Package* package,
+                                             int64_t node_count) {
+  SharedParam selector("s", 1);
+  int64_t depth = std::max<int64_t>(1, std::log2(node_count) - 1);
+  return benchmark_support::GenerateBalancedTree(
+      package, depth, /*fan_out=*/2, CaseSelect(selector), DistinctLiteral());
+}
+
+constexpr std::pair<std::string_view, GraphGenerator> kGraphShapes[] = {
+    {"add_chain", GenerateAddChain},
+    {"literal_add_tree", GenerateLiteralAddTree},
+    {"select_tree", GenerateSelectTree},
+};
+
+void BM_Pass(benchmark::State& state, std::string_view pass_name,
+             GraphGenerator generate) {
+  int64_t node_count = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto package = std::make_unique<Package>("scaling_benchmark");
+    absl::StatusOr<Function*> f = generate(package.get(), state.range(0));
+    absl::Status status = f.status();
+    OptimizationCompoundPass pass("bench", "Pass scaling benchmark");
+    if (status.ok()) {
+      status = package->SetTop(*f);
+    }
+    if (status.ok()) {
+      node_count = (*f)->node_count();
+      absl::StatusOr<OptimizationPassGenerator*> generator =
+          GetOptimizationRegistry().Generator(pass_name);
+      status = generator.ok() ? (*generator)->AddToPipeline(&pass, kMaxOptLevel)
+                              : generator.status();
+    }
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      break;
+    }
+    PassResults results;
+    state.ResumeTiming();
+
+    absl::StatusOr<bool> changed =
+        pass.Run(package.get(), OptimizationPassOptions(), &results);
+    if (!changed.ok()) {
+      state.SkipWithError(changed.status().ToString().c_str());
+      break;
+    }
+    benchmark::DoNotOptimize(*changed);
+
+    // Do not time the destruction of the package.
+    state.PauseTiming();
+    package.reset();
+    state.ResumeTiming();
+  }
+  state.SetComplexityN(node_count);
+  state.counters["nodes"] = static_cast<double>(node_count);
+}
+
+// Registers one benchmark per registered pass and graph shape. Must be called
+// after the pass registry is populated, i.e. not from a static initializer.
+void RegisterPassBenchmarks() {
+  for (std::string_view pass_name :
+       GetOptimizationRegistry().GetRegisteredNames()) {
+    for (const auto& [shape, generate] : kGraphShapes) {
+      benchmark::RegisterBenchmark(
+          absl::StrCat("BM_Pass/", pass_name, "/", shape).c_str(),
+          [pass_name = pass_name, generate = generate](benchmark::State& state) {
+            BM_Pass(state, pass_name, generate);
+          })
+          ->RangeMultiplier(8)
+          ->Range(1 << 10, 1 << 20)
+          ->Unit(benchmark::kMillisecond)
+          ->Complexity();
+    }
+  }
+}
+
+// Console reporter which additionally fits the per-iteration CPU time of each
+// benchmark family against its node count on a log-log scale and prints the
+// slopes once all benchmarks have run.
+class ScalingExponentReporter : public benchmark::ConsoleReporter {
+ public:
+  void ReportRuns(const std::vector<Run>& reports) override {
+    benchmark::ConsoleReporter::ReportRuns(reports);
+    for (const Run& run : reports) {
+      if (run.run_type != Run::RT_Iteration || run.skipped ||
+          run.complexity_n <= 0) {
+        continue;
+      }
+      samples_[run.run_name.function_name].push_back(
+          {std::log(static_cast<double>(run.complexity_n)),
+           std::log(run.GetAdjustedCPUTime())});
+    }
+  }
+
+  void Finalize() override {
+    benchmark::ConsoleReporter::Finalize();
+    std::ostream& out = GetOutputStream();
+    out << "\nScaling exponents (cpu time ~ nodes^k):\n";
+    for (const auto& [name, points] : samples_) {
+      if (points.size() < 2) {
+        continue;
+      }
+      double exponent = Slope(points);
+      out << absl::StreamFormat("%-70s %5.2f%s\n", name, exponent,
+                                exponent > kSuperlinearExponent
+                                    ? "  <-- superlinear"
+                                    : "");
+    }
+  }
+
+ private:
+  // Least-squares slope of the (x, y) points.
+  static double Slope(const std::vector<std::pair<double, double>>& points) {
+    double n = points.size();
+    double sum_x = 0.0, sum_y = 0.0, sum_xx = 0.0, sum_xy = 0.0;
+    for (const auto& [x, y] : points) {
+      sum_x += x;
+      sum_y += y;
+      sum_xx += x * x;
+      sum_xy += x * y;
+    }
+    double denominator = n * sum_xx - sum_x * sum_x;
+    return denominator == 0.0 ? 0.0
+                              : (n * sum_xy - sum_x * sum_y) / denominator;
+  }
+
+  // Keyed by benchmark family (the name without the size argument).
+  std::map<std::string, std::vector<std::pair<double, double>>> samples_;
+};
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  // Consumes the --benchmark_* flags so they are not seen by absl.
+  benchmark::Initialize(&argc, argv);
+  xls::InitXls(kUsage, argc, argv);
+  xls::RegisterPassBenchmarks();
+  xls::ScalingExponentReporter reporter;
+  benchmark::RunSpecifiedBenchmarks(&reporter);
+  benchmark::Shutdown();
+  return 0;
+}
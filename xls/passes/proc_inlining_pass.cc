@@ -34,10 +34,12 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/casts.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/stopwatch.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
@@ -1345,6 +1347,17 @@ class ProcThread {
 
   Proc* GetInlinedProc() const { return inlined_proc_; }
 
+  // Returns the outgoing activation bits of the activation network. These are
+  // the only nodes queried by MaybeSaveReceivedData.
+  std::vector<Node*> GetActivationBits() const {
+    std::vector<Node*> bits;
+    bits.reserve(activation_nodes_.size());
+    for (const ActivationNode& anode : activation_nodes_) {
+      bits.push_back(anode.activation_out);
+    }
+    return bits;
+  }
+
   // Returns the signal indicating that the tick of the proc thread is complete.
   Node* GetProcTickComplete() const {
     return sink_activation_node_->activation_out;
@@ -1761,6 +1774,37 @@ absl::StatusOr<ProcThread> InlineProcAsProcThread(
   return std::move(proc_thread);
 }
 
+// Returns the given nodes and their transitive operands.
+absl::flat_hash_set<Node*> GetCone(absl::Span<Node* const> roots) {
+  absl::flat_hash_set<Node*> cone(roots.begin(), roots.end());
+  std::vector<Node*> worklist(roots.begin(), roots.end());
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    for (Node* operand : node->operands()) {
+      if (cone.insert(operand).second) {
+        worklist.push_back(operand);
+      }
+    }
+  }
+  return cone;
+}
+
+// The cost of inlining a single proc. Reported at VLOG level 1 to find the
+// procs which dominate the compile time of large networks.
+struct ProcInliningCost {
+  std::string proc_name;
+  // Time spent cloning the proc into the container and building its activation
+  // network.
+  absl::Duration inline_time;
+  // Time spent deciding which received data must be saved as state.
+  absl::Duration save_data_time;
+  // Nodes added to the container proc for the proc.
+  int64_t nodes_added = 0;
+  // State elements added to the container proc for the proc.
+  int64_t state_elements = 0;
+};
+
 // Sets the state of `proc` to the given state elements.
 absl::Status SetProcState(Proc* proc, absl::Span<const StateElement> elements) {
   std::vector<std::string> names;
@@ -1855,15 +1899,22 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
   }
 
   std::vector<ProcThread> proc_threads;
+  std::vector<ProcInliningCost> costs;
 
   // Inline each proc into `container_proc`. Sends/receives are converted to
   // virtual send/receives.
   // TODO(meheff): 2022/02/11 Add analysis which determines whether inlining is
   // a legal transformation.
   for (Proc* proc : procs_to_inline) {
+    Stopwatch stopwatch;
+    int64_t node_count = container_proc->node_count();
     XLS_ASSIGN_OR_RETURN(
         ProcThread proc_thread,
         InlineProcAsProcThread(proc, container_proc, virtual_channels));
+    costs.push_back(ProcInliningCost{
+        .proc_name = proc->name(),
+        .inline_time = stopwatch.GetElapsedTime(),
+        .nodes_added = container_proc->node_count() - node_count});
     proc_threads.push_back(std::move(proc_thread));
   }
 
@@ -1882,16 +1933,56 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
             node->Is<ExtendOp>() || node->Is<Concat>() ||
             node->Is<BitwiseReductionOp>() || node->Is<Literal>());
   };
+  // Only the activation bits are queried so only their cones are evaluated
+  // with BDDs; the datapaths of the inlined procs are modeled as variables. A
+  // BDD only depends on the cone of its node so the answers are unchanged.
+  std::vector<Node*> activation_bits;
+  for (const ProcThread& proc_thread : proc_threads) {
+    std::vector<Node*> bits = proc_thread.GetActivationBits();
+    activation_bits.insert(activation_bits.end(), bits.begin(), bits.end());
+  }
+  absl::flat_hash_set<Node*> activation_cone = GetCone(activation_bits);
   std::vector<std::unique_ptr<QueryEngine>> query_engines;
   query_engines.push_back(std::make_unique<StatelessQueryEngine>());
   query_engines.push_back(std::make_unique<BddQueryEngine>(
-      static_cast<int64_t>(16 * 1024), should_compute_with_bdds));
+      static_cast<int64_t>(16 * 1024),
+      [&](const Node* node) {
+        return activation_cone.contains(node) &&
+               should_compute_with_bdds(node);
+      }));
   UnionQueryEngine query_engine(std::move(query_engines));
 
+  Stopwatch populate_stopwatch;
   XLS_RETURN_IF_ERROR(query_engine.Populate(container_proc).status());
-
-  for (ProcThread& proc_thread : proc_threads) {
-    XLS_RETURN_IF_ERROR(proc_thread.MaybeSaveReceivedData(query_engine));
+  VLOG(1) << absl::StreamFormat(
+      "Proc inlining: populated query engine over %d nodes (%d in activation "
+      "cones) in %s",
+      container_proc->node_count(), activation_cone.size(),
+      absl::FormatDuration(populate_stopwatch.GetElapsedTime()));
+
+  for (int64_t i = 0; i < proc_threads.size(); ++i) {
+    Stopwatch stopwatch;
+    int64_t node_count = container_proc->node_count();
+    XLS_RETURN_IF_ERROR(proc_threads[i].MaybeSaveReceivedData(query_engine));
+    costs[i].save_data_time = stopwatch.GetElapsedTime();
+    costs[i].nodes_added += container_proc->node_count() - node_count;
+    costs[i].state_elements = proc_threads[i].GetStateElements().size();
+  }
+
+  if (VLOG_IS_ON(1)) {
+    std::sort(costs.begin(), costs.end(),
+              [](const ProcInliningCost& a, const ProcInliningCost& b) {
+                return a.inline_time + a.save_data_time >
+                       b.inline_time + b.save_data_time;
+              });
+    for (const ProcInliningCost& cost : costs) {
+      VLOG(1) << absl::StreamFormat(
+          "Proc inlining cost of %s: inline %s, save data %s, %d nodes, %d "
+          "state elements",
+          cost.proc_name, absl::FormatDuration(cost.inline_time),
+          absl::FormatDuration(cost.save_data_time), cost.nodes_added,
+          cost.state_elements);
+    }
   }
 
   // Add the inlined (and top) proc state and activation bits.
@@ -48,6 +48,7 @@
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/proc_state_simulation.h"
 #include "xls/passes/query_engine.h"
 #include "xls/passes/range_query_engine.h"
 #include "xls/passes/ternary_query_engine.h"
@@ -356,19 +357,35 @@ absl::StatusOr<std::optional<RangeData>> NarrowUsingSegments(
   return std::nullopt;
 }
 
+// Narrowing removes at least this many leading bits of a state element.
+constexpr int64_t kMinNarrowedBits = 2;
+
+// Returns whether `param` is a candidate for narrowing. If the proc was
+// simulated, elements which were observed to change any of their leading
+// kMinNarrowedBits bits cannot be narrowed so are not candidates.
+bool IsNarrowingCandidate(Param* param,
+                          const std::optional<ProcStateToggles>& toggles) {
+  // TODO(allight): Being able to narrow inside a compound value would be
+  // nice. Since we unpack tuple state elements in other passes however the
+  // actual impact would likely be negligible so no reason to bother with it
+  // for now.
+  if (!param->GetType()->IsBits()) {
+    return false;
+  }
+  return !toggles.has_value() ||
+         toggles->StableLeadingBits(param) >= kMinNarrowedBits;
+}
+
 // Narrow ranges using the contextual information of the next predicates.
 absl::StatusOr<absl::flat_hash_map<Param*, RangeData>> FindContextualRanges(
     Proc* proc, const QueryEngine& qe, const RangeQueryEngine& rqe,
     const NodeDependencyAnalysis& dependency_analysis,
-    absl::Span<Node* const> reverse_topo_sort) {
+    absl::Span<Node* const> reverse_topo_sort,
+    const std::optional<ProcStateToggles>& toggles) {
   // List of all the next instructions that change the param for each param.
   absl::flat_hash_map<Param*, std::vector<Next*>> modifying_nexts_for_param;
   for (Param* param : proc->StateParams()) {
-    // TODO(allight): Being able to narrow inside a compound value would be
-    // nice. Since we unpack tuple state elements in other passes however the
-    // actual impact would likely be negligible so no reason to bother with it
-    // for now.
-    if (!param->GetType()->IsBits()) {
+    if (!IsNarrowingCandidate(param, toggles)) {
       continue;
     }
     std::vector<Next*>& nexts = modifying_nexts_for_param[param];
@@ -458,6 +475,20 @@ absl::StatusOr<absl::flat_hash_map<Param*, RangeData>> FindContextualRanges(
 absl::StatusOr<bool> ProcStateNarrowingPass::RunOnProcInternal(
     Proc* proc, const OptimizationPassOptions& options,
     PassResults* results) const {
+  // Screen out the state elements which a simulation shows cannot be narrowed
+  // before running any of the (expensive) analyses below.
+  std::optional<ProcStateToggles> toggles;
+  if (options.proc_state_simulation_ticks.has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        toggles, ProcStateToggles::Simulate(
+                     proc, *options.proc_state_simulation_ticks));
+    if (absl::c_none_of(proc->StateParams(), [&](Param* param) {
+          return IsNarrowingCandidate(param, toggles);
+        })) {
+      return false;
+    }
+  }
+
   // Find basic ternary limits
   TernaryQueryEngine tqe;
   // Use for more complicated range analysis.
@@ -483,7 +514,7 @@ absl::StatusOr<bool> ProcStateNarrowingPass::RunOnProcInternal(
   XLS_ASSIGN_OR_RETURN(
       (absl::flat_hash_map<Param*, RangeData> initial_transforms),
       FindContextualRanges(proc, qe, rqe, next_node_sources,
-                           reverse_topo_sort));
+                           reverse_topo_sort, toggles));
   absl::flat_hash_map<Param*, RangeData> final_transformation_list;
   for (const auto& [orig_param, t] : initial_transforms) {
     const auto& [ternary, interval_set] = t;
@@ -493,7 +524,7 @@ absl::StatusOr<bool> ProcStateNarrowingPass::RunOnProcInternal(
     // are usually good enough except with signed integer things (identified as
     // only being able to eliminate the sign bit or not being able to eliminate
     // anything).
-    if (known_leading > 1) {
+    if (known_leading >= kMinNarrowedBits) {
       VLOG(2) << "Narrowed " << orig_param << " to "
               << (orig_param->BitCountOrDie() - known_leading)
               << " bits (savings: " << known_leading
@@ -531,7 +562,8 @@ absl::StatusOr<bool> ProcStateNarrowingPass::RunOnProcInternal(
         NarrowUsingSegments(proc, orig_param, interval_set.Get({}), *topo_sort,
                             next_node_sources, initial_transforms));
     if (narrowed &&
-        ternary_ops::ToKnownBits(*narrowed->ternary).CountLeadingOnes() > 1) {
+        ternary_ops::ToKnownBits(*narrowed->ternary).CountLeadingOnes() >=
+            kMinNarrowedBits) {
       VLOG(2)
           << "Narrowed " << orig_param << " to "
           << (orig_param->BitCountOrDie() -
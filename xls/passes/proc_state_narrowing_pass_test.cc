@@ -29,6 +29,7 @@
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/value.h"
+#include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/proc_state_optimization_pass.h"
 #include "xls/solvers/z3_ir_equivalence_testutils.h"
@@ -78,6 +79,36 @@ TEST_F(ProcStateNarrowingPassTest, ZeroExtend) {
       UnorderedElementsAre(AllOf(m::Type(p->GetBitsType(3)), m::Param("foo"))));
 }
 
+TEST_F(ProcStateNarrowingPassTest, ZeroExtendWithSimulationPrescreen) {
+  auto p = CreatePackage();
+  ProcBuilder fb(TestName(), p.get());
+  auto st = fb.StateElement("foo", UBits(0, 32));
+  auto counter = fb.StateElement("counter", UBits(0, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto chan, p->CreateStreamingChannel("side_effect", ChannelOps::kSendOnly,
+                                           p->GetBitsType(32)));
+  fb.Send(chan, fb.Literal(Value::Token()), fb.Add(st, counter));
+  fb.Next(st, fb.ZeroExtend(
+                  fb.Add(fb.Literal(UBits(1, 3)), fb.BitSlice(st, 0, 3)), 32));
+  // Wraps around in the first tick so the simulation screens it out.
+  fb.Next(counter, fb.Sub(counter, fb.Literal(UBits(1, 32))));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, fb.Build());
+
+  OptimizationPassOptions options;
+  options.proc_state_simulation_ticks = 16;
+  PassResults r;
+  EXPECT_THAT(ProcStateNarrowingPass().Run(p.get(), options, &r),
+              IsOkAndHolds(true));
+  EXPECT_THAT(RunProcStateCleanup(proc), IsOkAndHolds(true));
+
+  EXPECT_THAT(
+      proc->StateParams(),
+      UnorderedElementsAre(
+          AllOf(m::Type(p->GetBitsType(3)), m::Param("foo")),
+          AllOf(m::Type(p->GetBitsType(32)), m::Param("counter"))));
+}
+
 TEST_F(ProcStateNarrowingPassTest, ZeroExtendMultiple) {
   auto p = CreatePackage();
   ProcBuilder fb(TestName(), p.get());
@@ -52,6 +52,7 @@
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/proc_state_simulation.h"
 #include "xls/passes/query_engine.h"
 #include "xls/passes/stateless_query_engine.h"
 #include "xls/passes/ternary_query_engine.h"
@@ -91,12 +92,17 @@ absl::StatusOr<bool> RemoveZeroWidthStateElements(Proc* proc) {
   return true;
 }
 
-absl::StatusOr<bool> RemoveConstantStateElements(Proc* proc,
-                                                 QueryEngine& query_engine) {
+// State elements which `toggles` shows to change are not considered.
+absl::StatusOr<bool> RemoveConstantStateElements(
+    Proc* proc, QueryEngine& query_engine,
+    const std::optional<ProcStateToggles>& toggles) {
   std::vector<int64_t> to_remove;
   for (int64_t i = proc->GetStateElementCount() - 1; i >= 0; --i) {
     Param* state_param = proc->GetStateParam(i);
     const Value& initial_value = proc->GetInitValueElement(i);
+    if (toggles.has_value() && toggles->Changed(state_param)) {
+      continue;
+    }
 
     // TODO(epastor): Remove this once we no longer use next-state elements.
     if (proc->next_values(state_param).empty()) {
@@ -557,6 +563,15 @@ absl::StatusOr<bool> ProcStateOptimizationPass::RunOnProcInternal(
                        RemoveZeroWidthStateElements(proc));
   changed = changed || zero_width_changed;
 
+  // Elements which a simulation shows to change cannot be constant, so there
+  // is no need to query the values of their next_value nodes.
+  std::optional<ProcStateToggles> toggles;
+  if (options.proc_state_simulation_ticks.has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        toggles, ProcStateToggles::Simulate(
+                     proc, *options.proc_state_simulation_ticks));
+  }
+
   std::vector<std::unique_ptr<QueryEngine>> query_engines;
   query_engines.push_back(std::make_unique<StatelessQueryEngine>());
   query_engines.push_back(std::make_unique<TernaryQueryEngine>());
@@ -570,7 +585,8 @@ absl::StatusOr<bool> ProcStateOptimizationPass::RunOnProcInternal(
   bool constant_changed = false;
   do {
     XLS_ASSIGN_OR_RETURN(constant_changed,
-                         RemoveConstantStateElements(proc, query_engine));
+                         RemoveConstantStateElements(proc, query_engine,
+                                                     toggles));
     if (constant_changed) {
       XLS_RETURN_IF_ERROR(query_engine.Populate(proc).status());
     }
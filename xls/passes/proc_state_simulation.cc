@@ -0,0 +1,139 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/passes/proc_state_simulation.h"
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+
+namespace xls {
+
+/* static */ absl::StatusOr<ProcStateToggles> ProcStateToggles::Simulate(
+    Proc* proc, int64_t ticks, int64_t seed) {
+  ProcStateToggles toggles;
+  for (Param* param : proc->StateParams()) {
+    if (param->GetType()->IsBits()) {
+      toggles.toggled_bits_.emplace(param, Bits(param->BitCountOrDie()));
+    }
+  }
+
+  std::mt19937_64 rng(seed);
+  std::vector<Node*> topo_sort = TopoSort(proc);
+  std::vector<Value> state(proc->InitValues().begin(),
+                           proc->InitValues().end());
+  absl::flat_hash_map<Node*, Value> values;
+  for (int64_t tick = 0; tick < ticks; ++tick) {
+    values.clear();
+    for (Node* node : topo_sort) {
+      std::vector<Value> operand_values;
+      operand_values.reserve(node->operand_count());
+      for (Node* operand : node->operands()) {
+        operand_values.push_back(values.at(operand));
+      }
+      auto predicate_is_false = [&](std::optional<Node*> predicate) {
+        return predicate.has_value() && values.at(*predicate).bits().IsZero();
+      };
+
+      if (node->Is<Param>()) {
+        XLS_ASSIGN_OR_RETURN(int64_t index,
+                             proc->GetStateParamIndex(node->As<Param>()));
+        values[node] = state[index];
+      } else if (node->Is<Receive>()) {
+        Receive* receive = node->As<Receive>();
+        if (predicate_is_false(receive->predicate()) ||
+            (!receive->is_blocking() && (rng() & 1) == 0)) {
+          values[node] = ZeroOfType(receive->GetType());
+        } else if (receive->is_blocking()) {
+          values[node] = Value::Tuple(
+              {Value::Token(), RandomValue(receive->GetPayloadType(), rng)});
+        } else {
+          values[node] = Value::Tuple(
+              {Value::Token(), RandomValue(receive->GetPayloadType(), rng),
+               Value(UBits(1, 1))});
+        }
+      } else if (node->Is<Assert>() &&
+                 values.at(node->As<Assert>()->condition()).bits().IsZero()) {
+        // Executions past a failed assertion are not valid so stop here.
+        VLOG(3) << "Assertion " << node->GetName() << " failed in tick "
+                << tick << "; stopping simulation of " << proc->name();
+        return toggles;
+      } else if (OpIsSideEffecting(node->op()) && node->op() != Op::kGate) {
+        values[node] = ZeroOfType(node->GetType());
+      } else {
+        absl::StatusOr<Value> value = InterpretNode(node, operand_values);
+        if (!value.ok()) {
+          VLOG(3) << "Unable to interpret " << node->GetName() << " ("
+                  << value.status() << "); stopping simulation of "
+                  << proc->name();
+          return toggles;
+        }
+        values[node] = *std::move(value);
+      }
+    }
+
+    // Compute the state for the next tick. A state element keeps its value if
+    // none of its next_value nodes are active.
+    for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+      Param* param = proc->GetStateParam(i);
+      if (proc->next_values(param).empty()) {
+        state[i] = values.at(proc->GetNextStateElement(i));
+      } else {
+        for (Next* next : proc->next_values(param)) {
+          if (!next->predicate().has_value() ||
+              values.at(*next->predicate()).bits().IsOne()) {
+            state[i] = values.at(next->value());
+            break;
+          }
+        }
+      }
+      const Value& init_value = proc->GetInitValueElement(i);
+      if (state[i] == init_value) {
+        continue;
+      }
+      toggles.changed_.insert(param);
+      auto it = toggles.toggled_bits_.find(param);
+      if (it != toggles.toggled_bits_.end()) {
+        it->second = bits_ops::Or(
+            it->second, bits_ops::Xor(state[i].bits(), init_value.bits()));
+      }
+    }
+  }
+  return toggles;
+}
+
+int64_t ProcStateToggles::StableLeadingBits(Param* param) const {
+  return toggled_bits_.at(param).CountLeadingZeros();
+}
+
+}  // namespace xls
@@ -0,0 +1,68 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_PASSES_PROC_STATE_SIMULATION_H_
+#define XLS_PASSES_PROC_STATE_SIMULATION_H_
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
+
+namespace xls {
+
+// The state elements of a proc (and, for bits-typed elements, the individual
+// bits) which were observed to take a value other than their initial value
+// during a bounded simulation of the proc with random inputs.
+//
+// The simulation is a real execution of the proc so a state element observed
+// to change can not be proven constant, nor can an observed bit be proven to
+// hold its initial value. Passes use this to avoid spending expensive static
+// analyses on state elements which cannot be optimized. The converse does not
+// hold: an element which was not observed to change may still change.
+class ProcStateToggles {
+ public:
+  // Simulates at most `ticks` ticks of `proc`. Each receive (with a true
+  // predicate) reads uniformly random data generated from `seed`, and
+  // non-blocking receives are randomly valid. The simulation stops early at
+  // the first tick in which an assertion fails or a node cannot be
+  // interpreted; the values observed up to that tick are kept.
+  static absl::StatusOr<ProcStateToggles> Simulate(Proc* proc, int64_t ticks,
+                                                   int64_t seed = 0);
+
+  // Whether the state element was observed to take a value other than its
+  // initial value.
+  bool Changed(Param* param) const { return changed_.contains(param); }
+
+  // The number of leading (most significant) bits of the bits-typed state
+  // element `param` which always held their initial value.
+  int64_t StableLeadingBits(Param* param) const;
+
+ private:
+  ProcStateToggles() = default;
+
+  absl::flat_hash_set<Param*> changed_;
+  // The bits of each bits-typed state element which were observed to differ
+  // from the initial value.
+  absl::flat_hash_map<Param*, Bits> toggled_bits_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_PROC_STATE_SIMULATION_H_
@@ -0,0 +1,90 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/passes/proc_state_simulation.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+class ProcStateSimulationTest : public IrTestBase {};
+
+TEST_F(ProcStateSimulationTest, CounterTogglesLowBits) {
+  auto p = CreatePackage();
+  ProcBuilder pb(TestName(), p.get());
+  BValue counter = pb.StateElement("counter", UBits(0, 32));
+  BValue constant = pb.StateElement("constant", UBits(42, 32));
+  pb.Next(counter,
+          pb.ZeroExtend(pb.Add(pb.BitSlice(counter, 0, 3),
+                               pb.Literal(UBits(1, 3))),
+                        32));
+  pb.Next(constant, pb.Literal(UBits(42, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(ProcStateToggles toggles,
+                           ProcStateToggles::Simulate(proc, /*ticks=*/16));
+  Param* counter_param = counter.node()->As<Param>();
+  Param* constant_param = constant.node()->As<Param>();
+  EXPECT_TRUE(toggles.Changed(counter_param));
+  EXPECT_EQ(toggles.StableLeadingBits(counter_param), 29);
+  EXPECT_FALSE(toggles.Changed(constant_param));
+  EXPECT_EQ(toggles.StableLeadingBits(constant_param), 32);
+}
+
+TEST_F(ProcStateSimulationTest, ReceivedDataTogglesAllBits) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in, p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly,
+                                              p->GetBitsType(8)));
+  ProcBuilder pb(TestName(), p.get());
+  BValue st = pb.StateElement("st", UBits(0, 8));
+  BValue data = pb.TupleIndex(pb.Receive(in, pb.Literal(Value::Token())), 1);
+  pb.Next(st, data);
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(ProcStateToggles toggles,
+                           ProcStateToggles::Simulate(proc, /*ticks=*/64));
+  EXPECT_TRUE(toggles.Changed(st.node()->As<Param>()));
+  EXPECT_EQ(toggles.StableLeadingBits(st.node()->As<Param>()), 0);
+}
+
+TEST_F(ProcStateSimulationTest, StopsAtFailedAssertion) {
+  auto p = CreatePackage();
+  ProcBuilder pb(TestName(), p.get());
+  BValue st = pb.StateElement("st", UBits(0, 32));
+  pb.Assert(pb.Literal(Value::Token()), pb.ULt(st, pb.Literal(UBits(2, 32))),
+            "st too large");
+  pb.Next(st, pb.Add(st, pb.Literal(UBits(1, 32))));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build());
+
+  // Only the transitions to 1 and 2 happen before the assertion fails.
+  XLS_ASSERT_OK_AND_ASSIGN(ProcStateToggles toggles,
+                           ProcStateToggles::Simulate(proc, /*ticks=*/100));
+  EXPECT_EQ(toggles.StableLeadingBits(st.node()->As<Param>()), 30);
+}
+
+}  // namespace
+}  // namespace xls
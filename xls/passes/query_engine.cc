@@ -67,15 +67,16 @@ std::vector<TreeBitLocation> ToTreeBitLocations(absl::Span<Node* const> preds) {
   return locations;
 }
 
+// How many non-trailing bits we want to consider when creating intervals from
+// a ternary. Each interval set will be made up of up to
+// `1 << kMaxTernaryIntervalBits` separate intervals.
+// "4" is arbitrary, but keeps the number of intervals from blowing up.
+constexpr int64_t kMaxTernaryIntervalBits = 4;
+
 }  // namespace
 
 LeafTypeTree<IntervalSet> QueryEngine::GetIntervals(Node* node) const {
-  // How many non-trailing bits we want to consider when creating intervals from
-  // a ternary. Each interval set will be made up of up to
-  // `1 << kMaxTernaryIntervalBits` separate intervals.
-  // "4" is arbitrary, but keeps the number of intervals from blowing up.
-  constexpr int64_t kMaxTernaryIntervalBits = 4;
-  LeafTypeTree<TernaryVector> tern = GetTernary(node);
+  SharedLeafTypeTree<TernaryVector> tern = GetTernaryShared(node);
   return leaf_type_tree::Map<IntervalSet, TernaryVector>(
       tern.AsView(), [](TernarySpan tv) -> IntervalSet {
         return interval_ops::FromTernary(
@@ -83,6 +84,13 @@ LeafTypeTree<IntervalSet> QueryEngine::GetIntervals(Node* node) const {
       });
 }
 
+IntervalSet QueryEngine::GetIntervalsElement(
+    Node* node, absl::Span<const int64_t> index) const {
+  return interval_ops::FromTernary(
+      GetTernaryElement(node, index),
+      /*max_interval_bits=*/kMaxTernaryIntervalBits);
+}
+
 std::optional<TreeBitLocation> QueryEngine::ExactlyOneBitUnknown(
     Node* node) const {
   std::optional<TreeBitLocation> unknown;
@@ -121,7 +129,7 @@ bool QueryEngine::IsKnown(const TreeBitLocation& bit) const {
   if (!IsTracked(bit.node())) {
     return false;
   }
-  return GetTernary(bit.node()).Get(bit.tree_index())[bit.bit_index()] !=
+  return GetTernaryElement(bit.node(), bit.tree_index())[bit.bit_index()] !=
          TernaryValue::kUnknown;
 }
 
@@ -130,7 +138,7 @@ std::optional<bool> QueryEngine::KnownValue(const TreeBitLocation& bit) const {
     return std::nullopt;
   }
 
-  switch (GetTernary(bit.node()).Get(bit.tree_index())[bit.bit_index()]) {
+  switch (GetTernaryElement(bit.node(), bit.tree_index())[bit.bit_index()]) {
     case TernaryValue::kUnknown:
       return std::nullopt;
     case TernaryValue::kKnownZero:
@@ -149,7 +157,7 @@ std::optional<Value> QueryEngine::KnownValue(Node* node) const {
   }
 
   bool fully_known = true;
-  LeafTypeTree<TernaryVector> ternary = GetTernary(node);
+  SharedLeafTypeTree<TernaryVector> ternary = GetTernaryShared(node);
   LeafTypeTree<Value> value = leaf_type_tree::Map<Value, TernaryVector>(
       ternary.AsView(), [&fully_known](const TernaryVector& v) {
         if (!ternary_ops::IsFullyKnown(v)) {
@@ -183,7 +191,7 @@ bool QueryEngine::IsMsbKnown(Node* node) const {
   if (!IsTracked(node)) {
     return false;
   }
-  TernaryVector ternary = GetTernary(node).Get({});
+  TernaryVector ternary = GetTernaryElement(node);
   return ternary_ops::ToKnownBits(ternary).msb();
 }
 
@@ -206,7 +214,7 @@ bool QueryEngine::IsZero(const TreeBitLocation& bit) const {
 bool QueryEngine::GetKnownMsb(Node* node) const {
   CHECK(node->GetType()->IsBits());
   CHECK(IsMsbKnown(node));
-  TernaryVector ternary = GetTernary(node).Get({});
+  TernaryVector ternary = GetTernaryElement(node);
   return ternary_ops::ToKnownBitsValues(ternary).msb();
 }
 
@@ -214,7 +222,7 @@ bool QueryEngine::IsAllZeros(Node* node) const {
   if (!IsTracked(node) || TypeHasToken(node->GetType())) {
     return false;
   }
-  LeafTypeTree<TernaryVector> ternary_value = GetTernary(node);
+  SharedLeafTypeTree<TernaryVector> ternary_value = GetTernaryShared(node);
   return absl::c_all_of(ternary_value.elements(), [](const TernaryVector& v) {
     return ternary_ops::IsKnownZero(v);
   });
@@ -224,7 +232,7 @@ bool QueryEngine::IsAllOnes(Node* node) const {
   if (!IsTracked(node) || TypeHasToken(node->GetType())) {
     return false;
   }
-  LeafTypeTree<TernaryVector> ternary_value = GetTernary(node);
+  SharedLeafTypeTree<TernaryVector> ternary_value = GetTernaryShared(node);
   return absl::c_all_of(ternary_value.elements(), [](const TernaryVector& v) {
     return ternary_ops::IsKnownOne(v);
   });
@@ -235,7 +243,7 @@ bool QueryEngine::IsFullyKnown(Node* node) const {
     return false;
   }
 
-  LeafTypeTree<TernaryVector> ternary = GetTernary(node);
+  SharedLeafTypeTree<TernaryVector> ternary = GetTernaryShared(node);
   return absl::c_all_of(ternary.elements(), [](const TernaryVector& v) {
     return ternary_ops::IsFullyKnown(v);
   });
@@ -291,8 +299,8 @@ bool QueryEngine::NodesKnownUnsignedNotEquals(Node* a, Node* b) const {
 bool QueryEngine::NodesKnownUnsignedEquals(Node* a, Node* b) const {
   CHECK(a->GetType()->IsBits());
   CHECK(b->GetType()->IsBits());
-  TernaryVector a_ternary = GetTernary(a).Get({});
-  TernaryVector b_ternary = GetTernary(b).Get({});
+  TernaryVector a_ternary = GetTernaryElement(a);
+  TernaryVector b_ternary = GetTernaryElement(b);
   return a == b ||
          (AllBitsKnown(a) && AllBitsKnown(b) &&
           bits_ops::UEqual(ternary_ops::ToKnownBitsValues(a_ternary),
@@ -302,9 +310,9 @@ bool QueryEngine::NodesKnownUnsignedEquals(Node* a, Node* b) const {
 std::string QueryEngine::ToString(Node* node) const {
   CHECK(IsTracked(node));
   if (node->GetType()->IsBits()) {
-    return xls::ToString(GetTernary(node).Get({}));
+    return xls::ToString(GetTernaryElement(node));
   }
-  return GetTernary(node).ToString(
+  return GetTernaryShared(node).ToString(
       [](const TernaryVector& v) -> std::string { return xls::ToString(v); });
 }
 
@@ -321,6 +329,14 @@ class ForwardingQueryEngine final : public QueryEngine {
   LeafTypeTree<TernaryVector> GetTernary(Node* node) const override {
     return real_.GetTernary(node);
   };
+  SharedLeafTypeTree<TernaryVector> GetTernaryShared(
+      Node* node) const override {
+    return real_.GetTernaryShared(node);
+  }
+  TernaryVector GetTernaryElement(
+      Node* node, absl::Span<const int64_t> index = {}) const override {
+    return real_.GetTernaryElement(node, index);
+  }
 
   std::unique_ptr<QueryEngine> SpecializeGivenPredicate(
       const absl::flat_hash_set<PredicateState>& state) const override {
@@ -330,6 +346,14 @@ class ForwardingQueryEngine final : public QueryEngine {
   LeafTypeTree<IntervalSet> GetIntervals(Node* node) const override {
     return real_.GetIntervals(node);
   }
+  SharedLeafTypeTree<IntervalSet> GetIntervalsShared(
+      Node* node) const override {
+    return real_.GetIntervalsShared(node);
+  }
+  IntervalSet GetIntervalsElement(
+      Node* node, absl::Span<const int64_t> index = {}) const override {
+    return real_.GetIntervalsElement(node, index);
+  }
 
   bool AtMostOneTrue(absl::Span<TreeBitLocation const> bits) const override {
     return real_.AtMostOneTrue(bits);
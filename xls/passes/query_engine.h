@@ -99,6 +99,21 @@ class QueryEngine {
   // values for the given node and what that bit's known value is.
   virtual LeafTypeTree<TernaryVector> GetTernary(Node* node) const = 0;
 
+  // Returns the same information as GetTernary, but refers to the engine's own
+  // storage rather than copying it if the engine holds the information. The
+  // result must not be used after the engine is repopulated or destroyed.
+  virtual SharedLeafTypeTree<TernaryVector> GetTernaryShared(Node* node) const {
+    return SharedLeafTypeTree<TernaryVector>(GetTernary(node));
+  }
+
+  // Returns the ternary information of the leaf element at `index` of the
+  // given node, i.e. `GetTernary(node).Get(index)`, without materializing the
+  // information for the other elements where possible.
+  virtual TernaryVector GetTernaryElement(
+      Node* node, absl::Span<const int64_t> index = {}) const {
+    return GetTernaryShared(node).Get(index);
+  }
+
   // Return a query engine which is specialized with the given predicates. The
   // reference has an lifetime of the source engine.  For now no query-engine
   // supports a state set with more than a single element. This is CHECK'd
@@ -111,6 +126,13 @@ class QueryEngine {
   // various parts of the value for a given node can exist in.
   virtual LeafTypeTree<IntervalSet> GetIntervals(Node* node) const;
 
+  // Counterparts of GetTernaryShared and GetTernaryElement for GetIntervals.
+  virtual SharedLeafTypeTree<IntervalSet> GetIntervalsShared(Node* node) const {
+    return SharedLeafTypeTree<IntervalSet>(GetIntervals(node));
+  }
+  virtual IntervalSet GetIntervalsElement(
+      Node* node, absl::Span<const int64_t> index = {}) const;
+
   // Returns true if at most one of the given bits can be true.
   virtual bool AtMostOneTrue(absl::Span<TreeBitLocation const> bits) const = 0;
 
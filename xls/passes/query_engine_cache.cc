@@ -0,0 +1,102 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/passes/query_engine_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/passes/range_query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+
+absl::flat_hash_set<Node*> GetNodesStaleSince(FunctionBase* f, int64_t epoch) {
+  absl::flat_hash_set<Node*> stale;
+  std::vector<Node*> worklist;
+  for (Node* node : f->nodes()) {
+    if (node->operands_change_epoch() > epoch && stale.insert(node).second) {
+      worklist.push_back(node);
+    }
+  }
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    for (Node* user : node->users()) {
+      if (stale.insert(user).second) {
+        worklist.push_back(user);
+      }
+    }
+  }
+  return stale;
+}
+
+template <typename EngineT>
+/* static */ QueryEngineCache::Entry<EngineT>*
+QueryEngineCache::GetOrCreateEntry(FunctionBase* f,
+                                   EntryMap<EngineT>& entries) {
+  std::unique_ptr<Entry<EngineT>>& entry = entries[f->uid()];
+  if (entry == nullptr) {
+    entry = std::make_unique<Entry<EngineT>>();
+  }
+  return entry.get();
+}
+
+template <typename EngineT>
+/* static */ absl::StatusOr<EngineT*> QueryEngineCache::UpdateEntry(
+    FunctionBase* f, Entry<EngineT>& entry) {
+  if (!entry.epoch.has_value()) {
+    XLS_RETURN_IF_ERROR(entry.engine.Populate(f).status());
+  } else if (*entry.epoch != f->change_epoch()) {
+    XLS_RETURN_IF_ERROR(
+        entry.engine.Repopulate(f, GetNodesStaleSince(f, *entry.epoch))
+            .status());
+  }
+  entry.epoch = f->change_epoch();
+  return &entry.engine;
+}
+
+absl::StatusOr<TernaryQueryEngine*> QueryEngineCache::GetTernaryQueryEngine(
+    FunctionBase* f) {
+  Entry<TernaryQueryEngine>* entry;
+  {
+    absl::MutexLock lock(&mutex_);
+    entry = GetOrCreateEntry(f, ternary_entries_);
+  }
+  // Only one pass may use the engines of a function base at a time so the
+  // entry itself needs no locking.
+  return UpdateEntry(f, *entry);
+}
+
+absl::StatusOr<RangeQueryEngine*> QueryEngineCache::GetRangeQueryEngine(
+    FunctionBase* f) {
+  Entry<RangeQueryEngine>* entry;
+  {
+    absl::MutexLock lock(&mutex_);
+    entry = GetOrCreateEntry(f, range_entries_);
+  }
+  return UpdateEntry(f, *entry);
+}
+
+}  // namespace xls
@@ -0,0 +1,95 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_PASSES_QUERY_ENGINE_CACHE_H_
+#define XLS_PASSES_QUERY_ENGINE_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/passes/range_query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+
+// Returns the nodes of `f` whose operands changed after change epoch `epoch`
+// (see Node::operands_change_epoch) along with all of their transitive users.
+// These are the nodes whose values in a forward dataflow analysis performed at
+// `epoch` may no longer be correct.
+absl::flat_hash_set<Node*> GetNodesStaleSince(FunctionBase* f, int64_t epoch);
+
+// A cache of populated query engines for the function bases of a package which
+// is shared between passes. When an engine is requested for a function base
+// which changed since the engine was last updated, only the information for
+// the nodes downstream of the changes is recomputed.
+//
+// Engines are owned by the cache and the returned pointers remain valid for
+// the lifetime of the cache. Requesting an engine for a function base updates
+// the engine in place so engines for a function base must not be used by more
+// than one pass at a time. Engines for different function bases may be
+// requested concurrently.
+class QueryEngineCache {
+ public:
+  QueryEngineCache() = default;
+  QueryEngineCache(const QueryEngineCache&) = delete;
+  QueryEngineCache& operator=(const QueryEngineCache&) = delete;
+
+  // Returns a ternary query engine populated for the current state of `f`.
+  absl::StatusOr<TernaryQueryEngine*> GetTernaryQueryEngine(FunctionBase* f);
+
+  // Returns a range query engine (without givens) populated for the current
+  // state of `f`.
+  absl::StatusOr<RangeQueryEngine*> GetRangeQueryEngine(FunctionBase* f);
+
+ private:
+  template <typename EngineT>
+  struct Entry {
+    EngineT engine;
+    // The change epoch of the function base when the engine was last updated,
+    // or nullopt if the engine was never populated.
+    std::optional<int64_t> epoch;
+  };
+
+  template <typename EngineT>
+  using EntryMap =
+      absl::flat_hash_map<int64_t, std::unique_ptr<Entry<EngineT>>>;
+
+  // Returns the entry for `f` in `entries`, creating it if necessary.
+  template <typename EngineT>
+  static Entry<EngineT>* GetOrCreateEntry(FunctionBase* f,
+                                          EntryMap<EngineT>& entries);
+
+  // Brings the engine of `entry` up to date with the current state of `f`.
+  template <typename EngineT>
+  static absl::StatusOr<EngineT*> UpdateEntry(FunctionBase* f,
+                                              Entry<EngineT>& entry);
+
+  absl::Mutex mutex_;
+  // Entries are keyed by FunctionBase::uid.
+  EntryMap<TernaryQueryEngine> ternary_entries_ ABSL_GUARDED_BY(mutex_);
+  EntryMap<RangeQueryEngine> range_entries_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_QUERY_ENGINE_CACHE_H_
@@ -0,0 +1,126 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/passes/query_engine_cache.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/value.h"
+#include "xls/passes/range_query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+namespace {
+
+using ::testing::UnorderedElementsAre;
+
+class QueryEngineCacheTest : public IrTestBase {
+ protected:
+  // Checks that the cached engines for `f` hold the same information as
+  // freshly populated engines.
+  void ExpectMatchesFreshEngines(QueryEngineCache& cache, Function* f) {
+    XLS_ASSERT_OK_AND_ASSIGN(TernaryQueryEngine * cached_ternary,
+                             cache.GetTernaryQueryEngine(f));
+    XLS_ASSERT_OK_AND_ASSIGN(RangeQueryEngine * cached_range,
+                             cache.GetRangeQueryEngine(f));
+    TernaryQueryEngine ternary;
+    XLS_ASSERT_OK(ternary.Populate(f).status());
+    RangeQueryEngine range;
+    XLS_ASSERT_OK(range.Populate(f).status());
+    for (Node* node : f->nodes()) {
+      ASSERT_TRUE(cached_ternary->IsTracked(node)) << node;
+      EXPECT_EQ(cached_ternary->GetTernary(node), ternary.GetTernary(node))
+          << node;
+      EXPECT_EQ(cached_range->GetIntervals(node), range.GetIntervals(node))
+          << node;
+    }
+  }
+};
+
+TEST_F(QueryEngineCacheTest, StaleNodesAreDownstreamOfOperandChanges) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue a = fb.Add(x, y);
+  BValue b = fb.Not(a);
+  BValue c = fb.Negate(y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Tuple({b, c})));
+  Node* tuple = f->return_value();
+
+  int64_t epoch = f->change_epoch();
+  EXPECT_TRUE(GetNodesStaleSince(f, epoch).empty());
+
+  // Changing an operand of `a` makes it and its transitive users stale, but
+  // not its old operand `y` whose users changed.
+  XLS_ASSERT_OK(a.node()->ReplaceOperandNumber(1, x.node()));
+  EXPECT_THAT(GetNodesStaleSince(f, epoch),
+              UnorderedElementsAre(a.node(), b.node(), tuple));
+}
+
+TEST_F(QueryEngineCacheTest, MatchesFreshEnginesAfterChanges) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue masked = fb.And(x, fb.Literal(UBits(0x0f, 8)));
+  BValue sum = fb.Add(masked, fb.ZeroExtend(fb.BitSlice(y, 0, 2), 8));
+  BValue shifted = fb.Shll(sum, fb.Literal(UBits(1, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f, fb.BuildWithReturnValue(fb.Tuple({shifted, fb.Not(y)})));
+
+  QueryEngineCache cache;
+  ExpectMatchesFreshEngines(cache, f);
+
+  // Unchanged functions return the same engine without recomputation.
+  XLS_ASSERT_OK_AND_ASSIGN(TernaryQueryEngine * first,
+                           cache.GetTernaryQueryEngine(f));
+  XLS_ASSERT_OK_AND_ASSIGN(TernaryQueryEngine * second,
+                           cache.GetTernaryQueryEngine(f));
+  EXPECT_EQ(first, second);
+
+  // Narrow the mask, which changes the information of everything downstream.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Literal * narrow_mask,
+      f->MakeNode<Literal>(SourceInfo(), Value(UBits(3, 8))));
+  XLS_ASSERT_OK(masked.node()->ReplaceOperandNumber(1, narrow_mask));
+  ExpectMatchesFreshEngines(cache, f);
+
+  // Replace a node and remove the original.
+  Node* old_sum = sum.node();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_sum,
+      f->MakeNode<BinOp>(SourceInfo(), masked.node(), masked.node(), Op::kAdd));
+  XLS_ASSERT_OK(old_sum->ReplaceUsesWith(new_sum));
+  XLS_ASSERT_OK(f->RemoveNode(old_sum));
+  ExpectMatchesFreshEngines(cache, f);
+}
+
+}  // namespace
+}  // namespace xls
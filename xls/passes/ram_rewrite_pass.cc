@@ -18,24 +18,31 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string_view>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/casts.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/proc.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/ternary.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
@@ -43,6 +50,8 @@
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
 
 namespace xls {
 namespace {
@@ -732,6 +741,375 @@ absl::StatusOr<Type*> DataTypeFromChannels(
   }
   return data_type.value();
 }
+
+// The sends and receives of one proc on the channels of an abstract RAM, each
+// in topological order.
+struct AbstractRamAccesses {
+  std::vector<Send*> read_reqs;
+  std::vector<Receive*> read_resps;
+  std::vector<Send*> write_reqs;
+  std::vector<Receive*> write_completions;
+};
+
+absl::StatusOr<absl::flat_hash_map<Proc*, AbstractRamAccesses>>
+GetAbstractRamAccesses(
+    Package* p, const absl::flat_hash_map<RamLogicalChannel, Channel*>&
+                    logical_to_channels) {
+  absl::flat_hash_map<Channel*, RamLogicalChannel> reverse_mapping;
+  for (const auto& [logical_channel, channel] : logical_to_channels) {
+    reverse_mapping[channel] = logical_channel;
+  }
+  absl::flat_hash_map<Proc*, AbstractRamAccesses> accesses;
+  for (auto& proc : p->procs()) {
+    for (Node* node : TopoSort(proc.get())) {
+      if (!node->Is<Send>() && !node->Is<Receive>()) {
+        continue;
+      }
+      std::string_view channel_name = node->Is<Send>()
+                                          ? node->As<Send>()->channel_name()
+                                          : node->As<Receive>()->channel_name();
+      XLS_ASSIGN_OR_RETURN(Channel * channel, p->GetChannel(channel_name));
+      auto it = reverse_mapping.find(channel);
+      if (it == reverse_mapping.end()) {
+        continue;
+      }
+      AbstractRamAccesses& proc_accesses = accesses[proc.get()];
+      switch (it->second) {
+        case RamLogicalChannel::kAbstractReadReq:
+          proc_accesses.read_reqs.push_back(node->As<Send>());
+          break;
+        case RamLogicalChannel::kAbstractReadResp:
+          proc_accesses.read_resps.push_back(node->As<Receive>());
+          break;
+        case RamLogicalChannel::kAbstractWriteReq:
+          proc_accesses.write_reqs.push_back(node->As<Send>());
+          break;
+        case RamLogicalChannel::kWriteCompletion:
+          proc_accesses.write_completions.push_back(node->As<Receive>());
+          break;
+        default:
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Invalid logical channel %s for abstract RAM.",
+              RamLogicalChannelName(it->second)));
+      }
+    }
+  }
+  return accesses;
+}
+
+// A banked RAM has to steer each response from the bank which served the
+// matching request, so the response must be attributable to its request: the
+// i-th receive of a proc (in topological order) must be predicated identically
+// to the i-th send. Returns an error if this is not the case.
+absl::Status CheckResponsesPaired(absl::Span<Send* const> requests,
+                                  absl::Span<Receive* const> responses) {
+  if (responses.empty()) {
+    return absl::OkStatus();
+  }
+  if (requests.size() != responses.size()) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "Cannot bank RAM: %d requests but %d responses in proc %s.",
+        requests.size(), responses.size(),
+        requests.empty() ? responses.front()->function_base()->name()
+                         : requests.front()->function_base()->name()));
+  }
+  for (int64_t i = 0; i < requests.size(); ++i) {
+    if (requests[i]->predicate() != responses[i]->predicate()) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "Cannot bank RAM: response %s is not predicated like request %s.",
+          responses[i]->GetName(), requests[i]->GetName()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CheckResponsesPaired(const AbstractRamAccesses& accesses) {
+  XLS_RETURN_IF_ERROR(
+      CheckResponsesPaired(accesses.read_reqs, accesses.read_resps));
+  return CheckResponsesPaired(accesses.write_reqs, accesses.write_completions);
+}
+
+// Adds to `counts` one for each bank which the `bank_bit_count` low bits of the
+// address of `request` may select.
+void CountPossibleBanks(const QueryEngine& query_engine, Send* request,
+                        int64_t bank_bit_count, std::vector<int64_t>& counts) {
+  // The address is the first element of the request.
+  TernaryVector address = query_engine.GetTernary(request->data()).Get({0});
+  for (int64_t bank = 0; bank < counts.size(); ++bank) {
+    bool possible = true;
+    for (int64_t bit = 0; bit < bank_bit_count; ++bit) {
+      TernaryValue known = address[bit];
+      bool bank_bit = ((bank >> bit) & 1) == 1;
+      if ((known == TernaryValue::kKnownOne && !bank_bit) ||
+          (known == TernaryValue::kKnownZero && bank_bit)) {
+        possible = false;
+        break;
+      }
+    }
+    if (possible) {
+      ++counts[bank];
+    }
+  }
+}
+
+// Returns the largest number of `requests` which may go to the same bank in one
+// activation of their proc.
+int64_t MaxRequestsPerBank(const QueryEngine& query_engine,
+                           absl::Span<Send* const> requests,
+                           int64_t bank_bit_count) {
+  std::vector<int64_t> counts(int64_t{1} << bank_bit_count, 0);
+  for (Send* request : requests) {
+    CountPossibleBanks(query_engine, request, bank_bit_count, counts);
+  }
+  return *std::max_element(counts.begin(), counts.end());
+}
+
+// Returns the smallest bank count for which no bank of a RAM of kind
+// `to_config.kind` is asked to serve more accesses per proc activation than its
+// ports allow within `worst_case_throughput` cycles. Returns 1 (no banking) if
+// the accesses of the procs fit without banking or if no bank count achieves
+// this.
+absl::StatusOr<int64_t> ChooseBankCount(
+    const absl::flat_hash_map<Proc*, AbstractRamAccesses>& accesses,
+    const RamConfig& to_config, int64_t worst_case_throughput) {
+  absl::flat_hash_map<Proc*, std::unique_ptr<TernaryQueryEngine>>
+      query_engines;
+  for (const auto& [proc, _] : accesses) {
+    auto query_engine = std::make_unique<TernaryQueryEngine>();
+    XLS_RETURN_IF_ERROR(query_engine->Populate(proc).status());
+    query_engines[proc] = std::move(query_engine);
+  }
+  for (int64_t bank_bit_count = 0;
+       (int64_t{1} << bank_bit_count) <= to_config.depth &&
+       to_config.depth % (int64_t{1} << bank_bit_count) == 0;
+       ++bank_bit_count) {
+    bool fits = true;
+    for (const auto& [proc, proc_accesses] : accesses) {
+      const QueryEngine& query_engine = *query_engines.at(proc);
+      if (to_config.kind == RamKind::k1R1W) {
+        // Reads and writes are served by separate ports.
+        fits = fits &&
+               MaxRequestsPerBank(query_engine, proc_accesses.read_reqs,
+                                  bank_bit_count) <= worst_case_throughput &&
+               MaxRequestsPerBank(query_engine, proc_accesses.write_reqs,
+                                  bank_bit_count) <= worst_case_throughput;
+      } else {
+        std::vector<Send*> requests = proc_accesses.read_reqs;
+        requests.insert(requests.end(), proc_accesses.write_reqs.begin(),
+                        proc_accesses.write_reqs.end());
+        fits = fits && MaxRequestsPerBank(query_engine, requests,
+                                          bank_bit_count) <=
+                           worst_case_throughput;
+      }
+    }
+    if (fits) {
+      return int64_t{1} << bank_bit_count;
+    }
+  }
+  VLOG(2) << "No bank count achieves a worst case throughput of "
+          << worst_case_throughput << "; not banking.";
+  return 1;
+}
+
+// Replaces `request` (whose payload starts with the address) with a send on
+// the corresponding channel of each bank, predicated on the `bank_bit_count`
+// low bits of the address selecting that bank and carrying the remaining
+// address bits. Returns the bank select.
+absl::StatusOr<Node*> BankRequest(Proc* proc, Send* request,
+                                  int64_t bank_bit_count,
+                                  absl::Span<Channel* const> bank_channels) {
+  const SourceInfo& loc = request->loc();
+  Node* payload = request->data();
+  std::vector<Node*> elements;
+  for (int64_t i = 0; i < payload->GetType()->AsTupleOrDie()->size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(Node * element,
+                         proc->MakeNode<TupleIndex>(loc, payload, i));
+    elements.push_back(element);
+  }
+  Node* address = elements.front();
+  int64_t address_width = address->BitCountOrDie();
+  XLS_ASSIGN_OR_RETURN(Node * bank, proc->MakeNode<BitSlice>(
+                                        loc, address, /*start=*/0,
+                                        /*width=*/bank_bit_count));
+  XLS_ASSIGN_OR_RETURN(
+      elements.front(),
+      proc->MakeNode<BitSlice>(loc, address, /*start=*/bank_bit_count,
+                               /*width=*/address_width - bank_bit_count));
+  XLS_ASSIGN_OR_RETURN(Node * bank_payload,
+                       proc->MakeNode<Tuple>(loc, elements));
+
+  std::vector<Node*> tokens;
+  for (int64_t b = 0; b < bank_channels.size(); ++b) {
+    XLS_ASSIGN_OR_RETURN(Node * bank_index,
+                         proc->MakeNode<Literal>(
+                             loc, Value(UBits(b, bank_bit_count))));
+    XLS_ASSIGN_OR_RETURN(Node * predicate,
+                         proc->MakeNode<CompareOp>(loc, bank, bank_index,
+                                                   Op::kEq));
+    if (request->predicate().has_value()) {
+      XLS_ASSIGN_OR_RETURN(
+          predicate,
+          proc->MakeNode<NaryOp>(
+              loc, std::vector<Node*>{*request->predicate(), predicate},
+              Op::kAnd));
+    }
+    XLS_ASSIGN_OR_RETURN(
+        Node * token,
+        proc->MakeNode<Send>(loc, request->token(), bank_payload, predicate,
+                             bank_channels[b]->name()));
+    tokens.push_back(token);
+  }
+  XLS_RETURN_IF_ERROR(
+      request->ReplaceUsesWithNew<AfterAll>(tokens).status());
+  XLS_RETURN_IF_ERROR(proc->RemoveNode(request));
+  return bank;
+}
+
+// Replaces `response` with a receive on the corresponding channel of each bank,
+// predicated on `bank` (the bank select of the matching request) and returns
+// the result of the selected bank's receive.
+absl::Status BankResponse(Proc* proc, Receive* response, Node* bank,
+                          absl::Span<Channel* const> bank_channels) {
+  const SourceInfo& loc = response->loc();
+  int64_t bank_bit_count = bank->BitCountOrDie();
+  std::vector<Node*> receives;
+  std::vector<Node*> tokens;
+  for (int64_t b = 0; b < bank_channels.size(); ++b) {
+    XLS_ASSIGN_OR_RETURN(Node * bank_index,
+                         proc->MakeNode<Literal>(
+                             loc, Value(UBits(b, bank_bit_count))));
+    XLS_ASSIGN_OR_RETURN(Node * predicate,
+                         proc->MakeNode<CompareOp>(loc, bank, bank_index,
+                                                   Op::kEq));
+    if (response->predicate().has_value()) {
+      XLS_ASSIGN_OR_RETURN(
+          predicate,
+          proc->MakeNode<NaryOp>(
+              loc, std::vector<Node*>{*response->predicate(), predicate},
+              Op::kAnd));
+    }
+    XLS_ASSIGN_OR_RETURN(
+        Node * receive,
+        proc->MakeNode<Receive>(loc, response->token(), predicate,
+                                bank_channels[b]->name(),
+                                response->is_blocking()));
+    XLS_ASSIGN_OR_RETURN(Node * token,
+                         proc->MakeNode<TupleIndex>(loc, receive, 0));
+    receives.push_back(receive);
+    tokens.push_back(token);
+  }
+  // The result is (token, payload) or, for a non-blocking receive, (token,
+  // payload, valid); select everything but the token from the bank.
+  std::vector<Node*> elements;
+  XLS_ASSIGN_OR_RETURN(Node * token, proc->MakeNode<AfterAll>(loc, tokens));
+  elements.push_back(token);
+  for (int64_t i = 1; i < response->GetType()->AsTupleOrDie()->size(); ++i) {
+    std::vector<Node*> cases;
+    for (Node* receive : receives) {
+      XLS_ASSIGN_OR_RETURN(Node * element,
+                           proc->MakeNode<TupleIndex>(loc, receive, i));
+      cases.push_back(element);
+    }
+    XLS_ASSIGN_OR_RETURN(
+        Node * selected,
+        proc->MakeNode<Select>(loc, bank, cases,
+                               /*default_value=*/std::nullopt));
+    elements.push_back(selected);
+  }
+  XLS_RETURN_IF_ERROR(response->ReplaceUsesWithNew<Tuple>(elements).status());
+  return proc->RemoveNode(response);
+}
+
+// Splits the abstract RAM on `logical_to_channels` into `bank_count` abstract
+// RAMs, bank `b` holding word `addr` at address `addr / bank_count` for each
+// `addr` with `addr % bank_count == b`. Returns the channels of each bank; only
+// the logical channels present in `logical_to_channels` are returned.
+absl::StatusOr<std::vector<absl::flat_hash_map<RamLogicalChannel, Channel*>>>
+BankAbstractRam(
+    Package* p,
+    const absl::flat_hash_map<RamLogicalChannel, Channel*>& logical_to_channels,
+    const absl::flat_hash_map<Proc*, AbstractRamAccesses>& accesses,
+    const RamConfig& bank_config, Type* data_type,
+    ChannelStrictness strictness, int64_t bank_count,
+    std::string_view name_prefix) {
+  int64_t bank_bit_count = CeilOfLog2(bank_count);
+  std::vector<absl::flat_hash_map<RamLogicalChannel, Channel*>> banks;
+  absl::flat_hash_map<RamLogicalChannel, std::vector<Channel*>>
+      bank_channels_by_logical_channel;
+  for (int64_t b = 0; b < bank_count; ++b) {
+    XLS_ASSIGN_OR_RETURN(
+        auto bank_channels,
+        MakeChannels(p, absl::StrFormat("%s_bank%d_abstract", name_prefix, b),
+                     bank_config, data_type, strictness));
+    absl::flat_hash_map<RamLogicalChannel, Channel*>& bank =
+        banks.emplace_back();
+    for (auto& [logical_channel, channel] : bank_channels) {
+      if (logical_to_channels.contains(logical_channel)) {
+        bank[logical_channel] = channel;
+        bank_channels_by_logical_channel[logical_channel].push_back(channel);
+      } else {
+        XLS_RETURN_IF_ERROR(p->RemoveChannel(channel));
+      }
+    }
+  }
+
+  auto rewrite = [&](Proc* proc, absl::Span<Send* const> requests,
+                     RamLogicalChannel request_channel,
+                     absl::Span<Receive* const> responses,
+                     RamLogicalChannel response_channel) -> absl::Status {
+    for (int64_t i = 0; i < requests.size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          Node * bank,
+          BankRequest(proc, requests[i], bank_bit_count,
+                      bank_channels_by_logical_channel.at(request_channel)));
+      if (!responses.empty()) {
+        XLS_RETURN_IF_ERROR(BankResponse(
+            proc, responses[i], bank,
+            bank_channels_by_logical_channel.at(response_channel)));
+      }
+    }
+    return absl::OkStatus();
+  };
+  for (const auto& [proc, proc_accesses] : accesses) {
+    XLS_RETURN_IF_ERROR(rewrite(proc, proc_accesses.read_reqs,
+                                RamLogicalChannel::kAbstractReadReq,
+                                proc_accesses.read_resps,
+                                RamLogicalChannel::kAbstractReadResp));
+    XLS_RETURN_IF_ERROR(rewrite(proc, proc_accesses.write_reqs,
+                                RamLogicalChannel::kAbstractWriteReq,
+                                proc_accesses.write_completions,
+                                RamLogicalChannel::kWriteCompletion));
+  }
+  return banks;
+}
+
+// Rewrites the RAM on `old_logical_to_channels` into a RAM of config
+// `to_config` whose channels are named with `name_prefix`, and removes the old
+// channels.
+absl::Status RewriteRam(
+    Package* p,
+    const absl::flat_hash_map<RamLogicalChannel, Channel*>&
+        old_logical_to_channels,
+    const RamConfig& from_config, const RamConfig& to_config,
+    std::string_view name_prefix, Type* data_type,
+    ChannelStrictness strictness,
+    const std::optional<ram_model_builder_t>& model_builder) {
+  XLS_ASSIGN_OR_RETURN(
+      auto new_logical_to_channels,
+      GetChannelsForNewRam(p, name_prefix, to_config, data_type, strictness,
+                           model_builder));
+  XLS_RETURN_IF_ERROR(ReplaceChannelReferences(p, old_logical_to_channels,
+                                               from_config, data_type,
+                                               new_logical_to_channels,
+                                               to_config));
+
+  // ReplaceChannelReferences() removes old sends and receives, but the old
+  // channels are still there. Remove them.
+  for (auto& [logical_name, channel] : old_logical_to_channels) {
+    XLS_RETURN_IF_ERROR(p->RemoveChannel(channel));
+  }
+  return absl::OkStatus();
+}
 }  // namespace
 
 absl::StatusOr<RamLogicalChannel> RamLogicalChannelFromName(
@@ -830,19 +1208,84 @@ absl::StatusOr<bool> RamRewritePass::RunInternal(
                      strictnesses.begin()));
     ChannelStrictness strictness = strictnesses.front();
 
+    if (!rewrite.bank_count.has_value() &&
+        !rewrite.worst_case_throughput.has_value()) {
+      XLS_RETURN_IF_ERROR(RewriteRam(p, old_logical_to_channels,
+                                     rewrite.from_config, rewrite.to_config,
+                                     rewrite.to_name_prefix, data_type,
+                                     strictness, rewrite.model_builder));
+      continue;
+    }
+
+    if (rewrite.from_config.kind != RamKind::kAbstract) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "Banking is only supported when rewriting from an abstract RAM, got "
+          "%s.",
+          RamKindToString(rewrite.from_config.kind)));
+    }
+    if (rewrite.model_builder.has_value()) {
+      return absl::UnimplementedError(
+          "Banking is not supported with a RAM model builder.");
+    }
+    XLS_ASSIGN_OR_RETURN(auto accesses,
+                         GetAbstractRamAccesses(p, old_logical_to_channels));
+    int64_t bank_count;
+    if (rewrite.bank_count.has_value()) {
+      bank_count = *rewrite.bank_count;
+      if (bank_count < 1 || !IsPowerOfTwo(static_cast<uint64_t>(bank_count)) ||
+          rewrite.from_config.depth % bank_count != 0 ||
+          rewrite.to_config.depth % bank_count != 0) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Bank count must be a power of two dividing the RAM depth %d, got "
+            "%d.",
+            rewrite.to_config.depth, bank_count));
+      }
+      for (const auto& [_, proc_accesses] : accesses) {
+        XLS_RETURN_IF_ERROR(CheckResponsesPaired(proc_accesses));
+      }
+    } else {
+      bank_count = 1;
+      bool paired = true;
+      for (const auto& [_, proc_accesses] : accesses) {
+        if (absl::Status status = CheckResponsesPaired(proc_accesses);
+            !status.ok()) {
+          VLOG(2) << "Not banking: " << status.message();
+          paired = false;
+        }
+      }
+      if (paired) {
+        XLS_ASSIGN_OR_RETURN(
+            bank_count,
+            ChooseBankCount(accesses, rewrite.to_config,
+                            *rewrite.worst_case_throughput));
+      }
+    }
+    if (bank_count == 1) {
+      XLS_RETURN_IF_ERROR(RewriteRam(p, old_logical_to_channels,
+                                     rewrite.from_config, rewrite.to_config,
+                                     rewrite.to_name_prefix, data_type,
+                                     strictness, rewrite.model_builder));
+      continue;
+    }
+
+    RamConfig bank_from_config = rewrite.from_config;
+    bank_from_config.depth = rewrite.from_config.depth / bank_count;
+    RamConfig bank_to_config = rewrite.to_config;
+    bank_to_config.depth = rewrite.to_config.depth / bank_count;
     XLS_ASSIGN_OR_RETURN(
-        auto new_logical_to_channels,
-        GetChannelsForNewRam(p, rewrite.to_name_prefix, rewrite.to_config,
-                             data_type, strictness, rewrite.model_builder));
-    XLS_RETURN_IF_ERROR(ReplaceChannelReferences(
-        p, old_logical_to_channels, rewrite.from_config, data_type,
-        new_logical_to_channels, rewrite.to_config));
-
-    // ReplaceChannelReferences() removes old sends and receives, but the old
-    // channels are still there. Remove them.
+        auto banks,
+        BankAbstractRam(p, old_logical_to_channels, accesses, bank_from_config,
+                        data_type, strictness, bank_count,
+                        rewrite.to_name_prefix));
     for (auto& [logical_name, channel] : old_logical_to_channels) {
       XLS_RETURN_IF_ERROR(p->RemoveChannel(channel));
     }
+    for (int64_t b = 0; b < banks.size(); ++b) {
+      XLS_RETURN_IF_ERROR(RewriteRam(
+          p, banks[b], bank_from_config, bank_to_config,
+          absl::StrFormat("%s_bank%d", rewrite.to_name_prefix, b), data_type,
+          strictness, /*model_builder=*/std::nullopt));
+    }
   }
   return !options.ram_rewrites.empty();
 }
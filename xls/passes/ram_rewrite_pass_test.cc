@@ -804,5 +804,213 @@ TEST_F(RamRewritePassTest, MultipleAbstractTo1RWAnd1R1WRewrite) {
   EXPECT_THAT(p->GetChannel("ram_1r1w_1_write_completion").value(),
               m::ChannelWithType("()"));
 }
+
+TEST_F(RamRewritePassTest, BankedAbstractTo1RWRewrite) {
+  auto p = std::make_unique<Package>(TestName());
+  auto pb = MakeProcBuilder(p.get(), "p");
+  RamConfig config_abstract{.kind = RamKind::kAbstract,
+                            .depth = 1024,
+                            .word_partition_size = std::nullopt,
+                            .initial_value = std::nullopt};
+  RamConfig config_1rw = config_abstract;
+  config_1rw.kind = RamKind::k1RW;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto abstract_ram_channels,
+      MakeAbstractRam(p.get(), config_abstract, "ram_abstract",
+                      /*data_type=*/p->GetBitsType(32)));
+  auto& [ram_abstract_read_req, ram_abstract_read_resp, ram_abstract_write_req,
+         ram_abstract_write_resp] = abstract_ram_channels;
+
+  BValue addr = pb->StateElement("addr", Value(UBits(0, 10)));
+  pb->Send(ram_abstract_read_req, pb->Tuple({addr, pb->Tuple({})}));
+  BValue read_data = pb->TupleIndex(pb->Receive(ram_abstract_read_resp), 0);
+  pb->Send(ram_abstract_write_req,
+           pb->Tuple({addr, read_data, pb->Tuple({})}));
+  pb->Receive(ram_abstract_write_resp);
+
+  XLS_ASSERT_OK(pb->Build({pb->Add(addr, pb->Literal(UBits(1, 10)))}).status());
+  XLS_ASSERT_OK(p->SetTopByName("p"));
+
+  std::vector<RamRewrite> ram_rewrites{RamRewrite{
+      .from_config = config_abstract,
+      .from_channels_logical_to_physical =
+          absl::flat_hash_map<std::string, std::string>{
+              {"abstract_read_req", "ram_abstract_read_req"},
+              {"abstract_read_resp", "ram_abstract_read_resp"},
+              {"abstract_write_req", "ram_abstract_write_req"},
+              {"write_completion", "ram_abstract_write_resp"},
+          },
+      .to_config = config_1rw,
+      .to_name_prefix = "ram_1rw",
+      .model_builder = std::nullopt,
+      .bank_count = 2,
+  }};
+  EXPECT_THAT(Run(p.get(), ram_rewrites), IsOkAndHolds(true));
+  EXPECT_EQ(p->procs().size(), 1);
+  EXPECT_EQ(p->channels().size(), 6);
+  for (std::string_view bank : {"ram_1rw_bank0", "ram_1rw_bank1"}) {
+    EXPECT_THAT(p->GetChannel(absl::StrCat(bank, "_req")).value(),
+                m::ChannelWithType(
+                    "(bits[9], bits[32], (), (), bits[1], bits[1])"));
+    EXPECT_THAT(p->GetChannel(absl::StrCat(bank, "_resp")).value(),
+                m::ChannelWithType("(bits[32])"));
+    EXPECT_THAT(p->GetChannel(absl::StrCat(bank, "_write_completion")).value(),
+                m::ChannelWithType("()"));
+  }
+}
+
+TEST_F(RamRewritePassTest, MultipleBankedAbstractTo1RWRewrite) {
+  auto p = std::make_unique<Package>(TestName());
+  auto pb = MakeProcBuilder(p.get(), "p");
+  RamConfig config_abstract{.kind = RamKind::kAbstract,
+                            .depth = 1024,
+                            .word_partition_size = std::nullopt,
+                            .initial_value = std::nullopt};
+  RamConfig config_1rw = config_abstract;
+  config_1rw.kind = RamKind::k1RW;
+  BValue addr = pb->StateElement("addr", Value(UBits(0, 10)));
+  std::vector<RamRewrite> ram_rewrites;
+  for (int64_t i = 0; i < 2; ++i) {
+    std::string name = absl::StrCat("ram_abstract", i);
+    XLS_ASSERT_OK_AND_ASSIGN(
+        auto abstract_ram_channels,
+        MakeAbstractRam(p.get(), config_abstract, name,
+                        /*data_type=*/p->GetBitsType(32)));
+    auto& [read_req, read_resp, write_req, write_resp] = abstract_ram_channels;
+    pb->Send(read_req, pb->Tuple({addr, pb->Tuple({})}));
+    BValue read_data = pb->TupleIndex(pb->Receive(read_resp), 0);
+    pb->Send(write_req, pb->Tuple({addr, read_data, pb->Tuple({})}));
+    pb->Receive(write_resp);
+    ram_rewrites.push_back(RamRewrite{
+        .from_config = config_abstract,
+        .from_channels_logical_to_physical =
+            absl::flat_hash_map<std::string, std::string>{
+                {"abstract_read_req", absl::StrCat(name, "_read_req")},
+                {"abstract_read_resp", absl::StrCat(name, "_read_resp")},
+                {"abstract_write_req", absl::StrCat(name, "_write_req")},
+                {"write_completion", absl::StrCat(name, "_write_resp")},
+            },
+        .to_config = config_1rw,
+        .to_name_prefix = absl::StrCat("ram_1rw_", i),
+        .model_builder = std::nullopt,
+        .bank_count = 2,
+    });
+  }
+
+  XLS_ASSERT_OK(pb->Build({pb->Add(addr, pb->Literal(UBits(1, 10)))}).status());
+  XLS_ASSERT_OK(p->SetTopByName("p"));
+
+  // Every rewrite is applied, not just the first one.
+  EXPECT_THAT(Run(p.get(), ram_rewrites), IsOkAndHolds(true));
+  EXPECT_EQ(p->procs().size(), 1);
+  EXPECT_EQ(p->channels().size(), 12);
+  for (std::string_view bank : {"ram_1rw_0_bank0", "ram_1rw_0_bank1",
+                                "ram_1rw_1_bank0", "ram_1rw_1_bank1"}) {
+    EXPECT_THAT(p->GetChannel(absl::StrCat(bank, "_req")).value(),
+                m::ChannelWithType(
+                    "(bits[9], bits[32], (), (), bits[1], bits[1])"));
+    EXPECT_THAT(p->GetChannel(absl::StrCat(bank, "_resp")).value(),
+                m::ChannelWithType("(bits[32])"));
+    EXPECT_THAT(p->GetChannel(absl::StrCat(bank, "_write_completion")).value(),
+                m::ChannelWithType("()"));
+  }
+}
+
+TEST_F(RamRewritePassTest, BankCountChosenFromThroughput) {
+  auto p = std::make_unique<Package>(TestName());
+  auto pb = MakeProcBuilder(p.get(), "p");
+  RamConfig config_abstract{.kind = RamKind::kAbstract,
+                            .depth = 1024,
+                            .word_partition_size = std::nullopt,
+                            .initial_value = std::nullopt};
+  RamConfig config_1rw = config_abstract;
+  config_1rw.kind = RamKind::k1RW;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto abstract_ram_channels,
+      MakeAbstractRam(p.get(), config_abstract, "ram_abstract",
+                      /*data_type=*/p->GetBitsType(32)));
+  auto& [ram_abstract_read_req, ram_abstract_read_resp, ram_abstract_write_req,
+         ram_abstract_write_resp] = abstract_ram_channels;
+
+  // Reads go to even addresses and writes to odd addresses, so two banks let
+  // both be served in the same cycle.
+  BValue row = pb->StateElement("row", Value(UBits(0, 9)));
+  BValue even = pb->Concat({row, pb->Literal(UBits(0, 1))});
+  BValue odd = pb->Concat({row, pb->Literal(UBits(1, 1))});
+  pb->Send(ram_abstract_read_req, pb->Tuple({even, pb->Tuple({})}));
+  BValue read_data = pb->TupleIndex(pb->Receive(ram_abstract_read_resp), 0);
+  pb->Send(ram_abstract_write_req, pb->Tuple({odd, read_data, pb->Tuple({})}));
+  pb->Receive(ram_abstract_write_resp);
+
+  XLS_ASSERT_OK(pb->Build({pb->Add(row, pb->Literal(UBits(1, 9)))}).status());
+  XLS_ASSERT_OK(p->SetTopByName("p"));
+
+  std::vector<RamRewrite> ram_rewrites{RamRewrite{
+      .from_config = config_abstract,
+      .from_channels_logical_to_physical =
+          absl::flat_hash_map<std::string, std::string>{
+              {"abstract_read_req", "ram_abstract_read_req"},
+              {"abstract_read_resp", "ram_abstract_read_resp"},
+              {"abstract_write_req", "ram_abstract_write_req"},
+              {"write_completion", "ram_abstract_write_resp"},
+          },
+      .to_config = config_1rw,
+      .to_name_prefix = "ram_1rw",
+      .model_builder = std::nullopt,
+      .worst_case_throughput = 1,
+  }};
+  EXPECT_THAT(Run(p.get(), ram_rewrites), IsOkAndHolds(true));
+  EXPECT_THAT(p->GetChannel("ram_1rw_bank0_req").value(),
+              m::ChannelWithType(
+                  "(bits[9], bits[32], (), (), bits[1], bits[1])"));
+  EXPECT_THAT(p->GetChannel("ram_1rw_bank1_req").value(),
+              m::ChannelWithType(
+                  "(bits[9], bits[32], (), (), bits[1], bits[1])"));
+  EXPECT_FALSE(p->GetChannel("ram_1rw_req").ok());
+}
+
+TEST_F(RamRewritePassTest, BankCountMustBePowerOfTwo) {
+  auto p = std::make_unique<Package>(TestName());
+  auto pb = MakeProcBuilder(p.get(), "p");
+  RamConfig config_abstract{.kind = RamKind::kAbstract,
+                            .depth = 1024,
+                            .word_partition_size = std::nullopt,
+                            .initial_value = std::nullopt};
+  RamConfig config_1rw = config_abstract;
+  config_1rw.kind = RamKind::k1RW;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto abstract_ram_channels,
+      MakeAbstractRam(p.get(), config_abstract, "ram_abstract",
+                      /*data_type=*/p->GetBitsType(32)));
+  auto& [ram_abstract_read_req, ram_abstract_read_resp, ram_abstract_write_req,
+         ram_abstract_write_resp] = abstract_ram_channels;
+
+  pb->Send(ram_abstract_read_req, pb->Literal(Value::Tuple({
+                                      Value(UBits(0, 10)),  // addr
+                                      Value::Tuple({})      // mask
+                                  })));
+  pb->Receive(ram_abstract_read_resp);
+
+  XLS_ASSERT_OK(pb->Build({}).status());
+  XLS_ASSERT_OK(p->SetTopByName("p"));
+
+  std::vector<RamRewrite> ram_rewrites{RamRewrite{
+      .from_config = config_abstract,
+      .from_channels_logical_to_physical =
+          absl::flat_hash_map<std::string, std::string>{
+              {"abstract_read_req", "ram_abstract_read_req"},
+              {"abstract_read_resp", "ram_abstract_read_resp"},
+              {"abstract_write_req", "ram_abstract_write_req"},
+              {"write_completion", "ram_abstract_write_resp"},
+          },
+      .to_config = config_1rw,
+      .to_name_prefix = "ram_1rw",
+      .model_builder = std::nullopt,
+      .bank_count = 3,
+  }};
+  EXPECT_THAT(Run(p.get(), ram_rewrites),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("power of two")));
+}
 }  // namespace
 }  // namespace xls
@@ -28,6 +28,7 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -303,6 +304,63 @@ absl::StatusOr<ReachedFixpoint> RangeQueryEngine::PopulateWithGivens(
   return visitor.GetReachedFixpoint();
 }
 
+absl::StatusOr<ReachedFixpoint> RangeQueryEngine::Repopulate(
+    FunctionBase* f, const absl::flat_hash_set<Node*>& stale_nodes) {
+  for (Node* node : stale_nodes) {
+    known_bits_.erase(node);
+    known_bit_values_.erase(node);
+    interval_sets_.erase(node);
+  }
+  if (known_bits_.size() > f->node_count() ||
+      interval_sets_.size() > f->node_count()) {
+    absl::flat_hash_set<Node*> live_nodes(f->nodes().begin(),
+                                          f->nodes().end());
+    auto removed = [&](const auto& kv) {
+      return !live_nodes.contains(kv.first);
+    };
+    absl::erase_if(known_bits_, removed);
+    absl::erase_if(known_bit_values_, removed);
+    absl::erase_if(interval_sets_, removed);
+  }
+
+  NoGivensProvider givens(f);
+  RangeQueryVisitor visitor(this, givens);
+  for (Node* node : f->nodes()) {
+    if (IsTracked(node)) {
+      visitor.MarkVisited(node);
+    }
+  }
+  XLS_RETURN_IF_ERROR(f->Accept(&visitor));
+  return visitor.GetReachedFixpoint();
+}
+
+absl::Status RangeQueryEngine::PopulateNode(Node* node) {
+  if (IsTracked(node)) {
+    return absl::OkStatus();
+  }
+  NoGivensProvider givens(node->function_base());
+  RangeQueryVisitor visitor(this, givens);
+  // Post-order walk over the untracked part of the operand cone. Each entry
+  // holds a node and the index of the next operand to visit.
+  std::vector<std::pair<Node*, int64_t>> stack = {{node, 0}};
+  while (!stack.empty()) {
+    auto [current, next_operand] = stack.back();
+    if (next_operand < current->operand_count()) {
+      ++stack.back().second;
+      Node* operand = current->operand(next_operand);
+      if (!IsTracked(operand)) {
+        stack.push_back({operand, 0});
+      }
+      continue;
+    }
+    stack.pop_back();
+    if (!IsTracked(current)) {
+      XLS_RETURN_IF_ERROR(current->VisitSingleNode(&visitor));
+    }
+  }
+  return absl::OkStatus();
+}
+
 IntervalSetTree RangeQueryEngine::GetIntervalSetTree(Node* node) const {
   if (interval_sets_.contains(node)) {
     return interval_sets_.at(node);
@@ -323,6 +381,7 @@ void RangeQueryEngine::SetIntervalSetTree(
           lhs = IntervalSet::Intersect(lhs, rhs);
         });
   }
+  Widen(ist);
 
   if (node->GetType()->IsBits()) {
     interval_ops::KnownBits bits =
@@ -345,6 +404,7 @@ void RangeQueryEngine::SetIntervalSetTree(Node* node,
           lhs = IntervalSet::Intersect(lhs, rhs);
         });
   }
+  Widen(ist);
 
   if (node->GetType()->IsBits()) {
     interval_ops::KnownBits bits =
@@ -354,6 +414,18 @@ void RangeQueryEngine::SetIntervalSetTree(Node* node,
   }
 }
 
+void RangeQueryEngine::Widen(MutableIntervalSetTreeView ist) const {
+  if (!max_interval_set_size_.has_value()) {
+    return;
+  }
+  for (IntervalSet& set : ist.elements()) {
+    if (set.NumberOfIntervals() > *max_interval_set_size_) {
+      set = interval_ops::MinimizeIntervals(std::move(set),
+                                            *max_interval_set_size_);
+    }
+  }
+}
+
 void RangeQueryEngine::InitializeNode(Node* node) {
   if (!known_bits_.contains(node) || !known_bit_values_.contains(node)) {
     known_bits_[node] = Bits(node->GetType()->GetFlatBitCount());
@@ -22,6 +22,7 @@
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
@@ -104,6 +105,13 @@ class RangeQueryEngine : public QueryEngine {
  public:
   // Create a `RangeQueryEngine` that contains no data.
   RangeQueryEngine() = default;
+  // Creates an engine which widens every interval set it stores to at most
+  // `max_interval_set_size` intervals by merging the intervals separated by the
+  // smallest gaps (i.e., replacing neighbouring intervals with their convex
+  // hull). A size of 1 widens every set to its convex hull. This bounds the
+  // cost of the analysis on large arithmetic graphs at the cost of precision.
+  explicit RangeQueryEngine(std::optional<int64_t> max_interval_set_size)
+      : max_interval_set_size_(max_interval_set_size) {}
   RangeQueryEngine(RangeQueryEngine&&) = default;
   RangeQueryEngine(const RangeQueryEngine&) = default;
   RangeQueryEngine& operator=(const RangeQueryEngine&) = default;
@@ -122,6 +130,24 @@ class RangeQueryEngine : public QueryEngine {
   // std::nullopt and `ShouldContinue` always returns true)
   absl::StatusOr<ReachedFixpoint> PopulateWithGivens(RangeDataProvider& givens);
 
+  // Updates the information for `f` after it was changed since the engine was
+  // last populated (without givens). The information of the nodes in
+  // `stale_nodes`, which must include every node whose operands changed along
+  // with all of their transitive users, and of any untracked nodes is
+  // recomputed. The remaining information is kept; information for removed
+  // nodes is discarded.
+  absl::StatusOr<ReachedFixpoint> Repopulate(
+      FunctionBase* f, const absl::flat_hash_set<Node*>& stale_nodes);
+
+  // Computes the information for `node` and for every untracked node in its
+  // transitive operand cone. Information for all other nodes is left alone, so
+  // the cost is proportional to the size of the cone rather than the function.
+  absl::Status PopulateNode(Node* node);
+
+  std::optional<int64_t> max_interval_set_size() const {
+    return max_interval_set_size_;
+  }
+
   bool IsTracked(Node* node) const override {
     return known_bits_.contains(node);
   }
@@ -165,10 +191,42 @@ class RangeQueryEngine : public QueryEngine {
     return tree;
   }
 
+  TernaryVector GetTernaryElement(
+      Node* node, absl::Span<const int64_t> index = {}) const override {
+    if (!node->GetType()->IsBits()) {
+      Type* leaf_type = leaf_type_tree_internal::GetSubtypeAndOffset(
+                            node->GetType(), index)
+                            .first;
+      return TernaryVector(leaf_type->GetFlatBitCount(),
+                           TernaryValue::kUnknown);
+    }
+    return ternary_ops::FromKnownBits(known_bits_.at(node),
+                                      known_bit_values_.at(node));
+  }
+
   LeafTypeTree<IntervalSet> GetIntervals(Node* node) const override {
     return GetIntervalSetTree(node);
   }
 
+  SharedLeafTypeTree<IntervalSet> GetIntervalsShared(
+      Node* node) const override {
+    if (HasExplicitIntervals(node)) {
+      return SharedLeafTypeTree<IntervalSet>(interval_sets_.at(node).AsView());
+    }
+    return SharedLeafTypeTree<IntervalSet>(GetIntervalSetTree(node));
+  }
+
+  IntervalSet GetIntervalsElement(
+      Node* node, absl::Span<const int64_t> index = {}) const override {
+    if (HasExplicitIntervals(node)) {
+      return interval_sets_.at(node).Get(index);
+    }
+    Type* leaf_type =
+        leaf_type_tree_internal::GetSubtypeAndOffset(node->GetType(), index)
+            .first;
+    return IntervalSet::Maximal(leaf_type->GetFlatBitCount());
+  }
+
   bool AtMostOneTrue(absl::Span<TreeBitLocation const> bits) const override {
     int64_t maybe_one_count = 0;
     for (const TreeBitLocation& location : bits) {
@@ -243,6 +301,10 @@ class RangeQueryEngine : public QueryEngine {
  private:
   friend class RangeQueryVisitor;
 
+  // Widens each leaf of `ist` to at most `max_interval_set_size_` intervals.
+  void Widen(MutableIntervalSetTreeView ist) const;
+
+  std::optional<int64_t> max_interval_set_size_;
   absl::flat_hash_map<Node*, Bits> known_bits_;
   absl::flat_hash_map<Node*, Bits> known_bit_values_;
   absl::flat_hash_map<Node*, IntervalSetTree> interval_sets_;
@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -36,13 +37,17 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/common/visitor.h"
 #include "xls/data_structures/algorithm.h"
 #include "xls/data_structures/inline_bitmap.h"
+#include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/lsb_or_msb.h"
 #include "xls/ir/node.h"
 #include "xls/ir/node_util.h"
@@ -56,6 +61,7 @@
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/stateless_query_engine.h"
 #include "xls/passes/ternary_query_engine.h"
 #include "xls/passes/union_query_engine.h"
@@ -568,7 +574,7 @@ absl::StatusOr<bool> SimplifyNode(Node* node, const QueryEngine& query_engine,
     PrioritySelect* sel = node->As<PrioritySelect>();
     XLS_RET_CHECK(sel->selector()->GetType()->IsBits());
     const TernaryVector selector =
-        query_engine.GetTernary(sel->selector()).Get({});
+        query_engine.GetTernaryElement(sel->selector());
     auto first_nonzero_case = absl::c_find_if(
         selector, [](TernaryValue v) { return v != TernaryValue::kKnownZero; });
     if (first_nonzero_case == selector.end()) {
@@ -1092,7 +1098,7 @@ absl::StatusOr<bool> SimplifyNode(Node* node, const QueryEngine& query_engine,
                                         ? node->As<OneHotSelect>()->cases()
                                         : node->As<PrioritySelect>()->cases();
     if (query_engine.IsTracked(selector)) {
-      TernaryVector selector_bits = query_engine.GetTernary(selector).Get({});
+      TernaryVector selector_bits = query_engine.GetTernaryElement(selector);
       // For one-hot-selects if either the selector bit or the case value is
       // zero, the case can be removed. For priority selects, the case can be
       // removed only if the selector bit is zero, or if *all later* cases are
@@ -1194,26 +1200,24 @@ absl::StatusOr<bool> SimplifyNode(Node* node, const QueryEngine& query_engine,
       if (!node->Is<Select>() || !node->GetType()->IsBits()) {
         return false;
       }
-      int64_t leading_known = bits_ops::CountLeadingOnes(
-          ternary_ops::ToKnownBits(query_engine.GetTernary(node).Get({})));
-      int64_t trailing_known = bits_ops::CountTrailingOnes(
-          ternary_ops::ToKnownBits(query_engine.GetTernary(node).Get({})));
+      TernaryVector ternary = query_engine.GetTernaryElement(node);
+      int64_t leading_known =
+          bits_ops::CountLeadingOnes(ternary_ops::ToKnownBits(ternary));
+      int64_t trailing_known =
+          bits_ops::CountTrailingOnes(ternary_ops::ToKnownBits(ternary));
       if (leading_known == 0 && trailing_known == 0) {
         return false;
       }
       int64_t bit_count = node->BitCountOrDie();
-      *msb =
-          ternary_ops::ToKnownBitsValues(query_engine.GetTernary(node).Get({}))
-              .Slice(/*start=*/bit_count - leading_known,
-                     /*width=*/leading_known);
+      *msb = ternary_ops::ToKnownBitsValues(ternary).Slice(
+          /*start=*/bit_count - leading_known, /*width=*/leading_known);
       if (leading_known == trailing_known && leading_known == bit_count) {
         // This is just a constant value, just say we only have high constant
         // bits, the replacement will be the same.
         return true;
       }
-      *lsb =
-          ternary_ops::ToKnownBitsValues(query_engine.GetTernary(node).Get({}))
-              .Slice(/*start=*/0, /*width=*/trailing_known);
+      *lsb = ternary_ops::ToKnownBitsValues(ternary).Slice(
+          /*start=*/0, /*width=*/trailing_known);
       return true;
     };
     Bits const_msb, const_lsb;
@@ -1532,31 +1536,255 @@ absl::StatusOr<bool> SimplifyNode(Node* node, const QueryEngine& query_engine,
   return false;
 }
 
+// Returns whether SimplifyNode consults the query engine about `node` and its
+// operands.
+bool IsAnalyzedNode(Node* node) {
+  return node->OpIn({Op::kSel, Op::kOneHotSel, Op::kPrioritySel, Op::kOneHot});
+}
+
+// A query engine which answers ternary queries about a fixed set of nodes from
+// information gathered up front (possibly concurrently) from `base`, and
+// forwards all other queries to `base`. The pass never repopulates its query
+// engines and replacing the uses of a node does not change the information of
+// other nodes, so the answers are the same as those of `base`.
+class SnapshotQueryEngine final : public QueryEngine {
+ public:
+  // Gathers the information of `nodes` using `threads` threads which each
+  // handle a contiguous chunk of the nodes. `base` must be safe to query
+  // concurrently.
+  SnapshotQueryEngine(const QueryEngine& base, absl::Span<Node* const> nodes,
+                      int64_t threads)
+      : base_(base) {
+    std::vector<std::optional<LeafTypeTree<TernaryVector>>> ternaries(
+        nodes.size());
+    const int64_t chunk_size = CeilOfRatio(
+        static_cast<int64_t>(nodes.size()), std::max<int64_t>(threads, 1));
+    std::vector<std::unique_ptr<Thread>> workers;
+    for (int64_t start = 0; start < nodes.size(); start += chunk_size) {
+      const int64_t end =
+          std::min(start + chunk_size, static_cast<int64_t>(nodes.size()));
+      workers.push_back(
+          std::make_unique<Thread>([this, &nodes, &ternaries, start, end]() {
+            for (int64_t i = start; i < end; ++i) {
+              if (base_.IsTracked(nodes[i])) {
+                ternaries[i] = base_.GetTernary(nodes[i]);
+              }
+            }
+          }));
+    }
+    for (std::unique_ptr<Thread>& worker : workers) {
+      worker->Join();
+    }
+    ternaries_.reserve(nodes.size());
+    for (int64_t i = 0; i < nodes.size(); ++i) {
+      if (ternaries[i].has_value()) {
+        ternaries_.emplace(nodes[i], *std::move(ternaries[i]));
+      }
+    }
+  }
+
+  absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override {
+    return absl::UnimplementedError(
+        "SnapshotQueryEngine cannot be repopulated");
+  }
+  bool IsTracked(Node* node) const override {
+    return ternaries_.contains(node) || base_.IsTracked(node);
+  }
+  LeafTypeTree<TernaryVector> GetTernary(Node* node) const override {
+    auto it = ternaries_.find(node);
+    return it == ternaries_.end() ? base_.GetTernary(node) : it->second;
+  }
+  SharedLeafTypeTree<TernaryVector> GetTernaryShared(
+      Node* node) const override {
+    auto it = ternaries_.find(node);
+    return it == ternaries_.end()
+               ? base_.GetTernaryShared(node)
+               : SharedLeafTypeTree<TernaryVector>(it->second.AsView());
+  }
+  TernaryVector GetTernaryElement(
+      Node* node, absl::Span<const int64_t> index = {}) const override {
+    auto it = ternaries_.find(node);
+    return it == ternaries_.end() ? base_.GetTernaryElement(node, index)
+                                  : it->second.Get(index);
+  }
+  bool AtMostOneTrue(absl::Span<TreeBitLocation const> bits) const override {
+    return base_.AtMostOneTrue(bits);
+  }
+  bool AtLeastOneTrue(absl::Span<TreeBitLocation const> bits) const override {
+    return base_.AtLeastOneTrue(bits);
+  }
+  bool Implies(const TreeBitLocation& a,
+               const TreeBitLocation& b) const override {
+    return base_.Implies(a, b);
+  }
+  std::optional<Bits> ImpliedNodeValue(
+      absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+      Node* node) const override {
+    return base_.ImpliedNodeValue(predicate_bit_values, node);
+  }
+  std::optional<TernaryVector> ImpliedNodeTernary(
+      absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+      Node* node) const override {
+    return base_.ImpliedNodeTernary(predicate_bit_values, node);
+  }
+  bool KnownEquals(const TreeBitLocation& a,
+                   const TreeBitLocation& b) const override {
+    return base_.KnownEquals(a, b);
+  }
+  bool KnownNotEquals(const TreeBitLocation& a,
+                      const TreeBitLocation& b) const override {
+    return base_.KnownNotEquals(a, b);
+  }
+
+ private:
+  const QueryEngine& base_;
+  absl::flat_hash_map<Node*, LeafTypeTree<TernaryVector>> ternaries_;
+};
+
+// A query engine which answers at most `budget` queries with `full` and the
+// remaining ones with `fallback`, which should be cheap. Any answer of a query
+// engine is conservative so mixing the answers of the two engines is sound.
+class BudgetedQueryEngine final : public QueryEngine {
+ public:
+  BudgetedQueryEngine(const QueryEngine& full, const QueryEngine& fallback,
+                      std::optional<int64_t> budget)
+      : full_(full), fallback_(fallback), budget_(budget) {}
+
+  // Number of queries answered by the full and by the fallback engine.
+  int64_t full_queries() const { return full_queries_; }
+  int64_t fallback_queries() const { return fallback_queries_; }
+
+  absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override {
+    return absl::UnimplementedError(
+        "BudgetedQueryEngine cannot be repopulated");
+  }
+  bool IsTracked(Node* node) const override {
+    return engine().IsTracked(node);
+  }
+  LeafTypeTree<TernaryVector> GetTernary(Node* node) const override {
+    return engine().GetTernary(node);
+  }
+  SharedLeafTypeTree<TernaryVector> GetTernaryShared(
+      Node* node) const override {
+    return engine().GetTernaryShared(node);
+  }
+  TernaryVector GetTernaryElement(
+      Node* node, absl::Span<const int64_t> index = {}) const override {
+    return engine().GetTernaryElement(node, index);
+  }
+  bool AtMostOneTrue(absl::Span<TreeBitLocation const> bits) const override {
+    return engine().AtMostOneTrue(bits);
+  }
+  bool AtLeastOneTrue(absl::Span<TreeBitLocation const> bits) const override {
+    return engine().AtLeastOneTrue(bits);
+  }
+  bool Implies(const TreeBitLocation& a,
+               const TreeBitLocation& b) const override {
+    return engine().Implies(a, b);
+  }
+  std::optional<Bits> ImpliedNodeValue(
+      absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+      Node* node) const override {
+    return engine().ImpliedNodeValue(predicate_bit_values, node);
+  }
+  std::optional<TernaryVector> ImpliedNodeTernary(
+      absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+      Node* node) const override {
+    return engine().ImpliedNodeTernary(predicate_bit_values, node);
+  }
+  bool KnownEquals(const TreeBitLocation& a,
+                   const TreeBitLocation& b) const override {
+    return engine().KnownEquals(a, b);
+  }
+  bool KnownNotEquals(const TreeBitLocation& a,
+                      const TreeBitLocation& b) const override {
+    return engine().KnownNotEquals(a, b);
+  }
+
+ private:
+  // Returns the engine which answers the next query and charges it for it.
+  const QueryEngine& engine() const {
+    if (budget_.has_value() && full_queries_ >= *budget_) {
+      ++fallback_queries_;
+      return fallback_;
+    }
+    ++full_queries_;
+    return full_;
+  }
+
+  const QueryEngine& full_;
+  const QueryEngine& fallback_;
+  std::optional<int64_t> budget_;
+  mutable int64_t full_queries_ = 0;
+  mutable int64_t fallback_queries_ = 0;
+};
+
 }  // namespace
 
-absl::StatusOr<bool> SelectSimplificationPass::RunOnFunctionBaseInternal(
-    FunctionBase* func, const OptimizationPassOptions& options,
-    PassResults* results) const {
-  std::vector<std::unique_ptr<QueryEngine>> query_engines;
-  query_engines.push_back(std::make_unique<StatelessQueryEngine>());
-  query_engines.push_back(std::make_unique<TernaryQueryEngine>());
+absl::StatusOr<bool> SimplifySelects(FunctionBase* f,
+                                     const QueryEngine& query_engine,
+                                     int64_t opt_level,
+                                     std::optional<int64_t> query_budget,
+                                     int64_t threads,
+                                     SelectSimplificationStats* stats) {
+  std::vector<Node*> nodes = TopoSort(f);
 
-  UnionQueryEngine query_engine(std::move(query_engines));
-  XLS_RETURN_IF_ERROR(query_engine.Populate(func).status());
+  // Gathering the information about the analyzed nodes and their operands only
+  // reads the IR and the query engine, so it can be done up front in parallel.
+  std::optional<SnapshotQueryEngine> snapshot;
+  if (threads > 1) {
+    std::vector<Node*> snapshot_nodes;
+    absl::flat_hash_set<Node*> seen;
+    for (Node* node : nodes) {
+      if (!IsAnalyzedNode(node)) {
+        continue;
+      }
+      if (seen.insert(node).second) {
+        snapshot_nodes.push_back(node);
+      }
+      for (Node* operand : node->operands()) {
+        if (seen.insert(operand).second) {
+          snapshot_nodes.push_back(operand);
+        }
+      }
+    }
+    snapshot.emplace(query_engine, snapshot_nodes, threads);
+  }
+  StatelessQueryEngine stateless_query_engine;
+  BudgetedQueryEngine budgeted_query_engine(
+      snapshot.has_value() ? *snapshot : query_engine, stateless_query_engine,
+      query_budget);
+
+  SelectSimplificationStats local_stats;
+  if (stats == nullptr) {
+    stats = &local_stats;
+  }
+  // Runs `simplify` and counts it as skipped if the budget ran out before or
+  // while it queried the engine.
+  auto run_budgeted = [&](auto simplify) {
+    const int64_t fallback_queries = budgeted_query_engine.fallback_queries();
+    auto result = simplify();
+    if (budgeted_query_engine.fallback_queries() > fallback_queries) {
+      ++stats->nodes_skipped;
+    }
+    return result;
+  };
 
   bool changed = false;
-  for (Node* node : TopoSort(func)) {
-    XLS_ASSIGN_OR_RETURN(bool node_changed,
-                         SimplifyNode(node, query_engine, opt_level_));
+  for (Node* node : nodes) {
+    XLS_ASSIGN_OR_RETURN(bool node_changed, run_budgeted([&] {
+                           return SimplifyNode(node, budgeted_query_engine,
+                                               opt_level);
+                         }));
     changed = changed || node_changed;
   }
 
   // Use a worklist to split OneHotSelects based on common bits in the cases
   // because this transformation creates many more OneHotSelects exposing
   // further opportunities for optimizations.
-  if (SplitsEnabled(opt_level_)) {
+  if (SplitsEnabled(opt_level)) {
     std::deque<OneHotSelect*> worklist;
-    for (Node* node : func->nodes()) {
+    for (Node* node : f->nodes()) {
       if (node->Is<OneHotSelect>()) {
         worklist.push_back(node->As<OneHotSelect>());
       }
@@ -1567,13 +1795,62 @@ absl::StatusOr<bool> SelectSimplificationPass::RunOnFunctionBaseInternal(
       // Note that query_engine may be stale at this point but that is
       // ok; we'll fall back on the stateless query engine.
       XLS_ASSIGN_OR_RETURN(std::vector<OneHotSelect*> new_ohses,
-                           MaybeSplitOneHotSelect(ohs, query_engine));
+                           run_budgeted([&] {
+                             return MaybeSplitOneHotSelect(
+                                 ohs, budgeted_query_engine);
+                           }));
       if (!new_ohses.empty()) {
         changed = true;
         worklist.insert(worklist.end(), new_ohses.begin(), new_ohses.end());
       }
     }
   }
+
+  stats->queries = budgeted_query_engine.full_queries() +
+                   budgeted_query_engine.fallback_queries();
+  return changed;
+}
+
+absl::StatusOr<bool> SelectSimplificationPass::RunOnFunctionBaseInternal(
+    FunctionBase* func, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  std::vector<std::unique_ptr<QueryEngine>> query_engines;
+  query_engines.push_back(std::make_unique<StatelessQueryEngine>());
+  if (options.query_engine_cache != nullptr) {
+    XLS_ASSIGN_OR_RETURN(
+        TernaryQueryEngine * ternary_query_engine,
+        options.query_engine_cache->GetTernaryQueryEngine(func));
+    query_engines.push_back(std::make_unique<UnownedUnionQueryEngine>(
+        std::vector<QueryEngine*>{ternary_query_engine}));
+  } else {
+    auto ternary_query_engine = std::make_unique<TernaryQueryEngine>();
+    XLS_RETURN_IF_ERROR(ternary_query_engine->Populate(func).status());
+    query_engines.push_back(std::move(ternary_query_engine));
+  }
+  // The stateless query engine needs no population and the ternary engine is
+  // populated above.
+  UnionQueryEngine query_engine(std::move(query_engines));
+
+  const int64_t analyzed_nodes =
+      absl::c_count_if(func->nodes(), IsAnalyzedNode);
+  SelectSimplificationStats stats;
+  XLS_ASSIGN_OR_RETURN(
+      bool changed,
+      SimplifySelects(func, query_engine, opt_level_,
+                      options.select_simplification_query_budget,
+                      analyzed_nodes >= kMinSelectsForParallelAnalysis
+                          ? options.node_threads
+                          : 1,
+                      &stats));
+  if (stats.nodes_skipped > 0) {
+    LOG(INFO) << absl::StreamFormat(
+        "Select simplification of %s exhausted its query budget of %d; "
+        "skipped analysis of %d nodes",
+        func->name(), *options.select_simplification_query_budget,
+        stats.nodes_skipped);
+  }
+  VLOG(2) << absl::StreamFormat("Select simplification of %s made %d queries",
+                                func->name(), stats.queries);
   return changed;
 }
 
@@ -16,19 +16,54 @@
 #define XLS_PASSES_SELECT_SIMPLIFICATION_PASS_H_
 
 #include <cstdint>
+#include <optional>
 #include <string_view>
 
 #include "absl/status/statusor.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/query_engine.h"
 
 namespace xls {
 
+// Statistics gathered while simplifying the selects of a function base.
+struct SelectSimplificationStats {
+  // Number of queries answered by the query engine of the pass.
+  int64_t queries = 0;
+
+  // Number of nodes which were simplified with only the stateless query engine
+  // because the query budget was exhausted. Simplifications of these nodes
+  // which depend on the analysis were skipped.
+  int64_t nodes_skipped = 0;
+};
+
+// Simplifies the selects of `f` using `query_engine`, which must be populated
+// for `f`. If `query_budget` is given, at most that many queries are answered
+// by `query_engine`; later queries fall back on the stateless query engine.
+// With `threads` greater than one, the information about the select nodes is
+// first gathered from `query_engine` concurrently, so it must be safe to query
+// from several threads. The IR is still transformed serially in topological
+// order so the output is the same for any thread count. If `stats` is not
+// null, the statistics of the run are stored there.
+absl::StatusOr<bool> SimplifySelects(
+    FunctionBase* f, const QueryEngine& query_engine, int64_t opt_level,
+    std::optional<int64_t> query_budget, int64_t threads,
+    SelectSimplificationStats* stats = nullptr);
+
 // Pass which simplifies selects and one-hot-selects. Example optimizations
 // include removing dead arms and eliminating selects with constant selectors.
+// The analysis done by the pass can be bounded with
+// OptimizationPassOptions::select_simplification_query_budget.
 class SelectSimplificationPass : public OptimizationFunctionBasePass {
  public:
   static constexpr std::string_view kName = "select_simp";
+
+  // Function bases with fewer select and one-hot nodes than this are analyzed
+  // serially regardless of OptimizationPassOptions::node_threads as starting
+  // threads would cost more than it saves.
+  static constexpr int64_t kMinSelectsForParallelAnalysis = 1000;
+
   explicit SelectSimplificationPass(int64_t opt_level = kMaxOptLevel)
       : OptimizationFunctionBasePass(kName, "Select Simplification"),
         opt_level_(opt_level) {}
@@ -14,7 +14,9 @@
 
 #include "xls/passes/select_simplification_pass.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -35,6 +37,7 @@
 #include "xls/ir/value.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/ternary_query_engine.h"
 #include "xls/solvers/z3_ir_equivalence_testutils.h"
 
 namespace m = ::xls::op_matchers;
@@ -44,6 +47,8 @@ namespace {
 
 using status_testing::IsOkAndHolds;
 using ::testing::Eq;
+using ::testing::Gt;
+using ::testing::Not;
 
 class SelectSimplificationPassTest : public IrTestBase {
  protected:
@@ -1142,5 +1147,102 @@ TEST_F(SelectSimplificationPassTest, OneHotWithSingleUnknownBit) {
           {m::Literal("bits[3]:0b010"), m::Literal("bits[3]:0b001")}));
 }
 
+TEST_F(SelectSimplificationPassTest, QueryBudgetSkipsAnalysis) {
+  // The selector is only known to be zero through ternary analysis.
+  const std::string kIr = R"(
+     fn f(p: bits[1], x: bits[8], y: bits[8]) -> bits[8] {
+        literal.1: bits[1] = literal(value=0)
+        and.2: bits[1] = and(p, literal.1)
+        ret sel.3: bits[8] = sel(and.2, cases=[x, y])
+     }
+  )";
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(kIr, p.get()));
+  TernaryQueryEngine query_engine;
+  XLS_ASSERT_OK(query_engine.Populate(f).status());
+
+  SelectSimplificationStats stats;
+  XLS_ASSERT_OK(SimplifySelects(f, query_engine, kMaxOptLevel,
+                                /*query_budget=*/0, /*threads=*/1, &stats)
+                    .status());
+  EXPECT_THAT(f->return_value(), Not(m::Param("x")));
+  EXPECT_THAT(stats.nodes_skipped, Gt(0));
+
+  stats = SelectSimplificationStats();
+  EXPECT_THAT(SimplifySelects(f, query_engine, kMaxOptLevel,
+                              /*query_budget=*/1000, /*threads=*/1, &stats),
+              IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Param("x"));
+  EXPECT_EQ(stats.nodes_skipped, 0);
+  EXPECT_THAT(stats.queries, Gt(0));
+}
+
+TEST_F(SelectSimplificationPassTest, QueryBudgetOption) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+     fn f(p: bits[1], x: bits[8], y: bits[8]) -> bits[8] {
+        literal.1: bits[1] = literal(value=0)
+        and.2: bits[1] = and(p, literal.1)
+        ret sel.3: bits[8] = sel(and.2, cases=[x, y])
+     }
+  )",
+                                                       p.get()));
+  OptimizationPassOptions options;
+  options.select_simplification_query_budget = 0;
+  PassResults results;
+  XLS_ASSERT_OK(SelectSimplificationPass()
+                    .RunOnFunctionBase(f, options, &results)
+                    .status());
+  EXPECT_THAT(f->return_value(), Not(m::Param("x")));
+}
+
+TEST_F(SelectSimplificationPassTest, ParallelAnalysisMatchesSerial) {
+  // Builds a chain of selects, one-hot selects and priority selects with
+  // selectors of which some bits are known so that simplifying a node changes
+  // the operands of later nodes.
+  auto build = [&](Package* p) -> absl::StatusOr<Function*> {
+    FunctionBuilder fb(TestName(), p);
+    Type* u8 = p->GetBitsType(8);
+    BValue s = fb.Param("s", p->GetBitsType(2));
+    BValue x = fb.Param("x", u8);
+    BValue y = fb.Param("y", u8);
+    std::vector<BValue> values = {x, y};
+    for (int64_t i = 0; i < 100; ++i) {
+      BValue known = fb.Literal(UBits(i % 4, 2));
+      BValue partial = fb.Or(s, fb.Literal(UBits(i % 2 + 1, 2)));
+      BValue a = values[values.size() - 1];
+      BValue b = values[values.size() - 2];
+      values.push_back(fb.Select(fb.BitSlice(known, 0, 1), {a, b}));
+      values.push_back(
+          fb.OneHotSelect(partial, {values.back(), fb.Literal(UBits(0, 8))}));
+      values.push_back(fb.PrioritySelect(partial, {a, values.back()},
+                                         /*default_value=*/b));
+    }
+    return fb.BuildWithReturnValue(fb.Tuple(values));
+  };
+  auto serial_package = CreatePackage();
+  auto parallel_package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * serial, build(serial_package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * parallel, build(parallel_package.get()));
+  TernaryQueryEngine serial_query_engine;
+  TernaryQueryEngine parallel_query_engine;
+  XLS_ASSERT_OK(serial_query_engine.Populate(serial).status());
+  XLS_ASSERT_OK(parallel_query_engine.Populate(parallel).status());
+
+  SelectSimplificationStats serial_stats;
+  SelectSimplificationStats parallel_stats;
+  EXPECT_THAT(SimplifySelects(serial, serial_query_engine, kMaxOptLevel,
+                              /*query_budget=*/500, /*threads=*/1,
+                              &serial_stats),
+              IsOkAndHolds(true));
+  EXPECT_THAT(SimplifySelects(parallel, parallel_query_engine, kMaxOptLevel,
+                              /*query_budget=*/500, /*threads=*/4,
+                              &parallel_stats),
+              IsOkAndHolds(true));
+  EXPECT_EQ(serial->DumpIr(), parallel->DumpIr());
+  EXPECT_EQ(serial_stats.queries, parallel_stats.queries);
+  EXPECT_EQ(serial_stats.nodes_skipped, parallel_stats.nodes_skipped);
+}
+
 }  // namespace
 }  // namespace xls
@@ -15,6 +15,9 @@
 #ifndef XLS_PASSES_TERNARY_EVALUATOR_H_
 #define XLS_PASSES_TERNARY_EVALUATOR_H_
 
+#include <cstdint>
+
+#include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
 #include "xls/ir/abstract_evaluator.h"
@@ -49,6 +52,63 @@ class TernaryEvaluator
   TernaryValue Or(const TernaryValue& a, const TernaryValue& b) const {
     return ternary_ops::Or(a, b);
   }
+
+  // The operations below shadow the element-by-element implementations of
+  // AbstractEvaluator with word-parallel ones on PackedTernaryVector. Add is
+  // also more precise than the generic ripple-carry adder, which loses
+  // information whenever a carry is unknown.
+  Vector BitwiseAnd(SpanOfSpan inputs) const {
+    return Fold(inputs, [](const PackedTernaryVector& a,
+                           const PackedTernaryVector& b) {
+      return ternary_ops::And(a, b);
+    });
+  }
+  Vector BitwiseOr(SpanOfSpan inputs) const {
+    return Fold(inputs, [](const PackedTernaryVector& a,
+                           const PackedTernaryVector& b) {
+      return ternary_ops::Or(a, b);
+    });
+  }
+  Vector BitwiseXor(SpanOfSpan inputs) const {
+    return Fold(inputs, [](const PackedTernaryVector& a,
+                           const PackedTernaryVector& b) {
+      return ternary_ops::Xor(a, b);
+    });
+  }
+  Vector BitwiseAnd(Span a, Span b) const { return BitwiseAnd({a, b}); }
+  Vector BitwiseOr(Span a, Span b) const { return BitwiseOr({a, b}); }
+  Vector BitwiseXor(Span a, Span b) const { return BitwiseXor({a, b}); }
+
+  Vector Add(Span a, Span b) const {
+    CHECK_EQ(a.size(), b.size());
+    return ternary_ops::Add(PackedTernaryVector::FromTernary(a),
+                            PackedTernaryVector::FromTernary(b))
+        .ToTernary();
+  }
+
+  TernaryValue Equals(Span a, Span b) const {
+    CHECK_EQ(a.size(), b.size());
+    return ternary_ops::Eq(PackedTernaryVector::FromTernary(a),
+                           PackedTernaryVector::FromTernary(b));
+  }
+
+  TernaryValue ULessThan(Span a, Span b) const {
+    CHECK_EQ(a.size(), b.size());
+    return ternary_ops::ULt(PackedTernaryVector::FromTernary(a),
+                            PackedTernaryVector::FromTernary(b));
+  }
+
+ private:
+  template <typename F>
+  static Vector Fold(SpanOfSpan inputs, F f) {
+    CHECK(!inputs.empty());
+    PackedTernaryVector result = PackedTernaryVector::FromTernary(inputs[0]);
+    for (int64_t i = 1; i < inputs.size(); ++i) {
+      CHECK_EQ(inputs[i].size(), result.bit_count());
+      result = f(result, PackedTernaryVector::FromTernary(inputs[i]));
+    }
+    return result.ToTernary();
+  }
 };
 
 }  // namespace xls
@@ -265,6 +265,26 @@ TEST_F(TernaryLogicTest, ULessThan) {
   }
 }
 
+TEST_F(TernaryLogicTest, Add) {
+  for (const TernaryVector& lhs : EnumerateTernaryVectors(/*width=*/3)) {
+    for (const TernaryVector& rhs : EnumerateTernaryVectors(/*width=*/3)) {
+      std::vector<Bits> results;
+      for (const Bits& lhs_bits : ExpandToBits(lhs)) {
+        for (const Bits& rhs_bits : ExpandToBits(rhs)) {
+          results.push_back(bits_ops::Add(lhs_bits, rhs_bits));
+        }
+      }
+      TernaryVector expected = ReduceFromBits(results);
+      TernaryVector actual = evaluator_.Add(lhs, rhs);
+      std::string message = absl::StrFormat("%s + %s => %s", ToString(lhs),
+                                            ToString(rhs), ToString(expected));
+      VLOG(1) << message;
+      EXPECT_EQ(expected, actual)
+          << message << ", but result is " << ToString(actual);
+    }
+  }
+}
+
 TEST_F(TernaryLogicTest, BinarySelect) {
   for (const TernaryVector& selector : EnumerateTernaryVectors(/*width=*/1)) {
     for (const TernaryVector& on_true : EnumerateTernaryVectors(/*width=*/2)) {
@@ -23,6 +23,7 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -340,6 +341,79 @@ absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Populate(FunctionBase* f) {
   return rf;
 }
 
+absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Repopulate(
+    FunctionBase* f, const absl::flat_hash_set<Node*>& stale_nodes) {
+  for (Node* node : stale_nodes) {
+    values_.erase(node);
+  }
+  if (values_.size() > f->node_count()) {
+    absl::flat_hash_set<Node*> live_nodes(f->nodes().begin(),
+                                          f->nodes().end());
+    absl::erase_if(values_, [&](const auto& kv) {
+      return !live_nodes.contains(kv.first);
+    });
+  }
+
+  TernaryEvaluator evaluator;
+  TernaryNodeEvaluator ternary_visitor(evaluator);
+  ternary_visitor.SetValues(std::move(values_));
+  ReachedFixpoint rf = ReachedFixpoint::Unchanged;
+  for (Node* n : TopoSort(f)) {
+    if (ternary_visitor.values().contains(n)) {
+      continue;
+    }
+    rf = ReachedFixpoint::Changed;
+    if (IsExpensiveToEvaluate(n, ternary_visitor.values())) {
+      XLS_RETURN_IF_ERROR(ternary_visitor.DefaultHandler(n));
+      continue;
+    }
+    XLS_RETURN_IF_ERROR(n->VisitSingleNode(&ternary_visitor));
+  }
+  values_ = std::move(ternary_visitor).values();
+  return rf;
+}
+
+absl::Status TernaryQueryEngine::PopulateCone(Node* node) {
+  if (IsTracked(node)) {
+    return absl::OkStatus();
+  }
+
+  // Collect the untracked nodes of the cone in topological order with an
+  // iterative post-order traversal; the cones can be very deep.
+  std::vector<Node*> untracked;
+  absl::flat_hash_set<Node*> seen = {node};
+  std::vector<std::pair<Node*, int64_t>> stack = {{node, 0}};
+  while (!stack.empty()) {
+    auto& [current, next_operand] = stack.back();
+    if (next_operand == current->operand_count()) {
+      untracked.push_back(current);
+      stack.pop_back();
+      continue;
+    }
+    Node* operand = current->operand(next_operand++);
+    if (!IsTracked(operand) && seen.insert(operand).second) {
+      stack.push_back({operand, 0});
+    }
+  }
+
+  // Information about nodes whose type has changed is stale.
+  for (Node* n : untracked) {
+    values_.erase(n);
+  }
+  TernaryEvaluator evaluator;
+  TernaryNodeEvaluator ternary_visitor(evaluator);
+  ternary_visitor.SetValues(std::move(values_));
+  for (Node* n : untracked) {
+    if (IsExpensiveToEvaluate(n, ternary_visitor.values())) {
+      XLS_RETURN_IF_ERROR(ternary_visitor.DefaultHandler(n));
+      continue;
+    }
+    XLS_RETURN_IF_ERROR(n->VisitSingleNode(&ternary_visitor));
+  }
+  values_ = std::move(ternary_visitor).values();
+  return absl::OkStatus();
+}
+
 bool TernaryQueryEngine::AtMostOneTrue(
     absl::Span<TreeBitLocation const> bits) const {
   int64_t maybe_one_count = 0;
@@ -15,12 +15,15 @@
 #ifndef XLS_PASSES_TERNARY_QUERY_ENGINE_H_
 #define XLS_PASSES_TERNARY_QUERY_ENGINE_H_
 
+#include <cstdint>
 #include <optional>
 #include <utility>
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/data_structures/leaf_type_tree.h"
@@ -43,6 +46,20 @@ class TernaryQueryEngine : public QueryEngine {
  public:
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
+  // Updates the information for `f` after it was changed since the engine was
+  // last populated. The information of the nodes in `stale_nodes`, which must
+  // include every node whose operands changed along with all of their
+  // transitive users, and of any untracked nodes is recomputed. The remaining
+  // information is kept; information for removed nodes is discarded.
+  absl::StatusOr<ReachedFixpoint> Repopulate(
+      FunctionBase* f, const absl::flat_hash_set<Node*>& stale_nodes);
+
+  // Computes the information for `node` and those of its transitive operands
+  // which are not yet tracked, keeping all other information. Only the
+  // untracked part of the cone of `node` is visited, so this is cheap for
+  // querying nodes of a function which is being built up incrementally.
+  absl::Status PopulateCone(Node* node);
+
   bool IsTracked(Node* node) const override {
     return values_.contains(node) && values_.at(node).type() == node->GetType();
   }
@@ -55,6 +72,15 @@ class TernaryQueryEngine : public QueryEngine {
     CHECK(IsTracked(node)) << node;
     return values_.at(node).AsView();
   }
+  SharedLeafTypeTree<TernaryVector> GetTernaryShared(
+      Node* node) const override {
+    return SharedLeafTypeTree<TernaryVector>(GetTernaryView(node));
+  }
+  TernaryVector GetTernaryElement(
+      Node* node, absl::Span<const int64_t> index = {}) const override {
+    CHECK(IsTracked(node)) << node;
+    return values_.at(node).Get(index);
+  }
 
   bool AtMostOneTrue(absl::Span<TreeBitLocation const> bits) const override;
   bool AtLeastOneTrue(absl::Span<TreeBitLocation const> bits) const override;
@@ -40,6 +40,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/visitor.h"
+#include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/benchmark_support.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
@@ -967,6 +968,37 @@ TEST_F(TernaryQueryEngineTest, Identity) {
   }
 }
 
+TEST_F(TernaryQueryEngineTest, SharedAndElementQueries) {
+  auto package = CreatePackage();
+  FunctionBuilder fb(TestName(), package.get());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BValue compound,
+      MakeValueWithKnownBits(
+          "compound", TValue::Tuple({"0bX10", TValue::Array({"0b0X", "0b10"})}),
+          &fb));
+  BValue ident = fb.Identity(compound);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  TernaryQueryEngine query_engine;
+  XLS_ASSERT_OK(query_engine.Populate(f).status());
+
+  // The shared tree refers to the engine's storage rather than a copy.
+  SharedLeafTypeTree<TernaryVector> shared =
+      query_engine.GetTernaryShared(ident.node());
+  EXPECT_FALSE(shared.IsOwned());
+  EXPECT_EQ(shared.elements().data(),
+            query_engine.GetTernaryView(ident.node()).elements().data());
+  EXPECT_EQ(shared.AsView(), query_engine.GetTernary(ident.node()).AsView());
+
+  EXPECT_EQ(xls::ToString(query_engine.GetTernaryElement(ident.node(), {0})),
+            "0bX10");
+  EXPECT_EQ(
+      xls::ToString(query_engine.GetTernaryElement(ident.node(), {1, 0})),
+      "0b0X");
+  EXPECT_EQ(
+      xls::ToString(query_engine.GetTernaryElement(ident.node(), {1, 1})),
+      "0b10");
+}
+
 TEST_F(TernaryQueryEngineTest, EmptyCompoundIdentity) {
   auto package = CreatePackage();
   FunctionBuilder fb(TestName(), package.get());
@@ -1733,6 +1765,28 @@ TEST_F(TernaryQueryEngineTest, Repopulate) {
   EXPECT_THAT(query_engine.ToString(result.node()), "0b0");
 }
 
+TEST_F(TernaryQueryEngineTest, PopulateCone) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue masked = fb.And(x, fb.Literal(UBits(0x0f, 8)));
+  BValue unrelated = fb.Not(x);
+
+  // The function need not be built.
+  TernaryQueryEngine query_engine;
+  XLS_ASSERT_OK(query_engine.PopulateCone(masked.node()));
+  EXPECT_THAT(query_engine.ToString(masked.node()), "0b0000_XXXX");
+  EXPECT_TRUE(query_engine.IsTracked(x.node()));
+  EXPECT_FALSE(query_engine.IsTracked(unrelated.node()));
+
+  // Nodes added later reuse the information computed so far.
+  BValue high = fb.BitSlice(masked, /*start=*/4, /*width=*/4);
+  BValue is_zero = fb.Eq(high, fb.Literal(UBits(0, 4)));
+  XLS_ASSERT_OK(query_engine.PopulateCone(is_zero.node()));
+  EXPECT_TRUE(query_engine.IsOne(TreeBitLocation(is_zero.node(), 0)));
+  EXPECT_FALSE(query_engine.IsTracked(unrelated.node()));
+}
+
 namespace {
 
 class ArrayCreation : public benchmark_support::strategy::NaryNode {
@@ -79,7 +79,7 @@ LeafTypeTree<TernaryVector> UnownedUnionQueryEngine::GetTernary(
   for (const auto& engine : engines_) {
     if (engine->IsTracked(node)) {
       leaf_type_tree::SimpleUpdateFrom<TernaryVector, TernaryVector>(
-          result.AsMutableView(), engine->GetTernary(node).AsView(),
+          result.AsMutableView(), engine->GetTernaryShared(node).AsView(),
           [](TernaryVector& lhs, const TernaryVector& rhs) {
             CHECK_OK(ternary_ops::UpdateWithUnion(lhs, rhs));
           });
@@ -88,6 +88,28 @@ LeafTypeTree<TernaryVector> UnownedUnionQueryEngine::GetTernary(
   return result;
 }
 
+TernaryVector UnownedUnionQueryEngine::GetTernaryElement(
+    Node* node, absl::Span<const int64_t> index) const {
+  std::optional<TernaryVector> result;
+  for (const auto& engine : engines_) {
+    if (engine->IsTracked(node)) {
+      if (result.has_value()) {
+        CHECK_OK(ternary_ops::UpdateWithUnion(
+            *result, engine->GetTernaryElement(node, index)));
+      } else {
+        result = engine->GetTernaryElement(node, index);
+      }
+    }
+  }
+  if (!result.has_value()) {
+    Type* leaf_type =
+        leaf_type_tree_internal::GetSubtypeAndOffset(node->GetType(), index)
+            .first;
+    return TernaryVector(leaf_type->GetFlatBitCount(), TernaryValue::kUnknown);
+  }
+  return *std::move(result);
+}
+
 std::unique_ptr<QueryEngine> UnownedUnionQueryEngine::SpecializeGivenPredicate(
     const absl::flat_hash_set<PredicateState>& state) const {
   std::vector<std::unique_ptr<QueryEngine>> engines;
@@ -108,7 +130,7 @@ LeafTypeTree<IntervalSet> UnownedUnionQueryEngine::GetIntervals(
   for (const auto& engine : engines_) {
     if (engine->IsTracked(node)) {
       leaf_type_tree::SimpleUpdateFrom<IntervalSet, IntervalSet>(
-          result.AsMutableView(), engine->GetIntervals(node).AsView(),
+          result.AsMutableView(), engine->GetIntervalsShared(node).AsView(),
           [](IntervalSet& lhs, const IntervalSet& rhs) {
             lhs = IntervalSet::Intersect(lhs, rhs);
           });
@@ -117,6 +139,21 @@ LeafTypeTree<IntervalSet> UnownedUnionQueryEngine::GetIntervals(
   return result;
 }
 
+IntervalSet UnownedUnionQueryEngine::GetIntervalsElement(
+    Node* node, absl::Span<const int64_t> index) const {
+  Type* leaf_type =
+      leaf_type_tree_internal::GetSubtypeAndOffset(node->GetType(), index)
+          .first;
+  IntervalSet result = IntervalSet::Maximal(leaf_type->GetFlatBitCount());
+  for (const auto& engine : engines_) {
+    if (engine->IsTracked(node)) {
+      result = IntervalSet::Intersect(result,
+                                      engine->GetIntervalsElement(node, index));
+    }
+  }
+  return result;
+}
+
 bool UnownedUnionQueryEngine::AtMostOneTrue(
     absl::Span<TreeBitLocation const> bits) const {
   for (const auto& engine : engines_) {
@@ -56,8 +56,14 @@ class UnownedUnionQueryEngine : public QueryEngine {
 
   LeafTypeTree<TernaryVector> GetTernary(Node* node) const override;
 
+  TernaryVector GetTernaryElement(
+      Node* node, absl::Span<const int64_t> index = {}) const override;
+
   LeafTypeTree<IntervalSet> GetIntervals(Node* node) const override;
 
+  IntervalSet GetIntervalsElement(
+      Node* node, absl::Span<const int64_t> index = {}) const override;
+
   std::unique_ptr<QueryEngine> SpecializeGivenPredicate(
       const absl::flat_hash_set<PredicateState>& state) const override;
 
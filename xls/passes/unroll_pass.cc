@@ -15,17 +15,26 @@
 #include "xls/passes/unroll_pass.h"
 
 #include <cstdint>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
@@ -73,6 +82,158 @@ absl::Status UnrollCountedFor(CountedFor* loop) {
   return f->RemoveNode(loop);
 }
 
+// Returns whether `node` may be removed when it has no users. Matches
+// DeadCodeEliminationPass.
+bool IsDeletable(Node* node) {
+  return !node->function_base()->HasImplicitUse(node) &&
+         (!OpIsSideEffecting(node->op()) || node->Is<Gate>());
+}
+
+// Returns whether `node` can be evaluated at compile time given literal
+// operands. Matches ConstantFoldingPass.
+bool IsFoldable(Node* node, absl::Span<Node* const> operands) {
+  return !TypeHasToken(node->GetType()) &&
+         (!OpIsSideEffecting(node->op()) || node->Is<Gate>()) &&
+         absl::c_all_of(operands, [](Node* n) { return n->Is<Literal>(); });
+}
+
+// Returns the non-parameter nodes of `body` which are not dead, in
+// topological order.
+std::vector<Node*> GetLiveBodyNodes(Function* body) {
+  absl::flat_hash_set<Node*> live;
+  std::vector<Node*> worklist;
+  auto mark_live = [&](Node* node) {
+    if (live.insert(node).second) {
+      worklist.push_back(node);
+    }
+  };
+  mark_live(body->return_value());
+  for (Node* node : body->nodes()) {
+    if (!IsDeletable(node)) {
+      mark_live(node);
+    }
+  }
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    for (Node* operand : node->operands()) {
+      mark_live(operand);
+    }
+  }
+  std::vector<Node*> nodes;
+  for (Node* node : TopoSort(body)) {
+    if (!node->Is<Param>() && live.contains(node)) {
+      nodes.push_back(node);
+    }
+  }
+  return nodes;
+}
+
+// Unrolls the node "loop" by inlining the body once per trip. Each iteration
+// is simplified as it is emitted: nodes with literal operands are constant
+// folded, equivalent nodes are commoned and nodes left dead are removed. This
+// keeps the graph from ever holding the full unsimplified expansion of loops
+// with large trip counts.
+absl::Status StreamingUnrollCountedFor(CountedFor* loop) {
+  FunctionBase* f = loop->function_base();
+  Function* body = loop->body();
+  std::vector<Node*> body_nodes = GetLiveBodyNodes(body);
+  int64_t ivar_bit_count = body->params()[0]->BitCountOrDie();
+
+  // Map from body node to its value in the current iteration.
+  absl::flat_hash_map<Node*, Node*> values;
+  values.reserve(body->node_count());
+  // Nodes of the current iteration by op and operands, and literals of the
+  // current iteration by value, for commoning.
+  absl::flat_hash_map<std::pair<Op, std::vector<Node*>>, std::vector<Node*>>
+      candidates;
+  absl::flat_hash_map<std::string, Node*> literals;
+  std::vector<Node*> iteration_nodes;
+  std::vector<Node*> operands;
+  std::vector<Value> operand_values;
+
+  Node* loop_carry = loop->initial_value();
+  for (int64_t trip = 0, iv = 0; trip < loop->trip_count();
+       ++trip, iv += loop->stride()) {
+    values.clear();
+    candidates.clear();
+    literals.clear();
+    iteration_nodes.clear();
+    // The carry of the previous iteration may be left dead by this one.
+    if (trip > 0) {
+      iteration_nodes.push_back(loop_carry);
+    }
+
+    XLS_ASSIGN_OR_RETURN(
+        Literal * iv_node,
+        f->MakeNode<Literal>(loop->loc(), Value(UBits(iv, ivar_bit_count))));
+    iteration_nodes.push_back(iv_node);
+    literals[iv_node->value().ToString()] = iv_node;
+    values[body->params()[0]] = iv_node;
+    values[body->params()[1]] = loop_carry;
+    for (int64_t i = 0; i < loop->invariant_args().size(); ++i) {
+      values[body->params()[i + 2]] = loop->invariant_args()[i];
+    }
+
+    for (Node* node : body_nodes) {
+      operands.clear();
+      for (Node* operand : node->operands()) {
+        operands.push_back(values.at(operand));
+      }
+      Node* clone;
+      if (IsFoldable(node, operands)) {
+        operand_values.clear();
+        for (Node* operand : operands) {
+          operand_values.push_back(operand->As<Literal>()->value());
+        }
+        XLS_ASSIGN_OR_RETURN(Value result, InterpretNode(node, operand_values));
+        XLS_ASSIGN_OR_RETURN(clone, f->MakeNode<Literal>(node->loc(), result));
+      } else {
+        XLS_ASSIGN_OR_RETURN(clone, node->CloneInNewFunction(operands, f));
+      }
+
+      Node* equivalent = nullptr;
+      if (clone->Is<Literal>()) {
+        auto [it, inserted] = literals.try_emplace(
+            clone->As<Literal>()->value().ToString(), clone);
+        equivalent = inserted ? nullptr : it->second;
+      } else {
+        std::vector<Node*>& equivalents =
+            candidates[{clone->op(), clone->operands()}];
+        auto it = absl::c_find_if(equivalents, [&](Node* n) {
+          return n->IsDefinitelyEqualTo(clone);
+        });
+        if (it != equivalents.end()) {
+          equivalent = *it;
+        } else {
+          equivalents.push_back(clone);
+        }
+      }
+      if (equivalent != nullptr) {
+        XLS_RETURN_IF_ERROR(f->RemoveNode(clone));
+        clone = equivalent;
+      } else {
+        iteration_nodes.push_back(clone);
+      }
+      values[node] = clone;
+    }
+    loop_carry = values.at(body->return_value());
+
+    // Remove the nodes of this iteration left dead by folding and commoning.
+    // Users are created after their operands so a reverse sweep removes whole
+    // dead chains.
+    for (auto it = iteration_nodes.rbegin(); it != iteration_nodes.rend();
+         ++it) {
+      Node* node = *it;
+      if (node != loop_carry && node->users().empty() && IsDeletable(node)) {
+        XLS_RETURN_IF_ERROR(f->RemoveNode(node));
+      }
+    }
+  }
+  XLS_RETURN_IF_ERROR(loop->ReplaceUsesWith(loop_carry));
+  return f->RemoveNode(loop);
+}
+
 }  // namespace
 
 absl::StatusOr<bool> UnrollPass::RunOnFunctionBaseInternal(
@@ -84,7 +245,12 @@ absl::StatusOr<bool> UnrollPass::RunOnFunctionBaseInternal(
     if (loop == nullptr) {
       break;
     }
-    XLS_RETURN_IF_ERROR(UnrollCountedFor(loop));
+    if (options.streaming_unroll_min_trip_count.has_value() &&
+        loop->trip_count() >= *options.streaming_unroll_min_trip_count) {
+      XLS_RETURN_IF_ERROR(StreamingUnrollCountedFor(loop));
+    } else {
+      XLS_RETURN_IF_ERROR(UnrollCountedFor(loop));
+    }
     changed = true;
   }
   return changed;
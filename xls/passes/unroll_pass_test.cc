@@ -14,16 +14,22 @@
 
 #include "xls/passes/unroll_pass.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
+#include "xls/ir/value.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
 
@@ -63,5 +69,112 @@ fn unrollable() -> bits[32] {
                         m::Literal(0)));
 }
 
+TEST(UnrollPassTest, StreamingUnrollFoldsConstantIterations) {
+  const std::string program = R"(
+package some_package
+
+fn body(i: bits[4], accum: bits[32], zero: bits[32]) -> bits[32] {
+  zero_ext.3: bits[32] = zero_ext(i, new_bit_count=32)
+  add.4: bits[32] = add(zero_ext.3, accum)
+  ret add.5: bits[32] = add(add.4, zero)
+}
+
+fn unrollable() -> bits[32] {
+  literal.1: bits[32] = literal(value=0)
+  ret counted_for.2: bits[32] = counted_for(literal.1, trip_count=2, stride=2, body=body, invariant_args=[literal.1])
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  PassResults results;
+  OptimizationPassOptions options;
+  options.streaming_unroll_min_trip_count = 2;
+  UnrollPass pass;
+  EXPECT_THAT(pass.RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Literal(2));
+  // Only the original literal and the result of the last iteration remain.
+  EXPECT_EQ(f->node_count(), 2);
+}
+
+TEST(UnrollPassTest, StreamingUnrollSimplifiesEachIteration) {
+  const std::string program = R"(
+package some_package
+
+fn body(i: bits[8], accum: bits[8], x: bits[8]) -> bits[8] {
+  one: bits[8] = literal(value=1)
+  i_plus_one: bits[8] = add(i, one)
+  dead: bits[8] = neg(accum)
+  masked_a: bits[8] = and(x, i_plus_one)
+  masked_b: bits[8] = and(x, i_plus_one)
+  sum: bits[8] = add(masked_a, masked_b)
+  ret result: bits[8] = xor(accum, sum)
+}
+
+fn unrollable(x: bits[8]) -> bits[8] {
+  literal.1: bits[8] = literal(value=0)
+  ret counted_for.2: bits[8] = counted_for(literal.1, trip_count=64, stride=3, body=body, invariant_args=[x])
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  std::vector<Value> expected;
+  for (int64_t x = 0; x < 256; x += 17) {
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> r,
+                             InterpretFunction(f, {Value(UBits(x, 8))}));
+    expected.push_back(r.value);
+  }
+
+  PassResults results;
+  OptimizationPassOptions options;
+  options.streaming_unroll_min_trip_count = 64;
+  UnrollPass pass;
+  EXPECT_THAT(pass.RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+  // Each iteration leaves a literal mask, an and, an add and an xor: the
+  // increment is folded, the duplicate and is commoned and the neg is dead.
+  EXPECT_EQ(f->node_count(), 2 + 64 * 4);
+  EXPECT_THAT(f->return_value(),
+              m::Xor(m::Xor(), m::Add(m::And(m::Param("x"), m::Literal()),
+                                      m::And(m::Param("x"), m::Literal()))));
+
+  for (int64_t x = 0, i = 0; x < 256; x += 17, ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> r,
+                             InterpretFunction(f, {Value(UBits(x, 8))}));
+    EXPECT_EQ(r.value, expected[i]) << "x = " << x;
+  }
+}
+
+TEST(UnrollPassTest, StreamingUnrollOnlyAppliesAboveTripCount) {
+  const std::string program = R"(
+package some_package
+
+fn body(i: bits[4], accum: bits[32]) -> bits[32] {
+  zero_ext.3: bits[32] = zero_ext(i, new_bit_count=32)
+  ret add.4: bits[32] = add(zero_ext.3, accum)
+}
+
+fn unrollable() -> bits[32] {
+  literal.1: bits[32] = literal(value=0)
+  ret counted_for.2: bits[32] = counted_for(literal.1, trip_count=2, stride=1, body=body)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  PassResults results;
+  OptimizationPassOptions options;
+  options.streaming_unroll_min_trip_count = 3;
+  UnrollPass pass;
+  EXPECT_THAT(pass.RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Invoke());
+}
+
 }  // namespace
 }  // namespace xls
@@ -15,6 +15,10 @@
 #include "xls/passes/verifier_checker.h"
 
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/package.h"
 #include "xls/ir/verifier.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
@@ -24,7 +28,19 @@ namespace xls {
 absl::Status VerifierChecker::Run(Package* p,
                                   const OptimizationPassOptions& options,
                                   PassResults* results) const {
-  return VerifyPackage(p);
+  if (!options.incremental_passes) {
+    return VerifyPackage(p);
+  }
+  absl::MutexLock lock(&mutex_);
+  if (run_count_++ % full_verification_interval_ != 0) {
+    return VerifyPackageIncrementally(p, &verified_epochs_);
+  }
+  verified_epochs_.clear();
+  XLS_RETURN_IF_ERROR(VerifyPackage(p));
+  for (FunctionBase* f : p->GetFunctionBases()) {
+    verified_epochs_[f->uid()] = f->change_epoch();
+  }
+  return absl::OkStatus();
 }
 
 }  // namespace xls
@@ -15,16 +15,40 @@
 #ifndef XLS_PASSES_VERIFIER_CHECKER_H_
 #define XLS_PASSES_VERIFIER_CHECKER_H_
 
+#include <cstdint>
+
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/verifier.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
 
 namespace xls {
 
 // Invariant checker which just runs xls::Verifier.
+//
+// If OptimizationPassOptions::incremental_passes is set, only the invariants
+// which may have been violated by changes since the previous run are checked
+// (see VerifyPackageIncrementally), except that every
+// `full_verification_interval`-th run verifies the whole package.
 class VerifierChecker : public OptimizationInvariantChecker {
  public:
+  static constexpr int64_t kDefaultFullVerificationInterval = 16;
+
+  explicit VerifierChecker(
+      int64_t full_verification_interval = kDefaultFullVerificationInterval)
+      : full_verification_interval_(full_verification_interval) {}
+
   absl::Status Run(Package* p, const OptimizationPassOptions& options,
                    PassResults* results) const override;
+
+ private:
+  int64_t full_verification_interval_;
+
+  mutable absl::Mutex mutex_;
+  mutable int64_t run_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  mutable VerifiedEpochs verified_epochs_ ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace xls
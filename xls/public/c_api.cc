@@ -17,6 +17,7 @@
 #include <string.h>  // NOLINT(modernize-deprecated-headers)
 
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
@@ -25,15 +26,32 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_buffer.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_proc_runtime.h"
 #include "xls/public/runtime_build_actions.h"
 
 namespace {
@@ -52,6 +70,83 @@ std::vector<std::filesystem::path> ToCpp(const char* additional_search_paths[],
 
 char* ToOwnedCString(const std::string& s) { return strdup(s.c_str()); }
 
+// Backing object for `xls_function_jit`. The FunctionJit's own buffers are
+// not safe for concurrent use, so each run borrows a temporary buffer from a
+// pool which grows to the maximum number of concurrent callers.
+struct FunctionJitHandle {
+  std::unique_ptr<xls::FunctionJit> jit;
+  absl::Mutex mu;
+  std::vector<xls::JitTempBuffer> temp_buffers ABSL_GUARDED_BY(mu);
+
+  xls::JitTempBuffer AcquireTempBuffer() {
+    {
+      absl::MutexLock lock(&mu);
+      if (!temp_buffers.empty()) {
+        xls::JitTempBuffer result = std::move(temp_buffers.back());
+        temp_buffers.pop_back();
+        return result;
+      }
+    }
+    return jit->CreateTempBuffer();
+  }
+
+  void ReleaseTempBuffer(xls::JitTempBuffer buffer) {
+    absl::MutexLock lock(&mu);
+    temp_buffers.push_back(std::move(buffer));
+  }
+};
+
+// Backing object for `xls_channel_queue`.
+struct ChannelQueueHandle {
+  xls::JitChannelQueue* queue;
+  int64_t element_size;
+};
+
+// Backing object for `xls_proc_runtime`. Queue handles are created on first
+// lookup and live as long as the runtime.
+struct ProcRuntimeHandle {
+  std::unique_ptr<xls::SerialProcRuntime> runtime;
+  absl::Mutex mu;
+  absl::flat_hash_map<std::string, std::unique_ptr<ChannelQueueHandle>> queues
+      ABSL_GUARDED_BY(mu);
+
+  absl::StatusOr<ChannelQueueHandle*> GetQueue(std::string_view name) {
+    absl::MutexLock lock(&mu);
+    auto it = queues.find(name);
+    if (it != queues.end()) {
+      return it->second.get();
+    }
+    XLS_ASSIGN_OR_RETURN(xls::ChannelQueue * queue,
+                         runtime->queue_manager().GetQueueByName(name));
+    auto* jit_queue = dynamic_cast<xls::JitChannelQueue*>(queue);
+    XLS_RET_CHECK(jit_queue != nullptr)
+        << "Queue of channel " << name << " is not a JIT channel queue";
+    XLS_ASSIGN_OR_RETURN(xls::JitChannelQueueManager * queue_manager,
+                         runtime->GetJitChannelQueueManager());
+    auto handle = std::make_unique<ChannelQueueHandle>(ChannelQueueHandle{
+        .queue = jit_queue,
+        .element_size = queue_manager->runtime().GetTypeByteSize(
+            jit_queue->channel()->type())});
+    ChannelQueueHandle* result = handle.get();
+    queues.emplace(name, std::move(handle));
+    return result;
+  }
+};
+
+FunctionJitHandle* ToHandle(struct xls_function_jit* jit) {
+  CHECK(jit != nullptr);
+  return reinterpret_cast<FunctionJitHandle*>(jit);
+}
+
+bool ReturnErrorHelper(const absl::Status& status, char** error_out) {
+  if (status.ok()) {
+    *error_out = nullptr;
+    return true;
+  }
+  *error_out = ToOwnedCString(status.ToString());
+  return false;
+}
+
 // Helper function that we can use to adapt to the common C API pattern when
 // we're returning an `absl::StatusOr<std::string>` value.
 bool ReturnStringHelper(absl::StatusOr<std::string>& to_return,
@@ -151,6 +246,17 @@ bool xls_optimize_ir(const char* ir, const char* top, char** error_out,
   return ReturnStringHelper(result, error_out, ir_out);
 }
 
+bool xls_optimize_ir_with_cache(const char* ir, const char* top,
+                                const char* cache_dir, char** error_out,
+                                char** ir_out) {
+  CHECK(ir != nullptr);
+  CHECK(top != nullptr);
+  CHECK(cache_dir != nullptr);
+
+  absl::StatusOr<std::string> result = xls::OptimizeIr(ir, top, cache_dir);
+  return ReturnStringHelper(result, error_out, ir_out);
+}
+
 bool xls_mangle_dslx_name(const char* module_name, const char* function_name,
                           char** error_out, char** mangled_out) {
   CHECK(module_name != nullptr);
@@ -431,4 +537,217 @@ bool xls_interpret_function(struct xls_function* function, size_t argc,
   return true;
 }
 
+bool xls_make_function_jit(struct xls_function* function, char** error_out,
+                           struct xls_function_jit** result_out) {
+  CHECK(function != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  absl::StatusOr<std::unique_ptr<xls::FunctionJit>> jit =
+      xls::FunctionJit::Create(reinterpret_cast<xls::Function*>(function));
+  if (!jit.ok()) {
+    *result_out = nullptr;
+    return ReturnErrorHelper(jit.status(), error_out);
+  }
+  auto* handle = new FunctionJitHandle;
+  handle->jit = std::move(jit).value();
+  *result_out = reinterpret_cast<struct xls_function_jit*>(handle);
+  *error_out = nullptr;
+  return true;
+}
+
+void xls_function_jit_free(struct xls_function_jit* jit) {
+  delete reinterpret_cast<FunctionJitHandle*>(jit);
+}
+
+int64_t xls_function_jit_get_arg_count(struct xls_function_jit* jit) {
+  return ToHandle(jit)->jit->function()->params().size();
+}
+
+int64_t xls_function_jit_get_arg_size(struct xls_function_jit* jit,
+                                      int64_t arg_index) {
+  CHECK_LT(arg_index, xls_function_jit_get_arg_count(jit));
+  return ToHandle(jit)->jit->GetArgTypeSize(arg_index);
+}
+
+int64_t xls_function_jit_get_arg_alignment(struct xls_function_jit* jit,
+                                           int64_t arg_index) {
+  CHECK_LT(arg_index, xls_function_jit_get_arg_count(jit));
+  return ToHandle(jit)->jit->GetArgTypeAlignment(arg_index);
+}
+
+int64_t xls_function_jit_get_result_size(struct xls_function_jit* jit) {
+  return ToHandle(jit)->jit->GetReturnTypeSize();
+}
+
+int64_t xls_function_jit_get_result_alignment(struct xls_function_jit* jit) {
+  return ToHandle(jit)->jit->GetReturnTypeAlignment();
+}
+
+bool xls_function_jit_write_arg(struct xls_function_jit* jit,
+                                int64_t arg_index, const struct xls_value* value,
+                                uint8_t* buffer, char** error_out) {
+  CHECK(value != nullptr);
+  CHECK(buffer != nullptr);
+  CHECK(error_out != nullptr);
+  xls::FunctionJit* function_jit = ToHandle(jit)->jit.get();
+  absl::Span<xls::Param* const> params = function_jit->function()->params();
+  if (arg_index < 0 || arg_index >= params.size()) {
+    return ReturnErrorHelper(
+        absl::InvalidArgumentError(
+            absl::StrFormat("Argument index %d out of range; function has %d "
+                            "parameters",
+                            arg_index, params.size())),
+        error_out);
+  }
+  const xls::Value* xls_value = reinterpret_cast<const xls::Value*>(value);
+  xls::Type* type = params[arg_index]->GetType();
+  if (!xls::ValueConformsToType(*xls_value, type)) {
+    return ReturnErrorHelper(
+        absl::InvalidArgumentError(absl::StrFormat(
+            "Value %s does not match type %s of parameter %d",
+            xls_value->ToString(), type->ToString(), arg_index)),
+        error_out);
+  }
+  function_jit->runtime()->BlitValueToBuffer(
+      *xls_value, type,
+      absl::MakeSpan(buffer, function_jit->GetArgTypeSize(arg_index)));
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_function_jit_read_result(struct xls_function_jit* jit,
+                                  const uint8_t* buffer, char** error_out,
+                                  struct xls_value** result_out) {
+  CHECK(buffer != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  xls::FunctionJit* function_jit = ToHandle(jit)->jit.get();
+  xls::Value result = function_jit->runtime()->UnpackBuffer(
+      buffer, function_jit->function()->return_value()->GetType());
+  *result_out =
+      reinterpret_cast<struct xls_value*>(new xls::Value(std::move(result)));
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_function_jit_run(struct xls_function_jit* jit,
+                          const uint8_t* const* args, uint8_t* result,
+                          char** error_out) {
+  return xls_function_jit_run_batched(jit, args, /*batch_size=*/1, result,
+                                      error_out);
+}
+
+bool xls_function_jit_run_batched(struct xls_function_jit* jit,
+                                  const uint8_t* const* args,
+                                  size_t batch_size, uint8_t* results,
+                                  char** error_out) {
+  CHECK(results != nullptr);
+  CHECK(error_out != nullptr);
+  FunctionJitHandle* handle = ToHandle(jit);
+  int64_t argc = handle->jit->function()->params().size();
+  CHECK(argc == 0 || args != nullptr);
+  xls::JitTempBuffer temp_buffer = handle->AcquireTempBuffer();
+  absl::Status status = handle->jit->RunBatchedWithTempBuffer(
+      absl::MakeConstSpan(args, argc), batch_size,
+      absl::MakeSpan(results, batch_size * handle->jit->GetReturnTypeSize()),
+      temp_buffer);
+  handle->ReleaseTempBuffer(std::move(temp_buffer));
+  return ReturnErrorHelper(status, error_out);
+}
+
+bool xls_make_jit_proc_runtime(struct xls_package* package, char** error_out,
+                               struct xls_proc_runtime** result_out) {
+  CHECK(package != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  xls::Package* xls_package = reinterpret_cast<xls::Package*>(package);
+  std::optional<xls::FunctionBase*> top = xls_package->GetTop();
+  absl::StatusOr<std::unique_ptr<xls::SerialProcRuntime>> runtime =
+      top.has_value() && (*top)->IsProc() &&
+              (*top)->AsProcOrDie()->is_new_style_proc()
+          ? xls::CreateJitSerialProcRuntime((*top)->AsProcOrDie())
+          : xls::CreateJitSerialProcRuntime(xls_package);
+  if (!runtime.ok()) {
+    *result_out = nullptr;
+    return ReturnErrorHelper(runtime.status(), error_out);
+  }
+  auto* handle = new ProcRuntimeHandle;
+  handle->runtime = std::move(runtime).value();
+  *result_out = reinterpret_cast<struct xls_proc_runtime*>(handle);
+  *error_out = nullptr;
+  return true;
+}
+
+void xls_proc_runtime_free(struct xls_proc_runtime* runtime) {
+  delete reinterpret_cast<ProcRuntimeHandle*>(runtime);
+}
+
+bool xls_proc_runtime_tick(struct xls_proc_runtime* runtime, char** error_out) {
+  CHECK(runtime != nullptr);
+  CHECK(error_out != nullptr);
+  return ReturnErrorHelper(
+      reinterpret_cast<ProcRuntimeHandle*>(runtime)->runtime->Tick(),
+      error_out);
+}
+
+bool xls_proc_runtime_tick_until_blocked(struct xls_proc_runtime* runtime,
+                                         int64_t max_ticks, char** error_out,
+                                         int64_t* ticks_out) {
+  CHECK(runtime != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(ticks_out != nullptr);
+  absl::StatusOr<int64_t> ticks =
+      reinterpret_cast<ProcRuntimeHandle*>(runtime)->runtime->TickUntilBlocked(
+          max_ticks < 0 ? std::nullopt : std::make_optional(max_ticks));
+  if (!ticks.ok()) {
+    return ReturnErrorHelper(ticks.status(), error_out);
+  }
+  *ticks_out = *ticks;
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_proc_runtime_get_channel_queue(struct xls_proc_runtime* runtime,
+                                        const char* channel_name,
+                                        char** error_out,
+                                        struct xls_channel_queue** queue_out) {
+  CHECK(runtime != nullptr);
+  CHECK(channel_name != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(queue_out != nullptr);
+  absl::StatusOr<ChannelQueueHandle*> queue =
+      reinterpret_cast<ProcRuntimeHandle*>(runtime)->GetQueue(channel_name);
+  if (!queue.ok()) {
+    *queue_out = nullptr;
+    return ReturnErrorHelper(queue.status(), error_out);
+  }
+  *queue_out = reinterpret_cast<struct xls_channel_queue*>(*queue);
+  *error_out = nullptr;
+  return true;
+}
+
+int64_t xls_channel_queue_get_element_size(struct xls_channel_queue* queue) {
+  CHECK(queue != nullptr);
+  return reinterpret_cast<ChannelQueueHandle*>(queue)->element_size;
+}
+
+int64_t xls_channel_queue_get_size(struct xls_channel_queue* queue) {
+  CHECK(queue != nullptr);
+  return reinterpret_cast<ChannelQueueHandle*>(queue)->queue->GetSize();
+}
+
+void xls_channel_queue_push_bytes(struct xls_channel_queue* queue,
+                                  const uint8_t* data) {
+  CHECK(queue != nullptr);
+  CHECK(data != nullptr);
+  reinterpret_cast<ChannelQueueHandle*>(queue)->queue->WriteRaw(data);
+}
+
+bool xls_channel_queue_pop_bytes(struct xls_channel_queue* queue,
+                                 uint8_t* buffer) {
+  CHECK(queue != nullptr);
+  CHECK(buffer != nullptr);
+  return reinterpret_cast<ChannelQueueHandle*>(queue)->queue->ReadRaw(buffer);
+}
+
 }  // extern "C"
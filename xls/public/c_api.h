@@ -44,6 +44,9 @@ struct xls_package;
 struct xls_function;
 struct xls_type;
 struct xls_function_type;
+struct xls_function_jit;
+struct xls_proc_runtime;
+struct xls_channel_queue;
 
 void xls_init_xls(const char* usage, int argc, char *argv[]);
 
@@ -62,6 +65,13 @@ bool xls_convert_dslx_path_to_ir(const char* path, const char* dslx_stdlib_path,
 bool xls_optimize_ir(const char* ir, const char* top, char** error_out,
                      char** ir_out);
 
+// As `xls_optimize_ir`, but reuses optimized IR cached in `cache_dir` for
+// byte-identical inputs and adds newly optimized IR to it. Cached IR is checked
+// to parse and verify before it is returned.
+bool xls_optimize_ir_with_cache(const char* ir, const char* top,
+                                const char* cache_dir, char** error_out,
+                                char** ir_out);
+
 bool xls_mangle_dslx_name(const char* module_name, const char* function_name,
                           char** error_out, char** mangled_out);
 
@@ -168,6 +178,119 @@ bool xls_interpret_function(struct xls_function* function, size_t argc,
                             const struct xls_value** args, char** error_out,
                             struct xls_value** result_out);
 
+// -- JIT function evaluation
+//
+// An `xls_function_jit` is a compiled, reusable handle for evaluating a
+// function many times. Arguments and results are passed as byte buffers in the
+// JIT's native layout: argument `i` occupies `xls_function_jit_get_arg_size(i)`
+// bytes and must be aligned to `xls_function_jit_get_arg_alignment(i)`, and
+// likewise for the result. Buffers can be filled from and converted to
+// `xls_value`s with `xls_function_jit_write_arg` and
+// `xls_function_jit_read_result`.
+//
+// The run functions may be called concurrently from multiple threads on the
+// same handle, provided each call uses distinct result buffers.
+
+// Compiles `function` -- `result_out` must be freed with
+// `xls_function_jit_free`. The handle refers to `function`, so the owning
+// package must outlive it.
+bool xls_make_function_jit(struct xls_function* function, char** error_out,
+                           struct xls_function_jit** result_out);
+
+void xls_function_jit_free(struct xls_function_jit* jit);
+
+// Returns the number of parameters of the jitted function.
+int64_t xls_function_jit_get_arg_count(struct xls_function_jit* jit);
+
+// Returns the size and alignment in bytes of the native buffer for the
+// parameter `arg_index`.
+int64_t xls_function_jit_get_arg_size(struct xls_function_jit* jit,
+                                      int64_t arg_index);
+int64_t xls_function_jit_get_arg_alignment(struct xls_function_jit* jit,
+                                           int64_t arg_index);
+
+// Returns the size and alignment in bytes of the native result buffer.
+int64_t xls_function_jit_get_result_size(struct xls_function_jit* jit);
+int64_t xls_function_jit_get_result_alignment(struct xls_function_jit* jit);
+
+// Writes `value` in native layout to `buffer`, which must hold at least
+// `xls_function_jit_get_arg_size(jit, arg_index)` bytes. Returns false if the
+// value does not match the type of the parameter.
+bool xls_function_jit_write_arg(struct xls_function_jit* jit,
+                                int64_t arg_index, const struct xls_value* value,
+                                uint8_t* buffer, char** error_out);
+
+// Converts the native result held in `buffer` to a value -- `result_out` is
+// owned by the caller and must be freed with `xls_value_free`.
+bool xls_function_jit_read_result(struct xls_function_jit* jit,
+                                  const uint8_t* buffer, char** error_out,
+                                  struct xls_value** result_out);
+
+// Runs the function on the native argument buffers `args` (one per parameter)
+// and writes the native result to `result`. Returns false if an assertion
+// fails or a buffer is misaligned.
+bool xls_function_jit_run(struct xls_function_jit* jit,
+                          const uint8_t* const* args, uint8_t* result,
+                          char** error_out);
+
+// Runs the function on `batch_size` sets of arguments. `args[i]` holds
+// `batch_size` consecutive native values of parameter `i`, and `results`
+// receives `batch_size` consecutive native results (see
+// `xls_function_jit_get_result_size`).
+bool xls_function_jit_run_batched(struct xls_function_jit* jit,
+                                  const uint8_t* const* args,
+                                  size_t batch_size, uint8_t* results,
+                                  char** error_out);
+
+// -- JIT proc network evaluation
+//
+// An `xls_proc_runtime` evaluates the proc network of a package with the JIT.
+// Inputs are pushed onto and outputs popped from channel queues as raw bytes
+// in the JIT's native layout for the channel type (e.g. a `bits[32]` value is
+// a little-endian `uint32_t`), avoiding any `xls_value` conversion.
+
+// Creates a JIT proc runtime for the procs in `package` -- `result_out` must be
+// freed with `xls_proc_runtime_free`. If the package top is a proc with
+// proc-scoped channels the network is elaborated from it. The package must
+// outlive the runtime.
+bool xls_make_jit_proc_runtime(struct xls_package* package, char** error_out,
+                               struct xls_proc_runtime** result_out);
+
+void xls_proc_runtime_free(struct xls_proc_runtime* runtime);
+
+// Ticks every proc in the network once.
+bool xls_proc_runtime_tick(struct xls_proc_runtime* runtime, char** error_out);
+
+// Ticks the network until all procs with IO are blocked on receives, and
+// stores the number of ticks taken in `ticks_out`. Fails if the network is
+// still running after `max_ticks` ticks; a negative `max_ticks` means no limit.
+bool xls_proc_runtime_tick_until_blocked(struct xls_proc_runtime* runtime,
+                                         int64_t max_ticks, char** error_out,
+                                         int64_t* ticks_out);
+
+// Returns the queue of the channel named `channel_name`. The queue is owned by
+// the runtime; look it up once and reuse it for pushes and pops.
+bool xls_proc_runtime_get_channel_queue(struct xls_proc_runtime* runtime,
+                                        const char* channel_name,
+                                        char** error_out,
+                                        struct xls_channel_queue** queue_out);
+
+// Returns the number of bytes in the native representation of one element.
+int64_t xls_channel_queue_get_element_size(struct xls_channel_queue* queue);
+
+// Returns the number of elements currently in the queue.
+int64_t xls_channel_queue_get_size(struct xls_channel_queue* queue);
+
+// Pushes the element held in `data` (of the queue's element size) onto the
+// queue.
+void xls_channel_queue_push_bytes(struct xls_channel_queue* queue,
+                                  const uint8_t* data);
+
+// Pops an element into `buffer` (of the queue's element size). Returns false,
+// leaving `buffer` untouched, if the queue is empty.
+bool xls_channel_queue_pop_bytes(struct xls_channel_queue* queue,
+                                 uint8_t* buffer);
+
 }  // extern "C"
 
 #endif  // XLS_PUBLIC_C_API_H_
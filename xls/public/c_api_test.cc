@@ -14,9 +14,12 @@
 
 #include "xls/public/c_api.h"
 
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>  // NOLINT
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/cleanup/cleanup.h"
 #include "gmock/gmock.h"
@@ -24,6 +27,7 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/temp_directory.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 
 namespace {
@@ -190,6 +194,170 @@ fn f(x: bits[32]) -> bits[32] {
   ASSERT_TRUE(xls_value_eq(ft, result));
 }
 
+TEST(XlsCApiTest, FunctionJitRunAndRunBatched) {
+  const std::string kPackage = R"(package p
+
+fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.3: bits[32] = add(x, y, id=3)
+}
+)";
+
+  char* error = nullptr;
+  struct xls_package* package = nullptr;
+  ASSERT_TRUE(xls_parse_ir_package(kPackage.c_str(), "p.ir", &error, &package))
+      << "xls_parse_ir_package error: " << error;
+  absl::Cleanup free_package([package] { xls_package_free(package); });
+
+  struct xls_function* function = nullptr;
+  ASSERT_TRUE(xls_package_get_function(package, "f", &error, &function));
+
+  struct xls_function_jit* jit = nullptr;
+  ASSERT_TRUE(xls_make_function_jit(function, &error, &jit)) << error;
+  absl::Cleanup free_jit([jit] { xls_function_jit_free(jit); });
+  ASSERT_EQ(xls_function_jit_get_arg_count(jit), 2);
+  ASSERT_EQ(xls_function_jit_get_arg_size(jit, 0), sizeof(uint32_t));
+  ASSERT_EQ(xls_function_jit_get_arg_size(jit, 1), sizeof(uint32_t));
+  ASSERT_EQ(xls_function_jit_get_result_size(jit), sizeof(uint32_t));
+  ASSERT_LE(xls_function_jit_get_result_alignment(jit), alignof(uint32_t));
+
+  // Single evaluation through values.
+  struct xls_value* x = nullptr;
+  struct xls_value* y = nullptr;
+  struct xls_value* expected = nullptr;
+  ASSERT_TRUE(xls_parse_typed_value("bits[32]:40", &error, &x));
+  ASSERT_TRUE(xls_parse_typed_value("bits[32]:2", &error, &y));
+  ASSERT_TRUE(xls_parse_typed_value("bits[32]:42", &error, &expected));
+  absl::Cleanup free_values([&] {
+    xls_value_free(x);
+    xls_value_free(y);
+    xls_value_free(expected);
+  });
+  uint32_t x_buffer = 0;
+  uint32_t y_buffer = 0;
+  uint32_t result_buffer = 0;
+  ASSERT_TRUE(xls_function_jit_write_arg(
+      jit, 0, x, reinterpret_cast<uint8_t*>(&x_buffer), &error));
+  ASSERT_TRUE(xls_function_jit_write_arg(
+      jit, 1, y, reinterpret_cast<uint8_t*>(&y_buffer), &error));
+  const uint8_t* args[] = {reinterpret_cast<const uint8_t*>(&x_buffer),
+                           reinterpret_cast<const uint8_t*>(&y_buffer)};
+  ASSERT_TRUE(xls_function_jit_run(
+      jit, args, reinterpret_cast<uint8_t*>(&result_buffer), &error))
+      << error;
+  EXPECT_EQ(result_buffer, 42);
+  struct xls_value* result = nullptr;
+  ASSERT_TRUE(xls_function_jit_read_result(
+      jit, reinterpret_cast<const uint8_t*>(&result_buffer), &error, &result));
+  absl::Cleanup free_result([result] { xls_value_free(result); });
+  EXPECT_TRUE(xls_value_eq(result, expected));
+
+  // A value of the wrong type is rejected.
+  struct xls_value* bit = xls_value_make_true();
+  absl::Cleanup free_bit([bit] { xls_value_free(bit); });
+  ASSERT_FALSE(xls_function_jit_write_arg(
+      jit, 0, bit, reinterpret_cast<uint8_t*>(&x_buffer), &error));
+  EXPECT_THAT(std::string(error), HasSubstr("does not match type"));
+  free(error);
+  error = nullptr;
+
+  // Batched evaluation from several threads at once.
+  constexpr int kThreadCount = 4;
+  constexpr int kBatchSize = 100;
+  std::vector<std::vector<uint32_t>> xs(kThreadCount);
+  std::vector<std::vector<uint32_t>> results(kThreadCount);
+  std::vector<int> oks(kThreadCount);
+  std::vector<std::unique_ptr<xls::Thread>> threads;
+  for (int t = 0; t < kThreadCount; ++t) {
+    for (int i = 0; i < kBatchSize; ++i) {
+      xs[t].push_back(t * kBatchSize + i);
+    }
+    results[t].resize(kBatchSize);
+    threads.push_back(std::make_unique<xls::Thread>([&, t] {
+      std::vector<uint32_t> ys(kBatchSize, t);
+      const uint8_t* batch_args[] = {
+          reinterpret_cast<const uint8_t*>(xs[t].data()),
+          reinterpret_cast<const uint8_t*>(ys.data())};
+      char* thread_error = nullptr;
+      oks[t] = xls_function_jit_run_batched(
+          jit, batch_args, kBatchSize,
+          reinterpret_cast<uint8_t*>(results[t].data()), &thread_error);
+      free(thread_error);
+    }));
+  }
+  for (std::unique_ptr<xls::Thread>& thread : threads) {
+    thread->Join();
+  }
+  for (int t = 0; t < kThreadCount; ++t) {
+    ASSERT_NE(oks[t], 0) << "thread " << t;
+    for (int i = 0; i < kBatchSize; ++i) {
+      EXPECT_EQ(results[t][i], xs[t][i] + t);
+    }
+  }
+}
+
+TEST(XlsCApiTest, JitProcRuntimePushTickAndPop) {
+  const std::string kPackage = R"(package p
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="""""")
+chan out(bits[32], id=1, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="""""")
+
+top proc accumulate(x: bits[32], init={0}) {
+  tkn: token = literal(value=token)
+  rcv: (token, bits[32]) = receive(tkn, channel=in)
+  rcv_token: token = tuple_index(rcv, index=0)
+  rcv_data: bits[32] = tuple_index(rcv, index=1)
+  next_x: bits[32] = add(x, rcv_data)
+  send: token = send(rcv_token, next_x, channel=out)
+  next (next_x)
+}
+)";
+
+  char* error = nullptr;
+  struct xls_package* package = nullptr;
+  ASSERT_TRUE(xls_parse_ir_package(kPackage.c_str(), "p.ir", &error, &package))
+      << "xls_parse_ir_package error: " << error;
+  absl::Cleanup free_package([package] { xls_package_free(package); });
+
+  struct xls_proc_runtime* runtime = nullptr;
+  ASSERT_TRUE(xls_make_jit_proc_runtime(package, &error, &runtime)) << error;
+  absl::Cleanup free_runtime([runtime] { xls_proc_runtime_free(runtime); });
+
+  struct xls_channel_queue* in = nullptr;
+  struct xls_channel_queue* out = nullptr;
+  ASSERT_TRUE(xls_proc_runtime_get_channel_queue(runtime, "in", &error, &in));
+  ASSERT_TRUE(xls_proc_runtime_get_channel_queue(runtime, "out", &error, &out));
+  ASSERT_EQ(xls_channel_queue_get_element_size(in), sizeof(uint32_t));
+  ASSERT_EQ(xls_channel_queue_get_element_size(out), sizeof(uint32_t));
+
+  for (uint32_t value : {1, 2, 3}) {
+    xls_channel_queue_push_bytes(in,
+                                 reinterpret_cast<const uint8_t*>(&value));
+  }
+  EXPECT_EQ(xls_channel_queue_get_size(in), 3);
+
+  ASSERT_TRUE(xls_proc_runtime_tick(runtime, &error)) << error;
+  EXPECT_EQ(xls_channel_queue_get_size(out), 1);
+  int64_t ticks = 0;
+  ASSERT_TRUE(xls_proc_runtime_tick_until_blocked(runtime, /*max_ticks=*/100,
+                                                  &error, &ticks))
+      << error;
+  EXPECT_EQ(xls_channel_queue_get_size(in), 0);
+
+  std::vector<uint32_t> outputs;
+  uint32_t output = 0;
+  while (xls_channel_queue_pop_bytes(out,
+                                     reinterpret_cast<uint8_t*>(&output))) {
+    outputs.push_back(output);
+  }
+  EXPECT_THAT(outputs, testing::ElementsAre(1, 3, 6));
+
+  struct xls_channel_queue* missing = nullptr;
+  ASSERT_FALSE(xls_proc_runtime_get_channel_queue(runtime, "no_such_channel",
+                                                  &error, &missing));
+  EXPECT_THAT(std::string(error), HasSubstr("no_such_channel"));
+  free(error);
+}
+
 TEST(XlsCApiTest, ParsePackageAndOptimizeFunctionInIt) {
   const std::string kPackage = R"(
 package p
@@ -217,6 +385,36 @@ top fn f() -> bits[32] {
   EXPECT_EQ(std::string_view(opt_ir), kWant);
 }
 
+TEST(XlsCApiTest, OptimizeIrWithCache) {
+  const std::string kPackage = R"(
+package p
+
+fn f() -> bits[32] {
+  one: bits[32] = literal(value=1)
+  ret result: bits[32] = add(one, one)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(xls::TempDirectory temp_dir,
+                           xls::TempDirectory::Create());
+  std::string cache_dir = temp_dir.path().string();
+
+  // The second call is served from the cache and returns the same IR.
+  char* error = nullptr;
+  char* first = nullptr;
+  char* second = nullptr;
+  ASSERT_TRUE(xls_optimize_ir_with_cache(kPackage.c_str(), "f",
+                                         cache_dir.c_str(), &error, &first))
+      << error;
+  absl::Cleanup free_first([first] { free(first); });
+  ASSERT_FALSE(std::filesystem::is_empty(temp_dir.path()));
+  ASSERT_TRUE(xls_optimize_ir_with_cache(kPackage.c_str(), "f",
+                                         cache_dir.c_str(), &error, &second))
+      << error;
+  absl::Cleanup free_second([second] { free(second); });
+  EXPECT_EQ(std::string_view(first), std::string_view(second));
+  EXPECT_THAT(std::string(first), HasSubstr("literal(value=2"));
+}
+
 TEST(XlsCApiTest, MangleDslxName) {
   std::string module_name = "foo_bar";
   std::string function_name = "baz_bat";
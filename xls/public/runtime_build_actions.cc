@@ -18,12 +18,17 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <system_error>  // NOLINT
+#include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/dslx/bytecode/bytecode_cache.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/extract_module_name.h"
@@ -46,6 +51,20 @@ namespace xls {
 
 std::string_view GetDefaultDslxStdlibPath() { return kDefaultDslxStdlibPath; }
 
+namespace {
+
+absl::StatusOr<std::string> ConvertDslxToIrWithImportData(
+    std::string_view dslx, std::string_view path, std::string_view module_name,
+    dslx::ImportData* import_data) {
+  XLS_ASSIGN_OR_RETURN(
+      dslx::TypecheckedModule typechecked,
+      dslx::ParseAndTypecheck(dslx, path, module_name, import_data));
+  return dslx::ConvertModule(typechecked.module, import_data,
+                             dslx::ConvertOptions{});
+}
+
+}  // namespace
+
 absl::StatusOr<std::string> ConvertDslxToIr(
     std::string_view dslx, std::string_view path, std::string_view module_name,
     std::string_view dslx_stdlib_path,
@@ -55,11 +74,7 @@ absl::StatusOr<std::string> ConvertDslxToIr(
   dslx::ImportData import_data(dslx::CreateImportData(
       std::string(dslx_stdlib_path), additional_search_paths,
       dslx::kDefaultWarningsSet));
-  XLS_ASSIGN_OR_RETURN(
-      dslx::TypecheckedModule typechecked,
-      dslx::ParseAndTypecheck(dslx, path, module_name, &import_data));
-  return dslx::ConvertModule(typechecked.module, &import_data,
-                             dslx::ConvertOptions{});
+  return ConvertDslxToIrWithImportData(dslx, path, module_name, &import_data);
 }
 
 absl::StatusOr<std::string> ConvertDslxPathToIr(
@@ -71,11 +86,114 @@ absl::StatusOr<std::string> ConvertDslxPathToIr(
                          additional_search_paths);
 }
 
+struct DslxConversionSession::Workspace {
+  std::unique_ptr<dslx::ImportData> import_data;
+  // Modification times of the files of the modules in `import_data`.
+  absl::flat_hash_map<std::string, std::filesystem::file_time_type>
+      import_mtimes;
+
+  // Returns true if none of the imported files has been modified.
+  bool ImportedFilesUnchanged() const {
+    for (const auto& [path, mtime] : import_mtimes) {
+      std::error_code ec;
+      std::filesystem::file_time_type current =
+          std::filesystem::last_write_time(path, ec);
+      if (ec || current != mtime) {
+        VLOG(1) << "Imported file changed: " << path;
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+DslxConversionSession::DslxConversionSession(
+    std::string_view dslx_stdlib_path,
+    absl::Span<const std::filesystem::path> additional_search_paths)
+    : dslx_stdlib_path_(dslx_stdlib_path),
+      additional_search_paths_(additional_search_paths.begin(),
+                               additional_search_paths.end()) {}
+
+DslxConversionSession::~DslxConversionSession() = default;
+
+std::unique_ptr<DslxConversionSession::Workspace>
+DslxConversionSession::CreateWorkspace() const {
+  auto workspace = std::make_unique<Workspace>();
+  workspace->import_data = dslx::CreateImportDataPtr(
+      dslx_stdlib_path_, additional_search_paths_, dslx::kDefaultWarningsSet);
+  return workspace;
+}
+
+std::unique_ptr<DslxConversionSession::Workspace>
+DslxConversionSession::AcquireWorkspace() {
+  while (true) {
+    std::unique_ptr<Workspace> workspace;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (idle_workspaces_.empty()) {
+        break;
+      }
+      workspace = std::move(idle_workspaces_.back());
+      idle_workspaces_.pop_back();
+    }
+    if (workspace->ImportedFilesUnchanged()) {
+      return workspace;
+    }
+  }
+  return CreateWorkspace();
+}
+
+absl::StatusOr<std::string> DslxConversionSession::ConvertDslxToIr(
+    std::string_view dslx, std::string_view path,
+    std::string_view module_name) {
+  VLOG(5) << "path: " << path << " module name: " << module_name;
+  XLS_ASSIGN_OR_RETURN(dslx::ImportTokens subject,
+                       dslx::ImportTokens::FromString(module_name));
+  std::unique_ptr<Workspace> workspace = AcquireWorkspace();
+  if (workspace->import_data->Contains(subject)) {
+    // The module was imported by an earlier conversion, and other retained
+    // modules may refer to it.
+    workspace = CreateWorkspace();
+  }
+  absl::StatusOr<std::string> ir = ConvertDslxToIrWithImportData(
+      dslx, path, module_name, workspace->import_data.get());
+  // A failed conversion may leave partial state (e.g. type information for a
+  // module that was never added) behind, so only successful ones are reused.
+  if (!ir.ok() || !workspace->import_data->Remove(subject).ok()) {
+    return ir;
+  }
+  // Bytecode may refer to functions and type information of the removed
+  // module.
+  workspace->import_data->SetBytecodeCache(
+      std::make_unique<dslx::BytecodeCache>(workspace->import_data.get()));
+  for (const std::filesystem::path& module_path :
+       workspace->import_data->GetModulePaths()) {
+    std::error_code ec;
+    std::filesystem::file_time_type mtime =
+        std::filesystem::last_write_time(module_path, ec);
+    if (!ec) {
+      workspace->import_mtimes.try_emplace(module_path.string(), mtime);
+    }
+  }
+  absl::MutexLock lock(&mutex_);
+  idle_workspaces_.push_back(std::move(workspace));
+  return ir;
+}
+
+absl::StatusOr<std::string> DslxConversionSession::ConvertDslxPathToIr(
+    const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(std::string dslx, GetFileContents(path));
+  XLS_ASSIGN_OR_RETURN(std::string module_name, dslx::ExtractModuleName(path));
+  return ConvertDslxToIr(dslx, std::string{path}, module_name);
+}
+
 absl::StatusOr<std::string> OptimizeIr(std::string_view ir,
-                                       std::string_view top) {
+                                       std::string_view top,
+                                       std::string_view cache_dir) {
   const tools::OptOptions options = {
       .opt_level = xls::kMaxOptLevel,
       .top = top,
+      .cache_dir = std::string(cache_dir),
   };
   return tools::OptimizeIrForTop(ir, options);
 }
@@ -29,11 +29,15 @@
 // these actions remaining stable, they will evolve as the XLS system evolves.
 
 #include <filesystem>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/public/ir.h"
@@ -75,10 +79,55 @@ absl::StatusOr<std::string> ConvertDslxPathToIr(
     const std::filesystem::path& path, std::string_view dslx_stdlib_path,
     absl::Span<const std::filesystem::path> additional_search_paths);
 
+// A long-lived context for converting many DSLX modules to IR with the same
+// stdlib and search paths. Unlike the functions above, which parse and type
+// check the stdlib and every imported module on each call, a session keeps the
+// imported modules (and their type information) around and reuses them in
+// later conversions, as long as none of their files have been modified since
+// they were imported. The converted module itself is not retained; it is
+// always parsed and type checked from the given text.
+//
+// Thread-safe: concurrent conversions each use their own set of imported
+// modules, which are returned to the session for reuse afterwards.
+class DslxConversionSession {
+ public:
+  DslxConversionSession(
+      std::string_view dslx_stdlib_path,
+      absl::Span<const std::filesystem::path> additional_search_paths);
+  ~DslxConversionSession();
+
+  DslxConversionSession(const DslxConversionSession&) = delete;
+  DslxConversionSession& operator=(const DslxConversionSession&) = delete;
+
+  // As the ConvertDslxToIr() and ConvertDslxPathToIr() functions above.
+  absl::StatusOr<std::string> ConvertDslxToIr(std::string_view dslx,
+                                              std::string_view path,
+                                              std::string_view module_name);
+  absl::StatusOr<std::string> ConvertDslxPathToIr(
+      const std::filesystem::path& path);
+
+ private:
+  struct Workspace;
+
+  // Returns an idle workspace whose imported files are unchanged, or a new
+  // one if there is none.
+  std::unique_ptr<Workspace> AcquireWorkspace();
+  std::unique_ptr<Workspace> CreateWorkspace() const;
+
+  const std::string dslx_stdlib_path_;
+  const std::vector<std::filesystem::path> additional_search_paths_;
+
+  absl::Mutex mutex_;
+  std::vector<std::unique_ptr<Workspace>> idle_workspaces_
+      ABSL_GUARDED_BY(mutex_);
+};
+
 // Optimizes the generated XLS IR with the given top-level entity (e.g.,
-// function, proc, etc).
+// function, proc, etc). If `cache_dir` is non-empty, results are cached there
+// keyed on the IR, top and optimizer version (see xls/tools/opt_cache.h).
 absl::StatusOr<std::string> OptimizeIr(std::string_view ir,
-                                       std::string_view top);
+                                       std::string_view top,
+                                       std::string_view cache_dir = "");
 
 // Mangles the given DSL module/function name combination so it can be resolved
 // as a corresponding symbol in converted IR.
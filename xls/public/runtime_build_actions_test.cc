@@ -14,16 +14,28 @@
 
 #include "xls/public/runtime_build_actions.h"
 
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 
 namespace xls {
 namespace {
 
+using status_testing::IsOkAndHolds;
+using testing::HasSubstr;
+
 TEST(RuntimeBuildActionsTest, SimpleProtoToDslxConversion) {
   constexpr std::string_view kBindingName = "MY_TEST_MESSAGE";
   constexpr std::string_view kProtoDef = R"(
@@ -66,5 +78,73 @@ TEST(RuntimeBuildActionsTest, DefaultDslxPath) {
   EXPECT_EQ(GetDefaultDslxStdlibPath(), kDefaultDslxStdlibPath);
 }
 
+TEST(RuntimeBuildActionsTest, SessionMatchesOneShotConversion) {
+  constexpr std::string_view kDslx = R"(
+import std;
+
+fn main(x: u32) -> u32 { std::popcount(x) }
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string expected,
+      ConvertDslxToIr(kDslx, "main.x", "main", kDefaultDslxStdlibPath, {}));
+  DslxConversionSession session(kDefaultDslxStdlibPath, {});
+  // The second conversion reuses the type checked stdlib.
+  for (int64_t i = 0; i < 2; ++i) {
+    EXPECT_THAT(session.ConvertDslxToIr(kDslx, "main.x", "main"),
+                IsOkAndHolds(expected));
+  }
+  // A failed conversion does not affect later ones.
+  EXPECT_FALSE(session.ConvertDslxToIr("fn main(", "main.x", "main").ok());
+  EXPECT_THAT(session.ConvertDslxToIr(kDslx, "main.x", "main"),
+              IsOkAndHolds(expected));
+}
+
+TEST(RuntimeBuildActionsTest, SessionSeesModifiedImports) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  const std::filesystem::path dep_path = temp_dir.path() / "dep.x";
+  XLS_ASSERT_OK(SetFileContents(dep_path, "pub const X = u32:42;"));
+  constexpr std::string_view kDslx = R"(
+import dep;
+
+fn main() -> u32 { dep::X }
+)";
+  const std::vector<std::filesystem::path> search_paths = {temp_dir.path()};
+  DslxConversionSession session(kDefaultDslxStdlibPath, search_paths);
+  EXPECT_THAT(session.ConvertDslxToIr(kDslx, "main.x", "main"),
+              IsOkAndHolds(HasSubstr("value=42")));
+
+  XLS_ASSERT_OK(SetFileContents(dep_path, "pub const X = u32:43;"));
+  // Make sure the modification is visible with coarse timestamps.
+  std::filesystem::last_write_time(
+      dep_path,
+      std::filesystem::last_write_time(dep_path) + std::chrono::seconds(10));
+  EXPECT_THAT(session.ConvertDslxToIr(kDslx, "main.x", "main"),
+              IsOkAndHolds(HasSubstr("value=43")));
+}
+
+TEST(RuntimeBuildActionsTest, SessionIsThreadSafe) {
+  constexpr std::string_view kDslx = R"(
+import std;
+
+fn main(x: u32, y: u32) -> u32 { std::umax(x, y) }
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string expected,
+      ConvertDslxToIr(kDslx, "main.x", "main", kDefaultDslxStdlibPath, {}));
+  DslxConversionSession session(kDefaultDslxStdlibPath, {});
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t t = 0; t < 4; ++t) {
+    threads.push_back(std::make_unique<Thread>([&]() {
+      for (int64_t i = 0; i < 4; ++i) {
+        EXPECT_THAT(session.ConvertDslxToIr(kDslx, "main.x", "main"),
+                    IsOkAndHolds(expected));
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <numeric>
 #include <optional>
 #include <utility>
@@ -31,6 +32,7 @@
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
+#include "xls/common/thread.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/node.h"
@@ -41,12 +43,6 @@
 
 namespace xls {
 
-namespace {
-
-// Splits the nodes at the boundary between 'cycle' and 'cycle + 1' by
-// performing a minimum cost cut and tightens the bounds accordingly. Upon
-// return no node in the function will have a range which spans both 'cycle' and
-// 'cycle + 1'.
 absl::Status SplitAfterCycle(FunctionBase* f, int64_t cycle,
                              const DelayEstimator& delay_estimator,
                              sched::ScheduleBounds* bounds) {
@@ -75,6 +71,68 @@ absl::Status SplitAfterCycle(FunctionBase* f, int64_t cycle,
   return absl::OkStatus();
 }
 
+namespace {
+
+// The minimum number of nodes in a function for which cuts are computed on
+// multiple threads. Below this the cuts are cheaper than starting a thread.
+constexpr int64_t kMinNodeCountForConcurrentCuts = 256;
+
+// Splits the nodes at each cycle boundary from 'first' to 'last' inclusive by
+// recursive bisection: first after the middle cycle, then recursively in the
+// cycles before and after it, which is the order given by MiddleFirstOrder.
+//
+// Once the middle split is made no node's range spans it, so the two halves
+// involve disjoint sets of nodes and neither half's cuts or bound propagation
+// can affect the other. When 'spare_threads' is positive the upper half is
+// therefore computed concurrently on a copy of the bounds and merged back
+// afterwards; the result is identical to splitting sequentially.
+absl::Status SplitRecursively(FunctionBase* f, int64_t first, int64_t last,
+                              int64_t spare_threads,
+                              const DelayEstimator& delay_estimator,
+                              sched::ScheduleBounds* bounds) {
+  if (first > last) {
+    return absl::OkStatus();
+  }
+  int64_t middle = (first + last) / 2;
+  XLS_RETURN_IF_ERROR(SplitAfterCycle(f, middle, delay_estimator, bounds));
+  XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
+  XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
+
+  if (spare_threads == 0 || first > middle - 1 || middle + 1 > last) {
+    XLS_RETURN_IF_ERROR(SplitRecursively(f, first, middle - 1, spare_threads,
+                                         delay_estimator, bounds));
+    return SplitRecursively(f, middle + 1, last, spare_threads,
+                            delay_estimator, bounds);
+  }
+
+  int64_t lower_spare_threads = (spare_threads - 1) / 2;
+  int64_t upper_spare_threads = spare_threads - 1 - lower_spare_threads;
+  sched::ScheduleBounds upper_bounds = *bounds;
+  absl::Status upper_status;
+  {
+    Thread upper_thread([&]() {
+      upper_status = SplitRecursively(f, middle + 1, last, upper_spare_threads,
+                                      delay_estimator, &upper_bounds);
+    });
+    absl::Status lower_status =
+        SplitRecursively(f, first, middle - 1, lower_spare_threads,
+                         delay_estimator, bounds);
+    upper_thread.Join();
+    XLS_RETURN_IF_ERROR(lower_status);
+    XLS_RETURN_IF_ERROR(upper_status);
+  }
+
+  // Nodes after the middle split only changed in 'upper_bounds'.
+  for (Node* node : f->nodes()) {
+    if (upper_bounds.lb(node) > middle) {
+      XLS_RETURN_IF_ERROR(bounds->TightenNodeLb(node, upper_bounds.lb(node)));
+      XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, upper_bounds.ub(node)));
+    }
+  }
+  XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
+  return bounds->PropagateUpperBounds();
+}
+
 // Returns the number of pipeline registers (flops) on the interior of the
 // pipeline not counting the input and output flops (if any).
 absl::StatusOr<int64_t> CountInteriorPipelineRegisters(
@@ -193,30 +251,83 @@ absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
     }
   }
 
+  // The delays used by bound propagation are estimated on the first
+  // propagation and then shared by every copy of the bounds. Estimate them now
+  // so the trials below do not race to do it.
+  XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
+  XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
+
   // Try a number of different orderings of cycle boundary at which the min-cut
-  // is performed and keep the best one.
-  int64_t best_register_count = std::numeric_limits<int64_t>::max();
-  std::optional<sched::ScheduleBounds> best_bounds;
-  for (const std::vector<int64_t>& cut_order :
-       GetMinCutCycleOrders(pipeline_stages - 1)) {
+  // is performed and keep the best one. The trials are independent so for
+  // large functions each runs on its own thread, and the middle-first ordering
+  // is further split by recursive bisection.
+  const int64_t boundary_count = pipeline_stages - 1;
+  const bool concurrent = f->node_count() >= kMinNodeCountForConcurrentCuts;
+  std::vector<std::vector<int64_t>> cut_orders =
+      GetMinCutCycleOrders(boundary_count);
+  std::vector<int64_t> middle_first_order =
+      boundary_count > 2 ? MiddleFirstOrder(0, boundary_count - 1)
+                         : std::vector<int64_t>();
+  int64_t spare_threads = 0;
+  if (concurrent) {
+    spare_threads = std::max<int64_t>(
+        0, AvailableCPUs() - static_cast<int64_t>(cut_orders.size()));
+  }
+
+  std::vector<sched::ScheduleBounds> trial_bounds(cut_orders.size(), *bounds);
+  std::vector<absl::StatusOr<int64_t>> trial_register_counts(
+      cut_orders.size(), absl::UnknownError("trial not run"));
+  auto run_trial = [&](int64_t i) {
+    const std::vector<int64_t>& cut_order = cut_orders[i];
     VLOG(3) << absl::StreamFormat("Trying cycle order: {%s}",
                                   absl::StrJoin(cut_order, ", "));
-    sched::ScheduleBounds trial_bounds = *bounds;
-    // Partition the nodes at each cycle boundary. For each iteration, this
-    // splits the nodes into those which must be scheduled at or before the
-    // cycle and those which must be scheduled after. Upon loop completion each
-    // node will have a range of exactly one cycle.
-    for (int64_t cycle : cut_order) {
-      XLS_RETURN_IF_ERROR(
-          SplitAfterCycle(f, cycle, delay_estimator, &trial_bounds));
-      XLS_RETURN_IF_ERROR(trial_bounds.PropagateLowerBounds());
-      XLS_RETURN_IF_ERROR(trial_bounds.PropagateUpperBounds());
+    auto split = [&]() -> absl::Status {
+      if (cut_order == middle_first_order) {
+        return SplitRecursively(f, 0, boundary_count - 1, spare_threads,
+                                delay_estimator, &trial_bounds[i]);
+      }
+      // Partition the nodes at each cycle boundary. For each iteration, this
+      // splits the nodes into those which must be scheduled at or before the
+      // cycle and those which must be scheduled after. Upon loop completion
+      // each node will have a range of exactly one cycle.
+      for (int64_t cycle : cut_order) {
+        XLS_RETURN_IF_ERROR(
+            SplitAfterCycle(f, cycle, delay_estimator, &trial_bounds[i]));
+        XLS_RETURN_IF_ERROR(trial_bounds[i].PropagateLowerBounds());
+        XLS_RETURN_IF_ERROR(trial_bounds[i].PropagateUpperBounds());
+      }
+      return absl::OkStatus();
+    };
+    if (absl::Status status = split(); !status.ok()) {
+      trial_register_counts[i] = status;
+      return;
+    }
+    trial_register_counts[i] =
+        CountInteriorPipelineRegisters(f, trial_bounds[i]);
+  };
+  if (concurrent) {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(cut_orders.size());
+    for (int64_t i = 0; i < cut_orders.size(); ++i) {
+      threads.push_back(std::make_unique<Thread>([&, i]() { run_trial(i); }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  } else {
+    for (int64_t i = 0; i < cut_orders.size(); ++i) {
+      run_trial(i);
     }
+  }
+
+  int64_t best_register_count = std::numeric_limits<int64_t>::max();
+  std::optional<sched::ScheduleBounds> best_bounds;
+  for (int64_t i = 0; i < cut_orders.size(); ++i) {
     XLS_ASSIGN_OR_RETURN(int64_t trial_register_count,
-                         CountInteriorPipelineRegisters(f, trial_bounds));
+                         std::move(trial_register_counts[i]));
     if (!best_bounds.has_value() ||
         best_register_count > trial_register_count) {
-      best_bounds = std::move(trial_bounds);
+      best_bounds = std::move(trial_bounds[i]);
       best_register_count = trial_register_count;
     }
   }
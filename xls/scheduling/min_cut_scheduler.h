@@ -50,6 +50,14 @@ absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
 // are tried. This function returns this set of orderings.  Exposed for testing.
 std::vector<std::vector<int64_t>> GetMinCutCycleOrders(int64_t length);
 
+// Splits the nodes at the boundary between 'cycle' and 'cycle + 1' by
+// performing a minimum cost cut and tightens the bounds accordingly. Upon
+// return no node in the function will have a range which spans both 'cycle' and
+// 'cycle + 1'. The bounds are not propagated.
+absl::Status SplitAfterCycle(FunctionBase* f, int64_t cycle,
+                             const DelayEstimator& delay_estimator,
+                             sched::ScheduleBounds* bounds);
+
 }  // namespace xls
 
 #endif  // XLS_SCHEDULING_MIN_CUT_SCHEDULER_H_
@@ -15,14 +15,15 @@
 #include "xls/scheduling/mutual_exclusion_pass.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <iterator>
 #include <memory>
-#include <numeric>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -37,11 +38,14 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/casts.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/graph_coloring.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/data_structures/transitive_closure.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
@@ -51,11 +55,15 @@
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
+#include "xls/ir/package.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
+#include "xls/passes/bdd_function.h"
+#include "xls/passes/bdd_query_engine.h"
 #include "xls/passes/post_dominator_analysis.h"
+#include "xls/passes/query_engine.h"
 #include "xls/passes/token_provenance_analysis.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "xls/scheduling/scheduling_pass.h"
@@ -121,6 +129,10 @@ std::vector<std::pair<Node*, int64_t>> PredicateNodes(Predicates* p,
   return result;
 }
 
+// Groups of nodes with conflict graphs no larger than this are colored with the
+// fewest possible merge classes using Z3; larger ones are colored with DSatur.
+constexpr int64_t kExactColoringComponentSizeLimit = 16;
+
 bool IsHeavyOp(Op op) {
   return op == Op::kUMul || op == Op::kSMul || op == Op::kSend ||
          op == Op::kReceive;
@@ -263,16 +275,26 @@ absl::StatusOr<NodeRelation> ComputeMergableEffects(FunctionBase* f) {
 // A merge class is a set of nodes that are all jointly mutually exclusive.
 absl::StatusOr<std::vector<absl::flat_hash_set<Node*>>> ComputeMergeClasses(
     Predicates* p, FunctionBase* f, const ScheduleCycleMap& scm) {
-  absl::flat_hash_set<Node*> nodes;
-  std::vector<Node*> ordered_nodes;
-  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>> neighborhoods;
-
+  // Nodes can only be merged with nodes of the same op (and, for sends and
+  // receives, on the same channel), so each such group is colored separately.
+  std::vector<std::vector<Node*>> groups;
+  absl::flat_hash_map<std::pair<Op, std::string>, int64_t> group_indices;
   for (Node* node : TopoSort(f)) {
-    if (IsHeavyOp(node->op())) {
-      nodes.insert(node);
-      neighborhoods[node];
-      ordered_nodes.push_back(node);
+    if (!IsHeavyOp(node->op())) {
+      continue;
+    }
+    std::string channel_name;
+    if (node->Is<Send>()) {
+      channel_name = node->As<Send>()->channel_name();
+    } else if (node->Is<Receive>()) {
+      channel_name = node->As<Receive>()->channel_name();
     }
+    auto [it, inserted] =
+        group_indices.try_emplace({node->op(), channel_name}, groups.size());
+    if (inserted) {
+      groups.emplace_back();
+    }
+    groups[it->second].push_back(node);
   }
 
   XLS_ASSIGN_OR_RETURN(NodeRelation mergable_effects,
@@ -281,74 +303,44 @@ absl::StatusOr<std::vector<absl::flat_hash_set<Node*>>> ComputeMergeClasses(
     return mergable_effects.contains(x) && mergable_effects.at(x).contains(y) &&
            scm.at(x) == scm.at(y);
   };
-
-  for (Node* x : nodes) {
-    if (!(p->GetPredicate(x).has_value())) {
-      continue;
-    }
-    Node* px = p->GetPredicate(x).value();
-    for (Node* y : nodes) {
-      if (!(p->GetPredicate(y).has_value())) {
-        continue;
-      }
-      Node* py = p->GetPredicate(y).value();
-      if (x->op() != y->op()) {
-        continue;
-      }
-      if ((x->op() == Op::kSend) &&
-          (!is_mergable(x, y) ||
-           (x->As<Send>()->channel_name() != y->As<Send>()->channel_name()))) {
-        continue;
-      }
-      if ((x->op() == Op::kReceive) &&
-          (!is_mergable(x, y) || (x->As<Receive>()->channel_name() !=
-                                  y->As<Receive>()->channel_name()))) {
-        continue;
-      }
-      if (p->QueryMutuallyExclusive(px, py) == std::make_optional(true)) {
-        neighborhoods[x].insert(y);
-        neighborhoods[y].insert(x);
-      }
+  auto can_merge = [&](Node* x, Node* y) -> bool {
+    if (!p->GetPredicate(x).has_value() || !p->GetPredicate(y).has_value()) {
+      return false;
     }
-  }
-
-  // The complement of the `neighborhoods` graph
-  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>> inverted_neighborhoods;
-
-  for (Node* node : nodes) {
-    inverted_neighborhoods[node] = nodes;
-    for (Node* neighbor : neighborhoods.at(node)) {
-      inverted_neighborhoods[node].erase(neighbor);
+    if ((x->op() == Op::kSend || x->op() == Op::kReceive) &&
+        !is_mergable(x, y)) {
+      return false;
     }
-  }
-
-  absl::flat_hash_map<Node*, int64_t> node_to_index;
-  for (int64_t i = 0; i < ordered_nodes.size(); ++i) {
-    node_to_index[ordered_nodes[i]] = i;
-  }
-
-  std::vector<int64_t> iota(ordered_nodes.size());
-  std::iota(iota.begin(), iota.end(), 0);
-  std::vector<absl::flat_hash_set<int64_t>> coloring_indices =
-      RecursiveLargestFirstColoring<int64_t>(
-          absl::flat_hash_set<int64_t>(iota.begin(), iota.end()),
-          [&](int64_t node_index) -> absl::flat_hash_set<int64_t> {
-            absl::flat_hash_set<Node*> inv_neighbors =
-                inverted_neighborhoods.at(ordered_nodes.at(node_index));
-            absl::flat_hash_set<int64_t> result;
-            for (Node* inv_neighbor : inv_neighbors) {
-              result.insert(node_to_index.at(inv_neighbor));
-            }
-            return result;
-          });
+    return p->QueryMutuallyExclusive(p->GetPredicate(x).value(),
+                                     p->GetPredicate(y).value()) ==
+           std::make_optional(true);
+  };
 
   std::vector<absl::flat_hash_set<Node*>> coloring;
-  for (const absl::flat_hash_set<int64_t>& color_class : coloring_indices) {
-    absl::flat_hash_set<Node*> color_node_class;
-    for (int64_t index : color_class) {
-      color_node_class.insert(ordered_nodes[index]);
+  for (const std::vector<Node*>& group : groups) {
+    // Color the graph in which two nodes are adjacent unless they can be
+    // merged; each color class is then a set of jointly mergeable nodes.
+    const int64_t n = group.size();
+    std::vector<InlineBitmap> conflicts(n, InlineBitmap(n, /*fill=*/true));
+    for (int64_t i = 0; i < n; ++i) {
+      conflicts[i].Set(i, false);
+    }
+    for (int64_t i = 0; i < n; ++i) {
+      for (int64_t j = 0; j < n; ++j) {
+        if (i != j && conflicts[i].Get(j) && can_merge(group[i], group[j])) {
+          conflicts[i].Set(j, false);
+          conflicts[j].Set(i, false);
+        }
+      }
+    }
+    for (const std::vector<int64_t>& color_class :
+         DenseColoring(conflicts, {.exact_component_size_limit =
+                                       kExactColoringComponentSizeLimit})) {
+      absl::flat_hash_set<Node*>& color_node_class = coloring.emplace_back();
+      for (int64_t index : color_class) {
+        color_node_class.insert(group[index]);
+      }
     }
-    coloring.push_back(color_node_class);
   }
 
   for (const absl::flat_hash_set<Node*>& color_class : coloring) {
@@ -670,6 +662,117 @@ absl::StatusOr<bool> ControlsContendedProvenMutuallyExclusiveChannel(
   return false;
 }
 
+// Assigns each node of `f` a number such that nodes with the same number are
+// known to compute the same value: they have the same op and attributes and
+// their operands have the same numbers. Side-effecting nodes and nodes without
+// operands (other than literals) only share a number with themselves.
+absl::flat_hash_map<Node*, int64_t> ValueNumbers(FunctionBase* f) {
+  absl::flat_hash_map<Node*, int64_t> numbers;
+  absl::flat_hash_map<std::pair<Op, std::vector<int64_t>>, std::vector<Node*>>
+      candidates;
+  int64_t next_number = 0;
+  for (Node* node : TopoSort(f)) {
+    if (OpIsSideEffecting(node->op()) ||
+        (node->operand_count() == 0 && !node->Is<Literal>())) {
+      numbers[node] = next_number++;
+      continue;
+    }
+    std::vector<int64_t> operand_numbers;
+    operand_numbers.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      operand_numbers.push_back(numbers.at(operand));
+    }
+    std::vector<Node*>& same_shape =
+        candidates[{node->op(), std::move(operand_numbers)}];
+    auto it = absl::c_find_if(same_shape, [&](Node* candidate) {
+      return node->IsDefinitelyEqualTo(candidate);
+    });
+    if (it != same_shape.end()) {
+      numbers[node] = numbers.at(*it);
+      continue;
+    }
+    same_shape.push_back(node);
+    numbers[node] = next_number++;
+  }
+  return numbers;
+}
+
+// A query of whether two predicates can be true at the same time which needs
+// Z3 to answer.
+struct MutualExclusionQuery {
+  Node* pred_a;
+  Node* pred_b;
+  // Whether the predicates must be proven mutually exclusive for channel
+  // operations to be legal, in which case the query has no rlimit.
+  bool required_for_compilation = false;
+  Z3_lbool satisfiable = Z3_L_UNDEF;
+};
+
+// The minimum number of Z3 queries to give each thread. Every thread beyond
+// the first translates the function into its own Z3 context, so small batches
+// are cheaper to run on a single thread.
+constexpr int64_t kMinQueriesPerThread = 8;
+
+// Runs the given queries, setting their `satisfiable` fields. Z3 contexts are
+// not thread-safe, so the queries are spread over threads which each have
+// their own translation of `f`; the calling thread uses `translator`.
+absl::Status RunMutualExclusionQueries(
+    FunctionBase* f, solvers::z3::IrTranslator* translator, int64_t z3_rlimit,
+    absl::Span<MutualExclusionQuery> queries) {
+  auto run_query = [&](solvers::z3::IrTranslator* t,
+                       MutualExclusionQuery& query) {
+    Z3_context ctx = t->ctx();
+    Z3_ast z3_a = t->GetTranslation(query.pred_a);
+    Z3_ast z3_b = t->GetTranslation(query.pred_b);
+    // We try to find out if `a ∧ b` is satisfiable, which is true iff
+    // `a NAND b` is not valid.
+    Z3_ast a_and_b =
+        solvers::z3::BitVectorToBoolean(ctx, Z3_mk_bvand(ctx, z3_a, z3_b));
+    t->SetRlimit(query.required_for_compilation ? 0 : z3_rlimit);
+    query.satisfiable = RunSolver(ctx, a_and_b);
+  };
+
+  std::atomic<int64_t> next_query = 0;
+  auto worker = [&](solvers::z3::IrTranslator* t) {
+    for (int64_t i = next_query++; i < queries.size(); i = next_query++) {
+      run_query(t, queries[i]);
+    }
+  };
+
+  int64_t thread_count = std::min<int64_t>(
+      AvailableCPUs(),
+      (queries.size() + kMinQueriesPerThread - 1) / kMinQueriesPerThread);
+  absl::Mutex mutex;
+  absl::Status status;
+  // Translation may look up types of the package from every thread.
+  Package* package = f->package();
+  package->type_manager().BeginConcurrentAccess();
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>([&]() {
+      absl::StatusOr<std::unique_ptr<solvers::z3::IrTranslator>>
+          thread_translator = solvers::z3::IrTranslator::CreateAndTranslate(
+              f, /*allow_unsupported=*/true);
+      if (!thread_translator.ok()) {
+        absl::MutexLock lock(&mutex);
+        status.Update(thread_translator.status());
+        return;
+      }
+      solvers::z3::ScopedErrorHandler seh((*thread_translator)->ctx());
+      worker(thread_translator->get());
+      absl::MutexLock lock(&mutex);
+      status.Update(seh.status());
+    }));
+  }
+  worker(translator);
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  package->type_manager().EndConcurrentAccess();
+  absl::MutexLock lock(&mutex);
+  return status;
+}
+
 }  // namespace
 
 void Predicates::SetPredicate(Node* node, Node* pred) {
@@ -957,6 +1060,11 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
     return absl::OkStatus();
   }
 
+  // Questions which are cheap to answer with ternary or BDD analysis are
+  // answered that way before resorting to Z3.
+  BddQueryEngine query_engine(BddFunction::kDefaultPathLimit, IsCheapForBdds);
+  XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
+
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<solvers::z3::IrTranslator> translator,
                        solvers::z3::IrTranslator::CreateAndTranslate(f, true));
 
@@ -971,21 +1079,26 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
   // the runtime by doing only a linear amount of Z3 calls to remove
   // quadratically many Z3 calls.
   for (const auto& [node, index] : predicate_nodes) {
-    Z3_ast translated = translator->GetTranslation(node);
-    // Check whether it's possible for `node` to need to be proven mutually
-    // exclusive with some other node in order for channel operations to be
-    // legal; if so, we remove the rlimit on the prover.
-    XLS_ASSIGN_OR_RETURN(
-        bool required_for_compilation,
-        ControlsContendedProvenMutuallyExclusiveChannel(node, p, f));
-    if (required_for_compilation) {
-      LOG(INFO) << "Removing Z3's rlimit for always-false check on "
-                << node->GetName()
-                << " as mutual exclusion is required for compilation.";
+    bool always_false = query_engine.IsAllZeros(node);
+    if (!always_false) {
+      Z3_ast translated = translator->GetTranslation(node);
+      // Check whether it's possible for `node` to need to be proven mutually
+      // exclusive with some other node in order for channel operations to be
+      // legal; if so, we remove the rlimit on the prover.
+      XLS_ASSIGN_OR_RETURN(
+          bool required_for_compilation,
+          ControlsContendedProvenMutuallyExclusiveChannel(node, p, f));
+      if (required_for_compilation) {
+        LOG(INFO) << "Removing Z3's rlimit for always-false check on "
+                  << node->GetName()
+                  << " as mutual exclusion is required for compilation.";
+      }
+      translator->SetRlimit(z3_rlimit);
+      always_false =
+          RunSolver(ctx, solvers::z3::BitVectorToBoolean(ctx, translated)) ==
+          Z3_L_FALSE;
     }
-    translator->SetRlimit(z3_rlimit);
-    if (RunSolver(ctx, solvers::z3::BitVectorToBoolean(ctx, translated)) ==
-        Z3_L_FALSE) {
+    if (always_false) {
       VLOG(3) << "Proved that " << node << " is always false";
       // A constant false node is mutually exclusive with all other nodes.
       for (const auto& [other, other_index] : predicate_nodes) {
@@ -1003,6 +1116,7 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
   int64_t known_false = 0;
   int64_t known_true = 0;
   int64_t unknown = 0;
+  int64_t answered_without_z3 = 0;
 
   absl::flat_hash_map<Node*, absl::flat_hash_set<Op>> ops_for_pred;
   for (const auto& [node, index] : predicate_nodes) {
@@ -1023,6 +1137,14 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
     }
   }
 
+  // Pairs of predicates which compute the same pair of values share a single
+  // Z3 query, keyed by the value numbers of the predicates.
+  absl::flat_hash_map<Node*, int64_t> value_numbers = ValueNumbers(f);
+  std::vector<MutualExclusionQuery> queries;
+  absl::flat_hash_map<std::pair<int64_t, int64_t>, int64_t> query_index;
+  // Each pair of predicates which needs Z3, with the index of its query.
+  std::vector<std::tuple<Node*, Node*, int64_t>> pairs_for_z3;
+
   for (const auto& [node_a, index_a] : predicate_nodes) {
     XLS_ASSIGN_OR_RETURN(
         absl::flat_hash_set<Channel*> channels_a,
@@ -1043,13 +1165,19 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
         continue;
       }
 
-      Z3_ast z3_a = translator->GetTranslation(node_a);
-      Z3_ast z3_b = translator->GetTranslation(node_b);
-
-      // We try to find out if `a ∧ b` is satisfiable, which is true iff
-      // `a NAND b` is not valid.
-      Z3_ast a_and_b =
-          solvers::z3::BitVectorToBoolean(ctx, Z3_mk_bvand(ctx, z3_a, z3_b));
+      if (query_engine.AtMostOneTrue(
+              {TreeBitLocation(node_a, 0), TreeBitLocation(node_b, 0)})) {
+        ++answered_without_z3;
+        known_true += 1;
+        XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node_a, node_b));
+        continue;
+      }
+      if (query_engine.IsAllOnes(node_a) && query_engine.IsAllOnes(node_b)) {
+        ++answered_without_z3;
+        known_false += 1;
+        XLS_RETURN_IF_ERROR(p->MarkNotMutuallyExclusive(node_a, node_b));
+        continue;
+      }
 
       // Check whether `a` and `b` must be proven mutually exclusive in order
       // for channel operations to be legal; if so, we remove the rlimit on the
@@ -1060,31 +1188,49 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
       bool required_for_compilation = absl::c_any_of(
           channels_a,
           [&](Channel* channel) { return channels_b.contains(channel); });
-      translator->SetRlimit(required_for_compilation ? 0 : z3_rlimit);
       if (required_for_compilation) {
         LOG(INFO) << "Removing Z3's rlimit for mutual exclusion between "
                   << node_a->GetName() << " and " << node_b->GetName()
                   << " as mutual exclusion is required for compilation.";
       }
-      Z3_lbool satisfiable = RunSolver(ctx, a_and_b);
 
-      if (satisfiable == Z3_L_FALSE) {
-        known_true += 1;
-        XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node_a, node_b));
-      } else if (satisfiable == Z3_L_TRUE) {
-        known_false += 1;
-        XLS_RETURN_IF_ERROR(p->MarkNotMutuallyExclusive(node_a, node_b));
+      std::pair<int64_t, int64_t> key = std::minmax(value_numbers.at(node_a),
+                                                    value_numbers.at(node_b));
+      auto [it, inserted] = query_index.try_emplace(key, queries.size());
+      if (inserted) {
+        queries.push_back(MutualExclusionQuery{.pred_a = node_a,
+                                               .pred_b = node_b});
       } else {
-        unknown += 1;
-        VLOG(3) << "Z3 ran out of time checking mutual exclusion of "
-                << node_a->GetName() << " and " << node_b->GetName();
+        ++answered_without_z3;
       }
+      queries[it->second].required_for_compilation |= required_for_compilation;
+      pairs_for_z3.push_back({node_a, node_b, it->second});
+    }
+  }
+
+  XLS_RETURN_IF_ERROR(RunMutualExclusionQueries(f, translator.get(), z3_rlimit,
+                                                absl::MakeSpan(queries)));
+
+  for (const auto& [node_a, node_b, index] : pairs_for_z3) {
+    Z3_lbool satisfiable = queries[index].satisfiable;
+    if (satisfiable == Z3_L_FALSE) {
+      known_true += 1;
+      XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node_a, node_b));
+    } else if (satisfiable == Z3_L_TRUE) {
+      known_false += 1;
+      XLS_RETURN_IF_ERROR(p->MarkNotMutuallyExclusive(node_a, node_b));
+    } else {
+      unknown += 1;
+      VLOG(3) << "Z3 ran out of time checking mutual exclusion of "
+              << node_a->GetName() << " and " << node_b->GetName();
     }
   }
 
   VLOG(3) << "known_false = " << known_false;
   VLOG(3) << "known_true  = " << known_true;
   VLOG(3) << "unknown     = " << unknown;
+  VLOG(3) << "z3 queries  = " << queries.size() << " (" << answered_without_z3
+          << " pairs answered without a query)";
 
   XLS_RETURN_IF_ERROR(seh.status());
 
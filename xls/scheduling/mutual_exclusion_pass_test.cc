@@ -18,6 +18,7 @@
 #include <memory>
 #include <optional>
 #include <string_view>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -185,14 +186,76 @@ TEST_F(MutualExclusionPassTest,
           /*initial_values=*/{}, /*fifo_config=*/std::nullopt,
           /*flow_control=*/FlowControl::kReadyValid,
           /*strictness=*/ChannelStrictness::kArbitraryStaticOrder));
+  // The predicates are wide comparisons which BDD analysis does not model, so
+  // only Z3 could prove them mutually exclusive.
+  ProcBuilder pb("main", p.get());
+  BValue tok = pb.StateElement("__token", Value::Token());
+  BValue st = pb.StateElement("__state", Value(UBits(0, 32)));
+  BValue lit50 = pb.Literal(UBits(50, 32));
+  BValue lit60 = pb.Literal(UBits(60, 32));
+  BValue send0 = pb.SendIf(test_channel, tok,
+                           pb.ULt(st, pb.Literal(UBits(5, 32))), lit50);
+  BValue send1 = pb.SendIf(test_channel, tok,
+                           pb.UGt(st, pb.Literal(UBits(10, 32))), lit60);
   XLS_ASSERT_OK_AND_ASSIGN(
-      Proc * proc, CreateTwoParallelSendsProc(p.get(), "main", test_channel));
+      Proc * proc,
+      pb.Build({pb.AfterAll({send0, send1}),
+                pb.Add(st, pb.Literal(UBits(1, 32)))}));
   EXPECT_THAT(RunMutualExclusionPass(
                   proc, SchedulingOptions().mutual_exclusion_z3_rlimit(1)),
               IsOkAndHolds(false));
   EXPECT_EQ(NumberOfOp(proc, Op::kSend), 2);
 }
 
+TEST_F(MutualExclusionPassTest,
+       TwoParallelSendsWithSmallRlimitProvenWithoutZ3) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * test_channel,
+      p->CreateStreamingChannel(
+          "test_channel", ChannelOps::kSendOnly, p->GetBitsType(32),
+          /*initial_values=*/{}, /*fifo_config=*/std::nullopt,
+          /*flow_control=*/FlowControl::kReadyValid,
+          /*strictness=*/ChannelStrictness::kArbitraryStaticOrder));
+  // `st` and `!st` are shown to be mutually exclusive by BDD analysis, so the
+  // rlimit on Z3 does not matter.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc, CreateTwoParallelSendsProc(p.get(), "main", test_channel));
+  EXPECT_THAT(RunMutualExclusionPass(
+                  proc, SchedulingOptions().mutual_exclusion_z3_rlimit(1)),
+              IsOkAndHolds(true));
+  EXPECT_EQ(NumberOfOp(proc, Op::kSend), 1);
+  XLS_EXPECT_OK(VerifyProc(proc, true));
+}
+
+TEST_F(MutualExclusionPassTest, ManyParallelSendsWithArithmeticPredicates) {
+  // Enough pairs of predicates need Z3 that the queries are spread over
+  // several threads.
+  constexpr int64_t kSendCount = 8;
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * test_channel,
+      p->CreateStreamingChannel("test_channel", ChannelOps::kSendOnly,
+                                p->GetBitsType(32)));
+  ProcBuilder pb("main", p.get());
+  BValue tok = pb.StateElement("__token", Value::Token());
+  BValue st = pb.StateElement("__state", Value(UBits(0, 32)));
+  std::vector<BValue> sends;
+  for (int64_t i = 0; i < kSendCount; ++i) {
+    BValue in_range =
+        pb.And(pb.UGe(st, pb.Literal(UBits(10 * i, 32))),
+               pb.ULt(st, pb.Literal(UBits(10 * i + 5, 32))));
+    sends.push_back(
+        pb.SendIf(test_channel, tok, in_range, pb.Literal(UBits(i, 32))));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc,
+      pb.Build({pb.AfterAll(sends), pb.Add(st, pb.Literal(UBits(1, 32)))}));
+  EXPECT_THAT(RunMutualExclusionPass(proc), IsOkAndHolds(true));
+  EXPECT_EQ(NumberOfOp(proc, Op::kSend), 1);
+  XLS_EXPECT_OK(VerifyProc(proc, true));
+}
+
 TEST_F(MutualExclusionPassTest, ThreeParallelSends) {
   XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
      package test_module
@@ -0,0 +1,333 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/scheduling/partitioned_sdc_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/thread.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/scheduling/min_cut_scheduler.h"
+#include "xls/scheduling/schedule_bounds.h"
+#include "xls/scheduling/scheduling_options.h"
+#include "ortools/math_opt/cpp/math_opt.h"
+
+namespace xls {
+
+namespace {
+
+namespace math_opt = ::operations_research::math_opt;
+
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+// A range of consecutive stages and the nodes scheduled within it.
+struct StageGroup {
+  int64_t first;
+  int64_t last;
+  // The nodes in the group, in topological order.
+  std::vector<Node*> nodes;
+};
+
+// Returns the number of nodes which must be scheduled within stages 'first' to
+// 'last' inclusive but are not yet fixed to a single stage.
+int64_t UnfixedNodeCount(FunctionBase* f, int64_t first, int64_t last,
+                         const sched::ScheduleBounds& bounds) {
+  int64_t count = 0;
+  for (Node* node : f->nodes()) {
+    if (bounds.lb(node) >= first && bounds.ub(node) <= last &&
+        bounds.lb(node) < bounds.ub(node)) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+// Bisects the stages from 'first' to 'last' inclusive with minimum cost cuts
+// until each range has at most 'max_partition_node_count' unfixed nodes, and
+// appends the resulting ranges to 'ranges' in order.
+absl::Status SplitStages(FunctionBase* f, int64_t first, int64_t last,
+                         int64_t max_partition_node_count,
+                         const DelayEstimator& delay_estimator,
+                         sched::ScheduleBounds* bounds,
+                         std::vector<std::pair<int64_t, int64_t>>* ranges) {
+  if (first == last ||
+      UnfixedNodeCount(f, first, last, *bounds) <= max_partition_node_count) {
+    ranges->push_back({first, last});
+    return absl::OkStatus();
+  }
+  int64_t middle = (first + last) / 2;
+  XLS_RETURN_IF_ERROR(SplitAfterCycle(f, middle, delay_estimator, bounds));
+  XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
+  XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
+  XLS_RETURN_IF_ERROR(SplitStages(f, first, middle, max_partition_node_count,
+                                  delay_estimator, bounds, ranges));
+  return SplitStages(f, middle + 1, last, max_partition_node_count,
+                     delay_estimator, bounds, ranges);
+}
+
+// Schedules the nodes of 'groups[index]' within their bounds by solving the
+// SDC formulation restricted to the group. Edges to and from other groups only
+// contribute to the objective: values used by a later group are live until the
+// end of this group, and values defined by an earlier group and not used after
+// this group are live from its start until their last use within it.
+absl::StatusOr<ScheduleCycleMap> ScheduleStageGroup(
+    absl::Span<const StageGroup> groups, int64_t index,
+    const absl::flat_hash_map<Node*, int64_t>& group_of,
+    const absl::flat_hash_map<Node*, int64_t>& delay_map,
+    int64_t clock_period_ps, const sched::ScheduleBounds& bounds) {
+  const StageGroup& group = groups[index];
+  math_opt::Model model(
+      absl::StrFormat("partitioned_sdc_model:%d-%d", group.first, group.last));
+
+  absl::flat_hash_map<Node*, math_opt::Variable> cycle_var;
+  for (Node* node : group.nodes) {
+    cycle_var.emplace(node, model.AddContinuousVariable(
+                                static_cast<double>(bounds.lb(node)),
+                                static_cast<double>(bounds.ub(node)),
+                                node->GetName()));
+  }
+
+  auto live_after_group = [&](Node* node) {
+    for (Node* user : node->users()) {
+      if (group_of.at(user) > index) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  math_opt::LinearExpression objective;
+  absl::flat_hash_map<Node*, math_opt::Variable> incoming_lifetime_var;
+  for (Node* node : group.nodes) {
+    math_opt::Variable cycle = cycle_var.at(node);
+    math_opt::Variable lifetime = model.AddContinuousVariable(
+        0.0, kInfinity, absl::StrFormat("lifetime_%s", node->GetName()));
+    objective += 1024 *
+                 static_cast<double>(node->GetType()->GetFlatBitCount()) *
+                 lifetime;
+    // As in the SDC scheduler, favor ASAP schedules as a tie-breaker.
+    objective += cycle;
+
+    for (Node* user : node->users()) {
+      if (group_of.at(user) == index) {
+        model.AddLinearConstraint(cycle_var.at(user) - cycle >= 0.0);
+        model.AddLinearConstraint(lifetime + cycle - cycle_var.at(user) >=
+                                  0.0);
+      } else {
+        XLS_RET_CHECK_GT(group_of.at(user), index);
+        model.AddLinearConstraint(lifetime + cycle >=
+                                  static_cast<double>(group.last + 1));
+      }
+    }
+
+    for (Node* operand : node->operands()) {
+      if (group_of.at(operand) == index || live_after_group(operand)) {
+        continue;
+      }
+      auto it = incoming_lifetime_var.find(operand);
+      if (it == incoming_lifetime_var.end()) {
+        math_opt::Variable incoming_lifetime = model.AddContinuousVariable(
+            0.0, kInfinity,
+            absl::StrFormat("incoming_lifetime_%s", operand->GetName()));
+        objective +=
+            1024 * static_cast<double>(operand->GetType()->GetFlatBitCount()) *
+            incoming_lifetime;
+        it = incoming_lifetime_var.emplace(operand, incoming_lifetime).first;
+      }
+      model.AddLinearConstraint(it->second - cycle >=
+                                -static_cast<double>(group.first));
+    }
+  }
+
+  // Add the timing constraints. A combinational path can only be within a
+  // single stage, so only paths within the group need to be considered.
+  absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>
+      distances_to_node;
+  for (Node* node : group.nodes) {
+    const int64_t node_delay = delay_map.at(node);
+    absl::flat_hash_map<Node*, int64_t>& distances = distances_to_node[node];
+    distances[node] = node_delay;
+    for (Node* operand : node->operands()) {
+      auto operand_it = distances_to_node.find(operand);
+      if (operand_it == distances_to_node.end()) {
+        continue;
+      }
+      for (auto [a, operand_distance] : operand_it->second) {
+        auto [it, inserted] =
+            distances.try_emplace(a, operand_distance + node_delay);
+        if (!inserted) {
+          it->second = std::max(it->second, operand_distance + node_delay);
+        }
+      }
+    }
+    for (auto [a, distance] : distances) {
+      if (distance > clock_period_ps &&
+          distance - node_delay <= clock_period_ps) {
+        model.AddLinearConstraint(cycle_var.at(node) - cycle_var.at(a) >= 1.0);
+      }
+    }
+  }
+
+  model.Minimize(objective);
+  XLS_ASSIGN_OR_RETURN(math_opt::SolveResult result,
+                       math_opt::Solve(model, math_opt::SolverType::kGlop));
+  if (result.termination.reason != math_opt::TerminationReason::kOptimal) {
+    return absl::InternalError(absl::StrFormat(
+        "Unable to schedule stages %d to %d; solver terminated with %s",
+        group.first, group.last,
+        math_opt::EnumToString(result.termination.reason)));
+  }
+
+  ScheduleCycleMap cycle_map;
+  for (Node* node : group.nodes) {
+    double cycle = result.variable_values().at(cycle_var.at(node));
+    if (std::fabs(cycle - std::round(cycle)) > 0.001) {
+      return absl::InternalError(
+          "The scheduling result is expected to be integer");
+    }
+    cycle_map[node] = std::round(cycle);
+  }
+  return cycle_map;
+}
+
+}  // namespace
+
+absl::StatusOr<ScheduleCycleMap> PartitionedSDCScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    absl::Span<const SchedulingConstraint> constraints,
+    int64_t max_partition_node_count) {
+  VLOG(3) << "PartitionedSDCScheduler()";
+  VLOG(3) << "  pipeline stages = " << pipeline_stages;
+  XLS_RET_CHECK_GT(max_partition_node_count, 0);
+
+  if (!f->IsFunction()) {
+    return absl::UnimplementedError(
+        "Partitioned SDC scheduling only supports functions.");
+  }
+  for (const SchedulingConstraint& constraint : constraints) {
+    if (!std::holds_alternative<BackedgeConstraint>(constraint) &&
+        !std::holds_alternative<SendThenRecvConstraint>(constraint) &&
+        !std::holds_alternative<RecvsFirstSendsLastConstraint>(constraint)) {
+      return absl::UnimplementedError(
+          "Partitioned SDC scheduling doesn't support IO, node-in-cycle or "
+          "difference constraints.");
+    }
+  }
+  absl::flat_hash_map<Node*, int64_t> delay_map;
+  for (Node* node : f->nodes()) {
+    if (node->Is<MinDelay>()) {
+      return absl::UnimplementedError(
+          "Partitioned SDC scheduling doesn't support min_delay nodes.");
+    }
+    XLS_ASSIGN_OR_RETURN(delay_map[node],
+                         delay_estimator.GetOperationDelayInPs(node));
+  }
+
+  XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
+  XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
+  std::vector<std::pair<int64_t, int64_t>> ranges;
+  XLS_RETURN_IF_ERROR(SplitStages(f, 0, pipeline_stages - 1,
+                                  max_partition_node_count, delay_estimator,
+                                  bounds, &ranges));
+
+  // Every node's range now lies within a single group of stages.
+  std::vector<StageGroup> groups;
+  groups.reserve(ranges.size());
+  for (const auto& [first, last] : ranges) {
+    groups.push_back(StageGroup{.first = first, .last = last});
+  }
+  absl::flat_hash_map<Node*, int64_t> group_of;
+  for (Node* node : TopoSort(f)) {
+    auto it = std::partition_point(
+        groups.begin(), groups.end(),
+        [&](const StageGroup& group) { return group.last < bounds->lb(node); });
+    XLS_RET_CHECK(it != groups.end());
+    XLS_RET_CHECK_LE(bounds->ub(node), it->last) << node->GetName();
+    group_of[node] = it - groups.begin();
+    it->nodes.push_back(node);
+  }
+
+  // The groups are independent so schedule them concurrently.
+  std::vector<absl::StatusOr<ScheduleCycleMap>> group_cycle_maps(
+      groups.size(), absl::UnknownError("partition not scheduled"));
+  std::atomic<int64_t> next_group = 0;
+  auto schedule_groups = [&]() {
+    for (int64_t i = next_group++; i < groups.size(); i = next_group++) {
+      group_cycle_maps[i] = ScheduleStageGroup(groups, i, group_of, delay_map,
+                                               clock_period_ps, *bounds);
+    }
+  };
+  const int64_t thread_count =
+      std::min<int64_t>(AvailableCPUs(), groups.size());
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 1; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(schedule_groups));
+  }
+  schedule_groups();
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  ScheduleCycleMap cycle_map;
+  int64_t largest_group = 0;
+  for (int64_t i = 0; i < groups.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(ScheduleCycleMap group_cycle_map,
+                         std::move(group_cycle_maps[i]));
+    cycle_map.insert(group_cycle_map.begin(), group_cycle_map.end());
+    largest_group =
+        std::max(largest_group, static_cast<int64_t>(groups[i].nodes.size()));
+  }
+
+  // The registers at the group boundaries were chosen by the cuts rather than
+  // by the SDC solver; this is where the schedule may lose optimality.
+  int64_t boundary_register_bits = 0;
+  for (Node* node : f->nodes()) {
+    int64_t last_group = group_of.at(node);
+    for (Node* user : node->users()) {
+      last_group = std::max(last_group, group_of.at(user));
+    }
+    boundary_register_bits += node->GetType()->GetFlatBitCount() *
+                              (last_group - group_of.at(node));
+  }
+  LOG(INFO) << absl::StreamFormat(
+      "Partitioned SDC scheduling of %s: %d partitions of stages (largest has "
+      "%d nodes); %d pipeline register bits lie on partition boundaries "
+      "chosen by min-cut rather than by the SDC solver",
+      f->name(), groups.size(), largest_group, boundary_register_bits);
+  return cycle_map;
+}
+
+}  // namespace xls
@@ -0,0 +1,54 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_SCHEDULING_PARTITIONED_SDC_SCHEDULER_H_
+#define XLS_SCHEDULING_PARTITIONED_SDC_SCHEDULER_H_
+
+#include <cstdint>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/scheduling/schedule_bounds.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+
+// Schedules the given function into a pipeline with the given number of stages
+// and clock period by decomposing the SDC formulation, for functions too large
+// to solve as a single linear program.
+//
+// The stages are first split by recursive bisection with minimum cost cuts (as
+// in the min-cut scheduler) until each group of consecutive stages contains at
+// most 'max_partition_node_count' nodes which are not yet fixed to a single
+// stage. Every edge between two groups then runs forward, so each group is
+// scheduled independently, and concurrently, by an SDC program over only its
+// own nodes, within their bounds. The results are register-optimal within each
+// group but the values live across group boundaries are fixed by the cuts, so
+// the schedule may use more registers than a global SDC solve; the number of
+// register bits at the group boundaries is logged.
+//
+// 'bounds' must hold the ASAP and ALAP bounds for the given pipeline length.
+// Only scheduling constraints which have no effect on functions are accepted.
+absl::StatusOr<ScheduleCycleMap> PartitionedSDCScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    absl::Span<const SchedulingConstraint> constraints,
+    int64_t max_partition_node_count);
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_PARTITIONED_SDC_SCHEDULER_H_
@@ -0,0 +1,317 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/scheduling/pipeline_retiming_pass.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+#include "xls/scheduling/scheduling_pass.h"
+
+namespace xls {
+namespace {
+
+// The state of a schedule being retimed: the cycle of each node, the nodes of
+// each stage in topological order and the delay of each stage.
+class Retimer {
+ public:
+  static absl::StatusOr<Retimer> Create(
+      const PipelineSchedule& schedule, const DelayEstimator& delay_estimator,
+      absl::Span<const SchedulingConstraint> constraints) {
+    Retimer retimer(schedule);
+    std::vector<Node*> topo_order = TopoSort(schedule.function_base());
+    for (int64_t i = 0; i < topo_order.size(); ++i) {
+      Node* node = topo_order[i];
+      XLS_RET_CHECK(schedule.IsScheduled(node)) << node->GetName();
+      retimer.topo_index_[node] = i;
+      XLS_ASSIGN_OR_RETURN(retimer.delays_[node],
+                           delay_estimator.GetOperationDelayInPs(node));
+      if (OpIsSideEffecting(node->op())) {
+        retimer.pinned_.insert(node);
+      }
+    }
+    for (const SchedulingConstraint& constraint : constraints) {
+      if (const auto* in_cycle =
+              std::get_if<NodeInCycleConstraint>(&constraint)) {
+        retimer.pinned_.insert(in_cycle->GetNode());
+      } else if (const auto* difference =
+                     std::get_if<DifferenceConstraint>(&constraint)) {
+        retimer.pinned_.insert(difference->GetA());
+        retimer.pinned_.insert(difference->GetB());
+      }
+    }
+    for (int64_t stage = 0; stage < schedule.length(); ++stage) {
+      retimer.stage_delays_[stage] =
+          retimer.StageDelay(retimer.stages_[stage], /*path=*/nullptr);
+    }
+    return retimer;
+  }
+
+  const std::vector<int64_t>& stage_delays() const { return stage_delays_; }
+
+  // Moves the cone of a node on the critical path of a worst stage to a
+  // neighboring stage if that lowers the largest stage delay or the number of
+  // stages with that delay. Returns whether a move was made.
+  bool Step() {
+    int64_t max_delay =
+        *std::max_element(stage_delays_.begin(), stage_delays_.end());
+    std::pair<int64_t, int64_t> best_cost = {max_delay,
+                                             CountStagesWithDelay(max_delay)};
+    std::optional<Move> best_move;
+    for (int64_t stage = 0; stage < stage_delays_.size(); ++stage) {
+      if (stage_delays_[stage] != max_delay) {
+        continue;
+      }
+      std::vector<Node*> critical_path;
+      StageDelay(stages_[stage], &critical_path);
+      for (Node* node : critical_path) {
+        for (int64_t direction : {-1, 1}) {
+          std::optional<Move> move = MakeMove(node, stage, direction);
+          if (!move.has_value()) {
+            continue;
+          }
+          std::pair<int64_t, int64_t> cost = Cost(*move);
+          if (cost < best_cost ||
+              (cost == best_cost && best_move.has_value() &&
+               move->nodes.size() < best_move->nodes.size())) {
+            best_cost = cost;
+            best_move = std::move(move);
+          }
+        }
+      }
+    }
+    if (!best_move.has_value()) {
+      return false;
+    }
+    Apply(*best_move);
+    return true;
+  }
+
+  ScheduleCycleMap cycle_map() const { return cycle_map_; }
+
+ private:
+  // Nodes to move from stage `from` to stage `to` along with the resulting
+  // contents of the two stages.
+  struct Move {
+    std::vector<Node*> nodes;
+    int64_t from;
+    int64_t to;
+    std::vector<Node*> from_stage;
+    std::vector<Node*> to_stage;
+  };
+
+  explicit Retimer(const PipelineSchedule& schedule)
+      : cycle_map_(schedule.GetCycleMap()),
+        stage_delays_(schedule.length()) {
+    for (int64_t stage = 0; stage < schedule.length(); ++stage) {
+      absl::Span<Node* const> nodes = schedule.nodes_in_cycle(stage);
+      stages_.emplace_back(nodes.begin(), nodes.end());
+    }
+  }
+
+  // Returns the delay of the longest path through `nodes` (which must be in
+  // topological order), optionally storing the path in `path`.
+  int64_t StageDelay(absl::Span<Node* const> nodes,
+                     std::vector<Node*>* path) const {
+    absl::flat_hash_map<Node*, int64_t> arrival;
+    absl::flat_hash_map<Node*, Node*> predecessor;
+    Node* last = nullptr;
+    for (Node* node : nodes) {
+      int64_t start = 0;
+      Node* pred = nullptr;
+      for (Node* operand : node->operands()) {
+        auto it = arrival.find(operand);
+        if (it != arrival.end() && it->second > start) {
+          start = it->second;
+          pred = operand;
+        }
+      }
+      arrival[node] = start + delays_.at(node);
+      predecessor[node] = pred;
+      if (last == nullptr || arrival[node] > arrival[last]) {
+        last = node;
+      }
+    }
+    if (last == nullptr) {
+      return 0;
+    }
+    if (path != nullptr) {
+      path->clear();
+      for (Node* node = last; node != nullptr; node = predecessor.at(node)) {
+        path->push_back(node);
+      }
+      std::reverse(path->begin(), path->end());
+    }
+    return arrival.at(last);
+  }
+
+  int64_t CountStagesWithDelay(int64_t delay) const {
+    return std::count(stage_delays_.begin(), stage_delays_.end(), delay);
+  }
+
+  // Returns the move of `node` from `stage` to `stage + direction` along with
+  // its same-stage fan-in cone (when moving back) or fan-out cone (when moving
+  // forward), or nullopt if the move is not possible.
+  std::optional<Move> MakeMove(Node* node, int64_t stage,
+                               int64_t direction) const {
+    int64_t to = stage + direction;
+    if (to < 0 || to >= stages_.size()) {
+      return std::nullopt;
+    }
+    absl::flat_hash_set<Node*> cone = {node};
+    std::vector<Node*> worklist = {node};
+    while (!worklist.empty()) {
+      Node* n = worklist.back();
+      worklist.pop_back();
+      if (pinned_.contains(n)) {
+        return std::nullopt;
+      }
+      auto visit = [&](Node* neighbor) {
+        if (cycle_map_.at(neighbor) == stage && cone.insert(neighbor).second) {
+          worklist.push_back(neighbor);
+        }
+      };
+      if (direction < 0) {
+        for (Node* operand : n->operands()) {
+          visit(operand);
+        }
+      } else {
+        for (Node* user : n->users()) {
+          visit(user);
+        }
+      }
+    }
+    Move move{.from = stage, .to = to};
+    for (Node* n : stages_[stage]) {
+      (cone.contains(n) ? move.nodes : move.from_stage).push_back(n);
+    }
+    std::merge(stages_[to].begin(), stages_[to].end(), move.nodes.begin(),
+               move.nodes.end(), std::back_inserter(move.to_stage),
+               [&](Node* a, Node* b) {
+                 return topo_index_.at(a) < topo_index_.at(b);
+               });
+    return move;
+  }
+
+  // Returns the largest stage delay after `move` and the number of stages
+  // with that delay.
+  std::pair<int64_t, int64_t> Cost(const Move& move) const {
+    std::vector<int64_t> delays = stage_delays_;
+    delays[move.from] = StageDelay(move.from_stage, /*path=*/nullptr);
+    delays[move.to] = StageDelay(move.to_stage, /*path=*/nullptr);
+    int64_t max_delay = *std::max_element(delays.begin(), delays.end());
+    return {max_delay, std::count(delays.begin(), delays.end(), max_delay)};
+  }
+
+  void Apply(Move& move) {
+    for (Node* node : move.nodes) {
+      cycle_map_[node] = move.to;
+    }
+    stages_[move.from] = std::move(move.from_stage);
+    stages_[move.to] = std::move(move.to_stage);
+    stage_delays_[move.from] = StageDelay(stages_[move.from], nullptr);
+    stage_delays_[move.to] = StageDelay(stages_[move.to], nullptr);
+  }
+
+  ScheduleCycleMap cycle_map_;
+  std::vector<std::vector<Node*>> stages_;
+  std::vector<int64_t> stage_delays_;
+  absl::flat_hash_map<Node*, int64_t> topo_index_;
+  absl::flat_hash_map<Node*, int64_t> delays_;
+  absl::flat_hash_set<Node*> pinned_;
+};
+
+}  // namespace
+
+absl::StatusOr<std::vector<int64_t>> ComputeStageDelays(
+    const PipelineSchedule& schedule, const DelayEstimator& delay_estimator) {
+  XLS_ASSIGN_OR_RETURN(
+      Retimer retimer,
+      Retimer::Create(schedule, delay_estimator, /*constraints=*/{}));
+  return retimer.stage_delays();
+}
+
+absl::StatusOr<PipelineSchedule> RetimePipelineSchedule(
+    const PipelineSchedule& schedule, const DelayEstimator& delay_estimator,
+    absl::Span<const SchedulingConstraint> constraints) {
+  XLS_ASSIGN_OR_RETURN(Retimer retimer, Retimer::Create(schedule,
+                                                        delay_estimator,
+                                                        constraints));
+  // Each step strictly lowers (largest delay, stages with that delay), so this
+  // terminates.
+  while (retimer.Step()) {
+  }
+  PipelineSchedule retimed(schedule.function_base(), retimer.cycle_map(),
+                           schedule.length());
+  XLS_RETURN_IF_ERROR(retimed.Verify());
+  return retimed;
+}
+
+absl::StatusOr<bool> PipelineRetimingPass::RunInternal(
+    SchedulingUnit* unit, const SchedulingPassOptions& options,
+    SchedulingPassResults* results) const {
+  if (!options.scheduling_options.retime_pipeline()) {
+    return false;
+  }
+  XLS_RET_CHECK_NE(options.delay_estimator, nullptr);
+  bool changed = false;
+  for (auto& [f, schedule] : unit->schedules()) {
+    if (schedule.length() < 2) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        PipelineSchedule retimed,
+        RetimePipelineSchedule(schedule, *options.delay_estimator,
+                               options.scheduling_options.constraints()));
+    if (retimed.GetCycleMap() == schedule.GetCycleMap()) {
+      continue;
+    }
+    if (VLOG_IS_ON(2)) {
+      XLS_ASSIGN_OR_RETURN(
+          std::vector<int64_t> before,
+          ComputeStageDelays(schedule, *options.delay_estimator));
+      XLS_ASSIGN_OR_RETURN(
+          std::vector<int64_t> after,
+          ComputeStageDelays(retimed, *options.delay_estimator));
+      VLOG(2) << "Retimed " << f->name() << ": largest stage delay "
+              << *std::max_element(before.begin(), before.end()) << "ps -> "
+              << *std::max_element(after.begin(), after.end()) << "ps";
+    }
+    schedule = std::move(retimed);
+    changed = true;
+  }
+  return changed;
+}
+
+}  // namespace xls
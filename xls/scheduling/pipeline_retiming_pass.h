@@ -0,0 +1,67 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_SCHEDULING_PIPELINE_RETIMING_PASS_H_
+#define XLS_SCHEDULING_PIPELINE_RETIMING_PASS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+#include "xls/scheduling/scheduling_pass.h"
+
+namespace xls {
+
+// Returns the delay of the longest path of nodes within each stage of
+// `schedule`.
+absl::StatusOr<std::vector<int64_t>> ComputeStageDelays(
+    const PipelineSchedule& schedule, const DelayEstimator& delay_estimator);
+
+// Returns `schedule` with its stages rebalanced to minimize the largest stage
+// delay, keeping the length of the pipeline.
+//
+// Pipeline registers sit exactly on stage boundaries, so moving nodes across a
+// boundary retimes the registers around them. Repeatedly moves the same-stage
+// fan-in cone of a node on the critical path of a worst stage back by one
+// stage, or its same-stage fan-out cone forward by one stage, as long as doing
+// so lowers the largest stage delay (or the number of stages with that delay).
+// Side-effecting nodes (including parameters and proc IO) and nodes named in
+// node-in-cycle or difference `constraints` are never moved.
+absl::StatusOr<PipelineSchedule> RetimePipelineSchedule(
+    const PipelineSchedule& schedule, const DelayEstimator& delay_estimator,
+    absl::Span<const SchedulingConstraint> constraints);
+
+// Pass which retimes the pipeline schedule of each function and proc in the
+// unit with RetimePipelineSchedule(), correcting stages left unbalanced by the
+// scheduler (e.g. because of slack in its delay model) without rescheduling.
+// Does nothing unless `SchedulingOptions::retime_pipeline()` is set.
+class PipelineRetimingPass : public SchedulingPass {
+ public:
+  PipelineRetimingPass() : SchedulingPass("retime", "Pipeline Retiming") {}
+  ~PipelineRetimingPass() override = default;
+
+ protected:
+  absl::StatusOr<bool> RunInternal(
+      SchedulingUnit* unit, const SchedulingPassOptions& options,
+      SchedulingPassResults* results) const override;
+};
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_PIPELINE_RETIMING_PASS_H_
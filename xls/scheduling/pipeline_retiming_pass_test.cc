@@ -0,0 +1,116 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/scheduling/pipeline_retiming_pass.h"
+
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+#include "xls/scheduling/scheduling_pass.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::xls::status_testing::IsOkAndHolds;
+
+class PipelineRetimingPassTest : public IrTestBase {
+ protected:
+  // Builds a chain of four adds after two parameters, scheduled with only the
+  // first add in the first stage.
+  void BuildUnbalancedChain(Package* p) {
+    FunctionBuilder fb(TestName(), p);
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue y = fb.Param("y", p->GetBitsType(32));
+    BValue a = fb.Add(x, y);
+    BValue b = fb.Add(a, y);
+    BValue c = fb.Add(b, y);
+    BValue d = fb.Add(c, y);
+    XLS_ASSERT_OK_AND_ASSIGN(f_, fb.BuildWithReturnValue(d));
+    a_ = a.node();
+    b_ = b.node();
+    ScheduleCycleMap cycle_map = {{x.node(), 0}, {y.node(), 0}, {a_, 0},
+                                  {b_, 1},       {c.node(), 1}, {d.node(), 1}};
+    schedule_.emplace(f_, cycle_map, /*length=*/2);
+  }
+
+  Function* f_ = nullptr;
+  Node* a_ = nullptr;
+  Node* b_ = nullptr;
+  std::optional<PipelineSchedule> schedule_;
+};
+
+TEST_F(PipelineRetimingPassTest, BalancesStages) {
+  auto p = CreatePackage();
+  BuildUnbalancedChain(p.get());
+  EXPECT_THAT(ComputeStageDelays(*schedule_, TestDelayEstimator()),
+              IsOkAndHolds(ElementsAre(1, 3)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule retimed,
+      RetimePipelineSchedule(*schedule_, TestDelayEstimator(),
+                             /*constraints=*/{}));
+  EXPECT_EQ(retimed.length(), 2);
+  EXPECT_EQ(retimed.cycle(b_), 0);
+  EXPECT_THAT(ComputeStageDelays(retimed, TestDelayEstimator()),
+              IsOkAndHolds(ElementsAre(2, 2)));
+}
+
+TEST_F(PipelineRetimingPassTest, ConstrainedNodesAreNotMoved) {
+  auto p = CreatePackage();
+  BuildUnbalancedChain(p.get());
+  std::vector<SchedulingConstraint> constraints = {
+      NodeInCycleConstraint(b_, 1)};
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule retimed,
+      RetimePipelineSchedule(*schedule_, TestDelayEstimator(), constraints));
+  EXPECT_EQ(retimed.cycle(b_), 1);
+  EXPECT_THAT(ComputeStageDelays(retimed, TestDelayEstimator()),
+              IsOkAndHolds(ElementsAre(1, 3)));
+}
+
+TEST_F(PipelineRetimingPassTest, PassRunsOnlyWhenEnabled) {
+  auto p = CreatePackage();
+  BuildUnbalancedChain(p.get());
+  TestDelayEstimator delay_estimator;
+  SchedulingPassResults results;
+
+  SchedulingUnit unit = SchedulingUnit::CreateForSingleFunction(f_);
+  unit.schedules().emplace(f_, *schedule_);
+  SchedulingPassOptions options{.delay_estimator = &delay_estimator};
+  EXPECT_THAT(PipelineRetimingPass().Run(&unit, options, &results),
+              IsOkAndHolds(false));
+  EXPECT_EQ(unit.schedules().at(f_).cycle(b_), 1);
+
+  options.scheduling_options.retime_pipeline(true);
+  EXPECT_THAT(PipelineRetimingPass().Run(&unit, options, &results),
+              IsOkAndHolds(true));
+  EXPECT_EQ(unit.schedules().at(f_).cycle(b_), 0);
+  EXPECT_THAT(PipelineRetimingPass().Run(&unit, options, &results),
+              IsOkAndHolds(false));
+}
+
+}  // namespace
+}  // namespace xls
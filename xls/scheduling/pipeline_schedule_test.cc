@@ -442,6 +442,36 @@ TEST_F(PipelineScheduleTest, JustPipelineLengthGiven) {
   EXPECT_THAT(scheduled_ops(5), UnorderedElementsAre(Op::kNeg));
 }
 
+TEST_F(PipelineScheduleTest, ParallelClockPeriodSearch) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue value = x;
+  for (int64_t i = 0; i < 20; ++i) {
+    value = fb.Add(value, x);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule serial,
+      RunPipelineSchedule(func, TestDelayEstimator(),
+                          SchedulingOptions().pipeline_stages(3)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule parallel,
+      RunPipelineSchedule(
+          func, TestDelayEstimator(),
+          SchedulingOptions().pipeline_stages(3).clock_period_search_threads(
+              4)));
+
+  // A chain of 20 unit-delay adds over 3 stages needs a 7ps clock.
+  EXPECT_EQ(parallel.length(), 3);
+  XLS_EXPECT_OK(parallel.VerifyTiming(7, TestDelayEstimator()));
+  EXPECT_FALSE(parallel.VerifyTiming(6, TestDelayEstimator()).ok());
+  for (Node* node : func->nodes()) {
+    EXPECT_EQ(parallel.cycle(node), serial.cycle(node)) << node->GetName();
+  }
+}
+
 TEST_F(PipelineScheduleTest, LongPipelineLength) {
   // Generate an absurdly long pipeline schedule. Most stages are empty, but it
   // should not crash.
@@ -1181,6 +1211,132 @@ TEST_F(PipelineScheduleTest, MinimizedThroughputWorksWithGivenClockPeriod) {
   EXPECT_EQ(proc->GetInitiationInterval().value_or(1), 3);
 }
 
+TEST_F(PipelineScheduleTest, PartitionedSdcScheduleOfChain) {
+  Package package = Package(TestName());
+  FunctionBuilder fb(TestName(), &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  BValue y = fb.Param("y", package.GetBitsType(32));
+  BValue chain = x;
+  for (int64_t i = 0; i < 24; ++i) {
+    chain = fb.Negate(chain);
+  }
+  fb.Add(chain, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(const DelayEstimator* delay_estimator,
+                           GetDelayEstimator("unit"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule sdc_schedule,
+      RunPipelineSchedule(func, *delay_estimator,
+                          SchedulingOptions().clock_period_ps(2)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule partitioned_schedule,
+      RunPipelineSchedule(
+          func, *delay_estimator,
+          SchedulingOptions().clock_period_ps(2).sdc_partition_node_count(4)));
+
+  // Every stage boundary carries the chain and `y` whichever way the stages
+  // are grouped.
+  EXPECT_EQ(partitioned_schedule.length(), sdc_schedule.length());
+  EXPECT_EQ(partitioned_schedule.CountFinalInteriorPipelineRegisters(),
+            sdc_schedule.CountFinalInteriorPipelineRegisters());
+}
+
+TEST_F(PipelineScheduleTest, PartitionedSdcScheduleWithPipelineLength) {
+  Package package = Package(TestName());
+  FunctionBuilder fb(TestName(), &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  BValue y = fb.Param("y", package.GetBitsType(32));
+  BValue lhs = fb.UMul(fb.Add(x, y), fb.Subtract(x, y));
+  BValue rhs = fb.UMul(fb.Negate(x), fb.Not(y));
+  fb.Concat({fb.Add(lhs, rhs), fb.Subtract(lhs, rhs)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(const DelayEstimator* delay_estimator,
+                           GetDelayEstimator("unit"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(func, *delay_estimator,
+                          SchedulingOptions()
+                              .clock_period_ps(1)
+                              .pipeline_stages(6)
+                              .sdc_partition_node_count(2)));
+  EXPECT_EQ(schedule.length(), 6);
+  EXPECT_EQ(schedule.cycle(x.node()), 0);
+  EXPECT_EQ(schedule.cycle(func->return_value()), 5);
+}
+
+TEST_F(PipelineScheduleTest, ModuloScheduleUsesSpareInitiationInterval) {
+  Package package = Package(TestName());
+
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch_in,
+      package.CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch_out,
+      package.CreateStreamingChannel("out", ChannelOps::kSendOnly, u32));
+
+  ProcBuilder pb(TestName(), &package);
+  BValue tkn = pb.Literal(Value::Token());
+  BValue state = pb.StateElement("state", Value(Bits(32)));
+  BValue rcv = pb.Receive(ch_in, tkn);
+  BValue x = pb.TupleIndex(rcv, 1);
+  BValue sum = pb.Add(pb.Add(x, state), pb.Add(pb.Negate(x), state));
+  BValue product = pb.UMul(pb.Add(sum, x), pb.Subtract(sum, state));
+  BValue send = pb.Send(ch_out, pb.TupleIndex(rcv, 0), product);
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({pb.Add(state, x)}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(const DelayEstimator* delay_estimator,
+                           GetDelayEstimator("unit"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule sdc_schedule,
+      RunPipelineSchedule(proc, *delay_estimator,
+                          SchedulingOptions(SchedulingStrategy::SDC)
+                              .clock_period_ps(2)
+                              .worst_case_throughput(3)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule modulo_schedule,
+      RunPipelineSchedule(proc, *delay_estimator,
+                          SchedulingOptions(SchedulingStrategy::MODULO)
+                              .clock_period_ps(2)
+                              .worst_case_throughput(3)));
+
+  // At most II - 1 = 2 stages may be added, and only if they save registers.
+  EXPECT_GE(modulo_schedule.length(), sdc_schedule.length());
+  EXPECT_LE(modulo_schedule.length(), sdc_schedule.length() + 2);
+  EXPECT_LE(modulo_schedule.CountFinalInteriorPipelineRegisters(),
+            sdc_schedule.CountFinalInteriorPipelineRegisters());
+  EXPECT_LT(modulo_schedule.cycle(rcv.node()),
+            modulo_schedule.cycle(send.node()));
+  EXPECT_EQ(proc->GetInitiationInterval().value_or(1), 3);
+}
+
+TEST_F(PipelineScheduleTest, ModuloScheduleOfFunctionMatchesSdc) {
+  Package package = Package(TestName());
+  FunctionBuilder fb(TestName(), &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  BValue y = fb.Param("y", package.GetBitsType(32));
+  fb.UMul(fb.Add(x, y), fb.Subtract(x, y));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(const DelayEstimator* delay_estimator,
+                           GetDelayEstimator("unit"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule sdc_schedule,
+      RunPipelineSchedule(
+          func, *delay_estimator,
+          SchedulingOptions(SchedulingStrategy::SDC).clock_period_ps(1)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule modulo_schedule,
+      RunPipelineSchedule(
+          func, *delay_estimator,
+          SchedulingOptions(SchedulingStrategy::MODULO).clock_period_ps(1)));
+  EXPECT_EQ(modulo_schedule.length(), sdc_schedule.length());
+  EXPECT_EQ(modulo_schedule.CountFinalInteriorPipelineRegisters(),
+            sdc_schedule.CountFinalInteriorPipelineRegisters());
+}
+
 TEST_F(PipelineScheduleTest,
        SuggestReducedThroughputWhenFullThroughputFailsWithClockGiven) {
   Package package = Package(TestName());
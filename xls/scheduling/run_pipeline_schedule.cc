@@ -50,6 +50,7 @@
 #include "xls/ir/op.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/scheduling/min_cut_scheduler.h"
+#include "xls/scheduling/partitioned_sdc_scheduler.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/schedule_bounds.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -180,10 +181,16 @@ absl::StatusOr<int64_t> ComputeCriticalPath(
 // schedule the function into a pipeline with the given number of stages. If
 // `target_clock_period_ps` is specified, will not try to check lower clock
 // periods than this.
+//
+// With `search_threads` > 1, that many candidate periods are checked
+// concurrently in every round of the search. `scheduler` serves the first
+// thread; each other thread lazily builds its own SDCScheduler with
+// `constraints`, since the schedulers are stateful.
 absl::StatusOr<int64_t> FindMinimumClockPeriod(
     FunctionBase* f, std::optional<int64_t> pipeline_stages,
     const DelayEstimator& delay_estimator, SDCScheduler& scheduler,
-    SchedulingFailureBehavior failure_behavior,
+    absl::Span<const SchedulingConstraint> constraints,
+    SchedulingFailureBehavior failure_behavior, int64_t search_threads,
     std::optional<int64_t> target_clock_period_ps = std::nullopt) {
   VLOG(4) << "FindMinimumClockPeriod()";
   VLOG(4) << "  pipeline stages = "
@@ -229,16 +236,32 @@ absl::StatusOr<int64_t> FindMinimumClockPeriod(
   // Don't waste time explaining infeasibility for the failing points in the
   // search.
   failure_behavior.explain_infeasibility = false;
-  int64_t min_clk_period_ps = BinarySearchMinTrue(
-      optimistic_clk_period_ps, pessimistic_clk_period_ps,
-      [&](int64_t clk_period_ps) {
-        return scheduler
-            .Schedule(pipeline_stages, clk_period_ps,
-                      failure_behavior,
-                      /*check_feasibility=*/true)
-            .ok();
-      },
-      BinarySearchAssumptions::kEndKnownTrue);
+  std::vector<std::unique_ptr<SDCScheduler>> worker_schedulers(
+      std::max(int64_t{0}, search_threads - 1));
+  XLS_ASSIGN_OR_RETURN(
+      int64_t min_clk_period_ps,
+      ParallelBinarySearchMinTrueWithStatus(
+          optimistic_clk_period_ps, pessimistic_clk_period_ps,
+          std::max(int64_t{1}, search_threads),
+          [&](int64_t worker,
+              int64_t clk_period_ps) -> absl::StatusOr<bool> {
+            SDCScheduler* worker_scheduler = &scheduler;
+            if (worker > 0) {
+              std::unique_ptr<SDCScheduler>& owned =
+                  worker_schedulers[worker - 1];
+              if (owned == nullptr) {
+                XLS_ASSIGN_OR_RETURN(owned,
+                                     SDCScheduler::Create(f, delay_estimator));
+                XLS_RETURN_IF_ERROR(owned->AddConstraints(constraints));
+              }
+              worker_scheduler = owned.get();
+            }
+            return worker_scheduler
+                ->Schedule(pipeline_stages, clk_period_ps, failure_behavior,
+                           /*check_feasibility=*/true)
+                .ok();
+          },
+          BinarySearchAssumptions::kEndKnownTrue));
   VLOG(4) << "minimum clock period = " << min_clk_period_ps;
 
   return min_clk_period_ps;
@@ -316,6 +339,65 @@ absl::StatusOr<int64_t> FindMinimumWorstCaseThroughput(
   return min_worst_case_throughput;
 }
 
+// Given a minimum-length SDC schedule of a proc with initiation interval
+// II > 1, reschedules it at each pipeline length up to II - 1 stages longer and
+// returns whichever schedule has the fewest pipeline register bits. A new
+// iteration only starts every II cycles anyway, so the extra stages cost
+// latency but not throughput, and the additional slack can let the scheduler
+// place wide values after they have been reduced.
+absl::StatusOr<ScheduleCycleMap> MinimizeRegistersWithinInitiationInterval(
+    FunctionBase* f, ScheduleCycleMap cycle_map, int64_t clock_period_ps,
+    SDCScheduler& scheduler, const SchedulingOptions& options,
+    std::optional<int64_t> worst_case_throughput) {
+  const int64_t initiation_interval = worst_case_throughput.value_or(
+      f->GetInitiationInterval().value_or(1));
+  if (!f->IsProc() || options.pipeline_stages().has_value() ||
+      initiation_interval <= 1) {
+    return cycle_map;
+  }
+
+  int64_t min_length = 1;
+  for (const auto& [node, cycle] : cycle_map) {
+    min_length = std::max(min_length, cycle + 1);
+  }
+  const int64_t min_length_bits =
+      PipelineSchedule(f, cycle_map, min_length)
+          .CountFinalInteriorPipelineRegisters();
+
+  int64_t best_length = min_length;
+  int64_t best_bits = min_length_bits;
+  SchedulingFailureBehavior failure_behavior = options.failure_behavior();
+  failure_behavior.explain_infeasibility = false;
+  for (int64_t length = min_length + 1;
+       length < min_length + initiation_interval; ++length) {
+    absl::StatusOr<ScheduleCycleMap> candidate =
+        scheduler.Schedule(length, clock_period_ps, failure_behavior,
+                           /*check_feasibility=*/false, worst_case_throughput);
+    if (!candidate.ok()) {
+      VLOG(3) << "Unable to schedule " << f->name() << " in " << length
+              << " stages: " << candidate.status();
+      continue;
+    }
+    int64_t bits = PipelineSchedule(f, *candidate, length)
+                       .CountFinalInteriorPipelineRegisters();
+    VLOG(3) << "Schedule of " << f->name() << " in " << length << " stages has "
+            << bits << " pipeline register bits";
+    if (bits < best_bits) {
+      best_length = length;
+      best_bits = bits;
+      cycle_map = *std::move(candidate);
+    }
+  }
+
+  LOG(INFO) << "Modulo scheduling of proc '" << f->name()
+            << "' at initiation interval " << initiation_interval << ": "
+            << best_length << " stages, " << best_bits
+            << " pipeline register bits (saved "
+            << min_length_bits - best_bits << " bits relative to "
+            << min_length << " stages)";
+  return cycle_map;
+}
+
 }  // namespace
 
 absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
@@ -346,11 +428,25 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
     f->SetInitiationInterval(*options.worst_case_throughput());
   }
 
+  // Very large functions are scheduled by SDC in independent groups of stages
+  // rather than as a whole; this only supports constraints which have no
+  // effect on functions.
+  const bool partition_sdc =
+      options.strategy() == SchedulingStrategy::SDC && !options.use_fdo() &&
+      f->IsFunction() && options.sdc_partition_node_count().has_value() &&
+      f->node_count() > *options.sdc_partition_node_count() &&
+      absl::c_all_of(
+          options.constraints(), [](const SchedulingConstraint& constraint) {
+            return std::holds_alternative<BackedgeConstraint>(constraint) ||
+                   std::holds_alternative<SendThenRecvConstraint>(constraint);
+          });
+
   std::unique_ptr<SDCScheduler> sdc_scheduler;
   if (!options.clock_period_ps().has_value() ||
       (options.minimize_worst_case_throughput().value_or(false) &&
        f->IsProc() && f->GetInitiationInterval().value_or(1) <= 0) ||
-      options.strategy() == SchedulingStrategy::SDC) {
+      (options.strategy() == SchedulingStrategy::SDC && !partition_sdc) ||
+      options.strategy() == SchedulingStrategy::MODULO) {
     // We currently use the SDC scheduler to determine the minimum clock period
     // (if not specified) and worst-case throughput (if minimization is
     // requested), even if we're not using it for the final schedule.
@@ -384,7 +480,9 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
     XLS_ASSIGN_OR_RETURN(
         clock_period_ps,
         FindMinimumClockPeriod(f, options.pipeline_stages(), input_delay_added,
-                               *sdc_scheduler, options.failure_behavior()));
+                               *sdc_scheduler, options.constraints(),
+                               options.failure_behavior(),
+                               options.clock_period_search_threads()));
 
     if (options.period_relaxation_percent().has_value()) {
       int64_t relaxation_percent = options.period_relaxation_percent().value();
@@ -409,9 +507,15 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
   }
 
   ScheduleCycleMap cycle_map;
-  if (options.strategy() == SchedulingStrategy::SDC) {
+  if ((options.strategy() == SchedulingStrategy::SDC && !partition_sdc) ||
+      options.strategy() == SchedulingStrategy::MODULO) {
     // Enable iterative SDC scheduling when use_fdo is true
     if (options.use_fdo()) {
+      if (options.strategy() == SchedulingStrategy::MODULO) {
+        return absl::UnimplementedError(
+            "Iterative SDC scheduling is not supported with the modulo "
+            "scheduling strategy.");
+      }
       if (!options.clock_period_ps().has_value()) {
         return absl::UnimplementedError(
             "Iterative SDC scheduling is only supported when a clock period is "
@@ -428,8 +532,13 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
       isdc_options.stochastic_ratio = options.fdo_refinement_stochastic_ratio();
       isdc_options.path_evaluate_strategy =
           options.fdo_path_evaluate_strategy();
+      isdc_options.max_concurrent_synthesis_jobs =
+          options.fdo_max_concurrent_synthesis_jobs();
 
-      DelayManager delay_manager(f, delay_estimator);
+      // Only pairs of nodes whose delay is within a clock period of each
+      // other are stored; longer paths are constrained through their prefixes.
+      DelayManager delay_manager(f, delay_estimator,
+                                 /*delay_horizon_ps=*/clock_period_ps);
       XLS_ASSIGN_OR_RETURN(
           cycle_map,
           ScheduleByIterativeSDC(f, options.pipeline_stages(), clock_period_ps,
@@ -473,7 +582,8 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
           int64_t target_clock_period_ps = clock_period_ps + 1;
           absl::StatusOr<int64_t> min_clock_period_ps = FindMinimumClockPeriod(
               f, options.pipeline_stages(), input_delay_added, *sdc_scheduler,
-              options.failure_behavior(), target_clock_period_ps);
+              options.constraints(), options.failure_behavior(),
+              options.clock_period_search_threads(), target_clock_period_ps);
           if (min_clock_period_ps.ok()) {
             if (options.recover_after_minimizing_clock().value_or(false)) {
               LOG(WARNING) << "Continuing with clock period = "
@@ -541,6 +651,12 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
       return schedule_cycle_map.status();
     }
     cycle_map = *std::move(schedule_cycle_map);
+    if (options.strategy() == SchedulingStrategy::MODULO) {
+      XLS_ASSIGN_OR_RETURN(
+          cycle_map, MinimizeRegistersWithinInitiationInterval(
+                         f, std::move(cycle_map), clock_period_ps,
+                         *sdc_scheduler, options, worst_case_throughput));
+    }
   } else {
     // Run an initial ASAP/ALAP scheduling pass, which we'll refine with the
     // chosen scheduler.
@@ -548,7 +664,15 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
                                  input_delay_added);
     XLS_RETURN_IF_ERROR(TightenBounds(bounds, f, options.pipeline_stages()));
 
-    if (options.strategy() == SchedulingStrategy::MIN_CUT) {
+    if (partition_sdc) {
+      XLS_ASSIGN_OR_RETURN(
+          cycle_map,
+          PartitionedSDCScheduler(
+              f,
+              options.pipeline_stages().value_or(bounds.max_lower_bound() + 1),
+              clock_period_ps, input_delay_added, &bounds,
+              options.constraints(), *options.sdc_partition_node_count()));
+    } else if (options.strategy() == SchedulingStrategy::MIN_CUT) {
       XLS_ASSIGN_OR_RETURN(cycle_map,
                            MinCutScheduler(f,
                                            options.pipeline_stages().value_or(
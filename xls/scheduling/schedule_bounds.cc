@@ -16,7 +16,10 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <limits>
+#include <memory>
+#include <queue>
 #include <string>
 #include <utility>
 #include <vector>
@@ -35,74 +38,94 @@ namespace sched {
 
 ScheduleBounds::ScheduleBounds(FunctionBase* f, int64_t clock_period_ps,
                                const DelayEstimator& delay_estimator)
-    : clock_period_ps_(clock_period_ps), delay_estimator_(&delay_estimator) {
-  auto topo_sort_it = TopoSort(f);
-  topo_sort_ = std::vector<Node*>(topo_sort_it.begin(), topo_sort_it.end());
-  Reset();
-}
+    : ScheduleBounds(f, TopoSort(f), clock_period_ps, delay_estimator) {}
 
 ScheduleBounds::ScheduleBounds(FunctionBase* f, std::vector<Node*> topo_sort,
                                int64_t clock_period_ps,
                                const DelayEstimator& delay_estimator)
-    : topo_sort_(std::move(topo_sort)),
+    : graph_(MakeGraph(std::move(topo_sort))),
       clock_period_ps_(clock_period_ps),
       delay_estimator_(&delay_estimator) {
   Reset();
 }
 
+/* static */ std::shared_ptr<ScheduleBounds::Graph> ScheduleBounds::MakeGraph(
+    std::vector<Node*> topo_sort) {
+  auto graph = std::make_shared<Graph>();
+  graph->topo_sort = std::move(topo_sort);
+  const int64_t node_count = graph->topo_sort.size();
+  graph->topo_index.reserve(node_count);
+  for (int64_t i = 0; i < node_count; ++i) {
+    graph->topo_index[graph->topo_sort[i]] = i;
+  }
+  graph->operands.resize(node_count);
+  graph->users.resize(node_count);
+  for (int64_t i = 0; i < node_count; ++i) {
+    Node* node = graph->topo_sort[i];
+    for (Node* operand : node->operands()) {
+      graph->operands[i].push_back(graph->topo_index.at(operand));
+    }
+    for (Node* user : node->users()) {
+      graph->users[i].push_back(graph->topo_index.at(user));
+    }
+  }
+  return graph;
+}
+
 void ScheduleBounds::Reset() {
+  const int64_t node_count = graph_->topo_sort.size();
+  bounds_.assign(node_count, {0, std::numeric_limits<int64_t>::max()});
   max_lower_bound_ = 0;
-  min_upper_bound_ = 0;
-  for (Node* node : topo_sort_) {
-    bounds_[node] = {0, std::numeric_limits<int64_t>::max()};
-    max_lower_bound_ = 0;
-    min_upper_bound_ = std::numeric_limits<int64_t>::max();
-  }
+  min_upper_bound_ = node_count == 0 ? 0 : std::numeric_limits<int64_t>::max();
+  lb_in_cycle_delay_.assign(node_count, 0);
+  ub_in_cycle_delay_.assign(node_count, 0);
+  lower_bounds_propagated_ = false;
+  upper_bounds_propagated_ = false;
+  lb_pending_.clear();
+  ub_pending_.clear();
 }
 
 std::string ScheduleBounds::ToString() const {
   std::string out = "Bounds:\n";
-  if (!bounds_.empty()) {
-    for (Node* node : TopoSort(bounds_.begin()->first->function_base())) {
-      if (bounds_.contains(node)) {
-        absl::StrAppendFormat(&out, "  %s : [%d, %d]\n", node->GetName(),
-                              lb(node), ub(node));
-      }
-    }
+  for (int64_t i = 0; i < graph_->topo_sort.size(); ++i) {
+    absl::StrAppendFormat(&out, "  %s : [%d, %d]\n",
+                          graph_->topo_sort[i]->GetName(), bounds_[i].first,
+                          bounds_[i].second);
   }
   return out;
 }
 
-absl::Status ScheduleBounds::PropagateLowerBounds() {
-  VLOG(4) << "PropagateLowerBounds()";
-  // The delay in picoseconds from the beginning of a cycle to the start of the
-  // node.
-  absl::flat_hash_map<Node*, int64_t> in_cycle_delay;
-
-  // Compute the lower bound of each node based on the lower bounds of the
-  // operands of the node.
-  for (Node* node : topo_sort_) {
-    int64_t& node_in_cycle_delay = in_cycle_delay[node];
-    VLOG(4) << absl::StreamFormat("  %s : original lb=%d", node->GetName(),
-                                  lb(node));
-    for (Node* operand : node->operands()) {
-      int64_t operand_lb = lb(operand);
-      if (operand_lb < lb(node)) {
-        continue;
-      }
-      XLS_ASSIGN_OR_RETURN(int64_t operand_delay,
-                           delay_estimator_->GetOperationDelayInPs(operand));
-      if (operand_lb > lb(node)) {
-        VLOG(4) << absl::StreamFormat(
-            "    tightened lb to %d because of operand %s", operand_lb,
-            operand->GetName());
-        XLS_RETURN_IF_ERROR(TightenNodeLb(node, operand_lb));
-        node_in_cycle_delay = in_cycle_delay.at(operand) + operand_delay;
-        continue;
-      }
-      node_in_cycle_delay = std::max(
-          node_in_cycle_delay, in_cycle_delay.at(operand) + operand_delay);
-    }
+absl::Status ScheduleBounds::TightenLb(int64_t index, int64_t value) {
+  std::pair<int64_t, int64_t>& bounds = bounds_[index];
+  if (value > bounds.second) {
+    return absl::ResourceExhaustedError(
+        absl::StrFormat("Unable to tighten the lower bound of node %s to %d.",
+                        graph_->topo_sort[index]->GetName(), value));
+  }
+  bounds.first = std::max(bounds.first, value);
+  max_lower_bound_ = std::max(max_lower_bound_, value);
+  return absl::OkStatus();
+}
+
+absl::Status ScheduleBounds::TightenUb(int64_t index, int64_t value) {
+  std::pair<int64_t, int64_t>& bounds = bounds_[index];
+  if (value < bounds.first) {
+    return absl::ResourceExhaustedError(
+        absl::StrFormat("Unable to tighten the upper bound of node %s to %d.",
+                        graph_->topo_sort[index]->GetName(), value));
+  }
+  bounds.second = std::min(bounds.second, value);
+  min_upper_bound_ = std::min(min_upper_bound_, value);
+  return absl::OkStatus();
+}
+
+absl::Status ScheduleBounds::EstimateDelays() {
+  if (graph_->delays.size() == graph_->topo_sort.size()) {
+    return absl::OkStatus();
+  }
+  std::vector<int64_t> delays;
+  delays.reserve(graph_->topo_sort.size());
+  for (Node* node : graph_->topo_sort) {
     XLS_ASSIGN_OR_RETURN(int64_t node_delay,
                          delay_estimator_->GetOperationDelayInPs(node));
     if (node_delay > clock_period_ps_) {
@@ -110,61 +133,176 @@ absl::Status ScheduleBounds::PropagateLowerBounds() {
           "Node %s has a greater delay (%dps) than the clock period (%dps)",
           node->GetName(), node_delay, clock_period_ps_));
     }
-    if (node_in_cycle_delay + node_delay > clock_period_ps_) {
-      // Node does not fit in this cycle. Move to next cycle.
-      VLOG(4) << "    overflows clock period, tightened lb to " << lb(node) + 1;
-      XLS_RETURN_IF_ERROR(TightenNodeLb(node, lb(node) + 1));
-      node_in_cycle_delay = 0;
+    delays.push_back(node_delay);
+  }
+  graph_->delays = std::move(delays);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<bool> ScheduleBounds::UpdateLowerBound(int64_t index) {
+  Node* node = graph_->topo_sort[index];
+  const int64_t original_lb = bounds_[index].first;
+  int64_t node_in_cycle_delay = 0;
+  VLOG(4) << absl::StreamFormat("  %s : original lb=%d", node->GetName(),
+                                original_lb);
+  for (int64_t operand : graph_->operands[index]) {
+    int64_t operand_lb = bounds_[operand].first;
+    if (operand_lb < bounds_[index].first) {
+      continue;
     }
+    int64_t operand_delay = graph_->delays[operand];
+    if (operand_lb > bounds_[index].first) {
+      VLOG(4) << absl::StreamFormat(
+          "    tightened lb to %d because of operand %s", operand_lb,
+          graph_->topo_sort[operand]->GetName());
+      XLS_RETURN_IF_ERROR(TightenLb(index, operand_lb));
+      node_in_cycle_delay = lb_in_cycle_delay_[operand] + operand_delay;
+      continue;
+    }
+    node_in_cycle_delay = std::max(node_in_cycle_delay,
+                                   lb_in_cycle_delay_[operand] + operand_delay);
+  }
+  if (node_in_cycle_delay + graph_->delays[index] > clock_period_ps_) {
+    // Node does not fit in this cycle. Move to next cycle.
+    VLOG(4) << "    overflows clock period, tightened lb to "
+            << bounds_[index].first + 1;
+    XLS_RETURN_IF_ERROR(TightenLb(index, bounds_[index].first + 1));
+    node_in_cycle_delay = 0;
+  }
+  bool changed = bounds_[index].first != original_lb ||
+                 lb_in_cycle_delay_[index] != node_in_cycle_delay;
+  lb_in_cycle_delay_[index] = node_in_cycle_delay;
+  return changed;
+}
+
+absl::StatusOr<bool> ScheduleBounds::UpdateUpperBound(int64_t index) {
+  Node* node = graph_->topo_sort[index];
+  const int64_t original_ub = bounds_[index].second;
+  int64_t node_in_cycle_delay = 0;
+  VLOG(4) << absl::StreamFormat("  %s : original ub=%d", node->GetName(),
+                                original_ub);
+  for (int64_t user : graph_->users[index]) {
+    int64_t user_ub = bounds_[user].second;
+    if (user_ub == std::numeric_limits<int64_t>::max() ||
+        user_ub > bounds_[index].second) {
+      continue;
+    }
+    int64_t user_delay = graph_->delays[user];
+    if (user_ub < bounds_[index].second) {
+      VLOG(4) << absl::StreamFormat(
+          "    tightened ub to %d because of user %s", user_ub,
+          graph_->topo_sort[user]->GetName());
+      XLS_RETURN_IF_ERROR(TightenUb(index, user_ub));
+      node_in_cycle_delay = ub_in_cycle_delay_[user] + user_delay;
+      continue;
+    }
+    node_in_cycle_delay =
+        std::max(node_in_cycle_delay, ub_in_cycle_delay_[user] + user_delay);
+  }
+  if (node_in_cycle_delay + graph_->delays[index] > clock_period_ps_) {
+    // Node does not fit in this cycle. Move to next cycle.
+    VLOG(4) << "    overflows clock period, tightened ub to "
+            << bounds_[index].second - 1;
+    XLS_RETURN_IF_ERROR(TightenUb(index, bounds_[index].second - 1));
+    node_in_cycle_delay = 0;
   }
+  bool changed = bounds_[index].second != original_ub ||
+                 ub_in_cycle_delay_[index] != node_in_cycle_delay;
+  ub_in_cycle_delay_[index] = node_in_cycle_delay;
+  return changed;
+}
+
+absl::Status ScheduleBounds::PropagateLowerBounds() {
+  VLOG(4) << "PropagateLowerBounds()";
+  XLS_RETURN_IF_ERROR(EstimateDelays());
+  const int64_t node_count = graph_->topo_sort.size();
+  std::vector<int64_t> pending = std::move(lb_pending_);
+  lb_pending_.clear();
+  // Until a propagation completes, in-cycle delays are unknown and every node
+  // must be visited.
+  const bool visit_all = !lower_bounds_propagated_;
+  lower_bounds_propagated_ = false;
+
+  if (visit_all) {
+    for (int64_t i = 0; i < node_count; ++i) {
+      XLS_RETURN_IF_ERROR(UpdateLowerBound(i).status());
+    }
+  } else {
+    // Visit the users of tightened nodes in topological order, stopping
+    // wherever the bounds and in-cycle delays are unchanged.
+    std::priority_queue<int64_t, std::vector<int64_t>, std::greater<>> worklist;
+    std::vector<bool> queued(node_count, false);
+    auto enqueue_users = [&](int64_t index) {
+      for (int64_t user : graph_->users[index]) {
+        if (!queued[user]) {
+          queued[user] = true;
+          worklist.push(user);
+        }
+      }
+    };
+    for (int64_t index : pending) {
+      if (!queued[index]) {
+        queued[index] = true;
+        worklist.push(index);
+      }
+      enqueue_users(index);
+    }
+    while (!worklist.empty()) {
+      int64_t index = worklist.top();
+      worklist.pop();
+      XLS_ASSIGN_OR_RETURN(bool changed, UpdateLowerBound(index));
+      if (changed) {
+        enqueue_users(index);
+      }
+    }
+  }
+  lower_bounds_propagated_ = true;
   return absl::OkStatus();
 }
 
 absl::Status ScheduleBounds::PropagateUpperBounds() {
   VLOG(4) << "PropagateUpperBounds()";
-  // The delay in picoseconds from the end of a cycle to the end of the node.
-  absl::flat_hash_map<Node*, int64_t> in_cycle_delay;
-
-  // Compute the upper bound of each node based on the upper bounds of the
-  // users of the node.
-  for (auto it = topo_sort_.rbegin(); it != topo_sort_.rend(); ++it) {
-    Node* node = *it;
-    int64_t& node_in_cycle_delay = in_cycle_delay[node];
-    VLOG(4) << absl::StreamFormat("  %s : original ub=%d", node->GetName(),
-                                  ub(node));
-    for (Node* user : node->users()) {
-      int64_t user_ub = ub(user);
-      if (user_ub == std::numeric_limits<int64_t>::max() ||
-          user_ub > ub(node)) {
-        continue;
+  XLS_RETURN_IF_ERROR(EstimateDelays());
+  const int64_t node_count = graph_->topo_sort.size();
+  std::vector<int64_t> pending = std::move(ub_pending_);
+  ub_pending_.clear();
+  const bool visit_all = !upper_bounds_propagated_;
+  upper_bounds_propagated_ = false;
+
+  if (visit_all) {
+    for (int64_t i = node_count - 1; i >= 0; --i) {
+      XLS_RETURN_IF_ERROR(UpdateUpperBound(i).status());
+    }
+  } else {
+    // Visit the operands of tightened nodes in reverse topological order,
+    // stopping wherever the bounds and in-cycle delays are unchanged.
+    std::priority_queue<int64_t> worklist;
+    std::vector<bool> queued(node_count, false);
+    auto enqueue_operands = [&](int64_t index) {
+      for (int64_t operand : graph_->operands[index]) {
+        if (!queued[operand]) {
+          queued[operand] = true;
+          worklist.push(operand);
+        }
       }
-      XLS_ASSIGN_OR_RETURN(int64_t user_delay,
-                           delay_estimator_->GetOperationDelayInPs(user));
-      if (user_ub < ub(node)) {
-        VLOG(4) << absl::StreamFormat(
-            "    tightened ub to %d because of user %s", user_ub,
-            user->GetName());
-        XLS_RETURN_IF_ERROR(TightenNodeUb(node, user_ub));
-        node_in_cycle_delay = in_cycle_delay.at(user) + user_delay;
-        continue;
+    };
+    for (int64_t index : pending) {
+      if (!queued[index]) {
+        queued[index] = true;
+        worklist.push(index);
       }
-      node_in_cycle_delay =
-          std::max(node_in_cycle_delay, in_cycle_delay.at(user) + user_delay);
+      enqueue_operands(index);
     }
-    XLS_ASSIGN_OR_RETURN(int64_t node_delay,
-                         delay_estimator_->GetOperationDelayInPs(node));
-    if (node_delay > clock_period_ps_) {
-      return absl::ResourceExhaustedError(absl::StrFormat(
-          "Node %s has a greater delay (%dps) than the clock period (%dps)",
-          node->GetName(), node_delay, clock_period_ps_));
-    }
-    if (node_in_cycle_delay + node_delay > clock_period_ps_) {
-      // Node does not fit in this cycle. Move to next cycle.
-      VLOG(4) << "    overflows clock period, tightened ub to " << ub(node) - 1;
-      XLS_RETURN_IF_ERROR(TightenNodeUb(node, ub(node) - 1));
-      node_in_cycle_delay = 0;
+    while (!worklist.empty()) {
+      int64_t index = worklist.top();
+      worklist.pop();
+      XLS_ASSIGN_OR_RETURN(bool changed, UpdateUpperBound(index));
+      if (changed) {
+        enqueue_operands(index);
+      }
     }
   }
+  upper_bounds_propagated_ = true;
   return absl::OkStatus();
 }
 
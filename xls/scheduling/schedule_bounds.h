@@ -18,11 +18,13 @@
 #include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
@@ -69,40 +71,34 @@ class ScheduleBounds {
   void Reset();
 
   // Return the lower/upper bound of the given node.
-  int64_t lb(Node* node) const { return bounds_.at(node).first; }
-  int64_t ub(Node* node) const { return bounds_.at(node).second; }
+  int64_t lb(Node* node) const { return bounds(node).first; }
+  int64_t ub(Node* node) const { return bounds(node).second; }
 
   // Return the lower and upper bound as a pair (lower bound is first element).
   const std::pair<int64_t, int64_t>& bounds(Node* node) const {
-    return bounds_.at(node);
+    return bounds_[graph_->topo_index.at(node)];
   }
 
   // Sets the lower bound of the given node to the maximum of its existing value
   // and the given value. Raises a ResourceExhaustedError if the new value
   // results in infeasible bounds (lower bound is greater than upper bound).
   absl::Status TightenNodeLb(Node* node, int64_t value) {
-    if (value > ub(node)) {
-      return absl::ResourceExhaustedError(
-          absl::StrFormat("Unable to tighten the lower bound of node %s to %d.",
-                          node->GetName(), value));
+    int64_t index = graph_->topo_index.at(node);
+    if (value > bounds_[index].first) {
+      lb_pending_.push_back(index);
     }
-    bounds_.at(node).first = std::max(bounds_.at(node).first, value);
-    max_lower_bound_ = std::max(max_lower_bound_, value);
-    return absl::OkStatus();
+    return TightenLb(index, value);
   }
 
   // Sets the upper bound of the given node to the minimum of its existing value
   // and the given value. Raises a ResourceExhaustedError if the new value
   // results in infeasible bounds (lower bound is greater than upper bound).
   absl::Status TightenNodeUb(Node* node, int64_t value) {
-    if (value < lb(node)) {
-      return absl::ResourceExhaustedError(
-          absl::StrFormat("Unable to tighten the upper bound of node %s to %d.",
-                          node->GetName(), value));
+    int64_t index = graph_->topo_index.at(node);
+    if (value < bounds_[index].second) {
+      ub_pending_.push_back(index);
     }
-    bounds_.at(node).second = std::min(bounds_.at(node).second, value);
-    min_upper_bound_ = std::min(min_upper_bound_, value);
-    return absl::OkStatus();
+    return TightenUb(index, value);
   }
 
   // Returns the maximum lower (upper) bound of any node in the function.
@@ -117,18 +113,60 @@ class ScheduleBounds {
   // throughout the graph. This method only tightens bounds (increases lower
   // bounds and decreases upper bounds). Returns an error if propagation results
   // in infeasible bounds (lower bound is greater than upper bound for a node).
+  //
+  // After the first propagation in each direction, only the users (operands)
+  // of nodes tightened since the previous propagation are revisited, and the
+  // walk stops wherever the bounds stop changing. The result is identical to
+  // propagating over the whole graph.
   absl::Status PropagateLowerBounds();
   absl::Status PropagateUpperBounds();
 
  private:
-  // A topological sort of the nodes in the function.
-  std::vector<Node*> topo_sort_;
+  // The function's nodes and their dependencies, identified by their position
+  // in a topological sort. Shared between copies of the bounds, which differ
+  // only in the bounds themselves.
+  struct Graph {
+    std::vector<Node*> topo_sort;
+    absl::flat_hash_map<Node*, int64_t> topo_index;
+    std::vector<absl::InlinedVector<int64_t, 2>> operands;
+    std::vector<absl::InlinedVector<int64_t, 2>> users;
+    // The delay of each node; estimated on first propagation.
+    std::vector<int64_t> delays;
+  };
+
+  static std::shared_ptr<Graph> MakeGraph(std::vector<Node*> topo_sort);
+
+  absl::Status EstimateDelays();
+
+  absl::Status TightenLb(int64_t index, int64_t value);
+  absl::Status TightenUb(int64_t index, int64_t value);
+
+  // Recomputes the lower (upper) bound and in-cycle delay of the node at
+  // `index` from its operands (users). Returns whether either changed.
+  absl::StatusOr<bool> UpdateLowerBound(int64_t index);
+  absl::StatusOr<bool> UpdateUpperBound(int64_t index);
+
+  std::shared_ptr<Graph> graph_;
 
   int64_t clock_period_ps_;
   const DelayEstimator* delay_estimator_;
 
-  // The bounds of each node stored as a {lower, upper} pair.
-  absl::flat_hash_map<Node*, std::pair<int64_t, int64_t>> bounds_;
+  // The bounds of each node stored as a {lower, upper} pair, indexed by
+  // position in the topological sort.
+  std::vector<std::pair<int64_t, int64_t>> bounds_;
+
+  // The delay in picoseconds from the beginning of a cycle to the start of
+  // each node (lower) and from the end of each node to the end of its cycle
+  // (upper) as of the last propagation. Only meaningful once the respective
+  // direction has been propagated since the last Reset().
+  std::vector<int64_t> lb_in_cycle_delay_;
+  std::vector<int64_t> ub_in_cycle_delay_;
+  bool lower_bounds_propagated_ = false;
+  bool upper_bounds_propagated_ = false;
+
+  // Nodes whose bounds were tightened since the last propagation.
+  std::vector<int64_t> lb_pending_;
+  std::vector<int64_t> ub_pending_;
 
   int64_t max_lower_bound_;
   int64_t min_upper_bound_;
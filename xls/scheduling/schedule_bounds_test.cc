@@ -19,6 +19,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
 #include "xls/delay_model/delay_estimator.h"
@@ -30,6 +31,7 @@ namespace xls {
 namespace sched {
 namespace {
 
+using status_testing::StatusIs;
 using testing::Pair;
 
 class TestDelayEstimator : public DelayEstimator {
@@ -165,6 +167,59 @@ TEST_F(ScheduleBoundsTest, SimpleExpressionTightenBounds) {
   EXPECT_EQ(bounds.lb(result.node()), 23);
 }
 
+TEST_F(ScheduleBoundsTest, IncrementalPropagation) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto a = fb.Not(x);
+  auto b = fb.Not(a);
+  auto c = fb.Not(b);
+  auto d = fb.Negate(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Tuple({c, d})));
+
+  ScheduleBounds bounds(f, /*clock_period_ps=*/2, delay_estimator_);
+  XLS_ASSERT_OK(bounds.PropagateLowerBounds());
+  EXPECT_EQ(bounds.lb(a.node()), 0);
+  EXPECT_EQ(bounds.lb(b.node()), 0);
+  EXPECT_EQ(bounds.lb(c.node()), 1);
+  EXPECT_EQ(bounds.lb(d.node()), 0);
+
+  // Copies are independent of the original.
+  ScheduleBounds copy = bounds;
+
+  // Only the users of `a` are revisited, using the in-cycle delays from the
+  // previous propagation.
+  XLS_ASSERT_OK(bounds.TightenNodeLb(a.node(), 3));
+  XLS_ASSERT_OK(bounds.PropagateLowerBounds());
+  EXPECT_EQ(bounds.lb(a.node()), 3);
+  EXPECT_EQ(bounds.lb(b.node()), 3);
+  EXPECT_EQ(bounds.lb(c.node()), 4);
+  EXPECT_EQ(bounds.lb(d.node()), 0);
+  EXPECT_EQ(bounds.max_lower_bound(), 4);
+
+  XLS_ASSERT_OK(copy.TightenNodeLb(b.node(), 2));
+  XLS_ASSERT_OK(copy.PropagateLowerBounds());
+  EXPECT_EQ(copy.lb(a.node()), 0);
+  EXPECT_EQ(copy.lb(b.node()), 2);
+  EXPECT_EQ(copy.lb(c.node()), 2);
+  EXPECT_EQ(bounds.lb(b.node()), 3);
+
+  XLS_ASSERT_OK(bounds.TightenNodeUb(c.node(), 4));
+  XLS_ASSERT_OK(bounds.PropagateUpperBounds());
+  EXPECT_EQ(bounds.ub(b.node()), 4);
+  EXPECT_EQ(bounds.ub(a.node()), 3);
+  EXPECT_EQ(bounds.ub(x.node()), 3);
+  EXPECT_THAT(bounds.TightenNodeLb(x.node(), 4),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+
+  // Later upper-bound propagations only revisit the operands of `b`.
+  XLS_ASSERT_OK(bounds.TightenNodeUb(b.node(), 3));
+  XLS_ASSERT_OK(bounds.PropagateUpperBounds());
+  EXPECT_EQ(bounds.ub(a.node()), 3);
+  EXPECT_EQ(bounds.ub(c.node()), 4);
+}
+
 }  // namespace
 }  // namespace sched
 }  // namespace xls
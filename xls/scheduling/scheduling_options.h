@@ -46,6 +46,12 @@ enum class SchedulingStrategy : int8_t {
 
   // Create a random but sound schedule. This is useful for testing.
   RANDOM,
+
+  // Like SDC, but for procs with an initiation interval II > 1 (and no fixed
+  // pipeline length) also consider pipelines up to II - 1 stages longer than
+  // the minimum, keeping the one with the fewest pipeline register bits. The
+  // extra stages add latency but leave the worst-case throughput unchanged.
+  MODULO,
 };
 
 enum class PathEvaluateStrategy : int8_t {
@@ -233,6 +239,8 @@ class SchedulingOptions {
         minimize_clock_on_failure_(true),
         recover_after_minimizing_clock_(false),
         minimize_worst_case_throughput_(false),
+        clock_period_search_threads_(1),
+        retime_pipeline_(false),
         constraints_({
             BackedgeConstraint(),
             SendThenRecvConstraint(/*minimum_latency=*/1),
@@ -244,6 +252,7 @@ class SchedulingOptions {
         fdo_refinement_stochastic_ratio_(1.0),
         fdo_path_evaluate_strategy_(PathEvaluateStrategy::WINDOW),
         fdo_synthesizer_name_("yosys"),
+        fdo_persistent_synthesis_tools_(false),
         schedule_all_procs_(false) {}
 
   // Returns the scheduling strategy.
@@ -312,6 +321,39 @@ class SchedulingOptions {
     return recover_after_minimizing_clock_;
   }
 
+  // Sets/gets the number of candidate clock periods evaluated concurrently,
+  // each on its own thread and SDC model, when searching for the minimum
+  // feasible clock period.
+  SchedulingOptions& clock_period_search_threads(int64_t value) {
+    clock_period_search_threads_ = value;
+    return *this;
+  }
+  int64_t clock_period_search_threads() const {
+    return clock_period_search_threads_;
+  }
+
+  // Sets/gets the number of nodes above which the SDC strategy schedules a
+  // function in independent groups of pipeline stages, each with at most
+  // roughly this many nodes, rather than as a single linear program. Trades
+  // some register optimality for speed on very large functions.
+  SchedulingOptions& sdc_partition_node_count(int64_t value) {
+    sdc_partition_node_count_ = value;
+    return *this;
+  }
+  std::optional<int64_t> sdc_partition_node_count() const {
+    return sdc_partition_node_count_;
+  }
+
+  // Sets/gets whether to rebalance the stages of the schedule after scheduling
+  // by moving nodes across stage boundaries (i.e., retiming the pipeline
+  // registers) to minimize the largest stage delay, keeping the pipeline
+  // length.
+  SchedulingOptions& retime_pipeline(bool value) {
+    retime_pipeline_ = value;
+    return *this;
+  }
+  bool retime_pipeline() const { return retime_pipeline_; }
+
   // Sets/gets whether to find the fastest feasible worst-case throughput if the
   // user has not specified a worst-case throughput bound.
   SchedulingOptions& minimize_worst_case_throughput(bool value) {
@@ -461,6 +503,16 @@ class SchedulingOptions {
     return fdo_path_evaluate_strategy_;
   }
 
+  // The maximum number of subgraph synthesis jobs in flight at once in each
+  // FDO iteration. If unset, all subgraphs are synthesized concurrently.
+  SchedulingOptions& fdo_max_concurrent_synthesis_jobs(int64_t value) {
+    fdo_max_concurrent_synthesis_jobs_ = value;
+    return *this;
+  }
+  std::optional<int64_t> fdo_max_concurrent_synthesis_jobs() const {
+    return fdo_max_concurrent_synthesis_jobs_;
+  }
+
   // Only support yosys for now.
   SchedulingOptions& fdo_synthesizer_name(std::string_view value) {
     fdo_synthesizer_name_ = value;
@@ -500,6 +552,14 @@ class SchedulingOptions {
     return fdo_default_driver_cell_;
   }
 
+  // Directory of the persistent cache of synthesized subgraph delays. Empty
+  // disables caching.
+  SchedulingOptions& fdo_delay_cache_dir(std::string_view value) {
+    fdo_delay_cache_dir_ = value;
+    return *this;
+  }
+  std::string fdo_delay_cache_dir() const { return fdo_delay_cache_dir_; }
+
   // Cell to assume is being driven by primary outputs
   SchedulingOptions& fdo_default_load(std::string_view value) {
     fdo_default_load_ = value;
@@ -507,6 +567,17 @@ class SchedulingOptions {
   }
   std::string fdo_default_load() const { return fdo_default_load_; }
 
+  // Whether to keep the synthesis and STA tools running between subgraph
+  // synthesis jobs (with the cell libraries loaded) instead of starting them
+  // for each job.
+  SchedulingOptions& fdo_persistent_synthesis_tools(bool value) {
+    fdo_persistent_synthesis_tools_ = value;
+    return *this;
+  }
+  bool fdo_persistent_synthesis_tools() const {
+    return fdo_persistent_synthesis_tools_;
+  }
+
   SchedulingOptions& schedule_all_procs(bool value) {
     schedule_all_procs_ = value;
     return *this;
@@ -523,6 +594,9 @@ class SchedulingOptions {
   bool minimize_clock_on_failure_;
   bool recover_after_minimizing_clock_;
   bool minimize_worst_case_throughput_;
+  int64_t clock_period_search_threads_;
+  std::optional<int64_t> sdc_partition_node_count_;
+  bool retime_pipeline_;
   std::optional<int64_t> worst_case_throughput_;
   std::optional<int64_t> additional_input_delay_ps_;
   std::optional<int64_t> ffi_fallback_delay_ps_;
@@ -537,12 +611,15 @@ class SchedulingOptions {
   int64_t fdo_fanout_driven_path_number_;
   float fdo_refinement_stochastic_ratio_;
   PathEvaluateStrategy fdo_path_evaluate_strategy_;
+  std::optional<int64_t> fdo_max_concurrent_synthesis_jobs_;
   std::string fdo_synthesizer_name_;
   std::string fdo_yosys_path_;
   std::string fdo_sta_path_;
   std::string fdo_synthesis_libraries_;
   std::string fdo_default_driver_cell_;
   std::string fdo_default_load_;
+  std::string fdo_delay_cache_dir_;
+  bool fdo_persistent_synthesis_tools_;
   bool schedule_all_procs_;
 };
 
@@ -23,6 +23,7 @@
 #include "xls/passes/literal_uncommoning_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
 #include "xls/scheduling/mutual_exclusion_pass.h"
+#include "xls/scheduling/pipeline_retiming_pass.h"
 #include "xls/scheduling/pipeline_scheduling_pass.h"
 #include "xls/scheduling/proc_state_legalization_pass.h"
 #include "xls/scheduling/scheduling_checker.h"
@@ -49,6 +50,7 @@ std::unique_ptr<SchedulingCompoundPass> CreateSchedulingPassPipeline() {
   top->Add<MutualExclusionPass>();
   top->Add<SchedulingWrapperPass>(std::make_unique<DeadCodeEliminationPass>());
   top->Add<PipelineSchedulingPass>();
+  top->Add<PipelineRetimingPass>();
 
   return top;
 }
@@ -525,31 +525,53 @@ absl::StatusOr<ScheduleCycleMap> SDCSchedulingModel::ExtractResult(
 }
 
 void SDCSchedulingModel::SetClockPeriod(int64_t clock_period_ps) {
+  UpdateTimingConstraints(ComputeCombinationalDelayConstraints(
+      func_, topo_sort_, clock_period_ps, distances_to_node_, delay_map_));
+}
+
+void SDCSchedulingModel::RecomputeDistances() {
+  distances_to_node_ = ComputeDistancesToNodes(func_, topo_sort_, delay_map_);
+}
+
+void SDCSchedulingModel::UpdateTimingConstraints(
+    absl::flat_hash_map<Node*, std::vector<Node*>> delay_constraints) {
   absl::flat_hash_map<Node*, std::vector<Node*>> prev_delay_constraints =
       std::move(delay_constraints_);
-  delay_constraints_ = ComputeCombinationalDelayConstraints(
-      func_, topo_sort_, clock_period_ps, distances_to_node_, delay_map_);
+  delay_constraints_ = std::move(delay_constraints);
 
+  int64_t added = 0;
+  int64_t removed = 0;
   for (Node* source : topo_sort_) {
-    if (!prev_delay_constraints.empty()) {
+    auto new_it = delay_constraints_.find(source);
+    if (auto prev_it = prev_delay_constraints.find(source);
+        prev_it != prev_delay_constraints.end()) {
       // Check over all the prior constraints, dropping any that are obsolete.
-      absl::flat_hash_set<Node*> new_targets(
-          delay_constraints_.at(source).begin(),
-          delay_constraints_.at(source).end());
-      for (Node* target : prev_delay_constraints.at(source)) {
+      absl::flat_hash_set<Node*> new_targets;
+      if (new_it != delay_constraints_.end()) {
+        new_targets.insert(new_it->second.begin(), new_it->second.end());
+      }
+      for (Node* target : prev_it->second) {
         if (new_targets.contains(target)) {
           continue;
         }
 
         // No longer related; remove constraint.
         auto it = timing_constraint_.find(std::make_pair(source, target));
+        if (it == timing_constraint_.end()) {
+          continue;
+        }
         model_.DeleteLinearConstraint(it->second);
         timing_constraint_.erase(it);
+        ++removed;
       }
     }
 
+    if (new_it == delay_constraints_.end()) {
+      continue;
+    }
+
     // Add all new constraints, avoiding duplicates for any that already exist.
-    for (Node* target : delay_constraints_.at(source)) {
+    for (Node* target : new_it->second) {
       auto key = std::make_pair(source, target);
       if (timing_constraint_.contains(key)) {
         continue;
@@ -561,8 +583,12 @@ void SDCSchedulingModel::SetClockPeriod(int64_t clock_period_ps) {
                                  source->GetName());
       timing_constraint_.emplace(
           key, DiffAtLeastConstraint(target, source, 1, "timing"));
+      ++added;
     }
   }
+  VLOG(2) << absl::StrFormat(
+      "Timing constraints: %d added, %d removed, %d total", added, removed,
+      timing_constraint_.size());
 }
 
 absl::Status SDCSchedulingModel::SetWorstCaseThroughput(
@@ -959,6 +985,24 @@ absl::Status SDCScheduler::AddConstraints(
   return absl::OkStatus();
 }
 
+absl::Status SDCScheduler::UpdateNodeDelays(
+    const absl::flat_hash_map<Node*, int64_t>& delays) {
+  bool changed = false;
+  for (const auto& [node, delay] : delays) {
+    auto it = delay_map_.find(node);
+    XLS_RET_CHECK(it != delay_map_.end())
+        << "Node " << node->GetName() << " is not in " << f_->name();
+    if (it->second != delay) {
+      it->second = delay;
+      changed = true;
+    }
+  }
+  if (changed) {
+    model_.RecomputeDistances();
+  }
+  return absl::OkStatus();
+}
+
 absl::Status SDCScheduler::BuildError(
     const math_opt::SolveResult& result,
     SchedulingFailureBehavior failure_behavior) {
@@ -63,8 +63,16 @@ class SDCSchedulingModel {
   absl::Status AddSendThenRecvConstraint(
       const SendThenRecvConstraint& constraint);
 
+  // Brings the timing constraints up to date with `clock_period_ps` and the
+  // current critical-path distances. Only the constraints which changed since
+  // the previous call are added to or removed from the LP.
   void SetClockPeriod(int64_t clock_period_ps);
 
+  // Recomputes the critical-path distances between nodes; must be called after
+  // the delay map passed on construction has been modified. The timing
+  // constraints are updated on the next call to SetClockPeriod.
+  void RecomputeDistances();
+
   absl::Status SetWorstCaseThroughput(int64_t worst_case_throughput);
 
   void SetPipelineLength(std::optional<int64_t> pipeline_length);
@@ -118,6 +126,15 @@ class SDCSchedulingModel {
   operations_research::math_opt::LinearConstraint DiffEqualsConstraint(
       Node* x, Node* y, int64_t diff, std::string_view name);
 
+ protected:
+  // Replaces the timing constraints of the model with `delay_constraints`,
+  // where `delay_constraints[x]` is the set of nodes which must be scheduled
+  // at least one cycle later than `x`. Constraints present both before and
+  // after are left untouched so an incremental solver can warm-start from its
+  // previous basis.
+  void UpdateTimingConstraints(
+      absl::flat_hash_map<Node*, std::vector<Node*>> delay_constraints);
+
  private:
   operations_research::math_opt::Variable AddUpperBoundSlack(
       operations_research::math_opt::LinearConstraint c,
@@ -217,6 +234,13 @@ class SDCScheduler {
   absl::Status AddConstraints(
       absl::Span<const SchedulingConstraint> constraints);
 
+  // Replaces the estimated delays of the given nodes. The LP built so far is
+  // retained: the next call to Schedule only adds and removes the timing
+  // constraints affected by the change, and the solver warm-starts from the
+  // basis of the previous solve.
+  absl::Status UpdateNodeDelays(
+      const absl::flat_hash_map<Node*, int64_t>& delays);
+
   // Schedule to minimize the total pipeline registers using SDC scheduling
   // the constraint matrix is totally unimodular, this ILP problem can be solved
   // by LP.
@@ -0,0 +1,98 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/scheduling/sdc_scheduler.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+namespace {
+
+using ::testing::UnorderedElementsAreArray;
+
+class SDCSchedulerTest : public IrTestBase {};
+
+TEST_F(SDCSchedulerTest, UpdateNodeDelaysMatchesFreshSchedule) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue value = x;
+  for (int64_t i = 0; i < 4; ++i) {
+    value = fb.Add(value, x);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SDCScheduler> scheduler,
+                           SDCScheduler::Create(f, TestDelayEstimator()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ScheduleCycleMap initial,
+      scheduler->Schedule(/*pipeline_stages=*/std::nullopt,
+                          /*clock_period_ps=*/2, SchedulingFailureBehavior()));
+  EXPECT_EQ(initial.at(f->return_value()), 1);
+
+  // Double the delay of every add; each now fills a whole cycle.
+  absl::flat_hash_map<Node*, int64_t> delays;
+  for (Node* node : f->nodes()) {
+    if (node->op() == Op::kAdd) {
+      delays[node] = 2;
+    }
+  }
+  XLS_ASSERT_OK(scheduler->UpdateNodeDelays(delays));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ScheduleCycleMap updated,
+      scheduler->Schedule(/*pipeline_stages=*/std::nullopt,
+                          /*clock_period_ps=*/2, SchedulingFailureBehavior()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SDCScheduler> fresh_scheduler,
+      SDCScheduler::Create(f, TestDelayEstimator(/*base_delay=*/2)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ScheduleCycleMap fresh,
+      fresh_scheduler->Schedule(/*pipeline_stages=*/std::nullopt,
+                                /*clock_period_ps=*/2,
+                                SchedulingFailureBehavior()));
+  EXPECT_EQ(updated.at(f->return_value()), 3);
+  EXPECT_THAT(updated, UnorderedElementsAreArray(fresh));
+}
+
+TEST_F(SDCSchedulerTest, UpdateNodeDelaysRejectsForeignNode) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Not(fb.Param("x", p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  FunctionBuilder other_fb("other", p.get());
+  BValue y = other_fb.Param("y", p->GetBitsType(32));
+  XLS_ASSERT_OK(other_fb.Build().status());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SDCScheduler> scheduler,
+                           SDCScheduler::Create(f, TestDelayEstimator()));
+  EXPECT_FALSE(scheduler->UpdateNodeDelays({{y.node(), 1}}).ok());
+}
+
+}  // namespace
+}  // namespace xls
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -43,6 +44,7 @@
 #include "xls/simulation/module_testbench.h"
 #include "xls/simulation/module_testbench_thread.h"
 #include "xls/simulation/testbench_signal_capture.h"
+#include "xls/simulation/testbench_stream.h"
 #include "xls/tools/eval_utils.h"
 
 namespace xls {
@@ -150,9 +152,12 @@ absl::Status HoldoffValid(int64_t input_number, int64_t input_bit_count,
 }
 
 // Sets up the test bench to drive the specified inputs on to the given channel.
+// If `stream` is given, the data values are instead read from it during
+// simulation so only the number of `inputs` is built into the test bench.
 absl::Status DriveInputChannel(absl::Span<const Bits> inputs,
                                const ChannelProto& channel_proto,
                                absl::Span<const ValidHoldoff> valid_holdoffs,
+                               const TestbenchStream* stream,
                                ModuleTestbench& tb) {
   std::vector<DutInput> dut_inputs;
   std::string_view data_port_name = channel_proto.data_port_name();
@@ -184,7 +189,11 @@ absl::Status DriveInputChannel(absl::Span<const Bits> inputs,
                                        valid_holdoffs[input_number],
                                        channel_proto, seq_block));
     }
-    seq_block.Set(data_port_name, value);
+    if (stream != nullptr) {
+      seq_block.ReadFromStreamAndSet(data_port_name, stream);
+    } else {
+      seq_block.Set(data_port_name, value);
+    }
     if (valid_port_name.has_value()) {
       seq_block.Set(valid_port_name.value(), UBits(1, 1));
     }
@@ -202,10 +211,12 @@ absl::Status DriveInputChannel(absl::Span<const Bits> inputs,
 
 // Sets up the test bench to captures `output_count` outputs on the given output
 // channel. Returns the sequence of placeholder Bits objects which will hold the
-// values after the test bench is run.
+// values after the test bench is run. If `stream` is given, the outputs are
+// instead written to it and no placeholders are returned.
 absl::StatusOr<std::vector<std::unique_ptr<Bits>>> CaptureOutputChannel(
     const ChannelProto& channel_proto, int64_t output_count,
-    absl::Span<const int64_t> ready_holdoffs, ModuleTestbench& tb) {
+    absl::Span<const int64_t> ready_holdoffs, const TestbenchStream* stream,
+    ModuleTestbench& tb) {
   if (channel_proto.has_ready_port_name()) {
     std::string_view ready_port_name = channel_proto.ready_port_name();
     // Create a separate thread to drive ready and any necessary holdoffs
@@ -258,14 +269,15 @@ absl::StatusOr<std::vector<std::unique_ptr<Bits>>> CaptureOutputChannel(
   }
   std::vector<std::unique_ptr<Bits>> outputs;
   for (int64_t read_count = 0; read_count < output_count; ++read_count) {
-    outputs.push_back(std::make_unique<Bits>());
-    if (flow_control_signals.empty()) {
-      tbt->MainBlock().AtEndOfCycle().Capture(channel_proto.data_port_name(),
-                                              outputs.back().get());
+    EndOfCycleEvent& event =
+        flow_control_signals.empty()
+            ? tbt->MainBlock().AtEndOfCycle()
+            : tbt->MainBlock().AtEndOfCycleWhenAll(flow_control_signals);
+    if (stream != nullptr) {
+      event.CaptureAndWriteToStream(channel_proto.data_port_name(), stream);
     } else {
-      tbt->MainBlock()
-          .AtEndOfCycleWhenAll(flow_control_signals)
-          .Capture(channel_proto.data_port_name(), outputs.back().get());
+      outputs.push_back(std::make_unique<Bits>());
+      event.Capture(channel_proto.data_port_name(), outputs.back().get());
     }
   }
   return outputs;
@@ -526,7 +538,7 @@ absl::StatusOr<std::string> ModuleSimulator::GenerateProcTestbenchVerilog(
   XLS_ASSIGN_OR_RETURN(
       ProcTestbench proc_tb,
       CreateProcTestbench(channel_inputs, output_channel_counts,
-                          std::move(holdoffs)));
+                          std::move(holdoffs), /*stream_channel_data=*/false));
   return proc_tb.testbench->GenerateVerilog();
 }
 
@@ -534,7 +546,8 @@ absl::StatusOr<ModuleSimulator::ProcTestbench>
 ModuleSimulator::CreateProcTestbench(
     const absl::flat_hash_map<std::string, std::vector<Bits>>& channel_inputs,
     const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
-    std::optional<ReadyValidHoldoffs> holdoffs) const {
+    std::optional<ReadyValidHoldoffs> holdoffs,
+    bool stream_channel_data) const {
   VLOG(1) << "Generating testbench for Verilog module with signature:\n"
           << signature_.ToString();
   if (VLOG_IS_ON(1)) {
@@ -595,6 +608,30 @@ ModuleSimulator::CreateProcTestbench(
     max_channel_reads = std::max(max_channel_reads, read_count);
   }
 
+  // Creates a stream named after the channel to carry the values of its data
+  // port, if channel data is streamed.
+  auto make_stream = [&](const ChannelProto& channel_proto, bool is_input)
+      -> absl::StatusOr<const TestbenchStream*> {
+    if (!stream_channel_data) {
+      return nullptr;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        PortProto data_port,
+        is_input
+            ? signature_.GetInputPortProtoByName(channel_proto.data_port_name())
+            : signature_.GetOutputPortProtoByName(
+                  channel_proto.data_port_name()));
+    if (data_port.width() == 0) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "Cannot stream the data of zero-width channel `%s`",
+          channel_proto.name()));
+    }
+    return is_input
+               ? tb->CreateInputStream(channel_proto.name(), data_port.width())
+               : tb->CreateOutputStream(channel_proto.name(),
+                                        data_port.width());
+  };
+
   // TODO(vmirian): 10-30-2022 Ensure semantics work for single value channel.
   for (const ChannelProto& channel_proto : signature_.GetInputChannels()) {
     std::string_view channel_name = channel_proto.name();
@@ -603,8 +640,11 @@ ModuleSimulator::CreateProcTestbench(
         holdoffs->valid_holdoffs.contains(channel_name)) {
       valid_holdoffs = holdoffs->valid_holdoffs.at(channel_name);
     }
+    XLS_ASSIGN_OR_RETURN(const TestbenchStream* stream,
+                         make_stream(channel_proto, /*is_input=*/true));
     XLS_RETURN_IF_ERROR(DriveInputChannel(channel_inputs.at(channel_name),
-                                          channel_proto, valid_holdoffs, *tb));
+                                          channel_proto, valid_holdoffs, stream,
+                                          *tb));
   }
 
   // Use std::unique_ptr for pointer stability necessary for
@@ -618,11 +658,13 @@ ModuleSimulator::CreateProcTestbench(
         holdoffs->ready_holdoffs.contains(channel_name)) {
       ready_holdoffs = holdoffs->ready_holdoffs.at(channel_name);
     }
+    XLS_ASSIGN_OR_RETURN(const TestbenchStream* stream,
+                         make_stream(channel_proto, /*is_input=*/false));
     XLS_ASSIGN_OR_RETURN(
         stable_outputs[channel_name],
         CaptureOutputChannel(channel_proto,
                              output_channel_counts.at(channel_proto.name()),
-                             ready_holdoffs, *tb));
+                             ready_holdoffs, stream, *tb));
   }
   return ProcTestbench{
       .testbench = std::move(tb),
@@ -638,7 +680,7 @@ ModuleSimulator::RunInputSeriesProc(
   XLS_ASSIGN_OR_RETURN(
       ProcTestbench proc_tb,
       CreateProcTestbench(channel_inputs, output_channel_counts,
-                          std::move(holdoffs)));
+                          std::move(holdoffs), /*stream_channel_data=*/false));
   XLS_RETURN_IF_ERROR(proc_tb.testbench->Run());
 
   absl::flat_hash_map<std::string, std::vector<Bits>> outputs;
@@ -702,6 +744,136 @@ ModuleSimulator::RunInputSeriesProc(
   return channel_outputs;
 }
 
+absl::StatusOr<std::vector<absl::flat_hash_map<std::string, std::vector<Bits>>>>
+ModuleSimulator::RunInputSeriesProcBatched(
+    absl::Span<const absl::flat_hash_map<std::string, std::vector<Bits>>>
+        channel_inputs,
+    const absl::flat_hash_map<std::string, int64_t>& output_channel_counts)
+    const {
+  using ChannelBits = absl::flat_hash_map<std::string, std::vector<Bits>>;
+
+  // Series with the same number of values on each input channel share a
+  // testbench. Shapes are kept in order of first appearance for determinism.
+  absl::flat_hash_map<std::vector<int64_t>, std::vector<int64_t>>
+      series_by_shape;
+  std::vector<std::vector<int64_t>> shapes;
+  for (int64_t i = 0; i < channel_inputs.size(); ++i) {
+    std::vector<int64_t> shape;
+    for (const ChannelProto& channel_proto : signature_.GetInputChannels()) {
+      auto it = channel_inputs[i].find(channel_proto.name());
+      if (it == channel_inputs[i].end()) {
+        return absl::NotFoundError(
+            absl::StrFormat("Input series %d has no values for channel `%s`",
+                            i, channel_proto.name()));
+      }
+      shape.push_back(it->second.size());
+    }
+    auto [it, inserted] = series_by_shape.try_emplace(shape);
+    if (inserted) {
+      shapes.push_back(shape);
+    }
+    it->second.push_back(i);
+  }
+
+  std::vector<ChannelBits> outputs(channel_inputs.size());
+  for (const std::vector<int64_t>& shape : shapes) {
+    const std::vector<int64_t>& series_indices = series_by_shape.at(shape);
+    XLS_ASSIGN_OR_RETURN(
+        ProcTestbench proc_tb,
+        CreateProcTestbench(channel_inputs[series_indices.front()],
+                            output_channel_counts, /*holdoffs=*/std::nullopt,
+                            /*stream_channel_data=*/true));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledModuleTestbench> compiled,
+                         proc_tb.testbench->CompileWithStreamingIo());
+
+    for (int64_t index : series_indices) {
+      const ChannelBits& series_inputs = channel_inputs[index];
+      for (const auto& [channel_name, channel_values] : series_inputs) {
+        XLS_RETURN_IF_ERROR(
+            signature_.ValidateChannelBitsInputs(channel_name, channel_values));
+      }
+
+      // The streams are serviced by separate threads so create all of the
+      // output vectors up front; the consumers then only append to their own.
+      ChannelBits& series_outputs = outputs[index];
+      for (const ChannelProto& channel_proto : signature_.GetOutputChannels()) {
+        series_outputs[channel_proto.name()].reserve(
+            output_channel_counts.at(channel_proto.name()));
+      }
+
+      // Streams are named after their channels. The producer and consumer
+      // functions must outlive the references to them passed to the testbench.
+      absl::flat_hash_map<std::string, std::function<std::optional<Bits>()>>
+          producer_fns;
+      for (const auto& [channel_name, channel_values] : series_inputs) {
+        producer_fns[channel_name] =
+            [&values = channel_values, next = int64_t{0}]() mutable
+            -> std::optional<Bits> {
+          if (next == values.size()) {
+            return std::nullopt;
+          }
+          return values[next++];
+        };
+      }
+      absl::flat_hash_map<std::string, std::function<absl::Status(const Bits&)>>
+          consumer_fns;
+      for (auto& [channel_name, channel_values] : series_outputs) {
+        consumer_fns[channel_name] = [&values = channel_values](
+                                         const Bits& bits) {
+          values.push_back(bits);
+          return absl::OkStatus();
+        };
+      }
+      absl::flat_hash_map<std::string, TestbenchStreamThread::Producer>
+          producers(producer_fns.begin(), producer_fns.end());
+      absl::flat_hash_map<std::string, TestbenchStreamThread::Consumer>
+          consumers(consumer_fns.begin(), consumer_fns.end());
+      XLS_RETURN_IF_ERROR(compiled->RunWithStreamingIo(producers, consumers));
+    }
+  }
+  return outputs;
+}
+
+absl::StatusOr<
+    std::vector<absl::flat_hash_map<std::string, std::vector<Value>>>>
+ModuleSimulator::RunInputSeriesProcBatched(
+    absl::Span<const absl::flat_hash_map<std::string, std::vector<Value>>>
+        channel_inputs,
+    const absl::flat_hash_map<std::string, int64_t>& output_channel_counts)
+    const {
+  using BitsMapT = absl::flat_hash_map<std::string, std::vector<Bits>>;
+  std::vector<BitsMapT> channel_inputs_bits;
+  channel_inputs_bits.reserve(channel_inputs.size());
+  for (const auto& series : channel_inputs) {
+    BitsMapT& series_bits = channel_inputs_bits.emplace_back();
+    for (const auto& [channel_name, channel_values] : series) {
+      XLS_RETURN_IF_ERROR(
+          signature_.ValidateChannelValueInputs(channel_name, channel_values));
+      series_bits[channel_name] = ValueListToBitsList(channel_values);
+    }
+  }
+
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<BitsMapT> channel_outputs_bits,
+      RunInputSeriesProcBatched(channel_inputs_bits, output_channel_counts));
+
+  std::vector<absl::flat_hash_map<std::string, std::vector<Value>>>
+      channel_outputs(channel_outputs_bits.size());
+  for (int64_t i = 0; i < channel_outputs_bits.size(); ++i) {
+    for (const auto& [channel_name, channel_bits] : channel_outputs_bits[i]) {
+      XLS_ASSIGN_OR_RETURN(
+          ChannelProto channel_proto,
+          signature_.GetOutputChannelProtoByName(channel_name));
+      XLS_ASSIGN_OR_RETURN(
+          PortProto data_port,
+          signature_.GetOutputPortProtoByName(channel_proto.data_port_name()));
+      XLS_ASSIGN_OR_RETURN(channel_outputs[i][channel_name],
+                           BitsListToValueList(channel_bits, data_port.type()));
+    }
+  }
+  return channel_outputs;
+}
+
 absl::StatusOr<Value> ModuleSimulator::RunFunction(
     absl::Span<const Value> inputs) const {
   absl::flat_hash_map<std::string, Value> kwargs;
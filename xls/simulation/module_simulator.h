@@ -128,6 +128,29 @@ class ModuleSimulator {
       const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
       std::optional<ReadyValidHoldoffs> holdoffs = std::nullopt) const;
 
+  // Runs each of the given series of channel inputs through the module as
+  // RunInputSeriesProc does, returning the outputs of each series. Channel
+  // values are streamed into and out of the simulation, so the testbench is
+  // generated and compiled only once for all series with the same number of
+  // inputs on each channel; each series is then a separate (reset) run of the
+  // compiled simulation. This is much faster than calling RunInputSeriesProc
+  // for each series. Ready/valid holdoffs are not supported.
+  absl::StatusOr<
+      std::vector<absl::flat_hash_map<std::string, std::vector<Bits>>>>
+  RunInputSeriesProcBatched(
+      absl::Span<const absl::flat_hash_map<std::string, std::vector<Bits>>>
+          channel_inputs,
+      const absl::flat_hash_map<std::string, int64_t>& output_channel_counts)
+      const;
+  // Overload of the above function that accepts Values rather than Bits.
+  absl::StatusOr<
+      std::vector<absl::flat_hash_map<std::string, std::vector<Value>>>>
+  RunInputSeriesProcBatched(
+      absl::Span<const absl::flat_hash_map<std::string, std::vector<Value>>>
+          channel_inputs,
+      const absl::flat_hash_map<std::string, int64_t>& output_channel_counts)
+      const;
+
   // Runs a function with arguments as a Span.
   absl::StatusOr<Value> RunFunction(absl::Span<const Value> inputs) const;
 
@@ -150,10 +173,14 @@ class ModuleSimulator {
     absl::flat_hash_map<std::string, std::vector<std::unique_ptr<Bits>>>
         outputs;
   };
+  // If `stream_channel_data` is true, channel values are streamed through
+  // streams named after the channels rather than built into the testbench, and
+  // `outputs` is left empty.
   absl::StatusOr<ProcTestbench> CreateProcTestbench(
       const absl::flat_hash_map<std::string, std::vector<Bits>>& channel_inputs,
       const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
-      std::optional<ReadyValidHoldoffs> holdoffs) const;
+      std::optional<ReadyValidHoldoffs> holdoffs,
+      bool stream_channel_data) const;
 
   ModuleSignature signature_;
   std::string verilog_text_;
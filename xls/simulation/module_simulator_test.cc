@@ -592,6 +592,34 @@ TEST_P(ModuleSimulatorTest, RunPipelinedProcValues) {
               IsOkAndHolds(result_values));
 }
 
+TEST_P(ModuleSimulatorTest, RunPipelinedProcBatched) {
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleGeneratorResult result, GetPipelinedProc());
+  ModuleSimulator simulator =
+      NewModuleSimulator(result.verilog_text, result.signature);
+  absl::flat_hash_map<std::string, int64_t> output_channel_counts = {
+      {"result", 2}};
+
+  std::vector<absl::flat_hash_map<std::string, std::vector<Bits>>> series(3);
+  series[0]["operand_0"] = {UBits(41, 32), UBits(32, 32)};
+  series[0]["operand_1"] = {UBits(1, 32), UBits(32, 32)};
+  series[1]["operand_0"] = {UBits(0, 32), UBits(100, 32)};
+  series[1]["operand_1"] = {UBits(7, 32), UBits(23, 32)};
+  // A series with a different number of inputs requires a separate testbench.
+  series[2]["operand_0"] = {UBits(1, 32), UBits(2, 32), UBits(3, 32)};
+  series[2]["operand_1"] = {UBits(10, 32), UBits(20, 32), UBits(30, 32)};
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto outputs,
+      simulator.RunInputSeriesProcBatched(series, output_channel_counts));
+  ASSERT_EQ(outputs.size(), series.size());
+  for (int64_t i = 0; i < series.size(); ++i) {
+    EXPECT_THAT(simulator.RunInputSeriesProc(series[i], output_channel_counts),
+                IsOkAndHolds(outputs[i]));
+  }
+  EXPECT_THAT(outputs[1].at("result"),
+              ElementsAre(UBits(7, 32), UBits(123, 32)));
+}
+
 TEST_P(ModuleSimulatorTest, RunPipelinedProcValidHoldoff) {
   XLS_ASSERT_OK_AND_ASSIGN(ModuleGeneratorResult result, GetPipelinedProc());
   ModuleSimulator simulator =
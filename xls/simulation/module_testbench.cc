@@ -16,13 +16,13 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
-#include <variant>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -33,24 +33,18 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
-#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
-#include "absl/types/variant.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/codegen/vast.h"
 #include "xls/common/file/temp_directory.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/source_location.h"
-#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
-#include "xls/ir/bits_ops.h"
-#include "xls/ir/format_preference.h"
-#include "xls/ir/number_parser.h"
 #include "xls/ir/source_location.h"
 #include "xls/simulation/module_testbench_thread.h"
 #include "xls/simulation/testbench_metadata.h"
@@ -58,7 +52,6 @@
 #include "xls/simulation/testbench_stream.h"
 #include "xls/simulation/verilog_simulator.h"
 #include "xls/tools/verilog_include.h"
-#include "re2/re2.h"
 
 namespace xls {
 namespace verilog {
@@ -270,150 +263,8 @@ absl::StatusOr<ModuleTestbenchThread*> ModuleTestbench::CreateThread(
   return threads_.back().get();
 }
 
-// Scans the given simulation stdout and finds the $display statement outputs
-// associated with captured signals. Returns the signal values as Bits (or X)
-// for each output found in a map indexed by id of the capture instance.
-static absl::StatusOr<absl::flat_hash_map<int64_t, std::vector<BitsOrX>>>
-ExtractSignalValues(std::string_view stdout_str) {
-  // Scan the simulator output and pick out the OUTPUT lines holding the value
-  // of module signal.
-  absl::flat_hash_map<int64_t, std::vector<BitsOrX>> parsed_values;
-
-  // Example output lines for a bits value:
-  //
-  //   5 OUTPUT out0 = 16'h12ab (#1)
-  //
-  // And a value with one or more X's:
-  //
-  //   5 OUTPUT out0 = 16'hxxab (#1)
-  RE2 re(
-      R"(\s+[0-9]+\s+OUTPUT\s(\w+)\s+=\s+([0-9]+)'h([0-9a-fA-FxX]+)\s+\(#([0-9]+)\))");
-  std::string output_name;
-  std::string output_width;
-  std::string output_value;
-  std::string instance_str;
-  std::string_view piece(stdout_str);
-  while (RE2::FindAndConsume(&piece, re, &output_name, &output_width,
-                             &output_value, &instance_str)) {
-    int64_t width;
-    XLS_RET_CHECK(absl::SimpleAtoi(output_width, &width));
-    int64_t instance;
-    XLS_RET_CHECK(absl::SimpleAtoi(instance_str, &instance));
-
-    VLOG(1) << absl::StreamFormat(
-        "Found output `%s` width %d value %s instance #%d", output_name, width,
-        output_value, instance);
-
-    if (absl::StrContains(output_value, "x") ||
-        absl::StrContains(output_value, "X")) {
-      parsed_values[instance].push_back(IsX());
-    } else {
-      XLS_ASSIGN_OR_RETURN(
-          Bits value, ParseUnsignedNumberWithoutPrefix(output_value,
-                                                       FormatPreference::kHex));
-      XLS_RET_CHECK_GE(width, value.bit_count());
-      parsed_values[instance].push_back(bits_ops::ZeroExtend(value, width));
-    }
-  }
-  return parsed_values;
-}
-
-// Writes the captured sequence of values of the given signal/instance into the
-// given Bits vector. `outputs` is index by instance_id as returned by
-// `ExtractSignalValues`.
-static absl::Status RecordCapturedBitsVector(
-    std::string_view signal_name, int64_t instance_id,
-    const absl::flat_hash_map<int64_t, std::vector<BitsOrX>>& outputs,
-    std::vector<Bits>* bits_vector) {
-  bits_vector->clear();
-  if (outputs.contains(instance_id)) {
-    for (int64_t i = 0; i < outputs.at(instance_id).size(); ++i) {
-      const BitsOrX& output = outputs.at(instance_id)[i];
-      if (std::holds_alternative<IsX>(output)) {
-        return absl::NotFoundError(absl::StrFormat(
-            "Output `%s`, instance #%d, recurrence %d holds X value in "
-            "Verilog simulator output.",
-            signal_name, instance_id, i));
-      }
-      bits_vector->push_back(std::get<Bits>(output));
-    }
-  }
-  return absl::OkStatus();
-}
-
-// Writes the captured single value of the given signal/instance into the given
-// Bits. `outputs` is index by instance_id as returned by `ExtractSignalValues`.
-static absl::Status RecordCapturedBits(
-    std::string_view signal_name, int64_t instance_id,
-    const absl::flat_hash_map<int64_t, std::vector<BitsOrX>>& outputs,
-    Bits* bits) {
-  if (!outputs.contains(instance_id)) {
-    return absl::NotFoundError(absl::StrFormat(
-        "Output `%s`, instance #%d not found in Verilog simulator output.",
-        signal_name, instance_id));
-  }
-  XLS_RET_CHECK_EQ(outputs.at(instance_id).size(), 1);
-  const BitsOrX& bits_or_x = outputs.at(instance_id).front();
-  // Write out module signal values to pointers passed in via Capture
-  // calls.
-  if (std::holds_alternative<IsX>(bits_or_x)) {
-    return absl::NotFoundError(
-        absl::StrFormat("Output `%s`, instance #%d holds X value in "
-                        "Verilog simulator output.",
-                        signal_name, instance_id));
-  }
-  *bits = std::get<Bits>(bits_or_x);
-  return absl::OkStatus();
-}
-
-// Checks all of the captured values of the given signal/instance against the
-// given expectation. `outputs` is index by instance_id as returned by
-// `ExtractSignalValues`.
-static absl::Status CheckCapturedSignalAgainstExpectation(
-    std::string_view signal_name, int64_t instance_id,
-    const TestbenchExpectation& expectation,
-    const absl::flat_hash_map<int64_t, std::vector<BitsOrX>>& outputs) {
-  // The captured signal may appear zero or more times in the output. Check
-  // every instance.
-  if (outputs.contains(instance_id)) {
-    auto get_source_location = [&]() {
-      return absl::StrFormat("%s@%d", expectation.loc.file_name(),
-                             expectation.loc.line());
-    };
-    for (int64_t i = 0; i < outputs.at(instance_id).size(); ++i) {
-      const BitsOrX& bits_or_x = outputs.at(instance_id)[i];
-      std::string instance_name =
-          absl::StrFormat("output `%s`, instance #%d, recurrence %d",
-                          signal_name, instance_id, i);
-      if (std::holds_alternative<Bits>(expectation.expected)) {
-        const Bits& expected_bits = std::get<Bits>(expectation.expected);
-        if (std::holds_alternative<IsX>(bits_or_x)) {
-          return absl::FailedPreconditionError(absl::StrFormat(
-              "%s: expected %s to have value: %v, has X", get_source_location(),
-              instance_name, expected_bits));
-        }
-        const Bits& actual_bits = std::get<Bits>(bits_or_x);
-        if (actual_bits != expected_bits) {
-          return absl::FailedPreconditionError(
-              absl::StrFormat("%s: expected %s to have value: %v, actual: %v",
-                              get_source_location(), instance_name,
-                              expected_bits, actual_bits));
-        }
-      } else {
-        CHECK(std::holds_alternative<IsX>(expectation.expected));
-        if (std::holds_alternative<Bits>(bits_or_x)) {
-          return absl::FailedPreconditionError(absl::StrFormat(
-              "%s: expected %s to have X value, has non X value: %v",
-              get_source_location(), instance_name, std::get<Bits>(bits_or_x)));
-        }
-      }
-    }
-  }
-  return absl::OkStatus();
-}
-
 absl::Status ModuleTestbench::CaptureOutputsAndCheckExpectations(
-    std::string_view stdout_str) const {
+    std::string_view stdout_str, SignalCaptureCollector& collector) const {
   // Check for timeout.
   if (simulation_cycle_limit_.has_value() &&
       absl::StrContains(stdout_str,
@@ -423,37 +274,10 @@ absl::Status ModuleTestbench::CaptureOutputsAndCheckExpectations(
                         simulation_cycle_limit_.value()));
   }
 
-  absl::flat_hash_map<int64_t, std::vector<BitsOrX>> outputs;
-  XLS_ASSIGN_OR_RETURN(outputs, ExtractSignalValues(stdout_str));
-
-  for (const SignalCapture& signal_capture :
-       capture_manager_.signal_captures()) {
-    if (std::holds_alternative<const TestbenchStream*>(signal_capture.action)) {
-      continue;
-    }
-    if (std::holds_alternative<std::vector<Bits>*>(signal_capture.action)) {
-      // Capture multiple instances of the same signal.
-      XLS_RETURN_IF_ERROR(RecordCapturedBitsVector(
-          signal_capture.signal_name, signal_capture.instance_id, outputs,
-          std::get<std::vector<Bits>*>(signal_capture.action)));
-      continue;
-    }
-
-    if (std::holds_alternative<Bits*>(signal_capture.action)) {
-      // Capture a single instance of a signal.
-      XLS_RETURN_IF_ERROR(RecordCapturedBits(
-          signal_capture.signal_name, signal_capture.instance_id, outputs,
-          std::get<Bits*>(signal_capture.action)));
-      continue;
-    }
-
-    // Check the signal value against any expectations.
-    XLS_RET_CHECK(
-        std::holds_alternative<TestbenchExpectation>(signal_capture.action));
-    XLS_RETURN_IF_ERROR(CheckCapturedSignalAgainstExpectation(
-        signal_capture.signal_name, signal_capture.instance_id,
-        std::get<TestbenchExpectation>(signal_capture.action), outputs));
+  if (signal_capture_format_ == SignalCaptureFormat::kDisplay) {
+    XLS_RETURN_IF_ERROR(CollectSignalCapturesFromText(stdout_str, collector));
   }
+  XLS_RETURN_IF_ERROR(collector.Finish());
 
   // Look for the expected trace messages in the simulation output.
   size_t search_pos = 0;
@@ -543,13 +367,14 @@ std::string ModuleTestbench::GenerateVerilog() const {
 
   // Create emitters for emitting Verilog code for handling file I/O. Add any
   // declarations for handling IO to/from streams. And emit code to open files.
+  const std::vector<const TestbenchStream*> all_streams = GetAllStreams();
   absl::flat_hash_map<std::string, VastStreamEmitter> stream_emitters;
-  if (!streams_.empty()) {
+  if (!all_streams.empty()) {
     m->Add<BlankLine>(SourceInfo());
     m->Add<Comment>(SourceInfo(),
                     "Variable declarations for supporting streaming I/O.");
     // Declare variables required for performing IO.
-    for (const std::unique_ptr<TestbenchStream>& stream : streams_) {
+    for (const TestbenchStream* stream : all_streams) {
       stream_emitters.insert(
           {stream->name, VastStreamEmitter::Create(*stream, m)});
     }
@@ -557,12 +382,14 @@ std::string ModuleTestbench::GenerateVerilog() const {
     m->Add<BlankLine>(SourceInfo());
     m->Add<Comment>(SourceInfo(), "Open files for I/O.");
     Initial* initial = m->Add<Initial>(SourceInfo());
-    for (const std::unique_ptr<TestbenchStream>& stream : streams_) {
+    for (const TestbenchStream* stream : all_streams) {
       stream_emitters.at(stream->name).EmitOpen(initial->statements());
     }
   }
 
-  {
+  // The monitor output grows with the length of the simulation so it is
+  // omitted when signal captures are streamed.
+  if (capture_stream_ == nullptr) {
     // Add a monitor statement which prints out all the port values.
     m->Add<BlankLine>(SourceInfo());
     m->Add<Comment>(SourceInfo(), "Monitor for input/output ports.");
@@ -651,7 +478,7 @@ std::string ModuleTestbench::GenerateVerilog() const {
         SourceInfo(), file.PlainLiteral(1, SourceInfo()));
 
     // Close any open files.
-    for (const std::unique_ptr<TestbenchStream>& stream : streams_) {
+    for (const TestbenchStream* stream : all_streams) {
       stream_emitters.at(stream->name).EmitClose(initial->statements());
     }
 
@@ -679,6 +506,12 @@ absl::Status ModuleTestbench::Run() const {
     return absl::InvalidArgumentError(
         "Testbenches with streaming IO should be run with RunWithStreamingIO");
   }
+  if (capture_stream_ != nullptr) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledModuleTestbench> compiled,
+                         CompileWithStreamingIo());
+    return compiled->RunWithStreamingIo(/*input_producers=*/{},
+                                        /*output_consumers=*/{});
+  }
   std::string verilog_text = GenerateVerilog();
   XLS_VLOG_LINES(3, verilog_text);
   std::pair<std::string, std::string> stdout_stderr;
@@ -688,7 +521,8 @@ absl::Status ModuleTestbench::Run() const {
   VLOG(2) << "Verilog simulator stdout:\n" << stdout_stderr.first;
   VLOG(2) << "Verilog simulator stderr:\n" << stdout_stderr.second;
   const std::string& stdout_str = stdout_stderr.first;
-  return CaptureOutputsAndCheckExpectations(stdout_str);
+  SignalCaptureCollector collector(capture_manager_.signal_captures());
+  return CaptureOutputsAndCheckExpectations(stdout_str, collector);
 }
 
 absl::Status ModuleTestbench::RunWithStreamingIo(
@@ -697,9 +531,42 @@ absl::Status ModuleTestbench::RunWithStreamingIo(
     const absl::flat_hash_map<std::string, TestbenchStreamThread::Consumer>&
         output_consumers) const {
   VLOG(1) << "ModuleTestbench::RunWithStreamingIo()";
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledModuleTestbench> compiled,
+                       CompileWithStreamingIo());
+  return compiled->RunWithStreamingIo(input_producers, output_consumers);
+}
+
+absl::StatusOr<std::unique_ptr<CompiledModuleTestbench>>
+ModuleTestbench::CompileWithStreamingIo() const {
+  VLOG(1) << "ModuleTestbench::CompileWithStreamingIo()";
+  std::string verilog_text = GenerateVerilog();
+  XLS_VLOG_LINES(3, verilog_text);
+
+  XLS_ASSIGN_OR_RETURN(TempDirectory stream_dir, TempDirectory::Create());
+  std::vector<VerilogSimulator::MacroDefinition> macro_definitions;
+  for (const TestbenchStream* stream : GetAllStreams()) {
+    macro_definitions.push_back(VerilogSimulator::MacroDefinition{
+        stream->path_macro_name,
+        absl::StrFormat("\"%s\"",
+                        (stream_dir.path() / stream->name).string())});
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledSimulation> simulation,
+                       simulator_->Compile(verilog_text, file_type_,
+                                           macro_definitions, includes_));
+  return absl::WrapUnique(new CompiledModuleTestbench(
+      this, std::move(stream_dir), std::move(simulation)));
+}
+
+absl::Status CompiledModuleTestbench::RunWithStreamingIo(
+    const absl::flat_hash_map<std::string, TestbenchStreamThread::Producer>&
+        input_producers,
+    const absl::flat_hash_map<std::string, TestbenchStreamThread::Consumer>&
+        output_consumers) const {
+  const std::vector<std::unique_ptr<TestbenchStream>>& streams =
+      testbench_->streams_;
 
   // Verify all inputs and output consumer/producers are there.
-  for (const std::unique_ptr<TestbenchStream>& stream : streams_) {
+  for (const std::unique_ptr<TestbenchStream>& stream : streams) {
     if (stream->direction == TestbenchStreamDirection::kInput) {
       if (!input_producers.contains(stream->name)) {
         return absl::InvalidArgumentError(absl::StrFormat(
@@ -712,22 +579,16 @@ absl::Status ModuleTestbench::RunWithStreamingIo(
       }
     }
   }
-  if (input_producers.size() + output_consumers.size() > streams_.size()) {
+  if (input_producers.size() + output_consumers.size() > streams.size()) {
     return absl::InvalidArgumentError(absl::StrFormat(
         "Too many producers/consumers specified (%d). Expected %d.",
-        input_producers.size() + output_consumers.size(), streams_.size()));
+        input_producers.size() + output_consumers.size(), streams.size()));
   }
 
-  std::string verilog_text = GenerateVerilog();
-  XLS_VLOG_LINES(3, verilog_text);
-
-  XLS_ASSIGN_OR_RETURN(TempDirectory temp_dir, TempDirectory::Create());
-  std::vector<VerilogSimulator::MacroDefinition> macro_definitions;
-
   std::vector<TestbenchStreamThread> stream_threads;
-  stream_threads.reserve(streams_.size());
-  for (const std::unique_ptr<TestbenchStream>& stream : streams_) {
-    std::filesystem::path stream_path = temp_dir.path() / stream->name;
+  stream_threads.reserve(streams.size() + 1);
+  for (const std::unique_ptr<TestbenchStream>& stream : streams) {
+    std::filesystem::path stream_path = stream_dir_.path() / stream->name;
     XLS_ASSIGN_OR_RETURN(TestbenchStreamThread thread,
                          TestbenchStreamThread::Create(*stream, stream_path));
     stream_threads.push_back(std::move(thread));
@@ -736,15 +597,23 @@ absl::Status ModuleTestbench::RunWithStreamingIo(
     } else {
       stream_threads.back().RunOutputStream(output_consumers.at(stream->name));
     }
-    macro_definitions.push_back(VerilogSimulator::MacroDefinition{
-        stream->path_macro_name,
-        absl::StrFormat("\"%s\"", stream_path.string())});
+  }
+  SignalCaptureCollector collector(
+      testbench_->capture_manager_.signal_captures());
+  if (testbench_->capture_stream_ != nullptr) {
+    const TestbenchStream& stream = *testbench_->capture_stream_;
+    std::filesystem::path stream_path = stream_dir_.path() / stream.name;
+    XLS_ASSIGN_OR_RETURN(TestbenchStreamThread thread,
+                         TestbenchStreamThread::Create(stream, stream_path));
+    stream_threads.push_back(std::move(thread));
+    stream_threads.back().RunOutputFileStream([&](FILE* file) {
+      return CollectSignalCapturesFromFile(
+          file, testbench_->signal_capture_format_, collector);
+    });
   }
   VLOG(1) << "Starting simulation.";
   std::pair<std::string, std::string> stdout_stderr;
-  XLS_ASSIGN_OR_RETURN(
-      stdout_stderr,
-      simulator_->Run(verilog_text, file_type_, macro_definitions, includes_));
+  XLS_ASSIGN_OR_RETURN(stdout_stderr, simulation_->Run());
 
   VLOG(1) << "Simulation done.";
 
@@ -756,7 +625,7 @@ absl::Status ModuleTestbench::RunWithStreamingIo(
   VLOG(2) << "Verilog simulator stderr:\n" << stdout_stderr.second;
 
   const std::string& stdout_str = stdout_stderr.first;
-  return CaptureOutputsAndCheckExpectations(stdout_str);
+  return testbench_->CaptureOutputsAndCheckExpectations(stdout_str, collector);
 }
 
 static std::string GetPipePathMacroName(std::string_view stream_name) {
@@ -793,5 +662,42 @@ absl::StatusOr<const TestbenchStream*> ModuleTestbench::CreateOutputStream(
   return streams_.back().get();
 }
 
+std::vector<const TestbenchStream*> ModuleTestbench::GetAllStreams() const {
+  std::vector<const TestbenchStream*> streams;
+  for (const std::unique_ptr<TestbenchStream>& stream : streams_) {
+    streams.push_back(stream.get());
+  }
+  if (capture_stream_ != nullptr) {
+    streams.push_back(capture_stream_.get());
+  }
+  return streams;
+}
+
+absl::Status ModuleTestbench::SetSignalCaptureFormat(
+    SignalCaptureFormat format) {
+  signal_capture_format_ = format;
+  if (format == SignalCaptureFormat::kDisplay) {
+    if (capture_stream_ != nullptr) {
+      stream_names_.erase(capture_stream_->name);
+      capture_stream_.reset();
+    }
+    return absl::OkStatus();
+  }
+  if (capture_stream_ == nullptr) {
+    if (stream_names_.contains(kSignalCaptureStreamName)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Already a I/O stream named `%s`", kSignalCaptureStreamName));
+    }
+    stream_names_.insert(std::string{kSignalCaptureStreamName});
+    capture_stream_ = absl::WrapUnique(new TestbenchStream{
+        .name = std::string{kSignalCaptureStreamName},
+        .direction = TestbenchStreamDirection::kOutput,
+        .path_macro_name = GetPipePathMacroName(kSignalCaptureStreamName),
+        .width = 0});
+  }
+  capture_stream_->binary = format == SignalCaptureFormat::kPipeBinary;
+  return absl::OkStatus();
+}
+
 }  // namespace verilog
 }  // namespace xls
@@ -21,6 +21,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -30,6 +31,7 @@
 #include "absl/types/span.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/vast.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/simulation/module_testbench_thread.h"
 #include "xls/simulation/testbench_metadata.h"
 #include "xls/simulation/testbench_signal_capture.h"
@@ -47,6 +49,41 @@ static constexpr int64_t kDefaultSimulationCycleLimit = 10'000;
 
 enum class ZeroOrX : int8_t { kZero, kX };
 
+class ModuleTestbench;
+
+// A testbench with streaming IO which has been compiled by the simulator. It
+// can be run any number of times with different data streamed through it, and
+// (for simulators with a separate compilation step) each run only pays for the
+// simulation itself. Created by ModuleTestbench::CompileWithStreamingIo; the
+// ModuleTestbench must outlive this object.
+class CompiledModuleTestbench {
+ public:
+  // Runs the simulation. Arguments are as for
+  // ModuleTestbench::RunWithStreamingIo.
+  absl::Status RunWithStreamingIo(
+      const absl::flat_hash_map<std::string, TestbenchStreamThread::Producer>&
+          input_producers,
+      const absl::flat_hash_map<std::string, TestbenchStreamThread::Consumer>&
+          output_consumers) const;
+
+ private:
+  friend class ModuleTestbench;
+
+  CompiledModuleTestbench(const ModuleTestbench* testbench,
+                          TempDirectory stream_dir,
+                          std::unique_ptr<CompiledSimulation> simulation)
+      : testbench_(testbench),
+        stream_dir_(std::move(stream_dir)),
+        simulation_(std::move(simulation)) {}
+
+  const ModuleTestbench* testbench_;
+
+  // The directory holding the named pipes underlying the streams. The pipe
+  // paths are compiled into the simulation so they are the same for each run.
+  TempDirectory stream_dir_;
+  std::unique_ptr<CompiledSimulation> simulation_;
+};
+
 // Test class which does a cycle-by-cycle simulation of a Verilog module.
 class ModuleTestbench {
  public:
@@ -129,6 +166,12 @@ class ModuleTestbench {
       const absl::flat_hash_map<std::string, TestbenchStreamThread::Consumer>&
           output_consumers) const;
 
+  // Compiles the testbench for running repeatedly with streaming IO. This is
+  // much cheaper than calling RunWithStreamingIo for each run when the
+  // testbench is to be run many times.
+  absl::StatusOr<std::unique_ptr<CompiledModuleTestbench>>
+  CompileWithStreamingIo() const;
+
   // Allocate streams for reading and writing values to the testbench. The
   // returned pointer can be passed to SequentialBlock::ReadFromStreamAndSet or
   // EndOfCycleEvent::CaptureAndWriteToStream to connect into the simulation.
@@ -137,7 +180,17 @@ class ModuleTestbench {
   absl::StatusOr<const TestbenchStream*> CreateOutputStream(
       std::string_view name, int64_t width);
 
+  // Sets how captured signal values are communicated from the simulator. By
+  // default they are $display-ed on stdout and parsed once the simulation
+  // completes. The pipe formats instead parse values as the simulation runs so
+  // memory use does not grow with the length of the simulation; with these the
+  // $monitor of the ports is also omitted from stdout. The pipe formats reserve
+  // the stream name kSignalCaptureStreamName.
+  absl::Status SetSignalCaptureFormat(SignalCaptureFormat format);
+
  private:
+  friend class CompiledModuleTestbench;
+
   ModuleTestbench(std::string_view verilog_text, FileType file_type,
                   const VerilogSimulator* simulator,
                   const TestbenchMetadata& metadata, bool reset_dut,
@@ -152,9 +205,14 @@ class ModuleTestbench {
       std::string_view thread_name, absl::Span<const DutInput> dut_inputs,
       bool wait_until_done, bool wait_for_reset);
 
-  // Checks the stdout of a simulation run against expectations.
+  // Checks the stdout of a simulation run and the signal captures observed by
+  // `collector` against expectations.
   absl::Status CaptureOutputsAndCheckExpectations(
-      std::string_view stdout_str) const;
+      std::string_view stdout_str, SignalCaptureCollector& collector) const;
+
+  // Returns the streams of the testbench including the stream of signal
+  // captures (if any).
+  std::vector<const TestbenchStream*> GetAllStreams() const;
 
   std::vector<std::string> GatherExpectedTraces() const;
 
@@ -186,6 +244,12 @@ class ModuleTestbench {
 
   // The set of names of all streams.
   absl::flat_hash_set<std::string> stream_names_;
+
+  SignalCaptureFormat signal_capture_format_ = SignalCaptureFormat::kDisplay;
+
+  // The stream signal captures are written to for the pipe formats of
+  // SignalCaptureFormat.
+  std::unique_ptr<TestbenchStream> capture_stream_;
 };
 
 }  // namespace verilog
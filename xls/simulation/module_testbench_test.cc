@@ -1191,6 +1191,92 @@ TEST_P(ModuleTestbenchTest, StreamingIoMultipleInputOutput) {
   XLS_ASSERT_OK(tb->RunWithStreamingIo(producer_map, consumer_map));
 }
 
+TEST_P(ModuleTestbenchTest, SignalCapturesThroughPipe) {
+  for (SignalCaptureFormat format :
+       {SignalCaptureFormat::kPipeText, SignalCaptureFormat::kPipeBinary}) {
+    VerilogFile f = NewVerilogFile();
+    // Use a width which spans more than one 32-bit word of the binary format.
+    Module* m = MakeTwoStageIdentityPipeline(&f, /*width=*/80);
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<ModuleTestbench> tb,
+        ModuleTestbench::CreateFromVastModule(m, GetSimulator(), "clk"));
+    XLS_ASSERT_OK(tb->SetSignalCaptureFormat(format));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        ModuleTestbenchThread * tbt,
+        tb->CreateThread("input driver",
+                         /*dut_inputs=*/{DutInput{.port_name = "in",
+                                                  .initial_value = IsX()}}));
+    const Bits wide = bits_ops::Concat({UBits(0xabcd, 16), UBits(42, 64)});
+    Bits captured;
+    std::vector<Bits> repeated;
+    SequentialBlock& seq = tbt->MainBlock();
+    seq.Set("in", wide);
+    seq.NextCycle().SetX("in");
+    seq.AtEndOfCycle().ExpectX("out");
+    seq.AtEndOfCycle().ExpectEq("out", wide).Capture("out", &captured);
+    seq.Set("in", 1234);
+    seq.AdvanceNCycles(3);
+    SequentialBlock& loop = seq.Repeat(3);
+    loop.AtEndOfCycle().CaptureMultiple("out", &repeated);
+
+    XLS_ASSERT_OK(tb->Run());
+    EXPECT_EQ(captured, wide);
+    EXPECT_THAT(repeated, ElementsAre(UBits(1234, 80), UBits(1234, 80),
+                                      UBits(1234, 80)));
+  }
+}
+
+TEST_P(ModuleTestbenchTest, SignalCapturesThroughPipeWithFailure) {
+  for (SignalCaptureFormat format :
+       {SignalCaptureFormat::kPipeText, SignalCaptureFormat::kPipeBinary}) {
+    VerilogFile f = NewVerilogFile();
+    Module* m = MakeTwoStageIdentityPipeline(&f);
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<ModuleTestbench> tb,
+        ModuleTestbench::CreateFromVastModule(m, GetSimulator(), "clk"));
+    XLS_ASSERT_OK(tb->SetSignalCaptureFormat(format));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        ModuleTestbenchThread * tbt,
+        tb->CreateThread("input driver",
+                         /*dut_inputs=*/{DutInput{.port_name = "in",
+                                                  .initial_value = IsX()}}));
+    Bits captured;
+    SequentialBlock& seq = tbt->MainBlock();
+    seq.Set("in", 42);
+    seq.NextCycle().Set("in", 1234);
+    seq.AtEndOfCycle().ExpectX("out");
+    seq.AtEndOfCycle().ExpectEq("out", 42);
+    seq.SetX("in");
+    seq.AtEndOfCycle().ExpectEq("out", 7);
+    seq.NextCycle();
+    seq.AtEndOfCycle().Capture("out", &captured);
+
+    EXPECT_THAT(
+        tb->Run(),
+        StatusIs(absl::StatusCode::kFailedPrecondition,
+                 ContainsRegex("module_testbench_test.cc@[0-9]+: expected "
+                               "output `out`, instance #2, recurrence 0 to "
+                               "have value: 7, actual: 1234")));
+  }
+}
+
+TEST_P(ModuleTestbenchTest, SignalCaptureStreamNameIsReserved) {
+  VerilogFile f = NewVerilogFile();
+  Module* m = MakeTwoStageIdentityPipeline(&f);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ModuleTestbench> tb,
+      ModuleTestbench::CreateFromVastModule(m, GetSimulator(), "clk"));
+  XLS_ASSERT_OK(tb->SetSignalCaptureFormat(SignalCaptureFormat::kPipeBinary));
+  EXPECT_THAT(tb->CreateOutputStream(kSignalCaptureStreamName, 16),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Already a I/O stream named")));
+  XLS_ASSERT_OK(tb->SetSignalCaptureFormat(SignalCaptureFormat::kDisplay));
+  XLS_ASSERT_OK(tb->CreateOutputStream(kSignalCaptureStreamName, 16).status());
+  EXPECT_THAT(tb->SetSignalCaptureFormat(SignalCaptureFormat::kPipeText),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Already a I/O stream named")));
+}
+
 INSTANTIATE_TEST_SUITE_P(ModuleTestbenchTestInstantiation, ModuleTestbenchTest,
                          testing::ValuesIn(kDefaultSimulationTargets),
                          ParameterizedTestName<ModuleTestbenchTest>);
@@ -87,6 +87,9 @@ void EmitSignalCaptures(
     const absl::flat_hash_map<std::string, LogicRef*>& signal_refs,
     const absl::flat_hash_map<std::string, VastStreamEmitter>&
         stream_emitters) {
+  // Captures are written to a dedicated stream rather than $display-ed if the
+  // testbench has one (see SignalCaptureFormat).
+  auto capture_emitter = stream_emitters.find(kSignalCaptureStreamName);
   for (const SignalCapture& signal_capture : signal_captures) {
     if (std::holds_alternative<const TestbenchStream*>(signal_capture.action)) {
       const TestbenchStream* stream =
@@ -97,6 +100,15 @@ void EmitSignalCaptures(
                      signal_refs.at(signal_capture.signal_name));
       continue;
     }
+    if (capture_emitter != stream_emitters.end()) {
+      capture_emitter->second.EmitWriteSignalCapture(
+          statement_block, signal_capture.signal_name,
+          signal_capture.signal_width, signal_capture.instance_id,
+          signal_capture.signal_width == 0
+              ? nullptr
+              : signal_refs.at(signal_capture.signal_name));
+      continue;
+    }
     if (signal_capture.signal_width == 0) {
       // Zero-width signals are not actually represented in the Verilog though
       // they may appear in the module signature. Call $display to print a
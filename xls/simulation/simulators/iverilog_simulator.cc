@@ -90,8 +90,49 @@ void AppendMacroDefinitionsToArgs(
   }
 }
 
+// A testbench compiled by iverilog; each run only invokes vvp.
+class IcarusCompiledSimulation : public CompiledSimulation {
+ public:
+  IcarusCompiledSimulation(TempDirectory temp_dir,
+                           std::filesystem::path compiled_path)
+      : temp_dir_(std::move(temp_dir)),
+        compiled_path_(std::move(compiled_path)) {}
+
+  absl::StatusOr<std::pair<std::string, std::string>> Run() const override {
+    return InvokeVvp({compiled_path_.string()});
+  }
+
+ private:
+  TempDirectory temp_dir_;
+  std::filesystem::path compiled_path_;
+};
+
 class IcarusVerilogSimulator : public VerilogSimulator {
  public:
+  absl::StatusOr<std::unique_ptr<CompiledSimulation>> Compile(
+      std::string_view text, FileType file_type,
+      absl::Span<const MacroDefinition> macro_definitions,
+      absl::Span<const VerilogInclude> includes) const override {
+    if (file_type == FileType::kSystemVerilog) {
+      return absl::UnimplementedError(
+          "iverilog does not support SystemVerilog");
+    }
+    XLS_ASSIGN_OR_RETURN(TempDirectory temp_top, TempDirectory::Create());
+    std::filesystem::path temp_dir = temp_top.path();
+
+    std::string top_v_path = temp_dir / GetTopFileName(file_type);
+    XLS_RETURN_IF_ERROR(SetFileContents(top_v_path, text));
+    XLS_RETURN_IF_ERROR(SetUpIncludes(temp_dir, includes));
+
+    std::filesystem::path compiled_path = temp_dir / "top.out";
+    std::vector<std::string> args = {top_v_path, "-o", compiled_path.string(),
+                                     "-I", temp_dir.string()};
+    AppendMacroDefinitionsToArgs(macro_definitions, args);
+    XLS_RETURN_IF_ERROR(InvokeIverilog(args).status());
+    return std::make_unique<IcarusCompiledSimulation>(std::move(temp_top),
+                                                      compiled_path);
+  }
+
   absl::StatusOr<std::pair<std::string, std::string>> Run(
       std::string_view text, FileType file_type,
       absl::Span<const MacroDefinition> macro_definitions,
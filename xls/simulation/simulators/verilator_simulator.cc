@@ -0,0 +1,273 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Verilog simulator which uses Verilator to compile the testbench and the
+// module under test into a native executable. Compilation is comparatively
+// expensive but the resulting executable runs much faster than an
+// interpreter-style simulator, and compiled executables are cached by the
+// contents of their sources so identical simulations are only compiled once
+// per process.
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/codegen/vast.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/module_initializer.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/subprocess.h"
+#include "xls/simulation/verilog_simulator.h"
+#include "xls/tools/verilog_include.h"
+
+ABSL_FLAG(std::string, verilator_path, "verilator",
+          "Path to the verilator binary used by the \"verilator\" Verilog "
+          "simulator. If not an absolute path, PATH is searched.");
+ABSL_FLAG(int64_t, verilator_cache_size, 8,
+          "Maximum number of builds the \"verilator\" Verilog simulator keeps "
+          "for reuse by later simulations of the same sources. Each build is "
+          "a directory on disk which is deleted once it is evicted and no "
+          "longer in use.");
+
+namespace xls {
+namespace verilog {
+namespace {
+
+absl::Status SetUpIncludes(const std::filesystem::path& temp_dir,
+                           absl::Span<const VerilogInclude> includes) {
+  for (const VerilogInclude& include : includes) {
+    std::filesystem::path path = temp_dir / include.relative_path;
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(path.parent_path()));
+    XLS_RETURN_IF_ERROR(SetFileContents(path, include.verilog_text));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::pair<std::string, std::string>> InvokeVerilator(
+    absl::Span<const std::string> args) {
+  std::vector<std::string> args_vec = {absl::GetFlag(FLAGS_verilator_path)};
+  args_vec.insert(args_vec.end(), args.begin(), args.end());
+  return SubprocessResultToStrings(
+      SubprocessErrorAsStatus(InvokeSubprocess(args_vec)));
+}
+
+// Returns the arguments common to compilation and syntax checking.
+std::vector<std::string> VerilatorArgs(
+    const std::filesystem::path& temp_dir, const std::string& top_v_path,
+    absl::Span<const VerilogSimulator::MacroDefinition> macro_definitions) {
+  std::vector<std::string> args = {
+      top_v_path,
+      absl::StrCat("-I", temp_dir.string()),
+      // Testbenches rely on delays and event controls.
+      "--timing",
+      "--assert",
+      // Generated code and testbenches are not lint clean by Verilator's
+      // standards; only report errors.
+      "-Wno-fatal",
+      "-Wno-lint",
+      "-Wno-style",
+  };
+  for (const VerilogSimulator::MacroDefinition& macro : macro_definitions) {
+    if (macro.value.has_value()) {
+      args.push_back(absl::StrFormat("-D%s=%s", macro.name, *macro.value));
+    } else {
+      args.push_back(absl::StrFormat("-D%s", macro.name));
+    }
+  }
+  return args;
+}
+
+// A native executable built by Verilator along with the directory holding it.
+struct VerilatedExecutable {
+  TempDirectory temp_dir;
+  std::filesystem::path path;
+};
+
+class VerilatorCompiledSimulation : public CompiledSimulation {
+ public:
+  explicit VerilatorCompiledSimulation(
+      std::shared_ptr<const VerilatedExecutable> executable)
+      : executable_(std::move(executable)) {}
+
+  absl::StatusOr<std::pair<std::string, std::string>> Run() const override {
+    return SubprocessResultToStrings(SubprocessErrorAsStatus(
+        InvokeSubprocess({executable_->path.string()})));
+  }
+
+ private:
+  std::shared_ptr<const VerilatedExecutable> executable_;
+};
+
+class VerilatorSimulator : public VerilogSimulator {
+ public:
+  absl::StatusOr<std::unique_ptr<CompiledSimulation>> Compile(
+      std::string_view text, FileType file_type,
+      absl::Span<const MacroDefinition> macro_definitions,
+      absl::Span<const VerilogInclude> includes) const override {
+    XLS_ASSIGN_OR_RETURN(
+        std::shared_ptr<const VerilatedExecutable> executable,
+        GetOrBuildExecutable(text, file_type, macro_definitions, includes));
+    return std::make_unique<VerilatorCompiledSimulation>(
+        std::move(executable));
+  }
+
+  absl::StatusOr<std::pair<std::string, std::string>> Run(
+      std::string_view text, FileType file_type,
+      absl::Span<const MacroDefinition> macro_definitions,
+      absl::Span<const VerilogInclude> includes) const override {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<CompiledSimulation> compiled,
+        Compile(text, file_type, macro_definitions, includes));
+    return compiled->Run();
+  }
+
+  absl::Status RunSyntaxChecking(
+      std::string_view text, FileType file_type,
+      absl::Span<const MacroDefinition> macro_definitions,
+      absl::Span<const VerilogInclude> includes) const override {
+    XLS_ASSIGN_OR_RETURN(TempDirectory temp_top, TempDirectory::Create());
+    std::filesystem::path temp_dir = temp_top.path();
+
+    std::string top_v_path = temp_dir / GetTopFileName(file_type);
+    XLS_RETURN_IF_ERROR(SetFileContents(top_v_path, text));
+    XLS_RETURN_IF_ERROR(SetUpIncludes(temp_dir, includes));
+
+    std::vector<std::string> args =
+        VerilatorArgs(temp_dir, top_v_path, macro_definitions);
+    args.push_back("--lint-only");
+    return InvokeVerilator(args).status();
+  }
+
+  bool DoesSupportSystemVerilog() const override { return true; }
+  bool DoesSupportAssertions() const override { return true; }
+
+ private:
+  // Returns a key uniquely identifying the sources of a simulation.
+  static std::string CacheKey(
+      std::string_view text, FileType file_type,
+      absl::Span<const MacroDefinition> macro_definitions,
+      absl::Span<const VerilogInclude> includes) {
+    // Length-prefix each component so distinct inputs can't collide.
+    std::string key;
+    auto append = [&](std::string_view s) {
+      absl::StrAppend(&key, s.size(), ":", s);
+    };
+    append(file_type == FileType::kSystemVerilog ? "sv" : "v");
+    append(text);
+    for (const MacroDefinition& macro : macro_definitions) {
+      append(macro.name);
+      append(macro.value.has_value() ? absl::StrCat("=", *macro.value) : "");
+    }
+    for (const VerilogInclude& include : includes) {
+      append(include.relative_path);
+      append(include.verilog_text);
+    }
+    return key;
+  }
+
+  absl::StatusOr<std::shared_ptr<const VerilatedExecutable>>
+  GetOrBuildExecutable(std::string_view text, FileType file_type,
+                       absl::Span<const MacroDefinition> macro_definitions,
+                       absl::Span<const VerilogInclude> includes) const {
+    std::string key =
+        CacheKey(text, file_type, macro_definitions, includes);
+    {
+      absl::MutexLock lock(&mutex_);
+      auto it = cache_.find(key);
+      if (it != cache_.end()) {
+        recency_.splice(recency_.begin(), recency_, it->second.recency);
+        return it->second.executable;
+      }
+    }
+
+    // Build outside of the lock so that distinct simulations can be compiled
+    // concurrently. If the same simulation is compiled concurrently the first
+    // result to be inserted wins.
+    XLS_ASSIGN_OR_RETURN(TempDirectory temp_top, TempDirectory::Create());
+    std::filesystem::path temp_dir = temp_top.path();
+
+    std::string top_v_path = temp_dir / GetTopFileName(file_type);
+    XLS_RETURN_IF_ERROR(SetFileContents(top_v_path, text));
+    XLS_RETURN_IF_ERROR(SetUpIncludes(temp_dir, includes));
+
+    std::filesystem::path obj_dir = temp_dir / "obj_dir";
+    std::vector<std::string> args =
+        VerilatorArgs(temp_dir, top_v_path, macro_definitions);
+    args.insert(args.end(),
+                {"--binary", "--Mdir", obj_dir.string(), "-o", "top", "-j",
+                 absl::StrCat(std::thread::hardware_concurrency())});
+    XLS_RETURN_IF_ERROR(InvokeVerilator(args).status());
+
+    auto executable = std::make_shared<const VerilatedExecutable>(
+        VerilatedExecutable{.temp_dir = std::move(temp_top),
+                            .path = obj_dir / "top"});
+    absl::MutexLock lock(&mutex_);
+    auto [it, inserted] = cache_.try_emplace(key);
+    if (inserted) {
+      recency_.push_front(key);
+      it->second = CacheEntry{.executable = std::move(executable),
+                              .recency = recency_.begin()};
+    }
+    std::shared_ptr<const VerilatedExecutable> result = it->second.executable;
+    // Evicted executables are deleted once the simulations using them are.
+    int64_t capacity =
+        std::max<int64_t>(absl::GetFlag(FLAGS_verilator_cache_size), 0);
+    while (static_cast<int64_t>(cache_.size()) > capacity) {
+      cache_.erase(recency_.back());
+      recency_.pop_back();
+    }
+    return result;
+  }
+
+  struct CacheEntry {
+    std::shared_ptr<const VerilatedExecutable> executable;
+    // Position of the entry's key in `recency_`.
+    std::list<std::string>::iterator recency;
+  };
+
+  mutable absl::Mutex mutex_;
+  // Executables by CacheKey, bounded by --verilator_cache_size. The least
+  // recently used executable is evicted first.
+  mutable absl::flat_hash_map<std::string, CacheEntry> cache_
+      ABSL_GUARDED_BY(mutex_);
+  // Keys of `cache_`, most recently used first.
+  mutable std::list<std::string> recency_ ABSL_GUARDED_BY(mutex_);
+};
+
+XLS_REGISTER_MODULE_INITIALIZER(verilator_simulator, {
+  CHECK_OK(GetVerilogSimulatorManagerSingleton().RegisterVerilogSimulator(
+      "verilator", std::make_unique<VerilatorSimulator>()));
+});
+
+}  // namespace
+}  // namespace verilog
+}  // namespace xls
@@ -0,0 +1,135 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/subprocess.h"
+#include "xls/simulation/verilog_simulator.h"
+
+ABSL_DECLARE_FLAG(std::string, verilator_path);
+ABSL_DECLARE_FLAG(int64_t, verilator_cache_size);
+
+namespace xls {
+namespace verilog {
+namespace {
+
+using ::testing::HasSubstr;
+
+// Runs simulations through a wrapper around verilator which counts how often
+// it is invoked, i.e. how many builds are made.
+class VerilatorSimulatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    saved_path_ = absl::GetFlag(FLAGS_verilator_path);
+    saved_cache_size_ = absl::GetFlag(FLAGS_verilator_cache_size);
+    absl::StatusOr<SubprocessResult> version =
+        InvokeSubprocess({saved_path_, "--version"});
+    if (!version.ok() || !version->normal_termination ||
+        version->exit_status != 0) {
+      GTEST_SKIP() << "verilator is not available";
+    }
+
+    XLS_ASSERT_OK_AND_ASSIGN(temp_dir_, TempDirectory::Create());
+    count_path_ = temp_dir_->path() / "invocations";
+    std::filesystem::path wrapper = temp_dir_->path() / "verilator";
+    XLS_ASSERT_OK(SetFileContents(
+        wrapper, absl::StrFormat("#!/bin/sh\necho >> '%s'\nexec '%s' \"$@\"\n",
+                                 count_path_.string(), saved_path_)));
+    std::filesystem::permissions(wrapper,
+                                 std::filesystem::perms::owner_exec,
+                                 std::filesystem::perm_options::add);
+    absl::SetFlag(&FLAGS_verilator_path, wrapper.string());
+
+    XLS_ASSERT_OK_AND_ASSIGN(
+        simulator_,
+        GetVerilogSimulatorManagerSingleton().GetVerilogSimulator("verilator"));
+  }
+
+  void TearDown() override {
+    absl::SetFlag(&FLAGS_verilator_path, saved_path_);
+    absl::SetFlag(&FLAGS_verilator_cache_size, saved_cache_size_);
+  }
+
+  // Returns a testbench printing `message`. The simulator's cache lives as
+  // long as the process, so messages must be unique to each test.
+  static std::string Testbench(std::string_view message) {
+    return absl::StrFormat(R"(module tb;
+  initial begin
+    $display("%s");
+    $finish;
+  end
+endmodule
+)",
+                           message);
+  }
+
+  void ExpectRunPrints(std::string_view message) {
+    absl::StatusOr<std::pair<std::string, std::string>> output =
+        simulator_->Run(Testbench(message), FileType::kVerilog);
+    XLS_ASSERT_OK(output.status());
+    EXPECT_THAT(output->first, HasSubstr(message));
+  }
+
+  int64_t BuildCount() {
+    if (!std::filesystem::exists(count_path_)) {
+      return 0;
+    }
+    std::string contents = GetFileContents(count_path_).value();
+    return std::count(contents.begin(), contents.end(), '\n');
+  }
+
+  std::string saved_path_;
+  int64_t saved_cache_size_;
+  std::optional<TempDirectory> temp_dir_;
+  std::filesystem::path count_path_;
+  VerilogSimulator* simulator_ = nullptr;
+};
+
+TEST_F(VerilatorSimulatorTest, SecondRunReusesBuild) {
+  ExpectRunPrints("reuse");
+  EXPECT_EQ(BuildCount(), 1);
+  ExpectRunPrints("reuse");
+  EXPECT_EQ(BuildCount(), 1);
+}
+
+TEST_F(VerilatorSimulatorTest, LeastRecentlyUsedBuildIsEvicted) {
+  absl::SetFlag(&FLAGS_verilator_cache_size, 1);
+  ExpectRunPrints("evict a");
+  ExpectRunPrints("evict b");
+  EXPECT_EQ(BuildCount(), 2);
+  // Building "b" evicted "a".
+  ExpectRunPrints("evict a");
+  EXPECT_EQ(BuildCount(), 3);
+  ExpectRunPrints("evict a");
+  EXPECT_EQ(BuildCount(), 3);
+}
+
+}  // namespace
+}  // namespace verilog
+}  // namespace xls
@@ -15,17 +15,305 @@
 #include "xls/simulation/testbench_signal_capture.h"
 
 #include <cstdint>
+#include <cstdio>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/math_util.h"
 #include "xls/common/source_location.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/number_parser.h"
 #include "xls/simulation/testbench_stream.h"
+#include "re2/re2.h"
 
 namespace xls {
 namespace verilog {
+namespace {
+
+// Regular expression matching the text emitted for a signal capture. Example
+// output lines for a bits value:
+//
+//   5 OUTPUT out0 = 16'h12ab (#1)
+//
+// And a value with one or more X's:
+//
+//   5 OUTPUT out0 = 16'hxxab (#1)
+const RE2& SignalCaptureRegex() {
+  static const RE2* re = new RE2(
+      R"(\s+[0-9]+\s+OUTPUT\s(\w+)\s+=\s+([0-9]+)'h([0-9a-fA-FxX]+)\s+\(#([0-9]+)\))");
+  return *re;
+}
+
+// Observes the value of a signal capture matched by SignalCaptureRegex.
+absl::Status ObserveMatchedSignalCapture(std::string_view output_name,
+                                         std::string_view output_width,
+                                         std::string_view output_value,
+                                         std::string_view instance_str,
+                                         SignalCaptureCollector& collector) {
+  int64_t width;
+  XLS_RET_CHECK(absl::SimpleAtoi(output_width, &width));
+  int64_t instance;
+  XLS_RET_CHECK(absl::SimpleAtoi(instance_str, &instance));
+
+  VLOG(1) << absl::StreamFormat(
+      "Found output `%s` width %d value %s instance #%d", output_name, width,
+      output_value, instance);
+
+  if (absl::StrContains(output_value, "x") ||
+      absl::StrContains(output_value, "X")) {
+    return collector.Observe(instance, IsX());
+  }
+  XLS_ASSIGN_OR_RETURN(Bits value, ParseUnsignedNumberWithoutPrefix(
+                                       output_value, FormatPreference::kHex));
+  XLS_RET_CHECK_GE(width, value.bit_count());
+  return collector.Observe(instance, bits_ops::ZeroExtend(value, width));
+}
+
+absl::Status CollectSignalCapturesFromTextFile(
+    FILE* file, SignalCaptureCollector& collector) {
+  std::string line;
+  int c;
+  while ((c = fgetc(file)) != EOF) {
+    if (static_cast<char>(c) != '\n') {
+      line += static_cast<char>(c);
+      continue;
+    }
+    std::string output_name;
+    std::string output_width;
+    std::string output_value;
+    std::string instance_str;
+    if (!RE2::PartialMatch(line, SignalCaptureRegex(), &output_name,
+                           &output_width, &output_value, &instance_str)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Unable to parse signal capture from simulator: %s", line));
+    }
+    XLS_RETURN_IF_ERROR(ObserveMatchedSignalCapture(
+        output_name, output_width, output_value, instance_str, collector));
+    line.clear();
+  }
+  if (ferror(file)) {
+    return absl::InternalError("Error reading signal captures from simulator");
+  }
+  if (!line.empty()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Truncated signal capture from simulator: %s", line));
+  }
+  return absl::OkStatus();
+}
+
+// Reads the records written by `$fwrite(fd, "%u%z", id, value)`: the instance
+// id as a 32-bit word followed by, for each 32-bit chunk of the value (least
+// significant chunk first), a pair of 32-bit words holding the aval and bval
+// bits of the four-state encoding. A set bval bit indicates an X or Z bit.
+// Words are in the byte order of the host running the simulation.
+absl::Status CollectSignalCapturesFromBinaryFile(
+    FILE* file, SignalCaptureCollector& collector) {
+  std::vector<uint32_t> words;
+  while (true) {
+    uint32_t instance;
+    if (fread(&instance, sizeof(instance), 1, file) != 1) {
+      if (ferror(file)) {
+        return absl::InternalError(
+            "Error reading signal captures from simulator");
+      }
+      return absl::OkStatus();
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t width, collector.GetSignalWidth(instance));
+    if (width == 0) {
+      XLS_RETURN_IF_ERROR(collector.Observe(instance, Bits()));
+      continue;
+    }
+    const int64_t chunk_count = CeilOfRatio<int64_t>(width, 32);
+    words.resize(2 * chunk_count);
+    if (fread(words.data(), sizeof(uint32_t), words.size(), file) !=
+        words.size()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Truncated value of signal capture instance #%d from simulator",
+          instance));
+    }
+    InlineBitmap aval(width);
+    InlineBitmap bval(width);
+    for (int64_t i = 0; i < chunk_count; i += 2) {
+      uint64_t aval_word = words[2 * i];
+      uint64_t bval_word = words[2 * i + 1];
+      if (i + 1 < chunk_count) {
+        aval_word |= uint64_t{words[2 * i + 2]} << 32;
+        bval_word |= uint64_t{words[2 * i + 3]} << 32;
+      }
+      aval.SetWord(i / 2, aval_word);
+      bval.SetWord(i / 2, bval_word);
+    }
+    if (!bval.IsAllZeroes()) {
+      XLS_RETURN_IF_ERROR(collector.Observe(instance, IsX()));
+    } else {
+      XLS_RETURN_IF_ERROR(
+          collector.Observe(instance, Bits::FromBitmap(std::move(aval))));
+    }
+  }
+}
+
+}  // namespace
+
+SignalCaptureCollector::SignalCaptureCollector(
+    absl::Span<const SignalCapture> signal_captures) {
+  for (const SignalCapture& signal_capture : signal_captures) {
+    if (signal_capture.instance_id >= states_.size()) {
+      states_.resize(signal_capture.instance_id + 1);
+    }
+    states_[signal_capture.instance_id].capture = &signal_capture;
+    if (std::holds_alternative<std::vector<Bits>*>(signal_capture.action)) {
+      std::get<std::vector<Bits>*>(signal_capture.action)->clear();
+    }
+  }
+}
+
+absl::StatusOr<int64_t> SignalCaptureCollector::GetSignalWidth(
+    int64_t instance_id) const {
+  XLS_RET_CHECK(instance_id >= 0 && instance_id < states_.size() &&
+                states_[instance_id].capture != nullptr)
+      << "Unknown signal capture instance #" << instance_id;
+  return states_[instance_id].capture->signal_width;
+}
+
+absl::Status SignalCaptureCollector::Observe(int64_t instance_id,
+                                             BitsOrX value) {
+  XLS_RET_CHECK(instance_id >= 0 && instance_id < states_.size() &&
+                states_[instance_id].capture != nullptr)
+      << "Unknown signal capture instance #" << instance_id;
+  CaptureState& state = states_[instance_id];
+  const int64_t recurrence = state.count++;
+  if (!state.status.ok()) {
+    return absl::OkStatus();
+  }
+  const SignalCapture& capture = *state.capture;
+  if (std::holds_alternative<const TestbenchStream*>(capture.action)) {
+    // Values of captures written to streams are consumed by the stream.
+    return absl::OkStatus();
+  }
+  if (std::holds_alternative<std::vector<Bits>*>(capture.action)) {
+    // Capture multiple instances of the same signal.
+    if (std::holds_alternative<IsX>(value)) {
+      state.status = absl::NotFoundError(absl::StrFormat(
+          "Output `%s`, instance #%d, recurrence %d holds X value in "
+          "Verilog simulator output.",
+          capture.signal_name, instance_id, recurrence));
+      return absl::OkStatus();
+    }
+    std::get<std::vector<Bits>*>(capture.action)
+        ->push_back(std::get<Bits>(std::move(value)));
+    return absl::OkStatus();
+  }
+  if (std::holds_alternative<Bits*>(capture.action)) {
+    // Capture a single instance of a signal.
+    if (recurrence > 0) {
+      state.status = absl::InternalError(absl::StrFormat(
+          "Output `%s`, instance #%d captured more than once in Verilog "
+          "simulator output.",
+          capture.signal_name, instance_id));
+    } else if (std::holds_alternative<IsX>(value)) {
+      state.status = absl::NotFoundError(
+          absl::StrFormat("Output `%s`, instance #%d holds X value in "
+                          "Verilog simulator output.",
+                          capture.signal_name, instance_id));
+    } else {
+      *std::get<Bits*>(capture.action) = std::get<Bits>(std::move(value));
+    }
+    return absl::OkStatus();
+  }
+
+  // Check the signal value against the expectation. The captured signal may
+  // appear zero or more times in the output; every instance is checked.
+  const TestbenchExpectation& expectation =
+      std::get<TestbenchExpectation>(capture.action);
+  auto get_source_location = [&]() {
+    return absl::StrFormat("%s@%d", expectation.loc.file_name(),
+                           expectation.loc.line());
+  };
+  std::string instance_name =
+      absl::StrFormat("output `%s`, instance #%d, recurrence %d",
+                      capture.signal_name, instance_id, recurrence);
+  if (std::holds_alternative<Bits>(expectation.expected)) {
+    const Bits& expected_bits = std::get<Bits>(expectation.expected);
+    if (std::holds_alternative<IsX>(value)) {
+      state.status = absl::FailedPreconditionError(absl::StrFormat(
+          "%s: expected %s to have value: %v, has X", get_source_location(),
+          instance_name, expected_bits));
+    } else if (std::get<Bits>(value) != expected_bits) {
+      state.status = absl::FailedPreconditionError(absl::StrFormat(
+          "%s: expected %s to have value: %v, actual: %v",
+          get_source_location(), instance_name, expected_bits,
+          std::get<Bits>(value)));
+    }
+  } else {
+    CHECK(std::holds_alternative<IsX>(expectation.expected));
+    if (std::holds_alternative<Bits>(value)) {
+      state.status = absl::FailedPreconditionError(absl::StrFormat(
+          "%s: expected %s to have X value, has non X value: %v",
+          get_source_location(), instance_name, std::get<Bits>(value)));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SignalCaptureCollector::Finish() const {
+  for (int64_t instance_id = 0; instance_id < states_.size(); ++instance_id) {
+    const CaptureState& state = states_[instance_id];
+    XLS_RETURN_IF_ERROR(state.status);
+    if (state.capture != nullptr && state.count == 0 &&
+        std::holds_alternative<Bits*>(state.capture->action)) {
+      return absl::NotFoundError(absl::StrFormat(
+          "Output `%s`, instance #%d not found in Verilog simulator output.",
+          state.capture->signal_name, instance_id));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CollectSignalCapturesFromText(std::string_view text,
+                                           SignalCaptureCollector& collector) {
+  std::string output_name;
+  std::string output_width;
+  std::string output_value;
+  std::string instance_str;
+  std::string_view piece(text);
+  while (RE2::FindAndConsume(&piece, SignalCaptureRegex(), &output_name,
+                             &output_width, &output_value, &instance_str)) {
+    XLS_RETURN_IF_ERROR(ObserveMatchedSignalCapture(
+        output_name, output_width, output_value, instance_str, collector));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CollectSignalCapturesFromFile(FILE* file,
+                                           SignalCaptureFormat format,
+                                           SignalCaptureCollector& collector) {
+  switch (format) {
+    case SignalCaptureFormat::kPipeText:
+      return CollectSignalCapturesFromTextFile(file, collector);
+    case SignalCaptureFormat::kPipeBinary:
+      return CollectSignalCapturesFromBinaryFile(file, collector);
+    case SignalCaptureFormat::kDisplay:
+      break;
+  }
+  return absl::InvalidArgumentError(
+      "Signal captures in the kDisplay format are not written to a file");
+}
 
 SignalCapture SignalCaptureManager::Capture(std::string_view signal_name,
                                             Bits* bits) {
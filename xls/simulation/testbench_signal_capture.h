@@ -16,12 +16,15 @@
 #define XLS_SIMULATION_TESTBENCH_SIGNAL_CAPTURE_H_
 
 #include <cstdint>
+#include <cstdio>
 #include <string>
 #include <string_view>
 #include <variant>
 #include <vector>
 
 #include "absl/log/die_if_null.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/source_location.h"
 #include "xls/ir/bits.h"
@@ -99,6 +102,70 @@ class SignalCaptureManager {
   std::vector<SignalCapture> signal_captures_;
 };
 
+// How the values of signal captures are communicated from the simulator to the
+// testbench.
+enum class SignalCaptureFormat : int8_t {
+  // Each value is $display-ed as a line of text on stdout which is parsed after
+  // the simulation completes.
+  kDisplay,
+  // Each value is written as a line of text (in the same format as kDisplay)
+  // into a named pipe which is parsed while the simulation runs.
+  kPipeText,
+  // Each value is written into a named pipe with the binary formats of $fwrite
+  // ("%u" for the instance id, "%z" for the value) and parsed while the
+  // simulation runs. This is the most compact option for long simulations.
+  kPipeBinary,
+};
+
+// Name of the stream used for the signal captures of the kPipe* formats.
+inline constexpr std::string_view kSignalCaptureStreamName = "signal_captures";
+
+// Records the values of signal captures as they are observed and checks them
+// against the expectations of the captures. Values are not retained beyond
+// what the capture actions require so memory use is independent of the length
+// of the simulation.
+class SignalCaptureCollector {
+ public:
+  // Vectors of CaptureMultiple actions are cleared on construction.
+  explicit SignalCaptureCollector(
+      absl::Span<const SignalCapture> signal_captures);
+
+  // Returns the width of the signal of the capture with the given instance id.
+  absl::StatusOr<int64_t> GetSignalWidth(int64_t instance_id) const;
+
+  // Records a value of the capture with the given instance id. Failed
+  // expectations are reported by Finish; an error is returned only if the
+  // instance id is unknown.
+  absl::Status Observe(int64_t instance_id, BitsOrX value);
+
+  // Returns the error of the capture with the smallest instance id which
+  // failed (if any), including captures of single values which were never
+  // observed.
+  absl::Status Finish() const;
+
+ private:
+  struct CaptureState {
+    const SignalCapture* capture = nullptr;
+    // The number of values observed so far.
+    int64_t count = 0;
+    absl::Status status;
+  };
+
+  // Indexed by instance id.
+  std::vector<CaptureState> states_;
+};
+
+// Observes the values of all signal captures $display-ed in the given
+// simulation stdout.
+absl::Status CollectSignalCapturesFromText(std::string_view text,
+                                           SignalCaptureCollector& collector);
+
+// Observes the values of all signal captures written into `file` in the given
+// pipe format until EOF is reached.
+absl::Status CollectSignalCapturesFromFile(FILE* file,
+                                           SignalCaptureFormat format,
+                                           SignalCaptureCollector& collector);
+
 // Data-structure representing the end of a cycle (one time unit before the
 // rising edge of the clock). In the ModuleTestbench infrastructure signals are
 // only sampled at the end of a cycle. The ModuleTestbenchThread API returns
@@ -15,11 +15,13 @@
 #include "xls/simulation/testbench_stream.h"
 
 #include <cstdint>
+#include <cstdio>
 #include <filesystem>  // NOLINT
 #include <functional>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -31,6 +33,7 @@
 #include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
 #include "xls/codegen/vast.h"
+#include "xls/common/file/file_descriptor.h"
 #include "xls/common/file/named_pipe.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/thread.h"
@@ -141,6 +144,40 @@ void VastStreamEmitter::EmitWrite(StatementBlock* block,
           block->file()->Make<QuotedString>(SourceInfo(), R"(\n)")});
 }
 
+void VastStreamEmitter::EmitWriteSignalCapture(StatementBlock* block,
+                                               std::string_view signal_name,
+                                               int64_t width,
+                                               int64_t instance_id,
+                                               Expression* value) const {
+  VerilogFile* file = block->file();
+  std::vector<Expression*> args = {file_descriptor_};
+  if (stream_.binary) {
+    // Emit code:
+    //
+    //   $fwrite(fd, "%u%z", 32'h<instance_id>, <value>);
+    args.push_back(file->Make<QuotedString>(
+        SourceInfo(), value == nullptr ? "%u" : "%u%z"));
+    args.push_back(file->Literal(UBits(instance_id, 32), SourceInfo()));
+  } else {
+    // Emit code:
+    //
+    //   $fwrite(fd, "%t OUTPUT <name> = <width>'h%0x (#<instance_id>)\n",
+    //           $time, <value>);
+    args.push_back(file->Make<QuotedString>(
+        SourceInfo(),
+        value == nullptr
+            ? absl::StrFormat(R"(%%t OUTPUT %s = 0'h0 (#%d)\n)", signal_name,
+                              instance_id)
+            : absl::StrFormat(R"(%%t OUTPUT %s = %d'h%%0x (#%d)\n)",
+                              signal_name, width, instance_id)));
+    args.push_back(file->Make<SystemFunctionCall>(SourceInfo(), "time"));
+  }
+  if (value != nullptr) {
+    args.push_back(value);
+  }
+  block->Add<SystemTaskCall>(SourceInfo(), "fwrite", args);
+}
+
 void VastStreamEmitter::EmitClose(StatementBlock* block) const {
   block->Add<SystemTaskCall>(SourceInfo(), "fclose",
                              std::vector<Expression*>{file_descriptor_});
@@ -255,6 +292,33 @@ void TestbenchStreamThread::RunOutputStream(
   }));
 }
 
+void TestbenchStreamThread::RunOutputFileStream(
+    TestbenchStreamThread::FileReader reader) {
+  VLOG(1) << absl::StrFormat("RunOutputFileStream [%s]", stream_.name);
+  thread_ = absl::WrapUnique(new Thread([this, reader]() {
+    VLOG(1) << absl::StrFormat("Thread for stream `%s` started", stream_.name);
+    absl::StatusOr<FileStream> file =
+        FileStream::Open(named_pipe_.path(), "rb");
+    if (!file.ok()) {
+      LOG(ERROR) << absl::StrFormat(
+          "Opening the pipe failed for stream `%s`: %s", stream_.name,
+          file.status().message());
+      MaybeSetError(file.status());
+      return;
+    }
+    absl::Status result = reader(file->get());
+    if (!result.ok()) {
+      VLOG(1) << absl::StrFormat("Reader for stream `%s` returned an error: %s",
+                                 stream_.name, result.message());
+      MaybeSetError(result);
+      // Drain the pipe so the simulation does not block on writes.
+      char buffer[4096];
+      while (fread(buffer, 1, sizeof(buffer), file->get()) > 0) {
+      }
+    }
+  }));
+}
+
 absl::Status TestbenchStreamThread::Join() {
   thread_->Join();
   return status_;
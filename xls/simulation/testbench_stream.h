@@ -16,10 +16,12 @@
 #define XLS_SIMULATION_TESTBENCH_STREAM_H_
 
 #include <cstdint>
+#include <cstdio>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 
 #include "absl/functional/function_ref.h"
@@ -50,6 +52,11 @@ struct TestbenchStream {
 
   // The width of the data to read/write to the testbench.
   int64_t width;
+
+  // Whether values are written with the binary formats of $fwrite rather than
+  // as lines of hex text. Only supported by the stream of signal captures (see
+  // SignalCaptureFormat).
+  bool binary = false;
 };
 
 // Class for emitting VAST code for reading and writing values to streams.
@@ -69,6 +76,15 @@ class VastStreamEmitter {
   // Emit code which writes `value` into the pipe.
   void EmitWrite(StatementBlock* block, Expression* value) const;
 
+  // Emit code which writes the value of instance `instance_id` of a signal
+  // capture into the pipe: a line in the format $display-ed for captures on
+  // stdout or, for binary streams, the instance id as a 32-bit word ("%u")
+  // followed by the four-state value ("%z"). `value` is nullptr for zero-width
+  // signals, for which only the instance id is written in binary streams.
+  void EmitWriteSignalCapture(StatementBlock* block,
+                              std::string_view signal_name, int64_t width,
+                              int64_t instance_id, Expression* value) const;
+
  private:
   explicit VastStreamEmitter(const TestbenchStream& stream) : stream_(stream) {}
 
@@ -111,6 +127,15 @@ class TestbenchStreamThread {
   using Consumer = absl::FunctionRef<absl::Status(const Bits&)>;
   void RunOutputStream(Consumer consumer);
 
+  // Start running a thread which reads raw data from the testbench. The stream
+  // used to create this TestbenchStreamThread must be an output stream.
+  //
+  // `reader` is called once with the opened pipe and should read until EOF. If
+  // it returns an error then the rest of the data is discarded (so the
+  // simulation is not blocked) and the error is returned by Join.
+  using FileReader = absl::FunctionRef<absl::Status(FILE*)>;
+  void RunOutputFileStream(FileReader reader);
+
   absl::Status Join();
 
  private:
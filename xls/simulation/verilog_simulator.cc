@@ -36,6 +36,7 @@
 #include "xls/codegen/vast.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
+#include "xls/tools/verilog_include.h"
 #include "re2/re2.h"
 
 namespace xls {
@@ -92,8 +93,42 @@ absl::StatusOr<std::vector<Observation>> StdoutToObservations(
   return result;
 }
 
+// A compiled simulation which simply runs the simulator on the full text.
+class RecompilingSimulation : public CompiledSimulation {
+ public:
+  RecompilingSimulation(
+      const VerilogSimulator* simulator, std::string_view text,
+      FileType file_type,
+      absl::Span<const VerilogSimulator::MacroDefinition> macro_definitions,
+      absl::Span<const VerilogInclude> includes)
+      : simulator_(simulator),
+        text_(text),
+        file_type_(file_type),
+        macro_definitions_(macro_definitions.begin(), macro_definitions.end()),
+        includes_(includes.begin(), includes.end()) {}
+
+  absl::StatusOr<std::pair<std::string, std::string>> Run() const override {
+    return simulator_->Run(text_, file_type_, macro_definitions_, includes_);
+  }
+
+ private:
+  const VerilogSimulator* simulator_;
+  std::string text_;
+  FileType file_type_;
+  std::vector<VerilogSimulator::MacroDefinition> macro_definitions_;
+  std::vector<VerilogInclude> includes_;
+};
+
 }  // namespace
 
+absl::StatusOr<std::unique_ptr<CompiledSimulation>> VerilogSimulator::Compile(
+    std::string_view text, FileType file_type,
+    absl::Span<const MacroDefinition> macro_definitions,
+    absl::Span<const VerilogInclude> includes) const {
+  return std::make_unique<RecompilingSimulation>(this, text, file_type,
+                                                 macro_definitions, includes);
+}
+
 absl::StatusOr<std::pair<std::string, std::string>> VerilogSimulator::Run(
     std::string_view text, FileType file_type) const {
   return Run(text, file_type, /*macro_definitions=*/{}, /*includes=*/{});
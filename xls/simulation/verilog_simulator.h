@@ -42,6 +42,16 @@ struct Observation {
   Bits value;
 };
 
+// A simulation which has been compiled once and can be run repeatedly, e.g.
+// with different data streamed into it through named pipes.
+class CompiledSimulation {
+ public:
+  virtual ~CompiledSimulation() = default;
+
+  // Runs the simulation and returns the stdout/stderr as a string pair.
+  virtual absl::StatusOr<std::pair<std::string, std::string>> Run() const = 0;
+};
+
 // Interface wrapping a Verilog simulator such Icarus verilog.
 class VerilogSimulator {
  public:
@@ -57,6 +67,15 @@ class VerilogSimulator {
     std::optional<std::string> value;
   };
 
+  // Compiles the given Verilog text for running any number of times. The
+  // default implementation defers everything to Run, so it recompiles the text
+  // on each run; simulators with a separate compilation step (such as iverilog
+  // and vvp) override this to compile only once.
+  virtual absl::StatusOr<std::unique_ptr<CompiledSimulation>> Compile(
+      std::string_view text, FileType file_type,
+      absl::Span<const MacroDefinition> macro_definitions,
+      absl::Span<const VerilogInclude> includes) const;
+
   // Runs the simulator with the given Verilog text as input and returns the
   // stdout/stderr as a string pair.
   absl::StatusOr<std::pair<std::string, std::string>> Run(
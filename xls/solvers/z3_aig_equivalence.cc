@@ -0,0 +1,678 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/z3_aig_equivalence.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/solvers/z3_ir_translator.h"
+#include "xls/solvers/z3_utils.h"
+#include "xls/tools/booleanifier.h"
+#include "external/z3/src/api/z3_api.h"
+
+namespace xls::solvers::z3 {
+namespace {
+
+// A literal of an AIG: twice the index of a node, plus one if complemented.
+using AigLit = int64_t;
+
+constexpr AigLit kFalseLit = 0;
+constexpr AigLit kTrueLit = 1;
+
+AigLit NotLit(AigLit a) { return a ^ 1; }
+int64_t LitNode(AigLit a) { return a >> 1; }
+bool LitIsComplemented(AigLit a) { return (a & 1) != 0; }
+
+// An and-inverter graph. Node 0 is the constant false and every other node is
+// either an input or the and of literals of two earlier nodes, so the nodes
+// are in topological order. Ands are structurally hashed.
+class Aig {
+ public:
+  Aig() { AddNode(kFalseLit, kFalseLit, /*is_input=*/false); }
+
+  int64_t node_count() const { return fanins_.size(); }
+  int64_t and_count() const { return node_count() - 1 - inputs_.size(); }
+  absl::Span<const int64_t> inputs() const { return inputs_; }
+  bool IsInput(int64_t node) const { return is_input_[node]; }
+  AigLit fanin0(int64_t node) const { return fanins_[node].first; }
+  AigLit fanin1(int64_t node) const { return fanins_[node].second; }
+
+  AigLit NewInput() {
+    inputs_.push_back(node_count());
+    return AddNode(kFalseLit, kFalseLit, /*is_input=*/true);
+  }
+
+  AigLit And(AigLit a, AigLit b) {
+    if (a > b) {
+      std::swap(a, b);
+    }
+    if (a == kFalseLit || a == NotLit(b)) {
+      return kFalseLit;
+    }
+    if (a == kTrueLit || a == b) {
+      return b;
+    }
+    auto [it, inserted] = strash_.try_emplace(std::make_pair(a, b), kFalseLit);
+    if (inserted) {
+      it->second = AddNode(a, b, /*is_input=*/false);
+    }
+    return it->second;
+  }
+
+  AigLit Or(AigLit a, AigLit b) { return NotLit(And(NotLit(a), NotLit(b))); }
+
+  AigLit Xor(AigLit a, AigLit b) {
+    return Or(And(a, NotLit(b)), And(NotLit(a), b));
+  }
+
+ private:
+  AigLit AddNode(AigLit a, AigLit b, bool is_input) {
+    fanins_.push_back({a, b});
+    is_input_.push_back(is_input);
+    return 2 * (node_count() - 1);
+  }
+
+  std::vector<std::pair<AigLit, AigLit>> fanins_;
+  std::vector<bool> is_input_;
+  std::vector<int64_t> inputs_;
+  absl::flat_hash_map<std::pair<AigLit, AigLit>, AigLit> strash_;
+};
+
+// The bits of a value are laid out by visiting the leaves of its type in
+// order, with the bits of each leaf from least to most significant.
+void AppendValueLits(const Value& value, std::vector<AigLit>& lits) {
+  if (value.IsBits()) {
+    for (int64_t i = 0; i < value.bits().bit_count(); ++i) {
+      lits.push_back(value.bits().Get(i) ? kTrueLit : kFalseLit);
+    }
+    return;
+  }
+  for (const Value& element : value.elements()) {
+    AppendValueLits(element, lits);
+  }
+}
+
+// The inverse of the layout above: reads a value of type `type` from `bits`
+// starting at `offset`, which is advanced past the bits read.
+absl::StatusOr<Value> ValueFromBits(Type* type, absl::Span<const bool> bits,
+                                    int64_t& offset) {
+  if (type->IsBits()) {
+    int64_t width = type->GetFlatBitCount();
+    Value value(Bits(bits.subspan(offset, width)));
+    offset += width;
+    return value;
+  }
+  std::vector<Value> elements;
+  if (type->IsTuple()) {
+    for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+      XLS_ASSIGN_OR_RETURN(Value element,
+                           ValueFromBits(element_type, bits, offset));
+      elements.push_back(std::move(element));
+    }
+    return Value::TupleOwned(std::move(elements));
+  }
+  if (type->IsArray()) {
+    ArrayType* array_type = type->AsArrayOrDie();
+    for (int64_t i = 0; i < array_type->size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          Value element,
+          ValueFromBits(array_type->element_type(), bits, offset));
+      elements.push_back(std::move(element));
+    }
+    return Value::Array(elements);
+  }
+  return absl::UnimplementedError(
+      absl::StrFormat("Type %s is not supported", type->ToString()));
+}
+
+// Lowers the booleanified function `f` into `aig` with the bits of param i
+// given by `param_lits[i]`. Returns the bits of the return value.
+absl::StatusOr<std::vector<AigLit>> LowerToAig(
+    Function* f, absl::Span<const std::vector<AigLit>> param_lits, Aig& aig) {
+  absl::flat_hash_map<Node*, std::vector<AigLit>> node_lits;
+  for (Node* node : TopoSort(f)) {
+    std::vector<AigLit> lits;
+    auto append_range = [&](Node* operand, int64_t start, int64_t width) {
+      const std::vector<AigLit>& operand_lits = node_lits.at(operand);
+      lits.insert(lits.end(), operand_lits.begin() + start,
+                  operand_lits.begin() + start + width);
+    };
+    switch (node->op()) {
+      case Op::kParam: {
+        XLS_ASSIGN_OR_RETURN(int64_t index,
+                             f->GetParamIndex(node->As<Param>()));
+        lits = param_lits[index];
+        break;
+      }
+      case Op::kLiteral:
+        AppendValueLits(node->As<Literal>()->value(), lits);
+        break;
+      case Op::kIdentity:
+        lits = node_lits.at(node->operand(0));
+        break;
+      case Op::kBitSlice:
+        append_range(node->operand(0), node->As<BitSlice>()->start(),
+                     node->As<BitSlice>()->width());
+        break;
+      case Op::kTupleIndex: {
+        TupleType* tuple_type = node->operand(0)->GetType()->AsTupleOrDie();
+        int64_t start = 0;
+        for (int64_t i = 0; i < node->As<TupleIndex>()->index(); ++i) {
+          start += tuple_type->element_type(i)->GetFlatBitCount();
+        }
+        append_range(node->operand(0), start,
+                     node->GetType()->GetFlatBitCount());
+        break;
+      }
+      case Op::kArrayIndex: {
+        ArrayIndex* array_index = node->As<ArrayIndex>();
+        Type* type = array_index->array()->GetType();
+        int64_t start = 0;
+        for (Node* index : array_index->indices()) {
+          if (!index->Is<Literal>()) {
+            return absl::UnimplementedError(absl::StrFormat(
+                "Non-literal array index %s is not supported by the AIG "
+                "lowering",
+                node->GetName()));
+          }
+          // Out-of-bounds indices are clamped to the last element.
+          ArrayType* array_type = type->AsArrayOrDie();
+          const Bits& bits = index->As<Literal>()->value().bits();
+          int64_t element = array_type->size() - 1;
+          if (bits.FitsInUint64() && bits.ToUint64().value() <
+                                         static_cast<uint64_t>(element)) {
+            element = static_cast<int64_t>(bits.ToUint64().value());
+          }
+          start += element * array_type->element_type()->GetFlatBitCount();
+          type = array_type->element_type();
+        }
+        append_range(array_index->array(), start,
+                     node->GetType()->GetFlatBitCount());
+        break;
+      }
+      case Op::kConcat:
+        // The last operand holds the least significant bits.
+        for (auto it = node->operands().rbegin(); it != node->operands().rend();
+             ++it) {
+          append_range(*it, 0, (*it)->GetType()->GetFlatBitCount());
+        }
+        break;
+      case Op::kTuple:
+      case Op::kArray:
+        for (Node* operand : node->operands()) {
+          append_range(operand, 0, operand->GetType()->GetFlatBitCount());
+        }
+        break;
+      case Op::kNot:
+        for (AigLit lit : node_lits.at(node->operand(0))) {
+          lits.push_back(NotLit(lit));
+        }
+        break;
+      case Op::kAnd:
+      case Op::kNand:
+      case Op::kOr:
+      case Op::kNor:
+      case Op::kXor: {
+        lits = node_lits.at(node->operand(0));
+        for (Node* operand : node->operands().subspan(1)) {
+          const std::vector<AigLit>& operand_lits = node_lits.at(operand);
+          for (int64_t i = 0; i < lits.size(); ++i) {
+            if (node->op() == Op::kXor) {
+              lits[i] = aig.Xor(lits[i], operand_lits[i]);
+            } else if (node->op() == Op::kAnd || node->op() == Op::kNand) {
+              lits[i] = aig.And(lits[i], operand_lits[i]);
+            } else {
+              lits[i] = aig.Or(lits[i], operand_lits[i]);
+            }
+          }
+        }
+        if (node->op() == Op::kNand || node->op() == Op::kNor) {
+          for (AigLit& lit : lits) {
+            lit = NotLit(lit);
+          }
+        }
+        break;
+      }
+      default:
+        return absl::UnimplementedError(absl::StrFormat(
+            "Op %s of node %s is not supported by the AIG lowering",
+            OpToString(node->op()), node->GetName()));
+    }
+    XLS_RET_CHECK_EQ(static_cast<int64_t>(lits.size()),
+                     node->GetType()->GetFlatBitCount())
+        << node->ToString();
+    node_lits[node] = std::move(lits);
+  }
+  return node_lits.at(f->return_value());
+}
+
+// Merges the equivalent nodes of an AIG by SAT sweeping, building a new AIG
+// (the "fraig") in which each class of equivalent nodes is a single node.
+class AigSweeper {
+ public:
+  AigSweeper(const Aig& aig, const AigEquivalenceOptions& options,
+             AigEquivalenceStats& stats)
+      : aig_(aig), options_(options), stats_(stats) {
+    Z3_config config = Z3_mk_config();
+    ctx_ = Z3_mk_context(config);
+    Z3_del_config(config);
+    solver_ = CreateSolver(ctx_, /*num_threads=*/1);
+  }
+
+  ~AigSweeper() {
+    Z3_solver_dec_ref(ctx_, solver_);
+    Z3_del_context(ctx_);
+  }
+
+  absl::Status Sweep();
+
+  const Aig& fraig() const { return fraig_; }
+
+  // Returns the literal of the fraig equivalent to `lit` of the original AIG.
+  AigLit Map(AigLit lit) const {
+    return fraig_lits_[LitNode(lit)] ^ (lit & 1);
+  }
+
+  // Returns whether literals `a` and `b` of the fraig are equivalent. If not,
+  // `counterexample` is set to an assignment of the inputs under which they
+  // differ. Returns a DeadlineExceededError if the query took longer than
+  // `timeout`.
+  absl::StatusOr<bool> ProveEqual(
+      AigLit a, AigLit b, absl::Duration timeout,
+      absl::InlinedVector<bool, 64>& counterexample);
+
+ private:
+  // Simulates random input patterns and partitions the nodes into classes of
+  // candidate equivalent nodes.
+  void Simulate();
+
+  // Evaluates the original AIG under `inputs` and records the value of each
+  // node to tell candidates apart without a SAT query.
+  void AddCounterexample(absl::Span<const bool> inputs);
+
+  // Returns true if nodes `a` and `b` of the original AIG (complemented
+  // relative to each other if their phases differ) agree on every recorded
+  // counterexample.
+  bool CounterexamplesAgree(int64_t a, int64_t b) const;
+
+  void SetTimeout(absl::Duration timeout);
+
+  // Returns the Z3 expression for a literal of the fraig.
+  Z3_ast Translate(AigLit lit);
+
+  const Aig& aig_;
+  const AigEquivalenceOptions& options_;
+  AigEquivalenceStats& stats_;
+
+  // simulation_[node * options_.simulation_words + i] is the i-th word of
+  // random patterns for the node.
+  std::vector<uint64_t> simulation_;
+  // The value of each node under the first pattern; nodes whose patterns are
+  // complements of each other are candidates for equivalence up to phase.
+  std::vector<bool> phase_;
+  std::vector<int64_t> class_of_;
+  int64_t class_count_ = 0;
+
+  // counterexamples_[i][node] holds the value of the node under
+  // counterexamples 64 * i to 64 * i + 63.
+  std::vector<std::vector<uint64_t>> counterexamples_;
+  int64_t counterexample_count_ = 0;
+
+  Aig fraig_;
+  std::vector<AigLit> fraig_lits_;
+
+  Z3_context ctx_;
+  Z3_solver solver_;
+  std::optional<absl::Duration> timeout_;
+  // The translation of each fraig node translated so far; nodes are translated
+  // in order.
+  std::vector<Z3_ast> z3_nodes_;
+};
+
+void AigSweeper::Simulate() {
+  const int64_t words = options_.simulation_words;
+  simulation_.assign(aig_.node_count() * words, 0);
+  std::mt19937_64 engine(options_.seed);
+  for (int64_t node : aig_.inputs()) {
+    for (int64_t i = 0; i < words; ++i) {
+      simulation_[node * words + i] = engine();
+    }
+  }
+  auto word = [&](AigLit lit, int64_t i) {
+    uint64_t value = simulation_[LitNode(lit) * words + i];
+    return LitIsComplemented(lit) ? ~value : value;
+  };
+  for (int64_t node = 1; node < aig_.node_count(); ++node) {
+    if (aig_.IsInput(node)) {
+      continue;
+    }
+    for (int64_t i = 0; i < words; ++i) {
+      simulation_[node * words + i] =
+          word(aig_.fanin0(node), i) & word(aig_.fanin1(node), i);
+    }
+  }
+
+  phase_.resize(aig_.node_count());
+  class_of_.resize(aig_.node_count());
+  absl::flat_hash_map<std::vector<uint64_t>, int64_t> class_of_signature;
+  std::vector<uint64_t> signature(words);
+  for (int64_t node = 0; node < aig_.node_count(); ++node) {
+    phase_[node] = (simulation_[node * words] & 1) != 0;
+    for (int64_t i = 0; i < words; ++i) {
+      uint64_t value = simulation_[node * words + i];
+      signature[i] = phase_[node] ? ~value : value;
+    }
+    auto [it, inserted] =
+        class_of_signature.try_emplace(signature, class_count_);
+    if (inserted) {
+      ++class_count_;
+    }
+    class_of_[node] = it->second;
+  }
+}
+
+void AigSweeper::AddCounterexample(absl::Span<const bool> inputs) {
+  std::vector<bool> values(aig_.node_count(), false);
+  for (int64_t i = 0; i < aig_.inputs().size(); ++i) {
+    values[aig_.inputs()[i]] = inputs[i];
+  }
+  auto lit_value = [&](AigLit lit) {
+    return values[LitNode(lit)] != LitIsComplemented(lit);
+  };
+  if (counterexample_count_ % 64 == 0) {
+    counterexamples_.push_back(std::vector<uint64_t>(aig_.node_count(), 0));
+  }
+  std::vector<uint64_t>& word = counterexamples_.back();
+  const uint64_t bit = uint64_t{1} << (counterexample_count_ % 64);
+  for (int64_t node = 1; node < aig_.node_count(); ++node) {
+    if (!aig_.IsInput(node)) {
+      values[node] =
+          lit_value(aig_.fanin0(node)) && lit_value(aig_.fanin1(node));
+    }
+    if (values[node]) {
+      word[node] |= bit;
+    }
+  }
+  ++counterexample_count_;
+}
+
+bool AigSweeper::CounterexamplesAgree(int64_t a, int64_t b) const {
+  const uint64_t flip = phase_[a] != phase_[b] ? ~uint64_t{0} : 0;
+  for (int64_t i = 0; i < counterexamples_.size(); ++i) {
+    uint64_t differing = counterexamples_[i][a] ^ counterexamples_[i][b] ^ flip;
+    int64_t valid_bits = std::min<int64_t>(64, counterexample_count_ - 64 * i);
+    if (valid_bits < 64) {
+      differing &= (uint64_t{1} << valid_bits) - 1;
+    }
+    if (differing != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void AigSweeper::SetTimeout(absl::Duration timeout) {
+  if (timeout_ == timeout) {
+    return;
+  }
+  timeout_ = timeout;
+  unsigned timeout_ms = std::numeric_limits<unsigned>::max();
+  if (timeout != absl::InfiniteDuration()) {
+    timeout_ms = static_cast<unsigned>(std::clamp<int64_t>(
+        absl::ToInt64Milliseconds(timeout), 1,
+        std::numeric_limits<unsigned>::max()));
+  }
+  Z3_params params = Z3_mk_params(ctx_);
+  Z3_params_inc_ref(ctx_, params);
+  Z3_params_set_uint(ctx_, params, Z3_mk_string_symbol(ctx_, "timeout"),
+                     timeout_ms);
+  Z3_solver_set_params(ctx_, solver_, params);
+  Z3_params_dec_ref(ctx_, params);
+}
+
+Z3_ast AigSweeper::Translate(AigLit lit) {
+  auto translation = [&](AigLit l) {
+    Z3_ast ast = z3_nodes_[LitNode(l)];
+    return LitIsComplemented(l) ? Z3_mk_not(ctx_, ast) : ast;
+  };
+  while (static_cast<int64_t>(z3_nodes_.size()) <= LitNode(lit)) {
+    int64_t node = z3_nodes_.size();
+    if (node == 0) {
+      z3_nodes_.push_back(Z3_mk_false(ctx_));
+    } else if (fraig_.IsInput(node)) {
+      z3_nodes_.push_back(
+          Z3_mk_fresh_const(ctx_, "input", Z3_mk_bool_sort(ctx_)));
+    } else {
+      Z3_ast args[] = {translation(fraig_.fanin0(node)),
+                       translation(fraig_.fanin1(node))};
+      z3_nodes_.push_back(Z3_mk_and(ctx_, 2, args));
+    }
+  }
+  return translation(lit);
+}
+
+absl::StatusOr<bool> AigSweeper::ProveEqual(
+    AigLit a, AigLit b, absl::Duration timeout,
+    absl::InlinedVector<bool, 64>& counterexample) {
+  SetTimeout(timeout);
+  // The query is guarded by a fresh literal which is disabled afterwards, so
+  // the solver keeps what it learned without the query constraining later
+  // ones.
+  Z3_ast guard = Z3_mk_fresh_const(ctx_, "guard", Z3_mk_bool_sort(ctx_));
+  Z3_solver_assert(
+      ctx_, solver_,
+      Z3_mk_implies(ctx_, guard, Z3_mk_xor(ctx_, Translate(a), Translate(b))));
+  Z3_lbool result = Z3_solver_check_assumptions(ctx_, solver_, 1, &guard);
+  if (result == Z3_L_TRUE) {
+    Z3_model model = Z3_solver_get_model(ctx_, solver_);
+    Z3_model_inc_ref(ctx_, model);
+    counterexample.assign(fraig_.inputs().size(), false);
+    for (int64_t i = 0; i < fraig_.inputs().size(); ++i) {
+      int64_t node = fraig_.inputs()[i];
+      Z3_ast value;
+      if (node < z3_nodes_.size() &&
+          Z3_model_eval(ctx_, model, z3_nodes_[node],
+                        /*model_completion=*/true, &value)) {
+        counterexample[i] = Z3_get_bool_value(ctx_, value) == Z3_L_TRUE;
+      }
+    }
+    Z3_model_dec_ref(ctx_, model);
+  }
+  Z3_solver_assert(ctx_, solver_, Z3_mk_not(ctx_, guard));
+  switch (result) {
+    case Z3_L_FALSE:
+      return true;
+    case Z3_L_TRUE:
+      return false;
+    default:
+      return absl::DeadlineExceededError("SAT query timed out");
+  }
+}
+
+absl::Status AigSweeper::Sweep() {
+  Simulate();
+  fraig_lits_.resize(aig_.node_count());
+  // The nodes of each class which are not (known to be) equivalent to each
+  // other, in topological order.
+  std::vector<std::vector<int64_t>> representatives(class_count_);
+  absl::InlinedVector<bool, 64> counterexample;
+  for (int64_t node = 0; node < aig_.node_count(); ++node) {
+    if (node == 0) {
+      fraig_lits_[node] = kFalseLit;
+      representatives[class_of_[node]].push_back(node);
+      continue;
+    }
+    if (aig_.IsInput(node)) {
+      fraig_lits_[node] = fraig_.NewInput();
+      continue;
+    }
+    AigLit lit = fraig_.And(Map(aig_.fanin0(node)), Map(aig_.fanin1(node)));
+    std::vector<int64_t>& candidates = representatives[class_of_[node]];
+    bool merged = false;
+    int64_t queries = 0;
+    for (int64_t candidate : candidates) {
+      AigLit target =
+          fraig_lits_[candidate] ^ (phase_[node] != phase_[candidate] ? 1 : 0);
+      if (target == lit) {
+        merged = true;
+        break;
+      }
+      if (queries >= options_.max_candidates_per_node) {
+        break;
+      }
+      if (!CounterexamplesAgree(node, candidate)) {
+        continue;
+      }
+      ++queries;
+      ++stats_.sweep_query_count;
+      absl::StatusOr<bool> equal = ProveEqual(
+          lit, target, options_.timeout_per_sweep_query, counterexample);
+      if (absl::IsDeadlineExceeded(equal.status())) {
+        continue;
+      }
+      XLS_RETURN_IF_ERROR(equal.status());
+      if (*equal) {
+        ++stats_.sweep_merge_count;
+        lit = target;
+        merged = true;
+        break;
+      }
+      AddCounterexample(counterexample);
+    }
+    fraig_lits_[node] = lit;
+    if (!merged) {
+      candidates.push_back(node);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<absl::flat_hash_map<const Param*, Value>> CounterexampleValues(
+    Function* f, absl::Span<const bool> inputs) {
+  absl::flat_hash_map<const Param*, Value> values;
+  int64_t offset = 0;
+  for (Param* param : f->params()) {
+    XLS_ASSIGN_OR_RETURN(values[param],
+                         ValueFromBits(param->GetType(), inputs, offset));
+  }
+  return values;
+}
+
+}  // namespace
+
+absl::StatusOr<ProverResult> TryProveEquivalenceWithAig(
+    Function* a, Function* b, const AigEquivalenceOptions& options,
+    AigEquivalenceStats* stats) {
+  XLS_RET_CHECK_GE(options.simulation_words, 1);
+  XLS_RET_CHECK_EQ(a->params().size(), b->params().size());
+  for (int64_t i = 0; i < a->params().size(); ++i) {
+    XLS_RET_CHECK(a->param(i)->GetType()->IsEqualTo(b->param(i)->GetType()))
+        << "Param " << i << " types differ";
+  }
+  XLS_RET_CHECK(a->return_value()->GetType()->IsEqualTo(
+      b->return_value()->GetType()))
+      << "Return types differ";
+
+  // Booleanify copies so that neither function nor its package is altered.
+  Package package(absl::StrFormat("%s_aig", a->package()->name()));
+  XLS_ASSIGN_OR_RETURN(Function * a_copy, a->Clone("a", &package));
+  XLS_ASSIGN_OR_RETURN(Function * b_copy, b->Clone("b", &package));
+  XLS_ASSIGN_OR_RETURN(Function * a_boolean,
+                       Booleanifier::Booleanify(a_copy));
+  XLS_ASSIGN_OR_RETURN(Function * b_boolean,
+                       Booleanifier::Booleanify(b_copy));
+
+  Aig aig;
+  std::vector<std::vector<AigLit>> param_lits;
+  for (Param* param : a->params()) {
+    std::vector<AigLit>& lits = param_lits.emplace_back();
+    for (int64_t i = 0; i < param->GetType()->GetFlatBitCount(); ++i) {
+      lits.push_back(aig.NewInput());
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<AigLit> a_outputs,
+                       LowerToAig(a_boolean, param_lits, aig));
+  XLS_ASSIGN_OR_RETURN(std::vector<AigLit> b_outputs,
+                       LowerToAig(b_boolean, param_lits, aig));
+  XLS_RET_CHECK_EQ(a_outputs.size(), b_outputs.size());
+
+  AigEquivalenceStats local_stats;
+  AigEquivalenceStats& s = stats == nullptr ? local_stats : *stats;
+  s = AigEquivalenceStats{.aig_and_count = aig.and_count()};
+  AigSweeper sweeper(aig, options, s);
+  XLS_RETURN_IF_ERROR(sweeper.Sweep());
+  s.swept_and_count = sweeper.fraig().and_count();
+
+  absl::InlinedVector<bool, 64> counterexample;
+  for (int64_t i = 0; i < a_outputs.size(); ++i) {
+    AigLit a_lit = sweeper.Map(a_outputs[i]);
+    AigLit b_lit = sweeper.Map(b_outputs[i]);
+    if (a_lit == b_lit) {
+      continue;
+    }
+    ++s.output_query_count;
+    XLS_ASSIGN_OR_RETURN(
+        bool equal,
+        sweeper.ProveEqual(a_lit, b_lit, options.timeout, counterexample));
+    if (equal) {
+      continue;
+    }
+    absl::StatusOr<absl::flat_hash_map<const Param*, Value>> values =
+        CounterexampleValues(a, counterexample);
+    std::string message = absl::StrFormat(
+        "Bit %d of the return value (leaves in order, least significant bit "
+        "first) differs",
+        i);
+    if (values.ok()) {
+      std::vector<std::string> assignments;
+      for (Param* param : a->params()) {
+        assignments.push_back(absl::StrFormat(
+            "%s = %s", param->GetName(), values->at(param).ToString()));
+      }
+      absl::StrAppend(&message, " for ", absl::StrJoin(assignments, ", "));
+    }
+    return ProvenFalse{.counterexample = std::move(values),
+                       .message = std::move(message)};
+  }
+  return ProvenTrue();
+}
+
+}  // namespace xls::solvers::z3
@@ -0,0 +1,83 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SOLVERS_Z3_AIG_EQUIVALENCE_H_
+#define XLS_SOLVERS_Z3_AIG_EQUIVALENCE_H_
+
+#include <cstdint>
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "xls/ir/function.h"
+#include "xls/solvers/z3_ir_translator.h"
+
+namespace xls::solvers::z3 {
+
+struct AigEquivalenceOptions {
+  // The number of 64-bit words of random input patterns simulated to find
+  // candidate equivalent nodes.
+  int64_t simulation_words = 4;
+
+  // Seed of the random input patterns.
+  uint64_t seed = 0;
+
+  // At most this many earlier candidates are tried when merging a node.
+  int64_t max_candidates_per_node = 2;
+
+  // How long each SAT query proving a pair of candidate nodes equivalent may
+  // run before the pair is treated as not equivalent.
+  absl::Duration timeout_per_sweep_query = absl::Milliseconds(100);
+
+  // How long each SAT query on a pair of output bits may run.
+  absl::Duration timeout = absl::InfiniteDuration();
+};
+
+struct AigEquivalenceStats {
+  // The number of and nodes in the AIG of both functions, before and after
+  // merging equivalent nodes.
+  int64_t aig_and_count = 0;
+  int64_t swept_and_count = 0;
+  // The number of SAT queries made while sweeping and how many of them proved
+  // the candidate nodes equivalent.
+  int64_t sweep_query_count = 0;
+  int64_t sweep_merge_count = 0;
+  // The number of SAT queries made on output bits not already merged by the
+  // sweep.
+  int64_t output_query_count = 0;
+};
+
+// Verify that both functions have the same behaviors, as TryProveEquivalence
+// does, using an and-inverter graph (AIG) rather than a bit-vector encoding.
+// Both functions must have exactly the same types and must not contain
+// invokes.
+//
+// Both functions are booleanified (see Booleanifier) and lowered into a single
+// structurally hashed AIG sharing the param bits. Internal nodes which agree
+// under random simulation are candidates for merging; SAT sweeping proves
+// candidates equivalent in topological order with an incremental solver,
+// merging proven pairs and refining the candidates with the counterexamples of
+// disproven ones. The remaining output bit pairs are then proved with the same
+// solver. Z3 serves as the SAT solver: the queries are purely propositional and
+// each is guarded by an assumption literal so learned clauses are kept.
+//
+// This call does not alter either function. Counterexamples are keyed by the
+// params of `a`. If `stats` is not null it is filled in.
+absl::StatusOr<ProverResult> TryProveEquivalenceWithAig(
+    Function* a, Function* b,
+    const AigEquivalenceOptions& options = AigEquivalenceOptions(),
+    AigEquivalenceStats* stats = nullptr);
+
+}  // namespace xls::solvers::z3
+
+#endif  // XLS_SOLVERS_Z3_AIG_EQUIVALENCE_H_
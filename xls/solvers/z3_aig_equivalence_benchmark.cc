@@ -0,0 +1,117 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks proving the unoptimized and optimized IR of the examples
+// equivalent, with the bit-vector Z3 encoding (TryProveEquivalence) and with
+// AIG-based SAT sweeping (TryProveEquivalenceWithAig).
+
+#include <memory>
+#include <string>
+#include <variant>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "xls/examples/sample_packages.h"
+#include "xls/ir/function.h"
+#include "xls/ir/package.h"
+#include "xls/passes/dce_pass.h"
+#include "xls/passes/inlining_pass.h"
+#include "xls/passes/map_inlining_pass.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/unroll_pass.h"
+#include "xls/solvers/z3_aig_equivalence.h"
+#include "xls/solvers/z3_ir_equivalence.h"
+#include "xls/solvers/z3_ir_translator.h"
+
+namespace xls::solvers::z3 {
+namespace {
+
+// Returns the given example before and after optimization, with all invokes,
+// maps and counted_fors of the unoptimized package inlined so both engines
+// accept it.
+struct ExamplePair {
+  std::unique_ptr<Package> unoptimized;
+  std::unique_ptr<Package> optimized;
+  Function* a;
+  Function* b;
+};
+
+ExamplePair LoadExample(const std::string& name) {
+  ExamplePair pair;
+  pair.unoptimized =
+      sample_packages::GetBenchmark(name, /*optimized=*/false).value();
+  pair.optimized =
+      sample_packages::GetBenchmark(name, /*optimized=*/true).value();
+  OptimizationCompoundPass inlining_passes("inlining_passes",
+                                           "All inlining passes.");
+  inlining_passes.Add<MapInliningPass>();
+  inlining_passes.Add<UnrollPass>();
+  inlining_passes.Add<InliningPass>();
+  inlining_passes.Add<DeadCodeEliminationPass>();
+  PassResults results;
+  bool keep_going = true;
+  while (keep_going) {
+    keep_going = inlining_passes
+                     .Run(pair.unoptimized.get(), OptimizationPassOptions(),
+                          &results)
+                     .value();
+  }
+  pair.a = pair.unoptimized->GetTopAsFunction().value();
+  pair.b = pair.optimized->GetTopAsFunction().value();
+  return pair;
+}
+
+void BM_BitVector(benchmark::State& state, const std::string& name) {
+  ExamplePair pair = LoadExample(name);
+  for (auto _ : state) {
+    absl::StatusOr<ProverResult> result = TryProveEquivalence(pair.a, pair.b);
+    CHECK_OK(result.status());
+    CHECK(std::holds_alternative<ProvenTrue>(*result));
+  }
+}
+
+void BM_Aig(benchmark::State& state, const std::string& name) {
+  ExamplePair pair = LoadExample(name);
+  AigEquivalenceStats stats;
+  for (auto _ : state) {
+    stats = AigEquivalenceStats();
+    absl::StatusOr<ProverResult> result = TryProveEquivalenceWithAig(
+        pair.a, pair.b, AigEquivalenceOptions(), &stats);
+    CHECK_OK(result.status());
+    CHECK(std::holds_alternative<ProvenTrue>(*result));
+  }
+  state.counters["aig_ands"] = stats.aig_and_count;
+  state.counters["swept_ands"] = stats.swept_and_count;
+  state.counters["sweep_queries"] = stats.sweep_query_count;
+  state.counters["sweep_merges"] = stats.sweep_merge_count;
+  state.counters["output_queries"] = stats.output_query_count;
+}
+
+BENCHMARK_CAPTURE(BM_BitVector, crc32, "examples/crc32/crc32")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Aig, crc32, "examples/crc32/crc32")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_BitVector, adler32, "examples/adler32/adler32")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Aig, adler32, "examples/adler32/adler32")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_BitVector, sha256, "examples/sha256")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Aig, sha256, "examples/sha256")
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace xls::solvers::z3
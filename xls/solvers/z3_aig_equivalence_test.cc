@@ -0,0 +1,126 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/z3_aig_equivalence.h"
+
+#include <memory>
+#include <variant>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/solvers/z3_ir_translator.h"
+#include "xls/solvers/z3_ir_translator_matchers.h"
+
+namespace xls::solvers::z3 {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::Gt;
+
+class AigEquivalenceTest : public IrTestBase {};
+
+TEST_F(AigEquivalenceTest, ArithmeticRewritesAreEquivalent) {
+  std::unique_ptr<Package> p = CreatePackage();
+  Type* u16 = p->GetBitsType(16);
+  FunctionBuilder fa("a", p.get());
+  {
+    BValue x = fa.Param("x", u16);
+    BValue y = fa.Param("y", u16);
+    fa.Tuple({fa.Add(x, y), fa.UMul(x, fa.Literal(UBits(2, 16))),
+              fa.Subtract(x, y)});
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * a, fa.Build());
+  FunctionBuilder fb("b", p.get());
+  {
+    BValue x = fb.Param("x", u16);
+    BValue y = fb.Param("y", u16);
+    fb.Tuple({fb.Add(y, x), fb.Shll(x, fb.Literal(UBits(1, 16))),
+              fb.Add(x, fb.Negate(y))});
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * b, fb.Build());
+
+  AigEquivalenceStats stats;
+  EXPECT_THAT(
+      TryProveEquivalenceWithAig(a, b, AigEquivalenceOptions(), &stats),
+      IsOkAndHolds(IsProvenTrue()));
+  EXPECT_THAT(stats.aig_and_count, Gt(0));
+  EXPECT_LE(stats.swept_and_count, stats.aig_and_count);
+}
+
+TEST_F(AigEquivalenceTest, IdenticalFunctionsNeedNoOutputQueries) {
+  std::unique_ptr<Package> p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  fb.UMul(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  AigEquivalenceStats stats;
+  EXPECT_THAT(
+      TryProveEquivalenceWithAig(f, f, AigEquivalenceOptions(), &stats),
+      IsOkAndHolds(IsProvenTrue()));
+  // Structural hashing alone merges the two copies.
+  EXPECT_EQ(stats.output_query_count, 0);
+}
+
+TEST_F(AigEquivalenceTest, DifferentFunctionsHaveCounterexample) {
+  std::unique_ptr<Package> p = CreatePackage();
+  Type* u8 = p->GetBitsType(8);
+  Type* arr = p->GetArrayType(2, u8);
+  FunctionBuilder fa("a", p.get());
+  {
+    BValue x = fa.Param("x", arr);
+    BValue y = fa.Param("y", u8);
+    fa.Add(fa.ArrayIndex(x, {fa.Literal(UBits(1, 1))}), y);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * a, fa.Build());
+  FunctionBuilder fb("b", p.get());
+  {
+    BValue x = fb.Param("x", arr);
+    BValue y = fb.Param("y", u8);
+    // Differs from `a` only when y is 42.
+    BValue sum = fb.Add(fb.ArrayIndex(x, {fb.Literal(UBits(1, 1))}), y);
+    fb.Select(fb.Eq(y, fb.Literal(UBits(42, 8))),
+              {sum, fb.Add(sum, fb.Literal(UBits(1, 8)))});
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * b, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(ProverResult result,
+                           TryProveEquivalenceWithAig(a, b));
+  ASSERT_TRUE(std::holds_alternative<ProvenFalse>(result));
+  const ProvenFalse& proven_false = std::get<ProvenFalse>(result);
+  XLS_ASSERT_OK(proven_false.counterexample.status());
+  std::vector<Value> args = {proven_false.counterexample->at(a->param(0)),
+                             proven_false.counterexample->at(a->param(1))};
+  EXPECT_EQ(args[1], Value(UBits(42, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Value a_result,
+                           DropInterpreterEvents(InterpretFunction(a, args)));
+  XLS_ASSERT_OK_AND_ASSIGN(Value b_result,
+                           DropInterpreterEvents(InterpretFunction(b, args)));
+  EXPECT_NE(a_result, b_result);
+}
+
+}  // namespace
+}  // namespace xls::solvers::z3
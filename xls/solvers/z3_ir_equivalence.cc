@@ -14,18 +14,29 @@
 
 #include "xls/solvers/z3_ir_equivalence.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
 #include <vector>
 
+#include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/thread.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
@@ -38,6 +49,8 @@
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/value.h"
 #include "xls/solvers/z3_ir_translator.h"
+#include "xls/solvers/z3_utils.h"
+#include "external/z3/src/api/z3_api.h"
 
 namespace xls::solvers::z3 {
 namespace {
@@ -89,15 +102,92 @@ absl::StatusOr<Node*> FlattenToBits(Function* function, Node* original) {
       SourceInfo(), values,
       absl::StrFormat("split_concat_%s", original->GetName()), function));
 }
-}  // namespace
 
-absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
-                                                 absl::Duration timeout) {
-  std::unique_ptr<Package> to_test = std::make_unique<Package>(
-      absl::StrFormat("%s_tester", a->package()->name()));
+// One output slice checked by a sub-query of TryProveEquivalenceInParallel.
+struct OutputSlice {
+  Node* value;
+  // Human-readable location of the slice in the return value.
+  std::string description;
+};
+
+// Splits "original" into its bits-typed leaves, and those leaves into slices
+// of at most "max_bits" bits, appending them to "slices". Zero-width leaves are
+// skipped as they are trivially equal.
+absl::Status SplitToBits(Function* function, Node* original,
+                         std::optional<int64_t> max_bits,
+                         std::vector<int64_t>& index,
+                         std::vector<OutputSlice>& slices) {
+  Type* type = original->GetType();
+  auto element_name = [&]() {
+    return absl::StrFormat("element {%s}", absl::StrJoin(index, ", "));
+  };
+  if (type->IsBits()) {
+    int64_t width = type->GetFlatBitCount();
+    if (width == 0) {
+      return absl::OkStatus();
+    }
+    if (!max_bits.has_value() || width <= *max_bits) {
+      slices.push_back({.value = original, .description = element_name()});
+      return absl::OkStatus();
+    }
+    for (int64_t start = 0; start < width; start += *max_bits) {
+      int64_t slice_width = std::min(*max_bits, width - start);
+      Node* slice = function->AddNode(std::make_unique<BitSlice>(
+          SourceInfo(), original, start, slice_width,
+          absl::StrFormat("split_bits_%s__%d__", original->GetName(), start),
+          function));
+      slices.push_back(
+          {.value = slice,
+           .description = absl::StrFormat("bits [%d, %d) of %s", start,
+                                          start + slice_width,
+                                          element_name())});
+    }
+    return absl::OkStatus();
+  }
+  if (type->IsTuple()) {
+    for (int64_t i = 0; i < type->AsTupleOrDie()->size(); ++i) {
+      Node* element = function->AddNode(std::make_unique<TupleIndex>(
+          SourceInfo(), original, i,
+          absl::StrFormat("split_tuple_%s__%i__", original->GetName(), i),
+          function));
+      index.push_back(i);
+      XLS_RETURN_IF_ERROR(
+          SplitToBits(function, element, max_bits, index, slices));
+      index.pop_back();
+    }
+    return absl::OkStatus();
+  }
+  XLS_RET_CHECK(type->IsArray()) << type;
+  for (int64_t i = 0; i < type->AsArrayOrDie()->size(); ++i) {
+    Node* array_index = function->AddNode(std::make_unique<Literal>(
+        SourceInfo(), Value(UBits(i, 64)),
+        absl::StrFormat("split_array_index_%s__%d__", original->GetName(), i),
+        function));
+    Node* element = function->AddNode(std::make_unique<ArrayIndex>(
+        SourceInfo(), original, absl::MakeConstSpan({array_index}),
+        absl::StrFormat("split_array_%s__%i__", original->GetName(), i),
+        function));
+    index.push_back(i);
+    XLS_RETURN_IF_ERROR(
+        SplitToBits(function, element, max_bits, index, slices));
+    index.pop_back();
+  }
+  return absl::OkStatus();
+}
+
+// A function computing the results of two functions on the same inputs.
+struct Miter {
+  Function* function;
+  Node* a_result;
+  Node* b_result;
+};
+
+// Clones "a" into "package" and patches "b" into the clone, wiring up the
+// parameters of "b" to those at the same index.
+absl::StatusOr<Miter> BuildMiter(Function* a, Function* b, Package* package) {
   XLS_ASSIGN_OR_RETURN(
       Function * to_test_func,
-      a->Clone(absl::StrFormat("%s_test", a->name()), to_test.get()));
+      a->Clone(absl::StrFormat("%s_test", a->name()), package));
 
   XLS_RET_CHECK(
       a->return_value()->GetType()->IsEqualTo(b->return_value()->GetType()))
@@ -110,8 +200,8 @@ absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
 
   // Patch b into to_test. Wire up parameters to those at the same index in the
   // to_test_function.  We do this so we can test whether the two functions are
-  // semantically equivalent by making a single Z3-AST function and checking a
-  // single eq node's value.
+  // semantically equivalent by making a single Z3-AST function and checking
+  // eq nodes' values.
   absl::flat_hash_map<Node*, Node*> node_map;
   for (Node* n : TopoSort(b)) {
     if (n->Is<Param>()) {
@@ -127,21 +217,77 @@ absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
     XLS_ASSIGN_OR_RETURN(node_map[n],
                          n->CloneInNewFunction(new_ops, to_test_func));
   }
+  return Miter{.function = to_test_func,
+               .a_result = to_test_func->return_value(),
+               .b_result = node_map.at(b->return_value())};
+}
+
+// Proves that the node named "check_name" in a copy of "miter" is always true.
+// Only the logic feeding the check is kept in the copy. Counterexamples are
+// keyed by the params of "a".
+absl::StatusOr<ProverResult> ProveSlice(Function* miter,
+                                        std::string_view check_name,
+                                        Function* a, absl::Duration timeout) {
+  Package package(absl::StrFormat("%s_slice", miter->package()->name()));
+  XLS_ASSIGN_OR_RETURN(Function * f, miter->Clone(miter->name(), &package));
+  XLS_ASSIGN_OR_RETURN(Node * check, f->GetNode(check_name));
+  XLS_RETURN_IF_ERROR(f->set_return_value(check));
+  for (Node* n : ReverseTopoSort(f)) {
+    if (n != check && !n->Is<Param>() && n->users().empty()) {
+      XLS_RETURN_IF_ERROR(f->RemoveNode(n));
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(
+      ProverResult result,
+      TryProve(f, check, Predicate::NotEqualToZero(), timeout));
+  if (std::holds_alternative<ProvenFalse>(result)) {
+    ProvenFalse& proven_false = std::get<ProvenFalse>(result);
+    if (proven_false.counterexample.ok()) {
+      absl::flat_hash_map<const Param*, Value> remapped;
+      for (const auto& [param, value] : *proven_false.counterexample) {
+        XLS_ASSIGN_OR_RETURN(int64_t index,
+                             f->GetParamIndex(const_cast<Param*>(param)));
+        remapped[a->param(index)] = value;
+      }
+      proven_false.counterexample = std::move(remapped);
+    }
+  }
+  return result;
+}
+}  // namespace
+
+absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
+                                                 absl::Duration timeout) {
+  std::unique_ptr<Package> to_test = std::make_unique<Package>(
+      absl::StrFormat("%s_tester", a->package()->name()));
+  XLS_ASSIGN_OR_RETURN(Miter miter, BuildMiter(a, b, to_test.get()));
+  Function* to_test_func = miter.function;
 
   // Add check, coerce any tuples/arays into bit-arrays since z3 ir-translator
   // doesn't support eq of tuples/arrays yet.
   XLS_ASSIGN_OR_RETURN(
       Node * original_result,
-      FlattenToBits(to_test_func, to_test_func->return_value()));
+      FlattenToBits(to_test_func, miter.a_result));
   XLS_ASSIGN_OR_RETURN(
       Node * transformed_result,
-      FlattenToBits(to_test_func, node_map[b->return_value()]));
+      FlattenToBits(to_test_func, miter.b_result));
   Node* new_ret = to_test_func->AddNode(std::make_unique<CompareOp>(
       SourceInfo(), original_result, transformed_result, Op::kEq, "TestCheck",
       to_test_func));
   XLS_RETURN_IF_ERROR(to_test_func->set_return_value(new_ret));
+
+  // The translator shares the translations of structurally identical nodes, so
+  // the parts of "b" which are unchanged from "a" map onto the ASTs of "a". If
+  // that covers the whole result there is nothing left to solve.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
+                       IrTranslator::CreateAndTranslate(to_test_func));
+  if (translator->GetTranslation(original_result) ==
+      translator->GetTranslation(transformed_result)) {
+    return ProvenTrue();
+  }
   // Run prover
-  return TryProve(to_test_func, new_ret, Predicate::NotEqualToZero(), timeout);
+  return TryProve(std::move(translator), new_ret, Predicate::NotEqualToZero(),
+                  timeout);
 }
 
 absl::StatusOr<ProverResult> TryProveEquivalence(
@@ -159,5 +305,195 @@ absl::StatusOr<ProverResult> TryProveEquivalence(
   return TryProveEquivalence(original, to_transform_func, timeout);
 }
 
+absl::StatusOr<ProverResult> TryProveEquivalenceInParallel(
+    Function* a, Function* b, const ParallelEquivalenceOptions& options) {
+  XLS_RET_CHECK_GE(options.worker_count, 1);
+  XLS_RET_CHECK(!options.max_bits_per_query.has_value() ||
+                *options.max_bits_per_query >= 1);
+  std::unique_ptr<Package> to_test = std::make_unique<Package>(
+      absl::StrFormat("%s_tester", a->package()->name()));
+  XLS_ASSIGN_OR_RETURN(Miter miter, BuildMiter(a, b, to_test.get()));
+  Function* to_test_func = miter.function;
+
+  std::vector<OutputSlice> a_slices;
+  std::vector<OutputSlice> b_slices;
+  std::vector<int64_t> index;
+  XLS_RETURN_IF_ERROR(SplitToBits(to_test_func, miter.a_result,
+                                  options.max_bits_per_query, index,
+                                  a_slices));
+  XLS_RETURN_IF_ERROR(SplitToBits(to_test_func, miter.b_result,
+                                  options.max_bits_per_query, index,
+                                  b_slices));
+  XLS_RET_CHECK_EQ(a_slices.size(), b_slices.size());
+  std::vector<std::string> check_names;
+  check_names.reserve(a_slices.size());
+  for (int64_t i = 0; i < a_slices.size(); ++i) {
+    Node* check = to_test_func->AddNode(std::make_unique<CompareOp>(
+        SourceInfo(), a_slices[i].value, b_slices[i].value, Op::kEq,
+        absl::StrFormat("TestCheck_%d", i), to_test_func));
+    check_names.push_back(check->GetName());
+  }
+
+  // Sub-queries are handed out in order; once a counterexample (or error) is
+  // found no further sub-queries are started. `to_test_func` is only read
+  // while the workers run.
+  absl::Mutex mutex;
+  int64_t next_query = 0;
+  std::optional<int64_t> failed_query;
+  std::optional<absl::StatusOr<ProverResult>> failure;
+  auto worker = [&]() {
+    while (true) {
+      int64_t i;
+      {
+        absl::MutexLock lock(&mutex);
+        if (failure.has_value() || next_query >= check_names.size()) {
+          return;
+        }
+        i = next_query++;
+      }
+      absl::StatusOr<ProverResult> result =
+          ProveSlice(to_test_func, check_names[i], a,
+                     options.timeout_per_query);
+      if (result.ok() && std::holds_alternative<ProvenTrue>(*result)) {
+        continue;
+      }
+      absl::MutexLock lock(&mutex);
+      // Report the earliest failing slice among those that have finished.
+      if (!failed_query.has_value() || i < *failed_query) {
+        failed_query = i;
+        failure = std::move(result);
+      }
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t t = 0;
+       t < std::min<int64_t>(options.worker_count, check_names.size()); ++t) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  absl::MutexLock lock(&mutex);
+  if (!failure.has_value()) {
+    return ProvenTrue();
+  }
+  XLS_ASSIGN_OR_RETURN(ProverResult result, std::move(*failure));
+  ProvenFalse& proven_false = std::get<ProvenFalse>(result);
+  proven_false.message = absl::StrFormat(
+      "Mismatch in %s of the return value:\n%s",
+      a_slices[*failed_query].description, proven_false.message);
+  return result;
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<IncrementalEquivalenceChecker>>
+IncrementalEquivalenceChecker::Create(Function* reference,
+                                      absl::Duration timeout_per_check) {
+  auto snapshots = std::make_unique<Package>(
+      absl::StrFormat("%s_snapshots", reference->package()->name()));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> context_owner,
+                       IrTranslator::CreateAndTranslate(/*source=*/nullptr));
+  context_owner->SetTimeout(timeout_per_check);
+  auto checker = absl::WrapUnique(new IncrementalEquivalenceChecker(
+      std::move(snapshots), std::move(context_owner)));
+
+  XLS_ASSIGN_OR_RETURN(
+      checker->reference_,
+      reference->Clone(absl::StrFormat("%s_reference", reference->name()),
+                       checker->snapshots_.get()));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
+                       IrTranslator::CreateAndTranslateWithCache(
+                           checker->ctx(), checker->reference_,
+                           /*imported_params=*/std::nullopt, &checker->cache_));
+  for (Param* param : checker->reference_->params()) {
+    checker->params_.push_back(translator->GetTranslation(param));
+  }
+  checker->reference_result_ = translator->FlattenValue(
+      checker->reference_->return_value()->GetType(),
+      translator->GetReturnNode());
+  checker->solver_ = CreateSolver(checker->ctx(), /*num_threads=*/1);
+  return checker;
+}
+
+IncrementalEquivalenceChecker::~IncrementalEquivalenceChecker() {
+  if (solver_ != nullptr) {
+    Z3_solver_dec_ref(ctx(), solver_);
+  }
+}
+
+absl::StatusOr<ProverResult> IncrementalEquivalenceChecker::Check(
+    Function* f) {
+  XLS_RET_CHECK(f->return_value()->GetType()->IsEqualTo(
+      reference_->return_value()->GetType()))
+      << f->return_value()->GetType() << " vs "
+      << reference_->return_value()->GetType();
+  XLS_RET_CHECK_EQ(f->params().size(), reference_->params().size());
+  for (int64_t i = 0; i < f->params().size(); ++i) {
+    XLS_RET_CHECK(
+        f->param(i)->GetType()->IsEqualTo(reference_->param(i)->GetType()));
+  }
+
+  XLS_ASSIGN_OR_RETURN(
+      Function * snapshot,
+      f->Clone(absl::StrFormat("%s_check_%d", f->name(), check_count_++),
+               snapshots_.get()));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<IrTranslator> translator,
+      IrTranslator::CreateAndTranslateWithCache(
+          ctx(), snapshot, absl::MakeConstSpan(params_), &cache_));
+  std::vector<Z3_ast> result = translator->FlattenValue(
+      snapshot->return_value()->GetType(), translator->GetReturnNode());
+  XLS_RET_CHECK_EQ(result.size(), reference_result_.size());
+
+  // The versions differ iff some bit of the results differs.
+  std::vector<Z3_ast> differences;
+  differences.reserve(result.size());
+  for (int64_t i = 0; i < result.size(); ++i) {
+    if (result[i] != reference_result_[i]) {
+      differences.push_back(
+          Z3_mk_not(ctx(), Z3_mk_eq(ctx(), result[i], reference_result_[i])));
+    }
+  }
+  if (differences.empty()) {
+    // The translations are identical so no solving is needed.
+    return ProvenTrue();
+  }
+  Z3_ast differs =
+      Z3_mk_or(ctx(), differences.size(), differences.data());
+
+  Z3_ast active = Z3_mk_fresh_const(ctx(), "check", Z3_mk_bool_sort(ctx()));
+  Z3_solver_assert(ctx(), solver_, Z3_mk_implies(ctx(), active, differs));
+  // Retire the assumption so it doesn't constrain later checks.
+  auto retire = absl::Cleanup(
+      [&] { Z3_solver_assert(ctx(), solver_, Z3_mk_not(ctx(), active)); });
+  Z3_lbool satisfiable =
+      Z3_solver_check_assumptions(ctx(), solver_, 1, &active);
+  switch (satisfiable) {
+    case Z3_L_FALSE:
+      return ProvenTrue();
+    case Z3_L_TRUE: {
+      absl::StatusOr<absl::flat_hash_map<const Param*, Value>> counterexample =
+          absl::flat_hash_map<const Param*, Value>();
+      Z3_model model = Z3_solver_get_model(ctx(), solver_);
+      for (int64_t i = 0; i < f->params().size(); ++i) {
+        absl::StatusOr<Value> value =
+            NodeValue(ctx(), model, params_[i], f->param(i)->GetType());
+        if (!value.ok()) {
+          counterexample = std::move(value).status();
+          break;
+        }
+        counterexample->emplace(f->param(i), *std::move(value));
+      }
+      return ProvenFalse{
+          .counterexample = std::move(counterexample),
+          .message = SolverResultToString(ctx(), solver_, satisfiable),
+      };
+    }
+    case Z3_L_UNDEF:
+      return absl::DeadlineExceededError("Z3 solver timed out");
+  }
+  return absl::InternalError(
+      absl::StrFormat("Invalid Z3 result: %d", satisfiable));
+}
 
 }  // namespace xls::solvers::z3
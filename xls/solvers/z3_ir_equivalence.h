@@ -15,7 +15,12 @@
 #ifndef XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
 #define XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
 
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -23,6 +28,7 @@
 #include "xls/ir/function.h"
 #include "xls/ir/package.h"
 #include "xls/solvers/z3_ir_translator.h"
+#include "external/z3/src/api/z3_api.h"
 
 namespace xls::solvers::z3 {
 
@@ -50,6 +56,85 @@ absl::StatusOr<ProverResult> TryProveEquivalence(
     Function* a, Function* b,
     absl::Duration timeout = absl::InfiniteDuration());
 
+struct ParallelEquivalenceOptions {
+  // Number of threads used to run the sub-queries.
+  int64_t worker_count = 1;
+
+  // How long each sub-query may run before it is abandoned.
+  absl::Duration timeout_per_query = absl::InfiniteDuration();
+
+  // If set, bits-typed outputs (and bits-typed tuple/array elements) wider
+  // than this are further split into slices of at most this many bits.
+  std::optional<int64_t> max_bits_per_query;
+};
+
+// Verify that both functions have the same behaviors by splitting the check
+// into one sub-query per leaf element of the return type (split further into
+// bit slices per `options.max_bits_per_query`). Each sub-query only includes
+// the logic feeding its outputs and is proven in its own Z3 context, with up to
+// `options.worker_count` sub-queries in flight at once. Once any sub-query
+// finds a counterexample no further sub-queries are started and that
+// counterexample (keyed by the params of `a`) is returned.
+//
+// This call does not alter either function.
+absl::StatusOr<ProverResult> TryProveEquivalenceInParallel(
+    Function* a, Function* b, const ParallelEquivalenceOptions& options);
+
+// Checks a sequence of versions of a function (e.g., the function after each
+// pass of a pipeline) for equivalence with a reference version, reusing work
+// between checks. A single Z3 context and solver are kept alive across checks
+// and the nodes of each version which are structurally identical to nodes of
+// earlier versions reuse their translations (see TranslationCache), so only
+// the parts of the function which changed are translated again.
+//
+// Each check is guarded by a fresh assumption literal rather than a push/pop
+// scope: popping a scope frees the Z3 ASTs created within it, which would
+// invalidate the cached translations, and lemmas learned by the solver remain
+// usable by later checks. The literal is disabled once the check completes.
+//
+// Every checked version is copied into a package owned by the checker (the
+// cache refers to its nodes), so memory use grows with the number of checks.
+class IncrementalEquivalenceChecker {
+ public:
+  // Creates a checker whose reference is a copy of `reference`. Each call to
+  // Check may take at most `timeout_per_check`.
+  static absl::StatusOr<std::unique_ptr<IncrementalEquivalenceChecker>> Create(
+      Function* reference,
+      absl::Duration timeout_per_check = absl::InfiniteDuration());
+
+  ~IncrementalEquivalenceChecker();
+
+  // Verify that `f` has the same behavior as the reference. `f` must have the
+  // same type signature as the reference. `f` is not altered and may be
+  // modified after this call. Counterexamples are keyed by the params of `f`.
+  absl::StatusOr<ProverResult> Check(Function* f);
+
+  // The number of nodes across all versions (including the reference) whose
+  // translations were reused or had to be computed, respectively. Params and
+  // side-effecting nodes are not counted.
+  int64_t reused_translation_count() const { return cache_.hit_count(); }
+  int64_t new_translation_count() const { return cache_.miss_count(); }
+
+ private:
+  IncrementalEquivalenceChecker(std::unique_ptr<Package> snapshots,
+                                std::unique_ptr<IrTranslator> context_owner)
+      : snapshots_(std::move(snapshots)),
+        context_owner_(std::move(context_owner)) {}
+
+  Z3_context ctx() { return context_owner_->ctx(); }
+
+  std::unique_ptr<Package> snapshots_;
+  // Owns the Z3 context shared by all translations.
+  std::unique_ptr<IrTranslator> context_owner_;
+  TranslationCache cache_;
+  Function* reference_ = nullptr;
+  std::vector<Z3_ast> params_;
+  // The bits of the reference's return value.
+  std::vector<Z3_ast> reference_result_;
+  Z3_solver solver_ = nullptr;
+  int64_t check_count_ = 0;
+};
+
 }  // namespace xls::solvers::z3
 
 #endif  // XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
@@ -17,6 +17,7 @@
 #include <cstdint>
 #include <memory>
 #include <string_view>
+#include <variant>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest-spi.h"
@@ -350,5 +351,105 @@ TEST_F(EquivalenceTest, MultiFunctionDetectsDifference) {
   EXPECT_THAT(TryProveEquivalence(f1, f2), IsOkAndHolds(IsProvenFalse()));
 }
 
+TEST_F(EquivalenceTest, ParallelProvesEquivalence) {
+  std::unique_ptr<Package> p1 = CreatePackage();
+  FunctionBuilder fb1(TestName(), p1.get());
+  BValue x1 = fb1.Param("x", p1->GetBitsType(32));
+  BValue y1 = fb1.Param("y", p1->GetBitsType(32));
+  fb1.Tuple(
+      {fb1.Add(x1, y1), fb1.Array({fb1.UMul(x1, y1), x1}, p1->GetBitsType(32)),
+       fb1.Tuple({})});
+
+  std::unique_ptr<Package> p2 = CreatePackage();
+  FunctionBuilder fb2(TestName(), p2.get());
+  BValue x2 = fb2.Param("x", p2->GetBitsType(32));
+  BValue y2 = fb2.Param("y", p2->GetBitsType(32));
+  fb2.Tuple(
+      {fb2.Add(y2, x2), fb2.Array({fb2.UMul(y2, x2), x2}, p2->GetBitsType(32)),
+       fb2.Tuple({})});
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f1, fb1.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f2, fb2.Build());
+
+  EXPECT_THAT(TryProveEquivalenceInParallel(
+                  f1, f2, {.worker_count = 4, .max_bits_per_query = 8}),
+              IsOkAndHolds(IsProvenTrue()));
+  EXPECT_THAT(TryProveEquivalenceInParallel(f1, f2, {.worker_count = 1}),
+              IsOkAndHolds(IsProvenTrue()));
+}
+
+TEST_F(EquivalenceTest, ParallelDetectsDifference) {
+  std::unique_ptr<Package> p1 = CreatePackage();
+  FunctionBuilder fb1(TestName(), p1.get());
+  BValue x1 = fb1.Param("x", p1->GetBitsType(32));
+  BValue y1 = fb1.Param("y", p1->GetBitsType(32));
+  fb1.Tuple({fb1.Add(x1, y1), fb1.Subtract(x1, y1)});
+
+  std::unique_ptr<Package> p2 = CreatePackage();
+  FunctionBuilder fb2(TestName(), p2.get());
+  BValue x2 = fb2.Param("x", p2->GetBitsType(32));
+  BValue y2 = fb2.Param("y", p2->GetBitsType(32));
+  fb2.Tuple({fb2.Add(x2, y2), fb2.Subtract(y2, x2)});
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f1, fb1.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f2, fb2.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ProverResult result,
+      TryProveEquivalenceInParallel(f1, f2, {.worker_count = 2}));
+  EXPECT_THAT(result, IsProvenFalse(testing::HasSubstr("element {1}")));
+  const ProvenFalse& proven_false = std::get<ProvenFalse>(result);
+  XLS_ASSERT_OK(proven_false.counterexample.status());
+  EXPECT_TRUE(proven_false.counterexample->contains(f1->param(0)));
+  EXPECT_TRUE(proven_false.counterexample->contains(f1->param(1)));
+}
+
+TEST_F(EquivalenceTest, IncrementalCheckerReusesTranslations) {
+  std::unique_ptr<Package> p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue product = fb.UMul(x, y);
+  fb.Tuple({fb.Add(product, x), fb.Subtract(product, y)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalEquivalenceChecker> checker,
+      IncrementalEquivalenceChecker::Create(f));
+  int64_t reference_translations = checker->new_translation_count();
+
+  // An unchanged function reuses every translation.
+  EXPECT_THAT(checker->Check(f), IsOkAndHolds(IsProvenTrue()));
+  EXPECT_EQ(checker->new_translation_count(), reference_translations);
+
+  // Commuting the add only translates the add and the nodes which use it.
+  Node* add = f->return_value()->operand(0);
+  XLS_ASSERT_OK(
+      add->ReplaceUsesWithNew<BinOp>(add->operand(1), add->operand(0), Op::kAdd)
+          .status());
+  XLS_ASSERT_OK(f->RemoveNode(add));
+  int64_t reused_before = checker->reused_translation_count();
+  EXPECT_THAT(checker->Check(f), IsOkAndHolds(IsProvenTrue()));
+  EXPECT_GT(checker->reused_translation_count(), reused_before);
+  EXPECT_LT(checker->new_translation_count(), 2 * reference_translations);
+
+  // Breaking the subtract is caught, with a counterexample in terms of `f`.
+  Node* sub = f->return_value()->operand(1);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * swapped_sub,
+      sub->ReplaceUsesWithNew<BinOp>(sub->operand(1), sub->operand(0),
+                                     Op::kSub));
+  XLS_ASSERT_OK_AND_ASSIGN(ProverResult result, checker->Check(f));
+  ASSERT_THAT(result, IsProvenFalse());
+  const ProvenFalse& proven_false = std::get<ProvenFalse>(result);
+  XLS_ASSERT_OK(proven_false.counterexample.status());
+  EXPECT_TRUE(proven_false.counterexample->contains(f->param(0)));
+  EXPECT_TRUE(proven_false.counterexample->contains(f->param(1)));
+
+  // A failed check doesn't constrain later ones.
+  XLS_ASSERT_OK(swapped_sub->ReplaceUsesWith(sub));
+  EXPECT_THAT(checker->Check(f), IsOkAndHolds(IsProvenTrue()));
+}
+
 }  // namespace
 }  // namespace xls::solvers::z3
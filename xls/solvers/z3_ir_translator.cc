@@ -46,6 +46,8 @@
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/solvers/z3_op_translator.h"
@@ -150,7 +152,8 @@ absl::StatusOr<std::unique_ptr<IrTranslator>> IrTranslator::CreateAndTranslate(
   translator->allow_unsupported_ = allow_unsupported;
   if (source != nullptr) {
     XLS_RET_CHECK(!source->IsBlock());
-    XLS_RETURN_IF_ERROR(source->Accept(translator.get()));
+    XLS_RETURN_IF_ERROR(
+        translator->TranslateWithCache(&translator->term_cache_));
   }
   return translator;
 }
@@ -173,10 +176,79 @@ absl::StatusOr<std::unique_ptr<IrTranslator>> IrTranslator::CreateAndTranslate(
       absl::WrapUnique(new IrTranslator(ctx, function_base, imported_params));
   translator->allow_unsupported_ = allow_unsupported;
   XLS_RET_CHECK(!function_base->IsBlock());
-  XLS_RETURN_IF_ERROR(function_base->Accept(translator.get()));
+  XLS_RETURN_IF_ERROR(translator->TranslateWithCache(&translator->term_cache_));
+  return translator;
+}
+
+absl::StatusOr<std::unique_ptr<IrTranslator>>
+IrTranslator::CreateAndTranslateWithCache(
+    Z3_context ctx, FunctionBase* function_base,
+    std::optional<absl::Span<const Z3_ast>> imported_params,
+    TranslationCache* cache, bool allow_unsupported) {
+  auto translator =
+      absl::WrapUnique(new IrTranslator(ctx, function_base, imported_params));
+  translator->allow_unsupported_ = allow_unsupported;
+  XLS_RET_CHECK(!function_base->IsBlock());
+  XLS_RETURN_IF_ERROR(translator->TranslateWithCache(cache));
   return translator;
 }
 
+absl::Status IrTranslator::TranslateWithCache(TranslationCache* cache) {
+  std::vector<Z3_ast> operands;
+  for (Node* node : TopoSort(xls_function_)) {
+    bool cacheable = !node->Is<Param>() && !node->Is<Literal>() &&
+                     !OpIsSideEffecting(node->op());
+    operands.clear();
+    for (Node* operand : node->operands()) {
+      auto it = translations_.find(operand);
+      if (it == translations_.end()) {
+        cacheable = false;
+        break;
+      }
+      operands.push_back(it->second);
+    }
+    if (cacheable) {
+      if (std::optional<Z3_ast> cached = cache->Lookup(node, operands)) {
+        NoteTranslation(node, *cached);
+        MarkVisited(node);
+        continue;
+      }
+    }
+    XLS_RETURN_IF_ERROR(node->VisitSingleNode(this));
+    MarkVisited(node);
+    if (cacheable) {
+      auto it = translations_.find(node);
+      if (it != translations_.end()) {
+        cache->Insert(node, operands, it->second);
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+std::optional<Z3_ast> TranslationCache::Lookup(
+    Node* node, absl::Span<const Z3_ast> operands) {
+  auto it = entries_.find(std::make_pair(
+      node->op(), std::vector<Z3_ast>(operands.begin(), operands.end())));
+  if (it != entries_.end()) {
+    for (const Entry& entry : it->second) {
+      if (entry.node->IsDefinitelyEqualTo(node)) {
+        ++hit_count_;
+        return entry.translation;
+      }
+    }
+  }
+  ++miss_count_;
+  return std::nullopt;
+}
+
+void TranslationCache::Insert(Node* node, absl::Span<const Z3_ast> operands,
+                              Z3_ast translation) {
+  entries_[std::make_pair(node->op(), std::vector<Z3_ast>(operands.begin(),
+                                                          operands.end()))]
+      .push_back(Entry{.node = node, .translation = translation});
+}
+
 absl::Status IrTranslator::Retranslate(
     const absl::flat_hash_map<const Node*, Z3_ast>& replacements) {
   ResetVisitedState();
@@ -1704,6 +1776,19 @@ absl::StatusOr<ProverResult> TryProve(FunctionBase* f, Node* subject,
                              allow_unsupported);
 }
 
+absl::StatusOr<ProverResult> TryProve(std::unique_ptr<IrTranslator> translator,
+                                      Node* subject, Predicate p,
+                                      absl::Duration timeout) {
+  FunctionBase* f = translator->xls_function();
+  XLS_RET_CHECK(f != nullptr);
+  XLS_RET_CHECK_EQ(subject->function_base(), f);
+  translator->SetTimeout(timeout);
+  PredicateOfNode term = {.subject = subject, .p = std::move(p)};
+  return TryProveCombination(f, std::move(translator),
+                             absl::MakeConstSpan(&term, 1),
+                             PredicateCombination::kConjunction);
+}
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
@@ -25,6 +25,7 @@
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -40,6 +41,7 @@
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "external/z3/src/api/z3.h"  // IWYU pragma: keep
@@ -58,8 +60,52 @@ enum class PredicateKind : uint8_t {
   kUnsignedLessOrEqual,     // vs some given (constant) value
 };
 
+// Records Z3 translations of nodes so that structurally identical nodes in
+// later translations (in the same Z3 context) can reuse them rather than being
+// translated again. Two nodes are structurally identical if they have the same
+// op, types and attributes (see Node::IsDefinitelyEqualTo) and their operands
+// have the same translations, so an unchanged subgraph of a new version of a
+// function maps onto the existing Z3 AST wholesale.
+//
+// The cache refers to the nodes it records, so they must outlive it. Params
+// and side-effecting nodes are never shared, nor are literals, which are cheap
+// to translate and whose equal values Z3 already maps to the same AST.
+class TranslationCache {
+ public:
+  TranslationCache() = default;
+
+  // Returns the recorded translation of a node structurally identical to
+  // `node` whose operands were translated to `operands`, if any.
+  std::optional<Z3_ast> Lookup(Node* node, absl::Span<const Z3_ast> operands);
+
+  // Records `translation` as the translation of `node` with operand
+  // translations `operands`.
+  void Insert(Node* node, absl::Span<const Z3_ast> operands,
+              Z3_ast translation);
+
+  int64_t hit_count() const { return hit_count_; }
+  int64_t miss_count() const { return miss_count_; }
+
+ private:
+  struct Entry {
+    Node* node;
+    Z3_ast translation;
+  };
+
+  absl::flat_hash_map<std::pair<Op, std::vector<Z3_ast>>, std::vector<Entry>>
+      entries_;
+  int64_t hit_count_ = 0;
+  int64_t miss_count_ = 0;
+};
+
 // Translates a function into its Z3 equivalent bit-vector circuit for use in
 // theorem proving.
+//
+// Translations of functions are hash-consed: each translator keeps a
+// TranslationCache of the nodes it has translated, so a node structurally
+// identical to an earlier one (e.g. a repeated bit slice of the same operand,
+// or the copy of a subgraph shared by both sides of an equivalence miter)
+// reuses the earlier AST rather than being translated again.
 class IrTranslator : public DfsVisitorWithDefault {
  public:
   // Creates a translator and uses it to translate the given function into a Z3
@@ -82,6 +128,17 @@ class IrTranslator : public DfsVisitorWithDefault {
   static absl::StatusOr<std::unique_ptr<IrTranslator>> CreateAndTranslate(
       Z3_context ctx, Node* source, bool allow_unsupported = false);
 
+  // Like the context-borrowing CreateAndTranslate() above, but reuses the
+  // translations in `cache` for nodes structurally identical to ones
+  // translated before and records the translations of all other nodes in it.
+  // If `imported_params` is std::nullopt fresh Z3 constants are created for
+  // the params. `cache` must only be shared between translators using `ctx`.
+  static absl::StatusOr<std::unique_ptr<IrTranslator>>
+  CreateAndTranslateWithCache(
+      Z3_context ctx, FunctionBase* function_base,
+      std::optional<absl::Span<const Z3_ast>> imported_params,
+      TranslationCache* cache, bool allow_unsupported = false);
+
   ~IrTranslator() override;
 
   // Sets the amount of time to allow Z3 to execute before aborting.
@@ -211,12 +268,19 @@ class IrTranslator : public DfsVisitorWithDefault {
 
   FunctionBase* xls_function() { return xls_function_; }
 
+  // The cache through which the nodes of the function were translated.
+  const TranslationCache& term_cache() const { return term_cache_; }
+
  private:
   IrTranslator(Z3_config config, FunctionBase* source);
 
   IrTranslator(Z3_context ctx, FunctionBase* source,
                std::optional<absl::Span<const Z3_ast>> imported_params);
 
+  // Translates the nodes of the function in topological order, consulting
+  // `cache` before translating each one.
+  absl::Status TranslateWithCache(TranslationCache* cache);
+
   // Gets the bit count associated with the bit-vector-sort Z3 node "arg".
   // (Arg must be known to be of bit-vector sort.)
   int64_t GetBvBitCount(Z3_ast arg);
@@ -312,6 +376,7 @@ class IrTranslator : public DfsVisitorWithDefault {
   std::optional<absl::Span<const Z3_ast>> imported_params_;
   FunctionBase* xls_function_;
   int current_symbol_;
+  TranslationCache term_cache_;
 };
 
 // Describes a predicate to compute about a subject node in an XLS IR function.
@@ -427,6 +492,13 @@ absl::StatusOr<ProverResult> TryProve(FunctionBase* f, Node* subject,
                                       Predicate p, int64_t rlimit,
                                       bool allow_unsupported = false);
 
+// As above, but reuses the translation of the function made by "translator"
+// rather than translating it again. "subject" must be a node of
+// translator->xls_function().
+absl::StatusOr<ProverResult> TryProve(std::unique_ptr<IrTranslator> translator,
+                                      Node* subject, Predicate p,
+                                      absl::Duration timeout);
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
@@ -2374,5 +2374,31 @@ TEST_F(Z3IrTranslatorTest, HandlesComplexAggregateEqAndNe) {
   EXPECT_THAT(proven, IsProvenTrue());
 }
 
+TEST_F(Z3IrTranslatorTest, StructurallyIdenticalNodesShareTranslations) {
+  const std::string program = R"(
+fn f(x: bits[32], y: bits[8]) -> bits[16] {
+  bit_slice.1: bits[8] = bit_slice(x, start=4, width=8)
+  bit_slice.2: bits[8] = bit_slice(x, start=4, width=8)
+  bit_slice.3: bits[8] = bit_slice(x, start=0, width=8)
+  umul.4: bits[8] = umul(bit_slice.1, y)
+  umul.5: bits[8] = umul(bit_slice.2, y)
+  ret concat.6: bits[16] = concat(umul.4, umul.5)
+})";
+  std::unique_ptr<Package> package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(program, package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<IrTranslator> translator,
+                           IrTranslator::CreateAndTranslate(f));
+  // bit_slice.2 and umul.5 reuse the translations of bit_slice.1 and umul.4.
+  EXPECT_EQ(translator->term_cache().hit_count(), 2);
+  XLS_ASSERT_OK_AND_ASSIGN(Node * umul_4, f->GetNode("umul.4"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * umul_5, f->GetNode("umul.5"));
+  EXPECT_EQ(translator->GetTranslation(umul_4),
+            translator->GetTranslation(umul_5));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * bit_slice_1, f->GetNode("bit_slice.1"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * bit_slice_3, f->GetNode("bit_slice.3"));
+  EXPECT_NE(translator->GetTranslation(bit_slice_1),
+            translator->GetTranslation(bit_slice_3));
+}
+
 }  // namespace
 }  // namespace xls
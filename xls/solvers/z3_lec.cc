@@ -33,9 +33,12 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "xls/codegen/vast.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/format_preference.h"
@@ -43,6 +46,7 @@
 #include "xls/ir/node.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
 #include "xls/netlist/netlist.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/solvers/z3_ir_translator.h"
@@ -71,7 +75,8 @@ bool CheckingSingleStage(std::optional<PipelineSchedule> schedule,
 absl::StatusOr<std::unique_ptr<Lec>> Lec::Create(const LecParams& params) {
   auto lec = absl::WrapUnique<Lec>(new Lec(params.ir_function, params.netlist,
                                            params.netlist_module_name,
-                                           std::nullopt, 0));
+                                           std::nullopt, 0,
+                                           params.solver_threads));
   XLS_RETURN_IF_ERROR(lec->Init());
   return lec;
 }
@@ -82,19 +87,21 @@ absl::StatusOr<std::unique_ptr<Lec>> Lec::CreateForStage(
     const LecParams& params, const PipelineSchedule& schedule, int stage) {
   auto lec = absl::WrapUnique<Lec>(new Lec(params.ir_function, params.netlist,
                                            params.netlist_module_name, schedule,
-                                           stage));
+                                           stage, params.solver_threads));
   XLS_RETURN_IF_ERROR(lec->Init());
   return lec;
 }
 
 Lec::Lec(Function* ir_function, Netlist* netlist,
          const std::string& netlist_module_name,
-         std::optional<PipelineSchedule> schedule, int stage)
+         std::optional<PipelineSchedule> schedule, int stage,
+         int solver_threads)
     : ir_function_(ir_function),
       netlist_(netlist),
       netlist_module_name_(netlist_module_name),
       schedule_(schedule),
-      stage_(stage) {}
+      stage_(stage),
+      solver_threads_(solver_threads) {}
 
 Lec::~Lec() {
   if (model_) {
@@ -153,7 +160,9 @@ absl::Status Lec::Init() {
 
   Z3_ast eval_node = Z3_mk_and(ctx(), eq_nodes.size(), eq_nodes.data());
   eval_node = Z3_mk_not(ctx(), eval_node);
-  solver_ = CreateSolver(ctx(), std::thread::hardware_concurrency());
+  solver_ = CreateSolver(ctx(), solver_threads_ > 0
+                                    ? solver_threads_
+                                    : std::thread::hardware_concurrency());
   Z3_solver_assert(ctx(), solver_.value(), eval_node);
 
   return absl::OkStatus();
@@ -279,7 +288,8 @@ absl::Status Lec::AddConstraints(Function* constraints) {
 
 bool Lec::Run() {
   LOG(INFO) << "Beginning execution";
-  satisfiable_ = Z3_solver_check(ctx(), solver_.value()) == Z3_L_TRUE;
+  check_result_ = Z3_solver_check(ctx(), solver_.value());
+  satisfiable_ = check_result_ == Z3_L_TRUE;
   if (satisfiable_) {
     model_ = Z3_solver_get_model(ctx(), solver_.value());
     Z3_model_inc_ref(ctx(), model_.value());
@@ -515,6 +525,117 @@ std::string Lec::NodeToNetlistName(const Node* node,
   return name;
 }
 
+absl::StatusOr<StagedLecResult> LecAllStages(const LecParams& params,
+                                             const PipelineSchedule& schedule,
+                                             const StagedLecOptions& options) {
+  XLS_RET_CHECK_GE(options.worker_count, 1);
+  const int stage_count = schedule.length();
+  const int worker_count = std::min(options.worker_count, stage_count);
+  LecParams stage_params = params;
+  if (stage_params.solver_threads <= 0) {
+    stage_params.solver_threads = std::max<int>(
+        1, std::thread::hardware_concurrency() / std::max(worker_count, 1));
+  }
+
+  StagedLecResult result;
+  result.stages.assign(stage_count, StageLecOutcome::kSkipped);
+
+  // Stages are handed out in order. The calling thread watches the running
+  // solvers and interrupts them on timeout or once a stage has failed.
+  absl::Mutex mutex;
+  int next_stage = 0;
+  int running_workers = worker_count;
+  bool stop = false;
+  absl::Status error;
+  // The context of each stage being solved and the time its solve started.
+  absl::flat_hash_map<int, std::pair<Z3_context, absl::Time>> active;
+  absl::flat_hash_set<int> timed_out;
+  auto worker = [&]() {
+    while (true) {
+      int stage;
+      {
+        absl::MutexLock lock(&mutex);
+        if (stop || next_stage >= stage_count) {
+          break;
+        }
+        stage = next_stage++;
+      }
+      absl::StatusOr<std::unique_ptr<Lec>> lec =
+          Lec::CreateForStage(stage_params, schedule, stage);
+      {
+        absl::MutexLock lock(&mutex);
+        if (!lec.ok()) {
+          if (error.ok()) {
+            error = lec.status();
+          }
+          stop = true;
+          break;
+        }
+        if (stop) {
+          break;
+        }
+        active[stage] = {(*lec)->ctx(), absl::Now()};
+      }
+      bool equal = (*lec)->Run();
+      absl::MutexLock lock(&mutex);
+      active.erase(stage);
+      if ((*lec)->Undetermined()) {
+        result.stages[stage] = (stop && !timed_out.contains(stage))
+                                   ? StageLecOutcome::kSkipped
+                                   : StageLecOutcome::kUndetermined;
+      } else if (equal) {
+        result.stages[stage] = StageLecOutcome::kEquivalent;
+      } else {
+        result.stages[stage] = StageLecOutcome::kMismatch;
+        if (!result.failing_stage.has_value() ||
+            stage < *result.failing_stage) {
+          result.failing_stage = stage;
+          result.failing_lec = std::move(*lec);
+        }
+        stop = true;
+      }
+    }
+    absl::MutexLock lock(&mutex);
+    --running_workers;
+  };
+
+  // Every stage translates the same function, which may look up types of the
+  // package.
+  params.ir_package->type_manager().BeginConcurrentAccess();
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int i = 0; i < worker_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  {
+    // Interrupts are repeated on every poll as one delivered just before a
+    // solve begins may be lost.
+    constexpr absl::Duration kPollInterval = absl::Milliseconds(100);
+    absl::MutexLock lock(&mutex);
+    auto all_done = [](int* running) { return *running == 0; };
+    while (!mutex.AwaitWithTimeout(
+        absl::Condition(+all_done, &running_workers), kPollInterval)) {
+      absl::Time now = absl::Now();
+      for (const auto& [stage, ctx_and_start] : active) {
+        const auto& [ctx, start] = ctx_and_start;
+        if (options.timeout_per_stage.has_value() &&
+            now - start >= *options.timeout_per_stage) {
+          timed_out.insert(stage);
+        }
+        if (stop || timed_out.contains(stage)) {
+          Z3_interrupt(ctx);
+        }
+      }
+    }
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  params.ir_package->type_manager().EndConcurrentAccess();
+
+  XLS_RETURN_IF_ERROR(error);
+  return result;
+}
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
@@ -24,12 +24,14 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "xls/ir/node.h"
 #include "xls/ir/package.h"
 #include "xls/netlist/netlist.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/solvers/z3_ir_translator.h"
 #include "xls/solvers/z3_netlist_translator.h"
+#include "external/z3/src/api/z3_api.h"
 
 namespace xls {
 namespace solvers {
@@ -50,6 +52,10 @@ struct LecParams {
 
   // The name of the module (inside "netlist") to compare.
   std::string netlist_module_name;
+
+  // The number of threads the Z3 solver may use. If not positive, the solver
+  // uses every hardware thread.
+  int solver_threads = 0;
 };
 
 // Class for performing logical equivalence checks between a function specified
@@ -80,6 +86,10 @@ class Lec {
   // Returns true of the netlist and IR are proved to be equivalent.
   bool Run();
 
+  // Returns true if the last Run() neither proved nor disproved equivalence,
+  // e.g., because the solver was interrupted. Run() returns true in this case.
+  bool Undetermined() const { return check_result_ == Z3_L_UNDEF; }
+
   // Dumps all Z3 values corresponding to IR nodes in the input function.
   void DumpIrTree();
 
@@ -91,7 +101,7 @@ class Lec {
  private:
   Lec(Function* ir_function, netlist::rtl::Netlist* netlist,
       const std::string& netlist_module_name,
-      std::optional<PipelineSchedule> schedule, int stage);
+      std::optional<PipelineSchedule> schedule, int stage, int solver_threads);
   absl::Status Init();
   absl::Status CreateIrTranslator();
   absl::Status CreateNetlistTranslator();
@@ -157,6 +167,7 @@ class Lec {
 
   std::optional<PipelineSchedule> schedule_;
   int stage_;
+  int solver_threads_;
 
   // Z3 elements are, under the hood, void pointers, but let's respect the
   // interface and use std::optional to determine live-ness.
@@ -165,9 +176,53 @@ class Lec {
   // Satisfiable is equivalent to "model_.has_value()", but having an explicit
   // value is more understandable.
   bool satisfiable_;
+  Z3_lbool check_result_ = Z3_L_UNDEF;
   std::optional<Z3_model> model_;
 };
 
+// Options for LecAllStages().
+struct StagedLecOptions {
+  // The number of stages to prove concurrently. Unless
+  // LecParams::solver_threads is set, the hardware threads are divided evenly
+  // among the solvers of the concurrent stages.
+  int worker_count = 1;
+
+  // If set, a stage whose solver runs longer than this is interrupted and
+  // reported as undetermined.
+  std::optional<absl::Duration> timeout_per_stage;
+};
+
+// The outcome of checking a single stage with LecAllStages().
+enum class StageLecOutcome {
+  kEquivalent,
+  kMismatch,
+  // The solver neither proved nor disproved equivalence, e.g., it timed out.
+  kUndetermined,
+  // The stage was not checked (or its check was interrupted) because another
+  // stage was found to differ.
+  kSkipped,
+};
+
+struct StagedLecResult {
+  // The outcome of each stage, indexed by stage.
+  std::vector<StageLecOutcome> stages;
+
+  // The lowest-numbered stage found to differ, if any, and the Lec which found
+  // the difference (for ResultToString() and DumpIrTree()).
+  std::optional<int> failing_stage;
+  std::unique_ptr<Lec> failing_lec;
+};
+
+// Proves every pipeline stage of `schedule` with a separate Lec (and so Z3
+// context) per stage, running `options.worker_count` stages at a time on a
+// pool of threads. The IR function and netlist in `params` are shared by all
+// stages and must not be modified during the call. Once a stage is found to
+// differ no further stages are started and the solvers of the running stages
+// are interrupted.
+absl::StatusOr<StagedLecResult> LecAllStages(const LecParams& params,
+                                             const PipelineSchedule& schedule,
+                                             const StagedLecOptions& options);
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
@@ -16,17 +16,22 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/node.h"
+#include "xls/ir/op.h"
 #include "xls/netlist/cell_library.h"
 #include "xls/netlist/fake_cell_library.h"
 #include "xls/netlist/netlist.h"
 #include "xls/netlist/netlist_parser.h"
+#include "xls/scheduling/pipeline_schedule.h"
 
 namespace xls {
 namespace solvers {
@@ -34,6 +39,8 @@ namespace z3 {
 namespace {
 
 using netlist::rtl::Netlist;
+using ::testing::Each;
+using ::testing::ElementsAre;
 
 absl::StatusOr<bool> Match(const std::string& ir_text,
                            const std::string& netlist_text, bool expect_equal) {
@@ -506,6 +513,109 @@ endmodule
   }
 }
 
+// The IR and netlist of SimpleMultiStage, split into three stages.
+constexpr std::string_view kThreeStageIr = R"(
+package p
+
+top fn main(i0: bits[1], i1: bits[1], i2: bits[1], i3: bits[1]) -> bits[1] {
+  and.1: bits[1] = and(i0, i1)
+  and.2: bits[1] = and(i2, i3)
+  or.3: bits[1] = or(and.1, and.2)
+  ret not.4: bits[1] = not(or.3)
+}
+)";
+
+// `stage0_cell` is the cell computing p1_and_2; "AND" is correct.
+std::string ThreeStageNetlist(std::string_view stage0_cell) {
+  return absl::StrFormat(R"(
+module main ( clk, i3, i2, i1, i0, out_0);
+  input clk, i3, i2, i1, i0;
+  output out_0;
+  wire p0_i3, p0_i2, p0_i1, p0_i0,
+       p1_and_1_comb, p1_and_2_comb, p1_and_1, p1_and_2,
+       p2_or_3_comb, p2_or_3;
+
+  DFF p0_i3_reg ( .D(i3), .CLK(clk), .Q(p0_i3) );
+  DFF p0_i2_reg ( .D(i2), .CLK(clk), .Q(p0_i2) );
+  DFF p0_i1_reg ( .D(i1), .CLK(clk), .Q(p0_i1) );
+  DFF p0_i0_reg ( .D(i0), .CLK(clk), .Q(p0_i0) );
+
+  AND p1_and_1 ( .A(p0_i0), .B(p0_i1), .Z(p1_and_1_comb) );
+  %s p1_and_2 ( .A(p0_i2), .B(p0_i3), .Z(p1_and_2_comb) );
+  DFF p1_and_1_reg ( .D(p1_and_1_comb), .CLK(clk), .Q(p1_and_1) );
+  DFF p1_and_2_reg ( .D(p1_and_2_comb), .CLK(clk), .Q(p1_and_2) );
+
+  OR p2_or_3 ( .A(p1_and_1), .B(p1_and_2), .Z(p2_or_3_comb) );
+  DFF p2_or_3_reg ( .D(p2_or_3_comb), .CLK(clk), .Q(p2_or_3) );
+
+  INV p3_not_4 ( .A(p2_or_3), .ZN(out_0) );
+endmodule
+)",
+                         stage0_cell);
+}
+
+absl::StatusOr<StagedLecResult> LecAllThreeStages(std::string_view stage0_cell,
+                                                  int worker_count) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(kThreeStageIr));
+  XLS_ASSIGN_OR_RETURN(Function * entry_function, package->GetTopAsFunction());
+  XLS_ASSIGN_OR_RETURN(netlist::CellLibrary cell_library,
+                       netlist::MakeFakeCellLibrary());
+  netlist::rtl::Scanner scanner(ThreeStageNetlist(stage0_cell));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Netlist> netlist,
+      netlist::rtl::Parser::ParseNetlist(&cell_library, &scanner));
+
+  LecParams params;
+  params.ir_package = package.get();
+  params.ir_function = entry_function;
+  params.netlist = netlist.get();
+  params.netlist_module_name = "main";
+
+  ScheduleCycleMap cycle_map;
+  for (Node* node : entry_function->nodes()) {
+    if (node->Is<Param>() || node->op() == Op::kAnd) {
+      cycle_map[node] = 0;
+    } else if (node->op() == Op::kOr) {
+      cycle_map[node] = 1;
+    } else {
+      cycle_map[node] = 2;
+    }
+  }
+  PipelineSchedule schedule(entry_function, cycle_map, /*length=*/3);
+
+  StagedLecOptions options;
+  options.worker_count = worker_count;
+  // The Lec holding the counterexample refers to the IR and netlist; drop it
+  // before they go out of scope.
+  XLS_ASSIGN_OR_RETURN(StagedLecResult result,
+                       LecAllStages(params, schedule, options));
+  result.failing_lec.reset();
+  return result;
+}
+
+TEST(Z3LecTest, AllStagesConcurrently) {
+  XLS_ASSERT_OK_AND_ASSIGN(StagedLecResult result,
+                           LecAllThreeStages("AND", /*worker_count=*/3));
+  EXPECT_THAT(result.stages, Each(StageLecOutcome::kEquivalent));
+  EXPECT_FALSE(result.failing_stage.has_value());
+}
+
+TEST(Z3LecTest, AllStagesStopsAtFirstMismatch) {
+  // With a single worker the stages are checked in order, so none are started
+  // after stage 0 fails.
+  XLS_ASSERT_OK_AND_ASSIGN(StagedLecResult result,
+                           LecAllThreeStages("OR", /*worker_count=*/1));
+  EXPECT_THAT(result.stages,
+              ElementsAre(StageLecOutcome::kMismatch, StageLecOutcome::kSkipped,
+                          StageLecOutcome::kSkipped));
+  EXPECT_EQ(result.failing_stage, 0);
+
+  XLS_ASSERT_OK_AND_ASSIGN(result, LecAllThreeStages("OR", /*worker_count=*/3));
+  EXPECT_EQ(result.stages[0], StageLecOutcome::kMismatch);
+  EXPECT_EQ(result.failing_stage, 0);
+}
+
 }  // namespace
 }  // namespace z3
 }  // namespace solvers
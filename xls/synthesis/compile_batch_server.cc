@@ -0,0 +1,125 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/synthesis/compile_batch_server.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/synchronization/mutex.h"
+#include "grpcpp/support/status.h"
+#include "grpcpp/support/sync_stream.h"
+#include "xls/common/thread.h"
+#include "xls/synthesis/synthesis.pb.h"
+
+namespace xls {
+namespace synthesis {
+
+CompileConcurrencyLimit::CompileConcurrencyLimit(int64_t max_concurrent)
+    : max_concurrent_(max_concurrent) {
+  CHECK_GT(max_concurrent, 0);
+}
+
+::grpc::Status CompileConcurrencyLimit::Run(
+    const std::function<::grpc::Status()>& compile) {
+  {
+    absl::MutexLock lock(&mutex_);
+    auto slot_free = [&]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+      return running_ < max_concurrent_;
+    };
+    mutex_.Await(absl::Condition(&slot_free));
+    ++running_;
+  }
+  ::grpc::Status status = compile();
+  absl::MutexLock lock(&mutex_);
+  --running_;
+  return status;
+}
+
+::grpc::Status ServeCompileBatch(
+    ::grpc::ServerReaderWriterInterface<CompileBatchResponse,
+                                        CompileBatchRequest>* stream,
+    CompileConcurrencyLimit& limit, const CompileFunction& compile) {
+  absl::Mutex mutex;
+  std::deque<CompileBatchRequest> queue;
+  bool reads_done = false;
+  bool write_failed = false;
+  // Only one write may be outstanding on a stream at a time.
+  absl::Mutex write_mutex;
+
+  auto worker = [&]() {
+    while (true) {
+      CompileBatchRequest request;
+      {
+        absl::MutexLock lock(&mutex);
+        auto work_or_done = [&]() ABSL_SHARED_LOCKS_REQUIRED(mutex) {
+          return !queue.empty() || reads_done;
+        };
+        mutex.Await(absl::Condition(&work_or_done));
+        if (queue.empty()) {
+          return;
+        }
+        request = std::move(queue.front());
+        queue.pop_front();
+      }
+      CompileBatchResponse response;
+      response.set_id(request.id());
+      ::grpc::Status status = limit.Run([&]() {
+        return compile(request.request(), response.mutable_response());
+      });
+      if (!status.ok()) {
+        response.clear_response();
+        response.set_error_code(static_cast<int32_t>(status.error_code()));
+        response.set_error_message(status.error_message());
+      }
+      absl::MutexLock lock(&write_mutex);
+      if (!stream->Write(response)) {
+        absl::MutexLock queue_lock(&mutex);
+        write_failed = true;
+      }
+    }
+  };
+
+  std::vector<std::unique_ptr<Thread>> workers;
+  workers.reserve(limit.max_concurrent());
+  for (int64_t i = 0; i < limit.max_concurrent(); ++i) {
+    workers.push_back(std::make_unique<Thread>(worker));
+  }
+  CompileBatchRequest request;
+  while (stream->Read(&request)) {
+    absl::MutexLock lock(&mutex);
+    queue.push_back(std::move(request));
+  }
+  {
+    absl::MutexLock lock(&mutex);
+    reads_done = true;
+  }
+  for (std::unique_ptr<Thread>& thread : workers) {
+    thread->Join();
+  }
+  if (write_failed) {
+    return ::grpc::Status(::grpc::StatusCode::UNAVAILABLE,
+                          "Unable to write CompileBatch response");
+  }
+  return ::grpc::Status::OK;
+}
+
+}  // namespace synthesis
+}  // namespace xls
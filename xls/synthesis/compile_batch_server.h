@@ -0,0 +1,66 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_SYNTHESIS_COMPILE_BATCH_SERVER_H_
+#define XLS_SYNTHESIS_COMPILE_BATCH_SERVER_H_
+
+#include <cstdint>
+#include <functional>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "grpcpp/support/status.h"
+#include "grpcpp/support/sync_stream.h"
+#include "xls/synthesis/synthesis.pb.h"
+
+namespace xls {
+namespace synthesis {
+
+// Bounds the number of compilations a synthesis server runs at once across
+// all of its CompileBatch streams.
+class CompileConcurrencyLimit {
+ public:
+  explicit CompileConcurrencyLimit(int64_t max_concurrent);
+
+  int64_t max_concurrent() const { return max_concurrent_; }
+
+  // Blocks until fewer than `max_concurrent()` compilations are running, then
+  // runs `compile`.
+  ::grpc::Status Run(const std::function<::grpc::Status()>& compile);
+
+ private:
+  const int64_t max_concurrent_;
+  absl::Mutex mutex_;
+  int64_t running_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+using CompileFunction = std::function<::grpc::Status(
+    const CompileRequest& request, CompileResponse* response)>;
+
+// Serves a CompileBatch stream: compiles each request read from `stream` with
+// `compile`, with up to `limit.max_concurrent()` requests of the stream in
+// flight (and no more than `limit` allows across the server), and writes each
+// response tagged with the id of its request as soon as it is done. A failed
+// compilation is reported in its response; the returned status is only an
+// error if the stream could not be written.
+::grpc::Status ServeCompileBatch(
+    ::grpc::ServerReaderWriterInterface<CompileBatchResponse,
+                                        CompileBatchRequest>* stream,
+    CompileConcurrencyLimit& limit, const CompileFunction& compile);
+
+}  // namespace synthesis
+}  // namespace xls
+
+#endif  // XLS_SYNTHESIS_COMPILE_BATCH_SERVER_H_
@@ -28,7 +28,9 @@
 #include "grpcpp/server_builder.h"
 #include "grpcpp/server_context.h"
 #include "grpcpp/support/status.h"
+#include "grpcpp/support/sync_stream.h"
 #include "xls/common/init_xls.h"
+#include "xls/synthesis/compile_batch_server.h"
 #include "xls/synthesis/credentials.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/synthesis_service.grpc.pb.h"
@@ -49,6 +51,9 @@ ABSL_FLAG(double, max_frequency_ghz, 1000,
           "The maximum frequency to use for any synthesis request.");
 ABSL_FLAG(bool, serve_errors, false,
           "Whether to serve an error in the response.");
+ABSL_FLAG(int64_t, max_concurrent_compiles, 4,
+          "The maximum number of compilations of CompileBatch streams to run "
+          "at once.");
 
 namespace xls {
 namespace synthesis {
@@ -58,8 +63,11 @@ namespace {
 class FakeSynthesisServiceImpl : public SynthesisService::Service {
  public:
   explicit FakeSynthesisServiceImpl(int64_t max_frequency_hz,
-                                     bool serve_errors)
-      : max_frequency_hz_(max_frequency_hz), serve_errors_(serve_errors) {}
+                                     bool serve_errors,
+                                     int64_t max_concurrent_compiles)
+      : max_frequency_hz_(max_frequency_hz),
+        serve_errors_(serve_errors),
+        compile_limit_(max_concurrent_compiles) {}
 
   ::grpc::Status Compile(::grpc::ServerContext* server_context,
                          const CompileRequest* request,
@@ -83,9 +91,21 @@ class FakeSynthesisServiceImpl : public SynthesisService::Service {
     return ::grpc::Status::OK;
   }
 
+  ::grpc::Status CompileBatch(
+      ::grpc::ServerContext* server_context,
+      ::grpc::ServerReaderWriter<CompileBatchResponse, CompileBatchRequest>*
+          stream) override {
+    return ServeCompileBatch(
+        stream, compile_limit_,
+        [&](const CompileRequest& request, CompileResponse* response) {
+          return Compile(server_context, &request, response);
+        });
+  }
+
  private:
   int64_t max_frequency_hz_;
   bool serve_errors_;
+  CompileConcurrencyLimit compile_limit_;
 };
 
 void RealMain() {
@@ -93,8 +113,9 @@ void RealMain() {
       static_cast<int64_t>(1e9 * absl::GetFlag(FLAGS_max_frequency_ghz));
   int port = absl::GetFlag(FLAGS_port);
   std::string server_address = absl::StrCat("0.0.0.0:", port);
-  FakeSynthesisServiceImpl service(max_frequency_hz,
-                                    absl::GetFlag(FLAGS_serve_errors));
+  FakeSynthesisServiceImpl service(
+      max_frequency_hz, absl::GetFlag(FLAGS_serve_errors),
+      absl::GetFlag(FLAGS_max_concurrent_compiles));
 
   ::grpc::ServerBuilder builder;
   std::shared_ptr<::grpc::ServerCredentials> creds = GetServerCredentials();
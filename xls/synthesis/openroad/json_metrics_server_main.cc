@@ -33,11 +33,13 @@
 #include "grpcpp/server_builder.h"
 #include "grpcpp/server_context.h"
 #include "grpcpp/support/status.h"
+#include "grpcpp/support/sync_stream.h"
 #include "libs/json11/json11.hpp"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/temp_directory.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/synthesis/compile_batch_server.h"
 #include "xls/synthesis/credentials.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/synthesis_service.grpc.pb.h"
@@ -142,8 +144,22 @@ class JsonMetricsSynthesisServiceImpl : public SynthesisService::Service {
     return absl::OkStatus();
   }
 
+  // The metrics command is configured through the environment of this
+  // process, so batched requests are compiled one at a time.
+  ::grpc::Status CompileBatch(
+      ::grpc::ServerContext* server_context,
+      ::grpc::ServerReaderWriter<CompileBatchResponse, CompileBatchRequest>*
+          stream) override {
+    return ServeCompileBatch(
+        stream, compile_limit_,
+        [&](const CompileRequest& request, CompileResponse* response) {
+          return Compile(server_context, &request, response);
+        });
+  }
+
  private:
   std::string metrics_command_;
+  CompileConcurrencyLimit compile_limit_{/*max_concurrent=*/1};
 };
 
 void RealMain() {
@@ -14,17 +14,28 @@
 
 #include "xls/synthesis/synthesis_client.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "grpcpp/support/status.h"
 #include "grpcpp/channel.h"
 #include "grpcpp/client_context.h"
 #include "grpcpp/create_channel.h"
 #include "grpcpp/security/credentials.h"
+#include "grpcpp/support/sync_stream.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/synthesis/credentials.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/synthesis_service.grpc.pb.h"
@@ -62,5 +73,120 @@ absl::StatusOr<CompileResponse> SynthesizeViaClient(
   return response;
 }
 
+/* static */ absl::StatusOr<std::unique_ptr<CompileBatchClient>>
+CompileBatchClient::Create(const std::string& server) {
+  std::shared_ptr<grpc::ChannelCredentials> creds = GetChannelCredentials();
+  std::shared_ptr<grpc::Channel> channel = grpc::CreateChannel(server, creds);
+  auto client = absl::WrapUnique(new CompileBatchClient());
+  client->stub_ = SynthesisService::NewStub(channel);
+  client->stream_ = client->stub_->CompileBatch(&client->context_);
+  if (client->stream_ == nullptr) {
+    return absl::UnavailableError(
+        absl::StrCat("Unable to open CompileBatch stream to ", server));
+  }
+  CompileBatchClient* raw = client.get();
+  client->reader_ = std::make_unique<Thread>([raw]() { raw->ReadResponses(); });
+  return client;
+}
+
+CompileBatchClient::~CompileBatchClient() {
+  {
+    absl::MutexLock lock(&mutex_);
+    auto idle = [&]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+      return pending_.empty() || stream_done_;
+    };
+    mutex_.Await(absl::Condition(&idle));
+  }
+  {
+    absl::MutexLock lock(&write_mutex_);
+    stream_->WritesDone();
+  }
+  reader_->Join();
+}
+
+void CompileBatchClient::ReadResponses() {
+  CompileBatchResponse response;
+  while (stream_->Read(&response)) {
+    absl::MutexLock lock(&mutex_);
+    auto it = pending_.find(response.id());
+    if (it == pending_.end()) {
+      continue;
+    }
+    if (response.has_error_code()) {
+      it->second->response = absl::Status(
+          static_cast<absl::StatusCode>(response.error_code()),
+          response.error_message());
+    } else {
+      it->second->response = std::move(*response.mutable_response());
+    }
+    it->second->done = true;
+    pending_.erase(it);
+  }
+  absl::Status status = GrpcToAbslStatus(stream_->Finish());
+  absl::MutexLock lock(&mutex_);
+  stream_status_ =
+      status.ok() ? absl::UnavailableError("CompileBatch stream closed")
+                  : status;
+  stream_done_ = true;
+  for (auto& [id, pending] : pending_) {
+    pending->response = stream_status_;
+    pending->done = true;
+  }
+  pending_.clear();
+}
+
+absl::StatusOr<CompileResponse> CompileBatchClient::Compile(
+    const CompileRequest& request) {
+  Pending pending;
+  CompileBatchRequest batch_request;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (stream_done_) {
+      return stream_status_;
+    }
+    batch_request.set_id(next_id_++);
+    pending_[batch_request.id()] = &pending;
+  }
+  *batch_request.mutable_request() = request;
+  {
+    // If the write fails the stream is broken, and the reader thread fails the
+    // request when the stream ends.
+    absl::MutexLock lock(&write_mutex_);
+    stream_->Write(batch_request);
+  }
+  absl::MutexLock lock(&mutex_);
+  auto done = [&]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) { return pending.done; };
+  mutex_.Await(absl::Condition(&done));
+  return std::move(pending.response);
+}
+
+absl::StatusOr<std::vector<absl::StatusOr<CompileResponse>>>
+SynthesizeBatchViaClient(const std::string& server,
+                         absl::Span<const CompileRequest> requests,
+                         int64_t max_in_flight) {
+  if (max_in_flight <= 0) {
+    return absl::InvalidArgumentError("max_in_flight must be positive");
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompileBatchClient> client,
+                       CompileBatchClient::Create(server));
+  std::vector<absl::StatusOr<CompileResponse>> responses(
+      requests.size(), absl::UnknownError("Not compiled"));
+  std::atomic<int64_t> next = 0;
+  auto worker = [&]() {
+    for (int64_t i = next++; i < requests.size(); i = next++) {
+      responses[i] = client->Compile(requests[i]);
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 0; i < std::min<int64_t>(max_in_flight, requests.size());
+       ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  return responses;
+}
+
 }  // namespace synthesis
 }  // namespace xls
@@ -15,10 +15,22 @@
 #ifndef XLS_SYNTHESIS_SYNTHESIS_CLIENT_H_
 #define XLS_SYNTHESIS_SYNTHESIS_CLIENT_H_
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "grpcpp/client_context.h"
+#include "grpcpp/support/sync_stream.h"
+#include "xls/common/thread.h"
 #include "xls/synthesis/synthesis.pb.h"
+#include "xls/synthesis/synthesis_service.grpc.pb.h"
 
 namespace xls {
 namespace synthesis {
@@ -28,6 +40,57 @@ absl::StatusOr<CompileResponse> SynthesizeViaClient(
     const std::string& server,
     const CompileRequest& request);
 
+// A client which multiplexes compile requests from any number of threads over
+// a single CompileBatch stream to one server. Requests are pipelined: each
+// Compile() call blocks only until its own response arrives, and the server
+// compiles outstanding requests concurrently.
+class CompileBatchClient {
+ public:
+  static absl::StatusOr<std::unique_ptr<CompileBatchClient>> Create(
+      const std::string& server);
+
+  // Closes the stream once all outstanding requests are answered.
+  ~CompileBatchClient();
+
+  absl::StatusOr<CompileResponse> Compile(const CompileRequest& request);
+
+ private:
+  // The result of an outstanding request, filled in by the reader thread.
+  struct Pending {
+    bool done = false;
+    absl::StatusOr<CompileResponse> response;
+  };
+
+  CompileBatchClient() = default;
+
+  // Dispatches responses to the outstanding requests until the stream ends.
+  void ReadResponses();
+
+  std::unique_ptr<SynthesisService::Stub> stub_;
+  grpc::ClientContext context_;
+  std::unique_ptr<
+      grpc::ClientReaderWriter<CompileBatchRequest, CompileBatchResponse>>
+      stream_;
+  std::unique_ptr<Thread> reader_;
+
+  // Only one write may be outstanding on the stream at a time.
+  absl::Mutex write_mutex_;
+  absl::Mutex mutex_;
+  int64_t next_id_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::flat_hash_map<int64_t, Pending*> pending_ ABSL_GUARDED_BY(mutex_);
+  // Set once the stream has ended; later requests fail with this status.
+  absl::Status stream_status_ ABSL_GUARDED_BY(mutex_);
+  bool stream_done_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+// Synthesizes each of `requests` over a single CompileBatch stream to `server`
+// and returns the responses in the order of the requests. At most
+// `max_in_flight` requests are outstanding at once.
+absl::StatusOr<std::vector<absl::StatusOr<CompileResponse>>>
+SynthesizeBatchViaClient(const std::string& server,
+                         absl::Span<const CompileRequest> requests,
+                         int64_t max_in_flight = 16);
+
 }  // namespace synthesis
 }  // namespace xls
 
@@ -21,6 +21,7 @@
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "google/protobuf/text_format.h"
@@ -34,6 +35,9 @@ ABSL_FLAG(std::string, server, "localhost", "Server to connect to");
 ABSL_FLAG(int, port, 10000, "Server port to connect to");
 ABSL_FLAG(double, ghz, 1.0, "The target frequency for synthesis (GHz)");
 ABSL_FLAG(std::string, top, "main", "Name of the top module to synthesize");
+ABSL_FLAG(int64_t, max_in_flight, 16,
+          "When several Verilog files are given, the maximum number of "
+          "requests outstanding on the CompileBatch stream at once.");
 
 static constexpr std::string_view kUsage = R"(
 A test client in C++ for using the synthesis server.
@@ -44,7 +48,10 @@ The default port matches that used by the Yosys synth server.
        [--port=10000] \
        [--server=localhost] \
        [--top="main"] \
-       <path_to_verilog>
+       <path_to_verilog>...
+
+If several Verilog files are given they are sent over a single CompileBatch
+stream and each response is printed after a "# <path>" line.
 )";
 
 int main(int argc, char** argv) {
@@ -61,25 +68,52 @@ int main(int argc, char** argv) {
       static_cast<int64_t>(absl::GetFlag(FLAGS_ghz) * 1e9));
 
   // Check that input Verilog is provided, and get it
-  if (positional_arguments.size() != 1) {
+  if (positional_arguments.empty()) {
     LOG(QFATAL) << absl::StrCat("Expected invocation: ", argv[0],
-                                " [flags] VERILOG_FILE\n");
+                                " [flags] VERILOG_FILE...\n");
+  }
+  std::vector<xls::synthesis::CompileRequest> requests;
+  for (std::string_view vpath : positional_arguments) {
+    absl::StatusOr<std::string> verilog_contents = xls::GetFileContents(vpath);
+    QCHECK_OK(verilog_contents.status());
+    request.set_module_text(verilog_contents.value());
+    requests.push_back(request);
   }
-  std::string_view vpath = positional_arguments[0];
-  absl::StatusOr<std::string> verilog_contents = xls::GetFileContents(vpath);
-  QCHECK_OK(verilog_contents.status());
-  request.set_module_text(verilog_contents.value());
 
-  // Use the client to perform the RPC
-  absl::StatusOr<xls::synthesis::CompileResponse> compile_response_status =
-      xls::synthesis::SynthesizeViaClient(server, request);
+  if (requests.size() == 1) {
+    // Use the client to perform the RPC
+    absl::StatusOr<xls::synthesis::CompileResponse> compile_response_status =
+        xls::synthesis::SynthesizeViaClient(server, requests.front());
 
-  // Examine the response
-  if (compile_response_status.ok()) {
+    // Examine the response
+    if (compile_response_status.ok()) {
+      std::string compile_response_text;
+      google::protobuf::TextFormat::PrintToString(compile_response_status.value(),
+                                        &compile_response_text);
+      std::cout << compile_response_text << '\n';
+    }
+    return xls::ExitStatus(compile_response_status.status());
+  }
+
+  absl::StatusOr<std::vector<absl::StatusOr<xls::synthesis::CompileResponse>>>
+      responses = xls::synthesis::SynthesizeBatchViaClient(
+          server, requests, absl::GetFlag(FLAGS_max_in_flight));
+  if (!responses.ok()) {
+    return xls::ExitStatus(responses.status());
+  }
+  absl::Status status = absl::OkStatus();
+  for (int64_t i = 0; i < responses->size(); ++i) {
+    std::cout << "# " << positional_arguments[i] << '\n';
+    const absl::StatusOr<xls::synthesis::CompileResponse>& response =
+        (*responses)[i];
+    if (!response.ok()) {
+      std::cout << "# error: " << response.status() << '\n';
+      status.Update(response.status());
+      continue;
+    }
     std::string compile_response_text;
-    google::protobuf::TextFormat::PrintToString(compile_response_status.value(),
-                                      &compile_response_text);
+    google::protobuf::TextFormat::PrintToString(*response, &compile_response_text);
     std::cout << compile_response_text << '\n';
   }
-  return xls::ExitStatus(compile_response_status.status());
+  return xls::ExitStatus(status);
 }
@@ -86,6 +86,28 @@ class SynthesisServerTest(absltest.TestCase):
     proc.terminate()
     proc.wait()
 
+  def test_batch(self):
+    port, proc = self._start_server(['--max_frequency_ghz=2.0'])
+
+    verilog_files = [self.create_tempfile(content=VERILOG) for _ in range(3)]
+    output = subprocess.check_output(
+        [CLIENT_PATH] + [f.full_path for f in verilog_files] +
+        [f'--port={port}', '--ghz=1.0']).decode('utf-8')
+
+    # Each response follows a "# <path>" line, in the order of the files.
+    sections = output.split('# ')[1:]
+    self.assertLen(sections, 3)
+    for verilog_file, section in zip(verilog_files, sections):
+      path, response_text = section.split('\n', 1)
+      self.assertEqual(path, verilog_file.full_path)
+      response = text_format.Parse(response_text,
+                                   synthesis_pb2.CompileResponse())
+      self.assertGreaterEqual(response.slack_ps, 0)
+      self.assertEqual(response.netlist, '// NETLIST')
+
+    proc.terminate()
+    proc.wait()
+
 
 if __name__ == '__main__':
   absltest.main()
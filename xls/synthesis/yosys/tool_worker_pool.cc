@@ -0,0 +1,146 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/synthesis/yosys/tool_worker_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/subprocess.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+// Written by a worker on a line of its own once it has finished a job,
+// followed by the error message if the job raised an error.
+constexpr std::string_view kDoneMarker = "XLS_TOOL_WORKER_DONE";
+
+// Wraps `script` so that errors it raises are caught and the done marker is
+// written once it has finished.
+std::string WrapScript(std::string_view script,
+                       std::string_view print_command) {
+  return absl::StrFormat(
+      "if {[catch {\n%s\n} xls_worker_error]} {\n"
+      "  %s \"%s [string map [list \\n { }] $xls_worker_error]\"\n"
+      "} else {\n"
+      "  %s \"%s\"\n"
+      "}\n"
+      "flush stdout",
+      script, print_command, kDoneMarker, print_command, kDoneMarker);
+}
+
+}  // namespace
+
+ToolWorkerPool::ToolWorkerPool(std::vector<std::string> argv,
+                               std::string init_script,
+                               std::string print_command, int64_t max_workers)
+    : argv_(std::move(argv)),
+      init_script_(std::move(init_script)),
+      print_command_(std::move(print_command)),
+      max_workers_(max_workers) {}
+
+absl::StatusOr<std::string> ToolWorkerPool::Run(std::string_view script) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<InteractiveSubprocess> worker,
+                       Acquire());
+  bool worker_failed = false;
+  absl::StatusOr<std::string> output =
+      RunOnWorker(*worker, script, &worker_failed);
+  Release(worker_failed ? nullptr : std::move(worker));
+  return output;
+}
+
+absl::StatusOr<std::unique_ptr<InteractiveSubprocess>>
+ToolWorkerPool::Acquire() {
+  {
+    absl::MutexLock lock(&mutex_);
+    auto can_acquire = [this]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+      return !idle_workers_.empty() || worker_count_ < max_workers_;
+    };
+    mutex_.Await(absl::Condition(&can_acquire));
+    if (!idle_workers_.empty()) {
+      std::unique_ptr<InteractiveSubprocess> worker =
+          std::move(idle_workers_.back());
+      idle_workers_.pop_back();
+      return worker;
+    }
+    ++worker_count_;
+  }
+  absl::StatusOr<std::unique_ptr<InteractiveSubprocess>> worker =
+      StartWorker();
+  if (!worker.ok()) {
+    Release(nullptr);
+  }
+  return worker;
+}
+
+absl::StatusOr<std::unique_ptr<InteractiveSubprocess>>
+ToolWorkerPool::StartWorker() {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<InteractiveSubprocess> worker,
+                       InteractiveSubprocess::Create(argv_));
+  bool worker_failed = false;
+  absl::StatusOr<std::string> output =
+      RunOnWorker(*worker, init_script_, &worker_failed);
+  if (!output.ok()) {
+    return absl::InternalError(
+        absl::StrCat("Failed to initialize ", argv_.front(),
+                     " worker: ", output.status().message()));
+  }
+  return worker;
+}
+
+void ToolWorkerPool::Release(std::unique_ptr<InteractiveSubprocess> worker) {
+  absl::MutexLock lock(&mutex_);
+  if (worker == nullptr) {
+    --worker_count_;
+  } else {
+    idle_workers_.push_back(std::move(worker));
+  }
+}
+
+absl::StatusOr<std::string> ToolWorkerPool::RunOnWorker(
+    InteractiveSubprocess& worker, std::string_view script,
+    bool* worker_failed) {
+  absl::StatusOr<std::string> reply =
+      worker.CommunicateUntil(WrapScript(script, print_command_), kDoneMarker);
+  if (!reply.ok()) {
+    *worker_failed = true;
+    return reply.status();
+  }
+  // The marker is on the last line of the reply.
+  const size_t marker = reply->rfind(kDoneMarker);
+  std::string_view error = absl::StripAsciiWhitespace(
+      std::string_view(*reply).substr(marker + kDoneMarker.size()));
+  if (!error.empty()) {
+    return absl::InternalError(
+        absl::StrFormat("%s raised an error: %s", argv_.front(), error));
+  }
+  reply->resize(marker);
+  return reply;
+}
+
+}  // namespace synthesis
+}  // namespace xls
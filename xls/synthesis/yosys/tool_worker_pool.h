@@ -0,0 +1,88 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SYNTHESIS_YOSYS_TOOL_WORKER_POOL_H_
+#define XLS_SYNTHESIS_YOSYS_TOOL_WORKER_POOL_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/subprocess.h"
+
+namespace xls {
+namespace synthesis {
+
+// A pool of long-running tool processes (Yosys, OpenSTA) which read Tcl
+// commands from stdin. Each job script is sent to an idle worker rather than to
+// a newly started tool, so the tool startup and any state set up by the
+// initialization script (e.g. Liberty files read by OpenSTA) are paid once per
+// worker instead of once per job.
+//
+// As with InteractiveSubprocess, a worker which has died raises SIGPIPE when
+// it is sent a job; ignore that signal to get an error status instead.
+class ToolWorkerPool {
+ public:
+  // `argv` starts the tool as a Tcl shell reading from stdin. `init_script` is
+  // run once by each new worker. `print_command` is the Tcl command the tool
+  // writes its regular output with (e.g. "puts" or "yosys log"); it is used to
+  // mark the end of each job so that the marker is ordered after the output of
+  // the job. Up to `max_workers` jobs run at once; further jobs wait.
+  ToolWorkerPool(std::vector<std::string> argv, std::string init_script,
+                 std::string print_command, int64_t max_workers);
+
+  // Runs `script` on a worker and returns what it wrote to stdout. A Tcl error
+  // raised by the script is returned as an internal error; the worker is kept,
+  // so scripts should not rely on state left behind by earlier jobs. A worker
+  // which fails to communicate is discarded.
+  absl::StatusOr<std::string> Run(std::string_view script);
+
+ private:
+  // Returns an idle worker, starting a new one if none is idle and fewer than
+  // `max_workers_` exist, or else waiting for one to become idle.
+  absl::StatusOr<std::unique_ptr<InteractiveSubprocess>> Acquire();
+
+  // Starts a worker and runs the initialization script on it.
+  absl::StatusOr<std::unique_ptr<InteractiveSubprocess>> StartWorker();
+
+  // Returns `worker` to the pool. A null `worker` gives up the slot of a
+  // worker which was discarded.
+  void Release(std::unique_ptr<InteractiveSubprocess> worker);
+
+  // Runs `script` on `worker` and returns what it wrote to stdout, or the
+  // error it raised.
+  absl::StatusOr<std::string> RunOnWorker(InteractiveSubprocess& worker,
+                                          std::string_view script,
+                                          bool* worker_failed);
+
+  const std::vector<std::string> argv_;
+  const std::string init_script_;
+  const std::string print_command_;
+  const int64_t max_workers_;
+
+  absl::Mutex mutex_;
+  std::vector<std::unique_ptr<InteractiveSubprocess>> idle_workers_
+      ABSL_GUARDED_BY(mutex_);
+  int64_t worker_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace synthesis
+}  // namespace xls
+
+#endif  // XLS_SYNTHESIS_YOSYS_TOOL_WORKER_POOL_H_
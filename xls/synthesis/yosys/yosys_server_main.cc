@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <csignal>
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
@@ -28,6 +30,7 @@
 #include "grpcpp/server_context.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/thread.h"
 #include "xls/synthesis/credentials.h"
 #include "xls/synthesis/yosys/yosys_synthesis_service.h"
 
@@ -65,6 +68,14 @@ ABSL_FLAG(std::string, default_driver_cell, "",
           "The default driver cell to use during synthesis.");
 ABSL_FLAG(std::string, default_load, "",
           "The default load cell to use during synthesis.");
+ABSL_FLAG(int64_t, max_concurrent_compiles, 0,
+          "The maximum number of compilations of CompileBatch streams to run "
+          "at once. 0 uses the number of available CPUs.");
+ABSL_FLAG(bool, persistent_tools, false,
+          "Keep up to --max_concurrent_compiles Yosys and OpenSTA processes "
+          "running between compilations (with the STA libraries loaded) "
+          "instead of starting the tools for each compilation. Only applies "
+          "when --synthesis_target is not given.");
 
 namespace xls {
 namespace synthesis {
@@ -106,13 +117,29 @@ void RealMain() {
     }
   }
 
+  int64_t max_concurrent_compiles =
+      absl::GetFlag(FLAGS_max_concurrent_compiles);
+  QCHECK_GE(max_concurrent_compiles, 0)
+      << "--max_concurrent_compiles must be non-negative";
+  if (max_concurrent_compiles == 0) {
+    max_concurrent_compiles = std::max(AvailableCPUs(), 1);
+  }
+  const int64_t persistent_tool_workers =
+      absl::GetFlag(FLAGS_persistent_tools) ? max_concurrent_compiles : 0;
+  if (persistent_tool_workers > 0) {
+    // Report a tool process which has died as an error of the compilation
+    // rather than being killed when writing to it.
+    signal(SIGPIPE, SIG_IGN);
+  }
+
   int port = absl::GetFlag(FLAGS_port);
   std::string server_address = absl::StrCat("0.0.0.0:", port);
   YosysSynthesisServiceImpl service(
       yosys_path, nextpnr_path, synthesis_target, sta_path, synthesis_libraries,
       sta_libraries, absl::GetFlag(FLAGS_default_driver_cell),
       absl::GetFlag(FLAGS_default_load), absl::GetFlag(FLAGS_save_temps),
-      absl::GetFlag(FLAGS_return_netlist), synthesis_only);
+      absl::GetFlag(FLAGS_return_netlist), synthesis_only,
+      max_concurrent_compiles, persistent_tool_workers);
 
   ::grpc::ServerBuilder builder;
   std::shared_ptr<::grpc::ServerCredentials> creds = GetServerCredentials();
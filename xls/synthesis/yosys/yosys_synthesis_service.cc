@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <filesystem>  // NOLINT
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -34,12 +35,15 @@
 #include "grpcpp/server.h"
 #include "grpcpp/server_context.h"
 #include "grpcpp/support/status.h"
+#include "grpcpp/support/sync_stream.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/temp_directory.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
+#include "xls/synthesis/compile_batch_server.h"
 #include "xls/synthesis/synthesis.pb.h"
+#include "xls/synthesis/yosys/tool_worker_pool.h"
 #include "xls/synthesis/yosys/yosys_util.h"
 
 namespace xls {
@@ -62,6 +66,33 @@ namespace synthesis {
   return ::grpc::Status::OK;
 }
 
+::grpc::Status YosysSynthesisServiceImpl::CompileBatch(
+    ::grpc::ServerContext* server_context,
+    ::grpc::ServerReaderWriter<CompileBatchResponse, CompileBatchRequest>*
+        stream) {
+  return ServeCompileBatch(
+      stream, compile_limit_,
+      [&](const CompileRequest& request, CompileResponse* response) {
+        return Compile(server_context, &request, response);
+      });
+}
+
+void YosysSynthesisServiceImpl::CreateToolWorkerPools(int64_t max_workers) {
+  // Only the standard cell flow (Yosys followed by OpenSTA) runs on workers.
+  if (max_workers <= 0 || !synthesis_target_.empty()) {
+    return;
+  }
+  yosys_workers_ = std::make_unique<ToolWorkerPool>(
+      std::vector<std::string>{yosys_path_, "-Q", "-C"},
+      /*init_script=*/"", /*print_command=*/"yosys log", max_workers);
+  if (!synthesis_only_) {
+    sta_workers_ = std::make_unique<ToolWorkerPool>(
+        std::vector<std::string>{sta_path_, "-no_splash"},
+        /*init_script=*/BuildSTALibraryCmds(), /*print_command=*/"puts",
+        max_workers);
+  }
+}
+
 // Run the given arguments as a subprocess with InvokeSubprocess.
 // InvokeSubprocess is wrapped because the error message can be very large (it
 // includes both stdout and stderr) which breaks propagation of the error via
@@ -231,9 +262,19 @@ absl::Status YosysSynthesisServiceImpl::RunSynthesis(
         BuildYosysTcl(request, abc_constr_path, verilog_path, synth_json_path,
                       synth_verilog_path);
     XLS_RETURN_IF_ERROR(SetFileContents(yosys_tcl_path, yosys_tcl));
-    LOG(INFO) << "Running Yosys:  command file: " << yosys_tcl_path;
-    XLS_ASSIGN_OR_RETURN(string_pair,
-                         RunSubprocess({yosys_path_, "-c", yosys_tcl_path}));
+    if (yosys_workers_ != nullptr) {
+      // The worker still holds the design of its previous job.
+      LOG(INFO) << "Running Yosys on a worker:  command file: "
+                << yosys_tcl_path;
+      XLS_ASSIGN_OR_RETURN(
+          string_pair.first,
+          yosys_workers_->Run(absl::StrCat("yosys design -reset\n",
+                                           yosys_tcl)));
+    } else {
+      LOG(INFO) << "Running Yosys:  command file: " << yosys_tcl_path;
+      XLS_ASSIGN_OR_RETURN(string_pair,
+                           RunSubprocess({yosys_path_, "-c", yosys_tcl_path}));
+    }
   }
 
   auto [yosys_stdout, yosys_stderr] = string_pair;
@@ -321,19 +362,35 @@ absl::Status YosysSynthesisServiceImpl::RunNextPNR(
 std::string YosysSynthesisServiceImpl::BuildSTACmds(
     const CompileRequest* request,
     const std::filesystem::path& netlist_path) const {
+  std::string sta_cmd =
+      absl::StrJoin({BuildSTALibraryCmds(),
+                     BuildSTADesignCmds(request, netlist_path),
+                     std::string("exit")},
+                    "\n");
+
+  VLOG(1) << "about to start, sta cmd: " << sta_cmd;
+  return sta_cmd;
+}
+
+std::string YosysSynthesisServiceImpl::BuildSTALibraryCmds() const {
+  const std::string setup_libraries =
+      absl::StrFormat("set LIB_FILES { %s }", sta_libraries_);
+  const std::string read_libraries =
+      absl::StrFormat("foreach libFile $LIB_FILES { read_liberty $libFile }");
+  return absl::StrJoin({setup_libraries, read_libraries}, "\n");
+}
+
+std::string YosysSynthesisServiceImpl::BuildSTADesignCmds(
+    const CompileRequest* request,
+    const std::filesystem::path& netlist_path) const {
   // Invoke STA for timing and max freq analysis.
   std::vector<std::string> sta_cmd_vec;
-  std::string sta_cmd;
 
   // Input in hz, adjust for scale ps
   double clock_period_ps =
       1e12 / static_cast<double>(request->target_frequency_hz());
   std::string delay_target = absl::StrCat(clock_period_ps);
 
-  const std::string setup_libraries =
-      absl::StrFormat("set LIB_FILES { %s }", sta_libraries_);
-  const std::string read_libraries =
-      absl::StrFormat("foreach libFile $LIB_FILES { read_liberty $libFile }");
   const std::string read_verilog_netlist =
       absl::StrFormat("read_verilog %s ", netlist_path.string());
   const std::string perform_elaboratation =
@@ -365,10 +422,6 @@ std::string YosysSynthesisServiceImpl::BuildSTACmds(
       "report_checks -path_delay min_max -fields {slew cap input nets "
       "fanout} -format full_clock_expanded");
 
-  const std::string perform_exit = absl::StrFormat("exit");
-
-  sta_cmd_vec.push_back(setup_libraries);
-  sta_cmd_vec.push_back(read_libraries);
   sta_cmd_vec.push_back(read_verilog_netlist);
   sta_cmd_vec.push_back(perform_elaboratation);
 
@@ -384,12 +437,7 @@ std::string YosysSynthesisServiceImpl::BuildSTACmds(
   sta_cmd_vec.push_back(perform_report_negative_slacks);
   sta_cmd_vec.push_back(perform_report_checks);
 
-  sta_cmd_vec.push_back(perform_exit);
-
-  sta_cmd = absl::StrJoin(sta_cmd_vec, "\n");
-
-  VLOG(1) << "about to start, sta cmd: " << sta_cmd;
-  return sta_cmd;
+  return absl::StrJoin(sta_cmd_vec, "\n");
 }
 
 absl::Status YosysSynthesisServiceImpl::RunSTA(
@@ -405,8 +453,16 @@ absl::Status YosysSynthesisServiceImpl::RunSTA(
 
   std::pair<std::string, std::string> string_pair;
 
-  XLS_ASSIGN_OR_RETURN(string_pair, RunSubprocess({sta_path_, "-no_splash",
-                                                   "-exit", sta_cmd_path}));
+  if (sta_workers_ != nullptr) {
+    // The worker has already read the libraries, so only the design commands
+    // are sent to it.
+    XLS_ASSIGN_OR_RETURN(
+        string_pair.first,
+        sta_workers_->Run(BuildSTADesignCmds(request, netlist_path)));
+  } else {
+    XLS_ASSIGN_OR_RETURN(string_pair, RunSubprocess({sta_path_, "-no_splash",
+                                                     "-exit", sta_cmd_path}));
+  }
 
   auto [sta_stdout, sta_stderr] = string_pair;
   if (save_temps_) {
@@ -15,7 +15,9 @@
 #ifndef XLS_SYNTHESIS_YOSYS_YOSYS_SYNTHESIS_SERVICE_H_
 #define XLS_SYNTHESIS_YOSYS_YOSYS_SYNTHESIS_SERVICE_H_
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
+#include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -26,20 +28,27 @@
 #include "grpcpp/server.h"
 #include "grpcpp/server_context.h"
 #include "grpcpp/support/status.h"
+#include "grpcpp/support/sync_stream.h"
+#include "xls/synthesis/compile_batch_server.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/synthesis_service.grpc.pb.h"
+#include "xls/synthesis/yosys/tool_worker_pool.h"
 
 namespace xls {
 namespace synthesis {
 
 class YosysSynthesisServiceImpl : public SynthesisService::Service {
  public:
+  // If `persistent_tool_workers` is positive, up to that many Yosys and OpenSTA
+  // processes are kept running between compilations for the standard cell
+  // flow, rather than starting the tools for each compilation.
   explicit YosysSynthesisServiceImpl(
       std::string_view yosys_path, std::string_view nextpnr_path,
       std::string_view synthesis_target, std::string_view sta_path,
       std::string_view synthesis_libraries, std::string_view sta_libraries,
       std::string_view default_driver_cell, std::string_view default_load,
-      bool save_temps, bool return_netlist, bool synthesis_only)
+      bool save_temps, bool return_netlist, bool synthesis_only,
+      int64_t max_concurrent_compiles = 1, int64_t persistent_tool_workers = 0)
       : yosys_path_(yosys_path),
         nextpnr_path_(nextpnr_path),
         synthesis_target_(synthesis_target),
@@ -50,12 +59,22 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
         default_load_(default_load),
         save_temps_(save_temps),
         return_netlist_(return_netlist),
-        synthesis_only_(synthesis_only) {}
+        synthesis_only_(synthesis_only),
+        compile_limit_(max_concurrent_compiles) {
+    CreateToolWorkerPools(persistent_tool_workers);
+  }
 
   ::grpc::Status Compile(::grpc::ServerContext* server_context,
                          const CompileRequest* request,
                          CompileResponse* result) override;
 
+  // Runs up to `max_concurrent_compiles` compilations at once across all
+  // batch streams; each uses its own temporary directory.
+  ::grpc::Status CompileBatch(
+      ::grpc::ServerContext* server_context,
+      ::grpc::ServerReaderWriter<CompileBatchResponse, CompileBatchRequest>*
+          stream) override;
+
   // Run the given arguments as a subprocess with InvokeSubprocess.
   // InvokeSubprocess is wrapped because the error message can be very large (it
   // includes both stdout and stderr) which breaks propagation of the error via
@@ -87,11 +106,22 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
   std::string BuildSTACmds(const CompileRequest* request,
                            const std::filesystem::path& netlist_path) const;
 
+  // The commands of BuildSTACmds() which read the libraries, and those which
+  // analyze the given netlist.
+  std::string BuildSTALibraryCmds() const;
+  std::string BuildSTADesignCmds(
+      const CompileRequest* request,
+      const std::filesystem::path& netlist_path) const;
+
   absl::Status RunSTA(const CompileRequest* request, CompileResponse* result,
                       const std::filesystem::path& temp_dir_path,
                       const std::filesystem::path& netlist_path) const;
 
  private:
+  // If `max_workers` is positive, creates pools of up to that many Yosys and
+  // OpenSTA processes which are kept running between compilations.
+  void CreateToolWorkerPools(int64_t max_workers);
+
   std::string yosys_path_;
   std::string nextpnr_path_;
   std::string synthesis_target_;
@@ -103,6 +133,9 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
   bool save_temps_;
   bool return_netlist_;
   bool synthesis_only_;
+  CompileConcurrencyLimit compile_limit_;
+  std::unique_ptr<ToolWorkerPool> yosys_workers_;
+  std::unique_ptr<ToolWorkerPool> sta_workers_;
 };
 
 }  // namespace synthesis
@@ -122,21 +122,52 @@ absl::Status RealMain(std::string_view input_path) {
         BddFunction::Run(top.value(), absl::GetFlag(FLAGS_bdd_path_limit)));
     absl::Duration bdd_time = absl::Now() - start;
     total_time += bdd_time;
+    const BinaryDecisionDiagram& bdd = bdd_function->bdd();
     std::cout << "BDD construction time: " << bdd_time << "\n";
-    std::cout << "BDD node count: " << bdd_function->bdd().size() << "\n";
-    std::cout << "BDD variable count: " << bdd_function->bdd().variable_count()
+    std::cout << "BDD node count: " << bdd.size() << "\n";
+    std::cout << "BDD peak node count: " << bdd.statistics().peak_node_count
               << "\n";
+    std::cout << "BDD variable count: " << bdd.variable_count() << "\n";
 
     int64_t number_bits = 0;
+    std::vector<BddNodeIndex> expressions;
     for (Node* node : top.value()->nodes()) {
       number_bits += node->GetType()->GetFlatBitCount();
+      if (node->GetType()->IsBits()) {
+        for (int64_t i = 0; i < node->BitCountOrDie(); ++i) {
+          expressions.push_back(bdd_function->GetBddNode(node, i));
+        }
+      }
     }
     std::cout << "Bits in graph: " << number_bits << "\n";
 
+    // Compare the size of the BDD against one without complement edges and
+    // report how much garbage collection and the computed table helped.
+    int64_t reachable_nodes = bdd.GetNodeCount(expressions);
+    int64_t reachable_nodes_without_complement =
+        bdd.GetNodeCountWithoutComplementEdges(expressions);
+    std::cout << "BDD nodes reachable from expressions: " << reachable_nodes
+              << "\n";
+    std::cout << absl::StreamFormat(
+        "BDD nodes required without complement edges: %d (%.2fx)\n",
+        reachable_nodes_without_complement,
+        static_cast<double>(reachable_nodes_without_complement) /
+            reachable_nodes);
+    const BinaryDecisionDiagram::Statistics& statistics = bdd.statistics();
+    std::cout << absl::StreamFormat(
+        "BDD garbage collections: %d (%d nodes freed)\n", statistics.gc_count,
+        statistics.gc_freed_node_count);
+    std::cout << absl::StreamFormat(
+        "BDD computed table hit rate: %d / %d (%.1f%%)\n",
+        statistics.computed_table_hits, statistics.computed_table_lookups,
+        statistics.computed_table_lookups == 0
+            ? 0.0
+            : 100.0 * statistics.computed_table_hits /
+                  statistics.computed_table_lookups);
+
     int64_t max_paths = 0;
-    for (int64_t i = 0; i < bdd_function->bdd().size(); ++i) {
-      max_paths =
-          std::max(max_paths, bdd_function->bdd().path_count(BddNodeIndex(i)));
+    for (BddNodeIndex expression : expressions) {
+      max_paths = std::max(max_paths, bdd.path_count(expression));
     }
     if (max_paths == std::numeric_limits<int32_t>::max()) {
       std::cout << "Maximum paths of any expression: INT32_MAX\n";
@@ -79,6 +79,7 @@
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/pass_profile.h"
 #include "xls/passes/query_engine.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/tools/codegen.h"
@@ -129,6 +130,11 @@ ABSL_FLAG(std::string, synthesis_server, "ipv4:///0.0.0.0:10000",
           "The address, including port, of the gRPC server to use with "
           "--compare_delay_to_synthesis.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
+ABSL_FLAG(std::string, pass_profile_path, "",
+          "If specified, write the per-invocation profile of the optimization "
+          "pipeline to this path. A path ending in '.json' is written as a "
+          "Chrome trace, '.pb' as a binary PassPipelineProfileProto and "
+          "anything else as a text PassPipelineProfileProto.");
 
 namespace xls {
 namespace {
@@ -196,6 +202,10 @@ absl::Status RunOptimizationAndPrintStats(Package* package) {
                                   DurationToMs(total_time));
   std::cout << absl::StreamFormat("Dynamic pass count: %d\n",
                                   pass_results.invocations.size());
+  if (!absl::GetFlag(FLAGS_pass_profile_path).empty()) {
+    XLS_RETURN_IF_ERROR(WritePassProfile(
+        pass_results, absl::GetFlag(FLAGS_pass_profile_path)));
+  }
 
   // Aggregate run times by the pass name and print a table of the aggregate
   // execution time of each pass in descending order.
@@ -0,0 +1,118 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/tools/channel_data_file.h"
+#include "xls/tools/eval_utils.h"
+
+static constexpr std::string_view kUsage = R"(
+Converts channel values between the text form accepted by
+eval_proc_main's --inputs_for_all_channels and the binary channel data form
+accepted by --channel_data_inputs_for_all_channels.
+
+Text to binary (the IR file provides the types of the channels):
+
+  channel_data_converter_main --ir_file=IR_FILE --output=OUT.bin IN.txt
+
+Binary to text:
+
+  channel_data_converter_main --to_text --output=OUT.txt IN.bin
+)";
+
+ABSL_FLAG(bool, to_text, false,
+          "Convert a binary channel data file to text rather than the other "
+          "way around.");
+ABSL_FLAG(std::string, ir_file, "",
+          "IR file declaring the channels; required when converting to the "
+          "binary form.");
+ABSL_FLAG(std::string, output, "", "Path of the file to write.");
+
+namespace xls {
+namespace {
+
+absl::Status TextToBinary(std::string_view input_path,
+                          std::string_view ir_path,
+                          std::string_view output_path) {
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text));
+  absl::btree_map<std::string, Type*> channel_types;
+  for (Channel* channel : package->channels()) {
+    channel_types[std::string{channel->name()}] = channel->type();
+  }
+  absl::btree_map<std::string, std::vector<Value>> channel_values;
+  XLS_ASSIGN_OR_RETURN(channel_values, ParseChannelValuesFromFile(input_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitRuntime> runtime,
+                       CreateHostJitRuntime());
+  return WriteChannelValuesToDataFile(output_path, channel_values,
+                                      channel_types, *runtime);
+}
+
+absl::Status BinaryToText(std::string_view input_path,
+                          std::string_view output_path) {
+  // The types of the channels are recorded in the file itself.
+  Package package("channel_data");
+  XLS_ASSIGN_OR_RETURN(ChannelDataFile file,
+                       ChannelDataFile::Open(input_path, &package));
+  return SetFileContents(
+      output_path, ChannelValuesToString(file.ToChannelValues(std::nullopt)));
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.size() != 1) {
+    LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s INPUT_FILE",
+                                      argv[0]);
+  }
+  if (absl::GetFlag(FLAGS_output).empty()) {
+    LOG(QFATAL) << "--output (path of the converted file) required.";
+  }
+
+  if (absl::GetFlag(FLAGS_to_text)) {
+    return xls::ExitStatus(xls::BinaryToText(positional_arguments[0],
+                                             absl::GetFlag(FLAGS_output)));
+  }
+  if (absl::GetFlag(FLAGS_ir_file).empty()) {
+    LOG(QFATAL) << "--ir_file required when converting to the binary form.";
+  }
+  return xls::ExitStatus(xls::TextToBinary(positional_arguments[0],
+                                           absl::GetFlag(FLAGS_ir_file),
+                                           absl::GetFlag(FLAGS_output)));
+}
@@ -0,0 +1,237 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/channel_data_file.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "llvm/include/llvm/IR/DataLayout.h"
+#include "xls/common/file/mapped_file.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
+#include "xls/tools/channel_data_file.pb.h"
+
+namespace xls {
+namespace {
+
+// The file starts with the magic string followed by the size of the header
+// proto (a uint64_t); the data section follows the header at the next multiple
+// of kAlignment, as does the data of each channel within the data section.
+constexpr std::string_view kMagic = "XLSCHDAT";
+constexpr int64_t kAlignment = 64;
+constexpr int64_t kPreambleSize = kMagic.size() + sizeof(uint64_t);
+
+int64_t DataSectionOffset(int64_t header_size) {
+  return RoundUpToNearest<int64_t>(kPreambleSize + header_size, kAlignment);
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<ChannelDataFile> ChannelDataFile::Open(
+    const std::filesystem::path& path, Package* package) {
+  XLS_ASSIGN_OR_RETURN(MappedFile file, MappedFile::Open(path));
+  std::string_view contents = file.contents();
+  if (contents.size() < kPreambleSize || !contents.starts_with(kMagic)) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("%s is not a channel data file", path.string()));
+  }
+  uint64_t header_size;
+  std::memcpy(&header_size, contents.data() + kMagic.size(),
+              sizeof(header_size));
+  if (header_size > contents.size() - kPreambleSize) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Channel data file %s is truncated (header)", path.string()));
+  }
+  ChannelDataFileHeaderProto header;
+  if (!header.ParseFromArray(contents.data() + kPreambleSize, header_size)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Unable to parse header of channel data file %s", path.string()));
+  }
+
+  const int64_t data_offset = DataSectionOffset(header_size);
+  const auto* base = reinterpret_cast<const uint8_t*>(contents.data());
+  std::vector<ChannelData> channels;
+  channels.reserve(header.channels_size());
+  for (const ChannelDataFileHeaderProto::Channel& channel :
+       header.channels()) {
+    XLS_ASSIGN_OR_RETURN(TypeLayout layout,
+                         TypeLayout::FromProto(channel.layout(), package));
+    const int64_t size = channel.count() * layout.size();
+    if (channel.count() < 0 || channel.offset() < 0 ||
+        data_offset + channel.offset() + size > contents.size()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Channel data file %s is truncated (channel %s)", path.string(),
+          channel.name()));
+    }
+    channels.push_back(ChannelData{
+        .name = channel.name(),
+        .layout = std::move(layout),
+        .data = absl::MakeConstSpan(base + data_offset + channel.offset(),
+                                    size)});
+  }
+  return ChannelDataFile(std::move(file), std::move(channels));
+}
+
+const ChannelData* ChannelDataFile::GetChannel(std::string_view name) const {
+  auto it = std::find_if(
+      channels_.begin(), channels_.end(),
+      [&](const ChannelData& channel) { return channel.name == name; });
+  return it == channels_.end() ? nullptr : &*it;
+}
+
+absl::btree_map<std::string, std::vector<Value>>
+ChannelDataFile::ToChannelValues(
+    std::optional<int64_t> max_values_count) const {
+  absl::btree_map<std::string, std::vector<Value>> result;
+  for (const ChannelData& channel : channels_) {
+    int64_t count = channel.count();
+    if (max_values_count.has_value()) {
+      count = std::min(count, *max_values_count);
+    }
+    std::vector<Value>& values = result[channel.name];
+    values.reserve(count);
+    for (int64_t i = 0; i < count; ++i) {
+      values.push_back(channel.GetValue(i));
+    }
+  }
+  return result;
+}
+
+absl::Status ChannelDataMatchesLayout(const ChannelData& data, Type* type,
+                                      JitRuntime& runtime) {
+  const TypeLayout& expected = runtime.GetTypeLayout(type);
+  if (!data.layout.type()->IsEqualTo(type) ||
+      data.layout.size() != expected.size() ||
+      !std::equal(data.layout.elements().begin(), data.layout.elements().end(),
+                  expected.elements().begin(), expected.elements().end())) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Channel data for %s has layout %s; expected %s (was the file written "
+        "on a different host?)",
+        data.name, data.layout.ToString(), expected.ToString()));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<JitRuntime>> CreateHostJitRuntime() {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
+  XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
+                       orc_jit->CreateDataLayout());
+  return std::make_unique<JitRuntime>(data_layout);
+}
+
+absl::Status WriteChannelDataFile(const std::filesystem::path& path,
+                                  absl::Span<const ChannelData> channels) {
+  ChannelDataFileHeaderProto header;
+  int64_t offset = 0;
+  for (const ChannelData& channel : channels) {
+    XLS_RET_CHECK(channel.layout.size() == 0 ||
+                  channel.data.size() % channel.layout.size() == 0)
+        << channel.name;
+    ChannelDataFileHeaderProto::Channel* proto = header.add_channels();
+    proto->set_name(channel.name);
+    *proto->mutable_layout() = channel.layout.ToProto();
+    proto->set_count(channel.count());
+    proto->set_offset(offset);
+    offset =
+        RoundUpToNearest<int64_t>(offset + channel.data.size(), kAlignment);
+  }
+  const std::string header_bytes = header.SerializeAsString();
+  const uint64_t header_size = header_bytes.size();
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    return absl::UnavailableError(
+        absl::StrFormat("Unable to open %s for writing", path.string()));
+  }
+  const std::string padding(kAlignment, '\0');
+  int64_t position = 0;
+  auto write = [&](const void* data, int64_t size) {
+    out.write(static_cast<const char*>(data), size);
+    position += size;
+  };
+  auto pad_to = [&](int64_t target) {
+    write(padding.data(), target - position);
+  };
+  write(kMagic.data(), kMagic.size());
+  write(&header_size, sizeof(header_size));
+  write(header_bytes.data(), header_bytes.size());
+  const int64_t data_offset = DataSectionOffset(header_size);
+  for (int64_t i = 0; i < channels.size(); ++i) {
+    pad_to(data_offset + header.channels(i).offset());
+    write(channels[i].data.data(), channels[i].data.size());
+  }
+  out.close();
+  if (!out) {
+    return absl::UnavailableError(
+        absl::StrFormat("Unable to write channel data file %s", path.string()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status WriteChannelValuesToDataFile(
+    const std::filesystem::path& path,
+    const absl::btree_map<std::string, std::vector<Value>>& channel_values,
+    const absl::btree_map<std::string, Type*>& channel_types,
+    JitRuntime& runtime) {
+  std::vector<std::vector<uint8_t>> buffers;
+  buffers.reserve(channel_values.size());
+  std::vector<ChannelData> channels;
+  channels.reserve(channel_values.size());
+  for (const auto& [name, values] : channel_values) {
+    auto it = channel_types.find(name);
+    if (it == channel_types.end()) {
+      return absl::NotFoundError(
+          absl::StrFormat("No type given for channel %s", name));
+    }
+    const TypeLayout& layout = runtime.GetTypeLayout(it->second);
+    std::vector<uint8_t>& buffer =
+        buffers.emplace_back(values.size() * layout.size(), 0);
+    for (int64_t i = 0; i < values.size(); ++i) {
+      if (!ValueConformsToType(values[i], it->second)) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Value %s of channel %s does not have type %s",
+            values[i].ToString(), name, it->second->ToString()));
+      }
+      layout.ValueToNativeLayout(values[i], buffer.data() + i * layout.size());
+    }
+    channels.push_back(ChannelData{
+        .name = name, .layout = layout, .data = absl::MakeConstSpan(buffer)});
+  }
+  return WriteChannelDataFile(path, channels);
+}
+
+}  // namespace xls
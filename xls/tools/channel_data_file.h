@@ -0,0 +1,122 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_TOOLS_CHANNEL_DATA_FILE_H_
+#define XLS_TOOLS_CHANNEL_DATA_FILE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/file/mapped_file.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+
+// The values of one channel held in the native layout used by the JIT.
+struct ChannelData {
+  std::string name;
+  TypeLayout layout;
+  // The values, stored back to back (`layout.size()` bytes each).
+  absl::Span<const uint8_t> data;
+
+  int64_t count() const {
+    return layout.size() == 0 ? 0 : data.size() / layout.size();
+  }
+  const uint8_t* GetRaw(int64_t i) const {
+    return data.data() + i * layout.size();
+  }
+  Value GetValue(int64_t i) const {
+    return layout.NativeLayoutToValue(GetRaw(i));
+  }
+};
+
+// A binary file holding the values of a set of channels in the native layout
+// used by the JIT, so that large stimulus (or result) sets can be fed to (or
+// drained from) JIT channel queues with a copy per value rather than parsing
+// text or protos into Values first.
+//
+// The file is a short header (a ChannelDataFileHeaderProto, which records the
+// layout each channel was written with) followed by the values of each channel
+// at a cache-line aligned offset. Files are memory mapped when read, so pages
+// are faulted in as the values are consumed.
+//
+// The native layout (and the byte order of the header) is that of the host
+// writing the file. Use ChannelDataMatchesLayout() to check that a file can be
+// consumed directly by a JIT; channel_data_converter_main converts between
+// this format and the text format of ParseChannelValues().
+class ChannelDataFile {
+ public:
+  // Maps the file at `path`. Types of the channels are created in `package`.
+  static absl::StatusOr<ChannelDataFile> Open(const std::filesystem::path& path,
+                                              Package* package);
+
+  absl::Span<const ChannelData> channels() const { return channels_; }
+
+  // Returns the channel with the given name or nullptr if there is none.
+  const ChannelData* GetChannel(std::string_view name) const;
+
+  // Returns a channels-to-values map of the contents of the file, as
+  // ParseChannelValues() does for the text format. At most
+  // `max_values_count` values are returned per channel.
+  absl::btree_map<std::string, std::vector<Value>> ToChannelValues(
+      std::optional<int64_t> max_values_count = std::nullopt) const;
+
+ private:
+  ChannelDataFile(MappedFile file, std::vector<ChannelData> channels)
+      : file_(std::move(file)), channels_(std::move(channels)) {}
+
+  MappedFile file_;
+  std::vector<ChannelData> channels_;
+};
+
+// Returns an error if `data` was not written in the layout `runtime` uses for
+// values of type `type`.
+absl::Status ChannelDataMatchesLayout(const ChannelData& data, Type* type,
+                                      JitRuntime& runtime);
+
+// Returns a runtime using the data layout of the JIT for the host, for
+// writing channel data files which can be fed to the JIT directly.
+absl::StatusOr<std::unique_ptr<JitRuntime>> CreateHostJitRuntime();
+
+// Writes a channel data file holding `channels` to `path`.
+absl::Status WriteChannelDataFile(const std::filesystem::path& path,
+                                  absl::Span<const ChannelData> channels);
+
+// Writes a channel data file holding the given channels-to-values map to
+// `path`, using the layouts of `runtime`. The type of each channel is given by
+// `channel_types`.
+absl::Status WriteChannelValuesToDataFile(
+    const std::filesystem::path& path,
+    const absl::btree_map<std::string, std::vector<Value>>& channel_values,
+    const absl::btree_map<std::string, Type*>& channel_types,
+    JitRuntime& runtime);
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_CHANNEL_DATA_FILE_H_
@@ -0,0 +1,126 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/channel_data_file.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/btree_map.h"
+#include "absl/status/status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_runtime.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+class ChannelDataFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(runtime_, CreateHostJitRuntime());
+  }
+
+  std::unique_ptr<JitRuntime> runtime_;
+};
+
+TEST_F(ChannelDataFileTest, RoundTrip) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  const std::filesystem::path path = temp_dir.path() / "data.bin";
+
+  Package package("test");
+  Type* u32 = package.GetBitsType(32);
+  Type* tuple = package.GetTupleType({package.GetBitsType(1), u32});
+  absl::btree_map<std::string, std::vector<Value>> values = {
+      {"a", {Value(UBits(1, 32)), Value(UBits(2, 32)), Value(UBits(3, 32))}},
+      {"b",
+       {Value::Tuple({Value(UBits(1, 1)), Value(UBits(42, 32))}),
+        Value::Tuple({Value(UBits(0, 1)), Value(UBits(7, 32))})}},
+      {"empty", {}},
+  };
+  XLS_ASSERT_OK(WriteChannelValuesToDataFile(
+      path, values, {{"a", u32}, {"b", tuple}, {"empty", u32}}, *runtime_));
+
+  // Types are recreated in the package the file is opened with.
+  Package other("other");
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelDataFile file,
+                           ChannelDataFile::Open(path, &other));
+  ASSERT_EQ(file.channels().size(), 3);
+  const ChannelData* b = file.GetChannel("b");
+  ASSERT_NE(b, nullptr);
+  EXPECT_EQ(b->count(), 2);
+  EXPECT_EQ(b->GetValue(1), values["b"][1]);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(b->GetRaw(0)) % 64, 0);
+  EXPECT_EQ(file.GetChannel("c"), nullptr);
+
+  EXPECT_EQ(file.ToChannelValues(std::nullopt), values);
+  EXPECT_THAT(file.ToChannelValues(1),
+              ElementsAre(Pair("a", ElementsAre(Value(UBits(1, 32)))),
+                          Pair("b", ElementsAre(values["b"][0])),
+                          Pair("empty", ElementsAre())));
+}
+
+TEST_F(ChannelDataFileTest, LayoutMustMatch) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  const std::filesystem::path path = temp_dir.path() / "data.bin";
+
+  Package package("test");
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK(WriteChannelValuesToDataFile(
+      path, {{"a", {Value(UBits(1, 32))}}}, {{"a", u32}}, *runtime_));
+
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelDataFile file,
+                           ChannelDataFile::Open(path, &package));
+  const ChannelData& a = file.channels()[0];
+  XLS_EXPECT_OK(ChannelDataMatchesLayout(a, u32, *runtime_));
+  EXPECT_THAT(ChannelDataMatchesLayout(a, package.GetBitsType(64), *runtime_),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(ChannelDataFileTest, ValuesMustConformToType) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  Package package("test");
+  EXPECT_THAT(WriteChannelValuesToDataFile(
+                  temp_dir.path() / "data.bin", {{"a", {Value(UBits(1, 8))}}},
+                  {{"a", package.GetBitsType(32)}}, *runtime_),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(ChannelDataFileTest, RejectsOtherFiles) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  const std::filesystem::path path = temp_dir.path() / "data.txt";
+  XLS_ASSERT_OK(SetFileContents(path, "a : {\n  bits[32]:1\n}\n"));
+  Package package("test");
+  EXPECT_THAT(ChannelDataFile::Open(path, &package),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace xls
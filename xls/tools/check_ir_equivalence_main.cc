@@ -12,18 +12,22 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <thread>  // NOLINT(build/c++11)
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/exit_status.h"
@@ -31,6 +35,7 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
@@ -40,6 +45,8 @@
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/unroll_pass.h"
+#include "xls/solvers/z3_aig_equivalence.h"
+#include "xls/solvers/z3_ir_equivalence.h"
 #include "xls/solvers/z3_ir_translator.h"
 #include "xls/solvers/z3_utils.h"
 #include "external/z3/src/api/z3_api.h"
@@ -65,6 +72,22 @@ ABSL_FLAG(std::string, top, "",
 ABSL_FLAG(absl::Duration, timeout, absl::InfiniteDuration(),
           "How long to wait for any proof to complete.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
+ABSL_FLAG(int64_t, worker_count, 0,
+          "If positive, split the check into one sub-query per element of the "
+          "return value (see --max_bits_per_query) and prove the sub-queries "
+          "on this many threads, stopping at the first counterexample.");
+ABSL_FLAG(absl::Duration, timeout_per_query, absl::InfiniteDuration(),
+          "When --worker_count is positive, how long each sub-query may run.");
+ABSL_FLAG(int64_t, max_bits_per_query, 0,
+          "When --worker_count is positive, also split bits-typed elements of "
+          "the return value into slices of at most this many bits. Zero means "
+          "elements are not split.");
+ABSL_FLAG(std::string, engine, "z3",
+          "The engine proving equivalence: \"z3\" translates both functions "
+          "to bit-vector formulas; \"aig\" lowers them to an and-inverter "
+          "graph and merges equivalent nodes by SAT sweeping before proving "
+          "the outputs (see TryProveEquivalenceWithAig). --timeout applies "
+          "to each output query of the \"aig\" engine.");
 
 namespace xls {
 
@@ -85,8 +108,55 @@ static absl::StatusOr<Z3_ast> CreateComparisonFunction(
   return Z3_mk_eq(ctx, result1, result2);
 }
 
+static void PrintProverResult(const solvers::z3::ProverResult& result) {
+  if (std::holds_alternative<solvers::z3::ProvenTrue>(result)) {
+    std::cout << "Solver result; satisfiable: false\n";
+  } else {
+    std::cout << std::get<solvers::z3::ProvenFalse>(result).message << '\n';
+  }
+}
+
+// Proves equivalence with one Z3 query per output slice; see
+// TryProveEquivalenceInParallel.
+static absl::Status CheckInParallel(Function* a, Function* b,
+                                    int64_t worker_count,
+                                    absl::Duration timeout_per_query,
+                                    int64_t max_bits_per_query) {
+  solvers::z3::ParallelEquivalenceOptions options{
+      .worker_count = worker_count, .timeout_per_query = timeout_per_query};
+  if (max_bits_per_query > 0) {
+    options.max_bits_per_query = max_bits_per_query;
+  }
+  XLS_ASSIGN_OR_RETURN(
+      solvers::z3::ProverResult result,
+      solvers::z3::TryProveEquivalenceInParallel(a, b, options));
+  PrintProverResult(result);
+  return absl::OkStatus();
+}
+
+// Proves equivalence by SAT sweeping an AIG of both functions; see
+// TryProveEquivalenceWithAig.
+static absl::Status CheckWithAig(Function* a, Function* b,
+                                 absl::Duration timeout) {
+  solvers::z3::AigEquivalenceOptions options;
+  options.timeout = timeout;
+  XLS_ASSIGN_OR_RETURN(
+      solvers::z3::ProverResult result,
+      solvers::z3::TryProveEquivalenceWithAig(a, b, options));
+  PrintProverResult(result);
+  return absl::OkStatus();
+}
+
 static absl::Status RealMain(const std::vector<std::string_view>& ir_paths,
-                             const std::string& entry, absl::Duration timeout) {
+                             const std::string& entry, absl::Duration timeout,
+                             int64_t worker_count,
+                             absl::Duration timeout_per_query,
+                             int64_t max_bits_per_query,
+                             std::string_view engine) {
+  if (engine != "z3" && engine != "aig") {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unknown --engine: \"%s\"", engine));
+  }
   std::vector<std::unique_ptr<Package>> packages;
   for (const auto ir_path : ir_paths) {
     XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
@@ -126,6 +196,14 @@ static absl::Status RealMain(const std::vector<std::string_view>& ir_paths,
     functions.push_back(func);
   }
 
+  if (engine == "aig") {
+    return CheckWithAig(functions[0], functions[1], timeout);
+  }
+  if (worker_count > 0) {
+    return CheckInParallel(functions[0], functions[1], worker_count,
+                           timeout_per_query, max_bits_per_query);
+  }
+
   std::vector<std::unique_ptr<IrTranslator>> translators;
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
                        IrTranslator::CreateAndTranslate(functions[0]));
@@ -175,5 +253,8 @@ int main(int argc, char** argv) {
       xls::InitXls(kUsage, argc, argv);
   QCHECK_EQ(positional_args.size(), 2) << "Two IR files must be specified!";
   return xls::ExitStatus(xls::RealMain(
-      positional_args, absl::GetFlag(FLAGS_top), absl::GetFlag(FLAGS_timeout)));
+      positional_args, absl::GetFlag(FLAGS_top), absl::GetFlag(FLAGS_timeout),
+      absl::GetFlag(FLAGS_worker_count),
+      absl::GetFlag(FLAGS_timeout_per_query),
+      absl::GetFlag(FLAGS_max_bits_per_query), absl::GetFlag(FLAGS_engine)));
 }
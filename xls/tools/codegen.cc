@@ -43,6 +43,7 @@
 #include "xls/ir/function_base.h"
 #include "xls/ir/op.h"
 #include "xls/ir/verifier.h"
+#include "xls/passes/pass_base.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -74,15 +75,18 @@ using PipelineScheduleOrGroup =
 
 absl::StatusOr<PipelineScheduleOrGroup> RunSchedulingPipeline(
     FunctionBase* main, const SchedulingOptions& scheduling_options,
-    const DelayEstimator* delay_estimator,
-    synthesis::Synthesizer* synthesizer) {
+    const DelayEstimator* delay_estimator, synthesis::Synthesizer* synthesizer,
+    SchedulingPassResults* scheduling_pass_results) {
   SchedulingPassOptions sched_options;
   sched_options.scheduling_options = scheduling_options;
   sched_options.delay_estimator = delay_estimator;
   sched_options.synthesizer = synthesizer;
   std::unique_ptr<SchedulingCompoundPass> scheduling_pipeline =
       CreateSchedulingPassPipeline();
-  SchedulingPassResults results;
+  SchedulingPassResults local_results;
+  SchedulingPassResults& results = scheduling_pass_results == nullptr
+                                       ? local_results
+                                       : *scheduling_pass_results;
   XLS_RETURN_IF_ERROR(main->package()->SetTop(main));
   auto scheduling_unit =
       (scheduling_options.schedule_all_procs())
@@ -198,6 +202,14 @@ absl::StatusOr<verilog::CodegenOptions> CodegenOptionsFromProto(
     options.emit_sv_types(p.emit_sv_types());
   }
 
+  if (!p.codegen_cache_dir().empty()) {
+    // Every option affecting the generated Verilog is in the flags proto, so
+    // its text form (less the cache directory itself) salts the cache keys.
+    CodegenFlagsProto salt = p;
+    salt.clear_codegen_cache_dir();
+    options.codegen_cache(p.codegen_cache_dir(), salt.DebugString());
+  }
+
   std::vector<std::unique_ptr<verilog::RamConfiguration>> ram_configurations;
   ram_configurations.reserve(p.ram_configurations_size());
   for (const std::string& config_text : p.ram_configurations()) {
@@ -229,7 +241,8 @@ absl::StatusOr<verilog::CodegenOptions> CodegenOptionsFromProto(
 
 absl::StatusOr<PipelineScheduleOrGroup> Schedule(
     Package* p, const SchedulingOptions& scheduling_options,
-    const DelayEstimator* delay_estimator, absl::Duration* scheduling_time) {
+    const DelayEstimator* delay_estimator, absl::Duration* scheduling_time,
+    PassResults* scheduling_pass_results) {
   QCHECK(scheduling_options.pipeline_stages() != 0 ||
          scheduling_options.clock_period_ps() != 0)
       << "Must specify --pipeline_stages or --clock_period_ps (or both).";
@@ -243,7 +256,8 @@ absl::StatusOr<PipelineScheduleOrGroup> Schedule(
     XLS_ASSIGN_OR_RETURN(synthesizer, SetUpSynthesizer(scheduling_options));
   }
   absl::StatusOr<PipelineScheduleOrGroup> result = RunSchedulingPipeline(
-      *p->GetTop(), scheduling_options, delay_estimator, synthesizer);
+      *p->GetTop(), scheduling_options, delay_estimator, synthesizer,
+      scheduling_pass_results);
   if (scheduling_time != nullptr) {
     *scheduling_time = stopwatch->GetElapsedTime();
   }
@@ -253,7 +267,8 @@ absl::StatusOr<PipelineScheduleOrGroup> Schedule(
 absl::StatusOr<CodegenResult> CodegenPipeline(
     Package* p, PipelineScheduleOrGroup schedules,
     const verilog::CodegenOptions& codegen_options,
-    const DelayEstimator* delay_estimator, absl::Duration* codegen_time) {
+    const DelayEstimator* delay_estimator, absl::Duration* codegen_time,
+    PassResults* codegen_pass_results) {
   XLS_RETURN_IF_ERROR(VerifyPackage(p, /*codegen=*/true));
 
   std::optional<Stopwatch> stopwatch;
@@ -266,16 +281,18 @@ absl::StatusOr<CodegenResult> CodegenPipeline(
   if (std::holds_alternative<PipelineSchedule>(schedules)) {
     const PipelineSchedule& schedule = std::get<PipelineSchedule>(schedules);
     XLS_ASSIGN_OR_RETURN(
-        result, verilog::ToPipelineModuleText(
-                    schedule, *p->GetTop(), codegen_options, delay_estimator));
+        result, verilog::ToPipelineModuleText(schedule, *p->GetTop(),
+                                              codegen_options, delay_estimator,
+                                              codegen_pass_results));
     package_pipeline_schedules_proto.mutable_schedules()->insert(
         {schedule.function_base()->name(), schedule.ToProto(*delay_estimator)});
   } else if (std::holds_alternative<PackagePipelineSchedules>(schedules)) {
     const PackagePipelineSchedules& schedule_group =
         std::get<PackagePipelineSchedules>(schedules);
     XLS_ASSIGN_OR_RETURN(
-        result, verilog::ToPipelineModuleText(
-                    schedule_group, p, codegen_options, delay_estimator));
+        result, verilog::ToPipelineModuleText(schedule_group, p,
+                                              codegen_options, delay_estimator,
+                                              codegen_pass_results));
     package_pipeline_schedules_proto =
         PackagePipelineSchedulesToProto(schedule_group, *delay_estimator);
   } else {
@@ -295,14 +312,16 @@ absl::StatusOr<CodegenResult> CodegenPipeline(
 
 absl::StatusOr<CodegenResult> CodegenCombinational(
     Package* p, const verilog::CodegenOptions& codegen_options,
-    const DelayEstimator* delay_estimator, absl::Duration* codegen_time) {
+    const DelayEstimator* delay_estimator, absl::Duration* codegen_time,
+    PassResults* codegen_pass_results) {
   std::optional<Stopwatch> stopwatch;
   if (codegen_time != nullptr) {
     stopwatch.emplace();
   }
   XLS_ASSIGN_OR_RETURN(verilog::ModuleGeneratorResult result,
                        verilog::GenerateCombinationalModule(
-                           *p->GetTop(), codegen_options, delay_estimator));
+                           *p->GetTop(), codegen_options, delay_estimator,
+                           codegen_pass_results));
   if (codegen_time != nullptr) {
     *codegen_time = stopwatch->GetElapsedTime();
   }
@@ -313,7 +332,8 @@ absl::StatusOr<CodegenResult> ScheduleAndCodegen(
     Package* p,
     const SchedulingOptionsFlagsProto& scheduling_options_flags_proto,
     const CodegenFlagsProto& codegen_flags_proto, bool with_delay_model,
-    TimingReport* timing_report, PipelineScheduleOrGroup* schedules) {
+    TimingReport* timing_report, PipelineScheduleOrGroup* schedules,
+    PassResults* scheduling_pass_results, PassResults* codegen_pass_results) {
   if (!codegen_flags_proto.top().empty()) {
     XLS_RETURN_IF_ERROR(p->SetTopByName(codegen_flags_proto.top()));
   }
@@ -331,7 +351,8 @@ absl::StatusOr<CodegenResult> ScheduleAndCodegen(
     }
     return CodegenCombinational(
         p, codegen_options, delay_estimator,
-        timing_report ? &timing_report->codegen_time : nullptr);
+        timing_report ? &timing_report->codegen_time : nullptr,
+        codegen_pass_results);
   }
 
   // Note: this should already be validated by CodegenFlagsFromAbslFlags().
@@ -369,7 +390,8 @@ absl::StatusOr<CodegenResult> ScheduleAndCodegen(
   XLS_ASSIGN_OR_RETURN(
       *schedules,
       Schedule(p, scheduling_options, &delay_estimator,
-               timing_report ? &timing_report->scheduling_time : nullptr));
+               timing_report ? &timing_report->scheduling_time : nullptr,
+               scheduling_pass_results));
 
   if (p->GetTop().value()->IsProc()) {
     // Force using non-pretty printed codegen when generating procs.
@@ -379,7 +401,8 @@ absl::StatusOr<CodegenResult> ScheduleAndCodegen(
   }
   return CodegenPipeline(
       p, *schedules, codegen_options, &delay_estimator,
-      timing_report ? &timing_report->codegen_time : nullptr);
+      timing_report ? &timing_report->codegen_time : nullptr,
+      codegen_pass_results);
 }
 
 }  // namespace xls
@@ -21,6 +21,7 @@
 #include "xls/codegen/module_signature.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/package.h"
+#include "xls/passes/pass_base.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -35,10 +36,13 @@ namespace xls {
 using PipelineScheduleOrGroup =
     std::variant<PipelineSchedule, PackagePipelineSchedules>;
 
+// Schedules the top of `p`. If `scheduling_pass_results` is non-null the
+// invocations of the scheduling pass pipeline are recorded in it.
 absl::StatusOr<PipelineScheduleOrGroup> Schedule(
     Package* p, const SchedulingOptions& scheduling_options,
     const DelayEstimator* delay_estimator,
-    absl::Duration* scheduling_time = nullptr);
+    absl::Duration* scheduling_time = nullptr,
+    PassResults* scheduling_pass_results = nullptr);
 
 struct CodegenResult {
   verilog::ModuleGeneratorResult module_generator_result;
@@ -46,16 +50,20 @@ struct CodegenResult {
       package_pipeline_schedules_proto = std::nullopt;
 };
 
+// If `codegen_pass_results` is non-null, the invocations of the codegen pass
+// pipeline are recorded in it.
 absl::StatusOr<CodegenResult> CodegenPipeline(
     Package* p, PipelineScheduleOrGroup schedules,
     const verilog::CodegenOptions& codegen_options,
     const DelayEstimator* delay_estimator,
-    absl::Duration* codegen_time = nullptr);
+    absl::Duration* codegen_time = nullptr,
+    PassResults* codegen_pass_results = nullptr);
 
 absl::StatusOr<CodegenResult> CodegenCombinational(
     Package* p, const verilog::CodegenOptions& codegen_options,
     const DelayEstimator* delay_estimator,
-    absl::Duration* codegen_time = nullptr);
+    absl::Duration* codegen_time = nullptr,
+    PassResults* codegen_pass_results = nullptr);
 
 absl::StatusOr<verilog::CodegenOptions> CodegenOptionsFromProto(
     const CodegenFlagsProto& p);
@@ -70,7 +78,9 @@ absl::StatusOr<CodegenResult> ScheduleAndCodegen(
     const SchedulingOptionsFlagsProto& scheduling_options_flags_proto,
     const CodegenFlagsProto& codegen_flags_proto, bool with_delay_model,
     TimingReport* timing_report = nullptr,
-    PipelineScheduleOrGroup* schedules = nullptr);
+    PipelineScheduleOrGroup* schedules = nullptr,
+    PassResults* scheduling_pass_results = nullptr,
+    PassResults* codegen_pass_results = nullptr);
 
 }  // namespace xls
 
@@ -159,6 +159,10 @@ ABSL_FLAG(bool, emit_sv_types, true,
 //   //xls/build_rules/xls_providers.bzl,
 //   //docs_src/codegen_options.md
 // )
+ABSL_FLAG(std::string, codegen_cache_dir, "",
+          "Directory in which to cache the generated Verilog of each block. "
+          "Blocks whose IR and codegen options match a previous run reuse the "
+          "cached Verilog instead of being regenerated.");
 // This flag should only be specified by the build-system itself and cannot be
 // manually configured.
 ABSL_FLAG(
@@ -273,6 +277,9 @@ static absl::StatusOr<bool> SetOptionsFromFlags(CodegenFlagsProto &proto) {
   proto.set_register_merge_strategy(merge_strategy);
 
   // Misc
+  if (!absl::GetFlag(FLAGS_codegen_cache_dir).empty()) {
+    POPULATE_FLAG(codegen_cache_dir);
+  }
   if (absl::GetFlag(FLAGS_ir_interface_proto)) {
     XLS_ASSIGN_OR_RETURN(
         std::string interface_bytes,
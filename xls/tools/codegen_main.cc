@@ -31,9 +31,11 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/binary_ir.h"
 #include "xls/ir/function_base.h"
-#include "xls/ir/ir_parser.h"
 #include "xls/ir/verifier.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/pass_profile.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/tools/codegen.h"
 #include "xls/tools/codegen_flags.h"
@@ -57,6 +59,19 @@ Emit a feed-forward pipelined module:
        IR_FILE
 )";
 
+ABSL_FLAG(std::string, output_scheduling_pass_profile_path, "",
+          "If specified, write the per-invocation profile (wall time, CPU "
+          "time, peak RSS delta and node counts) of the scheduling pass "
+          "pipeline to this path. A path ending in '.json' is written as a "
+          "Chrome trace, '.pb' as a binary PassPipelineProfileProto and "
+          "anything else as a text PassPipelineProfileProto.");
+ABSL_FLAG(std::string, output_codegen_pass_profile_path, "",
+          "If specified, write the per-invocation profile of the codegen pass "
+          "pipeline to this path, in the same formats as "
+          "--output_scheduling_pass_profile_path. The profile is also "
+          "recorded in the metrics of the signature written to "
+          "--output_signature_path.");
+
 namespace xls {
 namespace {
 
@@ -67,7 +82,7 @@ absl::Status RealMain(std::string_view ir_path) {
   }
   XLS_ASSIGN_OR_RETURN(std::string ir_contents, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> p,
-                       Parser::ParsePackage(ir_contents, ir_path));
+                       ParsePackageFromTextOrBinaryIr(ir_contents, ir_path));
 
   XLS_ASSIGN_OR_RETURN(CodegenFlagsProto codegen_flags_proto,
                        GetCodegenFlags());
@@ -85,11 +100,31 @@ absl::Status RealMain(std::string_view ir_path) {
   XLS_ASSIGN_OR_RETURN(
       bool delay_model_flag_passed,
       IsDelayModelSpecifiedViaFlag(scheduling_options_flags_proto));
+  PassResults scheduling_pass_results;
+  PassResults codegen_pass_results;
   XLS_ASSIGN_OR_RETURN(
       CodegenResult r,
       ScheduleAndCodegen(p.get(), scheduling_options_flags_proto,
-                         codegen_flags_proto, delay_model_flag_passed));
+                         codegen_flags_proto, delay_model_flag_passed,
+                         /*timing_report=*/nullptr, /*schedules=*/nullptr,
+                         &scheduling_pass_results, &codegen_pass_results));
+  const std::string& scheduling_pass_profile_path =
+      absl::GetFlag(FLAGS_output_scheduling_pass_profile_path);
+  if (!scheduling_pass_profile_path.empty()) {
+    XLS_RETURN_IF_ERROR(WritePassProfile(scheduling_pass_results,
+                                         scheduling_pass_profile_path));
+  }
   verilog::ModuleGeneratorResult result = r.module_generator_result;
+  const std::string& codegen_pass_profile_path =
+      absl::GetFlag(FLAGS_output_codegen_pass_profile_path);
+  if (!codegen_pass_profile_path.empty()) {
+    XLS_RETURN_IF_ERROR(
+        WritePassProfile(codegen_pass_results, codegen_pass_profile_path));
+    // Timings are not deterministic so the profile is only added to the
+    // signature on request.
+    result.signature.ReplaceCodegenPassProfile(
+        PassResultsToProfileProto(codegen_pass_results));
+  }
   std::optional<PackagePipelineSchedulesProto> schedule =
       r.package_pipeline_schedules_proto;
 
@@ -0,0 +1,285 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/design_benchmark.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/resource_usage.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/stopwatch.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/dslx/command_line_utils.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/frontend/module.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/ir_convert/conversion_info.h"
+#include "xls/dslx/ir_convert/convert_options.h"
+#include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/warning_kind.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_proc_runtime.h"
+#include "xls/scheduling/scheduling_options.h"
+#include "xls/tools/codegen.h"
+#include "xls/tools/codegen_flags.pb.h"
+#include "xls/tools/opt.h"
+#include "xls/tools/scheduling_options_flags.h"
+#include "xls/tools/scheduling_options_flags.pb.h"
+#include "nlohmann/json.hpp"
+
+namespace xls {
+namespace {
+
+// Number of distinct random argument sets with which a function is evaluated
+// in the "jit_run" stage. The sets are reused cyclically so generating them
+// does not dominate the benchmark.
+constexpr int64_t kMaxArgumentSets = 64;
+
+// Calls `f` and appends the time and memory it consumed to `result` as a stage
+// named `stage`. Returns the value returned by `f`.
+template <typename F>
+auto MeasureStage(std::string_view stage, DesignBenchmarkResult& result,
+                  F&& f) {
+  ResourceUsage before = GetResourceUsage();
+  Stopwatch stopwatch;
+  auto value = f();
+  absl::Duration wall_time = stopwatch.GetElapsedTime();
+  ResourceUsage after = GetResourceUsage();
+  result.stages.push_back(StageMeasurement{
+      .stage = std::string(stage),
+      .wall_time = wall_time,
+      .cpu_time = after.cpu_time - before.cpu_time,
+      .peak_rss_bytes = after.peak_rss_bytes,
+      .peak_rss_growth_bytes = after.peak_rss_bytes - before.peak_rss_bytes,
+  });
+  return value;
+}
+
+// Parses, typechecks and converts the DSLX design to IR. Returns the IR text.
+absl::StatusOr<std::string> ConvertDslx(const DesignBenchmarkOptions& options,
+                                        DesignBenchmarkResult& result) {
+  std::string path = options.path.string();
+  XLS_ASSIGN_OR_RETURN(std::string text, GetFileContents(options.path));
+  XLS_ASSIGN_OR_RETURN(std::string module_name, dslx::PathToName(path));
+  dslx::ImportData import_data(dslx::CreateImportData(
+      options.dslx_stdlib_path, options.dslx_paths, dslx::kDefaultWarningsSet));
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<dslx::Module> module,
+                       MeasureStage("parse", result, [&] {
+                         return dslx::ParseModule(text, path, module_name);
+                       }));
+  XLS_ASSIGN_OR_RETURN(dslx::TypecheckedModule typechecked,
+                       MeasureStage("typecheck", result, [&] {
+                         return dslx::TypecheckModule(std::move(module), path,
+                                                      &import_data);
+                       }));
+  dslx::PackageConversionData conversion_data{
+      .package = std::make_unique<Package>(module_name)};
+  XLS_RETURN_IF_ERROR(MeasureStage("ir_convert", result, [&] {
+    return dslx::ConvertOneFunctionIntoPackage(
+        typechecked.module, options.top, &import_data,
+        /*parametric_env=*/nullptr, dslx::ConvertOptions{}, &conversion_data);
+  }));
+  return conversion_data.DumpIr();
+}
+
+absl::Status ScheduleAndCodegenPackage(Package* package,
+                                       const DesignBenchmarkOptions& options,
+                                       DesignBenchmarkResult& result) {
+  SchedulingOptionsFlagsProto scheduling_flags;
+  scheduling_flags.set_pipeline_stages(options.pipeline_stages);
+  scheduling_flags.set_delay_model(options.delay_model);
+  scheduling_flags.set_multi_proc(package->procs().size() > 1);
+  XLS_ASSIGN_OR_RETURN(SchedulingOptions scheduling_options,
+                       SetUpSchedulingOptions(scheduling_flags, package));
+  XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
+                       SetUpDelayEstimator(scheduling_flags));
+  XLS_ASSIGN_OR_RETURN(PipelineScheduleOrGroup schedules,
+                       MeasureStage("schedule", result, [&] {
+                         return Schedule(package, scheduling_options,
+                                         delay_estimator);
+                       }));
+
+  CodegenFlagsProto codegen_flags;
+  codegen_flags.set_generator(GENERATOR_KIND_PIPELINE);
+  XLS_ASSIGN_OR_RETURN(verilog::CodegenOptions codegen_options,
+                       CodegenOptionsFromProto(codegen_flags));
+  return MeasureStage("codegen", result, [&] {
+    return CodegenPipeline(package, std::move(schedules), codegen_options,
+                           delay_estimator)
+        .status();
+  });
+}
+
+absl::Status RunFunctionJit(Function* function,
+                            const DesignBenchmarkOptions& options,
+                            DesignBenchmarkResult& result) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<FunctionJit> jit,
+      MeasureStage("jit_compile", result,
+                   [&] { return FunctionJit::Create(function); }));
+
+  std::minstd_rand rng(0);
+  std::vector<std::vector<Value>> argument_sets;
+  for (int64_t i = 0;
+       i < std::min(options.jit_run_iterations, kMaxArgumentSets); ++i) {
+    argument_sets.push_back(RandomFunctionArguments(function, rng));
+  }
+  // Assertion failures on random arguments are reported as interpreter events
+  // rather than errors and are ignored.
+  return MeasureStage("jit_run", result, [&]() -> absl::Status {
+    for (int64_t i = 0; i < options.jit_run_iterations; ++i) {
+      XLS_RETURN_IF_ERROR(
+          jit->Run(argument_sets[i % argument_sets.size()]).status());
+    }
+    return absl::OkStatus();
+  });
+}
+
+absl::Status RunProcJit(Package* package, Proc* top,
+                        const DesignBenchmarkOptions& options,
+                        DesignBenchmarkResult& result) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<SerialProcRuntime> runtime,
+      MeasureStage("jit_compile", result, [&] {
+        return top->is_new_style_proc() ? CreateJitSerialProcRuntime(top)
+                                        : CreateJitSerialProcRuntime(package);
+      }));
+
+  // Inputs of the proc network always have a zero value available and the
+  // outputs are drained after every tick.
+  std::vector<ChannelQueue*> output_queues;
+  for (ChannelQueue* queue : runtime->queue_manager().queues()) {
+    if (queue->channel()->supported_ops() == ChannelOps::kReceiveOnly) {
+      XLS_RETURN_IF_ERROR(queue->AttachGenerator(
+          [value = ZeroOfType(queue->channel()->type())]()
+              -> std::optional<Value> { return value; }));
+    } else if (queue->channel()->supported_ops() == ChannelOps::kSendOnly) {
+      output_queues.push_back(queue);
+    }
+  }
+  return MeasureStage("jit_run", result, [&]() -> absl::Status {
+    for (int64_t i = 0; i < options.jit_run_iterations; ++i) {
+      XLS_RETURN_IF_ERROR(runtime->Tick());
+      for (ChannelQueue* queue : output_queues) {
+        while (queue->Read().has_value()) {
+        }
+      }
+    }
+    return absl::OkStatus();
+  });
+}
+
+}  // namespace
+
+std::string DesignBenchmarkResult::ToJsonLines() const {
+  std::string lines;
+  for (const StageMeasurement& measurement : stages) {
+    nlohmann::json json;
+    json["design"] = design;
+    json["stage"] = measurement.stage;
+    json["wall_ns"] = absl::ToInt64Nanoseconds(measurement.wall_time);
+    json["cpu_ns"] = absl::ToInt64Nanoseconds(measurement.cpu_time);
+    json["peak_rss_bytes"] = measurement.peak_rss_bytes;
+    json["peak_rss_growth_bytes"] = measurement.peak_rss_growth_bytes;
+    absl::StrAppend(&lines, json.dump(), "\n");
+  }
+  return lines;
+}
+
+absl::StatusOr<DesignBenchmarkResult> RunDesignBenchmark(
+    const DesignBenchmarkOptions& options) {
+  DesignBenchmarkResult result{.design = options.path.stem().string()};
+
+  std::string ir_text;
+  if (options.path.extension() == ".x") {
+    if (options.top.empty()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "A top must be given for DSLX design %s", options.path.string()));
+    }
+    XLS_ASSIGN_OR_RETURN(ir_text, ConvertDslx(options, result));
+  } else {
+    XLS_ASSIGN_OR_RETURN(ir_text, GetFileContents(options.path));
+  }
+
+  // The defaults of opt_main. The top is already set in converted DSLX.
+  tools::OptOptions opt_options = {
+      .top = options.path.extension() == ".x" ? "" : options.top,
+      .split_next_value_selects = 4,
+      .inline_procs = false,
+      .use_context_narrowing_analysis = false,
+  };
+  XLS_ASSIGN_OR_RETURN(std::string opt_ir,
+                       MeasureStage("opt", result, [&] {
+                         return tools::OptimizeIrForTop(ir_text, opt_options);
+                       }));
+
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Package> package,
+      MeasureStage("ir_parse", result,
+                   [&] { return Parser::ParsePackage(opt_ir); }));
+  XLS_RETURN_IF_ERROR(
+      ScheduleAndCodegenPackage(package.get(), options, result));
+
+  // Codegen adds blocks to the package so the JIT gets a fresh copy.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> jit_package,
+                       Parser::ParsePackage(opt_ir));
+  std::optional<FunctionBase*> top = jit_package->GetTop();
+  if (!top.has_value()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Design %s has no top", result.design));
+  }
+  if ((*top)->IsFunction()) {
+    XLS_RETURN_IF_ERROR(
+        RunFunctionJit((*top)->AsFunctionOrDie(), options, result));
+  } else if ((*top)->IsProc()) {
+    XLS_RETURN_IF_ERROR(RunProcJit(jit_package.get(), (*top)->AsProcOrDie(),
+                                   options, result));
+  } else {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Top of design %s must be a function or proc", result.design));
+  }
+  return result;
+}
+
+}  // namespace xls
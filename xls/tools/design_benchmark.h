@@ -0,0 +1,85 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Measures the throughput of the XLS toolchain on a single design by running
+// it through every stage of the flow in-process (DSLX parsing, type checking,
+// IR conversion, optimization, scheduling, codegen, JIT compilation and JIT
+// evaluation) and recording the time and memory consumed by each stage. Used
+// by `design_benchmark_main` to track performance baselines of the example
+// designs.
+
+#ifndef XLS_TOOLS_DESIGN_BENCHMARK_H_
+#define XLS_TOOLS_DESIGN_BENCHMARK_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+
+namespace xls {
+
+struct DesignBenchmarkOptions {
+  // Path of the design. Files with a ".x" extension are DSLX; any other file
+  // is IR, in which case the DSLX stages are skipped.
+  std::filesystem::path path;
+  // Name of the top function or proc. For DSLX this is the name in the DSLX
+  // module. For IR this may be empty to use the top of the package.
+  std::string top;
+  std::filesystem::path dslx_stdlib_path = kDefaultDslxStdlibPath;
+  std::vector<std::filesystem::path> dslx_paths;
+  // Scheduling and codegen options.
+  int64_t pipeline_stages = 1;
+  std::string delay_model = "unit";
+  // Number of invocations (functions) or ticks (procs) of the JIT measured by
+  // the "jit_run" stage.
+  int64_t jit_run_iterations = 1000;
+};
+
+struct StageMeasurement {
+  // Name of the stage, e.g. "typecheck" or "jit_compile".
+  std::string stage;
+  absl::Duration wall_time;
+  // CPU time of all threads of the process during the stage.
+  absl::Duration cpu_time;
+  // Peak resident set size of the process at the end of the stage and the
+  // amount by which the stage raised it. The peak is a high-water mark so a
+  // stage which allocates less than the earlier stages shows no growth.
+  int64_t peak_rss_bytes = 0;
+  int64_t peak_rss_growth_bytes = 0;
+};
+
+struct DesignBenchmarkResult {
+  // Name of the design (the file name without extension).
+  std::string design;
+  std::vector<StageMeasurement> stages;
+
+  // Returns the measurements as JSON lines, one object per stage with the
+  // keys "design", "stage", "wall_ns", "cpu_ns", "peak_rss_bytes" and
+  // "peak_rss_growth_bytes".
+  std::string ToJsonLines() const;
+};
+
+// Runs the design described by `options` through the toolchain. Returns an
+// error if any stage fails.
+absl::StatusOr<DesignBenchmarkResult> RunDesignBenchmark(
+    const DesignBenchmarkOptions& options);
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_DESIGN_BENCHMARK_H_
@@ -0,0 +1,107 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_split.h"
+#include "absl/types/span.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/tools/design_benchmark.h"
+
+static constexpr std::string_view kUsage = R"(
+Runs each design through the XLS toolchain in-process (DSLX frontend, IR
+optimization, scheduling, codegen and JIT) and reports the wall time, CPU time
+and peak memory of every stage as JSON lines, one object per design and stage.
+Designs are given as PATH[:TOP] where PATH is a DSLX (.x) or IR file and TOP is
+the top function or proc (required for DSLX). Example invocation:
+
+  design_benchmark_main xls/examples/sha256.x:main \
+      xls/examples/matmul_4x4/matmul_4x4.ir --output_path=/tmp/baseline.jsonl
+)";
+
+ABSL_FLAG(std::string, dslx_stdlib_path, xls::kDefaultDslxStdlibPath,
+          "Path to DSLX standard library files.");
+ABSL_FLAG(std::string, dslx_paths, "",
+          "Comma-separated list of paths to search for DSLX imports.");
+ABSL_FLAG(int64_t, pipeline_stages, 1,
+          "Number of pipeline stages with which to schedule each design.");
+ABSL_FLAG(std::string, delay_model, "unit",
+          "Delay model used for scheduling and codegen.");
+ABSL_FLAG(int64_t, jit_run_iterations, 1000,
+          "Number of function invocations or proc ticks measured by the "
+          "jit_run stage.");
+ABSL_FLAG(std::string, output_path, "",
+          "File to which the JSON lines are written. If empty, they are "
+          "written to stdout.");
+
+namespace xls {
+namespace {
+
+absl::Status RealMain(absl::Span<const std::string_view> designs) {
+  DesignBenchmarkOptions base_options;
+  base_options.dslx_stdlib_path = absl::GetFlag(FLAGS_dslx_stdlib_path);
+  std::string dslx_paths = absl::GetFlag(FLAGS_dslx_paths);
+  for (std::string_view path :
+       absl::StrSplit(dslx_paths, ',', absl::SkipEmpty())) {
+    base_options.dslx_paths.push_back(path);
+  }
+  base_options.pipeline_stages = absl::GetFlag(FLAGS_pipeline_stages);
+  base_options.delay_model = absl::GetFlag(FLAGS_delay_model);
+  base_options.jit_run_iterations = absl::GetFlag(FLAGS_jit_run_iterations);
+
+  std::string output;
+  for (std::string_view design : designs) {
+    std::vector<std::string_view> pieces =
+        absl::StrSplit(design, absl::MaxSplits(':', 1));
+    DesignBenchmarkOptions options = base_options;
+    options.path = pieces[0];
+    if (pieces.size() > 1) {
+      options.top = pieces[1];
+    }
+    XLS_ASSIGN_OR_RETURN(DesignBenchmarkResult result,
+                         RunDesignBenchmark(options));
+    output += result.ToJsonLines();
+  }
+
+  std::string output_path = absl::GetFlag(FLAGS_output_path);
+  if (output_path.empty()) {
+    std::cout << output;
+    return absl::OkStatus();
+  }
+  return SetFileContents(output_path, output);
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_args =
+      xls::InitXls(kUsage, argc, argv);
+  if (positional_args.empty()) {
+    LOG(QFATAL) << "At least one design must be specified.";
+  }
+  return xls::ExitStatus(xls::RealMain(positional_args));
+}
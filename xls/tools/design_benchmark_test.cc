@@ -0,0 +1,155 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/design_benchmark.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/time.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "nlohmann/json.hpp"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+std::vector<std::string> StageNames(const DesignBenchmarkResult& result) {
+  std::vector<std::string> names;
+  for (const StageMeasurement& measurement : result.stages) {
+    names.push_back(measurement.stage);
+  }
+  return names;
+}
+
+TEST(DesignBenchmarkTest, DslxFunction) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  DesignBenchmarkOptions options;
+  options.path = temp_dir.path() / "adder.x";
+  options.top = "main";
+  options.jit_run_iterations = 10;
+  XLS_ASSERT_OK(SetFileContents(options.path,
+                                "fn main(x: u8, y: u8) -> u8 { x + y }"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(DesignBenchmarkResult result,
+                           RunDesignBenchmark(options));
+  EXPECT_EQ(result.design, "adder");
+  EXPECT_THAT(StageNames(result),
+              ElementsAre("parse", "typecheck", "ir_convert", "opt", "ir_parse",
+                          "schedule", "codegen", "jit_compile", "jit_run"));
+  for (const StageMeasurement& measurement : result.stages) {
+    EXPECT_GT(measurement.peak_rss_bytes, 0) << measurement.stage;
+    EXPECT_GE(measurement.peak_rss_growth_bytes, 0) << measurement.stage;
+  }
+}
+
+TEST(DesignBenchmarkTest, DslxProc) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  DesignBenchmarkOptions options;
+  options.path = temp_dir.path() / "accumulator.x";
+  options.top = "Accumulator";
+  options.jit_run_iterations = 10;
+  XLS_ASSERT_OK(SetFileContents(options.path, R"(
+proc Accumulator {
+  input: chan<u32> in;
+  output: chan<u32> out;
+
+  config(input: chan<u32> in, output: chan<u32> out) { (input, output) }
+
+  init { u32:0 }
+
+  next(sum: u32) {
+    let (tok, x) = recv(join(), input);
+    let sum = sum + x;
+    send(tok, output, sum);
+    sum
+  }
+}
+)"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(DesignBenchmarkResult result,
+                           RunDesignBenchmark(options));
+  EXPECT_THAT(StageNames(result),
+              ElementsAre("parse", "typecheck", "ir_convert", "opt", "ir_parse",
+                          "schedule", "codegen", "jit_compile", "jit_run"));
+}
+
+TEST(DesignBenchmarkTest, IrFunction) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  DesignBenchmarkOptions options;
+  options.path = temp_dir.path() / "neg.ir";
+  options.top = "neg";
+  options.jit_run_iterations = 10;
+  XLS_ASSERT_OK(SetFileContents(options.path, R"(
+package neg_package
+
+fn neg(x: bits[32]) -> bits[32] {
+  ret neg.2: bits[32] = neg(x, id=2)
+}
+)"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(DesignBenchmarkResult result,
+                           RunDesignBenchmark(options));
+  EXPECT_EQ(result.design, "neg");
+  EXPECT_THAT(StageNames(result),
+              ElementsAre("opt", "ir_parse", "schedule", "codegen",
+                          "jit_compile", "jit_run"));
+}
+
+TEST(DesignBenchmarkTest, DslxRequiresTop) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  DesignBenchmarkOptions options;
+  options.path = temp_dir.path() / "adder.x";
+  XLS_ASSERT_OK(SetFileContents(options.path,
+                                "fn main(x: u8, y: u8) -> u8 { x + y }"));
+  EXPECT_THAT(RunDesignBenchmark(options),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("A top must be given")));
+}
+
+TEST(DesignBenchmarkTest, ToJsonLines) {
+  DesignBenchmarkResult result{
+      .design = "foo",
+      .stages = {StageMeasurement{.stage = "opt",
+                                  .wall_time = absl::Nanoseconds(20),
+                                  .cpu_time = absl::Nanoseconds(10),
+                                  .peak_rss_bytes = 4096,
+                                  .peak_rss_growth_bytes = 1024},
+                 StageMeasurement{.stage = "codegen"}}};
+  std::vector<std::string_view> lines =
+      absl::StrSplit(result.ToJsonLines(), '\n', absl::SkipEmpty());
+  ASSERT_EQ(lines.size(), 2);
+  nlohmann::json opt = nlohmann::json::parse(lines[0]);
+  EXPECT_EQ(opt["design"], "foo");
+  EXPECT_EQ(opt["stage"], "opt");
+  EXPECT_EQ(opt["wall_ns"], 20);
+  EXPECT_EQ(opt["cpu_ns"], 10);
+  EXPECT_EQ(opt["peak_rss_bytes"], 4096);
+  EXPECT_EQ(opt["peak_rss_growth_bytes"], 1024);
+  EXPECT_EQ(nlohmann::json::parse(lines[1])["stage"], "codegen");
+}
+
+}  // namespace
+}  // namespace xls
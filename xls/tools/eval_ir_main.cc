@@ -14,8 +14,11 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <deque>
 #include <filesystem>  // NOLINT
+#include <fstream>
 #include <iostream>
+#include <istream>
 #include <iterator>
 #include <memory>
 #include <optional>
@@ -33,10 +36,13 @@
 #include "absl/random/bit_gen_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/ADT/APInt.h"
 #include "llvm/include/llvm/ADT/StringRef.h"
@@ -69,9 +75,12 @@
 #include "llvm/include/llvm/Target/TargetMachine.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/stopwatch.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/import_data.h"
@@ -80,8 +89,10 @@
 #include "xls/dslx/mangle.h"
 #include "xls/dslx/parse_and_typecheck.h"
 #include "xls/dslx/warning_kind.h"
+#include "xls/interpreter/compiled_function_interpreter.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/interpreter/random_value.h"
+#include "xls/ir/binary_ir.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/events.h"
 #include "xls/ir/format_preference.h"
@@ -100,6 +111,8 @@
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
 #include "xls/passes/pass_base.h"
+#include "xls/tools/jit_object_cache_flags.h"
+#include "xls/tools/typed_value_file.h"
 
 static constexpr std::string_view kUsage = R"(
 Evaluates an IR file with user-specified or random inputs using the IR
@@ -145,6 +158,11 @@ Evaluate IR after every optimization pass:
 Evaluate IR using the JIT and with the interpreter and compare the results:
 
    eval_ir_main --test_llvm_jit --random_inputs=100  IR_FILE
+
+Evaluate a very large batch of arguments on all available cores, reading
+INPUT_FILE in chunks rather than all at once:
+
+   eval_ir_main --streaming --input_file=INPUT_FILE IR_FILE
 )";
 
 // LINT.IfChange
@@ -154,8 +172,9 @@ ABSL_FLAG(std::string, input, "",
           "values. For example: \"bits[32]:42; (bits[7]:0, bits[20]:4)\"");
 ABSL_FLAG(std::string, input_file, "",
           "Inputs to interpreter, one set per line. Each line should contain a "
-          "semicolon-separated set of typed values. Cannot be specified with "
-          "--input.");
+          "semicolon-separated set of typed values. Alternatively, a typed "
+          "value file (see typed_value_file.h) holding a tuple of the "
+          "arguments per input. Cannot be specified with --input.");
 ABSL_FLAG(int64_t, random_inputs, 0,
           "If non-zero, this is the number of randomly generated inputs to use "
           "in evaluation. Cannot be specified with --input.");
@@ -165,8 +184,8 @@ ABSL_FLAG(std::string, expected, "",
 ABSL_FLAG(
     std::string, expected_file, "",
     "The expected result(s) of the evaluation(s). A non-zero error code is "
-    "returned if the evaluated result does not match. Must be specified with "
-    "--input_file.");
+    "returned if the evaluated result does not match. Either one typed value "
+    "per line or a typed value file. Must be specified with --input_file.");
 ABSL_FLAG(bool, optimize_ir, false,
           "Run optimization passes on the input and evaluate before and after "
           "optimizations. A non-zero error status is returned if the results "
@@ -214,11 +233,31 @@ ABSL_FLAG(
     std::optional<std::string>, llvm_jit_main_wrapper_output, std::nullopt,
     "Path to write a simple LLVM IR program to which invokes the jit "
     "code. (The program writes output to fd-1). --use_llvm_jit must be true.");
+ABSL_FLAG(std::optional<std::string>, jit_compile_time_output, std::nullopt,
+          "Path to write the time (in nanoseconds) taken to compile the "
+          "function with the JIT. If the function is compiled more than once, "
+          "the time of the last compilation is written.");
+ABSL_FLAG(std::optional<std::string>, jit_compile_phase_time_output,
+          std::nullopt,
+          "Path to write the time (in nanoseconds) the JIT spent in each "
+          "compilation phase (IR building, LLVM optimization and codegen), "
+          "one '<phase>: <nanoseconds>' line per phase.");
 ABSL_FLAG(bool, llvm_jit_main_wrapper_write_is_linked, false,
           "Make the main wrapper call the write libc function instead of just "
           "doing a volatile memmove, incompatible with interpreter.");
 // TODO(allight): It would be nice to enable doing this automatically if the
 // llvm jit code crashes or something.
+ABSL_FLAG(bool, streaming, false,
+          "Evaluate the inputs of --input_file or --random_inputs in chunks on "
+          "a pool of worker threads (each with its own JIT or interpreter) "
+          "instead of reading all of them up front. Results are still written "
+          "in input order. With --test_llvm_jit only the JIT results are "
+          "written. Cannot be used with --optimize_ir.");
+ABSL_FLAG(int64_t, streaming_threads, 0,
+          "Number of worker threads to use with --streaming; 0 means one per "
+          "available CPU.");
+ABSL_FLAG(int64_t, streaming_chunk_size, 1024,
+          "Number of inputs in each unit of work with --streaming.");
 ABSL_FLAG(
     bool, use_llvm_jit_interpreter, false,
     "Instead of compiling jitted XLS ir code and executing it, compile it to "
@@ -589,11 +628,31 @@ absl::StatusOr<std::vector<Value>> Eval(
                              absl::GetFlag(FLAGS_use_llvm_jit_interpreter),
                              absl::GetFlag(FLAGS_llvm_jit_asm_output));
   std::unique_ptr<FunctionJit> jit;
+  std::unique_ptr<CompiledFunctionInterpreter> interpreter;
   if (use_jit) {
     // No support for procs yet.
+    Stopwatch compile_timer;
+    JitCompileTimeObserver phase_times;
+    CompoundObserver observers({&observer, &phase_times});
     XLS_ASSIGN_OR_RETURN(
-        jit,
-        FunctionJit::Create(f, absl::GetFlag(FLAGS_llvm_opt_level), &observer));
+        jit, FunctionJit::Create(f, absl::GetFlag(FLAGS_llvm_opt_level),
+                                 &observers));
+    if (std::optional<std::string> compile_time_path =
+            absl::GetFlag(FLAGS_jit_compile_time_output);
+        compile_time_path.has_value()) {
+      XLS_RETURN_IF_ERROR(SetFileContents(
+          *compile_time_path,
+          absl::StrCat(
+              absl::ToInt64Nanoseconds(compile_timer.GetElapsedTime()))));
+    }
+    if (std::optional<std::string> phase_time_path =
+            absl::GetFlag(FLAGS_jit_compile_phase_time_output);
+        phase_time_path.has_value()) {
+      XLS_RETURN_IF_ERROR(
+          SetFileContents(*phase_time_path, phase_times.ToString()));
+    }
+  } else {
+    XLS_ASSIGN_OR_RETURN(interpreter, CompiledFunctionInterpreter::Create(f));
   }
 
   if (absl::GetFlag(FLAGS_llvm_jit_main_wrapper_output)) {
@@ -627,7 +686,7 @@ absl::StatusOr<std::vector<Value>> Eval(
       // require rethinking some of the control flow because event comparison
       // only makes sense for certain modes (optimize_ir and test_llvm_jit).
       XLS_ASSIGN_OR_RETURN(
-          result, DropInterpreterEvents(InterpretFunction(f, arg_set.args)));
+          result, DropInterpreterEvents(interpreter->Run(arg_set.args)));
     }
     std::cout << result.ToString(FormatPreference::kHex) << '\n';
 
@@ -743,6 +802,27 @@ absl::StatusOr<ArgSet> ArgSetFromString(std::string_view args_string) {
   return arg_set;
 }
 
+// Returns an error unless the values read by `reader` are tuples of the
+// parameter types of `f`.
+absl::Status CheckTypedArgs(Function* f, const TypedValueReader& reader) {
+  Package* package = f->package();
+  XLS_ASSIGN_OR_RETURN(Type * type, package->GetTypeFromProto(reader.type()));
+  Type* expected = package->GetTupleType(f->GetType()->parameters());
+  if (type != expected) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Values of input file %s have type %s; expected %s",
+        absl::GetFlag(FLAGS_input_file), type->ToString(),
+        expected->ToString()));
+  }
+  return absl::OkStatus();
+}
+
+// Returns the arguments held by a tuple of a typed value file.
+ArgSet ArgSetFromTuple(const Value& tuple) {
+  return ArgSet{.args = std::vector<Value>(tuple.elements().begin(),
+                                          tuple.elements().end())};
+}
+
 // Converts the given DSLX validation function into IR.
 absl::StatusOr<std::unique_ptr<Package>> ConvertValidator(
     Function* f, std::string_view dslx_stdlib_path,
@@ -824,6 +904,434 @@ absl::StatusOr<ArgSet> GenerateArgSet(Function* f, Function* validator,
       "or -input_validator_limit should be increased."));
 }
 
+// Returns the validator for randomly generated inputs given by the flags, or
+// nullptr if there is none. The validator is owned by "validator_pkg".
+absl::StatusOr<Function*> GetInputValidator(
+    Function* f, std::string_view dslx_stdlib_path,
+    absl::Span<const std::filesystem::path> dslx_paths,
+    std::unique_ptr<Package>& validator_pkg) {
+  std::string validator_text = absl::GetFlag(FLAGS_input_validator_expr);
+  std::filesystem::path validator_path =
+      absl::GetFlag(FLAGS_input_validator_path);
+  if (!validator_path.empty()) {
+    XLS_ASSIGN_OR_RETURN(validator_text, GetFileContents(validator_path));
+  }
+  if (validator_text.empty()) {
+    return nullptr;
+  }
+  XLS_ASSIGN_OR_RETURN(
+      validator_pkg,
+      ConvertValidator(f, dslx_stdlib_path, dslx_paths, validator_text));
+  XLS_ASSIGN_OR_RETURN(std::string mangled_name,
+                       dslx::MangleDslxName(kPackageName, kPackageName,
+                                            dslx::CallingConvention::kTypical));
+  return validator_pkg->GetFunction(mangled_name);
+}
+
+// A run of consecutive inputs evaluated as a unit in streaming mode.
+struct StreamingChunk {
+  // Index of the first input of the chunk.
+  int64_t first_input;
+  // The inputs as unparsed lines of --input_file (parsing is left to the
+  // workers), or the argument sets themselves for random inputs and typed
+  // value files.
+  std::vector<std::string> input_lines;
+  std::vector<ArgSet> arg_sets;
+  // Unparsed lines of --expected_file corresponding to the inputs, if any, or
+  // the values themselves if it is a typed value file.
+  std::vector<std::string> expected_lines;
+  std::vector<Value> expected_values;
+
+  // Set by the worker which evaluated the chunk: the text to write to stdout
+  // and the first error encountered (evaluation of the chunk stops there).
+  std::string output;
+  absl::Status status;
+  bool done = false;
+};
+
+// Per-thread state for streaming evaluation. JITted functions and compiled
+// interpreters are not safe to share between threads so every worker has its
+// own.
+class StreamingEvaluator {
+ public:
+  static absl::StatusOr<StreamingEvaluator> Create(Function* f,
+                                                   JitObserver* observer) {
+    StreamingEvaluator evaluator;
+    evaluator.use_jit_ = absl::GetFlag(FLAGS_use_llvm_jit) ||
+                         absl::GetFlag(FLAGS_test_llvm_jit);
+    if (evaluator.use_jit_ &&
+        absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
+      XLS_ASSIGN_OR_RETURN(
+          evaluator.jit_,
+          FunctionJit::Create(f, absl::GetFlag(FLAGS_llvm_opt_level),
+                              observer));
+    }
+    if (!evaluator.use_jit_ || absl::GetFlag(FLAGS_test_llvm_jit)) {
+      XLS_ASSIGN_OR_RETURN(evaluator.interpreter_,
+                           CompiledFunctionInterpreter::Create(f));
+    }
+    if (!absl::GetFlag(FLAGS_expected).empty()) {
+      XLS_ASSIGN_OR_RETURN(
+          evaluator.expected_,
+          Parser::ParseTypedValue(absl::GetFlag(FLAGS_expected)));
+    }
+    return evaluator;
+  }
+
+  // Evaluates the inputs of the chunk, filling in its results.
+  void Run(StreamingChunk& chunk) {
+    int64_t count = std::max(chunk.input_lines.size(), chunk.arg_sets.size());
+    for (int64_t i = 0; i < count; ++i) {
+      chunk.status = RunOne(chunk, i, chunk.output);
+      if (!chunk.status.ok()) {
+        return;
+      }
+    }
+  }
+
+ private:
+  StreamingEvaluator() = default;
+
+  absl::Status RunOne(const StreamingChunk& chunk, int64_t i,
+                      std::string& output) {
+    ArgSet parsed;
+    const ArgSet* arg_set;
+    if (chunk.input_lines.empty()) {
+      arg_set = &chunk.arg_sets[i];
+    } else {
+      absl::StatusOr<ArgSet> parsed_or =
+          ArgSetFromString(chunk.input_lines[i]);
+      if (!parsed_or.ok()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Invalid line in input file %s: %s: %s",
+            absl::GetFlag(FLAGS_input_file), chunk.input_lines[i],
+            parsed_or.status().message()));
+      }
+      parsed = *std::move(parsed_or);
+      arg_set = &parsed;
+    }
+
+    std::optional<Value> expected = expected_;
+    std::string_view actual_src = "actual";
+    std::string_view expected_src = "expected";
+    if (!chunk.expected_values.empty()) {
+      expected = chunk.expected_values[i];
+    } else if (!chunk.expected_lines.empty()) {
+      absl::StatusOr<Value> expected_or =
+          Parser::ParseTypedValue(chunk.expected_lines[i]);
+      if (!expected_or.ok()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Failed to parse line in expected file %s: %s",
+            absl::GetFlag(FLAGS_expected_file), chunk.expected_lines[i]));
+      }
+      expected = *std::move(expected_or);
+    }
+
+    Value result;
+    if (use_jit_) {
+      if (jit_ == nullptr) {
+        XLS_ASSIGN_OR_RETURN(result, Parser::ParseTypedValue(absl::GetFlag(
+                                         FLAGS_test_only_inject_jit_result)));
+      } else {
+        XLS_ASSIGN_OR_RETURN(result,
+                             DropInterpreterEvents(jit_->Run(arg_set->args)));
+      }
+    }
+    if (interpreter_ != nullptr) {
+      XLS_ASSIGN_OR_RETURN(
+          Value interpreter_result,
+          DropInterpreterEvents(interpreter_->Run(arg_set->args)));
+      if (use_jit_) {
+        // --test_llvm_jit: the interpreter provides the expected value.
+        expected = std::move(interpreter_result);
+        actual_src = "JIT";
+        expected_src = "interpreter";
+      } else {
+        result = std::move(interpreter_result);
+      }
+    }
+    absl::StrAppend(&output, result.ToString(FormatPreference::kHex), "\n");
+
+    if (expected.has_value() && result != *expected) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Miscompare for input[%i] \"%s\"\n  %s: %s\n  %s: %s",
+          chunk.first_input + i, ArgsToString(arg_set->args),
+          actual_src, result.ToString(FormatPreference::kHex),
+          expected_src, expected->ToString(FormatPreference::kHex)));
+    }
+    return absl::OkStatus();
+  }
+
+  bool use_jit_ = false;
+  std::unique_ptr<FunctionJit> jit_;
+  std::unique_ptr<CompiledFunctionInterpreter> interpreter_;
+  std::optional<Value> expected_;
+};
+
+// Reads the next (non-blank) line of "stream" into "line"; returns false at
+// the end of the stream.
+bool ReadNonBlankLine(std::istream& stream, std::string& line) {
+  while (std::getline(stream, line)) {
+    if (!absl::StripAsciiWhitespace(line).empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Maps the file at `path` if it is a typed value file; returns std::nullopt if
+// it is not (or cannot be mapped, e.g. a pipe) so that it is read as text.
+std::optional<MappedFile> OpenTypedValueFile(std::string_view path) {
+  absl::StatusOr<MappedFile> file = MappedFile::Open(path);
+  if (!file.ok() || !IsTypedValueFile(file->contents())) {
+    return std::nullopt;
+  }
+  return *std::move(file);
+}
+
+// Evaluates the inputs given by --input_file or --random_inputs with a pool
+// of worker threads. Inputs are read (or generated) a chunk at a time and only
+// a bounded number of chunks are in flight at once, so memory use does not
+// depend on the number of inputs. Results are written in input order and
+// evaluation stops at the first error.
+absl::Status RunStreaming(Function* f, std::string_view dslx_stdlib_path,
+                          absl::Span<const std::filesystem::path> dslx_paths) {
+  QCHECK(absl::GetFlag(FLAGS_input).empty())
+      << "--streaming requires --input_file or --random_inputs";
+  QCHECK(!absl::GetFlag(FLAGS_optimize_ir) &&
+         !absl::GetFlag(FLAGS_eval_after_each_pass))
+      << "Cannot specify both --streaming and --optimize_ir";
+  QCHECK(!absl::GetFlag(FLAGS_llvm_jit_main_wrapper_output).has_value() &&
+         !absl::GetFlag(FLAGS_use_llvm_jit_interpreter))
+      << "--streaming only supports running the JIT directly";
+  QCHECK(absl::GetFlag(FLAGS_expected).empty() ||
+         absl::GetFlag(FLAGS_expected_file).empty())
+      << "Cannot specify both --expected_file and --expected";
+  QCHECK(!absl::GetFlag(FLAGS_test_llvm_jit) ||
+         (absl::GetFlag(FLAGS_expected).empty() &&
+          absl::GetFlag(FLAGS_expected_file).empty()))
+      << "Cannot specify expected values when using --test_llvm_jit";
+  const int64_t chunk_size = absl::GetFlag(FLAGS_streaming_chunk_size);
+  QCHECK_GT(chunk_size, 0) << "--streaming_chunk_size must be positive";
+  int64_t thread_count = absl::GetFlag(FLAGS_streaming_threads);
+  if (thread_count <= 0) {
+    thread_count = std::max(AvailableCPUs(), 1);
+  }
+
+  // Sources of inputs. Typed value files are mapped (and read by the
+  // TypedValueReaders) rather than streamed.
+  std::ifstream input_stream;
+  std::ifstream expected_stream;
+  std::optional<MappedFile> typed_input_file;
+  std::optional<MappedFile> typed_expected_file;
+  std::optional<TypedValueReader> typed_inputs;
+  std::optional<TypedValueReader> typed_expecteds;
+  int64_t next_typed_input = 0;
+  int64_t next_typed_expected = 0;
+  int64_t random_inputs_left = 0;
+  std::minstd_rand rng_engine;
+  std::unique_ptr<Package> validator_pkg;
+  Function* validator = nullptr;
+  if (!absl::GetFlag(FLAGS_input_file).empty()) {
+    QCHECK_EQ(absl::GetFlag(FLAGS_random_inputs), 0)
+        << "Cannot specify both --input_file and --random_inputs";
+    typed_input_file = OpenTypedValueFile(absl::GetFlag(FLAGS_input_file));
+    if (typed_input_file.has_value()) {
+      XLS_ASSIGN_OR_RETURN(typed_inputs, TypedValueReader::Create(
+                                             typed_input_file->contents()));
+      XLS_RETURN_IF_ERROR(CheckTypedArgs(f, *typed_inputs));
+    } else {
+      input_stream.open(absl::GetFlag(FLAGS_input_file));
+      if (!input_stream) {
+        return absl::NotFoundError(absl::StrFormat(
+            "Unable to open input file %s", absl::GetFlag(FLAGS_input_file)));
+      }
+    }
+  } else {
+    QCHECK_NE(absl::GetFlag(FLAGS_random_inputs), 0)
+        << "Must specify --input_file or --random_inputs with --streaming.";
+    random_inputs_left = absl::GetFlag(FLAGS_random_inputs);
+    XLS_ASSIGN_OR_RETURN(
+        validator,
+        GetInputValidator(f, dslx_stdlib_path, dslx_paths, validator_pkg));
+  }
+  if (!absl::GetFlag(FLAGS_expected_file).empty()) {
+    typed_expected_file =
+        OpenTypedValueFile(absl::GetFlag(FLAGS_expected_file));
+    if (typed_expected_file.has_value()) {
+      XLS_ASSIGN_OR_RETURN(
+          typed_expecteds,
+          TypedValueReader::Create(typed_expected_file->contents()));
+    } else {
+      expected_stream.open(absl::GetFlag(FLAGS_expected_file));
+      if (!expected_stream) {
+        return absl::NotFoundError(
+            absl::StrFormat("Unable to open expected file %s",
+                            absl::GetFlag(FLAGS_expected_file)));
+      }
+    }
+  }
+
+  // Reads or generates the next chunk of inputs; returns nullptr once the
+  // inputs are exhausted.
+  int64_t input_count = 0;
+  auto next_chunk = [&]() -> absl::StatusOr<std::unique_ptr<StreamingChunk>> {
+    auto chunk = std::make_unique<StreamingChunk>();
+    chunk->first_input = input_count;
+    std::string line;
+    if (input_stream.is_open()) {
+      while (chunk->input_lines.size() < chunk_size &&
+             ReadNonBlankLine(input_stream, line)) {
+        chunk->input_lines.push_back(std::move(line));
+      }
+    } else if (typed_inputs.has_value()) {
+      while (chunk->arg_sets.size() < chunk_size &&
+             next_typed_input < typed_inputs->count()) {
+        chunk->arg_sets.push_back(
+            ArgSetFromTuple(typed_inputs->Get(next_typed_input++)));
+      }
+    } else {
+      while (chunk->arg_sets.size() < chunk_size && random_inputs_left > 0) {
+        XLS_ASSIGN_OR_RETURN(ArgSet arg_set,
+                             GenerateArgSet(f, validator, rng_engine));
+        chunk->arg_sets.push_back(std::move(arg_set));
+        --random_inputs_left;
+      }
+    }
+    const int64_t count =
+        std::max(chunk->input_lines.size(), chunk->arg_sets.size());
+    if (expected_stream.is_open()) {
+      while (chunk->expected_lines.size() < count &&
+             ReadNonBlankLine(expected_stream, line)) {
+        chunk->expected_lines.push_back(std::move(line));
+      }
+      if (chunk->expected_lines.size() != count ||
+          (count == 0 && ReadNonBlankLine(expected_stream, line))) {
+        return absl::InvalidArgumentError(
+            "Number of values in expected file does not match the number of "
+            "inputs.");
+      }
+    } else if (typed_expecteds.has_value()) {
+      while (chunk->expected_values.size() < count &&
+             next_typed_expected < typed_expecteds->count()) {
+        chunk->expected_values.push_back(
+            typed_expecteds->Get(next_typed_expected++));
+      }
+      if (chunk->expected_values.size() != count ||
+          (count == 0 && next_typed_expected < typed_expecteds->count())) {
+        return absl::InvalidArgumentError(
+            "Number of values in expected file does not match the number of "
+            "inputs.");
+      }
+    }
+    if (count == 0) {
+      return nullptr;
+    }
+    input_count += count;
+    return chunk;
+  };
+
+  absl::Mutex mutex;
+  // Chunks not yet picked up by a worker, and whether workers should exit once
+  // there are none left. Both are guarded by "mutex" (as is
+  // StreamingChunk::done).
+  std::deque<StreamingChunk*> pending;
+  bool no_more_chunks = false;
+
+  auto worker = [&](int64_t worker_index) {
+    // Only the first worker reports on the JIT compilation so the output
+    // files are written once.
+    std::optional<EvalIrJitObserver> observer;
+    if (worker_index == 0) {
+      observer.emplace(absl::GetFlag(FLAGS_llvm_jit_ir_output),
+                       absl::GetFlag(FLAGS_llvm_jit_opt_ir_output),
+                       /*interpreter=*/false,
+                       absl::GetFlag(FLAGS_llvm_jit_asm_output));
+    }
+    absl::StatusOr<StreamingEvaluator> evaluator = StreamingEvaluator::Create(
+        f, observer.has_value() ? &*observer : nullptr);
+    while (true) {
+      StreamingChunk* chunk;
+      {
+        absl::MutexLock lock(&mutex);
+        auto has_work = [&]() { return !pending.empty() || no_more_chunks; };
+        mutex.Await(absl::Condition(&has_work));
+        if (pending.empty()) {
+          return;
+        }
+        chunk = pending.front();
+        pending.pop_front();
+      }
+      if (evaluator.ok()) {
+        evaluator->Run(*chunk);
+      } else {
+        chunk->status = evaluator.status();
+      }
+      absl::MutexLock lock(&mutex);
+      chunk->done = true;
+    }
+  };
+  // Every worker compiles or interprets `f`, which may look up types of the
+  // package.
+  f->package()->type_manager().BeginConcurrentAccess();
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>([&worker, i] { worker(i); }));
+  }
+
+  // Keep a couple of chunks per worker in flight so workers are not starved
+  // while we write results, and write the results of the oldest chunk as soon
+  // as it is done.
+  const int64_t max_in_flight = 2 * thread_count;
+  std::deque<std::unique_ptr<StreamingChunk>> in_flight;
+  absl::Status status;
+  absl::Status read_status;
+  bool exhausted = false;
+  while (status.ok() && (!exhausted || !in_flight.empty())) {
+    if (!exhausted && in_flight.size() < max_in_flight) {
+      absl::StatusOr<std::unique_ptr<StreamingChunk>> chunk = next_chunk();
+      if (!chunk.ok()) {
+        // Still write out the results of the inputs read so far.
+        read_status = chunk.status();
+        exhausted = true;
+      } else if (*chunk == nullptr) {
+        exhausted = true;
+      } else {
+        absl::MutexLock lock(&mutex);
+        pending.push_back(chunk->get());
+        in_flight.push_back(*std::move(chunk));
+      }
+      continue;
+    }
+    StreamingChunk* oldest = in_flight.front().get();
+    {
+      absl::MutexLock lock(&mutex);
+      mutex.Await(absl::Condition(&oldest->done));
+    }
+    std::cout << oldest->output;
+    status = oldest->status;
+    in_flight.pop_front();
+  }
+  std::cout.flush();
+  if (status.ok()) {
+    status = read_status;
+  }
+
+  // On error drop the chunks that have not been started and wait for the ones
+  // that have before releasing them.
+  {
+    absl::MutexLock lock(&mutex);
+    pending.clear();
+    no_more_chunks = true;
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  f->package()->type_manager().EndConcurrentAccess();
+  return status;
+}
+
 absl::Status RealMain(std::string_view input_path,
                       std::string_view dslx_stdlib_path,
                       absl::Span<const std::filesystem::path> dslx_paths) {
@@ -832,12 +1340,16 @@ absl::Status RealMain(std::string_view input_path,
   }
   XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(input_path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                       Parser::ParsePackage(contents, input_path));
+                       ParsePackageFromTextOrBinaryIr(contents, input_path));
   if (!absl::GetFlag(FLAGS_top).empty()) {
     XLS_RETURN_IF_ERROR(package->SetTopByName(absl::GetFlag(FLAGS_top)));
   }
   XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
 
+  if (absl::GetFlag(FLAGS_streaming)) {
+    return RunStreaming(f, dslx_stdlib_path, dslx_paths);
+  }
+
   std::vector<ArgSet> arg_sets;
   if (!absl::GetFlag(FLAGS_input).empty()) {
     QCHECK_EQ(absl::GetFlag(FLAGS_random_inputs), 0)
@@ -856,37 +1368,33 @@ absl::Status RealMain(std::string_view input_path,
     absl::StatusOr<std::string> args_input_file =
         GetFileContents(absl::GetFlag(FLAGS_input_file));
     QCHECK_OK(args_input_file.status());
-    for (const auto& arg_line : absl::StrSplit(args_input_file.value(), '\n',
-                                               absl::SkipWhitespace())) {
-      absl::StatusOr<ArgSet> arg_set_status = ArgSetFromString(arg_line);
-      QCHECK_OK(arg_set_status.status())
-          << absl::StreamFormat("Invalid line in input file %s: %s",
-                                absl::GetFlag(FLAGS_input_file), arg_line);
-      arg_sets.push_back(arg_set_status.value());
+    if (IsTypedValueFile(*args_input_file)) {
+      XLS_ASSIGN_OR_RETURN(TypedValueReader reader,
+                           TypedValueReader::Create(*args_input_file));
+      XLS_RETURN_IF_ERROR(CheckTypedArgs(f, reader));
+      arg_sets.reserve(reader.count());
+      for (int64_t i = 0; i < reader.count(); ++i) {
+        arg_sets.push_back(ArgSetFromTuple(reader.Get(i)));
+      }
+    } else {
+      for (const auto& arg_line : absl::StrSplit(args_input_file.value(), '\n',
+                                                 absl::SkipWhitespace())) {
+        absl::StatusOr<ArgSet> arg_set_status = ArgSetFromString(arg_line);
+        QCHECK_OK(arg_set_status.status())
+            << absl::StreamFormat("Invalid line in input file %s: %s",
+                                  absl::GetFlag(FLAGS_input_file), arg_line);
+        arg_sets.push_back(arg_set_status.value());
+      }
     }
   } else {
     QCHECK_NE(absl::GetFlag(FLAGS_random_inputs), 0)
         << "Must specify --input, --input_file, or --random_inputs.";
     arg_sets.resize(absl::GetFlag(FLAGS_random_inputs));
     std::minstd_rand rng_engine;
-    std::string validator_text = absl::GetFlag(FLAGS_input_validator_expr);
-    std::filesystem::path validator_path =
-        absl::GetFlag(FLAGS_input_validator_path);
-    if (!validator_path.empty()) {
-      XLS_ASSIGN_OR_RETURN(validator_text, GetFileContents(validator_path));
-    }
     std::unique_ptr<Package> validator_pkg;
-    Function* validator = nullptr;
-    if (!validator_text.empty()) {
-      XLS_ASSIGN_OR_RETURN(
-          validator_pkg,
-          ConvertValidator(f, dslx_stdlib_path, dslx_paths, validator_text));
-      XLS_ASSIGN_OR_RETURN(
-          std::string mangled_name,
-          dslx::MangleDslxName(kPackageName, kPackageName,
-                               dslx::CallingConvention::kTypical));
-      XLS_ASSIGN_OR_RETURN(validator, validator_pkg->GetFunction(mangled_name));
-    }
+    XLS_ASSIGN_OR_RETURN(
+        Function * validator,
+        GetInputValidator(f, dslx_stdlib_path, dslx_paths, validator_pkg));
 
     for (ArgSet& arg_set : arg_sets) {
       XLS_ASSIGN_OR_RETURN(arg_set, GenerateArgSet(f, validator, rng_engine));
@@ -909,14 +1417,18 @@ absl::Status RealMain(std::string_view input_path,
         GetFileContents(absl::GetFlag(FLAGS_expected_file));
     QCHECK_OK(expected_file.status());
     std::vector<Value> expecteds;
-    for (const auto& expected_line :
-         absl::StrSplit(expected_file.value(), '\n', absl::SkipWhitespace())) {
-      absl::StatusOr<Value> expected_status =
-          Parser::ParseTypedValue(expected_line);
-      QCHECK_OK(expected_status.status())
-          << absl::StreamFormat("Failed to parse line in expected file %s: %s",
-                                expected_line, expected_line);
-      expecteds.push_back(expected_status.value());
+    if (IsTypedValueFile(*expected_file)) {
+      XLS_ASSIGN_OR_RETURN(expecteds, DecodeTypedValues(*expected_file));
+    } else {
+      for (const auto& expected_line : absl::StrSplit(
+               expected_file.value(), '\n', absl::SkipWhitespace())) {
+        absl::StatusOr<Value> expected_status =
+            Parser::ParseTypedValue(expected_line);
+        QCHECK_OK(expected_status.status()) << absl::StreamFormat(
+            "Failed to parse line in expected file %s: %s", expected_line,
+            expected_line);
+        expecteds.push_back(expected_status.value());
+      }
     }
     QCHECK_EQ(expecteds.size(), arg_sets.size())
         << "Number of values in expected file does not match the number of "
@@ -939,6 +1451,13 @@ int main(int argc, char** argv) {
     LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s <ir-path>",
                                       argv[0]);
   }
+  if (absl::Status status = xls::InitJitObjectCacheFromFlags(); !status.ok()) {
+    LOG(QFATAL) << "Unable to initialize JIT object cache: " << status;
+  }
+  if (absl::Status status = xls::InitJitProfilerFromFlags(); !status.ok()) {
+    LOG(QFATAL) << "Unable to initialize JIT profiler: " << status;
+  }
+  xls::InitJitCompileBudgetFromFlags();
   QCHECK(absl::GetFlag(FLAGS_input_validator_expr).empty() ||
          absl::GetFlag(FLAGS_input_validator_path).empty())
       << "At most one one of 'input_validator' or 'input_validator_path' may "
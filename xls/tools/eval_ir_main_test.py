@@ -14,11 +14,13 @@
 # limitations under the License.
 
 import ctypes
+import struct
 import subprocess
 
 from absl.testing import absltest
 from xls.common import runfiles
 from xls.common import test_base
+from xls.ir import xls_type_pb2
 
 EVAL_IR_MAIN_PATH = runfiles.get_path('xls/tools/eval_ir_main')
 
@@ -43,6 +45,18 @@ top fn foo(x: bits[32], y:bits[32]) -> bits[64] {
 """
 
 
+def typed_add_args(args):
+  """Returns a typed value file holding (bits[32], bits[32]) tuples."""
+  u32 = xls_type_pb2.TypeProto(
+      type_enum=xls_type_pb2.TypeProto.BITS, bit_count=32)
+  tuple_type = xls_type_pb2.TypeProto(
+      type_enum=xls_type_pb2.TypeProto.TUPLE, tuple_elements=[u32, u32])
+  type_bytes = tuple_type.SerializeToString()
+  records = b''.join(struct.pack('<II', x, y) for x, y in args)
+  return (b'XLSTVALS' + struct.pack('<QQ', len(type_bytes), len(args)) +
+          type_bytes + records)
+
+
 class EvalMainTest(absltest.TestCase):
 
   def test_one_input_jit(self):
@@ -174,6 +188,79 @@ class EvalMainTest(absltest.TestCase):
     ])
     self.assertEqual(results.decode('utf-8'), '')
 
+  def test_streaming_input_file_preserves_order(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    lines = ['bits[32]:{:#x}; bits[32]:0x1'.format(i) for i in range(1000)]
+    input_file = self.create_tempfile(content='\n'.join(lines))
+    results = subprocess.check_output([
+        EVAL_IR_MAIN_PATH, '--streaming', '--streaming_threads=4',
+        '--streaming_chunk_size=7', '--input_file=' + input_file.full_path,
+        ir_file.full_path
+    ])
+    self.assertSequenceEqual(
+        ['bits[32]:{:#x}'.format(i + 1) for i in range(1000)],
+        results.decode('utf-8').strip().split('\n'))
+
+  def test_typed_value_input_file(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    input_file = self.create_tempfile()
+    with open(input_file.full_path, 'wb') as f:
+      f.write(typed_add_args([(i, 0x10000) for i in range(100)]))
+    expected = ['bits[32]:{:#x}'.format(i + 0x10000) for i in range(100)]
+    for streaming in (False, True):
+      results = subprocess.check_output([
+          EVAL_IR_MAIN_PATH, '--streaming={}'.format(streaming).lower(),
+          '--streaming_chunk_size=7', '--input_file=' + input_file.full_path,
+          ir_file.full_path
+      ])
+      self.assertSequenceEqual(expected,
+                               results.decode('utf-8').strip().split('\n'))
+
+  def test_typed_value_input_file_of_wrong_type(self):
+    ir_file = self.create_tempfile(content=TUPLE_IR)
+    input_file = self.create_tempfile()
+    with open(input_file.full_path, 'wb') as f:
+      f.write(typed_add_args([(1, 2)]))
+    comp = subprocess.run([
+        EVAL_IR_MAIN_PATH, '--input_file=' + input_file.full_path,
+        ir_file.full_path
+    ],
+                          stdout=subprocess.PIPE,
+                          stderr=subprocess.PIPE,
+                          check=False)
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn('have type (bits[32], bits[32]); expected',
+                  comp.stderr.decode('utf-8'))
+
+  def test_streaming_input_file_with_failed_expected_file(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    input_file = self.create_tempfile(
+        content='\n'.join(('bits[32]:0x42; bits[32]:0x123',
+                           'bits[32]:0x10; bits[32]:0x00')))
+    expected_file = self.create_tempfile(content='\n'.join(('bits[32]:0x165',
+                                                            'bits[32]:0xf1f')))
+    comp = subprocess.run([
+        EVAL_IR_MAIN_PATH, '--streaming', '--streaming_chunk_size=1',
+        '--input_file=' + input_file.full_path,
+        '--expected_file=' + expected_file.full_path, ir_file.full_path
+    ],
+                          stdout=subprocess.PIPE,
+                          stderr=subprocess.PIPE,
+                          check=False)
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn('Miscompare for input[1] "bits[32]:0x10; bits[32]:0x0"',
+                  comp.stderr.decode('utf-8'))
+    self.assertEqual(
+        comp.stdout.decode('utf-8').split('\n')[0], 'bits[32]:0x165')
+
+  def test_streaming_random_inputs_test_llvm_jit(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    result = subprocess.check_output([
+        EVAL_IR_MAIN_PATH, '--streaming', '--streaming_chunk_size=5',
+        '--random_inputs=42', '--test_llvm_jit', ir_file.full_path
+    ])
+    self.assertLen(result.decode('utf-8').strip().split('\n'), 42)
+
   def test_tuple_in_out(self):
     ir_file = self.create_tempfile(content=TUPLE_IR)
     result = subprocess.check_output([
@@ -18,6 +18,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <deque>
+#include <filesystem>  // NOLINT
 #include <iostream>
 #include <iterator>
 #include <memory>
@@ -37,6 +38,7 @@
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/random/distributions.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -57,20 +59,31 @@
 #include "xls/interpreter/block_interpreter.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/block.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc_elaboration.h"
 #include "xls/ir/register.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
 #include "xls/jit/block_jit.h"
+#include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_proc_runtime.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
+#include "xls/tools/channel_data_file.h"
 #include "xls/tools/eval_utils.h"
+#include "xls/tools/jit_memory_model.h"
+#include "xls/tools/jit_object_cache_flags.h"
+#include "xls/tools/proc_channel_activity.pb.h"
 
 static constexpr std::string_view kUsage = R"(
 Evaluates an IR file containing Procs, or a Block generated from them.
@@ -98,12 +111,14 @@ ABSL_FLAG(int64_t, max_cycles_no_output, 100,
 ABSL_FLAG(
     std::vector<std::string>, inputs_for_channels, {},
     "Comma separated list of channel=filename pairs, for example: ch_a=foo.ir. "
-    "Files contain one XLS Value in human-readable form per line. Either "
+    "Files contain one XLS Value in human-readable form per line or are "
+    "typed value files (see typed_value_file.h). Either "
     "'inputs_for_channels' or 'inputs_for_all_channels' can be defined.");
 ABSL_FLAG(
     std::vector<std::string>, expected_outputs_for_channels, {},
     "Comma separated list of channel=filename pairs, for example: ch_a=foo.ir. "
-    "Files contain one XLS Value in human-readable form per line. Either "
+    "Files contain one XLS Value in human-readable form per line or are "
+    "typed value files (see typed_value_file.h). Either "
     "'expected_outputs_for_channels' or 'expected_outputs_for_all_channels' "
     "can be defined.\n"
     "For procs, when 'expected_outputs_for_channels' or "
@@ -145,6 +160,19 @@ ABSL_FLAG(
     std::string, expected_proto_outputs_for_all_channels, "",
     "Path to file containing ProcChannelValuesProto binary proto of outputs "
     "for all channels.");
+ABSL_FLAG(
+    std::string, channel_data_inputs_for_all_channels, "",
+    "Path to a binary channel data file (see xls/tools/channel_data_file.h) "
+    "containing inputs for all channels. With --backend=serial_jit the values "
+    "are copied into the channel queues without being converted to Values "
+    "if the file was written with the JIT's layout for this host.");
+ABSL_FLAG(std::string, expected_channel_data_outputs_for_all_channels, "",
+          "Path to a binary channel data file containing outputs for all "
+          "channels.");
+ABSL_FLAG(std::string, channel_data_outputs_for_all_channels, "",
+          "Path to write the outputs of all channels to as a binary channel "
+          "data file instead of printing them. Only used for procs when no "
+          "expected outputs are given.");
 ABSL_FLAG(std::string, streaming_channel_data_suffix, "_data",
           "Suffix to data signals for streaming channels.");
 ABSL_FLAG(std::string, streaming_channel_valid_suffix, "_vld",
@@ -180,6 +208,22 @@ ABSL_FLAG(std::vector<std::string>, model_memories, {},
 ABSL_FLAG(bool, fail_on_assert, false,
           "When set to true, the simulation fails on the activation or cycle "
           "in which an assertion fires.");
+ABSL_FLAG(bool, flat_channel_queues, false,
+          "With --backend=ir_interpreter, store channel queue elements in a "
+          "contiguous flat-bit ring buffer rather than as a deque of Values.");
+ABSL_FLAG(int64_t, channel_activity_sample_size, -1,
+          "If non-negative, count the writes, reads, empty reads and peak "
+          "occupancy of every channel during proc evaluation and keep a random "
+          "sample of this many of the values read from each channel. The "
+          "result, including a suggested FIFO depth for each streaming "
+          "channel, is written as a ProcChannelActivityProto text proto to "
+          "--output_stats_path (which opt_main --fifo_depths_pb accepts). "
+          "Unlike --show_trace, this is cheap enough to leave enabled on long "
+          "runs.");
+ABSL_FLAG(bool, dump_proc_performance_counters, false,
+          "With --backend=serial_jit, count the activations, completed ticks, "
+          "blocked receives, channel operations and cycles spent in each proc "
+          "instance and print them to stderr after evaluation.");
 
 namespace xls {
 
@@ -203,12 +247,166 @@ static absl::Status LogInterpreterEvents(std::string_view entity_name,
   return absl::OkStatus();
 }
 
+// Writes the activity counted on the channel queues of `queue_manager` as a
+// ProcChannelActivityProto to `output_path`.
+static absl::Status WriteChannelActivity(ChannelQueueManager& queue_manager,
+                                         std::string_view output_path) {
+  ProcChannelActivityProto proto;
+  for (ChannelQueue* queue : queue_manager.queues()) {
+    std::optional<ChannelActivity> activity = queue->GetActivity();
+    if (!activity.has_value()) {
+      continue;
+    }
+    ProcChannelActivityProto::Channel* channel = proto.add_channels();
+    channel->set_name(queue->channel()->name());
+    channel->set_writes(activity->writes);
+    channel->set_reads(activity->reads);
+    channel->set_empty_reads(activity->empty_reads);
+    channel->set_max_occupancy(activity->max_occupancy);
+    for (const Value& value : activity->sampled_values) {
+      XLS_ASSIGN_OR_RETURN(*channel->add_sampled_values(), value.AsProto());
+    }
+    if (queue->channel()->kind() == ChannelKind::kStreaming) {
+      channel->set_suggested_fifo_depth(
+          std::max<int64_t>(activity->max_occupancy, 1));
+    }
+  }
+  return SetTextProtoFile(output_path, proto);
+}
+
+// Prints the performance counters of every proc instance in `runtime` to
+// stderr, sorted by instance name.
+static absl::Status DumpPerformanceCounters(const ProcRuntime& runtime) {
+  std::vector<ProcInstance*> instances(
+      runtime.elaboration().proc_instances().begin(),
+      runtime.elaboration().proc_instances().end());
+  std::sort(instances.begin(), instances.end(),
+            [](ProcInstance* a, ProcInstance* b) {
+              return a->GetName() < b->GetName();
+            });
+  for (ProcInstance* instance : instances) {
+    XLS_ASSIGN_OR_RETURN(ProcPerformanceCounters counters,
+                         runtime.GetPerformanceCounters(instance));
+    std::cerr << absl::StreamFormat(
+        "Proc %s: activations=%d completed_ticks=%d blocked_on_receive=%d "
+        "cycles=%d\n",
+        instance->GetName(), counters.activations, counters.completed_ticks,
+        counters.blocked_on_receive, counters.cycles);
+    absl::btree_map<std::string, std::pair<int64_t, int64_t>> channel_ops;
+    for (const auto& [channel_instance, count] : counters.sends) {
+      channel_ops[channel_instance->ToString()].first += count;
+    }
+    for (const auto& [channel_instance, count] : counters.receives) {
+      channel_ops[channel_instance->ToString()].second += count;
+    }
+    for (const auto& [name, ops] : channel_ops) {
+      std::cerr << absl::StreamFormat("  channel %s: sends=%d receives=%d\n",
+                                      name, ops.first, ops.second);
+    }
+  }
+  return absl::OkStatus();
+}
+
 struct EvaluateProcsOptions {
   bool use_jit = false;
+  bool flat_channel_queues = false;
   bool fail_on_assert = false;
   std::vector<int64_t> ticks = {-1};
+  // If non-negative, channel activity is counted with this reservoir size and
+  // written to `output_stats_path`.
+  int64_t channel_activity_sample_size = -1;
+  std::string output_stats_path;
+  // Whether to print the per-proc performance counters after evaluation.
+  bool dump_performance_counters = false;
+  // Inputs in the JIT's native layout, written to the channel queues in
+  // addition to `inputs_for_channels`; at most `max_channel_data_inputs`
+  // values per channel are used.
+  const ChannelDataFile* channel_data_inputs = nullptr;
+  std::optional<int64_t> max_channel_data_inputs;
+  // If non-empty and there are no expected outputs, the outputs of all
+  // channels are written to this path as a channel data file rather than being
+  // printed.
+  std::string channel_data_outputs_path;
 };
 
+// Writes the values of `inputs` to the queues of the corresponding channels.
+// The raw values are copied into JIT queues directly if they are in the
+// layout the JIT uses; otherwise they are converted to Values first.
+static absl::Status WriteChannelDataToQueues(
+    const ChannelDataFile& inputs, std::optional<int64_t> max_values_count,
+    ChannelQueueManager& queue_manager) {
+  auto* jit_queue_manager =
+      dynamic_cast<JitChannelQueueManager*>(&queue_manager);
+  for (const ChannelData& channel : inputs.channels()) {
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * queue,
+                         queue_manager.GetQueueByName(channel.name));
+    int64_t count = channel.count();
+    if (max_values_count.has_value()) {
+      count = std::min(count, *max_values_count);
+    }
+    auto* jit_queue = dynamic_cast<JitChannelQueue*>(queue);
+    if (jit_queue != nullptr && jit_queue_manager != nullptr &&
+        ChannelDataMatchesLayout(channel, queue->channel()->type(),
+                                 jit_queue_manager->runtime())
+            .ok()) {
+      for (int64_t i = 0; i < count; ++i) {
+        jit_queue->WriteRaw(channel.GetRaw(i));
+      }
+    } else {
+      for (int64_t i = 0; i < count; ++i) {
+        XLS_RETURN_IF_ERROR(queue->Write(channel.GetValue(i)));
+      }
+    }
+    if (absl::GetFlag(FLAGS_show_trace)) {
+      LOG(INFO) << "Channel " << channel.name << " has " << count << " inputs";
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Drains the queues of all the channels which can be sent on and writes their
+// contents to a channel data file at `path`.
+static absl::Status WriteQueuesToChannelData(
+    Package* package, ChannelQueueManager& queue_manager,
+    const std::filesystem::path& path) {
+  std::unique_ptr<JitRuntime> host_runtime;
+  JitRuntime* runtime;
+  if (auto* jit_queue_manager =
+          dynamic_cast<JitChannelQueueManager*>(&queue_manager)) {
+    runtime = &jit_queue_manager->runtime();
+  } else {
+    XLS_ASSIGN_OR_RETURN(host_runtime, CreateHostJitRuntime());
+    runtime = host_runtime.get();
+  }
+  std::vector<std::vector<uint8_t>> buffers;
+  buffers.reserve(package->channels().size());
+  std::vector<ChannelData> channels;
+  for (const Channel* channel : package->channels()) {
+    if (!channel->CanSend()) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * queue,
+                         queue_manager.GetQueueByName(channel->name()));
+    const TypeLayout& layout = runtime->GetTypeLayout(channel->type());
+    std::vector<uint8_t>& buffer =
+        buffers.emplace_back(queue->GetSize() * layout.size());
+    auto* jit_queue = dynamic_cast<JitChannelQueue*>(queue);
+    for (int64_t offset = 0; offset < buffer.size(); offset += layout.size()) {
+      if (jit_queue != nullptr) {
+        XLS_RET_CHECK(jit_queue->ReadRaw(buffer.data() + offset));
+      } else {
+        std::optional<Value> value = queue->Read();
+        XLS_RET_CHECK(value.has_value());
+        layout.ValueToNativeLayout(*value, buffer.data() + offset);
+      }
+    }
+    channels.push_back(ChannelData{.name = std::string{channel->name()},
+                                   .layout = layout,
+                                   .data = absl::MakeConstSpan(buffer)});
+  }
+  return WriteChannelDataFile(path, channels);
+}
+
 static absl::Status EvaluateProcs(
     Package* package,
     const absl::btree_map<std::string, std::vector<Value>>& inputs_for_channels,
@@ -219,10 +417,24 @@ static absl::Status EvaluateProcs(
   if (options.use_jit) {
     XLS_ASSIGN_OR_RETURN(runtime, CreateJitSerialProcRuntime(package));
   } else {
-    XLS_ASSIGN_OR_RETURN(runtime, CreateInterpreterSerialProcRuntime(package));
+    XLS_ASSIGN_OR_RETURN(
+        runtime,
+        CreateInterpreterSerialProcRuntime(
+            package, {.flat_channel_queues = options.flat_channel_queues}));
+  }
+
+  if (options.dump_performance_counters) {
+    XLS_RETURN_IF_ERROR(runtime->EnablePerformanceCounters());
   }
 
   ChannelQueueManager& queue_manager = runtime->queue_manager();
+  if (options.channel_activity_sample_size >= 0) {
+    for (ChannelQueue* queue : queue_manager.queues()) {
+      queue->EnableActivityCounting(options.channel_activity_sample_size);
+    }
+  }
+  // Names of all the channels inputs are given for.
+  std::vector<std::string> input_channel_names;
   for (const auto& [channel_name, values] : inputs_for_channels) {
     XLS_ASSIGN_OR_RETURN(ChannelQueue * in_queue,
                          queue_manager.GetQueueByName(channel_name));
@@ -233,6 +445,16 @@ static absl::Status EvaluateProcs(
       LOG(INFO) << "Channel " << channel_name << " has " << values.size()
                 << " inputs";
     }
+    input_channel_names.push_back(channel_name);
+  }
+  if (options.channel_data_inputs != nullptr) {
+    XLS_RETURN_IF_ERROR(WriteChannelDataToQueues(
+        *options.channel_data_inputs, options.max_channel_data_inputs,
+        queue_manager));
+    for (const ChannelData& channel :
+         options.channel_data_inputs->channels()) {
+      input_channel_names.push_back(channel.name);
+    }
   }
   if (absl::GetFlag(FLAGS_show_trace)) {
     for (const auto& [channel_name, values] : expected_outputs_for_channels) {
@@ -259,7 +481,7 @@ static absl::Status EvaluateProcs(
                                queue_manager.GetQueueByName(channel_name));
           ostr << channel_name << "[" << out_queue->GetSize() << "] " << " ";
         }
-        for (const auto& [channel_name, values] : inputs_for_channels) {
+        for (const std::string& channel_name : input_channel_names) {
           XLS_ASSIGN_OR_RETURN(ChannelQueue * in_queue,
                                queue_manager.GetQueueByName(channel_name));
           ostr << channel_name << "[" << in_queue->GetSize() << "] " << " ";
@@ -292,11 +514,9 @@ static absl::Status EvaluateProcs(
       }
 
       // Sort the keys for stable print order.
-      absl::flat_hash_map<Proc*, std::vector<Value>> states;
       std::vector<Proc*> sorted_procs;
       for (const auto& proc : package->procs()) {
         sorted_procs.push_back(proc.get());
-        states[proc.get()] = runtime->ResolveState(proc.get());
       }
 
       std::sort(sorted_procs.begin(), sorted_procs.end(),
@@ -316,11 +536,14 @@ static absl::Status EvaluateProcs(
         }
       }
 
-      for (const auto& proc : package->procs()) {
-        const auto& state = states.at(proc.get());
-        VLOG(1) << "Proc " << proc->name() << " : "
-                << absl::StrFormat("{%s}",
-                                   absl::StrJoin(state, ", ", ValueFormatter));
+      if (VLOG_IS_ON(1)) {
+        for (const auto& proc : package->procs()) {
+          VLOG(1) << "Proc " << proc->name() << " : "
+                  << absl::StrFormat(
+                         "{%s}",
+                         absl::StrJoin(runtime->ResolveState(proc.get()), ", ",
+                                       ValueFormatter));
+        }
       }
 
       if (!asserts.empty()) {
@@ -341,7 +564,7 @@ static absl::Status EvaluateProcs(
         }
         if (all_outputs_produced) {
           absl::btree_map<std::string, std::vector<Value>> unconsumed_inputs;
-          for (const auto& [channel_name, _] : inputs_for_channels) {
+          for (const std::string& channel_name : input_channel_names) {
             XLS_ASSIGN_OR_RETURN(ChannelQueue * in_queue,
                                  queue_manager.GetQueueByName(channel_name));
             // Ignore single value channels in this check
@@ -364,6 +587,16 @@ static absl::Status EvaluateProcs(
     }
   }
 
+  if (options.dump_performance_counters) {
+    XLS_RETURN_IF_ERROR(DumpPerformanceCounters(*runtime));
+  }
+
+  // Collect the activity before the outputs are drained below.
+  if (options.channel_activity_sample_size >= 0) {
+    XLS_RETURN_IF_ERROR(
+        WriteChannelActivity(queue_manager, options.output_stats_path));
+  }
+
   bool checked_any_output = false;
   std::vector<std::string> errors;
   for (const auto& [channel_name, values] : expected_outputs_for_channels) {
@@ -402,6 +635,12 @@ static absl::Status EvaluateProcs(
     return absl::UnknownError("No output verified (empty expected values?)");
   }
 
+  if (expected_outputs_for_channels.empty() &&
+      !options.channel_data_outputs_path.empty()) {
+    return WriteQueuesToChannelData(package, queue_manager,
+                                    options.channel_data_outputs_path);
+  }
+
   if (expected_outputs_for_channels.empty()) {
     for (const Channel* channel : package->channels()) {
       if (!channel->CanSend()) {
@@ -655,6 +894,125 @@ class MemoryModel {
 // to expose logical problems.
 static Value XsOfType(Type* type) { return AllOnesOfType(type); }
 
+// A continuation of a block evaluated with the block JIT whose memories are
+// modeled by JitMemoryModels operating on the JIT's port buffers. The memory
+// ports are neither set from the inputs passed to RunOneCycle nor included in
+// output_ports().
+class JitBlockContinuationWithMemories final : public BlockContinuation {
+ public:
+  static absl::StatusOr<std::unique_ptr<JitBlockContinuationWithMemories>>
+  Create(Block* block,
+         const absl::flat_hash_map<std::string, Value>& initial_registers) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<BlockJit> jit,
+                         BlockJit::Create(block));
+    std::unique_ptr<BlockJitContinuation> continuation = jit->NewContinuation();
+    XLS_RETURN_IF_ERROR(continuation->SetRegisters(initial_registers));
+    return absl::WrapUnique(new JitBlockContinuationWithMemories(
+        block, std::move(jit), std::move(continuation)));
+  }
+
+  JitRuntime& runtime() { return *jit_->runtime(); }
+
+  void AddMemory(std::unique_ptr<JitMemoryModel> memory) {
+    memory_input_ports_.insert(memory->read_data_index());
+    memory_output_ports_.insert(memory->output_port_indices().begin(),
+                                memory->output_port_indices().end());
+    memories_.push_back(std::move(memory));
+  }
+
+  // Performs the memory requests made in the last cycle.
+  absl::Status HandleMemoryRequests() {
+    for (const std::unique_ptr<JitMemoryModel>& memory : memories_) {
+      XLS_RETURN_IF_ERROR(
+          memory->HandleRequests(continuation_->output_port_pointers()));
+    }
+    return absl::OkStatus();
+  }
+
+  void TickMemories() {
+    for (const std::unique_ptr<JitMemoryModel>& memory : memories_) {
+      memory->Tick();
+    }
+  }
+
+  const absl::flat_hash_map<std::string, Value>& output_ports() final {
+    if (!temporary_outputs_.has_value()) {
+      temporary_outputs_.emplace();
+      absl::Span<OutputPort* const> ports = block_->GetOutputPorts();
+      for (int64_t i = 0; i < ports.size(); ++i) {
+        if (memory_output_ports_.contains(i)) {
+          continue;
+        }
+        (*temporary_outputs_)[ports[i]->name()] = runtime().UnpackBuffer(
+            continuation_->output_port_pointers()[i],
+            ports[i]->operand(0)->GetType());
+      }
+    }
+    return *temporary_outputs_;
+  }
+  const absl::flat_hash_map<std::string, Value>& registers() final {
+    if (!temporary_regs_.has_value()) {
+      temporary_regs_.emplace(continuation_->GetRegistersMap());
+    }
+    return *temporary_regs_;
+  }
+  const InterpreterEvents& events() final { return continuation_->GetEvents(); }
+  absl::Status RunOneCycle(
+      const absl::flat_hash_map<std::string, Value>& inputs) final {
+    temporary_outputs_.reset();
+    temporary_regs_.reset();
+    continuation_->ClearEvents();
+    absl::Span<uint8_t* const> input_ports =
+        continuation_->input_port_pointers();
+    int64_t inputs_set = 0;
+    for (int64_t i = 0; i < block_->GetInputPorts().size(); ++i) {
+      if (memory_input_ports_.contains(i)) {
+        continue;
+      }
+      InputPort* port = block_->GetInputPorts()[i];
+      auto it = inputs.find(port->name());
+      if (it == inputs.end()) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Missing input for port '%s'", port->name()));
+      }
+      runtime().BlitValueToBuffer(
+          it->second, port->GetType(),
+          absl::MakeSpan(input_ports[i], runtime().GetTypeByteSize(
+                                             port->GetType())));
+      ++inputs_set;
+    }
+    XLS_RET_CHECK_EQ(inputs_set, inputs.size())
+        << "Inputs given for ports driven by memory models";
+    for (const std::unique_ptr<JitMemoryModel>& memory : memories_) {
+      memory->SetReadData(input_ports);
+    }
+    return jit_->RunOneCycle(*continuation_);
+  }
+  absl::Status SetRegisters(
+      const absl::flat_hash_map<std::string, Value>& regs) final {
+    temporary_regs_.reset();
+    return continuation_->SetRegisters(regs);
+  }
+
+ private:
+  JitBlockContinuationWithMemories(
+      Block* block, std::unique_ptr<BlockJit> jit,
+      std::unique_ptr<BlockJitContinuation> continuation)
+      : block_(block),
+        jit_(std::move(jit)),
+        continuation_(std::move(continuation)) {}
+
+  Block* block_;
+  std::unique_ptr<BlockJit> jit_;
+  std::unique_ptr<BlockJitContinuation> continuation_;
+  std::vector<std::unique_ptr<JitMemoryModel>> memories_;
+  // Indices of the ports driven and consumed by the memory models.
+  absl::flat_hash_set<int64_t> memory_input_ports_;
+  absl::flat_hash_set<int64_t> memory_output_ports_;
+  std::optional<absl::flat_hash_map<std::string, Value>> temporary_outputs_;
+  std::optional<absl::flat_hash_map<std::string, Value>> temporary_regs_;
+};
+
 static xls::Type* GetPortTypeOrNull(Block* block, std::string_view port_name) {
   for (const InputPort* port : block->GetInputPorts()) {
     if (port->name() == port_name) {
@@ -728,17 +1086,6 @@ static absl::Status RunBlock(
     absl::c_copy(values, std::back_inserter(channel_value_queues[name]));
   }
 
-  absl::flat_hash_map<std::string, std::unique_ptr<MemoryModel>> model_memories;
-
-  for (const auto& [name, model_pair] : model_memories_param) {
-    const std::string rd_data =
-        name + std::string(options.memory_read_data_suffix);
-    XLS_ASSIGN_OR_RETURN(const InputPort* port, block->GetInputPort(rd_data));
-    model_memories[name] = std::make_unique<MemoryModel>(
-        name, model_pair.first, model_pair.second,
-        /*read_disabled_value=*/XsOfType(port->GetType()), options.show_trace);
-  }
-
   // Initial register state is one for all registers.
   // Ideally this would be randomized, but at least 1s are more likely to
   //  expose bad behavior than 0s.
@@ -748,13 +1095,61 @@ static absl::Status RunBlock(
     reg_state[reg->name()] = XsOfType(reg->type());
   }
 
-  const BlockEvaluator& continuation_factory =
-      options.use_jit
-          ? reinterpret_cast<const BlockEvaluator&>(kStreamingJitBlockEvaluator)
-          : reinterpret_cast<const BlockEvaluator&>(kInterpreterBlockEvaluator);
+  // With the JIT the memories are modeled on the JIT's port buffers so memory
+  // traffic does not go through Values.
+  absl::flat_hash_map<std::string, std::unique_ptr<MemoryModel>> model_memories;
+  std::unique_ptr<BlockContinuation> continuation;
+  JitBlockContinuationWithMemories* jit_memories = nullptr;
+  if (options.use_jit && !model_memories_param.empty() &&
+      block->GetInstantiations().empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<JitBlockContinuationWithMemories> jit_continuation,
+        JitBlockContinuationWithMemories::Create(block, reg_state));
+    for (const auto& [name, model_pair] : model_memories_param) {
+      const JitMemoryModel::Ports ports{
+          .read_enable = name + std::string(options.memory_read_enable_suffix),
+          .read_address =
+              name + std::string(options.memory_read_address_suffix),
+          .read_data = name + std::string(options.memory_read_data_suffix),
+          .write_enable =
+              name + std::string(options.memory_write_enable_suffix),
+          .write_address =
+              name + std::string(options.memory_write_address_suffix),
+          .write_data = name + std::string(options.memory_write_data_suffix),
+      };
+      XLS_ASSIGN_OR_RETURN(const InputPort* port,
+                           block->GetInputPort(ports.read_data));
+      XLS_ASSIGN_OR_RETURN(
+          std::unique_ptr<JitMemoryModel> memory,
+          JitMemoryModel::Create(
+              name, model_pair.first, model_pair.second,
+              /*read_disabled_value=*/XsOfType(port->GetType()), ports, block,
+              jit_continuation->runtime(), /*read_latency=*/1,
+              options.show_trace));
+      jit_continuation->AddMemory(std::move(memory));
+    }
+    jit_memories = jit_continuation.get();
+    continuation = std::move(jit_continuation);
+  } else {
+    for (const auto& [name, model_pair] : model_memories_param) {
+      const std::string rd_data =
+          name + std::string(options.memory_read_data_suffix);
+      XLS_ASSIGN_OR_RETURN(const InputPort* port,
+                           block->GetInputPort(rd_data));
+      model_memories[name] = std::make_unique<MemoryModel>(
+          name, model_pair.first, model_pair.second,
+          /*read_disabled_value=*/XsOfType(port->GetType()),
+          options.show_trace);
+    }
 
-  XLS_ASSIGN_OR_RETURN(auto continuation,
-                       continuation_factory.NewContinuation(block, reg_state));
+    const BlockEvaluator& continuation_factory =
+        options.use_jit ? reinterpret_cast<const BlockEvaluator&>(
+                              kStreamingJitBlockEvaluator)
+                        : reinterpret_cast<const BlockEvaluator&>(
+                              kInterpreterBlockEvaluator);
+    XLS_ASSIGN_OR_RETURN(
+        continuation, continuation_factory.NewContinuation(block, reg_state));
+  }
 
   int64_t last_output_cycle = 0;
   int64_t matched_outputs = 0;
@@ -899,6 +1294,9 @@ static absl::Status RunBlock(
     }
 
     // Memory model outputs
+    if (jit_memories != nullptr) {
+      XLS_RETURN_IF_ERROR(jit_memories->HandleMemoryRequests());
+    }
     for (const auto& [name, model] : model_memories) {
       // Write handling
       {
@@ -963,6 +1361,9 @@ static absl::Status RunBlock(
     for (const auto& [_, model] : model_memories) {
       XLS_RETURN_IF_ERROR(model->Tick());
     }
+    if (jit_memories != nullptr) {
+      jit_memories->TickMemories();
+    }
   }
 
   absl::btree_map<std::string, std::vector<Value>> unconsumed_inputs;
@@ -1074,7 +1475,9 @@ static absl::Status RealMain(
     std::string_view memory_write_data_suffix,
     std::string_view idle_channel_name, const int random_seed,
     const double prob_input_valid_assert, bool show_trace,
-    std::string_view output_stats_path, bool fail_on_assert) {
+    std::string_view output_stats_path, bool fail_on_assert,
+    bool flat_channel_queues, int64_t channel_activity_sample_size,
+    bool dump_proc_performance_counters) {
   // Don't waste time and memory parsing more input than can possibly be
   // consumed.
   const int64_t total_ticks =
@@ -1122,6 +1525,30 @@ static absl::Status RealMain(
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_file));
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
 
+  // Binary channel data. Inputs are only converted to Values if they cannot be
+  // fed to the JIT's channel queues directly.
+  const std::optional<int64_t> max_values_count =
+      total_ticks >= 0 ? std::make_optional(total_ticks) : std::nullopt;
+  std::optional<ChannelDataFile> channel_data_inputs;
+  if (std::string path =
+          absl::GetFlag(FLAGS_channel_data_inputs_for_all_channels);
+      !path.empty()) {
+    XLS_ASSIGN_OR_RETURN(channel_data_inputs,
+                         ChannelDataFile::Open(path, package.get()));
+    if (backend != "serial_jit") {
+      inputs_for_channels =
+          channel_data_inputs->ToChannelValues(max_values_count);
+      channel_data_inputs.reset();
+    }
+  }
+  if (std::string path =
+          absl::GetFlag(FLAGS_expected_channel_data_outputs_for_all_channels);
+      !path.empty()) {
+    XLS_ASSIGN_OR_RETURN(ChannelDataFile expected,
+                         ChannelDataFile::Open(path, package.get()));
+    expected_outputs_for_channels = expected.ToChannelValues(max_values_count);
+  }
+
   if (backend != "block_jit" && backend != "block_interpreter" &&
       !model_memories.empty()) {
     LOG(QFATAL) << "Only block interpreter supports memory models "
@@ -1164,12 +1591,21 @@ static absl::Status RealMain(
   EvaluateProcsOptions evaluate_procs_options = {
       .fail_on_assert = fail_on_assert,
       .ticks = ticks,
+      .channel_activity_sample_size = channel_activity_sample_size,
+      .output_stats_path = std::string(output_stats_path),
+      .dump_performance_counters = dump_proc_performance_counters,
+      .channel_data_inputs =
+          channel_data_inputs.has_value() ? &*channel_data_inputs : nullptr,
+      .max_channel_data_inputs = max_values_count,
+      .channel_data_outputs_path =
+          absl::GetFlag(FLAGS_channel_data_outputs_for_all_channels),
   };
 
   if (backend == "serial_jit") {
     evaluate_procs_options.use_jit = true;
   } else if (backend == "ir_interpreter") {
     evaluate_procs_options.use_jit = false;
+    evaluate_procs_options.flat_channel_queues = flat_channel_queues;
   } else {
     LOG(QFATAL) << "Unknown backend type";
   }
@@ -1185,6 +1621,13 @@ int main(int argc, char* argv[]) {
   if (positional_args.size() != 1) {
     LOG(QFATAL) << "One (and only one) IR file must be given.";
   }
+  if (absl::Status status = xls::InitJitObjectCacheFromFlags(); !status.ok()) {
+    LOG(QFATAL) << "Unable to initialize JIT object cache: " << status;
+  }
+  if (absl::Status status = xls::InitJitProfilerFromFlags(); !status.ok()) {
+    LOG(QFATAL) << "Unable to initialize JIT profiler: " << status;
+  }
+  xls::InitJitCompileBudgetFromFlags();
 
   std::string backend = absl::GetFlag(FLAGS_backend);
   if (backend != "serial_jit" && backend != "ir_interpreter" &&
@@ -1197,6 +1640,18 @@ int main(int argc, char* argv[]) {
     LOG(QFATAL) << "Block evaluation requires --block_signature_proto.";
   }
 
+  if (absl::GetFlag(FLAGS_channel_activity_sample_size) >= 0 &&
+      absl::GetFlag(FLAGS_output_stats_path).empty()) {
+    LOG(QFATAL) << "--channel_activity_sample_size requires "
+                   "--output_stats_path.";
+  }
+
+  if (absl::GetFlag(FLAGS_dump_proc_performance_counters) &&
+      backend != "serial_jit") {
+    LOG(QFATAL) << "--dump_proc_performance_counters requires "
+                   "--backend=serial_jit.";
+  }
+
   std::vector<int64_t> ticks;
   for (const std::string& run_str : absl::GetFlag(FLAGS_ticks)) {
     int ticks_int;
@@ -1212,12 +1667,15 @@ int main(int argc, char* argv[]) {
   if (absl::c_count(
           absl::Span<const bool>{
               absl::GetFlag(FLAGS_inputs_for_channels).empty() &&
-              absl::GetFlag(FLAGS_inputs_for_all_channels).empty() &&
-              absl::GetFlag(FLAGS_proto_inputs_for_all_channels).empty()},
+              absl::GetFlag(FLAGS_inputs_for_all_channels).empty(),
+              absl::GetFlag(FLAGS_proto_inputs_for_all_channels).empty(),
+              absl::GetFlag(FLAGS_channel_data_inputs_for_all_channels)
+                  .empty()},
           false) > 1) {
     LOG(QFATAL) << "Only one of --inputs_for_channels, "
-                   "--inputs_for_all_channels, and "
-                   "--proto_inputs_for_all_channels must be set.";
+                   "--inputs_for_all_channels, "
+                   "--proto_inputs_for_all_channels, and "
+                   "--channel_data_inputs_for_all_channels must be set.";
   }
 
   if (absl::c_count(
@@ -1225,11 +1683,16 @@ int main(int argc, char* argv[]) {
               absl::GetFlag(FLAGS_expected_outputs_for_channels).empty() &&
               absl::GetFlag(FLAGS_expected_outputs_for_all_channels).empty() &&
               absl::GetFlag(FLAGS_expected_proto_outputs_for_all_channels)
+                  .empty(),
+              absl::GetFlag(
+                  FLAGS_expected_channel_data_outputs_for_all_channels)
                   .empty()},
           false) > 1) {
     LOG(QFATAL) << "Only one of --expected_outputs_for_channels, "
-                   "--expected_outputs_for_all_channels, and "
-                   "--expected_proto_outputs_for_all_channels must be set.";
+                   "--expected_outputs_for_all_channels, "
+                   "--expected_proto_outputs_for_all_channels, and "
+                   "--expected_channel_data_outputs_for_all_channels must be "
+                   "set.";
   }
 
   return xls::ExitStatus(xls::RealMain(
@@ -1254,5 +1717,8 @@ int main(int argc, char* argv[]) {
       absl::GetFlag(FLAGS_idle_channel_name), absl::GetFlag(FLAGS_random_seed),
       absl::GetFlag(FLAGS_prob_input_valid_assert),
       absl::GetFlag(FLAGS_show_trace), absl::GetFlag(FLAGS_output_stats_path),
-      absl::GetFlag(FLAGS_fail_on_assert)));
+      absl::GetFlag(FLAGS_fail_on_assert),
+      absl::GetFlag(FLAGS_flat_channel_queues),
+      absl::GetFlag(FLAGS_channel_activity_sample_size),
+      absl::GetFlag(FLAGS_dump_proc_performance_counters)));
 }
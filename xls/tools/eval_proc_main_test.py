@@ -460,6 +460,49 @@ class EvalProcTest(parameterized.TestCase):
     output = run_command(shared_args + ["--backend", "serial_jit"])
     self.assertIn("Proc test_proc", output.stderr)
 
+  @parameterized.parameters("ir_interpreter", "serial_jit")
+  def test_channel_activity(self, backend):
+    ir_file = self.create_tempfile(content=PROC_IR)
+    stats_file = self.create_tempfile(content="")
+    input_file = self.create_tempfile(content=textwrap.dedent("""
+          in_ch : {
+            bits[64]:42
+            bits[64]:101
+          }
+          in_ch_2 : {
+            bits[64]:10
+            bits[64]:6
+          }
+        """))
+
+    run_command([
+        EVAL_PROC_MAIN_PATH,
+        ir_file.full_path,
+        "--ticks",
+        "2",
+        "--backend",
+        backend,
+        "--inputs_for_all_channels",
+        input_file.full_path,
+        "--channel_activity_sample_size",
+        "1",
+        "--output_stats_path",
+        stats_file.full_path,
+    ])
+
+    with open(stats_file.full_path, "r") as f:
+      stats_content = f.read()
+    self.assertRegex(
+        stats_content,
+        r'name: "in_ch"\s+writes: 2\s+reads: 2\s+max_occupancy: 2\s+'
+        r"sampled_values",
+    )
+    self.assertRegex(
+        stats_content,
+        r'name: "out_ch_2"\s+writes: 2\s+max_occupancy: 2\s+'
+        r"suggested_fifo_depth: 2",
+    )
+
   def test_reset_static(self):
     ir_file = self.create_tempfile(content=PROC_IR)
     input_file = self.create_tempfile(content=textwrap.dedent("""
@@ -36,6 +36,7 @@
 #include "xls/ir/value.h"
 #include "xls/ir/xls_value.pb.h"
 #include "xls/tools/proc_channel_values.pb.h"
+#include "xls/tools/typed_value_file.h"
 #include "re2/re2.h"
 
 namespace xls {
@@ -47,6 +48,12 @@ absl::StatusOr<std::vector<Value>> ParseValuesFile(std::string_view filename,
   }
 
   XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(filename));
+  if (IsTypedValueFile(contents)) {
+    XLS_ASSIGN_OR_RETURN(TypedValueReader reader,
+                         TypedValueReader::Create(contents));
+    return reader.GetAll(max_lines < 0 ? std::optional<int64_t>()
+                                       : std::optional<int64_t>(max_lines));
+  }
   std::vector<Value> ret;
   int64_t li = 0;
   for (const auto& line :
@@ -31,7 +31,8 @@
 
 namespace xls {
 
-// Returns all XLS Values in file.
+// Returns all XLS Values in file, which holds either one typed value per line
+// or a typed value file (see typed_value_file.h).
 // If max_lines is <0 then it is ignored.
 absl::StatusOr<std::vector<Value>> ParseValuesFile(std::string_view filename,
                                                    int64_t max_lines = -1);
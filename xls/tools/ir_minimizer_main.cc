@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <csignal>
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
@@ -27,6 +28,7 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -42,6 +44,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
@@ -51,6 +54,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/binary_search.h"
 #include "xls/data_structures/inline_bitmap.h"
 #include "xls/interpreter/function_interpreter.h"
@@ -163,6 +167,15 @@ ABSL_FLAG(std::vector<std::string>, test_executable_args, {},
 ABSL_FLAG(bool, test_executable_crash_is_bug, false,
           "If true a crash of the test executable is considered a bug repro, "
           "normal termination is considered a passing run.");
+ABSL_FLAG(bool, test_server, false,
+          "If true, --test_executable is started once and kept running as a "
+          "test server rather than being run for each candidate, e.g. to avoid "
+          "re-initializing LLVM for every test. For each candidate the path of "
+          "a file containing the candidate IR is written as a line to the "
+          "server's stdin, and the server must reply with a line on its "
+          "stdout which is 1 if the candidate still fails and 0 otherwise. The "
+          "server should exit when its stdin is closed. See "
+          "sample_runner_main --server.");
 ABSL_FLAG(bool, test_llvm_jit, false,
           "Tests for differences between results from the JIT and the "
           "interpreter as the reduction test case. Must specify --input with "
@@ -208,6 +221,12 @@ ABSL_FLAG(int64_t, simplifications_between_tests, 1,
           "Number of simplifications to do in-between tests. Increasing this "
           "value may speed minimization for large designs, especially when "
           "--test_executable is long-running.");
+ABSL_FLAG(int64_t, parallelism, 1,
+          "Number of candidate simplifications of the current sample to "
+          "generate and test concurrently. If greater than 1, each round tests "
+          "up to this many candidates in parallel and keeps the failing one "
+          "with the fewest nodes; --simplifications_between_tests is then "
+          "ignored. Candidates whose IR was already tested are not re-tested.");
 ABSL_FLAG(int64_t, failed_attempts_between_tests_limit, 16,
           "Failed simplification attempts between tests before we conclude we "
           "need to check our changes so far.");
@@ -251,6 +270,53 @@ absl::StatusOr<std::unique_ptr<Package>> ParsePackage(
   return package;
 }
 
+// Running --test_server processes. Each concurrent test uses its own server.
+class TestServerPool {
+ public:
+  // Asks a server whether the IR in the file at `ir_path` still fails.
+  absl::StatusOr<bool> StillFails(const std::string& ir_path) {
+    std::unique_ptr<InteractiveSubprocess> server;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (!idle_servers_.empty()) {
+        server = std::move(idle_servers_.back());
+        idle_servers_.pop_back();
+      }
+    }
+    if (server == nullptr) {
+      std::vector<std::string> argv;
+      argv.reserve(1 + absl::GetFlag(FLAGS_test_executable_args).size());
+      argv.push_back(absl::GetFlag(FLAGS_test_executable));
+      absl::c_copy(absl::GetFlag(FLAGS_test_executable_args),
+                   std::back_inserter(argv));
+      XLS_ASSIGN_OR_RETURN(server, InteractiveSubprocess::Create(argv));
+    }
+    XLS_ASSIGN_OR_RETURN(std::string reply, server->Communicate(ir_path));
+    bool still_fails;
+    if (reply == "1") {
+      still_fails = true;
+    } else if (reply == "0") {
+      still_fails = false;
+    } else {
+      return absl::InternalError(absl::StrFormat(
+          "Test server replied `%s`; expected `0` or `1`", reply));
+    }
+    absl::MutexLock lock(&mutex_);
+    idle_servers_.push_back(std::move(server));
+    return still_fails;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<std::unique_ptr<InteractiveSubprocess>> idle_servers_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+TestServerPool& GetTestServerPool() {
+  static TestServerPool* pool = new TestServerPool();
+  return *pool;
+}
+
 // Checks whether we still fail when attempting to run function "f". Optional
 // 'inputs' is required if --test_llvm_jit is used.
 absl::StatusOr<bool> StillFailsHelper(
@@ -283,6 +349,9 @@ absl::StatusOr<bool> StillFailsHelper(
         << "Cannot specify --test_optimizer with --test_executable";
     QCHECK(absl::GetFlag(FLAGS_input).empty())
         << "Cannot specify --input with --test_executable";
+    if (absl::GetFlag(FLAGS_test_server)) {
+      return GetTestServerPool().StillFails(ir_path);
+    }
     std::vector<std::string> argv;
     argv.reserve(2 + absl::GetFlag(FLAGS_test_executable_args).size());
     argv.push_back(absl::GetFlag(FLAGS_test_executable));
@@ -1215,10 +1284,182 @@ absl::Status CleanUp(FunctionBase* f, bool can_remove_params) {
   return absl::OkStatus();
 }
 
+// Returns the function base to simplify next, chosen randomly weighted by
+// node count, or nullptr if all function bases are empty.
+FunctionBase* PickFunctionBaseToSimplify(Package* package,
+                                         absl::BitGenRef rng) {
+  if (absl::GetFlag(FLAGS_simplify_top_only)) {
+    return package->GetTop().value();
+  }
+  std::vector<FunctionBase*> bases = package->GetFunctionBases();
+  std::vector<int64_t> node_counts;
+  node_counts.reserve(bases.size());
+  for (auto it = bases.begin(); it != bases.end();) {
+    FunctionBase* f = *it;
+    int64_t node_count = f->node_count();
+    if (node_count == 0) {
+      // This is an empty function.
+      it = bases.erase(it);
+      continue;
+    }
+    node_counts.push_back(node_count);
+    it++;
+  }
+  if (bases.empty()) {
+    return nullptr;
+  }
+  absl::discrete_distribution<size_t> distribution(node_counts.cbegin(),
+                                                   node_counts.cend());
+  return bases[distribution(rng)];
+}
+
+// Minimizes the (failing) sample `knownf_ir_text` by repeatedly generating up
+// to `parallelism` candidate simplifications of it, testing them concurrently,
+// and keeping the failing candidate with the fewest nodes. Returns the
+// minimized IR.
+absl::StatusOr<std::string> MinimizeInParallel(
+    std::string knownf_ir_text, const std::optional<std::vector<Value>>& inputs,
+    bool can_remove_params, int64_t failed_attempt_limit,
+    int64_t total_attempt_limit, int64_t parallelism,
+    absl::flat_hash_map<std::string, bool>& test_cache) {
+  // Candidates which fail to simplify the sample (e.g. because the RNG said
+  // not to) are cheap, so allow several of them per candidate to test.
+  const int64_t generation_attempt_limit =
+      parallelism * absl::GetFlag(FLAGS_failed_attempts_between_tests_limit);
+
+  std::mt19937 rng;  // Default constructor uses deterministic seed.
+  int64_t failed_simplification_attempts = 0;
+  int64_t total_attempts = 0;
+  struct Candidate {
+    std::string which_transform;
+    std::string ir_text;
+    int64_t node_count;
+    absl::StatusOr<bool> still_fails = false;
+  };
+  while (failed_simplification_attempts < failed_attempt_limit &&
+         total_attempts < total_attempt_limit) {
+    // Generate candidates which have not been tested yet.
+    std::vector<Candidate> candidates;
+    absl::flat_hash_set<std::string> candidate_ir_texts;
+    std::optional<Candidate> known_failing_candidate;
+    bool cannot_change = false;
+    for (int64_t i = 0;
+         i < generation_attempt_limit && static_cast<int64_t>(candidates.size()) < parallelism &&
+         total_attempts < total_attempt_limit;
+         ++i) {
+      ++total_attempts;
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                           ParsePackage(knownf_ir_text));
+      FunctionBase* f = PickFunctionBaseToSimplify(package.get(), rng);
+      if (f == nullptr) {
+        cannot_change = true;
+        break;
+      }
+      std::string which_transform;
+      XLS_ASSIGN_OR_RETURN(SimplifiedIr simplification,
+                           Simplify(f, inputs, rng, &which_transform));
+      if (simplification.result == SimplificationResult::kCannotChange) {
+        cannot_change = true;
+        break;
+      }
+      if (simplification.result == SimplificationResult::kDidNotChange) {
+        ++failed_simplification_attempts;
+        continue;
+      }
+      int64_t node_count = simplification.node_count;
+      if (simplification.in_place()) {
+        XLS_RETURN_IF_ERROR(CleanUp(f, can_remove_params));
+        node_count = package->GetNodeCount();
+      }
+      std::string ir_text = simplification.ir();
+      if (auto it = test_cache.find(ir_text); it != test_cache.end()) {
+        // Already tested; only remember it if it is a known failure.
+        if (it->second && (!known_failing_candidate.has_value() ||
+                           node_count < known_failing_candidate->node_count)) {
+          known_failing_candidate =
+              Candidate{.which_transform = which_transform,
+                        .ir_text = std::move(ir_text),
+                        .node_count = node_count,
+                        .still_fails = true};
+        } else {
+          ++failed_simplification_attempts;
+        }
+        continue;
+      }
+      if (!candidate_ir_texts.insert(ir_text).second) {
+        continue;
+      }
+      candidates.push_back(Candidate{.which_transform = which_transform,
+                                     .ir_text = std::move(ir_text),
+                                     .node_count = node_count});
+    }
+    if (cannot_change) {
+      LOG(INFO) << "Cannot simplify any further, done!";
+      break;
+    }
+
+    // Test the candidates concurrently.
+    LOG(INFO) << "Testing " << candidates.size() << " candidates";
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(candidates.size());
+    for (Candidate& candidate : candidates) {
+      threads.push_back(std::make_unique<Thread>([&candidate, &inputs]() {
+        candidate.still_fails = StillFailsHelper(candidate.ir_text, inputs);
+      }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+
+    // Accept the failing candidate with the fewest nodes.
+    std::optional<Candidate> best = std::move(known_failing_candidate);
+    for (Candidate& candidate : candidates) {
+      XLS_ASSIGN_OR_RETURN(bool still_fails, candidate.still_fails);
+      test_cache[candidate.ir_text] = still_fails;
+      if (!still_fails) {
+        ++failed_simplification_attempts;
+        continue;
+      }
+      if (!best.has_value() || candidate.node_count < best->node_count) {
+        best = std::move(candidate);
+      }
+    }
+    if (!best.has_value()) {
+      LOG(INFO) << "No candidate still fails; failed simplification attempts "
+                   "now: "
+                << failed_simplification_attempts << "/"
+                << failed_attempt_limit;
+      continue;
+    }
+    std::cerr << "---\ntransform: " << best->which_transform << "\n"
+              << (best->node_count > 50 ? "" : best->ir_text) << "("
+              << best->node_count << " nodes)\n";
+    knownf_ir_text = std::move(best->ir_text);
+    failed_simplification_attempts = 0;
+  }
+  LOG(INFO) << "Stopped after " << total_attempts << " attempts ("
+            << failed_simplification_attempts << " failed in a row)";
+  return knownf_ir_text;
+}
+
+// Prints the minimized IR and verifies (without the test cache) that it still
+// fails.
+absl::Status FinishMinimization(
+    std::string_view knownf_ir_text,
+    const std::optional<std::vector<Value>>& inputs) {
+  std::cout << knownf_ir_text;
+
+  // Run the last test verification without the cache.
+  return VerifyStillFails(knownf_ir_text, inputs,
+                          "Minimized function does not fail!",
+                          /*test_cache=*/nullptr);
+}
+
 absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
                       const int64_t total_attempt_limit,
                       const int64_t simplifications_between_tests,
-                      const int64_t failed_attempts_between_tests_limit) {
+                      const int64_t failed_attempts_between_tests_limit,
+                      const int64_t parallelism) {
   XLS_ASSIGN_OR_RETURN(std::string knownf_ir_text, GetFileContents(path));
   // Cache of test results to avoid duplicate invocations of the
   // test_executable.
@@ -1266,6 +1507,15 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
     LOG(INFO) << "=== Done cleaning up initial garbage";
   }
 
+  if (parallelism > 1) {
+    XLS_ASSIGN_OR_RETURN(
+        knownf_ir_text,
+        MinimizeInParallel(std::move(knownf_ir_text), inputs,
+                           can_remove_params, failed_attempt_limit,
+                           total_attempt_limit, parallelism, test_cache));
+    return FinishMinimization(knownf_ir_text, inputs);
+  }
+
   // If so, we start simplifying via this seeded RNG.
   std::mt19937 rng;  // Default constructor uses deterministic seed.
 
@@ -1305,31 +1555,10 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
 
     VLOG(1) << "=== Simplification attempt " << total_attempts;
 
-    FunctionBase* candidate;
-    if (absl::GetFlag(FLAGS_simplify_top_only)) {
-      candidate = package->GetTop().value();
-    } else {
-      std::vector<FunctionBase*> bases = package->GetFunctionBases();
-      std::vector<int64_t> node_counts;
-      node_counts.reserve(bases.size());
-      for (auto it = bases.begin(); it != bases.end();) {
-        FunctionBase* f = *it;
-        int64_t node_count = f->node_count();
-        if (node_count == 0) {
-          // This is an empty function.
-          it = bases.erase(it);
-          continue;
-        }
-        node_counts.push_back(node_count);
-        it++;
-      }
-      if (bases.empty()) {
-        LOG(INFO) << "Nothing left to simplify";
-        break;
-      }
-      absl::discrete_distribution<size_t> distribution(node_counts.cbegin(),
-                                                       node_counts.cend());
-      candidate = bases[distribution(rng)];
+    FunctionBase* candidate = PickFunctionBaseToSimplify(package.get(), rng);
+    if (candidate == nullptr) {
+      LOG(INFO) << "Nothing left to simplify";
+      break;
     }
     std::string candidate_name = candidate->name();
     XLS_VLOG_LINES(2,
@@ -1461,14 +1690,7 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
     candidate_changes.clear();
   }
 
-  std::cout << knownf_ir_text;
-
-  // Run the last test verification without the cache.
-  XLS_RETURN_IF_ERROR(VerifyStillFails(knownf_ir_text, inputs,
-                                       "Minimized function does not fail!",
-                                       /*test_cache=*/nullptr));
-
-  return absl::OkStatus();
+  return FinishMinimization(knownf_ir_text, inputs);
 }
 
 }  // namespace
@@ -1497,6 +1719,15 @@ int main(int argc, char** argv) {
       << "Must specify exactly one of --test_executable, --test_llvm_jit, or "
          "--test_optimizer";
 
+  if (absl::GetFlag(FLAGS_test_server)) {
+    QCHECK(!absl::GetFlag(FLAGS_test_executable).empty())
+        << "--test_server requires --test_executable";
+    QCHECK(!absl::GetFlag(FLAGS_test_executable_crash_is_bug))
+        << "Cannot specify --test_executable_crash_is_bug with --test_server";
+    // Report a test server which has exited as an error rather than dying.
+    signal(SIGPIPE, SIG_IGN);
+  }
+
   if (absl::GetFlag(FLAGS_can_extract_segments)) {
     std::vector<std::string> failures;
     bool failed = false;
@@ -1526,5 +1757,6 @@ int main(int argc, char** argv) {
       positional_arguments[0], absl::GetFlag(FLAGS_failed_attempt_limit),
       absl::GetFlag(FLAGS_total_attempt_limit),
       absl::GetFlag(FLAGS_simplifications_between_tests),
-      absl::GetFlag(FLAGS_failed_attempts_between_tests_limit)));
+      absl::GetFlag(FLAGS_failed_attempts_between_tests_limit),
+      absl::GetFlag(FLAGS_parallelism)));
 }
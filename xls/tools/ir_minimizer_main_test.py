@@ -377,6 +377,56 @@ top fn foo() -> bits[32] {
 """,
     )
 
+  def test_minimize_add_remove_params_with_test_server(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    test_sh_file = self.create_tempfile()
+    self._write_sh_script(
+        test_sh_file.full_path,
+        [
+            'while read ir_path; do',
+            '  if /usr/bin/env grep -q add "$ir_path"; then',
+            '    echo 1',
+            '  else',
+            '    echo 0',
+            '  fi',
+            'done',
+        ],
+    )
+    minimized_ir = subprocess.check_output([
+        IR_MINIMIZER_MAIN_PATH,
+        '--test_executable=' + test_sh_file.full_path,
+        '--test_server',
+        '--can_remove_params',
+        ir_file.full_path,
+    ])
+    self._maybe_record_property('output', minimized_ir.decode('utf-8'))
+    self.assertEqual(
+        minimized_ir.decode('utf-8'),
+        """package foo
+
+top fn foo() -> bits[32] {
+  literal.13: bits[32] = literal(value=0, id=13)
+  ret add.2: bits[32] = add(literal.13, literal.13, id=2)
+}
+""",
+    )
+
+  def test_minimize_add_remove_params_in_parallel(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    test_sh_file = self.create_tempfile()
+    self._write_sh_script(test_sh_file.full_path, ['/usr/bin/env grep add $1'])
+    minimized_ir = subprocess.check_output([
+        IR_MINIMIZER_MAIN_PATH,
+        '--test_executable=' + test_sh_file.full_path,
+        '--can_remove_params',
+        '--parallelism=4',
+        ir_file.full_path,
+    ])
+    self._maybe_record_property('output', minimized_ir.decode('utf-8'))
+    self.assertIn('top fn foo() -> bits[32]', minimized_ir.decode('utf-8'))
+    self.assertIn('add(', minimized_ir.decode('utf-8'))
+    self.assertNotIn('param', minimized_ir.decode('utf-8'))
+
   def test_no_reduction_possible(self):
     ir_file = self.create_tempfile(content=ADD_IR)
     test_sh_file = self.create_tempfile()
@@ -15,6 +15,8 @@
 // Prints summary information about an IR file to the terminal.
 // Output will be added as needs warrant, so feel free to make additions!
 
+#include <cstdint>
+#include <filesystem>  // NOLINT
 #include <iostream>
 #include <optional>
 #include <string>
@@ -24,17 +26,26 @@
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/tools/streaming_ir_stats.h"
 
 ABSL_FLAG(
     std::string, top, "",
     "The name of the top entity. Currently, only functions are supported. "
     "If set, restrict dumping to the given function. "
     "The name should not be mangled with the Package name.");
+ABSL_FLAG(bool, streaming, false,
+          "If true, scan the given IR files (text or binary, any number of "
+          "them) without parsing them into packages and print aggregate op, "
+          "bit count and function size histograms. Much faster and uses "
+          "bounded memory, so suited to surveying many files.");
+ABSL_FLAG(int64_t, threads, 1,
+          "Number of files scanned concurrently with --streaming.");
 
 namespace xls {
 
@@ -56,11 +67,25 @@ static absl::Status RealMain(std::string_view ir_path,
   return absl::OkStatus();
 }
 
+static absl::Status StreamingMain(absl::Span<const std::string_view> ir_paths,
+                                  int64_t threads) {
+  std::vector<std::filesystem::path> paths(ir_paths.begin(), ir_paths.end());
+  XLS_ASSIGN_OR_RETURN(StreamingIrStats stats,
+                       ScanIrFilesForStats(paths, threads));
+  std::cout << stats.ToString();
+  return absl::OkStatus();
+}
+
 }  // namespace xls
 
 int main(int argc, char** argv) {
   std::vector<std::string_view> positional_args =
       xls::InitXls(argv[0], argc, argv);
+  if (absl::GetFlag(FLAGS_streaming)) {
+    QCHECK(!positional_args.empty()) << "No IR files given";
+    return xls::ExitStatus(
+        xls::StreamingMain(positional_args, absl::GetFlag(FLAGS_threads)));
+  }
   QCHECK_EQ(positional_args.size(), 1);
 
   std::optional<std::string> restrict_fn;
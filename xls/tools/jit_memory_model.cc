@@ -0,0 +1,230 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/jit_memory_model.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/block.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/jit/jit_runtime.h"
+
+namespace xls {
+namespace {
+
+absl::StatusOr<int64_t> GetInputPortIndex(Block* block, std::string_view name) {
+  absl::Span<InputPort* const> ports = block->GetInputPorts();
+  auto it = std::find_if(ports.begin(), ports.end(), [&](InputPort* port) {
+    return port->name() == name;
+  });
+  if (it == ports.end()) {
+    return absl::NotFoundError(absl::StrFormat(
+        "Block %s has no input port %s", block->name(), name));
+  }
+  return it - ports.begin();
+}
+
+absl::StatusOr<int64_t> GetOutputPortIndex(Block* block,
+                                           std::string_view name) {
+  absl::Span<OutputPort* const> ports = block->GetOutputPorts();
+  auto it = std::find_if(ports.begin(), ports.end(), [&](OutputPort* port) {
+    return port->name() == name;
+  });
+  if (it == ports.end()) {
+    return absl::NotFoundError(absl::StrFormat(
+        "Block %s has no output port %s", block->name(), name));
+  }
+  return it - ports.begin();
+}
+
+Type* GetOutputPortType(Block* block, int64_t index) {
+  return block->GetOutputPorts()[index]->operand(0)->GetType();
+}
+
+// Enables are single bits, stored in the low bit of a byte.
+bool IsEnabled(const uint8_t* buffer) { return (buffer[0] & 1) != 0; }
+
+}  // namespace
+
+JitMemoryModel::JitMemoryModel(std::string_view name, int64_t size,
+                               Type* data_type, int64_t read_latency,
+                               bool show_trace, JitRuntime& runtime)
+    : name_(name),
+      size_(size),
+      data_type_(data_type),
+      word_size_(runtime.GetTypeByteSize(data_type)),
+      read_latency_(read_latency),
+      show_trace_(show_trace),
+      runtime_(runtime),
+      cells_(size * word_size_),
+      read_disabled_data_(word_size_),
+      read_slots_(read_latency * word_size_),
+      read_slot_valid_(read_latency, false) {}
+
+/* static */ absl::StatusOr<std::unique_ptr<JitMemoryModel>>
+JitMemoryModel::Create(std::string_view name, int64_t size,
+                       const Value& initial_value,
+                       const Value& read_disabled_value, const Ports& ports,
+                       Block* block, JitRuntime& runtime, int64_t read_latency,
+                       bool show_trace) {
+  XLS_RET_CHECK_GT(size, 0);
+  XLS_RET_CHECK_GE(read_latency, 1);
+  XLS_ASSIGN_OR_RETURN(int64_t read_data_index,
+                       GetInputPortIndex(block, ports.read_data));
+  Type* data_type = block->GetInputPorts()[read_data_index]->GetType();
+  auto model = absl::WrapUnique(new JitMemoryModel(
+      name, size, data_type, read_latency, show_trace, runtime));
+  model->read_data_index_ = read_data_index;
+  XLS_ASSIGN_OR_RETURN(model->read_enable_index_,
+                       GetOutputPortIndex(block, ports.read_enable));
+  XLS_ASSIGN_OR_RETURN(model->read_address_index_,
+                       GetOutputPortIndex(block, ports.read_address));
+  XLS_ASSIGN_OR_RETURN(model->write_enable_index_,
+                       GetOutputPortIndex(block, ports.write_enable));
+  XLS_ASSIGN_OR_RETURN(model->write_address_index_,
+                       GetOutputPortIndex(block, ports.write_address));
+  XLS_ASSIGN_OR_RETURN(model->write_data_index_,
+                       GetOutputPortIndex(block, ports.write_data));
+  model->output_port_indices_ = {
+      model->read_enable_index_, model->read_address_index_,
+      model->write_enable_index_, model->write_address_index_,
+      model->write_data_index_};
+
+  for (int64_t index : {model->read_enable_index_,
+                        model->write_enable_index_}) {
+    Type* type = GetOutputPortType(block, index);
+    if (!type->IsBits() || type->GetFlatBitCount() != 1) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Memory %s enable port %s must be bits[1], is %s", name,
+          block->GetOutputPorts()[index]->name(), type->ToString()));
+    }
+  }
+  for (int64_t index : {model->read_address_index_,
+                        model->write_address_index_}) {
+    Type* type = GetOutputPortType(block, index);
+    if (!type->IsBits()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Memory %s address port %s must be bits, is %s", name,
+          block->GetOutputPorts()[index]->name(), type->ToString()));
+    }
+  }
+  model->read_address_size_ = runtime.GetTypeByteSize(
+      GetOutputPortType(block, model->read_address_index_));
+  model->write_address_size_ = runtime.GetTypeByteSize(
+      GetOutputPortType(block, model->write_address_index_));
+  Type* write_data_type = GetOutputPortType(block, model->write_data_index_);
+  if (!write_data_type->IsEqualTo(data_type)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Memory %s write data type %s does not match read data type %s", name,
+        write_data_type->ToString(), data_type->ToString()));
+  }
+  for (const Value* value : {&initial_value, &read_disabled_value}) {
+    if (!ValueConformsToType(*value, data_type)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Memory %s value %s does not have the data type %s", name,
+          value->ToString(), data_type->ToString()));
+    }
+  }
+
+  runtime.BlitValueToBuffer(read_disabled_value, data_type,
+                            absl::MakeSpan(model->read_disabled_data_));
+  // Lay out the initial value once and replicate it to every cell.
+  runtime.BlitValueToBuffer(
+      initial_value, data_type,
+      absl::MakeSpan(model->cells_).subspan(0, model->word_size_));
+  for (int64_t address = 1; address < size; ++address) {
+    std::memcpy(model->cell(address), model->cell(0), model->word_size_);
+  }
+  return model;
+}
+
+void JitMemoryModel::SetReadData(
+    absl::Span<uint8_t* const> input_ports) const {
+  const uint8_t* data = read_slot_valid_[head_]
+                            ? read_slots_.data() + head_ * word_size_
+                            : read_disabled_data_.data();
+  std::memcpy(input_ports[read_data_index_], data, word_size_);
+}
+
+absl::StatusOr<int64_t> JitMemoryModel::GetAddress(
+    const uint8_t* buffer, int64_t byte_size,
+    std::string_view operation) const {
+  // Bits are stored little-endian in the native layout.
+  uint64_t address = 0;
+  std::memcpy(&address, buffer,
+              std::min<int64_t>(byte_size, sizeof(address)));
+  bool in_range = address < size_;
+  for (int64_t i = sizeof(address); i < byte_size; ++i) {
+    in_range = in_range && buffer[i] == 0;
+  }
+  if (!in_range) {
+    return absl::OutOfRangeError(absl::StrFormat(
+        "Memory %s %s out of range at %d", name_, operation, address));
+  }
+  return static_cast<int64_t>(address);
+}
+
+absl::Status JitMemoryModel::HandleRequests(
+    absl::Span<const uint8_t* const> output_ports) {
+  // The read is performed first so a write to the same address in the same
+  // tick is not visible to it.
+  read_slot_valid_[head_] = IsEnabled(output_ports[read_enable_index_]);
+  if (read_slot_valid_[head_]) {
+    XLS_ASSIGN_OR_RETURN(
+        int64_t address,
+        GetAddress(output_ports[read_address_index_], read_address_size_,
+                   "read"));
+    std::memcpy(read_slots_.data() + head_ * word_size_, cell(address),
+                word_size_);
+    if (show_trace_) {
+      LOG(INFO) << "Memory Model: Initiated read " << name_ << "[" << address
+                << "] = " << GetCell(address);
+    }
+  }
+  if (IsEnabled(output_ports[write_enable_index_])) {
+    XLS_ASSIGN_OR_RETURN(
+        int64_t address,
+        GetAddress(output_ports[write_address_index_], write_address_size_,
+                   "write"));
+    std::memcpy(cell(address), output_ports[write_data_index_], word_size_);
+    if (show_trace_) {
+      LOG(INFO) << "Memory Model: Committed write " << name_ << "[" << address
+                << "] = " << GetCell(address);
+    }
+  }
+  return absl::OkStatus();
+}
+
+Value JitMemoryModel::GetCell(int64_t address) const {
+  return runtime_.UnpackBuffer(cell(address), data_type_);
+}
+
+}  // namespace xls
@@ -0,0 +1,134 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_TOOLS_JIT_MEMORY_MODEL_H_
+#define XLS_TOOLS_JIT_MEMORY_MODEL_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/block.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_runtime.h"
+
+namespace xls {
+
+// A model of a RAM attached to the ports of a block evaluated with the block
+// JIT. The model reads its requests from and writes its read data to the
+// native-layout port buffers of a BlockJitContinuation (see
+// BlockJitContinuation::input_port_pointers and output_port_pointers) so no
+// Values are created while simulating. The contents of the memory and the
+// reads in flight are stored in the JIT's native layout in flat arrays.
+//
+// Each tick the block may request one read and one write. Data read is
+// presented on the read data port `read_latency` ticks later; a read and a
+// write of the same address in the same tick returns the old contents.
+class JitMemoryModel {
+ public:
+  // Names of the ports of the block the memory is attached to.
+  struct Ports {
+    std::string read_enable;
+    std::string read_address;
+    std::string read_data;
+    std::string write_enable;
+    std::string write_address;
+    std::string write_data;
+  };
+
+  // Creates a model of a memory with `size` cells each holding
+  // `initial_value`. `read_disabled_value` is presented on the read data port
+  // when no read completes in a tick.
+  static absl::StatusOr<std::unique_ptr<JitMemoryModel>> Create(
+      std::string_view name, int64_t size, const Value& initial_value,
+      const Value& read_disabled_value, const Ports& ports, Block* block,
+      JitRuntime& runtime, int64_t read_latency = 1, bool show_trace = false);
+
+  // Writes the data of the read completing this tick, or the read disabled
+  // value, to the read data port in `input_ports`.
+  void SetReadData(absl::Span<uint8_t* const> input_ports) const;
+
+  // Performs the read and write requested on the output ports after a cycle.
+  absl::Status HandleRequests(absl::Span<const uint8_t* const> output_ports);
+
+  // Advances the reads in flight by one tick.
+  void Tick() { head_ = (head_ + 1) % read_latency_; }
+
+  const std::string& name() const { return name_; }
+  int64_t size() const { return size_; }
+
+  // Returns the contents of cell `address`.
+  Value GetCell(int64_t address) const;
+
+  // Indices of the input and output ports driven and consumed by the model.
+  int64_t read_data_index() const { return read_data_index_; }
+  absl::Span<const int64_t> output_port_indices() const {
+    return output_port_indices_;
+  }
+
+ private:
+  JitMemoryModel(std::string_view name, int64_t size, Type* data_type,
+                 int64_t read_latency, bool show_trace, JitRuntime& runtime);
+
+  // Returns the address held in the native-layout buffer `buffer` of
+  // `byte_size` bytes or an error if it is not within the memory.
+  absl::StatusOr<int64_t> GetAddress(const uint8_t* buffer, int64_t byte_size,
+                                     std::string_view operation) const;
+
+  uint8_t* cell(int64_t address) {
+    return cells_.data() + address * word_size_;
+  }
+  const uint8_t* cell(int64_t address) const {
+    return cells_.data() + address * word_size_;
+  }
+
+  std::string name_;
+  int64_t size_;
+  Type* data_type_;
+  int64_t word_size_;
+  int64_t read_latency_;
+  bool show_trace_;
+  JitRuntime& runtime_;
+
+  int64_t read_enable_index_ = -1;
+  int64_t read_address_index_ = -1;
+  int64_t read_data_index_ = -1;
+  int64_t write_enable_index_ = -1;
+  int64_t write_address_index_ = -1;
+  int64_t write_data_index_ = -1;
+  std::vector<int64_t> output_port_indices_;
+  int64_t read_address_size_ = 0;
+  int64_t write_address_size_ = 0;
+
+  // `size_` cells of `word_size_` bytes.
+  std::vector<uint8_t> cells_;
+  std::vector<uint8_t> read_disabled_data_;
+  // Ring buffer of the reads in flight, one slot of `word_size_` bytes per tick
+  // of latency. The slot at `head_` holds the read completing this tick and is
+  // then reused for the read requested this tick.
+  std::vector<uint8_t> read_slots_;
+  std::vector<bool> read_slot_valid_;
+  int64_t head_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_JIT_MEMORY_MODEL_H_
@@ -0,0 +1,195 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/jit_memory_model.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/block_jit.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+class JitMemoryModelTest : public IrTestBase {
+ protected:
+  // Builds a block which passes its request inputs straight through to the
+  // memory ports and exposes the read data on `data`.
+  absl::StatusOr<Block*> BuildPassThroughBlock(Package* p) {
+    BlockBuilder bb(TestName(), p);
+    Type* u1 = p->GetBitsType(1);
+    Type* u8 = p->GetBitsType(8);
+    Type* u32 = p->GetBitsType(32);
+    bb.OutputPort("mem_rd_en", bb.InputPort("rd_en", u1));
+    bb.OutputPort("mem_rd_addr", bb.InputPort("rd_addr", u8));
+    bb.OutputPort("mem_wr_en", bb.InputPort("wr_en", u1));
+    bb.OutputPort("mem_wr_addr", bb.InputPort("wr_addr", u8));
+    bb.OutputPort("mem_wr_data", bb.InputPort("wr_data", u32));
+    bb.OutputPort("data", bb.InputPort("mem_rd_data", u32));
+    return bb.Build();
+  }
+
+  static JitMemoryModel::Ports MemPorts() {
+    return JitMemoryModel::Ports{.read_enable = "mem_rd_en",
+                                 .read_address = "mem_rd_addr",
+                                 .read_data = "mem_rd_data",
+                                 .write_enable = "mem_wr_en",
+                                 .write_address = "mem_wr_addr",
+                                 .write_data = "mem_wr_data"};
+  }
+
+  // Runs one cycle with the given requests and returns the value of the
+  // `data` port, i.e. the read data presented by the memory in that cycle.
+  static absl::StatusOr<Value> Cycle(BlockJit& jit,
+                                     BlockJitContinuation& continuation,
+                                     JitMemoryModel& memory, bool rd_en,
+                                     int64_t rd_addr, bool wr_en,
+                                     int64_t wr_addr, int64_t wr_data) {
+    XLS_RETURN_IF_ERROR(continuation.SetInputPorts({
+        Value(UBits(rd_en, 1)),
+        Value(UBits(rd_addr, 8)),
+        Value(UBits(wr_en, 1)),
+        Value(UBits(wr_addr, 8)),
+        Value(UBits(wr_data, 32)),
+        Value(UBits(0, 32)),
+    }));
+    memory.SetReadData(continuation.input_port_pointers());
+    XLS_RETURN_IF_ERROR(jit.RunOneCycle(continuation));
+    XLS_RETURN_IF_ERROR(
+        memory.HandleRequests(continuation.output_port_pointers()));
+    memory.Tick();
+    return continuation.GetOutputPortsMap().at("data");
+  }
+};
+
+TEST_F(JitMemoryModelTest, ReadsAndWrites) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, BuildPassThroughBlock(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  std::unique_ptr<BlockJitContinuation> continuation = jit->NewContinuation();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitMemoryModel> memory,
+      JitMemoryModel::Create("mem", 16, Value(UBits(0xaa, 32)),
+                             Value(UBits(0xffffffff, 32)), MemPorts(), block,
+                             *jit->runtime()));
+  EXPECT_EQ(memory->read_data_index(), 5);
+  EXPECT_EQ(memory->GetCell(15), Value(UBits(0xaa, 32)));
+
+  // Write 42 to cell 3 while reading it; the read sees the old contents.
+  EXPECT_THAT(Cycle(*jit, *continuation, *memory, true, 3, true, 3, 42),
+              status_testing::IsOkAndHolds(Value(UBits(0xffffffff, 32))));
+  EXPECT_EQ(memory->GetCell(3), Value(UBits(42, 32)));
+  EXPECT_THAT(Cycle(*jit, *continuation, *memory, true, 3, false, 0, 0),
+              status_testing::IsOkAndHolds(Value(UBits(0xaa, 32))));
+  EXPECT_THAT(Cycle(*jit, *continuation, *memory, false, 0, false, 0, 0),
+              status_testing::IsOkAndHolds(Value(UBits(42, 32))));
+  EXPECT_THAT(Cycle(*jit, *continuation, *memory, false, 0, false, 0, 0),
+              status_testing::IsOkAndHolds(Value(UBits(0xffffffff, 32))));
+}
+
+TEST_F(JitMemoryModelTest, ReadLatency) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, BuildPassThroughBlock(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  std::unique_ptr<BlockJitContinuation> continuation = jit->NewContinuation();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitMemoryModel> memory,
+      JitMemoryModel::Create("mem", 16, Value(UBits(0, 32)),
+                             Value(UBits(0xffffffff, 32)), MemPorts(), block,
+                             *jit->runtime(), /*read_latency=*/3));
+  for (int64_t i = 0; i < 4; ++i) {
+    XLS_ASSERT_OK(Cycle(*jit, *continuation, *memory, false, 0, true, i, i + 1)
+                      .status());
+  }
+  // Reads of cells 0, 1 and 2 in consecutive cycles complete three cycles
+  // later.
+  std::vector<Value> read_data;
+  for (int64_t i = 0; i < 6; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Value data, Cycle(*jit, *continuation, *memory, i < 3, i, false, 0, 0));
+    read_data.push_back(data);
+  }
+  EXPECT_THAT(read_data, testing::ElementsAre(
+                             Value(UBits(0xffffffff, 32)),
+                             Value(UBits(0xffffffff, 32)),
+                             Value(UBits(0xffffffff, 32)), Value(UBits(1, 32)),
+                             Value(UBits(2, 32)), Value(UBits(3, 32))));
+}
+
+TEST_F(JitMemoryModelTest, OutOfRangeAccess) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, BuildPassThroughBlock(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  std::unique_ptr<BlockJitContinuation> continuation = jit->NewContinuation();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitMemoryModel> memory,
+      JitMemoryModel::Create("mem", 16, Value(UBits(0, 32)),
+                             Value(UBits(0, 32)), MemPorts(), block,
+                             *jit->runtime()));
+  EXPECT_THAT(Cycle(*jit, *continuation, *memory, false, 0, true, 16, 1),
+              StatusIs(absl::StatusCode::kOutOfRange,
+                       HasSubstr("Memory mem write out of range at 16")));
+  EXPECT_THAT(Cycle(*jit, *continuation, *memory, true, 200, false, 0, 0),
+              StatusIs(absl::StatusCode::kOutOfRange,
+                       HasSubstr("Memory mem read out of range at 200")));
+}
+
+TEST_F(JitMemoryModelTest, MismatchedPortTypes) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, BuildPassThroughBlock(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  EXPECT_THAT(
+      JitMemoryModel::Create("mem", 16, Value(UBits(0, 8)), Value(UBits(0, 32)),
+                             MemPorts(), block, *jit->runtime()),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("does not have the data type")));
+  JitMemoryModel::Ports ports = MemPorts();
+  ports.write_data = "data";
+  ports.read_data = "wr_data";
+  XLS_EXPECT_OK(JitMemoryModel::Create("mem", 16, Value(UBits(0, 32)),
+                                       Value(UBits(0, 32)), ports, block,
+                                       *jit->runtime())
+                    .status());
+  ports.read_enable = "mem_rd_addr";
+  EXPECT_THAT(JitMemoryModel::Create("mem", 16, Value(UBits(0, 32)),
+                                     Value(UBits(0, 32)), ports, block,
+                                     *jit->runtime()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("must be bits[1]")));
+}
+
+}  // namespace
+}  // namespace xls
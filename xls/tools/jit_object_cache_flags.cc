@@ -0,0 +1,80 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/jit_object_cache_flags.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/jit/jit_object_cache.h"
+#include "xls/jit/orc_jit.h"
+
+ABSL_FLAG(std::string, jit_object_cache_dir, "",
+          "If non-empty, directory in which to cache JIT compiled object "
+          "files. Compiling unchanged IR with the same options loads the "
+          "cached object file rather than re-running LLVM optimization and "
+          "codegen. The directory may be shared between concurrent "
+          "processes.");
+ABSL_FLAG(std::string, jit_profiler, "none",
+          "Profiler with which to register JIT compiled code so that samples "
+          "are attributed to XLS function and proc names: 'none', 'perf' "
+          "(perf map and jitdump files; requires LLVM built with "
+          "LLVM_USE_PERF) or 'intel' (VTune; requires LLVM built with "
+          "LLVM_USE_INTEL_JITEVENTS).");
+ABSL_FLAG(int64_t, llvm_large_module_instruction_count,
+          xls::OrcJit::kDefaultLargeModuleInstructionCount,
+          "JIT modules (or, with concurrent compilation, module partitions) "
+          "with more LLVM instructions than this are optimized at a lower "
+          "level to bound compile time. Zero or negative disables the limit.");
+
+namespace xls {
+
+absl::Status InitJitObjectCacheFromFlags() {
+  std::string directory = absl::GetFlag(FLAGS_jit_object_cache_dir);
+  if (directory.empty()) {
+    return absl::OkStatus();
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitObjectCache> cache,
+                       JitObjectCache::Create(directory));
+  SetDefaultJitObjectCache(std::move(cache));
+  return absl::OkStatus();
+}
+
+absl::Status InitJitProfilerFromFlags() {
+  std::string profiler = absl::GetFlag(FLAGS_jit_profiler);
+  if (profiler == "none") {
+    OrcJit::SetDefaultProfiler(JitProfiler::kNone);
+  } else if (profiler == "perf") {
+    OrcJit::SetDefaultProfiler(JitProfiler::kPerf);
+  } else if (profiler == "intel") {
+    OrcJit::SetDefaultProfiler(JitProfiler::kIntelJitEvents);
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unknown --jit_profiler: %s", profiler));
+  }
+  return absl::OkStatus();
+}
+
+void InitJitCompileBudgetFromFlags() {
+  OrcJit::SetDefaultLargeModuleInstructionCount(
+      absl::GetFlag(FLAGS_llvm_large_module_instruction_count));
+}
+
+}  // namespace xls
@@ -0,0 +1,37 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_TOOLS_JIT_OBJECT_CACHE_FLAGS_H_
+#define XLS_TOOLS_JIT_OBJECT_CACHE_FLAGS_H_
+
+#include "absl/status/status.h"
+
+namespace xls {
+
+// Enables the persistent JIT object cache if the --jit_object_cache_dir flag
+// is set. Must be called before any JIT is created.
+absl::Status InitJitObjectCacheFromFlags();
+
+// Registers the code emitted by subsequently created JITs with the profiler
+// named by the --jit_profiler flag. Must be called before any JIT is created.
+absl::Status InitJitProfilerFromFlags();
+
+// Sets the instruction count above which JIT modules are optimized at a lower
+// level from the --llvm_large_module_instruction_count flag. Must be called
+// before any JIT is created.
+void InitJitCompileBudgetFromFlags();
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_JIT_OBJECT_CACHE_FLAGS_H_
@@ -31,6 +31,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
@@ -38,6 +39,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
+#include "xls/common/thread.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/nodes.h"
@@ -100,6 +102,13 @@ ABSL_FLAG(int32_t, stage, -1,
           "Pipeline stage to evaluate. Requires --schedule.\n"
           "If \"schedule\" is set, but this is not, then the entire module "
           "will be evaluated.");
+ABSL_FLAG(bool, all_stages, false,
+          "If true, every pipeline stage is proved concurrently, each in its "
+          "own Z3 context, stopping at the first mismatch. Requires "
+          "--schedule_path. --timeout_sec then applies to each stage.");
+ABSL_FLAG(int32_t, stage_threads, 0,
+          "Number of stages to prove concurrently with --all_stages. If not "
+          "positive, the number of available CPUs is used.");
 
 namespace xls {
 namespace {
@@ -231,6 +240,46 @@ absl::Status AutoStage(const solvers::z3::LecParams& lec_params,
   return absl::OkStatus();
 }
 
+std::string_view StageLecOutcomeToString(solvers::z3::StageLecOutcome outcome) {
+  switch (outcome) {
+    case solvers::z3::StageLecOutcome::kEquivalent:
+      return "PASSED!";
+    case solvers::z3::StageLecOutcome::kMismatch:
+      return "FAILED!";
+    case solvers::z3::StageLecOutcome::kUndetermined:
+      return "TIMED OUT!";
+    case solvers::z3::StageLecOutcome::kSkipped:
+      return "SKIPPED";
+  }
+  return "UNKNOWN";
+}
+
+// Proves all stages concurrently; the IR and netlist are shared by the stages.
+absl::Status AllStages(const solvers::z3::LecParams& lec_params,
+                       const PipelineSchedule& schedule, int timeout_sec,
+                       int stage_threads) {
+  std::cout << "Performing parallel staged LEC.\n";
+  solvers::z3::StagedLecOptions options;
+  options.worker_count = stage_threads > 0 ? stage_threads : AvailableCPUs();
+  if (timeout_sec != -1) {
+    options.timeout_per_stage = absl::Seconds(timeout_sec);
+  }
+  XLS_ASSIGN_OR_RETURN(
+      solvers::z3::StagedLecResult result,
+      solvers::z3::LecAllStages(lec_params, schedule, options));
+  for (int i = 0; i < result.stages.size(); i++) {
+    std::cout << "Stage " << i << "..."
+              << StageLecOutcomeToString(result.stages[i]) << '\n';
+  }
+  if (result.failing_lec != nullptr) {
+    std::cout << '\n' << "Stage " << *result.failing_stage << ":\n";
+    std::cout << result.failing_lec->ResultToString() << '\n';
+    std::cout << '\n' << "IR/netlist value dump:" << '\n';
+    result.failing_lec->DumpIrTree();
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 static absl::Status RealMain(
@@ -238,7 +287,8 @@ static absl::Status RealMain(
     std::string_view netlist_module_name, std::string_view cell_lib_path,
     std::string_view cell_proto_path, std::string_view netlist_path,
     std::string_view constraints_file, std::string_view schedule_path,
-    int stage, bool auto_stage, int timeout_sec) {
+    int stage, bool auto_stage, bool all_stages, int stage_threads,
+    int timeout_sec) {
   solvers::z3::LecParams lec_params;
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
@@ -268,6 +318,9 @@ static absl::Status RealMain(
     if (auto_stage) {
       return AutoStage(lec_params, schedule, timeout_sec);
     }
+    if (all_stages) {
+      return AllStages(lec_params, schedule, timeout_sec, stage_threads);
+    }
     XLS_ASSIGN_OR_RETURN(
         lec, solvers::z3::Lec::CreateForStage(lec_params, schedule, stage));
   } else {
@@ -343,9 +396,18 @@ int main(int argc, char* argv[]) {
   QCHECK(!(auto_stage && schedule_path.empty()))
       << "--schedule_path must be specified with --auto_stage.";
 
+  bool all_stages = absl::GetFlag(FLAGS_all_stages);
+  QCHECK(!(all_stages && (auto_stage || stage != -1)))
+      << "Only one of --stage, --auto_stage or --all_stages may be specified.";
+  QCHECK(!(all_stages && schedule_path.empty()))
+      << "--schedule_path must be specified with --all_stages.";
+  QCHECK(!(all_stages && !absl::GetFlag(FLAGS_constraints_file).empty()))
+      << "--constraints_file is not supported with --all_stages.";
+
   return xls::ExitStatus(xls::RealMain(
       ir_path, absl::GetFlag(FLAGS_entry_function_name),
       absl::GetFlag(FLAGS_netlist_module_name), cell_lib_path, cell_proto_path,
       netlist_path, absl::GetFlag(FLAGS_constraints_file), schedule_path, stage,
-      auto_stage, absl::GetFlag(FLAGS_timeout_sec)));
+      auto_stage, all_stages, absl::GetFlag(FLAGS_stage_threads),
+      absl::GetFlag(FLAGS_timeout_sec)));
 }
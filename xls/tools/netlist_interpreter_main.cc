@@ -15,14 +15,18 @@
 // Driver for NetlistInterpreter: loads a netlist from disk, feeds Value input
 // (taken from the command line) into it, and prints the result.
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
 #include "xls/codegen/flattening.h"
@@ -40,6 +44,7 @@
 #include "xls/netlist/cell_library.h"
 #include "xls/netlist/function_extractor.h"
 #include "xls/netlist/interpreter.h"
+#include "xls/netlist/levelized_simulator.h"
 #include "xls/netlist/lib_parser.h"
 #include "xls/netlist/netlist.h"
 #include "xls/netlist/netlist.pb.h"
@@ -59,6 +64,11 @@ ABSL_FLAG(std::string, input, "",
           "The input to the function as a semicolon-separated list of typed "
           "values. For example: \"bits[32]:42; (bits[7]:0, bits[20]:4)\". "
           "Values must be listed in the same order as the module inputs.");
+ABSL_FLAG(std::string, input_file, "",
+          "Path to a file of inputs to evaluate in batch, one per line in the "
+          "format of --input. The netlist is compiled once and evaluated many "
+          "inputs at a time; one output is printed per line of input. "
+          "Incompatible with --input and --dump_cells.");
 ABSL_FLAG(std::string, output_type, "",
           "Type of the value as an XLS-formatted string. If un-set, then the "
           "output will be printed as flat uninterpreted bits.");
@@ -87,23 +97,10 @@ static absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
   return netlist::CellLibrary::FromProto(lib_proto);
 }
 
-static absl::Status RealMain(const std::string& netlist_path,
-                             const std::string& cell_library_path,
-                             const std::string& cell_library_proto_path,
-                             const std::string& module_name,
-                             absl::Span<const std::string> inputs,
-                             const std::string& output_type_string,
-                             absl::Span<const std::string> dump_cells) {
-  XLS_ASSIGN_OR_RETURN(
-      netlist::CellLibrary cell_library,
-      GetCellLibrary(cell_library_path, cell_library_proto_path));
-
-  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
-  XLS_ASSIGN_OR_RETURN(auto netlist, netlist::rtl::Parser::ParseNetlist(
-                                         &cell_library, &scanner));
-  XLS_ASSIGN_OR_RETURN(const auto* module, netlist->GetModule(module_name));
-
+// Returns the value of each of the module's input nets (in the order of
+// Module::inputs()) for the given semicolon-separated list of typed values.
+static absl::StatusOr<std::vector<bool>> GetInputNetValues(
+    const netlist::rtl::Module* module, absl::Span<const std::string> inputs) {
   // Input values are listed in the same order as inputs are declared by
   // the netlist module declaration, which may be different from the order of
   // Module::inputs().  For example:
@@ -125,25 +122,21 @@ static absl::Status RealMain(const std::string& netlist_path,
   }
   input_bits = bits_ops::Reverse(input_bits);
 
-  netlist::NetRef2Value input_nets;
   const std::vector<netlist::rtl::NetRef>& module_inputs = module->inputs();
   XLS_RET_CHECK(module_inputs.size() == input_bits.bit_count());
 
-  for (int i = 0; i < module->inputs().size(); i++) {
-    const netlist::rtl::NetRef in = module_inputs[i];
-    input_nets[in] = input_bits.Get(module->GetInputPortOffset(in->name()));
+  std::vector<bool> values;
+  values.reserve(module_inputs.size());
+  for (const netlist::rtl::NetRef in : module_inputs) {
+    values.push_back(input_bits.Get(module->GetInputPortOffset(in->name())));
   }
+  return values;
+}
 
-  netlist::Interpreter interpreter(netlist.get());
-  XLS_ASSIGN_OR_RETURN(auto output_nets, interpreter.InterpretModule(
-                                             module, input_nets, dump_cells));
-
-  BitsRope rope(output_nets.size());
-  for (const netlist::rtl::NetRef ref : module->outputs()) {
-    rope.push_back(output_nets[ref]);
-  }
-  Bits output_bits = rope.Build();
-
+// Formats the output bits as a value of the given type (or as flat bits if no
+// type is given).
+static absl::StatusOr<std::string> FormatOutput(
+    const Bits& output_bits, const std::string& output_type_string) {
   Value output;
   if (!output_type_string.empty()) {
     // This is a disposable package - it only exists to hold the type below.
@@ -155,8 +148,93 @@ static absl::Status RealMain(const std::string& netlist_path,
   } else {
     output = Value(output_bits);
   }
+  return output.ToString(FormatPreference::kHex);
+}
+
+// Evaluates every line of `input_path`, LevelizedSimulator::kLaneCount lines
+// at a time.
+static absl::Status RunBatch(const netlist::rtl::Netlist& netlist,
+                             const netlist::rtl::Module* module,
+                             const std::string& input_path,
+                             const std::string& output_type_string) {
+  XLS_ASSIGN_OR_RETURN(netlist::LevelizedSimulator simulator,
+                       netlist::LevelizedSimulator::Create(netlist, module));
+  XLS_ASSIGN_OR_RETURN(std::string input_text, GetFileContents(input_path));
+  std::vector<std::string_view> lines;
+  for (std::string_view line : absl::StrSplit(input_text, '\n')) {
+    line = absl::StripAsciiWhitespace(line);
+    if (!line.empty()) {
+      lines.push_back(line);
+    }
+  }
 
-  std::cout << output.ToString(FormatPreference::kHex) << '\n';
+  constexpr int64_t kLaneCount = netlist::LevelizedSimulator::kLaneCount;
+  for (int64_t base = 0; base < lines.size(); base += kLaneCount) {
+    int64_t lane_count = std::min<int64_t>(kLaneCount, lines.size() - base);
+    std::vector<uint64_t> input_words(module->inputs().size(), 0);
+    for (int64_t lane = 0; lane < lane_count; ++lane) {
+      std::vector<std::string> inputs = absl::StrSplit(lines[base + lane], ';');
+      XLS_ASSIGN_OR_RETURN(std::vector<bool> values,
+                           GetInputNetValues(module, inputs));
+      for (int64_t i = 0; i < values.size(); ++i) {
+        input_words[i] |= static_cast<uint64_t>(values[i]) << lane;
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(std::vector<uint64_t> output_words,
+                         simulator.Run(input_words));
+    for (int64_t lane = 0; lane < lane_count; ++lane) {
+      BitsRope rope(output_words.size());
+      for (uint64_t word : output_words) {
+        rope.push_back((word >> lane) & 1);
+      }
+      XLS_ASSIGN_OR_RETURN(std::string output,
+                           FormatOutput(rope.Build(), output_type_string));
+      std::cout << output << '\n';
+    }
+  }
+  return absl::OkStatus();
+}
+
+static absl::Status RealMain(const std::string& netlist_path,
+                             const std::string& cell_library_path,
+                             const std::string& cell_library_proto_path,
+                             const std::string& module_name,
+                             absl::Span<const std::string> inputs,
+                             const std::string& input_file,
+                             const std::string& output_type_string,
+                             absl::Span<const std::string> dump_cells) {
+  XLS_ASSIGN_OR_RETURN(
+      netlist::CellLibrary cell_library,
+      GetCellLibrary(cell_library_path, cell_library_proto_path));
+
+  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
+  netlist::rtl::Scanner scanner(netlist_text);
+  XLS_ASSIGN_OR_RETURN(auto netlist, netlist::rtl::Parser::ParseNetlist(
+                                         &cell_library, &scanner));
+  XLS_ASSIGN_OR_RETURN(const auto* module, netlist->GetModule(module_name));
+
+  if (!input_file.empty()) {
+    return RunBatch(*netlist, module, input_file, output_type_string);
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::vector<bool> input_values,
+                       GetInputNetValues(module, inputs));
+  netlist::NetRef2Value input_nets;
+  for (int i = 0; i < module->inputs().size(); i++) {
+    input_nets[module->inputs()[i]] = input_values[i];
+  }
+
+  netlist::Interpreter interpreter(netlist.get());
+  XLS_ASSIGN_OR_RETURN(auto output_nets, interpreter.InterpretModule(
+                                             module, input_nets, dump_cells));
+
+  BitsRope rope(output_nets.size());
+  for (const netlist::rtl::NetRef ref : module->outputs()) {
+    rope.push_back(output_nets[ref]);
+  }
+  XLS_ASSIGN_OR_RETURN(std::string output,
+                       FormatOutput(rope.Build(), output_type_string));
+  std::cout << output << '\n';
   return absl::OkStatus();
 }
 
@@ -178,15 +256,20 @@ int main(int argc, char* argv[]) {
   QCHECK(!module_name.empty()) << "--module_name must be specified.";
 
   std::string input = absl::GetFlag(FLAGS_input);
-  QCHECK(!input.empty()) << "--input must be specified.";
+  std::string input_file = absl::GetFlag(FLAGS_input_file);
+  QCHECK(!input.empty() ^ !input_file.empty())
+      << "One (and only one) of --input or --input_file must be specified.";
   std::vector<std::string> inputs = absl::StrSplit(input, ';');
 
   std::string dump_cells_str = absl::GetFlag(FLAGS_dump_cells);
+  QCHECK(input_file.empty() || dump_cells_str.empty())
+      << "--dump_cells is not supported with --input_file.";
   std::vector<std::string> dump_cells = absl::StrSplit(dump_cells_str, ',');
 
   std::string output_type = absl::GetFlag(FLAGS_output_type);
 
   return xls::ExitStatus(xls::RealMain(netlist_path, cell_library_path,
                                        cell_library_proto_path, module_name,
-                                       inputs, output_type, dump_cells));
+                                       inputs, input_file, output_type,
+                                       dump_cells));
 }
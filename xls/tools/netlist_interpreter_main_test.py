@@ -14,6 +14,7 @@
 # limitations under the License.
 """Tests for xls.tools.netlist_interpreter_main."""
 
+import math
 import subprocess
 
 from xls.common import runfiles
@@ -35,6 +36,16 @@ def run_netlist_interpreter(netlist, module, input_data, output_type):
   return result.decode('utf-8').strip()
 
 
+def run_netlist_interpreter_batch(netlist, module, input_file, output_type):
+  result = subprocess.check_output([
+      NETLIST_INTERPRETER_MAIN,
+      '--netlist=' + runfiles.get_path(XLS_TOOLS + netlist),
+      '--module_name=' + module, '--input_file=' + input_file,
+      '--output_type=' + output_type, '--cell_library=' + CELL_LIBRARY
+  ])
+  return result.decode('utf-8').strip().splitlines()
+
+
 class NetlistTranspilerMainTest(test_base.TestCase):
 
   def test_sqrt(self):
@@ -48,6 +59,15 @@ class NetlistTranspilerMainTest(test_base.TestCase):
                                   'bits[8]')
     self.assertEqual(res, 'bits[8]:0xaa')
 
+  def test_sqrt_batch(self):
+    # More inputs than the simulator evaluates in one pass.
+    values = list(range(0, 65536, 331))
+    input_file = self.create_tempfile(
+        content='\n'.join(f'bits[16]:{v}' for v in values))
+    res = run_netlist_interpreter_batch('testdata/sqrt.v', 'isqrt',
+                                        input_file.full_path, 'bits[8]')
+    self.assertEqual(res, [f'bits[8]:{hex(math.isqrt(v))}' for v in values])
+
 
 if __name__ == '__main__':
   test_base.main()
@@ -14,6 +14,7 @@
 
 #include "xls/tools/opt.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
@@ -23,27 +24,80 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/binary_ir.h"
 #include "xls/ir/function_base.h"
-#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/ir/verifier.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/pass_profile.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/verifier_checker.h"
+#include "xls/tools/opt_cache.h"
+#include "xls/tools/proc_channel_activity.pb.h"
 
 namespace xls::tools {
 
-absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
-                                             const OptOptions& options) {
+namespace {
+
+// Returns a description of every option which can affect the optimized IR,
+// for use in an OptCache key.
+std::string DescribeOptionsForCache(const OptOptions& options) {
+  auto optional_to_string = [](const auto& value) -> std::string {
+    return value.has_value() ? absl::StrCat("[", *value, "]") : "none";
+  };
+  auto bool_to_string = [](bool value) { return value ? "true" : "false"; };
+  return absl::StrCat(
+      "top=", options.top, ";opt_level=", options.opt_level,
+      ";skip_passes=", absl::StrJoin(options.skip_passes, ","),
+      ";convert_array_index_to_select=",
+      optional_to_string(options.convert_array_index_to_select),
+      ";split_next_value_selects=",
+      optional_to_string(options.split_next_value_selects),
+      ";inline_procs=", bool_to_string(options.inline_procs),
+      ";use_context_narrowing_analysis=",
+      bool_to_string(options.use_context_narrowing_analysis),
+      ";pass_list=", optional_to_string(options.pass_list),
+      ";bisect_limit=", optional_to_string(options.bisect_limit),
+      ";incremental_passes=", bool_to_string(options.incremental_passes),
+      ";streaming_unroll_min_trip_count=",
+      optional_to_string(options.streaming_unroll_min_trip_count),
+      ";inlining_cost_threshold=",
+      optional_to_string(options.inlining_cost_threshold),
+      ";select_simplification_query_budget=",
+      optional_to_string(options.select_simplification_query_budget),
+      ";binary_output=", bool_to_string(options.binary_output));
+}
+
+// Cheap structural check of IR read from the cache: it must parse, pass the
+// verifier and contain the expected top.
+absl::Status CheckCachedIr(std::string_view ir, const OptOptions& options) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       ParsePackageFromTextOrBinaryIr(ir, options.ir_path));
+  XLS_RETURN_IF_ERROR(VerifyPackage(package.get()));
+  if (!options.top.empty()) {
+    XLS_RETURN_IF_ERROR(package->SetTopByName(options.top));
+  }
+  XLS_RET_CHECK(package->GetTop().has_value()) << "Cached IR has no top";
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string> RunOptimizationPipeline(std::string_view ir,
+                                                    const OptOptions& options) {
   if (!options.top.empty()) {
     VLOG(3) << "OptimizeIrForEntry; top: '" << options.top
             << "'; opt_level: " << options.opt_level;
@@ -52,7 +106,7 @@ absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
   }
 
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                       Parser::ParsePackage(ir, options.ir_path));
+                       ParsePackageFromTextOrBinaryIr(ir, options.ir_path));
   if (!options.top.empty()) {
     XLS_RETURN_IF_ERROR(package->SetTopByName(options.top));
   }
@@ -83,23 +137,94 @@ absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
       options.convert_array_index_to_select;
   pass_options.split_next_value_selects = options.split_next_value_selects;
   pass_options.ram_rewrites = options.ram_rewrites;
+  pass_options.fifo_depths = options.fifo_depths;
   pass_options.use_context_narrowing_analysis =
       options.use_context_narrowing_analysis;
   pass_options.bisect_limit = options.bisect_limit;
+  pass_options.function_base_threads = options.function_base_threads;
+  pass_options.node_threads = options.node_threads;
+  pass_options.incremental_passes = options.incremental_passes;
+  pass_options.streaming_unroll_min_trip_count =
+      options.streaming_unroll_min_trip_count;
+  pass_options.inlining_cost_threshold = options.inlining_cost_threshold;
+  pass_options.proc_state_simulation_ticks =
+      options.proc_state_simulation_ticks;
+  pass_options.select_simplification_query_budget =
+      options.select_simplification_query_budget;
+  // Share analyses between the passes of the pipeline.
+  QueryEngineCache query_engine_cache;
+  pass_options.query_engine_cache = &query_engine_cache;
   PassResults results;
   XLS_RETURN_IF_ERROR(
       pipeline->Run(package.get(), pass_options, &results).status());
+  if (!options.pass_profile_path.empty()) {
+    XLS_RETURN_IF_ERROR(WritePassProfile(results, options.pass_profile_path));
+  }
+  if (options.binary_output) {
+    return SerializePackageToBinaryIr(*package);
+  }
   return package->DumpIr();
 }
 
+}  // namespace
+
+absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
+                                             const OptOptions& options) {
+  if (options.cache_dir.empty() || !options.ir_dump_path.empty() ||
+      !options.pass_profile_path.empty() || !options.ram_rewrites.empty() ||
+      !options.fifo_depths.empty()) {
+    return RunOptimizationPipeline(ir, options);
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OptCache> cache,
+                       OptCache::Create(options.cache_dir));
+  std::string key = OptCache::ComputeKey(ir, DescribeOptionsForCache(options));
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> cached, cache->Lookup(key));
+  if (cached.has_value()) {
+    absl::Status check = CheckCachedIr(*cached, options);
+    if (check.ok()) {
+      VLOG(1) << "Optimized IR found in cache: " << key;
+      return *std::move(cached);
+    }
+    LOG(WARNING) << "Ignoring optimizer cache entry " << key
+                 << " which fails structural check: " << check;
+  }
+  XLS_ASSIGN_OR_RETURN(std::string optimized_ir,
+                       RunOptimizationPipeline(ir, options));
+  XLS_RETURN_IF_ERROR(cache->Insert(key, optimized_ir));
+  return optimized_ir;
+}
+
+absl::flat_hash_map<std::string, int64_t> FifoDepthsFromChannelActivity(
+    const ProcChannelActivityProto& activity) {
+  absl::flat_hash_map<std::string, int64_t> depths;
+  for (const ProcChannelActivityProto::Channel& channel :
+       activity.channels()) {
+    if (channel.suggested_fifo_depth() <= 0) {
+      continue;
+    }
+    int64_t& depth = depths[channel.name()];
+    depth = std::max(depth, channel.suggested_fifo_depth());
+  }
+  return depths;
+}
+
 absl::StatusOr<std::string> OptimizeIrForTop(
     std::string_view input_path, int64_t opt_level, std::string_view top,
     std::string_view ir_dump_path, absl::Span<const std::string> skip_passes,
     int64_t convert_array_index_to_select, int64_t split_next_value_selects,
     bool inline_procs, std::string_view ram_rewrites_pb,
     bool use_context_narrowing_analysis, std::optional<std::string> pass_list,
-    std::optional<int64_t> bisect_limit) {
-  XLS_ASSIGN_OR_RETURN(std::string ir, GetFileContents(input_path));
+    std::optional<int64_t> bisect_limit, int64_t function_base_threads,
+    int64_t node_threads, bool incremental_passes,
+    std::string_view pass_profile_path, bool binary_output,
+    std::string_view cache_dir, int64_t streaming_unroll_min_trip_count,
+    int64_t inlining_cost_threshold, std::string_view fifo_depths_pb,
+    int64_t proc_state_simulation_ticks,
+    int64_t select_simplification_query_budget) {
+  // Inputs can be very large, so they are parsed in place rather than read
+  // into memory first.
+  XLS_ASSIGN_OR_RETURN(MappedFile ir,
+                       MappedFile::Open(std::filesystem::path(input_path)));
   std::vector<RamRewrite> ram_rewrites;
   if (!ram_rewrites_pb.empty()) {
     RamRewritesProto ram_rewrite_proto;
@@ -107,6 +232,13 @@ absl::StatusOr<std::string> OptimizeIrForTop(
         std::filesystem::path(ram_rewrites_pb), &ram_rewrite_proto));
     XLS_ASSIGN_OR_RETURN(ram_rewrites, RamRewritesFromProto(ram_rewrite_proto));
   }
+  absl::flat_hash_map<std::string, int64_t> fifo_depths;
+  if (!fifo_depths_pb.empty()) {
+    ProcChannelActivityProto activity;
+    XLS_RETURN_IF_ERROR(xls::ParseTextProtoFile(
+        std::filesystem::path(fifo_depths_pb), &activity));
+    fifo_depths = FifoDepthsFromChannelActivity(activity);
+  }
   const OptOptions options = {
       .opt_level = opt_level,
       .top = top,
@@ -123,11 +255,34 @@ absl::StatusOr<std::string> OptimizeIrForTop(
               : std::make_optional(split_next_value_selects),
       .inline_procs = inline_procs,
       .ram_rewrites = std::move(ram_rewrites),
+      .fifo_depths = std::move(fifo_depths),
       .use_context_narrowing_analysis = use_context_narrowing_analysis,
       .pass_list = std::move(pass_list),
       .bisect_limit = bisect_limit,
+      .function_base_threads = function_base_threads,
+      .node_threads = node_threads,
+      .incremental_passes = incremental_passes,
+      .streaming_unroll_min_trip_count =
+          (streaming_unroll_min_trip_count < 0)
+              ? std::nullopt
+              : std::make_optional(streaming_unroll_min_trip_count),
+      .inlining_cost_threshold =
+          (inlining_cost_threshold < 0)
+              ? std::nullopt
+              : std::make_optional(inlining_cost_threshold),
+      .proc_state_simulation_ticks =
+          (proc_state_simulation_ticks < 0)
+              ? std::nullopt
+              : std::make_optional(proc_state_simulation_ticks),
+      .select_simplification_query_budget =
+          (select_simplification_query_budget < 0)
+              ? std::nullopt
+              : std::make_optional(select_simplification_query_budget),
+      .pass_profile_path = std::string(pass_profile_path),
+      .binary_output = binary_output,
+      .cache_dir = std::string(cache_dir),
   };
-  return OptimizeIrForTop(ir, options);
+  return OptimizeIrForTop(ir.contents(), options);
 }
 
 }  // namespace xls::tools
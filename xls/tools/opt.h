@@ -23,11 +23,13 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 
 // TODO(meheff): 2021-10-04 Remove this header.
 #include "absl/types/span.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/tools/proc_channel_activity.pb.h"
 
 namespace xls::tools {
 
@@ -43,14 +45,34 @@ struct OptOptions {
   std::optional<int64_t> split_next_value_selects = std::nullopt;
   bool inline_procs;
   std::vector<RamRewrite> ram_rewrites = {};
+  // Depths to give the FIFOs of streaming channels, keyed by channel name.
+  absl::flat_hash_map<std::string, int64_t> fifo_depths = {};
   bool use_context_narrowing_analysis;
   std::optional<std::string> pass_list;
   std::optional<int64_t> bisect_limit;
+  int64_t function_base_threads = 1;
+  int64_t node_threads = 1;
+  bool incremental_passes = false;
+  std::optional<int64_t> streaming_unroll_min_trip_count = std::nullopt;
+  std::optional<int64_t> inlining_cost_threshold = std::nullopt;
+  std::optional<int64_t> proc_state_simulation_ticks = std::nullopt;
+  std::optional<int64_t> select_simplification_query_budget = std::nullopt;
+  // If non-empty, the per-pass profile of the pipeline run is written here.
+  // See WritePassProfile for the supported formats.
+  std::string pass_profile_path = "";
+  // If true, the optimized package is returned in the binary IR format (see
+  // xls/ir/binary_ir.h) rather than as text.
+  bool binary_output = false;
+  // If non-empty, optimized IR is looked up in and added to the OptCache in
+  // this directory. Runs which produce side outputs (ir_dump_path,
+  // pass_profile_path) or use RAM rewrites or FIFO depths always run the
+  // pipeline.
+  std::string cache_dir = "";
 };
 
 // Helper used in the opt_main tool, optimizes the given IR for a particular
 // top-level entity (e.g., function, proc, etc) at the given opt level and
-// returns the resulting optimized IR.
+// returns the resulting optimized IR. `ir` may be either textual or binary IR.
 absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
                                              const OptOptions& options);
 
@@ -62,7 +84,21 @@ absl::StatusOr<std::string> OptimizeIrForTop(
     int64_t convert_array_index_to_select, int64_t split_next_value_selects,
     bool inline_procs, std::string_view ram_rewrites_pb,
     bool use_context_narrowing_analysis, std::optional<std::string> pass_list,
-    std::optional<int64_t> bisect_limit);
+    std::optional<int64_t> bisect_limit, int64_t function_base_threads,
+    int64_t node_threads, bool incremental_passes,
+    std::string_view pass_profile_path = "", bool binary_output = false,
+    std::string_view cache_dir = "",
+    int64_t streaming_unroll_min_trip_count = -1,
+    int64_t inlining_cost_threshold = -1, std::string_view fifo_depths_pb = "",
+    int64_t proc_state_simulation_ticks = -1,
+    int64_t select_simplification_query_budget = -1);
+
+// Returns the FIFO depths suggested in a ProcChannelActivityProto written by
+// eval_proc_main, keyed by channel name. If a channel appears more than once
+// (one entry per instance of a proc-scoped channel) the largest suggestion is
+// used.
+absl::flat_hash_map<std::string, int64_t> FifoDepthsFromChannelActivity(
+    const ProcChannelActivityProto& activity);
 
 }  // namespace xls::tools
 
@@ -0,0 +1,92 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/opt_cache.h"
+
+#include <cstddef>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/build_embed.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls::tools {
+namespace {
+
+// Bumped whenever the entry format or key derivation changes.
+constexpr std::string_view kFormatVersion = "xls_opt_cache_v1";
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<OptCache>> OptCache::Create(
+    const std::filesystem::path& directory) {
+  XLS_ASSIGN_OR_RETURN(
+      ContentAddressedCache cache,
+      ContentAddressedCache::Create(directory, ".opt", "optimizer cache"));
+  return absl::WrapUnique(new OptCache(std::move(cache)));
+}
+
+/* static */ std::string OptCache::ComputeKey(
+    std::string_view ir, std::string_view options_description) {
+  std::string build_label = GetBuildEmbedLabel();
+  return ContentAddressedCache::ComputeKey(
+      {kFormatVersion, build_label, options_description, ir});
+}
+
+absl::StatusOr<std::optional<std::string>> OptCache::Lookup(
+    std::string_view key) const {
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> contents,
+                       cache_.Lookup(key));
+  if (!contents.has_value()) {
+    return std::nullopt;
+  }
+
+  // Entries are "<format version> <sha256 of ir>\n<ir>".
+  std::string_view view = *contents;
+  size_t newline = view.find('\n');
+  std::string_view header = view.substr(0, newline);
+  std::string_view ir = view.substr(newline + 1);
+  std::string expected_header;
+  if (newline != std::string_view::npos) {
+    expected_header = absl::StrCat(kFormatVersion, " ",
+                                   ContentAddressedCache::Sha256Hex(ir));
+  }
+  if (newline == std::string_view::npos || header != expected_header) {
+    LOG(WARNING) << "Ignoring corrupt optimizer cache entry "
+                 << cache_.GetPath(key);
+    return std::nullopt;
+  }
+  return std::string(ir);
+}
+
+absl::Status OptCache::Insert(std::string_view key,
+                              std::string_view optimized_ir) {
+  return cache_.Insert(
+      key, absl::StrCat(kFormatVersion, " ",
+                        ContentAddressedCache::Sha256Hex(optimized_ir), "\n",
+                        optimized_ir));
+}
+
+}  // namespace xls::tools
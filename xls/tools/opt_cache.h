@@ -0,0 +1,72 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_TOOLS_OPT_CACHE_H_
+#define XLS_TOOLS_OPT_CACHE_H_
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/content_addressed_cache.h"
+
+namespace xls::tools {
+
+// A persistent cache of optimized IR stored in a directory on disk (see
+// ContentAddressedCache). Each entry is keyed on a hash of the input IR, a
+// description of the optimizer options which affect the output (top, opt
+// level, pass list, ...) and the build label of the running binary (see
+// GetBuildEmbedLabel), so a byte-identical package optimized by the same tool
+// maps to the same entry across runs. Binaries built without --embed_label
+// all share an empty label, so their caches should not be shared between
+// versions of the tool.
+//
+// Every entry records a digest of its contents which is checked on lookup, so
+// truncated or otherwise corrupted entries are reported as misses.
+class OptCache {
+ public:
+  // Creates a cache backed by `directory`, creating the directory if it does
+  // not exist.
+  static absl::StatusOr<std::unique_ptr<OptCache>> Create(
+      const std::filesystem::path& directory);
+
+  // Returns the cache key for optimizing `ir` with the options described by
+  // `options_description`.
+  static std::string ComputeKey(std::string_view ir,
+                                std::string_view options_description);
+
+  // Returns the optimized IR cached under `key`, or std::nullopt if there is no
+  // entry or the entry fails its digest check.
+  absl::StatusOr<std::optional<std::string>> Lookup(std::string_view key) const;
+
+  // Stores `optimized_ir` under `key`, replacing any existing entry.
+  absl::Status Insert(std::string_view key, std::string_view optimized_ir);
+
+  const std::filesystem::path& directory() const { return cache_.directory(); }
+
+ private:
+  explicit OptCache(ContentAddressedCache cache) : cache_(std::move(cache)) {}
+
+  ContentAddressedCache cache_;
+};
+
+}  // namespace xls::tools
+
+#endif  // XLS_TOOLS_OPT_CACHE_H_
@@ -0,0 +1,130 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/opt_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/tools/opt.h"
+
+namespace xls::tools {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using testing::HasSubstr;
+using testing::Optional;
+
+constexpr std::string_view kIr = R"(package p
+
+top fn f(x: bits[32]) -> bits[32] {
+  zero: bits[32] = literal(value=0, id=2)
+  ret add.3: bits[32] = add(x, zero, id=3)
+}
+)";
+
+int64_t CountCacheEntries(const std::filesystem::path& directory) {
+  int64_t count = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+    if (entry.path().extension() == ".opt") {
+      ++count;
+    }
+  }
+  return count;
+}
+
+TEST(OptCacheTest, KeyDependsOnIrAndOptions) {
+  std::string key = OptCache::ComputeKey(kIr, "opt_level=3");
+  EXPECT_EQ(key, OptCache::ComputeKey(kIr, "opt_level=3"));
+  EXPECT_NE(key, OptCache::ComputeKey(kIr, "opt_level=2"));
+  EXPECT_NE(key, OptCache::ComputeKey(absl::StrCat(kIr, " "), "opt_level=3"));
+}
+
+TEST(OptCacheTest, InsertAndLookup) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<OptCache> cache,
+                           OptCache::Create(temp_dir.path() / "cache"));
+  EXPECT_THAT(cache->Lookup("abc"), IsOkAndHolds(std::nullopt));
+  XLS_ASSERT_OK(cache->Insert("abc", "optimized"));
+  EXPECT_THAT(cache->Lookup("abc"),
+              IsOkAndHolds(Optional(std::string("optimized"))));
+}
+
+TEST(OptCacheTest, CorruptEntryIsAMiss) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<OptCache> cache,
+                           OptCache::Create(temp_dir.path()));
+  XLS_ASSERT_OK(cache->Insert("abc", "optimized"));
+  std::filesystem::path path = temp_dir.path() / "abc.opt";
+  XLS_ASSERT_OK_AND_ASSIGN(std::string contents, GetFileContents(path));
+  XLS_ASSERT_OK(SetFileContents(path, contents.substr(0, contents.size() - 1)));
+  EXPECT_THAT(cache->Lookup("abc"), IsOkAndHolds(std::nullopt));
+}
+
+TEST(OptCacheTest, OptimizeIrForTopUsesCache) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  OptOptions options = {.top = "f",
+                        .inline_procs = false,
+                        .use_context_narrowing_analysis = false,
+                        .cache_dir = temp_dir.path().string()};
+  XLS_ASSERT_OK_AND_ASSIGN(std::string optimized,
+                           OptimizeIrForTop(kIr, options));
+  EXPECT_THAT(optimized, testing::Not(HasSubstr("add(")));
+  EXPECT_EQ(CountCacheEntries(temp_dir.path()), 1);
+  EXPECT_THAT(OptimizeIrForTop(kIr, options), IsOkAndHolds(optimized));
+  EXPECT_EQ(CountCacheEntries(temp_dir.path()), 1);
+
+  // A different opt level is a different entry.
+  options.opt_level = 1;
+  XLS_ASSERT_OK(OptimizeIrForTop(kIr, options).status());
+  EXPECT_EQ(CountCacheEntries(temp_dir.path()), 2);
+}
+
+TEST(OptCacheTest, EntryFailingStructuralCheckIsRecomputed) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  OptOptions options = {.top = "f",
+                        .inline_procs = false,
+                        .use_context_narrowing_analysis = false,
+                        .cache_dir = temp_dir.path().string()};
+  XLS_ASSERT_OK_AND_ASSIGN(std::string optimized,
+                           OptimizeIrForTop(kIr, options));
+
+  // Replace the entry with well-formed cache data which is not valid IR.
+  std::filesystem::path entry;
+  for (const auto& file :
+       std::filesystem::directory_iterator(temp_dir.path())) {
+    entry = file.path();
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<OptCache> cache,
+                           OptCache::Create(temp_dir.path()));
+  XLS_ASSERT_OK(cache->Insert(entry.stem().string(), "not ir"));
+
+  EXPECT_THAT(OptimizeIrForTop(kIr, options), IsOkAndHolds(optimized));
+  EXPECT_THAT(cache->Lookup(entry.stem().string()),
+              IsOkAndHolds(Optional(optimized)));
+}
+
+}  // namespace
+}  // namespace xls::tools
@@ -93,6 +93,11 @@ ABSL_FLAG(bool, use_context_narrowing_analysis, false,
           "but might produce better results in some circumstances by using "
           "usage context to narrow values more aggressively.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
+ABSL_FLAG(std::string, fifo_depths_pb, "",
+          "Path to a ProcChannelActivityProto text proto, as written by "
+          "eval_proc_main with --channel_activity_sample_size, whose suggested "
+          "FIFO depths are applied to the FIFOs of the streaming channels of "
+          "the same name.");
 ABSL_FLAG(
     std::optional<std::string>, passes, std::nullopt,
     "Explicit list of passes to run in a specific order. Passes are named "
@@ -109,6 +114,53 @@ ABSL_FLAG(
 ABSL_FLAG(std::optional<int64_t>, passes_bisect_limit, std::nullopt,
           "Number of passes to allow to execute. This can be used as compiler "
           "fuel to ensure the compiler finishes at a particular point.");
+ABSL_FLAG(int64_t, function_base_threads, 1,
+          "Number of threads used to run passes on independent functions and "
+          "procs concurrently. The output is the same for any value.");
+ABSL_FLAG(int64_t, node_threads, 1,
+          "Number of threads used by passes which support it (currently cse "
+          "and select_simp) to analyze the nodes of a single large function "
+          "or proc concurrently. The output is the same for any value.");
+ABSL_FLAG(bool, incremental_passes, false,
+          "If true, passes which support it only revisit the nodes changed "
+          "since they last ran on a function or proc, which speeds up "
+          "fixed-point iteration. The output may differ slightly from a full "
+          "run.");
+ABSL_FLAG(int64_t, streaming_unroll_min_trip_count, -1,
+          "If non-negative, counted_for loops with at least this many trips "
+          "are unrolled by inlining and simplifying one iteration at a time, "
+          "which bounds memory use for loops with large trip counts.");
+ABSL_FLAG(int64_t, inlining_cost_threshold, -1,
+          "If non-negative, functions whose inlining at every callsite would "
+          "duplicate more than this many nodes are kept as invokes through the "
+          "mid-level pipeline, optimized once on their own and inlined late.");
+ABSL_FLAG(int64_t, proc_state_simulation_ticks, -1,
+          "If non-negative, the proc state passes simulate each proc for this "
+          "many ticks with random inputs and skip the static analysis of state "
+          "elements which the simulation shows cannot be optimized. The "
+          "output is the same as without simulation.");
+ABSL_FLAG(int64_t, select_simplification_query_budget, -1,
+          "If non-negative, the select simplification pass answers at most "
+          "this many analysis queries per run on a function or proc, which "
+          "bounds its run time on selector-heavy designs. Simplifications "
+          "needing further analysis are skipped and their number is logged.");
+ABSL_FLAG(std::string, pass_profile_path, "",
+          "If specified, write the wall time, CPU time, peak RSS delta and node "
+          "counts of each pass invocation to this path. A path ending in "
+          "'.json' is written as a Chrome trace (viewable in chrome://tracing "
+          "or Perfetto), '.pb' as a binary PassPipelineProfileProto and "
+          "anything else as a text PassPipelineProfileProto.");
+ABSL_FLAG(bool, binary_ir_output, false,
+          "If true, write the optimized package in the binary IR format rather "
+          "than as text. Only packages of functions are supported. The input "
+          "may be either textual or binary IR regardless of this flag.");
+ABSL_FLAG(std::string, opt_cache_dir, "",
+          "If specified, cache optimized IR in this directory keyed on the "
+          "input IR, the options which affect the output and the tool build "
+          "label, and reuse cached results for identical inputs. Cached IR is "
+          "checked to parse and verify before it is used. Ignored when "
+          "--ir_dump_path, --pass_profile_path, --ram_rewrites_pb or "
+          "--fifo_depths_pb is given.");
 ABSL_FLAG(bool, list_passes, false,
           "If passed list the names of all passes and exit.");
 
@@ -171,11 +223,26 @@ absl::Status RealMain(std::string_view input_path) {
       absl::GetFlag(FLAGS_split_next_value_selects);
   bool inline_procs = absl::GetFlag(FLAGS_inline_procs);
   std::string ram_rewrites_pb = absl::GetFlag(FLAGS_ram_rewrites_pb);
+  std::string fifo_depths_pb = absl::GetFlag(FLAGS_fifo_depths_pb);
   bool use_context_narrowing_analysis =
       absl::GetFlag(FLAGS_use_context_narrowing_analysis);
   std::optional<std::string> pass_list = absl::GetFlag(FLAGS_passes);
   std::optional<int64_t> bisect_limit =
       absl::GetFlag(FLAGS_passes_bisect_limit);
+  int64_t function_base_threads = absl::GetFlag(FLAGS_function_base_threads);
+  int64_t node_threads = absl::GetFlag(FLAGS_node_threads);
+  bool incremental_passes = absl::GetFlag(FLAGS_incremental_passes);
+  int64_t streaming_unroll_min_trip_count =
+      absl::GetFlag(FLAGS_streaming_unroll_min_trip_count);
+  int64_t inlining_cost_threshold =
+      absl::GetFlag(FLAGS_inlining_cost_threshold);
+  int64_t proc_state_simulation_ticks =
+      absl::GetFlag(FLAGS_proc_state_simulation_ticks);
+  int64_t select_simplification_query_budget =
+      absl::GetFlag(FLAGS_select_simplification_query_budget);
+  std::string pass_profile_path = absl::GetFlag(FLAGS_pass_profile_path);
+  bool binary_ir_output = absl::GetFlag(FLAGS_binary_ir_output);
+  std::string cache_dir = absl::GetFlag(FLAGS_opt_cache_dir);
 
   XLS_ASSIGN_OR_RETURN(
       std::string opt_ir,
@@ -190,7 +257,20 @@ absl::Status RealMain(std::string_view input_path) {
           /*ram_rewrites_pb=*/ram_rewrites_pb,
           /*use_context_narrowing_analysis=*/use_context_narrowing_analysis,
           /*pass_list=*/pass_list,
-          /*bisect_limit=*/bisect_limit));
+          /*bisect_limit=*/bisect_limit,
+          /*function_base_threads=*/function_base_threads,
+          /*node_threads=*/node_threads,
+          /*incremental_passes=*/incremental_passes,
+          /*pass_profile_path=*/pass_profile_path,
+          /*binary_output=*/binary_ir_output,
+          /*cache_dir=*/cache_dir,
+          /*streaming_unroll_min_trip_count=*/
+          streaming_unroll_min_trip_count,
+          /*inlining_cost_threshold=*/inlining_cost_threshold,
+          /*fifo_depths_pb=*/fifo_depths_pb,
+          /*proc_state_simulation_ticks=*/proc_state_simulation_ticks,
+          /*select_simplification_query_budget=*/
+          select_simplification_query_budget));
 
   if (output_path == "-") {
     std::cout << opt_ir;
@@ -13,8 +13,8 @@
 // limitations under the License.
 
 // Utility which parses files given specified as command-line arguments as XLS
-// IR text. If no argument given reads from stdin. Returns non-zero value on
-// failure and emits failing absl::Status message to stderr.
+// IR (text or binary). If no argument given reads from stdin. Returns non-zero
+// value on failure and emits failing absl::Status message to stderr.
 
 #include <iostream>
 #include <iterator>
@@ -30,13 +30,16 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
-#include "xls/ir/ir_parser.h"
+#include "xls/ir/binary_ir.h"
 #include "xls/ir/package.h"
 #include "xls/ir/verifier.h"
 
 ABSL_FLAG(bool, dump_ir, false,
           "If true, then dump the IR to stdout after parsing.");
 ABSL_FLAG(bool, verify_ir, false, "If true, then verify the IR after parsing.");
+ABSL_FLAG(std::string, binary_ir_output, "",
+          "If non-empty, write the parsed package in the binary IR format to "
+          "this path. Requires exactly one input file.");
 
 namespace xls {
 namespace tools {
@@ -44,21 +47,30 @@ namespace tools {
 static absl::Status RealMain(absl::Span<const std::string_view> args) {
   if (args.empty()) {
     // If no arguments are given, read from stdin.
-    return Parser::ParsePackage(
+    return ParsePackageFromTextOrBinaryIr(
                std::string{std::istreambuf_iterator<char>(std::cin),
                            std::istreambuf_iterator<char>()})
         .status();
   }
+  std::string binary_ir_output = absl::GetFlag(FLAGS_binary_ir_output);
+  if (!binary_ir_output.empty() && args.size() != 1) {
+    return absl::InvalidArgumentError(
+        "--binary_ir_output requires exactly one input file");
+  }
   for (std::string_view arg : args) {
     XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(arg));
     XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> p,
-                         Parser::ParsePackage(contents));
+                         ParsePackageFromTextOrBinaryIr(contents));
     if (absl::GetFlag(FLAGS_dump_ir)) {
       std::cout << p->DumpIr();
     }
     if (absl::GetFlag(FLAGS_verify_ir)) {
       XLS_RETURN_IF_ERROR(VerifyPackage(p.get()));
     }
+    if (!binary_ir_output.empty()) {
+      XLS_ASSIGN_OR_RETURN(std::string binary, SerializePackageToBinaryIr(*p));
+      XLS_RETURN_IF_ERROR(SetFileContents(binary_ir_output, binary));
+    }
   }
   return absl::OkStatus();
 }
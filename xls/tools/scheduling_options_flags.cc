@@ -19,6 +19,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -32,6 +33,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/delay_model/delay_estimators.h"
+#include "xls/fdo/synthesized_delay_cache.h"
 #include "xls/fdo/synthesizer.h"
 #include "xls/ir/package.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -70,6 +72,23 @@ ABSL_FLAG(
     "use the shortest feasible clock period - even if this does not meet the "
     "`--clock_period_ps` target - after printing a warning."
     "Otherwise, will stop with an error if `--clock_period_ps` is infeasible.");
+ABSL_FLAG(int64_t, clock_period_search_threads, 1,
+          "The number of candidate clock periods to evaluate concurrently when "
+          "searching for the shortest feasible clock period. Each thread "
+          "builds its own scheduling model, so memory use grows "
+          "proportionally. Must be >= 1.");
+ABSL_FLAG(int64_t, sdc_partition_node_count, 0,
+          "If positive, the SDC scheduler splits functions with more nodes "
+          "than this into groups of pipeline stages with min-cost cuts and "
+          "schedules each group of at most roughly this many nodes "
+          "independently and concurrently. This is much faster for very large "
+          "functions but may use more pipeline registers than scheduling the "
+          "whole function at once. Procs are always scheduled as a whole.");
+ABSL_FLAG(bool, retime_pipeline, false,
+          "If true, after scheduling, rebalance the pipeline stages by moving "
+          "nodes across stage boundaries (retiming the pipeline registers) "
+          "to minimize the largest estimated stage delay without changing "
+          "the pipeline length.");
 ABSL_FLAG(bool, minimize_worst_case_throughput, false,
           "If true, when `--worst_case_throughput` is not given, search for & "
           "report the best possible worst-case throughput of the circuit "
@@ -150,6 +169,10 @@ ABSL_FLAG(
     "FDO iteration. Must be a positive float <= 1.0.");
 ABSL_FLAG(std::string, fdo_path_evaluate_strategy, "window",
           "Path evaluation strategy for FDO. Supports path, cone, and window.");
+ABSL_FLAG(int64_t, fdo_max_concurrent_synthesis_jobs, 0,
+          "The maximum number of subgraph synthesis jobs in flight at once in "
+          "each FDO iteration. If 0, all subgraphs are synthesized "
+          "concurrently. Must be a non-negative integer.");
 ABSL_FLAG(std::string, fdo_synthesizer_name, "yosys",
           "Name of synthesis backend for FDO. Only supports yosys.");
 ABSL_FLAG(std::string, fdo_yosys_path, "", "Absolute path of yosys.");
@@ -160,6 +183,15 @@ ABSL_FLAG(std::string, fdo_default_driver_cell, "",
           "Cell to assume is driving primary inputs");
 ABSL_FLAG(std::string, fdo_default_load, "",
           "Cell to assume is being driven by primary outputs");
+ABSL_FLAG(std::string, fdo_delay_cache_dir, "",
+          "Directory of a persistent cache of synthesized subgraph delays, "
+          "which may be shared between runs and processes. If empty, delays "
+          "are not cached.");
+ABSL_FLAG(bool, fdo_persistent_synthesis_tools, false,
+          "If true, keep Yosys and OpenSTA processes running between FDO "
+          "subgraph synthesis jobs, with the cell libraries loaded, rather "
+          "than starting them for each job. Up to "
+          "--fdo_max_concurrent_synthesis_jobs of each are kept.");
 // TODO: google/xls#869 - Remove when proc-scoped channels supplant old-style
 // procs.
 ABSL_FLAG(bool, multi_proc, false,
@@ -199,6 +231,9 @@ static absl::StatusOr<bool> SetOptionsFromFlags(
   POPULATE_FLAG(period_relaxation_percent);
   POPULATE_FLAG(minimize_clock_on_failure);
   POPULATE_FLAG(recover_after_minimizing_clock);
+  POPULATE_FLAG(clock_period_search_threads);
+  POPULATE_FLAG(sdc_partition_node_count);
+  POPULATE_FLAG(retime_pipeline);
   POPULATE_FLAG(minimize_worst_case_throughput);
   {
     any_flags_set |= FLAGS_worst_case_throughput.IsSpecifiedOnCommandLine();
@@ -218,12 +253,15 @@ static absl::StatusOr<bool> SetOptionsFromFlags(
   POPULATE_FLAG(fdo_fanout_driven_path_number);
   POPULATE_FLAG(fdo_refinement_stochastic_ratio);
   POPULATE_FLAG(fdo_path_evaluate_strategy);
+  POPULATE_FLAG(fdo_max_concurrent_synthesis_jobs);
   POPULATE_FLAG(fdo_synthesizer_name);
   POPULATE_FLAG(fdo_yosys_path);
   POPULATE_FLAG(fdo_sta_path);
   POPULATE_FLAG(fdo_synthesis_libraries);
   POPULATE_FLAG(fdo_default_driver_cell);
   POPULATE_FLAG(fdo_default_load);
+  POPULATE_FLAG(fdo_delay_cache_dir);
+  POPULATE_FLAG(fdo_persistent_synthesis_tools);
   POPULATE_FLAG(multi_proc);
 #undef POPULATE_FLAG
 #undef POPULATE_REPEATED_FLAG
@@ -290,6 +328,22 @@ static absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
       proto.minimize_clock_on_failure());
   scheduling_options.recover_after_minimizing_clock(
       proto.recover_after_minimizing_clock());
+  if (proto.has_clock_period_search_threads()) {
+    if (proto.clock_period_search_threads() < 1) {
+      return absl::InvalidArgumentError(
+          "clock_period_search_threads must be >= 1");
+    }
+    scheduling_options.clock_period_search_threads(
+        proto.clock_period_search_threads());
+  }
+  if (proto.sdc_partition_node_count() < 0) {
+    return absl::InvalidArgumentError("sdc_partition_node_count must be >= 0");
+  }
+  if (proto.sdc_partition_node_count() != 0) {
+    scheduling_options.sdc_partition_node_count(
+        proto.sdc_partition_node_count());
+  }
+  scheduling_options.retime_pipeline(proto.retime_pipeline());
   if (proto.worst_case_throughput() != 1) {
     scheduling_options.worst_case_throughput(proto.worst_case_throughput());
   }
@@ -445,6 +499,16 @@ static absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
         proto.fdo_path_evaluate_strategy());
   }
 
+  if (proto.has_fdo_max_concurrent_synthesis_jobs()) {
+    if (proto.fdo_max_concurrent_synthesis_jobs() < 0) {
+      return absl::InternalError("max_concurrent_synthesis_jobs must be >= 0");
+    }
+    if (proto.fdo_max_concurrent_synthesis_jobs() > 0) {
+      scheduling_options.fdo_max_concurrent_synthesis_jobs(
+          proto.fdo_max_concurrent_synthesis_jobs());
+    }
+  }
+
   if (proto.has_fdo_synthesizer_name()) {
     scheduling_options.fdo_synthesizer_name(proto.fdo_synthesizer_name());
   }
@@ -455,6 +519,9 @@ static absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
   scheduling_options.fdo_synthesis_libraries(proto.fdo_synthesis_libraries());
   scheduling_options.fdo_default_driver_cell(proto.fdo_default_driver_cell());
   scheduling_options.fdo_default_load(proto.fdo_default_load());
+  scheduling_options.fdo_delay_cache_dir(proto.fdo_delay_cache_dir());
+  scheduling_options.fdo_persistent_synthesis_tools(
+      proto.fdo_persistent_synthesis_tools());
 
   scheduling_options.schedule_all_procs(proto.multi_proc());
 
@@ -482,6 +549,12 @@ absl::StatusOr<synthesis::Synthesizer*> SetUpSynthesizer(
       std::unique_ptr<synthesis::Synthesizer> synthesizer,
       synthesis::GetSynthesizerManagerSingleton().MakeSynthesizer(
           flags.fdo_synthesizer_name(), flags));
+  if (!flags.fdo_delay_cache_dir().empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<synthesis::SynthesizedDelayCache> delay_cache,
+        synthesis::SynthesizedDelayCache::Create(flags.fdo_delay_cache_dir()));
+    synthesizer->set_delay_cache(std::move(delay_cache));
+  }
   return synthesizer.release();
 }
 
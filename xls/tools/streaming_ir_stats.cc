@@ -0,0 +1,375 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/streaming_ir_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/numeric/bits.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/types/span.h"
+#include "xls/common/file/mapped_file.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/ir/binary_ir.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+namespace {
+
+// Collects the statistics of the function bases of one file.
+class StatsAccumulator : public BinaryIrScanVisitor {
+ public:
+  explicit StatsAccumulator(StreamingIrStats& stats) : stats_(stats) {}
+
+  void StartFunction(std::string_view name) override {
+    name_ = name;
+    node_count_ = 0;
+  }
+
+  void VisitNode(Op op, int64_t flat_bit_count) override {
+    AddNode(OpToString(op), flat_bit_count);
+  }
+
+  void AddNode(std::string_view op, int64_t flat_bit_count) {
+    ++node_count_;
+    ++stats_.nodes;
+    auto it = stats_.op_counts.find(op);
+    if (it == stats_.op_counts.end()) {
+      stats_.op_counts.emplace(std::string(op), 1);
+    } else {
+      ++it->second;
+    }
+    ++stats_.bit_count_histogram[flat_bit_count];
+  }
+
+  void EndFunction() override {
+    ++stats_.function_bases;
+    ++stats_.function_size_histogram[static_cast<int64_t>(
+        absl::bit_ceil(static_cast<uint64_t>(node_count_)))];
+    if (node_count_ > stats_.largest_function_nodes) {
+      stats_.largest_function_nodes = node_count_;
+      stats_.largest_function = name_;
+    }
+  }
+
+ private:
+  StreamingIrStats& stats_;
+  std::string name_;
+  int64_t node_count_ = 0;
+};
+
+bool ConsumePrefix(std::string_view& s, std::string_view prefix) {
+  if (!s.starts_with(prefix)) {
+    return false;
+  }
+  s.remove_prefix(prefix.size());
+  return true;
+}
+
+// Consumes a decimal number followed by `]` from the front of `s`.
+std::optional<int64_t> ConsumeBracketedNumber(std::string_view& s) {
+  size_t end = s.find(']');
+  int64_t value;
+  if (end == std::string_view::npos ||
+      !absl::SimpleAtoi(s.substr(0, end), &value)) {
+    return std::nullopt;
+  }
+  s.remove_prefix(end + 1);
+  return value;
+}
+
+// Consumes a type in the IR text syntax (e.g. `(bits[1], bits[8][4])`) from
+// the front of `s` and returns its flat bit count.
+std::optional<int64_t> ConsumeFlatBitCount(std::string_view& s) {
+  std::optional<int64_t> result;
+  if (ConsumePrefix(s, "token")) {
+    result = 0;
+  } else if (ConsumePrefix(s, "bits[")) {
+    result = ConsumeBracketedNumber(s);
+  } else if (ConsumePrefix(s, "(")) {
+    result = 0;
+    if (!ConsumePrefix(s, ")")) {
+      while (true) {
+        std::optional<int64_t> element = ConsumeFlatBitCount(s);
+        if (!element.has_value()) {
+          return std::nullopt;
+        }
+        *result += *element;
+        if (ConsumePrefix(s, ")")) {
+          break;
+        }
+        if (!ConsumePrefix(s, ", ")) {
+          return std::nullopt;
+        }
+      }
+    }
+  }
+  while (result.has_value() && ConsumePrefix(s, "[")) {
+    std::optional<int64_t> size = ConsumeBracketedNumber(s);
+    if (!size.has_value()) {
+      return std::nullopt;
+    }
+    *result *= *size;
+  }
+  return result;
+}
+
+// Returns the text between the bracket at the front of `s` and its matching
+// close bracket, or std::nullopt if it is unbalanced.
+std::optional<std::string_view> BracketedGroup(std::string_view s) {
+  int64_t depth = 0;
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (s[i] == '(' || s[i] == '[' || s[i] == '{' || s[i] == '<') {
+      ++depth;
+    } else if (s[i] == ')' || s[i] == ']' || s[i] == '}' || s[i] == '>') {
+      if (--depth == 0) {
+        return s.substr(1, i - 1);
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+// Splits `s` at commas which are not nested in brackets.
+std::vector<std::string_view> SplitTopLevel(std::string_view s) {
+  std::vector<std::string_view> pieces;
+  int64_t depth = 0;
+  size_t start = 0;
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (s[i] == '(' || s[i] == '[' || s[i] == '{') {
+      ++depth;
+    } else if (s[i] == ')' || s[i] == ']' || s[i] == '}') {
+      --depth;
+    } else if (s[i] == ',' && depth == 0) {
+      pieces.push_back(absl::StripAsciiWhitespace(s.substr(start, i - start)));
+      start = i + 1;
+    }
+  }
+  pieces.push_back(absl::StripAsciiWhitespace(s.substr(start)));
+  return pieces;
+}
+
+// Handles a function, proc or block header line such as
+// `top fn f(x: bits[32]) -> bits[32] {`. Returns false if `line` is not one.
+bool ScanHeader(std::string_view line, StatsAccumulator& accumulator) {
+  ConsumePrefix(line, "top ");
+  bool is_block = false;
+  if (!ConsumePrefix(line, "fn ") && !ConsumePrefix(line, "proc ")) {
+    if (!ConsumePrefix(line, "block ")) {
+      return false;
+    }
+    is_block = true;
+  }
+  if (!line.ends_with("{")) {
+    return false;
+  }
+  size_t name_end = line.find_first_of("(<");
+  if (name_end == std::string_view::npos) {
+    return false;
+  }
+  accumulator.StartFunction(line.substr(0, name_end));
+  line.remove_prefix(name_end);
+  if (line.starts_with("<")) {
+    // Skip the channel interface of a new-style proc.
+    std::optional<std::string_view> interface = BracketedGroup(line);
+    if (!interface.has_value()) {
+      return true;
+    }
+    line.remove_prefix(interface->size() + 2);
+  }
+  // Block ports are not nodes; their input_port/output_port nodes are listed
+  // in the body.
+  std::optional<std::string_view> params = BracketedGroup(line);
+  if (is_block || !params.has_value() || params->empty()) {
+    return true;
+  }
+  for (std::string_view param : SplitTopLevel(*params)) {
+    size_t colon = param.find(": ");
+    if (param.starts_with("init=") || colon == std::string_view::npos) {
+      continue;
+    }
+    std::string_view type = param.substr(colon + 2);
+    accumulator.AddNode("param", ConsumeFlatBitCount(type).value_or(0));
+  }
+  return true;
+}
+
+// Handles a node definition line such as `ret add.3: bits[32] = add(x, y)`.
+void ScanNode(std::string_view line, StatsAccumulator& accumulator) {
+  ConsumePrefix(line, "ret ");
+  size_t colon = line.find(": ");
+  if (colon == std::string_view::npos ||
+      line.substr(0, colon).find(' ') != std::string_view::npos) {
+    return;
+  }
+  line.remove_prefix(colon + 2);
+  std::optional<int64_t> flat_bit_count = ConsumeFlatBitCount(line);
+  if (!flat_bit_count.has_value() || !ConsumePrefix(line, " = ")) {
+    return;
+  }
+  size_t op_end = line.find('(');
+  // A parameter returned directly is listed again in the body as a `param`
+  // line; it was already counted from the signature.
+  if (op_end == std::string_view::npos || op_end == 0 ||
+      line.substr(0, op_end) == "param") {
+    return;
+  }
+  accumulator.AddNode(line.substr(0, op_end), *flat_bit_count);
+}
+
+absl::Status ScanIrTextForStats(std::string_view text,
+                                StreamingIrStats& stats) {
+  StatsAccumulator accumulator(stats);
+  bool in_body = false;
+  for (std::string_view line : absl::StrSplit(text, '\n')) {
+    line = absl::StripAsciiWhitespace(line);
+    if (!in_body) {
+      in_body = ScanHeader(line, accumulator);
+      continue;
+    }
+    if (line == "}") {
+      accumulator.EndFunction();
+      in_body = false;
+      continue;
+    }
+    // Channel, instantiation and register declarations and old-style proc
+    // next-state lines are not nodes.
+    if (line.starts_with("chan ") || line.starts_with("proc_instantiation ") ||
+        line.starts_with("instantiation ") || line.starts_with("reg ") ||
+        line.starts_with("next (")) {
+      continue;
+    }
+    ScanNode(line, accumulator);
+  }
+  XLS_RET_CHECK(!in_body) << "IR text ends inside a function body";
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+void StreamingIrStats::Merge(const StreamingIrStats& other) {
+  files += other.files;
+  failed_files += other.failed_files;
+  function_bases += other.function_bases;
+  nodes += other.nodes;
+  for (const auto& [op, count] : other.op_counts) {
+    op_counts[op] += count;
+  }
+  for (const auto& [bit_count, count] : other.bit_count_histogram) {
+    bit_count_histogram[bit_count] += count;
+  }
+  for (const auto& [size, count] : other.function_size_histogram) {
+    function_size_histogram[size] += count;
+  }
+  if (other.largest_function_nodes > largest_function_nodes) {
+    largest_function_nodes = other.largest_function_nodes;
+    largest_function = other.largest_function;
+  }
+}
+
+std::string StreamingIrStats::ToString() const {
+  std::string result = absl::StrFormat(
+      "Files: %d (%d failed)\nFunction bases: %d\nNodes: %d\n", files,
+      failed_files, function_bases, nodes);
+  if (function_bases > 0) {
+    absl::StrAppendFormat(&result, "Largest function: %s (%d nodes)\n",
+                          largest_function, largest_function_nodes);
+  }
+  absl::StrAppend(&result, "Op counts:\n");
+  for (const auto& [op, count] : op_counts) {
+    absl::StrAppendFormat(&result, "  %s: %d\n", op, count);
+  }
+  absl::StrAppend(&result, "Node bit counts:\n");
+  for (const auto& [bit_count, count] : bit_count_histogram) {
+    absl::StrAppendFormat(&result, "  %d: %d\n", bit_count, count);
+  }
+  absl::StrAppend(&result, "Function sizes (nodes):\n");
+  for (const auto& [size, count] : function_size_histogram) {
+    absl::StrAppendFormat(&result, "  <= %d: %d\n", size, count);
+  }
+  return result;
+}
+
+absl::Status ScanIrForStats(std::string_view contents,
+                            StreamingIrStats& stats) {
+  // Scan into a scratch copy so a failure part way through a file leaves
+  // `stats` untouched.
+  StreamingIrStats file_stats;
+  if (IsBinaryIr(contents)) {
+    StatsAccumulator accumulator(file_stats);
+    XLS_RETURN_IF_ERROR(ScanBinaryIr(contents, accumulator));
+  } else {
+    XLS_RETURN_IF_ERROR(ScanIrTextForStats(contents, file_stats));
+  }
+  file_stats.files = 1;
+  stats.Merge(file_stats);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<StreamingIrStats> ScanIrFilesForStats(
+    absl::Span<const std::filesystem::path> paths, int64_t thread_count) {
+  XLS_RET_CHECK_GE(thread_count, 1);
+  thread_count = std::max<int64_t>(
+      1, std::min<int64_t>(thread_count, static_cast<int64_t>(paths.size())));
+  std::vector<StreamingIrStats> thread_stats(thread_count);
+  std::atomic<int64_t> next = 0;
+  auto worker = [&](StreamingIrStats& stats) {
+    for (int64_t i = next++; i < paths.size(); i = next++) {
+      absl::Status status = [&]() -> absl::Status {
+        XLS_ASSIGN_OR_RETURN(MappedFile file, MappedFile::Open(paths[i]));
+        return ScanIrForStats(file.contents(), stats);
+      }();
+      if (!status.ok()) {
+        LOG(WARNING) << "Unable to scan " << paths[i] << ": " << status;
+        ++stats.files;
+        ++stats.failed_files;
+      }
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count - 1);
+  for (int64_t i = 1; i < thread_count; ++i) {
+    threads.push_back(
+        std::make_unique<Thread>([&, i]() { worker(thread_stats[i]); }));
+  }
+  worker(thread_stats[0]);
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  StreamingIrStats result;
+  for (const StreamingIrStats& stats : thread_stats) {
+    result.Merge(stats);
+  }
+  return result;
+}
+
+}  // namespace xls
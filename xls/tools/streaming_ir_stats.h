@@ -0,0 +1,77 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Summary statistics of IR files gathered by scanning the IR text or binary
+// format directly, without parsing it into a Package. This is much cheaper
+// than building every node and is intended for surveys over many archived IR
+// files, e.g. by `ir_stats_main --streaming`.
+
+#ifndef XLS_TOOLS_STREAMING_IR_STATS_H_
+#define XLS_TOOLS_STREAMING_IR_STATS_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <string_view>
+
+#include "absl/container/btree_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+
+namespace xls {
+
+// Statistics aggregated over any number of IR files. The memory used is
+// bounded by the number of distinct ops and widths, not by the size or number
+// of the files.
+struct StreamingIrStats {
+  int64_t files = 0;
+  // Files which could not be read or scanned. These contribute nothing else.
+  int64_t failed_files = 0;
+  // Functions, procs and blocks.
+  int64_t function_bases = 0;
+  int64_t nodes = 0;
+  // Number of nodes of each op, keyed by op name (e.g. "add").
+  absl::btree_map<std::string, int64_t> op_counts;
+  // Number of nodes with each flat bit count.
+  absl::btree_map<int64_t, int64_t> bit_count_histogram;
+  // Number of function bases by node count, bucketed by the next power of two
+  // (i.e., bucket N holds sizes in (N/2, N]).
+  absl::btree_map<int64_t, int64_t> function_size_histogram;
+  // The largest function base seen.
+  std::string largest_function;
+  int64_t largest_function_nodes = 0;
+
+  // Adds the counts of `other` to this.
+  void Merge(const StreamingIrStats& other);
+
+  // Returns a human readable report.
+  std::string ToString() const;
+};
+
+// Adds the statistics of the IR `contents`, which may be textual or binary IR,
+// to `stats`. Text is scanned line by line; lines which are not node
+// definitions are skipped, so this does not validate the IR.
+absl::Status ScanIrForStats(std::string_view contents, StreamingIrStats& stats);
+
+// Scans the files at `paths` on (at most) `thread_count` threads and returns
+// the combined statistics. Files are memory-mapped rather than read into
+// memory. Files which fail to scan are counted in `failed_files` and logged.
+absl::StatusOr<StreamingIrStats> ScanIrFilesForStats(
+    absl::Span<const std::filesystem::path> paths, int64_t thread_count = 1);
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_STREAMING_IR_STATS_H_
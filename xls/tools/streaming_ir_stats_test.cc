@@ -0,0 +1,161 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/streaming_ir_stats.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/binary_ir.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+constexpr std::string_view kFunctionsIr = R"(package test
+
+fn square(x: bits[8]) -> bits[8] {
+  ret umul.2: bits[8] = umul(x, x, id=2)
+}
+
+top fn main(a: bits[8][4], i: bits[2], t: (bits[1], bits[8])) -> (bits[8], bits[16]) {
+  array_index.4: bits[8] = array_index(a, indices=[i], id=4, pos=[(0,1,2)])
+  invoke.5: bits[8] = invoke(array_index.4, to_apply=square, id=5)
+  tuple_index.6: bits[8] = tuple_index(t, index=1, id=6)
+  concat.7: bits[16] = concat(invoke.5, tuple_index.6, id=7)
+  ret tuple.8: (bits[8], bits[16]) = tuple(invoke.5, concat.7, id=8)
+}
+)";
+
+// Returns the statistics gathered by parsing `ir` into a package.
+StreamingIrStats StatsFromPackage(Package& package) {
+  StreamingIrStats stats;
+  stats.files = 1;
+  for (FunctionBase* f : package.GetFunctionBases()) {
+    ++stats.function_bases;
+    stats.nodes += f->node_count();
+    for (Node* node : f->nodes()) {
+      ++stats.op_counts[OpToString(node->op())];
+      ++stats.bit_count_histogram[node->GetType()->GetFlatBitCount()];
+    }
+  }
+  return stats;
+}
+
+TEST(StreamingIrStatsTest, TextMatchesParsedPackage) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kFunctionsIr));
+  StreamingIrStats expected = StatsFromPackage(*package);
+
+  StreamingIrStats stats;
+  XLS_ASSERT_OK(ScanIrForStats(kFunctionsIr, stats));
+  EXPECT_EQ(stats.files, 1);
+  EXPECT_EQ(stats.function_bases, expected.function_bases);
+  EXPECT_EQ(stats.nodes, expected.nodes);
+  EXPECT_EQ(stats.op_counts, expected.op_counts);
+  EXPECT_EQ(stats.bit_count_histogram, expected.bit_count_histogram);
+  EXPECT_THAT(stats.function_size_histogram,
+              UnorderedElementsAre(Pair(2, 1), Pair(8, 1)));
+  EXPECT_EQ(stats.largest_function, "main");
+  EXPECT_EQ(stats.largest_function_nodes, 8);
+}
+
+TEST(StreamingIrStatsTest, BinaryMatchesText) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kFunctionsIr));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           SerializePackageToBinaryIr(*package));
+  StreamingIrStats text_stats;
+  StreamingIrStats binary_stats;
+  XLS_ASSERT_OK(ScanIrForStats(kFunctionsIr, text_stats));
+  XLS_ASSERT_OK(ScanIrForStats(binary, binary_stats));
+  EXPECT_EQ(binary_stats.ToString(), text_stats.ToString());
+}
+
+TEST(StreamingIrStatsTest, ProcsAndBlocks) {
+  constexpr std::string_view kIr = R"(package test
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="""""")
+
+top proc acc(x: bits[32], init={0}) {
+  tkn: token = literal(value=token, id=1)
+  rcv: (token, bits[32]) = receive(tkn, channel=in, id=2)
+  rcv_data: bits[32] = tuple_index(rcv, index=1, id=3)
+  next_x: bits[32] = add(x, rcv_data, id=4)
+  next (next_x)
+}
+
+block my_block(clk: clock, a: bits[32], out: bits[32]) {
+  reg r(bits[32])
+  a: bits[32] = input_port(name=a, id=5)
+  r_q: bits[32] = register_read(register=r, id=6)
+  r_d: () = register_write(a, register=r, id=7)
+  out: () = output_port(r_q, name=out, id=8)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kIr));
+  StreamingIrStats expected = StatsFromPackage(*package);
+
+  StreamingIrStats stats;
+  XLS_ASSERT_OK(ScanIrForStats(kIr, stats));
+  EXPECT_EQ(stats.function_bases, 2);
+  EXPECT_EQ(stats.nodes, expected.nodes);
+  EXPECT_EQ(stats.op_counts, expected.op_counts);
+  EXPECT_EQ(stats.bit_count_histogram, expected.bit_count_histogram);
+}
+
+TEST(StreamingIrStatsTest, ScanFilesInParallel) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::vector<std::filesystem::path> paths;
+  for (int64_t i = 0; i < 10; ++i) {
+    paths.push_back(temp_dir.path() / absl::StrCat("f", i, ".ir"));
+    XLS_ASSERT_OK(SetFileContents(paths.back(), kFunctionsIr));
+  }
+  paths.push_back(temp_dir.path() / "truncated.ir");
+  XLS_ASSERT_OK(SetFileContents(paths.back(), kFunctionsIr.substr(0, 60)));
+  paths.push_back(temp_dir.path() / "missing.ir");
+
+  StreamingIrStats single_file;
+  XLS_ASSERT_OK(ScanIrForStats(kFunctionsIr, single_file));
+  for (int64_t thread_count : {1, 4}) {
+    XLS_ASSERT_OK_AND_ASSIGN(StreamingIrStats stats,
+                             ScanIrFilesForStats(paths, thread_count));
+    EXPECT_EQ(stats.files, 12);
+    EXPECT_EQ(stats.failed_files, 2);
+    EXPECT_EQ(stats.nodes, 10 * single_file.nodes);
+    EXPECT_EQ(stats.op_counts.at("invoke"), 10);
+  }
+}
+
+}  // namespace
+}  // namespace xls
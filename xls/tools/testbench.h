@@ -15,19 +15,30 @@
 #ifndef XLS_TOOLS_TESTBENCH_H_
 #define XLS_TOOLS_TESTBENCH_H_
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <system_error>  // NOLINT
 #include <thread>  // NOLINT(build/c++11)
+#include <tuple>
 #include <type_traits>
 #include <vector>
 
 #include "absl/base/internal/sysinfo.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_format.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/tools/testbench_shard.h"
+#include "xls/tools/testbench_shard.pb.h"
 #include "xls/tools/testbench_thread.h"
 
 namespace xls {
@@ -39,10 +50,18 @@ namespace xls {
 // periodically printed to the terminal, as this class' primary use is for
 // exploring large test spaces.
 //
-// Presently, work is parititioned uniformly across threads at startup. This can
-// lead to work imbalance if certain areas of the input space execute faster
-// than others. More advanced strategies can be explored in the future if this
-// becomes a problem.
+// Work is handed out dynamically: each thread repeatedly claims the next small
+// chunk of the input space from a shared counter, so threads which land on
+// quickly-evaluated regions of the space simply claim more chunks rather than
+// sitting idle while another grinds through a slow region. Every index in
+// [start, end) is evaluated exactly once (absent cancellation), so the set of
+// results is the same from run to run regardless of the thread count.
+//
+// Spaces too large for one machine can be split into shards (see SetShard())
+// which are run independently, e.g. on different machines. Each shard can
+// checkpoint its progress and mismatches to a file (see SetCheckpointPath())
+// from which an interrupted run resumes, and testbench_merge_main combines the
+// files of all shards into a final report.
 
 namespace internal {
 // Forward decl of common Testbench base class.
@@ -75,6 +94,11 @@ class Testbench : public internal::TestbenchBase<InputT, ResultT, ShardDataT> {
   //                     are considered equivalent.
   //   log_errors      : The function to log errors when compare_results returns
   //                     false.
+  //   compute_actual_batch: Optional. If given, used in place of
+  //                     compute_actual to calculate the XLS results for a block
+  //                     of inputs at once (e.g. with a JIT wrapper's
+  //                     RunBatched), writing them to the span of results,
+  //                     which has the same size as the span of inputs.
   //
   // All lambdas must be thread-safe.
   //
@@ -89,18 +113,24 @@ class Testbench : public internal::TestbenchBase<InputT, ResultT, ShardDataT> {
             std::function<ResultT(ShardDataT*, InputT)> compute_expected,
             std::function<ResultT(ShardDataT*, InputT)> compute_actual,
             std::function<bool(ResultT, ResultT)> compare_results,
-            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+            std::function<void(ShardDataT*, absl::Span<const InputT>,
+                               absl::Span<ResultT>)>
+                compute_actual_batch = nullptr)
       : internal::TestbenchBase<InputT, ResultT, ShardDataT>(
             start, end, num_threads, max_failures, index_to_input,
             compare_results, log_errors),
         create_shard_(create_shard),
         compute_expected_(compute_expected),
-        compute_actual_(compute_actual) {
-    this->thread_create_fn_ = [this](uint64_t start, uint64_t end) {
+        compute_actual_(compute_actual),
+        compute_actual_batch_(compute_actual_batch) {
+    this->thread_create_fn_ = [this]() {
       return std::make_unique<TestbenchThread<InputT, ResultT, ShardDataT>>(
-          &this->mutex_, &this->wake_me_, start, end, this->max_failures_,
+          &this->mutex_, &this->wake_me_, &this->next_index_, this->end_,
+          this->chunk_size_, this->max_failures_,
           this->index_to_input_, create_shard_, compute_expected_,
-          compute_actual_, this->compare_results_, this->log_errors_);
+          compute_actual_, this->compare_results_, this->log_errors_,
+          compute_actual_batch_);
     };
   }
 
@@ -108,6 +138,9 @@ class Testbench : public internal::TestbenchBase<InputT, ResultT, ShardDataT> {
   std::function<std::unique_ptr<ShardDataT>()> create_shard_;
   std::function<ResultT(ShardDataT*, InputT)> compute_expected_;
   std::function<ResultT(ShardDataT*, InputT)> compute_actual_;
+  std::function<void(ShardDataT*, absl::Span<const InputT>,
+                     absl::Span<ResultT>)>
+      compute_actual_batch_;
 };
 
 // Shard-data-less implementation.
@@ -122,23 +155,29 @@ class Testbench<InputT, ResultT, ShardDataT,
             std::function<ResultT(InputT)> compute_expected,
             std::function<ResultT(InputT)> compute_actual,
             std::function<bool(ResultT, ResultT)> compare_results,
-            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+            std::function<void(absl::Span<const InputT>, absl::Span<ResultT>)>
+                compute_actual_batch = nullptr)
       : internal::TestbenchBase<InputT, ResultT, ShardDataT>(
             start, end, num_threads, max_failures, index_to_input,
             compare_results, log_errors),
         compute_expected_(compute_expected),
-        compute_actual_(compute_actual) {
-    this->thread_create_fn_ = [this](uint64_t start, uint64_t end) {
+        compute_actual_(compute_actual),
+        compute_actual_batch_(compute_actual_batch) {
+    this->thread_create_fn_ = [this]() {
       return std::make_unique<TestbenchThread<InputT, ResultT, ShardDataT>>(
-          &this->mutex_, &this->wake_me_, start, end, this->max_failures_,
+          &this->mutex_, &this->wake_me_, &this->next_index_, this->end_,
+          this->chunk_size_, this->max_failures_,
           this->index_to_input_, compute_expected_, compute_actual_,
-          this->compare_results_, this->log_errors_);
+          this->compare_results_, this->log_errors_, compute_actual_batch_);
     };
   }
 
  private:
   std::function<ResultT(InputT)> compute_expected_;
   std::function<ResultT(InputT)> compute_actual_;
+  std::function<void(absl::Span<const InputT>, absl::Span<ResultT>)>
+      compute_actual_batch_;
 };
 
 // INTERNAL IMPL ---------------------------------
@@ -158,11 +197,21 @@ class TestbenchBase {
         num_threads_(num_threads),
         start_(start),
         end_(end),
+        space_start_(start),
+        space_end_(end),
+        shard_index_(0),
+        num_shards_(1),
+        chunk_size_(1),
+        next_index_(start),
         max_failures_(max_failures),
         num_samples_processed_(0),
         index_to_input_(index_to_input),
         compare_results_(compare_results),
-        log_errors_(log_errors) {}
+        log_errors_([this, log_errors](int64_t index, InputT input,
+                                       ResultT expected, ResultT actual) {
+          RecordMismatch(index);
+          log_errors(index, input, expected, actual);
+        }) {}
 
   // Sets the number of threads to use. Must be called before Run().
   absl::Status SetNumThreads(int num_threads) {
@@ -175,6 +224,65 @@ class TestbenchBase {
     return absl::OkStatus();
   }
 
+  // Restricts execution to shard `shard_index` of `num_shards`: a contiguous
+  // range of [start, end) which, together with the ranges of the other shards,
+  // partitions the space (see TestbenchShardRange()). Must be called before
+  // SetCheckpointPath() and Run().
+  absl::Status SetShard(int64_t shard_index, int64_t num_shards) {
+    absl::MutexLock lock(&mutex_);
+    if (started_ || checkpoint_path_.has_value()) {
+      return absl::FailedPreconditionError(
+          "The shard must be set before checkpointing or starting execution.");
+    }
+    if (num_shards <= 0 || shard_index < 0 || shard_index >= num_shards) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid shard %d of %d.", shard_index, num_shards));
+    }
+    shard_index_ = shard_index;
+    num_shards_ = num_shards;
+    std::tie(start_, end_) =
+        TestbenchShardRange(space_start_, space_end_, shard_index, num_shards);
+    next_index_.store(start_);
+    return absl::OkStatus();
+  }
+
+  // Periodically writes the progress and mismatches of this testbench (or
+  // shard) to `path` as a binary TestbenchShardProto. If `path` already holds
+  // the record of an earlier run of the same shard, execution resumes where
+  // that run left off. Must be called before Run().
+  absl::Status SetCheckpointPath(const std::filesystem::path& path) {
+    absl::MutexLock lock(&mutex_);
+    if (started_) {
+      return absl::FailedPreconditionError(
+          "Can't set the checkpoint path after starting execution.");
+    }
+    checkpoint_path_ = path;
+    absl::Status exists = FileExists(path);
+    if (absl::IsNotFound(exists)) {
+      return absl::OkStatus();
+    }
+    XLS_RETURN_IF_ERROR(exists);
+
+    TestbenchShardProto record;
+    XLS_RETURN_IF_ERROR(ParseProtobinFile(path, &record));
+    if (record.shard_index() != shard_index_ ||
+        record.num_shards() != num_shards_ || record.start() != space_start_ ||
+        record.end() != space_end_) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Checkpoint %s is for shard %d of %d over [%d, %d), not shard %d of "
+          "%d over [%d, %d).",
+          path.string(), record.shard_index(), record.num_shards(),
+          record.start(), record.end(), shard_index_, num_shards_,
+          space_start_, space_end_));
+    }
+    start_ = std::clamp<uint64_t>(record.completed_end(), start_, end_);
+    next_index_.store(start_);
+    absl::MutexLock mismatch_lock(&mismatch_mutex_);
+    mismatch_indices_.assign(record.mismatch_indices().begin(),
+                             record.mismatch_indices().end());
+    return absl::OkStatus();
+  }
+
   // Executes the test.
   absl::Status Run() {
     // Lock before spawning threads to prevent missing any early wakeup signals
@@ -182,24 +290,17 @@ class TestbenchBase {
     mutex_.Lock();
     started_ = true;
 
-    // Set up all the workers.
-    uint64_t chunk_size = (end_ - start_) / num_threads_;
-    uint64_t chunk_remainder =
-        chunk_size == 0 ? (end_ - start_) : (end_ - start_) % chunk_size;
-    uint64_t first = 0;
-    uint64_t last;
+    // Set up all the workers. Chunks are small enough that each thread claims
+    // many of them (so the tail of the run stays balanced), but large enough
+    // that contention on the shared counter is negligible.
+    chunk_size_ = std::clamp<uint64_t>(
+        (end_ - start_) / (static_cast<uint64_t>(num_threads_) *
+                           kMinChunksPerThread),
+        1, kMaxChunkSize);
+    next_index_.store(start_);
     for (int i = 0; i < num_threads_; i++) {
-      last = first + chunk_size;
-      // Distribute any remainder evenly amongst the threads.
-      if (chunk_remainder > 0) {
-        last++;
-        chunk_remainder--;
-      }
-
-      threads_.push_back(thread_create_fn_(first, last));
+      threads_.push_back(thread_create_fn_());
       threads_.back()->Run();
-
-      first = last + 1;
     }
 
     // Wait for all to be ready.
@@ -224,12 +325,14 @@ class TestbenchBase {
     }
 
     // Now monitor them.
+    absl::Status checkpoint_status;
     bool done = false;
     while (!done) {
       int64_t num_done = 0;
       wake_me_.WaitWithTimeout(&mutex_, kPrintInterval);
 
       PrintStatus();
+      checkpoint_status.Update(WriteCheckpoint());
 
       // See if everyone's done or if someone blew up.
       for (int64_t i = 0; i < threads_.size(); i++) {
@@ -256,11 +359,21 @@ class TestbenchBase {
       threads_[i]->Join();
     }
 
+    checkpoint_status.Update(WriteCheckpoint());
+    XLS_RETURN_IF_ERROR(checkpoint_status);
+
+    bool any_mismatch;
+    {
+      // Includes mismatches found by a run this one resumed from.
+      absl::MutexLock lock(&mismatch_mutex_);
+      any_mismatch = !mismatch_indices_.empty();
+    }
     for (int i = 0; i < threads_.size(); i++) {
-      if (threads_[i]->num_failures() != 0) {
-        return absl::InternalError(
-            "There was at least one mismatch during execution.");
-      }
+      any_mismatch |= threads_[i]->num_failures() != 0;
+    }
+    if (any_mismatch) {
+      return absl::InternalError(
+          "There was at least one mismatch during execution.");
     }
 
     return absl::OkStatus();
@@ -270,37 +383,37 @@ class TestbenchBase {
   // How many seconds to wait before printing status (at most).
   static constexpr absl::Duration kPrintInterval = absl::Seconds(5);
 
+  // Bounds on the number of indices a worker claims at a time: at most
+  // kMaxChunkSize, and small enough to give each worker at least
+  // kMinChunksPerThread chunks when the space allows it.
+  static constexpr uint64_t kMaxChunkSize = 4096;
+  static constexpr uint64_t kMinChunksPerThread = 64;
+
   // Prints the current execution status across all threads.
   void PrintStatus() {
-    // Get the remainder-adjusted chunk size for this thread.
-    auto thread_chunk_size = [this](int thread_index) {
-      uint64_t total_size = end_ - start_;
-      uint64_t chunk_size = total_size / threads_.size();
-      uint64_t remainder =
-          chunk_size == 0 ? total_size : total_size % chunk_size;
-      if (thread_index < remainder) {
-        chunk_size++;
-      }
-      return chunk_size;
-    };
-
-    // Ignore remainder issues here. It shouldn't matter much at all.
     absl::Time now = absl::Now();
     auto delta = now - start_time_;
+    uint64_t total_size = end_ - start_;
     uint64_t total_done = 0;
     for (int64_t i = 0; i < threads_.size(); ++i) {
       uint64_t num_passes = threads_[i]->num_passes();
       uint64_t num_failures = threads_[i]->num_failures();
       uint64_t thread_done = num_passes + num_failures;
-      uint64_t chunk_size = thread_chunk_size(i);
       total_done += thread_done;
       std::cout << absl::StreamFormat(
-                       "thread %02d: %f%% @ %.1f us/sample :: failures %d", i,
-                       static_cast<double>(thread_done) / chunk_size * 100.0,
+                       "thread %02d: %d samples @ %.1f us/sample :: failures "
+                       "%d",
+                       i, thread_done,
                        absl::ToDoubleMicroseconds(delta) / thread_done,
                        num_failures)
                 << "\n";
     }
+    std::cout << absl::StreamFormat(
+                     "--- %f%% complete",
+                     total_size == 0 ? 100.0
+                                     : static_cast<double>(total_done) /
+                                           total_size * 100.0)
+              << "\n";
     double done_per_second = delta == absl::ZeroDuration()
                                  ? 0.0
                                  : total_done / absl::ToDoubleSeconds(delta);
@@ -320,6 +433,61 @@ class TestbenchBase {
     num_samples_processed_ = total_done;
   }
 
+  // Notes a mismatch at `index` for the checkpoint, if one is being written.
+  void RecordMismatch(uint64_t index) {
+    if (!checkpoint_path_.has_value()) {
+      return;
+    }
+    absl::MutexLock lock(&mismatch_mutex_);
+    mismatch_indices_.push_back(index);
+  }
+
+  // Returns the index below which every index of [start_, end_) has been
+  // evaluated.
+  uint64_t CompletedEnd() {
+    uint64_t completed_end = next_index_.load();
+    for (int64_t i = 0; i < threads_.size(); ++i) {
+      completed_end = std::min(completed_end, threads_[i]->chunk_in_progress());
+    }
+    return std::clamp(completed_end, start_, end_);
+  }
+
+  // Writes the current progress and mismatches to the checkpoint file, if any.
+  // The record is written to a temporary file first and then renamed, so an
+  // interruption never leaves a truncated checkpoint behind.
+  absl::Status WriteCheckpoint() {
+    if (!checkpoint_path_.has_value()) {
+      return absl::OkStatus();
+    }
+    TestbenchShardProto record;
+    record.set_shard_index(shard_index_);
+    record.set_num_shards(num_shards_);
+    record.set_start(space_start_);
+    record.set_end(space_end_);
+    record.set_completed_end(CompletedEnd());
+    {
+      absl::MutexLock lock(&mismatch_mutex_);
+      std::sort(mismatch_indices_.begin(), mismatch_indices_.end());
+      mismatch_indices_.erase(
+          std::unique(mismatch_indices_.begin(), mismatch_indices_.end()),
+          mismatch_indices_.end());
+      record.mutable_mismatch_indices()->Add(mismatch_indices_.begin(),
+                                             mismatch_indices_.end());
+    }
+
+    std::filesystem::path temp_path = *checkpoint_path_;
+    temp_path += ".tmp";
+    XLS_RETURN_IF_ERROR(SetProtobinFile(temp_path, record));
+    std::error_code ec;
+    std::filesystem::rename(temp_path, *checkpoint_path_, ec);
+    if (ec) {
+      return absl::InternalError(
+          absl::StrFormat("Unable to write checkpoint %s: %s",
+                          checkpoint_path_->string(), ec.message()));
+    }
+    return absl::OkStatus();
+  }
+
   // Requests that all running threads terminate (but doesn't Join() them).
   void Cancel() {
     for (int i = 0; i < threads_.size(); i++) {
@@ -330,8 +498,19 @@ class TestbenchBase {
   bool started_;
   int num_threads_;
   absl::Time start_time_;
+  // The range evaluated by this testbench: all of [space_start_, space_end_)
+  // or this testbench's shard of it, less any range completed by the run
+  // resumed from.
   uint64_t start_;
   uint64_t end_;
+  uint64_t space_start_;
+  uint64_t space_end_;
+  int64_t shard_index_;
+  int64_t num_shards_;
+  std::optional<std::filesystem::path> checkpoint_path_;
+  uint64_t chunk_size_;
+  // The first index not yet claimed by any worker thread.
+  std::atomic<uint64_t> next_index_;
   uint64_t max_failures_;
   uint64_t num_samples_processed_;
   std::function<InputT(uint64_t)> index_to_input_;
@@ -339,13 +518,17 @@ class TestbenchBase {
   std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors_;
 
   using ThreadT = TestbenchThread<InputT, ResultT, ShardDataT>;
-  std::function<std::unique_ptr<ThreadT>(uint64_t, uint64_t)> thread_create_fn_;
+  std::function<std::unique_ptr<ThreadT>()> thread_create_fn_;
   std::vector<std::unique_ptr<ThreadT>> threads_;
 
   // The main thread sleeps while tests are running. As worker threads finish,
   // they'll wake us up via this condvar.
   absl::Mutex mutex_;
   absl::CondVar wake_me_ ABSL_GUARDED_BY(mutex_);
+
+  // Mismatches found so far, for the checkpoint.
+  absl::Mutex mismatch_mutex_;
+  std::vector<uint64_t> mismatch_indices_ ABSL_GUARDED_BY(mismatch_mutex_);
 };
 
 }  // namespace internal
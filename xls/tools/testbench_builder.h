@@ -44,6 +44,7 @@
 #include <thread>
 #include <type_traits>
 
+#include "absl/types/span.h"
 #include "xls/tools/testbench.h"
 #include "xls/tools/testbench_builder_utils.h"
 
@@ -56,6 +57,8 @@ class TestbenchBuilder {
  public:
   using CompareResultsFnT = std::function<bool(const ResultT&, const ResultT&)>;
   using ComputeFnT = std::function<ResultT(ShardDataT*, InputT)>;
+  using ComputeBatchFnT = std::function<void(
+      ShardDataT*, absl::Span<const InputT>, absl::Span<ResultT>)>;
   using CreateShardDataFnT = std::function<std::unique_ptr<ShardDataT>()>;
   using IndexToInputFnT = std::function<InputT(int64_t)>;
   using LogErrorsFnT = std::function<void(int64_t, InputT, ResultT, ResultT)>;
@@ -73,6 +76,13 @@ class TestbenchBuilder {
     return *this;
   }
 
+  // Computes the actual results a block of inputs at a time with `fn` rather
+  // than with the compute_actual function given at construction.
+  TestbenchBuilder& SetComputeActualBatchFn(const ComputeBatchFnT& fn) {
+    compute_actual_batch_ = fn;
+    return *this;
+  }
+
   TestbenchBuilder& SetIndexToInputFn(const IndexToInputFnT& fn) {
     index_to_input_ = fn;
     return *this;
@@ -116,6 +126,7 @@ class TestbenchBuilder {
   int64_t max_failures_ = 1;
   ComputeFnT compute_expected_;
   ComputeFnT compute_actual_;
+  ComputeBatchFnT compute_actual_batch_;
   std::optional<CompareResultsFnT> compare_results_;
   CreateShardDataFnT create_shard_data_;
   std::optional<IndexToInputFnT> index_to_input_;
@@ -132,6 +143,8 @@ class TestbenchBuilder<
  public:
   using CompareResultsFnT = std::function<bool(const ResultT&, const ResultT&)>;
   using ComputeFnT = std::function<ResultT(InputT)>;
+  using ComputeBatchFnT =
+      std::function<void(absl::Span<const InputT>, absl::Span<ResultT>)>;
   using IndexToInputFnT = std::function<InputT(int64_t)>;
   using LogErrorsFnT = std::function<void(int64_t, InputT, ResultT, ResultT)>;
   using PrintInputFnT = std::function<std::string(const InputT&)>;
@@ -145,6 +158,13 @@ class TestbenchBuilder<
     return *this;
   }
 
+  // Computes the actual results a block of inputs at a time with `fn` rather
+  // than with the compute_actual function given at construction.
+  TestbenchBuilder& SetComputeActualBatchFn(const ComputeBatchFnT& fn) {
+    compute_actual_batch_ = fn;
+    return *this;
+  }
+
   TestbenchBuilder& SetIndexToInputFn(const IndexToInputFnT& fn) {
     index_to_input_ = fn;
     return *this;
@@ -188,6 +208,7 @@ class TestbenchBuilder<
   int64_t max_failures_ = 1;
   ComputeFnT compute_expected_;
   ComputeFnT compute_actual_;
+  ComputeBatchFnT compute_actual_batch_;
   std::optional<CompareResultsFnT> compare_results_;
   std::optional<IndexToInputFnT> index_to_input_;
   std::optional<PrintInputFnT> print_input_;
@@ -232,7 +253,8 @@ TestbenchBuilder<InputT, ResultT, ShardDataT, EnableT>::Build() {
   return Testbench<InputT, ResultT, ShardDataT>(
       /*start=*/0, this->num_samples_, this->num_threads_, this->max_failures_,
       index_to_input, create_shard_data_, this->compute_expected_,
-      this->compute_actual_, compare_results, log_errors);
+      this->compute_actual_, compare_results, log_errors,
+      this->compute_actual_batch_);
 }
 
 // Non-shard-data-containing Build() implementation.
@@ -272,7 +294,7 @@ Testbench<InputT, ResultT> TestbenchBuilder<
   return Testbench<InputT, ResultT, ShardDataT>(
       /*start=*/0, this->num_samples_, this->num_threads_, this->max_failures_,
       index_to_input, this->compute_expected_, this->compute_actual_,
-      compare_results, log_errors);
+      compare_results, log_errors, this->compute_actual_batch_);
 }
 
 }  // namespace xls
@@ -29,14 +29,15 @@
 #include <type_traits>
 #include <vector>
 
+#include "absl/base/casts.h"
 #include "absl/log/log.h"
 #include "absl/random/distributions.h"
-#include "absl/random/random.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "xls/common/philox_random.h"
 
 namespace xls {
 namespace internal {
@@ -45,12 +46,12 @@ namespace internal {
 // IndexToInput support - creates random samples. //
 ////////////////////////////////////////////////////
 template <typename ValueT>
-void GenerateRandomValue(absl::BitGen& gen, int64_t index, ValueT* value) {
+void GenerateRandomValue(PhiloxRandom& gen, int64_t index, ValueT* value) {
   // Fallback case - unknown ValueT. Do nothing.
 }
 
 template <>
-inline void GenerateRandomValue<int32_t>(absl::BitGen& gen, int64_t index,
+inline void GenerateRandomValue<int32_t>(PhiloxRandom& gen, int64_t index,
                                          int32_t* value) {
   *value = absl::bit_cast<int32_t>(absl::Uniform<uint32_t>(gen));
 }
@@ -58,19 +59,19 @@ inline void GenerateRandomValue<int32_t>(absl::BitGen& gen, int64_t index,
 // We could use MORE TEMPLATE MAGIC to combine some of these cases, but I don't
 // think it's worth the trouble.
 template <>
-inline void GenerateRandomValue<int64_t>(absl::BitGen& gen, int64_t index,
+inline void GenerateRandomValue<int64_t>(PhiloxRandom& gen, int64_t index,
                                          int64_t* value) {
   *value = absl::bit_cast<int64_t>(absl::Uniform<uint64_t>(gen));
 }
 
 template <>
-inline void GenerateRandomValue<float>(absl::BitGen& gen, int64_t index,
+inline void GenerateRandomValue<float>(PhiloxRandom& gen, int64_t index,
                                        float* value) {
   *value = absl::bit_cast<float>(absl::Uniform<uint32_t>(gen));
 }
 
 template <>
-inline void GenerateRandomValue<double>(absl::BitGen& gen, int64_t index,
+inline void GenerateRandomValue<double>(PhiloxRandom& gen, int64_t index,
                                         double* value) {
   *value = absl::bit_cast<double>(absl::Uniform<uint64_t>(gen));
 }
@@ -79,7 +80,7 @@ inline void GenerateRandomValue<double>(absl::BitGen& gen, int64_t index,
 // below.
 template <typename TupleT, int kTupleIndex,
           std::enable_if_t<kTupleIndex == std::tuple_size<TupleT>{}>* = nullptr>
-void GenerateRandomTuple(absl::BitGen& gen, int64_t index, TupleT* value) {
+void GenerateRandomTuple(PhiloxRandom& gen, int64_t index, TupleT* value) {
   // Nothing to do - we're at the end of the tuple!
 }
 
@@ -87,23 +88,29 @@ void GenerateRandomTuple(absl::BitGen& gen, int64_t index, TupleT* value) {
 // next.
 template <typename TupleT, int kTupleIndex = 0,
           std::enable_if_t<kTupleIndex != std::tuple_size<TupleT>{}>* = nullptr>
-void GenerateRandomTuple(absl::BitGen& gen, int64_t index, TupleT* value) {
+void GenerateRandomTuple(PhiloxRandom& gen, int64_t index, TupleT* value) {
   GenerateRandomValue<typename std::tuple_element<kTupleIndex, TupleT>::type>(
       gen, index, &std::get<kTupleIndex>(*value));
   GenerateRandomTuple<TupleT, kTupleIndex + 1>(gen, index, value);
 }
 
+// Seed of the default inputs. The input for an index is drawn from
+// PhiloxRandom(kDefaultIndexToInputSeed, index), so it is the same regardless
+// of sharding or of the thread which generates it, and a failing input can be
+// regenerated from its index alone.
+inline constexpr uint64_t kDefaultIndexToInputSeed = 0x584c53;
+
 // Entry point for general usage.
 template <typename ValueT>
 void DefaultIndexToInput(int64_t index, ValueT* value) {
-  thread_local absl::BitGen gen;
+  PhiloxRandom gen(kDefaultIndexToInputSeed, index);
   GenerateRandomValue<ValueT>(gen, index, value);
 }
 
 // std::tuple entry point.
 template <typename... ElementsT>
 void DefaultIndexToInput(int64_t index, std::tuple<ElementsT...>* value) {
-  thread_local absl::BitGen gen;
+  PhiloxRandom gen(kDefaultIndexToInputSeed, index);
   GenerateRandomTuple<std::tuple<ElementsT...>>(gen, index, value);
 }
 
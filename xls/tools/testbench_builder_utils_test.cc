@@ -16,6 +16,7 @@
 
 #include <bit>
 #include <cstdint>
+#include <tuple>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -51,6 +52,23 @@ TEST(TestbencUtils, DefaultPrintValuePrintFloat) {
   EXPECT_EQ(DefaultPrintValue(some_nan), "nan (nan)");
 }
 
+TEST(TestbencUtils, DefaultIndexToInputIsReproducible) {
+  std::tuple<int32_t, int64_t, float> a;
+  std::tuple<int32_t, int64_t, float> b;
+  DefaultIndexToInput(12345, &a);
+  DefaultIndexToInput(12345, &b);
+  EXPECT_EQ(std::get<0>(a), std::get<0>(b));
+  EXPECT_EQ(std::get<1>(a), std::get<1>(b));
+  EXPECT_EQ(std::bit_cast<uint32_t>(std::get<2>(a)),
+            std::bit_cast<uint32_t>(std::get<2>(b)));
+
+  int64_t c;
+  int64_t d;
+  DefaultIndexToInput(1, &c);
+  DefaultIndexToInput(2, &d);
+  EXPECT_NE(c, d);
+}
+
 TEST(TestbencUtils, DefaultPrintValuePrintUnprintable) {
   struct Foo {
     int value;
@@ -0,0 +1,80 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/tools/testbench_shard.h"
+#include "xls/tools/testbench_shard.pb.h"
+
+const char kUsage[] = R"(
+Combines the shard records written by a sharded testbench run (see
+TestbenchBase::SetShard and TestbenchBase::SetCheckpointPath) into a report for
+the full index space:
+
+  testbench_merge_main shard_0.pb shard_1.pb ... shard_N.pb
+
+Exits with an error if any shard is missing or incomplete, or if any mismatch
+was found.
+)";
+
+namespace xls {
+namespace {
+
+absl::Status RealMain(absl::Span<const std::string_view> record_paths) {
+  std::vector<TestbenchShardProto> shards;
+  shards.reserve(record_paths.size());
+  for (std::string_view path : record_paths) {
+    TestbenchShardProto& shard = shards.emplace_back();
+    XLS_RETURN_IF_ERROR(ParseProtobinFile(path, &shard));
+  }
+  XLS_ASSIGN_OR_RETURN(TestbenchShardReport report,
+                       MergeTestbenchShards(shards));
+  std::cout << report.ToString();
+  if (!report.complete()) {
+    return absl::FailedPreconditionError(
+        absl::StrFormat("%d of %d testbench shards are incomplete.",
+                        report.incomplete_shards.size(), report.num_shards));
+  }
+  if (!report.mismatch_indices.empty()) {
+    return absl::InternalError(
+        "There was at least one mismatch during execution.");
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.empty()) {
+    LOG(QFATAL) << "Expected invocation: " << argv[0]
+                << " <shard_record> [<shard_record>...]";
+  }
+
+  return xls::ExitStatus(xls::RealMain(positional_arguments));
+}
@@ -0,0 +1,120 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/testbench_shard.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/tools/testbench_shard.pb.h"
+
+namespace xls {
+
+std::pair<uint64_t, uint64_t> TestbenchShardRange(uint64_t start, uint64_t end,
+                                                  int64_t shard_index,
+                                                  int64_t num_shards) {
+  uint64_t size = end - start;
+  uint64_t base = size / num_shards;
+  uint64_t remainder = size % num_shards;
+  uint64_t index = shard_index;
+  // The first `remainder` shards each take one extra index.
+  uint64_t first = start + index * base + std::min(index, remainder);
+  uint64_t last = first + base + (index < remainder ? 1 : 0);
+  return {first, last};
+}
+
+std::string TestbenchShardReport::ToString() const {
+  std::string result = absl::StrFormat(
+      "%d shards; %d of %d indices evaluated; %d mismatches\n", num_shards,
+      num_evaluated, num_indices, mismatch_indices.size());
+  if (!incomplete_shards.empty()) {
+    absl::StrAppend(&result, "Incomplete shards: ",
+                    absl::StrJoin(incomplete_shards, ", "), "\n");
+  }
+  for (uint64_t index : mismatch_indices) {
+    absl::StrAppendFormat(&result, "Mismatch at index %d\n", index);
+  }
+  return result;
+}
+
+absl::StatusOr<TestbenchShardReport> MergeTestbenchShards(
+    absl::Span<const TestbenchShardProto> shards) {
+  if (shards.empty()) {
+    return absl::InvalidArgumentError("No testbench shard records to merge.");
+  }
+  const TestbenchShardProto& first = shards.front();
+  if (first.num_shards() <= 0 || first.end() < first.start()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid testbench shard record: %d shards over [%d, "
+                        "%d).",
+                        first.num_shards(), first.start(), first.end()));
+  }
+
+  TestbenchShardReport report;
+  report.num_shards = first.num_shards();
+  report.num_indices = first.end() - first.start();
+  std::vector<bool> seen(first.num_shards(), false);
+  std::vector<bool> complete(first.num_shards(), false);
+  for (const TestbenchShardProto& shard : shards) {
+    if (shard.num_shards() != first.num_shards() ||
+        shard.start() != first.start() || shard.end() != first.end()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Testbench shard %d covers %d shards over [%d, %d); expected %d "
+          "shards over [%d, %d).",
+          shard.shard_index(), shard.num_shards(), shard.start(), shard.end(),
+          first.num_shards(), first.start(), first.end()));
+    }
+    if (shard.shard_index() < 0 || shard.shard_index() >= shard.num_shards()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Testbench shard index %d is out of range [0, %d).",
+                          shard.shard_index(), shard.num_shards()));
+    }
+    if (seen[shard.shard_index()]) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Multiple records for testbench shard %d.", shard.shard_index()));
+    }
+    seen[shard.shard_index()] = true;
+
+    auto [shard_start, shard_end] = TestbenchShardRange(
+        shard.start(), shard.end(), shard.shard_index(), shard.num_shards());
+    uint64_t completed_end =
+        std::clamp(shard.completed_end(), shard_start, shard_end);
+    report.num_evaluated += completed_end - shard_start;
+    complete[shard.shard_index()] = completed_end == shard_end;
+    report.mismatch_indices.insert(report.mismatch_indices.end(),
+                                   shard.mismatch_indices().begin(),
+                                   shard.mismatch_indices().end());
+  }
+  for (int64_t i = 0; i < report.num_shards; ++i) {
+    if (!complete[i]) {
+      report.incomplete_shards.push_back(i);
+    }
+  }
+  std::sort(report.mismatch_indices.begin(), report.mismatch_indices.end());
+  report.mismatch_indices.erase(std::unique(report.mismatch_indices.begin(),
+                                            report.mismatch_indices.end()),
+                                report.mismatch_indices.end());
+  return report;
+}
+
+}  // namespace xls
@@ -0,0 +1,61 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_TOOLS_TESTBENCH_SHARD_H_
+#define XLS_TOOLS_TESTBENCH_SHARD_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/tools/testbench_shard.pb.h"
+
+namespace xls {
+
+// Returns the contiguous range [first, second) of the index space
+// [start, end) evaluated by shard `shard_index` of `num_shards`. The ranges of
+// the shards partition the space and differ in size by at most one.
+std::pair<uint64_t, uint64_t> TestbenchShardRange(uint64_t start, uint64_t end,
+                                                  int64_t shard_index,
+                                                  int64_t num_shards);
+
+// The combined results of the shards of a testbench run.
+struct TestbenchShardReport {
+  int64_t num_shards = 0;
+  // Size of the full index space.
+  uint64_t num_indices = 0;
+  // Number of indices evaluated across all shards.
+  uint64_t num_evaluated = 0;
+  // Shards which have no record or have not completed their range.
+  std::vector<int64_t> incomplete_shards;
+  // Indices at which results mismatched, in increasing order.
+  std::vector<uint64_t> mismatch_indices;
+
+  bool complete() const { return incomplete_shards.empty(); }
+
+  std::string ToString() const;
+};
+
+// Combines the records of the shards of a testbench run into a report. Returns
+// an error if the records disagree about the index space or the number of
+// shards, or if a shard has more than one record.
+absl::StatusOr<TestbenchShardReport> MergeTestbenchShards(
+    absl::Span<const TestbenchShardProto> shards);
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_TESTBENCH_SHARD_H_
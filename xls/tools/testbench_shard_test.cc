@@ -0,0 +1,98 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/testbench_shard.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/tools/testbench_shard.pb.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TestbenchShardProto MakeShard(int64_t shard_index, int64_t num_shards,
+                              uint64_t start, uint64_t end,
+                              uint64_t completed_end,
+                              std::vector<uint64_t> mismatches = {}) {
+  TestbenchShardProto shard;
+  shard.set_shard_index(shard_index);
+  shard.set_num_shards(num_shards);
+  shard.set_start(start);
+  shard.set_end(end);
+  shard.set_completed_end(completed_end);
+  for (uint64_t index : mismatches) {
+    shard.add_mismatch_indices(index);
+  }
+  return shard;
+}
+
+TEST(TestbenchShardTest, RangesPartitionSpace) {
+  EXPECT_EQ(TestbenchShardRange(10, 20, 0, 3), std::make_pair(10ul, 14ul));
+  EXPECT_EQ(TestbenchShardRange(10, 20, 1, 3), std::make_pair(14ul, 17ul));
+  EXPECT_EQ(TestbenchShardRange(10, 20, 2, 3), std::make_pair(17ul, 20ul));
+
+  EXPECT_EQ(TestbenchShardRange(0, 2, 0, 4), std::make_pair(0ul, 1ul));
+  EXPECT_EQ(TestbenchShardRange(0, 2, 1, 4), std::make_pair(1ul, 2ul));
+  EXPECT_EQ(TestbenchShardRange(0, 2, 2, 4), std::make_pair(2ul, 2ul));
+  EXPECT_EQ(TestbenchShardRange(0, 2, 3, 4), std::make_pair(2ul, 2ul));
+}
+
+TEST(TestbenchShardTest, MergeCompleteShards) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TestbenchShardReport report,
+      MergeTestbenchShards({MakeShard(1, 2, 0, 100, 100, {70, 51}),
+                            MakeShard(0, 2, 0, 100, 50, {3})}));
+  EXPECT_TRUE(report.complete());
+  EXPECT_EQ(report.num_shards, 2);
+  EXPECT_EQ(report.num_indices, uint64_t{100});
+  EXPECT_EQ(report.num_evaluated, uint64_t{100});
+  EXPECT_THAT(report.mismatch_indices, ElementsAre(3, 51, 70));
+}
+
+TEST(TestbenchShardTest, MergeIncompleteShards) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TestbenchShardReport report,
+      MergeTestbenchShards({MakeShard(0, 3, 0, 30, 5),
+                            MakeShard(2, 3, 0, 30, 30)}));
+  EXPECT_FALSE(report.complete());
+  EXPECT_EQ(report.num_evaluated, uint64_t{15});
+  EXPECT_THAT(report.incomplete_shards, ElementsAre(0, 1));
+  EXPECT_THAT(report.mismatch_indices, IsEmpty());
+}
+
+TEST(TestbenchShardTest, MergeInconsistentShards) {
+  EXPECT_THAT(MergeTestbenchShards({}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(MergeTestbenchShards(
+                  {MakeShard(0, 2, 0, 100, 50), MakeShard(1, 2, 0, 99, 99)}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(MergeTestbenchShards(
+                  {MakeShard(0, 2, 0, 100, 50), MakeShard(0, 2, 0, 100, 50)}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(MergeTestbenchShards({MakeShard(2, 2, 0, 100, 100)}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace xls
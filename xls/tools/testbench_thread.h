@@ -15,16 +15,20 @@
 #ifndef XLS_TOOLS_TESTBENCH_THREAD_H_
 #define XLS_TOOLS_TESTBENCH_THREAD_H_
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/common/thread.h"
 #include "xls/ir/package.h"
 
@@ -34,8 +38,11 @@ template <typename InputT, typename ResultT, typename ShardDataT>
 class TestbenchThreadBase;
 
 // TestbenchThread handles the work of _actually_ running tests.
-// It simply iterates over its given range of the index space and calls the
-// expected/actual calculators.
+// It repeatedly claims the next chunk of the index space from a counter shared
+// with its sibling threads and calls the expected/actual calculators on each
+// index of that chunk, until the space is exhausted. If a batched "actual"
+// calculator is given, the chunk is instead converted into blocks of inputs
+// which are each evaluated with a single call.
 //
 // Just as with Testbench, TestbenchThread supports execution both with and
 // without per-shard data, and uses the same type of construct to expose an API
@@ -49,6 +56,10 @@ class TestbenchThread
   // All specified functions must be thread-safe.
   //  - wake_parent_mutex: A mutex that protects:
   //  - wake_parent: A condvar to kick the parent when this thread has finished.
+  //  - next_index: The first index not yet claimed by any worker; shared by
+  //                all workers of a testbench.
+  //  - end_index: The (exclusive) end of the index space.
+  //  - chunk_size: The number of indices claimed from next_index at a time.
   //  - max_failures: The number of failures that will cause us to bail out.
   //                  If 0, then there will be no limit.
   //  - index_to_input: A function that can convert an index to an input to the
@@ -56,21 +67,30 @@ class TestbenchThread
   //  - generate_expected: Given an input, generates the "expected" value.
   //  - generate_actual: Given an input, generates a value from the module
   //                     under test.
+  //  - generate_actual_batch: Optional. Given a block of inputs, generates the
+  //                           corresponding values from the module under test.
+  //                           Used in place of generate_actual if given.
   TestbenchThread(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
-      uint64_t start_index, uint64_t end_index, uint64_t max_failures,
+      std::atomic<uint64_t>* next_index, uint64_t end_index,
+      uint64_t chunk_size, uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<std::unique_ptr<ShardDataT>()> create_shard,
       std::function<ResultT(ShardDataT*, InputT)> generate_expected,
       std::function<ResultT(ShardDataT*, InputT)> generate_actual,
       std::function<bool(ResultT, ResultT)> compare_results,
-      std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+      std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+      std::function<void(ShardDataT*, absl::Span<const InputT>,
+                         absl::Span<ResultT>)>
+          generate_actual_batch = nullptr)
       : TestbenchThreadBase<InputT, ResultT, ShardDataT>(
-            wake_parent_mutex, wake_parent, start_index, end_index,
-            max_failures, index_to_input, compare_results, log_errors),
+            wake_parent_mutex, wake_parent, next_index, end_index,
+            chunk_size, max_failures, index_to_input, compare_results,
+            log_errors),
         create_shard_fn_(create_shard),
         generate_expected_(generate_expected),
-        generate_actual_(generate_actual) {
+        generate_actual_(generate_actual),
+        generate_actual_batch_(generate_actual_batch) {
     this->generate_expected_fn_ = [this](InputT& input) {
       return generate_expected_(shard_data_.get(), input);
     };
@@ -78,6 +98,13 @@ class TestbenchThread
     this->generate_actual_fn_ = [this](InputT& input) {
       return generate_actual_(shard_data_.get(), input);
     };
+
+    if (generate_actual_batch_) {
+      this->generate_actual_batch_fn_ = [this](absl::Span<const InputT> inputs,
+                                               absl::Span<ResultT> results) {
+        generate_actual_batch_(shard_data_.get(), inputs, results);
+      };
+    }
   }
 
   void Init() override { shard_data_ = create_shard_fn_(); }
@@ -87,6 +114,9 @@ class TestbenchThread
   std::function<std::unique_ptr<ShardDataT>()> create_shard_fn_;
   std::function<ResultT(ShardDataT*, InputT)> generate_expected_;
   std::function<ResultT(ShardDataT*, InputT)> generate_actual_;
+  std::function<void(ShardDataT*, absl::Span<const InputT>,
+                     absl::Span<ResultT>)>
+      generate_actual_batch_;
 };
 
 // And the without-shard-data case.
@@ -98,15 +128,19 @@ class TestbenchThread<
  public:
   TestbenchThread(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
-      uint64_t start_index, uint64_t end_index, uint64_t max_failures,
+      std::atomic<uint64_t>* next_index, uint64_t end_index,
+      uint64_t chunk_size, uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<ResultT(InputT)> generate_expected,
       std::function<ResultT(InputT)> generate_actual,
       std::function<bool(ResultT, ResultT)> compare_results,
-      std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+      std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+      std::function<void(absl::Span<const InputT>, absl::Span<ResultT>)>
+          generate_actual_batch = nullptr)
       : TestbenchThreadBase<InputT, ResultT, ShardDataT>(
-            wake_parent_mutex, wake_parent, start_index, end_index,
-            max_failures, index_to_input, compare_results, log_errors),
+            wake_parent_mutex, wake_parent, next_index, end_index,
+            chunk_size, max_failures, index_to_input, compare_results,
+            log_errors),
         generate_expected_(generate_expected),
         generate_actual_(generate_actual) {
     this->generate_expected_fn_ = [this](InputT& input) {
@@ -117,6 +151,8 @@ class TestbenchThread<
       // return generate_actual_(this->jit_wrapper_.get(), input);
       return generate_actual_(input);
     };
+
+    this->generate_actual_batch_fn_ = generate_actual_batch;
   }
 
  private:
@@ -131,7 +167,8 @@ class TestbenchThreadBase {
  public:
   TestbenchThreadBase(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
-      uint64_t start_index, uint64_t end_index, uint64_t max_failures,
+      std::atomic<uint64_t>* next_index, uint64_t end_index,
+      uint64_t chunk_size, uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<bool(ResultT, ResultT)> compare_results,
       std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
@@ -141,8 +178,10 @@ class TestbenchThreadBase {
         running_(false),
         ready_(false),
         start_(false),
-        start_index_(start_index),
+        next_index_(next_index),
         end_index_(end_index),
+        chunk_size_(chunk_size),
+        chunk_in_progress_(next_index->load()),
         max_failures_(max_failures),
         num_passes_(0),
         num_failures_(0),
@@ -177,25 +216,44 @@ class TestbenchThreadBase {
     }
 
     running_.store(true);
-    for (uint64_t i = start_index_; i < end_index_; i++) {
-      // Don't check for cancelled on every iteration; it's a touch slow.
-      if (i % 128 == 0 && cancelled_.load()) {
-        return_status = absl::CancelledError("This thread was cancelled.");
+    while (return_status.ok()) {
+      // Claim the next chunk of the index space. Which worker evaluates a given
+      // index depends on timing, but the set of evaluated indices (and the
+      // result for each) does not.
+      uint64_t chunk_start = next_index_->fetch_add(chunk_size_);
+      if (chunk_start >= end_index_) {
+        chunk_in_progress_.store(std::numeric_limits<uint64_t>::max());
         break;
       }
-
-      InputT input = index_to_input_(i);
-      ResultT expected = generate_expected_fn_(input);
-      ResultT actual = generate_actual_fn_(input);
-      if (!compare_results_(expected, actual)) {
-        num_failures_.store(num_failures_.load() + 1);
-        log_errors_(i, input, expected, actual);
-        if (max_failures_ <= num_failures_.load()) {
-          return_status = absl::UnknownError("Maximum error count reached.");
+      chunk_in_progress_.store(chunk_start);
+      // Careful to not overflow for spaces ending near the top of uint64_t.
+      uint64_t chunk_end = end_index_ - chunk_start <= chunk_size_
+                               ? end_index_
+                               : chunk_start + chunk_size_;
+      if (generate_actual_batch_fn_) {
+        return_status = RunBatches(chunk_start, chunk_end);
+        continue;
+      }
+      for (uint64_t i = chunk_start; i < chunk_end; i++) {
+        // Don't check for cancelled on every iteration; it's a touch slow.
+        if (i % 128 == 0 && cancelled_.load()) {
+          return_status = absl::CancelledError("This thread was cancelled.");
           break;
         }
-      } else {
-        num_passes_.store(num_passes_.load() + 1);
+
+        InputT input = index_to_input_(i);
+        ResultT expected = generate_expected_fn_(input);
+        ResultT actual = generate_actual_fn_(input);
+        if (!compare_results_(expected, actual)) {
+          num_failures_.store(num_failures_.load() + 1);
+          log_errors_(i, input, expected, actual);
+          if (max_failures_ <= num_failures_.load()) {
+            return_status = absl::UnknownError("Maximum error count reached.");
+            break;
+          }
+        } else {
+          num_passes_.store(num_passes_.load() + 1);
+        }
       }
     }
 
@@ -207,6 +265,41 @@ class TestbenchThreadBase {
     this->WakeParent();
   }
 
+  // Evaluates the indices [start, end) in blocks of at most kMaxBatchSize
+  // inputs, computing the actual results of each block with one call to
+  // generate_actual_batch_fn_.
+  absl::Status RunBatches(uint64_t start, uint64_t end) {
+    uint64_t batch_start = start;
+    while (batch_start < end) {
+      if (cancelled_.load()) {
+        return absl::CancelledError("This thread was cancelled.");
+      }
+      uint64_t batch_size = std::min(kMaxBatchSize, end - batch_start);
+      batch_inputs_.clear();
+      for (uint64_t i = 0; i < batch_size; i++) {
+        batch_inputs_.push_back(index_to_input_(batch_start + i));
+      }
+      batch_results_.resize(batch_size);
+      generate_actual_batch_fn_(batch_inputs_, absl::MakeSpan(batch_results_));
+
+      for (uint64_t i = 0; i < batch_size; i++) {
+        ResultT expected = generate_expected_fn_(batch_inputs_[i]);
+        if (!compare_results_(expected, batch_results_[i])) {
+          num_failures_.store(num_failures_.load() + 1);
+          log_errors_(batch_start + i, batch_inputs_[i], expected,
+                      batch_results_[i]);
+          if (max_failures_ <= num_failures_.load()) {
+            return absl::UnknownError("Maximum error count reached.");
+          }
+        } else {
+          num_passes_.store(num_passes_.load() + 1);
+        }
+      }
+      batch_start += batch_size;
+    }
+    return absl::OkStatus();
+  }
+
   // Do any one-time initialization. In practice, this is initializing shard
   // data.
   virtual void Init() {}
@@ -230,6 +323,11 @@ class TestbenchThreadBase {
 
   uint64_t num_passes() { return num_passes_.load(); }
 
+  // Returns a lower bound on the start of the chunk this thread is evaluating;
+  // every index this thread has claimed below it has been evaluated. Returns
+  // the maximum uint64_t once the thread has run out of work.
+  uint64_t chunk_in_progress() { return chunk_in_progress_.load(); }
+
   absl::Status status() {
     absl::MutexLock lock(&mutex_);
     return status_;
@@ -243,6 +341,10 @@ class TestbenchThreadBase {
     wake_parent_->Signal();
   }
 
+  // The largest number of inputs evaluated with one call to
+  // generate_actual_batch_fn_.
+  static constexpr uint64_t kMaxBatchSize = 1024;
+
   // Parent-owned.
   absl::Mutex* wake_parent_mutex_;
   absl::CondVar* wake_parent_;
@@ -257,8 +359,11 @@ class TestbenchThreadBase {
   std::atomic<bool> ready_;
   std::atomic<bool> start_;
 
-  uint64_t start_index_;
+  // Parent-owned; the next unclaimed index of the space.
+  std::atomic<uint64_t>* next_index_;
   uint64_t end_index_;
+  uint64_t chunk_size_;
+  std::atomic<uint64_t> chunk_in_progress_;
 
   // Bookkeeping data.
   uint64_t max_failures_;
@@ -268,6 +373,12 @@ class TestbenchThreadBase {
   std::function<InputT(uint64_t)> index_to_input_;
   std::function<ResultT(InputT&)> generate_expected_fn_;
   std::function<ResultT(InputT&)> generate_actual_fn_;
+  // Optional; if set, used in place of generate_actual_fn_.
+  std::function<void(absl::Span<const InputT>, absl::Span<ResultT>)>
+      generate_actual_batch_fn_;
+  // Storage for the current block when generate_actual_batch_fn_ is used.
+  std::vector<InputT> batch_inputs_;
+  std::vector<ResultT> batch_results_;
   std::function<bool(ResultT, ResultT)> compare_results_;
   std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors_;
 
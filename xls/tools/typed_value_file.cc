@@ -0,0 +1,342 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/typed_value_file.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/value.h"
+#include "xls/ir/xls_type.pb.h"
+
+namespace xls {
+
+// The flattened layout of a type, computed once per file rather than per value.
+struct TypedValueLayout {
+  TypeProto::TypeEnum kind;
+  // Number of bits the value occupies in a record.
+  int64_t bit_count;
+  // Number of elements of a tuple or array.
+  int64_t size;
+  // The elements of a tuple, or the single element layout of an array.
+  std::vector<TypedValueLayout> elements;
+};
+
+namespace {
+
+constexpr std::string_view kMagic = "XLSTVALS";
+constexpr int64_t kPreambleSize = kMagic.size() + 2 * sizeof(uint64_t);
+
+absl::StatusOr<TypedValueLayout> LayoutFromProto(const TypeProto& proto) {
+  TypedValueLayout layout{.kind = proto.type_enum(), .bit_count = 0, .size = 0};
+  switch (proto.type_enum()) {
+    case TypeProto::BITS:
+      if (proto.bit_count() < 0) {
+        return absl::InvalidArgumentError("Negative bit count in type");
+      }
+      layout.bit_count = proto.bit_count();
+      return layout;
+    case TypeProto::TOKEN:
+      return layout;
+    case TypeProto::TUPLE:
+      layout.size = proto.tuple_elements_size();
+      for (const TypeProto& element : proto.tuple_elements()) {
+        XLS_ASSIGN_OR_RETURN(TypedValueLayout element_layout,
+                             LayoutFromProto(element));
+        if (element_layout.bit_count >
+            std::numeric_limits<int64_t>::max() - layout.bit_count) {
+          return absl::InvalidArgumentError("Type is too large");
+        }
+        layout.bit_count += element_layout.bit_count;
+        layout.elements.push_back(std::move(element_layout));
+      }
+      return layout;
+    case TypeProto::ARRAY: {
+      if (!proto.has_array_element() || proto.array_size() <= 0) {
+        return absl::InvalidArgumentError(
+            "Array types must have an element type and a positive size");
+      }
+      XLS_ASSIGN_OR_RETURN(TypedValueLayout element_layout,
+                           LayoutFromProto(proto.array_element()));
+      if (element_layout.bit_count != 0 &&
+          proto.array_size() >
+              std::numeric_limits<int64_t>::max() / element_layout.bit_count) {
+        return absl::InvalidArgumentError("Type is too large");
+      }
+      layout.size = proto.array_size();
+      layout.bit_count = layout.size * element_layout.bit_count;
+      layout.elements.push_back(std::move(element_layout));
+      return layout;
+    }
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid type kind %d", proto.type_enum()));
+  }
+}
+
+// Returns the `width` (at most 64) bits of `bitmap` starting at `offset`.
+uint64_t ExtractWord(const InlineBitmap& bitmap, int64_t offset,
+                     int64_t width) {
+  const int64_t wordno = offset / 64;
+  const int64_t shift = offset % 64;
+  uint64_t word = bitmap.GetWord(wordno) >> shift;
+  if (shift != 0 && shift + width > 64) {
+    word |= bitmap.GetWord(wordno + 1) << (64 - shift);
+  }
+  return width == 64 ? word : word & ((uint64_t{1} << width) - 1);
+}
+
+// Sets the `width` (at most 64) bits of `bitmap` starting at `offset`, which
+// must be zero, to `word`.
+void DepositWord(InlineBitmap& bitmap, int64_t offset, int64_t width,
+                 uint64_t word) {
+  const int64_t wordno = offset / 64;
+  const int64_t shift = offset % 64;
+  bitmap.SetWord(wordno, bitmap.GetWord(wordno) | (word << shift));
+  if (shift != 0 && shift + width > 64) {
+    bitmap.SetWord(wordno + 1,
+                   bitmap.GetWord(wordno + 1) | (word >> (64 - shift)));
+  }
+}
+
+// Copies `width` bits a word at a time; the destination bits must be zero.
+void CopyBits(const InlineBitmap& from, int64_t from_offset, InlineBitmap& to,
+              int64_t to_offset, int64_t width) {
+  for (int64_t i = 0; i < width; i += 64) {
+    const int64_t chunk = std::min<int64_t>(64, width - i);
+    DepositWord(to, to_offset + i, chunk,
+                ExtractWord(from, from_offset + i, chunk));
+  }
+}
+
+Bits ExtractBits(const InlineBitmap& record, int64_t offset, int64_t width) {
+  InlineBitmap bitmap(width);
+  CopyBits(record, offset, bitmap, 0, width);
+  return Bits::FromBitmap(std::move(bitmap));
+}
+
+Value DecodeValue(const InlineBitmap& record, int64_t offset,
+                  const TypedValueLayout& layout) {
+  switch (layout.kind) {
+    case TypeProto::BITS:
+      return Value(ExtractBits(record, offset, layout.bit_count));
+    case TypeProto::TOKEN:
+      return Value::Token();
+    case TypeProto::TUPLE: {
+      std::vector<Value> elements;
+      elements.reserve(layout.size);
+      for (const TypedValueLayout& element : layout.elements) {
+        elements.push_back(DecodeValue(record, offset, element));
+        offset += element.bit_count;
+      }
+      return Value::TupleOwned(std::move(elements));
+    }
+    default: {
+      const TypedValueLayout& element = layout.elements.front();
+      if (element.kind == TypeProto::BITS) {
+        // The record already holds the array in the packed layout.
+        return Value::PackedBitsArrayFromBits(
+                   ExtractBits(record, offset, layout.bit_count), layout.size)
+            .value();
+      }
+      std::vector<Value> elements;
+      elements.reserve(layout.size);
+      for (int64_t i = 0; i < layout.size; ++i) {
+        elements.push_back(DecodeValue(record, offset, element));
+        offset += element.bit_count;
+      }
+      return Value::ArrayOwned(std::move(elements));
+    }
+  }
+}
+
+// Writes `value` into the (zeroed) bits of `record` starting at `offset`.
+// Returns false if the value does not match the layout.
+bool EncodeValue(const Value& value, const TypedValueLayout& layout,
+                 InlineBitmap& record, int64_t offset) {
+  switch (layout.kind) {
+    case TypeProto::BITS:
+      if (!value.IsBits() || value.bits().bit_count() != layout.bit_count) {
+        return false;
+      }
+      CopyBits(value.bits().bitmap(), 0, record, offset, layout.bit_count);
+      return true;
+    case TypeProto::TOKEN:
+      return value.IsToken();
+    case TypeProto::TUPLE:
+      if (!value.IsTuple() || value.size() != layout.size) {
+        return false;
+      }
+      for (int64_t i = 0; i < layout.size; ++i) {
+        if (!EncodeValue(value.element(i), layout.elements[i], record,
+                         offset)) {
+          return false;
+        }
+        offset += layout.elements[i].bit_count;
+      }
+      return true;
+    default: {
+      if (!value.IsArray() || value.size() != layout.size) {
+        return false;
+      }
+      const TypedValueLayout& element = layout.elements.front();
+      if (value.IsPackedBitsArray()) {
+        if (element.kind != TypeProto::BITS ||
+            value.packed_element_bit_count() != element.bit_count) {
+          return false;
+        }
+        CopyBits(value.packed_bits().bitmap(), 0, record, offset,
+                 layout.bit_count);
+        return true;
+      }
+      for (int64_t i = 0; i < layout.size; ++i) {
+        if (!EncodeValue(value.element(i), element, record, offset)) {
+          return false;
+        }
+        offset += element.bit_count;
+      }
+      return true;
+    }
+  }
+}
+
+}  // namespace
+
+TypedValueReader::TypedValueReader(
+    TypeProto type, std::shared_ptr<const TypedValueLayout> layout,
+    int64_t count, std::string_view records)
+    : type_(std::move(type)),
+      layout_(std::move(layout)),
+      count_(count),
+      record_size_(CeilOfRatio(layout_->bit_count, int64_t{8})),
+      records_(records) {}
+
+/* static */ absl::StatusOr<TypedValueReader> TypedValueReader::Create(
+    std::string_view contents) {
+  if (!IsTypedValueFile(contents)) {
+    return absl::InvalidArgumentError("Not a typed value file");
+  }
+  uint64_t type_size;
+  uint64_t count;
+  std::memcpy(&type_size, contents.data() + kMagic.size(), sizeof(type_size));
+  std::memcpy(&count, contents.data() + kMagic.size() + sizeof(type_size),
+              sizeof(count));
+  if (type_size > contents.size() - kPreambleSize) {
+    return absl::InvalidArgumentError("Typed value file is truncated (type)");
+  }
+  TypeProto type;
+  if (!type.ParseFromArray(contents.data() + kPreambleSize, type_size)) {
+    return absl::InvalidArgumentError(
+        "Unable to parse the type of typed value file");
+  }
+  XLS_ASSIGN_OR_RETURN(TypedValueLayout layout, LayoutFromProto(type));
+  const uint64_t record_size = CeilOfRatio(layout.bit_count, int64_t{8});
+  std::string_view records = contents.substr(kPreambleSize + type_size);
+  if (record_size == 0 ? !records.empty()
+                       : (count > records.size() / record_size ||
+                          count * record_size != records.size())) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Typed value file holds %d bytes of values; expected %d values of %d "
+        "bytes",
+        records.size(), count, record_size));
+  }
+  if (count > std::numeric_limits<int64_t>::max()) {
+    return absl::InvalidArgumentError("Too many values in typed value file");
+  }
+  return TypedValueReader(
+      std::move(type),
+      std::make_shared<const TypedValueLayout>(std::move(layout)), count,
+      records);
+}
+
+Value TypedValueReader::Get(int64_t i) const {
+  const auto* record = reinterpret_cast<const uint8_t*>(records_.data()) +
+                       i * record_size_;
+  return DecodeValue(InlineBitmap::FromBytes(
+                         layout_->bit_count,
+                         absl::MakeConstSpan(record, record_size_)),
+                     0, *layout_);
+}
+
+std::vector<Value> TypedValueReader::GetAll(
+    std::optional<int64_t> max_count) const {
+  int64_t count = count_;
+  if (max_count.has_value()) {
+    count = std::min(count, *max_count);
+  }
+  std::vector<Value> values;
+  values.reserve(count);
+  for (int64_t i = 0; i < count; ++i) {
+    values.push_back(Get(i));
+  }
+  return values;
+}
+
+bool IsTypedValueFile(std::string_view contents) {
+  return contents.size() >= kPreambleSize && contents.starts_with(kMagic);
+}
+
+absl::StatusOr<std::string> EncodeTypedValues(const TypeProto& type,
+                                              absl::Span<const Value> values) {
+  XLS_ASSIGN_OR_RETURN(TypedValueLayout layout, LayoutFromProto(type));
+  const std::string type_bytes = type.SerializeAsString();
+  const uint64_t type_size = type_bytes.size();
+  const uint64_t count = values.size();
+  const int64_t record_size = CeilOfRatio(layout.bit_count, int64_t{8});
+
+  std::string result(kPreambleSize + type_size + count * record_size, '\0');
+  char* out = result.data();
+  std::memcpy(out, kMagic.data(), kMagic.size());
+  std::memcpy(out + kMagic.size(), &type_size, sizeof(type_size));
+  std::memcpy(out + kMagic.size() + sizeof(type_size), &count, sizeof(count));
+  std::memcpy(out + kPreambleSize, type_bytes.data(), type_size);
+  auto* records = reinterpret_cast<uint8_t*>(out + kPreambleSize + type_size);
+  for (int64_t i = 0; i < values.size(); ++i) {
+    InlineBitmap record(layout.bit_count);
+    if (!EncodeValue(values[i], layout, record, 0)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Value %d (%s) does not have the type of the values: %s", i,
+          values[i].ToString(), type.ShortDebugString()));
+    }
+    record.WriteBytesToBuffer(
+        absl::MakeSpan(records + i * record_size, record_size));
+  }
+  return result;
+}
+
+absl::StatusOr<std::vector<Value>> DecodeTypedValues(
+    std::string_view contents) {
+  XLS_ASSIGN_OR_RETURN(TypedValueReader reader,
+                       TypedValueReader::Create(contents));
+  return reader.GetAll();
+}
+
+}  // namespace xls
@@ -0,0 +1,88 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_TOOLS_TYPED_VALUE_FILE_H_
+#define XLS_TOOLS_TYPED_VALUE_FILE_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/value.h"
+#include "xls/ir/xls_type.pb.h"
+
+namespace xls {
+
+// The layout of the records of a typed value file (defined in the .cc file).
+struct TypedValueLayout;
+
+// A compact binary encoding of a sequence of Values of the same type, accepted
+// by the eval tools (and written by the fuzzer) in place of the text format of
+// Parser::ParseTypedValue() when there are many or large values to pass.
+//
+// The file is the magic string, the size of the serialized TypeProto and the
+// number of values (both uint64_t), the TypeProto itself and then one record
+// per value. A record holds the flattened bits of the value in
+// ceil(flat bit count / 8) bytes: leaves are laid out depth first from bit 0
+// (LSB first within a byte), with element 0 of a tuple or array in the lowest
+// bits. Arrays of bits are thus stored exactly as packed bits arrays (see
+// Value::IsPackedBitsArray()) and are copied a word at a time when reading or
+// writing. As in channel data files, the sizes are in host byte order.
+class TypedValueReader {
+ public:
+  // Creates a reader of `contents`, which must outlive the reader.
+  static absl::StatusOr<TypedValueReader> Create(std::string_view contents);
+
+  const TypeProto& type() const { return type_; }
+  int64_t count() const { return count_; }
+
+  // Returns the i-th value of the file.
+  Value Get(int64_t i) const;
+
+  // Returns the values of the file, at most `max_count` of them if given.
+  std::vector<Value> GetAll(
+      std::optional<int64_t> max_count = std::nullopt) const;
+
+ private:
+  TypedValueReader(TypeProto type,
+                   std::shared_ptr<const TypedValueLayout> layout,
+                   int64_t count, std::string_view records);
+
+  TypeProto type_;
+  std::shared_ptr<const TypedValueLayout> layout_;
+  int64_t count_;
+  int64_t record_size_;
+  std::string_view records_;
+};
+
+// Returns whether `contents` starts like a typed value file.
+bool IsTypedValueFile(std::string_view contents);
+
+// Returns a typed value file holding `values`, each of which must be of type
+// `type`.
+absl::StatusOr<std::string> EncodeTypedValues(const TypeProto& type,
+                                              absl::Span<const Value> values);
+
+// Returns the values held by the typed value file `contents`.
+absl::StatusOr<std::vector<Value>> DecodeTypedValues(std::string_view contents);
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_TYPED_VALUE_FILE_H_
@@ -0,0 +1,150 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/typed_value_file.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+TEST(TypedValueFileTest, RoundTrip) {
+  Package package("test");
+  Type* array = package.GetArrayType(3, package.GetBitsType(13));
+  Type* type = package.GetTupleType(
+      {package.GetBitsType(1), package.GetBitsType(70), array,
+       package.GetArrayType(2, package.GetTupleType({package.GetBitsType(5),
+                                                     package.GetTokenType()})),
+       package.GetBitsType(0)});
+  auto make_value = [](int64_t i) {
+    return Value::Tuple(
+        {Value(UBits(i % 2, 1)),
+         Value(bits_ops::Concat(
+             {UBits(i, 6), UBits(~static_cast<uint64_t>(i), 64)})),
+         Value::UBitsArray({1, static_cast<uint64_t>(i), 0x1fff}, 13).value(),
+         Value::ArrayOrDie(
+             {Value::Tuple({Value(UBits(i, 5)), Value::Token()}),
+              Value::Tuple({Value(UBits(31 - i, 5)), Value::Token()})}),
+         Value(Bits())});
+  };
+  std::vector<Value> values;
+  for (int64_t i = 0; i < 20; ++i) {
+    values.push_back(make_value(i));
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string contents,
+                           EncodeTypedValues(type->ToProto(), values));
+  EXPECT_TRUE(IsTypedValueFile(contents));
+  XLS_ASSERT_OK_AND_ASSIGN(TypedValueReader reader,
+                           TypedValueReader::Create(contents));
+  EXPECT_EQ(reader.count(), 20);
+  XLS_ASSERT_OK_AND_ASSIGN(Type * read_type,
+                           package.GetTypeFromProto(reader.type()));
+  EXPECT_EQ(read_type, type);
+  EXPECT_EQ(reader.Get(7), values[7]);
+  EXPECT_EQ(reader.GetAll(), values);
+  EXPECT_THAT(reader.GetAll(2), ElementsAre(values[0], values[1]));
+  EXPECT_THAT(DecodeTypedValues(contents), IsOkAndHolds(values));
+}
+
+TEST(TypedValueFileTest, ArraysOfBitsArePacked) {
+  Package package("test");
+  for (int64_t bit_count : {1, 8, 63, 64, 65, 130}) {
+    Type* type = package.GetArrayType(11, package.GetBitsType(bit_count));
+    std::vector<Bits> elements;
+    std::vector<Value> boxed;
+    for (int64_t i = 0; i < 11; ++i) {
+      elements.push_back(
+          bits_ops::ZeroExtend(UBits(i * 0x9e3779b97f4a7c15ULL, 64), 192)
+              .Slice(i % 3, bit_count));
+      boxed.push_back(Value(elements.back()));
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(Value packed, Value::PackedBitsArray(elements));
+
+    // Packed and boxed arrays are encoded identically.
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::string from_packed,
+        EncodeTypedValues(type->ToProto(), {packed, packed}));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::string from_boxed,
+        EncodeTypedValues(type->ToProto(),
+                          {Value::ArrayOrDie(boxed), packed}));
+    EXPECT_EQ(from_packed, from_boxed);
+
+    XLS_ASSERT_OK_AND_ASSIGN(std::vector<Value> values,
+                             DecodeTypedValues(from_packed));
+    ASSERT_EQ(values.size(), 2);
+    EXPECT_TRUE(values[0].IsPackedBitsArray());
+    EXPECT_EQ(values[0], Value::ArrayOrDie(boxed));
+    EXPECT_EQ(values[1], packed);
+  }
+}
+
+TEST(TypedValueFileTest, NoValues) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string contents,
+      EncodeTypedValues(package.GetBitsType(32)->ToProto(), {}));
+  EXPECT_THAT(DecodeTypedValues(contents),
+              IsOkAndHolds(std::vector<Value>()));
+}
+
+TEST(TypedValueFileTest, ValueOfWrongType) {
+  Package package("test");
+  TypeProto type = package.GetBitsType(32)->ToProto();
+  EXPECT_THAT(EncodeTypedValues(type, {Value(UBits(1, 32)),
+                                       Value(UBits(1, 31))}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Value 1 (bits[31]:1)")));
+  EXPECT_THAT(EncodeTypedValues(type, {Value::Tuple({})}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(TypedValueFileTest, MalformedFiles) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string contents,
+      EncodeTypedValues(package.GetBitsType(32)->ToProto(),
+                        {Value(UBits(1, 32)), Value(UBits(2, 32))}));
+  EXPECT_FALSE(IsTypedValueFile("bits[32]:1\n"));
+  EXPECT_THAT(TypedValueReader::Create("bits[32]:1\n"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Not a typed value file")));
+  EXPECT_THAT(TypedValueReader::Create(contents.substr(0, contents.size() - 1)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("expected 2 values of 4 bytes")));
+  EXPECT_THAT(TypedValueReader::Create(contents + "x"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace xls
@@ -242,10 +242,8 @@ def example_handler(filename: str):
     flask.abort(404)
 
 
-@webapp.route('/graph', methods=['POST'])
-def graph_handler():
-  """Parses the posted text and returns a parse status."""
-  text = flask.request.form['text']
+def run_ir_to_json(text: str, extra_args: List[str]):
+  """Runs ir_to_json_main on the given IR text and returns a Flask response."""
   with tempfile.NamedTemporaryFile(
       mode='w', encoding='utf-8', prefix='ir_viz.', suffix='.ir'
   ) as tmp_ir:
@@ -260,6 +258,7 @@ def graph_handler():
       argv.append('--pipeline_stages={}'.format(FLAGS.pipeline_stages))
     if FLAGS.top is not None:
       argv.append('--entry_name={}'.format(FLAGS.top))
+    argv.extend(extra_args)
     try:
       json_text = subprocess.check_output(
           argv,
@@ -276,6 +275,38 @@ def graph_handler():
   return jsonified
 
 
+@webapp.route('/graph', methods=['POST'])
+def graph_handler():
+  """Parses the posted text and returns a parse status."""
+  return run_ir_to_json(flask.request.form['text'], [])
+
+
+@webapp.route('/subgraph', methods=['POST'])
+def subgraph_handler():
+  """Returns part of the graph of the posted text.
+
+  For graphs too large to render whole. The form field 'kind' selects the
+  subgraph: 'neighborhood' (requires 'node', optionally 'radius'),
+  'critical_path' or 'cycle' (requires 'cycle' and --pipeline_stages). At most
+  'max_nodes' nodes are returned; the function is marked 'truncated' if more
+  were selected.
+  """
+  form = flask.request.form
+  kind = form.get('kind', 'neighborhood')
+  if kind not in ('neighborhood', 'critical_path', 'cycle'):
+    return flask.jsonify({
+        'error_code': 'error',
+        'message': 'Unknown subgraph kind: {}'.format(kind)
+    })
+  args = ['--subgraph={}'.format(kind)]
+  for field, flag in (('node', 'subgraph_node'), ('radius', 'subgraph_radius'),
+                      ('cycle', 'subgraph_cycle'),
+                      ('max_nodes', 'subgraph_max_nodes')):
+    if field in form:
+      args.append('--{}={}'.format(flag, form[field]))
+  return run_ir_to_json(form['text'], args)
+
+
 def main(argv):
   if len(argv) > 1:
     raise app.UsageError('Too many command-line arguments.')
@@ -23,6 +23,7 @@
 #include "google/protobuf/util/json_util.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/package.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/visualization/ir_viz/ir_to_proto.h"
@@ -30,13 +31,9 @@
 
 namespace xls {
 
-absl::StatusOr<std::string> IrToJson(
-    Package* package, const DelayEstimator& delay_estimator,
-    const PipelineSchedule* schedule,
-    std::optional<std::string_view> entry_name) {
-  XLS_ASSIGN_OR_RETURN(viz::Package proto, IrToProto(package, delay_estimator,
-                                                     schedule, entry_name));
+namespace {
 
+absl::StatusOr<std::string> ProtoToJson(const viz::Package& proto) {
   std::string serialized_json;
   google::protobuf::util::JsonPrintOptions print_options;
   print_options.add_whitespace = true;
@@ -50,4 +47,26 @@ absl::StatusOr<std::string> IrToJson(
   return serialized_json;
 }
 
+}  // namespace
+
+absl::StatusOr<std::string> IrToJson(
+    Package* package, const DelayEstimator& delay_estimator,
+    const PipelineSchedule* schedule,
+    std::optional<std::string_view> entry_name) {
+  XLS_ASSIGN_OR_RETURN(viz::Package proto, IrToProto(package, delay_estimator,
+                                                     schedule, entry_name));
+  return ProtoToJson(proto);
+}
+
+absl::StatusOr<std::string> IrToSubgraphJson(
+    Package* package, FunctionBase* function_base,
+    const DelayEstimator& delay_estimator, const PipelineSchedule* schedule,
+    const SubgraphOptions& options) {
+  XLS_ASSIGN_OR_RETURN(
+      viz::Package proto,
+      IrToSubgraphProto(package, function_base, delay_estimator, schedule,
+                        options));
+  return ProtoToJson(proto);
+}
+
 }  // namespace xls
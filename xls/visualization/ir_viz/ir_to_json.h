@@ -21,8 +21,10 @@
 
 #include "absl/status/statusor.h"
 #include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/package.h"
 #include "xls/scheduling/pipeline_schedule.h"
+#include "xls/visualization/ir_viz/ir_to_proto.h"
 
 namespace xls {
 
@@ -34,6 +36,13 @@ absl::StatusOr<std::string> IrToJson(
     const PipelineSchedule* schedule = nullptr,
     std::optional<std::string_view> entry_name = std::nullopt);
 
+// Returns a JSON representation of the selected subgraph of the given function
+// base. See IrToSubgraphProto.
+absl::StatusOr<std::string> IrToSubgraphJson(
+    Package* package, FunctionBase* function_base,
+    const DelayEstimator& delay_estimator, const PipelineSchedule* schedule,
+    const SubgraphOptions& options);
+
 }  // namespace xls
 
 #endif  // XLS_VISUALIZATION_IR_VIZ_IR_TO_JSON_H_
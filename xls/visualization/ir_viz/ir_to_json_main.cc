@@ -40,14 +40,26 @@
 #include "xls/scheduling/run_pipeline_schedule.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "xls/visualization/ir_viz/ir_to_json.h"
+#include "xls/visualization/ir_viz/ir_to_proto.h"
 
 ABSL_FLAG(std::string, delay_model, "", "Delay model to use.");
 ABSL_FLAG(std::optional<int64_t>, pipeline_stages, std::nullopt,
           "Pipeline stages to use when scheduling the function");
 ABSL_FLAG(std::optional<std::string>, entry_name, std::nullopt, "Entry name");
+ABSL_FLAG(std::string, subgraph, "",
+          "If specified, only emit part of the entry: 'neighborhood' (the nodes "
+          "within --subgraph_radius edges of --subgraph_node), 'critical_path' "
+          "or 'cycle' (the nodes in pipeline stage --subgraph_cycle).");
+ABSL_FLAG(std::string, subgraph_node, "",
+          "Name of the node at the center of a neighborhood subgraph.");
+ABSL_FLAG(int64_t, subgraph_radius, 2,
+          "Number of edges from --subgraph_node to include.");
+ABSL_FLAG(int64_t, subgraph_cycle, 0, "Pipeline stage of a cycle subgraph.");
+ABSL_FLAG(int64_t, subgraph_max_nodes, 2000,
+          "Maximum number of nodes in a subgraph.");
 
 constexpr std::string_view kUsage =
-    R"(Expected: ir_to_json_main --delay_model=MODEL [--pipeline_stages=N] [--entry_name=ENTRY] /path/to/file.ir)";
+    R"(Expected: ir_to_json_main --delay_model=MODEL [--pipeline_stages=N] [--entry_name=ENTRY] [--subgraph=KIND] /path/to/file.ir)";
 
 namespace xls {
 namespace {
@@ -67,10 +79,35 @@ absl::StatusOr<FunctionBase*> GetFunctionBaseToView(Package* package) {
       absl::StrFormat("No entities found in package: %s.", package->name()));
 }
 
+absl::StatusOr<std::optional<SubgraphOptions>> GetSubgraphOptions() {
+  std::string subgraph = absl::GetFlag(FLAGS_subgraph);
+  if (subgraph.empty()) {
+    return std::nullopt;
+  }
+  SubgraphOptions options;
+  if (subgraph == "neighborhood") {
+    options.selection = SubgraphOptions::Selection::kNeighborhood;
+  } else if (subgraph == "critical_path") {
+    options.selection = SubgraphOptions::Selection::kCriticalPath;
+  } else if (subgraph == "cycle") {
+    options.selection = SubgraphOptions::Selection::kCycle;
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unknown --subgraph: %s", subgraph));
+  }
+  options.center_node = absl::GetFlag(FLAGS_subgraph_node);
+  options.radius = absl::GetFlag(FLAGS_subgraph_radius);
+  options.cycle = absl::GetFlag(FLAGS_subgraph_cycle);
+  options.max_nodes = absl::GetFlag(FLAGS_subgraph_max_nodes);
+  return options;
+}
+
 absl::Status RealMain(const std::filesystem::path& ir_path,
                       std::string_view delay_model_name,
                       std::optional<int64_t> pipeline_stages,
                       std::optional<std::string_view> entry_name) {
+  XLS_ASSIGN_OR_RETURN(std::optional<SubgraphOptions> subgraph_options,
+                       GetSubgraphOptions());
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        Parser::ParsePackage(ir_text));
@@ -83,21 +120,27 @@ absl::Status RealMain(const std::filesystem::path& ir_path,
   XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
                        GetDelayEstimator(delay_model_name));
 
-  std::string json;
+  std::optional<PipelineSchedule> schedule;
   if (pipeline_stages.has_value()) {
     // TODO(meheff): Support scheduled procs.
     XLS_RET_CHECK(func_base->IsFunction());
     XLS_ASSIGN_OR_RETURN(
-        PipelineSchedule schedule,
+        schedule,
         RunPipelineSchedule(
             func_base->AsFunctionOrDie(), *delay_estimator,
             SchedulingOptions().pipeline_stages(pipeline_stages.value())));
-    XLS_ASSIGN_OR_RETURN(json, IrToJson(package.get(), *delay_estimator,
-                                        &schedule, func_base->name()));
+  }
+  const PipelineSchedule* schedule_ptr =
+      schedule.has_value() ? &schedule.value() : nullptr;
+
+  std::string json;
+  if (subgraph_options.has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        json, IrToSubgraphJson(package.get(), func_base, *delay_estimator,
+                               schedule_ptr, subgraph_options.value()));
   } else {
-    XLS_ASSIGN_OR_RETURN(json,
-                         IrToJson(package.get(), *delay_estimator,
-                                  /*schedule=*/nullptr, func_base->name()));
+    XLS_ASSIGN_OR_RETURN(json, IrToJson(package.get(), *delay_estimator,
+                                        schedule_ptr, func_base->name()));
   }
   std::cout << json << "\n";
   return absl::OkStatus();
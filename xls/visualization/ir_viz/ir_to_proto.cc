@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -142,7 +143,8 @@ std::optional<int64_t> MaybeGetStateParamIndex(Node* node) {
 // instruction) as a proto which is to be serialized to JSON.
 absl::StatusOr<viz::NodeAttributes> NodeAttributes(
     Node* node,
-    const absl::flat_hash_map<Node*, CriticalPathEntry*>& critical_path_map,
+    const absl::flat_hash_map<Node*, const CriticalPathEntry*>&
+        critical_path_map,
     const QueryEngine& query_engine, const PipelineSchedule* schedule,
     const DelayEstimator& delay_estimator) {
   AttributeVisitor visitor;
@@ -181,10 +183,29 @@ absl::StatusOr<viz::NodeAttributes> NodeAttributes(
   return attributes;
 }
 
+// Returns the critical path of the function, or an empty path if it could not
+// be analyzed.
+std::vector<CriticalPathEntry> GetCriticalPath(
+    FunctionBase* function, const DelayEstimator& delay_estimator) {
+  absl::StatusOr<std::vector<CriticalPathEntry>> critical_path =
+      AnalyzeCriticalPath(function, /*clock_period_ps=*/std::nullopt,
+                          delay_estimator);
+  if (!critical_path.ok()) {
+    LOG(WARNING) << "Could not analyze critical path for function: "
+                 << critical_path.status();
+    return {};
+  }
+  return std::move(critical_path).value();
+}
+
+// Returns the visualization proto of the function. If `selected_nodes` is
+// given, only those nodes and the edges between them are included.
 absl::StatusOr<viz::FunctionBase> FunctionBaseToVisualizationProto(
     FunctionBase* function, const DelayEstimator& delay_estimator,
     const PipelineSchedule* schedule,
-    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids) {
+    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids,
+    absl::Span<const CriticalPathEntry> critical_path,
+    const absl::flat_hash_set<Node*>* selected_nodes = nullptr) {
   viz::FunctionBase proto;
   proto.set_name(function->name());
   if (function->IsFunction()) {
@@ -196,27 +217,39 @@ absl::StatusOr<viz::FunctionBase> FunctionBaseToVisualizationProto(
     proto.set_kind("block");
   }
   proto.set_id(function_ids.at(function));
-  absl::StatusOr<std::vector<CriticalPathEntry>> critical_path =
-      AnalyzeCriticalPath(function, /*clock_period_ps=*/std::nullopt,
-                          delay_estimator);
-  absl::flat_hash_map<Node*, CriticalPathEntry*> node_to_critical_path_entry;
-  if (critical_path.ok()) {
-    for (CriticalPathEntry& entry : critical_path.value()) {
-      node_to_critical_path_entry[entry.node] = &entry;
-    }
-  } else {
-    LOG(WARNING) << "Could not analyze critical path for function: "
-                 << critical_path.status();
+  absl::flat_hash_map<Node*, const CriticalPathEntry*>
+      node_to_critical_path_entry;
+  for (const CriticalPathEntry& entry : critical_path) {
+    node_to_critical_path_entry[entry.node] = &entry;
   }
+  auto is_selected = [&](Node* node) {
+    return selected_nodes == nullptr || selected_nodes->contains(node);
+  };
 
-  std::vector<std::unique_ptr<QueryEngine>> engines;
-  engines.emplace_back(
-      std::make_unique<BddQueryEngine>(BddFunction::kDefaultPathLimit));
-  engines.emplace_back(std::make_unique<TernaryQueryEngine>());
-  UnionQueryEngine query_engine(std::move(engines));
-  XLS_RETURN_IF_ERROR(query_engine.Populate(function).status());
+  // A subgraph only needs known bits for its own nodes, so only their cones
+  // are analyzed, with the (linear-time) ternary engine.
+  std::unique_ptr<QueryEngine> query_engine;
+  if (selected_nodes == nullptr) {
+    std::vector<std::unique_ptr<QueryEngine>> engines;
+    engines.emplace_back(
+        std::make_unique<BddQueryEngine>(BddFunction::kDefaultPathLimit));
+    engines.emplace_back(std::make_unique<TernaryQueryEngine>());
+    query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
+    XLS_RETURN_IF_ERROR(query_engine->Populate(function).status());
+  } else {
+    auto ternary_query_engine = std::make_unique<TernaryQueryEngine>();
+    for (Node* node : function->nodes()) {
+      if (is_selected(node)) {
+        XLS_RETURN_IF_ERROR(ternary_query_engine->PopulateCone(node));
+      }
+    }
+    query_engine = std::move(ternary_query_engine);
+  }
 
   for (Node* node : function->nodes()) {
+    if (!is_selected(node)) {
+      continue;
+    }
     viz::Node* graph_node = proto.add_nodes();
     graph_node->set_name(node->GetName());
     graph_node->set_id(GetNodeUniqueId(node, function_ids));
@@ -224,7 +257,7 @@ absl::StatusOr<viz::FunctionBase> FunctionBaseToVisualizationProto(
     graph_node->set_ir(node->ToStringWithOperandTypes());
     XLS_ASSIGN_OR_RETURN(
         *graph_node->mutable_attributes(),
-        NodeAttributes(node, node_to_critical_path_entry, query_engine,
+        NodeAttributes(node, node_to_critical_path_entry, *query_engine,
                        schedule, delay_estimator));
   }
   viz::Node* implicit_sink = nullptr;
@@ -241,9 +274,15 @@ absl::StatusOr<viz::FunctionBase> FunctionBaseToVisualizationProto(
   };
 
   for (Node* node : function->nodes()) {
+    if (!is_selected(node)) {
+      continue;
+    }
     bool node_on_critical_path = node_to_critical_path_entry.contains(node);
     for (int64_t i = 0; i < node->operand_count(); ++i) {
       Node* operand = node->operand(i);
+      if (!is_selected(operand)) {
+        continue;
+      }
       viz::Edge* graph_edge = proto.add_edges();
       graph_edge->set_id(GetEdgeUniqueId(operand, node, function_ids));
       graph_edge->set_source_id(GetNodeUniqueId(operand, function_ids));
@@ -492,8 +531,98 @@ absl::StatusOr<std::string> MarkUpIrText(Package* package) {
   return absl::StrJoin(lines, "\n");
 }
 
+
+// Returns the nodes within `radius` operand or user edges of `center`, in
+// breadth-first order.
+std::vector<Node*> GetNeighborhood(Node* center, int64_t radius) {
+  std::vector<Node*> neighborhood = {center};
+  absl::flat_hash_set<Node*> visited = {center};
+  int64_t frontier_begin = 0;
+  for (int64_t distance = 0; distance < radius; ++distance) {
+    int64_t frontier_end = neighborhood.size();
+    for (int64_t i = frontier_begin; i < frontier_end; ++i) {
+      Node* node = neighborhood[i];
+      for (Node* operand : node->operands()) {
+        if (visited.insert(operand).second) {
+          neighborhood.push_back(operand);
+        }
+      }
+      for (Node* user : node->users()) {
+        if (visited.insert(user).second) {
+          neighborhood.push_back(user);
+        }
+      }
+    }
+    frontier_begin = frontier_end;
+  }
+  return neighborhood;
+}
+
 }  // namespace
 
+absl::StatusOr<viz::Package> IrToSubgraphProto(
+    Package* package, FunctionBase* function_base,
+    const DelayEstimator& delay_estimator, const PipelineSchedule* schedule,
+    const SubgraphOptions& options) {
+  XLS_RET_CHECK_GT(options.max_nodes, 0);
+  if (schedule != nullptr && schedule->function_base() != function_base) {
+    schedule = nullptr;
+  }
+  std::vector<CriticalPathEntry> critical_path =
+      GetCriticalPath(function_base, delay_estimator);
+
+  std::vector<Node*> nodes;
+  switch (options.selection) {
+    case SubgraphOptions::Selection::kNeighborhood: {
+      XLS_ASSIGN_OR_RETURN(Node * center,
+                           function_base->GetNode(options.center_node));
+      nodes = GetNeighborhood(center, options.radius);
+      break;
+    }
+    case SubgraphOptions::Selection::kCriticalPath:
+      for (const CriticalPathEntry& entry : critical_path) {
+        nodes.push_back(entry.node);
+      }
+      break;
+    case SubgraphOptions::Selection::kCycle: {
+      if (schedule == nullptr) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Selecting cycle %d requires a schedule of %s", options.cycle,
+            function_base->name()));
+      }
+      if (options.cycle < 0 || options.cycle >= schedule->length()) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Cycle %d is not in the %d-stage schedule of %s",
+                            options.cycle, schedule->length(),
+                            function_base->name()));
+      }
+      absl::Span<Node* const> cycle_nodes =
+          schedule->nodes_in_cycle(options.cycle);
+      nodes.assign(cycle_nodes.begin(), cycle_nodes.end());
+      break;
+    }
+  }
+
+  bool truncated = static_cast<int64_t>(nodes.size()) > options.max_nodes;
+  if (truncated) {
+    nodes.resize(options.max_nodes);
+  }
+  absl::flat_hash_set<Node*> selected_nodes(nodes.begin(), nodes.end());
+
+  absl::flat_hash_map<FunctionBase*, std::string> function_ids =
+      GetFunctionIds(package);
+  viz::Package proto;
+  proto.set_name(package->name());
+  XLS_ASSIGN_OR_RETURN(
+      *proto.add_function_bases(),
+      FunctionBaseToVisualizationProto(function_base, delay_estimator, schedule,
+                                       function_ids, critical_path,
+                                       &selected_nodes));
+  proto.mutable_function_bases(0)->set_truncated(truncated);
+  proto.set_entry_id(function_ids.at(function_base));
+  return proto;
+}
+
 absl::StatusOr<viz::Package> IrToProto(
     Package* package, const DelayEstimator& delay_estimator,
     const PipelineSchedule* schedule,
@@ -511,7 +640,7 @@ absl::StatusOr<viz::Package> IrToProto(
             fb, delay_estimator,
             schedule != nullptr && schedule->function_base() == fb ? schedule
                                                                    : nullptr,
-            function_ids));
+            function_ids, GetCriticalPath(fb, delay_estimator)));
     if (entry_name.has_value() && fb->name() == entry_name.value()) {
       entry_function_base = fb;
     }
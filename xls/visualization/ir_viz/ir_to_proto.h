@@ -15,12 +15,14 @@
 #ifndef XLS_VISUALIZATION_IR_VIZ_IR_TO_PROTO_H_
 #define XLS_VISUALIZATION_IR_VIZ_IR_TO_PROTO_H_
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <string_view>
 
 #include "absl/status/statusor.h"
 #include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/package.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/visualization/ir_viz/visualization.pb.h"
@@ -34,6 +36,36 @@ absl::StatusOr<xls::viz::Package> IrToProto(
     const PipelineSchedule* schedule = nullptr,
     std::optional<std::string_view> entry_name = std::nullopt);
 
+// Selects the part of a function base returned by IrToSubgraphProto.
+struct SubgraphOptions {
+  enum class Selection {
+    // The nodes within `radius` operand/user edges of `center_node`.
+    kNeighborhood,
+    // The nodes on the critical path.
+    kCriticalPath,
+    // The nodes scheduled in `cycle`. Requires a schedule.
+    kCycle,
+  };
+  Selection selection = Selection::kNeighborhood;
+  std::string center_node;
+  int64_t radius = 2;
+  int64_t cycle = 0;
+
+  // At most this many nodes are returned; if more are selected the function
+  // base is marked as truncated.
+  int64_t max_nodes = 2000;
+};
+
+// Returns a xls::viz::Package proto containing only the selected subgraph of
+// `function_base`, so that graphs too large to render (or to serialize) whole
+// can be browsed piecewise. Only edges between selected nodes are included,
+// known bits are computed for the selected nodes' cones only, and the package
+// IR text is omitted.
+absl::StatusOr<xls::viz::Package> IrToSubgraphProto(
+    Package* package, FunctionBase* function_base,
+    const DelayEstimator& delay_estimator, const PipelineSchedule* schedule,
+    const SubgraphOptions& options);
+
 }  // namespace xls
 
 #endif  // XLS_VISUALIZATION_IR_VIZ_IR_TO_PROTO_H_
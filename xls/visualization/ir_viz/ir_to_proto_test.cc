@@ -16,10 +16,14 @@
 
 #include <filesystem>  // NOLINT
 #include <memory>
+#include <string>
 #include <string_view>
+#include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/log/log.h"
+#include "absl/status/status.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/golden_files.h"
 #include "xls/common/status/matchers.h"
@@ -36,6 +40,9 @@
 namespace xls {
 namespace {
 
+using status_testing::StatusIs;
+using ::testing::UnorderedElementsAre;
+
 constexpr char kTestdataPath[] = "xls/visualization/ir_viz/testdata";
 
 class IrToProtoTest : public IrTestBase {
@@ -178,5 +185,85 @@ top proc the_proc(x: bits[32], y: bits[64], init={0, 42}) {
   ExpectEqualToGoldenFile(GoldenFilePath("htmltext"), proto.ir_html());
 }
 
+TEST_F(IrToProtoTest, NeighborhoodSubgraph) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package test
+
+top fn main(x: bits[32], y: bits[32]) -> bits[32] {
+  a: bits[32] = add(x, y)
+  b: bits[32] = neg(a)
+  c: bits[32] = not(b)
+  ret d: bits[32] = neg(c)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * delay_estimator,
+                           GetDelayEstimator("unit"));
+
+  SubgraphOptions options;
+  options.selection = SubgraphOptions::Selection::kNeighborhood;
+  options.center_node = "b";
+  options.radius = 1;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      viz::Package proto,
+      IrToSubgraphProto(p.get(), f, *delay_estimator, /*schedule=*/nullptr,
+                        options));
+  ASSERT_EQ(proto.function_bases_size(), 1);
+  const viz::FunctionBase& subgraph = proto.function_bases(0);
+  std::vector<std::string> names;
+  for (const viz::Node& node : subgraph.nodes()) {
+    names.push_back(node.name());
+  }
+  EXPECT_THAT(names, UnorderedElementsAre("a", "b", "c"));
+  EXPECT_EQ(subgraph.edges_size(), 2);
+  EXPECT_FALSE(subgraph.truncated());
+  EXPECT_FALSE(proto.has_ir_html());
+
+  options.radius = 10;
+  options.max_nodes = 2;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      proto, IrToSubgraphProto(p.get(), f, *delay_estimator,
+                               /*schedule=*/nullptr, options));
+  EXPECT_EQ(proto.function_bases(0).nodes_size(), 2);
+  EXPECT_TRUE(proto.function_bases(0).truncated());
+}
+
+TEST_F(IrToProtoTest, CycleSubgraph) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue add = fb.Add(x, y);
+  BValue negate = fb.Negate(add);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  ScheduleCycleMap cycle_map;
+  cycle_map[x.node()] = 0;
+  cycle_map[y.node()] = 0;
+  cycle_map[add.node()] = 1;
+  cycle_map[negate.node()] = 2;
+  PipelineSchedule schedule(f, cycle_map);
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * delay_estimator,
+                           GetDelayEstimator("unit"));
+
+  SubgraphOptions options;
+  options.selection = SubgraphOptions::Selection::kCycle;
+  options.cycle = 1;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      viz::Package proto,
+      IrToSubgraphProto(p.get(), f, *delay_estimator, &schedule, options));
+  ASSERT_EQ(proto.function_bases(0).nodes_size(), 1);
+  EXPECT_EQ(proto.function_bases(0).nodes(0).name(), add.node()->GetName());
+  EXPECT_EQ(proto.function_bases(0).edges_size(), 0);
+
+  options.cycle = 3;
+  EXPECT_THAT(
+      IrToSubgraphProto(p.get(), f, *delay_estimator, &schedule, options),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(IrToSubgraphProto(p.get(), f, *delay_estimator,
+                                /*schedule=*/nullptr, options),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 }  // namespace
 }  // namespace xls